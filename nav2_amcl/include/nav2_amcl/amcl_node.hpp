@@ -22,6 +22,8 @@
 #define NAV2_AMCL__AMCL_NODE_HPP_
 
 #include <atomic>
+#include <chrono>
+#include <future>
 #include <map>
 #include <memory>
 #include <string>
@@ -29,12 +31,17 @@
 #include <vector>
 
 #include "geometry_msgs/msg/pose_stamped.hpp"
+#include "map_msgs/msg/occupancy_grid_update.hpp"
 #include "message_filters/subscriber.h"
+#include "nav2_util/instrumentation.hpp"
 #include "nav2_util/lifecycle_node.hpp"
+#include "nav2_util/node_thread.hpp"
+#include "nav2_amcl/map/map_free_space.hpp"
 #include "nav2_amcl/motion_model/motion_model.hpp"
 #include "nav2_amcl/sensors/laser/laser.hpp"
 #include "nav2_msgs/msg/particle.hpp"
 #include "nav2_msgs/msg/particle_cloud.hpp"
+#include "nav_msgs/msg/odometry.hpp"
 #include "nav_msgs/srv/set_map.hpp"
 #include "sensor_msgs/msg/laser_scan.hpp"
 #include "std_srvs/srv/empty.hpp"
@@ -108,14 +115,25 @@ protected:
    * @brief Get new map from ROS topic to localize in
    * @param msg Map message
    */
-  void mapReceived(const nav_msgs::msg::OccupancyGrid::SharedPtr msg);
+  void mapReceived(const nav_msgs::msg::OccupancyGrid::ConstSharedPtr msg);
   /*
    * @brief Handle a new map message
    * @param msg Map message
    */
   void handleMapMessage(const nav_msgs::msg::OccupancyGrid & msg);
   /*
-   * @brief Creates lookup table of free cells in map
+   * @brief Get an update of a patch of the map from ROS topic
+   * @param msg Map update message
+   */
+  void mapUpdateReceived(const map_msgs::msg::OccupancyGridUpdate::SharedPtr msg);
+  /*
+   * @brief Handle a map update message, updating the cspace of the laser models
+   * only around the patch
+   * @param msg Map update message
+   */
+  void handleMapUpdateMessage(const map_msgs::msg::OccupancyGridUpdate & msg);
+  /*
+   * @brief Creates the index of the free cells in map, for uniform sampling
    */
   void createFreeSpaceVector();
   /*
@@ -123,6 +141,8 @@ protected:
    */
   void freeMapDependentMemory();
   map_t * map_{nullptr};
+  // Signature of the map as received, before any update, which particle checkpoints are saved for
+  uint64_t map_signature_{0};
   /*
    * @brief Convert an occupancy grid map to an AMCL map
    * @param map_msg Map message
@@ -134,8 +154,9 @@ protected:
   amcl_hyp_t * initial_pose_hyp_;
   std::recursive_mutex configuration_mutex_;
   rclcpp::Subscription<nav_msgs::msg::OccupancyGrid>::ConstSharedPtr map_sub_;
+  rclcpp::Subscription<map_msgs::msg::OccupancyGridUpdate>::ConstSharedPtr map_update_sub_;
 #if NEW_UNIFORM_SAMPLING
-  static std::vector<std::pair<int, int>> free_space_indices;
+  static nav2_amcl::MapFreeSpace free_space_index;
 #endif
 
   // Transforms
@@ -149,6 +170,9 @@ protected:
   bool sent_first_transform_{false};
   bool latest_tf_valid_{false};
   tf2::Transform latest_tf_;
+  // Latest map to odom transform of a known pose, read by the odometry callback without
+  // taking the filter mutex, null while the pose is unknown
+  std::shared_ptr<const tf2::Transform> map_to_odom_snapshot_;
 
   // Message filters
   /*
@@ -170,6 +194,26 @@ protected:
     pose_pub_;
   rclcpp_lifecycle::LifecyclePublisher<nav2_msgs::msg::ParticleCloud>::SharedPtr
     particle_cloud_pub_;
+  // Publishes the measurements of the probes of the laser updates
+  std::unique_ptr<nav2_util::InstrumentationPublisher> instrumentation_pub_;
+  // Memory held by the map, with its range table and free space index, and by the filter
+  std::unique_ptr<nav2_util::MemoryAccount> map_memory_;
+  std::unique_ptr<nav2_util::MemoryAccount> particle_memory_;
+  /*
+   * @brief Set the memory accounts to the memory held by the map and the filter
+   */
+  void updateMemoryAccounts();
+  // Pose in the global frame at the rate of the odometry, in its own thread not to wait for
+  // the filter updates
+  rclcpp::Subscription<nav_msgs::msg::Odometry>::ConstSharedPtr odom_sub_;
+  rclcpp_lifecycle::LifecyclePublisher<geometry_msgs::msg::PoseStamped>::SharedPtr
+    odom_rate_pose_pub_;
+  rclcpp::CallbackGroup::SharedPtr odom_callback_group_;
+  std::unique_ptr<nav2_util::NodeThread> odom_thread_;
+  /*
+   * @brief Publish the odometry pose composed with the latest map to odom transform
+   */
+  void odomReceived(nav_msgs::msg::Odometry::ConstSharedPtr msg);
   /*
    * @brief Handle with an initial pose estimate is received
    */
@@ -192,6 +236,29 @@ protected:
     const std::shared_ptr<rmw_request_id_t> request_header,
     const std::shared_ptr<std_srvs::srv::Empty::Request> request,
     std::shared_ptr<std_srvs::srv::Empty::Response> response);
+  /*
+   * @struct GlobalHypotheses
+   * @brief Poses matching a scan over the whole map, with their spread
+   */
+  struct GlobalHypotheses
+  {
+    std::vector<pf_vector_t> poses;
+    pf_vector_t spread;
+  };
+  GlobalHypotheses global_hypotheses_;
+  // Whether the next scan is matched over the map for a coarse-to-fine global localization
+  bool global_localization_pending_{false};
+  /*
+   * @brief Match a scan over the whole map, and spread the particles around the best
+   * matching poses, if the laser model can
+   * @param laser Laser model to match the scan with
+   * @param data Laser data to match
+   */
+  void seedGlobalHypotheses(nav2_amcl::Laser * laser, nav2_amcl::LaserData * data);
+  /*
+   * @brief Pose-generating function spreading particles around the global hypotheses
+   */
+  static pf_vector_t hypothesesPoseGenerator(void * arg);
 
   // Let amcl update samples without requiring motion
   rclcpp::Service<std_srvs::srv::Empty>::SharedPtr nomotion_update_srv_;
@@ -255,6 +322,14 @@ protected:
   int scan_error_count_{0};
   std::vector<nav2_amcl::Laser *> lasers_;
   std::vector<bool> lasers_update_;
+  // Ranges precomputed over the map for the beam model, shared by its lasers
+  std::shared_ptr<nav2_amcl::MapRangeTable> range_table_;
+  /*
+   * @brief Build or load from its cache the range table of the map, for the beam model
+   */
+  void createRangeTable();
+  // Time the robot last moved enough for an update, starting a batch of laser updates
+  rclcpp::Time batch_start_time_;
   std::map<std::string, int> frame_to_laser_;
   rclcpp::Time last_laser_received_ts_;
 
@@ -286,6 +361,21 @@ protected:
    * @brief Publish particle cloud
    */
   void publishParticleCloud(const pf_sample_set_t * set);
+  std::chrono::steady_clock::time_point last_particle_cloud_time_;
+  /*
+   * @brief Save the particle set to the checkpoint file, at most at its rate and from another
+   * thread, skipped while the previous checkpoint is being written
+   */
+  void saveParticleCheckpoint();
+  /*
+   * @brief Restore the particle set from the checkpoint file, if saved for the current map
+   * @return Whether the particle set was restored
+   */
+  bool restoreParticleCheckpoint();
+  std::chrono::steady_clock::time_point last_particle_checkpoint_time_;
+  std::future<bool> particle_checkpoint_write_;
+  // Whether the first scan since activation restores the checkpoint, unless a pose is known
+  bool particle_checkpoint_pending_{false};
   /*
    * @brief Get the current state estimat hypothesis from the particle cloud
    */
@@ -326,26 +416,42 @@ protected:
    * @brief Get ROS parameters for node
    */
   void initParameters();
+  bool adaptive_beam_selection_;
   double alpha1_;
   double alpha2_;
   double alpha3_;
   double alpha4_;
   double alpha5_;
   std::string base_frame_id_;
+  bool batch_laser_updates_;
+  int beam_range_table_bins_;
+  std::string beam_range_table_cache_;
   double beam_skip_distance_;
   double beam_skip_error_threshold_;
   double beam_skip_threshold_;
   bool do_beamskip_;
   std::string global_frame_id_;
+  int global_localization_factor_;
+  int global_localization_hypotheses_;
   double lambda_short_;
+  double laser_batch_window_;
   double laser_likelihood_max_dist_;
   double laser_max_range_;
   double laser_min_range_;
   std::string sensor_model_type_;
+  int laser_model_threads_;
   int max_beams_;
   int max_particles_;
   int min_particles_;
+  int motion_model_seed_;
   std::string odom_frame_id_;
+  std::string odom_topic_;
+  bool publish_odom_rate_pose_;
+  bool particle_cloud_clusters_;
+  int particle_cloud_max_count_;
+  double particle_cloud_max_rate_;
+  std::string particle_checkpoint_file_;
+  double particle_checkpoint_rate_;
   double pf_err_;
   double pf_z_;
   double alpha_fast_;
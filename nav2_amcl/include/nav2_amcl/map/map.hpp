@@ -46,10 +46,11 @@ struct _rtk_fig_t;
 typedef struct
 {
   // Occupancy state (-1 = free, 0 = unknown, +1 = occ)
-  int occ_state;
+  int8_t occ_state;
 
-  // Distance to the nearest occupied cell
-  double occ_dist;
+  // Distance to the nearest occupied cell, single precision as the likelihood fields sample
+  // it, which halves the size of the cells
+  float occ_dist;
 
   // Wifi levels
   // int wifi_levels[MAP_WIFI_MAX_LEVELS];
@@ -90,6 +91,12 @@ void map_free(map_t * map);
 // Update the cspace distances
 void map_update_cspace(map_t * map, double max_occ_dist);
 
+// Update the cspace distances around a window of changed cells, replaced by the updated window
+void map_update_cspace_region(map_t * map, int * min_i, int * min_j, int * max_i, int * max_j);
+
+// Hash of the size, scale, origin and occupancy of a map, to match data saved for it
+uint64_t map_signature(map_t * map);
+
 
 /**************************************************************************
  * Range functions
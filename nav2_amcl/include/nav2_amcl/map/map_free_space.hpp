@@ -0,0 +1,83 @@
+// Copyright (c) 2022 Samsung Research America
+//
+// This library is free software; you can redistribute it and/or
+// modify it under the terms of the GNU Lesser General Public
+// License as published by the Free Software Foundation; either
+// version 2.1 of the License, or (at your option) any later version.
+//
+// This library is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+// Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public
+// License along with this library; if not, write to the Free Software
+// Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+
+#ifndef NAV2_AMCL__MAP__MAP_FREE_SPACE_HPP_
+#define NAV2_AMCL__MAP__MAP_FREE_SPACE_HPP_
+
+#include <stddef.h>
+#include <stdint.h>
+#include <vector>
+#include "nav2_amcl/map/map.hpp"
+
+namespace nav2_amcl
+{
+
+/*
+ * @class MapFreeSpace
+ * @brief Index of the free cells of a map, to sample them uniformly. The free cells are
+ * kept as the runs of consecutive free cells of each row, with the count of free cells up
+ * to the end of each run, so that the cell of a rank is found by a binary search over the
+ * runs. Maps of large free areas take a few bytes per run rather than per free cell.
+ */
+class MapFreeSpace
+{
+public:
+  /*
+   * @brief Index the free cells of a map, the rows being split across one thread per core
+   * @param map Map to index
+   */
+  void build(const map_t * map);
+
+  /*
+   * @brief Clear the index
+   */
+  void clear();
+
+  /*
+   * @brief Get the number of free cells
+   */
+  int64_t size() const
+  {
+    return run_ends_.empty() ? 0 : run_ends_.back();
+  }
+
+  /*
+   * @brief Get the free cell of a rank, in row order
+   * @param rank Rank of the cell, in [0, size())
+   * @param i Column of the cell
+   * @param j Row of the cell
+   */
+  void getCell(int64_t rank, int & i, int & j) const;
+
+  /*
+   * @brief Get the number of bytes allocated by the index
+   */
+  size_t getMemoryUsage() const
+  {
+    return run_starts_.capacity() * sizeof(int) + run_ends_.capacity() * sizeof(int64_t);
+  }
+
+private:
+  int size_x_{0};
+  // Index of the first cell of each run
+  std::vector<int> run_starts_;
+  // Number of free cells up to the end of each run
+  std::vector<int64_t> run_ends_;
+};
+
+}  // namespace nav2_amcl
+
+#endif  // NAV2_AMCL__MAP__MAP_FREE_SPACE_HPP_
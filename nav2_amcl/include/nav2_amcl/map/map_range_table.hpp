@@ -0,0 +1,101 @@
+// Copyright (c) 2022 Samsung Research America
+//
+// This library is free software; you can redistribute it and/or
+// modify it under the terms of the GNU Lesser General Public
+// License as published by the Free Software Foundation; either
+// version 2.1 of the License, or (at your option) any later version.
+//
+// This library is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+// Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public
+// License along with this library; if not, write to the Free Software
+// Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+
+#ifndef NAV2_AMCL__MAP__MAP_RANGE_TABLE_HPP_
+#define NAV2_AMCL__MAP__MAP_RANGE_TABLE_HPP_
+
+#include <stddef.h>
+#include <stdint.h>
+#include <string>
+#include <vector>
+#include "nav2_amcl/map/map.hpp"
+
+namespace nav2_amcl
+{
+
+/*
+ * @class MapRangeTable
+ * @brief Ranges of map_calc_range() precomputed from the center of every cell of a map,
+ * in a number of headings evenly spread over a turn, so that the beam model looks up the
+ * range of each beam rather than ray casting it. The table holds a 16 bit range per cell
+ * and heading, in quarters of a cell.
+ */
+class MapRangeTable
+{
+public:
+  /*
+   * @brief MapRangeTable constructor, the table being empty until built or loaded
+   * @param map Map to cast the rays in
+   * @param bins Number of headings
+   * @param max_range Range of the rays cast, beyond which calcRange() casts its own
+   */
+  MapRangeTable(map_t * map, int bins, double max_range);
+
+  /*
+   * @brief Cast the rays of all the cells of the map, from one thread per core
+   */
+  void build();
+
+  /*
+   * @brief Cast again the rays which may cross a window of cells [min_i, max_i) x
+   * [min_j, max_j) whose occupancy changed, those of the cells within max_range of it
+   */
+  void update(int min_i, int min_j, int max_i, int max_j);
+
+  /*
+   * @brief Load the table from a file saved for the same map, bins and max range
+   * @param path Path of the file
+   * @return False if the file can't be read or was saved for another map or setting
+   */
+  bool load(const std::string & path);
+
+  /*
+   * @brief Save the table to a file
+   * @param path Path of the file
+   * @return False if the file can't be written
+   */
+  bool save(const std::string & path) const;
+
+  /*
+   * @brief Get the range to the first occupied cell from a pose, as map_calc_range(), from
+   * the ray of the nearest heading cast from the center of the cell of the pose
+   */
+  double calcRange(double ox, double oy, double oa, double max_range) const;
+
+  /*
+   * @brief Get the number of bytes allocated by the table
+   */
+  size_t getMemoryUsage() const
+  {
+    return ranges_.capacity() * sizeof(uint16_t);
+  }
+
+private:
+  /*
+   * @brief Cast the rays of the cells of a window [min_i, max_i) x [min_j, max_j)
+   */
+  void castRays(int min_i, int min_j, int max_i, int max_j);
+
+  map_t * map_;
+  int bins_;
+  double max_range_;
+  // Ranges of each cell, in heading order, UINT16_MAX when no cell is hit within max_range_
+  std::vector<uint16_t> ranges_;
+};
+
+}  // namespace nav2_amcl
+
+#endif  // NAV2_AMCL__MAP__MAP_RANGE_TABLE_HPP_
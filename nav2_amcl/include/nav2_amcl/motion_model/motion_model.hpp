@@ -17,8 +17,11 @@
 #ifndef NAV2_AMCL__MOTION_MODEL__MOTION_MODEL_HPP_
 #define NAV2_AMCL__MOTION_MODEL__MOTION_MODEL_HPP_
 
+#include <stdint.h>
+#include <time.h>
 #include <string>
 #include <memory>
+#include <vector>
 
 #include "nav2_amcl/pf/pf.hpp"
 #include "nav2_amcl/pf/pf_pdf.hpp"
@@ -33,6 +36,14 @@ namespace nav2_amcl
 class MotionModel
 {
 public:
+  /**
+   * @brief A MotionModel constructor, seeding the odometry noise from the time
+   */
+  MotionModel()
+  {
+    pf_ran_stream_seed(&noise_stream_, time(NULL));
+  }
+
   virtual ~MotionModel() = default;
 
   /**
@@ -56,6 +67,31 @@ public:
    * @param delta change in pose in odometry update
    */
   virtual void odometryUpdate(pf_t * pf, const pf_vector_t & pose, const pf_vector_t & delta) = 0;
+
+  /**
+   * @brief Seed the odometry noise, so that runs from the same seed sample the same noise
+   * @param seed Seed of the noise
+   */
+  void setRandomSeed(uint64_t seed)
+  {
+    pf_ran_stream_seed(&noise_stream_, seed);
+  }
+
+protected:
+  /**
+   * @brief Draw the zero-mean, unit standard deviation gaussian noise of an update at once
+   * @param count Number of noise values
+   * @return The noise values, valid until the next draw
+   */
+  const double * drawNoise(int count)
+  {
+    noise_.resize(count);
+    pf_ran_gaussian_batch(&noise_stream_, noise_.data(), count);
+    return noise_.data();
+  }
+
+  pf_ran_stream_t noise_stream_;
+  std::vector<double> noise_;
 };
 }  // namespace nav2_amcl
 
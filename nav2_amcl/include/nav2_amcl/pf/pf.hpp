@@ -134,6 +134,9 @@ typedef struct _pf_t
   double dist_threshold;  // distance threshold in each axis over which the pf is considered to not
                           // be converged
   int converged;
+
+  // Cumulative weights of the current set for resampling, of max_samples + 1 entries
+  double * resample_cdf;
 } pf_t;
 
 
@@ -146,12 +149,18 @@ pf_t * pf_alloc(
 // Free an existing filter
 void pf_free(pf_t * pf);
 
+// Get the number of bytes allocated by a filter, for its sample sets, trees and clusters
+size_t pf_memory_usage(const pf_t * pf);
+
 // Initialize the filter using a guassian
 void pf_init(pf_t * pf, pf_vector_t mean, pf_matrix_t cov);
 
 // Initialize the filter using some model
 void pf_init_model(pf_t * pf, pf_init_model_fn_t init_fn, void * init_data);
 
+// Initialize the filter with given samples, as many as max_samples, normalizing their weights
+void pf_init_samples(pf_t * pf, const pf_vector_t * poses, const double * weights, int count);
+
 // Update the filter with some new action
 // void pf_update_action(pf_t * pf, pf_action_model_fn_t action_fn, void * action_data);
 
@@ -28,6 +28,8 @@
 #ifndef NAV2_AMCL__PF__PF_PDF_HPP_
 #define NAV2_AMCL__PF__PF_PDF_HPP_
 
+#include <stdint.h>
+
 #include "nav2_amcl/pf/pf_vector.hpp"
 
 // #include <gsl/gsl_rng.h>
@@ -77,6 +79,27 @@ double pf_ran_gaussian(double sigma);
 // Generate a sample from the pdf.
 pf_vector_t pf_pdf_gaussian_sample(pf_pdf_gaussian_t * pdf);
 
+/**************************************************************************
+ * Random streams
+ *************************************************************************/
+
+// Counter based random stream: sample i of the stream is a hash of the seed
+// and of i, so that batches are drawn with no dependency between samples and
+// replayed from the seed.
+typedef struct
+{
+  uint64_t seed;
+  uint64_t counter;
+} pf_ran_stream_t;
+
+// Seed a random stream, restarting it
+void pf_ran_stream_seed(pf_ran_stream_t * stream, uint64_t seed);
+
+// Draw the next n samples of a random stream from a zero-mean Gaussian
+// distribution with unit standard deviation, in pairs from the basic form of
+// the Box-Muller transformation, which has no rejection loop.
+void pf_ran_gaussian_batch(pf_ran_stream_t * stream, double * samples, int n);
+
 #ifdef __cplusplus
 }
 #endif
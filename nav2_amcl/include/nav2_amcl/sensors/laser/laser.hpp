@@ -18,10 +18,15 @@
 #ifndef NAV2_AMCL__SENSORS__LASER__LASER_HPP_
 #define NAV2_AMCL__SENSORS__LASER__LASER_HPP_
 
+#include <stdint.h>
+#include <functional>
+#include <memory>
 #include <string>
+#include <vector>
 #include "nav2_amcl/pf/pf.hpp"
 #include "nav2_amcl/pf/pf_pdf.hpp"
 #include "nav2_amcl/map/map.hpp"
+#include "nav2_amcl/map/map_range_table.hpp"
 
 namespace nav2_amcl
 {
@@ -62,6 +67,46 @@ public:
    */
   void SetLaserPose(pf_vector_t & laser_pose);
 
+  /*
+   * @brief Set the number of threads weighting the samples of a sensor update
+   * @param num_threads Number of threads, 0 for one per hardware thread
+   */
+  void setThreadCount(int num_threads);
+
+  /*
+   * @brief Set whether the likelihood field models pick the beams of each scan from its
+   * geometry, rather than at a fixed step
+   * @param adaptive Whether to select beams adaptively
+   */
+  void setAdaptiveBeamSelection(bool adaptive);
+
+  /*
+   * @brief Update the map data precomputed by the model in a window of cells
+   * [min_i, max_i) x [min_j, max_j), once their cspace was updated by
+   * map_update_cspace_region()
+   */
+  void updateMapRegion(int min_i, int min_j, int max_i, int max_j);
+
+  /*
+   * @brief Find the poses of the map best matching a scan, for global localization, with
+   * the likelihood field models. The scan is matched by a grid search over the free cells
+   * of a likelihood field downsampled by a factor, in headings turning the farthest beam
+   * by a coarse cell. Each coarse cell holds the highest likelihood within a coarse cell
+   * of it, so that the score of a coarse pose bounds those of the poses around it. The
+   * best coarse poses, up to 64 per pose to find, are refined by a grid search at full
+   * resolution over their coarse cell and heading step, stopping once no other coarse
+   * pose may score better than the poses found.
+   * @param data Laser data to match, with the laser pose set
+   * @param factor Downsampling factor of the coarse likelihood field
+   * @param num_poses Number of poses to find, apart from each other by a coarse pose
+   * @param poses Poses found, best first
+   * @param spread Standard deviation of the poses along each axis, from the search step
+   * @return False if the model has no likelihood field or the scan no beam to match
+   */
+  bool findGlobalPoses(
+    LaserData * data, int factor, int num_poses,
+    std::vector<pf_vector_t> & poses, pf_vector_t & spread);
+
 protected:
   double z_hit_;
   double z_rand_;
@@ -73,12 +118,108 @@ protected:
    * @param max_obs number of observations
    */
   void reallocTempData(int max_samples, int max_obs);
+
+  /*
+   * @brief Run a function over contiguous chunks of the samples of a set, from as many
+   * threads as set, the chunks being the same for a given sample count and thread count
+   * @param set Sample set to split
+   * @param fn Function of the chunk index and its first and last (exclusive) samples
+   * @return Number of chunks
+   */
+  int forEachSampleChunk(
+    pf_sample_set_t * set, const std::function<void(int, int, int)> & fn) const;
+
+  /*
+   * @brief Sum the weights of the samples of a set in order, so that the total does not
+   * depend on how many threads weighted them
+   * @param set Sample set to sum
+   * @return Total weight
+   */
+  static double totalWeight(pf_sample_set_t * set);
+
+  /*
+   * @struct LikelihoodBeams
+   * @brief Beams of a scan integrated by the likelihood field models, as arrays of their
+   * ranges, the sines and cosines of their bearings, and their index among the stepped beams
+   */
+  struct LikelihoodBeams
+  {
+    std::vector<double> range;
+    std::vector<double> cos_bearing;
+    std::vector<double> sin_bearing;
+    std::vector<int> index;
+  };
+
+  /*
+   * @brief Get the beams of a scan that are neither max range nor NaN. With adaptive beam
+   * selection, as many beams are picked from the whole scan as the step would give, half
+   * of them evenly spread and half where the scan bends the most, at corners and edges.
+   * @param data Laser data to use
+   * @param step Step between the beams used
+   * @param beams Beams, replaced by those of the scan
+   */
+  void getLikelihoodBeams(LaserData * data, int step, LikelihoodBeams & beams) const;
+
+  /*
+   * @brief Pack the obstacle distances of the map cells into occ_dist_, followed by the
+   * max distance for beams ending off the map. Called after map_update_cspace().
+   */
+  void packOccDist();
+
+  /*
+   * @brief Precompute the gaussian hit likelihood exp(-z^2 / (2 sigma_hit^2)) of the
+   * obstacle distance z of each map cell into likelihood_, quantized to 16 bits, followed
+   * by that of the max distance for beams ending off the map. Called after
+   * map_update_cspace(), and after sigma_hit_ is set.
+   */
+  void packLikelihoodField();
+
+  /*
+   * @brief Get the gaussian hit likelihood of an obstacle distance, quantized to 16 bits
+   * as in likelihood_
+   * @param z Obstacle distance
+   */
+  uint16_t quantizeLikelihood(double z) const;
+
+  /*
+   * @brief Get the precomputed hit likelihood of a cell of likelihood_
+   * @param cell Index of the cell, as found by getBeamCells()
+   */
+  double hitLikelihood(int cell) const
+  {
+    return likelihood_[cell] * (1.0 / UINT16_MAX);
+  }
+
+  /*
+   * @brief Find the cell under the endpoint of each beam from a laser pose, as an index in
+   * occ_dist_ and likelihood_, their last cell for beams ending off the map
+   * @param pose Pose of the laser
+   * @param beams Beams to use
+   * @param cells Index of the cell of each beam, of the size of the beams
+   */
+  void getBeamCells(const pf_vector_t & pose, const LikelihoodBeams & beams, int * cells) const;
+
   map_t * map_;
   pf_vector_t laser_pose_;
   int max_beams_;
   int max_samples_;
   int max_obs_;
   double ** temp_obs_;
+  int num_threads_;
+  bool adaptive_beam_selection_;
+  std::vector<float> occ_dist_;
+  std::vector<uint16_t> likelihood_;
+  // Likelihood field downsampled by coarse_factor_ for findGlobalPoses(), built on use
+  std::vector<uint16_t> coarse_likelihood_;
+  int coarse_factor_;
+  int coarse_size_x_;
+  int coarse_size_y_;
+
+private:
+  /*
+   * @brief Build coarse_likelihood_ from likelihood_ for a downsampling factor
+   */
+  void buildCoarseLikelihood(int factor);
 };
 
 /*
@@ -127,12 +268,20 @@ public:
    */
   bool sensorUpdate(pf_t * pf, LaserData * data);
 
+  /*
+   * @brief Set the ranges precomputed over the map, looked up rather than ray casting
+   * each beam of each particle
+   * @param range_table Table of the map of the model, or null to ray cast
+   */
+  void setRangeTable(std::shared_ptr<const MapRangeTable> range_table);
+
 private:
   static double sensorFunction(LaserData * data, pf_sample_set_t * set);
   double z_short_;
   double z_max_;
   double lambda_short_;
   double chi_outlier_;
+  std::shared_ptr<const MapRangeTable> range_table_;
 };
 
 /*
@@ -23,6 +23,11 @@
 #include "nav2_amcl/amcl_node.hpp"
 
 #include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
 #include <memory>
 #include <string>
 #include <utility>
@@ -62,6 +67,11 @@ AmclNode::AmclNode(const rclcpp::NodeOptions & options)
 {
   RCLCPP_INFO(get_logger(), "Creating");
 
+  add_parameter(
+    "adaptive_beam_selection", rclcpp::ParameterValue(false),
+    "Whether the likelihood field models pick the beams of each scan where it bends the most "
+    "along with evenly spread ones, rather than every max_beams-th beam");
+
   add_parameter(
     "alpha1", rclcpp::ParameterValue(0.2),
     "This is the alpha1 parameter", "These are additional constraints for alpha1");
@@ -86,6 +96,21 @@ AmclNode::AmclNode(const rclcpp::NodeOptions & options)
     "base_frame_id", rclcpp::ParameterValue(std::string("base_footprint")),
     "Which frame to use for the robot base");
 
+  add_parameter(
+    "batch_laser_updates", rclcpp::ParameterValue(false),
+    "Whether to weight the particles with the scans of all scanners since the robot moved "
+    "before resampling them once, rather than resampling after the scan of each scanner");
+
+  add_parameter(
+    "beam_range_table_bins", rclcpp::ParameterValue(0),
+    "Number of headings of the ranges the beam model precomputes from each map cell "
+    "when a map is received, 0 to ray cast each beam instead");
+
+  add_parameter(
+    "beam_range_table_cache", rclcpp::ParameterValue(std::string("")),
+    "File the beam model range table is loaded from if saved there for the same map, "
+    "and saved to once built, empty to always build it");
+
   add_parameter("beam_skip_distance", rclcpp::ParameterValue(0.5));
   add_parameter("beam_skip_error_threshold", rclcpp::ParameterValue(0.9));
   add_parameter("beam_skip_threshold", rclcpp::ParameterValue(0.3));
@@ -95,10 +120,26 @@ AmclNode::AmclNode(const rclcpp::NodeOptions & options)
     "global_frame_id", rclcpp::ParameterValue(std::string("map")),
     "The name of the coordinate frame published by the localization system");
 
+  add_parameter(
+    "global_localization_factor", rclcpp::ParameterValue(0),
+    "Downsampling factor of the likelihood field a global localization request matches the "
+    "next scan against, before seeding the particles around the best poses at full "
+    "resolution, 0 to spread them uniformly over the map instead");
+
+  add_parameter(
+    "global_localization_hypotheses", rclcpp::ParameterValue(10),
+    "Number of poses matching the scan the particles are seeded around, by a coarse-to-fine "
+    "global localization");
+
   add_parameter(
     "lambda_short", rclcpp::ParameterValue(0.1),
     "Exponential decay parameter for z_short part of model");
 
+  add_parameter(
+    "laser_batch_window", rclcpp::ParameterValue(0.1),
+    "With batch_laser_updates, time in seconds after the robot moved past which the scanners "
+    "not yet received are left for the next update");
+
   add_parameter(
     "laser_likelihood_max_dist", rclcpp::ParameterValue(2.0),
     "Maximum distance to do obstacle inflation on map, for use in likelihood_field model");
@@ -118,6 +159,10 @@ AmclNode::AmclNode(const rclcpp::NodeOptions & options)
     "Which model to use, either beam, likelihood_field, or likelihood_field_prob",
     "Same as likelihood_field but incorporates the beamskip feature, if enabled");
 
+  add_parameter(
+    "laser_model_threads", rclcpp::ParameterValue(1),
+    "Number of threads weighting the particles in each laser update, 0 to use one per core");
+
   add_parameter(
     "set_initial_pose", rclcpp::ParameterValue(false),
     "Causes AMCL to set initial pose from the initial_pose* parameters instead of "
@@ -151,13 +196,49 @@ AmclNode::AmclNode(const rclcpp::NodeOptions & options)
     "min_particles", rclcpp::ParameterValue(500),
     "Maximum allowed number of particles");
 
+  add_parameter(
+    "motion_model_seed", rclcpp::ParameterValue(-1),
+    "Seed of the odometry noise of the motion model, so that benchmark runs are reproducible",
+    "Negative to seed it from the time");
+
   add_parameter(
     "odom_frame_id", rclcpp::ParameterValue(std::string("odom")),
     "Which frame to use for odometry");
 
+  add_parameter(
+    "odom_topic", rclcpp::ParameterValue(std::string("odom")),
+    "Odometry topic the pose is published at the rate of, with publish_odom_rate_pose");
+
+  add_parameter(
+    "particle_checkpoint_file", rclcpp::ParameterValue(std::string("")),
+    "File the particle set is periodically saved to, and restored from on activation when "
+    "saved for the same map and no initial pose is set, empty to disable");
+
+  add_parameter(
+    "particle_checkpoint_rate", rclcpp::ParameterValue(0.2),
+    "Maximum rate in Hz at which the particle set is saved to particle_checkpoint_file");
+
+  add_parameter(
+    "particle_cloud_clusters", rclcpp::ParameterValue(false),
+    "Whether to publish the mean of each particle cluster, weighted by the cluster, "
+    "instead of the particles themselves");
+
+  add_parameter(
+    "particle_cloud_max_count", rclcpp::ParameterValue(0),
+    "Maximum number of particles published, evenly picked from the set, 0 for all of them");
+
+  add_parameter(
+    "particle_cloud_max_rate", rclcpp::ParameterValue(0.0),
+    "Maximum rate in Hz of the particle cloud, 0 to publish it on every filter update");
+
   add_parameter("pf_err", rclcpp::ParameterValue(0.05));
   add_parameter("pf_z", rclcpp::ParameterValue(0.99));
 
+  add_parameter(
+    "publish_odom_rate_pose", rclcpp::ParameterValue(false),
+    "Whether to publish the pose at the rate of the odometry on amcl_pose_odom_rate, composing "
+    "the odometry with the map to odom transform of the latest filter update");
+
   add_parameter(
     "recovery_alpha_fast", rclcpp::ParameterValue(0.0),
     "Exponential decay rate for the fast average weight filter, used in deciding when to recover "
@@ -244,6 +325,11 @@ AmclNode::on_configure(const rclcpp_lifecycle::State & /*state*/)
   initPubSub();
   initServices();
   initOdometry();
+  instrumentation_pub_ = std::make_unique<nav2_util::InstrumentationPublisher>(
+    shared_from_this(), std::vector<std::string>{"amcl."});
+  map_memory_ = std::make_unique<nav2_util::MemoryAccount>("amcl.map");
+  particle_memory_ = std::make_unique<nav2_util::MemoryAccount>("amcl.particles");
+  updateMemoryAccounts();
 
   return nav2_util::CallbackReturn::SUCCESS;
 }
@@ -255,9 +341,14 @@ AmclNode::on_activate(const rclcpp_lifecycle::State & /*state*/)
 
   // Lifecycle publishers must be explicitly activated
   pose_pub_->on_activate();
+  if (odom_rate_pose_pub_) {
+    odom_rate_pose_pub_->on_activate();
+  }
   particle_cloud_pub_->on_activate();
+  instrumentation_pub_->activate();
 
   first_pose_sent_ = false;
+  particle_checkpoint_pending_ = !particle_checkpoint_file_.empty();
 
   // Keep track of whether we're in the active state. We won't
   // process incoming callbacks until we are
@@ -293,7 +384,11 @@ AmclNode::on_deactivate(const rclcpp_lifecycle::State & /*state*/)
 
   // Lifecycle publishers must be explicitly deactivated
   pose_pub_->on_deactivate();
+  if (odom_rate_pose_pub_) {
+    odom_rate_pose_pub_->on_deactivate();
+  }
   particle_cloud_pub_->on_deactivate();
+  instrumentation_pub_->deactivate();
 
   // destroy bond connection
   destroyBond();
@@ -311,17 +406,29 @@ AmclNode::on_cleanup(const rclcpp_lifecycle::State & /*state*/)
   global_loc_srv_.reset();
   nomotion_update_srv_.reset();
   initial_pose_sub_.reset();
+  odom_thread_.reset();
+  odom_sub_.reset();
+  odom_callback_group_.reset();
+  instrumentation_pub_.reset();
+  map_memory_.reset();
+  particle_memory_.reset();
+  map_update_sub_.reset();
   laser_scan_connection_.disconnect();
   laser_scan_filter_.reset();
   laser_scan_sub_.reset();
 
+  // Finish writing the last checkpoint
+  if (particle_checkpoint_write_.valid()) {
+    particle_checkpoint_write_.wait();
+  }
+
   // Map
   if (map_ != NULL) {
     map_free(map_);
     map_ = nullptr;
   }
   first_map_received_ = false;
-  free_space_indices.resize(0);
+  free_space_index.clear();
 
   // Transforms
   tf_broadcaster_.reset();
@@ -330,6 +437,8 @@ AmclNode::on_cleanup(const rclcpp_lifecycle::State & /*state*/)
 
   // PubSub
   pose_pub_.reset();
+  odom_rate_pose_pub_.reset();
+  std::atomic_store(&map_to_odom_snapshot_, std::shared_ptr<const tf2::Transform>());
   particle_cloud_pub_.reset();
 
   // Odometry
@@ -385,7 +494,7 @@ AmclNode::checkElapsedTime(std::chrono::seconds check_interval, rclcpp::Time las
 }
 
 #if NEW_UNIFORM_SAMPLING
-std::vector<std::pair<int, int>> AmclNode::free_space_indices;
+nav2_amcl::MapFreeSpace AmclNode::free_space_index;
 #endif
 
 bool
@@ -426,11 +535,12 @@ AmclNode::uniformPoseGenerator(void * arg)
   map_t * map = reinterpret_cast<map_t *>(arg);
 
 #if NEW_UNIFORM_SAMPLING
-  unsigned int rand_index = drand48() * free_space_indices.size();
-  std::pair<int, int> free_point = free_space_indices[rand_index];
+  const int64_t rand_index = drand48() * free_space_index.size();
+  int i, j;
+  free_space_index.getCell(rand_index, i, j);
   pf_vector_t p;
-  p.v[0] = MAP_WXGX(map, free_point.first);
-  p.v[1] = MAP_WYGY(map, free_point.second);
+  p.v[0] = MAP_WXGX(map, i);
+  p.v[1] = MAP_WYGY(map, j);
   p.v[2] = drand48() * 2 * M_PI - M_PI;
 #else
   double min_x, max_x, min_y, max_y;
@@ -475,6 +585,46 @@ AmclNode::globalLocalizationCallback(
   RCLCPP_INFO(get_logger(), "Global initialisation done!");
   initial_pose_is_known_ = true;
   pf_init_ = false;
+  std::atomic_store(&map_to_odom_snapshot_, std::shared_ptr<const tf2::Transform>());
+
+  // The uniform distribution holds until the next scan is matched over the map
+  global_localization_pending_ = global_localization_factor_ > 0;
+}
+
+void
+AmclNode::seedGlobalHypotheses(nav2_amcl::Laser * laser, nav2_amcl::LaserData * data)
+{
+  auto start = std::chrono::steady_clock::now();
+  if (!laser->findGlobalPoses(
+      data, global_localization_factor_, global_localization_hypotheses_,
+      global_hypotheses_.poses, global_hypotheses_.spread))
+  {
+    RCLCPP_WARN(
+      get_logger(), "Coarse-to-fine global localization needs a likelihood field model and "
+      "a scan with valid ranges, keeping the uniform distribution");
+    return;
+  }
+
+  pf_init_model(
+    pf_, (pf_init_model_fn_t)AmclNode::hypothesesPoseGenerator,
+    reinterpret_cast<void *>(&global_hypotheses_));
+  RCLCPP_INFO(
+    get_logger(), "Seeded the particles around %zu poses matching the scan in %.3f s",
+    global_hypotheses_.poses.size(),
+    std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count());
+}
+
+pf_vector_t
+AmclNode::hypothesesPoseGenerator(void * arg)
+{
+  GlobalHypotheses * hypotheses = reinterpret_cast<GlobalHypotheses *>(arg);
+  const int count = hypotheses->poses.size();
+  const pf_vector_t & pose = hypotheses->poses[std::min<int>(drand48() * count, count - 1)];
+  pf_vector_t p;
+  p.v[0] = pose.v[0] + pf_ran_gaussian(hypotheses->spread.v[0]);
+  p.v[1] = pose.v[1] + pf_ran_gaussian(hypotheses->spread.v[1]);
+  p.v[2] = angleutils::normalize(pose.v[2] + pf_ran_gaussian(hypotheses->spread.v[2]));
+  return p;
 }
 
 // force nomotion updates (amcl updating without requiring motion)
@@ -585,12 +735,14 @@ AmclNode::handleInitialPose(geometry_msgs::msg::PoseWithCovarianceStamped & msg)
   pf_init_ = false;
   init_pose_received_on_inactive = false;
   initial_pose_is_known_ = true;
+  std::atomic_store(&map_to_odom_snapshot_, std::shared_ptr<const tf2::Transform>());
 }
 
 void
 AmclNode::laserReceived(sensor_msgs::msg::LaserScan::ConstSharedPtr laser_scan)
 {
   std::lock_guard<std::mutex> lock(pf_mutex_);
+  NAV2_PROBE_SCOPE("amcl.laser_received");
 
   // Since the sensor data is continually being published by the simulator or robot,
   // we don't want our callbacks to fire until we're in the active state
@@ -618,6 +770,15 @@ AmclNode::laserReceived(sensor_msgs::msg::LaserScan::ConstSharedPtr laser_scan)
     laser_index = frame_to_laser_[laser_scan->header.frame_id];
   }
 
+  // Resume from the particles of a previous run, unless given a pose since
+  if (particle_checkpoint_pending_) {
+    particle_checkpoint_pending_ = false;
+    if (!initial_pose_is_known_ && restoreParticleCheckpoint()) {
+      initial_pose_is_known_ = true;
+      pf_init_ = false;
+    }
+  }
+
   // Where was the robot when this scan was taken?
   pf_vector_t pose;
   if (!getOdomPose(
@@ -638,6 +799,7 @@ AmclNode::laserReceived(sensor_msgs::msg::LaserScan::ConstSharedPtr laser_scan)
     for (unsigned int i = 0; i < lasers_update_.size(); i++) {
       lasers_update_[i] = true;
     }
+    batch_start_time_ = now();
 
     force_publication = true;
     resample_count_ = 0;
@@ -647,9 +809,16 @@ AmclNode::laserReceived(sensor_msgs::msg::LaserScan::ConstSharedPtr laser_scan)
       for (unsigned int i = 0; i < lasers_update_.size(); i++) {
         lasers_update_[i] = true;
       }
+      batch_start_time_ = now();
     }
     if (lasers_update_[laser_index]) {
+      NAV2_PROBE_SCOPE("amcl.motion_update");
+      auto motion_start = std::chrono::steady_clock::now();
       motion_model_->odometryUpdate(pf_, pose, delta);
+      RCLCPP_DEBUG(
+        get_logger(), "Motion update took %.3f ms",
+        std::chrono::duration<double, std::milli>(
+          std::chrono::steady_clock::now() - motion_start).count());
     }
     force_update_ = false;
   }
@@ -657,13 +826,42 @@ AmclNode::laserReceived(sensor_msgs::msg::LaserScan::ConstSharedPtr laser_scan)
   bool resampled = false;
 
   // If the robot has moved, update the filter
-  if (lasers_update_[laser_index]) {
+  const bool updated = lasers_update_[laser_index];
+  if (updated) {
+    auto sensor_start = std::chrono::steady_clock::now();
     updateFilter(laser_index, laser_scan, pose);
+    RCLCPP_DEBUG(
+      get_logger(), "Sensor update of laser %d took %.3f ms", laser_index,
+      std::chrono::duration<double, std::milli>(
+        std::chrono::steady_clock::now() - sensor_start).count());
+  }
+
+  // When batching, the weights multiply over the scans of all scanners since the robot
+  // moved, the same as a single update from all of their beams, and the set is only
+  // resampled once all of them were weighted or, on a scan of any scanner, once the batch
+  // window is over, so that a scanner no longer publishing doesn't hold the batch open
+  bool batch_done = updated;
+  if (batch_laser_updates_) {
+    const bool pending =
+      std::any_of(lasers_update_.begin(), lasers_update_.end(), [](bool u) {return u;});
+    batch_done = (updated && !pending) ||
+      (pending && (now() - batch_start_time_).seconds() >= laser_batch_window_);
+    if (batch_done) {
+      std::fill(lasers_update_.begin(), lasers_update_.end(), false);
+    }
+  }
 
+  if (batch_done) {
     // Resample the particles
     if (!(++resample_count_ % resample_interval_)) {
+      NAV2_PROBE_SCOPE("amcl.resample");
+      auto resample_start = std::chrono::steady_clock::now();
       pf_update_resample(pf_);
       resampled = true;
+      RCLCPP_DEBUG(
+        get_logger(), "Resampling took %.3f ms",
+        std::chrono::duration<double, std::milli>(
+          std::chrono::steady_clock::now() - resample_start).count());
     }
 
     pf_sample_set_t * set = pf_->sets + pf_->current_set;
@@ -701,6 +899,10 @@ AmclNode::laserReceived(sensor_msgs::msg::LaserScan::ConstSharedPtr laser_scan)
       sendMapToOdomTransform(transform_expiration);
     }
   }
+
+  if (!particle_checkpoint_file_.empty() && initial_pose_is_known_) {
+    saveParticleCheckpoint();
+  }
 }
 
 bool AmclNode::addNewScanner(
@@ -757,6 +959,7 @@ bool AmclNode::updateFilter(
   const sensor_msgs::msg::LaserScan::ConstSharedPtr & laser_scan,
   const pf_vector_t & pose)
 {
+  NAV2_PROBE_SCOPE("amcl.sensor_update");
   nav2_amcl::LaserData ldata;
   ldata.laser = lasers_[laser_index];
   ldata.range_count = laser_scan->ranges.size();
@@ -818,6 +1021,10 @@ bool AmclNode::updateFilter(
     ldata.ranges[i][1] = angle_min +
       (i * angle_increment);
   }
+  if (global_localization_pending_) {
+    global_localization_pending_ = false;
+    seedGlobalHypotheses(lasers_[laser_index], &ldata);
+  }
   lasers_[laser_index]->sensorUpdate(pf_, reinterpret_cast<nav2_amcl::LaserData *>(&ldata));
   lasers_update_[laser_index] = false;
   pf_odom_pose_ = pose;
@@ -829,18 +1036,52 @@ AmclNode::publishParticleCloud(const pf_sample_set_t * set)
 {
   // If initial pose is not known, AMCL does not know the current pose
   if (!initial_pose_is_known_) {return;}
+
+  // The cloud is a debugging stream, only built for subscribers and at most at its rate
+  if (particle_cloud_pub_->get_subscription_count() == 0) {return;}
+  auto now_steady = std::chrono::steady_clock::now();
+  if (particle_cloud_max_rate_ > 0.0 &&
+    now_steady - last_particle_cloud_time_ <
+    std::chrono::duration<double>(1.0 / particle_cloud_max_rate_))
+  {
+    return;
+  }
+  last_particle_cloud_time_ = now_steady;
+
   auto cloud_with_weights_msg = std::make_unique<nav2_msgs::msg::ParticleCloud>();
   cloud_with_weights_msg->header.stamp = this->now();
   cloud_with_weights_msg->header.frame_id = global_frame_id_;
-  cloud_with_weights_msg->particles.resize(set->sample_count);
 
-  for (int i = 0; i < set->sample_count; i++) {
-    cloud_with_weights_msg->particles[i].pose.position.x = set->samples[i].pose.v[0];
-    cloud_with_weights_msg->particles[i].pose.position.y = set->samples[i].pose.v[1];
-    cloud_with_weights_msg->particles[i].pose.position.z = 0;
-    cloud_with_weights_msg->particles[i].pose.orientation = orientationAroundZAxis(
+  if (particle_cloud_clusters_) {
+    cloud_with_weights_msg->particles.resize(set->cluster_count);
+    for (int i = 0; i < set->cluster_count; i++) {
+      cloud_with_weights_msg->particles[i].pose.position.x = set->clusters[i].mean.v[0];
+      cloud_with_weights_msg->particles[i].pose.position.y = set->clusters[i].mean.v[1];
+      cloud_with_weights_msg->particles[i].pose.position.z = 0;
+      cloud_with_weights_msg->particles[i].pose.orientation = orientationAroundZAxis(
+        set->clusters[i].mean.v[2]);
+      cloud_with_weights_msg->particles[i].weight = set->clusters[i].weight;
+    }
+    particle_cloud_pub_->publish(std::move(cloud_with_weights_msg));
+    return;
+  }
+
+  // Particles are picked at an even stride, their weights scaled to keep the same total
+  int count = set->sample_count;
+  if (particle_cloud_max_count_ > 0 && particle_cloud_max_count_ < count) {
+    count = particle_cloud_max_count_;
+  }
+  const double weight_scale = static_cast<double>(set->sample_count) / count;
+  cloud_with_weights_msg->particles.resize(count);
+
+  for (int n = 0; n < count; n++) {
+    const int i = static_cast<int64_t>(n) * set->sample_count / count;
+    cloud_with_weights_msg->particles[n].pose.position.x = set->samples[i].pose.v[0];
+    cloud_with_weights_msg->particles[n].pose.position.y = set->samples[i].pose.v[1];
+    cloud_with_weights_msg->particles[n].pose.position.z = 0;
+    cloud_with_weights_msg->particles[n].pose.orientation = orientationAroundZAxis(
       set->samples[i].pose.v[2]);
-    cloud_with_weights_msg->particles[i].weight = set->samples[i].weight;
+    cloud_with_weights_msg->particles[n].weight = set->samples[i].weight * weight_scale;
   }
 
   particle_cloud_pub_->publish(std::move(cloud_with_weights_msg));
@@ -974,6 +1215,35 @@ AmclNode::calculateMaptoOdomTransform(
 
   tf2::impl::Converter<true, false>::convert(odom_to_map.pose, latest_tf_);
   latest_tf_valid_ = true;
+  if (initial_pose_is_known_) {
+    std::atomic_store(
+      &map_to_odom_snapshot_, std::make_shared<const tf2::Transform>(latest_tf_.inverse()));
+  }
+}
+
+void
+AmclNode::odomReceived(nav_msgs::msg::Odometry::ConstSharedPtr msg)
+{
+  if (!active_) {return;}
+  auto map_to_odom = std::atomic_load(&map_to_odom_snapshot_);
+  if (!map_to_odom) {return;}
+  if (nav2_util::strip_leading_slash(msg->header.frame_id) != odom_frame_id_) {
+    RCLCPP_WARN_THROTTLE(
+      get_logger(), *get_clock(), 2000,
+      "Ignoring odometry in frame \"%s\"; the odometry frame is \"%s\"",
+      msg->header.frame_id.c_str(), odom_frame_id_.c_str());
+    return;
+  }
+
+  tf2::Transform odom_to_base;
+  tf2::impl::Converter<true, false>::convert(msg->pose.pose, odom_to_base);
+  tf2::Transform map_to_base = *map_to_odom * odom_to_base;
+
+  auto p = std::make_unique<geometry_msgs::msg::PoseStamped>();
+  p->header.frame_id = global_frame_id_;
+  p->header.stamp = msg->header.stamp;
+  tf2::toMsg(map_to_base, p->pose);
+  odom_rate_pose_pub_->publish(std::move(p));
 }
 
 void
@@ -989,27 +1259,164 @@ AmclNode::sendMapToOdomTransform(const tf2::TimePoint & transform_expiration)
   tf_broadcaster_->sendTransform(tmp_tf_stamped);
 }
 
+namespace
+{
+
+// Header of the particle checkpoints, versioned with the layout of the file
+const char particle_checkpoint_magic[8] = {'A', 'M', 'C', 'L', 'P', 'F', '0', '1'};
+
+/*
+ * @struct ParticleCheckpoint
+ * @brief Poses and weights of a particle set, with the signature of its map
+ */
+struct ParticleCheckpoint
+{
+  uint64_t map_signature;
+  std::vector<double> x, y, yaw, weight;
+};
+
+}  // namespace
+
+void
+AmclNode::saveParticleCheckpoint()
+{
+  auto now_steady = std::chrono::steady_clock::now();
+  if (now_steady - last_particle_checkpoint_time_ <
+    std::chrono::duration<double>(1.0 / particle_checkpoint_rate_))
+  {
+    return;
+  }
+  if (particle_checkpoint_write_.valid() &&
+    particle_checkpoint_write_.wait_for(0s) != std::future_status::ready)
+  {
+    return;
+  }
+  if (particle_checkpoint_write_.valid() && !particle_checkpoint_write_.get()) {
+    RCLCPP_WARN(
+      get_logger(), "Failed to write the particle checkpoint to %s",
+      particle_checkpoint_file_.c_str());
+  }
+  last_particle_checkpoint_time_ = now_steady;
+
+  // Only the copy of the set is made here, the file is written from another thread
+  auto checkpoint = std::make_shared<ParticleCheckpoint>();
+  checkpoint->map_signature = map_signature_;
+  pf_sample_set_t * set = pf_->sets + pf_->current_set;
+  checkpoint->x.resize(set->sample_count);
+  checkpoint->y.resize(set->sample_count);
+  checkpoint->yaw.resize(set->sample_count);
+  checkpoint->weight.resize(set->sample_count);
+  for (int i = 0; i < set->sample_count; i++) {
+    checkpoint->x[i] = set->samples[i].pose.v[0];
+    checkpoint->y[i] = set->samples[i].pose.v[1];
+    checkpoint->yaw[i] = set->samples[i].pose.v[2];
+    checkpoint->weight[i] = set->samples[i].weight;
+  }
+
+  particle_checkpoint_write_ = std::async(
+    std::launch::async, [checkpoint, path = particle_checkpoint_file_]() {
+      // Written aside then renamed, so that a crash never leaves a partial checkpoint
+      const std::string tmp_path = path + ".tmp";
+      {
+        std::ofstream file(tmp_path, std::ios::binary | std::ios::trunc);
+        const uint64_t count = checkpoint->x.size();
+        file.write(particle_checkpoint_magic, sizeof(particle_checkpoint_magic));
+        file.write(
+          reinterpret_cast<const char *>(&checkpoint->map_signature),
+          sizeof(checkpoint->map_signature));
+        file.write(reinterpret_cast<const char *>(&count), sizeof(count));
+        for (const auto * values : {&checkpoint->x, &checkpoint->y, &checkpoint->yaw,
+            &checkpoint->weight})
+        {
+          file.write(reinterpret_cast<const char *>(values->data()), count * sizeof(double));
+        }
+        if (!file) {
+          return false;
+        }
+      }
+      return std::rename(tmp_path.c_str(), path.c_str()) == 0;
+    });
+}
+
+bool
+AmclNode::restoreParticleCheckpoint()
+{
+  std::ifstream file(particle_checkpoint_file_, std::ios::binary);
+  if (!file) {
+    return false;
+  }
+  char magic[sizeof(particle_checkpoint_magic)];
+  ParticleCheckpoint checkpoint;
+  uint64_t count;
+  file.read(magic, sizeof(magic));
+  file.read(
+    reinterpret_cast<char *>(&checkpoint.map_signature), sizeof(checkpoint.map_signature));
+  file.read(reinterpret_cast<char *>(&count), sizeof(count));
+  if (!file || memcmp(magic, particle_checkpoint_magic, sizeof(magic)) != 0 || count == 0 ||
+    count > static_cast<uint64_t>(max_particles_))
+  {
+    RCLCPP_WARN(
+      get_logger(), "Ignoring the invalid particle checkpoint %s",
+      particle_checkpoint_file_.c_str());
+    return false;
+  }
+  if (checkpoint.map_signature != map_signature_) {
+    RCLCPP_INFO(
+      get_logger(), "Ignoring the particle checkpoint %s, saved for another map",
+      particle_checkpoint_file_.c_str());
+    return false;
+  }
+  for (auto * values : {&checkpoint.x, &checkpoint.y, &checkpoint.yaw, &checkpoint.weight}) {
+    values->resize(count);
+    file.read(reinterpret_cast<char *>(values->data()), count * sizeof(double));
+  }
+  if (!file) {
+    RCLCPP_WARN(
+      get_logger(), "Ignoring the truncated particle checkpoint %s",
+      particle_checkpoint_file_.c_str());
+    return false;
+  }
+
+  std::vector<pf_vector_t> poses(count);
+  for (uint64_t i = 0; i < count; i++) {
+    poses[i] = pf_vector_zero();
+    poses[i].v[0] = checkpoint.x[i];
+    poses[i].v[1] = checkpoint.y[i];
+    poses[i].v[2] = checkpoint.yaw[i];
+  }
+  pf_init_samples(pf_, poses.data(), checkpoint.weight.data(), static_cast<int>(count));
+  RCLCPP_INFO(
+    get_logger(), "Restored %zu particles from %s", poses.size(),
+    particle_checkpoint_file_.c_str());
+  return true;
+}
+
 nav2_amcl::Laser *
 AmclNode::createLaserObject()
 {
   RCLCPP_INFO(get_logger(), "createLaserObject");
 
+  nav2_amcl::Laser * laser;
   if (sensor_model_type_ == "beam") {
-    return new nav2_amcl::BeamModel(
+    auto beam_model = new nav2_amcl::BeamModel(
       z_hit_, z_short_, z_max_, z_rand_, sigma_hit_, lambda_short_,
       0.0, max_beams_, map_);
-  }
-
-  if (sensor_model_type_ == "likelihood_field_prob") {
-    return new nav2_amcl::LikelihoodFieldModelProb(
+    beam_model->setRangeTable(range_table_);
+    laser = beam_model;
+  } else if (sensor_model_type_ == "likelihood_field_prob") {
+    laser = new nav2_amcl::LikelihoodFieldModelProb(
       z_hit_, z_rand_, sigma_hit_,
       laser_likelihood_max_dist_, do_beamskip_, beam_skip_distance_, beam_skip_threshold_,
       beam_skip_error_threshold_, max_beams_, map_);
+  } else {
+    laser = new nav2_amcl::LikelihoodFieldModel(
+      z_hit_, z_rand_, sigma_hit_,
+      laser_likelihood_max_dist_, max_beams_, map_);
   }
 
-  return new nav2_amcl::LikelihoodFieldModel(
-    z_hit_, z_rand_, sigma_hit_,
-    laser_likelihood_max_dist_, max_beams_, map_);
+  laser->setThreadCount(laser_model_threads_);
+  laser->setAdaptiveBeamSelection(adaptive_beam_selection_);
+  return laser;
 }
 
 void
@@ -1018,22 +1425,30 @@ AmclNode::initParameters()
   double save_pose_rate;
   double tmp_tol;
 
+  get_parameter("adaptive_beam_selection", adaptive_beam_selection_);
   get_parameter("alpha1", alpha1_);
   get_parameter("alpha2", alpha2_);
   get_parameter("alpha3", alpha3_);
   get_parameter("alpha4", alpha4_);
   get_parameter("alpha5", alpha5_);
   get_parameter("base_frame_id", base_frame_id_);
+  get_parameter("batch_laser_updates", batch_laser_updates_);
+  get_parameter("beam_range_table_bins", beam_range_table_bins_);
+  get_parameter("beam_range_table_cache", beam_range_table_cache_);
   get_parameter("beam_skip_distance", beam_skip_distance_);
   get_parameter("beam_skip_error_threshold", beam_skip_error_threshold_);
   get_parameter("beam_skip_threshold", beam_skip_threshold_);
   get_parameter("do_beamskip", do_beamskip_);
   get_parameter("global_frame_id", global_frame_id_);
+  get_parameter("global_localization_factor", global_localization_factor_);
+  get_parameter("global_localization_hypotheses", global_localization_hypotheses_);
   get_parameter("lambda_short", lambda_short_);
+  get_parameter("laser_batch_window", laser_batch_window_);
   get_parameter("laser_likelihood_max_dist", laser_likelihood_max_dist_);
   get_parameter("laser_max_range", laser_max_range_);
   get_parameter("laser_min_range", laser_min_range_);
   get_parameter("laser_model_type", sensor_model_type_);
+  get_parameter("laser_model_threads", laser_model_threads_);
   get_parameter("set_initial_pose", set_initial_pose_);
   get_parameter("initial_pose.x", initial_pose_x_);
   get_parameter("initial_pose.y", initial_pose_y_);
@@ -1042,9 +1457,17 @@ AmclNode::initParameters()
   get_parameter("max_beams", max_beams_);
   get_parameter("max_particles", max_particles_);
   get_parameter("min_particles", min_particles_);
+  get_parameter("motion_model_seed", motion_model_seed_);
   get_parameter("odom_frame_id", odom_frame_id_);
+  get_parameter("odom_topic", odom_topic_);
+  get_parameter("particle_checkpoint_file", particle_checkpoint_file_);
+  get_parameter("particle_checkpoint_rate", particle_checkpoint_rate_);
+  get_parameter("particle_cloud_clusters", particle_cloud_clusters_);
+  get_parameter("particle_cloud_max_count", particle_cloud_max_count_);
+  get_parameter("particle_cloud_max_rate", particle_cloud_max_rate_);
   get_parameter("pf_err", pf_err_);
   get_parameter("pf_z", pf_z_);
+  get_parameter("publish_odom_rate_pose", publish_odom_rate_pose_);
   get_parameter("recovery_alpha_fast", alpha_fast_);
   get_parameter("recovery_alpha_slow", alpha_slow_);
   get_parameter("resample_interval", resample_interval_);
@@ -1080,6 +1503,37 @@ AmclNode::initParameters()
       " this isn't allowed so it will be set to default value 2.0.");
     laser_likelihood_max_dist_ = 2.0;
   }
+  if (laser_model_threads_ < 0) {
+    RCLCPP_WARN(
+      get_logger(), "You've set laser_model_threads to be negative,"
+      " this isn't allowed so it will be set to default value 1.");
+    laser_model_threads_ = 1;
+  }
+  if (global_localization_factor_ < 0) {
+    RCLCPP_WARN(
+      get_logger(), "You've set global_localization_factor to be negative,"
+      " this isn't allowed so it will be set to default value 0.");
+    global_localization_factor_ = 0;
+  }
+  if (global_localization_hypotheses_ < 1) {
+    RCLCPP_WARN(
+      get_logger(), "You've set global_localization_hypotheses to be less than 1,"
+      " this isn't allowed so it will be set to default value 10.");
+    global_localization_hypotheses_ = 10;
+  }
+  if (particle_checkpoint_rate_ <= 0.0) {
+    RCLCPP_WARN(
+      get_logger(), "You've set particle_checkpoint_rate to be non positive,"
+      " this isn't allowed so it will be set to default value 0.2.");
+    particle_checkpoint_rate_ = 0.2;
+  }
+  if (beam_range_table_bins_ < 0) {
+    RCLCPP_WARN(
+      get_logger(), "You've set beam_range_table_bins to be negative,"
+      " this isn't allowed so it will be set to default value 0.");
+    beam_range_table_bins_ = 0;
+  }
+
   if (max_particles_ < 0) {
     RCLCPP_WARN(
       get_logger(), "You've set max_particles to be negtive,"
@@ -1114,7 +1568,7 @@ AmclNode::initParameters()
 }
 
 void
-AmclNode::mapReceived(const nav_msgs::msg::OccupancyGrid::SharedPtr msg)
+AmclNode::mapReceived(const nav_msgs::msg::OccupancyGrid::ConstSharedPtr msg)
 {
   RCLCPP_DEBUG(get_logger(), "AmclNode: A new map was received.");
   if (first_map_only_ && first_map_received_) {
@@ -1143,6 +1597,73 @@ AmclNode::handleMapMessage(const nav_msgs::msg::OccupancyGrid & msg)
   }
   freeMapDependentMemory();
   map_ = convertMap(msg);
+  map_signature_ = map_signature(map_);
+  createRangeTable();
+
+#if NEW_UNIFORM_SAMPLING
+  createFreeSpaceVector();
+#endif
+  updateMemoryAccounts();
+}
+
+void
+AmclNode::mapUpdateReceived(const map_msgs::msg::OccupancyGridUpdate::SharedPtr msg)
+{
+  RCLCPP_DEBUG(get_logger(), "AmclNode: A map update was received.");
+  handleMapUpdateMessage(*msg);
+}
+
+void
+AmclNode::handleMapUpdateMessage(const map_msgs::msg::OccupancyGridUpdate & msg)
+{
+  std::lock_guard<std::recursive_mutex> cfl(configuration_mutex_);
+
+  if (map_ == NULL) {
+    RCLCPP_WARN(get_logger(), "Map update ignored, no map received yet");
+    return;
+  }
+  const int64_t min_i = msg.x;
+  const int64_t min_j = msg.y;
+  const int64_t max_i = min_i + msg.width;
+  const int64_t max_j = min_j + msg.height;
+  if (min_i < 0 || min_j < 0 || max_i > map_->size_x || max_j > map_->size_y ||
+    msg.data.size() != static_cast<size_t>(msg.width) * msg.height)
+  {
+    RCLCPP_WARN(
+      get_logger(), "Map update ignored, a %u X %u patch at (%d, %d) exceeds the %d X %d map",
+      msg.width, msg.height, msg.x, msg.y, map_->size_x, map_->size_y);
+    return;
+  }
+  if (msg.header.frame_id != global_frame_id_) {
+    RCLCPP_WARN(
+      get_logger(), "Frame_id of map update received:'%s' doesn't match global_frame_id:'%s'.",
+      msg.header.frame_id.c_str(),
+      global_frame_id_.c_str());
+  }
+
+  // Convert to player format, as convertMap() does
+  size_t k = 0;
+  for (int j = min_j; j < max_j; j++) {
+    for (int i = min_i; i < max_i; i++) {
+      const int8_t value = msg.data[k++];
+      map_->cells[MAP_INDEX(map_, i, j)].occ_state =
+        value == 0 ? -1 : (value == 100 ? +1 : 0);
+    }
+  }
+
+  if (range_table_) {
+    range_table_->update(min_i, min_j, max_i, max_j);
+  }
+
+  // The likelihood field models hold the cspace of the map, only update it around the patch
+  if (!lasers_.empty() && sensor_model_type_ != "beam") {
+    int region_min_i = min_i, region_min_j = min_j;
+    int region_max_i = max_i, region_max_j = max_j;
+    map_update_cspace_region(map_, &region_min_i, &region_min_j, &region_max_i, &region_max_j);
+    for (auto & laser : lasers_) {
+      laser->updateMapRegion(region_min_i, region_min_j, region_max_i, region_max_j);
+    }
+  }
 
 #if NEW_UNIFORM_SAMPLING
   createFreeSpaceVector();
@@ -1153,14 +1674,28 @@ void
 AmclNode::createFreeSpaceVector()
 {
   // Index of free space
-  free_space_indices.resize(0);
-  for (int i = 0; i < map_->size_x; i++) {
-    for (int j = 0; j < map_->size_y; j++) {
-      if (map_->cells[MAP_INDEX(map_, i, j)].occ_state == -1) {
-        free_space_indices.push_back(std::make_pair(i, j));
-      }
-    }
+  free_space_index.build(map_);
+}
+
+void
+AmclNode::updateMemoryAccounts()
+{
+  if (!map_memory_) {
+    return;
+  }
+
+  size_t map_bytes = 0;
+  if (map_ != nullptr) {
+    map_bytes = sizeof(map_t) + sizeof(map_cell_t) * map_->size_x * map_->size_y;
   }
+  if (range_table_) {
+    map_bytes += range_table_->getMemoryUsage();
+  }
+#if NEW_UNIFORM_SAMPLING
+  map_bytes += free_space_index.getMemoryUsage();
+#endif
+  map_memory_->set(map_bytes);
+  particle_memory_->set(pf_ != nullptr ? pf_memory_usage(pf_) : 0);
 }
 
 void
@@ -1176,6 +1711,42 @@ AmclNode::freeMapDependentMemory()
   lasers_.clear();
   lasers_update_.clear();
   frame_to_laser_.clear();
+  range_table_.reset();
+}
+
+void
+AmclNode::createRangeTable()
+{
+  if (sensor_model_type_ != "beam" || beam_range_table_bins_ == 0) {
+    return;
+  }
+  if (laser_max_range_ <= 0.0) {
+    RCLCPP_WARN(
+      get_logger(), "The beam model range table needs laser_max_range to be set,"
+      " ranges will be ray cast instead.");
+    return;
+  }
+
+  range_table_ = std::make_shared<nav2_amcl::MapRangeTable>(
+    map_, beam_range_table_bins_, laser_max_range_);
+  if (!beam_range_table_cache_.empty() && range_table_->load(beam_range_table_cache_)) {
+    RCLCPP_INFO(
+      get_logger(), "Loaded the beam model range table from %s",
+      beam_range_table_cache_.c_str());
+    return;
+  }
+
+  const auto start = std::chrono::steady_clock::now();
+  range_table_->build();
+  RCLCPP_INFO(
+    get_logger(), "Built the beam model range table of %d headings in %.1f s",
+    beam_range_table_bins_,
+    std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count());
+  if (!beam_range_table_cache_.empty() && !range_table_->save(beam_range_table_cache_)) {
+    RCLCPP_WARN(
+      get_logger(), "Failed to save the beam model range table to %s",
+      beam_range_table_cache_.c_str());
+  }
 }
 
 // Convert an OccupancyGrid map message into the internal representation. This function
@@ -1263,6 +1834,26 @@ AmclNode::initPubSub()
     map_topic_, rclcpp::QoS(rclcpp::KeepLast(1)).transient_local().reliable(),
     std::bind(&AmclNode::mapReceived, this, std::placeholders::_1));
 
+  map_update_sub_ = create_subscription<map_msgs::msg::OccupancyGridUpdate>(
+    map_topic_ + "_updates", rclcpp::SystemDefaultsQoS(),
+    std::bind(&AmclNode::mapUpdateReceived, this, std::placeholders::_1));
+
+  if (publish_odom_rate_pose_) {
+    odom_rate_pose_pub_ = create_publisher<geometry_msgs::msg::PoseStamped>(
+      "amcl_pose_odom_rate", rclcpp::SystemDefaultsQoS());
+
+    odom_callback_group_ = create_callback_group(
+      rclcpp::CallbackGroupType::MutuallyExclusive, false);
+    rclcpp::SubscriptionOptions sub_options;
+    sub_options.callback_group = odom_callback_group_;
+    odom_sub_ = create_subscription<nav_msgs::msg::Odometry>(
+      odom_topic_, rclcpp::SystemDefaultsQoS(),
+      std::bind(&AmclNode::odomReceived, this, std::placeholders::_1), sub_options);
+    auto executor = std::make_shared<rclcpp::executors::SingleThreadedExecutor>();
+    executor->add_callback_group(odom_callback_group_, get_node_base_interface());
+    odom_thread_ = std::make_unique<nav2_util::NodeThread>(executor);
+  }
+
   RCLCPP_INFO(get_logger(), "Subscribed to map topic.");
 }
 
@@ -1301,6 +1892,9 @@ AmclNode::initOdometry()
 
   motion_model_ = plugin_loader_.createSharedInstance(robot_model_type_);
   motion_model_->initialize(alpha1_, alpha2_, alpha3_, alpha4_, alpha5_);
+  if (motion_model_seed_ >= 0) {
+    motion_model_->setRandomSeed(motion_model_seed_);
+  }
 
   latest_odom_pose_ = geometry_msgs::msg::PoseStamped();
 }
@@ -63,3 +63,34 @@ void map_free(map_t * map)
   free(map->cells);
   free(map);
 }
+
+
+// FNV-1a hash of a buffer, continuing from a previous hash
+static uint64_t map_hash(uint64_t hash, const void * data, size_t size)
+{
+  const unsigned char * bytes = (const unsigned char *) data;
+  size_t k;
+  for (k = 0; k < size; k++) {
+    hash = (hash ^ bytes[k]) * 1099511628211ULL;
+  }
+  return hash;
+}
+
+
+// Hash of the size, scale, origin and occupancy of a map
+uint64_t map_signature(map_t * map)
+{
+  uint64_t hash = 14695981039346656037ULL;
+  int num_cells, k;
+
+  hash = map_hash(hash, &map->size_x, sizeof(map->size_x));
+  hash = map_hash(hash, &map->size_y, sizeof(map->size_y));
+  hash = map_hash(hash, &map->scale, sizeof(map->scale));
+  hash = map_hash(hash, &map->origin_x, sizeof(map->origin_x));
+  hash = map_hash(hash, &map->origin_y, sizeof(map->origin_y));
+  num_cells = map->size_x * map->size_y;
+  for (k = 0; k < num_cells; k++) {
+    hash = map_hash(hash, &map->cells[k].occ_state, sizeof(map->cells[k].occ_state));
+  }
+  return hash;
+}
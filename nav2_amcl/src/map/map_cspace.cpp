@@ -20,129 +20,135 @@
  */
 
 #include <math.h>
-#include <stdlib.h>
-#include <string.h>
-#include <queue>
+#include <stdint.h>
+#include <algorithm>
+#include <functional>
+#include <limits>
+#include <thread>
+#include <vector>
 #include "nav2_amcl/map/map.hpp"
 
 /*
- * @class CellData
- * @brief Data about map cells
+ * @brief Run a function over contiguous chunks of [0, count) from one thread per core
+ * @param count Number of items to split
+ * @param fn Function of the first and last (exclusive) items of a chunk
  */
-class CellData
+static void parallel_for(int count, const std::function<void(int, int)> & fn)
 {
-public:
-  map_t * map_;
-  unsigned int i_, j_;
-  unsigned int src_i_, src_j_;
-};
-
-/*
- * @class CachedDistanceMap
- * @brief Cached map with distances
- */
-class CachedDistanceMap
-{
-public:
-  /*
-   * @brief CachedDistanceMap constructor
-   */
-  CachedDistanceMap(double scale, double max_dist)
-  : distances_(NULL), scale_(scale), max_dist_(max_dist)
-  {
-    cell_radius_ = max_dist / scale;
-    distances_ = new double *[cell_radius_ + 2];
-    for (int i = 0; i <= cell_radius_ + 1; i++) {
-      distances_[i] = new double[cell_radius_ + 2];
-      for (int j = 0; j <= cell_radius_ + 1; j++) {
-        distances_[i][j] = sqrt(i * i + j * j);
-      }
-    }
+  const int num_threads = std::max(
+    1, std::min(static_cast<int>(std::thread::hardware_concurrency()), count));
+  std::vector<std::thread> threads;
+  for (int t = 1; t < num_threads; t++) {
+    threads.emplace_back(
+      fn, static_cast<int>(static_cast<int64_t>(count) * t / num_threads),
+      static_cast<int>(static_cast<int64_t>(count) * (t + 1) / num_threads));
   }
-
-  /*
-   * @brief CachedDistanceMap destructor
-   */
-  ~CachedDistanceMap()
-  {
-    if (distances_) {
-      for (int i = 0; i <= cell_radius_ + 1; i++) {
-        delete[] distances_[i];
-      }
-      delete[] distances_;
-    }
+  fn(0, count / num_threads);
+  for (auto & thread : threads) {
+    thread.join();
   }
-  double ** distances_;
-  double scale_;
-  double max_dist_;
-  int cell_radius_;
-};
-
-/*
- * @brief operator<
- */
-bool operator<(const CellData & a, const CellData & b)
-{
-  return a.map_->cells[MAP_INDEX(
-             a.map_, a.i_,
-             a.j_)].occ_dist > a.map_->cells[MAP_INDEX(b.map_, b.i_, b.j_)].occ_dist;
 }
 
 /*
- * @brief get_distance_map
- * @param scale of cost information wrt distance
- * @param max_dist Maximum distance to cache from occupied information
- * @return Pointer to cached distance map
- */
-CachedDistanceMap *
-get_distance_map(double scale, double max_dist)
-{
-  static CachedDistanceMap * cdm = NULL;
-
-  if (!cdm || (cdm->scale_ != scale) || (cdm->max_dist_ != max_dist)) {
-    if (cdm) {
-      delete cdm;
-    }
-    cdm = new CachedDistanceMap(scale, max_dist);
-  }
-
-  return cdm;
-}
-
-/*
- * @brief enqueue cell data for caching
+ * @brief Update the cspace distance values of the cells of a window of the map
+ * @param map Map to update, with max_occ_dist set
+ * @param x0, y0, x1, y1 Source window [x0, x1) x [y0, y1) of the occupied cells considered
+ * @param wx0, wy0, wx1, wy1 Window of the cells updated, within the source window
+ *
+ * The distance of each cell to the nearest occupied cell is the exact euclidean
+ * distance transform of Felzenszwalb and Huttenlocher, "Distance Transforms of Sampled
+ * Functions", in time linear in the number of cells. The vertical distances to the
+ * nearest occupied cell of each column are found first, from two sweeps over the rows,
+ * then each row takes the lower envelope of the parabolas of these distances. Both
+ * passes are split across threads, over bands of columns then over rows.
  */
-void enqueue(
-  map_t * map, int i, int j,
-  int src_i, int src_j,
-  std::priority_queue<CellData> & Q,
-  CachedDistanceMap * cdm,
-  unsigned char * marked)
+static void update_cspace_window(
+  map_t * map, int x0, int y0, int x1, int y1,
+  int wx0, int wy0, int wx1, int wy1)
 {
-  if (marked[MAP_INDEX(map, i, j)]) {
-    return;
-  }
-
-  int di = abs(i - src_i);
-  int dj = abs(j - src_j);
-  double distance = cdm->distances_[di][dj];
-
-  if (distance > cdm->cell_radius_) {
-    return;
-  }
-
-  map->cells[MAP_INDEX(map, i, j)].occ_dist = distance * map->scale;
-
-  CellData cell;
-  cell.map_ = map;
-  cell.i_ = i;
-  cell.j_ = j;
-  cell.src_i_ = src_i;
-  cell.src_j_ = src_j;
-
-  Q.push(cell);
-
-  marked[MAP_INDEX(map, i, j)] = 1;
+  const int size_x = x1 - x0;
+  const int size_y = y1 - y0;
+  const int64_t unreachable = std::numeric_limits<int32_t>::max();
+  const double max_occ_dist = map->max_occ_dist;
+
+  // Cells farther than the cell radius keep the max distance
+  const int cell_radius = max_occ_dist / map->scale;
+
+  auto occupied = [&](int i, int j) {
+      return map->cells[MAP_INDEX(map, x0 + i, y0 + j)].occ_state == +1;
+    };
+
+  // Vertical distance of each cell to the nearest occupied cell of its column
+  std::vector<int32_t> column_dist(static_cast<size_t>(size_x) * size_y);
+  parallel_for(
+    size_x, [&](int i0, int in) {
+      for (int i = i0; i < in; i++) {
+        column_dist[i] = occupied(i, 0) ? 0 : unreachable;
+      }
+      for (int j = 1; j < size_y; j++) {
+        for (int i = i0; i < in; i++) {
+          int32_t above = column_dist[(j - 1) * size_x + i];
+          column_dist[j * size_x + i] =
+          occupied(i, j) ? 0 : (above == unreachable ? unreachable : above + 1);
+        }
+      }
+      for (int j = size_y - 2; j >= 0; j--) {
+        for (int i = i0; i < in; i++) {
+          int32_t below = column_dist[(j + 1) * size_x + i];
+          int32_t & dist = column_dist[j * size_x + i];
+          if (below != unreachable && below + 1 < dist) {
+            dist = below + 1;
+          }
+        }
+      }
+    });
+
+  // Squared distance of each cell of a row to the nearest occupied cell, as the lower
+  // envelope of the parabolas (i - q)^2 + column_dist(q)^2 of the cells q of the row
+  parallel_for(
+    wy1 - wy0, [&](int j0, int jn) {
+      std::vector<int> sites(size_x);
+      std::vector<double> bounds(size_x + 1);
+      for (int j = wy0 - y0 + j0; j < wy0 - y0 + jn; j++) {
+        const int32_t * g = column_dist.data() + static_cast<size_t>(j) * size_x;
+        auto height = [&](int q) {return static_cast<double>(g[q]) * g[q] + 1.0 * q * q;};
+
+        int k = -1;
+        for (int q = 0; q < size_x; q++) {
+          if (g[q] == unreachable) {
+            continue;
+          }
+          double s = -std::numeric_limits<double>::infinity();
+          while (k >= 0) {
+            s = (height(q) - height(sites[k])) / (2.0 * (q - sites[k]));
+            if (s > bounds[k]) {
+              break;
+            }
+            k--;
+          }
+          k++;
+          sites[k] = q;
+          bounds[k] = k == 0 ? -std::numeric_limits<double>::infinity() : s;
+        }
+        bounds[k + 1] = std::numeric_limits<double>::infinity();
+
+        int site = 0;
+        for (int i = wx0 - x0; i < wx1 - x0; i++) {
+          map_cell_t & cell = map->cells[MAP_INDEX(map, x0 + i, y0 + j)];
+          if (k < 0) {
+            cell.occ_dist = max_occ_dist;
+            continue;
+          }
+          while (bounds[site + 1] < i) {
+            site++;
+          }
+          const int q = sites[site];
+          const double distance =
+            sqrt(static_cast<double>(i - q) * (i - q) + static_cast<double>(g[q]) * g[q]);
+          cell.occ_dist = distance > cell_radius ? max_occ_dist : distance * map->scale;
+        }
+      }
+    });
 }
 
 /*
@@ -152,62 +158,30 @@ void enqueue(
  */
 void map_update_cspace(map_t * map, double max_occ_dist)
 {
-  unsigned char * marked;
-  std::priority_queue<CellData> Q;
-
-  marked = new unsigned char[map->size_x * map->size_y];
-  memset(marked, 0, sizeof(unsigned char) * map->size_x * map->size_y);
-
   map->max_occ_dist = max_occ_dist;
+  update_cspace_window(
+    map, 0, 0, map->size_x, map->size_y,
+    0, 0, map->size_x, map->size_y);
+}
 
-  CachedDistanceMap * cdm = get_distance_map(map->scale, map->max_occ_dist);
-
-  // Enqueue all the obstacle cells
-  CellData cell;
-  cell.map_ = map;
-  for (int i = 0; i < map->size_x; i++) {
-    cell.src_i_ = cell.i_ = i;
-    for (int j = 0; j < map->size_y; j++) {
-      if (map->cells[MAP_INDEX(map, i, j)].occ_state == +1) {
-        map->cells[MAP_INDEX(map, i, j)].occ_dist = 0.0;
-        cell.src_j_ = cell.j_ = j;
-        marked[MAP_INDEX(map, i, j)] = 1;
-        Q.push(cell);
-      } else {
-        map->cells[MAP_INDEX(map, i, j)].occ_dist = max_occ_dist;
-      }
-    }
-  }
-
-  while (!Q.empty()) {
-    CellData current_cell = Q.top();
-    if (current_cell.i_ > 0) {
-      enqueue(
-        map, current_cell.i_ - 1, current_cell.j_,
-        current_cell.src_i_, current_cell.src_j_,
-        Q, cdm, marked);
-    }
-    if (current_cell.j_ > 0) {
-      enqueue(
-        map, current_cell.i_, current_cell.j_ - 1,
-        current_cell.src_i_, current_cell.src_j_,
-        Q, cdm, marked);
-    }
-    if (static_cast<int>(current_cell.i_) < map->size_x - 1) {
-      enqueue(
-        map, current_cell.i_ + 1, current_cell.j_,
-        current_cell.src_i_, current_cell.src_j_,
-        Q, cdm, marked);
-    }
-    if (static_cast<int>(current_cell.j_) < map->size_y - 1) {
-      enqueue(
-        map, current_cell.i_, current_cell.j_ + 1,
-        current_cell.src_i_, current_cell.src_j_,
-        Q, cdm, marked);
-    }
-
-    Q.pop();
-  }
-
-  delete[] marked;
+/*
+ * @brief Update the cspace distance values around changed cells
+ * @param map Map to update, whose cspace was computed by map_update_cspace()
+ * @param min_i, min_j, max_i, max_j Window [min_i, max_i) x [min_j, max_j) of the changed
+ * cells, replaced by the window of the updated cells
+ *
+ * Only the cells within max_occ_dist of the changed cells may change their distance,
+ * and only the occupied cells within max_occ_dist of these are looked at.
+ */
+void map_update_cspace_region(map_t * map, int * min_i, int * min_j, int * max_i, int * max_j)
+{
+  const int cell_radius = map->max_occ_dist / map->scale + 1;
+  *min_i = std::max(*min_i - cell_radius, 0);
+  *min_j = std::max(*min_j - cell_radius, 0);
+  *max_i = std::max(std::min(*max_i + cell_radius, map->size_x), *min_i);
+  *max_j = std::max(std::min(*max_j + cell_radius, map->size_y), *min_j);
+  update_cspace_window(
+    map, std::max(*min_i - cell_radius, 0), std::max(*min_j - cell_radius, 0),
+    std::min(*max_i + cell_radius, map->size_x), std::min(*max_j + cell_radius, map->size_y),
+    *min_i, *min_j, *max_i, *max_j);
 }
@@ -0,0 +1,99 @@
+// Copyright (c) 2022 Samsung Research America
+//
+// This library is free software; you can redistribute it and/or
+// modify it under the terms of the GNU Lesser General Public
+// License as published by the Free Software Foundation; either
+// version 2.1 of the License, or (at your option) any later version.
+//
+// This library is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+// Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public
+// License along with this library; if not, write to the Free Software
+// Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+
+#include <stdint.h>
+#include <algorithm>
+#include <thread>
+#include <vector>
+
+#include "nav2_amcl/map/map_free_space.hpp"
+
+namespace nav2_amcl
+{
+
+void
+MapFreeSpace::build(const map_t * map)
+{
+  size_x_ = map->size_x;
+
+  // Each thread finds the runs of a band of rows, with their lengths
+  const int num_threads = std::max(
+    1, std::min(static_cast<int>(std::thread::hardware_concurrency()), map->size_y));
+  std::vector<std::vector<int>> starts(num_threads), lengths(num_threads);
+  auto find_runs = [&](int band) {
+      const int min_j = static_cast<int64_t>(map->size_y) * band / num_threads;
+      const int max_j = static_cast<int64_t>(map->size_y) * (band + 1) / num_threads;
+      for (int j = min_j; j < max_j; j++) {
+        const map_cell_t * row = map->cells + MAP_INDEX(map, 0, j);
+        int i = 0;
+        while (i < map->size_x) {
+          if (row[i].occ_state != -1) {
+            i++;
+            continue;
+          }
+          const int start = i;
+          while (i < map->size_x && row[i].occ_state == -1) {
+            i++;
+          }
+          starts[band].push_back(MAP_INDEX(map, start, j));
+          lengths[band].push_back(i - start);
+        }
+      }
+    };
+  std::vector<std::thread> threads;
+  for (int band = 1; band < num_threads; band++) {
+    threads.emplace_back(find_runs, band);
+  }
+  find_runs(0);
+  for (auto & thread : threads) {
+    thread.join();
+  }
+
+  // The bands are joined in row order, summing the lengths of the runs
+  run_starts_.clear();
+  run_ends_.clear();
+  int64_t count = 0;
+  for (int band = 0; band < num_threads; band++) {
+    run_starts_.insert(run_starts_.end(), starts[band].begin(), starts[band].end());
+    for (const int & length : lengths[band]) {
+      count += length;
+      run_ends_.push_back(count);
+    }
+  }
+  run_starts_.shrink_to_fit();
+  run_ends_.shrink_to_fit();
+}
+
+void
+MapFreeSpace::clear()
+{
+  run_starts_.clear();
+  run_ends_.clear();
+}
+
+void
+MapFreeSpace::getCell(int64_t rank, int & i, int & j) const
+{
+  // The run of the rank is the first run ending after it
+  const size_t run = std::upper_bound(run_ends_.begin(), run_ends_.end(), rank) -
+    run_ends_.begin();
+  const int64_t run_start_rank = run == 0 ? 0 : run_ends_[run - 1];
+  const int index = run_starts_[run] + static_cast<int>(rank - run_start_rank);
+  i = index % size_x_;
+  j = index / size_x_;
+}
+
+}  // namespace nav2_amcl
@@ -0,0 +1,185 @@
+// Copyright (c) 2022 Samsung Research America
+//
+// This library is free software; you can redistribute it and/or
+// modify it under the terms of the GNU Lesser General Public
+// License as published by the Free Software Foundation; either
+// version 2.1 of the License, or (at your option) any later version.
+//
+// This library is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+// Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public
+// License along with this library; if not, write to the Free Software
+// Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+
+#include <math.h>
+#include <stdint.h>
+#include <string.h>
+#include <algorithm>
+#include <fstream>
+#include <functional>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "nav2_amcl/map/map_range_table.hpp"
+
+namespace nav2_amcl
+{
+
+namespace
+{
+
+// Header of the saved tables, versioned with the layout of the file
+const char table_magic[8] = {'A', 'M', 'C', 'L', 'R', 'T', '0', '1'};
+
+// Ranges are stored in quarters of a cell
+constexpr double range_resolution = 0.25;
+
+/*
+ * @brief Run a function over contiguous chunks of [0, count) from one thread per core
+ * @param count Number of items to split
+ * @param fn Function of the first and last (exclusive) items of a chunk
+ */
+void parallel_for(int count, const std::function<void(int, int)> & fn)
+{
+  const int num_threads = std::max(
+    1, std::min(static_cast<int>(std::thread::hardware_concurrency()), count));
+  std::vector<std::thread> threads;
+  for (int t = 1; t < num_threads; t++) {
+    threads.emplace_back(
+      fn, static_cast<int>(static_cast<int64_t>(count) * t / num_threads),
+      static_cast<int>(static_cast<int64_t>(count) * (t + 1) / num_threads));
+  }
+  fn(0, count / num_threads);
+  for (auto & thread : threads) {
+    thread.join();
+  }
+}
+
+}  // namespace
+
+MapRangeTable::MapRangeTable(map_t * map, int bins, double max_range)
+: map_(map), bins_(std::max(bins, 1))
+{
+  // The longest range stored below the no hit value
+  max_range_ = std::min(max_range, (UINT16_MAX - 1) * range_resolution * map_->scale);
+}
+
+void
+MapRangeTable::build()
+{
+  ranges_.assign(static_cast<size_t>(map_->size_x) * map_->size_y * bins_, UINT16_MAX);
+  castRays(0, 0, map_->size_x, map_->size_y);
+}
+
+void
+MapRangeTable::update(int min_i, int min_j, int max_i, int max_j)
+{
+  if (ranges_.empty()) {
+    return;
+  }
+  const int cell_range = static_cast<int>(ceil(max_range_ / map_->scale)) + 1;
+  castRays(
+    std::max(min_i - cell_range, 0), std::max(min_j - cell_range, 0),
+    std::min(max_i + cell_range, map_->size_x), std::min(max_j + cell_range, map_->size_y));
+}
+
+void
+MapRangeTable::castRays(int min_i, int min_j, int max_i, int max_j)
+{
+  if (min_i >= max_i || min_j >= max_j) {
+    return;
+  }
+
+  // Rays from occupied cells end at once, the cost is in the rays of the free cells
+  parallel_for(
+    max_j - min_j, [&](int begin, int end) {
+      for (int j = min_j + begin; j < min_j + end; j++) {
+        for (int i = min_i; i < max_i; i++) {
+          uint16_t * ranges = &ranges_[static_cast<size_t>(MAP_INDEX(map_, i, j)) * bins_];
+          const double ox = MAP_WXGX(map_, i);
+          const double oy = MAP_WYGY(map_, j);
+          for (int bin = 0; bin < bins_; bin++) {
+            const double range =
+              map_calc_range(map_, ox, oy, bin * 2 * M_PI / bins_, max_range_);
+            ranges[bin] = range >= max_range_ ? UINT16_MAX :
+              static_cast<uint16_t>(lround(range / (range_resolution * map_->scale)));
+          }
+        }
+      }
+    });
+}
+
+double
+MapRangeTable::calcRange(double ox, double oy, double oa, double max_range) const
+{
+  const int i = MAP_GXWX(map_, ox);
+  const int j = MAP_GYWY(map_, oy);
+  if (ranges_.empty() || !MAP_VALID(map_, i, j)) {
+    return map_calc_range(map_, ox, oy, oa, max_range);
+  }
+
+  double heading = fmod(oa, 2 * M_PI);
+  if (heading < 0) {
+    heading += 2 * M_PI;
+  }
+  const int bin = static_cast<int>(heading * bins_ / (2 * M_PI) + 0.5) % bins_;
+  const uint16_t range = ranges_[static_cast<size_t>(MAP_INDEX(map_, i, j)) * bins_ + bin];
+
+  // Nothing hit within the range of the table, only rays of a longer range are cast
+  if (range == UINT16_MAX) {
+    return max_range <= max_range_ ? max_range : map_calc_range(map_, ox, oy, oa, max_range);
+  }
+  return std::min(range * range_resolution * map_->scale, max_range);
+}
+
+bool
+MapRangeTable::load(const std::string & path)
+{
+  std::ifstream file(path, std::ios::binary);
+  char magic[sizeof(table_magic)];
+  uint64_t signature;
+  int32_t bins;
+  double max_range;
+  uint64_t count;
+  file.read(magic, sizeof(magic));
+  file.read(reinterpret_cast<char *>(&signature), sizeof(signature));
+  file.read(reinterpret_cast<char *>(&bins), sizeof(bins));
+  file.read(reinterpret_cast<char *>(&max_range), sizeof(max_range));
+  file.read(reinterpret_cast<char *>(&count), sizeof(count));
+  const size_t expected_count = static_cast<size_t>(map_->size_x) * map_->size_y * bins_;
+  if (!file || memcmp(magic, table_magic, sizeof(magic)) != 0 || bins != bins_ ||
+    max_range != max_range_ || count != expected_count || signature != map_signature(map_))
+  {
+    return false;
+  }
+
+  std::vector<uint16_t> ranges(count);
+  file.read(reinterpret_cast<char *>(ranges.data()), count * sizeof(uint16_t));
+  if (!file) {
+    return false;
+  }
+  ranges_.swap(ranges);
+  return true;
+}
+
+bool
+MapRangeTable::save(const std::string & path) const
+{
+  std::ofstream file(path, std::ios::binary | std::ios::trunc);
+  const uint64_t signature = map_signature(map_);
+  const int32_t bins = bins_;
+  const uint64_t count = ranges_.size();
+  file.write(table_magic, sizeof(table_magic));
+  file.write(reinterpret_cast<const char *>(&signature), sizeof(signature));
+  file.write(reinterpret_cast<const char *>(&bins), sizeof(bins));
+  file.write(reinterpret_cast<const char *>(&max_range_), sizeof(max_range_));
+  file.write(reinterpret_cast<const char *>(&count), sizeof(count));
+  file.write(reinterpret_cast<const char *>(ranges_.data()), count * sizeof(uint16_t));
+  return static_cast<bool>(file);
+}
+
+}  // namespace nav2_amcl
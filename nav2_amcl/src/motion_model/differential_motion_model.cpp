@@ -79,28 +79,26 @@ DifferentialMotionModel::odometryUpdate(
     fabs(angleutils::angle_diff(delta_rot2, 0.0)),
     fabs(angleutils::angle_diff(delta_rot2, M_PI)));
 
+  // The deviations of the noise are the same for all samples
+  const double rot1_stddev = sqrt(
+    alpha1_ * delta_rot1_noise * delta_rot1_noise +
+    alpha2_ * delta_trans * delta_trans);
+  const double trans_stddev = sqrt(
+    alpha3_ * delta_trans * delta_trans +
+    alpha4_ * delta_rot1_noise * delta_rot1_noise +
+    alpha4_ * delta_rot2_noise * delta_rot2_noise);
+  const double rot2_stddev = sqrt(
+    alpha1_ * delta_rot2_noise * delta_rot2_noise +
+    alpha2_ * delta_trans * delta_trans);
+  const double * noise = drawNoise(3 * set->sample_count);
+
   for (int i = 0; i < set->sample_count; i++) {
     pf_sample_t * sample = set->samples + i;
 
     // Sample pose differences
-    delta_rot1_hat = angleutils::angle_diff(
-      delta_rot1,
-      pf_ran_gaussian(
-        sqrt(
-          alpha1_ * delta_rot1_noise * delta_rot1_noise +
-          alpha2_ * delta_trans * delta_trans)));
-    delta_trans_hat = delta_trans -
-      pf_ran_gaussian(
-      sqrt(
-        alpha3_ * delta_trans * delta_trans +
-        alpha4_ * delta_rot1_noise * delta_rot1_noise +
-        alpha4_ * delta_rot2_noise * delta_rot2_noise));
-    delta_rot2_hat = angleutils::angle_diff(
-      delta_rot2,
-      pf_ran_gaussian(
-        sqrt(
-          alpha1_ * delta_rot2_noise * delta_rot2_noise +
-          alpha2_ * delta_trans * delta_trans)));
+    delta_rot1_hat = angleutils::angle_diff(delta_rot1, rot1_stddev * noise[3 * i]);
+    delta_trans_hat = delta_trans - trans_stddev * noise[3 * i + 1];
+    delta_rot2_hat = angleutils::angle_diff(delta_rot2, rot2_stddev * noise[3 * i + 2]);
 
     // Apply sampled update to particle pose
     sample->pose.v[0] += delta_trans_hat *
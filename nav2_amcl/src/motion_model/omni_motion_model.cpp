@@ -66,19 +66,23 @@ OmniMotionModel::odometryUpdate(
     alpha4_ * (delta_rot * delta_rot) +
     alpha5_ * (delta_trans * delta_trans) );
 
+  // The bearing of the motion from the heading of the old pose is the same for all samples
+  const double motion_bearing = angleutils::angle_diff(
+    atan2(delta.v[1], delta.v[0]),
+    old_pose.v[2]);
+  const double * noise = drawNoise(3 * set->sample_count);
+
   for (int i = 0; i < set->sample_count; i++) {
     pf_sample_t * sample = set->samples + i;
 
-    delta_bearing = angleutils::angle_diff(
-      atan2(delta.v[1], delta.v[0]),
-      old_pose.v[2]) + sample->pose.v[2];
+    delta_bearing = motion_bearing + sample->pose.v[2];
     double cs_bearing = cos(delta_bearing);
     double sn_bearing = sin(delta_bearing);
 
     // Sample pose differences
-    delta_trans_hat = delta_trans + pf_ran_gaussian(trans_hat_stddev);
-    delta_rot_hat = delta_rot + pf_ran_gaussian(rot_hat_stddev);
-    delta_strafe_hat = 0 + pf_ran_gaussian(strafe_hat_stddev);
+    delta_trans_hat = delta_trans + trans_hat_stddev * noise[3 * i];
+    delta_rot_hat = delta_rot + rot_hat_stddev * noise[3 * i + 1];
+    delta_strafe_hat = 0 + strafe_hat_stddev * noise[3 * i + 2];
     // Apply sampled update to particle pose
     sample->pose.v[0] += (delta_trans_hat * cs_bearing +
       delta_strafe_hat * sn_bearing);
@@ -42,6 +42,9 @@
 // with samples in them.
 static int pf_resample_limit(pf_t * pf, int k);
 
+// Find the sample of a cumulative weight table that a uniform draw falls in
+static int pf_resample_find(const double * c, int count, double r);
+
 
 // Create a new filter
 pf_t * pf_alloc(
@@ -99,6 +102,8 @@ pf_t * pf_alloc(
     set->cov = pf_matrix_zero();
   }
 
+  pf->resample_cdf = calloc(max_samples + 1, sizeof(double));
+
   pf->w_slow = 0.0;
   pf->w_fast = 0.0;
 
@@ -121,9 +126,24 @@ void pf_free(pf_t * pf)
     pf_kdtree_free(pf->sets[i].kdtree);
     free(pf->sets[i].samples);
   }
+  free(pf->resample_cdf);
   free(pf);
 }
 
+// Get the number of bytes allocated by a filter
+size_t pf_memory_usage(const pf_t * pf)
+{
+  int i;
+  size_t bytes = sizeof(pf_t) + (pf->max_samples + 1) * sizeof(double);
+
+  for (i = 0; i < 2; i++) {
+    bytes += pf->max_samples * sizeof(pf_sample_t);
+    bytes += sizeof(pf_kdtree_t) + pf->sets[i].kdtree->node_max_count * sizeof(pf_kdtree_node_t);
+    bytes += pf->sets[i].cluster_max_count * sizeof(pf_cluster_t);
+  }
+  return bytes;
+}
+
 // Initialize the filter using a guassian
 void pf_init(pf_t * pf, pf_vector_t mean, pf_matrix_t cov)
 {
@@ -196,6 +216,43 @@ void pf_init_model(pf_t * pf, pf_init_model_fn_t init_fn, void * init_data)
   pf_init_converged(pf);
 }
 
+void pf_init_samples(pf_t * pf, const pf_vector_t * poses, const double * weights, int count)
+{
+  int i;
+  double total;
+  pf_sample_set_t * set;
+  pf_sample_t * sample;
+
+  set = pf->sets + pf->current_set;
+
+  // Create the kd tree for adaptive sampling
+  pf_kdtree_clear(set->kdtree);
+
+  set->sample_count = count < pf->max_samples ? count : pf->max_samples;
+
+  total = 0.0;
+  for (i = 0; i < set->sample_count; i++) {
+    total += weights[i];
+  }
+
+  for (i = 0; i < set->sample_count; i++) {
+    sample = set->samples + i;
+    sample->pose = poses[i];
+    sample->weight = total > 0.0 ? weights[i] / total : 1.0 / set->sample_count;
+
+    // Add sample to histogram
+    pf_kdtree_insert(set->kdtree, sample->pose, sample->weight);
+  }
+
+  pf->w_slow = pf->w_fast = 0.0;
+
+  // Re-compute cluster statistics
+  pf_cluster_stats(pf, set);
+
+  // set converged to 0
+  pf_init_converged(pf);
+}
+
 void pf_init_converged(pf_t * pf)
 {
   pf_sample_set_t * set;
@@ -308,10 +365,9 @@ void pf_update_resample(pf_t * pf)
   set_a = pf->sets + pf->current_set;
   set_b = pf->sets + (pf->current_set + 1) % 2;
 
-  // Build up cumulative probability table for resampling.
-  // TODO(?): Replace this with a more efficient procedure
-  // (e.g., http://www.network-theory.co.uk/docs/gslref/GeneralDiscreteDistributions.html)
-  c = (double *)malloc(sizeof(double) * (set_a->sample_count + 1));
+  // Build up cumulative probability table for resampling, searched by bisection for
+  // each draw. The table is allocated with the filter, for up to max_samples samples.
+  c = pf->resample_cdf;
   c[0] = 0.0;
   for (i = 0; i < set_a->sample_count; i++) {
     c[i + 1] = c[i] + set_a->samples[i].weight;
@@ -370,14 +426,10 @@ void pf_update_resample(pf_t * pf)
       m++;
       */
 
-      // Naive discrete event sampler
+      // Discrete event sampler
       double r;
       r = drand48();
-      for (i = 0; i < set_a->sample_count; i++) {
-        if ((c[i] <= r) && (r < c[i + 1])) {
-          break;
-        }
-      }
+      i = pf_resample_find(c, set_a->sample_count, r);
       assert(i < set_a->sample_count);
 
       sample_a = set_a->samples + i;
@@ -420,8 +472,24 @@ void pf_update_resample(pf_t * pf)
   pf->current_set = (pf->current_set + 1) % 2;
 
   pf_update_converged(pf);
+}
 
-  free(c);
+
+// Find the sample i with c[i] <= r < c[i + 1], the last sample if rounding left the
+// total weight c[count] at or below r
+int pf_resample_find(const double * c, int count, double r)
+{
+  int lo = 0, hi = count - 1;
+
+  while (lo < hi) {
+    int mid = lo + (hi - lo) / 2;
+    if (r < c[mid + 1]) {
+      hi = mid;
+    } else {
+      lo = mid + 1;
+    }
+  }
+  return lo;
 }
 
 
@@ -147,3 +147,46 @@ double pf_ran_gaussian(double sigma)
 
   return sigma * x2 * sqrt(-2.0 * log(w) / w);
 }
+
+
+/**************************************************************************
+ * Random streams
+ *************************************************************************/
+
+// Hash a 64 bit integer with the finalizer of SplitMix64
+static uint64_t pf_ran_mix(uint64_t z)
+{
+  z *= 0x9e3779b97f4a7c15ULL;
+  z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9ULL;
+  z = (z ^ (z >> 27)) * 0x94d049bb133111ebULL;
+  return z ^ (z >> 31);
+}
+
+// Seed a random stream, restarting it
+void pf_ran_stream_seed(pf_ran_stream_t * stream, uint64_t seed)
+{
+  stream->seed = pf_ran_mix(seed);
+  stream->counter = 0;
+}
+
+// Draw the next n samples of a random stream from a zero-mean Gaussian
+// distribution with unit standard deviation.
+void pf_ran_gaussian_batch(pf_ran_stream_t * stream, double * samples, int n)
+{
+  int i;
+  uint64_t index;
+  double u1, u2, r;
+
+  for (i = 0; i < n; i += 2) {
+    // The radius is drawn in (0, 1], so that its log is finite, the angle in [0, 1)
+    index = stream->seed + stream->counter + i;
+    u1 = ((pf_ran_mix(index) >> 11) + 1) * (1.0 / 9007199254740992.0);
+    u2 = (pf_ran_mix(index + 1) >> 11) * (1.0 / 9007199254740992.0);
+    r = sqrt(-2.0 * log(u1));
+    samples[i] = r * cos(2 * M_PI * u2);
+    if (i + 1 < n) {
+      samples[i + 1] = r * sin(2 * M_PI * u2);
+    }
+  }
+  stream->counter += n + (n & 1);
+}
@@ -21,6 +21,8 @@
 
 #include <math.h>
 #include <assert.h>
+#include <memory>
+#include <utility>
 
 #include "nav2_amcl/sensors/laser/laser.hpp"
 
@@ -46,74 +48,87 @@ double
 BeamModel::sensorFunction(LaserData * data, pf_sample_set_t * set)
 {
   BeamModel * self;
-  int i, j, step;
-  double z, pz;
-  double p;
-  double map_range;
-  double obs_range, obs_bearing;
-  double total_weight;
-  pf_sample_t * sample;
-  pf_vector_t pose;
+  int step;
 
   self = reinterpret_cast<BeamModel *>(data->laser);
 
-  total_weight = 0.0;
-
-  // Compute the sample weights
-  for (j = 0; j < set->sample_count; j++) {
-    sample = set->samples + j;
-    pose = sample->pose;
-
-    // Take account of the laser pose relative to the robot
-    pose = pf_vector_coord_add(self->laser_pose_, pose);
-
-    p = 1.0;
-
-    step = (data->range_count - 1) / (self->max_beams_ - 1);
-    for (i = 0; i < data->range_count; i += step) {
-      obs_range = data->ranges[i][0];
-      obs_bearing = data->ranges[i][1];
-
-      // Compute the range according to the map
-      map_range = map_calc_range(
-        self->map_, pose.v[0], pose.v[1],
-        pose.v[2] + obs_bearing, data->range_max);
-      pz = 0.0;
-
-      // Part 1: good, but noisy, hit
-      z = obs_range - map_range;
-      pz += self->z_hit_ * exp(-(z * z) / (2 * self->sigma_hit_ * self->sigma_hit_));
-
-      // Part 2: short reading from unexpected obstacle (e.g., a person)
-      if (z < 0) {
-        pz += self->z_short_ * self->lambda_short_ * exp(-self->lambda_short_ * obs_range);
-      }
-
-      // Part 3: Failure to detect obstacle, reported as max-range
-      if (obs_range == data->range_max) {
-        pz += self->z_max_ * 1.0;
-      }
-
-      // Part 4: Random measurements
-      if (obs_range < data->range_max) {
-        pz += self->z_rand_ * 1.0 / data->range_max;
+  step = (data->range_count - 1) / (self->max_beams_ - 1);
+
+  // Compute the sample weights, each sample only depending on its own pose
+  self->forEachSampleChunk(
+    set, [&](int, int begin, int end) {
+      int i, j;
+      double z, pz;
+      double p;
+      double map_range;
+      double obs_range, obs_bearing;
+      pf_sample_t * sample;
+      pf_vector_t pose;
+
+      for (j = begin; j < end; j++) {
+        sample = set->samples + j;
+        pose = sample->pose;
+
+        // Take account of the laser pose relative to the robot
+        pose = pf_vector_coord_add(self->laser_pose_, pose);
+
+        p = 1.0;
+
+        for (i = 0; i < data->range_count; i += step) {
+          obs_range = data->ranges[i][0];
+          obs_bearing = data->ranges[i][1];
+
+          // Compute the range according to the map
+          if (self->range_table_) {
+            map_range = self->range_table_->calcRange(
+              pose.v[0], pose.v[1], pose.v[2] + obs_bearing, data->range_max);
+          } else {
+            map_range = map_calc_range(
+              self->map_, pose.v[0], pose.v[1],
+              pose.v[2] + obs_bearing, data->range_max);
+          }
+          pz = 0.0;
+
+          // Part 1: good, but noisy, hit
+          z = obs_range - map_range;
+          pz += self->z_hit_ * exp(-(z * z) / (2 * self->sigma_hit_ * self->sigma_hit_));
+
+          // Part 2: short reading from unexpected obstacle (e.g., a person)
+          if (z < 0) {
+            pz += self->z_short_ * self->lambda_short_ * exp(-self->lambda_short_ * obs_range);
+          }
+
+          // Part 3: Failure to detect obstacle, reported as max-range
+          if (obs_range == data->range_max) {
+            pz += self->z_max_ * 1.0;
+          }
+
+          // Part 4: Random measurements
+          if (obs_range < data->range_max) {
+            pz += self->z_rand_ * 1.0 / data->range_max;
+          }
+
+          // TODO(?): outlier rejection for short readings
+
+          assert(pz <= 1.0);
+          assert(pz >= 0.0);
+          //      p *= pz;
+          // here we have an ad-hoc weighting scheme for combining beam probs
+          // works well, though...
+          p += pz * pz * pz;
+        }
+
+        sample->weight *= p;
       }
+    });
 
-      // TODO(?): outlier rejection for short readings
-
-      assert(pz <= 1.0);
-      assert(pz >= 0.0);
-      //      p *= pz;
-      // here we have an ad-hoc weighting scheme for combining beam probs
-      // works well, though...
-      p += pz * pz * pz;
-    }
-
-    sample->weight *= p;
-    total_weight += sample->weight;
-  }
+  return totalWeight(set);
+}
 
-  return total_weight;
+void
+BeamModel::setRangeTable(std::shared_ptr<const MapRangeTable> range_table)
+{
+  range_table_ = std::move(range_table);
 }
 
 bool
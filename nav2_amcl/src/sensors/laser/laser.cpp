@@ -23,6 +23,12 @@
 #include <math.h>
 #include <stdlib.h>
 #include <assert.h>
+#include <stdint.h>
+
+#include <algorithm>
+#include <functional>
+#include <thread>
+#include <vector>
 
 #include "nav2_amcl/sensors/laser/laser.hpp"
 
@@ -30,7 +36,8 @@ namespace nav2_amcl
 {
 
 Laser::Laser(size_t max_beams, map_t * map)
-: max_samples_(0), max_obs_(0), temp_obs_(NULL)
+: max_samples_(0), max_obs_(0), temp_obs_(NULL), num_threads_(1),
+  adaptive_beam_selection_(false), coarse_factor_(0), coarse_size_x_(0), coarse_size_y_(0)
 {
   max_beams_ = max_beams;
   map_ = map;
@@ -70,4 +77,482 @@ Laser::SetLaserPose(pf_vector_t & laser_pose)
   laser_pose_ = laser_pose;
 }
 
+void
+Laser::setThreadCount(int num_threads)
+{
+  if (num_threads <= 0) {
+    num_threads = std::max(1u, std::thread::hardware_concurrency());
+  }
+  num_threads_ = num_threads;
+}
+
+int
+Laser::forEachSampleChunk(
+  pf_sample_set_t * set, const std::function<void(int, int, int)> & fn) const
+{
+  const int num_chunks = std::max(1, std::min(num_threads_, set->sample_count));
+  if (num_chunks == 1) {
+    fn(0, 0, set->sample_count);
+    return num_chunks;
+  }
+
+  // The calling thread weights the first chunk while the others run the rest
+  std::vector<std::thread> threads;
+  threads.reserve(num_chunks - 1);
+  for (int chunk = 1; chunk < num_chunks; chunk++) {
+    threads.emplace_back(
+      fn, chunk, chunk * set->sample_count / num_chunks,
+      (chunk + 1) * set->sample_count / num_chunks);
+  }
+  fn(0, 0, set->sample_count / num_chunks);
+  for (auto & thread : threads) {
+    thread.join();
+  }
+  return num_chunks;
+}
+
+double
+Laser::totalWeight(pf_sample_set_t * set)
+{
+  double total_weight = 0.0;
+  for (int j = 0; j < set->sample_count; j++) {
+    total_weight += set->samples[j].weight;
+  }
+  return total_weight;
+}
+
+void
+Laser::setAdaptiveBeamSelection(bool adaptive)
+{
+  adaptive_beam_selection_ = adaptive;
+}
+
+void
+Laser::getLikelihoodBeams(LaserData * data, int step, LikelihoodBeams & beams) const
+{
+  beams.range.clear();
+  beams.cos_bearing.clear();
+  beams.sin_bearing.clear();
+  beams.index.clear();
+
+  // The likelihood field models ignore max range readings, and NaN readings
+  auto valid = [&](int i) {
+      double obs_range = data->ranges[i][0];
+      return obs_range < data->range_max && obs_range == obs_range;
+    };
+  auto add_beam = [&](int i, int beam_ind) {
+      beams.range.push_back(data->ranges[i][0]);
+      beams.cos_bearing.push_back(cos(data->ranges[i][1]));
+      beams.sin_bearing.push_back(sin(data->ranges[i][1]));
+      beams.index.push_back(beam_ind);
+    };
+
+  int budget = 0;
+  int beam_ind = 0;
+  for (int i = 0; i < data->range_count; i += step, beam_ind++) {
+    if (valid(i)) {
+      if (!adaptive_beam_selection_) {
+        add_beam(i, beam_ind);
+      }
+      budget++;
+    }
+  }
+  if (!adaptive_beam_selection_) {
+    return;
+  }
+
+  std::vector<int> candidates;
+  for (int i = 0; i < data->range_count; i++) {
+    if (valid(i)) {
+      candidates.push_back(i);
+    }
+  }
+  const int num_candidates = candidates.size();
+  if (num_candidates <= budget) {
+    for (int k = 0; k < num_candidates; k++) {
+      add_beam(candidates[k], k);
+    }
+    return;
+  }
+
+  // Beams along a straight wall all agree with the poses sliding along it, those where
+  // the scan bends locate the robot. Their informativeness is the distance of their
+  // endpoint to the middle of the endpoints of the neighbouring candidates.
+  std::vector<double> x(num_candidates), y(num_candidates);
+  for (int k = 0; k < num_candidates; k++) {
+    x[k] = data->ranges[candidates[k]][0] * cos(data->ranges[candidates[k]][1]);
+    y[k] = data->ranges[candidates[k]][0] * sin(data->ranges[candidates[k]][1]);
+  }
+  std::vector<double> bend(num_candidates, 0.0);
+  for (int k = 1; k + 1 < num_candidates; k++) {
+    bend[k] = hypot(x[k - 1] + x[k + 1] - 2 * x[k], y[k - 1] + y[k + 1] - 2 * y[k]);
+  }
+
+  // Half of the beams are evenly spread for coverage, the others bend the most
+  std::vector<bool> selected(num_candidates, false);
+  const int num_spread = budget / 2;
+  for (int n = 0; n < num_spread; n++) {
+    selected[static_cast<int64_t>(n) * num_candidates / num_spread] = true;
+  }
+  std::vector<int> order;
+  for (int k = 0; k < num_candidates; k++) {
+    if (!selected[k]) {
+      order.push_back(k);
+    }
+  }
+  const int num_bent = std::min<int>(budget - num_spread, order.size());
+  std::partial_sort(
+    order.begin(), order.begin() + num_bent, order.end(),
+    [&](int a, int b) {return bend[a] > bend[b] || (bend[a] == bend[b] && a < b);});
+  for (int n = 0; n < num_bent; n++) {
+    selected[order[n]] = true;
+  }
+
+  // Beams are kept in scan order, indexed by their rank among the selected beams
+  beam_ind = 0;
+  for (int k = 0; k < num_candidates; k++) {
+    if (selected[k]) {
+      add_beam(candidates[k], beam_ind++);
+    }
+  }
+}
+
+void
+Laser::packOccDist()
+{
+  const int num_cells = map_->size_x * map_->size_y;
+  occ_dist_.resize(num_cells + 1);
+  for (int i = 0; i < num_cells; i++) {
+    occ_dist_[i] = map_->cells[i].occ_dist;
+  }
+  occ_dist_[num_cells] = map_->max_occ_dist;
+}
+
+void
+Laser::packLikelihoodField()
+{
+  // Distances are those of cells to cells, so they take few distinct values.
+  // Precomputing the likelihood per cell replaces an exp() per beam per particle.
+  const int num_cells = map_->size_x * map_->size_y;
+  auto quantize = [this](double z) {return quantizeLikelihood(z);};
+
+  likelihood_.resize(num_cells + 1);
+  double last_dist = -1.0;
+  uint16_t last_likelihood = 0;
+  for (int i = 0; i < num_cells; i++) {
+    if (map_->cells[i].occ_dist != last_dist) {
+      last_dist = map_->cells[i].occ_dist;
+      last_likelihood = quantize(last_dist);
+    }
+    likelihood_[i] = last_likelihood;
+  }
+  likelihood_[num_cells] = quantize(map_->max_occ_dist);
+}
+
+uint16_t
+Laser::quantizeLikelihood(double z) const
+{
+  const double z_hit_denom = 2 * sigma_hit_ * sigma_hit_;
+  return static_cast<uint16_t>(lround(exp(-(z * z) / z_hit_denom) * UINT16_MAX));
+}
+
+void
+Laser::updateMapRegion(int min_i, int min_j, int max_i, int max_j)
+{
+  // The coarse likelihood field is built again on its next use
+  coarse_likelihood_.clear();
+
+  // Only the likelihood field models precompute map data, the beam model has none
+  for (int j = min_j; j < max_j; j++) {
+    for (int i = min_i; i < max_i; i++) {
+      const int index = MAP_INDEX(map_, i, j);
+      if (!likelihood_.empty()) {
+        likelihood_[index] = quantizeLikelihood(map_->cells[index].occ_dist);
+      }
+      if (!occ_dist_.empty()) {
+        occ_dist_[index] = map_->cells[index].occ_dist;
+      }
+    }
+  }
+}
+
+void
+Laser::getBeamCells(const pf_vector_t & pose, const LikelihoodBeams & beams, int * cells) const
+{
+  // The bearing of each beam is added to the heading of the pose through the sine and
+  // cosine of each, so that the loop has no dependency on other beams and no branch
+  const double cos_theta = cos(pose.v[2]);
+  const double sin_theta = sin(pose.v[2]);
+  const double * range = beams.range.data();
+  const double * cos_bearing = beams.cos_bearing.data();
+  const double * sin_bearing = beams.sin_bearing.data();
+  const int num_beams = beams.range.size();
+  const int off_map = map_->size_x * map_->size_y;
+
+  for (int k = 0; k < num_beams; k++) {
+    // Compute the endpoint of the beam
+    double hit_x =
+      pose.v[0] + range[k] * (cos_theta * cos_bearing[k] - sin_theta * sin_bearing[k]);
+    double hit_y =
+      pose.v[1] + range[k] * (sin_theta * cos_bearing[k] + cos_theta * sin_bearing[k]);
+
+    // Convert to map grid coords.
+    int mi = MAP_GXWX(map_, hit_x);
+    int mj = MAP_GYWY(map_, hit_y);
+    cells[k] = MAP_VALID(map_, mi, mj) ? MAP_INDEX(map_, mi, mj) : off_map;
+  }
+}
+
+
+void
+Laser::buildCoarseLikelihood(int factor)
+{
+  coarse_factor_ = factor;
+  coarse_size_x_ = (map_->size_x + factor - 1) / factor;
+  coarse_size_y_ = (map_->size_y + factor - 1) / factor;
+  const int num_coarse = coarse_size_x_ * coarse_size_y_;
+  const uint16_t off_map = likelihood_.back();
+
+  // Each coarse cell takes the highest likelihood of the cells within a coarse cell of its
+  // cells, the maximum being taken along the rows, then along the columns
+  std::vector<uint16_t> row_max(static_cast<size_t>(coarse_size_x_) * map_->size_y);
+  for (int j = 0; j < map_->size_y; j++) {
+    const uint16_t * row = &likelihood_[MAP_INDEX(map_, 0, j)];
+    for (int ci = 0; ci < coarse_size_x_; ci++) {
+      const int min_i = std::max((ci - 1) * factor, 0);
+      const int max_i = std::min((ci + 2) * factor, map_->size_x);
+      row_max[static_cast<size_t>(j) * coarse_size_x_ + ci] =
+        *std::max_element(row + min_i, row + max_i);
+    }
+  }
+
+  coarse_likelihood_.assign(num_coarse + 1, off_map);
+  for (int cj = 0; cj < coarse_size_y_; cj++) {
+    const int min_j = std::max((cj - 1) * factor, 0);
+    const int max_j = std::min((cj + 2) * factor, map_->size_y);
+    for (int ci = 0; ci < coarse_size_x_; ci++) {
+      uint16_t value = 0;
+      for (int j = min_j; j < max_j; j++) {
+        value = std::max(value, row_max[static_cast<size_t>(j) * coarse_size_x_ + ci]);
+      }
+      // Beams ending off the map from a coarse pose may end on it from the poses around,
+      // and those ending on the border cells off it
+      if (ci == 0 || cj == 0 || ci == coarse_size_x_ - 1 || cj == coarse_size_y_ - 1) {
+        value = std::max(value, off_map);
+      }
+      coarse_likelihood_[cj * coarse_size_x_ + ci] = value;
+    }
+  }
+}
+
+bool
+Laser::findGlobalPoses(
+  LaserData * data, int factor, int num_poses,
+  std::vector<pf_vector_t> & poses, pf_vector_t & spread)
+{
+  poses.clear();
+  if (likelihood_.empty() || num_poses < 1) {
+    return false;
+  }
+
+  const int step = std::max(1, (data->range_count - 1) / std::max(max_beams_ - 1, 1));
+  LikelihoodBeams beams;
+  getLikelihoodBeams(data, step, beams);
+  const int num_beams = beams.range.size();
+  if (num_beams == 0) {
+    return false;
+  }
+
+  factor = std::max(factor, 1);
+  if (coarse_likelihood_.empty() || coarse_factor_ != factor) {
+    buildCoarseLikelihood(factor);
+  }
+
+  // Coarse headings turn the farthest beam by a coarse cell, fine ones by a cell
+  const double max_range = std::max(
+    *std::max_element(beams.range.begin(), beams.range.end()), map_->scale);
+  const int num_headings = static_cast<int>(
+    std::ceil(2 * M_PI * max_range / (factor * map_->scale)));
+  const double heading_step = 2 * M_PI / num_headings;
+  const int fine_half_steps = std::max(
+    1, static_cast<int>(std::ceil(0.5 * heading_step * max_range / map_->scale)));
+  const double fine_step = 0.5 * heading_step / fine_half_steps;
+
+  // Offsets of the beam endpoints from the robot in each coarse heading, in coarse cells
+  const double coarse_scale = factor * map_->scale;
+  auto endpoint_offsets = [&](double heading, std::vector<double> & dx, std::vector<double> & dy) {
+      pf_vector_t robot = pf_vector_zero();
+      robot.v[2] = heading;
+      const pf_vector_t laser = pf_vector_coord_add(laser_pose_, robot);
+      const double cos_theta = cos(laser.v[2]);
+      const double sin_theta = sin(laser.v[2]);
+      dx.resize(num_beams);
+      dy.resize(num_beams);
+      for (int k = 0; k < num_beams; k++) {
+        const double range = beams.range[k];
+        dx[k] = (laser.v[0] + range *
+          (cos_theta * beams.cos_bearing[k] - sin_theta * beams.sin_bearing[k])) / coarse_scale;
+        dy[k] = (laser.v[1] + range *
+          (sin_theta * beams.cos_bearing[k] + cos_theta * beams.sin_bearing[k])) / coarse_scale;
+      }
+    };
+  std::vector<std::vector<double>> offsets_x(num_headings), offsets_y(num_headings);
+  for (int h = 0; h < num_headings; h++) {
+    endpoint_offsets(h * heading_step, offsets_x[h], offsets_y[h]);
+  }
+
+  // Coarse cells holding a free cell
+  std::vector<bool> coarse_free(coarse_size_x_ * coarse_size_y_, false);
+  for (int j = 0; j < map_->size_y; j++) {
+    for (int i = 0; i < map_->size_x; i++) {
+      if (map_->cells[MAP_INDEX(map_, i, j)].occ_state == -1) {
+        coarse_free[(j / factor) * coarse_size_x_ + i / factor] = true;
+      }
+    }
+  }
+
+  // Score the coarse poses at the center of the free coarse cells, keeping the best ones
+  struct Candidate
+  {
+    int64_t score;
+    int ci, cj, h;
+    bool operator<(const Candidate & other) const {return score > other.score;}
+  };
+  const size_t max_candidates = 64 * static_cast<size_t>(num_poses);
+  const int num_chunks = std::max(1, std::min(num_threads_, coarse_size_y_));
+  std::vector<std::vector<Candidate>> chunk_candidates(num_chunks);
+  auto score_rows = [&](int chunk) {
+      std::vector<Candidate> & heap = chunk_candidates[chunk];
+      const int min_cj = static_cast<int64_t>(coarse_size_y_) * chunk / num_chunks;
+      const int max_cj = static_cast<int64_t>(coarse_size_y_) * (chunk + 1) / num_chunks;
+      // The coarse cell of a point is the floor of its coordinates in coarse cells, found
+      // by truncating them shifted to positive values. With the pose at the center of its
+      // coarse cell and MAP_GXWX() rounding to the nearest cell, these are offset by half
+      // a coarse cell from the coarse cell of the pose.
+      const double center = 0.5;
+      const int shift = 1 << 20;
+      for (int cj = min_cj; cj < max_cj; cj++) {
+        for (int ci = 0; ci < coarse_size_x_; ci++) {
+          if (!coarse_free[cj * coarse_size_x_ + ci]) {
+            continue;
+          }
+          const double x = ci + center + shift;
+          const double y = cj + center + shift;
+          for (int h = 0; h < num_headings; h++) {
+            const double * offset_x = offsets_x[h].data();
+            const double * offset_y = offsets_y[h].data();
+            int64_t score = 0;
+            for (int k = 0; k < num_beams; k++) {
+              const int cx = static_cast<int>(x + offset_x[k]) - shift;
+              const int cy = static_cast<int>(y + offset_y[k]) - shift;
+              // The cells just off the map fall in the border cells, which cover them
+              const int cell = cx >= -1 && cx <= coarse_size_x_ && cy >= -1 &&
+                cy <= coarse_size_y_ ?
+                std::min(std::max(cy, 0), coarse_size_y_ - 1) * coarse_size_x_ +
+                std::min(std::max(cx, 0), coarse_size_x_ - 1) :
+                coarse_size_x_ * coarse_size_y_;
+              score += coarse_likelihood_[cell];
+            }
+            if (heap.size() < max_candidates || score > heap.front().score) {
+              heap.push_back({score, ci, cj, h});
+              std::push_heap(heap.begin(), heap.end());
+              if (heap.size() > max_candidates) {
+                std::pop_heap(heap.begin(), heap.end());
+                heap.pop_back();
+              }
+            }
+          }
+        }
+      }
+    };
+  std::vector<std::thread> threads;
+  for (int chunk = 1; chunk < num_chunks; chunk++) {
+    threads.emplace_back(score_rows, chunk);
+  }
+  score_rows(0);
+  for (auto & thread : threads) {
+    thread.join();
+  }
+  std::vector<Candidate> candidates;
+  for (const auto & chunk : chunk_candidates) {
+    candidates.insert(candidates.end(), chunk.begin(), chunk.end());
+  }
+  std::sort(candidates.begin(), candidates.end());
+
+  // Refine the best coarse poses over the free cells of their coarse cell and the fine
+  // headings around theirs, while they may beat the poses found
+  struct Match
+  {
+    int64_t score;
+    pf_vector_t pose;
+  };
+  std::vector<Match> matches;
+  std::vector<int> cells(num_beams);
+  const double min_distance = factor * map_->scale;
+  for (const Candidate & candidate : candidates) {
+    if (static_cast<int>(matches.size()) >= num_poses &&
+      candidate.score <= matches[num_poses - 1].score)
+    {
+      break;
+    }
+
+    Match best{-1, pf_vector_zero()};
+    for (int a = -fine_half_steps; a <= fine_half_steps; a++) {
+      pf_vector_t robot = pf_vector_zero();
+      robot.v[2] = candidate.h * heading_step + a * fine_step;
+      for (int j = candidate.cj * factor; j < std::min((candidate.cj + 1) * factor, map_->size_y);
+        j++)
+      {
+        for (int i = candidate.ci * factor;
+          i < std::min((candidate.ci + 1) * factor, map_->size_x); i++)
+        {
+          if (map_->cells[MAP_INDEX(map_, i, j)].occ_state != -1) {
+            continue;
+          }
+          robot.v[0] = MAP_WXGX(map_, i);
+          robot.v[1] = MAP_WYGY(map_, j);
+          getBeamCells(pf_vector_coord_add(laser_pose_, robot), beams, cells.data());
+          int64_t score = 0;
+          for (int k = 0; k < num_beams; k++) {
+            score += likelihood_[cells[k]];
+          }
+          if (score > best.score) {
+            best = {score, robot};
+          }
+        }
+      }
+    }
+    if (best.score < 0) {
+      continue;
+    }
+
+    // Matches closer than a coarse pose to a better one are the same pose
+    auto same_pose = [&](const Match & match) {
+        const double angle = fabs(atan2(
+            sin(best.pose.v[2] - match.pose.v[2]), cos(best.pose.v[2] - match.pose.v[2])));
+        return hypot(best.pose.v[0] - match.pose.v[0], best.pose.v[1] - match.pose.v[1]) <
+               min_distance && angle < heading_step;
+      };
+    if (std::any_of(
+        matches.begin(), matches.end(), [&](const Match & match) {
+          return match.score >= best.score && same_pose(match);
+        }))
+    {
+      continue;
+    }
+    matches.erase(std::remove_if(matches.begin(), matches.end(), same_pose), matches.end());
+    matches.insert(
+      std::upper_bound(
+        matches.begin(), matches.end(), best,
+        [](const Match & a, const Match & b) {return a.score > b.score;}), best);
+  }
+
+  for (int n = 0; n < std::min<int>(num_poses, matches.size()); n++) {
+    poses.push_back(matches[n].pose);
+  }
+  spread.v[0] = spread.v[1] = map_->scale;
+  spread.v[2] = fine_step;
+  return !poses.empty();
+}
+
 }  // namespace nav2_amcl
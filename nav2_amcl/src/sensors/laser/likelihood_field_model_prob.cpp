@@ -23,6 +23,8 @@
 #include <math.h>
 #include <assert.h>
 
+#include <vector>
+
 #include "nav2_amcl/sensors/laser/laser.hpp"
 
 namespace nav2_amcl
@@ -45,6 +47,10 @@ LikelihoodFieldModelProb::LikelihoodFieldModelProb(
   beam_skip_threshold_ = beam_skip_threshold;
   beam_skip_error_threshold_ = beam_skip_error_threshold;
   map_update_cspace(map, max_occ_dist);
+  packLikelihoodField();
+  if (do_beamskip_) {
+    packOccDist();
+  }
 }
 
 // Determine the probability for the given pose
@@ -52,14 +58,8 @@ double
 LikelihoodFieldModelProb::sensorFunction(LaserData * data, pf_sample_set_t * set)
 {
   LikelihoodFieldModelProb * self;
-  int i, j, step;
-  double z, pz;
-  double log_p;
-  double obs_range, obs_bearing;
+  int step;
   double total_weight;
-  pf_sample_t * sample;
-  pf_vector_t pose;
-  pf_vector_t hit;
 
   self = reinterpret_cast<LikelihoodFieldModelProb *>(data->laser);
 
@@ -73,11 +73,8 @@ LikelihoodFieldModelProb::sensorFunction(LaserData * data, pf_sample_set_t * set
   }
 
   // Pre-compute a couple of things
-  double z_hit_denom = 2 * self->sigma_hit_ * self->sigma_hit_;
   double z_rand_mult = 1.0 / data->range_max;
 
-  double max_dist_prob = exp(-(self->map_->max_occ_dist * self->map_->max_occ_dist) / z_hit_denom);
-
   // Beam skipping - ignores beams for which a majoirty of particles do not agree with the map
   // prevents correct particles from getting down weighted because of unexpected obstacles
   // such as humans
@@ -118,80 +115,80 @@ LikelihoodFieldModelProb::sensorFunction(LaserData * data, pf_sample_set_t * set
     }
   }
 
-  // Compute the sample weights
-  for (j = 0; j < set->sample_count; j++) {
-    sample = set->samples + j;
-    pose = sample->pose;
-
-    // Take account of the laser pose relative to the robot
-    pose = pf_vector_coord_add(self->laser_pose_, pose);
-
-    log_p = 0;
-
-    beam_ind = 0;
-
-    for (i = 0; i < data->range_count; i += step, beam_ind++) {
-      obs_range = data->ranges[i][0];
-      obs_bearing = data->ranges[i][1];
-
-      // This model ignores max range readings
-      if (obs_range >= data->range_max) {
-        continue;
-      }
-
-      // Check for NaN
-      if (obs_range != obs_range) {
-        continue;
-      }
-
-      pz = 0.0;
-
-      // Compute the endpoint of the beam
-      hit.v[0] = pose.v[0] + obs_range * cos(pose.v[2] + obs_bearing);
-      hit.v[1] = pose.v[1] + obs_range * sin(pose.v[2] + obs_bearing);
-
-      // Convert to map grid coords.
-      int mi, mj;
-      mi = MAP_GXWX(self->map_, hit.v[0]);
-      mj = MAP_GYWY(self->map_, hit.v[1]);
-
-      // Part 1: Get distance from the hit to closest obstacle.
-      // Off-map penalized as max distance
-
-      if (!MAP_VALID(self->map_, mi, mj)) {
-        pz += self->z_hit_ * max_dist_prob;
-      } else {
-        z = self->map_->cells[MAP_INDEX(self->map_, mi, mj)].occ_dist;
-        if (z < beam_skip_distance) {
-          obs_count[beam_ind] += 1;
+  // The beams used are the same for all samples
+  LikelihoodBeams beams;
+  self->getLikelihoodBeams(data, step, beams);
+  const int num_beams = beams.range.size();
+  const int off_map = self->map_->size_x * self->map_->size_y;
+
+  // Compute the sample weights, each sample only depending on its own pose. Threads
+  // count the beams that agreed with the map in their own array, summed afterwards.
+  std::vector<std::vector<int>> chunk_obs_count(self->num_threads_);
+  int num_chunks = self->forEachSampleChunk(
+    set, [&](int chunk, int begin, int end) {
+      int j, k;
+      double pz;
+      double log_p;
+      pf_sample_t * sample;
+      pf_vector_t pose;
+      std::vector<int> cells(num_beams);
+
+      std::vector<int> & thread_obs_count = chunk_obs_count[chunk];
+      thread_obs_count.assign(self->max_beams_, 0);
+
+      for (j = begin; j < end; j++) {
+        sample = set->samples + j;
+        pose = sample->pose;
+
+        // Take account of the laser pose relative to the robot
+        pose = pf_vector_coord_add(self->laser_pose_, pose);
+
+        log_p = 0;
+
+        // Part 1: Get distance from the hit to closest obstacle.
+        // Off-map penalized as max distance
+        self->getBeamCells(pose, beams, cells.data());
+
+        for (k = 0; k < num_beams; k++) {
+          // Gaussian model, precomputed for the distance of the cell
+          // NOTE: this should have a normalization of 1/(sqrt(2pi)*sigma)
+          pz = self->z_hit_ * self->hitLikelihood(cells[k]);
+
+          if (do_beamskip && cells[k] != off_map &&
+            self->occ_dist_[cells[k]] < beam_skip_distance)
+          {
+            thread_obs_count[beams.index[k]] += 1;
+          }
+
+          // Part 2: random measurements
+          pz += self->z_rand_ * z_rand_mult;
+
+          assert(pz <= 1.0);
+          assert(pz >= 0.0);
+
+          // TODO(?): outlier rejection for short readings
+
+          if (!do_beamskip) {
+            log_p += log(pz);
+          } else {
+            self->temp_obs_[j][beams.index[k]] = pz;
+          }
+        }
+        if (!do_beamskip) {
+          sample->weight *= exp(log_p);
         }
-        pz += self->z_hit_ * exp(-(z * z) / z_hit_denom);
       }
+    });
 
-      // Gaussian model
-      // NOTE: this should have a normalization of 1/(sqrt(2pi)*sigma)
-
-      // Part 2: random measurements
-      pz += self->z_rand_ * z_rand_mult;
-
-      assert(pz <= 1.0);
-      assert(pz >= 0.0);
-
-      // TODO(?): outlier rejection for short readings
-
-      if (!do_beamskip) {
-        log_p += log(pz);
-      } else {
-        self->temp_obs_[j][beam_ind] = pz;
-      }
-    }
-    if (!do_beamskip) {
-      sample->weight *= exp(log_p);
-      total_weight += sample->weight;
+  for (int chunk = 0; chunk < num_chunks; chunk++) {
+    for (beam_ind = 0; beam_ind < self->max_beams_; beam_ind++) {
+      obs_count[beam_ind] += chunk_obs_count[chunk][beam_ind];
     }
   }
 
-  if (do_beamskip) {
+  if (!do_beamskip) {
+    total_weight = totalWeight(set);
+  } else {
     int skipped_beam_count = 0;
     for (beam_ind = 0; beam_ind < self->max_beams_; beam_ind++) {
       if ((obs_count[beam_ind] / static_cast<double>(set->sample_count)) > beam_skip_threshold) {
@@ -217,22 +214,24 @@ LikelihoodFieldModelProb::sensorFunction(LaserData * data, pf_sample_set_t * set
       error = true;
     }
 
-    for (j = 0; j < set->sample_count; j++) {
-      sample = set->samples + j;
-      pose = sample->pose;
+    self->forEachSampleChunk(
+      set, [&](int, int begin, int end) {
+        for (int j = begin; j < end; j++) {
+          pf_sample_t * sample = set->samples + j;
 
-      log_p = 0;
+          double log_p = 0;
 
-      for (beam_ind = 0; beam_ind < self->max_beams_; beam_ind++) {
-        if (error || obs_mask[beam_ind]) {
-          log_p += log(self->temp_obs_[j][beam_ind]);
-        }
-      }
+          for (int beam_ind = 0; beam_ind < self->max_beams_; beam_ind++) {
+            if (error || obs_mask[beam_ind]) {
+              log_p += log(self->temp_obs_[j][beam_ind]);
+            }
+          }
 
-      sample->weight *= exp(log_p);
+          sample->weight *= exp(log_p);
+        }
+      });
 
-      total_weight += sample->weight;
-    }
+    total_weight = totalWeight(set);
   }
 
   delete[] obs_count;
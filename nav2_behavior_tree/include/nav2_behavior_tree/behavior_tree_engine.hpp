@@ -24,6 +24,7 @@
 #include "behaviortree_cpp_v3/bt_factory.h"
 #include "behaviortree_cpp_v3/xml_parsing.h"
 #include "behaviortree_cpp_v3/loggers/bt_zmq_publisher.h"
+#include "rclcpp/rclcpp.hpp"
 
 
 namespace nav2_behavior_tree
@@ -50,18 +51,23 @@ public:
   virtual ~BehaviorTreeEngine() {}
 
   /**
-   * @brief Function to execute a BT at a specific rate
+   * @brief Function to execute a BT at a specific rate, or on events of its nodes
    * @param tree BT to execute
    * @param onLoop Function to execute on each iteration of BT execution
    * @param cancelRequested Function to check if cancel was requested during BT execution
-   * @param loopTimeout Time period for each iteration of BT execution
+   * @param loopTimeout Time period for each iteration of BT execution. When the BT is run
+   * on events, the longest time the BT is waiting for one before it is ticked again
+   * @param eventExecutor Executor shared by the BT nodes to spin their callback groups.
+   * If set, the BT is ticked again as soon as one of its callbacks was executed (action
+   * result or feedback arrived, topic message received, ...) rather than at a fixed rate
    * @return nav2_behavior_tree::BtStatus Status of BT execution
    */
   BtStatus run(
     BT::Tree * tree,
     std::function<void()> onLoop,
     std::function<bool()> cancelRequested,
-    std::chrono::milliseconds loopTimeout = std::chrono::milliseconds(10));
+    std::chrono::milliseconds loopTimeout = std::chrono::milliseconds(10),
+    std::shared_ptr<rclcpp::executors::SingleThreadedExecutor> eventExecutor = nullptr);
 
   /**
    * @brief Function to create a BT from a XML string
@@ -0,0 +1,244 @@
+// Copyright (c) 2021 Samsung Research America
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef NAV2_BEHAVIOR_TREE__BINARY_BT_LOGGER_HPP_
+#define NAV2_BEHAVIOR_TREE__BINARY_BT_LOGGER_HPP_
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <utility>
+#include <vector>
+
+#include "behaviortree_cpp_v3/bt_factory.h"
+#include "behaviortree_cpp_v3/loggers/abstract_logger.h"
+
+namespace nav2_behavior_tree
+{
+
+/**
+ * @brief A BT status change, as written to a binary BT log
+ */
+struct BtLogRecord
+{
+  int64_t timestamp;  // Nanoseconds since the epoch
+  uint16_t tree_id;
+  uint16_t node_uid;
+  uint8_t previous_status;
+  uint8_t current_status;
+  uint16_t reserved;
+};
+static_assert(sizeof(BtLogRecord) == 16, "BtLogRecord is expected to be 16 bytes");
+
+/**
+ * @class nav2_behavior_tree::BtLogRingBuffer
+ * @brief Lock-free ring buffer of BT log records, for one producer and one consumer
+ */
+class BtLogRingBuffer
+{
+public:
+  /**
+   * @brief A constructor for nav2_behavior_tree::BtLogRingBuffer
+   * @param capacity Number of records the buffer holds, rounded up to a power of 2
+   */
+  explicit BtLogRingBuffer(size_t capacity);
+
+  /**
+   * @brief Add a record to the buffer, only to be called by the producer
+   * @param record Record to add
+   * @return bool false if the buffer is full and the record was dropped
+   */
+  bool push(const BtLogRecord & record);
+
+  /**
+   * @brief Remove the oldest records from the buffer, only to be called by the consumer
+   * @param records Output records
+   * @param max_records Maximum number of records to remove
+   * @return size_t Number of records removed
+   */
+  size_t pop(BtLogRecord * records, size_t max_records);
+
+protected:
+  std::vector<BtLogRecord> records_;
+  size_t mask_;
+  alignas(64) std::atomic<size_t> head_{0};
+  alignas(64) std::atomic<size_t> tail_{0};
+};
+
+/**
+ * @class nav2_behavior_tree::BinaryBtLogSink
+ * @brief Writes BT log records to a memory mapped file from a background thread.
+ * The file starts with a header, followed by chunks of either the node names of a
+ * tree, written once when the tree is added, or of the records drained from the buffer.
+ */
+class BinaryBtLogSink
+{
+public:
+  static constexpr char MAGIC[8] = {'N', 'A', 'V', '2', 'B', 'T', 'L', 'G'};
+  static constexpr uint32_t VERSION = 1;
+  static constexpr uint32_t TREE_CHUNK = 1;
+  static constexpr uint32_t RECORD_CHUNK = 2;
+
+  /**
+   * @brief A constructor for nav2_behavior_tree::BinaryBtLogSink
+   * @param filename File to write, truncated if it exists
+   * @param capacity Number of records buffered between two drains
+   * @param drain_period Period at which the background thread writes the buffered records
+   */
+  explicit BinaryBtLogSink(
+    const std::string & filename,
+    size_t capacity = 8192,
+    std::chrono::milliseconds drain_period = std::chrono::milliseconds(100));
+
+  /**
+   * @brief A destructor for nav2_behavior_tree::BinaryBtLogSink, writing the remaining
+   * records and truncating the file to its content
+   */
+  ~BinaryBtLogSink();
+
+  /**
+   * @brief Write the node names of a tree, for its records to refer to
+   * @param nodes UIDs and names of the nodes of the tree
+   * @return uint16_t ID of the tree in the log
+   */
+  uint16_t addTree(const std::vector<std::pair<uint16_t, std::string>> & nodes);
+
+  /**
+   * @brief Buffer a record, lock-free, to be written by the background thread
+   * @param record Record to buffer
+   */
+  void push(const BtLogRecord & record);
+
+  /**
+   * @brief Get the number of records dropped because the buffer was full
+   * @return uint64_t Number of dropped records
+   */
+  uint64_t droppedRecords() const
+  {
+    return dropped_records_;
+  }
+
+protected:
+  /**
+   * @brief Write the buffered records to the file, with file_mutex_ locked
+   */
+  void drain();
+
+  /**
+   * @brief Make room in the file for a chunk, growing the file and its mapping as needed
+   * @param size Number of bytes to append
+   * @return bool false if the file could not be grown, the chunk is then dropped
+   */
+  bool reserve(size_t size);
+
+  /**
+   * @brief Append bytes to the file, after reserving room for them
+   * @param data Bytes to append
+   * @param size Number of bytes
+   */
+  void append(const void * data, size_t size);
+
+  /**
+   * @brief Get the number of bytes of a node name written to the file
+   * @param name Node name
+   * @return uint16_t Length of the name, capped to what the file format stores
+   */
+  static uint16_t nameLength(const std::string & name);
+
+  BtLogRingBuffer buffer_;
+  std::vector<BtLogRecord> drained_;
+  std::atomic<uint64_t> dropped_records_{0};
+
+  int fd_;
+  char * mapped_{nullptr};
+  size_t mapped_size_{0};
+  size_t size_{0};
+  uint16_t tree_count_{0};
+  std::mutex file_mutex_;
+
+  std::chrono::milliseconds drain_period_;
+  bool stop_{false};
+  std::mutex stop_mutex_;
+  std::condition_variable stop_cv_;
+  std::thread thread_;
+};
+
+/**
+ * @class nav2_behavior_tree::BinaryBtLogger
+ * @brief A BT logger writing compact records of the status changes to a BinaryBtLogSink,
+ * without copying the node names in the tick loop
+ */
+class BinaryBtLogger : public BT::StatusChangeLogger
+{
+public:
+  /**
+   * @brief A constructor for nav2_behavior_tree::BinaryBtLogger
+   * @param tree BT to monitor
+   * @param sink Sink to write the node names and status changes of the tree to
+   */
+  BinaryBtLogger(const BT::Tree & tree, const std::shared_ptr<BinaryBtLogSink> & sink);
+
+  /**
+   * @brief Callback function which is called each time BT changes status
+   * @param timestamp Timestamp of BT status change
+   * @param node Node that changed status
+   * @param prev_status Previous status of the node
+   * @param status Current status of the node
+   */
+  void callback(
+    BT::Duration timestamp,
+    const BT::TreeNode & node,
+    BT::NodeStatus prev_status,
+    BT::NodeStatus status) override;
+
+  /**
+   * @brief Records are written by the background thread of the sink, nothing to do here
+   */
+  void flush() override
+  {
+  }
+
+protected:
+  std::shared_ptr<BinaryBtLogSink> sink_;
+  uint16_t tree_id_;
+};
+
+/**
+ * @brief A BT status change read back from a binary BT log
+ */
+struct BtLogEvent
+{
+  BT::Duration timestamp;
+  uint16_t tree_id;
+  std::string node_name;
+  BT::NodeStatus previous_status;
+  BT::NodeStatus current_status;
+};
+
+/**
+ * @brief Read the status changes written to a binary BT log
+ * @param filename File written by a BinaryBtLogSink
+ * @return std::vector<BtLogEvent> Status changes, in the order they were logged
+ * @throw std::runtime_error if the file cannot be read or is not a binary BT log
+ */
+std::vector<BtLogEvent> readBinaryBtLog(const std::string & filename);
+
+}   // namespace nav2_behavior_tree
+
+#endif   // NAV2_BEHAVIOR_TREE__BINARY_BT_LOGGER_HPP_
@@ -15,6 +15,7 @@
 #ifndef NAV2_BEHAVIOR_TREE__BT_ACTION_NODE_HPP_
 #define NAV2_BEHAVIOR_TREE__BT_ACTION_NODE_HPP_
 
+#include <list>
 #include <memory>
 #include <string>
 
@@ -22,6 +23,9 @@
 #include "nav2_util/node_utils.hpp"
 #include "rclcpp_action/rclcpp_action.hpp"
 #include "nav2_behavior_tree/bt_conversions.hpp"
+#include "nav2_behavior_tree/bt_callback_group_executor.hpp"
+#include "nav2_behavior_tree/bt_client_registry.hpp"
+#include "nav2_behavior_tree/bt_profiler.hpp"
 
 namespace nav2_behavior_tree
 {
@@ -47,10 +51,20 @@ public:
   : BT::ActionNodeBase(xml_tag_name, conf), action_name_(action_name)
   {
     node_ = config().blackboard->template get<rclcpp::Node::SharedPtr>("node");
-    callback_group_ = node_->create_callback_group(
-      rclcpp::CallbackGroupType::MutuallyExclusive,
-      false);
-    callback_group_executor_.add_callback_group(callback_group_, node_->get_node_base_interface());
+    if (config().blackboard->get("client_registry", client_registry_) && client_registry_) {
+      // Share the clients of the tree and the executor spinning them
+      callback_group_ = client_registry_->getCallbackGroup();
+      callback_group_executor_ = client_registry_->getExecutor();
+    } else {
+      callback_group_ = node_->create_callback_group(
+        rclcpp::CallbackGroupType::MutuallyExclusive,
+        false);
+      callback_group_executor_ =
+        addToCallbackGroupExecutor(config().blackboard, callback_group_, node_);
+    }
+
+    // Report to the profiler, if profiling is enabled
+    config().blackboard->get("bt_profiler", profiler_);
 
     // Get the required items from the blackboard
     bt_loop_duration_ =
@@ -86,7 +100,11 @@ public:
   void createActionClient(const std::string & action_name)
   {
     // Now that we have the ROS node to use, create the action client for this BT action
-    action_client_ = rclcpp_action::create_client<ActionT>(node_, action_name, callback_group_);
+    if (client_registry_) {
+      action_client_ = client_registry_->template getActionClient<ActionT>(action_name);
+    } else {
+      action_client_ = rclcpp_action::create_client<ActionT>(node_, action_name, callback_group_);
+    }
 
     // Make sure the server is actually there before continuing
     RCLCPP_DEBUG(node_->get_logger(), "Waiting for \"%s\" action server", action_name.c_str());
@@ -172,6 +190,10 @@ public:
    */
   BT::NodeStatus tick() override
   {
+    BtProfiler::ScopedTick profiled_tick(profiler_.get(), *this);
+
+    check_pending_cancels();
+
     // first step to be done only at the beginning of the Action
     if (status() == BT::NodeStatus::IDLE) {
       // setting the status to RUNNING to notify the BT Loggers (if any)
@@ -228,7 +250,7 @@ public:
           }
         }
 
-        callback_group_executor_.spin_some();
+        callback_group_executor_->spin_some();
 
         // check if, after invoking spin_some(), we finally received the result
         if (!goal_result_available_) {
@@ -276,15 +298,13 @@ public:
    */
   void halt() override
   {
+    check_pending_cancels();
+
     if (should_cancel_goal()) {
-      auto future_cancel = action_client_->async_cancel_goal(goal_handle_);
-      if (callback_group_executor_.spin_until_future_complete(future_cancel, server_timeout_) !=
-        rclcpp::FutureReturnCode::SUCCESS)
-      {
-        RCLCPP_ERROR(
-          node_->get_logger(),
-          "Failed to cancel action server for %s", action_name_.c_str());
-      }
+      // Do not stall the tree until the action server acknowledges the cancel, a new goal
+      // may be sent meanwhile. The acknowledgment is checked for on the next ticks
+      pending_cancels_.push_back(
+        {action_client_->async_cancel_goal(goal_handle_), node_->now()});
     }
 
     setStatus(BT::NodeStatus::IDLE);
@@ -307,7 +327,7 @@ protected:
       return false;
     }
 
-    callback_group_executor_.spin_some();
+    callback_group_executor_->spin_some();
     auto status = goal_handle_->get_status();
 
     // Check if the goal is still executing
@@ -315,6 +335,32 @@ protected:
            status == action_msgs::msg::GoalStatus::STATUS_EXECUTING;
   }
 
+  /**
+   * @brief Function to check the acknowledgments of the cancels sent by halt(),
+   * forgetting those acknowledged and reporting those timed out
+   */
+  void check_pending_cancels()
+  {
+    if (pending_cancels_.empty()) {
+      return;
+    }
+
+    callback_group_executor_->spin_some();
+    auto it = pending_cancels_.begin();
+    while (it != pending_cancels_.end()) {
+      if (it->future.wait_for(std::chrono::seconds(0)) == std::future_status::ready) {
+        it = pending_cancels_.erase(it);
+      } else if (node_->now() - it->time_sent > rclcpp::Duration(server_timeout_)) {
+        RCLCPP_ERROR(
+          node_->get_logger(),
+          "Failed to cancel action server for %s", action_name_.c_str());
+        it = pending_cancels_.erase(it);
+      } else {
+        ++it;
+      }
+    }
+  }
+
   /**
    * @brief Function to send new goal to action server
    */
@@ -338,6 +384,21 @@ protected:
         if (this->goal_handle_->get_goal_id() == result.goal_id) {
           goal_result_available_ = true;
           result_ = result;
+          if (profiler_) {
+            profiler_->recordGoalResult(*this);
+          }
+        }
+      };
+
+    feedback_.reset();
+    send_goal_options.feedback_callback =
+      [this](typename rclcpp_action::ClientGoalHandle<ActionT>::SharedPtr goal_handle,
+        const std::shared_ptr<const typename ActionT::Feedback> feedback) {
+        // Feedback of older goals may still be received until a new goal is acknowledged
+        if (!future_goal_handle_ && this->goal_handle_ &&
+          this->goal_handle_->get_goal_id() == goal_handle->get_goal_id())
+        {
+          feedback_ = feedback;
         }
       };
 
@@ -345,6 +406,9 @@ protected:
       std::shared_future<typename rclcpp_action::ClientGoalHandle<ActionT>::SharedPtr>>(
       action_client_->async_send_goal(goal_, send_goal_options));
     time_goal_sent_ = node_->now();
+    if (profiler_) {
+      profiler_->recordGoalSent(*this);
+    }
   }
 
   /**
@@ -365,7 +429,7 @@ protected:
 
     auto timeout = remaining > bt_loop_duration_ ? bt_loop_duration_ : remaining;
     auto result =
-      callback_group_executor_.spin_until_future_complete(*future_goal_handle_, timeout);
+      callback_group_executor_->spin_until_future_complete(*future_goal_handle_, timeout);
     elapsed += timeout;
 
     if (result == rclcpp::FutureReturnCode::INTERRUPTED) {
@@ -379,6 +443,9 @@ protected:
       if (!goal_handle_) {
         throw std::runtime_error("Goal was rejected by the action server");
       }
+      if (profiler_) {
+        profiler_->recordGoalAccepted(*this);
+      }
       return true;
     }
 
@@ -405,11 +472,15 @@ protected:
   bool goal_result_available_{false};
   typename rclcpp_action::ClientGoalHandle<ActionT>::SharedPtr goal_handle_;
   typename rclcpp_action::ClientGoalHandle<ActionT>::WrappedResult result_;
+  // The last feedback of the current goal, if any
+  std::shared_ptr<const typename ActionT::Feedback> feedback_;
 
   // The node that will be used for any ROS operations
   rclcpp::Node::SharedPtr node_;
   rclcpp::CallbackGroup::SharedPtr callback_group_;
-  rclcpp::executors::SingleThreadedExecutor callback_group_executor_;
+  std::shared_ptr<rclcpp::executors::SingleThreadedExecutor> callback_group_executor_;
+  BtClientRegistry::Ptr client_registry_;
+  BtProfiler::Ptr profiler_;
 
   // The timeout value while waiting for response from a server when a
   // new action goal is sent or canceled
@@ -422,6 +493,14 @@ protected:
   std::shared_ptr<std::shared_future<typename rclcpp_action::ClientGoalHandle<ActionT>::SharedPtr>>
   future_goal_handle_;
   rclcpp::Time time_goal_sent_;
+
+  // Cancels sent by halt() that the action server has not acknowledged yet
+  struct PendingCancel
+  {
+    std::shared_future<typename rclcpp_action::Client<ActionT>::CancelResponse::SharedPtr> future;
+    rclcpp::Time time_sent;
+  };
+  std::list<PendingCancel> pending_cancels_;
 };
 
 }  // namespace nav2_behavior_tree
@@ -15,15 +15,21 @@
 #ifndef NAV2_BEHAVIOR_TREE__BT_ACTION_SERVER_HPP_
 #define NAV2_BEHAVIOR_TREE__BT_ACTION_SERVER_HPP_
 
+#include <chrono>
+#include <map>
 #include <memory>
 #include <string>
 #include <vector>
 
 #include "geometry_msgs/msg/pose_stamped.hpp"
 #include "nav2_behavior_tree/behavior_tree_engine.hpp"
+#include "nav2_behavior_tree/binary_bt_logger.hpp"
+#include "nav2_behavior_tree/bt_client_registry.hpp"
+#include "nav2_behavior_tree/bt_profiler.hpp"
 #include "nav2_behavior_tree/ros_topic_logger.hpp"
 #include "nav2_util/lifecycle_node.hpp"
 #include "nav2_util/simple_action_server.hpp"
+#include "std_srvs/srv/trigger.hpp"
 
 namespace nav2_behavior_tree
 {
@@ -87,7 +93,8 @@ public:
   bool on_cleanup();
 
   /**
-   * @brief Replace current BT with another one
+   * @brief Replace current BT with another one. BTs loaded before are kept, so switching
+   * back to one of them does not re-create its nodes
    * @param bt_xml_filename The file containing the new BT, uses default filename if empty
    * @return bool true if the resulting BT correspond to the one in bt_xml_filename. false
    * if something went wrong, and previous BT is maintained
@@ -188,6 +195,12 @@ protected:
    */
   void executeCallback();
 
+  /**
+   * @brief Publish the statistics of the BT nodes, when profiling
+   * @param force Publish even if the statistics period has not elapsed
+   */
+  void publishBtStatistics(bool force);
+
   // Action name
   std::string action_name_;
 
@@ -204,6 +217,19 @@ protected:
   std::string current_bt_xml_filename_;
   std::string default_bt_xml_filename_;
 
+  // XML files of Behavior Trees to create on activation, besides the default one
+  std::vector<std::string> preloaded_bt_xml_filenames_;
+
+  // Behavior Trees loaded before the current one, with their loggers, by XML filename.
+  // Kept to switch back to them without re-creating their nodes and action clients
+  struct CachedTree
+  {
+    BT::Tree tree;
+    std::unique_ptr<RosTopicLogger> topic_logger;
+    std::unique_ptr<BinaryBtLogger> binary_logger;
+  };
+  std::map<std::string, CachedTree> tree_cache_;
+
   // The wrapper class for the BT functionality
   std::unique_ptr<nav2_behavior_tree::BehaviorTreeEngine> bt_;
 
@@ -213,6 +239,12 @@ protected:
   // A regular, non-spinning ROS node that we can use for calls to the action client
   rclcpp::Node::SharedPtr client_node_;
 
+  // Executor shared by the BT nodes and their clients
+  std::shared_ptr<rclcpp::executors::SingleThreadedExecutor> callback_group_executor_;
+
+  // Whether the BT is ticked on the events of its nodes instead of at a fixed rate
+  bool event_driven_;
+
   // Parent node
   rclcpp_lifecycle::LifecycleNode::WeakPtr node_;
 
@@ -225,6 +257,17 @@ protected:
   // To publish BT logs
   std::unique_ptr<RosTopicLogger> topic_logger_;
 
+  // To write BT logs to a binary file, when its name is set
+  std::shared_ptr<BinaryBtLogSink> binary_log_sink_;
+  std::unique_ptr<BinaryBtLogger> binary_logger_;
+
+  // To profile the BT nodes, when enabled, and publish or dump their statistics
+  BtProfiler::Ptr profiler_;
+  rclcpp::Publisher<nav2_msgs::msg::BehaviorTreeStatistics>::SharedPtr bt_statistics_pub_;
+  rclcpp::Service<std_srvs::srv::Trigger>::SharedPtr bt_profile_service_;
+  double bt_statistics_period_;
+  std::chrono::steady_clock::time_point bt_statistics_published_;
+
   // Duration for each iteration of BT execution
   std::chrono::milliseconds bt_loop_duration_;
 
@@ -59,6 +59,22 @@ BtActionServer<ActionT>::BtActionServer(
   if (!node->has_parameter("default_server_timeout")) {
     node->declare_parameter("default_server_timeout", 20);
   }
+  if (!node->has_parameter("bt_event_driven")) {
+    node->declare_parameter("bt_event_driven", false);
+  }
+  if (!node->has_parameter(action_name_ + ".preloaded_bt_xml_filenames")) {
+    node->declare_parameter(
+      action_name_ + ".preloaded_bt_xml_filenames", std::vector<std::string>());
+  }
+  if (!node->has_parameter(action_name_ + ".bt_log_file")) {
+    node->declare_parameter(action_name_ + ".bt_log_file", std::string(""));
+  }
+  if (!node->has_parameter(action_name_ + ".bt_profiling")) {
+    node->declare_parameter(action_name_ + ".bt_profiling", false);
+  }
+  if (!node->has_parameter(action_name_ + ".bt_statistics_period")) {
+    node->declare_parameter(action_name_ + ".bt_statistics_period", 1.0);
+  }
 }
 
 template<class ActionT>
@@ -99,6 +115,39 @@ bool BtActionServer<ActionT>::on_configure()
   bt_loop_duration_ = std::chrono::milliseconds(timeout);
   node->get_parameter("default_server_timeout", timeout);
   default_server_timeout_ = std::chrono::milliseconds(timeout);
+  node->get_parameter("bt_event_driven", event_driven_);
+  node->get_parameter(
+    action_name_ + ".preloaded_bt_xml_filenames", preloaded_bt_xml_filenames_);
+  std::string bt_log_file;
+  node->get_parameter(action_name_ + ".bt_log_file", bt_log_file);
+
+  // Write the status changes of the BTs to a binary log as well, if requested
+  if (!bt_log_file.empty()) {
+    try {
+      binary_log_sink_ = std::make_shared<BinaryBtLogSink>(bt_log_file);
+    } catch (const std::runtime_error & e) {
+      RCLCPP_ERROR(logger_, "%s", e.what());
+      return false;
+    }
+  }
+
+  // Profile the BT nodes, if requested
+  bool bt_profiling;
+  node->get_parameter(action_name_ + ".bt_profiling", bt_profiling);
+  node->get_parameter(action_name_ + ".bt_statistics_period", bt_statistics_period_);
+  if (bt_profiling) {
+    profiler_ = std::make_shared<BtProfiler>();
+    bt_statistics_pub_ = client_node_->create_publisher<nav2_msgs::msg::BehaviorTreeStatistics>(
+      action_name_ + "/bt_statistics", rclcpp::QoS(1));
+    bt_profile_service_ = node->create_service<std_srvs::srv::Trigger>(
+      action_name_ + "/dump_bt_profile",
+      [this](
+        const std::shared_ptr<std_srvs::srv::Trigger::Request>,
+        std::shared_ptr<std_srvs::srv::Trigger::Response> response) {
+        response->success = true;
+        response->message = profiler_->report();
+      });
+  }
 
   // Create the class that registers our custom nodes and executes the BT
   bt_ = std::make_unique<nav2_behavior_tree::BehaviorTreeEngine>(plugin_lib_names_);
@@ -111,6 +160,18 @@ bool BtActionServer<ActionT>::on_configure()
   blackboard_->set<std::chrono::milliseconds>("server_timeout", default_server_timeout_);  // NOLINT
   blackboard_->set<std::chrono::milliseconds>("bt_loop_duration", bt_loop_duration_);  // NOLINT
 
+  // Let the BT nodes share one executor, that the BT engine is waiting on between ticks
+  // when event-driven, and one client per server
+  callback_group_executor_ = std::make_shared<rclcpp::executors::SingleThreadedExecutor>();
+  blackboard_->set<std::shared_ptr<rclcpp::executors::SingleThreadedExecutor>>(  // NOLINT
+    "callback_group_executor", callback_group_executor_);
+  blackboard_->set<BtClientRegistry::Ptr>(  // NOLINT
+    "client_registry",
+    std::make_shared<BtClientRegistry>(client_node_, callback_group_executor_));
+  if (profiler_) {
+    blackboard_->set<BtProfiler::Ptr>("bt_profiler", profiler_);  // NOLINT
+  }
+
   return true;
 }
 
@@ -121,6 +182,16 @@ bool BtActionServer<ActionT>::on_activate()
     RCLCPP_ERROR(logger_, "Error loading XML file: %s", default_bt_xml_filename_.c_str());
     return false;
   }
+
+  // Create the other configured BTs upfront, so that goals switching to them do not wait
+  // for their nodes to be created, then make the default BT current again
+  for (const auto & filename : preloaded_bt_xml_filenames_) {
+    if (!loadBehaviorTree(filename)) {
+      RCLCPP_WARN(logger_, "Could not preload XML file: %s", filename.c_str());
+    }
+  }
+  loadBehaviorTree(default_bt_xml_filename_);
+
   action_server_->activate();
   return true;
 }
@@ -135,14 +206,21 @@ bool BtActionServer<ActionT>::on_deactivate()
 template<class ActionT>
 bool BtActionServer<ActionT>::on_cleanup()
 {
+  bt_profile_service_.reset();
+  bt_statistics_pub_.reset();
+  profiler_.reset();
   client_node_.reset();
   action_server_.reset();
   topic_logger_.reset();
+  binary_logger_.reset();
+  tree_cache_.clear();
+  binary_log_sink_.reset();
   plugin_lib_names_.clear();
   current_bt_xml_filename_.clear();
   blackboard_.reset();
   bt_->haltAllActions(tree_.rootNode());
   bt_.reset();
+  callback_group_executor_.reset();
   return true;
 }
 
@@ -158,22 +236,53 @@ bool BtActionServer<ActionT>::loadBehaviorTree(const std::string & bt_xml_filena
     return true;
   }
 
-  // Read the input BT XML from the specified file into a string
-  std::ifstream xml_file(filename);
-
-  if (!xml_file.good()) {
-    RCLCPP_ERROR(logger_, "Couldn't open input XML file: %s", filename.c_str());
-    return false;
+  BT::Tree tree;
+  std::unique_ptr<RosTopicLogger> topic_logger;
+  std::unique_ptr<BinaryBtLogger> binary_logger;
+
+  auto cached = tree_cache_.find(filename);
+  if (cached != tree_cache_.end()) {
+    // Switch back to a BT created before, its nodes were halted after its last execution
+    RCLCPP_DEBUG(logger_, "Reusing the BT previously created from %s", filename.c_str());
+    tree = std::move(cached->second.tree);
+    topic_logger = std::move(cached->second.topic_logger);
+    binary_logger = std::move(cached->second.binary_logger);
+    tree_cache_.erase(cached);
+  } else {
+    // Read the input BT XML from the specified file into a string
+    std::ifstream xml_file(filename);
+
+    if (!xml_file.good()) {
+      RCLCPP_ERROR(logger_, "Couldn't open input XML file: %s", filename.c_str());
+      return false;
+    }
+
+    auto xml_string = std::string(
+      std::istreambuf_iterator<char>(xml_file),
+      std::istreambuf_iterator<char>());
+
+    // Create the Behavior Tree from the XML input
+    tree = bt_->createTreeFromText(xml_string, blackboard_);
+    topic_logger = std::make_unique<RosTopicLogger>(client_node_, tree);
+    if (binary_log_sink_) {
+      binary_logger = std::make_unique<BinaryBtLogger>(tree, binary_log_sink_);
+    }
+    if (profiler_) {
+      profiler_->addTree(tree);
+    }
   }
 
-  auto xml_string = std::string(
-    std::istreambuf_iterator<char>(xml_file),
-    std::istreambuf_iterator<char>());
-
-  // Create the Behavior Tree from the XML input
-  tree_ = bt_->createTreeFromText(xml_string, blackboard_);
-  topic_logger_ = std::make_unique<RosTopicLogger>(client_node_, tree_);
+  // Keep the current BT to switch back to it later
+  if (!current_bt_xml_filename_.empty()) {
+    CachedTree & previous = tree_cache_[current_bt_xml_filename_];
+    previous.tree = std::move(tree_);
+    previous.topic_logger = std::move(topic_logger_);
+    previous.binary_logger = std::move(binary_logger_);
+  }
 
+  tree_ = std::move(tree);
+  topic_logger_ = std::move(topic_logger);
+  binary_logger_ = std::move(binary_logger);
   current_bt_xml_filename_ = filename;
   return true;
 }
@@ -203,15 +312,19 @@ void BtActionServer<ActionT>::executeCallback()
         on_preempt_callback_(action_server_->get_pending_goal());
       }
       topic_logger_->flush();
+      publishBtStatistics(false);
       on_loop_callback_();
     };
 
   // Execute the BT that was previously created in the configure step
-  nav2_behavior_tree::BtStatus rc = bt_->run(&tree_, on_loop, is_canceling, bt_loop_duration_);
+  nav2_behavior_tree::BtStatus rc = bt_->run(
+    &tree_, on_loop, is_canceling, bt_loop_duration_,
+    event_driven_ ? callback_group_executor_ : nullptr);
 
   // Make sure that the Bt is not in a running state from a previous execution
   // note: if all the ControlNodes are implemented correctly, this is not needed.
   bt_->haltAllActions(tree_.rootNode());
+  publishBtStatistics(true);
 
   // Give server an opportunity to populate the result message or simple give
   // an indication that the action is complete.
@@ -236,6 +349,27 @@ void BtActionServer<ActionT>::executeCallback()
   }
 }
 
+template<class ActionT>
+void BtActionServer<ActionT>::publishBtStatistics(bool force)
+{
+  if (!profiler_ || bt_statistics_pub_->get_subscription_count() == 0) {
+    return;
+  }
+
+  const auto now = std::chrono::steady_clock::now();
+  if (!force &&
+    std::chrono::duration<double>(now - bt_statistics_published_).count() <
+    bt_statistics_period_)
+  {
+    return;
+  }
+  bt_statistics_published_ = now;
+
+  auto msg = std::make_unique<nav2_msgs::msg::BehaviorTreeStatistics>(profiler_->toMsg());
+  msg->header.stamp = clock_->now();
+  bt_statistics_pub_->publish(std::move(msg));
+}
+
 }  // namespace nav2_behavior_tree
 
 #endif  // NAV2_BEHAVIOR_TREE__BT_ACTION_SERVER_IMPL_HPP_
@@ -0,0 +1,53 @@
+// Copyright (c) 2021 Samsung Research America
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef NAV2_BEHAVIOR_TREE__BT_CALLBACK_GROUP_EXECUTOR_HPP_
+#define NAV2_BEHAVIOR_TREE__BT_CALLBACK_GROUP_EXECUTOR_HPP_
+
+#include <memory>
+
+#include "behaviortree_cpp_v3/blackboard.h"
+#include "rclcpp/rclcpp.hpp"
+
+namespace nav2_behavior_tree
+{
+
+/**
+ * @brief Add the callback group of a BT node to the executor that spins it.
+ * When the tree is run event-driven, all of its nodes share the executor put on the
+ * blackboard as "callback_group_executor", so that the BT engine can wait on it for
+ * the next event between ticks. Otherwise each node gets an executor of its own.
+ * @param blackboard Blackboard of the BT node
+ * @param callback_group Callback group of the BT node
+ * @param node ROS node the callback group was created for
+ * @return std::shared_ptr<rclcpp::executors::SingleThreadedExecutor> Executor spinning
+ * the callback group
+ */
+inline std::shared_ptr<rclcpp::executors::SingleThreadedExecutor>
+addToCallbackGroupExecutor(
+  const BT::Blackboard::Ptr & blackboard,
+  const rclcpp::CallbackGroup::SharedPtr & callback_group,
+  const rclcpp::Node::SharedPtr & node)
+{
+  std::shared_ptr<rclcpp::executors::SingleThreadedExecutor> executor;
+  if (!blackboard->get("callback_group_executor", executor) || !executor) {
+    executor = std::make_shared<rclcpp::executors::SingleThreadedExecutor>();
+  }
+  executor->add_callback_group(callback_group, node->get_node_base_interface());
+  return executor;
+}
+
+}  // namespace nav2_behavior_tree
+
+#endif  // NAV2_BEHAVIOR_TREE__BT_CALLBACK_GROUP_EXECUTOR_HPP_
@@ -23,6 +23,9 @@
 #include "nav2_util/node_utils.hpp"
 #include "rclcpp_action/rclcpp_action.hpp"
 #include "nav2_behavior_tree/bt_conversions.hpp"
+#include "nav2_behavior_tree/bt_callback_group_executor.hpp"
+#include "nav2_behavior_tree/bt_client_registry.hpp"
+#include "nav2_behavior_tree/bt_profiler.hpp"
 
 namespace nav2_behavior_tree
 {
@@ -48,10 +51,20 @@ public:
   : BT::ActionNodeBase(xml_tag_name, conf), action_name_(action_name)
   {
     node_ = config().blackboard->template get<rclcpp::Node::SharedPtr>("node");
-    callback_group_ = node_->create_callback_group(
-      rclcpp::CallbackGroupType::MutuallyExclusive,
-      false);
-    callback_group_executor_.add_callback_group(callback_group_, node_->get_node_base_interface());
+    if (config().blackboard->get("client_registry", client_registry_) && client_registry_) {
+      // Share the clients of the tree and the executor spinning them
+      callback_group_ = client_registry_->getCallbackGroup();
+      callback_group_executor_ = client_registry_->getExecutor();
+    } else {
+      callback_group_ = node_->create_callback_group(
+        rclcpp::CallbackGroupType::MutuallyExclusive,
+        false);
+      callback_group_executor_ =
+        addToCallbackGroupExecutor(config().blackboard, callback_group_, node_);
+    }
+
+    // Report to the profiler, if profiling is enabled
+    config().blackboard->get("bt_profiler", profiler_);
 
     // Get the required items from the blackboard
     server_timeout_ =
@@ -83,7 +96,11 @@ public:
   void createActionClient(const std::string & action_name)
   {
     // Now that we have the ROS node to use, create the action client for this BT action
-    action_client_ = rclcpp_action::create_client<ActionT>(node_, action_name, callback_group_);
+    if (client_registry_) {
+      action_client_ = client_registry_->template getActionClient<ActionT>(action_name);
+    } else {
+      action_client_ = rclcpp_action::create_client<ActionT>(node_, action_name, callback_group_);
+    }
 
     // Make sure the server is actually there before continuing
     RCLCPP_DEBUG(node_->get_logger(), "Waiting for \"%s\" action server", action_name.c_str());
@@ -126,6 +143,8 @@ public:
    */
   BT::NodeStatus tick() override
   {
+    BtProfiler::ScopedTick profiled_tick(profiler_.get(), *this);
+
     // setting the status to RUNNING to notify the BT Loggers (if any)
     setStatus(BT::NodeStatus::RUNNING);
 
@@ -136,7 +155,7 @@ public:
 
     auto future_cancel = action_client_->async_cancel_goals_before(goal_expiry_time);
 
-    if (callback_group_executor_.spin_until_future_complete(future_cancel, server_timeout_) !=
+    if (callback_group_executor_->spin_until_future_complete(future_cancel, server_timeout_) !=
       rclcpp::FutureReturnCode::SUCCESS)
     {
       RCLCPP_ERROR(
@@ -154,7 +173,9 @@ protected:
   // The node that will be used for any ROS operations
   rclcpp::Node::SharedPtr node_;
   rclcpp::CallbackGroup::SharedPtr callback_group_;
-  rclcpp::executors::SingleThreadedExecutor callback_group_executor_;
+  std::shared_ptr<rclcpp::executors::SingleThreadedExecutor> callback_group_executor_;
+  BtClientRegistry::Ptr client_registry_;
+  BtProfiler::Ptr profiler_;
 
   // The timeout value while waiting for response from a server when a
   // new action goal is canceled
@@ -0,0 +1,126 @@
+// Copyright (c) 2021 Samsung Research America
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef NAV2_BEHAVIOR_TREE__BT_CLIENT_REGISTRY_HPP_
+#define NAV2_BEHAVIOR_TREE__BT_CLIENT_REGISTRY_HPP_
+
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <typeindex>
+#include <utility>
+
+#include "rclcpp/rclcpp.hpp"
+#include "rclcpp_action/rclcpp_action.hpp"
+
+namespace nav2_behavior_tree
+{
+
+/**
+ * @class nav2_behavior_tree::BtClientRegistry
+ * @brief Action and service clients shared by the BT nodes of a blackboard.
+ * BT nodes talking to the same server with the same type get the same client, created
+ * once in a single callback group that is spun by the executor shared by the BT nodes.
+ * Goals and requests stay separated by their own goal handles and futures.
+ */
+class BtClientRegistry
+{
+public:
+  typedef std::shared_ptr<BtClientRegistry> Ptr;
+
+  /**
+   * @brief A constructor for nav2_behavior_tree::BtClientRegistry
+   * @param node ROS node the clients are created for
+   * @param executor Executor shared by the BT nodes, spinning the clients' callback group
+   */
+  BtClientRegistry(
+    const rclcpp::Node::SharedPtr & node,
+    const std::shared_ptr<rclcpp::executors::SingleThreadedExecutor> & executor)
+  : node_(node), executor_(executor)
+  {
+    callback_group_ = node_->create_callback_group(
+      rclcpp::CallbackGroupType::MutuallyExclusive,
+      false);
+    executor_->add_callback_group(callback_group_, node_->get_node_base_interface());
+  }
+
+  /**
+   * @brief Get the action client for an action server, creating it on first use
+   * @tparam ActionT Type of action
+   * @param action_name Action name to get the client for
+   * @return std::shared_ptr<rclcpp_action::Client<ActionT>> Shared action client
+   */
+  template<class ActionT>
+  std::shared_ptr<rclcpp_action::Client<ActionT>> getActionClient(const std::string & action_name)
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    auto & client = clients_[Key(action_name, std::type_index(typeid(ActionT)))];
+    if (!client) {
+      client = rclcpp_action::create_client<ActionT>(node_, action_name, callback_group_);
+    }
+    return std::static_pointer_cast<rclcpp_action::Client<ActionT>>(client);
+  }
+
+  /**
+   * @brief Get the service client for a service, creating it on first use
+   * @tparam ServiceT Type of service
+   * @param service_name Service name to get the client for
+   * @return std::shared_ptr<rclcpp::Client<ServiceT>> Shared service client
+   */
+  template<class ServiceT>
+  std::shared_ptr<rclcpp::Client<ServiceT>> getServiceClient(const std::string & service_name)
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    auto & client = clients_[Key(service_name, std::type_index(typeid(ServiceT)))];
+    if (!client) {
+      client = node_->create_client<ServiceT>(
+        service_name,
+        rmw_qos_profile_services_default,
+        callback_group_);
+    }
+    return std::static_pointer_cast<rclcpp::Client<ServiceT>>(client);
+  }
+
+  /**
+   * @brief Get the callback group of the shared clients
+   * @return rclcpp::CallbackGroup::SharedPtr Callback group
+   */
+  rclcpp::CallbackGroup::SharedPtr getCallbackGroup() const
+  {
+    return callback_group_;
+  }
+
+  /**
+   * @brief Get the executor spinning the shared clients
+   * @return std::shared_ptr<rclcpp::executors::SingleThreadedExecutor> Executor
+   */
+  std::shared_ptr<rclcpp::executors::SingleThreadedExecutor> getExecutor() const
+  {
+    return executor_;
+  }
+
+protected:
+  typedef std::pair<std::string, std::type_index> Key;
+
+  rclcpp::Node::SharedPtr node_;
+  std::shared_ptr<rclcpp::executors::SingleThreadedExecutor> executor_;
+  rclcpp::CallbackGroup::SharedPtr callback_group_;
+  std::map<Key, std::shared_ptr<void>> clients_;
+  std::mutex mutex_;
+};
+
+}  // namespace nav2_behavior_tree
+
+#endif  // NAV2_BEHAVIOR_TREE__BT_CLIENT_REGISTRY_HPP_
@@ -0,0 +1,190 @@
+// Copyright (c) 2021 Samsung Research America
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef NAV2_BEHAVIOR_TREE__BT_PROFILER_HPP_
+#define NAV2_BEHAVIOR_TREE__BT_PROFILER_HPP_
+
+#include <chrono>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "behaviortree_cpp_v3/bt_factory.h"
+#include "behaviortree_cpp_v3/loggers/abstract_logger.h"
+#include "nav2_msgs/msg/behavior_tree_statistics.hpp"
+
+namespace nav2_behavior_tree
+{
+
+/**
+ * @class nav2_behavior_tree::BtProfiler
+ * @brief Per node profile of the BTs of a BT server: ticks and time spent in tick(),
+ * executions and time spent RUNNING, and round trips of the action goals.
+ * It is put on the blackboard as "bt_profiler" when profiling is enabled, the BT nodes
+ * then report to it. Without it, they only test for a null pointer.
+ */
+class BtProfiler
+{
+public:
+  typedef std::shared_ptr<BtProfiler> Ptr;
+  typedef std::chrono::steady_clock Clock;
+
+  /**
+   * @brief Profile of a BT node
+   */
+  struct NodeProfile
+  {
+    std::string name;
+    std::string type;
+
+    uint64_t ticks{0};
+    Clock::duration tick_time{0};
+    Clock::duration max_tick_time{0};
+
+    uint64_t runs{0};
+    Clock::duration running_time{0};
+    uint64_t successes{0};
+    uint64_t failures{0};
+
+    uint64_t goals{0};
+    uint64_t accepted_goals{0};
+    Clock::duration accept_latency{0};
+    Clock::duration max_accept_latency{0};
+    uint64_t results{0};
+    Clock::duration result_latency{0};
+    Clock::duration max_result_latency{0};
+
+    Clock::time_point running_since;
+    Clock::time_point goal_sent;
+  };
+
+  /**
+   * @class nav2_behavior_tree::BtProfiler::ScopedTick
+   * @brief Measures a tick of a BT node from its construction to its destruction,
+   * to be put at the beginning of tick(). Does nothing without a profiler.
+   */
+  class ScopedTick
+  {
+public:
+    /**
+     * @brief A constructor for nav2_behavior_tree::BtProfiler::ScopedTick
+     * @param profiler Profiler to report the tick to, may be null
+     * @param node BT node being ticked
+     */
+    ScopedTick(BtProfiler * profiler, const BT::TreeNode & node)
+    : profiler_(profiler), node_(node)
+    {
+      if (profiler_) {
+        start_ = Clock::now();
+      }
+    }
+
+    ~ScopedTick()
+    {
+      if (profiler_) {
+        profiler_->recordTick(node_, Clock::now() - start_);
+      }
+    }
+
+protected:
+    BtProfiler * profiler_;
+    const BT::TreeNode & node_;
+    Clock::time_point start_;
+  };
+
+  /**
+   * @brief A constructor for nav2_behavior_tree::BtProfiler
+   */
+  BtProfiler();
+
+  /**
+   * @brief A destructor for nav2_behavior_tree::BtProfiler
+   */
+  ~BtProfiler();
+
+  /**
+   * @brief Profile the nodes of a tree, and follow their status changes
+   * @param tree BT to profile, expected to outlive the profiler
+   */
+  void addTree(const BT::Tree & tree);
+
+  /**
+   * @brief Record a tick of a BT node
+   * @param node BT node ticked
+   * @param duration Time spent in tick()
+   */
+  void recordTick(const BT::TreeNode & node, Clock::duration duration);
+
+  /**
+   * @brief Record a goal sent by an action node
+   * @param node BT node sending the goal
+   */
+  void recordGoalSent(const BT::TreeNode & node);
+
+  /**
+   * @brief Record the acceptance of the last goal sent by an action node
+   * @param node BT node which sent the goal
+   */
+  void recordGoalAccepted(const BT::TreeNode & node);
+
+  /**
+   * @brief Record the result of the last goal sent by an action node
+   * @param node BT node which sent the goal
+   */
+  void recordGoalResult(const BT::TreeNode & node);
+
+  /**
+   * @brief Get the profiles of the nodes as a message, without its header
+   * @return nav2_msgs::msg::BehaviorTreeStatistics Profiles of the nodes
+   */
+  nav2_msgs::msg::BehaviorTreeStatistics toMsg() const;
+
+  /**
+   * @brief Get the profiles of the nodes as a table, the most expensive nodes first
+   * @return std::string Report of the profiles
+   */
+  std::string report() const;
+
+protected:
+  /**
+   * @brief Get the profile of a node, with mutex_ locked
+   * @param node BT node
+   * @return NodeProfile & Profile of the node, created on first use
+   */
+  NodeProfile & profile(const BT::TreeNode & node);
+
+  /**
+   * @brief Record a status change of a node
+   * @param node BT node that changed status
+   * @param prev_status Previous status of the node
+   * @param status Current status of the node
+   */
+  void recordStatusChange(
+    const BT::TreeNode & node,
+    BT::NodeStatus prev_status,
+    BT::NodeStatus status);
+
+  class StatusChangeRecorder;
+
+  std::unordered_map<const BT::TreeNode *, NodeProfile> profiles_;
+  std::vector<const BT::TreeNode *> order_;
+  std::vector<std::unique_ptr<BT::StatusChangeLogger>> recorders_;
+  mutable std::mutex mutex_;
+};
+
+}  // namespace nav2_behavior_tree
+
+#endif  // NAV2_BEHAVIOR_TREE__BT_PROFILER_HPP_
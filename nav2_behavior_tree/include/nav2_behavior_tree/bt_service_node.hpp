@@ -22,6 +22,9 @@
 #include "nav2_util/node_utils.hpp"
 #include "rclcpp/rclcpp.hpp"
 #include "nav2_behavior_tree/bt_conversions.hpp"
+#include "nav2_behavior_tree/bt_callback_group_executor.hpp"
+#include "nav2_behavior_tree/bt_client_registry.hpp"
+#include "nav2_behavior_tree/bt_profiler.hpp"
 
 namespace nav2_behavior_tree
 {
@@ -45,10 +48,20 @@ public:
   : BT::ActionNodeBase(service_node_name, conf), service_node_name_(service_node_name)
   {
     node_ = config().blackboard->template get<rclcpp::Node::SharedPtr>("node");
-    callback_group_ = node_->create_callback_group(
-      rclcpp::CallbackGroupType::MutuallyExclusive,
-      false);
-    callback_group_executor_.add_callback_group(callback_group_, node_->get_node_base_interface());
+    if (config().blackboard->get("client_registry", client_registry_) && client_registry_) {
+      // Share the clients of the tree and the executor spinning them
+      callback_group_ = client_registry_->getCallbackGroup();
+      callback_group_executor_ = client_registry_->getExecutor();
+    } else {
+      callback_group_ = node_->create_callback_group(
+        rclcpp::CallbackGroupType::MutuallyExclusive,
+        false);
+      callback_group_executor_ =
+        addToCallbackGroupExecutor(config().blackboard, callback_group_, node_);
+    }
+
+    // Report to the profiler, if profiling is enabled
+    config().blackboard->get("bt_profiler", profiler_);
 
     // Get the required items from the blackboard
     bt_loop_duration_ =
@@ -59,10 +72,14 @@ public:
 
     // Now that we have node_ to use, create the service client for this BT service
     getInput("service_name", service_name_);
-    service_client_ = node_->create_client<ServiceT>(
-      service_name_,
-      rmw_qos_profile_services_default,
-      callback_group_);
+    if (client_registry_) {
+      service_client_ = client_registry_->template getServiceClient<ServiceT>(service_name_);
+    } else {
+      service_client_ = node_->create_client<ServiceT>(
+        service_name_,
+        rmw_qos_profile_services_default,
+        callback_group_);
+    }
 
     // Make a request for the service without parameter
     request_ = std::make_shared<typename ServiceT::Request>();
@@ -116,6 +133,8 @@ public:
    */
   BT::NodeStatus tick() override
   {
+    BtProfiler::ScopedTick profiled_tick(profiler_.get(), *this);
+
     if (!request_sent_) {
       on_tick();
       future_result_ = service_client_->async_send_request(request_).share();
@@ -165,7 +184,7 @@ public:
       auto timeout = remaining > bt_loop_duration_ ? bt_loop_duration_ : remaining;
 
       rclcpp::FutureReturnCode rc;
-      rc = callback_group_executor_.spin_until_future_complete(future_result_, server_timeout_);
+      rc = callback_group_executor_->spin_until_future_complete(future_result_, server_timeout_);
       if (rc == rclcpp::FutureReturnCode::SUCCESS) {
         request_sent_ = false;
         BT::NodeStatus status = on_completion();
@@ -215,7 +234,9 @@ protected:
   // The node that will be used for any ROS operations
   rclcpp::Node::SharedPtr node_;
   rclcpp::CallbackGroup::SharedPtr callback_group_;
-  rclcpp::executors::SingleThreadedExecutor callback_group_executor_;
+  std::shared_ptr<rclcpp::executors::SingleThreadedExecutor> callback_group_executor_;
+  BtClientRegistry::Ptr client_registry_;
+  BtProfiler::Ptr profiler_;
 
   // The timeout value while to use in the tick loop while waiting for
   // a result from the server
@@ -44,6 +44,13 @@ public:
     const std::string & action_name,
     const BT::NodeConfiguration & conf);
 
+  /**
+   * @brief The main override required by a BT action. Outputs the prefetched path
+   * instead of calling the planner server when it was computed for the current goals
+   * @return BT::NodeStatus Status of tick execution
+   */
+  BT::NodeStatus tick() override;
+
   /**
    * @brief Function to perform some user-defined operation on tick
    */
@@ -62,7 +69,8 @@ public:
   {
     return providedBasicPorts(
       {
-        BT::OutputPort<nav_msgs::msg::Path>("path", "Path created by ComputePathThroughPoses node"),
+        BT::OutputPort<nav_msgs::msg::Path::ConstSharedPtr>(
+          "path", "Path created by ComputePathThroughPoses node"),
         BT::InputPort<std::vector<geometry_msgs::msg::PoseStamped>>(
           "goals",
           "Destinations to plan through"),
@@ -71,8 +79,23 @@ public:
         BT::InputPort<std::string>(
           "planner_id", "",
           "Mapped name to the planner plugin type to use"),
+        BT::InputPort<nav_msgs::msg::Path::ConstSharedPtr>(
+          "prefetched_path", "Path computed ahead of time through prefetched_goals"),
+        BT::InputPort<std::vector<geometry_msgs::msg::PoseStamped>>(
+          "prefetched_goals", "Goals the prefetched path was computed through"),
       });
   }
+
+protected:
+  /**
+   * @brief Output the prefetched path if it was computed for the current goals,
+   * and was not used yet
+   * @return bool true if the prefetched path was used
+   */
+  bool usePrefetchedPath();
+
+  // Stamp of the last prefetched path used, so that it is used only once
+  builtin_interfaces::msg::Time prefetched_path_stamp_;
 };
 
 }  // namespace nav2_behavior_tree
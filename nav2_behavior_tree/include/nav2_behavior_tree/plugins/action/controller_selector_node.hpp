@@ -24,6 +24,7 @@
 #include "behaviortree_cpp_v3/action_node.h"
 
 #include "rclcpp/rclcpp.hpp"
+#include "nav2_behavior_tree/bt_callback_group_executor.hpp"
 
 namespace nav2_behavior_tree
 {
@@ -89,7 +90,7 @@ private:
 
   rclcpp::Node::SharedPtr node_;
   rclcpp::CallbackGroup::SharedPtr callback_group_;
-  rclcpp::executors::SingleThreadedExecutor callback_group_executor_;
+  std::shared_ptr<rclcpp::executors::SingleThreadedExecutor> callback_group_executor_;
 
   std::string topic_name_;
 };
@@ -59,11 +59,15 @@ public:
   {
     return providedBasicPorts(
       {
-        BT::InputPort<nav_msgs::msg::Path>("path", "Path to follow"),
+        BT::InputPort<nav_msgs::msg::Path::ConstSharedPtr>("path", "Path to follow"),
         BT::InputPort<std::string>("controller_id", ""),
         BT::InputPort<std::string>("goal_checker_id", ""),
       });
   }
+
+private:
+  // Path of the goal, the input only being compared to it when another one was set
+  nav_msgs::msg::Path::ConstSharedPtr path_;
 };
 
 }  // namespace nav2_behavior_tree
@@ -47,6 +47,11 @@ public:
    */
   void on_tick() override;
 
+  /**
+   * @brief Function to set the segments smoothed so far to the output, when streamed
+   */
+  void on_wait_for_result() override;
+
   /**
    * @brief Function to perform some user-defined operation upon successful completion of the action
    */
@@ -60,13 +65,14 @@ public:
   {
     return providedBasicPorts(
       {
-        BT::OutputPort<nav_msgs::msg::Path>(
+        BT::OutputPort<nav_msgs::msg::Path::ConstSharedPtr>(
           "smoothed_path",
-          "Path smoothed by SmootherServer node"),
+          "Path smoothed by SmootherServer node, or its leading segments while streamed"),
         BT::OutputPort<double>("smoothing_duration", "Time taken to smooth path"),
         BT::OutputPort<bool>(
           "was_completed", "True if smoothing was not interrupted by time limit"),
-        BT::InputPort<nav_msgs::msg::Path>("unsmoothed_path", "Path to be smoothed"),
+        BT::InputPort<nav_msgs::msg::Path::ConstSharedPtr>(
+          "unsmoothed_path", "Path to be smoothed"),
         BT::InputPort<double>("max_smoothing_duration", 3.0, "Maximum smoothing duration"),
         BT::InputPort<bool>(
           "check_for_collisions", false,
@@ -74,6 +80,9 @@ public:
         BT::InputPort<std::string>("smoother_id", ""),
       });
   }
+
+private:
+  std::shared_ptr<const nav2_msgs::action::SmoothPath::Feedback> last_feedback_;
 };
 
 }  // namespace nav2_behavior_tree
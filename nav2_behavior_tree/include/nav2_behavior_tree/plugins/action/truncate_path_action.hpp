@@ -48,8 +48,9 @@ public:
   static BT::PortsList providedPorts()
   {
     return {
-      BT::InputPort<nav_msgs::msg::Path>("input_path", "Original Path"),
-      BT::OutputPort<nav_msgs::msg::Path>("output_path", "Path truncated to a certain distance"),
+      BT::InputPort<nav_msgs::msg::Path::ConstSharedPtr>("input_path", "Original Path"),
+      BT::OutputPort<nav_msgs::msg::Path::ConstSharedPtr>(
+        "output_path", "Path truncated to a certain distance"),
       BT::InputPort<double>("distance", 1.0, "distance"),
     };
   }
@@ -67,6 +68,9 @@ private:
   BT::NodeStatus tick() override;
 
   double distance_;
+  // Last path truncated and its truncation, output again while the input path is unchanged
+  nav_msgs::msg::Path::ConstSharedPtr input_path_;
+  nav_msgs::msg::Path::ConstSharedPtr output_path_;
 };
 
 }  // namespace nav2_behavior_tree
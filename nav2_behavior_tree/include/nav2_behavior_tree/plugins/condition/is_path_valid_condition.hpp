@@ -21,6 +21,7 @@
 #include "rclcpp/rclcpp.hpp"
 #include "behaviortree_cpp_v3/condition_node.h"
 #include "geometry_msgs/msg/pose_stamped.hpp"
+#include "nav_msgs/msg/path.hpp"
 #include "nav2_msgs/srv/is_path_valid.hpp"
 
 namespace nav2_behavior_tree
@@ -28,7 +29,8 @@ namespace nav2_behavior_tree
 
 /**
  * @brief A BT::ConditionNode that returns SUCCESS when the IsPathValid
- * service returns true and FAILURE otherwise
+ * service returns true and FAILURE otherwise. A path is only sent once, then
+ * checked by the identifier the service registered it with, until it changes.
  */
 class IsPathValidCondition : public BT::ConditionNode
 {
@@ -57,14 +59,27 @@ public:
   static BT::PortsList providedPorts()
   {
     return {
-      BT::InputPort<nav_msgs::msg::Path>("path", "Path to Check"),
+      BT::InputPort<nav_msgs::msg::Path::ConstSharedPtr>("path", "Path to Check"),
       BT::InputPort<std::chrono::milliseconds>("server_timeout")
     };
   }
 
 private:
+  /**
+   * @brief Whether a path is the one last registered by the service, comparing its
+   * header, size and ends rather than all of its poses
+   */
+  bool isRegisteredPath(const nav_msgs::msg::Path & path) const;
+
   rclcpp::Node::SharedPtr node_;
   rclcpp::Client<nav2_msgs::srv::IsPathValid>::SharedPtr client_;
+  // Identifier of the path last registered by the service, 0 if there is none,
+  // and what tells that path apart
+  uint32_t path_id_;
+  std_msgs::msg::Header registered_header_;
+  size_t registered_size_;
+  geometry_msgs::msg::PoseStamped registered_front_;
+  geometry_msgs::msg::PoseStamped registered_back_;
   // The timeout value while waiting for a responce from the
   // is path valid service
   std::chrono::milliseconds server_timeout_;
@@ -56,14 +56,14 @@ public:
   {
     return {
       BT::InputPort<double>("seconds", 1.0, "Seconds"),
-      BT::InputPort<nav_msgs::msg::Path>("path")
+      BT::InputPort<nav_msgs::msg::Path::ConstSharedPtr>("path")
     };
   }
 
 private:
   rclcpp::Node::SharedPtr node_;
   rclcpp::Time start_;
-  nav_msgs::msg::Path prev_path_;
+  nav_msgs::msg::Path::ConstSharedPtr prev_path_;
   double period_;
   bool first_time_;
 };
@@ -48,7 +48,7 @@ public:
   static BT::PortsList providedPorts()
   {
     return {
-      BT::InputPort<nav_msgs::msg::Path>("path", "Planned Path"),
+      BT::InputPort<nav_msgs::msg::Path::ConstSharedPtr>("path", "Planned Path"),
       BT::InputPort<double>(
         "prox_len", 3.0,
         "Proximity length (m) for the path to be longer on approach"),
@@ -72,8 +72,8 @@ private:
    * @return whether the path is updated for the current goal
    */
   bool isPathUpdated(
-    nav_msgs::msg::Path & new_path,
-    nav_msgs::msg::Path & old_path);
+    const nav_msgs::msg::Path::ConstSharedPtr & new_path,
+    const nav_msgs::msg::Path::ConstSharedPtr & old_path);
 
   /**
    * @brief Checks if the robot is in the goal proximity
@@ -82,7 +82,7 @@ private:
    * @return whether the robot is in the goal proximity
    */
   bool isRobotInGoalProximity(
-    nav_msgs::msg::Path & old_path,
+    const nav_msgs::msg::Path & old_path,
     double & prox_leng);
 
   /**
@@ -93,13 +93,13 @@ private:
    * @return whether the new path is longer
    */
   bool isNewPathLonger(
-    nav_msgs::msg::Path & new_path,
-    nav_msgs::msg::Path & old_path,
+    const nav_msgs::msg::Path & new_path,
+    const nav_msgs::msg::Path & old_path,
     double & length_factor);
 
 private:
-  nav_msgs::msg::Path new_path_;
-  nav_msgs::msg::Path old_path_;
+  nav_msgs::msg::Path::ConstSharedPtr new_path_;
+  nav_msgs::msg::Path::ConstSharedPtr old_path_;
   double prox_len_ = std::numeric_limits<double>::max();
   double length_factor_ = std::numeric_limits<double>::max();
   rclcpp::Node::SharedPtr node_;
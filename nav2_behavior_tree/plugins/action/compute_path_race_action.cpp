@@ -0,0 +1,77 @@
+// Copyright (c) 2021 Samsung Research America
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <memory>
+#include <sstream>
+#include <string>
+
+#include "nav2_behavior_tree/plugins/action/compute_path_race_action.hpp"
+
+namespace nav2_behavior_tree
+{
+
+ComputePathRaceAction::ComputePathRaceAction(
+  const std::string & xml_tag_name,
+  const std::string & action_name,
+  const BT::NodeConfiguration & conf)
+: BtActionNode<nav2_msgs::action::ComputePathToPose>(xml_tag_name, action_name, conf)
+{
+}
+
+void ComputePathRaceAction::on_tick()
+{
+  getInput("goal", goal_.goal);
+  if (getInput("start", goal_.start)) {
+    goal_.use_start = true;
+  }
+
+  std::string planner_ids;
+  getInput("planner_ids", planner_ids);
+  goal_.race_planner_ids.clear();
+  std::istringstream planner_ids_stream(planner_ids);
+  std::string planner_id;
+  while (std::getline(planner_ids_stream, planner_id, ';')) {
+    if (!planner_id.empty()) {
+      goal_.race_planner_ids.push_back(planner_id);
+    }
+  }
+
+  double deadline = 0.0;
+  getInput("deadline", deadline);
+  goal_.race_deadline = rclcpp::Duration::from_seconds(deadline);
+}
+
+BT::NodeStatus ComputePathRaceAction::on_success()
+{
+  // The path is shared with the result rather than copied
+  setOutput("path", nav_msgs::msg::Path::ConstSharedPtr(result_.result, &result_.result->path));
+  setOutput("winner_id", result_.result->planner_id);
+  return BT::NodeStatus::SUCCESS;
+}
+
+}  // namespace nav2_behavior_tree
+
+#include "behaviortree_cpp_v3/bt_factory.h"
+BT_REGISTER_NODES(factory)
+{
+  BT::NodeBuilder builder =
+    [](const std::string & name, const BT::NodeConfiguration & config)
+    {
+      return std::make_unique<nav2_behavior_tree::ComputePathRaceAction>(
+        name, "compute_path_to_pose", config);
+    };
+
+  factory.registerBuilder<nav2_behavior_tree::ComputePathRaceAction>(
+    "ComputePathRace", builder);
+}
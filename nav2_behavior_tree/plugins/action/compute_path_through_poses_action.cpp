@@ -29,6 +29,14 @@ ComputePathThroughPosesAction::ComputePathThroughPosesAction(
 {
 }
 
+BT::NodeStatus ComputePathThroughPosesAction::tick()
+{
+  if (status() == BT::NodeStatus::IDLE && usePrefetchedPath()) {
+    return BT::NodeStatus::SUCCESS;
+  }
+  return BtActionNode<nav2_msgs::action::ComputePathThroughPoses>::tick();
+}
+
 void ComputePathThroughPosesAction::on_tick()
 {
   getInput("goals", goal_.goals);
@@ -40,10 +48,36 @@ void ComputePathThroughPosesAction::on_tick()
 
 BT::NodeStatus ComputePathThroughPosesAction::on_success()
 {
-  setOutput("path", result_.result->path);
+  // The path is shared with the result rather than copied
+  setOutput("path", nav_msgs::msg::Path::ConstSharedPtr(result_.result, &result_.result->path));
   return BT::NodeStatus::SUCCESS;
 }
 
+bool ComputePathThroughPosesAction::usePrefetchedPath()
+{
+  nav_msgs::msg::Path::ConstSharedPtr prefetched_path;
+  std::vector<geometry_msgs::msg::PoseStamped> prefetched_goals, goals;
+  geometry_msgs::msg::PoseStamped start;
+  if (!getInput("prefetched_path", prefetched_path) ||
+    !getInput("prefetched_goals", prefetched_goals) ||
+    !getInput("goals", goals) || getInput("start", start))
+  {
+    return false;
+  }
+
+  if (!prefetched_path || prefetched_path->poses.empty() ||
+    prefetched_path->header.stamp == prefetched_path_stamp_ || prefetched_goals != goals)
+  {
+    return false;
+  }
+
+  // Only once: the next replanning takes the obstacles seen since then into account
+  prefetched_path_stamp_ = prefetched_path->header.stamp;
+  RCLCPP_DEBUG(node_->get_logger(), "Using the path prefetched through %lu goals", goals.size());
+  setOutput("path", prefetched_path);
+  return true;
+}
+
 }  // namespace nav2_behavior_tree
 
 #include "behaviortree_cpp_v3/bt_factory.h"
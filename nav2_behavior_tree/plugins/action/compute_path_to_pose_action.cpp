@@ -39,7 +39,8 @@ void ComputePathToPoseAction::on_tick()
 
 BT::NodeStatus ComputePathToPoseAction::on_success()
 {
-  setOutput("path", result_.result->path);
+  // The path is shared with the result rather than copied
+  setOutput("path", nav_msgs::msg::Path::ConstSharedPtr(result_.result, &result_.result->path));
   return BT::NodeStatus::SUCCESS;
 }
 
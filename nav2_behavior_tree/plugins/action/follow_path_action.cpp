@@ -30,22 +30,29 @@ FollowPathAction::FollowPathAction(
 
 void FollowPathAction::on_tick()
 {
-  getInput("path", goal_.path);
+  nav_msgs::msg::Path::ConstSharedPtr path;
+  if (getInput("path", path) && path) {
+    goal_.path = *path;
+  }
+  path_ = path;
   getInput("controller_id", goal_.controller_id);
   getInput("goal_checker_id", goal_.goal_checker_id);
 }
 
 void FollowPathAction::on_wait_for_result()
 {
-  // Grab the new path
-  nav_msgs::msg::Path new_path;
+  // Grab the new path, only looked at when another one was set
+  nav_msgs::msg::Path::ConstSharedPtr new_path;
   getInput("path", new_path);
 
   // Check if it is not same with the current one
-  if (goal_.path != new_path) {
-    // the action server on the next loop iteration
-    goal_.path = new_path;
-    goal_updated_ = true;
+  if (new_path && new_path != path_) {
+    path_ = new_path;
+    if (goal_.path != *new_path) {
+      // the action server on the next loop iteration
+      goal_.path = *new_path;
+      goal_updated_ = true;
+    }
   }
 
   std::string new_controller_id;
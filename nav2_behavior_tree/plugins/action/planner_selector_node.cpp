@@ -36,7 +36,8 @@ PlannerSelector::PlannerSelector(
   callback_group_ = node_->create_callback_group(
     rclcpp::CallbackGroupType::MutuallyExclusive,
     false);
-  callback_group_executor_.add_callback_group(callback_group_, node_->get_node_base_interface());
+  callback_group_executor_ =
+    addToCallbackGroupExecutor(config().blackboard, callback_group_, node_);
 
   getInput("topic_name", topic_name_);
 
@@ -54,7 +55,7 @@ PlannerSelector::PlannerSelector(
 
 BT::NodeStatus PlannerSelector::tick()
 {
-  callback_group_executor_.spin_some();
+  callback_group_executor_->spin_some();
 
   // This behavior always use the last selected planner received from the topic input.
   // When no input is specified it uses the default planner.
@@ -31,7 +31,10 @@ SmoothPathAction::SmoothPathAction(
 
 void SmoothPathAction::on_tick()
 {
-  getInput("unsmoothed_path", goal_.path);
+  nav_msgs::msg::Path::ConstSharedPtr unsmoothed_path;
+  if (getInput("unsmoothed_path", unsmoothed_path) && unsmoothed_path) {
+    goal_.path = *unsmoothed_path;
+  }
   getInput("smoother_id", goal_.smoother_id);
   double max_smoothing_duration;
   getInput("max_smoothing_duration", max_smoothing_duration);
@@ -39,9 +42,23 @@ void SmoothPathAction::on_tick()
   getInput("check_for_collisions", goal_.check_for_collisions);
 }
 
+void SmoothPathAction::on_wait_for_result()
+{
+  // Streamed segments are given out as soon as they are smoothed, ahead of the whole path
+  if (feedback_ && feedback_ != last_feedback_) {
+    last_feedback_ = feedback_;
+    setOutput(
+      "smoothed_path",
+      nav_msgs::msg::Path::ConstSharedPtr(feedback_, &feedback_->path));
+  }
+}
+
 BT::NodeStatus SmoothPathAction::on_success()
 {
-  setOutput("smoothed_path", result_.result->path);
+  // The path is shared with the result rather than copied
+  setOutput(
+    "smoothed_path",
+    nav_msgs::msg::Path::ConstSharedPtr(result_.result, &result_.result->path));
   setOutput("smoothing_duration", rclcpp::Duration(result_.result->smoothing_duration).seconds());
   setOutput("was_completed", result_.result->was_completed);
   return BT::NodeStatus::SUCCESS;
@@ -16,6 +16,7 @@
 #include <string>
 #include <memory>
 #include <limits>
+#include <utility>
 
 #include "nav_msgs/msg/path.hpp"
 #include "geometry_msgs/msg/pose_stamped.hpp"
@@ -40,15 +41,27 @@ inline BT::NodeStatus TruncatePath::tick()
 {
   setStatus(BT::NodeStatus::RUNNING);
 
-  nav_msgs::msg::Path input_path;
+  nav_msgs::msg::Path::ConstSharedPtr input_path_ptr;
+  getInput("input_path", input_path_ptr);
+  if (!input_path_ptr) {
+    input_path_ptr = std::make_shared<const nav_msgs::msg::Path>();
+  }
 
-  getInput("input_path", input_path);
+  // The same path is truncated the same
+  if (input_path_ptr == input_path_) {
+    setOutput("output_path", output_path_);
+    return BT::NodeStatus::SUCCESS;
+  }
+  input_path_ = input_path_ptr;
 
-  if (input_path.poses.empty()) {
-    setOutput("output_path", input_path);
+  if (input_path_ptr->poses.empty()) {
+    output_path_ = input_path_ptr;
+    setOutput("output_path", output_path_);
     return BT::NodeStatus::SUCCESS;
   }
 
+  auto input_path = *input_path_ptr;
+
   geometry_msgs::msg::PoseStamped final_pose = input_path.poses.back();
 
   double distance_to_goal = nav2_util::geometry_utils::euclidean_distance(
@@ -75,7 +88,8 @@ inline BT::NodeStatus TruncatePath::tick()
   input_path.poses.back().pose.orientation = nav2_util::geometry_utils::orientationAroundZAxis(
     final_angle);
 
-  setOutput("output_path", input_path);
+  output_path_ = std::make_shared<const nav_msgs::msg::Path>(std::move(input_path));
+  setOutput("output_path", output_path_);
 
   return BT::NodeStatus::SUCCESS;
 }
@@ -36,7 +36,8 @@ IsBatteryLowCondition::IsBatteryLowCondition(
   callback_group_ = node_->create_callback_group(
     rclcpp::CallbackGroupType::MutuallyExclusive,
     false);
-  callback_group_executor_.add_callback_group(callback_group_, node_->get_node_base_interface());
+  callback_group_executor_ =
+    addToCallbackGroupExecutor(config().blackboard, callback_group_, node_);
 
   rclcpp::SubscriptionOptions sub_option;
   sub_option.callback_group = callback_group_;
@@ -49,7 +50,7 @@ IsBatteryLowCondition::IsBatteryLowCondition(
 
 BT::NodeStatus IsBatteryLowCondition::tick()
 {
-  callback_group_executor_.spin_some();
+  callback_group_executor_->spin_some();
   if (is_battery_low_) {
     return BT::NodeStatus::SUCCESS;
   }
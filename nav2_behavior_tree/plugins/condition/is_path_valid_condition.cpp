@@ -23,7 +23,9 @@ namespace nav2_behavior_tree
 IsPathValidCondition::IsPathValidCondition(
   const std::string & condition_name,
   const BT::NodeConfiguration & conf)
-: BT::ConditionNode(condition_name, conf)
+: BT::ConditionNode(condition_name, conf),
+  path_id_(0),
+  registered_size_(0)
 {
   node_ = config().blackboard->get<rclcpp::Node::SharedPtr>("node");
   client_ = node_->create_client<nav2_msgs::srv::IsPathValid>("is_path_valid");
@@ -34,24 +36,58 @@ IsPathValidCondition::IsPathValidCondition(
 
 BT::NodeStatus IsPathValidCondition::tick()
 {
-  nav_msgs::msg::Path path;
-  getInput("path", path);
+  nav_msgs::msg::Path::ConstSharedPtr path_ptr;
+  getInput("path", path_ptr);
+  if (!path_ptr) {
+    path_ptr = std::make_shared<const nav_msgs::msg::Path>();
+  }
+  const nav_msgs::msg::Path & path = *path_ptr;
 
-  auto request = std::make_shared<nav2_msgs::srv::IsPathValid::Request>();
+  if (!isRegisteredPath(path)) {
+    path_id_ = 0;
+  }
 
-  request->path = path;
-  auto result = client_->async_send_request(request);
+  // The path is sent again if the service does not know its identifier anymore
+  for (unsigned int attempt = 0; attempt != 2; ++attempt) {
+    auto request = std::make_shared<nav2_msgs::srv::IsPathValid::Request>();
+    request->path_id = path_id_;
+    if (path_id_ == 0) {
+      request->path = path;
+    }
+    auto result = client_->async_send_request(request);
+
+    if (rclcpp::spin_until_future_complete(node_, result, server_timeout_) !=
+      rclcpp::FutureReturnCode::SUCCESS)
+    {
+      return BT::NodeStatus::FAILURE;
+    }
 
-  if (rclcpp::spin_until_future_complete(node_, result, server_timeout_) ==
-    rclcpp::FutureReturnCode::SUCCESS)
-  {
-    if (result.get()->is_valid) {
-      return BT::NodeStatus::SUCCESS;
+    auto response = result.get();
+    if (request->path_id != 0 && response->path_id == 0) {
+      path_id_ = 0;
+      continue;
     }
+    if (path_id_ == 0 && response->path_id != 0) {
+      path_id_ = response->path_id;
+      registered_header_ = path.header;
+      registered_size_ = path.poses.size();
+      registered_front_ = path.poses.front();
+      registered_back_ = path.poses.back();
+    }
+    return response->is_valid ? BT::NodeStatus::SUCCESS : BT::NodeStatus::FAILURE;
   }
   return BT::NodeStatus::FAILURE;
 }
 
+bool IsPathValidCondition::isRegisteredPath(const nav_msgs::msg::Path & path) const
+{
+  return path_id_ != 0 && !path.poses.empty() &&
+         path.header == registered_header_ &&
+         path.poses.size() == registered_size_ &&
+         path.poses.front() == registered_front_ &&
+         path.poses.back() == registered_back_;
+}
+
 }  // namespace nav2_behavior_tree
 
 #include "behaviortree_cpp_v3/bt_factory.h"
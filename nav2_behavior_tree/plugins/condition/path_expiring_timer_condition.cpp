@@ -43,11 +43,11 @@ BT::NodeStatus PathExpiringTimerCondition::tick()
   }
 
   // Grab the new path
-  nav_msgs::msg::Path path;
+  nav_msgs::msg::Path::ConstSharedPtr path;
   getInput("path", path);
 
-  // Reset timer if the path has been updated
-  if (prev_path_ != path) {
+  // Reset timer if the path has been updated, only compared when another one was set
+  if (path != prev_path_ && (!path || !prev_path_ || *path != *prev_path_)) {
     prev_path_ = path;
     start_ = node_->now();
   }
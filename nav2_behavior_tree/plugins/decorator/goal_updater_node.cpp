@@ -37,7 +37,8 @@ GoalUpdater::GoalUpdater(
   callback_group_ = node_->create_callback_group(
     rclcpp::CallbackGroupType::MutuallyExclusive,
     false);
-  callback_group_executor_.add_callback_group(callback_group_, node_->get_node_base_interface());
+  callback_group_executor_ =
+    addToCallbackGroupExecutor(config().blackboard, callback_group_, node_);
 
   std::string goal_updater_topic;
   node_->get_parameter_or<std::string>("goal_updater_topic", goal_updater_topic, "goal_update");
@@ -57,7 +58,7 @@ inline BT::NodeStatus GoalUpdater::tick()
 
   getInput("input_goal", goal);
 
-  callback_group_executor_.spin_some();
+  callback_group_executor_->spin_some();
 
   if (rclcpp::Time(last_goal_received_.header.stamp) > rclcpp::Time(goal.header.stamp)) {
     goal = last_goal_received_;
@@ -31,24 +31,26 @@ PathLongerOnApproach::PathLongerOnApproach(
 }
 
 bool PathLongerOnApproach::isPathUpdated(
-  nav_msgs::msg::Path & new_path,
-  nav_msgs::msg::Path & old_path)
+  const nav_msgs::msg::Path::ConstSharedPtr & new_path,
+  const nav_msgs::msg::Path::ConstSharedPtr & old_path)
 {
-  return new_path != old_path && old_path.poses.size() != 0 &&
-         new_path.poses.size() != 0 &&
-         old_path.poses.back() == new_path.poses.back();
+  // The same path is never updated, only another one is compared
+  return new_path && old_path && new_path != old_path &&
+         old_path->poses.size() != 0 && new_path->poses.size() != 0 &&
+         *new_path != *old_path &&
+         old_path->poses.back() == new_path->poses.back();
 }
 
 bool PathLongerOnApproach::isRobotInGoalProximity(
-  nav_msgs::msg::Path & old_path,
+  const nav_msgs::msg::Path & old_path,
   double & prox_leng)
 {
   return nav2_util::geometry_utils::calculate_path_length(old_path, 0) < prox_leng;
 }
 
 bool PathLongerOnApproach::isNewPathLonger(
-  nav_msgs::msg::Path & new_path,
-  nav_msgs::msg::Path & old_path,
+  const nav_msgs::msg::Path & new_path,
+  const nav_msgs::msg::Path & old_path,
   double & length_factor)
 {
   return nav2_util::geometry_utils::calculate_path_length(new_path, 0) >
@@ -72,8 +74,8 @@ inline BT::NodeStatus PathLongerOnApproach::tick()
 
   // Check if the path is updated and valid, compare the old and the new path length,
   // given the goal proximity and check if the new path is longer
-  if (isPathUpdated(new_path_, old_path_) && isRobotInGoalProximity(old_path_, prox_len_) &&
-    isNewPathLonger(new_path_, old_path_, length_factor_) && !first_time_)
+  if (isPathUpdated(new_path_, old_path_) && isRobotInGoalProximity(*old_path_, prox_len_) &&
+    isNewPathLonger(*new_path_, *old_path_, length_factor_) && !first_time_)
   {
     const BT::NodeStatus child_state = child_node_->executeTick();
     switch (child_state) {
@@ -15,6 +15,7 @@
 
 #include "nav2_behavior_tree/behavior_tree_engine.hpp"
 
+#include <chrono>
 #include <memory>
 #include <string>
 #include <vector>
@@ -38,7 +39,8 @@ BehaviorTreeEngine::run(
   BT::Tree * tree,
   std::function<void()> onLoop,
   std::function<bool()> cancelRequested,
-  std::chrono::milliseconds loopTimeout)
+  std::chrono::milliseconds loopTimeout,
+  std::shared_ptr<rclcpp::executors::SingleThreadedExecutor> eventExecutor)
 {
   rclcpp::WallRate loopRate(loopTimeout);
   BT::NodeStatus result = BT::NodeStatus::RUNNING;
@@ -51,11 +53,22 @@ BehaviorTreeEngine::run(
         return BtStatus::CANCELED;
       }
 
+      auto tick_time = std::chrono::steady_clock::now();
+
       result = tree->tickRoot();
 
       onLoop();
 
-      loopRate.sleep();
+      if (!eventExecutor) {
+        loopRate.sleep();
+      } else if (result == BT::NodeStatus::RUNNING) {
+        // Wait until one of the BT node callbacks is executed or the loop period is over.
+        // Other callbacks that are ready are left to the nodes spinning during the tick
+        auto remaining = tick_time + loopTimeout - std::chrono::steady_clock::now();
+        if (remaining > std::chrono::nanoseconds::zero()) {
+          eventExecutor->spin_once(remaining);
+        }
+      }
     }
   } catch (const std::exception & ex) {
     RCLCPP_ERROR(
@@ -0,0 +1,315 @@
+// Copyright (c) 2021 Samsung Research America
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "nav2_behavior_tree/binary_bt_logger.hpp"
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+#include <fstream>
+#include <iterator>
+#include <map>
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "rcutils/logging_macros.h"
+
+namespace nav2_behavior_tree
+{
+
+// Granularity at which the log file and its mapping grow
+static constexpr size_t FILE_GROWTH = 1 << 16;
+
+BtLogRingBuffer::BtLogRingBuffer(size_t capacity)
+{
+  size_t size = 1;
+  while (size < capacity) {
+    size <<= 1;
+  }
+  records_.resize(size);
+  mask_ = size - 1;
+}
+
+bool BtLogRingBuffer::push(const BtLogRecord & record)
+{
+  const size_t tail = tail_.load(std::memory_order_relaxed);
+  if (tail - head_.load(std::memory_order_acquire) == records_.size()) {
+    return false;
+  }
+  records_[tail & mask_] = record;
+  tail_.store(tail + 1, std::memory_order_release);
+  return true;
+}
+
+size_t BtLogRingBuffer::pop(BtLogRecord * records, size_t max_records)
+{
+  const size_t head = head_.load(std::memory_order_relaxed);
+  const size_t count = std::min(tail_.load(std::memory_order_acquire) - head, max_records);
+  for (size_t i = 0; i < count; ++i) {
+    records[i] = records_[(head + i) & mask_];
+  }
+  head_.store(head + count, std::memory_order_release);
+  return count;
+}
+
+BinaryBtLogSink::BinaryBtLogSink(
+  const std::string & filename,
+  size_t capacity,
+  std::chrono::milliseconds drain_period)
+: buffer_(capacity), drained_(capacity), drain_period_(drain_period)
+{
+  fd_ = open(filename.c_str(), O_RDWR | O_CREAT | O_TRUNC, 0644);
+  if (fd_ < 0) {
+    throw std::runtime_error(
+            "Couldn't open binary BT log file " + filename + ": " + std::strerror(errno));
+  }
+
+  if (!reserve(sizeof(MAGIC) + sizeof(VERSION))) {
+    close(fd_);
+    throw std::runtime_error(
+            "Couldn't map binary BT log file " + filename + ": " + std::strerror(errno));
+  }
+  append(MAGIC, sizeof(MAGIC));
+  append(&VERSION, sizeof(VERSION));
+
+  thread_ = std::thread(
+    [this]() {
+      std::unique_lock<std::mutex> lock(stop_mutex_);
+      while (!stop_cv_.wait_for(lock, drain_period_, [this]() {return stop_;})) {
+        std::lock_guard<std::mutex> file_lock(file_mutex_);
+        drain();
+      }
+    });
+}
+
+BinaryBtLogSink::~BinaryBtLogSink()
+{
+  {
+    std::lock_guard<std::mutex> lock(stop_mutex_);
+    stop_ = true;
+  }
+  stop_cv_.notify_one();
+  thread_.join();
+
+  std::lock_guard<std::mutex> file_lock(file_mutex_);
+  drain();
+  if (mapped_) {
+    munmap(mapped_, mapped_size_);
+  }
+  // Drop the unused end of the last growth step, readers skip it otherwise
+  if (ftruncate(fd_, size_) != 0) {
+    RCUTILS_LOG_WARN("Couldn't truncate binary BT log file: %s", std::strerror(errno));
+  }
+  close(fd_);
+}
+
+uint16_t BinaryBtLogSink::addTree(const std::vector<std::pair<uint16_t, std::string>> & nodes)
+{
+  std::lock_guard<std::mutex> file_lock(file_mutex_);
+
+  // Records of the trees added before refer to their own names, write them first
+  drain();
+
+  const uint16_t tree_id = tree_count_++;
+  const uint32_t node_count = nodes.size();
+  size_t chunk_size = sizeof(TREE_CHUNK) + sizeof(tree_id) + sizeof(node_count);
+  for (const auto & node : nodes) {
+    chunk_size += sizeof(uint16_t) + sizeof(uint16_t) + nameLength(node.second);
+  }
+  if (!reserve(chunk_size)) {
+    return tree_id;
+  }
+
+  append(&TREE_CHUNK, sizeof(TREE_CHUNK));
+  append(&tree_id, sizeof(tree_id));
+  append(&node_count, sizeof(node_count));
+  for (const auto & node : nodes) {
+    const uint16_t name_length = nameLength(node.second);
+    append(&node.first, sizeof(node.first));
+    append(&name_length, sizeof(name_length));
+    append(node.second.data(), name_length);
+  }
+  return tree_id;
+}
+
+void BinaryBtLogSink::push(const BtLogRecord & record)
+{
+  if (!buffer_.push(record)) {
+    dropped_records_.fetch_add(1, std::memory_order_relaxed);
+  }
+}
+
+void BinaryBtLogSink::drain()
+{
+  size_t count;
+  while ((count = buffer_.pop(drained_.data(), drained_.size())) > 0) {
+    const uint32_t record_count = count;
+    if (!reserve(sizeof(RECORD_CHUNK) + sizeof(record_count) + count * sizeof(BtLogRecord))) {
+      dropped_records_.fetch_add(count, std::memory_order_relaxed);
+      continue;
+    }
+    append(&RECORD_CHUNK, sizeof(RECORD_CHUNK));
+    append(&record_count, sizeof(record_count));
+    append(drained_.data(), count * sizeof(BtLogRecord));
+  }
+}
+
+bool BinaryBtLogSink::reserve(size_t size)
+{
+  if (size_ + size <= mapped_size_) {
+    return true;
+  }
+
+  // Grow the file and map it again, anything past its content reads as zeros
+  const size_t new_size =
+    (std::max(2 * mapped_size_, size_ + size) + FILE_GROWTH - 1) / FILE_GROWTH * FILE_GROWTH;
+  if (mapped_) {
+    munmap(mapped_, mapped_size_);
+    mapped_ = nullptr;
+    mapped_size_ = 0;
+  }
+  if (ftruncate(fd_, new_size) != 0) {
+    return false;
+  }
+  void * mapped = mmap(nullptr, new_size, PROT_READ | PROT_WRITE, MAP_SHARED, fd_, 0);
+  if (mapped == MAP_FAILED) {
+    return false;
+  }
+  mapped_ = static_cast<char *>(mapped);
+  mapped_size_ = new_size;
+  return true;
+}
+
+void BinaryBtLogSink::append(const void * data, size_t size)
+{
+  std::memcpy(mapped_ + size_, data, size);
+  size_ += size;
+}
+
+uint16_t BinaryBtLogSink::nameLength(const std::string & name)
+{
+  return std::min<size_t>(name.size(), UINT16_MAX);
+}
+
+BinaryBtLogger::BinaryBtLogger(
+  const BT::Tree & tree,
+  const std::shared_ptr<BinaryBtLogSink> & sink)
+: StatusChangeLogger(tree.rootNode()), sink_(sink)
+{
+  std::vector<std::pair<uint16_t, std::string>> nodes;
+  nodes.reserve(tree.nodes.size());
+  for (const auto & node : tree.nodes) {
+    nodes.emplace_back(node->UID(), node->name());
+  }
+  tree_id_ = sink_->addTree(nodes);
+}
+
+void BinaryBtLogger::callback(
+  BT::Duration timestamp,
+  const BT::TreeNode & node,
+  BT::NodeStatus prev_status,
+  BT::NodeStatus status)
+{
+  BtLogRecord record;
+  record.timestamp = std::chrono::duration_cast<std::chrono::nanoseconds>(timestamp).count();
+  record.tree_id = tree_id_;
+  record.node_uid = node.UID();
+  record.previous_status = static_cast<uint8_t>(prev_status);
+  record.current_status = static_cast<uint8_t>(status);
+  record.reserved = 0;
+  sink_->push(record);
+}
+
+std::vector<BtLogEvent> readBinaryBtLog(const std::string & filename)
+{
+  std::ifstream file(filename, std::ios::binary);
+  if (!file.good()) {
+    throw std::runtime_error("Couldn't open binary BT log file " + filename);
+  }
+  const std::string data(
+    (std::istreambuf_iterator<char>(file)),
+    std::istreambuf_iterator<char>());
+
+  size_t offset = 0;
+  auto read = [&](void * value, size_t size) {
+      if (offset + size > data.size()) {
+        throw std::runtime_error("Binary BT log file " + filename + " is truncated");
+      }
+      std::memcpy(value, data.data() + offset, size);
+      offset += size;
+    };
+
+  char magic[sizeof(BinaryBtLogSink::MAGIC)];
+  uint32_t version;
+  read(magic, sizeof(magic));
+  read(&version, sizeof(version));
+  if (std::memcmp(magic, BinaryBtLogSink::MAGIC, sizeof(magic)) != 0 ||
+    version != BinaryBtLogSink::VERSION)
+  {
+    throw std::runtime_error(filename + " is not a binary BT log file");
+  }
+
+  std::map<std::pair<uint16_t, uint16_t>, std::string> node_names;
+  std::vector<BtLogEvent> events;
+  while (offset + sizeof(uint32_t) <= data.size()) {
+    uint32_t chunk;
+    read(&chunk, sizeof(chunk));
+
+    if (chunk == BinaryBtLogSink::TREE_CHUNK) {
+      uint16_t tree_id;
+      uint32_t node_count;
+      read(&tree_id, sizeof(tree_id));
+      read(&node_count, sizeof(node_count));
+      for (uint32_t i = 0; i < node_count; ++i) {
+        uint16_t uid, name_length;
+        read(&uid, sizeof(uid));
+        read(&name_length, sizeof(name_length));
+        std::string name(name_length, '\0');
+        read(&name[0], name_length);
+        node_names[{tree_id, uid}] = std::move(name);
+      }
+    } else if (chunk == BinaryBtLogSink::RECORD_CHUNK) {
+      uint32_t record_count;
+      read(&record_count, sizeof(record_count));
+      for (uint32_t i = 0; i < record_count; ++i) {
+        BtLogRecord record;
+        read(&record, sizeof(record));
+        BtLogEvent event;
+        event.timestamp = std::chrono::duration_cast<BT::Duration>(
+          std::chrono::nanoseconds(record.timestamp));
+        event.tree_id = record.tree_id;
+        event.node_name = node_names[{record.tree_id, record.node_uid}];
+        event.previous_status = static_cast<BT::NodeStatus>(record.previous_status);
+        event.current_status = static_cast<BT::NodeStatus>(record.current_status);
+        events.push_back(std::move(event));
+      }
+    } else if (chunk == 0) {
+      // Zeros past the content of a file whose writer did not shut down
+      break;
+    } else {
+      throw std::runtime_error("Unknown chunk in binary BT log file " + filename);
+    }
+  }
+
+  return events;
+}
+
+}  // namespace nav2_behavior_tree
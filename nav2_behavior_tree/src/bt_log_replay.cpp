@@ -0,0 +1,96 @@
+// Copyright (c) 2021 Samsung Research America
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <iostream>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "rclcpp/rclcpp.hpp"
+#include "nav2_msgs/msg/behavior_tree_log.hpp"
+#include "tf2_ros/buffer_interface.h"
+#include "nav2_behavior_tree/binary_bt_logger.hpp"
+
+using std::cerr;
+
+void usage()
+{
+  cerr << "Invalid command line.\n\n";
+  cerr << "This command replays a binary BT log written by the BT server when its\n";
+  cerr << "bt_log_file parameter is set. The status changes are printed, and with\n";
+  cerr << "--publish they are also published on behavior_tree_log, at their original pace\n\n";
+  cerr << "Usage:\n";
+  cerr << " > bt_log_replay <log file> [--publish]\n";
+  std::exit(1);
+}
+
+int main(int argc, char * argv[])
+{
+  if (argc < 2 || argc > 3 || (argc == 3 && std::string(argv[2]) != "--publish")) {
+    usage();
+  }
+  const bool publish = argc == 3;
+
+  std::vector<nav2_behavior_tree::BtLogEvent> events;
+  try {
+    events = nav2_behavior_tree::readBinaryBtLog(argv[1]);
+  } catch (const std::runtime_error & e) {
+    cerr << e.what() << "\n";
+    return 1;
+  }
+
+  rclcpp::Node::SharedPtr node;
+  rclcpp::Publisher<nav2_msgs::msg::BehaviorTreeLog>::SharedPtr log_pub;
+  if (publish) {
+    rclcpp::init(0, nullptr);
+    node = std::make_shared<rclcpp::Node>("bt_log_replay");
+    log_pub = node->create_publisher<nav2_msgs::msg::BehaviorTreeLog>(
+      "behavior_tree_log",
+      rclcpp::QoS(10));
+  }
+
+  const auto start = std::chrono::steady_clock::now();
+  for (const auto & event : events) {
+    std::printf(
+      "[%.3f]: %25s %s -> %s\n",
+      std::chrono::duration<double>(event.timestamp).count(),
+      event.node_name.c_str(),
+      BT::toStr(event.previous_status, true).c_str(),
+      BT::toStr(event.current_status, true).c_str());
+
+    if (publish && rclcpp::ok()) {
+      std::this_thread::sleep_until(start + (event.timestamp - events.front().timestamp));
+
+      nav2_msgs::msg::BehaviorTreeStatusChange status_change;
+      status_change.timestamp = tf2_ros::toMsg(tf2::TimePoint(event.timestamp));
+      status_change.node_name = event.node_name;
+      status_change.previous_status = BT::toStr(event.previous_status, false);
+      status_change.current_status = BT::toStr(event.current_status, false);
+
+      auto log_msg = std::make_unique<nav2_msgs::msg::BehaviorTreeLog>();
+      log_msg->timestamp = node->now();
+      log_msg->event_log.push_back(std::move(status_change));
+      log_pub->publish(std::move(log_msg));
+    }
+  }
+
+  if (publish) {
+    rclcpp::shutdown();
+  }
+  return 0;
+}
@@ -0,0 +1,211 @@
+// Copyright (c) 2021 Samsung Research America
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "nav2_behavior_tree/bt_profiler.hpp"
+
+#include <algorithm>
+#include <cstdio>
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace nav2_behavior_tree
+{
+
+// Follows the status changes of the nodes of a tree for the profiler
+class BtProfiler::StatusChangeRecorder : public BT::StatusChangeLogger
+{
+public:
+  StatusChangeRecorder(BtProfiler * profiler, const BT::Tree & tree)
+  : StatusChangeLogger(tree.rootNode()), profiler_(profiler)
+  {}
+
+  void callback(
+    BT::Duration /*timestamp*/,
+    const BT::TreeNode & node,
+    BT::NodeStatus prev_status,
+    BT::NodeStatus status) override
+  {
+    profiler_->recordStatusChange(node, prev_status, status);
+  }
+
+  void flush() override
+  {
+  }
+
+protected:
+  BtProfiler * profiler_;
+};
+
+static double toSeconds(BtProfiler::Clock::duration duration)
+{
+  return std::chrono::duration<double>(duration).count();
+}
+
+static double mean(BtProfiler::Clock::duration total, uint64_t count)
+{
+  return count > 0 ? toSeconds(total) / count : 0.0;
+}
+
+BtProfiler::BtProfiler() = default;
+
+BtProfiler::~BtProfiler() = default;
+
+void BtProfiler::addTree(const BT::Tree & tree)
+{
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    for (const auto & node : tree.nodes) {
+      profile(*node);
+    }
+  }
+  recorders_.push_back(std::make_unique<StatusChangeRecorder>(this, tree));
+}
+
+BtProfiler::NodeProfile & BtProfiler::profile(const BT::TreeNode & node)
+{
+  auto it = profiles_.find(&node);
+  if (it == profiles_.end()) {
+    it = profiles_.emplace(&node, NodeProfile()).first;
+    it->second.name = node.name();
+    it->second.type = node.registrationName();
+    order_.push_back(&node);
+  }
+  return it->second;
+}
+
+void BtProfiler::recordTick(const BT::TreeNode & node, Clock::duration duration)
+{
+  std::lock_guard<std::mutex> lock(mutex_);
+  NodeProfile & node_profile = profile(node);
+  node_profile.ticks++;
+  node_profile.tick_time += duration;
+  node_profile.max_tick_time = std::max(node_profile.max_tick_time, duration);
+}
+
+void BtProfiler::recordGoalSent(const BT::TreeNode & node)
+{
+  std::lock_guard<std::mutex> lock(mutex_);
+  NodeProfile & node_profile = profile(node);
+  node_profile.goals++;
+  node_profile.goal_sent = Clock::now();
+}
+
+void BtProfiler::recordGoalAccepted(const BT::TreeNode & node)
+{
+  std::lock_guard<std::mutex> lock(mutex_);
+  NodeProfile & node_profile = profile(node);
+  const auto latency = Clock::now() - node_profile.goal_sent;
+  node_profile.accepted_goals++;
+  node_profile.accept_latency += latency;
+  node_profile.max_accept_latency = std::max(node_profile.max_accept_latency, latency);
+}
+
+void BtProfiler::recordGoalResult(const BT::TreeNode & node)
+{
+  std::lock_guard<std::mutex> lock(mutex_);
+  NodeProfile & node_profile = profile(node);
+  const auto latency = Clock::now() - node_profile.goal_sent;
+  node_profile.results++;
+  node_profile.result_latency += latency;
+  node_profile.max_result_latency = std::max(node_profile.max_result_latency, latency);
+}
+
+void BtProfiler::recordStatusChange(
+  const BT::TreeNode & node,
+  BT::NodeStatus prev_status,
+  BT::NodeStatus status)
+{
+  std::lock_guard<std::mutex> lock(mutex_);
+  NodeProfile & node_profile = profile(node);
+  const auto now = Clock::now();
+
+  if (prev_status == BT::NodeStatus::IDLE && status != BT::NodeStatus::IDLE) {
+    node_profile.runs++;
+  }
+  if (status == BT::NodeStatus::RUNNING) {
+    node_profile.running_since = now;
+  } else if (prev_status == BT::NodeStatus::RUNNING) {
+    node_profile.running_time += now - node_profile.running_since;
+  }
+
+  if (status == BT::NodeStatus::SUCCESS) {
+    node_profile.successes++;
+  } else if (status == BT::NodeStatus::FAILURE) {
+    node_profile.failures++;
+  }
+}
+
+nav2_msgs::msg::BehaviorTreeStatistics BtProfiler::toMsg() const
+{
+  std::lock_guard<std::mutex> lock(mutex_);
+  nav2_msgs::msg::BehaviorTreeStatistics msg;
+  msg.nodes.reserve(order_.size());
+  for (const auto * node : order_) {
+    const NodeProfile & node_profile = profiles_.at(node);
+    nav2_msgs::msg::BehaviorTreeNodeStatistics node_msg;
+    node_msg.node_name = node_profile.name;
+    node_msg.node_type = node_profile.type;
+    node_msg.ticks = node_profile.ticks;
+    node_msg.tick_time = toSeconds(node_profile.tick_time);
+    node_msg.max_tick_time = toSeconds(node_profile.max_tick_time);
+    node_msg.runs = node_profile.runs;
+    node_msg.running_time = toSeconds(node_profile.running_time);
+    node_msg.successes = node_profile.successes;
+    node_msg.failures = node_profile.failures;
+    node_msg.goals = node_profile.goals;
+    node_msg.accepted_goals = node_profile.accepted_goals;
+    node_msg.mean_accept_latency = mean(node_profile.accept_latency, node_profile.accepted_goals);
+    node_msg.max_accept_latency = toSeconds(node_profile.max_accept_latency);
+    node_msg.results = node_profile.results;
+    node_msg.mean_result_latency = mean(node_profile.result_latency, node_profile.results);
+    node_msg.max_result_latency = toSeconds(node_profile.max_result_latency);
+    msg.nodes.push_back(std::move(node_msg));
+  }
+  return msg;
+}
+
+std::string BtProfiler::report() const
+{
+  auto msg = toMsg();
+  std::stable_sort(
+    msg.nodes.begin(), msg.nodes.end(),
+    [](const auto & a, const auto & b) {
+      return a.tick_time > b.tick_time ||
+      (a.tick_time == b.tick_time && a.running_time > b.running_time);
+    });
+
+  std::string report;
+  char line[256];
+  std::snprintf(
+    line, sizeof(line), "%-28s %-24s %8s %10s %9s %7s %11s %7s %7s %6s %11s %10s\n",
+    "node", "type", "ticks", "tick [ms]", "max [ms]", "runs", "running [s]",
+    "success", "failure", "goals", "accept [ms]", "result [s]");
+  report += line;
+  for (const auto & node : msg.nodes) {
+    std::snprintf(
+      line, sizeof(line),
+      "%-28.28s %-24.24s %8lu %10.3f %9.3f %7lu %11.3f %7lu %7lu %6lu %11.3f %10.3f\n",
+      node.node_name.c_str(), node.node_type.c_str(),
+      static_cast<unsigned long>(node.ticks), node.tick_time * 1e3, node.max_tick_time * 1e3,
+      static_cast<unsigned long>(node.runs), node.running_time,
+      static_cast<unsigned long>(node.successes), static_cast<unsigned long>(node.failures),
+      static_cast<unsigned long>(node.goals), node.mean_accept_latency * 1e3,
+      node.mean_result_latency);
+    report += line;
+  }
+  return report;
+}
+
+}  // namespace nav2_behavior_tree
@@ -25,6 +25,7 @@
 
 #include "behaviortree_cpp_v3/bt_factory.h"
 #include "nav2_behavior_tree/bt_action_node.hpp"
+#include "nav2_behavior_tree/behavior_tree_engine.hpp"
 
 #include "test_msgs/action/fibonacci.hpp"
 
@@ -54,6 +55,16 @@ public:
     sleep_duration_ = sleep_duration;
   }
 
+  void setHandleCancelSleepDuration(std::chrono::milliseconds cancel_sleep_duration)
+  {
+    cancel_sleep_duration_ = cancel_sleep_duration;
+  }
+
+  void setKeepGoalsRunning(bool keep_goals_running)
+  {
+    keep_goals_running_ = keep_goals_running;
+  }
+
 protected:
   rclcpp_action::GoalResponse handle_goal(
     const rclcpp_action::GoalUUID &,
@@ -68,6 +79,9 @@ protected:
   rclcpp_action::CancelResponse handle_cancel(
     const std::shared_ptr<rclcpp_action::ServerGoalHandle<test_msgs::action::Fibonacci>>)
   {
+    if (cancel_sleep_duration_ > 0ms) {
+      std::this_thread::sleep_for(cancel_sleep_duration_);
+    }
     return rclcpp_action::CancelResponse::ACCEPT;
   }
 
@@ -75,6 +89,11 @@ protected:
     const std::shared_ptr<rclcpp_action::ServerGoalHandle<test_msgs::action::Fibonacci>> handle)
   {
     // this needs to return quickly to avoid blocking the executor, so spin up a new thread
+    if (handle && keep_goals_running_) {
+      running_goals_.push_back(handle);
+      return;
+    }
+
     if (handle) {
       const auto goal = handle->get_goal();
       auto result = std::make_shared<test_msgs::action::Fibonacci::Result>();
@@ -99,6 +118,10 @@ protected:
 protected:
   rclcpp_action::Server<test_msgs::action::Fibonacci>::SharedPtr action_server_;
   std::chrono::milliseconds sleep_duration_;
+  std::chrono::milliseconds cancel_sleep_duration_{0ms};
+  bool keep_goals_running_{false};
+  std::vector<std::shared_ptr<rclcpp_action::ServerGoalHandle<test_msgs::action::Fibonacci>>>
+  running_goals_;
 };
 
 class FibonacciAction : public nav2_behavior_tree::BtActionNode<test_msgs::action::Fibonacci>
@@ -125,6 +148,11 @@ public:
   {
     return providedBasicPorts({BT::InputPort<int>("order", "Fibonacci order")});
   }
+
+  std::shared_ptr<rclcpp_action::Client<test_msgs::action::Fibonacci>> getActionClient() const
+  {
+    return action_client_;
+  }
 };
 
 class BTActionNodeTestFixture : public ::testing::Test
@@ -348,6 +376,147 @@ TEST_F(BTActionNodeTestFixture, test_server_timeout_failure)
   EXPECT_EQ(result, BT::NodeStatus::SUCCESS);
 }
 
+TEST_F(BTActionNodeTestFixture, test_event_driven_run)
+{
+  // create tree
+  std::string xml_txt =
+    R"(
+      <root main_tree_to_execute = "MainTree" >
+        <BehaviorTree ID="MainTree">
+            <Fibonacci order="5" />
+        </BehaviorTree>
+      </root>)";
+
+  // share one executor between the BT nodes for the engine to wait on
+  auto executor = std::make_shared<rclcpp::executors::SingleThreadedExecutor>();
+  config_->blackboard->set<std::chrono::milliseconds>("server_timeout", 1000ms);
+  config_->blackboard->set<std::chrono::milliseconds>("bt_loop_duration", 10ms);
+  config_->blackboard->set<std::shared_ptr<rclcpp::executors::SingleThreadedExecutor>>(
+    "callback_group_executor", executor);
+
+  tree_ = std::make_shared<BT::Tree>(factory_->createTreeFromText(xml_txt, config_->blackboard));
+
+  action_server_->setHandleGoalSleepDuration(0ms);
+
+  // the loop period is much longer than the time the action takes, so ticking
+  // the BT on the goal response and on the result should finish it much earlier
+  nav2_behavior_tree::BehaviorTreeEngine engine({});
+  auto start = std::chrono::steady_clock::now();
+  auto status = engine.run(
+    tree_.get(), []() {}, []() {return false;}, 2000ms, executor);
+  auto elapsed = std::chrono::steady_clock::now() - start;
+
+  EXPECT_EQ(status, nav2_behavior_tree::BtStatus::SUCCEEDED);
+  EXPECT_LT(elapsed, 1000ms);
+
+  // checking the output fibonacci sequence
+  auto sequence = config_->blackboard->get<std::vector<int>>("sequence");
+  std::vector<int> expected = {0, 1, 1, 2, 3, 5};
+  EXPECT_EQ(sequence, expected);
+
+  // let the next trees create their own executors again
+  config_->blackboard->set<std::shared_ptr<rclcpp::executors::SingleThreadedExecutor>>(
+    "callback_group_executor", nullptr);
+}
+
+TEST_F(BTActionNodeTestFixture, test_halt_does_not_wait_for_cancel)
+{
+  // create tree
+  std::string xml_txt =
+    R"(
+      <root main_tree_to_execute = "MainTree" >
+        <BehaviorTree ID="MainTree">
+            <Fibonacci order="5" />
+        </BehaviorTree>
+      </root>)";
+
+  config_->blackboard->set<std::chrono::milliseconds>("server_timeout", 2000ms);
+  config_->blackboard->set<std::chrono::milliseconds>("bt_loop_duration", 10ms);
+
+  tree_ = std::make_shared<BT::Tree>(factory_->createTreeFromText(xml_txt, config_->blackboard));
+
+  // the goals keep running, and the server takes long to acknowledge their cancels
+  action_server_->setHandleGoalSleepDuration(0ms);
+  action_server_->setHandleCancelSleepDuration(500ms);
+  action_server_->setKeepGoalsRunning(true);
+
+  // tick until the goal has been accepted
+  auto start = std::chrono::steady_clock::now();
+  while (std::chrono::steady_clock::now() - start < 200ms) {
+    EXPECT_EQ(tree_->tickRoot(), BT::NodeStatus::RUNNING);
+    std::this_thread::sleep_for(10ms);
+  }
+
+  // halting the node sends the cancel without waiting for the acknowledgment
+  start = std::chrono::steady_clock::now();
+  tree_->haltTree();
+  EXPECT_LT(std::chrono::steady_clock::now() - start, 250ms);
+
+  // a new goal is sent right away, while the cancel is still pending
+  start = std::chrono::steady_clock::now();
+  EXPECT_EQ(tree_->tickRoot(), BT::NodeStatus::RUNNING);
+  EXPECT_LT(std::chrono::steady_clock::now() - start, 250ms);
+
+  // the acknowledgment of the cancel and the response to the new goal are handled later
+  start = std::chrono::steady_clock::now();
+  while (std::chrono::steady_clock::now() - start < 1000ms) {
+    EXPECT_EQ(tree_->tickRoot(), BT::NodeStatus::RUNNING);
+    std::this_thread::sleep_for(10ms);
+  }
+  tree_->haltTree();
+}
+
+TEST_F(BTActionNodeTestFixture, test_shared_client)
+{
+  // create tree
+  std::string xml_txt =
+    R"(
+      <root main_tree_to_execute = "MainTree" >
+        <BehaviorTree ID="MainTree">
+          <Sequence>
+            <Fibonacci order="3" />
+            <Fibonacci order="5" />
+          </Sequence>
+        </BehaviorTree>
+      </root>)";
+
+  // let the BT nodes take their clients from a registry
+  auto executor = std::make_shared<rclcpp::executors::SingleThreadedExecutor>();
+  config_->blackboard->set<std::chrono::milliseconds>("server_timeout", 1000ms);
+  config_->blackboard->set<std::chrono::milliseconds>("bt_loop_duration", 10ms);
+  config_->blackboard->set<nav2_behavior_tree::BtClientRegistry::Ptr>(
+    "client_registry",
+    std::make_shared<nav2_behavior_tree::BtClientRegistry>(node_, executor));
+
+  tree_ = std::make_shared<BT::Tree>(factory_->createTreeFromText(xml_txt, config_->blackboard));
+
+  std::vector<FibonacciAction *> fibonacci_nodes;
+  for (auto & node : tree_->nodes) {
+    if (auto fibonacci_node = dynamic_cast<FibonacciAction *>(node.get())) {
+      fibonacci_nodes.push_back(fibonacci_node);
+    }
+  }
+  ASSERT_EQ(fibonacci_nodes.size(), 2u);
+  EXPECT_EQ(fibonacci_nodes[0]->getActionClient(), fibonacci_nodes[1]->getActionClient());
+
+  action_server_->setHandleGoalSleepDuration(0ms);
+
+  BT::NodeStatus result = BT::NodeStatus::RUNNING;
+  while (rclcpp::ok() && result == BT::NodeStatus::RUNNING) {
+    result = tree_->tickRoot();
+    std::this_thread::sleep_for(10ms);
+  }
+  EXPECT_EQ(result, BT::NodeStatus::SUCCESS);
+
+  // both goals went through the shared client, the last one set the output sequence
+  auto sequence = config_->blackboard->get<std::vector<int>>("sequence");
+  std::vector<int> expected = {0, 1, 1, 2, 3, 5};
+  EXPECT_EQ(sequence, expected);
+
+  // let the next trees create their own clients again
+  config_->blackboard->set<nav2_behavior_tree::BtClientRegistry::Ptr>("client_registry", nullptr);
+}
+
 int main(int argc, char ** argv)
 {
   ::testing::InitGoogleTest(&argc, argv);
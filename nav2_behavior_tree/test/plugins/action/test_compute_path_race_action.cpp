@@ -0,0 +1,180 @@
+// Copyright (c) 2021 Samsung Research America
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <gtest/gtest.h>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "nav_msgs/msg/path.hpp"
+#include "geometry_msgs/msg/pose_stamped.hpp"
+
+#include "behaviortree_cpp_v3/bt_factory.h"
+
+#include "../../test_action_server.hpp"
+#include "nav2_behavior_tree/plugins/action/compute_path_race_action.hpp"
+
+class ComputePathRaceActionServer : public TestActionServer<nav2_msgs::action::ComputePathToPose>
+{
+public:
+  ComputePathRaceActionServer()
+  : TestActionServer("compute_path_to_pose")
+  {}
+
+protected:
+  void execute(
+    const typename std::shared_ptr<
+      rclcpp_action::ServerGoalHandle<nav2_msgs::action::ComputePathToPose>> goal_handle)
+  override
+  {
+    // The last planner of the race wins
+    const auto goal = goal_handle->get_goal();
+    auto result = std::make_shared<nav2_msgs::action::ComputePathToPose::Result>();
+    result->path.poses.resize(2);
+    result->path.poses[1].pose.position.x = goal->goal.pose.position.x;
+    if (!goal->race_planner_ids.empty()) {
+      result->planner_id = goal->race_planner_ids.back();
+    }
+    goal_handle->succeed(result);
+  }
+};
+
+class ComputePathRaceActionTestFixture : public ::testing::Test
+{
+public:
+  static void SetUpTestCase()
+  {
+    node_ = std::make_shared<rclcpp::Node>("compute_path_race_action_test_fixture");
+    factory_ = std::make_shared<BT::BehaviorTreeFactory>();
+
+    config_ = new BT::NodeConfiguration();
+
+    // Create the blackboard that will be shared by all of the nodes in the tree
+    config_->blackboard = BT::Blackboard::create();
+    // Put items on the blackboard
+    config_->blackboard->set<rclcpp::Node::SharedPtr>(
+      "node",
+      node_);
+    config_->blackboard->set<std::chrono::milliseconds>(
+      "server_timeout",
+      std::chrono::milliseconds(20));
+    config_->blackboard->set<std::chrono::milliseconds>(
+      "bt_loop_duration",
+      std::chrono::milliseconds(10));
+
+    BT::NodeBuilder builder =
+      [](const std::string & name, const BT::NodeConfiguration & config)
+      {
+        return std::make_unique<nav2_behavior_tree::ComputePathRaceAction>(
+          name, "compute_path_to_pose", config);
+      };
+
+    factory_->registerBuilder<nav2_behavior_tree::ComputePathRaceAction>(
+      "ComputePathRace", builder);
+  }
+
+  static void TearDownTestCase()
+  {
+    delete config_;
+    config_ = nullptr;
+    node_.reset();
+    action_server_.reset();
+    factory_.reset();
+  }
+
+  void TearDown() override
+  {
+    tree_.reset();
+  }
+
+  static std::shared_ptr<ComputePathRaceActionServer> action_server_;
+
+protected:
+  static rclcpp::Node::SharedPtr node_;
+  static BT::NodeConfiguration * config_;
+  static std::shared_ptr<BT::BehaviorTreeFactory> factory_;
+  static std::shared_ptr<BT::Tree> tree_;
+};
+
+rclcpp::Node::SharedPtr ComputePathRaceActionTestFixture::node_ = nullptr;
+std::shared_ptr<ComputePathRaceActionServer>
+ComputePathRaceActionTestFixture::action_server_ = nullptr;
+BT::NodeConfiguration * ComputePathRaceActionTestFixture::config_ = nullptr;
+std::shared_ptr<BT::BehaviorTreeFactory> ComputePathRaceActionTestFixture::factory_ = nullptr;
+std::shared_ptr<BT::Tree> ComputePathRaceActionTestFixture::tree_ = nullptr;
+
+TEST_F(ComputePathRaceActionTestFixture, test_tick)
+{
+  // create tree
+  std::string xml_txt =
+    R"(
+      <root main_tree_to_execute = "MainTree" >
+        <BehaviorTree ID="MainTree">
+            <ComputePathRace goal="{goal}" path="{path}" winner_id="{winner_id}"
+              planner_ids="GridBased;Smac;ThetaStar" deadline="0.25"/>
+        </BehaviorTree>
+      </root>)";
+
+  tree_ = std::make_shared<BT::Tree>(factory_->createTreeFromText(xml_txt, config_->blackboard));
+
+  // create new goal and set it on blackboard
+  geometry_msgs::msg::PoseStamped goal;
+  goal.pose.position.x = 1.0;
+  config_->blackboard->set("goal", goal);
+
+  // tick until node succeeds
+  while (tree_->rootNode()->status() != BT::NodeStatus::SUCCESS) {
+    tree_->rootNode()->executeTick();
+  }
+
+  // the race should have reached our server
+  auto server_goal = action_server_->getCurrentGoal();
+  EXPECT_EQ(server_goal->goal.pose.position.x, 1.0);
+  EXPECT_FALSE(server_goal->use_start);
+  EXPECT_EQ(
+    server_goal->race_planner_ids,
+    std::vector<std::string>({"GridBased", "Smac", "ThetaStar"}));
+  EXPECT_EQ(rclcpp::Duration(server_goal->race_deadline).nanoseconds(), 250000000);
+
+  // with the path and planner of the winner
+  nav_msgs::msg::Path::ConstSharedPtr path;
+  config_->blackboard->get<nav_msgs::msg::Path::ConstSharedPtr>("path", path);
+  EXPECT_EQ(path->poses.size(), 2u);
+  EXPECT_EQ(path->poses[1].pose.position.x, 1.0);
+  EXPECT_EQ(config_->blackboard->get<std::string>("winner_id"), "ThetaStar");
+}
+
+int main(int argc, char ** argv)
+{
+  ::testing::InitGoogleTest(&argc, argv);
+
+  // initialize ROS
+  rclcpp::init(argc, argv);
+
+  // initialize action server and spin on new thread
+  ComputePathRaceActionTestFixture::action_server_ =
+    std::make_shared<ComputePathRaceActionServer>();
+
+  std::thread server_thread([]() {
+      rclcpp::spin(ComputePathRaceActionTestFixture::action_server_);
+    });
+
+  int all_successful = RUN_ALL_TESTS();
+
+  // shutdown ROS
+  rclcpp::shutdown();
+  server_thread.join();
+
+  return all_successful;
+}
@@ -152,11 +152,11 @@ TEST_F(ComputePathThroughPosesActionTestFixture, test_tick)
   EXPECT_EQ(action_server_->getCurrentGoal()->planner_id, std::string("GridBased"));
 
   // check if returned path is correct
-  nav_msgs::msg::Path path;
-  config_->blackboard->get<nav_msgs::msg::Path>("path", path);
-  EXPECT_EQ(path.poses.size(), 2u);
-  EXPECT_EQ(path.poses[0].pose.position.x, 0.0);
-  EXPECT_EQ(path.poses[1].pose.position.x, 1.0);
+  nav_msgs::msg::Path::ConstSharedPtr path;
+  config_->blackboard->get<nav_msgs::msg::Path::ConstSharedPtr>("path", path);
+  EXPECT_EQ(path->poses.size(), 2u);
+  EXPECT_EQ(path->poses[0].pose.position.x, 0.0);
+  EXPECT_EQ(path->poses[1].pose.position.x, 1.0);
 
   // halt node so another goal can be sent
   tree_->rootNode()->halt();
@@ -173,10 +173,10 @@ TEST_F(ComputePathThroughPosesActionTestFixture, test_tick)
   EXPECT_EQ(tree_->rootNode()->status(), BT::NodeStatus::SUCCESS);
   EXPECT_EQ(action_server_->getCurrentGoal()->goals[0].pose.position.x, -2.5);
 
-  config_->blackboard->get<nav_msgs::msg::Path>("path", path);
-  EXPECT_EQ(path.poses.size(), 2u);
-  EXPECT_EQ(path.poses[0].pose.position.x, 0.0);
-  EXPECT_EQ(path.poses[1].pose.position.x, -2.5);
+  config_->blackboard->get<nav_msgs::msg::Path::ConstSharedPtr>("path", path);
+  EXPECT_EQ(path->poses.size(), 2u);
+  EXPECT_EQ(path->poses[0].pose.position.x, 0.0);
+  EXPECT_EQ(path->poses[1].pose.position.x, -2.5);
 }
 
 TEST_F(ComputePathThroughPosesActionTestFixture, test_tick_use_start)
@@ -218,11 +218,11 @@ TEST_F(ComputePathThroughPosesActionTestFixture, test_tick_use_start)
   EXPECT_EQ(action_server_->getCurrentGoal()->planner_id, std::string("GridBased"));
 
   // check if returned path is correct
-  nav_msgs::msg::Path path;
-  config_->blackboard->get<nav_msgs::msg::Path>("path", path);
-  EXPECT_EQ(path.poses.size(), 2u);
-  EXPECT_EQ(path.poses[0].pose.position.x, 2.0);
-  EXPECT_EQ(path.poses[1].pose.position.x, 1.0);
+  nav_msgs::msg::Path::ConstSharedPtr path;
+  config_->blackboard->get<nav_msgs::msg::Path::ConstSharedPtr>("path", path);
+  EXPECT_EQ(path->poses.size(), 2u);
+  EXPECT_EQ(path->poses[0].pose.position.x, 2.0);
+  EXPECT_EQ(path->poses[1].pose.position.x, 1.0);
 
   // halt node so another goal can be sent
   tree_->rootNode()->halt();
@@ -241,10 +241,70 @@ TEST_F(ComputePathThroughPosesActionTestFixture, test_tick_use_start)
   EXPECT_EQ(tree_->rootNode()->status(), BT::NodeStatus::SUCCESS);
   EXPECT_EQ(action_server_->getCurrentGoal()->goals[0].pose.position.x, -2.5);
 
-  config_->blackboard->get<nav_msgs::msg::Path>("path", path);
-  EXPECT_EQ(path.poses.size(), 2u);
-  EXPECT_EQ(path.poses[0].pose.position.x, -1.5);
-  EXPECT_EQ(path.poses[1].pose.position.x, -2.5);
+  config_->blackboard->get<nav_msgs::msg::Path::ConstSharedPtr>("path", path);
+  EXPECT_EQ(path->poses.size(), 2u);
+  EXPECT_EQ(path->poses[0].pose.position.x, -1.5);
+  EXPECT_EQ(path->poses[1].pose.position.x, -2.5);
+}
+
+TEST_F(ComputePathThroughPosesActionTestFixture, test_tick_prefetched_path)
+{
+  // create tree
+  std::string xml_txt =
+    R"(
+      <root main_tree_to_execute = "MainTree" >
+        <BehaviorTree ID="MainTree">
+            <ComputePathThroughPoses goals="{goals}" path="{path}" planner_id="GridBased"
+              prefetched_path="{prefetched_path}" prefetched_goals="{prefetched_goals}"/>
+        </BehaviorTree>
+      </root>)";
+
+  tree_ = std::make_shared<BT::Tree>(factory_->createTreeFromText(xml_txt, config_->blackboard));
+
+  // create new goal and a path prefetched through it
+  std::vector<geometry_msgs::msg::PoseStamped> goals;
+  goals.resize(1);
+  goals[0].pose.position.x = 3.0;
+  config_->blackboard->set("goals", goals);
+
+  nav_msgs::msg::Path prefetched_path;
+  prefetched_path.header.stamp = node_->now();
+  prefetched_path.poses.resize(3);
+  prefetched_path.poses[2].pose.position.x = 3.0;
+  config_->blackboard->set(
+    "prefetched_path", std::make_shared<const nav_msgs::msg::Path>(prefetched_path));
+  config_->blackboard->set("prefetched_goals", goals);
+
+  // the prefetched path is used without calling the planner server
+  tree_->rootNode()->executeTick();
+  EXPECT_EQ(tree_->rootNode()->status(), BT::NodeStatus::SUCCESS);
+  nav_msgs::msg::Path::ConstSharedPtr path;
+  config_->blackboard->get<nav_msgs::msg::Path::ConstSharedPtr>("path", path);
+  EXPECT_EQ(path->poses.size(), 3u);
+  EXPECT_NE(action_server_->getCurrentGoal()->goals[0].pose.position.x, 3.0);
+
+  // but only once, the next path is computed by the planner server
+  tree_->rootNode()->halt();
+  while (tree_->rootNode()->status() != BT::NodeStatus::SUCCESS) {
+    tree_->rootNode()->executeTick();
+  }
+  EXPECT_EQ(action_server_->getCurrentGoal()->goals[0].pose.position.x, 3.0);
+  config_->blackboard->get<nav_msgs::msg::Path::ConstSharedPtr>("path", path);
+  EXPECT_EQ(path->poses.size(), 2u);
+
+  // a path prefetched through other goals is not used
+  tree_->rootNode()->halt();
+  prefetched_path.header.stamp = node_->now();
+  config_->blackboard->set(
+    "prefetched_path", std::make_shared<const nav_msgs::msg::Path>(prefetched_path));
+  goals[0].pose.position.x = 4.0;
+  config_->blackboard->set("goals", goals);
+  while (tree_->rootNode()->status() != BT::NodeStatus::SUCCESS) {
+    tree_->rootNode()->executeTick();
+  }
+  EXPECT_EQ(action_server_->getCurrentGoal()->goals[0].pose.position.x, 4.0);
+  config_->blackboard->get<nav_msgs::msg::Path::ConstSharedPtr>("path", path);
+  EXPECT_EQ(path->poses.size(), 2u);
 }
 
 int main(int argc, char ** argv)
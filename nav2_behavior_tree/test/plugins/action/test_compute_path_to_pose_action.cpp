@@ -149,11 +149,11 @@ TEST_F(ComputePathToPoseActionTestFixture, test_tick)
   EXPECT_EQ(action_server_->getCurrentGoal()->planner_id, std::string("GridBased"));
 
   // check if returned path is correct
-  nav_msgs::msg::Path path;
-  config_->blackboard->get<nav_msgs::msg::Path>("path", path);
-  EXPECT_EQ(path.poses.size(), 2u);
-  EXPECT_EQ(path.poses[0].pose.position.x, 0.0);
-  EXPECT_EQ(path.poses[1].pose.position.x, 1.0);
+  nav_msgs::msg::Path::ConstSharedPtr path;
+  config_->blackboard->get<nav_msgs::msg::Path::ConstSharedPtr>("path", path);
+  EXPECT_EQ(path->poses.size(), 2u);
+  EXPECT_EQ(path->poses[0].pose.position.x, 0.0);
+  EXPECT_EQ(path->poses[1].pose.position.x, 1.0);
 
   // halt node so another goal can be sent
   tree_->rootNode()->halt();
@@ -170,10 +170,10 @@ TEST_F(ComputePathToPoseActionTestFixture, test_tick)
   EXPECT_EQ(tree_->rootNode()->status(), BT::NodeStatus::SUCCESS);
   EXPECT_EQ(action_server_->getCurrentGoal()->goal.pose.position.x, -2.5);
 
-  config_->blackboard->get<nav_msgs::msg::Path>("path", path);
-  EXPECT_EQ(path.poses.size(), 2u);
-  EXPECT_EQ(path.poses[0].pose.position.x, 0.0);
-  EXPECT_EQ(path.poses[1].pose.position.x, -2.5);
+  config_->blackboard->get<nav_msgs::msg::Path::ConstSharedPtr>("path", path);
+  EXPECT_EQ(path->poses.size(), 2u);
+  EXPECT_EQ(path->poses[0].pose.position.x, 0.0);
+  EXPECT_EQ(path->poses[1].pose.position.x, -2.5);
 }
 
 TEST_F(ComputePathToPoseActionTestFixture, test_tick_use_start)
@@ -215,11 +215,11 @@ TEST_F(ComputePathToPoseActionTestFixture, test_tick_use_start)
   EXPECT_EQ(action_server_->getCurrentGoal()->planner_id, std::string("GridBased"));
 
   // check if returned path is correct
-  nav_msgs::msg::Path path;
-  config_->blackboard->get<nav_msgs::msg::Path>("path", path);
-  EXPECT_EQ(path.poses.size(), 2u);
-  EXPECT_EQ(path.poses[0].pose.position.x, 2.0);
-  EXPECT_EQ(path.poses[1].pose.position.x, 1.0);
+  nav_msgs::msg::Path::ConstSharedPtr path;
+  config_->blackboard->get<nav_msgs::msg::Path::ConstSharedPtr>("path", path);
+  EXPECT_EQ(path->poses.size(), 2u);
+  EXPECT_EQ(path->poses[0].pose.position.x, 2.0);
+  EXPECT_EQ(path->poses[1].pose.position.x, 1.0);
 
   // halt node so another goal can be sent
   tree_->rootNode()->halt();
@@ -238,10 +238,10 @@ TEST_F(ComputePathToPoseActionTestFixture, test_tick_use_start)
   EXPECT_EQ(tree_->rootNode()->status(), BT::NodeStatus::SUCCESS);
   EXPECT_EQ(action_server_->getCurrentGoal()->goal.pose.position.x, -2.5);
 
-  config_->blackboard->get<nav_msgs::msg::Path>("path", path);
-  EXPECT_EQ(path.poses.size(), 2u);
-  EXPECT_EQ(path.poses[0].pose.position.x, -1.5);
-  EXPECT_EQ(path.poses[1].pose.position.x, -2.5);
+  config_->blackboard->get<nav_msgs::msg::Path::ConstSharedPtr>("path", path);
+  EXPECT_EQ(path->poses.size(), 2u);
+  EXPECT_EQ(path->poses[0].pose.position.x, -1.5);
+  EXPECT_EQ(path->poses[1].pose.position.x, -2.5);
 }
 
 int main(int argc, char ** argv)
@@ -18,6 +18,7 @@
 #include <memory>
 #include <set>
 #include <string>
+#include <thread>
 
 #include "nav_msgs/msg/path.hpp"
 
@@ -41,6 +42,16 @@ protected:
   {
     const auto goal = goal_handle->get_goal();
     auto result = std::make_shared<nav2_msgs::action::SmoothPath::Result>();
+    result->path = goal->path;
+
+    // Stream the first pose of longer paths, as if it ended their first segment
+    if (goal->path.poses.size() > 1) {
+      std::this_thread::sleep_for(std::chrono::milliseconds(50));
+      auto feedback = std::make_shared<nav2_msgs::action::SmoothPath::Feedback>();
+      feedback->path.poses.push_back(goal->path.poses.front());
+      goal_handle->publish_feedback(feedback);
+      std::this_thread::sleep_for(std::chrono::milliseconds(50));
+    }
     goal_handle->succeed(result);
   }
 };
@@ -143,7 +154,8 @@ TEST_F(SmoothPathActionTestFixture, test_tick)
   pose.pose.position.x = -2.5;
   pose.pose.orientation.x = 1.0;
   path.poses.push_back(pose);
-  config_->blackboard->set<nav_msgs::msg::Path>("unsmoothed_path", path);
+  config_->blackboard->set(
+    "unsmoothed_path", std::make_shared<const nav_msgs::msg::Path>(path));
 
   while (tree_->rootNode()->status() != BT::NodeStatus::SUCCESS) {
     tree_->rootNode()->executeTick();
@@ -155,6 +167,47 @@ TEST_F(SmoothPathActionTestFixture, test_tick)
   EXPECT_EQ(tree_->rootNode()->status(), BT::NodeStatus::SUCCESS);
 }
 
+TEST_F(SmoothPathActionTestFixture, test_streamed_segments)
+{
+  // create tree
+  std::string xml_txt =
+    R"(
+      <root main_tree_to_execute = "MainTree" >
+        <BehaviorTree ID="MainTree">
+            <SmoothPath unsmoothed_path="{unsmoothed_path}" smoothed_path="{streamed_path}" />
+        </BehaviorTree>
+      </root>)";
+
+  nav_msgs::msg::Path path;
+  geometry_msgs::msg::PoseStamped pose;
+  for (double x : {0.0, 1.0, 2.0}) {
+    pose.pose.position.x = x;
+    path.poses.push_back(pose);
+  }
+  config_->blackboard->set(
+    "unsmoothed_path", std::make_shared<const nav_msgs::msg::Path>(path));
+  nav_msgs::msg::Path::ConstSharedPtr smoothed_path;
+  config_->blackboard->set("streamed_path", smoothed_path);
+
+  tree_ = std::make_shared<BT::Tree>(factory_->createTreeFromText(xml_txt, config_->blackboard));
+
+  // tick until the streamed segment is given out, before the whole path is
+  do {
+    tree_->rootNode()->executeTick();
+    config_->blackboard->get("streamed_path", smoothed_path);
+  } while (!smoothed_path && tree_->rootNode()->status() != BT::NodeStatus::SUCCESS);
+  EXPECT_EQ(tree_->rootNode()->status(), BT::NodeStatus::RUNNING);
+  ASSERT_TRUE(smoothed_path);
+  ASSERT_EQ(smoothed_path->poses.size(), 1u);
+  EXPECT_EQ(smoothed_path->poses[0], path.poses[0]);
+
+  while (tree_->rootNode()->status() != BT::NodeStatus::SUCCESS) {
+    tree_->rootNode()->executeTick();
+  }
+  ASSERT_TRUE(config_->blackboard->get("streamed_path", smoothed_path));
+  EXPECT_EQ(*smoothed_path, path);
+}
+
 int main(int argc, char ** argv)
 {
   ::testing::InitGoogleTest(&argc, argv);
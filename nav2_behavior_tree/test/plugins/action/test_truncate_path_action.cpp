@@ -119,25 +119,31 @@ TEST_F(TruncatePathTestFixture, test_tick)
 
   EXPECT_EQ(path.poses.size(), 4u);
 
-  config_->blackboard->set("path", path);
+  config_->blackboard->set("path", std::make_shared<const nav_msgs::msg::Path>(path));
 
   // tick until node succeeds
   while (tree_->rootNode()->status() != BT::NodeStatus::SUCCESS) {
     tree_->rootNode()->executeTick();
   }
 
-  nav_msgs::msg::Path truncated_path;
+  nav_msgs::msg::Path::ConstSharedPtr truncated_path;
   config_->blackboard->get("truncated_path", truncated_path);
 
-  EXPECT_NE(path, truncated_path);
-  EXPECT_EQ(truncated_path.poses.size(), 2u);
+  EXPECT_NE(path, *truncated_path);
+  EXPECT_EQ(truncated_path->poses.size(), 2u);
 
   double r, p, y;
   tf2::Quaternion q;
-  tf2::fromMsg(truncated_path.poses.back().pose.orientation, q);
+  tf2::fromMsg(truncated_path->poses.back().pose.orientation, q);
   tf2::Matrix3x3(q).getRPY(r, p, y);
 
   EXPECT_NEAR(y, 0.463, 0.001);
+
+  // the same input path is not truncated again, its truncation is output as is
+  tree_->rootNode()->executeTick();
+  nav_msgs::msg::Path::ConstSharedPtr same_truncated_path;
+  config_->blackboard->get("truncated_path", same_truncated_path);
+  EXPECT_EQ(same_truncated_path, truncated_path);
 }
 
 int main(int argc, char ** argv)
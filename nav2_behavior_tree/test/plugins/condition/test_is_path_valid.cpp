@@ -13,6 +13,7 @@
 // limitations under the License.
 
 #include <gtest/gtest.h>
+#include <atomic>
 #include <chrono>
 #include <memory>
 #include <set>
@@ -42,9 +43,24 @@ public:
     const std::shared_ptr<nav2_msgs::srv::IsPathValid::Response> response)
   {
     (void)request_header;
-    (void)request;
+    // Registers paths as the planner server does, forgetting them when asked to
+    if (request->path_id == 0) {
+      paths_received_++;
+      response->path_id = ++registered_id_;
+    } else if (request->path_id == registered_id_ && !forget_) {
+      response->path_id = request->path_id;
+    } else {
+      forget_ = false;
+      response->path_id = 0;
+      response->is_valid = false;
+      return;
+    }
     response->is_valid = true;
   }
+
+  std::atomic<unsigned int> paths_received_{0};
+  std::atomic<uint32_t> registered_id_{0};
+  std::atomic<bool> forget_{false};
 };
 
 class IsPathValidTestFixture : public ::testing::Test
@@ -103,6 +119,45 @@ TEST_F(IsPathValidTestFixture, test_behavior)
   EXPECT_EQ(tree_->rootNode()->executeTick(), BT::NodeStatus::SUCCESS);
 }
 
+TEST_F(IsPathValidTestFixture, test_path_registration)
+{
+  std::string xml_txt =
+    R"(
+      <root main_tree_to_execute = "MainTree" >
+        <BehaviorTree ID="MainTree">
+            <IsPathValid path="{path}"/>
+        </BehaviorTree>
+      </root>)";
+
+  nav_msgs::msg::Path path;
+  path.header.frame_id = "map";
+  path.poses.resize(100);
+  for (unsigned int i = 0; i != path.poses.size(); i++) {
+    path.poses[i].pose.position.x = 0.1 * i;
+  }
+  config_->blackboard->set("path", std::make_shared<const nav_msgs::msg::Path>(path));
+
+  tree_ = std::make_shared<BT::Tree>(factory_->createTreeFromText(xml_txt, config_->blackboard));
+  std::this_thread::sleep_for(500ms);
+  const unsigned int paths_received = server_->paths_received_;
+
+  // The path is only sent once, until it changes
+  EXPECT_EQ(tree_->rootNode()->executeTick(), BT::NodeStatus::SUCCESS);
+  EXPECT_EQ(tree_->rootNode()->executeTick(), BT::NodeStatus::SUCCESS);
+  EXPECT_EQ(server_->paths_received_, paths_received + 1);
+
+  path.poses.back().pose.position.y = 1.0;
+  config_->blackboard->set("path", std::make_shared<const nav_msgs::msg::Path>(path));
+  EXPECT_EQ(tree_->rootNode()->executeTick(), BT::NodeStatus::SUCCESS);
+  EXPECT_EQ(tree_->rootNode()->executeTick(), BT::NodeStatus::SUCCESS);
+  EXPECT_EQ(server_->paths_received_, paths_received + 2);
+
+  // The path is sent again once it is not registered anymore
+  server_->forget_ = true;
+  EXPECT_EQ(tree_->rootNode()->executeTick(), BT::NodeStatus::SUCCESS);
+  EXPECT_EQ(server_->paths_received_, paths_received + 3);
+}
+
 int main(int argc, char ** argv)
 {
   ::testing::InitGoogleTest(&argc, argv);
@@ -0,0 +1,146 @@
+// Copyright (c) 2021 Samsung Research America
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <gtest/gtest.h>
+#include <cstdio>
+#include <fstream>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "behaviortree_cpp_v3/bt_factory.h"
+#include "nav2_behavior_tree/binary_bt_logger.hpp"
+
+// Keeps the status changes in memory, to compare them with the binary log
+class MemoryLogger : public BT::StatusChangeLogger
+{
+public:
+  explicit MemoryLogger(const BT::Tree & tree)
+  : StatusChangeLogger(tree.rootNode())
+  {}
+
+  void callback(
+    BT::Duration timestamp,
+    const BT::TreeNode & node,
+    BT::NodeStatus prev_status,
+    BT::NodeStatus status) override
+  {
+    events.push_back({timestamp, 0, node.name(), prev_status, status});
+  }
+
+  void flush() override
+  {
+  }
+
+  std::vector<nav2_behavior_tree::BtLogEvent> events;
+};
+
+static const char * const XML_TXT =
+  R"(
+    <root main_tree_to_execute = "MainTree" >
+      <BehaviorTree ID="MainTree">
+        <Fallback name="root">
+          <AlwaysFailure name="first"/>
+          <Sequence name="second">
+            <AlwaysSuccess name="third"/>
+            <AlwaysSuccess name="fourth"/>
+          </Sequence>
+        </Fallback>
+      </BehaviorTree>
+    </root>)";
+
+TEST(BinaryBtLoggerTest, test_replay)
+{
+  const std::string filename = "/tmp/test_binary_bt_logger.bin";
+  BT::BehaviorTreeFactory factory;
+  auto tree = factory.createTreeFromText(XML_TXT);
+  auto other_tree = factory.createTreeFromText(XML_TXT);
+
+  std::vector<nav2_behavior_tree::BtLogEvent> expected;
+  {
+    auto sink = std::make_shared<nav2_behavior_tree::BinaryBtLogSink>(filename);
+    nav2_behavior_tree::BinaryBtLogger logger(tree, sink);
+    MemoryLogger memory_logger(tree);
+    for (int i = 0; i < 3; ++i) {
+      EXPECT_EQ(tree.tickRoot(), BT::NodeStatus::SUCCESS);
+    }
+    expected = memory_logger.events;
+
+    // The records of a tree loaded later refer to its own node names
+    nav2_behavior_tree::BinaryBtLogger other_logger(other_tree, sink);
+    MemoryLogger other_memory_logger(other_tree);
+    EXPECT_EQ(other_tree.tickRoot(), BT::NodeStatus::SUCCESS);
+    for (auto & event : other_memory_logger.events) {
+      event.tree_id = 1;
+      expected.push_back(event);
+    }
+    EXPECT_EQ(sink->droppedRecords(), 0u);
+  }
+
+  auto events = nav2_behavior_tree::readBinaryBtLog(filename);
+  ASSERT_EQ(events.size(), expected.size());
+  EXPECT_FALSE(events.empty());
+  for (size_t i = 0; i < events.size(); ++i) {
+    EXPECT_EQ(events[i].timestamp, expected[i].timestamp);
+    EXPECT_EQ(events[i].tree_id, expected[i].tree_id);
+    EXPECT_EQ(events[i].node_name, expected[i].node_name);
+    EXPECT_EQ(events[i].previous_status, expected[i].previous_status);
+    EXPECT_EQ(events[i].current_status, expected[i].current_status);
+  }
+
+  std::remove(filename.c_str());
+}
+
+TEST(BinaryBtLoggerTest, test_full_buffer)
+{
+  const std::string filename = "/tmp/test_binary_bt_logger_full.bin";
+  BT::BehaviorTreeFactory factory;
+  auto tree = factory.createTreeFromText(XML_TXT);
+
+  uint64_t dropped;
+  {
+    // The background thread does not drain the buffer during the test
+    auto sink = std::make_shared<nav2_behavior_tree::BinaryBtLogSink>(
+      filename, 4, std::chrono::hours(1));
+    nav2_behavior_tree::BinaryBtLogger logger(tree, sink);
+    for (int i = 0; i < 10; ++i) {
+      logger.callback(
+        BT::Duration(i), *tree.rootNode(), BT::NodeStatus::IDLE, BT::NodeStatus::RUNNING);
+    }
+    dropped = sink->droppedRecords();
+  }
+
+  // The records that did not fit are dropped instead of blocking the tick
+  EXPECT_EQ(dropped, 6u);
+  auto events = nav2_behavior_tree::readBinaryBtLog(filename);
+  ASSERT_EQ(events.size(), 4u);
+  for (size_t i = 0; i < events.size(); ++i) {
+    EXPECT_EQ(events[i].timestamp, BT::Duration(i));
+    EXPECT_EQ(events[i].node_name, "root");
+  }
+
+  std::remove(filename.c_str());
+}
+
+TEST(BinaryBtLoggerTest, test_invalid_file)
+{
+  const std::string filename = "/tmp/test_binary_bt_logger_invalid.bin";
+  {
+    std::ofstream file(filename);
+    file << "not a binary BT log file";
+  }
+  EXPECT_THROW(nav2_behavior_tree::readBinaryBtLog(filename), std::runtime_error);
+  EXPECT_THROW(nav2_behavior_tree::readBinaryBtLog("/tmp/does_not_exist.bin"), std::runtime_error);
+  std::remove(filename.c_str());
+}
@@ -0,0 +1,153 @@
+// Copyright (c) 2021 Samsung Research America
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <gtest/gtest.h>
+#include <chrono>
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <thread>
+
+#include "behaviortree_cpp_v3/bt_factory.h"
+#include "nav2_behavior_tree/bt_profiler.hpp"
+
+using namespace std::chrono_literals;  // NOLINT
+
+// Sleeps in tick(), reporting its ticks to the profiler like the nav2 BT nodes do
+class SleepNode : public BT::SyncActionNode
+{
+public:
+  SleepNode(const std::string & name, const BT::NodeConfiguration & config)
+  : SyncActionNode(name, config)
+  {
+    config.blackboard->get("bt_profiler", profiler_);
+  }
+
+  BT::NodeStatus tick() override
+  {
+    nav2_behavior_tree::BtProfiler::ScopedTick profiled_tick(profiler_.get(), *this);
+    std::this_thread::sleep_for(2ms);
+    return BT::NodeStatus::SUCCESS;
+  }
+
+  static BT::PortsList providedPorts()
+  {
+    return {};
+  }
+
+protected:
+  nav2_behavior_tree::BtProfiler::Ptr profiler_;
+};
+
+static const char * const XML_TXT =
+  R"(
+    <root main_tree_to_execute = "MainTree" >
+      <BehaviorTree ID="MainTree">
+        <Sequence name="root">
+          <Sleep name="sleep"/>
+          <AlwaysSuccess name="success"/>
+        </Sequence>
+      </BehaviorTree>
+    </root>)";
+
+static const nav2_msgs::msg::BehaviorTreeNodeStatistics & findNode(
+  const nav2_msgs::msg::BehaviorTreeStatistics & msg,
+  const std::string & name)
+{
+  for (const auto & node : msg.nodes) {
+    if (node.node_name == name) {
+      return node;
+    }
+  }
+  throw std::runtime_error("No statistics for node " + name);
+}
+
+TEST(BtProfilerTest, test_tree_profile)
+{
+  BT::BehaviorTreeFactory factory;
+  factory.registerNodeType<SleepNode>("Sleep");
+
+  auto profiler = std::make_shared<nav2_behavior_tree::BtProfiler>();
+  auto blackboard = BT::Blackboard::create();
+  blackboard->set<nav2_behavior_tree::BtProfiler::Ptr>("bt_profiler", profiler);
+  auto tree = factory.createTreeFromText(XML_TXT, blackboard);
+  profiler->addTree(tree);
+
+  for (int i = 0; i < 3; ++i) {
+    EXPECT_EQ(tree.tickRoot(), BT::NodeStatus::SUCCESS);
+  }
+
+  auto msg = profiler->toMsg();
+  ASSERT_EQ(msg.nodes.size(), 3u);
+
+  // Only the nodes reporting their ticks have tick statistics
+  auto sleep = findNode(msg, "sleep");
+  EXPECT_EQ(sleep.node_type, "Sleep");
+  EXPECT_EQ(sleep.ticks, 3u);
+  EXPECT_GE(sleep.tick_time, 0.006);
+  EXPECT_GE(sleep.max_tick_time, 0.002);
+  EXPECT_LE(sleep.max_tick_time, sleep.tick_time);
+  EXPECT_EQ(sleep.runs, 3u);
+  EXPECT_EQ(sleep.successes, 3u);
+  EXPECT_EQ(sleep.failures, 0u);
+
+  auto success = findNode(msg, "success");
+  EXPECT_EQ(success.ticks, 0u);
+  EXPECT_EQ(success.runs, 3u);
+  EXPECT_EQ(success.successes, 3u);
+
+  // The sequence is RUNNING while its children are ticked
+  auto root = findNode(msg, "root");
+  EXPECT_EQ(root.runs, 3u);
+  EXPECT_EQ(root.successes, 3u);
+  EXPECT_GE(root.running_time, 0.006);
+
+  // The most expensive nodes come first in the report
+  auto report = profiler->report();
+  auto sleep_line = report.find("\nsleep ");
+  auto success_line = report.find("\nsuccess ");
+  ASSERT_NE(sleep_line, std::string::npos);
+  ASSERT_NE(success_line, std::string::npos);
+  EXPECT_LT(sleep_line, success_line);
+}
+
+TEST(BtProfilerTest, test_goal_latencies)
+{
+  BT::BehaviorTreeFactory factory;
+  factory.registerNodeType<SleepNode>("Sleep");
+  auto tree = factory.createTreeFromText(XML_TXT);
+  const BT::TreeNode & node = *tree.rootNode();
+
+  nav2_behavior_tree::BtProfiler profiler;
+  for (int i = 0; i < 2; ++i) {
+    profiler.recordGoalSent(node);
+    std::this_thread::sleep_for(2ms);
+    profiler.recordGoalAccepted(node);
+    std::this_thread::sleep_for(2ms);
+    profiler.recordGoalResult(node);
+  }
+  // A goal which was never answered
+  profiler.recordGoalSent(node);
+
+  auto msg = profiler.toMsg();
+  ASSERT_EQ(msg.nodes.size(), 1u);
+  auto root = msg.nodes[0];
+  EXPECT_EQ(root.goals, 3u);
+  EXPECT_EQ(root.accepted_goals, 2u);
+  EXPECT_EQ(root.results, 2u);
+  EXPECT_GE(root.mean_accept_latency, 0.002);
+  EXPECT_GE(root.max_accept_latency, root.mean_accept_latency);
+  EXPECT_GE(root.mean_result_latency, 0.004);
+  EXPECT_GE(root.max_result_latency, root.mean_result_latency);
+}
@@ -117,9 +117,12 @@ public:
     node->get_parameter("robot_base_frame", robot_base_frame_);
     node->get_parameter("transform_tolerance", transform_tolerance_);
 
+    // Each behavior spins its action server in its own callback group and thread, so
+    // that behaviors running at the same time do not hold up each other's callbacks
     action_server_ = std::make_shared<ActionServer>(
       node, behavior_name_,
-      std::bind(&TimedBehavior::execute, this));
+      std::bind(&TimedBehavior::execute, this),
+      nullptr, std::chrono::milliseconds(500), true);
 
     collision_checker_ = collision_checker;
 
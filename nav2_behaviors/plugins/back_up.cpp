@@ -12,10 +12,13 @@
 // See the License for the specific language governing permissions and
 // limitations under the License.
 
+#include <algorithm>
 #include <chrono>
+#include <cmath>
 #include <ctime>
 #include <memory>
 #include <utility>
+#include <vector>
 
 #include "back_up.hpp"
 #include "nav2_util/node_utils.hpp"
@@ -71,6 +74,25 @@ Status BackUp::onRun(const std::shared_ptr<const BackUpAction::Goal> command)
     return Status::FAILED;
   }
 
+  // The footprint is rasterized once for the whole back up, at the distance it moves by each
+  // cycle. The cycles then only check again the cells changed by the costmap updates.
+  distance_step_ = command_speed_ / cycle_frequency_;
+  std::vector<geometry_msgs::msg::Pose2D> poses;
+  geometry_msgs::msg::Pose2D pose2d;
+  pose2d.theta = tf2::getYaw(initial_pose_.pose.orientation);
+  const size_t pose_count = distance_step_ > 0.0 ?
+    static_cast<size_t>(std::ceil(command_x_ / distance_step_)) + 1 : 1;
+  for (size_t i = 0; i < pose_count; ++i) {
+    const double sim_position_change = -std::min(i * distance_step_, command_x_);
+    pose2d.x = initial_pose_.pose.position.x + sim_position_change * cos(pose2d.theta);
+    pose2d.y = initial_pose_.pose.position.y + sim_position_change * sin(pose2d.theta);
+    poses.push_back(pose2d);
+  }
+  if (!collision_checker_->prepareManeuver(poses, maneuver_)) {
+    RCLCPP_ERROR(logger_, "Unable to check the back up for collisions.");
+    return Status::FAILED;
+  }
+
   return Status::SUCCEEDED;
 }
 
@@ -112,12 +134,7 @@ Status BackUp::onCycleUpdate()
   cmd_vel->angular.z = 0.0;
   cmd_vel->linear.x = -command_speed_;
 
-  geometry_msgs::msg::Pose2D pose2d;
-  pose2d.x = current_pose.pose.position.x;
-  pose2d.y = current_pose.pose.position.y;
-  pose2d.theta = tf2::getYaw(current_pose.pose.orientation);
-
-  if (!isCollisionFree(distance, cmd_vel.get(), pose2d)) {
+  if (!isCollisionFree(distance, cmd_vel.get())) {
     stopRobot();
     RCLCPP_WARN(logger_, "Collision Ahead - Exiting BackUp");
     return Status::FAILED;
@@ -130,33 +147,17 @@ Status BackUp::onCycleUpdate()
 
 bool BackUp::isCollisionFree(
   const double & distance,
-  geometry_msgs::msg::Twist * cmd_vel,
-  geometry_msgs::msg::Pose2D & pose2d)
+  geometry_msgs::msg::Twist * cmd_vel)
 {
-  // Simulate ahead by simulate_ahead_time_ in cycle_frequency_ increments
-  int cycle_count = 0;
-  double sim_position_change;
-  const double diff_dist = abs(command_x_) - distance;
-  const int max_cycle_count = static_cast<int>(cycle_frequency_ * simulate_ahead_time_);
-  geometry_msgs::msg::Pose2D init_pose = pose2d;
-  bool fetch_data = true;
-
-  while (cycle_count < max_cycle_count) {
-    sim_position_change = cmd_vel->linear.x * (cycle_count / cycle_frequency_);
-    pose2d.x = init_pose.x + sim_position_change * cos(init_pose.theta);
-    pose2d.y = init_pose.y + sim_position_change * sin(init_pose.theta);
-    cycle_count++;
-
-    if (diff_dist - abs(sim_position_change) <= 0.) {
-      break;
-    }
-
-    if (!collision_checker_->isCollisionFree(pose2d, fetch_data)) {
-      return false;
-    }
-    fetch_data = false;
+  if (distance_step_ <= 0.0) {
+    return collision_checker_->findFirstCollision(maneuver_, 0, 1) == -1;
   }
-  return true;
+
+  // Simulate ahead by simulate_ahead_time_, over the poses of the back up from the current one
+  const size_t first = static_cast<size_t>(distance / distance_step_);
+  const size_t count = static_cast<size_t>(
+    std::ceil(abs(cmd_vel->linear.x) * simulate_ahead_time_ / distance_step_)) + 1;
+  return collision_checker_->findFirstCollision(maneuver_, first, first + count) == -1;
 }
 
 }  // namespace nav2_behaviors
@@ -56,13 +56,11 @@ protected:
    * @brief Check if pose is collision free
    * @param distance Distance to check forward
    * @param cmd_vel current commanded velocity
-   * @param pose2d Current pose
    * @return is collision free or not
    */
   bool isCollisionFree(
     const double & distance,
-    geometry_msgs::msg::Twist * cmd_vel,
-    geometry_msgs::msg::Pose2D & pose2d);
+    geometry_msgs::msg::Twist * cmd_vel);
 
   /**
    * @brief Configuration of behavior action
@@ -79,6 +77,9 @@ protected:
   rclcpp::Duration command_time_allowance_{0, 0};
   rclcpp::Time end_time_;
   double simulate_ahead_time_;
+  // Poses of the back up, distance_step_ apart, prepared for collision checking by onRun
+  double distance_step_;
+  nav2_costmap_2d::CostmapTopicCollisionChecker::Maneuver maneuver_;
 
   BackUpAction::Feedback::SharedPtr feedback_;
 };
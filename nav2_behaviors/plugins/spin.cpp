@@ -19,6 +19,7 @@
 #include <algorithm>
 #include <memory>
 #include <utility>
+#include <vector>
 
 #include "spin.hpp"
 #pragma GCC diagnostic push
@@ -92,6 +93,27 @@ Status Spin::onRun(const std::shared_ptr<const SpinAction::Goal> command)
     logger_, "Turning %0.2f for spin behavior.",
     cmd_yaw_);
 
+  // The footprint is rasterized once for the whole spin, at the yaw it turns by each cycle
+  // at most. The cycles then only check again the cells changed by the costmap updates.
+  yaw_step_ = max_rotational_vel_ / cycle_frequency_;
+  if (yaw_step_ <= 0.0) {
+    RCLCPP_ERROR(logger_, "The maximum rotational velocity must be positive.");
+    return Status::FAILED;
+  }
+  std::vector<geometry_msgs::msg::Pose2D> poses;
+  geometry_msgs::msg::Pose2D pose2d;
+  pose2d.x = current_pose.pose.position.x;
+  pose2d.y = current_pose.pose.position.y;
+  const size_t pose_count = static_cast<size_t>(std::ceil(abs(cmd_yaw_) / yaw_step_)) + 1;
+  for (size_t i = 0; i < pose_count; ++i) {
+    pose2d.theta = prev_yaw_ + copysign(std::min(i * yaw_step_, abs(cmd_yaw_)), cmd_yaw_);
+    poses.push_back(pose2d);
+  }
+  if (!collision_checker_->prepareManeuver(poses, maneuver_)) {
+    RCLCPP_ERROR(logger_, "Unable to check the spin for collisions.");
+    return Status::FAILED;
+  }
+
   command_time_allowance_ = command->time_allowance;
   end_time_ = steady_clock_.now() + command_time_allowance_;
 
@@ -143,12 +165,7 @@ Status Spin::onCycleUpdate()
   auto cmd_vel = std::make_unique<geometry_msgs::msg::Twist>();
   cmd_vel->angular.z = copysign(vel, cmd_yaw_);
 
-  geometry_msgs::msg::Pose2D pose2d;
-  pose2d.x = current_pose.pose.position.x;
-  pose2d.y = current_pose.pose.position.y;
-  pose2d.theta = tf2::getYaw(current_pose.pose.orientation);
-
-  if (!isCollisionFree(relative_yaw_, cmd_vel.get(), pose2d)) {
+  if (!isCollisionFree(relative_yaw_, cmd_vel.get())) {
     stopRobot();
     RCLCPP_WARN(logger_, "Collision Ahead - Exiting Spin");
     return Status::FAILED;
@@ -161,31 +178,13 @@ Status Spin::onCycleUpdate()
 
 bool Spin::isCollisionFree(
   const double & relative_yaw,
-  geometry_msgs::msg::Twist * cmd_vel,
-  geometry_msgs::msg::Pose2D & pose2d)
+  geometry_msgs::msg::Twist * cmd_vel)
 {
-  // Simulate ahead by simulate_ahead_time_ in cycle_frequency_ increments
-  int cycle_count = 0;
-  double sim_position_change;
-  const int max_cycle_count = static_cast<int>(cycle_frequency_ * simulate_ahead_time_);
-  geometry_msgs::msg::Pose2D init_pose = pose2d;
-  bool fetch_data = true;
-
-  while (cycle_count < max_cycle_count) {
-    sim_position_change = cmd_vel->angular.z * (cycle_count / cycle_frequency_);
-    pose2d.theta = init_pose.theta + sim_position_change;
-    cycle_count++;
-
-    if (abs(relative_yaw) - abs(sim_position_change) <= 0.) {
-      break;
-    }
-
-    if (!collision_checker_->isCollisionFree(pose2d, fetch_data)) {
-      return false;
-    }
-    fetch_data = false;
-  }
-  return true;
+  // Simulate ahead by simulate_ahead_time_, over the poses of the spin from the current one
+  const size_t first = static_cast<size_t>(abs(relative_yaw) / yaw_step_);
+  const size_t count = static_cast<size_t>(
+    std::ceil(abs(cmd_vel->angular.z) * simulate_ahead_time_ / yaw_step_)) + 1;
+  return collision_checker_->findFirstCollision(maneuver_, first, first + count) == -1;
 }
 
 }  // namespace nav2_behaviors
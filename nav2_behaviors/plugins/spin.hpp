@@ -63,13 +63,11 @@ protected:
    * @brief Check if pose is collision free
    * @param distance Distance to check forward
    * @param cmd_vel current commanded velocity
-   * @param pose2d Current pose
    * @return is collision free or not
    */
   bool isCollisionFree(
     const double & distance,
-    geometry_msgs::msg::Twist * cmd_vel,
-    geometry_msgs::msg::Pose2D & pose2d);
+    geometry_msgs::msg::Twist * cmd_vel);
 
   SpinAction::Feedback::SharedPtr feedback_;
 
@@ -80,6 +78,9 @@ protected:
   double prev_yaw_;
   double relative_yaw_;
   double simulate_ahead_time_;
+  // Poses of the spin, yaw_step_ apart, prepared for collision checking by onRun
+  double yaw_step_;
+  nav2_costmap_2d::CostmapTopicCollisionChecker::Maneuver maneuver_;
   rclcpp::Duration command_time_allowance_{0, 0};
   rclcpp::Time end_time_;
 };
@@ -12,6 +12,7 @@
 // See the License for the specific language governing permissions and
 // limitations under the License. Reserved.
 
+#include <algorithm>
 #include <memory>
 #include <string>
 #include <vector>
@@ -35,6 +36,10 @@ BehaviorServer::BehaviorServer(const rclcpp::NodeOptions & options)
     "footprint_topic",
     rclcpp::ParameterValue(std::string("local_costmap/published_footprint")));
   declare_parameter("cycle_frequency", rclcpp::ParameterValue(10.0));
+  declare_parameter("collision_pyramid_levels", rclcpp::ParameterValue(3));
+  declare_parameter("in_process_costmap", rclcpp::ParameterValue(false));
+  declare_parameter("shared_memory_costmap", rclcpp::ParameterValue(false));
+  declare_parameter("shared_memory_timeout", rclcpp::ParameterValue(2.0));
   declare_parameter("behavior_plugins", default_ids_);
 
   get_parameter("behavior_plugins", behavior_ids_);
@@ -74,13 +79,24 @@ BehaviorServer::on_configure(const rclcpp_lifecycle::State & /*state*/)
   transform_listener_ = std::make_shared<tf2_ros::TransformListener>(*tf_);
 
   std::string costmap_topic, footprint_topic, robot_base_frame;
-  double transform_tolerance;
+  double transform_tolerance, shared_memory_timeout;
+  int collision_pyramid_levels;
+  bool in_process_costmap, shared_memory_costmap;
   this->get_parameter("costmap_topic", costmap_topic);
   this->get_parameter("footprint_topic", footprint_topic);
   this->get_parameter("transform_tolerance", transform_tolerance);
   this->get_parameter("robot_base_frame", robot_base_frame);
+  this->get_parameter("collision_pyramid_levels", collision_pyramid_levels);
+  this->get_parameter("in_process_costmap", in_process_costmap);
+  this->get_parameter("shared_memory_costmap", shared_memory_costmap);
+  this->get_parameter("shared_memory_timeout", shared_memory_timeout);
   costmap_sub_ = std::make_unique<nav2_costmap_2d::CostmapSubscriber>(
     shared_from_this(), costmap_topic);
+  // Composed with the costmap, read it directly rather than through its topics
+  costmap_sub_->setInProcess(in_process_costmap);
+  costmap_sub_->setSharedMemory(shared_memory_costmap, shared_memory_timeout);
+  // Coarse levels of the costmap let trajectories far from obstacles be checked quickly
+  costmap_sub_->setPyramidLevels(static_cast<unsigned int>(std::max(collision_pyramid_levels, 0)));
   footprint_sub_ = std::make_unique<nav2_costmap_2d::FootprintSubscriber>(
     shared_from_this(), footprint_topic, *tf_, robot_base_frame, transform_tolerance);
 
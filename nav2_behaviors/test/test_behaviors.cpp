@@ -253,6 +253,41 @@ TEST_F(BehaviorTest, testingTotalElapsedTimeIsZeroIfFailureOnRun)
   SUCCEED();
 }
 
+TEST_F(BehaviorTest, testingConcurrentBehaviors)
+{
+  // Another behavior of the same server, with its own action server thread
+  auto other_behavior = std::make_shared<DummyBehavior>();
+  other_behavior->configure(node_lifecycle_, "OtherBehavior", tf_buffer_, nullptr);
+  other_behavior->activate();
+  auto other_client = rclcpp_action::create_client<BehaviorAction>(
+    node_lifecycle_->get_node_base_interface(),
+    node_lifecycle_->get_node_graph_interface(),
+    node_lifecycle_->get_node_logging_interface(),
+    node_lifecycle_->get_node_waitables_interface(), "OtherBehavior");
+  ASSERT_TRUE(other_client->wait_for_action_server(4s));
+
+  auto start_time = std::chrono::steady_clock::now();
+  ASSERT_TRUE(sendCommand("Testing success"));
+  auto goal = BehaviorAction::Goal();
+  goal.command.data = "Testing success";
+  auto future_goal = other_client->async_send_goal(goal);
+  ASSERT_EQ(
+    rclcpp::spin_until_future_complete(node_lifecycle_, future_goal),
+    rclcpp::FutureReturnCode::SUCCESS);
+  auto other_goal_handle = future_goal.get();
+  ASSERT_TRUE(other_goal_handle);
+
+  // Both behaviors run at the same time
+  EXPECT_EQ(getOutcome(), Status::SUCCEEDED);
+  auto future_result = other_client->async_get_result(other_goal_handle);
+  rclcpp::spin_until_future_complete(node_lifecycle_, future_result);
+  EXPECT_EQ(future_result.get().code, rclcpp_action::ResultCode::SUCCEEDED);
+  EXPECT_LT(std::chrono::steady_clock::now() - start_time, 1900ms);
+
+  other_behavior->deactivate();
+  other_behavior->cleanup();
+}
+
 int main(int argc, char ** argv)
 {
   ::testing::InitGoogleTest(&argc, argv);
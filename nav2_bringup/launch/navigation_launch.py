@@ -163,7 +163,7 @@ def generate_launch_description():
                 package='nav2_smoother',
                 plugin='nav2_smoother::SmootherServer',
                 name='smoother_server',
-                parameters=[configured_params],
+                parameters=[configured_params, {'in_process_costmap': True}],
                 remappings=remappings),
             ComposableNode(
                 package='nav2_planner',
@@ -175,7 +175,7 @@ def generate_launch_description():
                 package='nav2_behaviors',
                 plugin='behavior_server::BehaviorServer',
                 name='behavior_server',
-                parameters=[configured_params],
+                parameters=[configured_params, {'in_process_costmap': True}],
                 remappings=remappings),
             ComposableNode(
                 package='nav2_bt_navigator',
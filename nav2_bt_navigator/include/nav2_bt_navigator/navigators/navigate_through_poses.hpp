@@ -18,11 +18,13 @@
 #include <string>
 #include <vector>
 #include <memory>
+#include <mutex>
 #include "rclcpp/rclcpp.hpp"
 #include "rclcpp_action/rclcpp_action.hpp"
 #include "geometry_msgs/msg/pose_stamped.hpp"
 #include "nav2_bt_navigator/navigator.hpp"
 #include "nav2_msgs/action/navigate_through_poses.hpp"
+#include "nav2_msgs/srv/compute_paths.hpp"
 #include "nav_msgs/msg/path.hpp"
 #include "nav2_util/robot_utils.hpp"
 #include "nav2_util/geometry_utils.hpp"
@@ -40,6 +42,7 @@ class NavigateThroughPosesNavigator
 {
 public:
   using ActionT = nav2_msgs::action::NavigateThroughPoses;
+  using PlannerServiceT = nav2_msgs::srv::ComputePaths;
   typedef std::vector<geometry_msgs::msg::PoseStamped> Goals;
 
   /**
@@ -98,15 +101,42 @@ protected:
    */
   void goalCompleted(typename ActionT::Result::SharedPtr result) override;
 
+  /**
+   * @brief Method to cleanup resources.
+   */
+  bool cleanup() override;
+
   /**
    * @brief Goal pose initialization on the blackboard
    */
   void initializeGoalPoses(ActionT::Goal::ConstSharedPtr goal);
 
+  /**
+   * @brief Put the last prefetched path on the blackboard, and request the path from the
+   * next goal through the following ones when getting close to the next goal
+   * @param goal_poses Goals left to navigate through
+   * @param current_pose Current robot pose
+   */
+  void prefetchPath(
+    const Goals & goal_poses,
+    const geometry_msgs::msg::PoseStamped & current_pose);
+
   rclcpp::Time start_time_;
   std::string goals_blackboard_id_;
   std::string path_blackboard_id_;
 
+  // To compute the path from the next goal while the robot is getting to it
+  bool prefetch_paths_;
+  double prefetch_distance_;
+  std::string prefetch_planner_id_;
+  rclcpp::Client<PlannerServiceT>::SharedPtr prefetch_client_;
+  // Goals the last path was requested through, and the last path received
+  Goals prefetch_goals_;
+  Goals prefetched_goals_;
+  nav_msgs::msg::Path::ConstSharedPtr prefetched_path_;
+  bool prefetched_path_received_;
+  std::mutex prefetch_mutex_;
+
   // Odometry smoother object
   std::shared_ptr<nav2_util::OdomSmoother> odom_smoother_;
 };
@@ -36,6 +36,7 @@ BtNavigator::BtNavigator(const rclcpp::NodeOptions & options)
   const std::vector<std::string> plugin_libs = {
     "nav2_compute_path_to_pose_action_bt_node",
     "nav2_compute_path_through_poses_action_bt_node",
+    "nav2_compute_path_race_action_bt_node",
     "nav2_smooth_path_action_bt_node",
     "nav2_follow_path_action_bt_node",
     "nav2_back_up_action_bt_node",
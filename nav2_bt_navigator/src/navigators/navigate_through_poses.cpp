@@ -12,6 +12,7 @@
 // See the License for the specific language governing permissions and
 // limitations under the License.
 
+#include <algorithm>
 #include <vector>
 #include <string>
 #include <set>
@@ -42,12 +43,44 @@ NavigateThroughPosesNavigator::configure(
 
   path_blackboard_id_ = node->get_parameter("path_blackboard_id").as_string();
 
+  if (!node->has_parameter("prefetch_paths")) {
+    node->declare_parameter("prefetch_paths", false);
+  }
+
+  prefetch_paths_ = node->get_parameter("prefetch_paths").as_bool();
+
+  if (!node->has_parameter("prefetch_distance")) {
+    node->declare_parameter("prefetch_distance", 2.0);
+  }
+
+  prefetch_distance_ = node->get_parameter("prefetch_distance").as_double();
+
+  if (!node->has_parameter("prefetch_planner_id")) {
+    node->declare_parameter("prefetch_planner_id", std::string(""));
+  }
+
+  prefetch_planner_id_ = node->get_parameter("prefetch_planner_id").as_string();
+
+  // The paths are prefetched with the compute_paths service rather than the actions of the
+  // planner server, so that they don't preempt the planning of the behavior tree
+  if (prefetch_paths_) {
+    prefetch_client_ = node->create_client<PlannerServiceT>("compute_paths");
+  }
+  prefetched_path_received_ = false;
+
   // Odometry smoother object for getting current speed
   odom_smoother_ = odom_smoother;
 
   return true;
 }
 
+bool
+NavigateThroughPosesNavigator::cleanup()
+{
+  prefetch_client_.reset();
+  return true;
+}
+
 std::string
 NavigateThroughPosesNavigator::getDefaultBTFilepath(
   rclcpp_lifecycle::LifecycleNode::WeakPtr parent_node)
@@ -111,15 +144,23 @@ NavigateThroughPosesNavigator::onLoop()
   }
 
   geometry_msgs::msg::PoseStamped current_pose;
-  nav2_util::getCurrentPose(
+  bool current_pose_found = nav2_util::getCurrentPose(
     current_pose, *feedback_utils_.tf,
     feedback_utils_.global_frame, feedback_utils_.robot_frame,
     feedback_utils_.transform_tolerance);
 
+  if (prefetch_client_ && current_pose_found) {
+    prefetchPath(goal_poses, current_pose);
+  }
+
   try {
-    // Get current path points
-    nav_msgs::msg::Path current_path;
-    blackboard->get<nav_msgs::msg::Path>(path_blackboard_id_, current_path);
+    // Get current path points, shared with the tree rather than copied
+    nav_msgs::msg::Path::ConstSharedPtr current_path_ptr;
+    blackboard->get<nav_msgs::msg::Path::ConstSharedPtr>(path_blackboard_id_, current_path_ptr);
+    if (!current_path_ptr) {
+      current_path_ptr = std::make_shared<const nav_msgs::msg::Path>();
+    }
+    const nav_msgs::msg::Path & current_path = *current_path_ptr;
 
     // Find the closest pose to current pose on global path
     auto find_closest_pose_idx =
@@ -212,6 +253,88 @@ NavigateThroughPosesNavigator::initializeGoalPoses(ActionT::Goal::ConstSharedPtr
 
   // Update the goal pose on the blackboard
   blackboard->set<Goals>(goals_blackboard_id_, goal->poses);
+
+  // Forget the paths prefetched for the previous goal
+  if (prefetch_client_) {
+    std::lock_guard<std::mutex> lock(prefetch_mutex_);
+    prefetch_goals_.clear();
+    prefetched_path_received_ = false;
+    blackboard->set<nav_msgs::msg::Path::ConstSharedPtr>(
+      "prefetched_path", std::make_shared<const nav_msgs::msg::Path>());
+    blackboard->set<Goals>("prefetched_goals", Goals());
+  }
+}
+
+void
+NavigateThroughPosesNavigator::prefetchPath(
+  const Goals & goal_poses,
+  const geometry_msgs::msg::PoseStamped & current_pose)
+{
+  auto blackboard = bt_action_server_->getBlackboard();
+
+  std::lock_guard<std::mutex> lock(prefetch_mutex_);
+  if (prefetched_path_received_) {
+    // Set from the BT thread, for ComputePathThroughPoses to use it once the next goal is passed
+    blackboard->set<nav_msgs::msg::Path::ConstSharedPtr>("prefetched_path", prefetched_path_);
+    blackboard->set<Goals>("prefetched_goals", prefetched_goals_);
+    prefetched_path_received_ = false;
+  }
+
+  if (goal_poses.size() < 2 ||
+    nav2_util::geometry_utils::euclidean_distance(current_pose, goal_poses.front()) >
+    prefetch_distance_)
+  {
+    return;
+  }
+
+  Goals next_goals(goal_poses.begin() + 1, goal_poses.end());
+  if (next_goals == prefetch_goals_ || !prefetch_client_->service_is_ready()) {
+    return;
+  }
+
+  // Plan from the next goal, where the robot will be when it is passed, each segment from a
+  // goal to the following one
+  auto request = std::make_shared<PlannerServiceT::Request>();
+  request->starts.assign(goal_poses.begin(), goal_poses.end() - 1);
+  request->goals = next_goals;
+  request->planner_id = prefetch_planner_id_;
+
+  auto response_callback =
+    [this, next_goals](rclcpp::Client<PlannerServiceT>::SharedFuture future) {
+      auto response = future.get();
+      if (response->paths.size() != next_goals.size() ||
+        std::any_of(
+          response->paths.begin(), response->paths.end(),
+          [](const nav_msgs::msg::Path & path) {return path.poses.empty();}))
+      {
+        RCLCPP_DEBUG(logger_, "Failed to prefetch the path through the next goals");
+        return;
+      }
+      std::lock_guard<std::mutex> lock(prefetch_mutex_);
+      if (next_goals != prefetch_goals_) {
+        return;
+      }
+
+      // Concatenated like the segments of ComputePathThroughPoses
+      auto prefetched_path = std::make_shared<nav_msgs::msg::Path>();
+      for (const auto & path : response->paths) {
+        prefetched_path->poses.insert(
+          prefetched_path->poses.end(), path.poses.begin(), path.poses.end());
+        prefetched_path->header = path.header;
+      }
+      if (rclcpp::Time(prefetched_path->header.stamp).nanoseconds() == 0) {
+        prefetched_path->header.stamp = clock_->now();
+      }
+      prefetched_path_ = prefetched_path;
+      prefetched_goals_ = next_goals;
+      prefetched_path_received_ = true;
+    };
+
+  RCLCPP_DEBUG(
+    logger_, "Prefetching the path through the %lu goals after the next one",
+    next_goals.size());
+  prefetch_goals_ = next_goals;
+  prefetch_client_->async_send_request(request, response_callback);
 }
 
 }  // namespace nav2_bt_navigator
@@ -121,9 +121,13 @@ NavigateToPoseNavigator::onLoop()
   auto blackboard = bt_action_server_->getBlackboard();
 
   try {
-    // Get current path points
-    nav_msgs::msg::Path current_path;
-    blackboard->get<nav_msgs::msg::Path>(path_blackboard_id_, current_path);
+    // Get current path points, shared with the tree rather than copied
+    nav_msgs::msg::Path::ConstSharedPtr current_path_ptr;
+    blackboard->get<nav_msgs::msg::Path::ConstSharedPtr>(path_blackboard_id_, current_path_ptr);
+    if (!current_path_ptr) {
+      current_path_ptr = std::make_shared<const nav_msgs::msg::Path>();
+    }
+    const nav_msgs::msg::Path & current_path = *current_path_ptr;
 
     // Find the closest pose to current pose on global path
     auto find_closest_pose_idx =
@@ -0,0 +1,161 @@
+// Copyright (c) 2022 Samsung Research America
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef NAV2_COLLISION_MONITOR__COLLISION_MONITOR_HPP_
+#define NAV2_COLLISION_MONITOR__COLLISION_MONITOR_HPP_
+
+#include <chrono>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+#include "geometry_msgs/msg/twist.hpp"
+#include "nav2_collision_monitor/collision_zones.hpp"
+#include "nav2_util/lifecycle_node.hpp"
+#include "rclcpp/rclcpp.hpp"
+#include "sensor_msgs/msg/laser_scan.hpp"
+#include "sensor_msgs/msg/point_cloud2.hpp"
+#include "tf2/LinearMath/Transform.h"
+#include "tf2_ros/buffer.h"
+#include "tf2_ros/transform_listener.h"
+
+namespace nav2_collision_monitor
+{
+
+/**
+ * @class nav2_collision_monitor::CollisionMonitor
+ * @brief A node filtering the velocity commands of the robot against raw laser scans and
+ * point clouds, without a costmap. Commands are stopped or slowed down while sensor points
+ * are in the stop or slow zones swept along them, and filtered again as soon as new sensor
+ * data arrives, so that the robot reacts at the rate of its sensors.
+ */
+class CollisionMonitor : public nav2_util::LifecycleNode
+{
+public:
+  /**
+   * @brief A constructor for nav2_collision_monitor::CollisionMonitor
+   * @param options Additional options to control creation of the node.
+   */
+  explicit CollisionMonitor(const rclcpp::NodeOptions & options = rclcpp::NodeOptions());
+
+  /**
+   * @brief A destructor for nav2_collision_monitor::CollisionMonitor
+   */
+  ~CollisionMonitor();
+
+protected:
+  /**
+   * @brief Configures the zones, the sensor subscriptions and the command publisher
+   * @param state Reference to LifeCycle node state
+   * @return SUCCESS or FAILURE
+   */
+  nav2_util::CallbackReturn on_configure(const rclcpp_lifecycle::State & state) override;
+  /**
+   * @brief Activates the command publisher
+   * @param state Reference to LifeCycle node state
+   * @return SUCCESS or FAILURE
+   */
+  nav2_util::CallbackReturn on_activate(const rclcpp_lifecycle::State & state) override;
+  /**
+   * @brief Deactivates the command publisher
+   * @param state Reference to LifeCycle node state
+   * @return SUCCESS or FAILURE
+   */
+  nav2_util::CallbackReturn on_deactivate(const rclcpp_lifecycle::State & state) override;
+  /**
+   * @brief Resets the member variables
+   * @param state Reference to LifeCycle node state
+   * @return SUCCESS or FAILURE
+   */
+  nav2_util::CallbackReturn on_cleanup(const rclcpp_lifecycle::State & state) override;
+  /**
+   * @brief Called when in Shutdown state
+   * @param state Reference to LifeCycle node state
+   * @return SUCCESS or FAILURE
+   */
+  nav2_util::CallbackReturn on_shutdown(const rclcpp_lifecycle::State & state) override;
+
+  /**
+   * @brief Filter a velocity command and publish it
+   */
+  void commandCallback(geometry_msgs::msg::Twist::SharedPtr command);
+
+  /**
+   * @brief Take the points of a laser scan, in its range, as those of its source
+   */
+  void scanCallback(size_t source, sensor_msgs::msg::LaserScan::SharedPtr scan);
+
+  /**
+   * @brief Take the points of a point cloud, between the heights, as those of its source
+   */
+  void pointCloudCallback(size_t source, sensor_msgs::msg::PointCloud2::SharedPtr cloud);
+
+  /**
+   * @brief Get the transform from a sensor frame to the base frame
+   * @return False if it is not available
+   */
+  bool getSensorTransform(const std::string & frame, tf2::Transform & transform);
+
+  /**
+   * @brief Check the points of the sources against the last command and, if the action
+   * changed or a command was received, publish the filtered command. With mutex_ held.
+   * @param command_received Whether the last command was just received
+   * @param start Start of the processing of the callback, to check its budget with
+   */
+  void filterCommand(
+    bool command_received, const std::chrono::steady_clock::time_point & start);
+
+  // The points of a sensor source, in the base frame, when they were received and whether
+  // any were yet
+  struct Source
+  {
+    std::string topic;
+    std::vector<Point> points;
+    rclcpp::Time stamp;
+    bool received;
+    rclcpp::SubscriptionBase::SharedPtr subscription;
+  };
+
+  std::shared_ptr<tf2_ros::Buffer> tf_;
+  std::shared_ptr<tf2_ros::TransformListener> transform_listener_;
+  rclcpp::Subscription<geometry_msgs::msg::Twist>::SharedPtr command_sub_;
+  rclcpp_lifecycle::LifecyclePublisher<geometry_msgs::msg::Twist>::SharedPtr command_pub_;
+
+  std::string base_frame_;
+  double source_timeout_;
+  double command_timeout_;
+  double min_height_, max_height_;
+  double slow_ratio_;
+  double processing_budget_;
+
+  std::unique_ptr<CollisionZones> zones_;
+  std::vector<Source> sources_;
+
+  // Last command received and when, and the action it was last published with
+  geometry_msgs::msg::Twist command_;
+  rclcpp::Time command_stamp_;
+  bool has_command_{false};
+  Action action_{Action::NONE};
+
+  // Bearings of the last laser scan, reused while the scans keep the same geometry
+  std::vector<double> scan_cos_, scan_sin_;
+  float scan_angle_min_{0.0f}, scan_angle_increment_{0.0f};
+
+  std::mutex mutex_;
+};
+
+}  // namespace nav2_collision_monitor
+
+#endif  // NAV2_COLLISION_MONITOR__COLLISION_MONITOR_HPP_
@@ -0,0 +1,116 @@
+// Copyright (c) 2022 Samsung Research America
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef NAV2_COLLISION_MONITOR__COLLISION_ZONES_HPP_
+#define NAV2_COLLISION_MONITOR__COLLISION_ZONES_HPP_
+
+#include <vector>
+
+#include "geometry_msgs/msg/point.hpp"
+#include "geometry_msgs/msg/twist.hpp"
+
+namespace nav2_collision_monitor
+{
+
+/**
+ * @struct nav2_collision_monitor::Point
+ * @brief A sensor point in the base frame of the robot
+ */
+struct Point
+{
+  double x;
+  double y;
+};
+
+/**
+ * @enum nav2_collision_monitor::Action
+ * @brief What to do with a velocity command, from the least to the most restrictive
+ */
+enum class Action
+{
+  NONE = 0,
+  SLOW,
+  STOP
+};
+
+/**
+ * @class nav2_collision_monitor::CollisionZones
+ * @brief The stop and slow zones of the robot, its footprint padded by their margins and
+ * swept along the velocity command for their times. The padded footprints are computed
+ * once, so that checking points only transforms them into the poses along the command.
+ */
+class CollisionZones
+{
+public:
+  /**
+   * @brief A constructor for nav2_collision_monitor::CollisionZones
+   * @param footprint Footprint of the robot, in its base frame
+   * @param stop_margin Padding of the footprint in the stop zone, in meters
+   * @param slow_margin Padding of the footprint in the slow zone, in meters
+   * @param stop_time Time the stop zone is swept along the command for, in seconds
+   * @param slow_time Time the slow zone is swept along the command for, in seconds
+   * @param time_step Time between the poses the zones are swept through, in seconds
+   */
+  CollisionZones(
+    const std::vector<geometry_msgs::msg::Point> & footprint,
+    double stop_margin, double slow_margin,
+    double stop_time, double slow_time, double time_step);
+
+  /**
+   * @brief Check points against the zones swept along a velocity command
+   * @param points Sensor points, in the base frame
+   * @param command Velocity command, in the base frame
+   * @return STOP if a point is in the stop zone, SLOW if one is in the slow zone
+   */
+  Action check(const std::vector<Point> & points, const geometry_msgs::msg::Twist & command);
+
+  /**
+   * @brief Get the footprint padded by the margin of the stop zone
+   */
+  const std::vector<Point> & getStopPolygon() const
+  {
+    return stop_polygon_;
+  }
+
+  /**
+   * @brief Get the footprint padded by the margin of the slow zone
+   */
+  const std::vector<Point> & getSlowPolygon() const
+  {
+    return slow_polygon_;
+  }
+
+  /**
+   * @brief Whether a point is inside a polygon, edges included
+   */
+  static bool isInside(const std::vector<Point> & polygon, double x, double y);
+
+protected:
+  struct Pose
+  {
+    double x, y, cos_yaw, sin_yaw;
+    bool stop;
+  };
+
+  std::vector<Point> stop_polygon_, slow_polygon_;
+  double stop_radius_, slow_radius_;
+  double stop_time_, slow_time_, time_step_;
+
+  // Poses along the last command checked, reused from one check to the next
+  std::vector<Pose> poses_;
+};
+
+}  // namespace nav2_collision_monitor
+
+#endif  // NAV2_COLLISION_MONITOR__COLLISION_ZONES_HPP_
@@ -0,0 +1,352 @@
+// Copyright (c) 2022 Samsung Research America
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "nav2_collision_monitor/collision_monitor.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <functional>
+#include <memory>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "nav2_costmap_2d/footprint.hpp"
+#include "nav2_util/instrumentation.hpp"
+#include "sensor_msgs/point_cloud2_iterator.hpp"
+#include "tf2_geometry_msgs/tf2_geometry_msgs.hpp"
+
+namespace nav2_collision_monitor
+{
+
+CollisionMonitor::CollisionMonitor(const rclcpp::NodeOptions & options)
+: LifecycleNode("collision_monitor", "", false, options)
+{
+  RCLCPP_INFO(get_logger(), "Creating collision monitor");
+
+  declare_parameter("base_frame_id", rclcpp::ParameterValue(std::string("base_link")));
+  declare_parameter("cmd_vel_in_topic", rclcpp::ParameterValue(std::string("cmd_vel_raw")));
+  declare_parameter("cmd_vel_out_topic", rclcpp::ParameterValue(std::string("cmd_vel")));
+  declare_parameter("scan_topics", rclcpp::ParameterValue(std::vector<std::string>()));
+  declare_parameter("pointcloud_topics", rclcpp::ParameterValue(std::vector<std::string>()));
+  declare_parameter("footprint", rclcpp::ParameterValue(std::string("[]")));
+  declare_parameter("robot_radius", rclcpp::ParameterValue(0.1));
+  declare_parameter("stop_margin", rclcpp::ParameterValue(0.05));
+  declare_parameter("slow_margin", rclcpp::ParameterValue(0.3));
+  declare_parameter("stop_time", rclcpp::ParameterValue(0.5));
+  declare_parameter("slow_time", rclcpp::ParameterValue(1.5));
+  declare_parameter("time_step", rclcpp::ParameterValue(0.1));
+  declare_parameter("slow_ratio", rclcpp::ParameterValue(0.5));
+  declare_parameter("min_height", rclcpp::ParameterValue(0.05));
+  declare_parameter("max_height", rclcpp::ParameterValue(2.0));
+  declare_parameter("source_timeout", rclcpp::ParameterValue(0.5));
+  declare_parameter("command_timeout", rclcpp::ParameterValue(0.5));
+  declare_parameter("processing_budget", rclcpp::ParameterValue(0.001));
+}
+
+CollisionMonitor::~CollisionMonitor()
+{
+}
+
+nav2_util::CallbackReturn
+CollisionMonitor::on_configure(const rclcpp_lifecycle::State &)
+{
+  RCLCPP_INFO(get_logger(), "Configuring");
+
+  std::string cmd_vel_in_topic, cmd_vel_out_topic, footprint_string;
+  std::vector<std::string> scan_topics, pointcloud_topics;
+  double robot_radius, stop_margin, slow_margin, stop_time, slow_time, time_step;
+  get_parameter("base_frame_id", base_frame_);
+  get_parameter("cmd_vel_in_topic", cmd_vel_in_topic);
+  get_parameter("cmd_vel_out_topic", cmd_vel_out_topic);
+  get_parameter("scan_topics", scan_topics);
+  get_parameter("pointcloud_topics", pointcloud_topics);
+  get_parameter("footprint", footprint_string);
+  get_parameter("robot_radius", robot_radius);
+  get_parameter("stop_margin", stop_margin);
+  get_parameter("slow_margin", slow_margin);
+  get_parameter("stop_time", stop_time);
+  get_parameter("slow_time", slow_time);
+  get_parameter("time_step", time_step);
+  get_parameter("slow_ratio", slow_ratio_);
+  get_parameter("min_height", min_height_);
+  get_parameter("max_height", max_height_);
+  get_parameter("source_timeout", source_timeout_);
+  get_parameter("command_timeout", command_timeout_);
+  get_parameter("processing_budget", processing_budget_);
+
+  std::vector<geometry_msgs::msg::Point> footprint;
+  if (footprint_string == "[]" || footprint_string.empty()) {
+    footprint = nav2_costmap_2d::makeFootprintFromRadius(robot_radius);
+  } else if (!nav2_costmap_2d::makeFootprintFromString(footprint_string, footprint)) {
+    RCLCPP_ERROR(get_logger(), "Invalid footprint %s", footprint_string.c_str());
+    return nav2_util::CallbackReturn::FAILURE;
+  }
+  zones_ = std::make_unique<CollisionZones>(
+    footprint, stop_margin, slow_margin, stop_time, slow_time, time_step);
+
+  if (scan_topics.empty() && pointcloud_topics.empty()) {
+    RCLCPP_WARN(get_logger(), "No scan or point cloud topics, commands will not be filtered");
+  }
+
+  tf_ = std::make_shared<tf2_ros::Buffer>(get_clock());
+  transform_listener_ = std::make_shared<tf2_ros::TransformListener>(*tf_);
+
+  // Sources are only appended here, so that their callbacks can refer to them by index
+  sources_.clear();
+  sources_.reserve(scan_topics.size() + pointcloud_topics.size());
+  for (const auto & topic : scan_topics) {
+    const size_t source = sources_.size();
+    sources_.push_back(Source{topic, {}, now(), false, nullptr});
+    sources_.back().subscription = create_subscription<sensor_msgs::msg::LaserScan>(
+      topic, rclcpp::SensorDataQoS(),
+      [this, source](sensor_msgs::msg::LaserScan::SharedPtr scan) {
+        scanCallback(source, scan);
+      });
+  }
+  for (const auto & topic : pointcloud_topics) {
+    const size_t source = sources_.size();
+    sources_.push_back(Source{topic, {}, now(), false, nullptr});
+    sources_.back().subscription = create_subscription<sensor_msgs::msg::PointCloud2>(
+      topic, rclcpp::SensorDataQoS(),
+      [this, source](sensor_msgs::msg::PointCloud2::SharedPtr cloud) {
+        pointCloudCallback(source, cloud);
+      });
+  }
+
+  command_pub_ = create_publisher<geometry_msgs::msg::Twist>(cmd_vel_out_topic, 1);
+  command_sub_ = create_subscription<geometry_msgs::msg::Twist>(
+    cmd_vel_in_topic, 1,
+    std::bind(&CollisionMonitor::commandCallback, this, std::placeholders::_1));
+
+  return nav2_util::CallbackReturn::SUCCESS;
+}
+
+nav2_util::CallbackReturn
+CollisionMonitor::on_activate(const rclcpp_lifecycle::State &)
+{
+  RCLCPP_INFO(get_logger(), "Activating");
+
+  command_pub_->on_activate();
+
+  // create bond connection
+  createBond();
+
+  return nav2_util::CallbackReturn::SUCCESS;
+}
+
+nav2_util::CallbackReturn
+CollisionMonitor::on_deactivate(const rclcpp_lifecycle::State &)
+{
+  RCLCPP_INFO(get_logger(), "Deactivating");
+
+  command_pub_->on_deactivate();
+
+  // destroy bond connection
+  destroyBond();
+
+  return nav2_util::CallbackReturn::SUCCESS;
+}
+
+nav2_util::CallbackReturn
+CollisionMonitor::on_cleanup(const rclcpp_lifecycle::State &)
+{
+  RCLCPP_INFO(get_logger(), "Cleaning up");
+
+  command_sub_.reset();
+  command_pub_.reset();
+  sources_.clear();
+  zones_.reset();
+  transform_listener_.reset();
+  tf_.reset();
+  has_command_ = false;
+  action_ = Action::NONE;
+
+  return nav2_util::CallbackReturn::SUCCESS;
+}
+
+nav2_util::CallbackReturn
+CollisionMonitor::on_shutdown(const rclcpp_lifecycle::State &)
+{
+  RCLCPP_INFO(get_logger(), "Shutting down");
+  return nav2_util::CallbackReturn::SUCCESS;
+}
+
+void CollisionMonitor::commandCallback(geometry_msgs::msg::Twist::SharedPtr command)
+{
+  NAV2_PROBE_SCOPE("collision_monitor.command");
+  const auto start = std::chrono::steady_clock::now();
+  std::lock_guard<std::mutex> lock(mutex_);
+  command_ = *command;
+  command_stamp_ = now();
+  has_command_ = true;
+  filterCommand(true, start);
+}
+
+void CollisionMonitor::scanCallback(size_t source, sensor_msgs::msg::LaserScan::SharedPtr scan)
+{
+  NAV2_PROBE_SCOPE("collision_monitor.scan");
+  const auto start = std::chrono::steady_clock::now();
+  tf2::Transform transform;
+  if (!getSensorTransform(scan->header.frame_id, transform)) {
+    return;
+  }
+
+  std::lock_guard<std::mutex> lock(mutex_);
+
+  // The bearings only change with the geometry of the scans
+  if (scan_cos_.size() != scan->ranges.size() || scan_angle_min_ != scan->angle_min ||
+    scan_angle_increment_ != scan->angle_increment)
+  {
+    scan_cos_.resize(scan->ranges.size());
+    scan_sin_.resize(scan->ranges.size());
+    for (size_t i = 0; i < scan->ranges.size(); ++i) {
+      const double angle = scan->angle_min + i * scan->angle_increment;
+      scan_cos_[i] = std::cos(angle);
+      scan_sin_[i] = std::sin(angle);
+    }
+    scan_angle_min_ = scan->angle_min;
+    scan_angle_increment_ = scan->angle_increment;
+  }
+
+  const tf2::Matrix3x3 & basis = transform.getBasis();
+  const tf2::Vector3 & origin = transform.getOrigin();
+  std::vector<Point> & points = sources_[source].points;
+  points.clear();
+  for (size_t i = 0; i < scan->ranges.size(); ++i) {
+    const double range = scan->ranges[i];
+    if (!std::isfinite(range) || range < scan->range_min || range > scan->range_max) {
+      continue;
+    }
+    const double x = range * scan_cos_[i];
+    const double y = range * scan_sin_[i];
+    points.push_back(
+      {basis[0][0] * x + basis[0][1] * y + origin.x(),
+        basis[1][0] * x + basis[1][1] * y + origin.y()});
+  }
+  sources_[source].stamp = now();
+  sources_[source].received = true;
+  filterCommand(false, start);
+}
+
+void CollisionMonitor::pointCloudCallback(
+  size_t source, sensor_msgs::msg::PointCloud2::SharedPtr cloud)
+{
+  NAV2_PROBE_SCOPE("collision_monitor.pointcloud");
+  const auto start = std::chrono::steady_clock::now();
+  tf2::Transform transform;
+  if (!getSensorTransform(cloud->header.frame_id, transform)) {
+    return;
+  }
+
+  std::lock_guard<std::mutex> lock(mutex_);
+  std::vector<Point> & points = sources_[source].points;
+  points.clear();
+  sensor_msgs::PointCloud2ConstIterator<float> iter_x(*cloud, "x");
+  sensor_msgs::PointCloud2ConstIterator<float> iter_y(*cloud, "y");
+  sensor_msgs::PointCloud2ConstIterator<float> iter_z(*cloud, "z");
+  for (; iter_x != iter_x.end(); ++iter_x, ++iter_y, ++iter_z) {
+    const tf2::Vector3 point = transform * tf2::Vector3(*iter_x, *iter_y, *iter_z);
+    if (point.z() >= min_height_ && point.z() <= max_height_) {
+      points.push_back({point.x(), point.y()});
+    }
+  }
+  sources_[source].stamp = now();
+  sources_[source].received = true;
+  filterCommand(false, start);
+}
+
+bool CollisionMonitor::getSensorTransform(const std::string & frame, tf2::Transform & transform)
+{
+  // Sensors are mounted on the robot, so the latest transform is used without waiting
+  try {
+    tf2::fromMsg(
+      tf_->lookupTransform(base_frame_, frame, tf2::TimePointZero).transform, transform);
+  } catch (tf2::TransformException & ex) {
+    RCLCPP_WARN_THROTTLE(
+      get_logger(), *get_clock(), 1000, "Failed to transform from %s to %s: %s",
+      frame.c_str(), base_frame_.c_str(), ex.what());
+    return false;
+  }
+  return true;
+}
+
+void CollisionMonitor::filterCommand(
+  bool command_received, const std::chrono::steady_clock::time_point & start)
+{
+  const rclcpp::Time current_time = now();
+  if (!has_command_ || (current_time - command_stamp_).seconds() > command_timeout_) {
+    return;
+  }
+
+  // Without recent data from a source, obstacles may be anywhere around the robot, so the
+  // commands are stopped until it publishes again
+  Action action = Action::NONE;
+  for (const auto & source : sources_) {
+    if (!source.received || (current_time - source.stamp).seconds() > source_timeout_) {
+      RCLCPP_WARN_THROTTLE(
+        get_logger(), *get_clock(), 1000, "%s from %s, stopping the robot",
+        source.received ? "Data timed out" : "No data yet", source.topic.c_str());
+      action = Action::STOP;
+      break;
+    }
+    if (source.points.empty()) {
+      continue;
+    }
+    action = std::max(action, zones_->check(source.points, command_));
+    if (action == Action::STOP) {
+      break;
+    }
+  }
+
+  // New sensor data only publishes the last command again if it must be filtered further
+  const bool stricter = action > action_;
+  if (action != action_) {
+    RCLCPP_INFO(
+      get_logger(), "%s the robot", action == Action::STOP ? "Stopping" :
+      (action == Action::SLOW ? "Slowing down" : "Releasing"));
+    action_ = action;
+  }
+
+  if ((command_received || stricter) && command_pub_->is_activated()) {
+    auto command = std::make_unique<geometry_msgs::msg::Twist>();
+    if (action != Action::STOP) {
+      const double scale = action == Action::SLOW ? slow_ratio_ : 1.0;
+      command->linear.x = command_.linear.x * scale;
+      command->linear.y = command_.linear.y * scale;
+      command->angular.z = command_.angular.z * scale;
+    }
+    command_pub_->publish(std::move(command));
+  }
+
+  const double elapsed =
+    std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+  if (elapsed > processing_budget_) {
+    NAV2_PROBE_COUNT("collision_monitor.budget_overruns", 1);
+    RCLCPP_WARN_THROTTLE(
+      get_logger(), *get_clock(), 1000,
+      "Processing took %.3f ms, over the budget of %.3f ms", 1e3 * elapsed,
+      1e3 * processing_budget_);
+  }
+}
+
+}  // namespace nav2_collision_monitor
+
+#include "rclcpp_components/register_node_macro.hpp"
+
+// Register the component with class_loader.
+// This acts as a sort of entry point, allowing the component to be discoverable when its library
+// is being loaded into a running process.
+RCLCPP_COMPONENTS_REGISTER_NODE(nav2_collision_monitor::CollisionMonitor)
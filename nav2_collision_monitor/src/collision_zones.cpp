@@ -0,0 +1,144 @@
+// Copyright (c) 2022 Samsung Research America
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "nav2_collision_monitor/collision_zones.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <vector>
+
+#include "nav2_costmap_2d/footprint.hpp"
+
+namespace nav2_collision_monitor
+{
+
+namespace
+{
+
+std::vector<Point> makePolygon(
+  std::vector<geometry_msgs::msg::Point> footprint, double margin, double & radius)
+{
+  nav2_costmap_2d::padFootprint(footprint, margin);
+  double min_dist;
+  nav2_costmap_2d::calculateMinAndMaxDistances(footprint, min_dist, radius);
+
+  std::vector<Point> polygon;
+  for (const auto & point : footprint) {
+    polygon.push_back({point.x, point.y});
+  }
+  return polygon;
+}
+
+}  // namespace
+
+CollisionZones::CollisionZones(
+  const std::vector<geometry_msgs::msg::Point> & footprint,
+  double stop_margin, double slow_margin,
+  double stop_time, double slow_time, double time_step)
+: stop_time_(std::max(stop_time, 0.0)),
+  slow_time_(std::max(slow_time, 0.0)),
+  time_step_(std::max(time_step, 1e-3))
+{
+  stop_polygon_ = makePolygon(footprint, stop_margin, stop_radius_);
+  slow_polygon_ = makePolygon(footprint, slow_margin, slow_radius_);
+}
+
+bool CollisionZones::isInside(const std::vector<Point> & polygon, double x, double y)
+{
+  // Crossings of the ray to +x by the edges, counting the points on the edges as inside
+  bool inside = false;
+  for (size_t i = 0, j = polygon.size() - 1; i < polygon.size(); j = i++) {
+    const Point & a = polygon[i];
+    const Point & b = polygon[j];
+    const double cross = (b.x - a.x) * (y - a.y) - (b.y - a.y) * (x - a.x);
+    if (cross == 0.0 && std::min(a.x, b.x) <= x && x <= std::max(a.x, b.x) &&
+      std::min(a.y, b.y) <= y && y <= std::max(a.y, b.y))
+    {
+      return true;
+    }
+    if ((a.y > y) != (b.y > y) && x < a.x + (b.x - a.x) * (y - a.y) / (b.y - a.y)) {
+      inside = !inside;
+    }
+  }
+  return inside;
+}
+
+Action CollisionZones::check(
+  const std::vector<Point> & points, const geometry_msgs::msg::Twist & command)
+{
+  if (stop_polygon_.size() < 3 || points.empty()) {
+    return Action::NONE;
+  }
+
+  // The poses of the robot along the command, integrated at constant velocity
+  const double sweep_time = std::max(stop_time_, slow_time_);
+  poses_.clear();
+  double x = 0.0, y = 0.0, yaw = 0.0;
+  for (double t = 0.0; ; t += time_step_) {
+    poses_.push_back({x, y, std::cos(yaw), std::sin(yaw), t <= stop_time_ + 1e-9});
+    if (t + 1e-9 >= sweep_time) {
+      break;
+    }
+    const double mid_yaw = yaw + 0.5 * command.angular.z * time_step_;
+    x += (command.linear.x * std::cos(mid_yaw) - command.linear.y * std::sin(mid_yaw)) *
+      time_step_;
+    y += (command.linear.x * std::sin(mid_yaw) + command.linear.y * std::cos(mid_yaw)) *
+      time_step_;
+    yaw += command.angular.z * time_step_;
+  }
+
+  // Points beyond the reach of a zone can't be in it at any of the poses
+  const double speed = std::hypot(command.linear.x, command.linear.y);
+  const double stop_reach = stop_radius_ + speed * stop_time_;
+  const double slow_reach = slow_radius_ + speed * slow_time_;
+  const double stop_reach_sq = stop_reach * stop_reach;
+  const double slow_reach_sq = slow_reach * slow_reach;
+  const double stop_radius_sq = stop_radius_ * stop_radius_;
+  const double slow_radius_sq = slow_radius_ * slow_radius_;
+
+  Action action = Action::NONE;
+  for (const Point & point : points) {
+    const double dist_sq = point.x * point.x + point.y * point.y;
+    const bool check_stop = dist_sq <= stop_reach_sq;
+    bool check_slow = action == Action::NONE && dist_sq <= slow_reach_sq;
+    if (!check_stop && !check_slow) {
+      continue;
+    }
+
+    for (const Pose & pose : poses_) {
+      const double dx = point.x - pose.x;
+      const double dy = point.y - pose.y;
+      const double local_x = pose.cos_yaw * dx + pose.sin_yaw * dy;
+      const double local_y = pose.cos_yaw * dy - pose.sin_yaw * dx;
+      const double local_sq = local_x * local_x + local_y * local_y;
+      if (check_stop && pose.stop && local_sq <= stop_radius_sq &&
+        isInside(stop_polygon_, local_x, local_y))
+      {
+        return Action::STOP;
+      }
+      if (check_slow && local_sq <= slow_radius_sq &&
+        isInside(slow_polygon_, local_x, local_y))
+      {
+        action = Action::SLOW;
+        check_slow = false;
+        if (!check_stop) {
+          break;
+        }
+      }
+    }
+  }
+  return action;
+}
+
+}  // namespace nav2_collision_monitor
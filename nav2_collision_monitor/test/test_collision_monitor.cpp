@@ -0,0 +1,141 @@
+// Copyright (c) 2022 Samsung Research America
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <chrono>
+#include <cmath>
+#include <limits>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "gtest/gtest.h"
+#include "rclcpp/rclcpp.hpp"
+#include "geometry_msgs/msg/twist.hpp"
+#include "sensor_msgs/msg/laser_scan.hpp"
+#include "nav2_collision_monitor/collision_monitor.hpp"
+
+using namespace std::chrono_literals;
+
+class RclCppFixture
+{
+public:
+  RclCppFixture() {rclcpp::init(0, nullptr);}
+  ~RclCppFixture() {rclcpp::shutdown();}
+};
+RclCppFixture g_rclcppfixture;
+
+class CollisionMonitorTest : public ::testing::Test
+{
+protected:
+  void SetUp() override
+  {
+    rclcpp::NodeOptions options;
+    options.parameter_overrides(
+    {
+      rclcpp::Parameter("base_frame_id", "base_link"),
+      rclcpp::Parameter("scan_topics", std::vector<std::string>{"scan"}),
+      rclcpp::Parameter("source_timeout", 0.5)});
+    monitor_ = std::make_shared<nav2_collision_monitor::CollisionMonitor>(options);
+    monitor_->configure();
+    monitor_->activate();
+
+    node_ = rclcpp::Node::make_shared("collision_monitor_test");
+    command_pub_ = node_->create_publisher<geometry_msgs::msg::Twist>("cmd_vel_raw", 1);
+    scan_pub_ = node_->create_publisher<sensor_msgs::msg::LaserScan>(
+      "scan", rclcpp::SensorDataQoS());
+    command_sub_ = node_->create_subscription<geometry_msgs::msg::Twist>(
+      "cmd_vel", 1, [this](geometry_msgs::msg::Twist::SharedPtr command) {
+        filtered_ = command;
+      });
+
+    executor_.add_node(monitor_->get_node_base_interface());
+    executor_.add_node(node_);
+  }
+
+  void TearDown() override
+  {
+    executor_.remove_node(monitor_->get_node_base_interface());
+    executor_.remove_node(node_);
+    monitor_->deactivate();
+    monitor_->cleanup();
+  }
+
+  // Publish a scan of the base frame without any point in range
+  void publishEmptyScan()
+  {
+    sensor_msgs::msg::LaserScan scan;
+    scan.header.frame_id = "base_link";
+    scan.angle_min = -M_PI;
+    scan.angle_increment = M_PI / 180.0;
+    scan.range_min = 0.05;
+    scan.range_max = 10.0;
+    scan.ranges.assign(360, std::numeric_limits<float>::infinity());
+    scan_pub_->publish(scan);
+    executor_.spin_some(100ms);
+  }
+
+  // Publish a command and wait for its filtered command
+  geometry_msgs::msg::Twist::SharedPtr filter(double vx)
+  {
+    filtered_.reset();
+    geometry_msgs::msg::Twist command;
+    command.linear.x = vx;
+    command_pub_->publish(command);
+    const auto deadline = std::chrono::steady_clock::now() + 2s;
+    while (!filtered_ && std::chrono::steady_clock::now() < deadline) {
+      executor_.spin_some(10ms);
+    }
+    return filtered_;
+  }
+
+  std::shared_ptr<nav2_collision_monitor::CollisionMonitor> monitor_;
+  rclcpp::Node::SharedPtr node_;
+  rclcpp::executors::SingleThreadedExecutor executor_;
+  rclcpp::Publisher<geometry_msgs::msg::Twist>::SharedPtr command_pub_;
+  rclcpp::Publisher<sensor_msgs::msg::LaserScan>::SharedPtr scan_pub_;
+  rclcpp::Subscription<geometry_msgs::msg::Twist>::SharedPtr command_sub_;
+  geometry_msgs::msg::Twist::SharedPtr filtered_;
+};
+
+TEST_F(CollisionMonitorTest, testStopsWithoutRecentSourceData)
+{
+  // Waits for the connections between the nodes
+  for (int i = 0; i < 10; ++i) {
+    executor_.spin_some(50ms);
+  }
+
+  // The scan never published yet
+  auto filtered = filter(0.5);
+  ASSERT_TRUE(filtered);
+  EXPECT_EQ(filtered->linear.x, 0.0);
+
+  // Nothing in the way of the robot
+  publishEmptyScan();
+  filtered = filter(0.5);
+  ASSERT_TRUE(filtered);
+  EXPECT_EQ(filtered->linear.x, 0.5);
+
+  // The scan timed out
+  std::this_thread::sleep_for(600ms);
+  filtered = filter(0.5);
+  ASSERT_TRUE(filtered);
+  EXPECT_EQ(filtered->linear.x, 0.0);
+
+  // Until it publishes again
+  publishEmptyScan();
+  filtered = filter(0.5);
+  ASSERT_TRUE(filtered);
+  EXPECT_EQ(filtered->linear.x, 0.5);
+}
@@ -0,0 +1,111 @@
+// Copyright (c) 2022 Samsung Research America
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <chrono>
+#include <cmath>
+#include <vector>
+
+#include "gtest/gtest.h"
+#include "nav2_collision_monitor/collision_zones.hpp"
+#include "nav2_costmap_2d/footprint.hpp"
+
+using nav2_collision_monitor::Action;
+using nav2_collision_monitor::CollisionZones;
+using nav2_collision_monitor::Point;
+
+namespace
+{
+
+// A 1 m x 0.6 m robot, with 0.1 m stop and 0.3 m slow margins, swept for 1 s and 2 s
+CollisionZones makeZones()
+{
+  std::vector<geometry_msgs::msg::Point> footprint;
+  nav2_costmap_2d::makeFootprintFromString("[[0.5, 0.3], [0.5, -0.3], [-0.5, -0.3], [-0.5, 0.3]]",
+    footprint);
+  return CollisionZones(footprint, 0.1, 0.3, 1.0, 2.0, 0.1);
+}
+
+geometry_msgs::msg::Twist makeCommand(double vx, double vy, double wz)
+{
+  geometry_msgs::msg::Twist command;
+  command.linear.x = vx;
+  command.linear.y = vy;
+  command.angular.z = wz;
+  return command;
+}
+
+}  // namespace
+
+TEST(CollisionZones, polygons)
+{
+  auto zones = makeZones();
+  ASSERT_EQ(zones.getStopPolygon().size(), 4u);
+  EXPECT_DOUBLE_EQ(zones.getStopPolygon()[0].x, 0.6);
+  EXPECT_DOUBLE_EQ(zones.getStopPolygon()[0].y, 0.4);
+  EXPECT_DOUBLE_EQ(zones.getSlowPolygon()[0].x, 0.8);
+
+  const auto & square = zones.getStopPolygon();
+  EXPECT_TRUE(CollisionZones::isInside(square, 0.0, 0.0));
+  EXPECT_TRUE(CollisionZones::isInside(square, 0.6, 0.0));
+  EXPECT_TRUE(CollisionZones::isInside(square, 0.6, 0.4));
+  EXPECT_FALSE(CollisionZones::isInside(square, 0.61, 0.0));
+  EXPECT_FALSE(CollisionZones::isInside(square, 0.0, -0.41));
+}
+
+TEST(CollisionZones, check)
+{
+  auto zones = makeZones();
+  const auto stopped = makeCommand(0.0, 0.0, 0.0);
+  EXPECT_EQ(zones.check({}, stopped), Action::NONE);
+  EXPECT_EQ(zones.check({{0.55, 0.0}}, stopped), Action::STOP);
+  EXPECT_EQ(zones.check({{0.7, 0.0}}, stopped), Action::SLOW);
+  EXPECT_EQ(zones.check({{0.9, 0.0}, {0.0, 5.0}}, stopped), Action::NONE);
+
+  // Zones are swept ahead at speed, 0.5 m for the stop zone and 1 m for the slow zone
+  const auto forward = makeCommand(0.5, 0.0, 0.0);
+  EXPECT_EQ(zones.check({{1.05, 0.0}}, forward), Action::STOP);
+  EXPECT_EQ(zones.check({{1.5, 0.0}}, forward), Action::SLOW);
+  EXPECT_EQ(zones.check({{2.0, 0.0}}, forward), Action::NONE);
+  EXPECT_EQ(zones.check({{-0.7, 0.0}}, forward), Action::SLOW);
+  EXPECT_EQ(zones.check({{2.0, 0.0}, {1.5, 0.0}, {1.05, 0.0}}, forward), Action::STOP);
+
+  // and sideways, or around the robot while it rotates
+  EXPECT_EQ(zones.check({{0.0, 0.85}}, makeCommand(0.0, 0.5, 0.0)), Action::STOP);
+  EXPECT_EQ(zones.check({{0.0, 0.85}}, makeCommand(0.0, -0.5, 0.0)), Action::NONE);
+  EXPECT_EQ(zones.check({{0.7, 0.0}}, makeCommand(0.0, 0.0, 1.0)), Action::STOP);
+  EXPECT_EQ(zones.check({{0.0, 0.7}}, makeCommand(0.0, 0.0, 1.0)), Action::STOP);
+  EXPECT_EQ(zones.check({{0.0, 0.7}}, makeCommand(0.0, 0.0, 0.0)), Action::NONE);
+}
+
+TEST(CollisionZones, budget)
+{
+  // A full scan of points around the robot, some of which are in the slow zone only, so
+  // that all of them are checked
+  auto zones = makeZones();
+  std::vector<Point> points;
+  for (int i = 0; i < 1440; ++i) {
+    const double angle = i * 2.0 * M_PI / 1440;
+    const double range = 1.6 + 0.3 * std::sin(5.0 * angle);
+    points.push_back({range * std::cos(angle), range * std::sin(angle)});
+  }
+
+  const auto command = makeCommand(0.3, 0.0, 0.3);
+  const auto start = std::chrono::steady_clock::now();
+  for (int i = 0; i < 100; ++i) {
+    EXPECT_EQ(zones.check(points, command), Action::SLOW);
+  }
+  const double seconds =
+    std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count() / 100;
+  EXPECT_LT(seconds, 1e-3);
+}
@@ -43,6 +43,11 @@ macro(nav2_package)
     set(CMAKE_SHARED_LINKER_FLAGS "${CMAKE_SHARED_LINKER_FLAGS} --coverage")
   endif()
 
+  option(NAV2_INSTRUMENTATION "Compile in the nav2_util instrumentation probes" TRUE)
+  if(NOT NAV2_INSTRUMENTATION)
+    add_compile_definitions(NAV2_INSTRUMENTATION_DISABLED)
+  endif()
+
   # Defaults for Microsoft C++ compiler
   if(MSVC)
     # https://blog.kitware.com/create-dlls-on-windows-without-declspec-using-new-cmake-export-all-feature/
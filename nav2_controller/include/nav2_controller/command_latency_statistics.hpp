@@ -0,0 +1,67 @@
+// Copyright (c) 2022 Samsung Research America
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef NAV2_CONTROLLER__COMMAND_LATENCY_STATISTICS_HPP_
+#define NAV2_CONTROLLER__COMMAND_LATENCY_STATISTICS_HPP_
+
+#include <vector>
+
+#include "nav2_msgs/msg/command_latency_statistics.hpp"
+
+namespace nav2_controller
+{
+
+/**
+ * @class nav2_controller::CommandLatencyStatistics
+ * @brief Latencies from the inputs of the velocity commands to their publication, over a
+ * window of commands, reported at the 50th, 90th and 99th percentiles
+ */
+class CommandLatencyStatistics
+{
+public:
+  /**
+   * @brief Add the latencies of a command
+   * @param sensor_to_command Latency from the newest sensor data of the costmap, in
+   * seconds, negative if the costmap incorporated no sensor data
+   * @param pose_to_command Latency from the robot pose, in seconds
+   */
+  void record(double sensor_to_command, double pose_to_command);
+
+  /**
+   * @brief Get the number of commands of the window
+   */
+  unsigned int getCommands() const
+  {
+    return commands_;
+  }
+
+  /**
+   * @brief Get the percentiles of the window as a message, without its header
+   */
+  nav2_msgs::msg::CommandLatencyStatistics toMsg() const;
+
+  /**
+   * @brief Clear the latencies to start a new window
+   */
+  void reset();
+
+protected:
+  std::vector<double> sensor_to_command_;
+  std::vector<double> pose_to_command_;
+  unsigned int commands_{0};
+};
+
+}  // namespace nav2_controller
+
+#endif  // NAV2_CONTROLLER__COMMAND_LATENCY_STATISTICS_HPP_
@@ -0,0 +1,110 @@
+// Copyright (c) 2022 Samsung Research America
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef NAV2_CONTROLLER__CONTROL_LOOP_STATISTICS_HPP_
+#define NAV2_CONTROLLER__CONTROL_LOOP_STATISTICS_HPP_
+
+#include <array>
+#include <vector>
+
+#include "nav2_msgs/msg/control_loop_statistics.hpp"
+
+namespace nav2_controller
+{
+
+/**
+ * @class nav2_controller::ControlLoopStatistics
+ * @brief Latency histograms of the stages of the cycles of the control loop, over a
+ * window of cycles. Bins have exponentially growing bounds, from 0.1 ms to about 0.2 s.
+ */
+class ControlLoopStatistics
+{
+public:
+  /**
+   * @brief Stages of a cycle. WAKE_UP is the delay between the deadline of a cycle
+   * and the wake up of the loop, CYCLE is the whole work of a cycle.
+   */
+  enum Stage : unsigned int
+  {
+    WAKE_UP = 0,
+    COSTMAP_WAIT,
+    UPDATE_PATH,
+    ROBOT_POSE,
+    COMPUTE_VELOCITY,
+    PUBLISH,
+    GOAL_CHECK,
+    CYCLE,
+    STAGE_COUNT
+  };
+
+  /**
+   * @brief Constructor for nav2_controller::ControlLoopStatistics
+   */
+  ControlLoopStatistics();
+
+  /**
+   * @brief Add the latency of a stage to its histogram
+   * @param stage Stage of the cycle
+   * @param seconds Latency of the stage
+   */
+  void record(Stage stage, double seconds);
+
+  /**
+   * @brief Count a completed cycle
+   * @param missed_deadline Whether the cycle overran its deadline
+   */
+  void recordCycle(bool missed_deadline);
+
+  /**
+   * @brief Get the number of cycles of the window
+   */
+  unsigned int getCycles() const
+  {
+    return cycles_;
+  }
+
+  /**
+   * @brief Get the upper bounds of the bins, in seconds. Latencies above the last
+   * bound are counted in one more bin.
+   */
+  static const std::vector<double> & getBinBounds();
+
+  /**
+   * @brief Get the histograms of the window as a message, without its header
+   * @param period Desired period of the loop, in seconds
+   */
+  nav2_msgs::msg::ControlLoopStatistics toMsg(double period) const;
+
+  /**
+   * @brief Clear the histograms to start a new window
+   */
+  void reset();
+
+protected:
+  struct Histogram
+  {
+    std::vector<uint32_t> counts;
+    unsigned int samples{0};
+    double sum{0.0};
+    double max{0.0};
+  };
+
+  std::array<Histogram, STAGE_COUNT> histograms_;
+  unsigned int cycles_{0};
+  unsigned int missed_deadlines_{0};
+};
+
+}  // namespace nav2_controller
+
+#endif  // NAV2_CONTROLLER__CONTROL_LOOP_STATISTICS_HPP_
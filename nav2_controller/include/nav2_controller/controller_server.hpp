@@ -15,6 +15,7 @@
 #ifndef NAV2_CONTROLLER__CONTROLLER_SERVER_HPP_
 #define NAV2_CONTROLLER__CONTROLLER_SERVER_HPP_
 
+#include <chrono>
 #include <memory>
 #include <string>
 #include <thread>
@@ -25,11 +26,20 @@
 #include "nav2_core/controller.hpp"
 #include "nav2_core/progress_checker.hpp"
 #include "nav2_core/goal_checker.hpp"
+#include "nav2_core/robot_state.hpp"
 #include "nav2_costmap_2d/costmap_2d_ros.hpp"
+#include "nav2_costmap_2d/tile_thread_pool.hpp"
+#include "nav2_controller/command_latency_statistics.hpp"
+#include "nav2_controller/control_loop_statistics.hpp"
+#include "nav2_controller/lazy_controller.hpp"
 #include "tf2_ros/transform_listener.h"
 #include "nav2_msgs/action/follow_path.hpp"
 #include "nav2_msgs/msg/speed_limit.hpp"
+#include "nav2_msgs/msg/command_latency_statistics.hpp"
+#include "nav2_msgs/msg/command_trace.hpp"
+#include "nav2_msgs/msg/control_loop_statistics.hpp"
 #include "nav_2d_utils/odom_subscriber.hpp"
+#include "nav2_util/instrumentation.hpp"
 #include "nav2_util/lifecycle_node.hpp"
 #include "nav2_util/simple_action_server.hpp"
 #include "nav2_util/robot_utils.hpp"
@@ -151,6 +161,42 @@ protected:
    * @brief Calculates velocity and publishes to "cmd_vel" topic
    */
   void computeAndPublishVelocity();
+  /**
+   * @brief Calculates velocity with the current controller, and with the shadow
+   * controllers in parallel for the same state
+   * @param state Current state of the robot
+   * @param goal_checker Goal checker of the current goal
+   * @return Velocity command of the current controller
+   * @throw nav2_core::PlannerException When the current controller fails
+   */
+  geometry_msgs::msg::TwistStamped computeShadowedVelocityCommands(
+    const nav2_core::RobotState & state,
+    nav2_core::GoalChecker * goal_checker);
+  /**
+   * @brief Sets the real-time scheduling policy and CPU affinity of the calling thread,
+   * as set by the control_thread_priority and control_thread_cpus parameters
+   */
+  void configureControlThread();
+  /**
+   * @brief Publishes the control loop statistics once their window is over, and starts a new one
+   */
+  void publishLoopStatistics();
+  /**
+   * @brief Logs the latencies of the current and shadow controllers over the last goal
+   */
+  void logShadowStatistics();
+  /**
+   * @brief Creates an instance of a controller plugin, or its stand-in until its first plan
+   * if the controller is lazy
+   * @param index Index of the controller in controller_ids_
+   * @return The controller, not configured yet
+   */
+  nav2_core::Controller::Ptr createController(size_t index);
+  /**
+   * @brief Starts loading the lazy controllers set to warm up, and the timer unloading the
+   * idle ones
+   */
+  void startLazyControllers();
   /**
    * @brief Calls setPlannerPath method with an updated path received from
    * action server
@@ -161,12 +207,17 @@ protected:
    * @param velocity Twist velocity to be published
    */
   void publishVelocity(const geometry_msgs::msg::TwistStamped & velocity);
+  /**
+   * @brief Publish the trace of the command just published, from the inputs recorded in
+   * command_trace_, and record its latencies
+   */
+  void publishCommandTrace();
   /**
    * @brief Calls velocity publisher to publish zero velocity
    */
   void publishZeroVelocity();
   /**
-   * @brief Checks if goal is reached
+   * @brief Checks if goal is reached, from the robot state of the cycle
    * @return true or false
    */
   bool isGoalReached();
@@ -221,6 +272,13 @@ protected:
   std::unique_ptr<nav_2d_utils::OdomSubscriber> odom_sub_;
   rclcpp_lifecycle::LifecyclePublisher<geometry_msgs::msg::Twist>::SharedPtr vel_publisher_;
   rclcpp::Subscription<nav2_msgs::msg::SpeedLimit>::SharedPtr speed_limit_sub_;
+  rclcpp_lifecycle::LifecyclePublisher<nav2_msgs::msg::ControlLoopStatistics>::SharedPtr
+    loop_statistics_publisher_;
+  rclcpp_lifecycle::LifecyclePublisher<nav2_msgs::msg::CommandTrace>::SharedPtr
+    command_trace_publisher_;
+  rclcpp_lifecycle::LifecyclePublisher<nav2_msgs::msg::CommandLatencyStatistics>::SharedPtr
+    command_latency_publisher_;
+  std::unique_ptr<nav2_util::InstrumentationPublisher> instrumentation_publisher_;
 
   // Progress Checker Plugin
   pluginlib::ClassLoader<nav2_core::ProgressChecker> progress_checker_loader_;
@@ -248,6 +306,19 @@ protected:
   std::vector<std::string> controller_types_;
   std::string controller_ids_concat_, current_controller_;
 
+  // Controllers loaded on their first plan, whether to load them in the background once active,
+  // the thread doing so and the timer unloading the idle ones
+  struct Lazy
+  {
+    std::string id;
+    std::shared_ptr<LazyController> controller;
+    bool warmup;
+  };
+  std::vector<Lazy> lazy_controllers_;
+  std::mutex loader_mutex_;
+  std::thread warmup_thread_;
+  rclcpp::TimerBase::SharedPtr lazy_unload_timer_;
+
   double controller_frequency_;
   double min_x_velocity_threshold_;
   double min_y_velocity_threshold_;
@@ -255,14 +326,60 @@ protected:
 
   double failure_tolerance_;
 
+  // Real-time setup of the thread running the control loop
+  int control_thread_priority_;
+  std::vector<int64_t> control_thread_cpus_;
+
+  // Latencies of the control loop over the current statistics window
+  ControlLoopStatistics loop_statistics_;
+  double loop_statistics_period_;
+  std::chrono::steady_clock::time_point loop_statistics_start_;
+
+  // Whether the inputs of the commands are traced, the inputs of the command of the current
+  // cycle and the latencies of the commands over the current statistics window
+  bool command_latency_tracing_;
+  nav2_msgs::msg::CommandTrace command_trace_;
+  CommandLatencyStatistics command_latency_statistics_;
+
+  // Latencies and failures of a controller over the cycles of a goal
+  struct ControllerStatistics
+  {
+    unsigned int cycles{0};
+    unsigned int failures{0};
+    double seconds{0.0};
+    double max_seconds{0.0};
+  };
+
+  // Controller run alongside the current one, whose commands are only published for comparison
+  struct ShadowController
+  {
+    std::string id;
+    nav2_core::Controller::Ptr controller;
+    rclcpp_lifecycle::LifecyclePublisher<geometry_msgs::msg::TwistStamped>::SharedPtr publisher;
+    geometry_msgs::msg::TwistStamped cmd_vel;
+    bool succeeded{false};
+    ControllerStatistics statistics;
+  };
+
+  // Shadow controllers, and the threads they are run on along with the current controller
+  std::vector<std::string> shadow_controller_ids_;
+  std::vector<ShadowController> shadow_controllers_;
+  std::vector<ShadowController *> running_shadows_;
+  std::unique_ptr<nav2_costmap_2d::TileThreadPool> shadow_pool_;
+  ControllerStatistics current_controller_statistics_;
+
   // Whether we've published the single controller warning yet
   geometry_msgs::msg::PoseStamped end_pose_;
 
   // Last time the controller generated a valid command
   rclcpp::Time last_valid_cmd_time_;
 
-  // Current path container
+  // State of the robot in the current cycle, shared by the checkers and controllers
+  nav2_core::RobotState robot_state_;
+
+  // Current path container, with the path length up to each of its poses
   nav_msgs::msg::Path current_path_;
+  std::vector<double> current_path_lengths_;
 
 private:
   /**
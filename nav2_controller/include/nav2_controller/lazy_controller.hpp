@@ -0,0 +1,96 @@
+// Copyright (c) 2022 Samsung Research America
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef NAV2_CONTROLLER__LAZY_CONTROLLER_HPP_
+#define NAV2_CONTROLLER__LAZY_CONTROLLER_HPP_
+
+#include <functional>
+#include <memory>
+#include <string>
+
+#include "nav2_core/controller.hpp"
+#include "nav2_util/lazy_plugin.hpp"
+
+namespace nav2_controller
+{
+
+/**
+ * @class nav2_controller::LazyController
+ * @brief A controller plugin standing in for another one, which it only loads and configures
+ * on its first plan, and unloads once unused for a while if set to. The last plan and speed
+ * limit are given again to the controller whenever it is loaded.
+ */
+class LazyController : public nav2_core::Controller
+{
+public:
+  using Clock = nav2_util::LazyPlugin<nav2_core::Controller>::Clock;
+
+  /**
+   * @brief A constructor for nav2_controller::LazyController
+   * @param create Function creating an instance of the controller plugin
+   * @param unload_timeout Time without use after which the controller is unloaded, never if zero
+   */
+  LazyController(
+    std::function<nav2_core::Controller::Ptr()> create,
+    Clock::duration unload_timeout);
+
+  void configure(
+    const rclcpp_lifecycle::LifecycleNode::WeakPtr & parent,
+    std::string name, const std::shared_ptr<tf2_ros::Buffer> & tf,
+    const std::shared_ptr<nav2_costmap_2d::Costmap2DROS> & costmap_ros) override;
+  void cleanup() override;
+  void activate() override;
+  void deactivate() override;
+  void setPlan(const nav_msgs::msg::Path & path) override;
+  geometry_msgs::msg::TwistStamped computeVelocityCommands(
+    const geometry_msgs::msg::PoseStamped & pose,
+    const geometry_msgs::msg::Twist & velocity,
+    nav2_core::GoalChecker * goal_checker) override;
+  geometry_msgs::msg::TwistStamped computeVelocityCommands(
+    const nav2_core::RobotState & state,
+    nav2_core::GoalChecker * goal_checker) override;
+  void setSpeedLimit(const double & speed_limit, const bool & percentage) override;
+
+  /**
+   * @brief Load the controller ahead of its first plan
+   */
+  void warm();
+
+  /**
+   * @brief Unload the controller if unused since the unload timeout
+   * @return True if the controller was unloaded
+   */
+  bool unloadIfIdle();
+
+protected:
+  /**
+   * @brief Give the last plan and speed limit to a newly loaded controller
+   */
+  void restore(nav2_core::Controller & controller);
+
+  std::function<nav2_core::Controller::Ptr()> create_;
+  Clock::duration unload_timeout_;
+  std::unique_ptr<nav2_util::LazyPlugin<nav2_core::Controller>> controller_;
+
+  // State given to the controller, only used along with it
+  bool has_plan_{false};
+  nav_msgs::msg::Path plan_;
+  bool has_speed_limit_{false};
+  double speed_limit_{0.0};
+  bool percentage_{false};
+};
+
+}  // namespace nav2_controller
+
+#endif  // NAV2_CONTROLLER__LAZY_CONTROLLER_HPP_
@@ -66,6 +66,8 @@ public:
   bool isGoalReached(
     const geometry_msgs::msg::Pose & query_pose, const geometry_msgs::msg::Pose & goal_pose,
     const geometry_msgs::msg::Twist & velocity) override;
+  bool isGoalReached(
+    const nav2_core::RobotState & state, const geometry_msgs::msg::Pose & goal_pose) override;
   bool getTolerances(
     geometry_msgs::msg::Pose & pose_tolerance,
     geometry_msgs::msg::Twist & vel_tolerance) override;
@@ -75,6 +77,9 @@ protected:
   bool stateful_, check_xy_;
   // Cached squared xy_goal_tolerance_
   double xy_goal_tolerance_sq_;
+  // Yaw of the last goal orientation checked against, which seldom changes between calls
+  geometry_msgs::msg::Quaternion goal_orientation_;
+  double goal_yaw_{0.0};
   // Dynamic parameters handler
   rclcpp::node_interfaces::OnSetParametersCallbackHandle::SharedPtr dyn_params_handler_;
   std::string plugin_name_;
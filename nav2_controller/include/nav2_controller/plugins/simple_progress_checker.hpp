@@ -38,6 +38,7 @@ public:
     const rclcpp_lifecycle::LifecycleNode::WeakPtr & parent,
     const std::string & plugin_name) override;
   bool check(geometry_msgs::msg::PoseStamped & current_pose) override;
+  bool check(const nav2_core::RobotState & state) override;
   void reset() override;
 
 protected:
@@ -96,11 +96,19 @@ void SimpleGoalChecker::reset()
 
 bool SimpleGoalChecker::isGoalReached(
   const geometry_msgs::msg::Pose & query_pose, const geometry_msgs::msg::Pose & goal_pose,
-  const geometry_msgs::msg::Twist &)
+  const geometry_msgs::msg::Twist & velocity)
+{
+  geometry_msgs::msg::PoseStamped query_pose_stamped;
+  query_pose_stamped.pose = query_pose;
+  return isGoalReached(nav2_core::RobotState(query_pose_stamped, velocity), goal_pose);
+}
+
+bool SimpleGoalChecker::isGoalReached(
+  const nav2_core::RobotState & state, const geometry_msgs::msg::Pose & goal_pose)
 {
   if (check_xy_) {
-    double dx = query_pose.position.x - goal_pose.position.x,
-      dy = query_pose.position.y - goal_pose.position.y;
+    double dx = state.x - goal_pose.position.x,
+      dy = state.y - goal_pose.position.y;
     if (dx * dx + dy * dy > xy_goal_tolerance_sq_) {
       return false;
     }
@@ -110,9 +118,11 @@ bool SimpleGoalChecker::isGoalReached(
       check_xy_ = false;
     }
   }
-  double dyaw = angles::shortest_angular_distance(
-    tf2::getYaw(query_pose.orientation),
-    tf2::getYaw(goal_pose.orientation));
+  if (goal_pose.orientation != goal_orientation_) {
+    goal_orientation_ = goal_pose.orientation;
+    goal_yaw_ = tf2::getYaw(goal_pose.orientation);
+  }
+  double dyaw = angles::shortest_angular_distance(state.yaw, goal_yaw_);
   return fabs(dyaw) < yaw_goal_tolerance_;
 }
 
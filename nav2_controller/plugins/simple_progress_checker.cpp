@@ -18,7 +18,6 @@
 #include <memory>
 #include <vector>
 #include "nav2_core/exceptions.hpp"
-#include "nav_2d_utils/conversions.hpp"
 #include "geometry_msgs/msg/pose_stamped.hpp"
 #include "geometry_msgs/msg/pose2_d.hpp"
 #include "nav2_util/node_utils.hpp"
@@ -56,11 +55,18 @@ void SimpleProgressChecker::initialize(
 }
 
 bool SimpleProgressChecker::check(geometry_msgs::msg::PoseStamped & current_pose)
+{
+  return check(nav2_core::RobotState(current_pose, geometry_msgs::msg::Twist()));
+}
+
+bool SimpleProgressChecker::check(const nav2_core::RobotState & state)
 {
   // relies on short circuit evaluation to not call is_robot_moved_enough if
   // baseline_pose is not set.
   geometry_msgs::msg::Pose2D current_pose2d;
-  current_pose2d = nav_2d_utils::poseToPose2D(current_pose.pose);
+  current_pose2d.x = state.x;
+  current_pose2d.y = state.y;
+  current_pose2d.theta = state.yaw;
 
   if ((!baseline_pose_set_) || (is_robot_moved_enough(current_pose2d))) {
     reset_baseline_pose(current_pose2d);
@@ -80,16 +80,15 @@ void StoppedGoalChecker::initialize(
 }
 
 bool StoppedGoalChecker::isGoalReached(
-  const geometry_msgs::msg::Pose & query_pose, const geometry_msgs::msg::Pose & goal_pose,
-  const geometry_msgs::msg::Twist & velocity)
+  const nav2_core::RobotState & state, const geometry_msgs::msg::Pose & goal_pose)
 {
-  bool ret = SimpleGoalChecker::isGoalReached(query_pose, goal_pose, velocity);
+  bool ret = SimpleGoalChecker::isGoalReached(state, goal_pose);
   if (!ret) {
     return ret;
   }
 
-  return fabs(velocity.angular.z) <= rot_stopped_velocity_ &&
-         hypot(velocity.linear.x, velocity.linear.y) <= trans_stopped_velocity_;
+  return fabs(state.velocity.angular.z) <= rot_stopped_velocity_ &&
+         state.speed <= trans_stopped_velocity_;
 }
 
 bool StoppedGoalChecker::getTolerances(
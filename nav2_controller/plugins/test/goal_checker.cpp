@@ -164,6 +164,44 @@ TEST(VelocityIterator, two_checks)
   trueFalse(gc, sgc, 0, 0, 0, 0, 0, 0, 0, 0, 1);
 }
 
+TEST(VelocityIterator, robot_state_matches_pose)
+{
+  auto x = std::make_shared<TestLifecycleNode>("goal_checker");
+
+  SimpleGoalChecker gc;
+  StoppedGoalChecker sgc;
+  gc.initialize(x, "nav2_controller");
+  sgc.initialize(x, "nav2_controller");
+
+  const double values[] = {-3.14, -0.3, 0.0, 0.1, 0.2, 1.0};
+  for (double position : values) {
+    for (double yaw : values) {
+      for (double speed : values) {
+        geometry_msgs::msg::Pose2D pose2d, goal2d;
+        pose2d.x = position;
+        pose2d.theta = yaw;
+        nav_2d_msgs::msg::Twist2D twist2d;
+        twist2d.x = speed;
+        twist2d.theta = speed;
+        geometry_msgs::msg::PoseStamped pose;
+        pose.pose = nav_2d_utils::pose2DToPose(pose2d);
+        const auto goal = nav_2d_utils::pose2DToPose(goal2d);
+        const auto velocity = nav_2d_utils::twist2Dto3D(twist2d);
+        const nav2_core::RobotState state(pose, velocity);
+
+        gc.reset();
+        const bool reached = gc.isGoalReached(pose.pose, goal, velocity);
+        gc.reset();
+        EXPECT_EQ(gc.isGoalReached(state, goal), reached);
+        sgc.reset();
+        const bool stopped = sgc.isGoalReached(pose.pose, goal, velocity);
+        sgc.reset();
+        EXPECT_EQ(sgc.isGoalReached(state, goal), stopped);
+      }
+    }
+  }
+}
+
 TEST(StoppedGoalChecker, get_tol_and_dynamic_params)
 {
   auto x = std::make_shared<TestLifecycleNode>("goal_checker");
@@ -0,0 +1,79 @@
+// Copyright (c) 2022 Samsung Research America
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "nav2_controller/command_latency_statistics.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <vector>
+
+namespace nav2_controller
+{
+
+namespace
+{
+
+const std::vector<double> PERCENTILES = {50.0, 90.0, 99.0};
+
+// Nearest rank percentiles of the latencies, which are sorted in place
+std::vector<double> getPercentiles(std::vector<double> & latencies)
+{
+  std::vector<double> values(PERCENTILES.size(), 0.0);
+  if (latencies.empty()) {
+    return values;
+  }
+  std::sort(latencies.begin(), latencies.end());
+  for (size_t i = 0; i < PERCENTILES.size(); ++i) {
+    const size_t rank = static_cast<size_t>(
+      std::ceil(PERCENTILES[i] / 100.0 * latencies.size()));
+    values[i] = latencies[std::max(rank, size_t{1}) - 1];
+  }
+  return values;
+}
+
+}  // namespace
+
+void CommandLatencyStatistics::record(double sensor_to_command, double pose_to_command)
+{
+  commands_++;
+  if (sensor_to_command >= 0.0) {
+    sensor_to_command_.push_back(sensor_to_command);
+  }
+  pose_to_command_.push_back(pose_to_command);
+}
+
+nav2_msgs::msg::CommandLatencyStatistics CommandLatencyStatistics::toMsg() const
+{
+  nav2_msgs::msg::CommandLatencyStatistics msg;
+  msg.commands = commands_;
+  msg.commands_without_sensor_data = commands_ - sensor_to_command_.size();
+  msg.percentiles = PERCENTILES;
+
+  std::vector<double> latencies = sensor_to_command_;
+  msg.sensor_to_command = getPercentiles(latencies);
+  msg.sensor_to_command_max = latencies.empty() ? 0.0 : latencies.back();
+  latencies = pose_to_command_;
+  msg.pose_to_command = getPercentiles(latencies);
+  msg.pose_to_command_max = latencies.empty() ? 0.0 : latencies.back();
+  return msg;
+}
+
+void CommandLatencyStatistics::reset()
+{
+  sensor_to_command_.clear();
+  pose_to_command_.clear();
+  commands_ = 0;
+}
+
+}  // namespace nav2_controller
@@ -0,0 +1,105 @@
+// Copyright (c) 2022 Samsung Research America
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "nav2_controller/control_loop_statistics.hpp"
+
+#include <algorithm>
+#include <vector>
+
+namespace nav2_controller
+{
+
+namespace
+{
+
+const char * const STAGE_NAMES[ControlLoopStatistics::STAGE_COUNT] = {
+  "wake_up",
+  "costmap_wait",
+  "update_path",
+  "robot_pose",
+  "compute_velocity",
+  "publish",
+  "goal_check",
+  "cycle"
+};
+
+std::vector<double> makeBinBounds()
+{
+  std::vector<double> bounds;
+  for (double bound = 1e-4; bound < 0.25; bound *= 2.0) {
+    bounds.push_back(bound);
+  }
+  return bounds;
+}
+
+}  // namespace
+
+ControlLoopStatistics::ControlLoopStatistics()
+{
+  reset();
+}
+
+const std::vector<double> & ControlLoopStatistics::getBinBounds()
+{
+  static const std::vector<double> bounds = makeBinBounds();
+  return bounds;
+}
+
+void ControlLoopStatistics::record(Stage stage, double seconds)
+{
+  const auto & bounds = getBinBounds();
+  Histogram & histogram = histograms_[stage];
+  histogram.counts[std::lower_bound(bounds.begin(), bounds.end(), seconds) - bounds.begin()]++;
+  histogram.samples++;
+  histogram.sum += seconds;
+  histogram.max = std::max(histogram.max, seconds);
+}
+
+void ControlLoopStatistics::recordCycle(bool missed_deadline)
+{
+  cycles_++;
+  if (missed_deadline) {
+    missed_deadlines_++;
+  }
+}
+
+nav2_msgs::msg::ControlLoopStatistics ControlLoopStatistics::toMsg(double period) const
+{
+  nav2_msgs::msg::ControlLoopStatistics msg;
+  msg.period = period;
+  msg.cycles = cycles_;
+  msg.missed_deadlines = missed_deadlines_;
+  msg.bin_bounds = getBinBounds();
+  msg.stages.resize(STAGE_COUNT);
+  for (unsigned int i = 0; i < STAGE_COUNT; ++i) {
+    const Histogram & histogram = histograms_[i];
+    msg.stages[i].name = STAGE_NAMES[i];
+    msg.stages[i].counts = histogram.counts;
+    msg.stages[i].mean = histogram.samples > 0 ? histogram.sum / histogram.samples : 0.0;
+    msg.stages[i].max = histogram.max;
+  }
+  return msg;
+}
+
+void ControlLoopStatistics::reset()
+{
+  for (auto & histogram : histograms_) {
+    histogram = Histogram();
+    histogram.counts.assign(getBinBounds().size() + 1, 0);
+  }
+  cycles_ = 0;
+  missed_deadlines_ = 0;
+}
+
+}  // namespace nav2_controller
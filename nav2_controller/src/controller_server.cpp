@@ -12,12 +12,18 @@
 // See the License for the specific language governing permissions and
 // limitations under the License.
 
+#include <pthread.h>
+#include <sched.h>
+
 #include <chrono>
+#include <cstring>
+#include <thread>
 #include <vector>
 #include <memory>
 #include <string>
 #include <utility>
 #include <limits>
+#include <algorithm>
 
 #include "nav2_core/exceptions.hpp"
 #include "nav_2d_utils/conversions.hpp"
@@ -59,6 +65,13 @@ ControllerServer::ControllerServer(const rclcpp::NodeOptions & options)
   declare_parameter("speed_limit_topic", rclcpp::ParameterValue("speed_limit"));
 
   declare_parameter("failure_tolerance", rclcpp::ParameterValue(0.0));
+  declare_parameter("shadow_controllers", rclcpp::ParameterValue(std::vector<std::string>()));
+
+  declare_parameter("control_thread_priority", rclcpp::ParameterValue(0));
+  declare_parameter("control_thread_cpus", rclcpp::ParameterValue(std::vector<int64_t>()));
+  declare_parameter("control_loop_statistics_period", rclcpp::ParameterValue(1.0));
+  declare_parameter("command_latency_tracing", rclcpp::ParameterValue(false));
+  declare_parameter("parallel_plugin_configuration", rclcpp::ParameterValue(false));
 
   // The costmap node is used in the implementation of the controller
   costmap_ros_ = std::make_shared<nav2_costmap_2d::Costmap2DROS>(
@@ -70,6 +83,9 @@ ControllerServer::ControllerServer(const rclcpp::NodeOptions & options)
 
 ControllerServer::~ControllerServer()
 {
+  if (warmup_thread_.joinable()) {
+    warmup_thread_.join();
+  }
   progress_checker_.reset();
   goal_checkers_.clear();
   controllers_.clear();
@@ -121,6 +137,11 @@ ControllerServer::on_configure(const rclcpp_lifecycle::State & state)
   std::string speed_limit_topic;
   get_parameter("speed_limit_topic", speed_limit_topic);
   get_parameter("failure_tolerance", failure_tolerance_);
+  get_parameter("shadow_controllers", shadow_controller_ids_);
+  get_parameter("control_thread_priority", control_thread_priority_);
+  get_parameter("control_thread_cpus", control_thread_cpus_);
+  get_parameter("control_loop_statistics_period", loop_statistics_period_);
+  get_parameter("command_latency_tracing", command_latency_tracing_);
 
   costmap_ros_->on_configure(state);
 
@@ -164,17 +185,26 @@ ControllerServer::on_configure(const rclcpp_lifecycle::State & state)
     get_logger(),
     "Controller Server has %s goal checkers available.", goal_checker_ids_concat_.c_str());
 
+  // With parallel plugin configuration, the controllers are created in turn, as class loaders
+  // aren't thread safe, and configured concurrently once all of them are
+  bool parallel_plugin_configuration;
+  get_parameter("parallel_plugin_configuration", parallel_plugin_configuration);
+  std::vector<std::pair<std::string, nav2_core::Controller::Ptr>> unconfigured;
+
   for (size_t i = 0; i != controller_ids_.size(); i++) {
     try {
       controller_types_[i] = nav2_util::get_plugin_type_param(node, controller_ids_[i]);
-      nav2_core::Controller::Ptr controller =
-        lp_loader_.createUniqueInstance(controller_types_[i]);
+      nav2_core::Controller::Ptr controller = createController(i);
       RCLCPP_INFO(
         get_logger(), "Created controller : %s of type %s",
         controller_ids_[i].c_str(), controller_types_[i].c_str());
-      controller->configure(
-        node, controller_ids_[i],
-        costmap_ros_->getTfBuffer(), costmap_ros_);
+      if (parallel_plugin_configuration) {
+        unconfigured.emplace_back(controller_ids_[i], controller);
+      } else {
+        controller->configure(
+          node, controller_ids_[i],
+          costmap_ros_->getTfBuffer(), costmap_ros_);
+      }
       controllers_.insert({controller_ids_[i], controller});
     } catch (const pluginlib::PluginlibException & ex) {
       RCLCPP_FATAL(
@@ -184,6 +214,25 @@ ControllerServer::on_configure(const rclcpp_lifecycle::State & state)
     }
   }
 
+  // Each controller is configured on its own thread, so that configuring the server takes
+  // as long as its slowest controller rather than all of them
+  if (!unconfigured.empty()) {
+    nav2_costmap_2d::TileThreadPool configuration_pool(unconfigured.size());
+    try {
+      configuration_pool.run(
+        unconfigured.size(), [&](unsigned int i) {
+          unconfigured[i].second->configure(
+            node, unconfigured[i].first, costmap_ros_->getTfBuffer(), costmap_ros_);
+        });
+    } catch (const std::exception & ex) {
+      RCLCPP_FATAL(
+        get_logger(), "Failed to configure controllers. Exception: %s", ex.what());
+      return nav2_util::CallbackReturn::FAILURE;
+    }
+    RCLCPP_INFO(
+      get_logger(), "Configured %zu controllers concurrently.", unconfigured.size());
+  }
+
   for (size_t i = 0; i != controller_ids_.size(); i++) {
     controller_ids_concat_ += controller_ids_[i] + std::string(" ");
   }
@@ -192,8 +241,42 @@ ControllerServer::on_configure(const rclcpp_lifecycle::State & state)
     get_logger(),
     "Controller Server has %s controllers available.", controller_ids_concat_.c_str());
 
+  for (const auto & shadow_id : shadow_controller_ids_) {
+    auto controller = controllers_.find(shadow_id);
+    if (controller == controllers_.end()) {
+      RCLCPP_FATAL(
+        get_logger(), "Shadow controller %s does not exist. Available controllers are: %s.",
+        shadow_id.c_str(), controller_ids_concat_.c_str());
+      return nav2_util::CallbackReturn::FAILURE;
+    }
+    ShadowController shadow;
+    shadow.id = shadow_id;
+    shadow.controller = controller->second;
+    shadow.publisher =
+      create_publisher<geometry_msgs::msg::TwistStamped>("shadow_cmd_vel/" + shadow_id, 1);
+    shadow_controllers_.push_back(shadow);
+  }
+
+  // The current controller is run on the calling thread along with the shadows
+  if (!shadow_controllers_.empty()) {
+    shadow_pool_ = std::make_unique<nav2_costmap_2d::TileThreadPool>(
+      shadow_controllers_.size() + 1);
+    RCLCPP_INFO(
+      get_logger(), "Running %zu shadow controllers alongside the current one.",
+      shadow_controllers_.size());
+  }
+
   odom_sub_ = std::make_unique<nav_2d_utils::OdomSubscriber>(node);
   vel_publisher_ = create_publisher<geometry_msgs::msg::Twist>("cmd_vel", 1);
+  loop_statistics_publisher_ =
+    create_publisher<nav2_msgs::msg::ControlLoopStatistics>("control_loop_statistics", 1);
+  command_trace_publisher_ = create_publisher<nav2_msgs::msg::CommandTrace>("cmd_vel_trace", 1);
+  command_latency_publisher_ = create_publisher<nav2_msgs::msg::CommandLatencyStatistics>(
+    "command_latency_statistics", 1);
+  // The memory of the costmap is reported with that of the controllers
+  instrumentation_publisher_ = std::make_unique<nav2_util::InstrumentationPublisher>(
+    node, std::vector<std::string>{"controller_server."},
+    std::vector<std::string>{"controller_server.", std::string(costmap_ros_->get_name()) + "."});
 
   // Create the action server that we implement with our followPath method
   action_server_ = std::make_unique<ActionServer>(
@@ -202,6 +285,8 @@ ControllerServer::on_configure(const rclcpp_lifecycle::State & state)
     std::bind(&ControllerServer::computeControl, this),
     nullptr,
     std::chrono::milliseconds(500),
+    true,
+    rcl_action_server_get_default_options(),
     true);
 
   // Set subscribtion to the speed limiting topic
@@ -223,7 +308,15 @@ ControllerServer::on_activate(const rclcpp_lifecycle::State & state)
     it->second->activate();
   }
   vel_publisher_->on_activate();
+  loop_statistics_publisher_->on_activate();
+  command_trace_publisher_->on_activate();
+  command_latency_publisher_->on_activate();
+  instrumentation_publisher_->activate();
+  for (auto & shadow : shadow_controllers_) {
+    shadow.publisher->on_activate();
+  }
   action_server_->activate();
+  startLazyControllers();
 
   auto node = shared_from_this();
   // Add callback for dynamic parameters
@@ -242,6 +335,10 @@ ControllerServer::on_deactivate(const rclcpp_lifecycle::State & state)
   RCLCPP_INFO(get_logger(), "Deactivating");
 
   action_server_->deactivate();
+  lazy_unload_timer_.reset();
+  if (warmup_thread_.joinable()) {
+    warmup_thread_.join();
+  }
   ControllerMap::iterator it;
   for (it = controllers_.begin(); it != controllers_.end(); ++it) {
     it->second->deactivate();
@@ -250,6 +347,13 @@ ControllerServer::on_deactivate(const rclcpp_lifecycle::State & state)
 
   publishZeroVelocity();
   vel_publisher_->on_deactivate();
+  loop_statistics_publisher_->on_deactivate();
+  command_trace_publisher_->on_deactivate();
+  command_latency_publisher_->on_deactivate();
+  instrumentation_publisher_->deactivate();
+  for (auto & shadow : shadow_controllers_) {
+    shadow.publisher->on_deactivate();
+  }
   dyn_params_handler_.reset();
 
   // destroy bond connection
@@ -269,6 +373,10 @@ ControllerServer::on_cleanup(const rclcpp_lifecycle::State & state)
     it->second->cleanup();
   }
   controllers_.clear();
+  lazy_controllers_.clear();
+  shadow_controllers_.clear();
+  running_shadows_.clear();
+  shadow_pool_.reset();
 
   goal_checkers_.clear();
   costmap_ros_->on_cleanup(state);
@@ -277,11 +385,84 @@ ControllerServer::on_cleanup(const rclcpp_lifecycle::State & state)
   action_server_.reset();
   odom_sub_.reset();
   vel_publisher_.reset();
+  loop_statistics_publisher_.reset();
+  command_trace_publisher_.reset();
+  command_latency_publisher_.reset();
+  instrumentation_publisher_.reset();
   speed_limit_sub_.reset();
 
   return nav2_util::CallbackReturn::SUCCESS;
 }
 
+nav2_core::Controller::Ptr ControllerServer::createController(size_t index)
+{
+  const std::string & id = controller_ids_[index];
+  const std::string & type = controller_types_[index];
+  auto node = shared_from_this();
+  nav2_util::declare_parameter_if_not_declared(node, id + ".lazy", rclcpp::ParameterValue(false));
+  if (!get_parameter(id + ".lazy").as_bool()) {
+    return lp_loader_.createUniqueInstance(type);
+  }
+
+  // Without an instance yet, the type of the controller is checked for right away
+  if (!lp_loader_.isClassAvailable(type)) {
+    throw pluginlib::LibraryLoadException("Lazy controller type " + type + " is not available");
+  }
+  nav2_util::declare_parameter_if_not_declared(
+    node, id + ".lazy_warmup", rclcpp::ParameterValue(false));
+  nav2_util::declare_parameter_if_not_declared(
+    node, id + ".lazy_unload_timeout", rclcpp::ParameterValue(0.0));
+  const auto unload_timeout = std::chrono::duration_cast<LazyController::Clock::duration>(
+    std::chrono::duration<double>(get_parameter(id + ".lazy_unload_timeout").as_double()));
+
+  // Instances are created once active, by the control loop and the warm up
+  auto controller = std::make_shared<LazyController>(
+    [this, type]() {
+      std::lock_guard<std::mutex> lock(loader_mutex_);
+      return lp_loader_.createUniqueInstance(type);
+    }, unload_timeout);
+  lazy_controllers_.push_back({id, controller, get_parameter(id + ".lazy_warmup").as_bool()});
+  return controller;
+}
+
+void ControllerServer::startLazyControllers()
+{
+  if (lazy_controllers_.empty()) {
+    return;
+  }
+
+  if (std::any_of(
+      lazy_controllers_.begin(), lazy_controllers_.end(),
+      [](const Lazy & lazy) {return lazy.warmup;}))
+  {
+    warmup_thread_ = std::thread(
+      [this]() {
+        for (auto & lazy : lazy_controllers_) {
+          if (!lazy.warmup) {
+            continue;
+          }
+          try {
+            lazy.controller->warm();
+            RCLCPP_INFO(get_logger(), "Warmed up lazy controller %s", lazy.id.c_str());
+          } catch (const std::exception & ex) {
+            RCLCPP_WARN(
+              get_logger(), "Failed to warm up lazy controller %s: %s",
+              lazy.id.c_str(), ex.what());
+          }
+        }
+      });
+  }
+
+  lazy_unload_timer_ = create_wall_timer(
+    std::chrono::seconds(1), [this]() {
+      for (auto & lazy : lazy_controllers_) {
+        if (lazy.controller->unloadIfIdle()) {
+          RCLCPP_INFO(get_logger(), "Unloaded idle lazy controller %s", lazy.id.c_str());
+        }
+      }
+    });
+}
+
 nav2_util::CallbackReturn
 ControllerServer::on_shutdown(const rclcpp_lifecycle::State &)
 {
@@ -347,6 +528,9 @@ void ControllerServer::computeControl()
 
   RCLCPP_INFO(get_logger(), "Received a goal, begin computing control effort.");
 
+  // Each goal is executed on a new thread
+  configureControlThread();
+
   try {
     std::string c_name = action_server_->get_current_goal()->controller_id;
     std::string current_controller;
@@ -369,9 +553,35 @@ void ControllerServer::computeControl()
     setPlannerPath(action_server_->get_current_goal()->path);
     progress_checker_->reset();
 
+    current_controller_statistics_ = ControllerStatistics();
+    for (auto & shadow : shadow_controllers_) {
+      shadow.statistics = ControllerStatistics();
+    }
+
     last_valid_cmd_time_ = now();
-    rclcpp::WallRate loop_rate(controller_frequency_);
+
+    // Deadlines are spaced by the period on the monotonic clock. A cycle overrunning
+    // its deadline is followed right away by the next one, rather than by a burst of
+    // cycles catching up with the missed deadlines.
+    using Clock = std::chrono::steady_clock;
+    const auto period = std::chrono::duration_cast<Clock::duration>(
+      std::chrono::duration<double>(1.0 / controller_frequency_));
+    auto deadline = Clock::now();
+    auto stage_start = deadline;
+    auto end_stage = [this, &stage_start](ControlLoopStatistics::Stage stage) {
+        const auto stage_end = Clock::now();
+        loop_statistics_.record(
+          stage, std::chrono::duration<double>(stage_end - stage_start).count());
+        stage_start = stage_end;
+      };
+    loop_statistics_.reset();
+    command_latency_statistics_.reset();
+    loop_statistics_start_ = deadline;
+
     while (rclcpp::ok()) {
+      const auto cycle_start = Clock::now();
+      stage_start = cycle_start;
+
       if (action_server_ == nullptr || !action_server_->is_server_active()) {
         RCLCPP_DEBUG(get_logger(), "Action server unavailable or inactive. Stopping.");
         return;
@@ -389,30 +599,52 @@ void ControllerServer::computeControl()
       while (!costmap_ros_->isCurrent()) {
         r.sleep();
       }
+      end_stage(ControlLoopStatistics::COSTMAP_WAIT);
 
       updateGlobalPath();
+      end_stage(ControlLoopStatistics::UPDATE_PATH);
 
       computeAndPublishVelocity();
+      stage_start = Clock::now();
+
+      const bool goal_reached = isGoalReached();
+      end_stage(ControlLoopStatistics::GOAL_CHECK);
+      loop_statistics_.record(
+        ControlLoopStatistics::CYCLE,
+        std::chrono::duration<double>(stage_start - cycle_start).count());
 
-      if (isGoalReached()) {
+      if (goal_reached) {
         RCLCPP_INFO(get_logger(), "Reached the goal!");
         break;
       }
 
-      if (!loop_rate.sleep()) {
+      deadline += period;
+      const bool missed_deadline = stage_start > deadline;
+      loop_statistics_.recordCycle(missed_deadline);
+      publishLoopStatistics();
+
+      if (missed_deadline) {
         RCLCPP_WARN(
           get_logger(), "Control loop missed its desired rate of %.4fHz",
           controller_frequency_);
+        deadline = Clock::now();
+      } else {
+        std::this_thread::sleep_until(deadline);
+        loop_statistics_.record(
+          ControlLoopStatistics::WAKE_UP,
+          std::chrono::duration<double>(Clock::now() - deadline).count());
       }
     }
   } catch (nav2_core::PlannerException & e) {
     RCLCPP_ERROR(this->get_logger(), e.what());
+    logShadowStatistics();
     publishZeroVelocity();
     action_server_->terminate_current();
     return;
   }
 
   RCLCPP_DEBUG(get_logger(), "Controller succeeded, setting result");
+  logShadowStatistics();
 
   publishZeroVelocity();
 
@@ -430,6 +662,13 @@ void ControllerServer::setPlannerPath(const nav_msgs::msg::Path & path)
   }
   controllers_[current_controller_]->setPlan(path);
 
+  // Shadows follow the same path, so that they are ready to take over
+  for (auto & shadow : shadow_controllers_) {
+    if (shadow.id != current_controller_) {
+      shadow.controller->setPlan(path);
+    }
+  }
+
   end_pose_ = path.poses.back();
   end_pose_.header.frame_id = path.header.frame_id;
   goal_checkers_[current_goal_checker_]->reset();
@@ -439,33 +678,67 @@ void ControllerServer::setPlannerPath(const nav_msgs::msg::Path & path)
     end_pose_.pose.position.x, end_pose_.pose.position.y);
 
   current_path_ = path;
+  current_path_lengths_ = nav2_util::geometry_utils::calculate_cumulative_path_lengths(path);
 }
 
 void ControllerServer::computeAndPublishVelocity()
 {
+  NAV2_PROBE_SCOPE("controller_server.cycle");
+  using Clock = std::chrono::steady_clock;
+  auto stage_start = Clock::now();
+  auto end_stage = [this, &stage_start](ControlLoopStatistics::Stage stage) {
+      const auto stage_end = Clock::now();
+      loop_statistics_.record(
+        stage, std::chrono::duration<double>(stage_end - stage_start).count());
+      stage_start = stage_end;
+    };
+
   geometry_msgs::msg::PoseStamped pose;
 
   if (!getRobotPose(pose)) {
     throw nav2_core::PlannerException("Failed to obtain robot pose");
   }
 
-  if (!progress_checker_->check(pose)) {
+  // The 2D pose and speed are computed once for all the checkers and controllers
+  nav_2d_msgs::msg::Twist2D twist = getThresholdedTwist(odom_sub_->getTwist());
+  robot_state_ = nav2_core::RobotState(pose, nav_2d_utils::twist2Dto3D(twist));
+  end_stage(ControlLoopStatistics::ROBOT_POSE);
+
+  if (!progress_checker_->check(robot_state_)) {
     throw nav2_core::PlannerException("Failed to make progress");
   }
 
-  nav_2d_msgs::msg::Twist2D twist = getThresholdedTwist(odom_sub_->getTwist());
+  // The costmap update is taken before the command is computed, so that the sensor data of
+  // updates made meanwhile, which the controller may not have seen, are not credited to it
+  if (command_latency_tracing_) {
+    NAV2_PROBE_SCOPE("controller_server.command_trace");
+    nav2_costmap_2d::LayeredCostmap * layered_costmap = costmap_ros_->getLayeredCostmap();
+    std::unique_lock<nav2_costmap_2d::Costmap2D::mutex_t> lock(
+      *(layered_costmap->getCostmap()->getMutex()));
+    command_trace_.costmap_update_count = layered_costmap->getUpdateCount();
+    command_trace_.sensor_stamp = layered_costmap->getSensorStamp();
+    command_trace_.pose_stamp = pose.header.stamp;
+  }
 
   geometry_msgs::msg::TwistStamped cmd_vel_2d;
 
+  stage_start = Clock::now();
   try {
-    cmd_vel_2d =
-      controllers_[current_controller_]->computeVelocityCommands(
-      pose,
-      nav_2d_utils::twist2Dto3D(twist),
-      goal_checkers_[current_goal_checker_].get());
+    NAV2_PROBE_SCOPE("controller_server.compute_velocity");
+    if (shadow_pool_) {
+      cmd_vel_2d = computeShadowedVelocityCommands(
+        robot_state_,
+        goal_checkers_[current_goal_checker_].get());
+    } else {
+      cmd_vel_2d =
+        controllers_[current_controller_]->computeVelocityCommands(
+        robot_state_,
+        goal_checkers_[current_goal_checker_].get());
+    }
     last_valid_cmd_time_ = now();
   } catch (nav2_core::PlannerException & e) {
     if (failure_tolerance_ > 0 || failure_tolerance_ == -1.0) {
+      NAV2_PROBE_COUNT("controller_server.tolerated_failures", 1);
       RCLCPP_WARN(this->get_logger(), e.what());
       cmd_vel_2d.twist.angular.x = 0;
       cmd_vel_2d.twist.angular.y = 0;
@@ -485,6 +758,8 @@ void ControllerServer::computeAndPublishVelocity()
     }
   }
 
+  end_stage(ControlLoopStatistics::COMPUTE_VELOCITY);
+
   std::shared_ptr<Action::Feedback> feedback = std::make_shared<Action::Feedback>();
   feedback->speed = std::hypot(cmd_vel_2d.twist.linear.x, cmd_vel_2d.twist.linear.y);
 
@@ -505,16 +780,184 @@ void ControllerServer::computeAndPublishVelocity()
       return closest_pose_idx;
     };
 
+  // The path lengths are computed once per path rather than summed up every cycle
   feedback->distance_to_goal =
-    nav2_util::geometry_utils::calculate_path_length(current_path_, find_closest_pose_idx());
+    current_path_lengths_.back() - current_path_lengths_[find_closest_pose_idx()];
   action_server_->publish_feedback(feedback);
 
   RCLCPP_DEBUG(get_logger(), "Publishing velocity at time %.2f", now().seconds());
   publishVelocity(cmd_vel_2d);
+  if (command_latency_tracing_) {
+    publishCommandTrace();
+  }
+  end_stage(ControlLoopStatistics::PUBLISH);
+}
+
+geometry_msgs::msg::TwistStamped ControllerServer::computeShadowedVelocityCommands(
+  const nav2_core::RobotState & state,
+  nav2_core::GoalChecker * goal_checker)
+{
+  running_shadows_.clear();
+  for (auto & shadow : shadow_controllers_) {
+    if (shadow.id != current_controller_) {
+      running_shadows_.push_back(&shadow);
+    }
+  }
+
+  auto record = [](ControllerStatistics & statistics, double seconds, bool succeeded) {
+      statistics.cycles++;
+      statistics.failures += succeeded ? 0 : 1;
+      statistics.seconds += seconds;
+      statistics.max_seconds = std::max(statistics.max_seconds, seconds);
+    };
+
+  // Task 0 runs the current controller, whose exception is rethrown by the pool
+  // once the shadows are done. Shadow failures are only counted.
+  nav2_core::Controller * controller = controllers_[current_controller_].get();
+  geometry_msgs::msg::TwistStamped cmd_vel;
+  shadow_pool_->run(
+    running_shadows_.size() + 1,
+    [&](unsigned int i) {
+      const auto start = std::chrono::steady_clock::now();
+      auto elapsed = [&start]() {
+          return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+        };
+
+      if (i == 0) {
+        try {
+          cmd_vel = controller->computeVelocityCommands(state, goal_checker);
+        } catch (...) {
+          record(current_controller_statistics_, elapsed(), false);
+          throw;
+        }
+        record(current_controller_statistics_, elapsed(), true);
+        return;
+      }
+
+      ShadowController & shadow = *running_shadows_[i - 1];
+      try {
+        shadow.cmd_vel = shadow.controller->computeVelocityCommands(state, goal_checker);
+        shadow.succeeded = true;
+      } catch (const std::exception & e) {
+        RCLCPP_DEBUG(get_logger(), "Shadow controller %s failed: %s", shadow.id.c_str(), e.what());
+        shadow.succeeded = false;
+      }
+      record(shadow.statistics, elapsed(), shadow.succeeded);
+    });
+
+  for (auto shadow : running_shadows_) {
+    if (shadow->succeeded && shadow->publisher->is_activated() &&
+      shadow->publisher->get_subscription_count() > 0)
+    {
+      shadow->publisher->publish(shadow->cmd_vel);
+    }
+  }
+
+  return cmd_vel;
+}
+
+void ControllerServer::configureControlThread()
+{
+  if (control_thread_priority_ > 0) {
+    sched_param param;
+    param.sched_priority = control_thread_priority_;
+    const int error = pthread_setschedparam(pthread_self(), SCHED_FIFO, &param);
+    if (error != 0) {
+      RCLCPP_WARN(
+        get_logger(), "Failed to run the control loop with SCHED_FIFO priority %d: %s",
+        control_thread_priority_, std::strerror(error));
+    }
+  }
+
+  if (!control_thread_cpus_.empty()) {
+    cpu_set_t cpus;
+    CPU_ZERO(&cpus);
+    for (const auto cpu : control_thread_cpus_) {
+      CPU_SET(cpu, &cpus);
+    }
+    const int error = pthread_setaffinity_np(pthread_self(), sizeof(cpus), &cpus);
+    if (error != 0) {
+      RCLCPP_WARN(
+        get_logger(), "Failed to set the CPU affinity of the control loop: %s",
+        std::strerror(error));
+    }
+  }
+}
+
+void ControllerServer::publishLoopStatistics()
+{
+  const auto now_time = std::chrono::steady_clock::now();
+  if (std::chrono::duration<double>(now_time - loop_statistics_start_).count() <
+    loop_statistics_period_)
+  {
+    return;
+  }
+
+  if (loop_statistics_publisher_->is_activated() &&
+    loop_statistics_publisher_->get_subscription_count() > 0)
+  {
+    auto msg = std::make_unique<nav2_msgs::msg::ControlLoopStatistics>(
+      loop_statistics_.toMsg(1.0 / controller_frequency_));
+    msg->header.stamp = now();
+    loop_statistics_publisher_->publish(std::move(msg));
+  }
+  if (command_latency_tracing_ && command_latency_publisher_->is_activated() &&
+    command_latency_publisher_->get_subscription_count() > 0)
+  {
+    auto msg = std::make_unique<nav2_msgs::msg::CommandLatencyStatistics>(
+      command_latency_statistics_.toMsg());
+    msg->header.stamp = now();
+    command_latency_publisher_->publish(std::move(msg));
+  }
+  loop_statistics_.reset();
+  command_latency_statistics_.reset();
+  loop_statistics_start_ = now_time;
+}
+
+void ControllerServer::publishCommandTrace()
+{
+  const rclcpp::Time publish_time = now();
+  const rclcpp::Time sensor_stamp(command_trace_.sensor_stamp, publish_time.get_clock_type());
+  const rclcpp::Time pose_stamp(command_trace_.pose_stamp, publish_time.get_clock_type());
+  command_latency_statistics_.record(
+    sensor_stamp.nanoseconds() > 0 ? (publish_time - sensor_stamp).seconds() : -1.0,
+    (publish_time - pose_stamp).seconds());
+
+  if (command_trace_publisher_->is_activated() &&
+    command_trace_publisher_->get_subscription_count() > 0)
+  {
+    auto msg = std::make_unique<nav2_msgs::msg::CommandTrace>(command_trace_);
+    msg->header.stamp = publish_time;
+    msg->header.frame_id = costmap_ros_->getBaseFrameID();
+    command_trace_publisher_->publish(std::move(msg));
+  }
+}
+
+void ControllerServer::logShadowStatistics()
+{
+  if (!shadow_pool_) {
+    return;
+  }
+
+  auto log = [this](const std::string & id, const ControllerStatistics & statistics) {
+      if (statistics.cycles == 0) {
+        return;
+      }
+      RCLCPP_INFO(
+        get_logger(), "Controller %s: %u cycles, %u failures, %.2f ms mean and %.2f ms max latency",
+        id.c_str(), statistics.cycles, statistics.failures,
+        1e3 * statistics.seconds / statistics.cycles, 1e3 * statistics.max_seconds);
+    };
+
+  log(current_controller_, current_controller_statistics_);
+  for (const auto & shadow : shadow_controllers_) {
+    log(shadow.id + " (shadow)", shadow.statistics);
+  }
 }
 
 void ControllerServer::updateGlobalPath()
 {
+  NAV2_PROBE_SCOPE("controller_server.update_path");
   if (action_server_->is_preempt_requested()) {
     RCLCPP_INFO(get_logger(), "Passing new path to controller.");
     auto goal = action_server_->accept_pending_goal();
@@ -556,15 +999,6 @@ void ControllerServer::publishZeroVelocity()
 
 bool ControllerServer::isGoalReached()
 {
-  geometry_msgs::msg::PoseStamped pose;
-
-  if (!getRobotPose(pose)) {
-    return false;
-  }
-
-  nav_2d_msgs::msg::Twist2D twist = getThresholdedTwist(odom_sub_->getTwist());
-  geometry_msgs::msg::Twist velocity = nav_2d_utils::twist2Dto3D(twist);
-
   geometry_msgs::msg::PoseStamped transformed_end_pose;
   rclcpp::Duration tolerance(rclcpp::Duration::from_seconds(costmap_ros_->getTransformTolerance()));
   nav_2d_utils::transformPose(
@@ -572,8 +1006,7 @@ bool ControllerServer::isGoalReached()
     end_pose_, transformed_end_pose, tolerance);
 
   return goal_checkers_[current_goal_checker_]->isGoalReached(
-    pose.pose, transformed_end_pose.pose,
-    velocity);
+    robot_state_, transformed_end_pose.pose);
 }
 
 bool ControllerServer::getRobotPose(geometry_msgs::msg::PoseStamped & pose)
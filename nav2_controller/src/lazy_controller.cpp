@@ -0,0 +1,128 @@
+// Copyright (c) 2022 Samsung Research America
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <memory>
+#include <string>
+#include <utility>
+
+#include "nav2_controller/lazy_controller.hpp"
+
+namespace nav2_controller
+{
+
+LazyController::LazyController(
+  std::function<nav2_core::Controller::Ptr()> create,
+  Clock::duration unload_timeout)
+: create_(std::move(create)), unload_timeout_(unload_timeout)
+{
+}
+
+void LazyController::configure(
+  const rclcpp_lifecycle::LifecycleNode::WeakPtr & parent,
+  std::string name, const std::shared_ptr<tf2_ros::Buffer> & tf,
+  const std::shared_ptr<nav2_costmap_2d::Costmap2DROS> & costmap_ros)
+{
+  // The configuration is kept for the controller to be configured with once loaded
+  controller_ = std::make_unique<nav2_util::LazyPlugin<nav2_core::Controller>>(
+    [this, parent, name, tf, costmap_ros]() {
+      nav2_core::Controller::Ptr controller = create_();
+      controller->configure(parent, name, tf, costmap_ros);
+      return controller;
+    }, unload_timeout_,
+    [this](nav2_core::Controller & controller) {restore(controller);});
+}
+
+void LazyController::cleanup()
+{
+  controller_->cleanup();
+  has_plan_ = false;
+  plan_ = nav_msgs::msg::Path();
+}
+
+void LazyController::activate()
+{
+  controller_->activate();
+}
+
+void LazyController::deactivate()
+{
+  controller_->deactivate();
+}
+
+void LazyController::setPlan(const nav_msgs::msg::Path & path)
+{
+  controller_->use(
+    [&](nav2_core::Controller & controller) {
+      plan_ = path;
+      has_plan_ = true;
+      controller.setPlan(path);
+    });
+}
+
+geometry_msgs::msg::TwistStamped LazyController::computeVelocityCommands(
+  const geometry_msgs::msg::PoseStamped & pose,
+  const geometry_msgs::msg::Twist & velocity,
+  nav2_core::GoalChecker * goal_checker)
+{
+  return controller_->use(
+    [&](nav2_core::Controller & controller) {
+      return controller.computeVelocityCommands(pose, velocity, goal_checker);
+    });
+}
+
+geometry_msgs::msg::TwistStamped LazyController::computeVelocityCommands(
+  const nav2_core::RobotState & state,
+  nav2_core::GoalChecker * goal_checker)
+{
+  return controller_->use(
+    [&](nav2_core::Controller & controller) {
+      return controller.computeVelocityCommands(state, goal_checker);
+    });
+}
+
+void LazyController::setSpeedLimit(const double & speed_limit, const bool & percentage)
+{
+  // An unloaded controller gets the speed limit once loaded, rather than being loaded for it
+  controller_->useIfLoaded(
+    [&](nav2_core::Controller * controller) {
+      speed_limit_ = speed_limit;
+      percentage_ = percentage;
+      has_speed_limit_ = true;
+      if (controller) {
+        controller->setSpeedLimit(speed_limit, percentage);
+      }
+    });
+}
+
+void LazyController::warm()
+{
+  controller_->warm();
+}
+
+bool LazyController::unloadIfIdle()
+{
+  return controller_->unloadIfIdle();
+}
+
+void LazyController::restore(nav2_core::Controller & controller)
+{
+  if (has_speed_limit_) {
+    controller.setSpeedLimit(speed_limit_, percentage_);
+  }
+  if (has_plan_) {
+    controller.setPlan(plan_);
+  }
+}
+
+}  // namespace nav2_controller
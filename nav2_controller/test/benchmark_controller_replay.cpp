@@ -0,0 +1,426 @@
+// Copyright (c) 2022 Samsung Research America
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License. Reserved.
+
+// Replays recorded controller inputs into controller plugins, without an executor or a TF
+// listener, timing computeVelocityCommands() and counting its heap allocations. The commands
+// are written into a CSV file, and compared to the ones of a reference CSV file if given,
+// such as one written by another version. The recording has one entry per line as
+//   costmap <resolution> <origin x> <origin y> <costs.pgm>
+//   path <x> <y> <yaw> [<x> <y> <yaw> ...]
+//   state <x> <y> <yaw> <vx> <vy> <wz>
+// in the costmap frame, every state being a call with the last costmap and path before it.
+// Without a recording, a robot following a curve past a few obstacles is simulated.
+// Usage: benchmark_controller_replay <output.csv> [<recording>] [<reference.csv>]
+//   [--ros-args ...]
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <cstdlib>
+#include <fstream>
+#include <iostream>
+#include <limits>
+#include <map>
+#include <memory>
+#include <new>
+#include <sstream>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "rclcpp/rclcpp.hpp"
+#include "rclcpp_lifecycle/lifecycle_node.hpp"
+#include "pluginlib/class_loader.hpp"
+#include "nav2_core/controller.hpp"
+#include "nav2_costmap_2d/costmap_2d_ros.hpp"
+#include "nav2_controller/plugins/simple_goal_checker.hpp"
+#include "nav2_util/geometry_utils.hpp"
+#include "nav2_util/node_utils.hpp"
+#include "tf2/utils.h"
+#include "tf2_ros/buffer.h"
+
+using namespace std::chrono;  // NOLINT
+using nav2_util::declare_parameter_if_not_declared;
+
+// Heap allocations of the process, through the replaceable global operator new
+static std::atomic<uint64_t> g_allocations{0};
+
+void * operator new(std::size_t size)
+{
+  g_allocations.fetch_add(1, std::memory_order_relaxed);
+  if (void * ptr = std::malloc(size == 0 ? 1 : size)) {
+    return ptr;
+  }
+  throw std::bad_alloc();
+}
+
+void operator delete(void * ptr) noexcept
+{
+  std::free(ptr);
+}
+
+void operator delete(void * ptr, std::size_t) noexcept
+{
+  std::free(ptr);
+}
+
+struct CostmapRecord
+{
+  double resolution, origin_x, origin_y;
+  unsigned int size_x, size_y;
+  std::vector<unsigned char> costs;
+};
+
+struct StateRecord
+{
+  std::shared_ptr<CostmapRecord> costmap;
+  std::shared_ptr<nav_msgs::msg::Path> path;
+  geometry_msgs::msg::PoseStamped pose;
+  geometry_msgs::msg::Twist velocity;
+};
+
+struct Command
+{
+  bool success;
+  double vx, vy, wz;
+};
+
+// Costs of a binary PGM image, top row first as written by map_saver
+bool readCosts(const std::string & file_name, CostmapRecord & costmap)
+{
+  std::ifstream file(file_name, std::ios::binary);
+  std::string magic;
+  unsigned int max_value;
+  file >> magic;
+  auto skipComments = [&file]() {
+      while (file >> std::ws && file.peek() == '#') {
+        file.ignore(std::numeric_limits<std::streamsize>::max(), '\n');
+      }
+    };
+  skipComments();
+  file >> costmap.size_x;
+  skipComments();
+  file >> costmap.size_y;
+  skipComments();
+  file >> max_value;
+  file.get();
+  if (!file || magic != "P5" || max_value > 255) {
+    return false;
+  }
+
+  std::vector<unsigned char> image(costmap.size_x * costmap.size_y);
+  file.read(reinterpret_cast<char *>(image.data()), image.size());
+  costmap.costs.resize(image.size());
+  for (unsigned int j = 0; j != costmap.size_y; j++) {
+    std::copy_n(
+      image.begin() + (costmap.size_y - 1 - j) * costmap.size_x, costmap.size_x,
+      costmap.costs.begin() + j * costmap.size_x);
+  }
+  return static_cast<bool>(file);
+}
+
+geometry_msgs::msg::PoseStamped makePose(const double & x, const double & y, const double & yaw)
+{
+  geometry_msgs::msg::PoseStamped pose;
+  pose.header.frame_id = "map";
+  pose.pose.position.x = x;
+  pose.pose.position.y = y;
+  pose.pose.orientation = nav2_util::geometry_utils::orientationAroundZAxis(yaw);
+  return pose;
+}
+
+std::vector<StateRecord> readRecording(const std::string & file_name)
+{
+  std::vector<StateRecord> states;
+  std::ifstream file(file_name);
+  std::shared_ptr<CostmapRecord> costmap;
+  std::shared_ptr<nav_msgs::msg::Path> path;
+  std::string line, type;
+  while (std::getline(file, line)) {
+    std::istringstream stream(line);
+    stream >> type;
+    if (type == "costmap") {
+      costmap = std::make_shared<CostmapRecord>();
+      std::string costs_file;
+      stream >> costmap->resolution >> costmap->origin_x >> costmap->origin_y >> costs_file;
+      if (!readCosts(costs_file, *costmap)) {
+        throw std::runtime_error("Failed to read costs from " + costs_file);
+      }
+    } else if (type == "path") {
+      path = std::make_shared<nav_msgs::msg::Path>();
+      path->header.frame_id = "map";
+      double x, y, yaw;
+      while (stream >> x >> y >> yaw) {
+        path->poses.push_back(makePose(x, y, yaw));
+      }
+    } else if (type == "state" && costmap && path) {
+      StateRecord state;
+      double x, y, yaw;
+      stream >> x >> y >> yaw >> state.velocity.linear.x >> state.velocity.linear.y >>
+        state.velocity.angular.z;
+      state.pose = makePose(x, y, yaw);
+      state.costmap = costmap;
+      state.path = path;
+      states.push_back(state);
+    }
+  }
+  return states;
+}
+
+// A robot following a curve past obstacles, slightly off the path, replanned now and then
+std::vector<StateRecord> simulateRecording()
+{
+  auto costmap = std::make_shared<CostmapRecord>();
+  costmap->resolution = 0.05;
+  costmap->origin_x = 0.0;
+  costmap->origin_y = 0.0;
+  costmap->size_x = 200;
+  costmap->size_y = 200;
+  costmap->costs.assign(costmap->size_x * costmap->size_y, 0);
+  const std::vector<std::pair<double, double>> obstacles = {{3.0, 3.0}, {6.0, 7.0}, {8.0, 4.0}};
+  for (unsigned int j = 0; j != costmap->size_y; j++) {
+    for (unsigned int i = 0; i != costmap->size_x; i++) {
+      for (const auto & obstacle : obstacles) {
+        const double d = std::hypot(
+          (i + 0.5) * costmap->resolution - obstacle.first,
+          (j + 0.5) * costmap->resolution - obstacle.second) - 0.3;
+        unsigned char cost = d <= 0.0 ? 254 : (d <= 0.22 ? 253 : (d <= 0.55 ?
+          static_cast<unsigned char>(252 * std::exp(-3.0 * (d - 0.22))) : 0));
+        costmap->costs[i + j * costmap->size_x] =
+          std::max(costmap->costs[i + j * costmap->size_x], cost);
+      }
+    }
+  }
+
+  auto curve = [](const double & x) {return 5.0 + 1.5 * std::sin(x * 0.8);};
+  std::vector<StateRecord> states;
+  std::shared_ptr<nav_msgs::msg::Path> path;
+  for (unsigned int i = 0; i != 400; i++) {
+    const double x = 1.0 + i * 0.02;
+    if (i % 50 == 0) {
+      path = std::make_shared<nav_msgs::msg::Path>();
+      path->header.frame_id = "map";
+      for (double px = x; px < 9.0; px += 0.05) {
+        const double yaw = std::atan2(curve(px + 0.05) - curve(px), 0.05);
+        path->poses.push_back(makePose(px, curve(px), yaw));
+      }
+    }
+    StateRecord state;
+    const double yaw = std::atan2(curve(x + 0.02) - curve(x), 0.02);
+    state.pose = makePose(x, curve(x) + 0.05 * std::sin(i * 0.1), yaw + 0.05 * std::cos(i * 0.1));
+    state.velocity.linear.x = 0.4;
+    state.velocity.angular.z = 0.1 * std::sin(i * 0.05);
+    state.costmap = costmap;
+    state.path = path;
+    states.push_back(state);
+  }
+  return states;
+}
+
+void setCostmap(const CostmapRecord & record, nav2_costmap_2d::Costmap2D * costmap)
+{
+  std::unique_lock<nav2_costmap_2d::Costmap2D::mutex_t> lock(*(costmap->getMutex()));
+  costmap->resizeMap(
+    record.size_x, record.size_y, record.resolution, record.origin_x, record.origin_y);
+  std::copy(record.costs.begin(), record.costs.end(), costmap->getCharMap());
+}
+
+// Robot pose as the transform of the robot base frame, given to the buffer without a listener
+void setTransform(
+  const geometry_msgs::msg::PoseStamped & pose, const rclcpp::Time & stamp,
+  tf2_ros::Buffer & tf)
+{
+  geometry_msgs::msg::TransformStamped transform;
+  transform.header.frame_id = pose.header.frame_id;
+  transform.header.stamp = stamp;
+  transform.child_frame_id = "base_link";
+  transform.transform.translation.x = pose.pose.position.x;
+  transform.transform.translation.y = pose.pose.position.y;
+  transform.transform.rotation = pose.pose.orientation;
+  tf.setTransform(transform, "benchmark_controller_replay", true);
+}
+
+double getPercentile(std::vector<double> values, const double & percentile)
+{
+  if (values.empty()) {
+    return 0.0;
+  }
+  std::sort(values.begin(), values.end());
+  const unsigned int rank = static_cast<unsigned int>(std::ceil(percentile * values.size()));
+  return values[std::max(rank, 1u) - 1];
+}
+
+// Commands of a CSV file written by this benchmark, by controller and state index
+std::map<std::pair<std::string, unsigned int>, Command> readCommands(const std::string & file_name)
+{
+  std::map<std::pair<std::string, unsigned int>, Command> commands;
+  std::ifstream file(file_name);
+  std::string line;
+  std::getline(file, line);
+  while (std::getline(file, line)) {
+    std::replace(line.begin(), line.end(), ',', ' ');
+    std::istringstream stream(line);
+    std::string controller;
+    unsigned int index;
+    double latency;
+    uint64_t allocations;
+    Command command;
+    if (stream >> controller >> index >> latency >> allocations >> command.success >>
+      command.vx >> command.vy >> command.wz)
+    {
+      commands[{controller, index}] = command;
+    }
+  }
+  return commands;
+}
+
+int main(int argc, char ** argv)
+{
+  std::vector<std::string> args = rclcpp::init_and_remove_ros_arguments(argc, argv);
+  if (args.size() < 2) {
+    std::cerr << "Usage: benchmark_controller_replay <output.csv> [<recording>] " <<
+      "[<reference.csv>]" << std::endl;
+    rclcpp::shutdown();
+    return 1;
+  }
+  const std::vector<StateRecord> states =
+    args.size() > 2 ? readRecording(args[2]) : simulateRecording();
+  std::map<std::pair<std::string, unsigned int>, Command> reference;
+  if (args.size() > 3) {
+    reference = readCommands(args[3]);
+  }
+
+  auto node = std::make_shared<rclcpp_lifecycle::LifecycleNode>("controller_benchmark");
+  declare_parameter_if_not_declared(
+    node, "controller_plugins", rclcpp::ParameterValue(
+      std::vector<std::string>{"DWB", "RPP", "RotationShim"}));
+  const std::vector<std::pair<std::string, std::string>> default_types = {
+    {"DWB", "dwb_core::DWBLocalPlanner"},
+    {"RPP", "nav2_regulated_pure_pursuit_controller::RegulatedPurePursuitController"},
+    {"RotationShim", "nav2_rotation_shim_controller::RotationShimController"}};
+  for (const auto & default_type : default_types) {
+    declare_parameter_if_not_declared(
+      node, default_type.first + ".plugin", rclcpp::ParameterValue(default_type.second));
+  }
+  declare_parameter_if_not_declared(
+    node, "DWB.critics", rclcpp::ParameterValue(
+      std::vector<std::string>{"RotateToGoal", "Oscillation", "BaseObstacle", "GoalAlign",
+        "PathAlign", "PathDist", "GoalDist"}));
+  declare_parameter_if_not_declared(
+    node, "RotationShim.primary_controller", rclcpp::ParameterValue(
+      std::string("nav2_regulated_pure_pursuit_controller::RegulatedPurePursuitController")));
+  const std::vector<std::string> controller_ids =
+    node->get_parameter("controller_plugins").as_string_array();
+
+  auto costmap_ros = std::make_shared<nav2_costmap_2d::Costmap2DROS>("local_costmap");
+  costmap_ros->on_configure(rclcpp_lifecycle::State());
+  auto tf = std::make_shared<tf2_ros::Buffer>(node->get_clock());
+  nav2_controller::SimpleGoalChecker goal_checker;
+  goal_checker.initialize(node, "goal_checker");
+  pluginlib::ClassLoader<nav2_core::Controller> loader("nav2_core", "nav2_core::Controller");
+
+  std::ofstream output(args[1]);
+  output << "controller,state,latency_us,allocations,success,vx,vy,wz" << std::endl;
+
+  for (const std::string & controller_id : controller_ids) {
+    nav2_core::Controller::Ptr controller;
+    try {
+      declare_parameter_if_not_declared(
+        node, controller_id + ".plugin", rclcpp::ParameterValue(std::string("")));
+      controller = loader.createUniqueInstance(
+        node->get_parameter(controller_id + ".plugin").as_string());
+    } catch (const pluginlib::PluginlibException & ex) {
+      std::cerr << "Failed to create controller " << controller_id << ": " << ex.what() <<
+        std::endl;
+      continue;
+    }
+    controller->configure(node, controller_id, tf, costmap_ros);
+    controller->activate();
+
+    std::vector<double> latencies;
+    uint64_t total_allocations = 0, max_allocations = 0;
+    double max_vx_delta = 0.0, max_wz_delta = 0.0;
+    unsigned int failures = 0, compared = 0;
+    std::shared_ptr<CostmapRecord> costmap;
+    std::shared_ptr<nav_msgs::msg::Path> path;
+    for (unsigned int i = 0; i != states.size(); i++) {
+      const StateRecord & state = states[i];
+      const rclcpp::Time stamp = node->now();
+      if (state.costmap != costmap) {
+        costmap = state.costmap;
+        setCostmap(*costmap, costmap_ros->getCostmap());
+      }
+      if (state.path != path) {
+        path = state.path;
+        path->header.stamp = stamp;
+        controller->setPlan(*path);
+      }
+      geometry_msgs::msg::PoseStamped pose = state.pose;
+      pose.header.stamp = stamp;
+      setTransform(pose, stamp, *tf);
+
+      Command command{true, 0.0, 0.0, 0.0};
+      const uint64_t allocations_before = g_allocations.load(std::memory_order_relaxed);
+      steady_clock::time_point a = steady_clock::now();
+      try {
+        geometry_msgs::msg::TwistStamped cmd =
+          controller->computeVelocityCommands(pose, state.velocity, &goal_checker);
+        command.vx = cmd.twist.linear.x;
+        command.vy = cmd.twist.linear.y;
+        command.wz = cmd.twist.angular.z;
+      } catch (...) {
+        command.success = false;
+        failures++;
+      }
+      steady_clock::time_point b = steady_clock::now();
+      const uint64_t allocations =
+        g_allocations.load(std::memory_order_relaxed) - allocations_before;
+
+      const double latency = duration_cast<duration<double>>(b - a).count() * 1e6;
+      latencies.push_back(latency);
+      total_allocations += allocations;
+      max_allocations = std::max(max_allocations, allocations);
+      output << controller_id << "," << i << "," << latency << "," << allocations << "," <<
+        command.success << "," << command.vx << "," << command.vy << "," << command.wz <<
+        std::endl;
+
+      auto reference_command = reference.find({controller_id, i});
+      if (reference_command != reference.end()) {
+        compared++;
+        max_vx_delta = std::max(max_vx_delta, std::fabs(command.vx - reference_command->second.vx));
+        max_wz_delta = std::max(max_wz_delta, std::fabs(command.wz - reference_command->second.wz));
+      }
+    }
+
+    controller->deactivate();
+    controller->cleanup();
+    controller.reset();
+
+    std::cout << controller_id << ": " << states.size() << " calls, " << failures <<
+      " failed, latency p50 " << getPercentile(latencies, 0.5) << " us, p90 " <<
+      getPercentile(latencies, 0.9) << " us, p99 " << getPercentile(latencies, 0.99) <<
+      " us, max " << getPercentile(latencies, 1.0) << " us, allocations " <<
+      static_cast<double>(total_allocations) / std::max<size_t>(states.size(), 1) <<
+      " per call, " << max_allocations << " max" << std::endl;
+    if (compared > 0) {
+      std::cout << "  " << compared << " commands compared to the reference, max delta vx " <<
+        max_vx_delta << " m/s, wz " << max_wz_delta << " rad/s" << std::endl;
+    }
+  }
+
+  costmap_ros->on_cleanup(rclcpp_lifecycle::State());
+  rclcpp::shutdown();
+  return 0;
+}
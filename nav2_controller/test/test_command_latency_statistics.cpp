@@ -0,0 +1,56 @@
+// Copyright (c) 2022 Samsung Research America
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <vector>
+
+#include "gtest/gtest.h"
+#include "nav2_controller/command_latency_statistics.hpp"
+
+using nav2_controller::CommandLatencyStatistics;
+
+TEST(CommandLatencyStatistics, percentiles)
+{
+  CommandLatencyStatistics statistics;
+  auto msg = statistics.toMsg();
+  EXPECT_EQ(msg.commands, 0u);
+  EXPECT_EQ(msg.percentiles, std::vector<double>({50.0, 90.0, 99.0}));
+  EXPECT_EQ(msg.sensor_to_command, std::vector<double>(3, 0.0));
+  EXPECT_DOUBLE_EQ(msg.pose_to_command_max, 0.0);
+
+  // Latencies of 0.01 s to 1 s, recorded out of order, the tenth without sensor data
+  for (int i = 100; i >= 1; --i) {
+    statistics.record(i == 10 ? -1.0 : 0.01 * i, 0.001 * i);
+  }
+  EXPECT_EQ(statistics.getCommands(), 100u);
+
+  msg = statistics.toMsg();
+  EXPECT_EQ(msg.commands, 100u);
+  EXPECT_EQ(msg.commands_without_sensor_data, 1u);
+  ASSERT_EQ(msg.sensor_to_command.size(), 3u);
+  ASSERT_EQ(msg.pose_to_command.size(), 3u);
+  EXPECT_DOUBLE_EQ(msg.sensor_to_command[0], 0.51);
+  EXPECT_DOUBLE_EQ(msg.sensor_to_command[1], 0.91);
+  EXPECT_DOUBLE_EQ(msg.sensor_to_command[2], 1.0);
+  EXPECT_DOUBLE_EQ(msg.sensor_to_command_max, 1.0);
+  EXPECT_DOUBLE_EQ(msg.pose_to_command[0], 0.050);
+  EXPECT_DOUBLE_EQ(msg.pose_to_command[1], 0.090);
+  EXPECT_DOUBLE_EQ(msg.pose_to_command[2], 0.099);
+  EXPECT_DOUBLE_EQ(msg.pose_to_command_max, 0.1);
+
+  statistics.reset();
+  EXPECT_EQ(statistics.getCommands(), 0u);
+  msg = statistics.toMsg();
+  EXPECT_EQ(msg.commands_without_sensor_data, 0u);
+  EXPECT_EQ(msg.pose_to_command, std::vector<double>(3, 0.0));
+}
@@ -0,0 +1,66 @@
+// Copyright (c) 2022 Samsung Research America
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License. Reserved.
+
+#include <vector>
+
+#include "gtest/gtest.h"
+#include "nav2_controller/control_loop_statistics.hpp"
+
+using nav2_controller::ControlLoopStatistics;
+
+TEST(ControlLoopStatistics, histograms)
+{
+  ControlLoopStatistics statistics;
+  const auto & bounds = ControlLoopStatistics::getBinBounds();
+  ASSERT_FALSE(bounds.empty());
+
+  statistics.record(ControlLoopStatistics::COMPUTE_VELOCITY, 0.5 * bounds[0]);
+  statistics.record(ControlLoopStatistics::COMPUTE_VELOCITY, bounds[2]);
+  statistics.record(ControlLoopStatistics::COMPUTE_VELOCITY, 2.0 * bounds.back());
+  statistics.record(ControlLoopStatistics::CYCLE, 0.01);
+  statistics.recordCycle(false);
+  statistics.recordCycle(true);
+  EXPECT_EQ(statistics.getCycles(), 2u);
+
+  auto msg = statistics.toMsg(0.05);
+  EXPECT_DOUBLE_EQ(msg.period, 0.05);
+  EXPECT_EQ(msg.cycles, 2u);
+  EXPECT_EQ(msg.missed_deadlines, 1u);
+  EXPECT_EQ(msg.bin_bounds, bounds);
+  ASSERT_EQ(msg.stages.size(), static_cast<size_t>(ControlLoopStatistics::STAGE_COUNT));
+
+  const auto & compute = msg.stages[ControlLoopStatistics::COMPUTE_VELOCITY];
+  EXPECT_EQ(compute.name, "compute_velocity");
+  ASSERT_EQ(compute.counts.size(), bounds.size() + 1);
+  EXPECT_EQ(compute.counts[0], 1u);
+  EXPECT_EQ(compute.counts[2], 1u);
+  EXPECT_EQ(compute.counts.back(), 1u);
+  EXPECT_DOUBLE_EQ(compute.max, 2.0 * bounds.back());
+  EXPECT_DOUBLE_EQ(compute.mean, (0.5 * bounds[0] + bounds[2] + 2.0 * bounds.back()) / 3.0);
+
+  const auto & wake_up = msg.stages[ControlLoopStatistics::WAKE_UP];
+  EXPECT_EQ(wake_up.name, "wake_up");
+  EXPECT_DOUBLE_EQ(wake_up.mean, 0.0);
+  EXPECT_EQ(msg.stages[ControlLoopStatistics::CYCLE].name, "cycle");
+
+  statistics.reset();
+  EXPECT_EQ(statistics.getCycles(), 0u);
+  msg = statistics.toMsg(0.05);
+  EXPECT_EQ(msg.missed_deadlines, 0u);
+  for (const auto & stage : msg.stages) {
+    for (const auto count : stage.counts) {
+      EXPECT_EQ(count, 0u);
+    }
+  }
+}
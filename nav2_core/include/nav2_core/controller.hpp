@@ -48,6 +48,7 @@
 #include "geometry_msgs/msg/twist_stamped.hpp"
 #include "nav_msgs/msg/path.hpp"
 #include "nav2_core/goal_checker.hpp"
+#include "nav2_core/robot_state.hpp"
 
 
 namespace nav2_core
@@ -116,6 +117,20 @@ public:
     const geometry_msgs::msg::Twist & velocity,
     nav2_core::GoalChecker * goal_checker) = 0;
 
+  /**
+   * @brief Controller computeVelocityCommands - calculates the best command given the
+   * state of the robot computed once in the control cycle
+   * @param state Current robot state
+   * @param goal_checker Pointer to the current goal checker the task is utilizing
+   * @return The best command for the robot to drive
+   */
+  virtual geometry_msgs::msg::TwistStamped computeVelocityCommands(
+    const RobotState & state,
+    nav2_core::GoalChecker * goal_checker)
+  {
+    return computeVelocityCommands(state.pose, state.velocity, goal_checker);
+  }
+
   /**
    * @brief Limits the maximum linear speed of the robot.
    * @param speed_limit expressed in absolute value (in m/s)
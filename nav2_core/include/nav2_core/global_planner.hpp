@@ -15,6 +15,7 @@
 #ifndef NAV2_CORE__GLOBAL_PLANNER_HPP_
 #define NAV2_CORE__GLOBAL_PLANNER_HPP_
 
+#include <functional>
 #include <memory>
 #include <string>
 #include "rclcpp/rclcpp.hpp"
@@ -76,6 +77,22 @@ public:
   virtual nav_msgs::msg::Path createPlan(
     const geometry_msgs::msg::PoseStamped & start,
     const geometry_msgs::msg::PoseStamped & goal) = 0;
+
+  /**
+   * @brief Method create the plan from a starting and ending goal, which may be given up
+   * once cancelled. Planners which cannot be interrupted plan to the end, by default.
+   * @param start The starting pose of the robot
+   * @param goal  The goal pose of the robot
+   * @param cancel_checker Function returning true once the plan is no longer wanted
+   * @return      The sequence of poses to get from start to goal, if any
+   */
+  virtual nav_msgs::msg::Path createPlan(
+    const geometry_msgs::msg::PoseStamped & start,
+    const geometry_msgs::msg::PoseStamped & goal,
+    std::function<bool()> /*cancel_checker*/)
+  {
+    return createPlan(start, goal);
+  }
 };
 
 }  // namespace nav2_core
@@ -42,6 +42,7 @@
 #include "rclcpp_lifecycle/lifecycle_node.hpp"
 #include "geometry_msgs/msg/pose.hpp"
 #include "geometry_msgs/msg/twist.hpp"
+#include "nav2_core/robot_state.hpp"
 
 namespace nav2_core
 {
@@ -82,6 +83,18 @@ public:
     const geometry_msgs::msg::Pose & query_pose, const geometry_msgs::msg::Pose & goal_pose,
     const geometry_msgs::msg::Twist & velocity) = 0;
 
+  /**
+   * @brief Check whether the goal should be considered reached, from the state computed
+   * once in the control cycle
+   * @param state The state of the robot to check
+   * @param goal_pose The pose to check against
+   * @return True if goal is reached
+   */
+  virtual bool isGoalReached(const RobotState & state, const geometry_msgs::msg::Pose & goal_pose)
+  {
+    return isGoalReached(state.pose.pose, goal_pose, state.velocity);
+  }
+
   /**
    * @brief Get the maximum possible tolerances used for goal checking in the major types.
    * Any field without a valid entry is replaced with std::numeric_limits<double>::lowest()
@@ -22,6 +22,7 @@
 #include "rclcpp_lifecycle/lifecycle_node.hpp"
 #include "geometry_msgs/msg/pose_stamped.hpp"
 #include "geometry_msgs/msg/pose2_d.hpp"
+#include "nav2_core/robot_state.hpp"
 
 namespace nav2_core
 {
@@ -52,6 +53,17 @@ public:
    * @return True if progress is made
    */
   virtual bool check(geometry_msgs::msg::PoseStamped & current_pose) = 0;
+  /**
+   * @brief Checks if the robot has moved compare to previous
+   * pose, from the state computed once in the control cycle
+   * @param state Current state of the robot
+   * @return True if progress is made
+   */
+  virtual bool check(const RobotState & state)
+  {
+    geometry_msgs::msg::PoseStamped current_pose = state.pose;
+    return check(current_pose);
+  }
   /**
    * @brief Reset class state upon calling
    */
@@ -0,0 +1,79 @@
+// Copyright (c) 2022 Samsung Research America
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef NAV2_CORE__ROBOT_STATE_HPP_
+#define NAV2_CORE__ROBOT_STATE_HPP_
+
+#include <cmath>
+
+#include "geometry_msgs/msg/pose_stamped.hpp"
+#include "geometry_msgs/msg/twist.hpp"
+
+namespace nav2_core
+{
+
+/**
+ * @struct nav2_core::RobotState
+ * @brief State of the robot in a control cycle, with its 2D pose and speed computed once
+ * for all the checkers and controllers of the cycle
+ */
+struct RobotState
+{
+  RobotState() = default;
+
+  /**
+   * @brief A constructor for nav2_core::RobotState
+   * @param robot_pose Current robot pose
+   * @param robot_velocity Current robot velocity
+   */
+  RobotState(
+    const geometry_msgs::msg::PoseStamped & robot_pose,
+    const geometry_msgs::msg::Twist & robot_velocity)
+  : pose(robot_pose),
+    velocity(robot_velocity),
+    x(robot_pose.pose.position.x),
+    y(robot_pose.pose.position.y),
+    yaw(getYaw(robot_pose.pose.orientation)),
+    speed(std::hypot(robot_velocity.linear.x, robot_velocity.linear.y))
+  {
+  }
+
+  /**
+   * @brief Get the yaw of a quaternion, as tf2::getYaw does
+   */
+  static double getYaw(const geometry_msgs::msg::Quaternion & q)
+  {
+    const double sqx = q.x * q.x, sqy = q.y * q.y, sqz = q.z * q.z, sqw = q.w * q.w;
+    // Normalized so that the quaternion need not be
+    const double sarg = -2.0 * (q.x * q.z - q.w * q.y) / (sqx + sqy + sqz + sqw);
+    if (sarg <= -0.99999) {
+      return -2.0 * std::atan2(q.y, q.x);
+    } else if (sarg >= 0.99999) {
+      return 2.0 * std::atan2(q.y, q.x);
+    }
+    return std::atan2(2.0 * (q.x * q.y + q.w * q.z), sqw + sqx - sqy - sqz);
+  }
+
+  geometry_msgs::msg::PoseStamped pose;
+  geometry_msgs::msg::Twist velocity;
+  double x{0.0};
+  double y{0.0};
+  double yaw{0.0};
+  // Planar linear speed
+  double speed{0.0};
+};
+
+}  // namespace nav2_core
+
+#endif  // NAV2_CORE__ROBOT_STATE_HPP_
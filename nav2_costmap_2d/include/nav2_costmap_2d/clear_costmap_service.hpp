@@ -18,12 +18,14 @@
 #include <vector>
 #include <string>
 #include <memory>
+#include <mutex>
 
 #include "rclcpp/rclcpp.hpp"
 #include "nav2_msgs/srv/clear_costmap_except_region.hpp"
 #include "nav2_msgs/srv/clear_costmap_around_robot.hpp"
 #include "nav2_msgs/srv/clear_entire_costmap.hpp"
 #include "nav2_costmap_2d/costmap_layer.hpp"
+#include "nav2_costmap_2d/tile_thread_pool.hpp"
 #include "nav2_util/lifecycle_node.hpp"
 
 namespace nav2_costmap_2d
@@ -49,10 +51,17 @@ public:
   ClearCostmapService() = delete;
 
   /**
-   * @brief Clears the region outside of a user-specified area reverting to the static map
+   * @brief Clears the region outside of a user-specified area reverting to the static map.
+   * With defer_clearing, the region is only queued to be cleared on the next update.
    */
   void clearRegion(double reset_distance, bool invert);
 
+  /**
+   * @brief Clears the regions queued since the last update, from the update thread
+   * before the layers are updated, the clearable layers being cleared in parallel
+   */
+  void applyDeferredClearing();
+
   /**
    * @brief Clears all layers
    */
@@ -68,6 +77,17 @@ private:
   // Clearing parameters
   unsigned char reset_value_;
   std::vector<std::string> clearable_layers_;
+  bool defer_clearing_{false};
+
+  // Regions queued to be cleared on the next update
+  struct DeferredClearing
+  {
+    double x, y;
+    double reset_distance;
+    bool invert;
+  };
+  std::mutex deferred_mutex_;
+  std::vector<DeferredClearing> deferred_clearing_;
 
   // Server for clearing the costmap
   rclcpp::Service<nav2_msgs::srv::ClearCostmapExceptRegion>::SharedPtr clear_except_service_;
@@ -97,6 +117,14 @@ private:
     const std::shared_ptr<nav2_msgs::srv::ClearEntireCostmap::Request> request,
     const std::shared_ptr<nav2_msgs::srv::ClearEntireCostmap::Response> response);
 
+  /**
+   * @brief Clear a region around a pose in all of the clearable layers
+   * @param thread_pool Pool to clear the layers in parallel on, if not null
+   */
+  void clearLayers(
+    double pose_x, double pose_y, double reset_distance, bool invert,
+    TileThreadPool * thread_pool);
+
   /**
    * @brief  Function used to clear a given costmap layer
    */
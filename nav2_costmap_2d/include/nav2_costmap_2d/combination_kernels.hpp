@@ -0,0 +1,61 @@
+// Copyright (c) 2022 Samsung Research America
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef NAV2_COSTMAP_2D__COMBINATION_KERNELS_HPP_
+#define NAV2_COSTMAP_2D__COMBINATION_KERNELS_HPP_
+
+namespace nav2_costmap_2d
+{
+
+/**
+ * Kernels combining a row of layer costs into a row of the master costmap, vectorized
+ * with AVX2, SSE2/SSE4.1 or NEON when the compiler targets them, with a scalar fallback.
+ * The rows must not overlap.
+ */
+
+/**
+ * @brief Set each master cell to the maximum of both costs. Unknown layer cells are skipped and
+ * unknown master cells take the layer cost.
+ * @param master Row of the master costmap to update
+ * @param layer Row of the layer costmap to combine
+ * @param size Number of cells in the rows
+ */
+void combineWithMax(unsigned char * master, const unsigned char * layer, unsigned int size);
+
+/**
+ * @brief Set each master cell to the layer cost, except where the layer cell is unknown
+ * @param master Row of the master costmap to update
+ * @param layer Row of the layer costmap to combine
+ * @param size Number of cells in the rows
+ */
+void combineWithOverwrite(unsigned char * master, const unsigned char * layer, unsigned int size);
+
+/**
+ * @brief Add the layer cost to each master cell, bounded just below the inscribed cost.
+ * Unknown layer cells are skipped and unknown master cells take the layer cost.
+ * @param master Row of the master costmap to update
+ * @param layer Row of the layer costmap to combine
+ * @param size Number of cells in the rows
+ */
+void combineWithAddition(unsigned char * master, const unsigned char * layer, unsigned int size);
+
+/**
+ * @brief Get the instruction set used by the combination kernels
+ * @return "AVX2", "SSE4.1", "SSE2", "NEON" or "scalar"
+ */
+const char * getCombinationKernelsInstructionSet();
+
+}  // namespace nav2_costmap_2d
+
+#endif  // NAV2_COSTMAP_2D__COMBINATION_KERNELS_HPP_
@@ -44,11 +44,13 @@
 #include <algorithm>
 #include <cmath>
 #include <string>
+#include <utility>
 #include <vector>
 #include <queue>
 #include <mutex>
 #include "geometry_msgs/msg/point.hpp"
 #include "nav_msgs/msg/occupancy_grid.hpp"
+#include "nav2_util/grid_traversal.hpp"
 
 namespace nav2_costmap_2d
 {
@@ -130,6 +132,14 @@ public:
     unsigned int sx0, unsigned int sy0, unsigned int sxn, unsigned int syn,
     unsigned int dx0, unsigned int dy0);
 
+  /**
+   * @brief Fill this costmap with the cells of a costmap of another resolution or origin,
+   * each cell taking the highest known cost of the source cells it overlaps, unknown if all
+   * of them are and the default value if none is on the source
+   * @param source Source costmap to resample
+   */
+  void copyResampled(const Costmap2D & source);
+
   /**
    * @brief  Default constructor
    */
@@ -312,7 +322,7 @@ public:
     std::vector<MapLocation> & polygon_cells);
 
   /**
-   * @brief  Get the map cells that fill a convex polygon
+   * @brief  Get the map cells that fill a convex polygon, in row-major order
    * @param polygon The polygon in map coordinates to rasterize
    * @param polygon_cells Will be set to the cells that fill the polygon
    */
@@ -399,6 +409,64 @@ protected:
     }
   }
 
+  /**
+   * @brief  Shift the cells of a map in place, such that the cell at (x, y) takes the value
+   * of the cell at (x + cell_ox, y + cell_oy). Cells shifted in from outside the map are set
+   * to a fill value, with no copy of the map.
+   * @param map The map to shift
+   * @param size_x The x size of the map
+   * @param size_y The y size of the map
+   * @param cell_ox The shift in x, in cells
+   * @param cell_oy The shift in y, in cells
+   * @param fill_value The value of the cells shifted in
+   */
+  template<typename data_type>
+  void shiftMapRegion(
+    data_type * map, unsigned int size_x, unsigned int size_y,
+    int cell_ox, int cell_oy, data_type fill_value)
+  {
+    const int sx = static_cast<int>(size_x);
+    const int sy = static_cast<int>(size_y);
+    if (cell_ox <= -sx || cell_ox >= sx || cell_oy <= -sy || cell_oy >= sy) {
+      std::fill(map, map + size_x * size_y, fill_value);
+      return;
+    }
+
+    const unsigned int len = size_x - std::abs(cell_ox);
+    const unsigned int dst_x = std::max(-cell_ox, 0);
+    const unsigned int src_x = std::max(cell_ox, 0);
+    const unsigned int rows = size_y - std::abs(cell_oy);
+
+    // Rows are moved in the order that never overwrites a row yet to be moved
+    for (unsigned int i = 0; i < rows; ++i) {
+      const unsigned int y = cell_oy >= 0 ? i : size_y - 1 - i;
+      data_type * row = map + y * size_x;
+      memmove(row + dst_x, map + (y + cell_oy) * size_x + src_x, len * sizeof(data_type));
+      if (cell_ox > 0) {
+        std::fill(row + len, row + size_x, fill_value);
+      } else {
+        std::fill(row, row + dst_x, fill_value);
+      }
+    }
+
+    if (cell_oy > 0) {
+      std::fill(map + rows * size_x, map + size_x * size_y, fill_value);
+    } else {
+      std::fill(map, map + (size_y - rows) * size_x, fill_value);
+    }
+  }
+
+  /**
+   * @brief  Get the rows of cells that fill a convex polygon, those between the first and
+   * last cells of its outline on each row
+   * @param polygon The polygon in map coordinates to rasterize, of at least three points
+   * @param min_y Will be set to the first row of the polygon
+   * @param spans Will be set to the first and last cells of each row from min_y
+   */
+  void convexFillSpans(
+    const std::vector<MapLocation> & polygon, unsigned int & min_y,
+    std::vector<std::pair<unsigned int, unsigned int>> & spans);
+
   /**
    * @brief  Deletes the costmap, static_map, and markers data structures
    */
@@ -495,16 +563,7 @@ private:
     unsigned int max_length)
   {
     unsigned int end = std::min(max_length, abs_da);
-    for (unsigned int i = 0; i < end; ++i) {
-      at(offset);
-      offset += offset_a;
-      error_b += abs_db;
-      if ((unsigned int)error_b >= abs_da) {
-        offset += offset_b;
-        error_b -= abs_da;
-      }
-    }
-    at(offset);
+    nav2_util::traverseLineOffsets(offset, abs_da, abs_db, error_b, offset_a, offset_b, end, at);
   }
 
   /**
@@ -544,6 +603,32 @@ protected:
     unsigned char value_;
   };
 
+  class PolygonOutlineSpans
+  {
+  public:
+    PolygonOutlineSpans(
+      unsigned int size_x, unsigned int min_y,
+      std::vector<std::pair<unsigned int, unsigned int>> & spans)
+    : size_x_(size_x), min_y_(min_y), spans_(spans)
+    {
+    }
+
+    // widen the span of the row to the cell
+    inline void operator()(unsigned int offset)
+    {
+      const unsigned int y = offset / size_x_;
+      const unsigned int x = offset - y * size_x_;
+      std::pair<unsigned int, unsigned int> & span = spans_[y - min_y_];
+      span.first = std::min(span.first, x);
+      span.second = std::max(span.second, x);
+    }
+
+  private:
+    unsigned int size_x_;
+    unsigned int min_y_;
+    std::vector<std::pair<unsigned int, unsigned int>> & spans_;
+  };
+
   class PolygonOutlineCells
   {
   public:
@@ -40,6 +40,7 @@
 #define NAV2_COSTMAP_2D__COSTMAP_2D_PUBLISHER_HPP_
 
 #include <algorithm>
+#include <atomic>
 #include <string>
 #include <memory>
 
@@ -48,7 +49,10 @@
 #include "nav_msgs/msg/occupancy_grid.hpp"
 #include "map_msgs/msg/occupancy_grid_update.hpp"
 #include "nav2_msgs/msg/costmap.hpp"
+#include "nav2_msgs/msg/costmap_update.hpp"
+#include "nav2_msgs/msg/compressed_costmap.hpp"
 #include "nav2_msgs/srv/get_costmap.hpp"
+#include "std_srvs/srv/empty.hpp"
 #include "tf2/transform_datatypes.h"
 #include "nav2_util/lifecycle_node.hpp"
 #include "tf2/LinearMath/Quaternion.h"
@@ -65,13 +69,16 @@ class Costmap2DPublisher
 public:
   /**
    * @brief  Constructor for the Costmap2DPublisher
+   * @param publish_compressed_costmap Whether to also publish the raw costs run-length
+   *        encoded, on the <topic_name>_raw_compressed and _raw_compressed_updates topics
    */
   Costmap2DPublisher(
     const nav2_util::LifecycleNode::WeakPtr & parent,
     Costmap2D * costmap,
     std::string global_frame,
     std::string topic_name,
-    bool always_send_full_costmap = false);
+    bool always_send_full_costmap = false,
+    bool publish_compressed_costmap = false);
 
   /**
    * @brief  Destructor
@@ -91,6 +98,11 @@ public:
     costmap_pub_->on_activate();
     costmap_update_pub_->on_activate();
     costmap_raw_pub_->on_activate();
+    costmap_raw_update_pub_->on_activate();
+    if (publish_compressed_costmap_) {
+      costmap_compressed_pub_->on_activate();
+      costmap_compressed_update_pub_->on_activate();
+    }
   }
 
   /**
@@ -101,6 +113,11 @@ public:
     costmap_pub_->on_deactivate();
     costmap_update_pub_->on_deactivate();
     costmap_raw_pub_->on_deactivate();
+    costmap_raw_update_pub_->on_deactivate();
+    if (publish_compressed_costmap_) {
+      costmap_compressed_pub_->on_deactivate();
+      costmap_compressed_update_pub_->on_deactivate();
+    }
   }
 
   /**
@@ -118,7 +135,11 @@ public:
   }
 
   /**
-   * @brief  Publishes the visualization data over ROS
+   * @brief  Publishes the visualization data over ROS. Full costmaps are only
+   *         published when the map changed size, resolution or origin, when a
+   *         subscriber joined, or when one which lost updates requested them on the
+   *         <topic_name>_raw_resync service, otherwise just the window changed since
+   *         the last publication is sent on the updates topics
    */
   void publishCostmap();
 
@@ -136,6 +157,13 @@ private:
   void prepareGrid();
   void prepareCostmap();
 
+  /** @brief Create an update message of the changed window of raw costs. */
+  std::unique_ptr<nav2_msgs::msg::CostmapUpdate> createCostmapUpdateMsg();
+
+  /** @brief Create a compressed message of a window of raw costs. */
+  std::unique_ptr<nav2_msgs::msg::CompressedCostmap> createCompressedCostmapMsg(
+    unsigned int x0, unsigned int xn, unsigned int y0, unsigned int yn);
+
   /** @brief Publish the latest full costmap to the new subscriber. */
   // void onNewSubscription(const ros::SingleSubscriberPublisher& pub);
 
@@ -156,6 +184,7 @@ private:
   double saved_origin_y_;
   bool active_;
   bool always_send_full_costmap_;
+  bool publish_compressed_costmap_;
 
   // Publisher for translated costmap values as msg::OccupancyGrid used in visualization
   rclcpp_lifecycle::LifecyclePublisher<nav_msgs::msg::OccupancyGrid>::SharedPtr costmap_pub_;
@@ -164,14 +193,33 @@ private:
 
   // Publisher for raw costmap values as msg::Costmap from layered costmap
   rclcpp_lifecycle::LifecyclePublisher<nav2_msgs::msg::Costmap>::SharedPtr costmap_raw_pub_;
+  rclcpp_lifecycle::LifecyclePublisher<nav2_msgs::msg::CostmapUpdate>::SharedPtr
+    costmap_raw_update_pub_;
+
+  // Publishers for run-length encoded raw costmaps and updates, if enabled
+  rclcpp_lifecycle::LifecyclePublisher<nav2_msgs::msg::CompressedCostmap>::SharedPtr
+    costmap_compressed_pub_;
+  rclcpp_lifecycle::LifecyclePublisher<nav2_msgs::msg::CompressedCostmap>::SharedPtr
+    costmap_compressed_update_pub_;
 
   // Service for getting the costmaps
   rclcpp::Service<nav2_msgs::srv::GetCostmap>::SharedPtr costmap_service_;
+  // Service requesting full costmaps on the next publication
+  rclcpp::Service<std_srvs::srv::Empty>::SharedPtr resync_service_;
+  std::atomic<bool> full_costmap_requested_{false};
 
   float grid_resolution;
   unsigned int grid_width, grid_height;
   std::unique_ptr<nav_msgs::msg::OccupancyGrid> grid_;
   std::unique_ptr<nav2_msgs::msg::Costmap> costmap_raw_;
+  float raw_resolution_;
+  unsigned int raw_size_x_, raw_size_y_;
+  double raw_origin_x_, raw_origin_y_;
+  // Stamps of the last full raw and compressed costmaps, and the updates numbered since
+  builtin_interfaces::msg::Time raw_base_stamp_, compressed_base_stamp_;
+  uint64_t raw_update_sequence_{0}, compressed_update_sequence_{0};
+  // Subscribers at the last publication, new ones need a full costmap
+  size_t grid_subscription_count_, raw_subscription_count_, compressed_subscription_count_;
   // Translate from 0-255 values in costmap to -1 to 100 values in message.
   static char * cost_translation_table_;
 };
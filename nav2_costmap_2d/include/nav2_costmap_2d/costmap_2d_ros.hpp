@@ -40,6 +40,7 @@
 
 #include <memory>
 #include <string>
+#include <utility>
 #include <vector>
 
 #include "geometry_msgs/msg/polygon.h"
@@ -47,9 +48,13 @@
 #include "nav2_costmap_2d/costmap_2d_publisher.hpp"
 #include "nav2_costmap_2d/footprint.hpp"
 #include "nav2_costmap_2d/clear_costmap_service.hpp"
+#include "nav2_costmap_2d/costmap_recorder.hpp"
 #include "nav2_costmap_2d/layered_costmap.hpp"
 #include "nav2_costmap_2d/layer.hpp"
+#include "nav2_costmap_2d/shared_memory_costmap.hpp"
+#include "nav2_util/instrumentation.hpp"
 #include "nav2_util/lifecycle_node.hpp"
+#include "nav2_util/transform_cache.hpp"
 #include "pluginlib/class_loader.hpp"
 #include "tf2/convert.h"
 #include "tf2/LinearMath/Transform.h"
@@ -197,6 +202,17 @@ public:
     return layered_costmap_->getCostmap();
   }
 
+  /**
+   * @brief Return an immutable snapshot of the "master" costmap, as of the end of the
+   * last update, which can be read without locking or waiting for the update thread.
+   *
+   * Same as calling getLayeredCostmap()->getCostmapSnapshot().
+   */
+  std::shared_ptr<const Costmap2D> getCostmapSnapshot()
+  {
+    return layered_costmap_->getCostmapSnapshot();
+  }
+
   /**
    * @brief  Returns the global frame of the costmap
    * @return The global frame of the costmap
@@ -254,6 +270,15 @@ public:
     return unpadded_footprint_;
   }
 
+  /**
+   * @brief Get the geometry of the padded footprint, shared with the layers, whose
+   * version only changes with the footprint
+   */
+  std::shared_ptr<const FootprintGeometry> getFootprintGeometry()
+  {
+    return layered_costmap_->getFootprintGeometry();
+  }
+
   /**
    * @brief  Build the oriented footprint of the robot at the robot's current pose
    * @param  oriented_footprint Will be filled with the points in the oriented footprint of the robot
@@ -309,6 +334,18 @@ protected:
   rclcpp_lifecycle::LifecyclePublisher<geometry_msgs::msg::PolygonStamped>::SharedPtr
     footprint_pub_;
   std::unique_ptr<Costmap2DPublisher> costmap_publisher_{nullptr};
+  std::unique_ptr<SharedMemoryCostmapWriter> shared_memory_writer_;
+  std::unique_ptr<nav2_util::InstrumentationPublisher> instrumentation_publisher_;
+
+  // Probes of the map update loop, named after the costmap
+  std::unique_ptr<nav2_util::Probe> update_map_probe_;
+  std::unique_ptr<nav2_util::Probe> publish_probe_;
+
+  // Memory accounts of the master costmap and of the plugins and filters, named after the
+  // costmap and the layer, set after each update
+  std::unique_ptr<nav2_util::MemoryAccount> master_memory_;
+  std::vector<std::pair<std::shared_ptr<Layer>, std::unique_ptr<nav2_util::MemoryAccount>>>
+  layer_memory_;
 
   rclcpp::Subscription<geometry_msgs::msg::Polygon>::SharedPtr footprint_sub_;
   rclcpp::Subscription<rcl_interfaces::msg::ParameterEvent>::SharedPtr parameter_sub_;
@@ -316,6 +353,8 @@ protected:
   // Transform listener
   std::shared_ptr<tf2_ros::Buffer> tf_buffer_;
   std::shared_ptr<tf2_ros::TransformListener> tf_listener_;
+  // Serves the robot pose and transforms queried repeatedly in a cycle
+  std::unique_ptr<nav2_util::TransformCache> tf_cache_;
 
   std::unique_ptr<LayeredCostmap> layered_costmap_{nullptr};
   std::string name_;
@@ -325,6 +364,11 @@ protected:
    * @brief Function on timer for costmap update
    */
   void mapUpdateLoop(double frequency);
+
+  /**
+   * @brief Set the memory accounts to the memory owned by the master costmap and layers
+   */
+  void updateMemoryAccounts();
   bool map_update_thread_shutdown_{false};
   bool stop_updates_{false};
   bool initialized_{false};
@@ -339,25 +383,38 @@ protected:
    */
   void getParameters();
   bool always_send_full_costmap_{false};
+  bool publish_compressed_costmap_{false};
+  bool shared_memory_export_{false};  ///< Whether to export the master costmap to shared memory
+  bool event_driven_updates_{false};  ///< Whether to update only when layers have new data
+  double distance_field_max_distance_{0.0};  ///< Truncation of the distance field, 0 disables
   std::string footprint_;
   float footprint_padding_{0};
   std::string global_frame_;       ///< The global frame for the costmap
   int map_height_meters_{0};
   double map_publish_frequency_{0};
   double map_update_frequency_{0};
+  double min_update_frequency_{0};  ///< Minimum rate of event driven updates, 0 for none
   int map_width_meters_{0};
   double origin_x_{0};
   double origin_y_{0};
+  std::string record_file_;        ///< File to record the updates to, empty to disable
+  int record_keyframe_interval_{50};  ///< Number of update cycles between recorded keyframes
   std::vector<std::string> default_plugins_;
   std::vector<std::string> default_types_;
   std::vector<std::string> plugin_names_;
   std::vector<std::string> plugin_types_;
   std::vector<std::string> filter_names_;
   std::vector<std::string> filter_types_;
+  int pyramid_levels_{0};          ///< Coarse levels of the master costmap, 0 to disable
   double resolution_{0};
+  std::vector<std::string> resolution_profile_names_;
+  double resolution_profile_hysteresis_{0.1};  ///< Speed below a profile to switch back to it
   std::string robot_base_frame_;   ///< The frame_id of the robot base
   double robot_radius_;
   bool rolling_window_{false};     ///< Whether to use a rolling window version of the costmap
+  int tile_size_{256};             ///< Size in cells of the tiles of parallel layer updates
+  int tiled_update_threads_{1};    ///< Threads updating tile safe layers, 1 to disable
+  double tf_cache_lifetime_{0.0};  ///< Duration transforms are cached for, 0 to disable
   bool track_unknown_space_{false};
   double transform_tolerance_{0};  ///< The timeout before transform errors
 
@@ -366,6 +423,27 @@ protected:
   std::vector<geometry_msgs::msg::Point> unpadded_footprint_;
   std::vector<geometry_msgs::msg::Point> padded_footprint_;
 
+  // Resolution and size of the rolling window up to a speed of the robot
+  struct ResolutionProfile
+  {
+    std::string name;
+    double max_speed;
+    double resolution;
+    double width, height;
+  };
+  std::vector<ResolutionProfile> resolution_profiles_;
+  size_t resolution_profile_{0};
+  geometry_msgs::msg::PoseStamped last_pose_;
+  bool has_last_pose_{false};
+  double speed_{0.0};
+
+  /**
+   * @brief Switch the rolling window to the resolution profile of the speed of the robot,
+   * estimated from its poses at the updates, resampling the layers
+   * @param pose Pose of the robot at this update
+   */
+  void updateResolutionProfile(const geometry_msgs::msg::PoseStamped & pose);
+
   std::unique_ptr<ClearCostmapService> clear_costmap_service_;
 
   // Dynamic parameters handler
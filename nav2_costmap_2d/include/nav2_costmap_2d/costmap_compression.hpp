@@ -0,0 +1,57 @@
+// Copyright (c) 2022 Samsung Research America
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef NAV2_COSTMAP_2D__COSTMAP_COMPRESSION_HPP_
+#define NAV2_COSTMAP_2D__COSTMAP_COMPRESSION_HPP_
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace nav2_costmap_2d
+{
+
+/**
+ * Run-length encoding of cost values, for the compressed costmap topics. Each run
+ * of equal costs is encoded as the cost followed by the length of the run as an
+ * unsigned LEB128 varint, so that the large free and unknown areas of a costmap
+ * take a few bytes each.
+ */
+
+/**
+ * @brief Run-length encode a window of costs, row by row
+ * @param data Cost of the first cell of the window
+ * @param size_x Number of cells in each row of the window
+ * @param size_y Number of rows of the window
+ * @param stride Number of cells between the starts of consecutive rows in data
+ * @param encoded Vector the encoded costs are written to, replacing its contents
+ */
+void encodeRunLength(
+  const unsigned char * data, unsigned int size_x, unsigned int size_y,
+  unsigned int stride, std::vector<uint8_t> & encoded);
+
+/**
+ * @brief Decode run-length encoded costs
+ * @param encoded Encoded costs
+ * @param encoded_size Number of bytes of encoded costs
+ * @param data Buffer the costs are decoded to
+ * @param size Number of costs expected
+ * @return False if the encoded costs are malformed or do not decode to exactly size costs
+ */
+bool decodeRunLength(
+  const uint8_t * encoded, size_t encoded_size, unsigned char * data, size_t size);
+
+}  // namespace nav2_costmap_2d
+
+#endif  // NAV2_COSTMAP_2D__COSTMAP_COMPRESSION_HPP_
@@ -40,10 +40,12 @@
 
 #include <string>
 #include <memory>
+#include <vector>
 
 #include "nav2_costmap_2d/costmap_filters/costmap_filter.hpp"
 
 #include "rclcpp/rclcpp.hpp"
+#include "tf2/LinearMath/Transform.h"
 #include "nav_msgs/msg/occupancy_grid.hpp"
 #include "nav2_msgs/msg/costmap_filter_info.hpp"
 
@@ -97,10 +99,101 @@ private:
    */
   void maskCallback(const nav_msgs::msg::OccupancyGrid::SharedPtr msg);
 
+  /**
+   * @brief Index the runs of equal known values along the rows of mask_costmap_
+   */
+  void buildMaskRuns();
+
+  /**
+   * @brief Check whether the cells of the master grid coincide with mask_costmap_ cells,
+   * which are then a fixed index offset away
+   * @param master_grid The master costmap grid
+   * @param offset_x Output X offset of the mask cell of a master grid cell
+   * @param offset_y Output Y offset of the mask cell of a master grid cell
+   * @return true if the grids are aligned
+   */
+  bool isMaskAligned(
+    const nav2_costmap_2d::Costmap2D & master_grid, int & offset_x, int & offset_y) const;
+
+  /**
+   * @brief Update the master grid window from the mask runs of an aligned mask
+   * @param master_grid The master costmap grid to update
+   * @param min_i X min map coord of the window to update
+   * @param min_j Y min map coord of the window to update
+   * @param max_i X max map coord of the window to update
+   * @param max_j Y max map coord of the window to update
+   * @param offset_x X offset of the mask cell of a master grid cell
+   * @param offset_y Y offset of the mask cell of a master grid cell
+   */
+  void processMaskRuns(
+    nav2_costmap_2d::Costmap2D & master_grid,
+    int min_i, int min_j, int max_i, int max_j,
+    int offset_x, int offset_y) const;
+
+  /**
+   * @brief Project mask_costmap_ on the master grid cells it overlaps, once per mask or master
+   * grid geometry. When the master grid is only shifted, as a rolling window is, the cells still
+   * overlapped are moved and only the newly exposed cells are projected.
+   * @param master_grid The master costmap grid
+   * @param transform Transformation of the master grid frame to the mask frame
+   */
+  void projectMask(
+    const nav2_costmap_2d::Costmap2D & master_grid, const tf2::Transform & transform);
+
+  /**
+   * @brief Get the mask_costmap_ value at the center of a master grid cell
+   * @param master_grid The master costmap grid
+   * @param transform Transformation of the master grid frame to the mask frame
+   * @param i X map coord of the master grid cell
+   * @param j Y map coord of the master grid cell
+   * @return The mask value, NO_INFORMATION outside of the mask
+   */
+  unsigned char projectCell(
+    const nav2_costmap_2d::Costmap2D & master_grid, const tf2::Transform & transform,
+    unsigned int i, unsigned int j) const;
+
+  /**
+   * @brief Update the master grid window from the projected mask
+   * @param master_grid The master costmap grid to update
+   * @param min_i X min map coord of the window to update
+   * @param min_j Y min map coord of the window to update
+   * @param max_i X max map coord of the window to update
+   * @param max_j Y max map coord of the window to update
+   */
+  void processProjectedMask(
+    nav2_costmap_2d::Costmap2D & master_grid,
+    int min_i, int min_j, int max_i, int max_j) const;
+
+  /**
+   * @struct MaskRun
+   * @brief Cells [begin, end) of a mask row, all of the same known value
+   */
+  struct MaskRun
+  {
+    unsigned int begin;
+    unsigned int end;
+    unsigned char value;
+  };
+
   rclcpp::Subscription<nav2_msgs::msg::CostmapFilterInfo>::SharedPtr filter_info_sub_;
   rclcpp::Subscription<nav_msgs::msg::OccupancyGrid>::SharedPtr mask_sub_;
 
   std::unique_ptr<Costmap2D> mask_costmap_;
+  // Runs of known values of mask_costmap_, those of row y from mask_row_runs_[y]
+  // up to mask_row_runs_[y + 1]. Unknown cells are left out, as they never apply.
+  std::vector<MaskRun> mask_runs_;
+  std::vector<size_t> mask_row_runs_;
+
+  // mask_costmap_ projected on the master grid cells [projected_min_x_, projected_max_x_) X
+  // [projected_min_y_, projected_max_y_) that it overlaps, for the master grid geometry and
+  // transformation it was projected with. Cells out of these bounds are left unset.
+  std::vector<unsigned char> projected_mask_;
+  std::vector<unsigned char> projected_scratch_;
+  bool projected_valid_;
+  unsigned int projected_size_x_, projected_size_y_;
+  double projected_resolution_, projected_origin_x_, projected_origin_y_;
+  tf2::Transform projected_transform_;
+  unsigned int projected_min_x_, projected_min_y_, projected_max_x_, projected_max_y_;
 
   std::string mask_frame_;  // Frame where mask located in
   std::string global_frame_;  // Frame of currnet layer (master_grid)
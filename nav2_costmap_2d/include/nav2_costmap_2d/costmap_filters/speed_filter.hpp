@@ -38,8 +38,10 @@
 #ifndef NAV2_COSTMAP_2D__COSTMAP_FILTERS__SPEED_FILTER_HPP_
 #define NAV2_COSTMAP_2D__COSTMAP_FILTERS__SPEED_FILTER_HPP_
 
+#include <limits>
 #include <memory>
 #include <string>
+#include <vector>
 
 #include "nav2_costmap_2d/costmap_filters/costmap_filter.hpp"
 
@@ -118,6 +120,12 @@ protected:
   inline int8_t getMaskData(
     const unsigned int mx, const unsigned int my) const;
 
+  /**
+   * @brief  Splits the filter mask into speed zones: 4-connected regions of cells
+   * with identical mask data. Each cell gets the id of the zone it belongs to.
+   */
+  void buildZones();
+
 private:
   /**
    * @brief Callback for the filter information
@@ -141,6 +149,13 @@ private:
   double base_, multiplier_;
   bool percentage_;
   double speed_limit_, speed_limit_prev_;
+
+  // Zone id stored for cells which do not belong to any zone / no zone visited yet
+  static constexpr unsigned int NO_ZONE = std::numeric_limits<unsigned int>::max();
+  // Per-cell speed zone ids of filter_mask_, in the same order as mask data
+  std::vector<unsigned int> mask_zones_;
+  // Zone where the robot was placed on previous process() call
+  unsigned int zone_prev_;
 };
 
 }  // namespace nav2_costmap_2d
@@ -81,6 +81,14 @@ public:
    */
   virtual void clearArea(int start_x, int start_y, int end_x, int end_y, bool invert);
 
+  /**
+   * @brief Get the bytes of memory owned by the layer, its grid of costs
+   */
+  size_t getMemoryUsage() override
+  {
+    return static_cast<size_t>(size_x_) * size_y_;
+  }
+
   /**
    * If an external source changes values in the costmap,
    * it should call this method with the area that it changed
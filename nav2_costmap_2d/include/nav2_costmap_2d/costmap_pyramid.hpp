@@ -0,0 +1,123 @@
+// Copyright (c) 2022 Samsung Research America
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef NAV2_COSTMAP_2D__COSTMAP_PYRAMID_HPP_
+#define NAV2_COSTMAP_2D__COSTMAP_PYRAMID_HPP_
+
+#include <memory>
+#include <vector>
+
+#include "nav2_costmap_2d/cost_values.hpp"
+#include "nav2_costmap_2d/costmap_2d.hpp"
+
+namespace nav2_costmap_2d
+{
+
+/**
+ * @class CostmapPyramid
+ * @brief Coarser resolution levels of a costmap, kept up to date with the window of each
+ * update rather than downsampled whenever they are read. Level k has a resolution 2^k times
+ * coarser than the costmap, and each of its cells holds the maximum cost of the cells it
+ * covers, as the downsampling of the planners does. Levels are regular Costmap2D objects,
+ * their shared origin with the costmap keeps worldToMap() and getCost() consistent across
+ * levels.
+ */
+class CostmapPyramid
+{
+public:
+  /**
+   * @brief Set the number of coarse levels, 0 to disable the pyramid
+   * @param levels Number of levels, with downsampling factors 2, 4, ..., 2^levels
+   */
+  void setLevels(unsigned int levels);
+
+  /**
+   * @brief Get the number of coarse levels
+   */
+  unsigned int getLevels() const
+  {
+    return levels_.size();
+  }
+
+  /**
+   * @brief Update the levels over a window of the costmap. All of the levels are
+   * recomputed instead if the size, resolution or origin of the costmap changed.
+   * @param costmap Costmap the levels are downsampled from
+   * @param x0 Window start x, in cells of the costmap
+   * @param y0 Window start y, in cells of the costmap
+   * @param xn Window end x (exclusive), in cells of the costmap
+   * @param yn Window end y (exclusive), in cells of the costmap
+   */
+  void update(
+    const Costmap2D & costmap,
+    unsigned int x0, unsigned int y0, unsigned int xn, unsigned int yn);
+
+  /**
+   * @brief Get the level with a downsampling factor. Readers must hold the mutex of the
+   * costmap, as the levels are updated along with it.
+   * @param factor Downsampling factor, a power of two
+   * @return The level, or nullptr if no level has this factor
+   */
+  const Costmap2D * getLevel(unsigned int factor) const;
+
+  /**
+   * @brief Get the maximum cost over a window of the costmap. Coarse cells are visited
+   * first and only those that could raise the maximum are refined, so that windows over
+   * free space, or with a lethal cell, are answered from a few cells of the levels. Levels
+   * that do not match the costmap yet, before their first update, are not used.
+   * @param costmap Costmap the levels are downsampled from
+   * @param x0 Window start x, in cells of the costmap
+   * @param y0 Window start y, in cells of the costmap
+   * @param xn Window end x (exclusive), in cells of the costmap
+   * @param yn Window end y (exclusive), in cells of the costmap
+   * @param stop_cost Cost at which the search stops, as no higher cost matters to the caller
+   * @return The maximum cost, or a cost of at least stop_cost if one was found
+   */
+  unsigned char getMaxCost(
+    const Costmap2D & costmap,
+    unsigned int x0, unsigned int y0, unsigned int xn, unsigned int yn,
+    unsigned char stop_cost = NO_INFORMATION) const;
+
+protected:
+  /**
+   * @brief Raise max_cost to the maximum cost of the window under a cell of a level
+   * @param costmap Costmap the levels are downsampled from, as level 0
+   * @param level Level of the cell
+   * @param cx Cell x, in cells of the level
+   * @param cy Cell y, in cells of the level
+   */
+  void getMaxCostInCell(
+    const Costmap2D & costmap, unsigned int level, unsigned int cx, unsigned int cy,
+    unsigned int x0, unsigned int y0, unsigned int xn, unsigned int yn,
+    unsigned char stop_cost, unsigned char & max_cost) const;
+
+  /**
+   * @brief Set a window of a level to the maximum cost of each 2x2 block of the finer level
+   * @param finer Level costs are downsampled from
+   * @param coarser Level costs are written to
+   * @param x0 Window start x, in cells of the coarser level
+   * @param y0 Window start y, in cells of the coarser level
+   * @param xn Window end x (exclusive), in cells of the coarser level
+   * @param yn Window end y (exclusive), in cells of the coarser level
+   */
+  static void downsampleWindow(
+    const Costmap2D & finer, Costmap2D & coarser,
+    unsigned int x0, unsigned int y0, unsigned int xn, unsigned int yn);
+
+  std::vector<std::unique_ptr<Costmap2D>> levels_;
+};
+
+}  // namespace nav2_costmap_2d
+
+#endif  // NAV2_COSTMAP_2D__COSTMAP_PYRAMID_HPP_
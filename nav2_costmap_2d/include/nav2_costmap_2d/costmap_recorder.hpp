@@ -0,0 +1,261 @@
+// Copyright (c) 2022 Samsung Research America
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+
+#ifndef NAV2_COSTMAP_2D__COSTMAP_RECORDER_HPP_
+#define NAV2_COSTMAP_2D__COSTMAP_RECORDER_HPP_
+
+#include <condition_variable>
+#include <cstdint>
+#include <fstream>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+#include "nav2_costmap_2d/costmap_2d.hpp"
+#include "nav2_costmap_2d/layered_costmap.hpp"
+#include "nav2_costmap_2d/observation.hpp"
+#include "rclcpp/logger.hpp"
+
+namespace nav2_costmap_2d
+{
+
+/**
+ * Recordings of costmap updates, to reproduce them offline without the raw sensor data and
+ * transforms. They hold the observations buffered, after their transform to the global frame
+ * and filtering, the robot pose of each update cycle, and the master costmap, in full at
+ * keyframes and as the windows changed by the cycles in between. Records are streamed to the
+ * file as they are made, each as its type (uint8), the size of its payload (uint32) and the
+ * payload, after the magic and version of the file. Costs are run-length encoded.
+ */
+
+/**
+ * @struct RecordedSource
+ * @brief An observation buffer of a layer, which the observations recorded come from
+ */
+struct RecordedSource
+{
+  std::string layer;        ///< Name of the layer of the buffer
+  std::string topic;        ///< Topic of the buffer
+  double keep_time{0.0};    ///< Time the observations are kept for, 0 to keep the latest only
+  bool marking{false};
+  bool clearing{false};
+};
+
+/**
+ * @struct RecordedCycle
+ * @brief An update cycle of the costmap
+ */
+struct RecordedCycle
+{
+  int64_t stamp_ns{0};      ///< Time of the update, in nanoseconds, on the clock of the costmap
+  double robot_x{0.0};
+  double robot_y{0.0};
+  double robot_yaw{0.0};
+  bool keyframe{false};     ///< Whether the whole master costmap was recorded
+};
+
+/**
+ * @struct CostmapRecord
+ * @brief A record of a recording, the fields set depending on its type
+ */
+struct CostmapRecord
+{
+  enum Type : uint8_t
+  {
+    SOURCE = 1,
+    OBSERVATION = 2,
+    CYCLE = 3
+  };
+
+  Type type{SOURCE};
+  uint32_t source_id{0};    ///< Source of a SOURCE or OBSERVATION record
+  RecordedSource source;    ///< SOURCE record
+  Observation observation;  ///< OBSERVATION record, with the xyz fields of its cloud only
+  RecordedCycle cycle;      ///< CYCLE record
+};
+
+/**
+ * @class CostmapRecorder
+ * @brief Records the updates of a costmap to a file, on a thread of its own so that updates
+ * and sensor callbacks only encode their records. Records are dropped rather than queued
+ * beyond a few tens of megabytes, the cycle after a dropped one being a keyframe.
+ */
+class CostmapRecorder
+{
+public:
+  /**
+   * @brief A constructor, opening the file and starting the thread
+   * @param path File to record to, replaced if it exists
+   * @param keyframe_interval Number of cycles between keyframes, 1 or less for all cycles
+   * @param logger Logger to report failures with
+   */
+  CostmapRecorder(
+    const std::string & path, unsigned int keyframe_interval, const rclcpp::Logger & logger);
+
+  /**
+   * @brief A destructor, writing the records queued before joining the thread
+   */
+  ~CostmapRecorder();
+
+  CostmapRecorder(const CostmapRecorder &) = delete;
+  CostmapRecorder & operator=(const CostmapRecorder &) = delete;
+
+  /**
+   * @brief Whether the file could be opened
+   */
+  bool isOpen() const
+  {
+    return open_;
+  }
+
+  /**
+   * @brief Record a source of observations. Thread safe.
+   * @return Identifier of the source, to record its observations with
+   */
+  uint32_t addSource(const RecordedSource & source);
+
+  /**
+   * @brief Record an observation, in the global frame. Thread safe.
+   * @param source Identifier of the source of the observation, from addSource()
+   * @param observation Observation, whose cloud has x, y and z float fields
+   */
+  void recordObservation(uint32_t source, const Observation & observation);
+
+  /**
+   * @brief Record an update cycle, after it updated the master costmap. Thread safe with
+   * the changes of the master costmap, under its mutex, not with other cycles.
+   * @param stamp_ns Time of the update, in nanoseconds, on the clock of the observations
+   * @param robot_x X coordinate of the robot the update was made at
+   * @param robot_y Y coordinate of the robot the update was made at
+   * @param robot_yaw Orientation of the robot the update was made at
+   * @param layered_costmap The costmap updated
+   */
+  void recordCycle(
+    int64_t stamp_ns, double robot_x, double robot_y, double robot_yaw,
+    LayeredCostmap & layered_costmap);
+
+protected:
+  /**
+   * @brief Queue a record to be written
+   * @return False if it was dropped
+   */
+  bool push(CostmapRecord::Type type, const std::vector<uint8_t> & payload);
+
+  /**
+   * @brief Loop of the thread, writing the records queued
+   */
+  void run();
+
+  rclcpp::Logger logger_;
+  std::ofstream file_;
+  bool open_{false};
+  unsigned int keyframe_interval_;
+
+  // Records queued, guarded by mutex_ along with the number of sources and of records dropped
+  std::mutex mutex_;
+  std::condition_variable cv_;
+  std::vector<uint8_t> pending_;
+  static constexpr size_t max_pending_bytes_ = 64 * 1024 * 1024;
+  uint32_t sources_{0};
+  uint64_t dropped_{0};
+  bool stop_{false};
+
+  // State of the cycles, only accessed by recordCycle()
+  bool has_cycle_{false};
+  unsigned int cycles_since_keyframe_{0};
+  uint64_t update_count_{0};
+  unsigned int size_x_{0}, size_y_{0};
+  double resolution_{0.0}, origin_x_{0.0}, origin_y_{0.0};
+  std::vector<LayeredCostmap::ChangedWindow> windows_;
+  std::vector<uint8_t> payload_, encoded_;
+
+  std::thread thread_;
+};
+
+/**
+ * @class CostmapRecordReader
+ * @brief Reads the records of a recording in order, rebuilding the master costmap of its
+ * cycles from their keyframes and changed windows
+ */
+class CostmapRecordReader
+{
+public:
+  /**
+   * @brief A constructor, opening the recording
+   * @param path File of the recording
+   */
+  explicit CostmapRecordReader(const std::string & path);
+
+  /**
+   * @brief Whether the file is a recording, with a valid magic and version
+   */
+  bool isOpen() const
+  {
+    return open_;
+  }
+
+  /**
+   * @brief Read the next record
+   * @param record Record read
+   * @return False at the end of the recording, or if the record is truncated or malformed,
+   *         see failed()
+   */
+  bool next(CostmapRecord & record);
+
+  /**
+   * @brief Whether reading stopped on a truncated or malformed record rather than at the end
+   */
+  bool failed() const
+  {
+    return failed_;
+  }
+
+  /**
+   * @brief Get the master costmap as of the last cycle read
+   */
+  const Costmap2D & getCostmap() const
+  {
+    return costmap_;
+  }
+
+  /**
+   * @brief Get the sources read so far, by identifier
+   */
+  const std::unordered_map<uint32_t, RecordedSource> & getSources() const
+  {
+    return sources_;
+  }
+
+protected:
+  /**
+   * @brief Parse the payload of a record
+   * @return False if it is malformed
+   */
+  bool parse(CostmapRecord & record);
+
+  std::ifstream file_;
+  bool open_{false};
+  bool failed_{false};
+  std::vector<uint8_t> payload_, window_;
+  Costmap2D costmap_;
+  bool has_costmap_{false};
+  std::unordered_map<uint32_t, RecordedSource> sources_;
+};
+
+}  // namespace nav2_costmap_2d
+
+#endif  // NAV2_COSTMAP_2D__COSTMAP_RECORDER_HPP_
@@ -0,0 +1,86 @@
+// Copyright (c) 2022 Samsung Research America
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef NAV2_COSTMAP_2D__COSTMAP_REGISTRY_HPP_
+#define NAV2_COSTMAP_2D__COSTMAP_REGISTRY_HPP_
+
+#include <cstdint>
+#include <functional>
+#include <map>
+#include <mutex>
+#include <string>
+
+#include "nav2_costmap_2d/layered_costmap.hpp"
+
+namespace nav2_costmap_2d
+{
+
+/**
+ * @class nav2_costmap_2d::CostmapRegistry
+ * @brief Process wide registry of the master costmaps of the active costmaps, by the
+ * resolved name of the topic their raw costmap is published on. Subscribers of that topic
+ * in the same process, such as servers composed in one container, may read the master
+ * costmap directly instead of receiving and deserializing its messages.
+ */
+class CostmapRegistry
+{
+public:
+  /**
+   * @brief Get the registry of the process
+   */
+  static CostmapRegistry & getInstance();
+
+  /**
+   * @brief Register a master costmap, until removed
+   * @param topic_name Resolved name of the raw costmap topic
+   * @param layered_costmap Costmap, outliving its registration
+   */
+  void add(const std::string & topic_name, LayeredCostmap * layered_costmap);
+
+  /**
+   * @brief Unregister a master costmap, waiting for the functions accessing it to return
+   * @param topic_name Resolved name of the raw costmap topic
+   * @param layered_costmap Costmap, left registered if another one replaced it
+   */
+  void remove(const std::string & topic_name, const LayeredCostmap * layered_costmap);
+
+  /**
+   * @brief Call a function on a registered master costmap, which is not unregistered
+   * while it runs. The function is given the costmap and the number of its registration,
+   * which differs between registrations, even of a costmap at the same address.
+   * @param topic_name Resolved name of the raw costmap topic
+   * @param function Function to call
+   * @return False if no costmap is registered for the topic
+   */
+  bool access(
+    const std::string & topic_name,
+    const std::function<void(LayeredCostmap &, uint64_t)> & function);
+
+protected:
+  CostmapRegistry() = default;
+
+  struct Registration
+  {
+    LayeredCostmap * layered_costmap;
+    uint64_t number;
+  };
+
+  std::mutex mutex_;
+  std::map<std::string, Registration> costmaps_;
+  uint64_t registrations_{0};
+};
+
+}  // namespace nav2_costmap_2d
+
+#endif  // NAV2_COSTMAP_2D__COSTMAP_REGISTRY_HPP_
@@ -0,0 +1,104 @@
+// Copyright (c) 2022 Samsung Research America
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+
+#ifndef NAV2_COSTMAP_2D__COSTMAP_REPLAY_HPP_
+#define NAV2_COSTMAP_2D__COSTMAP_REPLAY_HPP_
+
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <list>
+#include <memory>
+#include <unordered_map>
+
+#include "nav2_costmap_2d/costmap_recorder.hpp"
+#include "nav2_costmap_2d/layered_costmap.hpp"
+#include "nav2_costmap_2d/obstacle_layer.hpp"
+
+namespace nav2_costmap_2d
+{
+
+/**
+ * @struct ReplayStatistics
+ * @brief Statistics of a replay
+ */
+struct ReplayStatistics
+{
+  size_t cycles{0};
+  size_t observations{0};
+  size_t mismatched_cycles{0};  ///< Cycles replayed to a master costmap other than recorded
+  double update_time{0.0};      ///< Total time of the updates, in seconds
+  double max_update_time{0.0};  ///< Longest update, in seconds
+};
+
+/**
+ * @class CostmapReplay
+ * @brief Replays a recording through a layered costmap configured as the one recorded. The
+ * observations recorded are fed to the obstacle layers of the same names as static
+ * observations, kept as long as their buffers kept them, and the costmap is updated at the
+ * robot pose of each cycle, so that the updates are reproduced deterministically for
+ * profiling. Layers of other types are updated from their own inputs, if any.
+ */
+class CostmapReplay
+{
+public:
+  /**
+   * @brief Callback of each cycle replayed, with the cycle and the master costmap recorded
+   * for it, e.g. to run planners on
+   */
+  using CycleCallback = std::function<void (const RecordedCycle &, const Costmap2D &)>;
+
+  /**
+   * @brief A constructor
+   * @param layered_costmap The costmap to replay through, with its plugins initialized
+   */
+  explicit CostmapReplay(LayeredCostmap & layered_costmap);
+
+  /**
+   * @brief Replay the records left of a recording
+   * @param reader Reader of the recording
+   * @param statistics Statistics of the replay, added to
+   * @param callback Callback of each cycle, after its update, if any
+   * @return False if the recording ended on a truncated or malformed record
+   */
+  bool replay(
+    CostmapRecordReader & reader, ReplayStatistics & statistics,
+    const CycleCallback & callback = nullptr);
+
+protected:
+  /**
+   * @struct ReplayedSource
+   * @brief A source of the recording, with its observations kept, the newest first
+   */
+  struct ReplayedSource
+  {
+    RecordedSource source;
+    std::shared_ptr<ObstacleLayer> layer;
+    std::list<Observation> observations;
+  };
+
+  /**
+   * @brief Feed the observations of the sources kept at a cycle to their layers
+   * @param stamp_ns Time of the cycle
+   */
+  void feedObservations(int64_t stamp_ns);
+
+  LayeredCostmap & layered_costmap_;
+  std::unordered_map<uint32_t, ReplayedSource> sources_;
+};
+
+}  // namespace nav2_costmap_2d
+
+#endif  // NAV2_COSTMAP_2D__COSTMAP_REPLAY_HPP_
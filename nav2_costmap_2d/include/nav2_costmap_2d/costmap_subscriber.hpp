@@ -15,36 +15,64 @@
 #ifndef NAV2_COSTMAP_2D__COSTMAP_SUBSCRIBER_HPP_
 #define NAV2_COSTMAP_2D__COSTMAP_SUBSCRIBER_HPP_
 
+#include <deque>
 #include <string>
 #include <memory>
+#include <mutex>
+#include <vector>
 
 #include "rclcpp/rclcpp.hpp"
 #include "nav2_costmap_2d/costmap_2d.hpp"
+#include "nav2_costmap_2d/costmap_pyramid.hpp"
+#include "nav2_costmap_2d/layered_costmap.hpp"
+#include "nav2_costmap_2d/shared_memory_costmap.hpp"
 #include "nav2_msgs/msg/costmap.hpp"
+#include "nav2_msgs/msg/costmap_update.hpp"
+#include "nav2_msgs/msg/compressed_costmap.hpp"
+#include "std_srvs/srv/empty.hpp"
 #include "nav2_util/lifecycle_node.hpp"
 
 namespace nav2_costmap_2d
 {
 /**
  * @class CostmapSubscriber
- * @brief Subscribes to the costmap via a ros topic
+ * @brief Subscribes to the costmap via a ros topic, and to the updates of
+ *        its changed windows published in between full costmaps. The costmap
+ *        may instead be received compressed, from the <topic_name>_compressed
+ *        and <topic_name>_compressed_updates topics, or read from the master
+ *        costmap publishing it when in the same process, or from its shared
+ *        memory export
  */
 class CostmapSubscriber
 {
 public:
+  /**
+   * @brief A window of cells of the costmap changed by an update
+   */
+  struct ChangedWindow
+  {
+    uint64_t revision;
+    unsigned int x0, y0;
+    unsigned int xn, yn;  // Exclusive
+  };
+
   /**
    * @brief A constructor
+   * @param compressed Whether to subscribe to the compressed costmap topics
    */
   CostmapSubscriber(
     const nav2_util::LifecycleNode::WeakPtr & parent,
-    const std::string & topic_name);
+    const std::string & topic_name,
+    bool compressed = false);
 
   /**
    * @brief A constructor
+   * @param compressed Whether to subscribe to the compressed costmap topics
    */
   CostmapSubscriber(
     const rclcpp::Node::WeakPtr & parent,
-    const std::string & topic_name);
+    const std::string & topic_name,
+    bool compressed = false);
 
   /**
    * @brief A destructor
@@ -57,20 +85,138 @@ public:
   std::shared_ptr<Costmap2D> getCostmap();
 
   /**
-   * @brief Convert an occ grid message into a costmap object
+   * @brief Set whether to read the costmap from the master costmap publishing the topic
+   *        when it is active in the same process, e.g. composed in the same container,
+   *        copying the windows changed since the last call to getCostmap() instead of
+   *        deserializing the messages. The topics are used otherwise.
+   * @param enable Whether to read the costmap in process
+   */
+  void setInProcess(bool enable);
+
+  /**
+   * @brief Set whether to read the costmap from the shared memory export of the master
+   *        costmap publishing the topic, when it exports one on this host, mapping it
+   *        read-only and copying it once changed instead of deserializing the messages.
+   *        The topics are used otherwise, or while the export is stale.
+   * @param enable Whether to read the costmap from shared memory
+   * @param timeout Time in seconds without update of the master costmap after which its
+   *        export is stale, or 0 for it never to be
+   */
+  void setSharedMemory(bool enable, double timeout = 0.0);
+
+  /**
+   * @brief Set the number of coarse levels of the costmap kept up to date with it,
+   *        as windows of updates are applied
+   * @param levels Number of levels, with downsampling factors 2, 4, ..., 2^levels, 0 to disable
+   */
+  void setPyramidLevels(unsigned int levels);
+
+  /**
+   * @brief Get the coarse levels of the costmap, as of the last call to getCostmap()
+   */
+  const CostmapPyramid & getCostmapPyramid()
+  {
+    return pyramid_;
+  }
+
+  /**
+   * @brief Get the revision of the costmap, as of the last call to getCostmap(). It is
+   *        increased by every full costmap and update converted.
+   */
+  uint64_t getRevision();
+
+  /**
+   * @brief Get the windows of cells changed since a revision of the costmap, up to the
+   *        last call to getCostmap()
+   * @param revision Revision to get the changes since
+   * @param windows Windows changed since the revision, in order
+   * @return False if the whole costmap may have changed since the revision, e.g. because a
+   *         full costmap was received since, or the revision is too old
+   */
+  bool getChangedWindows(uint64_t revision, std::vector<ChangedWindow> & windows);
+
+  /**
+   * @brief Convert the last full costmap message received into a costmap object,
+   *        if not yet converted, and apply the updates received since
    */
   void toCostmap2D();
   /**
    * @brief Callback for the costmap topic
    */
   void costmapCallback(const nav2_msgs::msg::Costmap::SharedPtr msg);
+  /**
+   * @brief Callback for the costmap updates topic. Updates are applied in the order
+   *        they are numbered, past a lost one the publisher is requested a full costmap
+   */
+  void costmapUpdateCallback(const nav2_msgs::msg::CostmapUpdate::SharedPtr update_msg);
+  /**
+   * @brief Callback for the compressed costmap topic, decoding the full costmap
+   */
+  void compressedCostmapCallback(const nav2_msgs::msg::CompressedCostmap::SharedPtr msg);
+  /**
+   * @brief Callback for the compressed costmap updates topic, decoding the update
+   */
+  void compressedCostmapUpdateCallback(
+    const nav2_msgs::msg::CompressedCostmap::SharedPtr update_msg);
 
 protected:
+  /** @brief Create the subscriptions to the costmap and updates topics. */
+  template<typename NodeT>
+  void createSubscriptions(const NodeT & node, bool compressed);
+
+  /**
+   * @brief Copy the master costmap publishing the topic in this process, if any
+   * @return False if there is none, or it was not updated yet
+   */
+  bool copyInProcessCostmap();
+
+  /**
+   * @brief Copy the shared memory export of the master costmap publishing the topic, if any
+   * @return False if there is none, or it was not written yet
+   */
+  bool copySharedMemoryCostmap();
+
+  /**
+   * @brief Request a full costmap from the publisher of the topic, as updates were lost
+   */
+  void requestFullCostmap();
+
   std::shared_ptr<Costmap2D> costmap_;
+  CostmapPyramid pyramid_;
   nav2_msgs::msg::Costmap::SharedPtr costmap_msg_;
+  // Updates received since the costmap was last converted, applied in order,
+  // past this many the costmap is converted again from the full costmap
+  std::vector<nav2_msgs::msg::CostmapUpdate::SharedPtr> costmap_update_msgs_;
+  static constexpr size_t max_pending_updates_ = 16;
+  bool costmap_msg_converted_{false};
+  // Revision of the costmap, of the last full costmap converted, and the windows
+  // changed by the updates converted since, up to a number of them
+  uint64_t revision_{0};
+  uint64_t full_revision_{0};
+  std::deque<ChangedWindow> changed_windows_;
+  static constexpr size_t max_changed_windows_ = 64;
+  std::mutex msg_mutex_;
   std::string topic_name_;
+  // Resolved name of the topic, and the registration and update count of the master
+  // costmap last copied in process, 0 when none was
+  std::string resolved_topic_name_;
+  bool in_process_{false};
+  uint64_t in_process_registration_{0};
+  uint64_t in_process_update_count_{0};
+  std::vector<LayeredCostmap::ChangedWindow> in_process_windows_;
+  std::unique_ptr<SharedMemoryCostmapReader> shared_memory_reader_;
+  double shared_memory_timeout_{0.0};
   bool costmap_received_{false};
   rclcpp::Subscription<nav2_msgs::msg::Costmap>::SharedPtr costmap_sub_;
+  rclcpp::Subscription<nav2_msgs::msg::CostmapUpdate>::SharedPtr costmap_update_sub_;
+  rclcpp::Subscription<nav2_msgs::msg::CompressedCostmap>::SharedPtr compressed_costmap_sub_;
+  rclcpp::Subscription<nav2_msgs::msg::CompressedCostmap>::SharedPtr
+    compressed_costmap_update_sub_;
+  // Number of the last update applied on the full costmap, and whether a full costmap
+  // was requested since updates were lost
+  uint64_t update_sequence_{0};
+  bool resync_requested_{false};
+  rclcpp::Client<std_srvs::srv::Empty>::SharedPtr resync_client_;
 };
 
 }  // namespace nav2_costmap_2d
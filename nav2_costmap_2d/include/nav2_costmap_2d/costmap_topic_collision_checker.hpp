@@ -21,6 +21,7 @@
 #include <vector>
 #include <memory>
 #include <algorithm>
+#include <mutex>
 
 #include "rclcpp/rclcpp.hpp"
 #include "geometry_msgs/msg/pose_stamped.hpp"
@@ -35,11 +36,40 @@ namespace nav2_costmap_2d
 /**
  * @class CostmapTopicCollisionChecker
  * @brief Using a costmap via a ros topic, this object is used to
- * find if robot poses are in collision with the costmap environment
+ * find if robot poses are in collision with the costmap environment.
+ * It can be shared between threads, each check holding the costmap and footprint
+ * snapshot it fetched, or the last one fetched if it does not fetch them
  */
 class CostmapTopicCollisionChecker
 {
 public:
+  /**
+   * @brief The poses of a maneuver, with the costmap cells under the outline of the
+   * footprint at each of them, rasterized once. Only the cells in the windows of the
+   * costmap updates are checked again as the maneuver goes on.
+   */
+  struct Maneuver
+  {
+    std::vector<geometry_msgs::msg::Pose2D> poses;
+    Footprint footprint;
+
+    // Geometry of the costmap the cells were rasterized in
+    unsigned int size_x{0};
+    unsigned int size_y{0};
+    double resolution{0.0};
+    double origin_x{0.0};
+    double origin_y{0.0};
+
+    // Cells under the footprint, in increasing index order, the poses over each of them,
+    // and whether they are lethal as of the costmap revision last checked
+    std::vector<unsigned int> cells;
+    std::vector<std::vector<unsigned int>> cell_poses;
+    std::vector<bool> cell_lethal;
+    // Number of lethal cells under the footprint at each pose, or 1 if it leaves the costmap
+    std::vector<unsigned int> pose_lethal_cells;
+    uint64_t revision{0};
+  };
+
   /**
    * @brief A constructor
    */
@@ -75,7 +105,80 @@ public:
     const geometry_msgs::msg::Pose2D & pose,
     bool fetch_costmap_and_footprint = true);
 
+  /**
+   * @brief Returns the first pose of a trajectory in collision. The costmap and footprint
+   * are fetched once for the whole trajectory. If the costmap subscriber keeps coarse levels
+   * of the costmap, poses whose footprint only covers coarse cells below lethal cost are
+   * accepted without scoring their footprint.
+   *
+   * @param poses Poses of the trajectory, in order
+   * @param fetch_costmap_and_footprint Defaults to true. Whether to fetch the latest costmap and
+   * footprint before checking the trajectory
+   * @return Index of the first pose in collision, or -1 if all poses are collision free
+   */
+  int findFirstCollision(
+    const std::vector<geometry_msgs::msg::Pose2D> & poses,
+    bool fetch_costmap_and_footprint = true);
+
+  /**
+   * @brief Prepare the check of a maneuver, rasterizing the footprint at each of its poses
+   * in the latest costmap, with the latest footprint
+   *
+   * @param poses Poses of the maneuver, in order
+   * @param maneuver Maneuver to prepare
+   * @return False if the costmap or footprint is not available
+   */
+  bool prepareManeuver(
+    const std::vector<geometry_msgs::msg::Pose2D> & poses,
+    Maneuver & maneuver);
+
+  /**
+   * @brief Returns the first pose of a part of a prepared maneuver in collision with the
+   * latest costmap. Only the cells changed since the last check of the maneuver are
+   * checked, unless the costmap was replaced or moved since.
+   *
+   * @param maneuver Maneuver prepared with prepareManeuver()
+   * @param first Index of the first pose to check
+   * @param last Index past the last pose to check
+   * @return Index of the first pose in collision, or -1 if these poses are collision free
+   */
+  int findFirstCollision(Maneuver & maneuver, size_t first, size_t last);
+
 protected:
+  /**
+   * @brief Rasterize the footprint of the maneuver at each of its poses in the costmap
+   * fetched last, and check all of its cells
+   */
+  void rasterizeManeuver(Maneuver & maneuver);
+
+  /**
+   * @brief Check again cells of a maneuver in the costmap fetched last
+   *
+   * @param maneuver Maneuver to check the cells of
+   * @param begin Index of the first cell in maneuver.cells to check
+   * @param end Index past the last cell to check
+   */
+  void checkManeuverCells(Maneuver & maneuver, size_t begin, size_t end);
+
+  /**
+   * @brief Fetch the latest costmap and footprint
+   */
+  void fetchCostmapAndFootprint();
+
+  /**
+   * @brief Fetch the latest footprint, in the robot frame
+   */
+  void fetchFootprint();
+
+  /**
+   * @brief Whether all cells around a pose, within the footprint radius, are below lethal
+   * cost in a coarse level of the costmap
+   *
+   * @param pose Pose to check around
+   * @return True if the footprint is collision free at the pose, false if it is unknown
+   */
+  bool isCoarselyCollisionFree(const geometry_msgs::msg::Pose2D & pose);
+
   /**
    * @brief Get a footprint at a set pose
    *
@@ -94,6 +197,10 @@ protected:
   FootprintCollisionChecker<std::shared_ptr<Costmap2D>> collision_checker_;
   rclcpp::Clock::SharedPtr clock_;
   Footprint footprint_;
+  // Distance of the furthest footprint point from the robot
+  double footprint_radius_{0.0};
+  // Held by each check, recursive as some checks are made of others
+  std::recursive_mutex mutex_;
 };
 
 }  // namespace nav2_costmap_2d
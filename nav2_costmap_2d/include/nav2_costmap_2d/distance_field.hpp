@@ -0,0 +1,174 @@
+// Copyright (c) 2022 Samsung Research America
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef NAV2_COSTMAP_2D__DISTANCE_FIELD_HPP_
+#define NAV2_COSTMAP_2D__DISTANCE_FIELD_HPP_
+
+#include <vector>
+
+#include "nav2_costmap_2d/costmap_2d.hpp"
+
+namespace nav2_costmap_2d
+{
+
+/**
+ * @class DistanceField
+ * @brief Euclidean signed distance field of the lethal cells of a costmap, kept up to date
+ * with the window of each update, so that the clearance of a pose is read from a cell rather
+ * than inferred from inflated costs. Free cells, including unknown ones, hold the distance
+ * from their center to that of the nearest lethal cell, and lethal cells the negated distance
+ * to the nearest free cell. Distances are truncated to a maximum distance, which bounds the
+ * cells an update can change to those within it of the updated window.
+ */
+class DistanceField
+{
+public:
+  /**
+   * @brief Set the distance the field is truncated to, 0 to disable the field
+   * @param max_distance Maximum distance, in meters
+   */
+  void setMaxDistance(double max_distance);
+
+  /**
+   * @brief Get the distance the field is truncated to, in meters, 0 if disabled
+   */
+  double getMaxDistance() const
+  {
+    return max_distance_;
+  }
+
+  /**
+   * @brief Whether the field is enabled
+   */
+  bool isEnabled() const
+  {
+    return max_distance_ > 0.0;
+  }
+
+  /**
+   * @brief Update the field after a change of a window of the costmap. The whole field is
+   * recomputed instead if the size, resolution or origin of the costmap changed, or after
+   * invalidate().
+   * @param costmap Costmap the field is computed from
+   * @param x0 Window start x, in cells of the costmap
+   * @param y0 Window start y, in cells of the costmap
+   * @param xn Window end x (exclusive), in cells of the costmap
+   * @param yn Window end y (exclusive), in cells of the costmap
+   */
+  void update(
+    const Costmap2D & costmap,
+    unsigned int x0, unsigned int y0, unsigned int xn, unsigned int yn);
+
+  /**
+   * @brief Have the next update recompute the whole field, after a change of the costmap
+   * whose cells are not known, e.g. a reset
+   */
+  void invalidate()
+  {
+    full_update_ = true;
+  }
+
+  /**
+   * @brief Get the size of the field in cells, that of the costmap after its first update
+   */
+  unsigned int getSizeInCellsX() const
+  {
+    return size_x_;
+  }
+
+  unsigned int getSizeInCellsY() const
+  {
+    return size_y_;
+  }
+
+  /**
+   * @brief Get the signed distance of a cell. Readers must hold the mutex of the costmap,
+   * as the field is updated along with it.
+   * @param mx Cell x, in cells of the costmap
+   * @param my Cell y, in cells of the costmap
+   * @return Distance in meters, negative in lethal cells
+   */
+  float getDistance(unsigned int mx, unsigned int my) const
+  {
+    return distances_[my * size_x_ + mx];
+  }
+
+  /**
+   * @brief Get the signed distance at a point, interpolated between the centers of the
+   * cells around it
+   * @param wx Point x, in the frame of the costmap
+   * @param wy Point y, in the frame of the costmap
+   * @param distance Distance in meters, negative in lethal cells
+   * @return False if the point is outside the field
+   */
+  bool getDistance(double wx, double wy, float & distance) const;
+
+  /**
+   * @brief Get the signed distance at a point and its gradient, pointing away from the
+   * nearest lethal cells, of the distance interpolated between the centers of the cells
+   * around it. The gradient is zero where the distance is truncated.
+   * @param wx Point x, in the frame of the costmap
+   * @param wy Point y, in the frame of the costmap
+   * @param distance Distance in meters, negative in lethal cells
+   * @param gradient_x X component of the gradient
+   * @param gradient_y Y component of the gradient
+   * @return False if the point is outside the field
+   */
+  bool getDistanceAndGradient(
+    double wx, double wy, float & distance, float & gradient_x, float & gradient_y) const;
+
+protected:
+  /**
+   * @brief Get the interpolation cells of a point and its offsets from the first of them
+   * @return False if the point is outside the field
+   */
+  bool getInterpolation(
+    double wx, double wy, unsigned int & mx, unsigned int & my,
+    float & tx, float & ty) const;
+
+  /**
+   * @brief Recompute the distances of a window of cells, from the lethal and free cells
+   * within the maximum distance of it
+   */
+  void computeWindow(
+    const Costmap2D & costmap,
+    unsigned int x0, unsigned int y0, unsigned int xn, unsigned int yn);
+
+  /**
+   * @brief Compute the squared distances to the nearest zero of a sampled function with the
+   * lower envelope of the parabolas rooted at its samples, by Felzenszwalb and Huttenlocher
+   * @param f Squared distances along a line, at most the same cap at all samples
+   * @param d Squared distances to the nearest zero, capped likewise
+   * @param n Number of samples
+   */
+  void transformLine(const float * f, float * d, unsigned int n);
+
+  std::vector<float> distances_;
+  unsigned int size_x_{0};
+  unsigned int size_y_{0};
+  double resolution_{0.0};
+  double origin_x_{0.0};
+  double origin_y_{0.0};
+  double max_distance_{0.0};
+  bool full_update_{true};
+
+  // Scratch buffers of the transforms, kept between updates
+  std::vector<float> lethal_distances_, free_distances_, line_, transformed_;
+  std::vector<unsigned int> envelope_roots_;
+  std::vector<double> envelope_bounds_;
+};
+
+}  // namespace nav2_costmap_2d
+
+#endif  // NAV2_COSTMAP_2D__DISTANCE_FIELD_HPP_
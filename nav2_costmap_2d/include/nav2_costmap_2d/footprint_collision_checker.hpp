@@ -21,11 +21,13 @@
 #include <vector>
 #include <memory>
 #include <algorithm>
+#include <utility>
 
 #include "rclcpp/rclcpp.hpp"
 #include "geometry_msgs/msg/pose_stamped.hpp"
 #include "geometry_msgs/msg/pose2_d.hpp"
 #include "nav2_costmap_2d/costmap_2d.hpp"
+#include "nav2_costmap_2d/costmap_pyramid.hpp"
 #include "nav2_util/robot_utils.hpp"
 
 namespace nav2_costmap_2d
@@ -56,6 +58,52 @@ public:
    * @brief Find the footprint cost a a post with an unoriented footprint
    */
   double footprintCostAtPose(double x, double y, double theta, const Footprint footprint);
+  /**
+   * @brief Precompute the cells covered by a footprint at discretized headings, for
+   * footprintRasterCostAtPose(). The cells are those of the footprint at the center of
+   * a cell, so that costs of poses elsewhere in the cell, or between headings, are those
+   * of the nearest raster. Rasters follow changes of the costmap resolution.
+   * @param footprint Footprint to rasterize, unoriented
+   * @param num_headings Number of headings evenly spaced over a full turn
+   * @param include_interior Whether to rasterize the cells inside the footprint, rather
+   * than only its outline as footprintCostAtPose() does
+   */
+  void setFootprintRaster(
+    const Footprint & footprint, unsigned int num_headings, bool include_interior = false);
+  /**
+   * @brief Find the cost of the footprint set by setFootprintRaster() at a pose, with the
+   * raster of the nearest heading. Lethal if no raster was set, or if it leaves the costmap.
+   */
+  double footprintRasterCostAtPose(double x, double y, double theta);
+  /**
+   * @brief Get the cells of the raster set by setFootprintRaster() at the heading nearest
+   * to theta, as offsets from the cell of the pose sorted in row-major order
+   * @return Cells of the raster, empty if no raster was set
+   */
+  const std::vector<std::pair<int, int>> & getFootprintRaster(double theta);
+  /**
+   * @brief Find the raster cost of the footprint at many poses
+   * @param poses Poses to check
+   * @param costs Footprint cost at each pose, resized to the number of poses
+   */
+  void footprintRasterCostsAtPoses(
+    const std::vector<geometry_msgs::msg::Pose2D> & poses, std::vector<double> & costs);
+  /**
+   * @brief Find the first of a sweep of poses at which the footprint costs at least a cost.
+   * With a costmap pyramid set, the sweep is searched in runs of growing size. The footprints
+   * of a run are bounded together and runs whose bounds cost less are skipped without tracing
+   * any outline. Other runs are split in halves, down to footprintCostAtPose() for single
+   * poses, so that a sweep over free space only takes a few pyramid queries.
+   * @param poses Poses of the sweep, in order
+   * @param footprint Footprint to check, unoriented
+   * @param cost Footprint cost to find
+   * @param start Index of the first pose to check
+   * @return Index of the first pose from start at which the footprint costs at least cost,
+   * or the number of poses if there is none
+   */
+  size_t findFootprintCostAtPoses(
+    const std::vector<geometry_msgs::msg::Pose2D> & poses, const Footprint & footprint,
+    double cost, size_t start = 0);
   /**
    * @brief Get the cost for a line segment
    */
@@ -79,9 +127,69 @@ public:
   {
     return costmap_;
   }
+  /**
+  * @brief Set a pyramid kept up to date with the costmap, for footprintCost() to find
+  * footprints over free space from the maximum cost of their bounds, without tracing
+  * their outline. Callers must hold the mutex of the costmap while checking footprints.
+  * @param pyramid Pyramid of the costmap, or nullptr to trace every footprint
+  */
+  void setCostmapPyramid(const CostmapPyramid * pyramid)
+  {
+    costmap_pyramid_ = pyramid;
+  }
 
 protected:
+  /**
+   * @struct FootprintRaster
+   * @brief Cells covered by the footprint at one heading, as offsets from the cell of the
+   * pose sorted in row-major order, and their bounds
+   */
+  struct FootprintRaster
+  {
+    std::vector<std::pair<int, int>> cells;
+    int min_x{0}, min_y{0}, max_x{0}, max_y{0};
+  };
+
+  /**
+   * @brief Rasterize the footprint at each heading, at the current costmap resolution
+   */
+  void computeFootprintRasters();
+
+  /**
+   * @brief Get the index of the raster nearest to a heading
+   */
+  unsigned int getRasterHeading(double theta) const;
+
+  /**
+   * @struct CellBounds
+   * @brief Cell bounds of the footprint at a pose, invalid if it leaves the costmap
+   */
+  struct CellBounds
+  {
+    unsigned int min_x, min_y, max_x, max_y;
+    bool valid;
+  };
+
+  /**
+   * @brief Find the first pose of a run of the sweep at which the footprint costs at
+   * least a cost, bounding the run before splitting it
+   * @return Index of the pose, or end if there is none
+   */
+  size_t findFootprintCostInRun(
+    const std::vector<geometry_msgs::msg::Pose2D> & poses, const Footprint & footprint,
+    double cost, size_t begin, size_t end);
+
   CostmapT costmap_;
+  const CostmapPyramid * costmap_pyramid_{nullptr};
+
+  Footprint raster_footprint_;
+  unsigned int raster_headings_{0};
+  bool raster_interior_{false};
+  double raster_resolution_{0.0};
+  std::vector<FootprintRaster> rasters_;
+
+  // Bounds of the footprint at each pose of the current sweep
+  std::vector<CellBounds> sweep_bounds_;
 };
 
 }  // namespace nav2_costmap_2d
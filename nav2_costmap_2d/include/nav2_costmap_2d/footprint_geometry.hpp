@@ -0,0 +1,88 @@
+// Copyright (c) 2022 Samsung Research America
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef NAV2_COSTMAP_2D__FOOTPRINT_GEOMETRY_HPP_
+#define NAV2_COSTMAP_2D__FOOTPRINT_GEOMETRY_HPP_
+
+#include <cstdint>
+#include <map>
+#include <mutex>
+#include <vector>
+
+#include "geometry_msgs/msg/point.hpp"
+
+namespace nav2_costmap_2d
+{
+
+/**
+ * @class nav2_costmap_2d::FootprintGeometry
+ * @brief A footprint with its derived geometry, shared by its consumers so that it is
+ * computed once per footprint. Each footprint gets a new version, unique across the
+ * process, so that consumers caching data derived from it only rebuild it when the
+ * version changes rather than comparing footprints. The footprint is set once, and the
+ * oriented footprints are computed on first request, so it can be shared between threads.
+ */
+class FootprintGeometry
+{
+public:
+  /**
+   * @brief A constructor for nav2_costmap_2d::FootprintGeometry
+   * @param footprint Footprint of the robot, unoriented
+   */
+  explicit FootprintGeometry(const std::vector<geometry_msgs::msg::Point> & footprint);
+
+  /**
+   * @brief Get the version of the footprint, never 0
+   */
+  uint64_t getVersion() const {return version_;}
+
+  /**
+   * @brief Get the footprint, unoriented
+   */
+  const std::vector<geometry_msgs::msg::Point> & getFootprint() const {return footprint_;}
+
+  /**
+   * @brief Get the radius of the largest circle centered on the robot within the footprint
+   */
+  double getInscribedRadius() const {return inscribed_radius_;}
+
+  /**
+   * @brief Get the radius of the smallest circle centered on the robot around the footprint
+   */
+  double getCircumscribedRadius() const {return circumscribed_radius_;}
+
+  /**
+   * @brief Get the footprint oriented at regular headings, the i-th at i * 2 * pi / num_angles
+   * rounded to float as the angle bins of the planners. They are computed on the first
+   * request for each number of headings, and kept as long as the footprint.
+   * @param num_angles Number of headings
+   * @return Oriented footprints, one per heading
+   */
+  const std::vector<std::vector<geometry_msgs::msg::Point>> & getOrientedFootprints(
+    unsigned int num_angles) const;
+
+private:
+  uint64_t version_;
+  std::vector<geometry_msgs::msg::Point> footprint_;
+  double inscribed_radius_{0.0};
+  double circumscribed_radius_{0.0};
+
+  mutable std::mutex mutex_;
+  mutable std::map<unsigned int, std::vector<std::vector<geometry_msgs::msg::Point>>>
+  oriented_footprints_;
+};
+
+}  // namespace nav2_costmap_2d
+
+#endif  // NAV2_COSTMAP_2D__FOOTPRINT_GEOMETRY_HPP_
@@ -38,6 +38,7 @@
 #ifndef NAV2_COSTMAP_2D__INFLATION_LAYER_HPP_
 #define NAV2_COSTMAP_2D__INFLATION_LAYER_HPP_
 
+#include <cstdint>
 #include <map>
 #include <vector>
 #include <mutex>
@@ -45,6 +46,7 @@
 #include "rclcpp/rclcpp.hpp"
 #include "nav2_costmap_2d/layer.hpp"
 #include "nav2_costmap_2d/layered_costmap.hpp"
+#include "nav2_costmap_2d/visitation_map.hpp"
 
 namespace nav2_costmap_2d
 {
@@ -123,11 +125,59 @@ public:
     nav2_costmap_2d::Costmap2D & master_grid,
     int min_i, int min_j, int max_i, int max_j) override;
 
+  /**
+   * @brief If the layer supports tiled updates, see Layer::isTileSafe(). Incremental
+   * inflation keeps its own state across the map and the distance transform parallelizes
+   * its own passes, so both are updated over the whole window.
+   */
+  bool isTileSafe() override {return !incremental_inflation_ && !use_distance_transform_;}
+
+  /**
+   * @brief Get the number of cells beyond a tile read for its inflation, the inflation radius
+   */
+  unsigned int getTileHalo() override {return cell_inflation_radius_;}
+
+  /**
+   * @brief Lock the layer before inflating tiles of the window
+   * @param master_grid The master costmap grid to update
+   * @param min_i X min map coord of the window to update
+   * @param min_j Y min map coord of the window to update
+   * @param max_i X max map coord of the window to update
+   * @param max_j Y max map coord of the window to update
+   */
+  void beginTiledUpdate(
+    nav2_costmap_2d::Costmap2D & master_grid,
+    int min_i, int min_j, int max_i, int max_j) override;
+
+  /**
+   * @brief Inflate obstacles within the inflation radius of a tile into the tile,
+   * using scratch space local to the calling thread
+   * @param master_grid The master costmap grid to update
+   * @param min_i X min map coord of the tile to update
+   * @param min_j Y min map coord of the tile to update
+   * @param max_i X max map coord of the tile to update
+   * @param max_j Y max map coord of the tile to update
+   */
+  void updateCostsTile(
+    nav2_costmap_2d::Costmap2D & master_grid,
+    int min_i, int min_j, int max_i, int max_j) override;
+
+  /**
+   * @brief Unlock the layer after all tiles of the window were inflated
+   */
+  void endTiledUpdate() override;
+
   /**
    * @brief Match the size of the master costmap
    */
   void matchSize() override;
 
+  /**
+   * @brief Get the bytes of memory owned by the layer, its caches and the grids of its
+   * incremental inflation and distance transform
+   */
+  size_t getMemoryUsage() override;
+
   /**
    * @brief If clearing operations should be processed on this layer or not
    */
@@ -236,7 +286,60 @@ private:
    */
   inline void enqueue(
     unsigned int index, unsigned int mx, unsigned int my,
-    unsigned int src_x, unsigned int src_y);
+    unsigned int src_x, unsigned int src_y,
+    const VisitationMap & seen,
+    std::vector<std::vector<CellData>> & inflation_cells);
+
+  /**
+   * @brief Inflate the obstacles within the inflation radius of a window into the window
+   * @param seen Visited cells of the master grid, cleared for the inflation
+   * @param inflation_cells Bins of cells by distance, empty and sized to the distance levels
+   */
+  void inflate(
+    nav2_costmap_2d::Costmap2D & master_grid,
+    int min_i, int min_j, int max_i, int max_j,
+    VisitationMap & seen,
+    std::vector<std::vector<CellData>> & inflation_cells);
+
+  /**
+   * @brief Update the window from the inflated costs kept across updates, re-inflating
+   * only the blocks of the map near obstacles added or removed since they were inflated
+   * @param master_grid The master costmap grid to update
+   * @param min_i X min map coord of the window to update
+   * @param min_j Y min map coord of the window to update
+   * @param max_i X max map coord of the window to update
+   * @param max_j Y max map coord of the window to update
+   */
+  void updateCostsIncremental(
+    nav2_costmap_2d::Costmap2D & master_grid,
+    int min_i, int min_j, int max_i, int max_j);
+
+  /**
+   * @brief Inflate the window from an exact Euclidean distance transform of the obstacles
+   * within the inflation radius of it, rather than the brushfire of inflate()
+   * @param master_grid The master costmap grid to update
+   * @param min_i X min map coord of the window to update
+   * @param min_j Y min map coord of the window to update
+   * @param max_i X max map coord of the window to update
+   * @param max_j Y max map coord of the window to update
+   */
+  void inflateDistanceTransform(
+    nav2_costmap_2d::Costmap2D & master_grid,
+    int min_i, int min_j, int max_i, int max_j);
+
+  /**
+   * @brief Re-inflate the obstacles of the tracked seeds into one block of the inflated costs
+   * @param bx X index of the block
+   * @param by Y index of the block
+   */
+  void reinflateBlock(unsigned int bx, unsigned int by);
+
+  /**
+   * @brief Mark the blocks within the inflation radius of a cell for re-inflation
+   * @param mx The x coordinate of the cell
+   * @param my The y coordinate of the cell
+   */
+  void markBlocksDirty(unsigned int mx, unsigned int my);
 
   /**
    * @brief Callback executed when a parameter change is detected
@@ -253,16 +356,36 @@ private:
 
   double resolution_;
 
-  std::vector<bool> seen_;
+  VisitationMap seen_;
 
   std::vector<unsigned char> cached_costs_;
   std::vector<double> cached_distances_;
   std::vector<std::vector<int>> distance_matrix_;
+  // Cost by squared cell distance up to the inflation radius, for the distance transform
+  std::vector<unsigned char> cached_sq_distance_costs_;
   unsigned int cache_length_;
   double last_min_x_, last_min_y_, last_max_x_, last_max_y_;
 
   // Indicates that the entire costmap should be reinflated next time around.
   bool need_reinflation_;
+  // Version of the footprint the caches were computed for
+  uint64_t footprint_version_{0};
+
+  // Exact Euclidean distance transform: the column distances to the nearest obstacle
+  // and the squared distances to the nearest obstacle of the padded window
+  bool use_distance_transform_;
+  std::vector<int> column_distances_;
+  std::vector<int> sq_distances_;
+
+  // Incremental inflation: the costs inflated from the obstacle cells ("seeds") of the
+  // lower layers are kept in blocks, which are re-inflated only when a seed within the
+  // inflation radius was added or removed
+  bool incremental_inflation_;
+  bool inflated_costs_valid_;
+  Costmap2D inflated_costs_;
+  std::vector<bool> seeds_;
+  std::vector<bool> dirty_blocks_;
+  unsigned int block_size_, blocks_x_, blocks_y_;
   mutex_t * access_;
   // Dynamic parameters handler
   rclcpp::node_interfaces::OnSetParametersCallbackHandle::SharedPtr dyn_params_handler_;
@@ -37,6 +37,8 @@
 #ifndef NAV2_COSTMAP_2D__LAYER_HPP_
 #define NAV2_COSTMAP_2D__LAYER_HPP_
 
+#include <atomic>
+#include <cstddef>
 #include <string>
 #include <vector>
 #include <unordered_set>
@@ -112,9 +114,68 @@ public:
     Costmap2D & master_grid,
     int min_i, int min_j, int max_i, int max_j) = 0;
 
+  /**
+   * @brief Check if the layer is due to update its bounds in this update of the costmap,
+   *        starting its next update period if it is. Layers not due skip updateBounds(),
+   *        so that the composition of the master costmap only reruns over the windows
+   *        of the due layers, outside of which their costs are kept from before.
+   *
+   *        A layer is due when forced, once the period of its update_frequency parameter
+   *        elapsed, or when it requested an update since its last one, and always at
+   *        the default update_frequency of 0, that of the costmap. Only layers whose
+   *        bounds depend on their own data alone, unlike the inflation layer, should
+   *        set a lower one.
+   * @param force Whether all layers are due, e.g. after the costmap moved
+   */
+  bool startUpdateIfDue(bool force);
+
+  /**
+   * @brief If the layer supports tiled updates. When enabled in the LayeredCostmap,
+   *        the update window is split into tiles and updateCostsTile() is called for
+   *        several tiles at once from a thread pool, between calls to beginTiledUpdate()
+   *        and endTiledUpdate() on the updating thread. Layers not tile safe are always
+   *        updated by updateCosts() over the whole window.
+   */
+  virtual bool isTileSafe() {return false;}
+
+  /**
+   * @brief Get the number of cells beyond its tile that updateCostsTile() reads from
+   *        the master grid. Tiles within this distance of each other are never updated
+   *        at the same time, so that no tile reads cells while they are being written.
+   */
+  virtual unsigned int getTileHalo() {return 0;}
+
+  /**
+   * @brief Prepare a tiled update of the window, such as taking the layer's locks and
+   *        applying per-update work once rather than for each tile.
+   */
+  virtual void beginTiledUpdate(
+    Costmap2D & /*master_grid*/,
+    int /*min_i*/, int /*min_j*/, int /*max_i*/, int /*max_j*/) {}
+
+  /**
+   * @brief Update the costs of one tile of the window in the master costmap. May be
+   *        called concurrently for other tiles, so it must only write within its tile.
+   */
+  virtual void updateCostsTile(
+    Costmap2D & master_grid,
+    int min_i, int min_j, int max_i, int max_j)
+  {
+    updateCosts(master_grid, min_i, min_j, max_i, max_j);
+  }
+
+  /** @brief Finish a tiled update, after all of its tiles were updated. */
+  virtual void endTiledUpdate() {}
+
   /** @brief Implement this to make this layer match the size of the parent costmap. */
   virtual void matchSize() {}
 
+  /**
+   * @brief Get the bytes of memory owned by the layer, such as its grids and caches, to be
+   *        accounted for by the costmap. Called from the update thread.
+   */
+  virtual size_t getMemoryUsage() {return 0;}
+
   /** @brief LayeredCostmap calls this whenever the footprint there
    * changes (via LayeredCostmap::setFootprint()).  Override to be
    * notified of changes to the robot's footprint. */
@@ -173,6 +234,12 @@ protected:
    */
   virtual void onInitialize() {}
 
+  /**
+   * @brief Signal that this layer received new data, for event driven costmap updates.
+   *        Makes the layer due at the next update whatever its update_frequency.
+   */
+  void requestUpdate();
+
   bool current_;
   // Currently this var is managed by subclasses.
   // TODO(bpwilcox): make this managed by this class and/or container class.
@@ -181,6 +248,13 @@ protected:
   // Names of the parameters declared on the ROS node
   std::unordered_set<std::string> local_params_;
 
+  // Period between the updates of the bounds of this layer, 0 for every costmap update,
+  // the time of the last of them, and whether an update was requested since
+  double update_period_;
+  rclcpp::Time last_update_time_;
+  bool has_updated_;
+  std::atomic<bool> update_requested_;
+
 private:
   std::vector<geometry_msgs::msg::Point> footprint_spec_;
 };
@@ -0,0 +1,136 @@
+// Copyright (c) 2022 Samsung Research America
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef NAV2_COSTMAP_2D__LAYER_SNAPSHOT_HPP_
+#define NAV2_COSTMAP_2D__LAYER_SNAPSHOT_HPP_
+
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "rclcpp/logger.hpp"
+
+namespace nav2_costmap_2d
+{
+
+/**
+ * @struct LayerSnapshot
+ * @brief The state of a clearable layer, saved to local storage so that a restarted layer
+ * starts from it rather than empty
+ */
+struct LayerSnapshot
+{
+  std::string frame;        ///< Global frame of the layer
+  int64_t stamp_ns{0};      ///< System time of the snapshot, in nanoseconds since the epoch
+  double origin_x{0.0};
+  double origin_y{0.0};
+  double robot_x{0.0};      ///< Position of the robot in the global frame
+  double robot_y{0.0};
+  double resolution{0.0};
+  unsigned int size_x{0};
+  unsigned int size_y{0};
+  std::vector<unsigned char> costs;  ///< Costs of the layer, row by row
+
+  // Voxel columns of the cells of a voxel layer, as raw words, empty for other layers
+  unsigned int size_z{0};
+  unsigned int word_size{0};
+  double origin_z{0.0};
+  double z_resolution{0.0};
+  std::vector<uint8_t> voxels;
+};
+
+/**
+ * @brief Save a snapshot to a file, with its costs and voxels run-length encoded. The file
+ * is written next to the path then renamed, so that it is never left half written.
+ * @return False if the file could not be written
+ */
+bool saveLayerSnapshot(const std::string & path, const LayerSnapshot & snapshot);
+
+/**
+ * @brief Load a snapshot saved by saveLayerSnapshot()
+ * @return False if the file is missing or malformed
+ */
+bool loadLayerSnapshot(const std::string & path, LayerSnapshot & snapshot);
+
+/**
+ * @brief Copy the cells of a grid to another grid, shifted by a number of cells, where they
+ * overlap
+ * @param source Cells of the source grid, row by row
+ * @param source_size_x Number of cells in each row of the source grid
+ * @param source_size_y Number of rows of the source grid
+ * @param destination Cells of the destination grid, row by row
+ * @param size_x Number of cells in each row of the destination grid
+ * @param size_y Number of rows of the destination grid
+ * @param offset_x Column of the destination grid of the first column of the source grid
+ * @param offset_y Row of the destination grid of the first row of the source grid
+ * @param cell_bytes Number of bytes of each cell
+ * @return Number of cells copied
+ */
+size_t copyOverlappingCells(
+  const uint8_t * source, unsigned int source_size_x, unsigned int source_size_y,
+  uint8_t * destination, unsigned int size_x, unsigned int size_y,
+  int offset_x, int offset_y, size_t cell_bytes);
+
+/**
+ * @class LayerSnapshotWriter
+ * @brief Saves the snapshots of a layer on a thread of its own, so that layer updates only
+ * copy their state. A snapshot submitted while the previous one is being saved replaces any
+ * other waiting, as only the latest matters.
+ */
+class LayerSnapshotWriter
+{
+public:
+  /**
+   * @brief A constructor, starting the thread
+   * @param path File the snapshots are saved to
+   * @param logger Logger to warn of the snapshots which could not be saved with
+   */
+  LayerSnapshotWriter(const std::string & path, const rclcpp::Logger & logger);
+
+  /**
+   * @brief A destructor, saving the snapshot waiting if any before joining the thread
+   */
+  ~LayerSnapshotWriter();
+
+  LayerSnapshotWriter(const LayerSnapshotWriter &) = delete;
+  LayerSnapshotWriter & operator=(const LayerSnapshotWriter &) = delete;
+
+  /**
+   * @brief Submit a snapshot to be saved
+   */
+  void submit(std::unique_ptr<LayerSnapshot> snapshot);
+
+protected:
+  /**
+   * @brief Loop of the thread, saving the snapshots submitted
+   */
+  void run();
+
+  std::string path_;
+  rclcpp::Logger logger_;
+  std::mutex mutex_;
+  std::condition_variable cv_;
+  std::unique_ptr<LayerSnapshot> pending_;
+  bool stop_{false};
+  std::thread thread_;
+};
+
+}  // namespace nav2_costmap_2d
+
+#endif  // NAV2_COSTMAP_2D__LAYER_SNAPSHOT_HPP_
@@ -38,16 +38,29 @@
 #ifndef NAV2_COSTMAP_2D__LAYERED_COSTMAP_HPP_
 #define NAV2_COSTMAP_2D__LAYERED_COSTMAP_HPP_
 
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
 #include <memory>
+#include <mutex>
 #include <string>
 #include <vector>
 
 #include "nav2_costmap_2d/cost_values.hpp"
 #include "nav2_costmap_2d/layer.hpp"
 #include "nav2_costmap_2d/costmap_2d.hpp"
+#include "nav2_costmap_2d/costmap_pyramid.hpp"
+#include "nav2_costmap_2d/distance_field.hpp"
+#include "nav2_costmap_2d/footprint_geometry.hpp"
+#include "nav2_costmap_2d/tile_thread_pool.hpp"
 
 namespace nav2_costmap_2d
 {
+
+class CostmapRecorder;
 class Layer;
 
 /**
@@ -80,11 +93,23 @@ public:
 
   /**
    * @brief Resize the map to a new size, resolution, or origin
+   * @param resample Whether the layers resample their cells instead of being reset, see
+   * isResampling(). The whole map is then updated on the next update.
    */
   void resizeMap(
     unsigned int size_x, unsigned int size_y, double resolution, double origin_x,
     double origin_y,
-    bool size_locked = false);
+    bool size_locked = false,
+    bool resample = false);
+
+  /**
+   * @brief Whether the layers matching the size of the map in resizeMap() keep their
+   * cells, resampled to the new geometry, e.g. on a change of resolution on the fly
+   */
+  bool isResampling() const
+  {
+    return resampling_;
+  }
 
   /**
    * @brief Get the size of the bounds for update
@@ -111,6 +136,88 @@ public:
     return &combined_costmap_;
   }
 
+  /**
+   * @brief Get an immutable copy of the master costmap as of the end of the last update,
+   * without waiting for an update in progress. Snapshots are taken after each update
+   * from the first call on, which blocks until a first one is taken.
+   * @return The last snapshot, which stays valid and unchanged while held
+   */
+  std::shared_ptr<const Costmap2D> getCostmapSnapshot();
+
+  /**
+   * @brief Get the number of changes made to the master costmap so far, by updates,
+   * resizes and resets. Readers keeping results computed from the master costmap can
+   * compare it, with the costmap mutex held, to know whether they are still current.
+   */
+  uint64_t getUpdateCount() const
+  {
+    return update_count_;
+  }
+
+  /**
+   * @brief Count a change made to the master costmap outside of updateMap() and
+   * resizeMap(), e.g. a reset, with its mutex held. As the cells changed are not
+   * known, the whole costmap is taken as changed.
+   */
+  void markUpdated()
+  {
+    journal_start_count_ = ++update_count_;
+    changed_windows_.clear();
+    distance_field_.invalidate();
+    // The coarse levels would otherwise answer queries with the costs before the change
+    if (pyramid_.getLevels() > 0) {
+      pyramid_.update(
+        combined_costmap_, 0, 0, combined_costmap_.getSizeInCellsX(),
+        combined_costmap_.getSizeInCellsY());
+    }
+    update_all_layers_ = true;
+    if (snapshots_enabled_) {
+      publishSnapshot();
+    }
+  }
+
+  /**
+   * @brief Record the stamp of sensor data incorporated by the update in progress, to be
+   * called by layers from updateBounds()
+   */
+  void addSensorStamp(const rclcpp::Time & stamp)
+  {
+    pending_sensor_stamp_ = std::max(pending_sensor_stamp_, stamp.nanoseconds());
+  }
+
+  /**
+   * @brief Get the stamp of the newest sensor data incorporated by the master costmap as of
+   * its current update count, so that readers can trace the latency from sensor data to
+   * their results. To be called with the costmap mutex held.
+   * @return The stamp, zero if no sensor data was incorporated yet
+   */
+  rclcpp::Time getSensorStamp() const
+  {
+    return rclcpp::Time(sensor_stamp_, RCL_ROS_TIME);
+  }
+
+  /**
+   * @struct ChangedWindow
+   * @brief Window of cells of the master costmap changed by an update
+   */
+  struct ChangedWindow
+  {
+    uint64_t update_count;
+    unsigned int x0, y0, xn, yn;
+  };
+
+  /**
+   * @brief Get the windows of cells changed since an update count, up to the current one,
+   * so that readers keeping results computed from the master costmap can refresh only
+   * these cells. Updates that changed no cells have no window, so no windows since an
+   * update count means the costmap is unchanged. To be called with the costmap mutex held.
+   * @param update_count Update count to get the changes since, see getUpdateCount()
+   * @param windows Windows changed since the update count, in order
+   * @return False if the whole costmap may have changed since the update count, e.g.
+   *         because it was resized, reset or moved since, or the update count is too old
+   */
+  bool getChangedWindows(uint64_t update_count, std::vector<ChangedWindow> & windows) const;
+
   /**
    * @brief If this costmap is rolling or not
    */
@@ -192,6 +299,16 @@ public:
   /** @brief Returns the latest footprint stored with setFootprint(). */
   const std::vector<geometry_msgs::msg::Point> & getFootprint() {return footprint_;}
 
+  /**
+   * @brief Get the geometry of the latest footprint stored with setFootprint(), which
+   * keeps its version while the footprint set is the same, of an empty footprint until
+   * then. It can be called from any thread.
+   */
+  std::shared_ptr<const FootprintGeometry> getFootprintGeometry() const
+  {
+    return std::atomic_load(&footprint_geometry_);
+  }
+
   /** @brief The radius of a circle centered at the origin of the
    * robot which just surrounds all points on the robot's
    * footprint.
@@ -210,7 +327,112 @@ public:
   * of poorly configured setups. */
   bool isOutofBounds(double robot_x, double robot_y);
 
+  /**
+   * @brief Set the update of tile safe plugins to run in parallel over tiles of the window
+   * @param threads Number of threads to update tiles on, 1 or less to update sequentially
+   * @param tile_size Size of the tiles in cells, increased to the halo of a layer if smaller
+   */
+  void setTiledUpdate(unsigned int threads, unsigned int tile_size);
+
+  /**
+   * @brief Get the thread pool of tiled updates, which layers may also use to parallelize
+   * their own updates
+   * @return The thread pool, or nullptr if tiled updates are disabled
+   */
+  TileThreadPool * getTileThreadPool()
+  {
+    return tile_pool_.get();
+  }
+
+  /**
+   * @brief Set the recorder of the updates of the costmap, which layers record their
+   * observations to. To be set before the plugins are initialized.
+   * @param recorder The recorder, nullptr to disable recording
+   */
+  void setRecorder(std::shared_ptr<CostmapRecorder> recorder)
+  {
+    recorder_ = recorder;
+  }
+
+  /**
+   * @brief Get the recorder of the updates of the costmap
+   * @return The recorder, or nullptr if recording is disabled
+   */
+  std::shared_ptr<CostmapRecorder> getRecorder() const
+  {
+    return recorder_;
+  }
+
+  /**
+   * @brief Set the number of coarse levels of the master costmap kept up to date with it
+   * @param levels Number of levels, with downsampling factors 2, 4, ..., 2^levels, 0 to disable
+   */
+  void setPyramidLevels(unsigned int levels);
+
+  /**
+   * @brief Get the coarse levels of the master costmap, to be read with its mutex locked
+   */
+  const CostmapPyramid & getCostmapPyramid()
+  {
+    return pyramid_;
+  }
+
+  /**
+   * @brief Set the distance the signed distance field of the lethal cells of the master
+   * costmap is truncated to, the field being kept up to date with it
+   * @param max_distance Maximum distance, in meters, 0 to disable the field
+   */
+  void setDistanceFieldMaxDistance(double max_distance);
+
+  /**
+   * @brief Get the signed distance field of the lethal cells of the master costmap, to be
+   * read with its mutex locked
+   */
+  const DistanceField & getDistanceField()
+  {
+    return distance_field_;
+  }
+
+  /**
+   * @brief Get the bytes of memory owned by the master costmap along with its snapshots,
+   * coarse levels and distance field, the layers accounting for their own
+   */
+  size_t getMemoryUsage();
+
+  /**
+   * @brief Signal that a plugin or filter received new data, such that the master
+   * costmap should be updated. Safe to call from any thread.
+   */
+  void requestUpdate();
+
+  /**
+   * @brief Wait until an update is requested, consuming the request
+   * @param deadline Time to stop waiting at, or the time_point maximum to wait indefinitely
+   * @return True if an update was requested, false if the deadline passed
+   */
+  bool waitForUpdateRequest(const std::chrono::steady_clock::time_point & deadline);
+
 private:
+  /**
+   * @brief Update the bounds and costs of the master costmap, with its mutex locked
+   * @return False if no cells were updated, e.g. the layers had empty bounds
+   */
+  bool updateMasterCostmap(double robot_x, double robot_y, double robot_yaw);
+
+  /**
+   * @brief Copy the master costmap into a new snapshot for readers, with its mutex locked.
+   * A snapshot reused from before is only refreshed with the windows changed since.
+   */
+  void publishSnapshot();
+
+  /**
+   * @brief Update the costs of a plugin over the window, in parallel tiles if enabled
+   * and supported by the plugin
+   */
+  void updateLayerCosts(
+    const std::shared_ptr<Layer> & layer, Costmap2D & master_grid,
+    int x0, int y0, int xn, int yn);
+
   // primary_costmap_ is a bottom costmap used by plugins when costmap filters were enabled.
   // combined_costmap_ is a final costmap where all results produced by plugins and filters (if any)
   // to be merged.
@@ -230,8 +452,52 @@ private:
 
   bool initialized_;
   bool size_locked_;
+  bool resampling_;
+  // Whether the next update covers the whole map, after the layers were resampled
+  bool update_whole_map_;
+  // Whether all layers are due at the next update, whatever their update rates
+  bool update_all_layers_;
   double circumscribed_radius_, inscribed_radius_;
   std::vector<geometry_msgs::msg::Point> footprint_;
+  std::shared_ptr<const FootprintGeometry> footprint_geometry_;
+
+  std::unique_ptr<TileThreadPool> tile_pool_;
+  std::shared_ptr<CostmapRecorder> recorder_;
+  unsigned int tile_size_;
+
+  CostmapPyramid pyramid_;
+  DistanceField distance_field_;
+
+  // Last snapshot of the master costmap, only accessed atomically, and the one
+  // before it, to be reused for the next snapshot once readers released it
+  std::shared_ptr<Costmap2D> snapshot_;
+  std::shared_ptr<Costmap2D> spare_snapshot_;
+  std::atomic<bool> snapshots_enabled_;
+  // Update counts the snapshots were taken at, from which a reused snapshot is refreshed
+  // with the windows changed since
+  uint64_t snapshot_update_count_;
+  uint64_t spare_snapshot_update_count_;
+  std::vector<ChangedWindow> snapshot_windows_;
+
+  // Number of changes made to the master costmap, see getUpdateCount()
+  std::atomic<uint64_t> update_count_;
+
+  // Stamps of the newest sensor data incorporated by the master costmap and by the update in
+  // progress, in nanoseconds, see getSensorStamp()
+  int64_t sensor_stamp_;
+  int64_t pending_sensor_stamp_;
+
+  // Update count since which all of the windows changed are journaled, that of the last
+  // change of the whole costmap or of the last window dropped, and the windows changed by
+  // the updates since, see getChangedWindows(). Updates changing no cells add no window.
+  uint64_t journal_start_count_;
+  std::deque<ChangedWindow> changed_windows_;
+  static constexpr size_t max_changed_windows_ = 64;
+
+  // Update requests from plugins and filters, for event driven updates
+  std::mutex update_request_mutex_;
+  std::condition_variable update_request_cv_;
+  bool update_requested_;
 };
 
 }  // namespace nav2_costmap_2d
@@ -70,11 +70,12 @@ public:
   Observation & operator=(const Observation & obs)
   {
     origin_ = obs.origin_;
-    cloud_ = new sensor_msgs::msg::PointCloud2(*(obs.cloud_));
+    *cloud_ = *(obs.cloud_);
     obstacle_max_range_ = obs.obstacle_max_range_;
     obstacle_min_range_ = obs.obstacle_min_range_;
     raytrace_max_range_ = obs.raytrace_max_range_;
     raytrace_min_range_ = obs.raytrace_min_range_;
+    frustum_clearing_ = obs.frustum_clearing_;
 
     return *this;
   }
@@ -107,7 +108,7 @@ public:
   : origin_(obs.origin_), cloud_(new sensor_msgs::msg::PointCloud2(*(obs.cloud_))),
     obstacle_max_range_(obs.obstacle_max_range_), obstacle_min_range_(obs.obstacle_min_range_),
     raytrace_max_range_(obs.raytrace_max_range_),
-    raytrace_min_range_(obs.raytrace_min_range_)
+    raytrace_min_range_(obs.raytrace_min_range_), frustum_clearing_(obs.frustum_clearing_)
   {
   }
 
@@ -129,6 +130,8 @@ public:
   geometry_msgs::msg::Point origin_;
   sensor_msgs::msg::PointCloud2 * cloud_;
   double obstacle_max_range_, obstacle_min_range_, raytrace_max_range_, raytrace_min_range_;
+  // Whether to clear by raytracing to the nearest point in each direction only
+  bool frustum_clearing_{false};
 };
 
 }  // namespace nav2_costmap_2d
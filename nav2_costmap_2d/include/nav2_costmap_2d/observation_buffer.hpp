@@ -39,13 +39,18 @@
 
 #include <vector>
 #include <list>
+#include <memory>
+#include <mutex>
 #include <string>
+#include <unordered_map>
 
 #include "tf2_geometry_msgs/tf2_geometry_msgs.hpp"
 #include "rclcpp/time.hpp"
 #include "tf2_ros/buffer.h"
 #include "tf2_sensor_msgs/tf2_sensor_msgs.hpp"
+#include "sensor_msgs/msg/laser_scan.hpp"
 #include "sensor_msgs/msg/point_cloud2.hpp"
+#include "nav2_costmap_2d/costmap_recorder.hpp"
 #include "nav2_costmap_2d/observation.hpp"
 #include "nav2_util/lifecycle_node.hpp"
 
@@ -93,12 +98,22 @@ public:
   ~ObservationBuffer();
 
   /**
-   * @brief  Transforms a PointCloud to the global frame and buffers it
+   * @brief  Transforms a PointCloud to the global frame and buffers it. Thread safe, the buffer
+   *         is only locked to add the transformed cloud, which reuses the storage of stale ones
    * <b>Note: The burden is on the user to make sure the transform is available... ie they should use a MessageNotifier</b>
    * @param  cloud The cloud to be buffered
    */
   void bufferCloud(const sensor_msgs::msg::PointCloud2 & cloud);
 
+  /**
+   * @brief  Projects a LaserScan and buffers it as bufferCloud() does. Thread safe. The beams
+   *         are projected with unit vectors computed once per scan configuration into a cloud
+   *         reused between scans, which is transformed with the single transform at the stamp
+   *         of the scan, with no correction of the motion of the sensor during the scan.
+   * @param  scan The scan to be buffered, its ranges out of [range_min, range_max) being dropped
+   */
+  void bufferScan(const sensor_msgs::msg::LaserScan & scan);
+
   /**
    * @brief  Pushes copies of all current observations onto the end of the vector passed in
    * @param  observations The vector to be filled
@@ -132,12 +147,69 @@ public:
    */
   void resetLastUpdated();
 
+  /**
+   * @brief  Collapse the points of buffered clouds that fall in the same cell to the lowest
+   *         of them, after the height filtering. The lowest point passes any height limit
+   *         that another point of its cell passes. Thread safe.
+   * @param  resolution Size of the cells, 0 to keep all points
+   * @param  z_resolution Height of the cells, 0 for cells spanning all heights
+   * @param  origin_x X coordinate in the global frame that the cells are aligned to
+   * @param  origin_y Y coordinate in the global frame that the cells are aligned to
+   * @param  origin_z Z coordinate in the global frame that the cells are aligned to
+   */
+  void setVoxelFilter(
+    double resolution, double z_resolution,
+    double origin_x, double origin_y, double origin_z);
+
+  /**
+   * @brief  Set whether the observations buffered are cleared through their depth image,
+   *         raytracing only to their nearest point in each direction. Thread safe.
+   */
+  void setFrustumClearing(bool frustum_clearing);
+
+  /**
+   * @brief  Set the recorder the observations buffered are recorded to, once transformed and
+   *         filtered. Thread safe.
+   * @param  recorder The recorder, nullptr to stop recording
+   * @param  source Identifier of the buffer in the recording, from CostmapRecorder::addSource()
+   */
+  void setRecorder(std::shared_ptr<CostmapRecorder> recorder, uint32_t source);
+
 private:
+  /**
+   * @brief  Buffer a cloud, with scratch_lock_ held
+   */
+  void bufferCloudLocked(const sensor_msgs::msg::PointCloud2 & cloud);
+
   /**
    * @brief  Removes any stale observations from the buffer list
    */
   void purgeStaleObservations();
 
+  /**
+   * @brief  Removes observations from a list, keeping some of them for reuse by bufferCloud()
+   * @param  observations The list to remove from
+   * @param  first The first observation to remove, along with those that follow
+   */
+  void recycleObservations(
+    std::list<Observation> & observations, std::list<Observation>::iterator first);
+
+  /**
+   * @brief  Get the key of the voxel filter cell of a point
+   * @return False if the point is too far from the origin of the cells to be filtered
+   */
+  bool getFilterCell(float x, float y, float z, uint64_t & key) const;
+
+  /**
+   * @struct FilterCell
+   * @brief Point kept for a cell of the voxel filter
+   */
+  struct FilterCell
+  {
+    unsigned int index;
+    float z;
+  };
+
   rclcpp::Clock::SharedPtr clock_;
   rclcpp::Logger logger_{rclcpp::get_logger("nav2_costmap_2d")};
   tf2_ros::Buffer & tf2_buffer_;
@@ -147,6 +219,24 @@ private:
   std::string global_frame_;
   std::string sensor_frame_;
   std::list<Observation> observation_list_;
+  // Removed observations, whose clouds are reused by bufferCloud()
+  std::list<Observation> spare_observations_;
+  static constexpr size_t max_spare_observations_ = 4;
+  // Transformed cloud of bufferCloud(), kept to reuse its storage
+  sensor_msgs::msg::PointCloud2 global_frame_cloud_;
+  // Voxel filter, frustum clearing and recorder, guarded by scratch_lock_ along with the
+  // cells of the cloud being filtered and the scan being projected
+  double filter_resolution_{0.0}, filter_z_resolution_{0.0};
+  double filter_origin_x_{0.0}, filter_origin_y_{0.0}, filter_origin_z_{0.0};
+  std::unordered_map<uint64_t, FilterCell> filter_cells_;
+  bool frustum_clearing_{false};
+  std::shared_ptr<CostmapRecorder> recorder_;
+  uint32_t recorder_source_{0};
+  // Cloud of the last scan projected, and unit vectors of the beams of its configuration
+  sensor_msgs::msg::PointCloud2 scan_cloud_;
+  std::vector<float> beam_x_, beam_y_;
+  float beam_angle_min_{0.0f}, beam_angle_increment_{0.0f};
+  std::mutex scratch_lock_;
   std::string topic_name_;
   double min_obstacle_height_, max_obstacle_height_;
   std::recursive_mutex lock_;  ///< @brief A lock for accessing data in callbacks safely
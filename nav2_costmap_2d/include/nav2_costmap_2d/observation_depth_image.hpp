@@ -0,0 +1,60 @@
+// Copyright (c) 2022 Samsung Research America
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef NAV2_COSTMAP_2D__OBSERVATION_DEPTH_IMAGE_HPP_
+#define NAV2_COSTMAP_2D__OBSERVATION_DEPTH_IMAGE_HPP_
+
+#include <vector>
+
+#include "nav2_costmap_2d/observation.hpp"
+
+namespace nav2_costmap_2d
+{
+
+/**
+ * @class ObservationDepthImage
+ * @brief Depth image of an observation seen from its origin, keeping the nearest point
+ *        in each direction bin of azimuth, and of elevation in 3D. Raytracing to the points
+ *        kept clears the volume seen up to the measured depth, such as the frustum of a
+ *        depth camera, with one ray per bin instead of one per point.
+ */
+class ObservationDepthImage
+{
+public:
+  /**
+   * @brief  Keep the nearest point of each bin of an observation
+   * @param  observation Observation to reduce
+   * @param  angular_resolution Angular size of the bins, in radians, increased as needed
+   *         for the image to have at most max_bins bins
+   * @param  elevation Whether to bin the elevation too, with the 3D distance as depth,
+   *         else the bins only split the azimuth with the 2D distance as depth
+   * @param  reduced Observation of the points kept, with the origin and ranges of observation
+   */
+  void reduce(
+    const Observation & observation, double angular_resolution, bool elevation,
+    Observation & reduced);
+
+  static constexpr unsigned int max_bins = 1 << 20;
+
+private:
+  // Depth and point of each bin, infinite for the bins with no point
+  std::vector<float> depths_;
+  std::vector<unsigned int> points_;
+  // Bins with a point, to only reset those
+  std::vector<unsigned int> filled_;
+};
+
+}  // namespace nav2_costmap_2d
+
+#endif  // NAV2_COSTMAP_2D__OBSERVATION_DEPTH_IMAGE_HPP_
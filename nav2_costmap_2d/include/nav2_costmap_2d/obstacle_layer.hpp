@@ -38,6 +38,7 @@
 #ifndef NAV2_COSTMAP_2D__OBSTACLE_LAYER_HPP_
 #define NAV2_COSTMAP_2D__OBSTACLE_LAYER_HPP_
 
+#include <chrono>
 #include <memory>
 #include <string>
 #include <vector>
@@ -55,8 +56,12 @@
 #include "sensor_msgs/msg/point_cloud2.hpp"
 #include "nav2_costmap_2d/costmap_layer.hpp"
 #include "nav2_costmap_2d/layered_costmap.hpp"
+#include "nav2_costmap_2d/layer_snapshot.hpp"
 #include "nav2_costmap_2d/observation_buffer.hpp"
+#include "nav2_costmap_2d/observation_depth_image.hpp"
 #include "nav2_costmap_2d/footprint.hpp"
+#include "nav2_costmap_2d/tile_thread_pool.hpp"
+#include "nav2_costmap_2d/visitation_map.hpp"
 
 namespace nav2_costmap_2d
 {
@@ -111,6 +116,40 @@ public:
     nav2_costmap_2d::Costmap2D & master_grid,
     int min_i, int min_j, int max_i, int max_j);
 
+  /**
+   * @brief If the layer supports tiled updates, see Layer::isTileSafe()
+   */
+  virtual bool isTileSafe() {return true;}
+
+  /**
+   * @brief Lock the layer and apply per-update work before updating tiles of the window
+   * @param master_grid The master costmap grid to update
+   * @param min_i X min map coord of the window to update
+   * @param min_j Y min map coord of the window to update
+   * @param max_i X max map coord of the window to update
+   * @param max_j Y max map coord of the window to update
+   */
+  virtual void beginTiledUpdate(
+    nav2_costmap_2d::Costmap2D & master_grid,
+    int min_i, int min_j, int max_i, int max_j);
+
+  /**
+   * @brief Update the costs in the master costmap in a tile of the window
+   * @param master_grid The master costmap grid to update
+   * @param min_i X min map coord of the tile to update
+   * @param min_j Y min map coord of the tile to update
+   * @param max_i X max map coord of the tile to update
+   * @param max_j Y max map coord of the tile to update
+   */
+  virtual void updateCostsTile(
+    nav2_costmap_2d::Costmap2D & master_grid,
+    int min_i, int min_j, int max_i, int max_j);
+
+  /**
+   * @brief Unlock the layer after all tiles of the window were updated
+   */
+  virtual void endTiledUpdate();
+
   /**
    * @brief Deactivate the layer
    */
@@ -131,6 +170,12 @@ public:
    */
   virtual bool isClearable() {return true;}
 
+  /**
+   * @brief Match the size of the master costmap, aligning the voxel filters of the
+   *        observation buffers to its cells
+   */
+  virtual void matchSize();
+
   /**
    * @brief triggers the update of observations buffer
    */
@@ -154,6 +199,17 @@ public:
     sensor_msgs::msg::LaserScan::ConstSharedPtr message,
     const std::shared_ptr<nav2_costmap_2d::ObservationBuffer> & buffer);
 
+  /**
+   * @brief A callback to handle buffering LaserScan messages projected by the buffer itself,
+   *        with a single transform per scan rather than one per beam.
+   * @param message The message returned from a message notifier
+   * @param buffer A pointer to the observation buffer to update
+   * @param inf_is_valid Whether to turn Inf values into range_max
+   */
+  void laserScanDirectCallback(
+    sensor_msgs::msg::LaserScan::ConstSharedPtr message,
+    const std::shared_ptr<nav2_costmap_2d::ObservationBuffer> & buffer, bool inf_is_valid);
+
   /**
    * @brief  A callback to handle buffering PointCloud2 messages
    * @param message The message returned from a message notifier
@@ -185,7 +241,15 @@ protected:
     std::vector<nav2_costmap_2d::Observation> & clearing_observations) const;
 
   /**
-   * @brief  Clear freespace based on one observation
+   * @brief  Record the stamps of observations with the costmap, so that it knows the newest
+   *         sensor data it incorporates
+   * @param observations The observations of the update in progress
+   */
+  void addSensorStamps(const std::vector<nav2_costmap_2d::Observation> & observations) const;
+
+  /**
+   * @brief  Clear freespace based on one observation. Rays are traced between cells,
+   *         so each endpoint cell of the observation is only raytraced once.
    * @param clearing_observation The observation used to raytrace
    * @param min_x
    * @param min_y
@@ -198,6 +262,69 @@ protected:
     double * max_x,
     double * max_y);
 
+  /**
+   * @brief  Get the observation to raytrace for a clearing observation: with frustum clearing,
+   *         the nearest point in each direction of its depth image, else the observation itself
+   * @param clearing_observation The observation used to clear
+   * @param z_resolution Height of the cells raytraced, to split the directions in elevation
+   *        too, 0 for 2D raytracing
+   */
+  const nav2_costmap_2d::Observation & getRaytracedObservation(
+    const nav2_costmap_2d::Observation & clearing_observation, double z_resolution);
+
+  /**
+   * @brief  Get the observation to raytrace for a clearing observation, reducing frustum
+   *         clearing observations with a depth image and into an observation of the caller
+   * @param clearing_observation The observation used to clear
+   * @param z_resolution Height of the cells raytraced, 0 for 2D raytracing
+   * @param depth_image Depth image to reduce the observation with
+   * @param reduced Observation to reduce the observation into
+   */
+  const nav2_costmap_2d::Observation & getRaytracedObservation(
+    const nav2_costmap_2d::Observation & clearing_observation, double z_resolution,
+    ObservationDepthImage & depth_image, nav2_costmap_2d::Observation & reduced);
+
+  /**
+   * @brief  Apply an action to the cells cleared by raytracing an observation, each
+   *         endpoint cell being raytraced once
+   * @param clearing_observation The observation used to raytrace
+   * @param at Action applied to the index of each cell cleared
+   * @param raytraced_endpoints Endpoint cells already raytraced
+   */
+  template<class ActionType>
+  void raytraceObservation(
+    const nav2_costmap_2d::Observation & clearing_observation, ActionType at,
+    VisitationMap & raytraced_endpoints,
+    double * min_x, double * min_y, double * max_x, double * max_y);
+
+  /**
+   * @brief  Apply an action to the cells marked by the points of an observation
+   * @param observation The observation used to mark
+   * @param at Action applied to the index of each cell marked
+   */
+  template<class ActionType>
+  void markObservation(
+    const nav2_costmap_2d::Observation & observation, ActionType at,
+    double * min_x, double * min_y, double * max_x, double * max_y);
+
+  /**
+   * @brief  Clear and mark the observations on the threads of a pool. Each observation
+   *         collects the cells it changes on its own, which are then written in the order
+   *         of the observations, all clearing before marking as when processed serially.
+   * @param pool The thread pool to run the observations on
+   * @param observations The marking observations
+   * @param clearing_observations The clearing observations
+   */
+  void updateObservationsInParallel(
+    TileThreadPool & pool, const std::vector<nav2_costmap_2d::Observation> & observations,
+    const std::vector<nav2_costmap_2d::Observation> & clearing_observations,
+    double * min_x, double * min_y, double * max_x, double * max_y);
+
+  /**
+   * @brief Align the voxel filters of the observation buffers to the cells of the layer
+   */
+  void updateVoxelFilters();
+
   /**
    * @brief Process update costmap with raytracing the window bounds
    */
@@ -207,6 +334,40 @@ protected:
     double * max_x,
     double * max_y);
 
+  /**
+   * @brief Restore the layer from its snapshot once after activation, if set to and the
+   *        snapshot is still valid, expanding the bounds to the whole layer
+   * @param robot_x Position of the robot in the global frame, to check against the snapshot
+   * @param robot_y Position of the robot in the global frame, to check against the snapshot
+   */
+  void restorePendingSnapshot(
+    double robot_x, double robot_y, double * min_x, double * min_y, double * max_x,
+    double * max_y);
+
+  /**
+   * @brief Submit a snapshot of the layer to be saved, once per snapshot period
+   * @param robot_x Position of the robot in the global frame, saved with the snapshot
+   * @param robot_y Position of the robot in the global frame, saved with the snapshot
+   */
+  void updateSnapshot(double robot_x, double robot_y);
+
+  /**
+   * @brief Submit a snapshot of the layer to be saved right away
+   */
+  void submitSnapshot();
+
+  /**
+   * @brief Copy the state of the layer to a snapshot
+   */
+  virtual void fillSnapshot(LayerSnapshot & snapshot);
+
+  /**
+   * @brief Copy the state of a snapshot of the same frame and resolution to the layer, where
+   *        they overlap
+   * @return False if the snapshot cannot be restored to this layer
+   */
+  virtual bool applySnapshot(const LayerSnapshot & snapshot);
+
   std::vector<geometry_msgs::msg::Point> transformed_footprint_;
   bool footprint_clearing_enabled_;
   /**
@@ -233,14 +394,58 @@ protected:
   std::vector<std::shared_ptr<nav2_costmap_2d::ObservationBuffer>> marking_buffers_;
   /// @brief Used to store observation buffers used for clearing obstacles
   std::vector<std::shared_ptr<nav2_costmap_2d::ObservationBuffer>> clearing_buffers_;
+  /// @brief Used to store observation buffers collapsing their points to one per cell
+  std::vector<std::shared_ptr<nav2_costmap_2d::ObservationBuffer>> voxel_filter_buffers_;
+  /// @brief Height and z origin of the cells of the voxel filters, 0 height for 2D cells
+  double voxel_filter_z_resolution_{0.0}, voxel_filter_origin_z_{0.0};
 
   // Used only for testing purposes
   std::vector<nav2_costmap_2d::Observation> static_clearing_observations_;
   std::vector<nav2_costmap_2d::Observation> static_marking_observations_;
 
+  /// @brief Endpoint cells already raytraced for the current clearing observation
+  VisitationMap raytraced_endpoints_;
+  /// @brief Depth image of the frustum clearing observations, and the observation it keeps
+  ObservationDepthImage depth_image_;
+  nav2_costmap_2d::Observation frustum_observation_;
+
+  /**
+   * @brief Cells changed by one observation processed in parallel, along with the bounds
+   * they touched and its own scratch state
+   */
+  struct ObservationChanges
+  {
+    std::vector<unsigned int> cells;
+    double min_x, min_y, max_x, max_y;
+    VisitationMap raytraced_endpoints;
+    ObservationDepthImage depth_image;
+    nav2_costmap_2d::Observation frustum_observation;
+  };
+
+  /// @brief Whether to process the observations in parallel on the tile thread pool
+  bool parallel_observations_{false};
+  std::vector<ObservationChanges> observation_changes_;
+
   bool rolling_window_;
   bool was_reset_;
   int combination_method_;
+
+  /// @brief Snapshots of the layer saved to snapshot_file_ every snapshot_period_ seconds,
+  ///        and restored on activation if less than snapshot_max_age_ seconds old.
+  ///        The global frame is only matched by name, so the snapshot is also only restored
+  ///        if the robot is within snapshot_max_robot_offset_ meters of where it was taken,
+  ///        which a frame restarting with the robot, such as odom, would not be once moved.
+  ///        It may be negative for persistent frames, such as map, to restore anywhere.
+  std::string snapshot_file_;
+  double snapshot_period_{5.0};
+  double snapshot_max_age_{60.0};
+  double snapshot_max_robot_offset_{0.25};
+  double snapshot_robot_x_{0.0};
+  double snapshot_robot_y_{0.0};
+  bool restore_snapshot_{false};
+  bool pending_restore_{false};
+  std::unique_ptr<LayerSnapshotWriter> snapshot_writer_;
+  std::chrono::steady_clock::time_point last_snapshot_;
 };
 
 }  // namespace nav2_costmap_2d
@@ -0,0 +1,178 @@
+// Copyright (c) 2022 Samsung Research America
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef NAV2_COSTMAP_2D__SHARED_MEMORY_COSTMAP_HPP_
+#define NAV2_COSTMAP_2D__SHARED_MEMORY_COSTMAP_HPP_
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "nav2_costmap_2d/costmap_2d.hpp"
+#include "nav2_costmap_2d/layered_costmap.hpp"
+
+namespace nav2_costmap_2d
+{
+
+/**
+ * @brief Header of a shared memory costmap region, followed by the costs. The region is
+ * written under a sequence lock: the sequence is odd while the writer changes the region,
+ * and readers retry their copy if it changed while they were copying. The writer stamps the
+ * region on each of its updates, for readers to tell a writer which died from one without changes.
+ */
+struct SharedMemoryCostmapHeader
+{
+  static constexpr uint32_t MAGIC = 0x6e326373;  // "n2cs"
+  static constexpr uint32_t VERSION = 2;
+
+  // Set last once the region is initialized
+  std::atomic<uint32_t> magic;
+  uint32_t version;
+  // Cleared once the writer replaced the region by a larger one or removed it
+  std::atomic<uint32_t> valid;
+  uint32_t padding;
+  std::atomic<uint64_t> sequence;
+  // Steady clock time of the last update of the writer, in nanoseconds
+  std::atomic<int64_t> heartbeat;
+  uint64_t capacity;
+  uint32_t size_x;
+  uint32_t size_y;
+  double resolution;
+  double origin_x;
+  double origin_y;
+};
+
+static_assert(
+  std::atomic<uint64_t>::is_always_lock_free && std::atomic<int64_t>::is_always_lock_free &&
+  std::atomic<uint32_t>::is_always_lock_free,
+  "Shared memory costmaps need lock free atomics, to be shared between processes");
+
+/**
+ * @brief Get the name of the shared memory region of a costmap
+ * @param topic_name Resolved name of the raw costmap topic
+ * @return The name, as for shm_open()
+ */
+std::string getSharedMemoryName(const std::string & topic_name);
+
+/**
+ * @class nav2_costmap_2d::SharedMemoryCostmapWriter
+ * @brief Exports a master costmap to a POSIX shared memory region, for the processes of
+ * the same host to read it without receiving its messages. The region is removed with
+ * the writer.
+ */
+class SharedMemoryCostmapWriter
+{
+public:
+  /**
+   * @brief A constructor for nav2_costmap_2d::SharedMemoryCostmapWriter
+   * @param name Name of the shared memory region, see getSharedMemoryName()
+   */
+  explicit SharedMemoryCostmapWriter(const std::string & name);
+
+  /**
+   * @brief A destructor for nav2_costmap_2d::SharedMemoryCostmapWriter
+   */
+  ~SharedMemoryCostmapWriter();
+
+  SharedMemoryCostmapWriter(const SharedMemoryCostmapWriter &) = delete;
+  SharedMemoryCostmapWriter & operator=(const SharedMemoryCostmapWriter &) = delete;
+
+  /**
+   * @brief Write the master costmap into the region if it changed since the last write,
+   * with its mutex locked. Only the windows changed since are written when they are known.
+   * The region is stamped either way.
+   * @param layered_costmap Costmap to write
+   * @return False if the region could not be created
+   */
+  bool update(LayeredCostmap & layered_costmap);
+
+protected:
+  /**
+   * @brief Replace the region by one holding a number of cells
+   */
+  bool createRegion(size_t capacity);
+
+  /**
+   * @brief Unmap the region, marking it invalid for its readers
+   */
+  void removeRegion();
+
+  std::string name_;
+  SharedMemoryCostmapHeader * header_{nullptr};
+  unsigned char * costs_{nullptr};
+  size_t region_size_{0};
+  bool written_{false};
+  uint64_t update_count_{0};
+  std::vector<LayeredCostmap::ChangedWindow> windows_;
+};
+
+/**
+ * @class nav2_costmap_2d::SharedMemoryCostmapReader
+ * @brief Maps the shared memory region of a costmap read-only, and copies it when it
+ * changed. The region is mapped again when its writer replaced it, or when its writer did not
+ * update it for longer than a timeout, as a writer which died leaves its region behind.
+ */
+class SharedMemoryCostmapReader
+{
+public:
+  /**
+   * @brief A constructor for nav2_costmap_2d::SharedMemoryCostmapReader
+   * @param name Name of the shared memory region, see getSharedMemoryName()
+   * @param timeout Time in seconds without update of the writer after which the region is
+   * stale, or 0 for it never to be
+   */
+  explicit SharedMemoryCostmapReader(const std::string & name, double timeout = 0.0);
+
+  /**
+   * @brief A destructor for nav2_costmap_2d::SharedMemoryCostmapReader
+   */
+  ~SharedMemoryCostmapReader();
+
+  SharedMemoryCostmapReader(const SharedMemoryCostmapReader &) = delete;
+  SharedMemoryCostmapReader & operator=(const SharedMemoryCostmapReader &) = delete;
+
+  /**
+   * @brief Copy the costmap of the region, if it changed since the last copy
+   * @param costmap Costmap to copy into, resized to the costmap of the region
+   * @param changed Set to whether the costmap was copied
+   * @return False if there is no region, it is stale, or no consistent copy could be made
+   * as its writer kept changing it
+   */
+  bool read(Costmap2D & costmap, bool & changed);
+
+protected:
+  /**
+   * @brief Map the region, if it exists and is initialized
+   */
+  bool openRegion();
+
+  /**
+   * @brief Unmap the region
+   */
+  void closeRegion();
+
+  static constexpr unsigned int max_attempts_ = 100;
+
+  std::string name_;
+  int64_t timeout_;
+  const SharedMemoryCostmapHeader * header_{nullptr};
+  size_t region_size_{0};
+  uint64_t sequence_{0};
+};
+
+}  // namespace nav2_costmap_2d
+
+#endif  // NAV2_COSTMAP_2D__SHARED_MEMORY_COSTMAP_HPP_
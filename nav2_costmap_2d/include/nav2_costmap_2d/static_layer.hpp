@@ -38,6 +38,9 @@
 #ifndef NAV2_COSTMAP_2D__STATIC_LAYER_HPP_
 #define NAV2_COSTMAP_2D__STATIC_LAYER_HPP_
 
+#include <array>
+#include <chrono>
+#include <memory>
 #include <mutex>
 #include <string>
 #include <vector>
@@ -46,8 +49,11 @@
 #include "message_filters/subscriber.h"
 #include "nav2_costmap_2d/costmap_layer.hpp"
 #include "nav2_costmap_2d/layered_costmap.hpp"
+#include "nav2_costmap_2d/static_map_registry.hpp"
+#include "nav2_msgs/srv/get_map_region.hpp"
 #include "nav_msgs/msg/occupancy_grid.hpp"
 #include "rclcpp/rclcpp.hpp"
+#include "tf2/LinearMath/Transform.h"
 
 namespace nav2_costmap_2d
 {
@@ -118,6 +124,40 @@ public:
     nav2_costmap_2d::Costmap2D & master_grid,
     int min_i, int min_j, int max_i, int max_j);
 
+  /**
+   * @brief If the layer supports tiled updates, see Layer::isTileSafe()
+   */
+  virtual bool isTileSafe() {return true;}
+
+  /**
+   * @brief Lock the layer and apply per-update work before updating tiles of the window
+   * @param master_grid The master costmap grid to update
+   * @param min_i X min map coord of the window to update
+   * @param min_j Y min map coord of the window to update
+   * @param max_i X max map coord of the window to update
+   * @param max_j Y max map coord of the window to update
+   */
+  virtual void beginTiledUpdate(
+    nav2_costmap_2d::Costmap2D & master_grid,
+    int min_i, int min_j, int max_i, int max_j);
+
+  /**
+   * @brief Update the costs in the master costmap in a tile of the window
+   * @param master_grid The master costmap grid to update
+   * @param min_i X min map coord of the tile to update
+   * @param min_j Y min map coord of the tile to update
+   * @param max_i X max map coord of the tile to update
+   * @param max_j Y max map coord of the tile to update
+   */
+  virtual void updateCostsTile(
+    nav2_costmap_2d::Costmap2D & master_grid,
+    int min_i, int min_j, int max_i, int max_j);
+
+  /**
+   * @brief Unlock the layer after all tiles of the window were updated
+   */
+  virtual void endTiledUpdate();
+
   /**
    * @brief Match the size of the master costmap
    */
@@ -140,19 +180,45 @@ private:
    * map along with its size will determine what parts of the costmap's
    * static map are overwritten.
    */
-  void incomingMap(const nav_msgs::msg::OccupancyGrid::SharedPtr new_map);
+  void incomingMap(const nav_msgs::msg::OccupancyGrid::ConstSharedPtr new_map);
   /**
    * @brief Callback to update the costmap's map from the map_server (or SLAM)
    * with an update in a particular area of the map
    */
   void incomingUpdate(map_msgs::msg::OccupancyGridUpdate::ConstSharedPtr update);
 
+  /**
+   * @brief Request the region of the map covering the master costmap window and a margin
+   * around it from the map region service, if the current region does not cover the window
+   */
+  void requestMapRegion();
+
+  /**
+   * @brief Callback of the map region service, putting the received region into the costmap
+   * @param future Service response future
+   * @param min_x X min map coord of the requested region
+   * @param min_y Y min map coord of the requested region
+   * @param max_x X max map coord of the requested region
+   * @param max_y Y max map coord of the requested region
+   */
+  void incomingMapRegion(
+    rclcpp::Client<nav2_msgs::srv::GetMapRegion>::SharedFuture future,
+    double min_x, double min_y, double max_x, double max_y);
+
   /**
    * @brief Interpret the value in the static map given on the topic to
    * convert into costs for the costmap to utilize
    */
   unsigned char interpretValue(unsigned char value);
 
+  /**
+   * @brief Get the costs of the map, shared with other static layers or held by this one
+   */
+  const Costmap2D & getStaticCosts() const
+  {
+    return shared_costs_ ? *shared_costs_ : *this;
+  }
+
   /**
    * @brief Callback executed when a parameter change is detected
    * @param event ParameterEvent message
@@ -172,6 +238,7 @@ private:
 
   rclcpp::Subscription<nav_msgs::msg::OccupancyGrid>::SharedPtr map_sub_;
   rclcpp::Subscription<map_msgs::msg::OccupancyGridUpdate>::SharedPtr map_update_sub_;
+  rclcpp::Client<nav2_msgs::srv::GetMapRegion>::SharedPtr map_region_client_;
 
   // Parameters
   std::string map_topic_;
@@ -182,10 +249,34 @@ private:
   unsigned char lethal_threshold_;
   unsigned char unknown_cost_value_;
   bool trinary_costmap_;
+  // Costs of each possible map value, interpreted once the parameters are known
+  std::array<unsigned char, 256> value_costs_;
+  // Whether the costs of the map are shared with the other static layers of the process,
+  // see StaticMapRegistry, instead of held by this layer, the costs and the resolved name
+  // of the map topic they are shared by
+  bool share_map_{false};
+  std::shared_ptr<const Costmap2D> shared_costs_;
+  std::string map_topic_name_;
   bool map_received_{false};
+  std::string map_region_service_;
+  double map_region_margin_;
+  int map_region_level_;
+  double map_region_timeout_{5.0};
+  // Map frame bounds covered by the current map region, and a region request in flight
+  // since its time
+  double region_min_x_{0.0};
+  double region_min_y_{0.0};
+  double region_max_x_{0.0};
+  double region_max_y_{0.0};
+  bool region_received_{false};
+  std::atomic<bool> region_request_pending_{false};
+  std::chrono::steady_clock::time_point region_request_time_;
   tf2::Duration transform_tolerance_;
   std::atomic<bool> update_in_progress_;
-  nav_msgs::msg::OccupancyGrid::SharedPtr map_buffer_;
+  // Whether the update begun by beginTiledUpdate() can be applied, and its transform
+  bool update_ready_{false};
+  tf2::Transform update_transform_;
+  nav_msgs::msg::OccupancyGrid::ConstSharedPtr map_buffer_;
   // Dynamic parameters handler
   rclcpp::node_interfaces::OnSetParametersCallbackHandle::SharedPtr dyn_params_handler_;
 };
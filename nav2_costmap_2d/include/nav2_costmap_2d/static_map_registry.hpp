@@ -0,0 +1,76 @@
+// Copyright (c) 2022 Samsung Research America
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef NAV2_COSTMAP_2D__STATIC_MAP_REGISTRY_HPP_
+#define NAV2_COSTMAP_2D__STATIC_MAP_REGISTRY_HPP_
+
+#include <array>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+
+#include "nav_msgs/msg/occupancy_grid.hpp"
+#include "nav2_costmap_2d/costmap_2d.hpp"
+
+namespace nav2_costmap_2d
+{
+
+/**
+ * @class nav2_costmap_2d::StaticMapRegistry
+ * @brief Process wide registry of the static costs of the maps received by static layers,
+ * by the resolved name of their map topic. Static layers of the costmaps of the same process,
+ * such as those of the planner and controller servers composed in one container, receiving
+ * the same map and interpreting its values the same way share one grid of its costs, built
+ * by the first of them, rather than each converting the map into a copy of their own.
+ */
+class StaticMapRegistry
+{
+public:
+  /**
+   * @brief Get the registry of the process
+   */
+  static StaticMapRegistry & getInstance();
+
+  /**
+   * @brief Get the costs of a map, built from it unless another layer got them already.
+   * The costs are shared as long as one of the layers holds them.
+   * @param topic_name Resolved name of the map topic
+   * @param map Map received on the topic
+   * @param value_costs Costs of each of the values of the map
+   * @return Costs of the map, with the geometry of the map
+   */
+  std::shared_ptr<const Costmap2D> getCosts(
+    const std::string & topic_name, const nav_msgs::msg::OccupancyGrid & map,
+    const std::array<unsigned char, 256> & value_costs);
+
+protected:
+  StaticMapRegistry() = default;
+
+  struct Entry
+  {
+    builtin_interfaces::msg::Time stamp;
+    nav_msgs::msg::MapMetaData info;
+    std::string frame_id;
+    std::array<unsigned char, 256> value_costs;
+    std::weak_ptr<const Costmap2D> costs;
+  };
+
+  std::mutex mutex_;
+  std::multimap<std::string, Entry> maps_;
+};
+
+}  // namespace nav2_costmap_2d
+
+#endif  // NAV2_COSTMAP_2D__STATIC_MAP_REGISTRY_HPP_
@@ -0,0 +1,95 @@
+// Copyright (c) 2022 Samsung Research America
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef NAV2_COSTMAP_2D__TILE_THREAD_POOL_HPP_
+#define NAV2_COSTMAP_2D__TILE_THREAD_POOL_HPP_
+
+#include <atomic>
+#include <condition_variable>
+#include <exception>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace nav2_costmap_2d
+{
+
+/**
+ * @class TileThreadPool
+ * @brief Persistent worker threads running the tiles of a costmap update in parallel.
+ * The calling thread works on tiles too, so a pool of N threads starts N - 1 workers.
+ */
+class TileThreadPool
+{
+public:
+  /**
+   * @brief A constructor
+   * @param threads Number of threads to run tiles on, including the calling thread
+   */
+  explicit TileThreadPool(unsigned int threads);
+
+  /**
+   * @brief A destructor, joining the workers
+   */
+  ~TileThreadPool();
+
+  TileThreadPool(const TileThreadPool &) = delete;
+  TileThreadPool & operator=(const TileThreadPool &) = delete;
+
+  /**
+   * @brief Run a task for each tile and wait for all of them to complete
+   * @param count Number of tiles
+   * @param task Task to run with the index of each tile, may be called concurrently
+   * @throw The first exception thrown by a task, once all tiles are done
+   */
+  void run(unsigned int count, const std::function<void(unsigned int)> & task);
+
+  /**
+   * @brief Get the number of threads tiles are run on
+   */
+  unsigned int getThreads() const
+  {
+    return workers_.size() + 1;
+  }
+
+protected:
+  /**
+   * @brief Run tiles of the current batch until none are left
+   */
+  void work();
+
+  /**
+   * @brief Loop of the worker threads, waiting for each batch of tiles
+   */
+  void workerLoop();
+
+  std::vector<std::thread> workers_;
+  std::mutex mutex_;
+  std::condition_variable start_cv_;
+  std::condition_variable done_cv_;
+
+  // Batch state, set by run() under the mutex before the workers are woken
+  const std::function<void(unsigned int)> * task_{nullptr};
+  unsigned int count_{0};
+  std::atomic<unsigned int> next_{0};
+  unsigned int generation_{0};
+  unsigned int active_{0};
+  bool stop_{false};
+  std::exception_ptr error_;
+};
+
+}  // namespace nav2_costmap_2d
+
+#endif  // NAV2_COSTMAP_2D__TILE_THREAD_POOL_HPP_
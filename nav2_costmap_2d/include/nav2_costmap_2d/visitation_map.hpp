@@ -0,0 +1,91 @@
+// Copyright (c) 2022 Samsung Research America
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef NAV2_COSTMAP_2D__VISITATION_MAP_HPP_
+#define NAV2_COSTMAP_2D__VISITATION_MAP_HPP_
+
+#include <algorithm>
+#include <cstdint>
+#include <vector>
+
+namespace nav2_costmap_2d
+{
+
+/**
+ * @class VisitationMap
+ * @brief Visited state of the cells of a costmap for searches over it. Each cell is stamped
+ * with the search that visited it, so that starting a new search clears every cell at once
+ * rather than resetting all of them.
+ */
+class VisitationMap
+{
+public:
+  /**
+   * @brief Resize to a number of cells, which are all unvisited if the size changed
+   * @param size Number of cells
+   */
+  void resize(unsigned int size)
+  {
+    if (stamps_.size() != size) {
+      stamps_.assign(size, 0);
+      epoch_ = 1;
+    }
+  }
+
+  /**
+   * @brief Get the number of cells
+   */
+  unsigned int size() const
+  {
+    return stamps_.size();
+  }
+
+  /**
+   * @brief Mark all cells unvisited, for a new search
+   */
+  void clear()
+  {
+    // Stamps are only reset when the epoch wraps around
+    if (++epoch_ == 0) {
+      std::fill(stamps_.begin(), stamps_.end(), 0);
+      epoch_ = 1;
+    }
+  }
+
+  /**
+   * @brief If a cell was visited in the current search
+   * @param index Index of the cell
+   */
+  inline bool isVisited(unsigned int index) const
+  {
+    return stamps_[index] == epoch_;
+  }
+
+  /**
+   * @brief Mark a cell visited in the current search
+   * @param index Index of the cell
+   */
+  inline void setVisited(unsigned int index)
+  {
+    stamps_[index] = epoch_;
+  }
+
+protected:
+  std::vector<uint16_t> stamps_;
+  uint16_t epoch_{1};
+};
+
+}  // namespace nav2_costmap_2d
+
+#endif  // NAV2_COSTMAP_2D__VISITATION_MAP_HPP_
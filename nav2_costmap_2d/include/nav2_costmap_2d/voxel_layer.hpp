@@ -45,29 +45,34 @@
 #include <nav2_costmap_2d/layer.hpp>
 #include <nav2_costmap_2d/layered_costmap.hpp>
 #include <nav2_costmap_2d/observation_buffer.hpp>
+#include <nav2_costmap_2d/tile_thread_pool.hpp>
 #include <nav_msgs/msg/occupancy_grid.hpp>
 #include <nav2_msgs/msg/voxel_grid.hpp>
+#include <nav2_msgs/msg/voxel_grid_update.hpp>
 #include <sensor_msgs/msg/laser_scan.hpp>
 #include <laser_geometry/laser_geometry.hpp>
 #include <sensor_msgs/msg/point_cloud.hpp>
 #include <sensor_msgs/msg/point_cloud2.hpp>
 #include <nav2_costmap_2d/obstacle_layer.hpp>
 #include <nav2_voxel_grid/voxel_grid.hpp>
+#include <nav2_voxel_grid/voxel_stamps.hpp>
 
 namespace nav2_costmap_2d
 {
 
 /**
- * @class VoxelLayer
- * @brief Takes laser and pointcloud data to populate a 3D voxel representation of the environment
+ * @class BasicVoxelLayer
+ * @brief Takes laser and pointcloud data to populate a 3D voxel representation of the environment.
+ *        The voxel grid type sets the maximum number of z voxels of the layer.
  */
-class VoxelLayer : public ObstacleLayer
+template<class VoxelGridT>
+class BasicVoxelLayer : public ObstacleLayer
 {
 public:
   /**
    * @brief Voxel Layer constructor
    */
-  VoxelLayer()
+  BasicVoxelLayer()
   : voxel_grid_(0, 0, 0)
   {
     costmap_ = NULL;  // this is the unsigned char* member of parent class's parent class Costmap2D
@@ -76,7 +81,7 @@ public:
   /**
    * @brief Voxel Layer destructor
    */
-  virtual ~VoxelLayer();
+  virtual ~BasicVoxelLayer();
 
   /**
    * @brief Initialization process of layer on startup
@@ -127,12 +132,34 @@ public:
    */
   virtual bool isClearable() {return true;}
 
+  /**
+   * @brief Get the bytes of memory owned by the layer, its grid of costs and voxel columns
+   */
+  size_t getMemoryUsage() override
+  {
+    return ObstacleLayer::getMemoryUsage() +
+           static_cast<size_t>(voxel_grid_.sizeX()) * voxel_grid_.sizeY() *
+           sizeof(typename VoxelGridT::WordType) +
+           published_columns_.capacity() * sizeof(typename VoxelGridT::WordType);
+  }
+
 protected:
   /**
    * @brief Reset internal maps
    */
   virtual void resetMaps();
 
+  /**
+   * @brief Copy the costs and the voxel grid of the layer to a snapshot
+   */
+  void fillSnapshot(LayerSnapshot & snapshot) override;
+
+  /**
+   * @brief Copy the costs and the voxel grid of a snapshot of the same voxels to the layer
+   * @return False if the voxels of the snapshot differ from those of the layer
+   */
+  bool applySnapshot(const LayerSnapshot & snapshot) override;
+
 private:
   /**
    * @brief Use raycasting between 2 points to clear freespace
@@ -143,9 +170,67 @@ private:
     double * max_x,
     double * max_y);
 
+  /**
+   * @brief Clear the rays to the endpoints in clearing_rays_ on the threads of a pool.
+   *        Each thread accumulates the voxels to clear of a sector of the rays in its
+   *        own column masks, which are merged to clear the voxel grid once.
+   */
+  void clearRaysInParallel(
+    TileThreadPool & pool, double sensor_x, double sensor_y, double sensor_z,
+    unsigned int cell_raytrace_max_range, unsigned int cell_raytrace_min_range);
+
+  /**
+   * @brief Clear the voxels not marked again within the voxel decay time, expanding the
+   *        bounds to their columns
+   */
+  void decayVoxels(
+    uint32_t tick, double * min_x, double * min_y, double * max_x, double * max_y);
+
+  /**
+   * @brief Milliseconds since the first voxel decay, plus one so that no tick is zero,
+   *        never decreasing even if the clock jumps back
+   */
+  uint32_t getDecayTick();
+
+  /**
+   * @brief Publish the columns of the voxel grid changed since the last update published,
+   *        compared in the window of this update, or all of the columns not free when the
+   *        grid was reset, moved or resized since, or a subscriber joined
+   */
+  void publishVoxelGridUpdate(double min_x, double min_y, double max_x, double max_y);
+
+  /**
+   * @struct ClearingMasks
+   * @brief Voxels to clear of each column, accumulated by one clearing thread
+   */
+  struct ClearingMasks
+  {
+    std::vector<typename VoxelGridT::WordType> masks;
+    std::vector<unsigned int> columns;
+  };
+
   bool publish_voxel_;
+  bool parallel_clearing_;
+  std::vector<ClearingMasks> clearing_masks_;
+  std::vector<geometry_msgs::msg::Point> clearing_rays_;
   rclcpp_lifecycle::LifecyclePublisher<nav2_msgs::msg::VoxelGrid>::SharedPtr voxel_pub_;
-  nav2_voxel_grid::VoxelGrid voxel_grid_;
+  bool publish_voxel_updates_;
+  rclcpp_lifecycle::LifecyclePublisher<nav2_msgs::msg::VoxelGridUpdate>::SharedPtr
+    voxel_update_pub_;
+  // Columns as of the last update published, and whether the next one is full
+  std::vector<typename VoxelGridT::WordType> published_columns_;
+  double published_origin_x_{0.0}, published_origin_y_{0.0};
+  size_t published_subscribers_{0};
+  bool full_voxel_update_{true};
+  // Seconds after which voxels not marked again are cleared, zero to only clear by raytracing
+  double voxel_decay_{0.0};
+  nav2_voxel_grid::VoxelStamps voxel_stamps_;
+  ClearingMasks decay_masks_;
+  // Voxels to mark of each column, accumulated from the marking observations
+  ClearingMasks marking_masks_;
+  int64_t decay_start_ns_{-1};
+  uint32_t decay_tick_{0};
+  VoxelGridT voxel_grid_;
   double z_resolution_, origin_z_;
   int unknown_threshold_, mark_threshold_, size_z_;
   rclcpp_lifecycle::LifecyclePublisher<sensor_msgs::msg::PointCloud2>::SharedPtr
@@ -234,6 +319,15 @@ private:
   rclcpp::node_interfaces::OnSetParametersCallbackHandle::SharedPtr dyn_params_handler_;
 };
 
+/// @brief Voxel layer of up to 16 z voxels
+typedef BasicVoxelLayer<nav2_voxel_grid::VoxelGrid> VoxelLayer;
+/// @brief Voxel layer of up to 32 z voxels
+typedef BasicVoxelLayer<nav2_voxel_grid::VoxelGrid64> VoxelLayer64;
+#ifdef __SIZEOF_INT128__
+/// @brief Voxel layer of up to 64 z voxels
+typedef BasicVoxelLayer<nav2_voxel_grid::VoxelGrid128> VoxelLayer128;
+#endif
+
 }  // namespace nav2_costmap_2d
 
 #endif  // NAV2_COSTMAP_2D__VOXEL_LAYER_HPP_
@@ -38,6 +38,8 @@
 #include <string>
 #include <memory>
 #include <algorithm>
+#include <cmath>
+#include <limits>
 #include "tf2/convert.h"
 #include "tf2_geometry_msgs/tf2_geometry_msgs.hpp"
 
@@ -49,6 +51,9 @@ namespace nav2_costmap_2d
 
 KeepoutFilter::KeepoutFilter()
 : filter_info_sub_(nullptr), mask_sub_(nullptr), mask_costmap_(nullptr),
+  projected_valid_(false), projected_size_x_(0), projected_size_y_(0),
+  projected_resolution_(0.0), projected_origin_x_(0.0), projected_origin_y_(0.0),
+  projected_min_x_(0), projected_min_y_(0), projected_max_x_(0), projected_max_y_(0),
   mask_frame_(""), global_frame_("")
 {
 }
@@ -145,6 +150,84 @@ void KeepoutFilter::maskCallback(
   // Making a new mask_costmap_
   mask_costmap_ = std::make_unique<Costmap2D>(*msg);
   mask_frame_ = msg->header.frame_id;
+  buildMaskRuns();
+  projected_valid_ = false;
+  requestUpdate();
+}
+
+void KeepoutFilter::buildMaskRuns()
+{
+  const unsigned int size_x = mask_costmap_->getSizeInCellsX();
+  const unsigned int size_y = mask_costmap_->getSizeInCellsY();
+  const unsigned char * mask_array = mask_costmap_->getCharMap();
+
+  mask_runs_.clear();
+  mask_row_runs_.assign(1, 0);
+  for (unsigned int y = 0; y < size_y; y++) {
+    const unsigned char * row = mask_array + static_cast<size_t>(y) * size_x;
+    unsigned int x = 0;
+    while (x < size_x) {
+      const unsigned int begin = x;
+      while (x < size_x && row[x] == row[begin]) {
+        x++;
+      }
+      if (row[begin] != NO_INFORMATION) {
+        mask_runs_.push_back(MaskRun{begin, x, row[begin]});
+      }
+    }
+    mask_row_runs_.push_back(mask_runs_.size());
+  }
+
+  RCLCPP_DEBUG(
+    logger_,
+    "KeepoutFilter: Indexed %zu runs of known values in the %u X %u filter mask",
+    mask_runs_.size(), size_x, size_y);
+}
+
+bool KeepoutFilter::isMaskAligned(
+  const nav2_costmap_2d::Costmap2D & master_grid, int & offset_x, int & offset_y) const
+{
+  const double resolution = master_grid.getResolution();
+  if (std::fabs(mask_costmap_->getResolution() - resolution) > 1e-9 * resolution) {
+    return false;
+  }
+
+  // Cell centers must fall well within the mask cells for the offsets to match worldToMap()
+  const double cells_x = (master_grid.getOriginX() - mask_costmap_->getOriginX()) / resolution;
+  const double cells_y = (master_grid.getOriginY() - mask_costmap_->getOriginY()) / resolution;
+  offset_x = static_cast<int>(std::lround(cells_x));
+  offset_y = static_cast<int>(std::lround(cells_y));
+  return std::fabs(cells_x - offset_x) < 1e-3 && std::fabs(cells_y - offset_y) < 1e-3;
+}
+
+void KeepoutFilter::processMaskRuns(
+  nav2_costmap_2d::Costmap2D & master_grid,
+  int min_i, int min_j, int max_i, int max_j,
+  int offset_x, int offset_y) const
+{
+  const int mask_size_y = static_cast<int>(mask_costmap_->getSizeInCellsY());
+  const int mask_min_x = min_i + offset_x;
+  const int mask_max_x = max_i + offset_x;
+  unsigned char * master_array = master_grid.getCharMap();
+
+  for (int j = std::max(min_j, -offset_y); j < std::min(max_j, mask_size_y - offset_y); j++) {
+    unsigned char * master_row = master_array + master_grid.getIndex(0, j);
+    const int mask_y = j + offset_y;
+    for (size_t r = mask_row_runs_[mask_y]; r < mask_row_runs_[mask_y + 1]; r++) {
+      const MaskRun & run = mask_runs_[r];
+      if (static_cast<int>(run.begin) >= mask_max_x) {
+        break;
+      }
+      const int end = std::min(static_cast<int>(run.end), mask_max_x);
+      for (int mx = std::max(static_cast<int>(run.begin), mask_min_x); mx < end; mx++) {
+        // Update if mask data is greater than existing master_grid's one
+        unsigned char & old_data = master_row[mx - offset_x];
+        if (run.value > old_data || old_data == NO_INFORMATION) {
+          old_data = run.value;
+        }
+      }
+    }
+  }
 }
 
 void KeepoutFilter::process(
@@ -162,10 +245,16 @@ void KeepoutFilter::process(
     return;
   }
 
+  int offset_x, offset_y;  // mask_costmap_ index offsets of master_grid cells
+  if (mask_frame_ == global_frame_ && isMaskAligned(master_grid, offset_x, offset_y)) {
+    // Filter mask cells coincide with master_grid cells:
+    // only touch the cells of the mask runs, without per-cell coordinate conversions
+    processMaskRuns(master_grid, min_i, min_j, max_i, max_j, offset_x, offset_y);
+    return;
+  }
+
   tf2::Transform tf2_transform;
   tf2_transform.setIdentity();  // initialize by identical transform
-  int mg_min_x, mg_min_y;  // masger_grid indexes of bottom-left window corner
-  int mg_max_x, mg_max_y;  // masger_grid indexes of top-right window corner
 
   if (mask_frame_ != global_frame_) {
     // Filter mask and current layer are in different frames:
@@ -184,109 +273,154 @@ void KeepoutFilter::process(
       return;
     }
     tf2::fromMsg(transform.transform, tf2_transform);
+  }
 
-    mg_min_x = min_i;
-    mg_min_y = min_j;
-    mg_max_x = max_i;
-    mg_max_y = max_j;
-  } else {
-    // Filter mask and current layer are in the same frame:
-    // apply the following optimization - iterate only in overlapped
-    // (min_i, min_j)..(max_i, max_j) & mask_costmap_ area.
-    //
-    //           mask_costmap_
-    //       *----------------------------*
-    //       |                            |
-    //       |                            |
-    //       |      (2)                   |
-    // *-----+-------*                    |
-    // |     |///////|<- overlapped area  |
-    // |     |///////|   to iterate in    |
-    // |     *-------+--------------------*
-    // |    (1)      |
-    // |             |
-    // *-------------*
-    //  master_grid (min_i, min_j)..(max_i, max_j) window
-    //
-    // ToDo: after costmap rotation will be added, this should be re-worked.
-
-    double wx, wy;  // world coordinates
-
-    // Calculating bounds corresponding to bottom-left overlapping (1) corner
-    // mask_costmap_ -> master_grid intexes conversion
-    const double half_cell_size = 0.5 * mask_costmap_->getResolution();
-    wx = mask_costmap_->getOriginX() + half_cell_size;
-    wy = mask_costmap_->getOriginY() + half_cell_size;
-    master_grid.worldToMapNoBounds(wx, wy, mg_min_x, mg_min_y);
-    // Calculation of (1) corner bounds
-    if (mg_min_x >= max_i || mg_min_y >= max_j) {
-      // There is no overlapping. Do nothing.
-      return;
+  // Filter mask cells do not coincide with master_grid cells:
+  // project them once on master_grid cells, then only merge the projection in the window
+  projectMask(master_grid, tf2_transform);
+  processProjectedMask(master_grid, min_i, min_j, max_i, max_j);
+}
+
+void KeepoutFilter::projectMask(
+  const nav2_costmap_2d::Costmap2D & master_grid, const tf2::Transform & transform)
+{
+  const unsigned int size_x = master_grid.getSizeInCellsX();
+  const unsigned int size_y = master_grid.getSizeInCellsY();
+  const double resolution = master_grid.getResolution();
+  const double origin_x = master_grid.getOriginX();
+  const double origin_y = master_grid.getOriginY();
+
+  // Cells of the previous projection to keep, shifted by (shift_x, shift_y) cells
+  bool shifted = false;
+  int shift_x = 0, shift_y = 0;
+  if (projected_valid_ && size_x == projected_size_x_ && size_y == projected_size_y_ &&
+    resolution == projected_resolution_ && transform == projected_transform_)
+  {
+    const double cells_x = (origin_x - projected_origin_x_) / resolution;
+    const double cells_y = (origin_y - projected_origin_y_) / resolution;
+    shift_x = static_cast<int>(std::lround(cells_x));
+    shift_y = static_cast<int>(std::lround(cells_y));
+    if (std::fabs(cells_x - shift_x) < 1e-3 && std::fabs(cells_y - shift_y) < 1e-3) {
+      if (shift_x == 0 && shift_y == 0) {
+        // Same geometry: the projection is up to date
+        return;
+      }
+      shifted = true;
     }
-    mg_min_x = std::max(min_i, mg_min_x);
-    mg_min_y = std::max(min_j, mg_min_y);
-
-    // Calculating bounds corresponding to top-right window (2) corner
-    // mask_costmap_ -> master_grid intexes conversion
-    wx = mask_costmap_->getOriginX() +
-      mask_costmap_->getSizeInCellsX() * mask_costmap_->getResolution() + half_cell_size;
-    wy = mask_costmap_->getOriginY() +
-      mask_costmap_->getSizeInCellsY() * mask_costmap_->getResolution() + half_cell_size;
-    master_grid.worldToMapNoBounds(wx, wy, mg_max_x, mg_max_y);
-    // Calculation of (2) corner bounds
-    if (mg_max_x <= min_i || mg_max_y <= min_j) {
-      // There is no overlapping. Do nothing.
-      return;
+  }
+
+  // Master grid cells overlapped by the mask, from the bounding box of its corners
+  const tf2::Transform mask_to_global = transform.inverse();
+  const double mask_origin_x = mask_costmap_->getOriginX();
+  const double mask_origin_y = mask_costmap_->getOriginY();
+  const double mask_size_x = mask_costmap_->getSizeInCellsX() * mask_costmap_->getResolution();
+  const double mask_size_y = mask_costmap_->getSizeInCellsY() * mask_costmap_->getResolution();
+  int min_x = std::numeric_limits<int>::max(), min_y = std::numeric_limits<int>::max();
+  int max_x = std::numeric_limits<int>::min(), max_y = std::numeric_limits<int>::min();
+  for (unsigned int corner = 0; corner < 4; corner++) {
+    tf2::Vector3 point(
+      mask_origin_x + ((corner & 1) ? mask_size_x : 0.0),
+      mask_origin_y + ((corner & 2) ? mask_size_y : 0.0), 0.0);
+    point = mask_to_global * point;
+    int mx, my;
+    master_grid.worldToMapNoBounds(point.x(), point.y(), mx, my);
+    min_x = std::min(min_x, mx);
+    min_y = std::min(min_y, my);
+    max_x = std::max(max_x, mx + 1);
+    max_y = std::max(max_y, my + 1);
+  }
+  const unsigned int new_min_x = std::clamp(min_x, 0, static_cast<int>(size_x));
+  const unsigned int new_min_y = std::clamp(min_y, 0, static_cast<int>(size_y));
+  const unsigned int new_max_x = std::clamp(max_x, 0, static_cast<int>(size_x));
+  const unsigned int new_max_y = std::clamp(max_y, 0, static_cast<int>(size_y));
+
+  // Previous projection bounds in the shifted master grid cells, empty when not kept
+  int kept_min_x = 0, kept_min_y = 0, kept_max_x = 0, kept_max_y = 0;
+  if (shifted) {
+    kept_min_x = static_cast<int>(projected_min_x_) - shift_x;
+    kept_min_y = static_cast<int>(projected_min_y_) - shift_y;
+    kept_max_x = static_cast<int>(projected_max_x_) - shift_x;
+    kept_max_y = static_cast<int>(projected_max_y_) - shift_y;
+  }
+
+  projected_scratch_.resize(static_cast<size_t>(size_x) * size_y);
+  for (unsigned int j = new_min_y; j < new_max_y; j++) {
+    unsigned char * row = projected_scratch_.data() + static_cast<size_t>(j) * size_x;
+    unsigned int kept_begin = new_min_x, kept_end = new_min_x;
+    if (static_cast<int>(j) >= kept_min_y && static_cast<int>(j) < kept_max_y) {
+      const int begin_x = static_cast<int>(new_min_x), end_x = static_cast<int>(new_max_x);
+      kept_begin = std::clamp(kept_min_x, begin_x, end_x);
+      kept_end = std::clamp(kept_max_x, static_cast<int>(kept_begin), end_x);
+    }
+    for (unsigned int i = new_min_x; i < kept_begin; i++) {
+      row[i] = projectCell(master_grid, transform, i, j);
+    }
+    if (kept_begin < kept_end) {
+      const unsigned char * kept = projected_mask_.data() +
+        static_cast<size_t>(j + shift_y) * size_x + (kept_begin + shift_x);
+      std::copy(kept, kept + (kept_end - kept_begin), row + kept_begin);
+    }
+    for (unsigned int i = kept_end; i < new_max_x; i++) {
+      row[i] = projectCell(master_grid, transform, i, j);
     }
-    mg_max_x = std::min(max_i, mg_max_x);
-    mg_max_y = std::min(max_j, mg_max_y);
+  }
+  projected_mask_.swap(projected_scratch_);
+
+  projected_valid_ = true;
+  projected_size_x_ = size_x;
+  projected_size_y_ = size_y;
+  projected_resolution_ = resolution;
+  projected_origin_x_ = origin_x;
+  projected_origin_y_ = origin_y;
+  projected_transform_ = transform;
+  projected_min_x_ = new_min_x;
+  projected_min_y_ = new_min_y;
+  projected_max_x_ = new_max_x;
+  projected_max_y_ = new_max_y;
+}
+
+unsigned char KeepoutFilter::projectCell(
+  const nav2_costmap_2d::Costmap2D & master_grid, const tf2::Transform & transform,
+  unsigned int i, unsigned int j) const
+{
+  // Get world coordinates of (i, j) point in global_frame_
+  double gl_wx, gl_wy;
+  master_grid.mapToWorld(i, j, gl_wx, gl_wy);
+  // Transform (i, j) point from global_frame_ to mask_frame_
+  tf2::Vector3 point(gl_wx, gl_wy, 0);
+  point = transform * point;
+  // Get mask coordinates corresponding to (i, j) point at mask_costmap_
+  unsigned int mx, my;
+  if (!mask_costmap_->worldToMap(point.x(), point.y(), mx, my)) {
+    return NO_INFORMATION;
+  }
+  return mask_costmap_->getCost(mx, my);
+}
+
+void KeepoutFilter::processProjectedMask(
+  nav2_costmap_2d::Costmap2D & master_grid,
+  int min_i, int min_j, int max_i, int max_j) const
+{
+  // Iterate only in overlapped (min_i, min_j)..(max_i, max_j) & projected mask area
+  const int begin_x = std::max(min_i, static_cast<int>(projected_min_x_));
+  const int end_x = std::min(max_i, static_cast<int>(projected_max_x_));
+  const int begin_y = std::max(min_j, static_cast<int>(projected_min_y_));
+  const int end_y = std::min(max_j, static_cast<int>(projected_max_y_));
+  if (begin_x >= end_x) {
+    return;
   }
 
-  // unsigned<-signed conversions.
-  unsigned const int mg_min_x_u = static_cast<unsigned int>(mg_min_x);
-  unsigned const int mg_min_y_u = static_cast<unsigned int>(mg_min_y);
-  unsigned const int mg_max_x_u = static_cast<unsigned int>(mg_max_x);
-  unsigned const int mg_max_y_u = static_cast<unsigned int>(mg_max_y);
-
-  unsigned int i, j;  // master_grid iterators
-  unsigned int index;  // corresponding index of master_grid
-  double gl_wx, gl_wy;  // world coordinates in a global_frame_
-  double msk_wx, msk_wy;  // world coordinates in a mask_frame_
-  unsigned int mx, my;  // mask_costmap_ coordinates
-  unsigned char data, old_data;  // master_grid element data
-
-  // Main master_grid updating loop
-  // Iterate in costmap window by master_grid indexes
   unsigned char * master_array = master_grid.getCharMap();
-  for (i = mg_min_x_u; i < mg_max_x_u; i++) {
-    for (j = mg_min_y_u; j < mg_max_y_u; j++) {
-      index = master_grid.getIndex(i, j);
-      old_data = master_array[index];
-      // Calculating corresponding to (i, j) point at mask_costmap_:
-      // Get world coordinates in global_frame_
-      master_grid.mapToWorld(i, j, gl_wx, gl_wy);
-      if (mask_frame_ != global_frame_) {
-        // Transform (i, j) point from global_frame_ to mask_frame_
-        tf2::Vector3 point(gl_wx, gl_wy, 0);
-        point = tf2_transform * point;
-        msk_wx = point.x();
-        msk_wy = point.y();
-      } else {
-        // In this case master_grid and filter-mask are in the same frame
-        msk_wx = gl_wx;
-        msk_wy = gl_wy;
-      }
-      // Get mask coordinates corresponding to (i, j) point at mask_costmap_
-      if (mask_costmap_->worldToMap(msk_wx, msk_wy, mx, my)) {
-        data = mask_costmap_->getCost(mx, my);
-        // Update if mask_ data is valid and greater than existing master_grid's one
-        if (data == NO_INFORMATION) {
-          continue;
-        }
-        if (data > old_data || old_data == NO_INFORMATION) {
-          master_array[index] = data;
-        }
-      }
+  for (int j = begin_y; j < end_y; j++) {
+    const size_t row = static_cast<size_t>(j) * projected_size_x_;
+    const unsigned char * mask_row = projected_mask_.data() + row;
+    unsigned char * master_row = master_array + row;
+    for (int i = begin_x; i < end_x; i++) {
+      // Update if mask data is known and greater than existing master_grid's one, or the latter
+      // is unknown: offsetting both values by one maps NO_INFORMATION to 0 for a plain maximum
+      const unsigned char data = static_cast<unsigned char>(mask_row[i] + 1);
+      const unsigned char old_data = static_cast<unsigned char>(master_row[i] + 1);
+      master_row[i] = static_cast<unsigned char>(std::max(data, old_data) - 1);
     }
   }
 }
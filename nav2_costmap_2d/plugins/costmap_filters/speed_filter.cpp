@@ -41,6 +41,7 @@
 #include <utility>
 #include <memory>
 #include <string>
+#include <vector>
 #include "tf2_geometry_msgs/tf2_geometry_msgs.hpp"
 #include "geometry_msgs/msg/point_stamped.hpp"
 
@@ -52,7 +53,7 @@ namespace nav2_costmap_2d
 SpeedFilter::SpeedFilter()
 : filter_info_sub_(nullptr), mask_sub_(nullptr),
   speed_limit_pub_(nullptr), filter_mask_(nullptr), mask_frame_(""), global_frame_(""),
-  speed_limit_(NO_SPEED_LIMIT), speed_limit_prev_(NO_SPEED_LIMIT)
+  speed_limit_(NO_SPEED_LIMIT), speed_limit_prev_(NO_SPEED_LIMIT), zone_prev_(NO_ZONE)
 {
 }
 
@@ -141,6 +142,9 @@ void SpeedFilter::filterInfoCallback(
     return;
   }
 
+  // Speed limits of the zones are changed: calculate it again in the next zone visited
+  zone_prev_ = NO_ZONE;
+
   mask_topic_ = msg->filter_mask_topic;
 
   // Setting new filter mask subscriber
@@ -172,6 +176,61 @@ void SpeedFilter::maskCallback(
 
   filter_mask_ = msg;
   mask_frame_ = msg->header.frame_id;
+  buildZones();
+  requestUpdate();
+}
+
+void SpeedFilter::buildZones()
+{
+  const unsigned int size_x = filter_mask_->info.width;
+  const unsigned int size_y = filter_mask_->info.height;
+  const std::vector<int8_t> & data = filter_mask_->data;
+
+  mask_zones_.assign(static_cast<size_t>(size_x) * size_y, NO_ZONE);
+  zone_prev_ = NO_ZONE;
+  if (data.size() < mask_zones_.size()) {
+    RCLCPP_ERROR(
+      logger_,
+      "SpeedFilter: Filter mask data size (%zu) does not match its %u X %u dimensions",
+      data.size(), size_x, size_y);
+    mask_zones_.clear();
+    return;
+  }
+
+  unsigned int zones_num = 0;
+  std::vector<unsigned int> stack;
+  for (unsigned int start = 0; start < mask_zones_.size(); start++) {
+    if (mask_zones_[start] != NO_ZONE) {
+      continue;
+    }
+    // Flood fill the cells connected to start having the same data
+    const int8_t value = data[start];
+    mask_zones_[start] = zones_num;
+    stack.push_back(start);
+    while (!stack.empty()) {
+      const unsigned int index = stack.back();
+      stack.pop_back();
+      const unsigned int mx = index % size_x;
+      const unsigned int my = index / size_x;
+      const unsigned int neighbours[4] = {
+        mx > 0 ? index - 1 : NO_ZONE,
+        mx + 1 < size_x ? index + 1 : NO_ZONE,
+        my > 0 ? index - size_x : NO_ZONE,
+        my + 1 < size_y ? index + size_x : NO_ZONE};
+      for (const unsigned int n : neighbours) {
+        if (n != NO_ZONE && mask_zones_[n] == NO_ZONE && data[n] == value) {
+          mask_zones_[n] = zones_num;
+          stack.push_back(n);
+        }
+      }
+    }
+    zones_num++;
+  }
+
+  RCLCPP_DEBUG(
+    logger_,
+    "SpeedFilter: Found %u speed zones in the %u X %u filter mask",
+    zones_num, size_x, size_y);
 }
 
 bool SpeedFilter::transformPose(
@@ -266,6 +325,16 @@ void SpeedFilter::process(
     return;
   }
 
+  // All cells of a speed zone have the same mask data:
+  // while the robot stays in the same zone, speed limit is not changed
+  if (!mask_zones_.empty()) {
+    const unsigned int zone = mask_zones_[mask_robot_j * filter_mask_->info.width + mask_robot_i];
+    if (zone == zone_prev_) {
+      return;
+    }
+    zone_prev_ = zone;
+  }
+
   // Getting filter_mask data from cell where the robot placed and
   // calculating speed limit value
   int8_t speed_mask_data = getMaskData(mask_robot_i, mask_robot_j);
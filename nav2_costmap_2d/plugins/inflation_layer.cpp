@@ -37,6 +37,8 @@
  *********************************************************************/
 #include "nav2_costmap_2d/inflation_layer.hpp"
 
+#include <cmath>
+#include <functional>
 #include <limits>
 #include <map>
 #include <vector>
@@ -71,7 +73,14 @@ InflationLayer::InflationLayer()
   last_min_x_(std::numeric_limits<double>::lowest()),
   last_min_y_(std::numeric_limits<double>::lowest()),
   last_max_x_(std::numeric_limits<double>::max()),
-  last_max_y_(std::numeric_limits<double>::max())
+  last_max_y_(std::numeric_limits<double>::max()),
+  use_distance_transform_(false),
+  incremental_inflation_(false),
+  inflated_costs_valid_(false),
+  inflated_costs_(0, 0, 0.0, 0.0, 0.0, FREE_SPACE),
+  block_size_(0),
+  blocks_x_(0),
+  blocks_y_(0)
 {
   access_ = new mutex_t();
 }
@@ -90,6 +99,8 @@ InflationLayer::onInitialize()
   declareParameter("cost_scaling_factor", rclcpp::ParameterValue(10.0));
   declareParameter("inflate_unknown", rclcpp::ParameterValue(false));
   declareParameter("inflate_around_unknown", rclcpp::ParameterValue(false));
+  declareParameter("incremental_inflation", rclcpp::ParameterValue(false));
+  declareParameter("use_distance_transform", rclcpp::ParameterValue(false));
 
   {
     auto node = node_.lock();
@@ -101,6 +112,8 @@ InflationLayer::onInitialize()
     node->get_parameter(name_ + "." + "cost_scaling_factor", cost_scaling_factor_);
     node->get_parameter(name_ + "." + "inflate_unknown", inflate_unknown_);
     node->get_parameter(name_ + "." + "inflate_around_unknown", inflate_around_unknown_);
+    node->get_parameter(name_ + "." + "incremental_inflation", incremental_inflation_);
+    node->get_parameter(name_ + "." + "use_distance_transform", use_distance_transform_);
 
     dyn_params_handler_ = node->add_on_set_parameters_callback(
       std::bind(
@@ -117,6 +130,24 @@ InflationLayer::onInitialize()
   matchSize();
 }
 
+size_t
+InflationLayer::getMemoryUsage()
+{
+  std::lock_guard<Costmap2D::mutex_t> guard(*getMutex());
+  size_t bytes = seen_.size() * sizeof(uint16_t) + cached_costs_.capacity() +
+    cached_distances_.capacity() * sizeof(double) + cached_sq_distance_costs_.capacity() +
+    (column_distances_.capacity() + sq_distances_.capacity()) * sizeof(int) +
+    (seeds_.capacity() + dirty_blocks_.capacity()) / 8 +
+    static_cast<size_t>(inflated_costs_.getSizeInCellsX()) * inflated_costs_.getSizeInCellsY();
+  for (const auto & row : distance_matrix_) {
+    bytes += row.capacity() * sizeof(int);
+  }
+  for (const auto & level : inflation_cells_) {
+    bytes += level.capacity() * sizeof(CellData);
+  }
+  return bytes;
+}
+
 void
 InflationLayer::matchSize()
 {
@@ -125,7 +156,7 @@ InflationLayer::matchSize()
   resolution_ = costmap->getResolution();
   cell_inflation_radius_ = cellDistance(inflation_radius_);
   computeCaches();
-  seen_ = std::vector<bool>(costmap->getSizeInCellsX() * costmap->getSizeInCellsY(), false);
+  seen_.resize(costmap->getSizeInCellsX() * costmap->getSizeInCellsY());
 }
 
 void
@@ -165,6 +196,13 @@ void
 InflationLayer::onFootprintChanged()
 {
   std::lock_guard<Costmap2D::mutex_t> guard(*getMutex());
+  // The same footprint set again does not change the inflation
+  const uint64_t footprint_version = layered_costmap_->getFootprintGeometry()->getVersion();
+  if (footprint_version == footprint_version_) {
+    return;
+  }
+  footprint_version_ = footprint_version;
+
   inscribed_radius_ = layered_costmap_->getInscribedRadius();
   cell_inflation_radius_ = cellDistance(inflation_radius_);
   computeCaches();
@@ -194,16 +232,82 @@ InflationLayer::updateCosts(
       !dist.empty(), "The inflation list must be empty at the beginning of inflation");
   }
 
-  unsigned char * master_array = master_grid.getCharMap();
   unsigned int size_x = master_grid.getSizeInCellsX(), size_y = master_grid.getSizeInCellsY();
 
   if (seen_.size() != size_x * size_y) {
     RCLCPP_WARN(
       logger_, "InflationLayer::updateCosts(): seen_ vector size is wrong");
-    seen_ = std::vector<bool>(size_x * size_y, false);
+    seen_.resize(size_x * size_y);
+  }
+
+  if (incremental_inflation_) {
+    updateCostsIncremental(master_grid, min_i, min_j, max_i, max_j);
+    current_ = true;
+    return;
+  }
+
+  if (use_distance_transform_) {
+    inflateDistanceTransform(master_grid, min_i, min_j, max_i, max_j);
+    current_ = true;
+    return;
   }
 
-  std::fill(begin(seen_), end(seen_), false);
+  inflate(master_grid, min_i, min_j, max_i, max_j, seen_, inflation_cells_);
+
+  current_ = true;
+}
+
+void
+InflationLayer::beginTiledUpdate(
+  nav2_costmap_2d::Costmap2D & /*master_grid*/, int /*min_i*/, int /*min_j*/,
+  int /*max_i*/,
+  int /*max_j*/)
+{
+  // Held until endTiledUpdate(), while tiles are inflated from other threads
+  getMutex()->lock();
+}
+
+void
+InflationLayer::updateCostsTile(
+  nav2_costmap_2d::Costmap2D & master_grid, int min_i, int min_j,
+  int max_i,
+  int max_j)
+{
+  if (!enabled_ || (cell_inflation_radius_ == 0)) {
+    return;
+  }
+
+  // Each thread keeps its own scratch space, as tiles are inflated concurrently
+  thread_local VisitationMap seen;
+  thread_local std::vector<std::vector<CellData>> inflation_cells;
+  seen.resize(master_grid.getSizeInCellsX() * master_grid.getSizeInCellsY());
+  if (inflation_cells.size() != inflation_cells_.size()) {
+    inflation_cells.resize(inflation_cells_.size());
+  }
+
+  inflate(master_grid, min_i, min_j, max_i, max_j, seen, inflation_cells);
+}
+
+void
+InflationLayer::endTiledUpdate()
+{
+  if (enabled_ && (cell_inflation_radius_ != 0)) {
+    current_ = true;
+  }
+  getMutex()->unlock();
+}
+
+void
+InflationLayer::inflate(
+  nav2_costmap_2d::Costmap2D & master_grid, int min_i, int min_j,
+  int max_i,
+  int max_j,
+  VisitationMap & seen,
+  std::vector<std::vector<CellData>> & inflation_cells)
+{
+  unsigned char * master_array = master_grid.getCharMap();
+  unsigned int size_x = master_grid.getSizeInCellsX(), size_y = master_grid.getSizeInCellsY();
+  seen.clear();
 
   // We need to include in the inflation cells outside the bounding
   // box min_i...max_j, by the amount cell_inflation_radius_.  Cells
@@ -229,7 +333,7 @@ InflationLayer::updateCosts(
   // with a notable performance boost
 
   // Start with lethal obstacles: by definition distance is 0.0
-  auto & obs_bin = inflation_cells_[0];
+  auto & obs_bin = inflation_cells[0];
   for (int j = min_j; j < max_j; j++) {
     for (int i = min_i; i < max_i; i++) {
       int index = static_cast<int>(master_grid.getIndex(i, j));
@@ -243,7 +347,7 @@ InflationLayer::updateCosts(
   // Process cells by increasing distance; new cells are appended to the
   // corresponding distance bin, so they
   // can overtake previously inserted but farther away cells
-  for (const auto & dist_bin : inflation_cells_) {
+  for (const auto & dist_bin : inflation_cells) {
     for (std::size_t i = 0; i < dist_bin.size(); ++i) {
       // Do not use iterator or for-range based loops to
       // iterate though dist_bin, since it's size might
@@ -251,11 +355,11 @@ InflationLayer::updateCosts(
       unsigned int index = dist_bin[i].index_;
 
       // ignore if already visited
-      if (seen_[index]) {
+      if (seen.isVisited(index)) {
         continue;
       }
 
-      seen_[index] = true;
+      seen.setVisited(index);
 
       unsigned int mx = dist_bin[i].x_;
       unsigned int my = dist_bin[i].y_;
@@ -284,26 +388,295 @@ InflationLayer::updateCosts(
 
       // attempt to put the neighbors of the current cell onto the inflation list
       if (mx > 0) {
-        enqueue(index - 1, mx - 1, my, sx, sy);
+        enqueue(index - 1, mx - 1, my, sx, sy, seen, inflation_cells);
       }
       if (my > 0) {
-        enqueue(index - size_x, mx, my - 1, sx, sy);
+        enqueue(index - size_x, mx, my - 1, sx, sy, seen, inflation_cells);
       }
       if (mx < size_x - 1) {
-        enqueue(index + 1, mx + 1, my, sx, sy);
+        enqueue(index + 1, mx + 1, my, sx, sy, seen, inflation_cells);
       }
       if (my < size_y - 1) {
-        enqueue(index + size_x, mx, my + 1, sx, sy);
+        enqueue(index + size_x, mx, my + 1, sx, sy, seen, inflation_cells);
       }
     }
   }
 
-  for (auto & dist : inflation_cells_) {
+  for (auto & dist : inflation_cells) {
     dist.clear();
     dist.reserve(200);
   }
+}
 
-  current_ = true;
+void
+InflationLayer::inflateDistanceTransform(
+  nav2_costmap_2d::Costmap2D & master_grid, int min_i, int min_j,
+  int max_i,
+  int max_j)
+{
+  unsigned char * master_array = master_grid.getCharMap();
+  unsigned int size_x = master_grid.getSizeInCellsX(), size_y = master_grid.getSizeInCellsY();
+
+  // Obstacles up to the inflation radius outside the window can influence the costs inside it
+  const int r = static_cast<int>(cell_inflation_radius_);
+  const int pad_min_i = std::max(0, min_i - r);
+  const int pad_min_j = std::max(0, min_j - r);
+  const int pad_max_i = std::min(static_cast<int>(size_x), max_i + r);
+  const int pad_max_j = std::min(static_cast<int>(size_y), max_j + r);
+  const int width = pad_max_i - pad_min_i;
+  const int height = pad_max_j - pad_min_j;
+  if (width <= 0 || height <= 0) {
+    return;
+  }
+
+  column_distances_.resize(width * height);
+  sq_distances_.resize(width * height);
+
+  // Distances beyond the inflation radius have no cost, so they are clamped just above it
+  const int far = r + 1;
+  const int far_sq = far * far;
+  const int radius_sq = r * r;
+
+  // Bands of columns and rows are independent, so they run on the tile threads if enabled
+  TileThreadPool * pool = layered_costmap_->getTileThreadPool();
+  auto run_bands = [&](int count, const std::function<void(unsigned int)> & band) {
+      if (pool) {
+        pool->run(count, band);
+      } else {
+        for (int i = 0; i < count; ++i) {
+          band(i);
+        }
+      }
+    };
+  const int band_size = 64;
+
+  // 1. Vertical distance to the nearest obstacle in each column, scanning rows
+  // down and up so that the inner loops run along contiguous cells
+  run_bands(
+    (width + band_size - 1) / band_size, [&](unsigned int band) {
+      const int x0 = band * band_size;
+      const int x1 = std::min(width, x0 + band_size);
+      for (int y = 0; y < height; ++y) {
+        const unsigned char * costs =
+          master_array + master_grid.getIndex(pad_min_i, pad_min_j + y);
+        int * column = column_distances_.data() + y * width;
+        const int * above = y > 0 ? column - width : nullptr;
+        for (int x = x0; x < x1; ++x) {
+          const unsigned char cost = costs[x];
+          if (cost == LETHAL_OBSTACLE || (inflate_around_unknown_ && cost == NO_INFORMATION)) {
+            column[x] = 0;
+          } else {
+            column[x] = above ? std::min(above[x] + 1, far) : far;
+          }
+        }
+      }
+      for (int y = height - 2; y >= 0; --y) {
+        int * column = column_distances_.data() + y * width;
+        const int * below = column + width;
+        for (int x = x0; x < x1; ++x) {
+          column[x] = std::min(column[x], below[x] + 1);
+        }
+      }
+    });
+
+  // 2. Squared distance to the nearest obstacle of each row from the lower envelope
+  // of the parabolas of the column distances (Felzenszwalb and Huttenlocher)
+  run_bands(
+    (height + band_size - 1) / band_size, [&](unsigned int band) {
+      std::vector<int> sites(width);
+      std::vector<double> bounds(width + 1);
+      const int y0 = band * band_size;
+      const int y1 = std::min(height, y0 + band_size);
+      for (int y = y0; y < y1; ++y) {
+        const int * column = column_distances_.data() + y * width;
+        int * sq_distances = sq_distances_.data() + y * width;
+        auto f = [&](int x) {return column[x] * column[x];};
+
+        int k = 0;
+        sites[0] = 0;
+        bounds[0] = -std::numeric_limits<double>::max();
+        bounds[1] = std::numeric_limits<double>::max();
+        for (int q = 1; q < width; ++q) {
+          auto intersection = [&](int v) {
+              return static_cast<double>((f(q) + q * q) - (f(v) + v * v)) / (2 * (q - v));
+            };
+          double s = intersection(sites[k]);
+          while (s <= bounds[k]) {
+            k--;
+            s = intersection(sites[k]);
+          }
+          k++;
+          sites[k] = q;
+          bounds[k] = s;
+          bounds[k + 1] = std::numeric_limits<double>::max();
+        }
+
+        k = 0;
+        for (int q = 0; q < width; ++q) {
+          while (bounds[k + 1] < q) {
+            k++;
+          }
+          const int dx = q - sites[k];
+          sq_distances[q] = std::min(dx * dx + f(sites[k]), far_sq);
+        }
+      }
+    });
+
+  // 3. Assign the cost of the distance to each cell of the window as inflate() does,
+  // in bands of rows as well, which only write their own cells
+  run_bands(
+    (std::max(max_j - min_j, 0) + band_size - 1) / band_size, [&](unsigned int band) {
+      const int j0 = min_j + static_cast<int>(band) * band_size;
+      const int j1 = std::min(max_j, j0 + band_size);
+      for (int j = j0; j < j1; j++) {
+        const int * sq_distances = sq_distances_.data() + (j - pad_min_j) * width - pad_min_i;
+        for (int i = min_i; i < max_i; i++) {
+          const int sq_distance = sq_distances[i];
+          if (sq_distance > radius_sq) {
+            continue;
+          }
+          unsigned int index = master_grid.getIndex(i, j);
+          unsigned char cost = cached_sq_distance_costs_[sq_distance];
+          unsigned char old_cost = master_array[index];
+          if (old_cost == NO_INFORMATION &&
+            (inflate_unknown_ ? (cost > FREE_SPACE) : (cost >= INSCRIBED_INFLATED_OBSTACLE)))
+          {
+            master_array[index] = cost;
+          } else {
+            master_array[index] = std::max(old_cost, cost);
+          }
+        }
+      }
+    });
+}
+
+void
+InflationLayer::updateCostsIncremental(
+  nav2_costmap_2d::Costmap2D & master_grid, int min_i, int min_j,
+  int max_i,
+  int max_j)
+{
+  unsigned char * master_array = master_grid.getCharMap();
+  unsigned int size_x = master_grid.getSizeInCellsX(), size_y = master_grid.getSizeInCellsY();
+
+  if (min_i >= max_i || min_j >= max_j) {
+    return;
+  }
+
+  // Start over with every block dirty on a new map, a moved rolling window,
+  // or once the costs inflated around obstacles changed
+  if (!inflated_costs_valid_ ||
+    inflated_costs_.getSizeInCellsX() != size_x ||
+    inflated_costs_.getSizeInCellsY() != size_y ||
+    inflated_costs_.getOriginX() != master_grid.getOriginX() ||
+    inflated_costs_.getOriginY() != master_grid.getOriginY())
+  {
+    inflated_costs_.resizeMap(
+      size_x, size_y, master_grid.getResolution(),
+      master_grid.getOriginX(), master_grid.getOriginY());
+    seeds_.assign(size_x * size_y, false);
+    block_size_ = std::max(32u, 2 * cell_inflation_radius_);
+    blocks_x_ = (size_x + block_size_ - 1) / block_size_;
+    blocks_y_ = (size_y + block_size_ - 1) / block_size_;
+    dirty_blocks_.assign(blocks_x_ * blocks_y_, true);
+    inflated_costs_valid_ = true;
+  }
+
+  // Track the seeds of the blocks covering the window and of their surroundings,
+  // which are all that their inflation reads
+  const int r = static_cast<int>(cell_inflation_radius_);
+  const int block_size = static_cast<int>(block_size_);
+  const int min_bx = min_i / block_size, max_bx = (max_i - 1) / block_size;
+  const int min_by = min_j / block_size, max_by = (max_j - 1) / block_size;
+  const int scan_min_i = std::max(0, min_bx * block_size - r);
+  const int scan_min_j = std::max(0, min_by * block_size - r);
+  const int scan_max_i = std::min(static_cast<int>(size_x), (max_bx + 1) * block_size + r);
+  const int scan_max_j = std::min(static_cast<int>(size_y), (max_by + 1) * block_size + r);
+
+  for (int j = scan_min_j; j < scan_max_j; j++) {
+    for (int i = scan_min_i; i < scan_max_i; i++) {
+      unsigned int index = master_grid.getIndex(i, j);
+      unsigned char cost = master_array[index];
+      const bool seed =
+        cost == LETHAL_OBSTACLE || (inflate_around_unknown_ && cost == NO_INFORMATION);
+      if (seed != seeds_[index]) {
+        seeds_[index] = seed;
+        markBlocksDirty(i, j);
+      }
+    }
+  }
+
+  for (int by = min_by; by <= max_by; by++) {
+    for (int bx = min_bx; bx <= max_bx; bx++) {
+      if (dirty_blocks_[by * blocks_x_ + bx]) {
+        reinflateBlock(bx, by);
+        dirty_blocks_[by * blocks_x_ + bx] = false;
+      }
+    }
+  }
+
+  // Cells away from obstacles have no inflated cost, so merging them as
+  // inflate() does keeps their cost just as if they were never visited
+  const unsigned char * inflated_array = inflated_costs_.getCharMap();
+  for (int j = min_j; j < max_j; j++) {
+    for (int i = min_i; i < max_i; i++) {
+      unsigned int index = master_grid.getIndex(i, j);
+      unsigned char cost = inflated_array[index];
+      unsigned char old_cost = master_array[index];
+      if (old_cost == NO_INFORMATION &&
+        (inflate_unknown_ ? (cost > FREE_SPACE) : (cost >= INSCRIBED_INFLATED_OBSTACLE)))
+      {
+        master_array[index] = cost;
+      } else {
+        master_array[index] = std::max(old_cost, cost);
+      }
+    }
+  }
+}
+
+void
+InflationLayer::reinflateBlock(unsigned int bx, unsigned int by)
+{
+  unsigned char * costs = inflated_costs_.getCharMap();
+  const int size_x = static_cast<int>(inflated_costs_.getSizeInCellsX());
+  const int size_y = static_cast<int>(inflated_costs_.getSizeInCellsY());
+  const int r = static_cast<int>(cell_inflation_radius_);
+  const int min_i = bx * block_size_;
+  const int min_j = by * block_size_;
+  const int max_i = std::min(size_x, min_i + static_cast<int>(block_size_));
+  const int max_j = std::min(size_y, min_j + static_cast<int>(block_size_));
+
+  // Clear the block and seed it and its surroundings with the tracked obstacles.
+  // Cells left lethal by a removed seed are only found in blocks dirty themselves.
+  for (int j = std::max(0, min_j - r); j < std::min(size_y, max_j + r); j++) {
+    for (int i = std::max(0, min_i - r); i < std::min(size_x, max_i + r); i++) {
+      unsigned int index = inflated_costs_.getIndex(i, j);
+      if (seeds_[index]) {
+        costs[index] = LETHAL_OBSTACLE;
+      } else if (costs[index] == LETHAL_OBSTACLE ||
+        (i >= min_i && i < max_i && j >= min_j && j < max_j))
+      {
+        costs[index] = FREE_SPACE;
+      }
+    }
+  }
+
+  inflate(inflated_costs_, min_i, min_j, max_i, max_j, seen_, inflation_cells_);
+}
+
+void
+InflationLayer::markBlocksDirty(unsigned int mx, unsigned int my)
+{
+  const unsigned int r = cell_inflation_radius_;
+  const unsigned int min_bx = (mx > r ? mx - r : 0) / block_size_;
+  const unsigned int min_by = (my > r ? my - r : 0) / block_size_;
+  const unsigned int max_bx = std::min(mx + r, inflated_costs_.getSizeInCellsX() - 1) / block_size_;
+  const unsigned int max_by = std::min(my + r, inflated_costs_.getSizeInCellsY() - 1) / block_size_;
+  for (unsigned int by = min_by; by <= max_by; by++) {
+    for (unsigned int bx = min_bx; bx <= max_bx; bx++) {
+      dirty_blocks_[by * blocks_x_ + bx] = true;
+    }
+  }
 }
 
 /**
@@ -318,9 +691,11 @@ InflationLayer::updateCosts(
 void
 InflationLayer::enqueue(
   unsigned int index, unsigned int mx, unsigned int my,
-  unsigned int src_x, unsigned int src_y)
+  unsigned int src_x, unsigned int src_y,
+  const VisitationMap & seen,
+  std::vector<std::vector<CellData>> & inflation_cells)
 {
-  if (!seen_[index]) {
+  if (!seen.isVisited(index)) {
     // we compute our distance table one cell further than the
     // inflation radius dictates so we can make the check below
     double distance = distanceLookup(mx, my, src_x, src_y);
@@ -334,7 +709,7 @@ InflationLayer::enqueue(
     const unsigned int r = cell_inflation_radius_ + 2;
 
     // push the cell data onto the inflation list and mark
-    inflation_cells_[distance_matrix_[mx - src_x + r][my - src_y + r]].emplace_back(
+    inflation_cells[distance_matrix_[mx - src_x + r][my - src_y + r]].emplace_back(
       index, mx, my, src_x, src_y);
   }
 }
@@ -343,6 +718,7 @@ void
 InflationLayer::computeCaches()
 {
   std::lock_guard<Costmap2D::mutex_t> guard(*getMutex());
+  inflated_costs_valid_ = false;
   if (cell_inflation_radius_ == 0) {
     return;
   }
@@ -369,6 +745,11 @@ InflationLayer::computeCaches()
     }
   }
 
+  cached_sq_distance_costs_.resize(cell_inflation_radius_ * cell_inflation_radius_ + 1);
+  for (unsigned int i = 0; i < cached_sq_distance_costs_.size(); ++i) {
+    cached_sq_distance_costs_[i] = computeCost(std::sqrt(static_cast<double>(i)));
+  }
+
   int max_dist = generateIntegerDistances();
   inflation_cells_.clear();
   inflation_cells_.resize(max_dist + 1);
@@ -463,6 +844,16 @@ InflationLayer::dynamicParametersCallback(
       {
         inflate_around_unknown_ = parameter.as_bool();
         need_reinflation_ = true;
+      } else if (param_name == name_ + "." + "use_distance_transform" && // NOLINT
+        use_distance_transform_ != parameter.as_bool())
+      {
+        use_distance_transform_ = parameter.as_bool();
+        need_reinflation_ = true;
+      } else if (param_name == name_ + "." + "incremental_inflation" && // NOLINT
+        incremental_inflation_ != parameter.as_bool())
+      {
+        incremental_inflation_ = parameter.as_bool();
+        inflated_costs_valid_ = false;
       }
     }
   }
@@ -39,8 +39,11 @@
 #include "nav2_costmap_2d/obstacle_layer.hpp"
 
 #include <algorithm>
+#include <chrono>
+#include <cmath>
 #include <memory>
 #include <string>
+#include <utility>
 #include <vector>
 
 #include "pluginlib/class_list_macros.hpp"
@@ -59,6 +62,18 @@ using nav2_costmap_2d::Observation;
 namespace nav2_costmap_2d
 {
 
+// Filter positive infinities ("Inf"s) to max_range.
+static void filterInfRanges(sensor_msgs::msg::LaserScan & message)
+{
+  float epsilon = 0.0001;  // a tenth of a millimeter
+  for (size_t i = 0; i < message.ranges.size(); i++) {
+    float range = message.ranges[i];
+    if (!std::isfinite(range) && range > 0) {
+      message.ranges[i] = message.range_max - epsilon;
+    }
+  }
+}
+
 ObstacleLayer::~ObstacleLayer()
 {
   for (auto & notifier : observation_notifiers_) {
@@ -80,6 +95,12 @@ void ObstacleLayer::onInitialize()
   declareParameter("max_obstacle_height", rclcpp::ParameterValue(2.0));
   declareParameter("combination_method", rclcpp::ParameterValue(1));
   declareParameter("observation_sources", rclcpp::ParameterValue(std::string("")));
+  declareParameter("snapshot_file", rclcpp::ParameterValue(std::string("")));
+  declareParameter("snapshot_period", rclcpp::ParameterValue(5.0));
+  declareParameter("restore_snapshot", rclcpp::ParameterValue(false));
+  declareParameter("snapshot_max_age", rclcpp::ParameterValue(60.0));
+  declareParameter("snapshot_max_robot_offset", rclcpp::ParameterValue(0.25));
+  declareParameter("parallel_observations", rclcpp::ParameterValue(false));
 
   auto node = node_.lock();
   if (!node) {
@@ -93,6 +114,15 @@ void ObstacleLayer::onInitialize()
   node->get_parameter("track_unknown_space", track_unknown_space);
   node->get_parameter("transform_tolerance", transform_tolerance);
   node->get_parameter(name_ + "." + "observation_sources", topics_string);
+  node->get_parameter(name_ + "." + "snapshot_file", snapshot_file_);
+  node->get_parameter(name_ + "." + "snapshot_period", snapshot_period_);
+  node->get_parameter(name_ + "." + "restore_snapshot", restore_snapshot_);
+  node->get_parameter(name_ + "." + "snapshot_max_age", snapshot_max_age_);
+  node->get_parameter(name_ + "." + "snapshot_max_robot_offset", snapshot_max_robot_offset_);
+  node->get_parameter(name_ + "." + "parallel_observations", parallel_observations_);
+  if (!snapshot_file_.empty()) {
+    snapshot_writer_ = std::make_unique<LayerSnapshotWriter>(snapshot_file_, logger_);
+  }
 
   RCLCPP_INFO(
     logger_,
@@ -120,7 +150,7 @@ void ObstacleLayer::onInitialize()
     // get the parameters for the specific topic
     double observation_keep_time, expected_update_rate, min_obstacle_height, max_obstacle_height;
     std::string topic, sensor_frame, data_type;
-    bool inf_is_valid, clearing, marking;
+    bool inf_is_valid, high_fidelity, clearing, marking, voxel_filter, frustum_clearing;
 
     declareParameter(source + "." + "topic", rclcpp::ParameterValue(source));
     declareParameter(source + "." + "sensor_frame", rclcpp::ParameterValue(std::string("")));
@@ -130,12 +160,15 @@ void ObstacleLayer::onInitialize()
     declareParameter(source + "." + "min_obstacle_height", rclcpp::ParameterValue(0.0));
     declareParameter(source + "." + "max_obstacle_height", rclcpp::ParameterValue(0.0));
     declareParameter(source + "." + "inf_is_valid", rclcpp::ParameterValue(false));
+    declareParameter(source + "." + "high_fidelity", rclcpp::ParameterValue(true));
     declareParameter(source + "." + "marking", rclcpp::ParameterValue(true));
     declareParameter(source + "." + "clearing", rclcpp::ParameterValue(false));
     declareParameter(source + "." + "obstacle_max_range", rclcpp::ParameterValue(2.5));
     declareParameter(source + "." + "obstacle_min_range", rclcpp::ParameterValue(0.0));
     declareParameter(source + "." + "raytrace_max_range", rclcpp::ParameterValue(3.0));
     declareParameter(source + "." + "raytrace_min_range", rclcpp::ParameterValue(0.0));
+    declareParameter(source + "." + "voxel_filter", rclcpp::ParameterValue(false));
+    declareParameter(source + "." + "frustum_clearing", rclcpp::ParameterValue(false));
 
     node->get_parameter(name_ + "." + source + "." + "topic", topic);
     node->get_parameter(name_ + "." + source + "." + "sensor_frame", sensor_frame);
@@ -149,8 +182,11 @@ void ObstacleLayer::onInitialize()
     node->get_parameter(name_ + "." + source + "." + "min_obstacle_height", min_obstacle_height);
     node->get_parameter(name_ + "." + source + "." + "max_obstacle_height", max_obstacle_height);
     node->get_parameter(name_ + "." + source + "." + "inf_is_valid", inf_is_valid);
+    node->get_parameter(name_ + "." + source + "." + "high_fidelity", high_fidelity);
     node->get_parameter(name_ + "." + source + "." + "marking", marking);
     node->get_parameter(name_ + "." + source + "." + "clearing", clearing);
+    node->get_parameter(name_ + "." + source + "." + "voxel_filter", voxel_filter);
+    node->get_parameter(name_ + "." + source + "." + "frustum_clearing", frustum_clearing);
 
     if (!(data_type == "PointCloud2" || data_type == "LaserScan")) {
       RCLCPP_FATAL(
@@ -199,6 +235,23 @@ void ObstacleLayer::onInitialize()
       clearing_buffers_.push_back(observation_buffers_.back());
     }
 
+    // check if the points of this buffer should be collapsed to one per cell
+    if (voxel_filter) {
+      voxel_filter_buffers_.push_back(observation_buffers_.back());
+    }
+
+    // check if this buffer should only be raytraced to its nearest point in each direction
+    if (frustum_clearing) {
+      observation_buffers_.back()->setFrustumClearing(true);
+    }
+
+    // check if the observations of this buffer are recorded along with the costmap updates
+    if (auto recorder = layered_costmap_->getRecorder()) {
+      observation_buffers_.back()->setRecorder(
+        recorder, recorder->addSource(
+          {name_, topic, observation_keep_time, marking, clearing}));
+    }
+
     RCLCPP_DEBUG(
       logger_,
       "Created an observation buffer for source %s, topic %s, global frame: %s, "
@@ -220,7 +273,13 @@ void ObstacleLayer::onInitialize()
         new tf2_ros::MessageFilter<sensor_msgs::msg::LaserScan>(
           *sub, *tf_, global_frame_, 50, rclcpp_node_, tf2::durationFromSec(transform_tolerance)));
 
-      if (inf_is_valid) {
+      if (!high_fidelity) {
+        // projected with a single transform, without correcting the motion during the scan
+        filter->registerCallback(
+          std::bind(
+            &ObstacleLayer::laserScanDirectCallback, this, std::placeholders::_1,
+            observation_buffers_.back(), inf_is_valid));
+      } else if (inf_is_valid) {
         filter->registerCallback(
           std::bind(
             &ObstacleLayer::laserScanValidInfCallback, this, std::placeholders::_1,
@@ -270,6 +329,8 @@ void ObstacleLayer::onInitialize()
       observation_notifiers_.back()->setTargetFrames(target_frames);
     }
   }
+
+  updateVoxelFilters();
 }
 
 void
@@ -300,10 +361,9 @@ ObstacleLayer::laserScanCallback(
     return;
   }
 
-  // buffer the point cloud
-  buffer->lock();
+  // buffer the point cloud, the buffer only locks itself to add it
   buffer->bufferCloud(cloud);
-  buffer->unlock();
+  requestUpdate();
 }
 
 void
@@ -311,15 +371,8 @@ ObstacleLayer::laserScanValidInfCallback(
   sensor_msgs::msg::LaserScan::ConstSharedPtr raw_message,
   const std::shared_ptr<nav2_costmap_2d::ObservationBuffer> & buffer)
 {
-  // Filter positive infinities ("Inf"s) to max_range.
-  float epsilon = 0.0001;  // a tenth of a millimeter
   sensor_msgs::msg::LaserScan message = *raw_message;
-  for (size_t i = 0; i < message.ranges.size(); i++) {
-    float range = message.ranges[i];
-    if (!std::isfinite(range) && range > 0) {
-      message.ranges[i] = message.range_max - epsilon;
-    }
-  }
+  filterInfRanges(message);
 
   // project the laser into a point cloud
   sensor_msgs::msg::PointCloud2 cloud;
@@ -343,10 +396,25 @@ ObstacleLayer::laserScanValidInfCallback(
     return;
   }
 
-  // buffer the point cloud
-  buffer->lock();
+  // buffer the point cloud, the buffer only locks itself to add it
   buffer->bufferCloud(cloud);
-  buffer->unlock();
+  requestUpdate();
+}
+
+void
+ObstacleLayer::laserScanDirectCallback(
+  sensor_msgs::msg::LaserScan::ConstSharedPtr message,
+  const std::shared_ptr<nav2_costmap_2d::ObservationBuffer> & buffer, bool inf_is_valid)
+{
+  // the buffer projects the scan into its own cloud, only locking itself to add it
+  if (inf_is_valid) {
+    sensor_msgs::msg::LaserScan filtered_message = *message;
+    filterInfRanges(filtered_message);
+    buffer->bufferScan(filtered_message);
+  } else {
+    buffer->bufferScan(*message);
+  }
+  requestUpdate();
 }
 
 void
@@ -354,10 +422,9 @@ ObstacleLayer::pointCloud2Callback(
   sensor_msgs::msg::PointCloud2::ConstSharedPtr message,
   const std::shared_ptr<ObservationBuffer> & buffer)
 {
-  // buffer the point cloud
-  buffer->lock();
+  // buffer the point cloud, the buffer only locks itself to add it
   buffer->bufferCloud(*message);
-  buffer->unlock();
+  requestUpdate();
 }
 
 void
@@ -372,6 +439,7 @@ ObstacleLayer::updateBounds(
     return;
   }
   useExtraBounds(min_x, min_y, max_x, max_y);
+  restorePendingSnapshot(robot_x, robot_y, min_x, min_y, max_x, max_y);
 
   bool current = true;
   std::vector<Observation> observations, clearing_observations;
@@ -384,68 +452,86 @@ ObstacleLayer::updateBounds(
 
   // update the global current status
   current_ = current;
+  addSensorStamps(observations);
+  addSensorStamps(clearing_observations);
+
+  // Observations are independent until they write the layer, so they may be processed
+  // on the tile threads, the latency then being that of the slowest rather than their sum
+  TileThreadPool * pool =
+    parallel_observations_ ? layered_costmap_->getTileThreadPool() : nullptr;
+  if (pool && observations.size() + clearing_observations.size() > 1) {
+    updateObservationsInParallel(
+      *pool, observations, clearing_observations, min_x, min_y, max_x, max_y);
+  } else {
+    // raytrace freespace
+    for (unsigned int i = 0; i < clearing_observations.size(); ++i) {
+      raytraceFreespace(
+        getRaytracedObservation(clearing_observations[i], 0.0), min_x, min_y, max_x, max_y);
+    }
 
-  // raytrace freespace
-  for (unsigned int i = 0; i < clearing_observations.size(); ++i) {
-    raytraceFreespace(clearing_observations[i], min_x, min_y, max_x, max_y);
+    // place the new obstacles into the costmap
+    MarkCell marker(costmap_, LETHAL_OBSTACLE);
+    for (const Observation & obs : observations) {
+      markObservation(obs, marker, min_x, min_y, max_x, max_y);
+    }
   }
 
-  // place the new obstacles into a priority queue... each with a priority of zero to begin with
-  for (std::vector<Observation>::const_iterator it = observations.begin();
-    it != observations.end(); ++it)
-  {
-    const Observation & obs = *it;
-
-    const sensor_msgs::msg::PointCloud2 & cloud = *(obs.cloud_);
+  updateFootprint(robot_x, robot_y, robot_yaw, min_x, min_y, max_x, max_y);
+  updateSnapshot(robot_x, robot_y);
+}
 
-    double sq_obstacle_max_range = obs.obstacle_max_range_ * obs.obstacle_max_range_;
-    double sq_obstacle_min_range = obs.obstacle_min_range_ * obs.obstacle_min_range_;
+template<class ActionType>
+void
+ObstacleLayer::markObservation(
+  const Observation & obs, ActionType at,
+  double * min_x, double * min_y, double * max_x, double * max_y)
+{
+  const sensor_msgs::msg::PointCloud2 & cloud = *(obs.cloud_);
 
-    sensor_msgs::PointCloud2ConstIterator<float> iter_x(cloud, "x");
-    sensor_msgs::PointCloud2ConstIterator<float> iter_y(cloud, "y");
-    sensor_msgs::PointCloud2ConstIterator<float> iter_z(cloud, "z");
+  double sq_obstacle_max_range = obs.obstacle_max_range_ * obs.obstacle_max_range_;
+  double sq_obstacle_min_range = obs.obstacle_min_range_ * obs.obstacle_min_range_;
 
-    for (; iter_x != iter_x.end(); ++iter_x, ++iter_y, ++iter_z) {
-      double px = *iter_x, py = *iter_y, pz = *iter_z;
+  sensor_msgs::PointCloud2ConstIterator<float> iter_x(cloud, "x");
+  sensor_msgs::PointCloud2ConstIterator<float> iter_y(cloud, "y");
+  sensor_msgs::PointCloud2ConstIterator<float> iter_z(cloud, "z");
 
-      // if the obstacle is too high or too far away from the robot we won't add it
-      if (pz > max_obstacle_height_) {
-        RCLCPP_DEBUG(logger_, "The point is too high");
-        continue;
-      }
+  for (; iter_x != iter_x.end(); ++iter_x, ++iter_y, ++iter_z) {
+    double px = *iter_x, py = *iter_y, pz = *iter_z;
 
-      // compute the squared distance from the hitpoint to the pointcloud's origin
-      double sq_dist =
-        (px -
-        obs.origin_.x) * (px - obs.origin_.x) + (py - obs.origin_.y) * (py - obs.origin_.y) +
-        (pz - obs.origin_.z) * (pz - obs.origin_.z);
+    // if the obstacle is too high or too far away from the robot we won't add it
+    if (pz > max_obstacle_height_) {
+      RCLCPP_DEBUG(logger_, "The point is too high");
+      continue;
+    }
 
-      // if the point is far enough away... we won't consider it
-      if (sq_dist >= sq_obstacle_max_range) {
-        RCLCPP_DEBUG(logger_, "The point is too far away");
-        continue;
-      }
+    // compute the squared distance from the hitpoint to the pointcloud's origin
+    double sq_dist =
+      (px -
+      obs.origin_.x) * (px - obs.origin_.x) + (py - obs.origin_.y) * (py - obs.origin_.y) +
+      (pz - obs.origin_.z) * (pz - obs.origin_.z);
 
-      // if the point is too close, do not conisder it
-      if (sq_dist < sq_obstacle_min_range) {
-        RCLCPP_DEBUG(logger_, "The point is too close");
-        continue;
-      }
+    // if the point is far enough away... we won't consider it
+    if (sq_dist >= sq_obstacle_max_range) {
+      RCLCPP_DEBUG(logger_, "The point is too far away");
+      continue;
+    }
 
-      // now we need to compute the map coordinates for the observation
-      unsigned int mx, my;
-      if (!worldToMap(px, py, mx, my)) {
-        RCLCPP_DEBUG(logger_, "Computing map coords failed");
-        continue;
-      }
+    // if the point is too close, do not conisder it
+    if (sq_dist < sq_obstacle_min_range) {
+      RCLCPP_DEBUG(logger_, "The point is too close");
+      continue;
+    }
 
-      unsigned int index = getIndex(mx, my);
-      costmap_[index] = LETHAL_OBSTACLE;
-      touch(px, py, min_x, min_y, max_x, max_y);
+    // now we need to compute the map coordinates for the observation
+    unsigned int mx, my;
+    if (!worldToMap(px, py, mx, my)) {
+      RCLCPP_DEBUG(logger_, "Computing map coords failed");
+      continue;
     }
-  }
 
-  updateFootprint(robot_x, robot_y, robot_yaw, min_x, min_y, max_x, max_y);
+    at(getIndex(mx, my));
+    touch(px, py, min_x, min_y, max_x, max_y);
+  }
 }
 
 void
@@ -470,7 +556,25 @@ ObstacleLayer::updateCosts(
   int max_i,
   int max_j)
 {
-  std::lock_guard<Costmap2D::mutex_t> guard(*getMutex());
+  // Update the window as a single tile, releasing the layer lock on errors as well
+  beginTiledUpdate(master_grid, min_i, min_j, max_i, max_j);
+  try {
+    updateCostsTile(master_grid, min_i, min_j, max_i, max_j);
+  } catch (...) {
+    endTiledUpdate();
+    throw;
+  }
+  endTiledUpdate();
+}
+
+void
+ObstacleLayer::beginTiledUpdate(
+  nav2_costmap_2d::Costmap2D & /*master_grid*/, int /*min_i*/, int /*min_j*/,
+  int /*max_i*/,
+  int /*max_j*/)
+{
+  // Held until endTiledUpdate(), while tiles are combined from other threads
+  getMutex()->lock();
   if (!enabled_) {
     return;
   }
@@ -484,6 +588,17 @@ ObstacleLayer::updateCosts(
   if (footprint_clearing_enabled_) {
     setConvexPolygonCost(transformed_footprint_, nav2_costmap_2d::FREE_SPACE);
   }
+}
+
+void
+ObstacleLayer::updateCostsTile(
+  nav2_costmap_2d::Costmap2D & master_grid, int min_i, int min_j,
+  int max_i,
+  int max_j)
+{
+  if (!enabled_) {
+    return;
+  }
 
   switch (combination_method_) {
     case 0:  // Overwrite
@@ -497,6 +612,12 @@ ObstacleLayer::updateCosts(
   }
 }
 
+void
+ObstacleLayer::endTiledUpdate()
+{
+  getMutex()->unlock();
+}
+
 void
 ObstacleLayer::addStaticObservation(
   nav2_costmap_2d::Observation & obs,
@@ -555,12 +676,56 @@ ObstacleLayer::getClearingObservations(std::vector<Observation> & clearing_obser
   return current;
 }
 
+void
+ObstacleLayer::addSensorStamps(const std::vector<Observation> & observations) const
+{
+  for (const auto & observation : observations) {
+    layered_costmap_->addSensorStamp(rclcpp::Time(observation.cloud_->header.stamp));
+  }
+}
+
+const Observation &
+ObstacleLayer::getRaytracedObservation(
+  const Observation & clearing_observation, double z_resolution)
+{
+  return getRaytracedObservation(
+    clearing_observation, z_resolution, depth_image_, frustum_observation_);
+}
+
+const Observation &
+ObstacleLayer::getRaytracedObservation(
+  const Observation & clearing_observation, double z_resolution,
+  ObservationDepthImage & depth_image, Observation & reduced)
+{
+  if (!clearing_observation.frustum_clearing_) {
+    return clearing_observation;
+  }
+
+  // Bins as wide as a cell at the raytrace range, so that rays cross all cells in range
+  const double cell_size = z_resolution > 0.0 ? std::min(resolution_, z_resolution) : resolution_;
+  const double range = std::max(clearing_observation.raytrace_max_range_, cell_size);
+  depth_image.reduce(clearing_observation, cell_size / range, z_resolution > 0.0, reduced);
+  return reduced;
+}
+
 void
 ObstacleLayer::raytraceFreespace(
   const Observation & clearing_observation, double * min_x,
   double * min_y,
   double * max_x,
   double * max_y)
+{
+  raytraceObservation(
+    clearing_observation, MarkCell(costmap_, FREE_SPACE), raytraced_endpoints_,
+    min_x, min_y, max_x, max_y);
+}
+
+template<class ActionType>
+void
+ObstacleLayer::raytraceObservation(
+  const Observation & clearing_observation, ActionType at,
+  VisitationMap & raytraced_endpoints,
+  double * min_x, double * min_y, double * max_x, double * max_y)
 {
   double ox = clearing_observation.origin_.x;
   double oy = clearing_observation.origin_.y;
@@ -587,6 +752,14 @@ ObstacleLayer::raytraceFreespace(
 
   touch(ox, oy, min_x, min_y, max_x, max_y);
 
+  unsigned int cell_raytrace_max_range = cellDistance(clearing_observation.raytrace_max_range_);
+  unsigned int cell_raytrace_min_range = cellDistance(clearing_observation.raytrace_min_range_);
+
+  // Rays only depend on their end cells, so dense clouds with many points
+  // per cell would otherwise trace the same line over and over
+  raytraced_endpoints.resize(size_x_ * size_y_);
+  raytraced_endpoints.clear();
+
   // for each point in the cloud, we want to trace a line from the origin
   // and clear obstacles along it
   sensor_msgs::PointCloud2ConstIterator<float> iter_x(cloud, "x");
@@ -633,11 +806,12 @@ ObstacleLayer::raytraceFreespace(
       continue;
     }
 
-    unsigned int cell_raytrace_max_range = cellDistance(clearing_observation.raytrace_max_range_);
-    unsigned int cell_raytrace_min_range = cellDistance(clearing_observation.raytrace_min_range_);
-    MarkCell marker(costmap_, FREE_SPACE);
     // and finally... we can execute our trace to clear obstacles along that line
-    raytraceLine(marker, x0, y0, x1, y1, cell_raytrace_max_range, cell_raytrace_min_range);
+    const unsigned int endpoint = getIndex(x1, y1);
+    if (!raytraced_endpoints.isVisited(endpoint)) {
+      raytraced_endpoints.setVisited(endpoint);
+      raytraceLine(at, x0, y0, x1, y1, cell_raytrace_max_range, cell_raytrace_min_range);
+    }
 
     updateRaytraceBounds(
       ox, oy, wx, wy, clearing_observation.raytrace_max_range_,
@@ -646,6 +820,54 @@ ObstacleLayer::raytraceFreespace(
   }
 }
 
+void
+ObstacleLayer::updateObservationsInParallel(
+  TileThreadPool & pool, const std::vector<Observation> & observations,
+  const std::vector<Observation> & clearing_observations,
+  double * min_x, double * min_y, double * max_x, double * max_y)
+{
+  // The clearing observations come first, as they are written first
+  const unsigned int clearing = clearing_observations.size();
+  const unsigned int count = clearing + observations.size();
+  if (observation_changes_.size() < count) {
+    observation_changes_.resize(count);
+  }
+
+  pool.run(
+    count, [&](unsigned int i) {
+      ObservationChanges & changes = observation_changes_[i];
+      changes.cells.clear();
+      changes.min_x = *min_x;
+      changes.min_y = *min_y;
+      changes.max_x = *max_x;
+      changes.max_y = *max_y;
+      auto collect = [&changes](unsigned int offset) {changes.cells.push_back(offset);};
+      if (i < clearing) {
+        raytraceObservation(
+          getRaytracedObservation(
+            clearing_observations[i], 0.0, changes.depth_image, changes.frustum_observation),
+          collect, changes.raytraced_endpoints,
+          &changes.min_x, &changes.min_y, &changes.max_x, &changes.max_y);
+      } else {
+        markObservation(
+          observations[i - clearing], collect,
+          &changes.min_x, &changes.min_y, &changes.max_x, &changes.max_y);
+      }
+    });
+
+  for (unsigned int i = 0; i < count; ++i) {
+    const ObservationChanges & changes = observation_changes_[i];
+    const unsigned char cost = i < clearing ? FREE_SPACE : LETHAL_OBSTACLE;
+    for (const unsigned int & index : changes.cells) {
+      costmap_[index] = cost;
+    }
+    *min_x = std::min(*min_x, changes.min_x);
+    *min_y = std::min(*min_y, changes.min_y);
+    *max_x = std::max(*max_x, changes.max_x);
+    *max_y = std::max(*max_y, changes.max_y);
+  }
+}
+
 void
 ObstacleLayer::activate()
 {
@@ -660,11 +882,17 @@ ObstacleLayer::activate()
     }
   }
   resetBuffersLastUpdated();
+  pending_restore_ = restore_snapshot_ && snapshot_writer_;
 }
 
 void
 ObstacleLayer::deactivate()
 {
+  // The layer is saved as it is left, unless it was never updated since activation
+  if (snapshot_writer_ && !pending_restore_) {
+    std::lock_guard<Costmap2D::mutex_t> guard(*getMutex());
+    submitSnapshot();
+  }
   for (unsigned int i = 0; i < observation_subscribers_.size(); ++i) {
     if (observation_subscribers_[i] != NULL) {
       observation_subscribers_[i]->unsubscribe();
@@ -687,6 +915,22 @@ ObstacleLayer::updateRaytraceBounds(
   touch(ex, ey, min_x, min_y, max_x, max_y);
 }
 
+void
+ObstacleLayer::matchSize()
+{
+  CostmapLayer::matchSize();
+  updateVoxelFilters();
+}
+
+void
+ObstacleLayer::updateVoxelFilters()
+{
+  for (auto & buffer : voxel_filter_buffers_) {
+    buffer->setVoxelFilter(
+      resolution_, voxel_filter_z_resolution_, origin_x_, origin_y_, voxel_filter_origin_z_);
+  }
+}
+
 void
 ObstacleLayer::reset()
 {
@@ -696,6 +940,107 @@ ObstacleLayer::reset()
   was_reset_ = true;
 }
 
+void
+ObstacleLayer::restorePendingSnapshot(
+  double robot_x, double robot_y, double * min_x, double * min_y, double * max_x, double * max_y)
+{
+  if (!pending_restore_) {
+    return;
+  }
+  pending_restore_ = false;
+
+  LayerSnapshot snapshot;
+  if (!loadLayerSnapshot(snapshot_file_, snapshot)) {
+    RCLCPP_INFO(logger_, "No layer snapshot to restore from %s", snapshot_file_.c_str());
+    return;
+  }
+  const double age = 1e-9 * static_cast<double>(
+    std::chrono::duration_cast<std::chrono::nanoseconds>(
+      std::chrono::system_clock::now().time_since_epoch()).count() - snapshot.stamp_ns);
+  if (age < 0.0 || age > snapshot_max_age_ || snapshot.frame != global_frame_ ||
+    std::abs(snapshot.resolution - resolution_) > 1e-6 * resolution_)
+  {
+    RCLCPP_INFO(
+      logger_, "Layer snapshot %s of %.1f s ago is stale or of another costmap, not restored",
+      snapshot_file_.c_str(), age);
+    return;
+  }
+
+  // The frame is only matched by name, and one restarting with the robot, such as odom, is
+  // elsewhere than in the snapshot once the robot moved, the robot then being elsewhere too
+  const double robot_offset = std::hypot(robot_x - snapshot.robot_x, robot_y - snapshot.robot_y);
+  if (snapshot_max_robot_offset_ >= 0.0 && robot_offset > snapshot_max_robot_offset_) {
+    RCLCPP_INFO(
+      logger_, "Robot is %.2f m away from where layer snapshot %s was taken, not restored",
+      robot_offset, snapshot_file_.c_str());
+    return;
+  }
+
+  if (!applySnapshot(snapshot)) {
+    RCLCPP_INFO(
+      logger_, "Layer snapshot %s is of another costmap, not restored", snapshot_file_.c_str());
+    return;
+  }
+
+  RCLCPP_INFO(
+    logger_, "Restored layer from snapshot %s of %.1f s ago", snapshot_file_.c_str(), age);
+  touch(origin_x_, origin_y_, min_x, min_y, max_x, max_y);
+  touch(
+    origin_x_ + getSizeInMetersX(), origin_y_ + getSizeInMetersY(), min_x, min_y, max_x, max_y);
+}
+
+void
+ObstacleLayer::updateSnapshot(double robot_x, double robot_y)
+{
+  if (!snapshot_writer_) {
+    return;
+  }
+  snapshot_robot_x_ = robot_x;
+  snapshot_robot_y_ = robot_y;
+  const auto now = std::chrono::steady_clock::now();
+  if (now - last_snapshot_ < std::chrono::duration<double>(snapshot_period_)) {
+    return;
+  }
+  last_snapshot_ = now;
+  submitSnapshot();
+}
+
+void
+ObstacleLayer::submitSnapshot()
+{
+  auto snapshot = std::make_unique<LayerSnapshot>();
+  fillSnapshot(*snapshot);
+  snapshot_writer_->submit(std::move(snapshot));
+}
+
+void
+ObstacleLayer::fillSnapshot(LayerSnapshot & snapshot)
+{
+  snapshot.frame = global_frame_;
+  snapshot.stamp_ns = std::chrono::duration_cast<std::chrono::nanoseconds>(
+    std::chrono::system_clock::now().time_since_epoch()).count();
+  snapshot.origin_x = origin_x_;
+  snapshot.origin_y = origin_y_;
+  snapshot.robot_x = snapshot_robot_x_;
+  snapshot.robot_y = snapshot_robot_y_;
+  snapshot.resolution = resolution_;
+  snapshot.size_x = size_x_;
+  snapshot.size_y = size_y_;
+  snapshot.costs.assign(costmap_, costmap_ + static_cast<size_t>(size_x_) * size_y_);
+}
+
+bool
+ObstacleLayer::applySnapshot(const LayerSnapshot & snapshot)
+{
+  // Origins of rolling windows are on cells of the frame, so that the offset is whole cells
+  const int offset_x = static_cast<int>(std::lround((snapshot.origin_x - origin_x_) / resolution_));
+  const int offset_y = static_cast<int>(std::lround((snapshot.origin_y - origin_y_) / resolution_));
+  copyOverlappingCells(
+    snapshot.costs.data(), snapshot.size_x, snapshot.size_y, costmap_, size_x_, size_y_,
+    offset_x, offset_y, 1);
+  return true;
+}
+
 void
 ObstacleLayer::resetBuffersLastUpdated()
 {
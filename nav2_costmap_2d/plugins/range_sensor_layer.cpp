@@ -215,6 +215,7 @@ void RangeSensorLayer::bufferIncomingRangeMsg(
   range_message_mutex_.lock();
   range_msgs_buffer_.push_back(*range_message);
   range_message_mutex_.unlock();
+  requestUpdate();
 }
 
 void RangeSensorLayer::updateCostmap()
@@ -228,6 +229,7 @@ void RangeSensorLayer::updateCostmap()
 
   for (auto & range_msgs_it : range_msgs_buffer_copy) {
     processRangeMessageFunc_(range_msgs_it);
+    layered_costmap_->addSensorStamp(rclcpp::Time(range_msgs_it.header.stamp));
   }
 }
 
@@ -363,8 +365,21 @@ void RangeSensorLayer::updateCostmap(
   bx1 = std::min(static_cast<int>(size_x_), bx1);
   by1 = std::min(static_cast<int>(size_y_), by1);
 
-  for (unsigned int x = bx0; x <= (unsigned int)bx1; x++) {
-    for (unsigned int y = by0; y <= (unsigned int)by1; y++) {
+  // Barycentric coordinates inside area threshold, see below
+  const float bcciath = -static_cast<float>(inflate_cone_) * area(Ax, Ay, Bx, By, Ox, Oy);
+
+  // Unless the cone is cleared, the sensor model is 0.5 beyond the far edge of the
+  // reading and outside of the field of view, which leaves the cell costs as they are.
+  // Such cells are skipped before any trigonometry, with a small margin so that the cells
+  // near the edges are still updated through the full sensor model.
+  const double margin = 1e-6;
+  const double far_range = range_message.range * (1 + resolution_);
+  const double far_sq = far_range * far_range * (1 + margin);
+  const double cos_theta = cos(theta), sin_theta = sin(theta);
+  const double cos_fov = max_angle_ < M_PI ? cos(max_angle_) - margin : -2.0;
+
+  for (unsigned int y = by0; y <= (unsigned int)by1; y++) {
+    for (unsigned int x = bx0; x <= (unsigned int)bx1; x++) {
       bool update_xy_cell = true;
 
       // Unless inflate_cone_ is set to 100 %, we update cells only within the
@@ -380,13 +395,21 @@ void RangeSensorLayer::updateCostmap(
 
         // Barycentric coordinates inside area threshold; this is not mathematically
         // sound at all, but it works!
-        float bcciath = -static_cast<float>(inflate_cone_) * area(Ax, Ay, Bx, By, Ox, Oy);
         update_xy_cell = w0 >= bcciath && w1 >= bcciath && w2 >= bcciath;
       }
 
       if (update_xy_cell) {
         double wx, wy;
         mapToWorld(x, y, wx, wy);
+        if (!clear_sensor_cone) {
+          const double cx = wx - ox, cy = wy - oy;
+          const double dist_sq = cx * cx + cy * cy;
+          if (dist_sq > far_sq ||
+            cx * cos_theta + cy * sin_theta < cos_fov * sqrt(dist_sq))
+          {
+            continue;
+          }
+        }
         update_cell(ox, oy, theta, range_message.range, wx, wy, clear_sensor_cone);
       }
     }
@@ -40,8 +40,13 @@
 #include "nav2_costmap_2d/static_layer.hpp"
 
 #include <algorithm>
+#include <cstring>
+#include <limits>
+#include <memory>
 #include <string>
+#include <vector>
 
+#include "nav2_costmap_2d/combination_kernels.hpp"
 #include "pluginlib/class_list_macros.hpp"
 #include "tf2/convert.h"
 #include "tf2_geometry_msgs/tf2_geometry_msgs.hpp"
@@ -79,20 +84,37 @@ StaticLayer::onInitialize()
     map_qos.keep_last(1);
   }
 
+  auto node = node_.lock();
+  if (!node) {
+    throw std::runtime_error{"Failed to lock node"};
+  }
+
+  if (!map_region_service_.empty()) {
+    if (layered_costmap_->isRolling()) {
+      RCLCPP_INFO(
+        logger_,
+        "Requesting the regions of the map covering the costmap from the map region "
+        "service (%s) at level %d", map_region_service_.c_str(), map_region_level_);
+      map_region_client_ = node->create_client<nav2_msgs::srv::GetMapRegion>(
+        map_region_service_);
+      return;
+    }
+    RCLCPP_WARN(
+      logger_,
+      "Map region service (%s) is only used by rolling costmaps, ignoring it",
+      map_region_service_.c_str());
+  }
+
   RCLCPP_INFO(
     logger_,
     "Subscribing to the map topic (%s) with %s durability",
     map_topic_.c_str(),
     map_subscribe_transient_local_ ? "transient local" : "volatile");
 
-  auto node = node_.lock();
-  if (!node) {
-    throw std::runtime_error{"Failed to lock node"};
-  }
-
   map_sub_ = node->create_subscription<nav_msgs::msg::OccupancyGrid>(
     map_topic_, map_qos,
     std::bind(&StaticLayer::incomingMap, this, std::placeholders::_1));
+  map_topic_name_ = map_sub_->get_topic_name();
 
   if (subscribe_to_updates_) {
     RCLCPP_INFO(logger_, "Subscribing to updates");
@@ -132,6 +154,11 @@ StaticLayer::getParameters()
   declareParameter("map_subscribe_transient_local", rclcpp::ParameterValue(true));
   declareParameter("transform_tolerance", rclcpp::ParameterValue(0.0));
   declareParameter("map_topic", rclcpp::ParameterValue(""));
+  declareParameter("map_region_service", rclcpp::ParameterValue(""));
+  declareParameter("map_region_margin", rclcpp::ParameterValue(5.0));
+  declareParameter("map_region_level", rclcpp::ParameterValue(0));
+  declareParameter("map_region_timeout", rclcpp::ParameterValue(5.0));
+  declareParameter("share_map", rclcpp::ParameterValue(false));
 
   auto node = node_.lock();
   if (!node) {
@@ -157,10 +184,28 @@ StaticLayer::getParameters()
   node->get_parameter("unknown_cost_value", unknown_cost_value_);
   node->get_parameter("trinary_costmap", trinary_costmap_);
   node->get_parameter("transform_tolerance", temp_tf_tol);
+  node->get_parameter(name_ + "." + "map_region_service", map_region_service_);
+  node->get_parameter(name_ + "." + "map_region_margin", map_region_margin_);
+  node->get_parameter(name_ + "." + "map_region_level", map_region_level_);
+  node->get_parameter(name_ + "." + "map_region_timeout", map_region_timeout_);
+  node->get_parameter(name_ + "." + "share_map", share_map_);
 
   // Enforce bounds
   lethal_threshold_ = std::max(std::min(temp_lethal_threshold, 100), 0);
+  for (unsigned int value = 0; value != 256; ++value) {
+    value_costs_[value] = interpretValue(value);
+  }
+  map_region_margin_ = std::max(map_region_margin_, 0.0);
+  map_region_level_ = std::max(std::min(map_region_level_, 255), 0);
+  if (share_map_ && (subscribe_to_updates_ || !map_region_service_.empty())) {
+    // Map updates change the costs of a map in place, and map regions differ by costmap
+    RCLCPP_WARN(
+      logger_,
+      "StaticLayer: The map can't be shared with map updates or map regions, not sharing it");
+    share_map_ = false;
+  }
   map_received_ = false;
+  region_received_ = false;
   update_in_progress_.store(false);
 
   transform_tolerance_ = tf2::durationFromSec(temp_tf_tol);
@@ -204,10 +249,10 @@ StaticLayer::processMap(const nav_msgs::msg::OccupancyGrid & new_map)
       new_map.info.origin.position.x,
       new_map.info.origin.position.y,
       true);
-  } else if (size_x_ != size_x || size_y_ != size_y ||  // NOLINT
+  } else if (!share_map_ && (size_x_ != size_x || size_y_ != size_y ||  // NOLINT
     resolution_ != new_map.info.resolution ||
     origin_x_ != new_map.info.origin.position.x ||
-    origin_y_ != new_map.info.origin.position.y)
+    origin_y_ != new_map.info.origin.position.y))
   {
     // only update the size of the costmap stored locally in this layer
     RCLCPP_INFO(
@@ -219,25 +264,27 @@ StaticLayer::processMap(const nav_msgs::msg::OccupancyGrid & new_map)
       new_map.info.origin.position.x, new_map.info.origin.position.y);
   }
 
-  unsigned int index = 0;
-
   // we have a new map, update full size of map
   std::lock_guard<Costmap2D::mutex_t> guard(*getMutex());
 
-  // initialize the costmap with static data
-  for (unsigned int i = 0; i < size_y; ++i) {
-    for (unsigned int j = 0; j < size_x; ++j) {
-      unsigned char value = new_map.data[index];
-      costmap_[index] = interpretValue(value);
-      ++index;
+  if (share_map_) {
+    // The shared costs have the geometry of the map, whatever that of this layer
+    shared_costs_ = StaticMapRegistry::getInstance().getCosts(
+      map_topic_name_, new_map, value_costs_);
+  } else {
+    // initialize the costmap with static data through the table of interpreted values
+    const size_t size = static_cast<size_t>(size_x) * size_y;
+    const unsigned char * data = reinterpret_cast<const unsigned char *>(new_map.data.data());
+    for (size_t index = 0; index < size; ++index) {
+      costmap_[index] = value_costs_[data[index]];
     }
   }
 
   map_frame_ = new_map.header.frame_id;
 
   x_ = y_ = 0;
-  width_ = size_x_;
-  height_ = size_y_;
+  width_ = getStaticCosts().getSizeInCellsX();
+  height_ = getStaticCosts().getSizeInCellsY();
   has_updated_data_ = true;
 
   current_ = true;
@@ -247,8 +294,8 @@ void
 StaticLayer::matchSize()
 {
   // If we are using rolling costmap, the static map size is
-  //   unrelated to the size of the layered costmap
-  if (!layered_costmap_->isRolling()) {
+  //   unrelated to the size of the layered costmap, and shared costs have that of the map
+  if (!layered_costmap_->isRolling() && !share_map_) {
     Costmap2D * master = layered_costmap_->getCostmap();
     resizeMap(
       master->getSizeInCellsX(), master->getSizeInCellsY(), master->getResolution(),
@@ -275,7 +322,7 @@ StaticLayer::interpretValue(unsigned char value)
 }
 
 void
-StaticLayer::incomingMap(const nav_msgs::msg::OccupancyGrid::SharedPtr new_map)
+StaticLayer::incomingMap(const nav_msgs::msg::OccupancyGrid::ConstSharedPtr new_map)
 {
   std::lock_guard<Costmap2D::mutex_t> guard(*getMutex());
   if (!map_received_) {
@@ -288,6 +335,7 @@ StaticLayer::incomingMap(const nav_msgs::msg::OccupancyGrid::SharedPtr new_map)
     processMap(*new_map);
     map_buffer_ = nullptr;
   }
+  requestUpdate();
 }
 
 void
@@ -317,16 +365,16 @@ StaticLayer::incomingUpdate(map_msgs::msg::OccupancyGridUpdate::ConstSharedPtr u
       map_frame_.c_str(), update->header.frame_id.c_str());
   }
 
-  unsigned int di = 0;
+  const unsigned char * data = reinterpret_cast<const unsigned char *>(update->data.data());
   for (unsigned int y = 0; y < update->height; y++) {
-    unsigned int index_base = (update->y + y) * size_x_;
+    unsigned char * costs = costmap_ + (update->y + y) * size_x_ + update->x;
     for (unsigned int x = 0; x < update->width; x++) {
-      unsigned int index = index_base + x + update->x;
-      costmap_[index] = interpretValue(update->data[di++]);
+      costs[x] = value_costs_[*data++];
     }
   }
 
   has_updated_data_ = true;
+  requestUpdate();
 }
 
 
@@ -337,6 +385,10 @@ StaticLayer::updateBounds(
   double * max_x,
   double * max_y)
 {
+  if (map_region_client_) {
+    requestMapRegion();
+  }
+
   if (!map_received_) {
     return;
   }
@@ -360,25 +412,157 @@ StaticLayer::updateBounds(
 
   double wx, wy;
 
-  mapToWorld(x_, y_, wx, wy);
+  getStaticCosts().mapToWorld(x_, y_, wx, wy);
   *min_x = std::min(wx, *min_x);
   *min_y = std::min(wy, *min_y);
 
-  mapToWorld(x_ + width_, y_ + height_, wx, wy);
+  getStaticCosts().mapToWorld(x_ + width_, y_ + height_, wx, wy);
   *max_x = std::max(wx, *max_x);
   *max_y = std::max(wy, *max_y);
 
   has_updated_data_ = false;
 }
 
+void
+StaticLayer::requestMapRegion()
+{
+  // A request whose response was lost would otherwise block any further request
+  if (region_request_pending_.load()) {
+    if (std::chrono::steady_clock::now() - region_request_time_ <
+      std::chrono::duration<double>(map_region_timeout_))
+    {
+      return;
+    }
+    RCLCPP_WARN(
+      logger_, "StaticLayer: No response to the map region request in %.1f s, requesting again",
+      map_region_timeout_);
+    map_region_client_->prune_pending_requests();
+    region_request_pending_.store(false);
+  }
+  if (!map_region_client_->service_is_ready()) {
+    return;
+  }
+
+  // Bounds of the master costmap window in the global frame
+  Costmap2D * master = layered_costmap_->getCostmap();
+  const double window_min_x = master->getOriginX();
+  const double window_min_y = master->getOriginY();
+  const double window_max_x =
+    window_min_x + master->getSizeInCellsX() * master->getResolution();
+  const double window_max_y =
+    window_min_y + master->getSizeInCellsY() * master->getResolution();
+
+  // Until a region arrives the map frame is not known, assume the global frame is used
+  std::string map_frame;
+  {
+    std::lock_guard<Costmap2D::mutex_t> guard(*getMutex());
+    map_frame = map_frame_.empty() ? global_frame_ : map_frame_;
+  }
+  double min_x = window_min_x, min_y = window_min_y;
+  double max_x = window_max_x, max_y = window_max_y;
+  if (map_frame != global_frame_) {
+    geometry_msgs::msg::TransformStamped transform;
+    try {
+      transform = tf_->lookupTransform(
+        map_frame, global_frame_, tf2::TimePointZero,
+        transform_tolerance_);
+    } catch (tf2::TransformException & ex) {
+      RCLCPP_ERROR(logger_, "StaticLayer: %s", ex.what());
+      return;
+    }
+    tf2::Transform tf_transform;
+    tf2::fromMsg(transform.transform, tf_transform);
+    min_x = min_y = std::numeric_limits<double>::max();
+    max_x = max_y = std::numeric_limits<double>::lowest();
+    for (const double wx : {window_min_x, window_max_x}) {
+      for (const double wy : {window_min_y, window_max_y}) {
+        const tf2::Vector3 p = tf_transform * tf2::Vector3(wx, wy, 0);
+        min_x = std::min(min_x, p.x());
+        min_y = std::min(min_y, p.y());
+        max_x = std::max(max_x, p.x());
+        max_y = std::max(max_y, p.y());
+      }
+    }
+  }
+
+  {
+    std::lock_guard<Costmap2D::mutex_t> guard(*getMutex());
+    if (region_received_ && min_x >= region_min_x_ && min_y >= region_min_y_ &&
+      max_x <= region_max_x_ && max_y <= region_max_y_)
+    {
+      return;
+    }
+  }
+
+  auto request = std::make_shared<nav2_msgs::srv::GetMapRegion::Request>();
+  request->min_x = min_x - map_region_margin_;
+  request->min_y = min_y - map_region_margin_;
+  request->max_x = max_x + map_region_margin_;
+  request->max_y = max_y + map_region_margin_;
+  request->level = static_cast<uint8_t>(map_region_level_);
+  RCLCPP_DEBUG(
+    logger_, "StaticLayer: Requesting map region [%f, %f] X [%f, %f]",
+    request->min_x, request->max_x, request->min_y, request->max_y);
+
+  region_request_pending_.store(true);
+  region_request_time_ = std::chrono::steady_clock::now();
+  map_region_client_->async_send_request(
+    request,
+    std::bind(
+      &StaticLayer::incomingMapRegion, this, std::placeholders::_1,
+      request->min_x, request->min_y, request->max_x, request->max_y));
+}
+
+void
+StaticLayer::incomingMapRegion(
+  rclcpp::Client<nav2_msgs::srv::GetMapRegion>::SharedFuture future,
+  double min_x, double min_y, double max_x, double max_y)
+{
+  auto response = future.get();
+  {
+    // Requested bounds outside of the map are not requested again either
+    std::lock_guard<Costmap2D::mutex_t> guard(*getMutex());
+    region_min_x_ = min_x;
+    region_min_y_ = min_y;
+    region_max_x_ = max_x;
+    region_max_y_ = max_y;
+    region_received_ = true;
+  }
+  if (response->success) {
+    incomingMap(std::make_shared<nav_msgs::msg::OccupancyGrid>(std::move(response->map)));
+  } else {
+    RCLCPP_WARN(
+      logger_, "StaticLayer: No map region received for [%f, %f] X [%f, %f]",
+      min_x, max_x, min_y, max_y);
+  }
+  region_request_pending_.store(false);
+}
+
 void
 StaticLayer::updateCosts(
   nav2_costmap_2d::Costmap2D & master_grid,
   int min_i, int min_j, int max_i, int max_j)
 {
-  std::lock_guard<Costmap2D::mutex_t> guard(*getMutex());
+  // Update the window as a single tile, releasing the layer lock on errors as well
+  beginTiledUpdate(master_grid, min_i, min_j, max_i, max_j);
+  try {
+    updateCostsTile(master_grid, min_i, min_j, max_i, max_j);
+  } catch (...) {
+    endTiledUpdate();
+    throw;
+  }
+  endTiledUpdate();
+}
+
+void
+StaticLayer::beginTiledUpdate(
+  nav2_costmap_2d::Costmap2D & /*master_grid*/,
+  int /*min_i*/, int /*min_j*/, int /*max_i*/, int /*max_j*/)
+{
+  // Held until endTiledUpdate(), while tiles are copied from other threads
+  getMutex()->lock();
+  update_ready_ = false;
   if (!enabled_) {
-    update_in_progress_.store(false);
     return;
   }
   if (!map_received_) {
@@ -388,21 +572,11 @@ StaticLayer::updateCosts(
       RCLCPP_WARN(logger_, "Can't update static costmap layer, no map received");
       count = 0;
     }
-    update_in_progress_.store(false);
     return;
   }
 
-  if (!layered_costmap_->isRolling()) {
-    // if not rolling, the layered costmap (master_grid) has same coordinates as this layer
-    if (!use_maximum_) {
-      updateWithTrueOverwrite(master_grid, min_i, min_j, max_i, max_j);
-    } else {
-      updateWithMax(master_grid, min_i, min_j, max_i, max_j);
-    }
-  } else {
+  if (layered_costmap_->isRolling()) {
     // If rolling window, the master_grid is unlikely to have same coordinates as this layer
-    unsigned int mx, my;
-    double wx, wy;
     // Might even be in a different frame
     geometry_msgs::msg::TransformStamped transform;
     try {
@@ -411,33 +585,98 @@ StaticLayer::updateCosts(
         transform_tolerance_);
     } catch (tf2::TransformException & ex) {
       RCLCPP_ERROR(logger_, "StaticLayer: %s", ex.what());
-      update_in_progress_.store(false);
       return;
     }
-    // Copy map data given proper transformations
-    tf2::Transform tf2_transform;
-    tf2::fromMsg(transform.transform, tf2_transform);
+    tf2::fromMsg(transform.transform, update_transform_);
+  } else {
+    update_transform_.setIdentity();
+  }
 
+  update_ready_ = true;
+}
+
+void
+StaticLayer::updateCostsTile(
+  nav2_costmap_2d::Costmap2D & master_grid,
+  int min_i, int min_j, int max_i, int max_j)
+{
+  if (!update_ready_) {
+    return;
+  }
+
+  // Shared costs have the geometry of the map, which the master costmap only has if the
+  // layer sized it to the map
+  const Costmap2D & static_costs = getStaticCosts();
+  const bool same_geometry = !layered_costmap_->isRolling() && (!shared_costs_ || (
+    static_costs.getSizeInCellsX() == master_grid.getSizeInCellsX() &&
+    static_costs.getSizeInCellsY() == master_grid.getSizeInCellsY() &&
+    static_costs.getResolution() == master_grid.getResolution() &&
+    static_costs.getOriginX() == master_grid.getOriginX() &&
+    static_costs.getOriginY() == master_grid.getOriginY()));
+
+  if (same_geometry && !shared_costs_) {
+    // if not rolling, the layered costmap (master_grid) has same coordinates as this layer
+    if (!use_maximum_) {
+      updateWithTrueOverwrite(master_grid, min_i, min_j, max_i, max_j);
+    } else {
+      updateWithMax(master_grid, min_i, min_j, max_i, max_j);
+    }
+  } else if (same_geometry && max_i > min_i) {
+    const unsigned char * costs = static_costs.getCharMap();
+    unsigned char * master_array = master_grid.getCharMap();
+    const unsigned int span = master_grid.getSizeInCellsX();
+    for (int j = min_j; j < max_j; ++j) {
+      const size_t it = static_cast<size_t>(j) * span + min_i;
+      if (use_maximum_) {
+        combineWithMax(master_array + it, costs + it, max_i - min_i);
+      } else {
+        std::memcpy(master_array + it, costs + it, max_i - min_i);
+      }
+    }
+  } else if (!same_geometry && max_i > min_i) {
+    const tf2::Matrix3x3 & basis = update_transform_.getBasis();
+    const tf2::Vector3 & origin = update_transform_.getOrigin();
+    Costmap2D * layered_grid = layered_costmap_->getCostmap();
+    unsigned char * master_array = master_grid.getCharMap();
+    unsigned int mx, my;
+    double wx, wy;
+
+    // Column terms of the transform from global_frame_ to map_frame_, shared by all rows
+    std::vector<double> column_x(max_i - min_i), column_y(max_i - min_i);
     for (int i = min_i; i < max_i; ++i) {
-      for (int j = min_j; j < max_j; ++j) {
-        // Convert master_grid coordinates (i,j) into global_frame_(wx,wy) coordinates
-        layered_costmap_->getCostmap()->mapToWorld(i, j, wx, wy);
-        // Transform from global_frame_ to map_frame_
-        tf2::Vector3 p(wx, wy, 0);
-        p = tf2_transform * p;
-        // Set master_grid with cell from map
-        if (worldToMap(p.x(), p.y(), mx, my)) {
-          if (!use_maximum_) {
-            master_grid.setCost(i, j, getCost(mx, my));
-          } else {
-            master_grid.setCost(i, j, std::max(getCost(mx, my), master_grid.getCost(i, j)));
-          }
+      layered_grid->mapToWorld(i, min_j, wx, wy);
+      column_x[i - min_i] = basis[0].x() * wx;
+      column_y[i - min_i] = basis[1].x() * wx;
+    }
+
+    // Copy map data given proper transformations, row by row of master_grid
+    for (int j = min_j; j < max_j; ++j) {
+      // Convert master_grid coordinates (min_i,j) into global_frame_(wx,wy) coordinates
+      layered_grid->mapToWorld(min_i, j, wx, wy);
+      const double row_x = basis[0].y() * wy;
+      const double row_y = basis[1].y() * wy;
+      unsigned char * master_row = master_array + master_grid.getIndex(min_i, j);
+      for (int i = 0; i < max_i - min_i; ++i) {
+        // Transform from global_frame_ to map_frame_ and set master_grid with cell from map
+        if (static_costs.worldToMap(
+            column_x[i] + row_x + origin.x(), column_y[i] + row_y + origin.y(), mx, my))
+        {
+          const unsigned char cost = static_costs.getCharMap()[static_costs.getIndex(mx, my)];
+          master_row[i] = use_maximum_ ? std::max(cost, master_row[i]) : cost;
         }
       }
     }
   }
+}
+
+void
+StaticLayer::endTiledUpdate()
+{
   update_in_progress_.store(false);
-  current_ = true;
+  if (update_ready_) {
+    current_ = true;
+  }
+  getMutex()->unlock();
 }
 
 /**
@@ -457,7 +696,9 @@ StaticLayer::dynamicParametersCallback(
 
     if (param_name == name_ + "." + "map_subscribe_transient_local" ||
       param_name == name_ + "." + "map_topic" ||
-      param_name == name_ + "." + "subscribe_to_updates")
+      param_name == name_ + "." + "subscribe_to_updates" ||
+      param_name == name_ + "." + "map_region_service" ||
+      param_name == name_ + "." + "share_map")
     {
       RCLCPP_WARN(
         logger_, "%s is not a dynamic parameter "
@@ -465,14 +706,16 @@ StaticLayer::dynamicParametersCallback(
     } else if (param_type == ParameterType::PARAMETER_DOUBLE) {
       if (param_name == name_ + "." + "transform_tolerance") {
         transform_tolerance_ = tf2::durationFromSec(parameter.as_double());
+      } else if (param_name == name_ + "." + "map_region_timeout") {
+        map_region_timeout_ = parameter.as_double();
       }
     } else if (param_type == ParameterType::PARAMETER_BOOL) {
       if (param_name == name_ + "." + "enabled" && enabled_ != parameter.as_bool()) {
         enabled_ = parameter.as_bool();
 
         x_ = y_ = 0;
-        width_ = size_x_;
-        height_ = size_y_;
+        width_ = getStaticCosts().getSizeInCellsX();
+        height_ = getStaticCosts().getSizeInCellsY();
         has_updated_data_ = true;
         current_ = false;
       }
@@ -40,6 +40,7 @@
 
 #include <algorithm>
 #include <cassert>
+#include <cmath>
 #include <vector>
 #include <memory>
 #include <utility>
@@ -47,8 +48,11 @@
 #include "pluginlib/class_list_macros.hpp"
 #include "sensor_msgs/point_cloud2_iterator.hpp"
 
-#define VOXEL_BITS 16
 PLUGINLIB_EXPORT_CLASS(nav2_costmap_2d::VoxelLayer, nav2_costmap_2d::Layer)
+PLUGINLIB_EXPORT_CLASS(nav2_costmap_2d::VoxelLayer64, nav2_costmap_2d::Layer)
+#ifdef __SIZEOF_INT128__
+PLUGINLIB_EXPORT_CLASS(nav2_costmap_2d::VoxelLayer128, nav2_costmap_2d::Layer)
+#endif
 
 using nav2_costmap_2d::NO_INFORMATION;
 using nav2_costmap_2d::LETHAL_OBSTACLE;
@@ -58,7 +62,8 @@ using rcl_interfaces::msg::ParameterType;
 namespace nav2_costmap_2d
 {
 
-void VoxelLayer::onInitialize()
+template<class VoxelGridT>
+void BasicVoxelLayer<VoxelGridT>::onInitialize()
 {
   ObstacleLayer::onInitialize();
 
@@ -72,6 +77,9 @@ void VoxelLayer::onInitialize()
   declareParameter("mark_threshold", rclcpp::ParameterValue(0));
   declareParameter("combination_method", rclcpp::ParameterValue(1));
   declareParameter("publish_voxel_map", rclcpp::ParameterValue(false));
+  declareParameter("publish_voxel_map_updates", rclcpp::ParameterValue(false));
+  declareParameter("parallel_clearing", rclcpp::ParameterValue(false));
+  declareParameter("voxel_decay", rclcpp::ParameterValue(0.0));
 
   auto node = node_.lock();
   if (!node) {
@@ -88,6 +96,9 @@ void VoxelLayer::onInitialize()
   node->get_parameter(name_ + "." + "mark_threshold", mark_threshold_);
   node->get_parameter(name_ + "." + "combination_method", combination_method_);
   node->get_parameter(name_ + "." + "publish_voxel_map", publish_voxel_);
+  node->get_parameter(name_ + "." + "publish_voxel_map_updates", publish_voxel_updates_);
+  node->get_parameter(name_ + "." + "parallel_clearing", parallel_clearing_);
+  node->get_parameter(name_ + "." + "voxel_decay", voxel_decay_);
 
   auto custom_qos = rclcpp::QoS(rclcpp::KeepLast(1)).transient_local().reliable();
 
@@ -96,42 +107,62 @@ void VoxelLayer::onInitialize()
       "voxel_grid", custom_qos);
     voxel_pub_->on_activate();
   }
+  if (publish_voxel_updates_) {
+    voxel_update_pub_ = node->create_publisher<nav2_msgs::msg::VoxelGridUpdate>(
+      "voxel_grid_updates", custom_qos);
+    voxel_update_pub_->on_activate();
+  }
 
   clearing_endpoints_pub_ = node->create_publisher<sensor_msgs::msg::PointCloud2>(
     "clearing_endpoints", custom_qos);
   clearing_endpoints_pub_->on_activate();
 
-  unknown_threshold_ += (VOXEL_BITS - size_z_);
+  unknown_threshold_ += (static_cast<int>(VoxelGridT::max_size_z) - size_z_);
   matchSize();
 
   // Add callback for dynamic parameters
   dyn_params_handler_ = node->add_on_set_parameters_callback(
     std::bind(
-      &VoxelLayer::dynamicParametersCallback,
+      &BasicVoxelLayer::dynamicParametersCallback,
       this, std::placeholders::_1));
 }
 
-VoxelLayer::~VoxelLayer()
+template<class VoxelGridT>
+BasicVoxelLayer<VoxelGridT>::~BasicVoxelLayer()
 {
   dyn_params_handler_.reset();
 }
 
-void VoxelLayer::matchSize()
+template<class VoxelGridT>
+void BasicVoxelLayer<VoxelGridT>::matchSize()
 {
   std::lock_guard<Costmap2D::mutex_t> guard(*getMutex());
+  // Voxel filters of the observations keep points of each voxel
+  voxel_filter_z_resolution_ = z_resolution_;
+  voxel_filter_origin_z_ = origin_z_;
   ObstacleLayer::matchSize();
   voxel_grid_.resize(size_x_, size_y_, size_z_);
+  // Stamps are only kept when decaying, being 4 bytes per voxel
+  if (voxel_decay_ > 0.0) {
+    voxel_stamps_.resize(size_x_, size_y_, size_z_);
+  } else {
+    voxel_stamps_.resize(0, 0, 0);
+  }
+  decay_masks_.masks.assign(voxel_decay_ > 0.0 ? size_x_ * size_y_ : 0, 0);
+  full_voxel_update_ = true;
   assert(voxel_grid_.sizeX() == size_x_ && voxel_grid_.sizeY() == size_y_);
 }
 
-void VoxelLayer::reset()
+template<class VoxelGridT>
+void BasicVoxelLayer<VoxelGridT>::reset()
 {
   // Call the base class method before adding our own functionality
   ObstacleLayer::reset();
   resetMaps();
 }
 
-void VoxelLayer::resetMaps()
+template<class VoxelGridT>
+void BasicVoxelLayer<VoxelGridT>::resetMaps()
 {
   // Call the base class method before adding our own functionality
   // Note: at the time this was written, ObstacleLayer doesn't implement
@@ -139,9 +170,12 @@ void VoxelLayer::resetMaps()
   // doesn't implement this, so it actually goes all the way to Costmap2D
   ObstacleLayer::resetMaps();
   voxel_grid_.reset();
+  voxel_stamps_.reset();
+  full_voxel_update_ = true;
 }
 
-void VoxelLayer::updateBounds(
+template<class VoxelGridT>
+void BasicVoxelLayer<VoxelGridT>::updateBounds(
   double robot_x, double robot_y, double robot_yaw, double * min_x,
   double * min_y, double * max_x, double * max_y)
 {
@@ -154,6 +188,7 @@ void VoxelLayer::updateBounds(
     return;
   }
   useExtraBounds(min_x, min_y, max_x, max_y);
+  restorePendingSnapshot(robot_x, robot_y, min_x, min_y, max_x, max_y);
 
   bool current = true;
   std::vector<Observation> observations, clearing_observations;
@@ -166,13 +201,29 @@ void VoxelLayer::updateBounds(
 
   // update the global current status
   current_ = current;
+  addSensorStamps(observations);
+  addSensorStamps(clearing_observations);
 
   // raytrace freespace
   for (unsigned int i = 0; i < clearing_observations.size(); ++i) {
-    raytraceFreespace(clearing_observations[i], min_x, min_y, max_x, max_y);
+    raytraceFreespace(
+      getRaytracedObservation(clearing_observations[i], z_resolution_),
+      min_x, min_y, max_x, max_y);
   }
 
-  // place the new obstacles into a priority queue... each with a priority of zero to begin with
+  // clear the voxels not seen again, before those seen now are stamped
+  uint32_t decay_tick = 0;
+  if (!voxel_stamps_.empty()) {
+    decay_tick = getDecayTick();
+    decayVoxels(decay_tick, min_x, min_y, max_x, max_y);
+  }
+
+  // The points of the observations are accumulated per column, so that each column is
+  // marked once however many points fall in it, as on walls
+  if (marking_masks_.masks.size() != static_cast<size_t>(size_x_) * size_y_) {
+    marking_masks_.masks.assign(static_cast<size_t>(size_x_) * size_y_, 0);
+  }
+  marking_masks_.columns.clear();
   for (std::vector<Observation>::const_iterator it = observations.begin(); it != observations.end();
     ++it)
   {
@@ -218,26 +269,31 @@ void VoxelLayer::updateBounds(
         continue;
       }
 
-      // mark the cell in the voxel grid and check if we should also mark it in the costmap
-      if (voxel_grid_.markVoxelInMap(mx, my, mz, mark_threshold_)) {
-        unsigned int index = getIndex(mx, my);
-
-        costmap_[index] = LETHAL_OBSTACLE;
-        touch(
-          static_cast<double>(*iter_x), static_cast<double>(*iter_y),
-          min_x, min_y, max_x, max_y);
+      voxel_grid_.accumulateMarkVoxel(
+        mx, my, mz, marking_masks_.masks.data(), marking_masks_.columns);
+      if (decay_tick != 0) {
+        voxel_stamps_.stamp(getIndex(mx, my), mz, decay_tick);
       }
     }
   }
 
+  // mark the voxels in the voxel grid, and the columns with enough of them in the costmap
+  voxel_grid_.markColumns(marking_masks_.masks.data(), marking_masks_.columns, mark_threshold_);
+  for (const unsigned int & index : marking_masks_.columns) {
+    costmap_[index] = LETHAL_OBSTACLE;
+    double wx, wy;
+    mapToWorld(index % size_x_, index / size_x_, wx, wy);
+    touch(wx, wy, min_x, min_y, max_x, max_y);
+  }
+
   if (publish_voxel_) {
     auto grid_msg = std::make_unique<nav2_msgs::msg::VoxelGrid>();
     unsigned int size = voxel_grid_.sizeX() * voxel_grid_.sizeY();
     grid_msg->size_x = voxel_grid_.sizeX();
     grid_msg->size_y = voxel_grid_.sizeY();
     grid_msg->size_z = voxel_grid_.sizeZ();
-    grid_msg->data.resize(size);
-    memcpy(&grid_msg->data[0], voxel_grid_.getData(), size * sizeof(unsigned int));
+    grid_msg->data.resize(size * VoxelGridT::packed_words);
+    voxel_grid_.packData(&grid_msg->data[0]);
 
     grid_msg->origin.x = origin_x_;
     grid_msg->origin.y = origin_y_;
@@ -251,11 +307,185 @@ void VoxelLayer::updateBounds(
 
     voxel_pub_->publish(std::move(grid_msg));
   }
+  if (publish_voxel_updates_) {
+    publishVoxelGridUpdate(*min_x, *min_y, *max_x, *max_y);
+  }
 
   updateFootprint(robot_x, robot_y, robot_yaw, min_x, min_y, max_x, max_y);
+  updateSnapshot(robot_x, robot_y);
+}
+
+template<class VoxelGridT>
+void BasicVoxelLayer<VoxelGridT>::fillSnapshot(LayerSnapshot & snapshot)
+{
+  ObstacleLayer::fillSnapshot(snapshot);
+  typedef typename VoxelGridT::WordType Word;
+  const uint8_t * columns = reinterpret_cast<const uint8_t *>(voxel_grid_.getData());
+  snapshot.size_z = size_z_;
+  snapshot.word_size = sizeof(Word);
+  snapshot.origin_z = origin_z_;
+  snapshot.z_resolution = z_resolution_;
+  snapshot.voxels.assign(columns, columns + snapshot.costs.size() * sizeof(Word));
+}
+
+template<class VoxelGridT>
+bool BasicVoxelLayer<VoxelGridT>::applySnapshot(const LayerSnapshot & snapshot)
+{
+  typedef typename VoxelGridT::WordType Word;
+  if (snapshot.word_size != sizeof(Word) || snapshot.size_z != static_cast<unsigned int>(size_z_) ||
+    std::abs(snapshot.origin_z - origin_z_) > 1e-6 ||
+    std::abs(snapshot.z_resolution - z_resolution_) > 1e-6)
+  {
+    return false;
+  }
+  ObstacleLayer::applySnapshot(snapshot);
+  const int offset_x = static_cast<int>(std::lround((snapshot.origin_x - origin_x_) / resolution_));
+  const int offset_y = static_cast<int>(std::lround((snapshot.origin_y - origin_y_) / resolution_));
+  Word * columns = voxel_grid_.getData();
+  copyOverlappingCells(
+    snapshot.voxels.data(), snapshot.size_x, snapshot.size_y,
+    reinterpret_cast<uint8_t *>(columns), size_x_, size_y_, offset_x, offset_y, sizeof(Word));
+
+  // Restored voxels decay as if just marked
+  if (!voxel_stamps_.empty()) {
+    const uint32_t tick = getDecayTick();
+    for (unsigned int index = 0; index < size_x_ * size_y_; ++index) {
+      for (int z = 0; columns[index] != 0 && z < size_z_; ++z) {
+        const Word mask = VoxelGridT::voxelMask(z);
+        if ((columns[index] & mask) == mask) {
+          voxel_stamps_.stamp(index, z, tick);
+        }
+      }
+    }
+  }
+  full_voxel_update_ = true;
+  return true;
+}
+
+template<class VoxelGridT>
+uint32_t BasicVoxelLayer<VoxelGridT>::getDecayTick()
+{
+  const int64_t now_ns = clock_->now().nanoseconds();
+  if (decay_start_ns_ < 0) {
+    decay_start_ns_ = now_ns;
+  }
+  const int64_t tick = (now_ns - decay_start_ns_) / 1000000 + 1;
+  decay_tick_ = std::max(decay_tick_, static_cast<uint32_t>(std::max<int64_t>(tick, 1)));
+  return decay_tick_;
 }
 
-void VoxelLayer::raytraceFreespace(
+template<class VoxelGridT>
+void BasicVoxelLayer<VoxelGridT>::decayVoxels(
+  uint32_t tick, double * min_x, double * min_y, double * max_x, double * max_y)
+{
+  typedef typename VoxelGridT::WordType Word;
+  const Word * columns = voxel_grid_.getData();
+  std::vector<Word> & masks = decay_masks_.masks;
+  decay_masks_.columns.clear();
+  voxel_stamps_.sweep(
+    tick, static_cast<uint32_t>(voxel_decay_ * 1000.0),
+    [&](unsigned int index, unsigned int z) {
+      // Voxels cleared by raytracing since being stamped need no clearing
+      const Word mask = VoxelGridT::voxelMask(z);
+      if ((columns[index] & mask) != mask) {
+        return;
+      }
+      if (masks[index] == 0) {
+        decay_masks_.columns.push_back(index);
+      }
+      masks[index] |= mask;
+    });
+  if (decay_masks_.columns.empty()) {
+    return;
+  }
+
+  for (const unsigned int & index : decay_masks_.columns) {
+    double wx, wy;
+    mapToWorld(index % size_x_, index / size_x_, wx, wy);
+    touch(wx, wy, min_x, min_y, max_x, max_y);
+  }
+  voxel_grid_.clearColumnsInMap(
+    masks.data(), decay_masks_.columns, costmap_,
+    unknown_threshold_, mark_threshold_, FREE_SPACE, NO_INFORMATION);
+}
+
+template<class VoxelGridT>
+void BasicVoxelLayer<VoxelGridT>::publishVoxelGridUpdate(
+  double min_x, double min_y, double max_x, double max_y)
+{
+  typedef typename VoxelGridT::WordType Word;
+  const unsigned int size = voxel_grid_.sizeX() * voxel_grid_.sizeY();
+  const Word * columns = voxel_grid_.getData();
+
+  // Subscribers joining need a full update to apply the following ones to
+  const size_t subscribers = voxel_update_pub_->get_subscription_count();
+  const bool full = full_voxel_update_ || published_columns_.size() != size ||
+    published_origin_x_ != origin_x_ || published_origin_y_ != origin_y_ ||
+    subscribers > published_subscribers_;
+  published_subscribers_ = subscribers;
+
+  auto update_msg = std::make_unique<nav2_msgs::msg::VoxelGridUpdate>();
+  auto add_column = [&](unsigned int index) {
+      update_msg->indices.push_back(index);
+      for (unsigned int w = 0; w < VoxelGridT::packed_words; ++w) {
+        update_msg->data.push_back(static_cast<uint32_t>(columns[index] >> (32 * w)));
+      }
+    };
+
+  if (full) {
+    // Voxels above the grid are unknown in all columns, but are not part of it
+    Word voxels = 0;
+    for (int z = 0; z < size_z_; ++z) {
+      voxels |= VoxelGridT::voxelMask(z);
+    }
+    for (unsigned int index = 0; index < size; ++index) {
+      if (columns[index] & voxels) {
+        add_column(index);
+      }
+    }
+    published_columns_.assign(columns, columns + size);
+    published_origin_x_ = origin_x_;
+    published_origin_y_ = origin_y_;
+    full_voxel_update_ = false;
+  } else {
+    // Only the window of this update can have changed since the last one
+    int x0, y0, xn, yn;
+    if (min_x > max_x || min_y > max_y) {
+      return;
+    }
+    worldToMapEnforceBounds(min_x, min_y, x0, y0);
+    worldToMapEnforceBounds(max_x, max_y, xn, yn);
+    for (int y = y0; y <= yn; ++y) {
+      for (unsigned int index = getIndex(x0, y); index <= getIndex(xn, y); ++index) {
+        if (columns[index] != published_columns_[index]) {
+          published_columns_[index] = columns[index];
+          add_column(index);
+        }
+      }
+    }
+    if (update_msg->indices.empty()) {
+      return;
+    }
+  }
+
+  update_msg->header.frame_id = global_frame_;
+  update_msg->header.stamp = clock_->now();
+  update_msg->full = full;
+  update_msg->origin.x = origin_x_;
+  update_msg->origin.y = origin_y_;
+  update_msg->origin.z = origin_z_;
+  update_msg->resolutions.x = resolution_;
+  update_msg->resolutions.y = resolution_;
+  update_msg->resolutions.z = z_resolution_;
+  update_msg->size_x = voxel_grid_.sizeX();
+  update_msg->size_y = voxel_grid_.sizeY();
+  update_msg->size_z = voxel_grid_.sizeZ();
+  update_msg->words_per_column = VoxelGridT::packed_words;
+  voxel_update_pub_->publish(std::move(update_msg));
+}
+
+template<class VoxelGridT>
+void BasicVoxelLayer<VoxelGridT>::raytraceFreespace(
   const Observation & clearing_observation, double * min_x,
   double * min_y,
   double * max_x,
@@ -315,6 +545,13 @@ void VoxelLayer::raytraceFreespace(
   double map_end_y = origin_y_ + getSizeInMetersY();
   double map_end_z = origin_z_ + getSizeInMetersZ();
 
+  unsigned int cell_raytrace_max_range = cellDistance(clearing_observation.raytrace_max_range_);
+  unsigned int cell_raytrace_min_range = cellDistance(clearing_observation.raytrace_min_range_);
+
+  // Rays are only collected here when cleared in parallel, after all endpoints are known
+  TileThreadPool * pool = parallel_clearing_ ? layered_costmap_->getTileThreadPool() : nullptr;
+  clearing_rays_.clear();
+
   sensor_msgs::PointCloud2ConstIterator<float> iter_x(*(clearing_observation.cloud_), "x");
   sensor_msgs::PointCloud2ConstIterator<float> iter_y(*(clearing_observation.cloud_), "y");
   sensor_msgs::PointCloud2ConstIterator<float> iter_z(*(clearing_observation.cloud_), "z");
@@ -368,16 +605,20 @@ void VoxelLayer::raytraceFreespace(
 
     double point_x, point_y, point_z;
     if (worldToMap3DFloat(wpx, wpy, wpz, point_x, point_y, point_z)) {
-      unsigned int cell_raytrace_max_range = cellDistance(clearing_observation.raytrace_max_range_);
-      unsigned int cell_raytrace_min_range = cellDistance(clearing_observation.raytrace_min_range_);
-
-
-      // voxel_grid_.markVoxelLine(sensor_x, sensor_y, sensor_z, point_x, point_y, point_z);
-      voxel_grid_.clearVoxelLineInMap(
-        sensor_x, sensor_y, sensor_z, point_x, point_y, point_z,
-        costmap_,
-        unknown_threshold_, mark_threshold_, FREE_SPACE, NO_INFORMATION,
-        cell_raytrace_max_range, cell_raytrace_min_range);
+      if (pool) {
+        geometry_msgs::msg::Point ray_end;
+        ray_end.x = point_x;
+        ray_end.y = point_y;
+        ray_end.z = point_z;
+        clearing_rays_.push_back(ray_end);
+      } else {
+        // voxel_grid_.markVoxelLine(sensor_x, sensor_y, sensor_z, point_x, point_y, point_z);
+        voxel_grid_.clearVoxelLineInMap(
+          sensor_x, sensor_y, sensor_z, point_x, point_y, point_z,
+          costmap_,
+          unknown_threshold_, mark_threshold_, FREE_SPACE, NO_INFORMATION,
+          cell_raytrace_max_range, cell_raytrace_min_range);
+      }
 
       updateRaytraceBounds(
         ox, oy, wpx, wpy, clearing_observation.raytrace_max_range_,
@@ -397,6 +638,11 @@ void VoxelLayer::raytraceFreespace(
     }
   }
 
+  if (pool && !clearing_rays_.empty()) {
+    clearRaysInParallel(
+      *pool, sensor_x, sensor_y, sensor_z, cell_raytrace_max_range, cell_raytrace_min_range);
+  }
+
   if (publish_clearing_points) {
     clearing_endpoints_->header.frame_id = global_frame_;
     clearing_endpoints_->header.stamp = clearing_observation.cloud_->header.stamp;
@@ -405,7 +651,56 @@ void VoxelLayer::raytraceFreespace(
   }
 }
 
-void VoxelLayer::updateOrigin(double new_origin_x, double new_origin_y)
+template<class VoxelGridT>
+void BasicVoxelLayer<VoxelGridT>::clearRaysInParallel(
+  TileThreadPool & pool, double sensor_x, double sensor_y, double sensor_z,
+  unsigned int cell_raytrace_max_range, unsigned int cell_raytrace_min_range)
+{
+  const unsigned int threads = pool.getThreads();
+  const unsigned int cells = size_x_ * size_y_;
+  clearing_masks_.resize(threads);
+  for (ClearingMasks & clearing_masks : clearing_masks_) {
+    if (clearing_masks.masks.size() != cells) {
+      clearing_masks.masks.assign(cells, 0);
+    }
+    clearing_masks.columns.clear();
+  }
+
+  // Consecutive points of a cloud are mostly neighboring rays, so splitting the
+  // rays in contiguous ranges gives each thread a sector with few shared columns
+  const unsigned int count = clearing_rays_.size();
+  pool.run(
+    threads, [&](unsigned int sector) {
+      ClearingMasks & clearing_masks = clearing_masks_[sector];
+      const unsigned int end = static_cast<uint64_t>(count) * (sector + 1) / threads;
+      for (unsigned int i = static_cast<uint64_t>(count) * sector / threads; i < end; ++i) {
+        const geometry_msgs::msg::Point & ray_end = clearing_rays_[i];
+        voxel_grid_.accumulateClearVoxelLine(
+          sensor_x, sensor_y, sensor_z, ray_end.x, ray_end.y, ray_end.z,
+          clearing_masks.masks.data(), clearing_masks.columns,
+          cell_raytrace_max_range, cell_raytrace_min_range);
+      }
+    });
+
+  ClearingMasks & merged = clearing_masks_[0];
+  for (unsigned int t = 1; t < threads; ++t) {
+    ClearingMasks & clearing_masks = clearing_masks_[t];
+    for (const unsigned int & column : clearing_masks.columns) {
+      if (merged.masks[column] == 0) {
+        merged.columns.push_back(column);
+      }
+      merged.masks[column] |= clearing_masks.masks[column];
+      clearing_masks.masks[column] = 0;
+    }
+  }
+
+  voxel_grid_.clearColumnsInMap(
+    merged.masks.data(), merged.columns, costmap_,
+    unknown_threshold_, mark_threshold_, FREE_SPACE, NO_INFORMATION);
+}
+
+template<class VoxelGridT>
+void BasicVoxelLayer<VoxelGridT>::updateOrigin(double new_origin_x, double new_origin_y)
 {
   // project the new origin into the grid
   int cell_ox, cell_oy;
@@ -418,66 +713,30 @@ void VoxelLayer::updateOrigin(double new_origin_x, double new_origin_y)
   new_grid_ox = origin_x_ + cell_ox * resolution_;
   new_grid_oy = origin_y_ + cell_oy * resolution_;
 
-  // To save casting from unsigned int to int a bunch of times
-  int size_x = size_x_;
-  int size_y = size_y_;
-
-  // we need to compute the overlap of the new and existing windows
-  int lower_left_x, lower_left_y, upper_right_x, upper_right_y;
-  lower_left_x = std::min(std::max(cell_ox, 0), size_x);
-  lower_left_y = std::min(std::max(cell_oy, 0), size_y);
-  upper_right_x = std::min(std::max(cell_ox + size_x, 0), size_x);
-  upper_right_y = std::min(std::max(cell_oy + size_y, 0), size_y);
-
-  unsigned int cell_size_x = upper_right_x - lower_left_x;
-  unsigned int cell_size_y = upper_right_y - lower_left_y;
-
-  // we need a map to store the obstacles in the window temporarily
-  unsigned char * local_map = new unsigned char[cell_size_x * cell_size_y];
-  unsigned int * local_voxel_map = new unsigned int[cell_size_x * cell_size_y];
-  unsigned int * voxel_map = voxel_grid_.getData();
-
-  // copy the local window in the costmap to the local map
-  copyMapRegion(
-    costmap_, lower_left_x, lower_left_y, size_x_, local_map, 0, 0, cell_size_x,
-    cell_size_x,
-    cell_size_y);
-  copyMapRegion(
-    voxel_map, lower_left_x, lower_left_y, size_x_, local_voxel_map, 0, 0, cell_size_x,
-    cell_size_x,
-    cell_size_y);
-
-  // we'll reset our maps to unknown space if appropriate
-  resetMaps();
+  // move the overlap of the new and existing windows in place, and reset the rest
+  // of our maps to unknown space if appropriate
+  shiftMapRegion(costmap_, size_x_, size_y_, cell_ox, cell_oy, default_value_);
+  shiftMapRegion(
+    voxel_grid_.getData(), size_x_, size_y_, cell_ox, cell_oy, VoxelGridT::unknown_column);
+  if (!voxel_stamps_.empty()) {
+    for (int z = 0; z < size_z_; ++z) {
+      shiftMapRegion(voxel_stamps_.getStamps(z), size_x_, size_y_, cell_ox, cell_oy, 0u);
+    }
+    voxel_stamps_.shiftOrigin(cell_ox, cell_oy);
+  }
 
   // update the origin with the appropriate world coordinates
   origin_x_ = new_grid_ox;
   origin_y_ = new_grid_oy;
-
-  // compute the starting cell location for copying data back in
-  int start_x = lower_left_x - cell_ox;
-  int start_y = lower_left_y - cell_oy;
-
-  // now we want to copy the overlapping information back into the map, but in its new location
-  copyMapRegion(
-    local_map, 0, 0, cell_size_x, costmap_, start_x, start_y, size_x_, cell_size_x,
-    cell_size_y);
-  copyMapRegion(
-    local_voxel_map, 0, 0, cell_size_x, voxel_map, start_x, start_y, size_x_,
-    cell_size_x,
-    cell_size_y);
-
-  // make sure to clean up
-  delete[] local_map;
-  delete[] local_voxel_map;
 }
 
 /**
   * @brief Callback executed when a parameter change is detected
   * @param event ParameterEvent message
   */
+template<class VoxelGridT>
 rcl_interfaces::msg::SetParametersResult
-VoxelLayer::dynamicParametersCallback(
+BasicVoxelLayer<VoxelGridT>::dynamicParametersCallback(
   std::vector<rclcpp::Parameter> parameters)
 {
   std::lock_guard<Costmap2D::mutex_t> guard(*getMutex());
@@ -497,6 +756,11 @@ VoxelLayer::dynamicParametersCallback(
       } else if (param_name == name_ + "." + "z_resolution") {
         z_resolution_ = parameter.as_double();
         resize_map_needed = true;
+      } else if (param_name == name_ + "." + "voxel_decay") {
+        // Stamps are only kept when decaying, so the voxels are reset to start or stop
+        const double voxel_decay = parameter.as_double();
+        resize_map_needed |= (voxel_decay > 0.0) != (voxel_decay_ > 0.0);
+        voxel_decay_ = voxel_decay;
       }
     } else if (param_type == ParameterType::PARAMETER_BOOL) {
       if (param_name == name_ + "." + "enabled") {
@@ -504,11 +768,18 @@ VoxelLayer::dynamicParametersCallback(
         current_ = false;
       } else if (param_name == name_ + "." + "footprint_clearing_enabled") {
         footprint_clearing_enabled_ = parameter.as_bool();
+      } else if (param_name == name_ + "." + "parallel_clearing") {
+        parallel_clearing_ = parameter.as_bool();
       } else if (param_name == name_ + "." + "publish_voxel_map") {
         RCLCPP_WARN(
           logger_, "publish voxel map is not a dynamic parameter "
           "cannot be changed while running. Rejecting parameter update.");
         continue;
+      } else if (param_name == name_ + "." + "publish_voxel_map_updates") {
+        RCLCPP_WARN(
+          logger_, "publish voxel map updates is not a dynamic parameter "
+          "cannot be changed while running. Rejecting parameter update.");
+        continue;
       }
 
     } else if (param_type == ParameterType::PARAMETER_INTEGER) {
@@ -516,7 +787,8 @@ VoxelLayer::dynamicParametersCallback(
         size_z_ = parameter.as_int();
         resize_map_needed = true;
       } else if (param_name == name_ + "." + "unknown_threshold") {
-        unknown_threshold_ = parameter.as_int() + (VOXEL_BITS - size_z_);
+        unknown_threshold_ =
+          parameter.as_int() + (static_cast<int>(VoxelGridT::max_size_z) - size_z_);
       } else if (param_name == name_ + "." + "mark_threshold") {
         mark_threshold_ = parameter.as_int();
       } else if (param_name == name_ + "." + "combination_method") {
@@ -533,4 +805,10 @@ VoxelLayer::dynamicParametersCallback(
   return result;
 }
 
+template class BasicVoxelLayer<nav2_voxel_grid::VoxelGrid>;
+template class BasicVoxelLayer<nav2_voxel_grid::VoxelGrid64>;
+#ifdef __SIZEOF_INT128__
+template class BasicVoxelLayer<nav2_voxel_grid::VoxelGrid128>;
+#endif
+
 }  // namespace nav2_costmap_2d
@@ -16,6 +16,7 @@
 #include <string>
 #include <algorithm>
 #include <memory>
+#include <mutex>
 
 #include "nav2_costmap_2d/clear_costmap_service.hpp"
 #include "nav2_costmap_2d/costmap_2d_ros.hpp"
@@ -41,6 +42,7 @@ ClearCostmapService::ClearCostmapService(
   reset_value_ = costmap_.getCostmap()->getDefaultValue();
 
   node->get_parameter("clearable_layers", clearable_layers_);
+  node->get_parameter("defer_clearing", defer_clearing_);
 
   clear_except_service_ = node->create_service<ClearExceptRegion>(
     "clear_except_" + costmap_.getName(),
@@ -104,17 +106,55 @@ void ClearCostmapService::clearRegion(const double reset_distance, bool invert)
     return;
   }
 
-  auto layers = costmap_.getLayeredCostmap()->getPlugins();
+  if (defer_clearing_) {
+    // Cleared around the pose at the time of the request
+    std::lock_guard<std::mutex> lock(deferred_mutex_);
+    deferred_clearing_.push_back({x, y, reset_distance, invert});
+  } else {
+    clearLayers(x, y, reset_distance, invert, nullptr);
+  }
+  costmap_.getLayeredCostmap()->requestUpdate();
+
+  // AlexeyMerzlyakov: No need to clear layer region for costmap filters
+  // as they are always supposed to be not clearable.
+}
+
+void ClearCostmapService::applyDeferredClearing()
+{
+  std::vector<DeferredClearing> clearing;
+  {
+    std::lock_guard<std::mutex> lock(deferred_mutex_);
+    clearing.swap(deferred_clearing_);
+  }
+
+  TileThreadPool * thread_pool = costmap_.getLayeredCostmap()->getTileThreadPool();
+  for (const auto & region : clearing) {
+    clearLayers(region.x, region.y, region.reset_distance, region.invert, thread_pool);
+  }
+}
 
-  for (auto & layer : *layers) {
+void ClearCostmapService::clearLayers(
+  double pose_x, double pose_y, double reset_distance, bool invert,
+  TileThreadPool * thread_pool)
+{
+  vector<shared_ptr<CostmapLayer>> costmap_layers;
+  for (auto & layer : *costmap_.getLayeredCostmap()->getPlugins()) {
     if (layer->isClearable()) {
-      auto costmap_layer = std::static_pointer_cast<CostmapLayer>(layer);
-      clearLayerRegion(costmap_layer, x, y, reset_distance, invert);
+      costmap_layers.push_back(std::static_pointer_cast<CostmapLayer>(layer));
     }
   }
 
-  // AlexeyMerzlyakov: No need to clear layer region for costmap filters
-  // as they are always supposed to be not clearable.
+  // The layers have their own grids and mutexes, so are cleared independently
+  if (thread_pool && costmap_layers.size() > 1) {
+    thread_pool->run(
+      costmap_layers.size(), [&](unsigned int i) {
+        clearLayerRegion(costmap_layers[i], pose_x, pose_y, reset_distance, invert);
+      });
+  } else {
+    for (auto & costmap_layer : costmap_layers) {
+      clearLayerRegion(costmap_layer, pose_x, pose_y, reset_distance, invert);
+    }
+  }
 }
 
 void ClearCostmapService::clearLayerRegion(
@@ -134,6 +174,11 @@ void ClearCostmapService::clearLayerRegion(
 
   costmap->clearArea(start_x, start_y, end_x, end_y, invert);
 
+  // Only the region cleared needs an update, or all but it when inverted
+  if (!invert) {
+    costmap->addExtraBounds(start_point_x, start_point_y, end_point_x, end_point_y);
+    return;
+  }
   double ox = costmap->getOriginX(), oy = costmap->getOriginY();
   double width = costmap->getSizeInMetersX(), height = costmap->getSizeInMetersY();
   costmap->addExtraBounds(ox, oy, ox + width, oy + height);
@@ -0,0 +1,208 @@
+// Copyright (c) 2022 Samsung Research America
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "nav2_costmap_2d/combination_kernels.hpp"
+
+#include <algorithm>
+
+#include "nav2_costmap_2d/cost_values.hpp"
+
+#if defined(__AVX2__)
+#include <immintrin.h>
+#elif defined(__SSE2__)
+#include <emmintrin.h>
+#if defined(__SSE4_1__)
+#include <smmintrin.h>
+#endif
+#elif defined(__ARM_NEON)
+#include <arm_neon.h>
+#endif
+
+namespace nav2_costmap_2d
+{
+
+namespace
+{
+
+// Scalar kernels of one cell, for the fallback and the remainders of the vector loops
+
+inline unsigned char maxCell(unsigned char master, unsigned char layer)
+{
+  if (layer == NO_INFORMATION) {
+    return master;
+  }
+  return (master == NO_INFORMATION || master < layer) ? layer : master;
+}
+
+inline unsigned char overwriteCell(unsigned char master, unsigned char layer)
+{
+  return layer == NO_INFORMATION ? master : layer;
+}
+
+inline unsigned char additionCell(unsigned char master, unsigned char layer)
+{
+  if (layer == NO_INFORMATION) {
+    return master;
+  }
+  if (master == NO_INFORMATION) {
+    return layer;
+  }
+  const int sum = master + layer;
+  return sum >= INSCRIBED_INFLATED_OBSTACLE ? INSCRIBED_INFLATED_OBSTACLE - 1 : sum;
+}
+
+// Vector operations of each instruction set, where select() takes
+// the lanes of b where the mask is set and those of a elsewhere
+#if defined(__AVX2__)
+
+constexpr unsigned int kLanes = 32;
+typedef __m256i Vector;
+
+inline Vector load(const unsigned char * p)
+{
+  return _mm256_loadu_si256(reinterpret_cast<const Vector *>(p));
+}
+
+inline void store(unsigned char * p, Vector v)
+{
+  _mm256_storeu_si256(reinterpret_cast<Vector *>(p), v);
+}
+
+inline Vector splat(unsigned char c) {return _mm256_set1_epi8(static_cast<char>(c));}
+inline Vector isEqual(Vector a, Vector b) {return _mm256_cmpeq_epi8(a, b);}
+inline Vector maxU8(Vector a, Vector b) {return _mm256_max_epu8(a, b);}
+inline Vector minU8(Vector a, Vector b) {return _mm256_min_epu8(a, b);}
+inline Vector addsU8(Vector a, Vector b) {return _mm256_adds_epu8(a, b);}
+inline Vector select(Vector mask, Vector a, Vector b) {return _mm256_blendv_epi8(a, b, mask);}
+
+#elif defined(__SSE2__)
+
+constexpr unsigned int kLanes = 16;
+typedef __m128i Vector;
+
+inline Vector load(const unsigned char * p)
+{
+  return _mm_loadu_si128(reinterpret_cast<const Vector *>(p));
+}
+
+inline void store(unsigned char * p, Vector v)
+{
+  _mm_storeu_si128(reinterpret_cast<Vector *>(p), v);
+}
+
+inline Vector splat(unsigned char c) {return _mm_set1_epi8(static_cast<char>(c));}
+inline Vector isEqual(Vector a, Vector b) {return _mm_cmpeq_epi8(a, b);}
+inline Vector maxU8(Vector a, Vector b) {return _mm_max_epu8(a, b);}
+inline Vector minU8(Vector a, Vector b) {return _mm_min_epu8(a, b);}
+inline Vector addsU8(Vector a, Vector b) {return _mm_adds_epu8(a, b);}
+#if defined(__SSE4_1__)
+inline Vector select(Vector mask, Vector a, Vector b) {return _mm_blendv_epi8(a, b, mask);}
+#else
+inline Vector select(Vector mask, Vector a, Vector b)
+{
+  return _mm_or_si128(_mm_and_si128(mask, b), _mm_andnot_si128(mask, a));
+}
+#endif
+
+#elif defined(__ARM_NEON)
+
+constexpr unsigned int kLanes = 16;
+typedef uint8x16_t Vector;
+
+inline Vector load(const unsigned char * p) {return vld1q_u8(p);}
+inline void store(unsigned char * p, Vector v) {vst1q_u8(p, v);}
+inline Vector splat(unsigned char c) {return vdupq_n_u8(c);}
+inline Vector isEqual(Vector a, Vector b) {return vceqq_u8(a, b);}
+inline Vector maxU8(Vector a, Vector b) {return vmaxq_u8(a, b);}
+inline Vector minU8(Vector a, Vector b) {return vminq_u8(a, b);}
+inline Vector addsU8(Vector a, Vector b) {return vqaddq_u8(a, b);}
+inline Vector select(Vector mask, Vector a, Vector b) {return vbslq_u8(mask, b, a);}
+
+#endif
+
+}  // namespace
+
+void combineWithMax(unsigned char * master, const unsigned char * layer, unsigned int size)
+{
+  unsigned int i = 0;
+#if defined(__AVX2__) || defined(__SSE2__) || defined(__ARM_NEON)
+  const Vector unknown = splat(NO_INFORMATION);
+  for (; i + kLanes <= size; i += kLanes) {
+    const Vector m = load(master + i);
+    const Vector l = load(layer + i);
+    // An unknown master cell takes the layer cost, as the maximum would keep it unknown
+    Vector result = select(isEqual(m, unknown), maxU8(m, l), l);
+    result = select(isEqual(l, unknown), result, m);
+    store(master + i, result);
+  }
+#endif
+  for (; i < size; ++i) {
+    master[i] = maxCell(master[i], layer[i]);
+  }
+}
+
+void combineWithOverwrite(unsigned char * master, const unsigned char * layer, unsigned int size)
+{
+  unsigned int i = 0;
+#if defined(__AVX2__) || defined(__SSE2__) || defined(__ARM_NEON)
+  const Vector unknown = splat(NO_INFORMATION);
+  for (; i + kLanes <= size; i += kLanes) {
+    const Vector m = load(master + i);
+    const Vector l = load(layer + i);
+    store(master + i, select(isEqual(l, unknown), l, m));
+  }
+#endif
+  for (; i < size; ++i) {
+    master[i] = overwriteCell(master[i], layer[i]);
+  }
+}
+
+void combineWithAddition(unsigned char * master, const unsigned char * layer, unsigned int size)
+{
+  unsigned int i = 0;
+#if defined(__AVX2__) || defined(__SSE2__) || defined(__ARM_NEON)
+  const Vector unknown = splat(NO_INFORMATION);
+  const Vector bound = splat(INSCRIBED_INFLATED_OBSTACLE - 1);
+  for (; i + kLanes <= size; i += kLanes) {
+    const Vector m = load(master + i);
+    const Vector l = load(layer + i);
+    // A saturated sum is at least the inscribed cost whenever the true sum is, so
+    // bounding it gives the same cost as bounding the true sum
+    Vector result = minU8(addsU8(m, l), bound);
+    result = select(isEqual(m, unknown), result, l);
+    result = select(isEqual(l, unknown), result, m);
+    store(master + i, result);
+  }
+#endif
+  for (; i < size; ++i) {
+    master[i] = additionCell(master[i], layer[i]);
+  }
+}
+
+const char * getCombinationKernelsInstructionSet()
+{
+#if defined(__AVX2__)
+  return "AVX2";
+#elif defined(__SSE4_1__)
+  return "SSE4.1";
+#elif defined(__SSE2__)
+  return "SSE2";
+#elif defined(__ARM_NEON)
+  return "NEON";
+#else
+  return "scalar";
+#endif
+}
+
+}  // namespace nav2_costmap_2d
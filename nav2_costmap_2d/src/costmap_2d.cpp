@@ -38,14 +38,54 @@
 #include "nav2_costmap_2d/costmap_2d.hpp"
 
 #include <algorithm>
+#include <cmath>
+#include <cstdint>
 #include <cstdio>
+#include <cstring>
+#include <limits>
 #include <string>
+#include <utility>
 #include <vector>
 #include "nav2_costmap_2d/cost_values.hpp"
 #include "nav2_util/occ_grid_values.hpp"
 
+#if defined(__linux__)
+#include <sys/mman.h>
+#include <unistd.h>
+#endif
+
 namespace nav2_costmap_2d
 {
+
+// Smallest reset for which the pages of a zeroed map are released rather than written
+static constexpr size_t MIN_RELEASED_RESET_SIZE = 1u << 20;
+
+/**
+ * @brief Set all cells of a map to a value. Large maps reset to zero have their whole
+ * pages handed back to the kernel instead, which maps them to the zero page until the
+ * next write, so that the memory of mostly free maps scales with their written area.
+ */
+static void fillCells(unsigned char * data, size_t size, unsigned char value)
+{
+#if defined(__linux__)
+  if (value == 0 && size >= MIN_RELEASED_RESET_SIZE) {
+    const uintptr_t page_size = static_cast<uintptr_t>(sysconf(_SC_PAGESIZE));
+    const uintptr_t begin = reinterpret_cast<uintptr_t>(data);
+    const uintptr_t end = begin + size;
+    const uintptr_t pages_begin = (begin + page_size - 1) & ~(page_size - 1);
+    const uintptr_t pages_end = end & ~(page_size - 1);
+    if (pages_begin < pages_end &&
+      madvise(reinterpret_cast<void *>(pages_begin), pages_end - pages_begin, MADV_DONTNEED) == 0)
+    {
+      memset(data, 0, pages_begin - begin);
+      memset(reinterpret_cast<unsigned char *>(pages_end), 0, end - pages_end);
+      return;
+    }
+  }
+#endif
+  memset(data, value, size);
+}
+
 Costmap2D::Costmap2D(
   unsigned int cells_size_x, unsigned int cells_size_y, double resolution,
   double origin_x, double origin_y, unsigned char default_value)
@@ -124,7 +164,7 @@ void Costmap2D::resizeMap(
 void Costmap2D::resetMaps()
 {
   std::unique_lock<mutex_t> lock(*access_);
-  memset(costmap_, default_value_, size_x_ * size_y_ * sizeof(unsigned char));
+  fillCells(costmap_, size_x_ * size_y_ * sizeof(unsigned char), default_value_);
 }
 
 void Costmap2D::resetMap(unsigned int x0, unsigned int y0, unsigned int xn, unsigned int yn)
@@ -207,6 +247,52 @@ bool Costmap2D::copyWindow(
   return true;
 }
 
+void Costmap2D::copyResampled(const Costmap2D & source)
+{
+  std::unique_lock<mutex_t> lock(*access_);
+  const double scale = resolution_ / source.resolution_;
+  const double offset_x = (origin_x_ - source.origin_x_) / source.resolution_;
+  const double offset_y = (origin_y_ - source.origin_y_) / source.resolution_;
+
+  // Range of source cells overlapped by each cell, clamped to the source, with some
+  // tolerance for the cells whose edges are aligned
+  const double tolerance = 1e-6;
+  auto overlap = [&](double offset, unsigned int i, unsigned int source_size) {
+      const double start = std::floor(offset + i * scale + tolerance);
+      const double end = std::ceil(offset + (i + 1) * scale - tolerance);
+      return std::make_pair(
+        static_cast<unsigned int>(std::clamp(start, 0.0, static_cast<double>(source_size))),
+        static_cast<unsigned int>(std::clamp(end, 0.0, static_cast<double>(source_size))));
+    };
+  std::vector<std::pair<unsigned int, unsigned int>> columns(size_x_);
+  for (unsigned int i = 0; i < size_x_; ++i) {
+    columns[i] = overlap(offset_x, i, source.size_x_);
+  }
+
+  for (unsigned int j = 0; j < size_y_; ++j) {
+    const auto rows = overlap(offset_y, j, source.size_y_);
+    unsigned char * cell = costmap_ + j * size_x_;
+    for (unsigned int i = 0; i < size_x_; ++i, ++cell) {
+      if (rows.first >= rows.second || columns[i].first >= columns[i].second) {
+        *cell = default_value_;
+        continue;
+      }
+      bool known = false;
+      unsigned char cost = 0;
+      for (unsigned int y = rows.first; y < rows.second; ++y) {
+        const unsigned char * source_cell = source.costmap_ + y * source.size_x_;
+        for (unsigned int x = columns[i].first; x < columns[i].second; ++x) {
+          if (source_cell[x] != NO_INFORMATION) {
+            known = true;
+            cost = std::max(cost, source_cell[x]);
+          }
+        }
+      }
+      *cell = known ? cost : NO_INFORMATION;
+    }
+  }
+}
+
 Costmap2D & Costmap2D::operator=(const Costmap2D & map)
 {
   // check for self assignement
@@ -214,8 +300,11 @@ Costmap2D & Costmap2D::operator=(const Costmap2D & map)
     return *this;
   }
 
-  // clean up old data
-  deleteMaps();
+  // reallocate the maps only if their size changed
+  if (costmap_ == NULL || size_x_ * size_y_ != map.size_x_ * map.size_y_) {
+    deleteMaps();
+    initMaps(map.size_x_, map.size_y_);
+  }
 
   size_x_ = map.size_x_;
   size_y_ = map.size_y_;
@@ -223,9 +312,6 @@ Costmap2D & Costmap2D::operator=(const Costmap2D & map)
   origin_x_ = map.origin_x_;
   origin_y_ = map.origin_y_;
 
-  // initialize our various maps
-  initMaps(size_x_, size_y_);
-
   // copy the cost map
   memcpy(costmap_, map.costmap_, size_x_ * size_y_ * sizeof(unsigned char));
 
@@ -340,47 +426,13 @@ void Costmap2D::updateOrigin(double new_origin_x, double new_origin_y)
   new_grid_ox = origin_x_ + cell_ox * resolution_;
   new_grid_oy = origin_y_ + cell_oy * resolution_;
 
-  // To save casting from unsigned int to int a bunch of times
-  int size_x = size_x_;
-  int size_y = size_y_;
-
-  // we need to compute the overlap of the new and existing windows
-  int lower_left_x, lower_left_y, upper_right_x, upper_right_y;
-  lower_left_x = std::min(std::max(cell_ox, 0), size_x);
-  lower_left_y = std::min(std::max(cell_oy, 0), size_y);
-  upper_right_x = std::min(std::max(cell_ox + size_x, 0), size_x);
-  upper_right_y = std::min(std::max(cell_oy + size_y, 0), size_y);
-
-  unsigned int cell_size_x = upper_right_x - lower_left_x;
-  unsigned int cell_size_y = upper_right_y - lower_left_y;
-
-  // we need a map to store the obstacles in the window temporarily
-  unsigned char * local_map = new unsigned char[cell_size_x * cell_size_y];
-
-  // copy the local window in the costmap to the local map
-  copyMapRegion(
-    costmap_, lower_left_x, lower_left_y, size_x_, local_map, 0, 0, cell_size_x,
-    cell_size_x,
-    cell_size_y);
-
-  // now we'll set the costmap to be completely unknown if we track unknown space
-  resetMaps();
+  // move the overlap of the new and existing windows in place, and reset the rest
+  // of the costmap to unknown space if we track it
+  shiftMapRegion(costmap_, size_x_, size_y_, cell_ox, cell_oy, default_value_);
 
   // update the origin with the appropriate world coordinates
   origin_x_ = new_grid_ox;
   origin_y_ = new_grid_oy;
-
-  // compute the starting cell location for copying data back in
-  int start_x = lower_left_x - cell_ox;
-  int start_y = lower_left_y - cell_oy;
-
-  // now we want to copy the overlapping information back into the map, but in its new location
-  copyMapRegion(
-    local_map, 0, 0, cell_size_x, costmap_, start_x, start_y, size_x_, cell_size_x,
-    cell_size_y);
-
-  // make sure to clean up
-  delete[] local_map;
 }
 
 bool Costmap2D::setConvexPolygonCost(
@@ -399,15 +451,21 @@ bool Costmap2D::setConvexPolygonCost(
     map_polygon.push_back(loc);
   }
 
-  std::vector<MapLocation> polygon_cells;
-
-  // get the cells that fill the polygon
-  convexFillCells(map_polygon, polygon_cells);
+  // we need a minimum polygon of a triangle
+  if (map_polygon.size() < 3) {
+    return true;
+  }
 
-  // set the cost of those cells
-  for (unsigned int i = 0; i < polygon_cells.size(); ++i) {
-    unsigned int index = getIndex(polygon_cells[i].x, polygon_cells[i].y);
-    costmap_[index] = cost_value;
+  // set the cost of the cells that fill the polygon, row by row
+  unsigned int min_y;
+  std::vector<std::pair<unsigned int, unsigned int>> spans;
+  convexFillSpans(map_polygon, min_y, spans);
+  for (unsigned int i = 0; i < spans.size(); ++i) {
+    if (spans[i].first <= spans[i].second) {
+      memset(
+        costmap_ + getIndex(spans[i].first, min_y + i), cost_value,
+        spans[i].second - spans[i].first + 1);
+    }
   }
   return true;
 }
@@ -438,63 +496,35 @@ void Costmap2D::convexFillCells(
     return;
   }
 
-  // first get the cells that make up the outline of the polygon
-  polygonOutlineCells(polygon, polygon_cells);
-
-  // quick bubble sort to sort points by x
-  MapLocation swap;
-  unsigned int i = 0;
-  while (i < polygon_cells.size() - 1) {
-    if (polygon_cells[i].x > polygon_cells[i + 1].x) {
-      swap = polygon_cells[i];
-      polygon_cells[i] = polygon_cells[i + 1];
-      polygon_cells[i + 1] = swap;
-
-      if (i > 0) {
-        --i;
-      }
-    } else {
-      ++i;
+  unsigned int min_y;
+  std::vector<std::pair<unsigned int, unsigned int>> spans;
+  convexFillSpans(polygon, min_y, spans);
+  for (unsigned int i = 0; i < spans.size(); ++i) {
+    for (unsigned int x = spans[i].first; x <= spans[i].second; ++x) {
+      polygon_cells.push_back({x, min_y + i});
     }
   }
+}
 
-  i = 0;
-  MapLocation min_pt;
-  MapLocation max_pt;
-  unsigned int min_x = polygon_cells[0].x;
-  unsigned int max_x = polygon_cells[polygon_cells.size() - 1].x;
-
-  // walk through each column and mark cells inside the polygon
-  for (unsigned int x = min_x; x <= max_x; ++x) {
-    if (i >= polygon_cells.size() - 1) {
-      break;
-    }
-
-    if (polygon_cells[i].y < polygon_cells[i + 1].y) {
-      min_pt = polygon_cells[i];
-      max_pt = polygon_cells[i + 1];
-    } else {
-      min_pt = polygon_cells[i + 1];
-      max_pt = polygon_cells[i];
-    }
-
-    i += 2;
-    while (i < polygon_cells.size() && polygon_cells[i].x == x) {
-      if (polygon_cells[i].y < min_pt.y) {
-        min_pt = polygon_cells[i];
-      } else if (polygon_cells[i].y > max_pt.y) {
-        max_pt = polygon_cells[i];
-      }
-      ++i;
-    }
+void Costmap2D::convexFillSpans(
+  const std::vector<MapLocation> & polygon, unsigned int & min_y,
+  std::vector<std::pair<unsigned int, unsigned int>> & spans)
+{
+  // the outline stays within the rows of the vertices
+  min_y = polygon[0].y;
+  unsigned int max_y = polygon[0].y;
+  for (const auto & point : polygon) {
+    min_y = std::min(min_y, point.y);
+    max_y = std::max(max_y, point.y);
+  }
+  spans.assign(max_y - min_y + 1, {std::numeric_limits<unsigned int>::max(), 0});
 
-    MapLocation pt;
-    // loop though cells in the column
-    for (unsigned int y = min_pt.y; y <= max_pt.y; ++y) {
-      pt.x = x;
-      pt.y = y;
-      polygon_cells.push_back(pt);
-    }
+  // for a convex polygon, the cells between the ends of the outline on each row are
+  // those between its ends on each column, as found by sorting the outline cells
+  PolygonOutlineSpans span_gatherer(size_x_, min_y, spans);
+  for (unsigned int i = 0; i < polygon.size(); ++i) {
+    const MapLocation & next = polygon[(i + 1) % polygon.size()];
+    raytraceLine(span_gatherer, polygon[i].x, polygon[i].y, next.x, next.y);
   }
 }
 
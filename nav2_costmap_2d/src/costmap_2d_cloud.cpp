@@ -25,6 +25,8 @@
  * POSSIBILITY OF SUCH DAMAGE.
  */
 
+#include <algorithm>
+#include <set>
 #include <string>
 #include <vector>
 #include <memory>
@@ -35,6 +37,7 @@
 #include "sensor_msgs/point_cloud2_iterator.hpp"
 #include "nav2_voxel_grid/voxel_grid.hpp"
 #include "nav2_msgs/msg/voxel_grid.hpp"
+#include "nav2_msgs/msg/voxel_grid_update.hpp"
 #include "nav2_util/execution_timer.hpp"
 
 static inline void mapToWorld3D(
@@ -70,6 +73,16 @@ V_Cell g_unknown;
 
 rclcpp::Node::SharedPtr g_node;
 
+// Voxel grid built from the updates, with the indices of its columns not free
+struct VoxelGridState
+{
+  bool valid{false};
+  nav2_msgs::msg::VoxelGridUpdate geometry;
+  std::vector<uint32_t> data;
+  std::set<uint32_t> columns;
+};
+VoxelGridState g_grid;
+
 rclcpp::Publisher<sensor_msgs::msg::PointCloud2>::SharedPtr pub_marked;
 rclcpp::Publisher<sensor_msgs::msg::PointCloud2>::SharedPtr pub_unknown;
 
@@ -128,6 +141,56 @@ void pointCloud2Helper(
   }
 }
 
+/**
+ * @brief Add the marked and unknown voxels of a column of a packed voxel grid to their cells
+ */
+void addColumnCells(
+  uint32_t x_grid, uint32_t y_grid, uint32_t x_size, uint32_t y_size, uint32_t z_size,
+  const uint32_t * data, uint32_t words_per_column,
+  const geometry_msgs::msg::Point32 & origin, const geometry_msgs::msg::Vector3 & resolutions)
+{
+  for (uint32_t z_grid = 0; z_grid < z_size; ++z_grid) {
+    nav2_voxel_grid::VoxelStatus status =
+      nav2_voxel_grid::getPackedVoxel(
+      x_grid, y_grid,
+      z_grid, x_size, y_size, z_size, data, words_per_column);
+    if (status == nav2_voxel_grid::UNKNOWN || status == nav2_voxel_grid::MARKED) {
+      Cell c;
+      c.status = status;
+      mapToWorld3D(
+        x_grid, y_grid, z_grid, origin.x, origin.y,
+        origin.z, resolutions.x, resolutions.y, resolutions.z, c.x, c.y, c.z);
+      if (status == nav2_voxel_grid::UNKNOWN) {
+        g_unknown.push_back(c);
+      } else {
+        g_marked.push_back(c);
+      }
+    }
+  }
+}
+
+/**
+ * @brief Publish the clouds of the marked and unknown cells
+ */
+void publishClouds(const std::string & frame_id, const rclcpp::Time & stamp)
+{
+  std_msgs::msg::Header pcl_header;
+  pcl_header.frame_id = frame_id;
+  pcl_header.stamp = stamp;
+
+  {
+    auto cloud = std::make_unique<sensor_msgs::msg::PointCloud2>();
+    pointCloud2Helper(cloud, g_marked.size(), pcl_header, g_marked);
+    pub_marked->publish(std::move(cloud));
+  }
+
+  {
+    auto cloud = std::make_unique<sensor_msgs::msg::PointCloud2>();
+    pointCloud2Helper(cloud, g_unknown.size(), pcl_header, g_unknown);
+    pub_unknown->publish(std::move(cloud));
+  }
+}
+
 void voxelCallback(const nav2_msgs::msg::VoxelGrid::ConstSharedPtr grid)
 {
   if (grid->data.empty()) {
@@ -142,72 +205,103 @@ void voxelCallback(const nav2_msgs::msg::VoxelGrid::ConstSharedPtr grid)
   const std::string frame_id = grid->header.frame_id;
   const rclcpp::Time stamp = grid->header.stamp;
   const uint32_t * data = &grid->data.front();
-  const double x_origin = grid->origin.x;
-  const double y_origin = grid->origin.y;
-  const double z_origin = grid->origin.z;
-  const double x_res = grid->resolutions.x;
-  const double y_res = grid->resolutions.y;
-  const double z_res = grid->resolutions.z;
   const uint32_t x_size = grid->size_x;
   const uint32_t y_size = grid->size_y;
   const uint32_t z_size = grid->size_z;
+  // Grids of more than 16 z voxels pack each column in several words
+  const uint32_t words_per_column =
+    x_size * y_size > 0 ? grid->data.size() / (x_size * y_size) : 0;
 
   g_marked.clear();
   g_unknown.clear();
-  uint32_t num_marked = 0;
-  uint32_t num_unknown = 0;
   for (uint32_t y_grid = 0; y_grid < y_size; ++y_grid) {
     for (uint32_t x_grid = 0; x_grid < x_size; ++x_grid) {
-      for (uint32_t z_grid = 0; z_grid < z_size; ++z_grid) {
-        nav2_voxel_grid::VoxelStatus status =
-          nav2_voxel_grid::VoxelGrid::getVoxel(
-          x_grid, y_grid,
-          z_grid, x_size, y_size, z_size, data);
-        if (status == nav2_voxel_grid::UNKNOWN) {
-          Cell c;
-          c.status = status;
-          mapToWorld3D(
-            x_grid, y_grid, z_grid, x_origin, y_origin,
-            z_origin, x_res, y_res, z_res, c.x, c.y, c.z);
-
-          g_unknown.push_back(c);
-
-          ++num_unknown;
-        } else if (status == nav2_voxel_grid::MARKED) {
-          Cell c;
-          c.status = status;
-          mapToWorld3D(
-            x_grid, y_grid, z_grid, x_origin, y_origin,
-            z_origin, x_res, y_res, z_res, c.x, c.y, c.z);
-
-          g_marked.push_back(c);
-
-          ++num_marked;
-        }
-      }
+      addColumnCells(
+        x_grid, y_grid, x_size, y_size, z_size, data, words_per_column,
+        grid->origin, grid->resolutions);
     }
   }
 
-  std_msgs::msg::Header pcl_header;
-  pcl_header.frame_id = frame_id;
-  pcl_header.stamp = stamp;
+  publishClouds(frame_id, stamp);
+
+  timer.end();
+  RCLCPP_DEBUG(
+    g_node->get_logger(), "Published %zu points in %f seconds",
+    g_marked.size() + g_unknown.size(), timer.elapsed_time_in_seconds());
+}
 
+/**
+ * @brief Apply an update to the voxel grid of the previous updates, then publish the clouds
+ * of its columns not free, only reading the columns listed by the update
+ */
+void voxelUpdateCallback(const nav2_msgs::msg::VoxelGridUpdate::ConstSharedPtr update)
+{
+  nav2_util::ExecutionTimer timer;
+  timer.start();
+
+  const auto & geometry = g_grid.geometry;
+  if (update->full) {
+    g_grid.valid = true;
+    g_grid.geometry.origin = update->origin;
+    g_grid.geometry.resolutions = update->resolutions;
+    g_grid.geometry.size_x = update->size_x;
+    g_grid.geometry.size_y = update->size_y;
+    g_grid.geometry.size_z = update->size_z;
+    g_grid.geometry.words_per_column = update->words_per_column;
+    g_grid.data.assign(update->size_x * update->size_y * update->words_per_column, 0);
+    g_grid.columns.clear();
+  } else if (!g_grid.valid || geometry.size_x != update->size_x ||
+    geometry.size_y != update->size_y || geometry.size_z != update->size_z ||
+    geometry.words_per_column != update->words_per_column ||
+    geometry.origin != update->origin)
   {
-    auto cloud = std::make_unique<sensor_msgs::msg::PointCloud2>();
-    pointCloud2Helper(cloud, num_marked, pcl_header, g_marked);
-    pub_marked->publish(std::move(cloud));
+    RCLCPP_WARN(g_node->get_logger(), "Received voxel grid update without its full update");
+    return;
   }
 
-  {
-    auto cloud = std::make_unique<sensor_msgs::msg::PointCloud2>();
-    pointCloud2Helper(cloud, num_unknown, pcl_header, g_unknown);
-    pub_unknown->publish(std::move(cloud));
+  const uint32_t words = geometry.words_per_column;
+  const uint32_t size = geometry.size_x * geometry.size_y;
+  if (update->data.size() != update->indices.size() * words) {
+    RCLCPP_ERROR(g_node->get_logger(), "Received malformed voxel grid update");
+    return;
   }
+  for (size_t i = 0; i < update->indices.size(); ++i) {
+    const uint32_t index = update->indices[i];
+    if (index >= size) {
+      continue;
+    }
+    std::copy(
+      update->data.begin() + i * words, update->data.begin() + (i + 1) * words,
+      g_grid.data.begin() + index * words);
+
+    bool column_free = true;
+    for (uint32_t z = 0; z < geometry.size_z && column_free; ++z) {
+      column_free = nav2_voxel_grid::getPackedVoxel(
+        index % geometry.size_x, index / geometry.size_x, z, geometry.size_x, geometry.size_y,
+        geometry.size_z, g_grid.data.data(), words) == nav2_voxel_grid::FREE;
+    }
+    if (column_free) {
+      g_grid.columns.erase(index);
+    } else {
+      g_grid.columns.insert(index);
+    }
+  }
+
+  g_marked.clear();
+  g_unknown.clear();
+  for (const uint32_t index : g_grid.columns) {
+    addColumnCells(
+      index % geometry.size_x, index / geometry.size_x, geometry.size_x, geometry.size_y,
+      geometry.size_z, g_grid.data.data(), words, geometry.origin, geometry.resolutions);
+  }
+
+  publishClouds(update->header.frame_id, update->header.stamp);
 
   timer.end();
   RCLCPP_DEBUG(
-    g_node->get_logger(), "Published %d points in %f seconds",
-    num_marked + num_unknown, timer.elapsed_time_in_seconds());
+    g_node->get_logger(), "Published %zu points in %f seconds from an update of %zu columns",
+    g_marked.size() + g_unknown.size(), timer.elapsed_time_in_seconds(),
+    update->indices.size());
 }
 
 int main(int argc, char ** argv)
@@ -223,6 +317,8 @@ int main(int argc, char ** argv)
     "voxel_unknown_cloud", 1);
   auto sub = g_node->create_subscription<nav2_msgs::msg::VoxelGrid>(
     "voxel_grid", rclcpp::SystemDefaultsQoS(), voxelCallback);
+  auto update_sub = g_node->create_subscription<nav2_msgs::msg::VoxelGridUpdate>(
+    "voxel_grid_updates", rclcpp::SystemDefaultsQoS(), voxelUpdateCallback);
 
   rclcpp::spin(g_node->get_node_base_interface());
   rclcpp::shutdown();
@@ -89,6 +89,9 @@ void voxelCallback(const nav2_msgs::msg::VoxelGrid::ConstSharedPtr grid)
   const uint32_t x_size = grid->size_x;
   const uint32_t y_size = grid->size_y;
   const uint32_t z_size = grid->size_z;
+  // Grids of more than 16 z voxels pack each column in several words
+  const uint32_t words_per_column =
+    x_size * y_size > 0 ? grid->data.size() / (x_size * y_size) : 0;
 
   g_cells.clear();
   uint32_t num_markers = 0;
@@ -96,9 +99,9 @@ void voxelCallback(const nav2_msgs::msg::VoxelGrid::ConstSharedPtr grid)
     for (uint32_t x_grid = 0; x_grid < x_size; ++x_grid) {
       for (uint32_t z_grid = 0; z_grid < z_size; ++z_grid) {
         nav2_voxel_grid::VoxelStatus status =
-          nav2_voxel_grid::VoxelGrid::getVoxel(
+          nav2_voxel_grid::getPackedVoxel(
           x_grid, y_grid,
-          z_grid, x_size, y_size, z_size, data);
+          z_grid, x_size, y_size, z_size, data, words_per_column);
         if (status == nav2_voxel_grid::MARKED) {
           Cell c;
           c.status = status;
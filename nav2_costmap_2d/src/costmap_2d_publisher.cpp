@@ -38,11 +38,13 @@
  *********************************************************************/
 #include "nav2_costmap_2d/costmap_2d_publisher.hpp"
 
+#include <algorithm>
 #include <string>
 #include <memory>
 #include <utility>
 
 #include "nav2_costmap_2d/cost_values.hpp"
+#include "nav2_costmap_2d/costmap_compression.hpp"
 
 namespace nav2_costmap_2d
 {
@@ -54,12 +56,25 @@ Costmap2DPublisher::Costmap2DPublisher(
   Costmap2D * costmap,
   std::string global_frame,
   std::string topic_name,
-  bool always_send_full_costmap)
+  bool always_send_full_costmap,
+  bool publish_compressed_costmap)
 : costmap_(costmap),
   global_frame_(global_frame),
   topic_name_(topic_name),
   active_(false),
-  always_send_full_costmap_(always_send_full_costmap)
+  always_send_full_costmap_(always_send_full_costmap),
+  publish_compressed_costmap_(publish_compressed_costmap),
+  grid_resolution(0.0),
+  grid_width(0),
+  grid_height(0),
+  raw_resolution_(0.0),
+  raw_size_x_(0),
+  raw_size_y_(0),
+  raw_origin_x_(0.0),
+  raw_origin_y_(0.0),
+  grid_subscription_count_(0),
+  raw_subscription_count_(0),
+  compressed_subscription_count_(0)
 {
   auto node = parent.lock();
   clock_ = node->get_clock();
@@ -76,6 +91,14 @@ Costmap2DPublisher::Costmap2DPublisher(
     custom_qos);
   costmap_update_pub_ = node->create_publisher<map_msgs::msg::OccupancyGridUpdate>(
     topic_name + "_updates", custom_qos);
+  costmap_raw_update_pub_ = node->create_publisher<nav2_msgs::msg::CostmapUpdate>(
+    topic_name + "_raw_updates", custom_qos);
+  if (publish_compressed_costmap_) {
+    costmap_compressed_pub_ = node->create_publisher<nav2_msgs::msg::CompressedCostmap>(
+      topic_name + "_raw_compressed", custom_qos);
+    costmap_compressed_update_pub_ = node->create_publisher<nav2_msgs::msg::CompressedCostmap>(
+      topic_name + "_raw_compressed_updates", custom_qos);
+  }
 
   // Create a service that will use the callback function to handle requests.
   costmap_service_ = node->create_service<nav2_msgs::srv::GetCostmap>(
@@ -84,6 +107,16 @@ Costmap2DPublisher::Costmap2DPublisher(
       this, std::placeholders::_1, std::placeholders::_2,
       std::placeholders::_3));
 
+  // Subscribers which lost updates request full costmaps, sent on the next publication
+  resync_service_ = node->create_service<std_srvs::srv::Empty>(
+    topic_name + "_raw_resync",
+    [this](
+      const std::shared_ptr<rmw_request_id_t>/*request_header*/,
+      const std::shared_ptr<std_srvs::srv::Empty::Request>/*request*/,
+      std::shared_ptr<std_srvs::srv::Empty::Response>/*response*/) {
+      full_costmap_requested_ = true;
+    });
+
   if (cost_translation_table_ == NULL) {
     cost_translation_table_ = new char[256];
 
@@ -173,29 +206,85 @@ void Costmap2DPublisher::prepareCostmap()
   costmap_raw_->metadata.origin.position.z = 0.0;
   costmap_raw_->metadata.origin.orientation.w = 1.0;
 
-  costmap_raw_->data.resize(costmap_raw_->metadata.size_x * costmap_raw_->metadata.size_y);
-
   unsigned char * data = costmap_->getCharMap();
-  for (unsigned int i = 0; i < costmap_raw_->data.size(); i++) {
-    costmap_raw_->data[i] = data[i];
+  costmap_raw_->data.assign(
+    data, data + costmap_raw_->metadata.size_x * costmap_raw_->metadata.size_y);
+}
+
+std::unique_ptr<nav2_msgs::msg::CostmapUpdate> Costmap2DPublisher::createCostmapUpdateMsg()
+{
+  auto update = std::make_unique<nav2_msgs::msg::CostmapUpdate>();
+  update->header.stamp = clock_->now();
+  update->header.frame_id = global_frame_;
+  update->base_stamp = raw_base_stamp_;
+  update->sequence = ++raw_update_sequence_;
+  update->x = x0_;
+  update->y = y0_;
+  update->size_x = xn_ - x0_;
+  update->size_y = yn_ - y0_;
+  update->data.resize(update->size_x * update->size_y);
+
+  // Raw costs need no translation, so copy the window row by row
+  const unsigned int size_x = costmap_->getSizeInCellsX();
+  const unsigned char * data = costmap_->getCharMap();
+  for (unsigned int y = 0; y < update->size_y; y++) {
+    const unsigned char * row = data + (y0_ + y) * size_x + x0_;
+    std::copy(row, row + update->size_x, update->data.begin() + y * update->size_x);
   }
+  return update;
+}
+
+std::unique_ptr<nav2_msgs::msg::CompressedCostmap> Costmap2DPublisher::createCompressedCostmapMsg(
+  unsigned int x0, unsigned int xn, unsigned int y0, unsigned int yn)
+{
+  double resolution = costmap_->getResolution();
+
+  auto compressed = std::make_unique<nav2_msgs::msg::CompressedCostmap>();
+  compressed->header.frame_id = global_frame_;
+  compressed->header.stamp = clock_->now();
+
+  compressed->metadata.layer = "master";
+  compressed->metadata.resolution = resolution;
+  compressed->metadata.size_x = costmap_->getSizeInCellsX();
+  compressed->metadata.size_y = costmap_->getSizeInCellsY();
+
+  double wx, wy;
+  costmap_->mapToWorld(0, 0, wx, wy);
+  compressed->metadata.origin.position.x = wx - resolution / 2;
+  compressed->metadata.origin.position.y = wy - resolution / 2;
+  compressed->metadata.origin.position.z = 0.0;
+  compressed->metadata.origin.orientation.w = 1.0;
+
+  compressed->x = x0;
+  compressed->y = y0;
+  compressed->size_x = xn - x0;
+  compressed->size_y = yn - y0;
+  compressed->format = "rle";
+
+  const unsigned int size_x = compressed->metadata.size_x;
+  encodeRunLength(
+    costmap_->getCharMap() + y0 * size_x + x0, compressed->size_x, compressed->size_y,
+    size_x, compressed->data);
+  return compressed;
 }
 
 void Costmap2DPublisher::publishCostmap()
 {
-  if (costmap_raw_pub_->get_subscription_count() > 0) {
-    prepareCostmap();
-    costmap_raw_pub_->publish(std::move(costmap_raw_));
-  }
   float resolution = costmap_->getResolution();
 
+  // Late joining subscribers are only sent the last full costmap and not the
+  // updates published since, so send them the current costmap in full
+  const size_t grid_subscription_count = costmap_pub_->get_subscription_count();
+  const size_t raw_subscription_count = costmap_raw_pub_->get_subscription_count();
+
   if (always_send_full_costmap_ || grid_resolution != resolution ||
     grid_width != costmap_->getSizeInCellsX() ||
     grid_height != costmap_->getSizeInCellsY() ||
     saved_origin_x_ != costmap_->getOriginX() ||
-    saved_origin_y_ != costmap_->getOriginY())
+    saved_origin_y_ != costmap_->getOriginY() ||
+    grid_subscription_count > grid_subscription_count_)
   {
-    if (costmap_pub_->get_subscription_count() > 0) {
+    if (grid_subscription_count > 0) {
       prepareGrid();
       costmap_pub_->publish(std::move(grid_));
     }
@@ -222,6 +311,61 @@ void Costmap2DPublisher::publishCostmap()
     }
   }
 
+  const bool full_requested = full_costmap_requested_.exchange(false);
+  const bool raw_map_changed = always_send_full_costmap_ || raw_resolution_ != resolution ||
+    raw_size_x_ != costmap_->getSizeInCellsX() ||
+    raw_size_y_ != costmap_->getSizeInCellsY() ||
+    raw_origin_x_ != costmap_->getOriginX() ||
+    raw_origin_y_ != costmap_->getOriginY();
+
+  if (raw_map_changed || full_requested || raw_subscription_count > raw_subscription_count_) {
+    if (raw_subscription_count > 0) {
+      prepareCostmap();
+      raw_base_stamp_ = costmap_raw_->header.stamp;
+      raw_update_sequence_ = 0;
+      costmap_raw_pub_->publish(std::move(costmap_raw_));
+    }
+  } else if (x0_ < xn_) {
+    if (costmap_raw_update_pub_->get_subscription_count() > 0) {
+      std::unique_lock<Costmap2D::mutex_t> lock(*(costmap_->getMutex()));
+      costmap_raw_update_pub_->publish(createCostmapUpdateMsg());
+    }
+  }
+
+  if (publish_compressed_costmap_) {
+    const size_t compressed_subscription_count =
+      costmap_compressed_pub_->get_subscription_count();
+    if (raw_map_changed || full_requested ||
+      compressed_subscription_count > compressed_subscription_count_)
+    {
+      if (compressed_subscription_count > 0) {
+        std::unique_lock<Costmap2D::mutex_t> lock(*(costmap_->getMutex()));
+        auto compressed = createCompressedCostmapMsg(
+          0, costmap_->getSizeInCellsX(), 0, costmap_->getSizeInCellsY());
+        compressed_base_stamp_ = compressed->header.stamp;
+        compressed_update_sequence_ = 0;
+        costmap_compressed_pub_->publish(std::move(compressed));
+      }
+    } else if (x0_ < xn_) {
+      if (costmap_compressed_update_pub_->get_subscription_count() > 0) {
+        std::unique_lock<Costmap2D::mutex_t> lock(*(costmap_->getMutex()));
+        auto compressed = createCompressedCostmapMsg(x0_, xn_, y0_, yn_);
+        compressed->base_stamp = compressed_base_stamp_;
+        compressed->sequence = ++compressed_update_sequence_;
+        costmap_compressed_update_pub_->publish(std::move(compressed));
+      }
+    }
+    compressed_subscription_count_ = compressed_subscription_count;
+  }
+
+  grid_subscription_count_ = grid_subscription_count;
+  raw_subscription_count_ = raw_subscription_count;
+  raw_resolution_ = resolution;
+  raw_size_x_ = costmap_->getSizeInCellsX();
+  raw_size_y_ = costmap_->getSizeInCellsY();
+  raw_origin_x_ = costmap_->getOriginX();
+  raw_origin_y_ = costmap_->getOriginY();
+
   xn_ = yn_ = 0;
   x0_ = costmap_->getSizeInCellsX();
   y0_ = costmap_->getSizeInCellsY();
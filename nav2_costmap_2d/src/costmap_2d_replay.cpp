@@ -0,0 +1,65 @@
+// Copyright (c) 2022 Samsung Research America
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+
+#include <cstdio>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "nav2_costmap_2d/costmap_2d_ros.hpp"
+#include "nav2_costmap_2d/costmap_recorder.hpp"
+#include "nav2_costmap_2d/costmap_replay.hpp"
+#include "rclcpp/rclcpp.hpp"
+
+// Replays a costmap recording through a costmap configured by the parameters given, e.g.
+// nav2_costmap_2d_replay local.rec local_costmap --ros-args --params-file nav2_params.yaml
+int main(int argc, char ** argv)
+{
+  rclcpp::init(argc, argv);
+  std::vector<std::string> args = rclcpp::remove_ros_arguments(argc, argv);
+  if (args.size() < 2) {
+    fprintf(stderr, "Usage: %s <recording> [costmap name] [--ros-args ...]\n", argv[0]);
+    rclcpp::shutdown();
+    return 1;
+  }
+
+  auto costmap = std::make_shared<nav2_costmap_2d::Costmap2DROS>(
+    args.size() > 2 ? args[2] : "costmap");
+  auto logger = costmap->get_logger();
+  nav2_costmap_2d::CostmapRecordReader reader(args[1]);
+  if (!reader.isOpen()) {
+    RCLCPP_ERROR(logger, "%s is not a costmap recording", args[1].c_str());
+    rclcpp::shutdown();
+    return 1;
+  }
+
+  costmap->configure();
+  nav2_costmap_2d::CostmapReplay replay(*costmap->getLayeredCostmap());
+  nav2_costmap_2d::ReplayStatistics statistics;
+  if (!replay.replay(reader, statistics)) {
+    RCLCPP_WARN(logger, "The recording ended on a truncated or malformed record");
+  }
+
+  RCLCPP_INFO(
+    logger, "Replayed %zu cycles and %zu observations, updates took %.3f ms on average and "
+    "%.3f ms at most, %zu cycles differed from the recording", statistics.cycles,
+    statistics.observations,
+    statistics.cycles ? statistics.update_time * 1e3 / statistics.cycles : 0.0,
+    statistics.max_update_time * 1e3, statistics.mismatched_cycles);
+
+  costmap->cleanup();
+  rclcpp::shutdown();
+  return 0;
+}
@@ -38,12 +38,16 @@
 
 #include "nav2_costmap_2d/costmap_2d_ros.hpp"
 
+#include <algorithm>
+#include <cmath>
 #include <memory>
 #include <chrono>
 #include <string>
+#include <thread>
 #include <vector>
 #include <utility>
 
+#include "nav2_costmap_2d/costmap_registry.hpp"
 #include "nav2_costmap_2d/layered_costmap.hpp"
 #include "nav2_util/execution_timer.hpp"
 #include "nav2_util/node_utils.hpp"
@@ -91,6 +95,10 @@ Costmap2DROS::Costmap2DROS(
   std::vector<std::string> clearable_layers{"obstacle_layer", "voxel_layer", "range_layer"};
 
   declare_parameter("always_send_full_costmap", rclcpp::ParameterValue(false));
+  declare_parameter("publish_compressed_costmap", rclcpp::ParameterValue(false));
+  declare_parameter("defer_clearing", rclcpp::ParameterValue(false));
+  declare_parameter("distance_field_max_distance", rclcpp::ParameterValue(0.0));
+  declare_parameter("event_driven_updates", rclcpp::ParameterValue(false));
   declare_parameter("footprint_padding", rclcpp::ParameterValue(0.01f));
   declare_parameter("footprint", rclcpp::ParameterValue(std::string("[]")));
   declare_parameter("global_frame", rclcpp::ParameterValue(std::string("map")));
@@ -100,16 +108,26 @@ Costmap2DROS::Costmap2DROS(
   declare_parameter(
     "map_topic", rclcpp::ParameterValue(
       (parent_namespace_ == "/" ? "/" : parent_namespace_ + "/") + std::string("map")));
+  declare_parameter("min_update_frequency", rclcpp::ParameterValue(1.0));
   declare_parameter("observation_sources", rclcpp::ParameterValue(std::string("")));
   declare_parameter("origin_x", rclcpp::ParameterValue(0.0));
   declare_parameter("origin_y", rclcpp::ParameterValue(0.0));
   declare_parameter("plugins", rclcpp::ParameterValue(default_plugins_));
   declare_parameter("filters", rclcpp::ParameterValue(std::vector<std::string>()));
   declare_parameter("publish_frequency", rclcpp::ParameterValue(1.0));
+  declare_parameter("pyramid_levels", rclcpp::ParameterValue(0));
+  declare_parameter("record_file", rclcpp::ParameterValue(std::string("")));
+  declare_parameter("record_keyframe_interval", rclcpp::ParameterValue(50));
   declare_parameter("resolution", rclcpp::ParameterValue(0.1));
+  declare_parameter("resolution_profiles", rclcpp::ParameterValue(std::vector<std::string>()));
+  declare_parameter("resolution_profile_hysteresis", rclcpp::ParameterValue(0.1));
   declare_parameter("robot_base_frame", rclcpp::ParameterValue(std::string("base_link")));
   declare_parameter("robot_radius", rclcpp::ParameterValue(0.1));
   declare_parameter("rolling_window", rclcpp::ParameterValue(false));
+  declare_parameter("shared_memory_export", rclcpp::ParameterValue(false));
+  declare_parameter("tile_size", rclcpp::ParameterValue(256));
+  declare_parameter("tiled_update_threads", rclcpp::ParameterValue(1));
+  declare_parameter("tf_cache_lifetime", rclcpp::ParameterValue(0.0));
   declare_parameter("track_unknown_space", rclcpp::ParameterValue(false));
   declare_parameter("transform_tolerance", rclcpp::ParameterValue(0.3));
   declare_parameter("trinary_costmap", rclcpp::ParameterValue(true));
@@ -132,12 +150,36 @@ Costmap2DROS::on_configure(const rclcpp_lifecycle::State & /*state*/)
   // Create the costmap itself
   layered_costmap_ = std::make_unique<LayeredCostmap>(
     global_frame_, rolling_window_, track_unknown_space_);
+  layered_costmap_->setTiledUpdate(
+    static_cast<unsigned int>(std::max(tiled_update_threads_, 1)),
+    static_cast<unsigned int>(std::max(tile_size_, 1)));
+  layered_costmap_->setPyramidLevels(static_cast<unsigned int>(std::max(pyramid_levels_, 0)));
+  layered_costmap_->setDistanceFieldMaxDistance(distance_field_max_distance_);
+
+  // The updates may be recorded to be reproduced offline, with the observations of the layers
+  if (!record_file_.empty()) {
+    layered_costmap_->setRecorder(
+      std::make_shared<CostmapRecorder>(
+        record_file_, static_cast<unsigned int>(std::max(record_keyframe_interval_, 1)),
+        get_logger()));
+  }
 
   if (!layered_costmap_->isSizeLocked()) {
-    layered_costmap_->resizeMap(
-      (unsigned int)(map_width_meters_ / resolution_),
-      (unsigned int)(map_height_meters_ / resolution_), resolution_, origin_x_, origin_y_);
+    if (resolution_profiles_.empty()) {
+      layered_costmap_->resizeMap(
+        (unsigned int)(map_width_meters_ / resolution_),
+        (unsigned int)(map_height_meters_ / resolution_), resolution_, origin_x_, origin_y_);
+    } else {
+      const ResolutionProfile & profile = resolution_profiles_.front();
+      layered_costmap_->resizeMap(
+        (unsigned int)(profile.width / profile.resolution),
+        (unsigned int)(profile.height / profile.resolution), profile.resolution,
+        origin_x_, origin_y_);
+    }
   }
+  resolution_profile_ = 0;
+  has_last_pose_ = false;
+  speed_ = 0.0;
 
   // Create the transform-related objects
   tf_buffer_ = std::make_shared<tf2_ros::Buffer>(rclcpp_node_->get_clock());
@@ -146,6 +188,9 @@ Costmap2DROS::on_configure(const rclcpp_lifecycle::State & /*state*/)
     rclcpp_node_->get_node_timers_interface());
   tf_buffer_->setCreateTimerInterface(timer_interface);
   tf_listener_ = std::make_shared<tf2_ros::TransformListener>(*tf_buffer_);
+  tf_cache_ = std::make_unique<nav2_util::TransformCache>(
+    *tf_buffer_, std::chrono::duration_cast<std::chrono::nanoseconds>(
+      std::chrono::duration<double>(tf_cache_lifetime_)));
 
   // Then load and add the plug-ins to the costmap
   for (unsigned int i = 0; i < plugin_names_.size(); ++i) {
@@ -187,7 +232,20 @@ Costmap2DROS::on_configure(const rclcpp_lifecycle::State & /*state*/)
   costmap_publisher_ = std::make_unique<Costmap2DPublisher>(
     shared_from_this(),
     layered_costmap_->getCostmap(), global_frame_,
-    "costmap", always_send_full_costmap_);
+    "costmap", always_send_full_costmap_, publish_compressed_costmap_);
+
+  update_map_probe_ = std::make_unique<nav2_util::Probe>(name_ + ".update_map");
+  publish_probe_ = std::make_unique<nav2_util::Probe>(name_ + ".publish");
+  instrumentation_publisher_ = std::make_unique<nav2_util::InstrumentationPublisher>(
+    shared_from_this(), std::vector<std::string>{name_ + "."});
+  master_memory_ = std::make_unique<nav2_util::MemoryAccount>(name_ + ".master");
+  for (auto * layers : {layered_costmap_->getPlugins(), layered_costmap_->getFilters()}) {
+    for (const auto & layer : *layers) {
+      layer_memory_.emplace_back(
+        layer, std::make_unique<nav2_util::MemoryAccount>(name_ + "." + layer->getName()));
+    }
+  }
+  updateMemoryAccounts();
 
   // Set the footprint
   if (use_radius_) {
@@ -211,6 +269,7 @@ Costmap2DROS::on_activate(const rclcpp_lifecycle::State & /*state*/)
 
   costmap_publisher_->on_activate();
   footprint_pub_->on_activate();
+  instrumentation_publisher_->activate();
 
   // First, make sure that the transform between the robot base frame
   // and the global frame is available
@@ -234,6 +293,13 @@ Costmap2DROS::on_activate(const rclcpp_lifecycle::State & /*state*/)
     r.sleep();
   }
 
+  // Subscribers of other processes may read the master costmap from shared memory,
+  // written after each update
+  if (shared_memory_export_) {
+    shared_memory_writer_ = std::make_unique<SharedMemoryCostmapWriter>(
+      getSharedMemoryName(get_node_topics_interface()->resolve_topic_name("costmap_raw")));
+  }
+
   // Create a thread to handle updating the map
   stopped_ = true;  // to active plugins
   stop_updates_ = false;
@@ -245,6 +311,10 @@ Costmap2DROS::on_activate(const rclcpp_lifecycle::State & /*state*/)
 
   start();
 
+  // Subscribers in this process may read the master costmap instead of its messages
+  CostmapRegistry::getInstance().add(
+    get_node_topics_interface()->resolve_topic_name("costmap_raw"), layered_costmap_.get());
+
   // Add callback for dynamic parameters
   dyn_params_handler = this->add_on_set_parameters_callback(
     std::bind(&Costmap2DROS::dynamicParametersCallback, this, _1));
@@ -258,17 +328,23 @@ Costmap2DROS::on_deactivate(const rclcpp_lifecycle::State & /*state*/)
   RCLCPP_INFO(get_logger(), "Deactivating");
 
   dyn_params_handler.reset();
+  CostmapRegistry::getInstance().remove(
+    get_node_topics_interface()->resolve_topic_name("costmap_raw"), layered_costmap_.get());
   costmap_publisher_->on_deactivate();
   footprint_pub_->on_deactivate();
+  instrumentation_publisher_->deactivate();
 
   stop();
 
   // Map thread stuff
   // TODO(mjeronimo): unique_ptr
   map_update_thread_shutdown_ = true;
+  // Wake the map update thread if waiting for new data
+  layered_costmap_->requestUpdate();
   map_update_thread_->join();
   delete map_update_thread_;
   map_update_thread_ = nullptr;
+  shared_memory_writer_.reset();
 
   return nav2_util::CallbackReturn::SUCCESS;
 }
@@ -278,8 +354,11 @@ Costmap2DROS::on_cleanup(const rclcpp_lifecycle::State & /*state*/)
 {
   RCLCPP_INFO(get_logger(), "Cleaning up");
 
+  master_memory_.reset();
+  layer_memory_.clear();
   layered_costmap_.reset();
 
+  tf_cache_.reset();
   tf_listener_.reset();
   tf_buffer_.reset();
 
@@ -288,6 +367,9 @@ Costmap2DROS::on_cleanup(const rclcpp_lifecycle::State & /*state*/)
 
   costmap_publisher_.reset();
   clear_costmap_service_.reset();
+  instrumentation_publisher_.reset();
+  update_map_probe_.reset();
+  publish_probe_.reset();
 
   return nav2_util::CallbackReturn::SUCCESS;
 }
@@ -306,6 +388,9 @@ Costmap2DROS::getParameters()
 
   // Get all of the required parameters
   get_parameter("always_send_full_costmap", always_send_full_costmap_);
+  get_parameter("publish_compressed_costmap", publish_compressed_costmap_);
+  get_parameter("distance_field_max_distance", distance_field_max_distance_);
+  get_parameter("event_driven_updates", event_driven_updates_);
   get_parameter("footprint", footprint_);
   get_parameter("footprint_padding", footprint_padding_);
   get_parameter("global_frame", global_frame_);
@@ -313,19 +398,62 @@ Costmap2DROS::getParameters()
   get_parameter("origin_x", origin_x_);
   get_parameter("origin_y", origin_y_);
   get_parameter("publish_frequency", map_publish_frequency_);
+  get_parameter("pyramid_levels", pyramid_levels_);
+  get_parameter("record_file", record_file_);
+  get_parameter("record_keyframe_interval", record_keyframe_interval_);
   get_parameter("resolution", resolution_);
+  get_parameter("resolution_profiles", resolution_profile_names_);
+  get_parameter("resolution_profile_hysteresis", resolution_profile_hysteresis_);
   get_parameter("robot_base_frame", robot_base_frame_);
   get_parameter("robot_radius", robot_radius_);
   get_parameter("rolling_window", rolling_window_);
+  get_parameter("shared_memory_export", shared_memory_export_);
+  get_parameter("tile_size", tile_size_);
+  get_parameter("tiled_update_threads", tiled_update_threads_);
+  get_parameter("tf_cache_lifetime", tf_cache_lifetime_);
   get_parameter("track_unknown_space", track_unknown_space_);
   get_parameter("transform_tolerance", transform_tolerance_);
   get_parameter("update_frequency", map_update_frequency_);
+  get_parameter("min_update_frequency", min_update_frequency_);
   get_parameter("width", map_width_meters_);
   get_parameter("plugins", plugin_names_);
   get_parameter("filters", filter_names_);
 
   auto node = shared_from_this();
 
+  // Profiles of the rolling window, by increasing speed, the last one being used at any
+  // speed above the previous ones
+  resolution_profiles_.clear();
+  for (const std::string & profile_name : resolution_profile_names_) {
+    ResolutionProfile profile;
+    profile.name = profile_name;
+    nav2_util::declare_parameter_if_not_declared(
+      node, profile_name + ".max_speed", rclcpp::ParameterValue(0.0));
+    nav2_util::declare_parameter_if_not_declared(
+      node, profile_name + ".resolution", rclcpp::ParameterValue(resolution_));
+    nav2_util::declare_parameter_if_not_declared(
+      node, profile_name + ".width",
+      rclcpp::ParameterValue(static_cast<double>(map_width_meters_)));
+    nav2_util::declare_parameter_if_not_declared(
+      node, profile_name + ".height",
+      rclcpp::ParameterValue(static_cast<double>(map_height_meters_)));
+    node->get_parameter(profile_name + ".max_speed", profile.max_speed);
+    node->get_parameter(profile_name + ".resolution", profile.resolution);
+    node->get_parameter(profile_name + ".width", profile.width);
+    node->get_parameter(profile_name + ".height", profile.height);
+    resolution_profiles_.push_back(profile);
+  }
+  std::stable_sort(
+    resolution_profiles_.begin(), resolution_profiles_.end(),
+    [](const ResolutionProfile & a, const ResolutionProfile & b) {
+      return a.max_speed < b.max_speed;
+    });
+  if (!resolution_profiles_.empty() && !rolling_window_) {
+    RCLCPP_WARN(
+      get_logger(), "Resolution profiles are only used by rolling windows, ignoring them");
+    resolution_profiles_.clear();
+  }
+
   if (plugin_names_ == default_plugins_) {
     for (size_t i = 0; i < default_plugins_.size(); ++i) {
       nav2_util::declare_parameter_if_not_declared(
@@ -412,16 +540,30 @@ Costmap2DROS::mapUpdateLoop(double frequency)
 
   rclcpp::WallRate r(frequency);    // 200ms by default
 
+  // In event driven mode, the update frequency is the maximum rate of updates
+  const auto max_update_period = std::chrono::duration_cast<std::chrono::steady_clock::duration>(
+    std::chrono::duration<double>(1.0 / frequency));
+  const auto min_update_period = min_update_frequency_ > 0.0 ?
+    std::chrono::duration_cast<std::chrono::steady_clock::duration>(
+    std::chrono::duration<double>(1.0 / min_update_frequency_)) :
+    std::chrono::steady_clock::duration::max();
+
   while (rclcpp::ok() && !map_update_thread_shutdown_) {
     nav2_util::ExecutionTimer timer;
+    const auto update_start = std::chrono::steady_clock::now();
 
     // Measure the execution time of the updateMap method
     timer.start();
-    updateMap();
+    {
+      NAV2_PROBE_SCOPE_ON(*update_map_probe_);
+      updateMap();
+    }
     timer.end();
+    updateMemoryAccounts();
 
     RCLCPP_DEBUG(get_logger(), "Map update time: %.9f", timer.elapsed_time_in_seconds());
     if (publish_cycle_ > rclcpp::Duration(0s) && layered_costmap_->isInitialized()) {
+      NAV2_PROBE_SCOPE_ON(*publish_probe_);
       unsigned int x0, y0, xn, yn;
       layered_costmap_->getBounds(&x0, &xn, &y0, &yn);
       costmap_publisher_->updateBounds(x0, xn, y0, yn);
@@ -436,6 +578,18 @@ Costmap2DROS::mapUpdateLoop(double frequency)
       }
     }
 
+    if (event_driven_updates_) {
+      // Wait out the maximum rate, then for a layer to receive new data,
+      // but no longer than until an update is due at the minimum rate
+      std::this_thread::sleep_until(update_start + max_update_period);
+      const auto deadline = min_update_period == std::chrono::steady_clock::duration::max() ?
+        std::chrono::steady_clock::time_point::max() : update_start + min_update_period;
+      if (!layered_costmap_->waitForUpdateRequest(deadline)) {
+        RCLCPP_DEBUG(get_logger(), "No new data, updating at the minimum rate");
+      }
+      continue;
+    }
+
     // Make sure to sleep for the remainder of our cycle time
     r.sleep();
 
@@ -451,19 +605,42 @@ Costmap2DROS::mapUpdateLoop(double frequency)
   }
 }
 
+void
+Costmap2DROS::updateMemoryAccounts()
+{
+  master_memory_->set(layered_costmap_->getMemoryUsage());
+  for (auto & layer_memory : layer_memory_) {
+    layer_memory.second->set(layer_memory.first->getMemoryUsage());
+  }
+}
+
 void
 Costmap2DROS::updateMap()
 {
   RCLCPP_DEBUG(get_logger(), "Updating map...");
 
   if (!stop_updates_) {
+    // Regions cleared since the last update, if deferred, are merged into this one
+    if (clear_costmap_service_) {
+      clear_costmap_service_->applyDeferredClearing();
+    }
+
     // get global pose
     geometry_msgs::msg::PoseStamped pose;
     if (getRobotPose(pose)) {
       const double & x = pose.pose.position.x;
       const double & y = pose.pose.position.y;
       const double yaw = tf2::getYaw(pose.pose.orientation);
+      if (!resolution_profiles_.empty()) {
+        updateResolutionProfile(pose);
+      }
       layered_costmap_->updateMap(x, y, yaw);
+      if (shared_memory_writer_) {
+        shared_memory_writer_->update(*layered_costmap_);
+      }
+      if (auto recorder = layered_costmap_->getRecorder()) {
+        recorder->recordCycle(now().nanoseconds(), x, y, yaw, *layered_costmap_);
+      }
 
       auto footprint = std::make_unique<geometry_msgs::msg::PolygonStamped>();
       footprint->header = pose.header;
@@ -476,6 +653,54 @@ Costmap2DROS::updateMap()
   }
 }
 
+void
+Costmap2DROS::updateResolutionProfile(const geometry_msgs::msg::PoseStamped & pose)
+{
+  // The speed is smoothed over about half a second, for a late pose not to switch profiles
+  const rclcpp::Time stamp(pose.header.stamp);
+  if (!has_last_pose_) {
+    last_pose_ = pose;
+    has_last_pose_ = true;
+  } else {
+    const double dt = (stamp - rclcpp::Time(last_pose_.header.stamp)).seconds();
+    if (dt > 0.0) {
+      const double distance = std::hypot(
+        pose.pose.position.x - last_pose_.pose.position.x,
+        pose.pose.position.y - last_pose_.pose.position.y);
+      speed_ += dt / (dt + 0.5) * (distance / dt - speed_);
+      last_pose_ = pose;
+    }
+  }
+
+  size_t profile = resolution_profile_;
+  while (profile + 1 < resolution_profiles_.size() &&
+    speed_ > resolution_profiles_[profile].max_speed)
+  {
+    profile++;
+  }
+  while (profile > 0 &&
+    speed_ < resolution_profiles_[profile - 1].max_speed - resolution_profile_hysteresis_)
+  {
+    profile--;
+  }
+  if (profile == resolution_profile_ || layered_costmap_->isSizeLocked()) {
+    return;
+  }
+
+  // The layers are resampled rather than reset, keeping what they observed
+  resolution_profile_ = profile;
+  const ResolutionProfile & new_profile = resolution_profiles_[profile];
+  const unsigned int size_x = (unsigned int)(new_profile.width / new_profile.resolution);
+  const unsigned int size_y = (unsigned int)(new_profile.height / new_profile.resolution);
+  layered_costmap_->resizeMap(
+    size_x, size_y, new_profile.resolution,
+    pose.pose.position.x - size_x * new_profile.resolution / 2,
+    pose.pose.position.y - size_y * new_profile.resolution / 2, false, true);
+  RCLCPP_INFO(
+    get_logger(), "Switched to resolution profile %s (%.3fm cells) at %.2fm/s",
+    new_profile.name.c_str(), new_profile.resolution, speed_);
+}
+
 void
 Costmap2DROS::start()
 {
@@ -555,6 +780,7 @@ Costmap2DROS::resetLayers()
 {
   Costmap2D * top = layered_costmap_->getCostmap();
   top->resetMap(0, 0, top->getSizeInCellsX(), top->getSizeInCellsY());
+  layered_costmap_->markUpdated();
 
   // Reset each of the plugins
   std::vector<std::shared_ptr<Layer>> * plugins = layered_costmap_->getPlugins();
@@ -569,13 +795,15 @@ Costmap2DROS::resetLayers()
   {
     (*filter)->reset();
   }
+
+  layered_costmap_->requestUpdate();
 }
 
 bool
 Costmap2DROS::getRobotPose(geometry_msgs::msg::PoseStamped & global_pose)
 {
   return nav2_util::getCurrentPose(
-    global_pose, *tf_buffer_,
+    global_pose, *tf_cache_,
     global_frame_, robot_base_frame_, transform_tolerance_);
 }
 
@@ -589,7 +817,7 @@ Costmap2DROS::transformPoseToGlobalFrame(
     return true;
   } else {
     return nav2_util::transformPoseInTargetFrame(
-      input_pose, transformed_pose, *tf_buffer_,
+      input_pose, transformed_pose, *tf_cache_,
       global_frame_, transform_tolerance_);
   }
 }
@@ -674,7 +902,8 @@ Costmap2DROS::dynamicParametersCallback(std::vector<rclcpp::Parameter> parameter
     }
   }
 
-  if (resize_map && !layered_costmap_->isSizeLocked()) {
+  // Resolution profiles resize the rolling window by themselves
+  if (resize_map && !layered_costmap_->isSizeLocked() && resolution_profiles_.empty()) {
     layered_costmap_->resizeMap(
       (unsigned int)(map_width_meters_ / resolution_),
       (unsigned int)(map_height_meters_ / resolution_), resolution_, origin_x_, origin_y_);
@@ -0,0 +1,95 @@
+// Copyright (c) 2022 Samsung Research America
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "nav2_costmap_2d/costmap_compression.hpp"
+
+#include <algorithm>
+
+namespace nav2_costmap_2d
+{
+
+namespace
+{
+
+inline void appendRun(unsigned char cost, size_t length, std::vector<uint8_t> & encoded)
+{
+  encoded.push_back(cost);
+  while (length >= 0x80) {
+    encoded.push_back(static_cast<uint8_t>(length | 0x80));
+    length >>= 7;
+  }
+  encoded.push_back(static_cast<uint8_t>(length));
+}
+
+}  // namespace
+
+void encodeRunLength(
+  const unsigned char * data, unsigned int size_x, unsigned int size_y,
+  unsigned int stride, std::vector<uint8_t> & encoded)
+{
+  encoded.clear();
+  if (size_x == 0 || size_y == 0) {
+    return;
+  }
+
+  // Runs carry on across rows, so a uniform window is a single run
+  unsigned char cost = data[0];
+  size_t length = 0;
+  for (unsigned int y = 0; y < size_y; y++) {
+    const unsigned char * row = data + static_cast<size_t>(y) * stride;
+    for (unsigned int x = 0; x < size_x; x++) {
+      if (row[x] != cost) {
+        appendRun(cost, length, encoded);
+        cost = row[x];
+        length = 0;
+      }
+      length++;
+    }
+  }
+  appendRun(cost, length, encoded);
+}
+
+bool decodeRunLength(
+  const uint8_t * encoded, size_t encoded_size, unsigned char * data, size_t size)
+{
+  size_t decoded = 0;
+  size_t i = 0;
+  while (i < encoded_size) {
+    const unsigned char cost = encoded[i++];
+
+    size_t length = 0;
+    unsigned int shift = 0;
+    while (true) {
+      if (i == encoded_size || shift >= 8 * sizeof(size_t)) {
+        return false;
+      }
+      const uint8_t byte = encoded[i++];
+      length |= static_cast<size_t>(byte & 0x7f) << shift;
+      if (!(byte & 0x80)) {
+        break;
+      }
+      shift += 7;
+    }
+
+    if (length == 0 || length > size - decoded) {
+      return false;
+    }
+    std::fill(data + decoded, data + decoded + length, cost);
+    decoded += length;
+  }
+
+  return decoded == size;
+}
+
+}  // namespace nav2_costmap_2d
@@ -39,6 +39,9 @@
 #include <nav2_costmap_2d/costmap_layer.hpp>
 #include <stdexcept>
 #include <algorithm>
+#include <cstring>
+
+#include "nav2_costmap_2d/combination_kernels.hpp"
 
 namespace nav2_costmap_2d
 {
@@ -56,6 +59,14 @@ void CostmapLayer::touch(
 void CostmapLayer::matchSize()
 {
   Costmap2D * master = layered_costmap_->getCostmap();
+  if (layered_costmap_->isResampling() && getSizeInCellsX() > 0 && getSizeInCellsY() > 0) {
+    Costmap2D previous(*this);
+    resizeMap(
+      master->getSizeInCellsX(), master->getSizeInCellsY(), master->getResolution(),
+      master->getOriginX(), master->getOriginY());
+    copyResampled(previous);
+    return;
+  }
   resizeMap(
     master->getSizeInCellsX(), master->getSizeInCellsY(), master->getResolution(),
     master->getOriginX(), master->getOriginY());
@@ -65,17 +76,31 @@ void CostmapLayer::clearArea(int start_x, int start_y, int end_x, int end_y, boo
 {
   current_ = false;
   unsigned char * grid = getCharMap();
-  for (int x = 0; x < static_cast<int>(getSizeInCellsX()); x++) {
-    bool xrange = x > start_x && x < end_x;
-
-    for (int y = 0; y < static_cast<int>(getSizeInCellsY()); y++) {
-      if ((xrange && y > start_y && y < end_y) == invert) {
-        continue;
-      }
-      int index = getIndex(x, y);
-      if (grid[index] != NO_INFORMATION) {
-        grid[index] = NO_INFORMATION;
+  const int size_x = static_cast<int>(getSizeInCellsX());
+  const int size_y = static_cast<int>(getSizeInCellsY());
+
+  // The area is exclusive of its bounds, cleared (or kept) in spans of its rows
+  const int x0 = std::max(start_x + 1, 0), xn = std::min(end_x, size_x);
+  const int y0 = std::max(start_y + 1, 0), yn = std::min(end_y, size_y);
+  auto clear_span = [&](int y, int span_x0, int span_xn) {
+      if (span_x0 < span_xn) {
+        memset(grid + getIndex(span_x0, y), NO_INFORMATION, span_xn - span_x0);
       }
+    };
+
+  if (!invert) {
+    for (int y = y0; y < yn; y++) {
+      clear_span(y, x0, xn);
+    }
+    return;
+  }
+
+  for (int y = 0; y < size_y; y++) {
+    if (y < y0 || y >= yn || x0 >= xn) {
+      clear_span(y, 0, size_x);
+    } else {
+      clear_span(y, 0, x0);
+      clear_span(y, xn, size_x);
     }
   }
 }
@@ -87,6 +112,8 @@ void CostmapLayer::addExtraBounds(double mx0, double my0, double mx1, double my1
   extra_min_y_ = std::min(my0, extra_min_y_);
   extra_max_y_ = std::max(my1, extra_max_y_);
   has_extra_bounds_ = true;
+  // The extra bounds are only used once the layer is due
+  update_requested_ = true;
 }
 
 void CostmapLayer::useExtraBounds(double * min_x, double * min_y, double * max_x, double * max_y)
@@ -118,20 +145,13 @@ void CostmapLayer::updateWithMax(
   unsigned char * master_array = master_grid.getCharMap();
   unsigned int span = master_grid.getSizeInCellsX();
 
+  if (max_i <= min_i) {
+    return;
+  }
+
   for (int j = min_j; j < max_j; j++) {
     unsigned int it = j * span + min_i;
-    for (int i = min_i; i < max_i; i++) {
-      if (costmap_[it] == NO_INFORMATION) {
-        it++;
-        continue;
-      }
-
-      unsigned char old_cost = master_array[it];
-      if (old_cost == NO_INFORMATION || old_cost < costmap_[it]) {
-        master_array[it] = costmap_[it];
-      }
-      it++;
-    }
+    combineWithMax(master_array + it, costmap_ + it, max_i - min_i);
   }
 }
 
@@ -152,12 +172,13 @@ void CostmapLayer::updateWithTrueOverwrite(
   unsigned char * master = master_grid.getCharMap();
   unsigned int span = master_grid.getSizeInCellsX();
 
+  if (max_i <= min_i) {
+    return;
+  }
+
   for (int j = min_j; j < max_j; j++) {
     unsigned int it = span * j + min_i;
-    for (int i = min_i; i < max_i; i++) {
-      master[it] = costmap_[it];
-      it++;
-    }
+    std::memcpy(master + it, costmap_ + it, max_i - min_i);
   }
 }
 
@@ -171,14 +192,13 @@ void CostmapLayer::updateWithOverwrite(
   unsigned char * master = master_grid.getCharMap();
   unsigned int span = master_grid.getSizeInCellsX();
 
+  if (max_i <= min_i) {
+    return;
+  }
+
   for (int j = min_j; j < max_j; j++) {
     unsigned int it = span * j + min_i;
-    for (int i = min_i; i < max_i; i++) {
-      if (costmap_[it] != NO_INFORMATION) {
-        master[it] = costmap_[it];
-      }
-      it++;
-    }
+    combineWithOverwrite(master + it, costmap_ + it, max_i - min_i);
   }
 }
 
@@ -192,27 +212,13 @@ void CostmapLayer::updateWithAddition(
   unsigned char * master_array = master_grid.getCharMap();
   unsigned int span = master_grid.getSizeInCellsX();
 
+  if (max_i <= min_i) {
+    return;
+  }
+
   for (int j = min_j; j < max_j; j++) {
     unsigned int it = j * span + min_i;
-    for (int i = min_i; i < max_i; i++) {
-      if (costmap_[it] == NO_INFORMATION) {
-        it++;
-        continue;
-      }
-
-      unsigned char old_cost = master_array[it];
-      if (old_cost == NO_INFORMATION) {
-        master_array[it] = costmap_[it];
-      } else {
-        int sum = old_cost + costmap_[it];
-        if (sum >= nav2_costmap_2d::INSCRIBED_INFLATED_OBSTACLE) {
-          master_array[it] = nav2_costmap_2d::INSCRIBED_INFLATED_OBSTACLE - 1;
-        } else {
-          master_array[it] = sum;
-        }
-      }
-      it++;
-    }
+    combineWithAddition(master_array + it, costmap_ + it, max_i - min_i);
   }
 }
 }  // namespace nav2_costmap_2d
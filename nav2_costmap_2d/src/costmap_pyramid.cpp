@@ -0,0 +1,186 @@
+// Copyright (c) 2022 Samsung Research America
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "nav2_costmap_2d/costmap_pyramid.hpp"
+
+#include <algorithm>
+#include <memory>
+
+namespace nav2_costmap_2d
+{
+
+void CostmapPyramid::setLevels(unsigned int levels)
+{
+  // New levels have no size, so that the next update recomputes them
+  levels_.resize(levels);
+  for (auto & level : levels_) {
+    if (!level) {
+      level = std::make_unique<Costmap2D>();
+    }
+  }
+}
+
+void CostmapPyramid::update(
+  const Costmap2D & costmap,
+  unsigned int x0, unsigned int y0, unsigned int xn, unsigned int yn)
+{
+  const Costmap2D * finer = &costmap;
+  for (auto & level : levels_) {
+    const unsigned int size_x = (finer->getSizeInCellsX() + 1) / 2;
+    const unsigned int size_y = (finer->getSizeInCellsY() + 1) / 2;
+    const double resolution = 2.0 * finer->getResolution();
+
+    // A moved origin shifts the costs under all cells, and a resize reallocates
+    // the level, so either is followed by downsampling the whole costmap
+    if (level->getSizeInCellsX() != size_x || level->getSizeInCellsY() != size_y ||
+      level->getResolution() != resolution ||
+      level->getOriginX() != costmap.getOriginX() ||
+      level->getOriginY() != costmap.getOriginY())
+    {
+      level->resizeMap(size_x, size_y, resolution, costmap.getOriginX(), costmap.getOriginY());
+      x0 = 0;
+      y0 = 0;
+      xn = finer->getSizeInCellsX();
+      yn = finer->getSizeInCellsY();
+    }
+
+    // Coarse cells partially covered by the window are updated in full
+    x0 /= 2;
+    y0 /= 2;
+    xn = std::min((xn + 1) / 2, size_x);
+    yn = std::min((yn + 1) / 2, size_y);
+    if (x0 >= xn || y0 >= yn) {
+      return;
+    }
+
+    downsampleWindow(*finer, *level, x0, y0, xn, yn);
+    finer = level.get();
+  }
+}
+
+const Costmap2D * CostmapPyramid::getLevel(unsigned int factor) const
+{
+  for (unsigned int i = 0; i < levels_.size(); ++i) {
+    if (factor == (2u << i)) {
+      return levels_[i].get();
+    }
+  }
+  return nullptr;
+}
+
+unsigned char CostmapPyramid::getMaxCost(
+  const Costmap2D & costmap,
+  unsigned int x0, unsigned int y0, unsigned int xn, unsigned int yn,
+  unsigned char stop_cost) const
+{
+  xn = std::min(xn, costmap.getSizeInCellsX());
+  yn = std::min(yn, costmap.getSizeInCellsY());
+  unsigned char max_cost = FREE_SPACE;
+  if (x0 >= xn || y0 >= yn) {
+    return max_cost;
+  }
+
+  unsigned int top = 0;
+  const Costmap2D * finer = &costmap;
+  for (const auto & level : levels_) {
+    if (level->getSizeInCellsX() != (finer->getSizeInCellsX() + 1) / 2 ||
+      level->getSizeInCellsY() != (finer->getSizeInCellsY() + 1) / 2)
+    {
+      break;
+    }
+    finer = level.get();
+    ++top;
+  }
+
+  for (unsigned int cy = y0 >> top; cy <= (yn - 1) >> top; ++cy) {
+    for (unsigned int cx = x0 >> top; cx <= (xn - 1) >> top; ++cx) {
+      getMaxCostInCell(costmap, top, cx, cy, x0, y0, xn, yn, stop_cost, max_cost);
+      if (max_cost >= stop_cost) {
+        return max_cost;
+      }
+    }
+  }
+  return max_cost;
+}
+
+void CostmapPyramid::getMaxCostInCell(
+  const Costmap2D & costmap, unsigned int level, unsigned int cx, unsigned int cy,
+  unsigned int x0, unsigned int y0, unsigned int xn, unsigned int yn,
+  unsigned char stop_cost, unsigned char & max_cost) const
+{
+  // No cell under this one costs more than it does
+  const Costmap2D & map = level == 0 ? costmap : *levels_[level - 1];
+  const unsigned char cost = map.getCost(cx, cy);
+  if (cost <= max_cost) {
+    return;
+  }
+
+  // Cells covered in full by the window, with those of the last row and column clamped
+  // to the costmap, have the maximum cost of the window under them
+  const unsigned int size_x = costmap.getSizeInCellsX();
+  const unsigned int size_y = costmap.getSizeInCellsY();
+  if (level == 0 ||
+    ((cx << level) >= x0 && std::min((cx + 1) << level, size_x) <= xn &&
+    (cy << level) >= y0 && std::min((cy + 1) << level, size_y) <= yn))
+  {
+    max_cost = cost;
+    return;
+  }
+
+  const Costmap2D & finer = level == 1 ? costmap : *levels_[level - 2];
+  const unsigned int fx_end = std::min(2 * cx + 2, finer.getSizeInCellsX());
+  const unsigned int fy_end = std::min(2 * cy + 2, finer.getSizeInCellsY());
+  const unsigned int shift = level - 1;
+  for (unsigned int fy = 2 * cy; fy < fy_end; ++fy) {
+    if (((fy + 1) << shift) <= y0 || (fy << shift) >= yn) {
+      continue;
+    }
+    for (unsigned int fx = 2 * cx; fx < fx_end; ++fx) {
+      if (((fx + 1) << shift) <= x0 || (fx << shift) >= xn) {
+        continue;
+      }
+      getMaxCostInCell(costmap, shift, fx, fy, x0, y0, xn, yn, stop_cost, max_cost);
+      if (max_cost >= stop_cost) {
+        return;
+      }
+    }
+  }
+}
+
+void CostmapPyramid::downsampleWindow(
+  const Costmap2D & finer, Costmap2D & coarser,
+  unsigned int x0, unsigned int y0, unsigned int xn, unsigned int yn)
+{
+  const unsigned int finer_size_x = finer.getSizeInCellsX();
+  const unsigned int finer_size_y = finer.getSizeInCellsY();
+  const unsigned char * finer_costs = finer.getCharMap();
+  unsigned char * coarser_costs = coarser.getCharMap();
+  const unsigned int coarser_size_x = coarser.getSizeInCellsX();
+
+  for (unsigned int y = y0; y < yn; ++y) {
+    // The last row and column of an odd sized finer level cover a single cell
+    const unsigned char * row0 = finer_costs + 2 * y * finer_size_x;
+    const unsigned char * row1 = 2 * y + 1 < finer_size_y ? row0 + finer_size_x : row0;
+    unsigned char * coarser_row = coarser_costs + y * coarser_size_x;
+    for (unsigned int x = x0; x < xn; ++x) {
+      const unsigned int fx0 = 2 * x;
+      const unsigned int fx1 = fx0 + 1 < finer_size_x ? fx0 + 1 : fx0;
+      coarser_row[x] = std::max(
+        std::max(row0[fx0], row0[fx1]),
+        std::max(row1[fx0], row1[fx1]));
+    }
+  }
+}
+
+}  // namespace nav2_costmap_2d
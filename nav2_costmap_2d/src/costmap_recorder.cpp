@@ -0,0 +1,464 @@
+// Copyright (c) 2022 Samsung Research America
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+
+#include "nav2_costmap_2d/costmap_recorder.hpp"
+
+#include <cstring>
+#include <string>
+#include <vector>
+
+#include "nav2_costmap_2d/costmap_compression.hpp"
+#include "nav2_costmap_2d/layered_costmap.hpp"
+#include "rclcpp/logging.hpp"
+#include "sensor_msgs/point_cloud2_iterator.hpp"
+
+namespace nav2_costmap_2d
+{
+
+namespace
+{
+
+constexpr char kMagic[8] = {'N', 'A', 'V', '2', 'C', 'R', 'E', 'C'};
+constexpr uint32_t kVersion = 1;
+constexpr uint32_t kMaxPayloadSize = 1u << 30;
+constexpr uint32_t kMaxStringSize = 4096;
+
+template<class T>
+void append(std::vector<uint8_t> & buffer, const T & value)
+{
+  const uint8_t * bytes = reinterpret_cast<const uint8_t *>(&value);
+  buffer.insert(buffer.end(), bytes, bytes + sizeof(T));
+}
+
+void appendString(std::vector<uint8_t> & buffer, const std::string & value)
+{
+  append(buffer, static_cast<uint32_t>(value.size()));
+  buffer.insert(buffer.end(), value.begin(), value.end());
+}
+
+void appendEncoded(
+  std::vector<uint8_t> & buffer, std::vector<uint8_t> & encoded, const unsigned char * data,
+  unsigned int size_x, unsigned int size_y, unsigned int stride)
+{
+  encodeRunLength(data, size_x, size_y, stride, encoded);
+  append(buffer, static_cast<uint64_t>(encoded.size()));
+  buffer.insert(buffer.end(), encoded.begin(), encoded.end());
+}
+
+/**
+ * @class PayloadReader
+ * @brief Reads the fields of a payload, failing rather than reading past its end
+ */
+class PayloadReader
+{
+public:
+  explicit PayloadReader(const std::vector<uint8_t> & payload)
+  : payload_(payload) {}
+
+  template<class T>
+  bool read(T & value)
+  {
+    if (payload_.size() - offset_ < sizeof(T)) {
+      return false;
+    }
+    std::memcpy(&value, payload_.data() + offset_, sizeof(T));
+    offset_ += sizeof(T);
+    return true;
+  }
+
+  bool readString(std::string & value)
+  {
+    uint32_t size;
+    if (!read(size) || size > kMaxStringSize || payload_.size() - offset_ < size) {
+      return false;
+    }
+    value.assign(reinterpret_cast<const char *>(payload_.data() + offset_), size);
+    offset_ += size;
+    return true;
+  }
+
+  bool readEncoded(unsigned char * data, size_t size)
+  {
+    uint64_t encoded_size;
+    if (!read(encoded_size) || payload_.size() - offset_ < encoded_size) {
+      return false;
+    }
+    const uint8_t * encoded = payload_.data() + offset_;
+    offset_ += encoded_size;
+    return size == 0 ? encoded_size == 0 : decodeRunLength(encoded, encoded_size, data, size);
+  }
+
+  bool atEnd() const
+  {
+    return offset_ == payload_.size();
+  }
+
+protected:
+  const std::vector<uint8_t> & payload_;
+  size_t offset_{0};
+};
+
+}  // namespace
+
+CostmapRecorder::CostmapRecorder(
+  const std::string & path, unsigned int keyframe_interval, const rclcpp::Logger & logger)
+: logger_(logger),
+  file_(path, std::ios::binary | std::ios::trunc),
+  keyframe_interval_(keyframe_interval)
+{
+  file_.write(kMagic, sizeof(kMagic));
+  file_.write(reinterpret_cast<const char *>(&kVersion), sizeof(kVersion));
+  open_ = static_cast<bool>(file_);
+  if (!open_) {
+    RCLCPP_ERROR(logger_, "Failed to open the costmap recording %s", path.c_str());
+  }
+  thread_ = std::thread(&CostmapRecorder::run, this);
+}
+
+CostmapRecorder::~CostmapRecorder()
+{
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    stop_ = true;
+  }
+  cv_.notify_one();
+  thread_.join();
+}
+
+uint32_t CostmapRecorder::addSource(const RecordedSource & source)
+{
+  uint32_t id;
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    id = sources_++;
+  }
+
+  std::vector<uint8_t> payload;
+  append(payload, id);
+  appendString(payload, source.layer);
+  appendString(payload, source.topic);
+  append(payload, source.keep_time);
+  append(payload, static_cast<uint8_t>(source.marking));
+  append(payload, static_cast<uint8_t>(source.clearing));
+  push(CostmapRecord::SOURCE, payload);
+  return id;
+}
+
+void CostmapRecorder::recordObservation(uint32_t source, const Observation & observation)
+{
+  const sensor_msgs::msg::PointCloud2 & cloud = *(observation.cloud_);
+  const uint32_t points = cloud.width * cloud.height;
+
+  std::vector<uint8_t> payload;
+  payload.reserve(100 + 3 * sizeof(float) * static_cast<size_t>(points));
+  append(payload, source);
+  append(
+    payload, static_cast<int64_t>(cloud.header.stamp.sec) * 1000000000 +
+    cloud.header.stamp.nanosec);
+  append(payload, observation.origin_.x);
+  append(payload, observation.origin_.y);
+  append(payload, observation.origin_.z);
+  append(payload, observation.obstacle_max_range_);
+  append(payload, observation.obstacle_min_range_);
+  append(payload, observation.raytrace_max_range_);
+  append(payload, observation.raytrace_min_range_);
+  append(payload, static_cast<uint8_t>(observation.frustum_clearing_));
+  append(payload, points);
+  if (points != 0) {
+    sensor_msgs::PointCloud2ConstIterator<float> iter_x(cloud, "x");
+    sensor_msgs::PointCloud2ConstIterator<float> iter_y(cloud, "y");
+    sensor_msgs::PointCloud2ConstIterator<float> iter_z(cloud, "z");
+    for (uint32_t i = 0; i < points; ++i, ++iter_x, ++iter_y, ++iter_z) {
+      append(payload, *iter_x);
+      append(payload, *iter_y);
+      append(payload, *iter_z);
+    }
+  }
+  push(CostmapRecord::OBSERVATION, payload);
+}
+
+void CostmapRecorder::recordCycle(
+  int64_t stamp_ns, double robot_x, double robot_y, double robot_yaw,
+  LayeredCostmap & layered_costmap)
+{
+  Costmap2D * costmap = layered_costmap.getCostmap();
+  std::unique_lock<Costmap2D::mutex_t> lock(*(costmap->getMutex()));
+  const uint64_t update_count = layered_costmap.getUpdateCount();
+  const unsigned int size_x = costmap->getSizeInCellsX();
+  const unsigned int size_y = costmap->getSizeInCellsY();
+
+  // The cells changed outside of the windows journaled, as when the costmap moves, or since a
+  // cycle dropped are only known from a keyframe
+  windows_.clear();
+  const bool keyframe = !has_cycle_ || cycles_since_keyframe_ + 1 >= keyframe_interval_ ||
+    size_x != size_x_ || size_y != size_y_ || costmap->getResolution() != resolution_ ||
+    costmap->getOriginX() != origin_x_ || costmap->getOriginY() != origin_y_ ||
+    !layered_costmap.getChangedWindows(update_count_, windows_);
+
+  payload_.clear();
+  append(payload_, stamp_ns);
+  append(payload_, robot_x);
+  append(payload_, robot_y);
+  append(payload_, robot_yaw);
+  append(payload_, static_cast<uint8_t>(keyframe));
+  append(payload_, static_cast<uint32_t>(size_x));
+  append(payload_, static_cast<uint32_t>(size_y));
+  append(payload_, costmap->getResolution());
+  append(payload_, costmap->getOriginX());
+  append(payload_, costmap->getOriginY());
+  const unsigned char * costs = costmap->getCharMap();
+  if (keyframe) {
+    appendEncoded(payload_, encoded_, costs, size_x, size_y, size_x);
+  } else {
+    append(payload_, static_cast<uint32_t>(windows_.size()));
+    for (const auto & window : windows_) {
+      append(payload_, static_cast<uint32_t>(window.x0));
+      append(payload_, static_cast<uint32_t>(window.y0));
+      append(payload_, static_cast<uint32_t>(window.xn));
+      append(payload_, static_cast<uint32_t>(window.yn));
+      appendEncoded(
+        payload_, encoded_, costs + static_cast<size_t>(window.y0) * size_x + window.x0,
+        window.xn - window.x0, window.yn - window.y0, size_x);
+    }
+  }
+
+  update_count_ = update_count;
+  size_x_ = size_x;
+  size_y_ = size_y;
+  resolution_ = costmap->getResolution();
+  origin_x_ = costmap->getOriginX();
+  origin_y_ = costmap->getOriginY();
+  lock.unlock();
+
+  has_cycle_ = push(CostmapRecord::CYCLE, payload_);
+  cycles_since_keyframe_ = keyframe ? 0 : cycles_since_keyframe_ + 1;
+}
+
+bool CostmapRecorder::push(CostmapRecord::Type type, const std::vector<uint8_t> & payload)
+{
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (!open_) {
+      return false;
+    }
+    if (pending_.size() + payload.size() > max_pending_bytes_) {
+      ++dropped_;
+      return false;
+    }
+    pending_.push_back(type);
+    append(pending_, static_cast<uint32_t>(payload.size()));
+    pending_.insert(pending_.end(), payload.begin(), payload.end());
+  }
+  cv_.notify_one();
+  return true;
+}
+
+void CostmapRecorder::run()
+{
+  std::vector<uint8_t> writing;
+  uint64_t dropped_reported = 0;
+  bool write_failed = false;
+  std::unique_lock<std::mutex> lock(mutex_);
+  while (true) {
+    cv_.wait(lock, [this]() {return stop_ || !pending_.empty();});
+    if (pending_.empty()) {
+      return;
+    }
+    writing.swap(pending_);
+    const uint64_t dropped = dropped_;
+    lock.unlock();
+
+    file_.write(reinterpret_cast<const char *>(writing.data()), writing.size());
+    file_.flush();
+    if (!file_ && !write_failed) {
+      RCLCPP_ERROR(logger_, "Failed to write to the costmap recording");
+      write_failed = true;
+    }
+    if (dropped != dropped_reported) {
+      RCLCPP_WARN(
+        logger_, "Dropped %lu records of the costmap recording, which is written too slowly",
+        static_cast<unsigned long>(dropped - dropped_reported));  // NOLINT
+      dropped_reported = dropped;
+    }
+    writing.clear();
+    lock.lock();
+  }
+}
+
+CostmapRecordReader::CostmapRecordReader(const std::string & path)
+: file_(path, std::ios::binary)
+{
+  char magic[sizeof(kMagic)];
+  uint32_t version;
+  open_ = file_ && file_.read(magic, sizeof(magic)) &&
+    std::memcmp(magic, kMagic, sizeof(kMagic)) == 0 &&
+    file_.read(reinterpret_cast<char *>(&version), sizeof(version)) && version == kVersion;
+}
+
+bool CostmapRecordReader::next(CostmapRecord & record)
+{
+  if (!open_ || failed_) {
+    return false;
+  }
+
+  while (true) {
+    uint8_t type;
+    if (!file_.read(reinterpret_cast<char *>(&type), sizeof(type))) {
+      return false;
+    }
+    uint32_t size;
+    if (!file_.read(reinterpret_cast<char *>(&size), sizeof(size)) || size > kMaxPayloadSize) {
+      failed_ = true;
+      return false;
+    }
+    payload_.resize(size);
+    if (!file_.read(reinterpret_cast<char *>(payload_.data()), size)) {
+      failed_ = true;
+      return false;
+    }
+
+    // Records of types unknown to this version are skipped
+    if (type != CostmapRecord::SOURCE && type != CostmapRecord::OBSERVATION &&
+      type != CostmapRecord::CYCLE)
+    {
+      continue;
+    }
+    record.type = static_cast<CostmapRecord::Type>(type);
+    if (!parse(record)) {
+      failed_ = true;
+      return false;
+    }
+    return true;
+  }
+}
+
+bool CostmapRecordReader::parse(CostmapRecord & record)
+{
+  PayloadReader reader(payload_);
+  switch (record.type) {
+    case CostmapRecord::SOURCE:
+      {
+        uint8_t marking, clearing;
+        if (!reader.read(record.source_id) || !reader.readString(record.source.layer) ||
+          !reader.readString(record.source.topic) || !reader.read(record.source.keep_time) ||
+          !reader.read(marking) || !reader.read(clearing))
+        {
+          return false;
+        }
+        record.source.marking = marking != 0;
+        record.source.clearing = clearing != 0;
+        sources_[record.source_id] = record.source;
+        return reader.atEnd();
+      }
+
+    case CostmapRecord::OBSERVATION:
+      {
+        Observation & observation = record.observation;
+        int64_t stamp_ns;
+        uint8_t frustum_clearing;
+        uint32_t points;
+        if (!reader.read(record.source_id) || !reader.read(stamp_ns) ||
+          !reader.read(observation.origin_.x) || !reader.read(observation.origin_.y) ||
+          !reader.read(observation.origin_.z) || !reader.read(observation.obstacle_max_range_) ||
+          !reader.read(observation.obstacle_min_range_) ||
+          !reader.read(observation.raytrace_max_range_) ||
+          !reader.read(observation.raytrace_min_range_) || !reader.read(frustum_clearing) ||
+          !reader.read(points) || payload_.size() < 3 * sizeof(float) * points)
+        {
+          return false;
+        }
+        observation.frustum_clearing_ = frustum_clearing != 0;
+
+        sensor_msgs::msg::PointCloud2 & cloud = *(observation.cloud_);
+        cloud.header.stamp.sec = static_cast<int32_t>(stamp_ns / 1000000000);
+        cloud.header.stamp.nanosec = static_cast<uint32_t>(stamp_ns % 1000000000);
+        sensor_msgs::PointCloud2Modifier modifier(cloud);
+        modifier.setPointCloud2FieldsByString(1, "xyz");
+        modifier.resize(points);
+        if (points != 0) {
+          sensor_msgs::PointCloud2Iterator<float> iter_x(cloud, "x");
+          sensor_msgs::PointCloud2Iterator<float> iter_y(cloud, "y");
+          sensor_msgs::PointCloud2Iterator<float> iter_z(cloud, "z");
+          for (uint32_t i = 0; i < points; ++i, ++iter_x, ++iter_y, ++iter_z) {
+            if (!reader.read(*iter_x) || !reader.read(*iter_y) || !reader.read(*iter_z)) {
+              return false;
+            }
+          }
+        }
+        return reader.atEnd();
+      }
+
+    case CostmapRecord::CYCLE:
+      {
+        RecordedCycle & cycle = record.cycle;
+        uint8_t keyframe;
+        uint32_t size_x, size_y;
+        double resolution, origin_x, origin_y;
+        if (!reader.read(cycle.stamp_ns) || !reader.read(cycle.robot_x) ||
+          !reader.read(cycle.robot_y) || !reader.read(cycle.robot_yaw) ||
+          !reader.read(keyframe) || !reader.read(size_x) || !reader.read(size_y) ||
+          !reader.read(resolution) || !reader.read(origin_x) || !reader.read(origin_y))
+        {
+          return false;
+        }
+        cycle.keyframe = keyframe != 0;
+
+        const bool same_geometry = has_costmap_ && costmap_.getSizeInCellsX() == size_x &&
+          costmap_.getSizeInCellsY() == size_y && costmap_.getResolution() == resolution &&
+          costmap_.getOriginX() == origin_x && costmap_.getOriginY() == origin_y;
+        if (cycle.keyframe) {
+          // Runs take at least two bytes, which bounds the size of the costmap
+          if (static_cast<uint64_t>(size_x) * size_y > 2ull * kMaxPayloadSize) {
+            return false;
+          }
+          if (!same_geometry) {
+            costmap_.resizeMap(size_x, size_y, resolution, origin_x, origin_y);
+          }
+          has_costmap_ = reader.readEncoded(
+            costmap_.getCharMap(), static_cast<size_t>(size_x) * size_y);
+          return has_costmap_ && reader.atEnd();
+        }
+
+        // Cycles between keyframes only have the windows they changed
+        uint32_t windows;
+        if (!same_geometry || !reader.read(windows)) {
+          return false;
+        }
+        unsigned char * costs = costmap_.getCharMap();
+        for (uint32_t i = 0; i < windows; ++i) {
+          uint32_t x0, y0, xn, yn;
+          if (!reader.read(x0) || !reader.read(y0) || !reader.read(xn) || !reader.read(yn) ||
+            x0 > xn || xn > size_x || y0 > yn || yn > size_y)
+          {
+            return false;
+          }
+          const unsigned int window_x = xn - x0;
+          window_.resize(static_cast<size_t>(window_x) * (yn - y0));
+          if (!reader.readEncoded(window_.data(), window_.size())) {
+            return false;
+          }
+          for (uint32_t y = y0; window_x != 0 && y < yn; ++y) {
+            std::memcpy(
+              costs + static_cast<size_t>(y) * size_x + x0,
+              window_.data() + static_cast<size_t>(y - y0) * window_x, window_x);
+          }
+        }
+        return reader.atEnd();
+      }
+  }
+  return false;
+}
+
+}  // namespace nav2_costmap_2d
@@ -0,0 +1,59 @@
+// Copyright (c) 2022 Samsung Research America
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "nav2_costmap_2d/costmap_registry.hpp"
+
+#include <string>
+
+namespace nav2_costmap_2d
+{
+
+CostmapRegistry & CostmapRegistry::getInstance()
+{
+  // Never destroyed, as costmaps may be unregistered by static objects
+  static CostmapRegistry * registry = new CostmapRegistry();
+  return *registry;
+}
+
+void CostmapRegistry::add(const std::string & topic_name, LayeredCostmap * layered_costmap)
+{
+  std::lock_guard<std::mutex> lock(mutex_);
+  costmaps_[topic_name] = Registration{layered_costmap, ++registrations_};
+}
+
+void CostmapRegistry::remove(
+  const std::string & topic_name,
+  const LayeredCostmap * layered_costmap)
+{
+  std::lock_guard<std::mutex> lock(mutex_);
+  auto it = costmaps_.find(topic_name);
+  if (it != costmaps_.end() && it->second.layered_costmap == layered_costmap) {
+    costmaps_.erase(it);
+  }
+}
+
+bool CostmapRegistry::access(
+  const std::string & topic_name,
+  const std::function<void(LayeredCostmap &, uint64_t)> & function)
+{
+  std::lock_guard<std::mutex> lock(mutex_);
+  auto it = costmaps_.find(topic_name);
+  if (it == costmaps_.end()) {
+    return false;
+  }
+  function(*it->second.layered_costmap, it->second.number);
+  return true;
+}
+
+}  // namespace nav2_costmap_2d
@@ -0,0 +1,137 @@
+// Copyright (c) 2022 Samsung Research America
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+
+#include "nav2_costmap_2d/costmap_replay.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <cstring>
+#include <iterator>
+#include <list>
+#include <memory>
+#include <unordered_set>
+
+namespace nav2_costmap_2d
+{
+
+CostmapReplay::CostmapReplay(LayeredCostmap & layered_costmap)
+: layered_costmap_(layered_costmap)
+{
+}
+
+bool CostmapReplay::replay(
+  CostmapRecordReader & reader, ReplayStatistics & statistics,
+  const CycleCallback & callback)
+{
+  CostmapRecord record;
+  while (reader.next(record)) {
+    switch (record.type) {
+      case CostmapRecord::SOURCE:
+        {
+          ReplayedSource & source = sources_[record.source_id];
+          source.source = record.source;
+          source.layer.reset();
+          source.observations.clear();
+          for (auto & plugin : *layered_costmap_.getPlugins()) {
+            if (plugin->getName() == record.source.layer) {
+              source.layer = std::dynamic_pointer_cast<ObstacleLayer>(plugin);
+              break;
+            }
+          }
+          break;
+        }
+      case CostmapRecord::OBSERVATION:
+        {
+          auto source = sources_.find(record.source_id);
+          if (source != sources_.end() && source->second.layer) {
+            source->second.observations.push_front(record.observation);
+            statistics.observations++;
+          }
+          break;
+        }
+      case CostmapRecord::CYCLE:
+        {
+          const RecordedCycle & cycle = record.cycle;
+          feedObservations(cycle.stamp_ns);
+
+          auto start = std::chrono::steady_clock::now();
+          layered_costmap_.updateMap(cycle.robot_x, cycle.robot_y, cycle.robot_yaw);
+          double update_time = std::chrono::duration<double>(
+            std::chrono::steady_clock::now() - start).count();
+          statistics.cycles++;
+          statistics.update_time += update_time;
+          statistics.max_update_time = std::max(statistics.max_update_time, update_time);
+
+          const Costmap2D & recorded = reader.getCostmap();
+          Costmap2D * replayed = layered_costmap_.getCostmap();
+          if (recorded.getSizeInCellsX() != replayed->getSizeInCellsX() ||
+            recorded.getSizeInCellsY() != replayed->getSizeInCellsY() ||
+            std::memcmp(
+              recorded.getCharMap(), replayed->getCharMap(),
+              static_cast<size_t>(recorded.getSizeInCellsX()) * recorded.getSizeInCellsY()) != 0)
+          {
+            statistics.mismatched_cycles++;
+          }
+
+          if (callback) {
+            callback(cycle, recorded);
+          }
+          break;
+        }
+    }
+  }
+  return !reader.failed();
+}
+
+void CostmapReplay::feedObservations(int64_t stamp_ns)
+{
+  // Each layer is cleared once, as several of its sources may feed it
+  std::unordered_set<ObstacleLayer *> cleared;
+  for (auto & entry : sources_) {
+    ReplayedSource & source = entry.second;
+    if (!source.layer) {
+      continue;
+    }
+    if (cleared.insert(source.layer.get()).second) {
+      source.layer->clearStaticObservations(true, true);
+    }
+
+    // Drop the observations the buffer would have, as it does, from the first one out of date
+    std::list<Observation> & observations = source.observations;
+    if (source.source.keep_time == 0.0) {
+      if (!observations.empty()) {
+        observations.erase(std::next(observations.begin()), observations.end());
+      }
+    } else {
+      const int64_t keep_time_ns = static_cast<int64_t>(source.source.keep_time * 1e9);
+      for (auto it = observations.begin(); it != observations.end(); ++it) {
+        const auto & stamp = it->cloud_->header.stamp;
+        const int64_t observation_ns =
+          static_cast<int64_t>(stamp.sec) * 1000000000 + stamp.nanosec;
+        if (stamp_ns - observation_ns > keep_time_ns) {
+          observations.erase(it, observations.end());
+          break;
+        }
+      }
+    }
+
+    for (auto & observation : observations) {
+      source.layer->addStaticObservation(
+        observation, source.source.marking, source.source.clearing);
+    }
+  }
+}
+
+}  // namespace nav2_costmap_2d
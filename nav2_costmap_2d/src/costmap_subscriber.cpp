@@ -12,40 +12,72 @@
 // See the License for the specific language governing permissions and
 // limitations under the License.
 
+#include <algorithm>
 #include <string>
 #include <memory>
 
 #include "nav2_costmap_2d/costmap_subscriber.hpp"
+#include "nav2_costmap_2d/costmap_compression.hpp"
+#include "nav2_costmap_2d/costmap_registry.hpp"
 
 namespace nav2_costmap_2d
 {
 
 CostmapSubscriber::CostmapSubscriber(
   const nav2_util::LifecycleNode::WeakPtr & parent,
-  const std::string & topic_name)
+  const std::string & topic_name,
+  bool compressed)
 : topic_name_(topic_name)
 {
-  auto node = parent.lock();
-  costmap_sub_ = node->create_subscription<nav2_msgs::msg::Costmap>(
-    topic_name_,
-    rclcpp::QoS(rclcpp::KeepLast(1)).transient_local().reliable(),
-    std::bind(&CostmapSubscriber::costmapCallback, this, std::placeholders::_1));
+  createSubscriptions(parent.lock(), compressed);
 }
 
 CostmapSubscriber::CostmapSubscriber(
   const rclcpp::Node::WeakPtr & parent,
-  const std::string & topic_name)
+  const std::string & topic_name,
+  bool compressed)
 : topic_name_(topic_name)
 {
-  auto node = parent.lock();
-  costmap_sub_ = node->create_subscription<nav2_msgs::msg::Costmap>(
+  createSubscriptions(parent.lock(), compressed);
+}
+
+template<typename NodeT>
+void CostmapSubscriber::createSubscriptions(const NodeT & node, bool compressed)
+{
+  resolved_topic_name_ = node->get_node_topics_interface()->resolve_topic_name(topic_name_);
+  resync_client_ = node->template create_client<std_srvs::srv::Empty>(topic_name_ + "_resync");
+
+  if (compressed) {
+    compressed_costmap_sub_ =
+      node->template create_subscription<nav2_msgs::msg::CompressedCostmap>(
+      topic_name_ + "_compressed",
+      rclcpp::QoS(rclcpp::KeepLast(1)).transient_local().reliable(),
+      std::bind(&CostmapSubscriber::compressedCostmapCallback, this, std::placeholders::_1));
+    compressed_costmap_update_sub_ =
+      node->template create_subscription<nav2_msgs::msg::CompressedCostmap>(
+      topic_name_ + "_compressed_updates",
+      rclcpp::QoS(rclcpp::KeepLast(10)).reliable(),
+      std::bind(&CostmapSubscriber::compressedCostmapUpdateCallback, this, std::placeholders::_1));
+    return;
+  }
+
+  costmap_sub_ = node->template create_subscription<nav2_msgs::msg::Costmap>(
     topic_name_,
     rclcpp::QoS(rclcpp::KeepLast(1)).transient_local().reliable(),
     std::bind(&CostmapSubscriber::costmapCallback, this, std::placeholders::_1));
+  costmap_update_sub_ = node->template create_subscription<nav2_msgs::msg::CostmapUpdate>(
+    topic_name_ + "_updates",
+    rclcpp::QoS(rclcpp::KeepLast(10)).reliable(),
+    std::bind(&CostmapSubscriber::costmapUpdateCallback, this, std::placeholders::_1));
 }
 
 std::shared_ptr<Costmap2D> CostmapSubscriber::getCostmap()
 {
+  if ((in_process_ && copyInProcessCostmap()) ||
+    (shared_memory_reader_ && copySharedMemoryCostmap()))
+  {
+    return costmap_;
+  }
   if (!costmap_received_) {
     throw std::runtime_error("Costmap is not available");
   }
@@ -55,43 +87,342 @@ std::shared_ptr<Costmap2D> CostmapSubscriber::getCostmap()
 
 void CostmapSubscriber::toCostmap2D()
 {
-  auto current_costmap_msg = std::atomic_load(&costmap_msg_);
+  std::lock_guard<std::mutex> lock(msg_mutex_);
+
+  if (!costmap_msg_converted_) {
+    const auto & current_costmap_msg = costmap_msg_;
 
+    if (costmap_ == nullptr) {
+      costmap_ = std::make_shared<Costmap2D>(
+        current_costmap_msg->metadata.size_x, current_costmap_msg->metadata.size_y,
+        current_costmap_msg->metadata.resolution, current_costmap_msg->metadata.origin.position.x,
+        current_costmap_msg->metadata.origin.position.y);
+    } else if (costmap_->getSizeInCellsX() != current_costmap_msg->metadata.size_x ||  // NOLINT
+      costmap_->getSizeInCellsY() != current_costmap_msg->metadata.size_y ||
+      costmap_->getResolution() != current_costmap_msg->metadata.resolution ||
+      costmap_->getOriginX() != current_costmap_msg->metadata.origin.position.x ||
+      costmap_->getOriginY() != current_costmap_msg->metadata.origin.position.y)
+    {
+      // Update the size of the costmap
+      costmap_->resizeMap(
+        current_costmap_msg->metadata.size_x, current_costmap_msg->metadata.size_y,
+        current_costmap_msg->metadata.resolution,
+        current_costmap_msg->metadata.origin.position.x,
+        current_costmap_msg->metadata.origin.position.y);
+    }
+
+    std::copy(
+      current_costmap_msg->data.begin(), current_costmap_msg->data.end(),
+      costmap_->getCharMap());
+    costmap_msg_converted_ = true;
+    full_revision_ = ++revision_;
+    changed_windows_.clear();
+
+    if (pyramid_.getLevels() > 0) {
+      pyramid_.update(
+        *costmap_, 0, 0, costmap_->getSizeInCellsX(), costmap_->getSizeInCellsY());
+    }
+  }
+
+  unsigned char * master_array = costmap_->getCharMap();
+  const unsigned int size_x = costmap_->getSizeInCellsX();
+  for (const auto & update_msg : costmap_update_msgs_) {
+    for (unsigned int y = 0; y < update_msg->size_y; y++) {
+      auto row = update_msg->data.begin() + y * update_msg->size_x;
+      std::copy(
+        row, row + update_msg->size_x,
+        master_array + (update_msg->y + y) * size_x + update_msg->x);
+    }
+
+    if (pyramid_.getLevels() > 0) {
+      pyramid_.update(
+        *costmap_, update_msg->x, update_msg->y,
+        update_msg->x + update_msg->size_x, update_msg->y + update_msg->size_y);
+    }
+
+    changed_windows_.push_back(
+      {++revision_, update_msg->x, update_msg->y,
+        update_msg->x + update_msg->size_x, update_msg->y + update_msg->size_y});
+    if (changed_windows_.size() > max_changed_windows_) {
+      changed_windows_.pop_front();
+    }
+  }
+  costmap_update_msgs_.clear();
+}
+
+bool CostmapSubscriber::copyInProcessCostmap()
+{
+  std::lock_guard<std::mutex> lock(msg_mutex_);
+  bool copied = false;
+  CostmapRegistry::getInstance().access(
+    resolved_topic_name_,
+    [this, &copied](LayeredCostmap & layered_costmap, uint64_t registration) {
+      Costmap2D * master = layered_costmap.getCostmap();
+      std::unique_lock<Costmap2D::mutex_t> costmap_lock(*(master->getMutex()));
+      const uint64_t update_count = layered_costmap.getUpdateCount();
+      if (update_count == 0) {
+        return;
+      }
+
+      if (costmap_ != nullptr && registration == in_process_registration_ &&
+        layered_costmap.getChangedWindows(in_process_update_count_, in_process_windows_))
+      {
+        for (const auto & window : in_process_windows_) {
+          costmap_->copyWindow(
+            *master, window.x0, window.y0, window.xn, window.yn, window.x0, window.y0);
+          if (pyramid_.getLevels() > 0) {
+            pyramid_.update(*costmap_, window.x0, window.y0, window.xn, window.yn);
+          }
+
+          changed_windows_.push_back(
+            {++revision_, window.x0, window.y0, window.xn, window.yn});
+          if (changed_windows_.size() > max_changed_windows_) {
+            changed_windows_.pop_front();
+          }
+        }
+      } else {
+        if (costmap_ == nullptr) {
+          costmap_ = std::make_shared<Costmap2D>(*master);
+        } else {
+          *costmap_ = *master;
+        }
+        full_revision_ = ++revision_;
+        changed_windows_.clear();
+
+        if (pyramid_.getLevels() > 0) {
+          pyramid_.update(
+            *costmap_, 0, 0, costmap_->getSizeInCellsX(), costmap_->getSizeInCellsY());
+        }
+      }
+      in_process_registration_ = registration;
+      in_process_update_count_ = update_count;
+      copied = true;
+    });
+
+  if (copied) {
+    // Falling back to the topics converts the last full costmap received again
+    costmap_msg_converted_ = false;
+    costmap_update_msgs_.clear();
+  } else {
+    in_process_registration_ = 0;
+  }
+  return copied;
+}
+
+bool CostmapSubscriber::copySharedMemoryCostmap()
+{
+  std::lock_guard<std::mutex> lock(msg_mutex_);
   if (costmap_ == nullptr) {
-    costmap_ = std::make_shared<Costmap2D>(
-      current_costmap_msg->metadata.size_x, current_costmap_msg->metadata.size_y,
-      current_costmap_msg->metadata.resolution, current_costmap_msg->metadata.origin.position.x,
-      current_costmap_msg->metadata.origin.position.y);
-  } else if (costmap_->getSizeInCellsX() != current_costmap_msg->metadata.size_x ||  // NOLINT
-    costmap_->getSizeInCellsY() != current_costmap_msg->metadata.size_y ||
-    costmap_->getResolution() != current_costmap_msg->metadata.resolution ||
-    costmap_->getOriginX() != current_costmap_msg->metadata.origin.position.x ||
-    costmap_->getOriginY() != current_costmap_msg->metadata.origin.position.y)
+    costmap_ = std::make_shared<Costmap2D>();
+  }
+
+  bool changed;
+  if (!shared_memory_reader_->read(*costmap_, changed)) {
+    return false;
+  }
+  if (changed) {
+    // The windows changed are not known, the whole costmap is taken as changed
+    full_revision_ = ++revision_;
+    changed_windows_.clear();
+    if (pyramid_.getLevels() > 0) {
+      pyramid_.update(
+        *costmap_, 0, 0, costmap_->getSizeInCellsX(), costmap_->getSizeInCellsY());
+    }
+    costmap_msg_converted_ = false;
+    costmap_update_msgs_.clear();
+    in_process_registration_ = 0;
+  }
+  return true;
+}
+
+uint64_t CostmapSubscriber::getRevision()
+{
+  std::lock_guard<std::mutex> lock(msg_mutex_);
+  return revision_;
+}
+
+bool CostmapSubscriber::getChangedWindows(
+  uint64_t revision,
+  std::vector<ChangedWindow> & windows)
+{
+  std::lock_guard<std::mutex> lock(msg_mutex_);
+  windows.clear();
+  if (revision >= revision_) {
+    return true;
+  }
+
+  // The windows must go back to the revision, without a full costmap since
+  if (revision < full_revision_ || changed_windows_.empty() ||
+    changed_windows_.front().revision > revision + 1)
   {
-    // Update the size of the costmap
-    costmap_->resizeMap(
-      current_costmap_msg->metadata.size_x, current_costmap_msg->metadata.size_y,
-      current_costmap_msg->metadata.resolution,
-      current_costmap_msg->metadata.origin.position.x,
-      current_costmap_msg->metadata.origin.position.y);
+    return false;
   }
 
-  unsigned char * master_array = costmap_->getCharMap();
-  unsigned int index = 0;
-  for (unsigned int i = 0; i < current_costmap_msg->metadata.size_x; ++i) {
-    for (unsigned int j = 0; j < current_costmap_msg->metadata.size_y; ++j) {
-      master_array[index] = current_costmap_msg->data[index];
-      ++index;
+  for (const auto & window : changed_windows_) {
+    if (window.revision > revision) {
+      windows.push_back(window);
     }
   }
+  return true;
+}
+
+void CostmapSubscriber::setInProcess(bool enable)
+{
+  std::lock_guard<std::mutex> lock(msg_mutex_);
+  in_process_ = enable;
+  in_process_registration_ = 0;
+  costmap_msg_converted_ = false;
+  costmap_update_msgs_.clear();
+}
+
+void CostmapSubscriber::setSharedMemory(bool enable, double timeout)
+{
+  std::lock_guard<std::mutex> lock(msg_mutex_);
+  shared_memory_timeout_ = timeout;
+  if (enable) {
+    shared_memory_reader_ = std::make_unique<SharedMemoryCostmapReader>(
+      getSharedMemoryName(resolved_topic_name_), shared_memory_timeout_);
+  } else {
+    shared_memory_reader_.reset();
+  }
+  costmap_msg_converted_ = false;
+  costmap_update_msgs_.clear();
+}
+
+void CostmapSubscriber::setPyramidLevels(unsigned int levels)
+{
+  std::lock_guard<std::mutex> lock(msg_mutex_);
+  pyramid_.setLevels(levels);
+  // Added levels are computed from the whole costmap, on its next conversion
+  costmap_msg_converted_ = false;
+  costmap_update_msgs_.clear();
+  in_process_registration_ = 0;
+  if (shared_memory_reader_) {
+    shared_memory_reader_ = std::make_unique<SharedMemoryCostmapReader>(
+      getSharedMemoryName(resolved_topic_name_), shared_memory_timeout_);
+  }
 }
 
 void CostmapSubscriber::costmapCallback(const nav2_msgs::msg::Costmap::SharedPtr msg)
 {
-  std::atomic_store(&costmap_msg_, msg);
+  std::lock_guard<std::mutex> lock(msg_mutex_);
+  costmap_msg_ = msg;
+  costmap_msg_converted_ = false;
+  // The full costmap already contains the costs of the updates before it
+  costmap_update_msgs_.clear();
+  update_sequence_ = 0;
+  resync_requested_ = false;
   if (!costmap_received_) {
     costmap_received_ = true;
   }
 }
 
+void CostmapSubscriber::costmapUpdateCallback(
+  const nav2_msgs::msg::CostmapUpdate::SharedPtr update_msg)
+{
+  std::lock_guard<std::mutex> lock(msg_mutex_);
+  // Updates only apply on top of a full costmap published before them
+  if (costmap_msg_ == nullptr ||
+    rclcpp::Time(update_msg->header.stamp) < rclcpp::Time(costmap_msg_->header.stamp) ||
+    update_msg->x + update_msg->size_x > costmap_msg_->metadata.size_x ||
+    update_msg->y + update_msg->size_y > costmap_msg_->metadata.size_y ||
+    update_msg->data.size() != update_msg->size_x * update_msg->size_y)
+  {
+    return;
+  }
+  if (update_msg->sequence != 0) {
+    // Updates of another full costmap, older or not received yet, do not apply
+    if (rclcpp::Time(update_msg->base_stamp) != rclcpp::Time(costmap_msg_->header.stamp)) {
+      return;
+    }
+    // Past a lost update, the costmap stays as it was until a full costmap is received
+    if (update_msg->sequence != update_sequence_ + 1) {
+      requestFullCostmap();
+      return;
+    }
+    update_sequence_ = update_msg->sequence;
+  }
+
+  // Keep the last full costmap current, so that a costmap converted from it
+  // after many updates does not have to apply them one by one
+  const unsigned int size_x = costmap_msg_->metadata.size_x;
+  for (unsigned int y = 0; y < update_msg->size_y; y++) {
+    auto row = update_msg->data.begin() + y * update_msg->size_x;
+    std::copy(
+      row, row + update_msg->size_x,
+      costmap_msg_->data.begin() + (update_msg->y + y) * size_x + update_msg->x);
+  }
+
+  if (costmap_msg_converted_) {
+    if (costmap_update_msgs_.size() < max_pending_updates_) {
+      costmap_update_msgs_.push_back(update_msg);
+    } else {
+      costmap_update_msgs_.clear();
+      costmap_msg_converted_ = false;
+    }
+  }
+}
+
+void CostmapSubscriber::requestFullCostmap()
+{
+  // Asked once per lost update, the service may not be there, e.g. for other publishers
+  if (resync_requested_ || !resync_client_->service_is_ready()) {
+    return;
+  }
+  RCLCPP_DEBUG(
+    rclcpp::get_logger("nav2_costmap_2d"),
+    "Lost updates of %s, requesting a full costmap", resolved_topic_name_.c_str());
+  resync_client_->async_send_request(
+    std::make_shared<std_srvs::srv::Empty::Request>(),
+    [](rclcpp::Client<std_srvs::srv::Empty>::SharedFuture) {});
+  resync_requested_ = true;
+}
+
+void CostmapSubscriber::compressedCostmapCallback(
+  const nav2_msgs::msg::CompressedCostmap::SharedPtr msg)
+{
+  // Full costmaps are a window covering the whole costmap
+  if (msg->format != "rle" || msg->x != 0 || msg->y != 0 ||
+    msg->size_x != msg->metadata.size_x || msg->size_y != msg->metadata.size_y)
+  {
+    return;
+  }
+
+  auto costmap_msg = std::make_shared<nav2_msgs::msg::Costmap>();
+  costmap_msg->header = msg->header;
+  costmap_msg->metadata = msg->metadata;
+  costmap_msg->data.resize(static_cast<size_t>(msg->size_x) * msg->size_y);
+  if (!decodeRunLength(
+      msg->data.data(), msg->data.size(), costmap_msg->data.data(), costmap_msg->data.size()))
+  {
+    return;
+  }
+  costmapCallback(costmap_msg);
+}
+
+void CostmapSubscriber::compressedCostmapUpdateCallback(
+  const nav2_msgs::msg::CompressedCostmap::SharedPtr update_msg)
+{
+  if (update_msg->format != "rle") {
+    return;
+  }
+
+  auto costmap_update_msg = std::make_shared<nav2_msgs::msg::CostmapUpdate>();
+  costmap_update_msg->header = update_msg->header;
+  costmap_update_msg->base_stamp = update_msg->base_stamp;
+  costmap_update_msg->sequence = update_msg->sequence;
+  costmap_update_msg->x = update_msg->x;
+  costmap_update_msg->y = update_msg->y;
+  costmap_update_msg->size_x = update_msg->size_x;
+  costmap_update_msg->size_y = update_msg->size_y;
+  costmap_update_msg->data.resize(static_cast<size_t>(update_msg->size_x) * update_msg->size_y);
+  if (!decodeRunLength(
+      update_msg->data.data(), update_msg->data.size(),
+      costmap_update_msg->data.data(), costmap_update_msg->data.size()))
+  {
+    return;
+  }
+  costmapUpdateCallback(costmap_update_msg);
+}
+
 }  // namespace nav2_costmap_2d
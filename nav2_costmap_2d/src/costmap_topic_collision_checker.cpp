@@ -18,6 +18,7 @@
 #include <string>
 #include <vector>
 #include <algorithm>
+#include <cmath>
 #include <iostream>
 
 #include "nav2_costmap_2d/costmap_topic_collision_checker.hpp"
@@ -25,7 +26,7 @@
 #include "nav2_costmap_2d/cost_values.hpp"
 #include "nav2_costmap_2d/exceptions.hpp"
 #include "nav2_costmap_2d/footprint.hpp"
-#include "nav2_util/line_iterator.hpp"
+#include "nav2_util/grid_traversal.hpp"
 
 using namespace std::chrono_literals;
 
@@ -46,6 +47,7 @@ bool CostmapTopicCollisionChecker::isCollisionFree(
   const geometry_msgs::msg::Pose2D & pose,
   bool fetch_costmap_and_footprint)
 {
+  std::lock_guard<std::recursive_mutex> lock(mutex_);
   try {
     if (scorePose(pose, fetch_costmap_and_footprint) >= LETHAL_OBSTACLE) {
       return false;
@@ -63,10 +65,251 @@ bool CostmapTopicCollisionChecker::isCollisionFree(
   }
 }
 
+int CostmapTopicCollisionChecker::findFirstCollision(
+  const std::vector<geometry_msgs::msg::Pose2D> & poses,
+  bool fetch_costmap_and_footprint)
+{
+  std::lock_guard<std::recursive_mutex> lock(mutex_);
+  if (poses.empty()) {
+    return -1;
+  }
+
+  if (fetch_costmap_and_footprint) {
+    try {
+      fetchCostmapAndFootprint();
+    } catch (const CollisionCheckerException & e) {
+      RCLCPP_ERROR(rclcpp::get_logger(name_), "%s", e.what());
+      return 0;
+    }
+  }
+
+  for (unsigned int i = 0; i < poses.size(); ++i) {
+    if (!isCoarselyCollisionFree(poses[i]) && !isCollisionFree(poses[i], false)) {
+      return static_cast<int>(i);
+    }
+  }
+  return -1;
+}
+
+bool CostmapTopicCollisionChecker::prepareManeuver(
+  const std::vector<geometry_msgs::msg::Pose2D> & poses,
+  Maneuver & maneuver)
+{
+  std::lock_guard<std::recursive_mutex> lock(mutex_);
+  maneuver.poses = poses;
+  try {
+    fetchCostmapAndFootprint();
+  } catch (const CollisionCheckerException & e) {
+    RCLCPP_ERROR(rclcpp::get_logger(name_), "%s", e.what());
+    maneuver.poses.clear();
+    return false;
+  }
+
+  maneuver.footprint = footprint_;
+  maneuver.revision = costmap_sub_.getRevision();
+  rasterizeManeuver(maneuver);
+  return true;
+}
+
+int CostmapTopicCollisionChecker::findFirstCollision(
+  Maneuver & maneuver, size_t first, size_t last)
+{
+  std::lock_guard<std::recursive_mutex> lock(mutex_);
+  last = std::min(last, maneuver.poses.size());
+  if (first >= last) {
+    return -1;
+  }
+
+  std::shared_ptr<Costmap2D> costmap;
+  try {
+    costmap = costmap_sub_.getCostmap();
+  } catch (const std::runtime_error & e) {
+    RCLCPP_ERROR(rclcpp::get_logger(name_), "%s", e.what());
+    return static_cast<int>(first);
+  }
+  collision_checker_.setCostmap(costmap);
+
+  const uint64_t revision = costmap_sub_.getRevision();
+  std::vector<CostmapSubscriber::ChangedWindow> windows;
+  if (costmap->getSizeInCellsX() != maneuver.size_x ||
+    costmap->getSizeInCellsY() != maneuver.size_y ||
+    costmap->getResolution() != maneuver.resolution ||
+    costmap->getOriginX() != maneuver.origin_x || costmap->getOriginY() != maneuver.origin_y)
+  {
+    // The cells under the footprint moved with the costmap
+    rasterizeManeuver(maneuver);
+  } else if (revision != maneuver.revision) {
+    if (costmap_sub_.getChangedWindows(maneuver.revision, windows)) {
+      // The cells of each row of a window are a range of the sorted cells
+      for (const auto & window : windows) {
+        for (unsigned int y = window.y0; y < window.yn; ++y) {
+          const auto begin = std::lower_bound(
+            maneuver.cells.begin(), maneuver.cells.end(), y * maneuver.size_x + window.x0);
+          const auto end = std::lower_bound(
+            begin, maneuver.cells.end(), y * maneuver.size_x + window.xn);
+          checkManeuverCells(
+            maneuver, begin - maneuver.cells.begin(), end - maneuver.cells.begin());
+        }
+      }
+    } else {
+      checkManeuverCells(maneuver, 0, maneuver.cells.size());
+    }
+  }
+  maneuver.revision = revision;
+
+  for (size_t i = first; i < last; ++i) {
+    if (maneuver.pose_lethal_cells[i] > 0) {
+      return static_cast<int>(i);
+    }
+  }
+  return -1;
+}
+
+void CostmapTopicCollisionChecker::rasterizeManeuver(Maneuver & maneuver)
+{
+  const std::shared_ptr<Costmap2D> costmap = collision_checker_.getCostmap();
+  maneuver.size_x = costmap->getSizeInCellsX();
+  maneuver.size_y = costmap->getSizeInCellsY();
+  maneuver.resolution = costmap->getResolution();
+  maneuver.origin_x = costmap->getOriginX();
+  maneuver.origin_y = costmap->getOriginY();
+  maneuver.pose_lethal_cells.assign(maneuver.poses.size(), 0);
+
+  // The outline of the footprint at each pose, as footprintCost() scores it
+  std::vector<std::pair<unsigned int, unsigned int>> pose_cells;
+  for (unsigned int i = 0; i < maneuver.poses.size() && !maneuver.footprint.empty(); ++i) {
+    const auto & pose = maneuver.poses[i];
+    Footprint footprint;
+    transformFootprint(pose.x, pose.y, pose.theta, maneuver.footprint, footprint);
+
+    std::vector<unsigned int> xs(footprint.size()), ys(footprint.size());
+    unsigned int cell_x, cell_y;
+    bool on_costmap = costmap->worldToMap(pose.x, pose.y, cell_x, cell_y);
+    for (size_t j = 0; j < footprint.size() && on_costmap; ++j) {
+      on_costmap = costmap->worldToMap(footprint[j].x, footprint[j].y, xs[j], ys[j]);
+    }
+    if (!on_costmap) {
+      maneuver.pose_lethal_cells[i] = 1;
+      continue;
+    }
+
+    // The closing edge is rasterized from the first point to the last one, like the others
+    for (size_t j = 0; j < footprint.size(); ++j) {
+      const size_t start = j + 1 < footprint.size() ? j : 0;
+      const size_t end = j + 1 < footprint.size() ? j + 1 : footprint.size() - 1;
+      nav2_util::traverseLine(
+        xs[start], ys[start], xs[end], ys[end], [&](int x, int y) {
+          pose_cells.emplace_back(costmap->getIndex(x, y), i);
+        });
+    }
+  }
+  std::sort(pose_cells.begin(), pose_cells.end());
+  pose_cells.erase(std::unique(pose_cells.begin(), pose_cells.end()), pose_cells.end());
+
+  maneuver.cells.clear();
+  maneuver.cell_poses.clear();
+  for (const auto & pose_cell : pose_cells) {
+    if (maneuver.cells.empty() || maneuver.cells.back() != pose_cell.first) {
+      maneuver.cells.push_back(pose_cell.first);
+      maneuver.cell_poses.emplace_back();
+    }
+    maneuver.cell_poses.back().push_back(pose_cell.second);
+  }
+  maneuver.cell_lethal.assign(maneuver.cells.size(), false);
+  checkManeuverCells(maneuver, 0, maneuver.cells.size());
+}
+
+void CostmapTopicCollisionChecker::checkManeuverCells(
+  Maneuver & maneuver, size_t begin, size_t end)
+{
+  const unsigned char * charmap = collision_checker_.getCostmap()->getCharMap();
+  for (size_t i = begin; i < end; ++i) {
+    const bool lethal = charmap[maneuver.cells[i]] >= LETHAL_OBSTACLE;
+    if (lethal == maneuver.cell_lethal[i]) {
+      continue;
+    }
+    maneuver.cell_lethal[i] = lethal;
+    for (const unsigned int pose : maneuver.cell_poses[i]) {
+      if (lethal) {
+        maneuver.pose_lethal_cells[pose]++;
+      } else {
+        maneuver.pose_lethal_cells[pose]--;
+      }
+    }
+  }
+}
+
+void CostmapTopicCollisionChecker::fetchCostmapAndFootprint()
+{
+  try {
+    collision_checker_.setCostmap(costmap_sub_.getCostmap());
+  } catch (const std::runtime_error & e) {
+    throw CollisionCheckerException(e.what());
+  }
+  fetchFootprint();
+}
+
+void CostmapTopicCollisionChecker::fetchFootprint()
+{
+  std_msgs::msg::Header header;
+  if (!footprint_sub_.getFootprintInRobotFrame(footprint_, header)) {
+    throw CollisionCheckerException("Current footprint not available.");
+  }
+
+  footprint_radius_ = 0.0;
+  for (const auto & point : footprint_) {
+    footprint_radius_ = std::max(footprint_radius_, std::hypot(point.x, point.y));
+  }
+}
+
+bool CostmapTopicCollisionChecker::isCoarselyCollisionFree(
+  const geometry_msgs::msg::Pose2D & pose)
+{
+  const CostmapPyramid & pyramid = costmap_sub_.getCostmapPyramid();
+  const std::shared_ptr<Costmap2D> costmap = collision_checker_.getCostmap();
+  if (pyramid.getLevels() == 0 || !costmap || footprint_.empty()) {
+    return false;
+  }
+
+  // The coarsest level with cells no larger than the footprint radius, so that
+  // the footprint covers a few coarse cells without too many false positives
+  unsigned int factor = 2;
+  while (factor < (1u << pyramid.getLevels()) &&
+    2 * factor * costmap->getResolution() <= footprint_radius_)
+  {
+    factor *= 2;
+  }
+  const Costmap2D * level = pyramid.getLevel(factor);
+  if (level->getSizeInCellsX() != (costmap->getSizeInCellsX() + factor - 1) / factor ||
+    level->getSizeInCellsY() != (costmap->getSizeInCellsY() + factor - 1) / factor)
+  {
+    return false;
+  }
+
+  // Footprints leaving the costmap are scored, to be reported as collisions
+  unsigned int min_x, min_y, max_x, max_y;
+  if (!costmap->worldToMap(
+      pose.x - footprint_radius_, pose.y - footprint_radius_, min_x, min_y) ||
+    !costmap->worldToMap(pose.x + footprint_radius_, pose.y + footprint_radius_, max_x, max_y))
+  {
+    return false;
+  }
+
+  for (unsigned int y = min_y / factor; y <= max_y / factor; ++y) {
+    for (unsigned int x = min_x / factor; x <= max_x / factor; ++x) {
+      if (level->getCost(x, y) >= LETHAL_OBSTACLE) {
+        return false;
+      }
+    }
+  }
+  return true;
+}
+
 double CostmapTopicCollisionChecker::scorePose(
   const geometry_msgs::msg::Pose2D & pose,
   bool fetch_costmap_and_footprint)
 {
+  std::lock_guard<std::recursive_mutex> lock(mutex_);
   if (fetch_costmap_and_footprint) {
     try {
       collision_checker_.setCostmap(costmap_sub_.getCostmap());
@@ -89,10 +332,7 @@ Footprint CostmapTopicCollisionChecker::getFootprint(
   bool fetch_latest_footprint)
 {
   if (fetch_latest_footprint) {
-    std_msgs::msg::Header header;
-    if (!footprint_sub_.getFootprintInRobotFrame(footprint_, header)) {
-      throw CollisionCheckerException("Current footprint not available.");
-    }
+    fetchFootprint();
   }
   Footprint footprint;
   transformFootprint(pose.x, pose.y, pose.theta, footprint_, footprint);
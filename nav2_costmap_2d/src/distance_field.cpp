@@ -0,0 +1,263 @@
+// Copyright (c) 2022 Samsung Research America
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "nav2_costmap_2d/distance_field.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <vector>
+
+#include "nav2_costmap_2d/cost_values.hpp"
+
+namespace nav2_costmap_2d
+{
+
+void DistanceField::setMaxDistance(double max_distance)
+{
+  max_distance_ = std::max(max_distance, 0.0);
+  full_update_ = true;
+  if (!isEnabled()) {
+    size_x_ = size_y_ = 0;
+    std::vector<float>().swap(distances_);
+  }
+}
+
+void DistanceField::update(
+  const Costmap2D & costmap,
+  unsigned int x0, unsigned int y0, unsigned int xn, unsigned int yn)
+{
+  if (!isEnabled()) {
+    return;
+  }
+
+  // A moved origin shifts the lethal cells under all cells, and a resize reallocates
+  // the field, so either is followed by recomputing the whole field
+  if (size_x_ != costmap.getSizeInCellsX() || size_y_ != costmap.getSizeInCellsY() ||
+    resolution_ != costmap.getResolution() ||
+    origin_x_ != costmap.getOriginX() || origin_y_ != costmap.getOriginY())
+  {
+    size_x_ = costmap.getSizeInCellsX();
+    size_y_ = costmap.getSizeInCellsY();
+    resolution_ = costmap.getResolution();
+    origin_x_ = costmap.getOriginX();
+    origin_y_ = costmap.getOriginY();
+    distances_.assign(static_cast<size_t>(size_x_) * size_y_, static_cast<float>(max_distance_));
+    full_update_ = true;
+  }
+
+  if (full_update_) {
+    computeWindow(costmap, 0, 0, size_x_, size_y_);
+    full_update_ = false;
+    return;
+  }
+
+  if (x0 >= xn || y0 >= yn) {
+    return;
+  }
+
+  // Only the cells within the maximum distance of the window can have their nearest
+  // lethal or free cell within the window
+  const unsigned int margin = static_cast<unsigned int>(std::ceil(max_distance_ / resolution_));
+  x0 = x0 > margin ? x0 - margin : 0;
+  y0 = y0 > margin ? y0 - margin : 0;
+  xn = std::min(xn + margin, size_x_);
+  yn = std::min(yn + margin, size_y_);
+  if (x0 < xn && y0 < yn) {
+    computeWindow(costmap, x0, y0, xn, yn);
+  }
+}
+
+bool DistanceField::getInterpolation(
+  double wx, double wy, unsigned int & mx, unsigned int & my,
+  float & tx, float & ty) const
+{
+  if (size_x_ == 0 || size_y_ == 0 || wx < origin_x_ || wy < origin_y_ ||
+    wx >= origin_x_ + size_x_ * resolution_ || wy >= origin_y_ + size_y_ * resolution_)
+  {
+    return false;
+  }
+
+  // Points within half a cell of the edges take the distances of the edge cells
+  const double fx = std::min(
+    std::max((wx - origin_x_) / resolution_ - 0.5, 0.0), static_cast<double>(size_x_ - 1));
+  const double fy = std::min(
+    std::max((wy - origin_y_) / resolution_ - 0.5, 0.0), static_cast<double>(size_y_ - 1));
+  mx = std::min(static_cast<unsigned int>(fx), size_x_ > 1 ? size_x_ - 2 : 0);
+  my = std::min(static_cast<unsigned int>(fy), size_y_ > 1 ? size_y_ - 2 : 0);
+  tx = static_cast<float>(fx - mx);
+  ty = static_cast<float>(fy - my);
+  return true;
+}
+
+bool DistanceField::getDistance(double wx, double wy, float & distance) const
+{
+  float gradient_x, gradient_y;
+  return getDistanceAndGradient(wx, wy, distance, gradient_x, gradient_y);
+}
+
+bool DistanceField::getDistanceAndGradient(
+  double wx, double wy, float & distance, float & gradient_x, float & gradient_y) const
+{
+  unsigned int mx, my;
+  float tx, ty;
+  if (!getInterpolation(wx, wy, mx, my, tx, ty)) {
+    return false;
+  }
+
+  const unsigned int mx1 = std::min(mx + 1, size_x_ - 1);
+  const unsigned int my1 = std::min(my + 1, size_y_ - 1);
+  const float d00 = getDistance(mx, my);
+  const float d10 = getDistance(mx1, my);
+  const float d01 = getDistance(mx, my1);
+  const float d11 = getDistance(mx1, my1);
+
+  distance = (1.0f - ty) * ((1.0f - tx) * d00 + tx * d10) + ty * ((1.0f - tx) * d01 + tx * d11);
+  const float inverse_resolution = static_cast<float>(1.0 / resolution_);
+  gradient_x = ((1.0f - ty) * (d10 - d00) + ty * (d11 - d01)) * inverse_resolution;
+  gradient_y = ((1.0f - tx) * (d01 - d00) + tx * (d11 - d10)) * inverse_resolution;
+  return true;
+}
+
+void DistanceField::computeWindow(
+  const Costmap2D & costmap,
+  unsigned int x0, unsigned int y0, unsigned int xn, unsigned int yn)
+{
+  // Distances are capped beyond the maximum distance, which keeps them exact
+  // below it while no cell further than it from the window is read
+  const unsigned int margin = static_cast<unsigned int>(std::ceil(max_distance_ / resolution_));
+  const float cap = static_cast<float>(margin + 1);
+  const unsigned int sx0 = x0 > margin ? x0 - margin : 0;
+  const unsigned int sy0 = y0 > margin ? y0 - margin : 0;
+  const unsigned int sxn = std::min(xn + margin, size_x_);
+  const unsigned int syn = std::min(yn + margin, size_y_);
+  const unsigned int width = sxn - sx0;
+  const unsigned int height = syn - sy0;
+
+  const size_t scratch_size = static_cast<size_t>(width) * height;
+  lethal_distances_.resize(scratch_size);
+  free_distances_.resize(scratch_size);
+  line_.resize(width);
+  transformed_.resize(width);
+  envelope_roots_.resize(width);
+  envelope_bounds_.resize(width + 1);
+
+  // Distances along the columns, to the nearest lethal and free cells, by a sweep down
+  // and a sweep up the rows within the maximum distance of the window
+  const unsigned char * costs = costmap.getCharMap();
+  for (unsigned int y = sy0; y < syn; ++y) {
+    const unsigned char * row_costs = costs + static_cast<size_t>(y) * size_x_ + sx0;
+    float * to_lethal = &lethal_distances_[static_cast<size_t>(y - sy0) * width];
+    float * to_free = &free_distances_[static_cast<size_t>(y - sy0) * width];
+    if (y == sy0) {
+      for (unsigned int i = 0; i < width; ++i) {
+        const bool lethal = row_costs[i] == LETHAL_OBSTACLE;
+        to_lethal[i] = lethal ? 0.0f : cap;
+        to_free[i] = lethal ? cap : 0.0f;
+      }
+      continue;
+    }
+    const float * lethal_above = to_lethal - width;
+    const float * free_above = to_free - width;
+    for (unsigned int i = 0; i < width; ++i) {
+      const bool lethal = row_costs[i] == LETHAL_OBSTACLE;
+      to_lethal[i] = lethal ? 0.0f : std::min(lethal_above[i] + 1.0f, cap);
+      to_free[i] = lethal ? std::min(free_above[i] + 1.0f, cap) : 0.0f;
+    }
+  }
+  for (unsigned int y = syn - 1; y-- > sy0; ) {
+    float * to_lethal = &lethal_distances_[static_cast<size_t>(y - sy0) * width];
+    float * to_free = &free_distances_[static_cast<size_t>(y - sy0) * width];
+    for (unsigned int i = 0; i < width; ++i) {
+      to_lethal[i] = std::min(to_lethal[i], to_lethal[i + width] + 1.0f);
+      to_free[i] = std::min(to_free[i], to_free[i + width] + 1.0f);
+    }
+  }
+
+  // Then along the rows of the window, from the squared distances along the columns
+  const float max_distance = static_cast<float>(max_distance_);
+  const float resolution = static_cast<float>(resolution_);
+  for (unsigned int y = y0; y < yn; ++y) {
+    float * distances = &distances_[static_cast<size_t>(y) * size_x_];
+    const unsigned char * row_costs = costs + static_cast<size_t>(y) * size_x_;
+
+    const float * to_lethal = &lethal_distances_[static_cast<size_t>(y - sy0) * width];
+    for (unsigned int i = 0; i < width; ++i) {
+      line_[i] = to_lethal[i] * to_lethal[i];
+    }
+    transformLine(line_.data(), transformed_.data(), width);
+    for (unsigned int x = x0; x < xn; ++x) {
+      if (row_costs[x] != LETHAL_OBSTACLE) {
+        distances[x] = std::min(std::sqrt(transformed_[x - sx0]) * resolution, max_distance);
+      }
+    }
+
+    // Only lethal cells read their distance to free cells
+    if (std::find(row_costs + x0, row_costs + xn, LETHAL_OBSTACLE) == row_costs + xn) {
+      continue;
+    }
+    const float * to_free = &free_distances_[static_cast<size_t>(y - sy0) * width];
+    for (unsigned int i = 0; i < width; ++i) {
+      line_[i] = to_free[i] * to_free[i];
+    }
+    transformLine(line_.data(), transformed_.data(), width);
+    for (unsigned int x = x0; x < xn; ++x) {
+      if (row_costs[x] == LETHAL_OBSTACLE) {
+        distances[x] = -std::min(std::sqrt(transformed_[x - sx0]) * resolution, max_distance);
+      }
+    }
+  }
+}
+
+void DistanceField::transformLine(const float * f, float * d, unsigned int n)
+{
+  if (n == 0) {
+    return;
+  }
+
+  // Roots of the parabolas of the lower envelope, and the bounds of their intervals
+  unsigned int * v = envelope_roots_.data();
+  double * z = envelope_bounds_.data();
+  unsigned int k = 0;
+  v[0] = 0;
+  z[0] = -std::numeric_limits<double>::infinity();
+  z[1] = std::numeric_limits<double>::infinity();
+  for (unsigned int q = 1; q < n; ++q) {
+    // Parabolas the new one is below over their whole interval leave the envelope
+    double s;
+    while (true) {
+      const double p = v[k];
+      s = ((f[q] + static_cast<double>(q) * q) - (f[v[k]] + p * p)) / (2.0 * (q - p));
+      if (s > z[k]) {
+        break;
+      }
+      --k;
+    }
+    ++k;
+    v[k] = q;
+    z[k] = s;
+    z[k + 1] = std::numeric_limits<double>::infinity();
+  }
+
+  k = 0;
+  for (unsigned int q = 0; q < n; ++q) {
+    while (z[k + 1] < q) {
+      ++k;
+    }
+    const float offset = static_cast<float>(q) - static_cast<float>(v[k]);
+    d[q] = offset * offset + f[v[k]];
+  }
+}
+
+}  // namespace nav2_costmap_2d
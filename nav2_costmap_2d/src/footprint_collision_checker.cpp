@@ -14,8 +14,11 @@
 //
 // Modified by: Shivang Patel (shivaang14@gmail.com)
 
+#include <cmath>
+#include <limits>
 #include <memory>
 #include <string>
+#include <utility>
 #include <vector>
 #include <algorithm>
 
@@ -24,7 +27,7 @@
 #include "nav2_costmap_2d/cost_values.hpp"
 #include "nav2_costmap_2d/exceptions.hpp"
 #include "nav2_costmap_2d/footprint.hpp"
-#include "nav2_util/line_iterator.hpp"
+#include "nav2_util/grid_traversal.hpp"
 
 using namespace std::chrono_literals;
 
@@ -51,6 +54,26 @@ double FootprintCollisionChecker<CostmapT>::footprintCost(const Footprint footpr
   unsigned int x0, x1, y0, y1;
   double footprint_cost = 0.0;
 
+  // footprints with free bounds are free, which the pyramid finds from a few coarse cells
+  if (costmap_pyramid_ && costmap_pyramid_->getLevels() > 0) {
+    unsigned int min_x = std::numeric_limits<unsigned int>::max(), max_x = 0;
+    unsigned int min_y = std::numeric_limits<unsigned int>::max(), max_y = 0;
+    for (const auto & point : footprint) {
+      if (!worldToMap(point.x, point.y, x0, y0)) {
+        return static_cast<double>(LETHAL_OBSTACLE);
+      }
+      min_x = std::min(min_x, x0);
+      max_x = std::max(max_x, x0);
+      min_y = std::min(min_y, y0);
+      max_y = std::max(max_y, y0);
+    }
+    if (costmap_pyramid_->getMaxCost(
+        *costmap_, min_x, min_y, max_x + 1, max_y + 1, FREE_SPACE + 1) == FREE_SPACE)
+    {
+      return static_cast<double>(FREE_SPACE);
+    }
+  }
+
   // get the cell coord of the first point
   if (!worldToMap(footprint[0].x, footprint[0].y, x0, y0)) {
     return static_cast<double>(LETHAL_OBSTACLE);
@@ -87,23 +110,27 @@ double FootprintCollisionChecker<CostmapT>::footprintCost(const Footprint footpr
 template<typename CostmapT>
 double FootprintCollisionChecker<CostmapT>::lineCost(int x0, int x1, int y0, int y1) const
 {
-  double line_cost = 0.0;
-  double point_cost = -1.0;
-
-  for (nav2_util::LineIterator line(x0, y0, x1, y1); line.isValid(); line.advance()) {
-    point_cost = pointCost(line.getX(), line.getY());   // Score the current point
-
-    // if in collision, no need to continue
-    if (point_cost == static_cast<double>(LETHAL_OBSTACLE)) {
-      return point_cost;
-    }
-
-    if (line_cost < point_cost) {
-      line_cost = point_cost;
-    }
-  }
+  // The runs of the line along rows are scanned without branching on each cell, and the
+  // line stops at the first run in collision
+  const unsigned char * costs = costmap_->getCharMap();
+  const unsigned int size_x = costmap_->getSizeInCellsX();
+  unsigned char line_cost = 0;
+  bool lethal = false;
+  nav2_util::traverseLineSpans(
+    x0, y0, x1, y1, [&](int y, int x_first, int x_last) {
+      const unsigned char * row = costs + static_cast<size_t>(y) * size_x;
+      unsigned char run_cost = 0;
+      bool run_lethal = false;
+      for (int x = x_first; x <= x_last; ++x) {
+        run_cost = std::max(run_cost, row[x]);
+        run_lethal |= row[x] == LETHAL_OBSTACLE;
+      }
+      line_cost = std::max(line_cost, run_cost);
+      lethal = run_lethal;
+      return !run_lethal;
+    });
 
-  return line_cost;
+  return lethal ? static_cast<double>(LETHAL_OBSTACLE) : static_cast<double>(line_cost);
 }
 
 template<typename CostmapT>
@@ -142,6 +169,267 @@ double FootprintCollisionChecker<CostmapT>::footprintCostAtPose(
   return footprintCost(oriented_footprint);
 }
 
+template<typename CostmapT>
+void FootprintCollisionChecker<CostmapT>::setFootprintRaster(
+  const Footprint & footprint, unsigned int num_headings, bool include_interior)
+{
+  raster_footprint_ = footprint;
+  raster_headings_ = num_headings;
+  raster_interior_ = include_interior;
+  computeFootprintRasters();
+}
+
+template<typename CostmapT>
+void FootprintCollisionChecker<CostmapT>::computeFootprintRasters()
+{
+  rasters_.clear();
+  raster_resolution_ = costmap_->getResolution();
+  if (raster_footprint_.empty() || raster_headings_ == 0) {
+    return;
+  }
+
+  rasters_.resize(raster_headings_);
+  const unsigned int num_vertices = raster_footprint_.size();
+  std::vector<double> vertices_x(num_vertices), vertices_y(num_vertices);
+  std::vector<int> cells_x(num_vertices), cells_y(num_vertices);
+  std::vector<double> crossings;
+
+  for (unsigned int heading = 0; heading < raster_headings_; ++heading) {
+    const double theta = 2.0 * M_PI * heading / raster_headings_;
+    const double cos_th = cos(theta);
+    const double sin_th = sin(theta);
+    FootprintRaster & raster = rasters_[heading];
+
+    // Vertices in cells, with the pose at the center of cell (0, 0)
+    for (unsigned int i = 0; i < num_vertices; ++i) {
+      const Footprint::value_type & pt = raster_footprint_[i];
+      vertices_x[i] = 0.5 + (pt.x * cos_th - pt.y * sin_th) / raster_resolution_;
+      vertices_y[i] = 0.5 + (pt.x * sin_th + pt.y * cos_th) / raster_resolution_;
+      cells_x[i] = static_cast<int>(std::floor(vertices_x[i]));
+      cells_y[i] = static_cast<int>(std::floor(vertices_y[i]));
+    }
+
+    // The outline is traced between the cells of the vertices, as in footprintCost()
+    for (unsigned int i = 0; i < num_vertices; ++i) {
+      const unsigned int j = (i + 1) % num_vertices;
+      nav2_util::traverseLine(
+        cells_x[i], cells_y[i], cells_x[j], cells_y[j],
+        [&raster](int x, int y) {raster.cells.emplace_back(x, y);});
+    }
+
+    // Along with the cells whose centers are inside the footprint
+    if (raster_interior_) {
+      const auto rows = std::minmax_element(vertices_y.begin(), vertices_y.end());
+      const int min_row = static_cast<int>(std::floor(*rows.first));
+      const int max_row = static_cast<int>(std::floor(*rows.second));
+      for (int row = min_row; row <= max_row; ++row) {
+        const double y = row + 0.5;
+        crossings.clear();
+        for (unsigned int i = 0; i < num_vertices; ++i) {
+          const unsigned int j = (i + 1) % num_vertices;
+          if ((vertices_y[i] <= y) != (vertices_y[j] <= y)) {
+            crossings.push_back(
+              vertices_x[i] + (y - vertices_y[i]) * (vertices_x[j] - vertices_x[i]) /
+              (vertices_y[j] - vertices_y[i]));
+          }
+        }
+        std::sort(crossings.begin(), crossings.end());
+        for (unsigned int i = 0; i + 1 < crossings.size(); i += 2) {
+          const int first = static_cast<int>(std::ceil(crossings[i] - 0.5));
+          const int last = static_cast<int>(std::floor(crossings[i + 1] - 0.5));
+          for (int col = first; col <= last; ++col) {
+            raster.cells.emplace_back(col, row);
+          }
+        }
+      }
+    }
+
+    std::sort(
+      raster.cells.begin(), raster.cells.end(),
+      [](const std::pair<int, int> & a, const std::pair<int, int> & b) {
+        return a.second < b.second || (a.second == b.second && a.first < b.first);
+      });
+    raster.cells.erase(std::unique(raster.cells.begin(), raster.cells.end()), raster.cells.end());
+
+    raster.min_x = raster.max_x = raster.cells.front().first;
+    raster.min_y = raster.cells.front().second;
+    raster.max_y = raster.cells.back().second;
+    for (const auto & cell : raster.cells) {
+      raster.min_x = std::min(raster.min_x, cell.first);
+      raster.max_x = std::max(raster.max_x, cell.first);
+    }
+  }
+}
+
+template<typename CostmapT>
+double FootprintCollisionChecker<CostmapT>::footprintRasterCostAtPose(
+  double x, double y, double theta)
+{
+  if (raster_resolution_ != costmap_->getResolution()) {
+    computeFootprintRasters();
+  }
+
+  unsigned int mx, my;
+  if (rasters_.empty() || !worldToMap(x, y, mx, my)) {
+    return static_cast<double>(LETHAL_OBSTACLE);
+  }
+
+  const FootprintRaster & raster = rasters_[getRasterHeading(theta)];
+
+  // As with the vertices of the footprint, leaving the costmap is a collision
+  const int size_x = static_cast<int>(costmap_->getSizeInCellsX());
+  const int size_y = static_cast<int>(costmap_->getSizeInCellsY());
+  const int cx = static_cast<int>(mx);
+  const int cy = static_cast<int>(my);
+  if (cx + raster.min_x < 0 || cy + raster.min_y < 0 ||
+    cx + raster.max_x >= size_x || cy + raster.max_y >= size_y)
+  {
+    return static_cast<double>(LETHAL_OBSTACLE);
+  }
+
+  const unsigned char * costs = costmap_->getCharMap() + cy * size_x + cx;
+  unsigned char footprint_cost = 0;
+  for (const auto & cell : raster.cells) {
+    const unsigned char cost = costs[cell.second * size_x + cell.first];
+    if (cost == LETHAL_OBSTACLE) {
+      return static_cast<double>(LETHAL_OBSTACLE);
+    }
+    footprint_cost = std::max(footprint_cost, cost);
+  }
+
+  return static_cast<double>(footprint_cost);
+}
+
+template<typename CostmapT>
+const std::vector<std::pair<int, int>> &
+FootprintCollisionChecker<CostmapT>::getFootprintRaster(double theta)
+{
+  static const std::vector<std::pair<int, int>> no_cells;
+  if (raster_resolution_ != costmap_->getResolution()) {
+    computeFootprintRasters();
+  }
+  if (rasters_.empty()) {
+    return no_cells;
+  }
+  return rasters_[getRasterHeading(theta)].cells;
+}
+
+template<typename CostmapT>
+unsigned int FootprintCollisionChecker<CostmapT>::getRasterHeading(double theta) const
+{
+  const int num_headings = static_cast<int>(rasters_.size());
+  int heading = static_cast<int>(std::lround(theta * num_headings / (2.0 * M_PI)) % num_headings);
+  if (heading < 0) {
+    heading += num_headings;
+  }
+  return static_cast<unsigned int>(heading);
+}
+
+template<typename CostmapT>
+void FootprintCollisionChecker<CostmapT>::footprintRasterCostsAtPoses(
+  const std::vector<geometry_msgs::msg::Pose2D> & poses, std::vector<double> & costs)
+{
+  costs.resize(poses.size());
+  for (unsigned int i = 0; i < poses.size(); ++i) {
+    costs[i] = footprintRasterCostAtPose(poses[i].x, poses[i].y, poses[i].theta);
+  }
+}
+
+template<typename CostmapT>
+size_t FootprintCollisionChecker<CostmapT>::findFootprintCostAtPoses(
+  const std::vector<geometry_msgs::msg::Pose2D> & poses, const Footprint & footprint,
+  double cost, size_t start)
+{
+  if (!costmap_pyramid_ || costmap_pyramid_->getLevels() == 0) {
+    for (size_t i = start; i < poses.size(); ++i) {
+      if (footprintCostAtPose(poses[i].x, poses[i].y, poses[i].theta, footprint) >= cost) {
+        return i;
+      }
+    }
+    return poses.size();
+  }
+
+  // The sweep is searched in runs of growing size, so that poses far beyond an early
+  // collision are neither bounded nor checked
+  sweep_bounds_.resize(poses.size());
+  size_t run_size = 8;
+  for (size_t begin = start; begin < poses.size(); begin += run_size, run_size *= 2) {
+    const size_t end = std::min(begin + run_size, poses.size());
+
+    // The outline of the footprint is within the cell bounds of its vertices
+    for (size_t i = begin; i < end; ++i) {
+      const double cos_th = cos(poses[i].theta);
+      const double sin_th = sin(poses[i].theta);
+      CellBounds & bounds = sweep_bounds_[i];
+      bounds.min_x = bounds.min_y = std::numeric_limits<unsigned int>::max();
+      bounds.max_x = bounds.max_y = 0;
+      bounds.valid = true;
+      for (const auto & point : footprint) {
+        unsigned int mx, my;
+        if (!worldToMap(
+            poses[i].x + (point.x * cos_th - point.y * sin_th),
+            poses[i].y + (point.x * sin_th + point.y * cos_th), mx, my))
+        {
+          bounds.valid = false;
+          break;
+        }
+        bounds.min_x = std::min(bounds.min_x, mx);
+        bounds.max_x = std::max(bounds.max_x, mx);
+        bounds.min_y = std::min(bounds.min_y, my);
+        bounds.max_y = std::max(bounds.max_y, my);
+      }
+    }
+
+    const size_t first = findFootprintCostInRun(poses, footprint, cost, begin, end);
+    if (first != end) {
+      return first;
+    }
+  }
+  return poses.size();
+}
+
+template<typename CostmapT>
+size_t FootprintCollisionChecker<CostmapT>::findFootprintCostInRun(
+  const std::vector<geometry_msgs::msg::Pose2D> & poses, const Footprint & footprint,
+  double cost, size_t begin, size_t end)
+{
+  if (begin >= end) {
+    return end;
+  }
+
+  // No footprint of the run costs more than the cells under the bounds of all of them
+  CellBounds run = sweep_bounds_[begin];
+  for (size_t i = begin + 1; i < end && run.valid; ++i) {
+    const CellBounds & bounds = sweep_bounds_[i];
+    run.valid = bounds.valid;
+    run.min_x = std::min(run.min_x, bounds.min_x);
+    run.max_x = std::max(run.max_x, bounds.max_x);
+    run.min_y = std::min(run.min_y, bounds.min_y);
+    run.max_y = std::max(run.max_y, bounds.max_y);
+  }
+  if (run.valid) {
+    const unsigned char stop_cost =
+      static_cast<unsigned char>(std::min(std::ceil(cost), static_cast<double>(NO_INFORMATION)));
+    if (costmap_pyramid_->getMaxCost(
+        *costmap_, run.min_x, run.min_y, run.max_x + 1, run.max_y + 1, stop_cost) < cost)
+    {
+      return end;
+    }
+  }
+
+  if (end - begin == 1) {
+    const auto & pose = poses[begin];
+    return footprintCostAtPose(pose.x, pose.y, pose.theta, footprint) >= cost ? begin : end;
+  }
+
+  const size_t middle = begin + (end - begin) / 2;
+  const size_t first = findFootprintCostInRun(poses, footprint, cost, begin, middle);
+  if (first != middle) {
+    return first;
+  }
+  return findFootprintCostInRun(poses, footprint, cost, middle, end);
+}
+
 // declare our valid template parameters
 template class FootprintCollisionChecker<std::shared_ptr<nav2_costmap_2d::Costmap2D>>;
 template class FootprintCollisionChecker<nav2_costmap_2d::Costmap2D *>;
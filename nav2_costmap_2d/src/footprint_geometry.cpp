@@ -0,0 +1,67 @@
+// Copyright (c) 2022 Samsung Research America
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "nav2_costmap_2d/footprint_geometry.hpp"
+
+#include <atomic>
+#include <cmath>
+#include <mutex>
+#include <vector>
+
+#include "nav2_costmap_2d/footprint.hpp"
+
+namespace nav2_costmap_2d
+{
+
+// Shared across instances so that versions are never reused
+static std::atomic<uint64_t> next_version{1};
+
+FootprintGeometry::FootprintGeometry(const std::vector<geometry_msgs::msg::Point> & footprint)
+: version_(next_version++),
+  footprint_(footprint)
+{
+  calculateMinAndMaxDistances(footprint_, inscribed_radius_, circumscribed_radius_);
+}
+
+const std::vector<std::vector<geometry_msgs::msg::Point>> &
+FootprintGeometry::getOrientedFootprints(unsigned int num_angles) const
+{
+  std::lock_guard<std::mutex> lock(mutex_);
+  auto oriented = oriented_footprints_.find(num_angles);
+  if (oriented != oriented_footprints_.end()) {
+    return oriented->second;
+  }
+
+  std::vector<std::vector<geometry_msgs::msg::Point>> & footprints =
+    oriented_footprints_[num_angles];
+  footprints.reserve(num_angles);
+  const float bin_size = 2 * M_PI / static_cast<float>(num_angles);
+  geometry_msgs::msg::Point new_pt;
+  for (unsigned int i = 0; i != num_angles; i++) {
+    const double angle = bin_size * i;
+    const double sin_th = std::sin(angle);
+    const double cos_th = std::cos(angle);
+    std::vector<geometry_msgs::msg::Point> oriented_footprint;
+    oriented_footprint.reserve(footprint_.size());
+    for (const auto & point : footprint_) {
+      new_pt.x = point.x * cos_th - point.y * sin_th;
+      new_pt.y = point.x * sin_th + point.y * cos_th;
+      oriented_footprint.push_back(new_pt);
+    }
+    footprints.push_back(std::move(oriented_footprint));
+  }
+  return footprints;
+}
+
+}  // namespace nav2_costmap_2d
@@ -41,7 +41,10 @@ Layer::Layer()
   name_(),
   tf_(nullptr),
   current_(false),
-  enabled_(false)
+  enabled_(false),
+  update_period_(0.0),
+  has_updated_(false),
+  update_requested_(false)
 {}
 
 void
@@ -64,11 +67,49 @@ Layer::initialize(
     auto node_shared_ptr = node_.lock();
     logger_ = node_shared_ptr->get_logger();
     clock_ = node_shared_ptr->get_clock();
+
+    declareParameter("update_frequency", rclcpp::ParameterValue(0.0));
+    double update_frequency;
+    node_shared_ptr->get_parameter(getFullName("update_frequency"), update_frequency);
+    update_period_ = update_frequency > 0.0 ? 1.0 / update_frequency : 0.0;
   }
 
   onInitialize();
 }
 
+bool
+Layer::startUpdateIfDue(bool force)
+{
+  const bool requested = update_requested_.exchange(false);
+  if (update_period_ <= 0.0 || !clock_) {
+    return true;
+  }
+
+  // Time going backwards, e.g. a restarted simulation, is taken as the period elapsed
+  const rclcpp::Time now = clock_->now();
+  if (has_updated_ && !force && !requested &&
+    now.get_clock_type() == last_update_time_.get_clock_type())
+  {
+    const double elapsed = (now - last_update_time_).seconds();
+    if (elapsed >= 0.0 && elapsed < update_period_) {
+      return false;
+    }
+  }
+
+  last_update_time_ = now;
+  has_updated_ = true;
+  return true;
+}
+
+void
+Layer::requestUpdate()
+{
+  update_requested_ = true;
+  if (layered_costmap_) {
+    layered_costmap_->requestUpdate();
+  }
+}
+
 const std::vector<geometry_msgs::msg::Point> &
 Layer::getFootprint() const
 {
@@ -0,0 +1,223 @@
+// Copyright (c) 2022 Samsung Research America
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "nav2_costmap_2d/layer_snapshot.hpp"
+
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <memory>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "nav2_costmap_2d/costmap_compression.hpp"
+#include "rclcpp/logging.hpp"
+
+namespace nav2_costmap_2d
+{
+
+namespace
+{
+
+constexpr char kMagic[8] = {'N', 'A', 'V', '2', 'S', 'N', 'A', 'P'};
+constexpr uint32_t kVersion = 2;
+
+template<class T>
+void write(std::ofstream & file, const T & value)
+{
+  file.write(reinterpret_cast<const char *>(&value), sizeof(T));
+}
+
+template<class T>
+bool read(std::ifstream & file, T & value)
+{
+  return static_cast<bool>(file.read(reinterpret_cast<char *>(&value), sizeof(T)));
+}
+
+void writeEncoded(
+  std::ofstream & file, const uint8_t * data, unsigned int row_bytes, unsigned int rows)
+{
+  std::vector<uint8_t> encoded;
+  encodeRunLength(data, row_bytes, rows, row_bytes, encoded);
+  write(file, static_cast<uint64_t>(encoded.size()));
+  file.write(reinterpret_cast<const char *>(encoded.data()), encoded.size());
+}
+
+bool readEncoded(std::ifstream & file, std::vector<uint8_t> & data, size_t size)
+{
+  // Runs take at least two bytes, so that no more than two bytes per value are encoded
+  uint64_t encoded_size;
+  if (!read(file, encoded_size) || encoded_size > 2 * static_cast<uint64_t>(size)) {
+    return false;
+  }
+  std::vector<uint8_t> encoded(encoded_size);
+  if (!file.read(reinterpret_cast<char *>(encoded.data()), encoded_size)) {
+    return false;
+  }
+  data.resize(size);
+  if (size == 0) {
+    return true;
+  }
+  return decodeRunLength(encoded.data(), encoded.size(), data.data(), size);
+}
+
+}  // namespace
+
+bool saveLayerSnapshot(const std::string & path, const LayerSnapshot & snapshot)
+{
+  if (snapshot.costs.size() != static_cast<size_t>(snapshot.size_x) * snapshot.size_y ||
+    snapshot.voxels.size() !=
+    (snapshot.voxels.empty() ? 0 : snapshot.costs.size() * snapshot.word_size))
+  {
+    return false;
+  }
+
+  const std::string temporary_path = path + ".tmp";
+  {
+    std::ofstream file(temporary_path, std::ios::binary | std::ios::trunc);
+    if (!file) {
+      return false;
+    }
+    file.write(kMagic, sizeof(kMagic));
+    write(file, kVersion);
+    write(file, static_cast<uint32_t>(snapshot.frame.size()));
+    file.write(snapshot.frame.data(), snapshot.frame.size());
+    write(file, snapshot.stamp_ns);
+    write(file, snapshot.origin_x);
+    write(file, snapshot.origin_y);
+    write(file, snapshot.robot_x);
+    write(file, snapshot.robot_y);
+    write(file, snapshot.resolution);
+    write(file, static_cast<uint32_t>(snapshot.size_x));
+    write(file, static_cast<uint32_t>(snapshot.size_y));
+    writeEncoded(file, snapshot.costs.data(), snapshot.size_x, snapshot.size_y);
+    write(file, static_cast<uint32_t>(snapshot.voxels.empty() ? 0 : snapshot.size_z));
+    write(file, static_cast<uint32_t>(snapshot.voxels.empty() ? 0 : snapshot.word_size));
+    write(file, snapshot.origin_z);
+    write(file, snapshot.z_resolution);
+    if (!snapshot.voxels.empty()) {
+      writeEncoded(
+        file, snapshot.voxels.data(), snapshot.size_x * snapshot.word_size, snapshot.size_y);
+    }
+    if (!file.flush()) {
+      return false;
+    }
+  }
+  return std::rename(temporary_path.c_str(), path.c_str()) == 0;
+}
+
+bool loadLayerSnapshot(const std::string & path, LayerSnapshot & snapshot)
+{
+  std::ifstream file(path, std::ios::binary);
+  char magic[sizeof(kMagic)];
+  uint32_t version, frame_size;
+  if (!file || !file.read(magic, sizeof(magic)) ||
+    std::memcmp(magic, kMagic, sizeof(kMagic)) != 0 ||
+    !read(file, version) || version != kVersion || !read(file, frame_size) ||
+    frame_size > 4096)
+  {
+    return false;
+  }
+  snapshot.frame.resize(frame_size);
+  uint32_t size_x, size_y, size_z, word_size;
+  if (!file.read(&snapshot.frame[0], frame_size) || !read(file, snapshot.stamp_ns) ||
+    !read(file, snapshot.origin_x) || !read(file, snapshot.origin_y) ||
+    !read(file, snapshot.robot_x) || !read(file, snapshot.robot_y) ||
+    !read(file, snapshot.resolution) || !read(file, size_x) || !read(file, size_y))
+  {
+    return false;
+  }
+  snapshot.size_x = size_x;
+  snapshot.size_y = size_y;
+  const size_t cells = static_cast<size_t>(size_x) * size_y;
+  if (!readEncoded(file, snapshot.costs, cells) || !read(file, size_z) ||
+    !read(file, word_size) || !read(file, snapshot.origin_z) ||
+    !read(file, snapshot.z_resolution) || word_size > 16)
+  {
+    return false;
+  }
+  snapshot.size_z = size_z;
+  snapshot.word_size = word_size;
+  snapshot.voxels.clear();
+  return word_size == 0 || readEncoded(file, snapshot.voxels, cells * word_size);
+}
+
+size_t copyOverlappingCells(
+  const uint8_t * source, unsigned int source_size_x, unsigned int source_size_y,
+  uint8_t * destination, unsigned int size_x, unsigned int size_y,
+  int offset_x, int offset_y, size_t cell_bytes)
+{
+  // Columns and rows of the source grid within the destination grid
+  const int64_t first_x = std::max<int64_t>(0, -static_cast<int64_t>(offset_x));
+  const int64_t last_x = std::min<int64_t>(source_size_x, static_cast<int64_t>(size_x) - offset_x);
+  const int64_t first_y = std::max<int64_t>(0, -static_cast<int64_t>(offset_y));
+  const int64_t last_y = std::min<int64_t>(source_size_y, static_cast<int64_t>(size_y) - offset_y);
+  if (first_x >= last_x || first_y >= last_y) {
+    return 0;
+  }
+
+  const size_t row_bytes = static_cast<size_t>(last_x - first_x) * cell_bytes;
+  for (int64_t y = first_y; y < last_y; ++y) {
+    std::memcpy(
+      destination + ((y + offset_y) * size_x + first_x + offset_x) * cell_bytes,
+      source + (y * source_size_x + first_x) * cell_bytes, row_bytes);
+  }
+  return static_cast<size_t>(last_x - first_x) * static_cast<size_t>(last_y - first_y);
+}
+
+LayerSnapshotWriter::LayerSnapshotWriter(const std::string & path, const rclcpp::Logger & logger)
+: path_(path), logger_(logger)
+{
+  thread_ = std::thread(&LayerSnapshotWriter::run, this);
+}
+
+LayerSnapshotWriter::~LayerSnapshotWriter()
+{
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    stop_ = true;
+  }
+  cv_.notify_one();
+  thread_.join();
+}
+
+void LayerSnapshotWriter::submit(std::unique_ptr<LayerSnapshot> snapshot)
+{
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    pending_ = std::move(snapshot);
+  }
+  cv_.notify_one();
+}
+
+void LayerSnapshotWriter::run()
+{
+  std::unique_lock<std::mutex> lock(mutex_);
+  while (true) {
+    cv_.wait(lock, [this]() {return stop_ || pending_;});
+    if (!pending_) {
+      return;
+    }
+    std::unique_ptr<LayerSnapshot> snapshot = std::move(pending_);
+    lock.unlock();
+    if (!saveLayerSnapshot(path_, *snapshot)) {
+      RCLCPP_WARN(logger_, "Failed to save a layer snapshot to %s", path_.c_str());
+    }
+    lock.lock();
+  }
+}
+
+}  // namespace nav2_costmap_2d
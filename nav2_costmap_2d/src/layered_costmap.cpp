@@ -41,6 +41,7 @@
 #include <cstdio>
 #include <memory>
 #include <string>
+#include <utility>
 #include <vector>
 #include <limits>
 
@@ -67,8 +68,22 @@ LayeredCostmap::LayeredCostmap(std::string global_frame, bool rolling_window, bo
   byn_(0),
   initialized_(false),
   size_locked_(false),
+  resampling_(false),
+  update_whole_map_(false),
+  update_all_layers_(true),
   circumscribed_radius_(1.0),
-  inscribed_radius_(0.1)
+  inscribed_radius_(0.1),
+  footprint_geometry_(
+    std::make_shared<const FootprintGeometry>(std::vector<geometry_msgs::msg::Point>())),
+  tile_size_(256),
+  snapshots_enabled_(false),
+  snapshot_update_count_(0),
+  spare_snapshot_update_count_(0),
+  update_count_(0),
+  sensor_stamp_(0),
+  pending_sensor_stamp_(0),
+  journal_start_count_(0),
+  update_requested_(false)
 {
   if (track_unknown) {
     primary_costmap_.setDefaultValue(255);
@@ -99,12 +114,24 @@ void LayeredCostmap::resizeMap(
   unsigned int size_x, unsigned int size_y, double resolution,
   double origin_x,
   double origin_y,
-  bool size_locked)
+  bool size_locked,
+  bool resample)
 {
   std::unique_lock<Costmap2D::mutex_t> lock(*(combined_costmap_.getMutex()));
   size_locked_ = size_locked;
-  primary_costmap_.resizeMap(size_x, size_y, resolution, origin_x, origin_y);
-  combined_costmap_.resizeMap(size_x, size_y, resolution, origin_x, origin_y);
+  if (resample) {
+    // The master costmaps are resampled as well, for readers until the next update
+    Costmap2D previous_primary(primary_costmap_), previous_combined(combined_costmap_);
+    primary_costmap_.resizeMap(size_x, size_y, resolution, origin_x, origin_y);
+    combined_costmap_.resizeMap(size_x, size_y, resolution, origin_x, origin_y);
+    primary_costmap_.copyResampled(previous_primary);
+    combined_costmap_.copyResampled(previous_combined);
+    update_whole_map_ = true;
+  } else {
+    primary_costmap_.resizeMap(size_x, size_y, resolution, origin_x, origin_y);
+    combined_costmap_.resizeMap(size_x, size_y, resolution, origin_x, origin_y);
+  }
+  resampling_ = resample;
   for (vector<std::shared_ptr<Layer>>::iterator plugin = plugins_.begin();
     plugin != plugins_.end(); ++plugin)
   {
@@ -115,6 +142,15 @@ void LayeredCostmap::resizeMap(
   {
     (*filter)->matchSize();
   }
+  resampling_ = false;
+  journal_start_count_ = ++update_count_;
+  changed_windows_.clear();
+  distance_field_.invalidate();
+  update_all_layers_ = true;
+
+  if (snapshots_enabled_) {
+    publishSnapshot();
+  }
 }
 
 bool LayeredCostmap::isOutofBounds(double robot_x, double robot_y)
@@ -129,8 +165,119 @@ void LayeredCostmap::updateMap(double robot_x, double robot_y, double robot_yaw)
   // implement thread unsafe updateBounds() functions.
   std::unique_lock<Costmap2D::mutex_t> lock(*(combined_costmap_.getMutex()));
 
+  const double origin_x = combined_costmap_.getOriginX();
+  const double origin_y = combined_costmap_.getOriginY();
+  const bool updated = updateMasterCostmap(robot_x, robot_y, robot_yaw);
+
+  // The bounds are those of the last update if this one had none, so its window is
+  // empty instead. That only matters if the origin moved, which the pyramid and the
+  // distance field see themselves and then recompute in full.
+  const unsigned int xn = updated ? bxn_ : bx0_;
+  const unsigned int yn = updated ? byn_ : by0_;
+  if (pyramid_.getLevels() > 0) {
+    pyramid_.update(combined_costmap_, bx0_, by0_, xn, yn);
+  }
+  if (distance_field_.isEnabled()) {
+    distance_field_.update(combined_costmap_, bx0_, by0_, xn, yn);
+  }
+  sensor_stamp_ = std::max(sensor_stamp_, pending_sensor_stamp_);
+  ++update_count_;
+
+  // Moving the origin of a rolling costmap shifts all of its cells
+  if (origin_x != combined_costmap_.getOriginX() || origin_y != combined_costmap_.getOriginY()) {
+    journal_start_count_ = update_count_;
+    changed_windows_.clear();
+  } else if (updated) {
+    changed_windows_.push_back({update_count_, bx0_, by0_, bxn_, byn_});
+    if (changed_windows_.size() > max_changed_windows_) {
+      journal_start_count_ = changed_windows_.front().update_count;
+      changed_windows_.pop_front();
+    }
+  }
+
+  if (snapshots_enabled_) {
+    publishSnapshot();
+  }
+}
+
+bool LayeredCostmap::getChangedWindows(
+  uint64_t update_count,
+  std::vector<ChangedWindow> & windows) const
+{
+  windows.clear();
+  if (update_count >= update_count_) {
+    return true;
+  }
+
+  // The journal must go back to the update count, without a change of the whole costmap since
+  if (update_count < journal_start_count_) {
+    return false;
+  }
+
+  for (const auto & window : changed_windows_) {
+    if (window.update_count > update_count) {
+      windows.push_back(window);
+    }
+  }
+  return true;
+}
+
+std::shared_ptr<const Costmap2D> LayeredCostmap::getCostmapSnapshot()
+{
+  // Snapshots are only taken once requested, so that costmaps without
+  // snapshot readers do not pay for copying the master costmap
+  if (!snapshots_enabled_) {
+    std::unique_lock<Costmap2D::mutex_t> lock(*(combined_costmap_.getMutex()));
+    if (!snapshots_enabled_) {
+      publishSnapshot();
+      snapshots_enabled_ = true;
+    }
+  }
+  return std::atomic_load(&snapshot_);
+}
+
+void LayeredCostmap::publishSnapshot()
+{
+  // Readers can't get a reference to the previous snapshot anymore,
+  // so its costmap is reused once the last of them released it
+  std::shared_ptr<Costmap2D> snapshot;
+  uint64_t snapshot_update_count = 0;
+  if (spare_snapshot_ && spare_snapshot_.use_count() == 1) {
+    snapshot = std::move(spare_snapshot_);
+    snapshot_update_count = spare_snapshot_update_count_;
+  } else {
+    snapshot = std::make_shared<Costmap2D>();
+  }
+
+  // A reused snapshot only needs the windows changed since it was taken, unless the
+  // journal doesn't go back that far
+  if (snapshot->getCharMap() != nullptr &&
+    snapshot->getSizeInCellsX() == combined_costmap_.getSizeInCellsX() &&
+    snapshot->getSizeInCellsY() == combined_costmap_.getSizeInCellsY() &&
+    snapshot->getResolution() == combined_costmap_.getResolution() &&
+    snapshot->getOriginX() == combined_costmap_.getOriginX() &&
+    snapshot->getOriginY() == combined_costmap_.getOriginY() &&
+    getChangedWindows(snapshot_update_count, snapshot_windows_))
+  {
+    for (const auto & window : snapshot_windows_) {
+      snapshot->copyWindow(
+        combined_costmap_, window.x0, window.y0, window.xn, window.yn, window.x0, window.y0);
+    }
+  } else {
+    *snapshot = combined_costmap_;
+  }
+
+  spare_snapshot_update_count_ = snapshot_update_count_;
+  snapshot_update_count_ = update_count_;
+  spare_snapshot_ = std::atomic_exchange(&snapshot_, snapshot);
+}
+
+bool LayeredCostmap::updateMasterCostmap(double robot_x, double robot_y, double robot_yaw)
+{
   // if we're using a rolling buffer costmap...
   // we need to update the origin using the robot's position
+  const double previous_origin_x = combined_costmap_.getOriginX();
+  const double previous_origin_y = combined_costmap_.getOriginY();
   if (rolling_window_) {
     double new_origin_x = robot_x - combined_costmap_.getSizeInMetersX() / 2;
     double new_origin_y = robot_y - combined_costmap_.getSizeInMetersY() / 2;
@@ -138,6 +285,13 @@ void LayeredCostmap::updateMap(double robot_x, double robot_y, double robot_yaw)
     combined_costmap_.updateOrigin(new_origin_x, new_origin_y);
   }
 
+  // Layers move their own costmaps with the master costmap in their updateBounds(), so
+  // all of them are due after a move, as after a resize or a reset
+  const bool update_all_layers = update_all_layers_ || update_whole_map_ ||
+    previous_origin_x != combined_costmap_.getOriginX() ||
+    previous_origin_y != combined_costmap_.getOriginY();
+  update_all_layers_ = false;
+
   if (isOutofBounds(robot_x, robot_y)) {
     RCLCPP_WARN(
       rclcpp::get_logger("nav2_costmap_2d"),
@@ -145,7 +299,7 @@ void LayeredCostmap::updateMap(double robot_x, double robot_y, double robot_yaw)
   }
 
   if (plugins_.size() == 0 && filters_.size() == 0) {
-    return;
+    return false;
   }
 
   minx_ = miny_ = std::numeric_limits<double>::max();
@@ -154,6 +308,9 @@ void LayeredCostmap::updateMap(double robot_x, double robot_y, double robot_yaw)
   for (vector<std::shared_ptr<Layer>>::iterator plugin = plugins_.begin();
     plugin != plugins_.end(); ++plugin)
   {
+    if (!(*plugin)->startUpdateIfDue(update_all_layers)) {
+      continue;
+    }
     double prev_minx = minx_;
     double prev_miny = miny_;
     double prev_maxx = maxx_;
@@ -172,6 +329,9 @@ void LayeredCostmap::updateMap(double robot_x, double robot_y, double robot_yaw)
   for (vector<std::shared_ptr<Layer>>::iterator filter = filters_.begin();
     filter != filters_.end(); ++filter)
   {
+    if (!(*filter)->startUpdateIfDue(update_all_layers)) {
+      continue;
+    }
     double prev_minx = minx_;
     double prev_miny = miny_;
     double prev_maxx = maxx_;
@@ -188,6 +348,16 @@ void LayeredCostmap::updateMap(double robot_x, double robot_y, double robot_yaw)
     }
   }
 
+  if (update_whole_map_) {
+    const double origin_x = combined_costmap_.getOriginX();
+    const double origin_y = combined_costmap_.getOriginY();
+    minx_ = std::min(minx_, origin_x);
+    miny_ = std::min(miny_, origin_y);
+    maxx_ = std::max(maxx_, origin_x + combined_costmap_.getSizeInMetersX());
+    maxy_ = std::max(maxy_, origin_y + combined_costmap_.getSizeInMetersY());
+    update_whole_map_ = false;
+  }
+
   int x0, xn, y0, yn;
   combined_costmap_.worldToMapEnforceBounds(minx_, miny_, x0, y0);
   combined_costmap_.worldToMapEnforceBounds(maxx_, maxy_, xn, yn);
@@ -202,7 +372,7 @@ void LayeredCostmap::updateMap(double robot_x, double robot_y, double robot_yaw)
       "nav2_costmap_2d"), "Updating area x: [%d, %d] y: [%d, %d]", x0, xn, y0, yn);
 
   if (xn < x0 || yn < y0) {
-    return;
+    return false;
   }
 
   if (filters_.size() == 0) {
@@ -211,7 +381,7 @@ void LayeredCostmap::updateMap(double robot_x, double robot_y, double robot_yaw)
     for (vector<std::shared_ptr<Layer>>::iterator plugin = plugins_.begin();
       plugin != plugins_.end(); ++plugin)
     {
-      (*plugin)->updateCosts(combined_costmap_, x0, y0, xn, yn);
+      updateLayerCosts(*plugin, combined_costmap_, x0, y0, xn, yn);
     }
   } else {
     // Costmap Filters enabled
@@ -220,7 +390,7 @@ void LayeredCostmap::updateMap(double robot_x, double robot_y, double robot_yaw)
     for (vector<std::shared_ptr<Layer>>::iterator plugin = plugins_.begin();
       plugin != plugins_.end(); ++plugin)
     {
-      (*plugin)->updateCosts(primary_costmap_, x0, y0, xn, yn);
+      updateLayerCosts(*plugin, primary_costmap_, x0, y0, xn, yn);
     }
 
     // 2. Copy processed costmap window to a final costmap.
@@ -248,6 +418,99 @@ void LayeredCostmap::updateMap(double robot_x, double robot_y, double robot_yaw)
   byn_ = yn;
 
   initialized_ = true;
+  return true;
+}
+
+void LayeredCostmap::updateLayerCosts(
+  const std::shared_ptr<Layer> & layer, Costmap2D & master_grid,
+  int x0, int y0, int xn, int yn)
+{
+  if (!tile_pool_ || !layer->isTileSafe()) {
+    layer->updateCosts(master_grid, x0, y0, xn, yn);
+    return;
+  }
+
+  layer->beginTiledUpdate(master_grid, x0, y0, xn, yn);
+
+  try {
+    // Tiles are at least as large as the halo the layer reads around them, so that
+    // tiles of the same phase of a 2x2 checkerboard never read each other's cells
+    const unsigned int halo = layer->getTileHalo();
+    const int tile_size = static_cast<int>(std::max(tile_size_, std::max(halo, 1u)));
+    const int tiles_x = (xn - x0 + tile_size - 1) / tile_size;
+    const int tiles_y = (yn - y0 + tile_size - 1) / tile_size;
+    const int phases = halo > 0 ? 4 : 1;
+
+    for (int phase = 0; phase < phases; ++phase) {
+      std::vector<std::pair<int, int>> tiles;
+      for (int ty = 0; ty < tiles_y; ++ty) {
+        for (int tx = 0; tx < tiles_x; ++tx) {
+          if (phases == 1 || ((tx & 1) + 2 * (ty & 1)) == phase) {
+            tiles.emplace_back(tx, ty);
+          }
+        }
+      }
+
+      tile_pool_->run(
+        tiles.size(), [&](unsigned int i) {
+          const int min_i = x0 + tiles[i].first * tile_size;
+          const int min_j = y0 + tiles[i].second * tile_size;
+          layer->updateCostsTile(
+            master_grid, min_i, min_j,
+            std::min(min_i + tile_size, xn), std::min(min_j + tile_size, yn));
+        });
+    }
+  } catch (...) {
+    layer->endTiledUpdate();
+    throw;
+  }
+
+  layer->endTiledUpdate();
+}
+
+void LayeredCostmap::setTiledUpdate(unsigned int threads, unsigned int tile_size)
+{
+  tile_size_ = std::max(tile_size, 1u);
+  if (threads <= 1) {
+    tile_pool_.reset();
+  } else if (!tile_pool_ || tile_pool_->getThreads() != threads) {
+    tile_pool_ = std::make_unique<TileThreadPool>(threads);
+  }
+}
+
+void LayeredCostmap::setPyramidLevels(unsigned int levels)
+{
+  std::unique_lock<Costmap2D::mutex_t> lock(*(combined_costmap_.getMutex()));
+  pyramid_.setLevels(levels);
+}
+
+void LayeredCostmap::setDistanceFieldMaxDistance(double max_distance)
+{
+  std::unique_lock<Costmap2D::mutex_t> lock(*(combined_costmap_.getMutex()));
+  distance_field_.setMaxDistance(max_distance);
+}
+
+void LayeredCostmap::requestUpdate()
+{
+  {
+    std::lock_guard<std::mutex> lock(update_request_mutex_);
+    update_requested_ = true;
+  }
+  update_request_cv_.notify_all();
+}
+
+bool LayeredCostmap::waitForUpdateRequest(
+  const std::chrono::steady_clock::time_point & deadline)
+{
+  std::unique_lock<std::mutex> lock(update_request_mutex_);
+  auto requested = [this]() {return update_requested_;};
+  if (deadline == std::chrono::steady_clock::time_point::max()) {
+    update_request_cv_.wait(lock, requested);
+  } else if (!update_request_cv_.wait_until(lock, deadline, requested)) {
+    return false;
+  }
+  update_requested_ = false;
+  return true;
 }
 
 bool LayeredCostmap::isCurrent()
@@ -266,12 +529,42 @@ bool LayeredCostmap::isCurrent()
   return current_;
 }
 
+size_t LayeredCostmap::getMemoryUsage()
+{
+  auto cells = [](const Costmap2D & costmap) {
+      return static_cast<size_t>(costmap.getSizeInCellsX()) * costmap.getSizeInCellsY();
+    };
+
+  std::unique_lock<Costmap2D::mutex_t> lock(*(combined_costmap_.getMutex()));
+  size_t bytes = cells(primary_costmap_) + cells(combined_costmap_);
+  for (unsigned int level = 1; level <= pyramid_.getLevels(); ++level) {
+    if (const Costmap2D * coarse = pyramid_.getLevel(1u << level)) {
+      bytes += cells(*coarse);
+    }
+  }
+  if (distance_field_.isEnabled()) {
+    bytes += static_cast<size_t>(distance_field_.getSizeInCellsX()) *
+      distance_field_.getSizeInCellsY() * sizeof(float);
+  }
+  if (auto snapshot = std::atomic_load(&snapshot_)) {
+    bytes += cells(*snapshot);
+  }
+  if (spare_snapshot_) {
+    bytes += cells(*spare_snapshot_);
+  }
+  return bytes;
+}
+
 void LayeredCostmap::setFootprint(const std::vector<geometry_msgs::msg::Point> & footprint_spec)
 {
+  // The geometry is only computed again, with a new version, for a new footprint
+  if (footprint_spec != footprint_geometry_->getFootprint()) {
+    std::atomic_store(
+      &footprint_geometry_, std::make_shared<const FootprintGeometry>(footprint_spec));
+  }
   footprint_ = footprint_spec;
-  nav2_costmap_2d::calculateMinAndMaxDistances(
-    footprint_spec,
-    inscribed_radius_, circumscribed_radius_);
+  inscribed_radius_ = footprint_geometry_->getInscribedRadius();
+  circumscribed_radius_ = footprint_geometry_->getCircumscribedRadius();
 
   for (vector<std::shared_ptr<Layer>>::iterator plugin = plugins_.begin();
     plugin != plugins_.end();
@@ -285,6 +578,8 @@ void LayeredCostmap::setFootprint(const std::vector<geometry_msgs::msg::Point> &
   {
     (*filter)->onFootprintChanged();
   }
+
+  requestUpdate();
 }
 
 }  // namespace nav2_costmap_2d
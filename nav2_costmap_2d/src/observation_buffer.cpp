@@ -37,7 +37,11 @@
 #include "nav2_costmap_2d/observation_buffer.hpp"
 
 #include <algorithm>
+#include <cmath>
+#include <iterator>
 #include <list>
+#include <memory>
+#include <mutex>
 #include <string>
 #include <vector>
 #include <chrono>
@@ -82,10 +86,76 @@ ObservationBuffer::~ObservationBuffer()
 
 void ObservationBuffer::bufferCloud(const sensor_msgs::msg::PointCloud2 & cloud)
 {
-  geometry_msgs::msg::PointStamped global_origin;
+  std::lock_guard<std::mutex> scratch_guard(scratch_lock_);
+  bufferCloudLocked(cloud);
+}
+
+void ObservationBuffer::bufferScan(const sensor_msgs::msg::LaserScan & scan)
+{
+  std::lock_guard<std::mutex> scratch_guard(scratch_lock_);
+
+  // The unit vectors only change with the configuration of the scans
+  const size_t beams = scan.ranges.size();
+  if (beam_x_.size() != beams || beam_angle_min_ != scan.angle_min ||
+    beam_angle_increment_ != scan.angle_increment)
+  {
+    beam_x_.resize(beams);
+    beam_y_.resize(beams);
+    for (size_t i = 0; i < beams; ++i) {
+      const double angle = scan.angle_min + i * static_cast<double>(scan.angle_increment);
+      beam_x_[i] = static_cast<float>(std::cos(angle));
+      beam_y_[i] = static_cast<float>(std::sin(angle));
+    }
+    beam_angle_min_ = scan.angle_min;
+    beam_angle_increment_ = scan.angle_increment;
+  }
+
+  scan_cloud_.header = scan.header;
+  sensor_msgs::PointCloud2Modifier modifier(scan_cloud_);
+  if (scan_cloud_.fields.size() != 3) {
+    modifier.setPointCloud2FieldsByString(1, "xyz");
+  }
+  modifier.resize(beams);
+  sensor_msgs::PointCloud2Iterator<float> iter_x(scan_cloud_, "x");
+  sensor_msgs::PointCloud2Iterator<float> iter_y(scan_cloud_, "y");
+  sensor_msgs::PointCloud2Iterator<float> iter_z(scan_cloud_, "z");
+  size_t points = 0;
+  for (size_t i = 0; i < beams; ++i) {
+    const float range = scan.ranges[i];
+    if (!(range >= scan.range_min && range < scan.range_max)) {
+      continue;
+    }
+    *iter_x = range * beam_x_[i];
+    *iter_y = range * beam_y_[i];
+    *iter_z = 0.0f;
+    ++iter_x;
+    ++iter_y;
+    ++iter_z;
+    ++points;
+  }
+  modifier.resize(points);
 
-  // create a new observation on the list to be populated
-  observation_list_.push_front(Observation());
+  bufferCloudLocked(scan_cloud_);
+}
+
+void ObservationBuffer::bufferCloudLocked(const sensor_msgs::msg::PointCloud2 & cloud)
+{
+  // The cloud is transformed and filtered outside of the buffer lock, so that
+  // readers aren't blocked meanwhile, into a recycled observation if any
+  std::list<Observation> new_observation;
+  {
+    std::lock_guard<std::recursive_mutex> guard(lock_);
+    if (!spare_observations_.empty()) {
+      new_observation.splice(
+        new_observation.begin(), spare_observations_, spare_observations_.begin());
+    }
+  }
+  if (new_observation.empty()) {
+    new_observation.emplace_back();
+  }
+  Observation & observation = new_observation.front();
+
+  geometry_msgs::msg::PointStamped global_origin;
 
   // check whether the origin frame has been set explicitly
   // or whether we should get it from the cloud
@@ -101,24 +171,24 @@ void ObservationBuffer::bufferCloud(const sensor_msgs::msg::PointCloud2 & cloud)
     local_origin.point.y = 0;
     local_origin.point.z = 0;
     tf2_buffer_.transform(local_origin, global_origin, global_frame_, tf_tolerance_);
-    tf2::convert(global_origin.point, observation_list_.front().origin_);
+    tf2::convert(global_origin.point, observation.origin_);
 
     // make sure to pass on the raytrace/obstacle range
     // of the observation buffer to the observations
-    observation_list_.front().raytrace_max_range_ = raytrace_max_range_;
-    observation_list_.front().raytrace_min_range_ = raytrace_min_range_;
-    observation_list_.front().obstacle_max_range_ = obstacle_max_range_;
-    observation_list_.front().obstacle_min_range_ = obstacle_min_range_;
-
-    sensor_msgs::msg::PointCloud2 global_frame_cloud;
+    observation.raytrace_max_range_ = raytrace_max_range_;
+    observation.raytrace_min_range_ = raytrace_min_range_;
+    observation.obstacle_max_range_ = obstacle_max_range_;
+    observation.obstacle_min_range_ = obstacle_min_range_;
+    observation.frustum_clearing_ = frustum_clearing_;
 
-    // transform the point cloud
+    // transform the point cloud, reusing the storage of the last transformed cloud
+    sensor_msgs::msg::PointCloud2 & global_frame_cloud = global_frame_cloud_;
     tf2_buffer_.transform(cloud, global_frame_cloud, global_frame_, tf_tolerance_);
     global_frame_cloud.header.stamp = cloud.header.stamp;
 
     // now we need to remove observations from the cloud that are below
     // or above our height thresholds
-    sensor_msgs::msg::PointCloud2 & observation_cloud = *(observation_list_.front().cloud_);
+    sensor_msgs::msg::PointCloud2 & observation_cloud = *(observation.cloud_);
     observation_cloud.height = global_frame_cloud.height;
     observation_cloud.width = global_frame_cloud.width;
     observation_cloud.fields = global_frame_cloud.fields;
@@ -131,18 +201,38 @@ void ObservationBuffer::bufferCloud(const sensor_msgs::msg::PointCloud2 & cloud)
     sensor_msgs::PointCloud2Modifier modifier(observation_cloud);
     modifier.resize(cloud_size);
     unsigned int point_count = 0;
+    const bool voxel_filter = filter_resolution_ > 0.0;
+    filter_cells_.clear();
 
     // copy over the points that are within our height bounds
+    sensor_msgs::PointCloud2Iterator<float> iter_x(global_frame_cloud, "x");
+    sensor_msgs::PointCloud2Iterator<float> iter_y(global_frame_cloud, "y");
     sensor_msgs::PointCloud2Iterator<float> iter_z(global_frame_cloud, "z");
     std::vector<unsigned char>::const_iterator iter_global = global_frame_cloud.data.begin(),
       iter_global_end = global_frame_cloud.data.end();
     std::vector<unsigned char>::iterator iter_obs = observation_cloud.data.begin();
-    for (; iter_global != iter_global_end; ++iter_z, iter_global +=
+    for (; iter_global != iter_global_end; ++iter_x, ++iter_y, ++iter_z, iter_global +=
       global_frame_cloud.point_step)
     {
       if ((*iter_z) <= max_obstacle_height_ &&
         (*iter_z) >= min_obstacle_height_)
       {
+        uint64_t key;
+        if (voxel_filter && getFilterCell(*iter_x, *iter_y, *iter_z, key)) {
+          auto cell = filter_cells_.emplace(key, FilterCell{point_count, *iter_z});
+          if (!cell.second) {
+            // Replace the point of the cell if this one is lower
+            if (*iter_z < cell.first->second.z) {
+              cell.first->second.z = *iter_z;
+              std::copy(
+                iter_global, iter_global + global_frame_cloud.point_step,
+                observation_cloud.data.begin() +
+                cell.first->second.index * global_frame_cloud.point_step);
+            }
+            continue;
+          }
+        }
+
         std::copy(iter_global, iter_global + global_frame_cloud.point_step, iter_obs);
         iter_obs += global_frame_cloud.point_step;
         ++point_count;
@@ -154,8 +244,11 @@ void ObservationBuffer::bufferCloud(const sensor_msgs::msg::PointCloud2 & cloud)
     observation_cloud.header.stamp = cloud.header.stamp;
     observation_cloud.header.frame_id = global_frame_cloud.header.frame_id;
   } catch (tf2::TransformException & ex) {
-    // if an exception occurs, we need to remove the empty observation from the list
-    observation_list_.pop_front();
+    // if an exception occurs, we need to give the unused observation back
+    {
+      std::lock_guard<std::recursive_mutex> guard(lock_);
+      recycleObservations(new_observation, new_observation.begin());
+    }
     RCLCPP_ERROR(
       logger_,
       "TF Exception that should never happen for sensor frame: %s, cloud frame: %s, %s",
@@ -164,6 +257,13 @@ void ObservationBuffer::bufferCloud(const sensor_msgs::msg::PointCloud2 & cloud)
     return;
   }
 
+  if (recorder_) {
+    recorder_->recordObservation(recorder_source_, observation);
+  }
+
+  std::lock_guard<std::recursive_mutex> guard(lock_);
+  observation_list_.splice(observation_list_.begin(), new_observation);
+
   // if the update was successful, we want to update the last updated time
   last_updated_ = clock_->now();
 
@@ -174,6 +274,8 @@ void ObservationBuffer::bufferCloud(const sensor_msgs::msg::PointCloud2 & cloud)
 // returns a copy of the observations
 void ObservationBuffer::getObservations(std::vector<Observation> & observations)
 {
+  std::lock_guard<std::recursive_mutex> guard(lock_);
+
   // first... let's make sure that we don't have any stale observations
   purgeStaleObservations();
 
@@ -190,7 +292,7 @@ void ObservationBuffer::purgeStaleObservations()
     std::list<Observation>::iterator obs_it = observation_list_.begin();
     // if we're keeping observations for no time... then we'll only keep one observation
     if (observation_keep_time_ == rclcpp::Duration(0.0s)) {
-      observation_list_.erase(++obs_it, observation_list_.end());
+      recycleObservations(observation_list_, ++obs_it);
       return;
     }
 
@@ -202,13 +304,26 @@ void ObservationBuffer::purgeStaleObservations()
       if ((clock_->now() - obs.cloud_->header.stamp) >
         observation_keep_time_)
       {
-        observation_list_.erase(obs_it, observation_list_.end());
+        recycleObservations(observation_list_, obs_it);
         return;
       }
     }
   }
 }
 
+void ObservationBuffer::recycleObservations(
+  std::list<Observation> & observations, std::list<Observation>::iterator first)
+{
+  // Observations keep the storage of their clouds, so that the next clouds
+  // buffered into them allocate no memory unless they have more points
+  while (first != observations.end() && spare_observations_.size() < max_spare_observations_) {
+    auto next = std::next(first);
+    spare_observations_.splice(spare_observations_.end(), observations, first);
+    first = next;
+  }
+  observations.erase(first, observations.end());
+}
+
 bool ObservationBuffer::isCurrent() const
 {
   if (expected_update_rate_ == rclcpp::Duration(0.0s)) {
@@ -233,4 +348,49 @@ void ObservationBuffer::resetLastUpdated()
 {
   last_updated_ = clock_->now();
 }
+
+void ObservationBuffer::setVoxelFilter(
+  double resolution, double z_resolution,
+  double origin_x, double origin_y, double origin_z)
+{
+  std::lock_guard<std::mutex> scratch_guard(scratch_lock_);
+  filter_resolution_ = resolution;
+  filter_z_resolution_ = z_resolution;
+  filter_origin_x_ = origin_x;
+  filter_origin_y_ = origin_y;
+  filter_origin_z_ = origin_z;
+}
+
+bool ObservationBuffer::getFilterCell(float x, float y, float z, uint64_t & key) const
+{
+  // Cells are packed in 21 bits per axis, so points should be within a million cells
+  const double cell_limit = static_cast<double>(1 << 20);
+  const double cx = std::floor((x - filter_origin_x_) / filter_resolution_);
+  const double cy = std::floor((y - filter_origin_y_) / filter_resolution_);
+  const double cz = filter_z_resolution_ > 0.0 ?
+    std::floor((z - filter_origin_z_) / filter_z_resolution_) : 0.0;
+  if (!(std::abs(cx) < cell_limit && std::abs(cy) < cell_limit && std::abs(cz) < cell_limit)) {
+    return false;
+  }
+
+  const uint64_t mask = (1 << 21) - 1;
+  key = ((static_cast<uint64_t>(static_cast<int64_t>(cx)) & mask) << 42) |
+    ((static_cast<uint64_t>(static_cast<int64_t>(cy)) & mask) << 21) |
+    (static_cast<uint64_t>(static_cast<int64_t>(cz)) & mask);
+  return true;
+}
+
+void ObservationBuffer::setFrustumClearing(bool frustum_clearing)
+{
+  std::lock_guard<std::mutex> scratch_guard(scratch_lock_);
+  frustum_clearing_ = frustum_clearing;
+}
+
+void ObservationBuffer::setRecorder(std::shared_ptr<CostmapRecorder> recorder, uint32_t source)
+{
+  std::lock_guard<std::mutex> scratch_guard(scratch_lock_);
+  recorder_ = recorder;
+  recorder_source_ = source;
+}
+
 }  // namespace nav2_costmap_2d
@@ -0,0 +1,108 @@
+// Copyright (c) 2022 Samsung Research America
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "nav2_costmap_2d/observation_depth_image.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <vector>
+
+#include "sensor_msgs/point_cloud2_iterator.hpp"
+
+namespace nav2_costmap_2d
+{
+
+void ObservationDepthImage::reduce(
+  const Observation & observation, double angular_resolution, bool elevation,
+  Observation & reduced)
+{
+  const sensor_msgs::msg::PointCloud2 & cloud = *(observation.cloud_);
+  const double ox = observation.origin_.x;
+  const double oy = observation.origin_.y;
+  const double oz = observation.origin_.z;
+
+  // Bins cover azimuths of [-pi, pi), and elevations of [-pi / 2, pi / 2]
+  const double min_resolution = elevation ?
+    std::sqrt(2.0 * M_PI * M_PI / max_bins) : 2.0 * M_PI / max_bins;
+  const double resolution = std::max(angular_resolution, min_resolution);
+  const unsigned int azimuth_bins =
+    std::max(1, static_cast<int>(std::ceil(2.0 * M_PI / resolution)));
+  const unsigned int elevation_bins =
+    elevation ? static_cast<unsigned int>(std::ceil(M_PI / resolution)) + 1 : 1;
+  const unsigned int bins = azimuth_bins * elevation_bins;
+  if (depths_.size() != bins) {
+    depths_.assign(bins, std::numeric_limits<float>::infinity());
+    points_.resize(bins);
+  }
+  filled_.clear();
+
+  sensor_msgs::PointCloud2ConstIterator<float> iter_x(cloud, "x");
+  sensor_msgs::PointCloud2ConstIterator<float> iter_y(cloud, "y");
+  sensor_msgs::PointCloud2ConstIterator<float> iter_z(cloud, "z");
+  for (unsigned int point = 0; iter_x != iter_x.end(); ++iter_x, ++iter_y, ++iter_z, ++point) {
+    const double dx = *iter_x - ox;
+    const double dy = *iter_y - oy;
+    const double planar = std::hypot(dx, dy);
+    unsigned int bin = std::min(
+      static_cast<unsigned int>((std::atan2(dy, dx) + M_PI) / resolution), azimuth_bins - 1);
+    double depth = planar;
+    if (elevation) {
+      const double dz = *iter_z - oz;
+      const unsigned int elevation_bin = std::min(
+        static_cast<unsigned int>((std::atan2(dz, planar) + M_PI / 2.0) / resolution),
+        elevation_bins - 1);
+      bin += elevation_bin * azimuth_bins;
+      depth = std::hypot(planar, dz);
+    }
+
+    float & bin_depth = depths_[bin];
+    if (bin_depth == std::numeric_limits<float>::infinity()) {
+      filled_.push_back(bin);
+    } else if (depth >= bin_depth) {
+      continue;
+    }
+    bin_depth = static_cast<float>(depth);
+    points_[bin] = point;
+  }
+
+  reduced.origin_ = observation.origin_;
+  reduced.obstacle_max_range_ = observation.obstacle_max_range_;
+  reduced.obstacle_min_range_ = observation.obstacle_min_range_;
+  reduced.raytrace_max_range_ = observation.raytrace_max_range_;
+  reduced.raytrace_min_range_ = observation.raytrace_min_range_;
+  reduced.frustum_clearing_ = false;
+
+  sensor_msgs::msg::PointCloud2 & reduced_cloud = *(reduced.cloud_);
+  reduced_cloud.header = cloud.header;
+  reduced_cloud.fields = cloud.fields;
+  reduced_cloud.is_bigendian = cloud.is_bigendian;
+  reduced_cloud.point_step = cloud.point_step;
+  reduced_cloud.is_dense = cloud.is_dense;
+  reduced_cloud.height = 1;
+  reduced_cloud.width = filled_.size();
+  reduced_cloud.row_step = reduced_cloud.width * cloud.point_step;
+  reduced_cloud.data.resize(reduced_cloud.row_step);
+
+  // Points are kept in the order of their bins, neighboring rays being traced in turn
+  std::sort(filled_.begin(), filled_.end());
+  auto reduced_data = reduced_cloud.data.begin();
+  for (const unsigned int & bin : filled_) {
+    auto point_data = cloud.data.begin() + points_[bin] * cloud.point_step;
+    reduced_data = std::copy(point_data, point_data + cloud.point_step, reduced_data);
+    depths_[bin] = std::numeric_limits<float>::infinity();
+  }
+}
+
+}  // namespace nav2_costmap_2d
@@ -0,0 +1,296 @@
+// Copyright (c) 2022 Samsung Research America
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "nav2_costmap_2d/shared_memory_costmap.hpp"
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <cerrno>
+#include <chrono>
+#include <cstring>
+#include <mutex>
+#include <new>
+#include <string>
+#include <thread>
+
+#include "rclcpp/rclcpp.hpp"
+
+namespace nav2_costmap_2d
+{
+
+namespace
+{
+
+// The costs start at a multiple of 8 bytes
+constexpr size_t costs_offset = (sizeof(SharedMemoryCostmapHeader) + 7) & ~size_t(7);
+
+// The steady clock is the monotonic clock of the host, the same in all its processes
+int64_t steadyNow()
+{
+  return std::chrono::duration_cast<std::chrono::nanoseconds>(
+    std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+}  // namespace
+
+std::string getSharedMemoryName(const std::string & topic_name)
+{
+  // Names are a single component, starting with a slash
+  std::string name = "/nav2";
+  if (topic_name.empty() || topic_name.front() != '/') {
+    name += '_';
+  }
+  name += topic_name;
+  std::replace(name.begin() + 1, name.end(), '/', '_');
+  return name;
+}
+
+SharedMemoryCostmapWriter::SharedMemoryCostmapWriter(const std::string & name)
+: name_(name)
+{
+}
+
+SharedMemoryCostmapWriter::~SharedMemoryCostmapWriter()
+{
+  removeRegion();
+}
+
+bool SharedMemoryCostmapWriter::createRegion(size_t capacity)
+{
+  removeRegion();
+
+  // The region replaced is left to its readers, which open the new one once it is invalid
+  shm_unlink(name_.c_str());
+  const int fd = shm_open(name_.c_str(), O_CREAT | O_EXCL | O_RDWR, 0644);
+  if (fd < 0) {
+    RCLCPP_ERROR(
+      rclcpp::get_logger("nav2_costmap_2d"),
+      "Failed to create the shared memory costmap %s: %s", name_.c_str(), strerror(errno));
+    return false;
+  }
+
+  const size_t size = costs_offset + capacity;
+  void * region = MAP_FAILED;
+  if (ftruncate(fd, static_cast<off_t>(size)) == 0) {
+    region = mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+  }
+  close(fd);
+  if (region == MAP_FAILED) {
+    RCLCPP_ERROR(
+      rclcpp::get_logger("nav2_costmap_2d"),
+      "Failed to map the shared memory costmap %s: %s", name_.c_str(), strerror(errno));
+    shm_unlink(name_.c_str());
+    return false;
+  }
+
+  header_ = new (region) SharedMemoryCostmapHeader();
+  header_->version = SharedMemoryCostmapHeader::VERSION;
+  header_->valid.store(1, std::memory_order_relaxed);
+  header_->sequence.store(0, std::memory_order_relaxed);
+  header_->heartbeat.store(steadyNow(), std::memory_order_relaxed);
+  header_->capacity = capacity;
+  header_->size_x = 0;
+  header_->size_y = 0;
+  header_->resolution = 0.0;
+  header_->origin_x = 0.0;
+  header_->origin_y = 0.0;
+  header_->magic.store(SharedMemoryCostmapHeader::MAGIC, std::memory_order_release);
+  costs_ = static_cast<unsigned char *>(region) + costs_offset;
+  region_size_ = size;
+  written_ = false;
+  return true;
+}
+
+void SharedMemoryCostmapWriter::removeRegion()
+{
+  if (header_ == nullptr) {
+    return;
+  }
+  header_->valid.store(0, std::memory_order_release);
+  munmap(header_, region_size_);
+  shm_unlink(name_.c_str());
+  header_ = nullptr;
+  costs_ = nullptr;
+  region_size_ = 0;
+}
+
+bool SharedMemoryCostmapWriter::update(LayeredCostmap & layered_costmap)
+{
+  Costmap2D * costmap = layered_costmap.getCostmap();
+  std::unique_lock<Costmap2D::mutex_t> lock(*(costmap->getMutex()));
+  const uint64_t update_count = layered_costmap.getUpdateCount();
+  if (written_ && update_count == update_count_) {
+    header_->heartbeat.store(steadyNow(), std::memory_order_release);
+    return true;
+  }
+
+  const unsigned int size_x = costmap->getSizeInCellsX();
+  const unsigned int size_y = costmap->getSizeInCellsY();
+  const size_t cells = static_cast<size_t>(size_x) * size_y;
+  if ((header_ == nullptr || cells > header_->capacity) && !createRegion(cells)) {
+    return false;
+  }
+
+  const bool full = !written_ || header_->size_x != size_x || header_->size_y != size_y ||
+    header_->resolution != costmap->getResolution() ||
+    header_->origin_x != costmap->getOriginX() || header_->origin_y != costmap->getOriginY() ||
+    !layered_costmap.getChangedWindows(update_count_, windows_);
+
+  const uint64_t sequence = header_->sequence.load(std::memory_order_relaxed);
+  header_->sequence.store(sequence + 1, std::memory_order_relaxed);
+  std::atomic_thread_fence(std::memory_order_release);
+
+  const unsigned char * master = costmap->getCharMap();
+  if (full) {
+    header_->size_x = size_x;
+    header_->size_y = size_y;
+    header_->resolution = costmap->getResolution();
+    header_->origin_x = costmap->getOriginX();
+    header_->origin_y = costmap->getOriginY();
+    std::memcpy(costs_, master, cells);
+  } else {
+    for (const auto & window : windows_) {
+      for (unsigned int y = window.y0; y < window.yn; ++y) {
+        const size_t row = static_cast<size_t>(y) * size_x;
+        std::memcpy(costs_ + row + window.x0, master + row + window.x0, window.xn - window.x0);
+      }
+    }
+  }
+
+  header_->sequence.store(sequence + 2, std::memory_order_release);
+  header_->heartbeat.store(steadyNow(), std::memory_order_release);
+  written_ = true;
+  update_count_ = update_count;
+  return true;
+}
+
+SharedMemoryCostmapReader::SharedMemoryCostmapReader(const std::string & name, double timeout)
+: name_(name),
+  timeout_(static_cast<int64_t>(timeout * 1e9))
+{
+}
+
+SharedMemoryCostmapReader::~SharedMemoryCostmapReader()
+{
+  closeRegion();
+}
+
+bool SharedMemoryCostmapReader::openRegion()
+{
+  const int fd = shm_open(name_.c_str(), O_RDONLY, 0);
+  if (fd < 0) {
+    return false;
+  }
+
+  struct stat status;
+  void * region = MAP_FAILED;
+  if (fstat(fd, &status) == 0 && static_cast<size_t>(status.st_size) >= costs_offset) {
+    region = mmap(nullptr, status.st_size, PROT_READ, MAP_SHARED, fd, 0);
+  }
+  close(fd);
+  if (region == MAP_FAILED) {
+    return false;
+  }
+
+  auto header = static_cast<const SharedMemoryCostmapHeader *>(region);
+  if (header->magic.load(std::memory_order_acquire) != SharedMemoryCostmapHeader::MAGIC ||
+    header->version != SharedMemoryCostmapHeader::VERSION ||
+    costs_offset + header->capacity > static_cast<size_t>(status.st_size))
+  {
+    munmap(region, status.st_size);
+    return false;
+  }
+
+  header_ = header;
+  region_size_ = status.st_size;
+  // Never a sequence of a written region, so that its first costmap is copied
+  sequence_ = 1;
+  return true;
+}
+
+void SharedMemoryCostmapReader::closeRegion()
+{
+  if (header_ == nullptr) {
+    return;
+  }
+  munmap(const_cast<SharedMemoryCostmapHeader *>(header_), region_size_);
+  header_ = nullptr;
+  region_size_ = 0;
+}
+
+bool SharedMemoryCostmapReader::read(Costmap2D & costmap, bool & changed)
+{
+  changed = false;
+  if (header_ != nullptr && header_->valid.load(std::memory_order_acquire) == 0) {
+    closeRegion();
+  }
+  if (header_ == nullptr && !openRegion()) {
+    return false;
+  }
+  if (timeout_ > 0 &&
+    steadyNow() - header_->heartbeat.load(std::memory_order_acquire) > timeout_)
+  {
+    // Closed so that the region of a writer started again is opened instead
+    closeRegion();
+    return false;
+  }
+
+  const unsigned char * costs = reinterpret_cast<const unsigned char *>(header_) + costs_offset;
+  for (unsigned int attempt = 0; attempt < max_attempts_; ++attempt) {
+    const uint64_t sequence = header_->sequence.load(std::memory_order_acquire);
+    if (sequence == 0) {
+      // Nothing written yet
+      return false;
+    }
+    if (sequence & 1) {
+      std::this_thread::yield();
+      continue;
+    }
+    if (sequence == sequence_) {
+      return true;
+    }
+
+    const unsigned int size_x = header_->size_x;
+    const unsigned int size_y = header_->size_y;
+    const double resolution = header_->resolution;
+    const double origin_x = header_->origin_x;
+    const double origin_y = header_->origin_y;
+    const size_t cells = static_cast<size_t>(size_x) * size_y;
+    if (cells > header_->capacity) {
+      continue;
+    }
+
+    if (costmap.getSizeInCellsX() != size_x || costmap.getSizeInCellsY() != size_y ||
+      costmap.getResolution() != resolution || costmap.getOriginX() != origin_x ||
+      costmap.getOriginY() != origin_y)
+    {
+      costmap.resizeMap(size_x, size_y, resolution, origin_x, origin_y);
+    }
+    std::memcpy(costmap.getCharMap(), costs, cells);
+
+    std::atomic_thread_fence(std::memory_order_acquire);
+    if (header_->sequence.load(std::memory_order_relaxed) == sequence) {
+      sequence_ = sequence;
+      changed = true;
+      return true;
+    }
+  }
+  return false;
+}
+
+}  // namespace nav2_costmap_2d
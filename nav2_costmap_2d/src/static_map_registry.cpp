@@ -0,0 +1,69 @@
+// Copyright (c) 2022 Samsung Research America
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "nav2_costmap_2d/static_map_registry.hpp"
+
+#include <memory>
+#include <string>
+
+namespace nav2_costmap_2d
+{
+
+StaticMapRegistry & StaticMapRegistry::getInstance()
+{
+  // Never destroyed, as costs may be released by static objects
+  static StaticMapRegistry * registry = new StaticMapRegistry();
+  return *registry;
+}
+
+std::shared_ptr<const Costmap2D> StaticMapRegistry::getCosts(
+  const std::string & topic_name, const nav_msgs::msg::OccupancyGrid & map,
+  const std::array<unsigned char, 256> & value_costs)
+{
+  // Held while the costs are built, so that layers receiving the map at once build them once
+  std::lock_guard<std::mutex> lock(mutex_);
+
+  // Maps are told apart by their header and metadata, as received by all subscribers
+  auto range = maps_.equal_range(topic_name);
+  for (auto it = range.first; it != range.second; ) {
+    std::shared_ptr<const Costmap2D> costs = it->second.costs.lock();
+    if (!costs) {
+      it = maps_.erase(it);
+      continue;
+    }
+    const Entry & entry = it->second;
+    if (entry.stamp == map.header.stamp && entry.info == map.info &&
+      entry.frame_id == map.header.frame_id && entry.value_costs == value_costs)
+    {
+      return costs;
+    }
+    ++it;
+  }
+
+  auto costs = std::make_shared<Costmap2D>(
+    map.info.width, map.info.height, map.info.resolution,
+    map.info.origin.position.x, map.info.origin.position.y);
+  const size_t size = static_cast<size_t>(map.info.width) * map.info.height;
+  const unsigned char * data = reinterpret_cast<const unsigned char *>(map.data.data());
+  unsigned char * cells = costs->getCharMap();
+  for (size_t index = 0; index < size; ++index) {
+    cells[index] = value_costs[data[index]];
+  }
+
+  maps_.emplace(
+    topic_name, Entry{map.header.stamp, map.info, map.header.frame_id, value_costs, costs});
+  return costs;
+}
+
+}  // namespace nav2_costmap_2d
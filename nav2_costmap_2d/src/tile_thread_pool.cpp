@@ -0,0 +1,105 @@
+// Copyright (c) 2022 Samsung Research America
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "nav2_costmap_2d/tile_thread_pool.hpp"
+
+namespace nav2_costmap_2d
+{
+
+TileThreadPool::TileThreadPool(unsigned int threads)
+{
+  for (unsigned int i = 1; i < threads; ++i) {
+    workers_.emplace_back(&TileThreadPool::workerLoop, this);
+  }
+}
+
+TileThreadPool::~TileThreadPool()
+{
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    stop_ = true;
+  }
+  start_cv_.notify_all();
+  for (auto & worker : workers_) {
+    worker.join();
+  }
+}
+
+void TileThreadPool::run(unsigned int count, const std::function<void(unsigned int)> & task)
+{
+  if (count == 0) {
+    return;
+  }
+
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    task_ = &task;
+    count_ = count;
+    next_.store(0);
+    error_ = nullptr;
+    active_ = workers_.size();
+    generation_++;
+  }
+  start_cv_.notify_all();
+
+  work();
+
+  std::unique_lock<std::mutex> lock(mutex_);
+  done_cv_.wait(lock, [this]() {return active_ == 0;});
+  task_ = nullptr;
+  if (error_) {
+    std::exception_ptr error = error_;
+    error_ = nullptr;
+    std::rethrow_exception(error);
+  }
+}
+
+void TileThreadPool::work()
+{
+  for (unsigned int i = next_++; i < count_; i = next_++) {
+    try {
+      (*task_)(i);
+    } catch (...) {
+      std::lock_guard<std::mutex> lock(mutex_);
+      if (!error_) {
+        error_ = std::current_exception();
+      }
+    }
+  }
+}
+
+void TileThreadPool::workerLoop()
+{
+  unsigned int generation = 0;
+  while (true) {
+    {
+      std::unique_lock<std::mutex> lock(mutex_);
+      start_cv_.wait(lock, [&]() {return stop_ || generation_ != generation;});
+      if (stop_) {
+        return;
+      }
+      generation = generation_;
+    }
+
+    work();
+
+    {
+      std::lock_guard<std::mutex> lock(mutex_);
+      active_--;
+    }
+    done_cv_.notify_one();
+  }
+}
+
+}  // namespace nav2_costmap_2d
@@ -0,0 +1,122 @@
+// Copyright (c) 2022 Samsung Research America
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License. Reserved.
+
+// Compares the combination kernels of CostmapLayer against the cell by cell loops
+// they replaced, combining a layer into a master grid of random costs.
+// Usage: benchmark_combination_kernels [map size in cells] [number of trials]
+
+#include <chrono>
+#include <cstdlib>
+#include <functional>
+#include <iostream>
+#include <random>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "nav2_costmap_2d/combination_kernels.hpp"
+#include "nav2_costmap_2d/cost_values.hpp"
+
+using namespace std::chrono;  // NOLINT
+using nav2_costmap_2d::NO_INFORMATION;
+using nav2_costmap_2d::INSCRIBED_INFLATED_OBSTACLE;
+
+typedef std::function<void (unsigned char *, const unsigned char *, unsigned int)> Kernel;
+
+void scalarMax(unsigned char * master, const unsigned char * layer, unsigned int size)
+{
+  for (unsigned int i = 0; i < size; ++i) {
+    if (layer[i] == NO_INFORMATION) {
+      continue;
+    }
+    if (master[i] == NO_INFORMATION || master[i] < layer[i]) {
+      master[i] = layer[i];
+    }
+  }
+}
+
+void scalarOverwrite(unsigned char * master, const unsigned char * layer, unsigned int size)
+{
+  for (unsigned int i = 0; i < size; ++i) {
+    if (layer[i] != NO_INFORMATION) {
+      master[i] = layer[i];
+    }
+  }
+}
+
+void scalarAddition(unsigned char * master, const unsigned char * layer, unsigned int size)
+{
+  for (unsigned int i = 0; i < size; ++i) {
+    if (layer[i] == NO_INFORMATION) {
+      continue;
+    }
+    if (master[i] == NO_INFORMATION) {
+      master[i] = layer[i];
+    } else {
+      int sum = master[i] + layer[i];
+      master[i] = sum >= INSCRIBED_INFLATED_OBSTACLE ? INSCRIBED_INFLATED_OBSTACLE - 1 : sum;
+    }
+  }
+}
+
+double runBenchmark(
+  const Kernel & kernel, const std::vector<unsigned char> & master,
+  const std::vector<unsigned char> & layer, const unsigned int & size,
+  const unsigned int & trials)
+{
+  std::vector<unsigned char> grid;
+  double total_time = 0.0;
+  for (unsigned int i = 0; i != trials; i++) {
+    grid = master;
+    steady_clock::time_point a = steady_clock::now();
+    for (unsigned int j = 0; j != size; j++) {
+      kernel(grid.data() + j * size, layer.data() + j * size, size);
+    }
+    steady_clock::time_point b = steady_clock::now();
+    total_time += duration_cast<duration<double>>(b - a).count();
+  }
+  return total_time * 1000.0 / trials;
+}
+
+int main(int argc, char ** argv)
+{
+  const unsigned int size = argc > 1 ? std::atoi(argv[1]) : 2000;
+  const unsigned int trials = argc > 2 ? std::atoi(argv[2]) : 50;
+
+  // Mostly free space with obstacles and unknown space, as a layer of a real map
+  std::mt19937 generator(0);
+  std::vector<unsigned char> master(size * size), layer(size * size);
+  for (unsigned int i = 0; i != size * size; i++) {
+    master[i] = generator() % 10 == 0 ? generator() % 256 : 0;
+    const unsigned int kind = generator() % 10;
+    layer[i] = kind == 0 ? NO_INFORMATION : (kind == 1 ? generator() % 256 : 0);
+  }
+
+  std::cout << "Combining a " << size << "x" << size << " layer with " <<
+    nav2_costmap_2d::getCombinationKernelsInstructionSet() << " kernels" << std::endl;
+
+  const std::vector<std::pair<std::string, std::pair<Kernel, Kernel>>> kernels = {
+    {"max", {scalarMax, nav2_costmap_2d::combineWithMax}},
+    {"overwrite", {scalarOverwrite, nav2_costmap_2d::combineWithOverwrite}},
+    {"addition", {scalarAddition, nav2_costmap_2d::combineWithAddition}}};
+
+  for (const auto & kernel : kernels) {
+    const double scalar_time = runBenchmark(kernel.second.first, master, layer, size, trials);
+    const double vector_time = runBenchmark(kernel.second.second, master, layer, size, trials);
+    std::cout << kernel.first << ": cell by cell " << scalar_time << " ms, kernel " <<
+      vector_time << " ms, speedup " << scalar_time / vector_time << "x" << std::endl;
+  }
+
+  return 0;
+}
@@ -0,0 +1,366 @@
+// Copyright (c) 2022 Samsung Research America
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License. Reserved.
+
+// Times the updateBounds() and updateCosts() of each layer of a LayeredCostmap with the
+// static, obstacle, voxel and inflation layers and the keepout filter, and its update cycles,
+// replaying observations across map sizes and resolutions. Observations are read from a
+// file derived from a bag, one per line and in the costmap frame, as either
+//   cloud <origin x> <origin y> <origin z> <x> <y> <z> [<x> <y> <z> ...]
+//   scan <x> <y> <z> <yaw> <angle min> <angle increment> <range> [<range> ...]
+// or else simulated as a scan of a robot driving a loop.
+// Usage: benchmark_costmap_layers [observations file] [number of cycles]
+
+#include <chrono>
+#include <cmath>
+#include <cstdlib>
+#include <fstream>
+#include <iostream>
+#include <memory>
+#include <random>
+#include <sstream>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "rclcpp/rclcpp.hpp"
+#include "nav_msgs/msg/occupancy_grid.hpp"
+#include "nav2_msgs/msg/costmap_filter_info.hpp"
+#include "sensor_msgs/point_cloud2_iterator.hpp"
+#include "tf2_ros/buffer.h"
+#include "nav2_util/lifecycle_node.hpp"
+#include "nav2_costmap_2d/layered_costmap.hpp"
+#include "nav2_costmap_2d/static_layer.hpp"
+#include "nav2_costmap_2d/obstacle_layer.hpp"
+#include "nav2_costmap_2d/voxel_layer.hpp"
+#include "nav2_costmap_2d/inflation_layer.hpp"
+#include "nav2_costmap_2d/costmap_filters/keepout_filter.hpp"
+
+using namespace std::chrono;  // NOLINT
+
+// Forwards to a layer, timing its updateBounds() and updateCosts()
+class TimedLayer : public nav2_costmap_2d::Layer
+{
+public:
+  explicit TimedLayer(std::shared_ptr<nav2_costmap_2d::Layer> layer)
+  : layer_(layer), bounds_time_(0.0), costs_time_(0.0)
+  {
+    name_ = layer->getName();
+  }
+
+  void reset() override {layer_->reset();}
+  bool isClearable() override {return layer_->isClearable();}
+  void activate() override {layer_->activate();}
+  void deactivate() override {layer_->deactivate();}
+  void matchSize() override {layer_->matchSize();}
+  void onFootprintChanged() override {layer_->onFootprintChanged();}
+  bool isTileSafe() override {return layer_->isTileSafe();}
+  unsigned int getTileHalo() override {return layer_->getTileHalo();}
+
+  void updateBounds(
+    double robot_x, double robot_y, double robot_yaw,
+    double * min_x, double * min_y, double * max_x, double * max_y) override
+  {
+    steady_clock::time_point a = steady_clock::now();
+    layer_->updateBounds(robot_x, robot_y, robot_yaw, min_x, min_y, max_x, max_y);
+    bounds_time_ += duration_cast<duration<double>>(steady_clock::now() - a).count();
+  }
+
+  void updateCosts(
+    nav2_costmap_2d::Costmap2D & master_grid,
+    int min_i, int min_j, int max_i, int max_j) override
+  {
+    steady_clock::time_point a = steady_clock::now();
+    layer_->updateCosts(master_grid, min_i, min_j, max_i, max_j);
+    costs_time_ += duration_cast<duration<double>>(steady_clock::now() - a).count();
+  }
+
+  // A tiled update is timed from its beginning to its end, over all of its tiles
+  void beginTiledUpdate(
+    nav2_costmap_2d::Costmap2D & master_grid,
+    int min_i, int min_j, int max_i, int max_j) override
+  {
+    tiled_update_start_ = steady_clock::now();
+    layer_->beginTiledUpdate(master_grid, min_i, min_j, max_i, max_j);
+  }
+
+  void updateCostsTile(
+    nav2_costmap_2d::Costmap2D & master_grid,
+    int min_i, int min_j, int max_i, int max_j) override
+  {
+    layer_->updateCostsTile(master_grid, min_i, min_j, max_i, max_j);
+  }
+
+  void endTiledUpdate() override
+  {
+    layer_->endTiledUpdate();
+    costs_time_ +=
+      duration_cast<duration<double>>(steady_clock::now() - tiled_update_start_).count();
+  }
+
+  void resetTimes()
+  {
+    bounds_time_ = 0.0;
+    costs_time_ = 0.0;
+  }
+
+  double getBoundsTime() const {return bounds_time_;}
+  double getCostsTime() const {return costs_time_;}
+
+protected:
+  std::shared_ptr<nav2_costmap_2d::Layer> layer_;
+  double bounds_time_;
+  double costs_time_;
+  steady_clock::time_point tiled_update_start_;
+};
+
+struct ObservationRecord
+{
+  geometry_msgs::msg::Point origin;
+  double yaw;
+  std::vector<geometry_msgs::msg::Point> points;
+};
+
+std::vector<ObservationRecord> readObservations(const std::string & file_name)
+{
+  std::vector<ObservationRecord> observations;
+  std::ifstream file(file_name);
+  std::string line, type;
+  while (std::getline(file, line)) {
+    std::istringstream stream(line);
+    ObservationRecord observation;
+    stream >> type >> observation.origin.x >> observation.origin.y >> observation.origin.z;
+    observation.yaw = 0.0;
+    if (type == "cloud") {
+      geometry_msgs::msg::Point point;
+      while (stream >> point.x >> point.y >> point.z) {
+        observation.points.push_back(point);
+      }
+    } else if (type == "scan") {
+      double angle, angle_increment, range;
+      stream >> observation.yaw >> angle >> angle_increment;
+      while (stream >> range) {
+        if (std::isfinite(range)) {
+          geometry_msgs::msg::Point point;
+          point.x = observation.origin.x + range * std::cos(observation.yaw + angle);
+          point.y = observation.origin.y + range * std::sin(observation.yaw + angle);
+          point.z = observation.origin.z;
+          observation.points.push_back(point);
+        }
+        angle += angle_increment;
+      }
+    } else {
+      continue;
+    }
+    observations.push_back(observation);
+  }
+  return observations;
+}
+
+// Scans of a robot driving a loop in a room with moving obstacles around it
+std::vector<ObservationRecord> simulateObservations(const unsigned int & cycles)
+{
+  std::vector<ObservationRecord> observations;
+  std::mt19937 generator(0);
+  std::normal_distribution<double> noise(0.0, 0.02);
+  for (unsigned int i = 0; i != cycles; i++) {
+    const double t = 2.0 * M_PI * i / cycles;
+    ObservationRecord observation;
+    observation.origin.x = 5.0 * std::cos(t);
+    observation.origin.y = 5.0 * std::sin(t);
+    observation.origin.z = 0.5;
+    observation.yaw = t + M_PI_2;
+    for (unsigned int j = 0; j != 720; j++) {
+      const double angle = j * M_PI / 360.0;
+      const double range = 3.0 + std::sin(5.0 * angle + 3.0 * t) + noise(generator);
+      geometry_msgs::msg::Point point;
+      point.x = observation.origin.x + range * std::cos(observation.yaw + angle);
+      point.y = observation.origin.y + range * std::sin(observation.yaw + angle);
+      point.z = observation.origin.z;
+      observation.points.push_back(point);
+    }
+    observations.push_back(observation);
+  }
+  return observations;
+}
+
+nav2_costmap_2d::Observation toObservation(ObservationRecord & record)
+{
+  sensor_msgs::msg::PointCloud2 cloud;
+  sensor_msgs::PointCloud2Modifier modifier(cloud);
+  modifier.setPointCloud2FieldsByString(1, "xyz");
+  modifier.resize(record.points.size());
+  sensor_msgs::PointCloud2Iterator<float> iter_x(cloud, "x");
+  sensor_msgs::PointCloud2Iterator<float> iter_y(cloud, "y");
+  sensor_msgs::PointCloud2Iterator<float> iter_z(cloud, "z");
+  for (const auto & point : record.points) {
+    *iter_x = point.x;
+    *iter_y = point.y;
+    *iter_z = point.z;
+    ++iter_x;
+    ++iter_y;
+    ++iter_z;
+  }
+  return nav2_costmap_2d::Observation(record.origin, cloud, 5.0, 0.0, 6.0, 0.0);
+}
+
+// A map of rooms separated by walls with doors, and a mask with a keepout zone in each room
+void makeMaps(
+  const double & size, const double & resolution,
+  nav_msgs::msg::OccupancyGrid & map, nav_msgs::msg::OccupancyGrid & mask)
+{
+  map.header.frame_id = "map";
+  map.info.resolution = resolution;
+  map.info.width = static_cast<unsigned int>(size / resolution);
+  map.info.height = map.info.width;
+  map.info.origin.position.x = -size / 2.0;
+  map.info.origin.position.y = -size / 2.0;
+  map.info.origin.orientation.w = 1.0;
+  map.data.assign(map.info.width * map.info.height, 0);
+  mask = map;
+
+  const unsigned int room = static_cast<unsigned int>(4.0 / resolution);
+  const unsigned int door = room / 4;
+  for (unsigned int j = 0; j != map.info.height; j++) {
+    for (unsigned int i = 0; i != map.info.width; i++) {
+      const unsigned int ri = i % room, rj = j % room;
+      if ((ri == 0 && rj > door) || (rj == 0 && ri > door)) {
+        map.data[i + j * map.info.width] = 100;
+      }
+      if (ri > room * 3 / 4 && rj > room * 3 / 4) {
+        mask.data[i + j * mask.info.width] = 100;
+      }
+    }
+  }
+}
+
+template<typename MessageT>
+typename rclcpp::Publisher<MessageT>::SharedPtr publishLatched(
+  rclcpp::Node::SharedPtr node, const std::string & topic, const MessageT & message)
+{
+  auto publisher = node->create_publisher<MessageT>(
+    topic, rclcpp::QoS(rclcpp::KeepLast(1)).transient_local().reliable());
+  publisher->publish(message);
+  return publisher;
+}
+
+void runBenchmark(
+  const double & size, const double & resolution,
+  std::vector<ObservationRecord> & observations)
+{
+  auto node = std::make_shared<nav2_util::LifecycleNode>("benchmark_costmap_layers");
+  auto publisher_node = std::make_shared<rclcpp::Node>("benchmark_costmap_publisher");
+  node->declare_parameter("map_topic", rclcpp::ParameterValue(std::string("map")));
+  node->declare_parameter("track_unknown_space", rclcpp::ParameterValue(false));
+  node->declare_parameter("use_maximum", rclcpp::ParameterValue(false));
+  node->declare_parameter("lethal_cost_threshold", rclcpp::ParameterValue(100));
+  node->declare_parameter(
+    "unknown_cost_value", rclcpp::ParameterValue(static_cast<unsigned char>(0xff)));
+  node->declare_parameter("trinary_costmap", rclcpp::ParameterValue(true));
+  node->declare_parameter("transform_tolerance", rclcpp::ParameterValue(0.3));
+  node->declare_parameter("observation_sources", rclcpp::ParameterValue(std::string("")));
+  node->declare_parameter(
+    "keepout.filter_info_topic", rclcpp::ParameterValue(std::string("filter_info")));
+
+  nav_msgs::msg::OccupancyGrid map, mask;
+  makeMaps(size, resolution, map, mask);
+  nav2_msgs::msg::CostmapFilterInfo info;
+  info.type = 0;
+  info.filter_mask_topic = "mask";
+  info.base = 0.0;
+  info.multiplier = 1.0;
+  auto map_publisher = publishLatched(publisher_node, "map", map);
+  auto mask_publisher = publishLatched(publisher_node, "mask", mask);
+  auto info_publisher = publishLatched(publisher_node, "filter_info", info);
+
+  tf2_ros::Buffer tf(node->get_clock());
+  nav2_costmap_2d::LayeredCostmap layers("map", false, false);
+  std::vector<std::shared_ptr<TimedLayer>> timed_layers;
+  auto addLayer = [&](std::shared_ptr<nav2_costmap_2d::Layer> layer, const std::string & name,
+      const bool & filter) {
+      layer->initialize(&layers, name, &tf, node, nullptr, nullptr);
+      timed_layers.push_back(std::make_shared<TimedLayer>(layer));
+      if (filter) {
+        layers.addFilter(timed_layers.back());
+      } else {
+        layers.addPlugin(timed_layers.back());
+      }
+    };
+  addLayer(std::make_shared<nav2_costmap_2d::StaticLayer>(), "static", false);
+  auto obstacle_layer = std::make_shared<nav2_costmap_2d::ObstacleLayer>();
+  addLayer(obstacle_layer, "obstacles", false);
+  auto voxel_layer = std::make_shared<nav2_costmap_2d::VoxelLayer>();
+  addLayer(voxel_layer, "voxels", false);
+  addLayer(std::make_shared<nav2_costmap_2d::InflationLayer>(), "inflation", false);
+  auto keepout_filter = std::make_shared<nav2_costmap_2d::KeepoutFilter>();
+  addLayer(keepout_filter, "keepout", true);
+
+  // The static layer resizes the costmap to the map once received
+  steady_clock::time_point start = steady_clock::now();
+  while ((layers.getCostmap()->getSizeInCellsX() != map.info.width ||
+    !keepout_filter->isActive()) && steady_clock::now() - start < 5s)
+  {
+    rclcpp::spin_some(publisher_node);
+    rclcpp::spin_some(node->get_node_base_interface());
+    layers.updateMap(0.0, 0.0, 0.0);
+  }
+  for (auto & timed_layer : timed_layers) {
+    timed_layer->resetTimes();
+  }
+
+  steady_clock::time_point a = steady_clock::now();
+  for (auto & record : observations) {
+    nav2_costmap_2d::Observation observation = toObservation(record);
+    obstacle_layer->clearStaticObservations(true, true);
+    obstacle_layer->addStaticObservation(observation, true, true);
+    voxel_layer->clearStaticObservations(true, true);
+    voxel_layer->addStaticObservation(observation, true, true);
+    layers.updateMap(record.origin.x, record.origin.y, record.yaw);
+  }
+  const double total_time = duration_cast<duration<double>>(steady_clock::now() - a).count();
+
+  std::cout << size << " m at " << resolution << " m (" << map.info.width << "x" <<
+    map.info.height << " cells), " << observations.size() << " cycles:" << std::endl;
+  for (const auto & timed_layer : timed_layers) {
+    std::cout << "  " << timed_layer->getName() << ": updateBounds " <<
+      timed_layer->getBoundsTime() * 1000.0 / observations.size() << " ms, updateCosts " <<
+      timed_layer->getCostsTime() * 1000.0 / observations.size() << " ms" << std::endl;
+  }
+  std::cout << "  cycle: " << total_time * 1000.0 / observations.size() << " ms, " <<
+    observations.size() / total_time << " cycles/sec" << std::endl;
+}
+
+int main(int argc, char ** argv)
+{
+  rclcpp::init(0, nullptr);
+  const unsigned int cycles = argc > 2 ? std::atoi(argv[2]) : 100;
+  std::vector<ObservationRecord> observations = argc > 1 ?
+    readObservations(argv[1]) : simulateObservations(cycles);
+  if (observations.size() > cycles) {
+    observations.resize(cycles);
+  }
+  if (observations.empty()) {
+    std::cerr << "No observations read from " << argv[1] << std::endl;
+    rclcpp::shutdown();
+    return 1;
+  }
+
+  for (const double & size : {20.0, 50.0, 100.0}) {
+    for (const double & resolution : {0.1, 0.05}) {
+      runBenchmark(size, resolution, observations);
+    }
+  }
+
+  rclcpp::shutdown();
+  return 0;
+}
@@ -0,0 +1,145 @@
+// Copyright (c) 2022 Samsung Research America
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License. Reserved.
+
+// Compares the swept footprint check of FootprintCollisionChecker against checking the
+// poses one by one, as the collision lookahead of RPP did, on arcs of a costmap with
+// sparse obstacles.
+// Usage: benchmark_footprint_sweep [poses per arc] [number of arcs] [pyramid levels]
+
+#include <chrono>
+#include <cmath>
+#include <cstdlib>
+#include <iostream>
+#include <memory>
+#include <random>
+#include <vector>
+
+#include "nav2_costmap_2d/cost_values.hpp"
+#include "nav2_costmap_2d/costmap_2d.hpp"
+#include "nav2_costmap_2d/costmap_pyramid.hpp"
+#include "nav2_costmap_2d/footprint_collision_checker.hpp"
+
+using namespace std::chrono;  // NOLINT
+using nav2_costmap_2d::LETHAL_OBSTACLE;
+
+typedef nav2_costmap_2d::FootprintCollisionChecker<nav2_costmap_2d::Costmap2D *> Checker;
+typedef std::vector<geometry_msgs::msg::Pose2D> Arc;
+
+size_t firstCollisionPoseByPose(
+  Checker & checker, const Arc & arc, const nav2_costmap_2d::Footprint & footprint)
+{
+  for (size_t i = 0; i < arc.size(); ++i) {
+    if (checker.footprintCostAtPose(arc[i].x, arc[i].y, arc[i].theta, footprint) >=
+      LETHAL_OBSTACLE)
+    {
+      return i;
+    }
+  }
+  return arc.size();
+}
+
+int main(int argc, char ** argv)
+{
+  const unsigned int num_poses = argc > 1 ? std::atoi(argv[1]) : 100;
+  const unsigned int num_arcs = argc > 2 ? std::atoi(argv[2]) : 20000;
+  const unsigned int levels = argc > 3 ? std::atoi(argv[3]) : 4;
+  const unsigned int num_obstacles = argc > 4 ? std::atoi(argv[4]) : 100;
+
+  // A 20 m costmap at 5 cm, mostly free with scattered lethal cells and inflation
+  const unsigned int size = 400;
+  nav2_costmap_2d::Costmap2D costmap(size, size, 0.05, 0.0, 0.0);
+  std::mt19937 generator(0);
+  for (unsigned int i = 0; i < num_obstacles; ++i) {
+    const unsigned int x = generator() % size;
+    const unsigned int y = generator() % size;
+    for (unsigned int dy = 0; dy < 5; ++dy) {
+      for (unsigned int dx = 0; dx < 5; ++dx) {
+        if (x + dx < size && y + dy < size) {
+          costmap.setCost(x + dx, y + dy, dx == 2 && dy == 2 ? LETHAL_OBSTACLE : 100);
+        }
+      }
+    }
+  }
+
+  nav2_costmap_2d::CostmapPyramid pyramid;
+  pyramid.setLevels(levels);
+  pyramid.update(costmap, 0, 0, size, size);
+
+  nav2_costmap_2d::Footprint footprint;
+  for (const auto & vertex : std::vector<std::pair<double, double>>{
+      {0.35, 0.25}, {-0.35, 0.25}, {-0.35, -0.25}, {0.35, -0.25}})
+  {
+    geometry_msgs::msg::Point point;
+    point.x = vertex.first;
+    point.y = vertex.second;
+    footprint.push_back(point);
+  }
+
+  // Arcs of one costmap cell per step, as projected by RPP
+  std::uniform_real_distribution<double> position(2.0, 18.0), heading(-M_PI, M_PI);
+  std::uniform_real_distribution<double> curvature(-1.0, 1.0);
+  std::vector<Arc> arcs(num_arcs);
+  for (auto & arc : arcs) {
+    geometry_msgs::msg::Pose2D pose;
+    pose.x = position(generator);
+    pose.y = position(generator);
+    pose.theta = heading(generator);
+    const double k = curvature(generator);
+    for (unsigned int i = 0; i < num_poses; ++i) {
+      arc.push_back(pose);
+      pose.x += 0.05 * cos(pose.theta);
+      pose.y += 0.05 * sin(pose.theta);
+      pose.theta += 0.05 * k;
+    }
+  }
+
+  Checker outline_checker(&costmap), pyramid_checker(&costmap);
+  pyramid_checker.setCostmapPyramid(&pyramid);
+
+  auto run = [&](const char * name, auto check) {
+      std::vector<size_t> results(arcs.size());
+      steady_clock::time_point a = steady_clock::now();
+      for (size_t i = 0; i < arcs.size(); ++i) {
+        results[i] = check(arcs[i]);
+      }
+      steady_clock::time_point b = steady_clock::now();
+      std::cout << name << ": " <<
+        duration_cast<duration<double>>(b - a).count() * 1e6 / arcs.size() << " us per arc" <<
+        std::endl;
+      return results;
+    };
+
+  std::cout << "Checking " << num_arcs << " arcs of " << num_poses << " poses with " <<
+    levels << " pyramid levels" << std::endl;
+  const auto outline = run(
+    "pose by pose, outline", [&](const Arc & arc) {
+      return firstCollisionPoseByPose(outline_checker, arc, footprint);
+    });
+  const auto bounded = run(
+    "pose by pose, pyramid bounds", [&](const Arc & arc) {
+      return firstCollisionPoseByPose(pyramid_checker, arc, footprint);
+    });
+  const auto swept = run(
+    "swept", [&](const Arc & arc) {
+      return pyramid_checker.findFootprintCostAtPoses(arc, footprint, LETHAL_OBSTACLE);
+    });
+
+  size_t collisions = 0, mismatches = 0;
+  for (size_t i = 0; i < arcs.size(); ++i) {
+    collisions += outline[i] < num_poses;
+    mismatches += bounded[i] != outline[i] || swept[i] != outline[i];
+  }
+  std::cout << collisions << " arcs in collision, " << mismatches << " mismatches" << std::endl;
+  return mismatches == 0 ? 0 : 1;
+}
@@ -37,6 +37,7 @@
 #include <map>
 #include <memory>
 #include <string>
+#include <utility>
 #include <vector>
 
 #include "nav2_costmap_2d/costmap_2d.hpp"
@@ -602,6 +603,151 @@ TEST_F(TestNode, testInflation3)
   ASSERT_EQ(countValues(*costmap, nav2_costmap_2d::INSCRIBED_INFLATED_OBSTACLE), 4u);
 }
 
+/**
+ * Test that inflating in parallel tiles gives the same costs as a sequential update
+ */
+TEST_F(TestNode, testTiledInflation)
+{
+  initNode(3);
+  tf2_ros::Buffer tf(node_->get_clock());
+  nav2_costmap_2d::LayeredCostmap layers("frame", false, false);
+  nav2_costmap_2d::LayeredCostmap tiled_layers("frame", false, false);
+  layers.resizeMap(10, 10, 1, 0, 0);
+  tiled_layers.resizeMap(10, 10, 1, 0, 0);
+  // Tiles are smaller than the inflation radius, so they are grown to the halo
+  tiled_layers.setTiledUpdate(4, 2);
+
+  std::vector<Point> polygon = setRadii(layers, 1, 1.75);
+  setRadii(tiled_layers, 1, 1.75);
+
+  std::shared_ptr<nav2_costmap_2d::ObstacleLayer> olayer = nullptr;
+  addObstacleLayer(layers, tf, node_, olayer);
+  std::shared_ptr<nav2_costmap_2d::InflationLayer> ilayer = nullptr;
+  addInflationLayer(layers, tf, node_, ilayer);
+  layers.setFootprint(polygon);
+
+  std::shared_ptr<nav2_costmap_2d::ObstacleLayer> tiled_olayer = nullptr;
+  addObstacleLayer(tiled_layers, tf, node_, tiled_olayer);
+  std::shared_ptr<nav2_costmap_2d::InflationLayer> tiled_ilayer = nullptr;
+  addInflationLayer(tiled_layers, tf, node_, tiled_ilayer);
+  tiled_layers.setFootprint(polygon);
+
+  // Obstacles on tile borders and close enough for their inflation to overlap
+  for (const auto & obstacle : std::vector<std::pair<double, double>>{{2, 2}, {3, 3}, {6, 2},
+      {5, 7}, {9, 9}})
+  {
+    addObservation(olayer, obstacle.first, obstacle.second, MAX_Z, 0.0, 0.0, MAX_Z, true, false);
+    addObservation(
+      tiled_olayer, obstacle.first, obstacle.second, MAX_Z, 0.0, 0.0, MAX_Z, true, false);
+  }
+  layers.updateMap(0, 0, 0);
+  tiled_layers.updateMap(0, 0, 0);
+
+  nav2_costmap_2d::Costmap2D * costmap = layers.getCostmap();
+  nav2_costmap_2d::Costmap2D * tiled_costmap = tiled_layers.getCostmap();
+  ASSERT_EQ(countValues(*tiled_costmap, nav2_costmap_2d::LETHAL_OBSTACLE), 5u);
+  for (unsigned int j = 0; j < costmap->getSizeInCellsY(); ++j) {
+    for (unsigned int i = 0; i < costmap->getSizeInCellsX(); ++i) {
+      ASSERT_EQ(tiled_costmap->getCost(i, j), costmap->getCost(i, j));
+    }
+  }
+}
+
+/**
+ * Test inflation from the exact distance transform, starting with an empty map
+ */
+TEST_F(TestNode, testDistanceTransformInflation)
+{
+  std::vector<rclcpp::Parameter> parameters;
+  parameters.push_back(rclcpp::Parameter("inflation.cost_scaling_factor", 1.0));
+  parameters.push_back(rclcpp::Parameter("inflation.inflation_radius", 3.0));
+  parameters.push_back(rclcpp::Parameter("inflation.use_distance_transform", true));
+  initNode(parameters);
+  tf2_ros::Buffer tf(node_->get_clock());
+  nav2_costmap_2d::LayeredCostmap layers("frame", false, false);
+  layers.resizeMap(10, 10, 1, 0, 0);
+
+  std::vector<Point> polygon = setRadii(layers, 1, 1.75);
+
+  std::shared_ptr<nav2_costmap_2d::ObstacleLayer> olayer = nullptr;
+  addObstacleLayer(layers, tf, node_, olayer);
+
+  std::shared_ptr<nav2_costmap_2d::InflationLayer> ilayer = nullptr;
+  addInflationLayer(layers, tf, node_, ilayer);
+
+  layers.setFootprint(polygon);
+
+  // Add an obstacle at 5,5, which is inflated like the brushfire does in testInflation3
+  addObservation(olayer, 5, 5, MAX_Z);
+  layers.updateMap(0, 0, 0);
+
+  nav2_costmap_2d::Costmap2D * costmap = layers.getCostmap();
+  ASSERT_EQ(countValues(*costmap, nav2_costmap_2d::FREE_SPACE, false), 29u);
+  ASSERT_EQ(countValues(*costmap, nav2_costmap_2d::LETHAL_OBSTACLE), 1u);
+  ASSERT_EQ(countValues(*costmap, nav2_costmap_2d::INSCRIBED_INFLATED_OBSTACLE), 4u);
+  validatePointInflation(5, 5, costmap, ilayer, 3.0);
+
+  // Costs fall off with the exact Euclidean distance to the obstacle
+  ASSERT_EQ(costmap->getCost(5, 8), ilayer->computeCost(3.0));
+  ASSERT_EQ(costmap->getCost(7, 7), ilayer->computeCost(std::hypot(2.0, 2.0)));
+  ASSERT_EQ(costmap->getCost(8, 8), nav2_costmap_2d::FREE_SPACE);
+}
+
+/**
+ * Test that incremental inflation gives the same costs as re-inflating the window
+ */
+TEST_F(TestNode, testIncrementalInflation)
+{
+  std::vector<rclcpp::Parameter> parameters;
+  parameters.push_back(rclcpp::Parameter("inflation.cost_scaling_factor", 1.0));
+  parameters.push_back(rclcpp::Parameter("inflation.inflation_radius", 3.0));
+  parameters.push_back(rclcpp::Parameter("inflation.incremental_inflation", true));
+  initNode(parameters);
+  nav2_util::LifecycleNode::SharedPtr incremental_node = node_;
+  initNode(3);
+
+  tf2_ros::Buffer tf(node_->get_clock());
+  nav2_costmap_2d::LayeredCostmap layers("frame", false, false);
+  nav2_costmap_2d::LayeredCostmap incremental_layers("frame", false, false);
+  layers.resizeMap(10, 10, 1, 0, 0);
+  incremental_layers.resizeMap(10, 10, 1, 0, 0);
+
+  std::vector<Point> polygon = setRadii(layers, 1, 1.75);
+  setRadii(incremental_layers, 1, 1.75);
+
+  std::shared_ptr<nav2_costmap_2d::ObstacleLayer> olayer = nullptr;
+  addObstacleLayer(layers, tf, node_, olayer);
+  std::shared_ptr<nav2_costmap_2d::InflationLayer> ilayer = nullptr;
+  addInflationLayer(layers, tf, node_, ilayer);
+  layers.setFootprint(polygon);
+
+  std::shared_ptr<nav2_costmap_2d::ObstacleLayer> incremental_olayer = nullptr;
+  addObstacleLayer(incremental_layers, tf, incremental_node, incremental_olayer);
+  std::shared_ptr<nav2_costmap_2d::InflationLayer> incremental_ilayer = nullptr;
+  addInflationLayer(incremental_layers, tf, incremental_node, incremental_ilayer);
+  incremental_layers.setFootprint(polygon);
+
+  nav2_costmap_2d::Costmap2D * costmap = layers.getCostmap();
+  nav2_costmap_2d::Costmap2D * incremental_costmap = incremental_layers.getCostmap();
+
+  // Each update only re-inflates around the obstacle added since the last one
+  for (const auto & obstacle : std::vector<std::pair<double, double>>{{5, 5}, {2, 2}, {8, 1}}) {
+    addObservation(olayer, obstacle.first, obstacle.second, MAX_Z, 0.0, 0.0, MAX_Z, true, false);
+    addObservation(
+      incremental_olayer, obstacle.first, obstacle.second, MAX_Z, 0.0, 0.0, MAX_Z, true, false);
+    layers.updateMap(0, 0, 0);
+    incremental_layers.updateMap(0, 0, 0);
+
+    for (unsigned int j = 0; j < costmap->getSizeInCellsY(); ++j) {
+      for (unsigned int i = 0; i < costmap->getSizeInCellsX(); ++i) {
+        ASSERT_EQ(incremental_costmap->getCost(i, j), costmap->getCost(i, j));
+      }
+    }
+  }
+
+  ASSERT_EQ(countValues(*incremental_costmap, nav2_costmap_2d::LETHAL_OBSTACLE), 3u);
+}
+
 /**
  * Test dynamic parameter setting of inflation layer
  */
@@ -625,6 +771,8 @@ TEST_F(TestNode, testDynParamsSet)
     rclcpp::Parameter("inflation_layer.cost_scaling_factor", 0.0),
     rclcpp::Parameter("inflation_layer.inflate_unknown", true),
     rclcpp::Parameter("inflation_layer.inflate_around_unknown", true),
+    rclcpp::Parameter("inflation_layer.incremental_inflation", true),
+    rclcpp::Parameter("inflation_layer.use_distance_transform", true),
     rclcpp::Parameter("inflation_layer.enabled", false)
   });
 
@@ -636,6 +784,8 @@ TEST_F(TestNode, testDynParamsSet)
   EXPECT_EQ(costmap->get_parameter("inflation_layer.cost_scaling_factor").as_double(), 0.0);
   EXPECT_EQ(costmap->get_parameter("inflation_layer.inflate_unknown").as_bool(), true);
   EXPECT_EQ(costmap->get_parameter("inflation_layer.inflate_around_unknown").as_bool(), true);
+  EXPECT_EQ(costmap->get_parameter("inflation_layer.incremental_inflation").as_bool(), true);
+  EXPECT_EQ(costmap->get_parameter("inflation_layer.use_distance_transform").as_bool(), true);
   EXPECT_EQ(costmap->get_parameter("inflation_layer.enabled").as_bool(), false);
 
   costmap->on_deactivate(rclcpp_lifecycle::State());
@@ -32,15 +32,23 @@
  * Test harness for ObstacleLayer for Costmap2D
  */
 
+#include <chrono>
+#include <cmath>
+#include <cstring>
 #include <memory>
 #include <string>
 #include <algorithm>
+#include <thread>
 #include <utility>
+#include <vector>
 
 #include "gtest/gtest.h"
 #include "nav2_costmap_2d/costmap_2d.hpp"
+#include "nav2_costmap_2d/costmap_recorder.hpp"
+#include "nav2_costmap_2d/costmap_replay.hpp"
 #include "nav2_costmap_2d/layered_costmap.hpp"
 #include "nav2_costmap_2d/observation_buffer.hpp"
+#include "nav2_costmap_2d/voxel_layer.hpp"
 #include "../testing_helper.hpp"
 #include "nav2_costmap_2d/costmap_2d_ros.hpp"
 
@@ -278,6 +286,22 @@ TEST_F(TestNode, testZThreshold) {
   ASSERT_EQ(countValues(*costmap, nav2_costmap_2d::LETHAL_OBSTACLE), 1);
 }
 
+/**
+ * Verify that the memory of the layers follows the size of the costmap
+ */
+TEST_F(TestNode, testMemoryUsage) {
+  tf2_ros::Buffer tf(node_->get_clock());
+  nav2_costmap_2d::LayeredCostmap layers("frame", false, true);
+  layers.resizeMap(10, 10, 1, 0, 0);
+  auto olayer = addObstacleLayer(layers, tf, node_);
+  ASSERT_EQ(olayer->getMemoryUsage(), 100u);
+  ASSERT_GE(layers.getMemoryUsage(), 100u);
+
+  layers.resizeMap(20, 20, 1, 0, 0);
+  ASSERT_EQ(olayer->getMemoryUsage(), 400u);
+  ASSERT_GE(layers.getMemoryUsage(), 400u);
+}
+
 /**
  * Verify that dynamic obstacles are added
  */
@@ -408,6 +432,456 @@ TEST_F(TestNode, testRaytracing) {
   ASSERT_EQ(lethal_count, 1);
 }
 
+/**
+ * Test that dense clouds, with many points per endpoint cell, clear the same
+ * cells as a single point per endpoint cell
+ */
+TEST_F(TestNode, testRaytracingDuplicateEndpoints) {
+  tf2_ros::Buffer tf(node_->get_clock());
+
+  auto clear_with = [&](int points_per_cell) {
+      auto layers = std::make_shared<nav2_costmap_2d::LayeredCostmap>("frame", false, false);
+      layers->resizeMap(10, 10, 1, 0, 0);
+      std::shared_ptr<nav2_costmap_2d::ObstacleLayer> olayer = nullptr;
+      addObstacleLayer(*layers, tf, node_, olayer);
+
+      // A fan of rays from the middle of the map to its edges
+      sensor_msgs::msg::PointCloud2 cloud;
+      sensor_msgs::PointCloud2Modifier modifier(cloud);
+      modifier.setPointCloud2FieldsByString(1, "xyz");
+      modifier.resize(10 * points_per_cell);
+      sensor_msgs::PointCloud2Iterator<float> iter_x(cloud, "x");
+      sensor_msgs::PointCloud2Iterator<float> iter_y(cloud, "y");
+      sensor_msgs::PointCloud2Iterator<float> iter_z(cloud, "z");
+      for (int i = 0; i < 10; ++i) {
+        for (int j = 0; j < points_per_cell; ++j, ++iter_x, ++iter_y, ++iter_z) {
+          *iter_x = i + (j + 0.5) / points_per_cell;
+          *iter_y = 9.5;
+          *iter_z = MAX_Z / 2;
+        }
+      }
+
+      geometry_msgs::msg::Point p;
+      p.x = 5.5;
+      p.y = 0.5;
+      p.z = MAX_Z / 2;
+      nav2_costmap_2d::Observation obs(p, cloud, 100.0, 0.0, 100.0, 0.0);
+      olayer->addStaticObservation(obs, false, true);
+
+      for (unsigned int i = 0; i < olayer->getSizeInCellsX(); ++i) {
+        for (unsigned int j = 0; j < olayer->getSizeInCellsY(); ++j) {
+          olayer->setCost(i, j, nav2_costmap_2d::LETHAL_OBSTACLE);
+        }
+      }
+      layers->updateMap(0, 0, 0);
+      return std::make_pair(layers, olayer);
+    };
+
+  auto single = clear_with(1);
+  auto dense = clear_with(7);
+  std::shared_ptr<nav2_costmap_2d::ObstacleLayer> single_costmap = single.second;
+  std::shared_ptr<nav2_costmap_2d::ObstacleLayer> dense_costmap = dense.second;
+
+  ASSERT_GT(countValues(*single_costmap, nav2_costmap_2d::FREE_SPACE), 0);
+  for (unsigned int i = 0; i < single_costmap->getSizeInCellsX(); ++i) {
+    for (unsigned int j = 0; j < single_costmap->getSizeInCellsY(); ++j) {
+      ASSERT_EQ(single_costmap->getCost(i, j), dense_costmap->getCost(i, j));
+    }
+  }
+}
+
+/**
+ * Test that observations processed in parallel change the same cells as serially,
+ * all clearing before marking
+ */
+TEST_F(TestNode, testParallelObservations) {
+  tf2_ros::Buffer tf(node_->get_clock());
+  node_->declare_parameter(
+    "parallel_obstacles.parallel_observations", rclcpp::ParameterValue(true));
+
+  auto update_with = [&](const std::string & name) {
+      auto layers = std::make_shared<nav2_costmap_2d::LayeredCostmap>("frame", false, false);
+      layers->resizeMap(20, 20, 1, 0, 0);
+      layers->setTiledUpdate(4, 8);
+      auto olayer = std::make_shared<nav2_costmap_2d::ObstacleLayer>();
+      olayer->initialize(layers.get(), name, &tf, node_, nullptr, nullptr);
+      layers->addPlugin(olayer);
+
+      // Sources around the map, each seeing the others' obstacles through its rays
+      for (int i = 0; i < 6; ++i) {
+        const double ox = 10.0 + 8.0 * std::cos(i * M_PI / 3.0);
+        const double oy = 10.0 + 8.0 * std::sin(i * M_PI / 3.0);
+        addObservation(olayer, 20.0 - ox, 20.0 - oy, MAX_Z / 2, ox, oy, MAX_Z / 2);
+      }
+      for (unsigned int i = 0; i < olayer->getSizeInCellsX(); ++i) {
+        for (unsigned int j = 0; j < olayer->getSizeInCellsY(); ++j) {
+          olayer->setCost(i, j, nav2_costmap_2d::LETHAL_OBSTACLE);
+        }
+      }
+      layers->updateMap(0, 0, 0);
+      return std::make_pair(layers, olayer);
+    };
+
+  auto serial = update_with("obstacles");
+  auto parallel = update_with("parallel_obstacles");
+  std::shared_ptr<nav2_costmap_2d::ObstacleLayer> serial_costmap = serial.second;
+  std::shared_ptr<nav2_costmap_2d::ObstacleLayer> parallel_costmap = parallel.second;
+
+  ASSERT_GT(countValues(*serial_costmap, nav2_costmap_2d::FREE_SPACE), 0);
+  for (int i = 0; i < 6; ++i) {
+    // Marked over the origin cell of the opposite source, which its rays clear
+    unsigned int mx, my;
+    serial_costmap->worldToMap(
+      10.0 - 8.0 * std::cos(i * M_PI / 3.0), 10.0 - 8.0 * std::sin(i * M_PI / 3.0), mx, my);
+    ASSERT_EQ(serial_costmap->getCost(mx, my), nav2_costmap_2d::LETHAL_OBSTACLE);
+  }
+  for (unsigned int i = 0; i < serial_costmap->getSizeInCellsX(); ++i) {
+    for (unsigned int j = 0; j < serial_costmap->getSizeInCellsY(); ++j) {
+      ASSERT_EQ(serial_costmap->getCost(i, j), parallel_costmap->getCost(i, j));
+    }
+  }
+}
+
+/**
+ * Test that voxel layers of wide voxel columns mark obstacles above 16 z voxels
+ */
+TEST_F(TestNode, testTallVoxelColumns) {
+  tf2_ros::Buffer tf(node_->get_clock());
+
+  auto mark_tall_obstacle = [&](
+    std::shared_ptr<nav2_costmap_2d::ObstacleLayer> vlayer, const std::string & name) {
+      nav2_costmap_2d::LayeredCostmap layers("frame", false, false);
+      layers.resizeMap(10, 10, 1, 0, 0);
+      node_->declare_parameter(name + ".z_voxels", rclcpp::ParameterValue(24));
+      node_->declare_parameter(name + ".max_obstacle_height", rclcpp::ParameterValue(5.0));
+      vlayer->initialize(&layers, name, &tf, node_, nullptr, nullptr);
+      layers.addPlugin(vlayer);
+
+      // The obstacle is in the 23rd z voxel of 0.2m
+      addObservation(vlayer, 5.5, 5.5, 4.5, 0.5, 0.5, 4.5, true, false);
+      layers.updateMap(0, 0, 0);
+      return vlayer->getCost(5, 5);
+    };
+
+  ASSERT_NE(
+    mark_tall_obstacle(std::make_shared<nav2_costmap_2d::VoxelLayer>(), "narrow_voxels"),
+    nav2_costmap_2d::LETHAL_OBSTACLE);
+  ASSERT_EQ(
+    mark_tall_obstacle(std::make_shared<nav2_costmap_2d::VoxelLayer64>(), "wide_voxels"),
+    nav2_costmap_2d::LETHAL_OBSTACLE);
+}
+
+/**
+ * Test that voxels not marked again within the voxel decay are cleared without raytracing
+ */
+TEST_F(TestNode, testVoxelDecay) {
+  tf2_ros::Buffer tf(node_->get_clock());
+
+  nav2_costmap_2d::LayeredCostmap layers("frame", false, false);
+  layers.resizeMap(10, 10, 1, 0, 0);
+  node_->declare_parameter("decaying_voxels.voxel_decay", rclcpp::ParameterValue(0.2));
+  auto vlayer = std::make_shared<nav2_costmap_2d::VoxelLayer>();
+  vlayer->initialize(&layers, "decaying_voxels", &tf, node_, nullptr, nullptr);
+  layers.addPlugin(vlayer);
+
+  addObservation(vlayer, 5.5, 5.5, MAX_Z / 2, 0.5, 0.5, MAX_Z / 2, true, false);
+  layers.updateMap(0, 0, 0);
+  ASSERT_EQ(vlayer->getCost(5, 5), nav2_costmap_2d::LETHAL_OBSTACLE);
+
+  // Not seen anymore, the obstacle is kept until it decays
+  vlayer->clearStaticObservations(true, false);
+  layers.updateMap(0, 0, 0);
+  ASSERT_EQ(vlayer->getCost(5, 5), nav2_costmap_2d::LETHAL_OBSTACLE);
+  std::this_thread::sleep_for(std::chrono::milliseconds(300));
+  layers.updateMap(0, 0, 0);
+  ASSERT_EQ(vlayer->getCost(5, 5), nav2_costmap_2d::FREE_SPACE);
+  ASSERT_EQ(layers.getCostmap()->getCost(5, 5), nav2_costmap_2d::FREE_SPACE);
+}
+
+/**
+ * Test that costmap snapshots are immutable copies of the last update
+ */
+TEST_F(TestNode, testCostmapSnapshot) {
+  tf2_ros::Buffer tf(node_->get_clock());
+
+  nav2_costmap_2d::LayeredCostmap layers("frame", false, false);
+  layers.resizeMap(10, 10, 1, 0, 0);
+
+  std::shared_ptr<nav2_costmap_2d::StaticLayer> slayer = nullptr;
+  addStaticLayer(layers, tf, node_, slayer);
+  std::shared_ptr<nav2_costmap_2d::ObstacleLayer> olayer = nullptr;
+  addObstacleLayer(layers, tf, node_, olayer);
+
+  addObservation(olayer, 0.0, 0.0, MAX_Z / 2, 0, 0, MAX_Z / 2);
+  layers.updateMap(0, 0, 0);
+
+  auto first = layers.getCostmapSnapshot();
+  ASSERT_NE(first, nullptr);
+  ASSERT_EQ(first->getSizeInCellsX(), 10u);
+  ASSERT_EQ(first->getSizeInCellsY(), 10u);
+  ASSERT_EQ(first->getCost(0, 0), nav2_costmap_2d::LETHAL_OBSTACLE);
+  ASSERT_EQ(countValues(*first, nav2_costmap_2d::LETHAL_OBSTACLE), 1);
+
+  // Snapshots are only replaced by updates
+  ASSERT_EQ(layers.getCostmapSnapshot(), first);
+
+  addObservation(olayer, 5.0, 5.0, MAX_Z / 2, 0, 0, MAX_Z / 2);
+  layers.updateMap(0, 0, 0);
+
+  auto second = layers.getCostmapSnapshot();
+  ASSERT_NE(second, first);
+  ASSERT_EQ(second->getCost(5, 5), nav2_costmap_2d::LETHAL_OBSTACLE);
+  ASSERT_EQ(
+    countValues(*second, nav2_costmap_2d::LETHAL_OBSTACLE),
+    countValues(*(layers.getCostmap()), nav2_costmap_2d::LETHAL_OBSTACLE));
+
+  // The snapshot still held is not changed by the update
+  ASSERT_EQ(first->getCost(0, 0), nav2_costmap_2d::LETHAL_OBSTACLE);
+  ASSERT_EQ(first->getCost(5, 5), nav2_costmap_2d::FREE_SPACE);
+  ASSERT_EQ(countValues(*first, nav2_costmap_2d::LETHAL_OBSTACLE), 1);
+
+  // Once released, the first snapshot is reused after the next update
+  const nav2_costmap_2d::Costmap2D * first_costmap = first.get();
+  first.reset();
+  layers.updateMap(0, 0, 0);
+  ASSERT_EQ(layers.getCostmapSnapshot().get(), first_costmap);
+  ASSERT_EQ(layers.getCostmapSnapshot()->getCost(5, 5), nav2_costmap_2d::LETHAL_OBSTACLE);
+
+  // It is refreshed from the windows changed since it was taken, to the same costs
+  auto third = layers.getCostmapSnapshot();
+  for (unsigned int y = 0; y < 10; ++y) {
+    for (unsigned int x = 0; x < 10; ++x) {
+      ASSERT_EQ(third->getCost(x, y), layers.getCostmap()->getCost(x, y));
+    }
+  }
+
+  // Changes outside of updates are published as well
+  layers.getCostmap()->resetMap(0, 0, 10, 10);
+  layers.markUpdated();
+  ASSERT_NE(layers.getCostmapSnapshot(), third);
+  ASSERT_EQ(countValues(*(layers.getCostmapSnapshot()), nav2_costmap_2d::LETHAL_OBSTACLE), 0);
+}
+
+/**
+ * Test that the update count changes with each update, resize and reset
+ */
+TEST_F(TestNode, testUpdateCount) {
+  nav2_costmap_2d::LayeredCostmap layers("frame", false, false);
+  const uint64_t initial = layers.getUpdateCount();
+
+  layers.resizeMap(10, 10, 1, 0, 0);
+  ASSERT_EQ(layers.getUpdateCount(), initial + 1);
+
+  layers.updateMap(0, 0, 0);
+  layers.updateMap(0, 0, 0);
+  ASSERT_EQ(layers.getUpdateCount(), initial + 3);
+
+  layers.markUpdated();
+  ASSERT_EQ(layers.getUpdateCount(), initial + 4);
+
+  // Updates changing no cells, without layers here, are journaled as no change
+  std::vector<nav2_costmap_2d::LayeredCostmap::ChangedWindow> windows;
+  for (int i = 0; i < 100; ++i) {
+    layers.updateMap(0, 0, 0);
+  }
+  ASSERT_EQ(layers.getUpdateCount(), initial + 104);
+  ASSERT_TRUE(layers.getChangedWindows(initial + 4, windows));
+  ASSERT_TRUE(windows.empty());
+  ASSERT_FALSE(layers.getChangedWindows(initial + 3, windows));
+}
+
+/**
+ * Test that the windows changed by updates are kept until the whole costmap changes
+ */
+TEST_F(TestNode, testChangedWindows) {
+  tf2_ros::Buffer tf(node_->get_clock());
+
+  nav2_costmap_2d::LayeredCostmap layers("frame", false, false);
+  layers.resizeMap(10, 10, 1, 0, 0);
+  const uint64_t resized = layers.getUpdateCount();
+
+  std::shared_ptr<nav2_costmap_2d::StaticLayer> slayer = nullptr;
+  addStaticLayer(layers, tf, node_, slayer);
+  std::shared_ptr<nav2_costmap_2d::ObstacleLayer> olayer = nullptr;
+  addObstacleLayer(layers, tf, node_, olayer);
+
+  std::vector<nav2_costmap_2d::LayeredCostmap::ChangedWindow> windows;
+  ASSERT_TRUE(layers.getChangedWindows(resized, windows));
+  ASSERT_TRUE(windows.empty());
+
+  layers.updateMap(0, 0, 0);
+  const uint64_t first = layers.getUpdateCount();
+  addObservation(olayer, 5.0, 5.0, MAX_Z / 2, 0, 0, MAX_Z / 2);
+  layers.updateMap(0, 0, 0);
+
+  // The window of the second update covers the new obstacle
+  ASSERT_TRUE(layers.getChangedWindows(first, windows));
+  ASSERT_EQ(windows.size(), 1u);
+  ASSERT_EQ(windows[0].update_count, layers.getUpdateCount());
+  ASSERT_LE(windows[0].x0, 5u);
+  ASSERT_GT(windows[0].xn, 5u);
+  ASSERT_LE(windows[0].y0, 5u);
+  ASSERT_GT(windows[0].yn, 5u);
+  ASSERT_EQ(layers.getCostmap()->getCost(5, 5), nav2_costmap_2d::LETHAL_OBSTACLE);
+
+  ASSERT_TRUE(layers.getChangedWindows(resized, windows));
+  ASSERT_EQ(windows.size(), 2u);
+  ASSERT_EQ(windows[0].update_count, first);
+
+  // Nothing tells which cells a reset or resize changed
+  layers.markUpdated();
+  ASSERT_FALSE(layers.getChangedWindows(first, windows));
+  ASSERT_TRUE(layers.getChangedWindows(layers.getUpdateCount(), windows));
+  ASSERT_TRUE(windows.empty());
+  const uint64_t reset = layers.getUpdateCount();
+  layers.resizeMap(20, 20, 1, 0, 0);
+  ASSERT_FALSE(layers.getChangedWindows(reset, windows));
+}
+
+/**
+ * Test that updates record the stamp of the newest observation they incorporate
+ */
+TEST_F(TestNode, testSensorStamp) {
+  tf2_ros::Buffer tf(node_->get_clock());
+
+  nav2_costmap_2d::LayeredCostmap layers("frame", false, false);
+  layers.resizeMap(10, 10, 1, 0, 0);
+  std::shared_ptr<nav2_costmap_2d::ObstacleLayer> olayer = nullptr;
+  addObstacleLayer(layers, tf, node_, olayer);
+
+  layers.updateMap(0, 0, 0);
+  ASSERT_EQ(layers.getSensorStamp().nanoseconds(), 0);
+
+  auto add_observation = [&olayer](int32_t sec) {
+      sensor_msgs::msg::PointCloud2 cloud;
+      sensor_msgs::PointCloud2Modifier modifier(cloud);
+      modifier.setPointCloud2FieldsByString(1, "xyz");
+      modifier.resize(1);
+      cloud.header.stamp.sec = sec;
+      geometry_msgs::msg::Point origin;
+      nav2_costmap_2d::Observation obs(origin, cloud, 100.0, 0.0, 100.0, 0.0);
+      olayer->addStaticObservation(obs, true, false);
+    };
+  add_observation(20);
+  add_observation(10);
+  layers.updateMap(0, 0, 0);
+  ASSERT_EQ(layers.getSensorStamp(), rclcpp::Time(20, 0, RCL_ROS_TIME));
+
+  // Older observations don't take the stamp back
+  olayer->clearStaticObservations(true, false);
+  add_observation(15);
+  layers.updateMap(0, 0, 0);
+  ASSERT_EQ(layers.getSensorStamp(), rclcpp::Time(20, 0, RCL_ROS_TIME));
+  add_observation(30);
+  layers.updateMap(0, 0, 0);
+  ASSERT_EQ(layers.getSensorStamp(), rclcpp::Time(30, 0, RCL_ROS_TIME));
+}
+
+/**
+ * Test that replaying a recording reproduces the updates of the costmap recorded
+ */
+TEST_F(TestNode, testRecordAndReplay) {
+  tf2_ros::Buffer tf(node_->get_clock());
+  const std::string path = testing::TempDir() + "obstacle_tests.rec";
+
+  nav2_costmap_2d::LayeredCostmap layers("frame", false, false);
+  layers.resizeMap(10, 10, 1, 0, 0);
+  std::shared_ptr<nav2_costmap_2d::ObstacleLayer> olayer = nullptr;
+  addObstacleLayer(layers, tf, node_, olayer);
+
+  auto observe = [](int32_t sec, double x, double y) {
+      sensor_msgs::msg::PointCloud2 cloud;
+      sensor_msgs::PointCloud2Modifier modifier(cloud);
+      modifier.setPointCloud2FieldsByString(1, "xyz");
+      modifier.resize(1);
+      sensor_msgs::PointCloud2Iterator<float> iter_x(cloud, "x");
+      sensor_msgs::PointCloud2Iterator<float> iter_y(cloud, "y");
+      sensor_msgs::PointCloud2Iterator<float> iter_z(cloud, "z");
+      *iter_x = x;
+      *iter_y = y;
+      *iter_z = MAX_Z / 2;
+      cloud.header.stamp.sec = sec;
+      geometry_msgs::msg::Point origin;
+      origin.x = 0.5;
+      origin.y = 0.5;
+      origin.z = MAX_Z / 2;
+      return nav2_costmap_2d::Observation(origin, cloud, 100.0, 0.0, 100.0, 0.0);
+    };
+
+  // The buffer of the source keeps the latest observation only
+  std::vector<std::vector<unsigned char>> costmaps;
+  {
+    nav2_costmap_2d::CostmapRecorder recorder(path, 4, node_->get_logger());
+    const uint32_t source = recorder.addSource({"obstacles", "scan", 0.0, true, true});
+    for (int32_t i = 0; i < 10; ++i) {
+      nav2_costmap_2d::Observation obs = observe(i, 9.5 - i % 4, 2.5 + i % 7);
+      recorder.recordObservation(source, obs);
+      olayer->clearStaticObservations(true, true);
+      olayer->addStaticObservation(obs, true, true);
+      layers.updateMap(0, 0, 0);
+      recorder.recordCycle(i * 1000000000ll, 0, 0, 0, layers);
+      const unsigned char * costs = layers.getCostmap()->getCharMap();
+      costmaps.emplace_back(costs, costs + 100);
+    }
+  }
+
+  nav2_costmap_2d::LayeredCostmap replayed("frame", false, false);
+  replayed.resizeMap(10, 10, 1, 0, 0);
+  std::shared_ptr<nav2_costmap_2d::ObstacleLayer> rlayer = nullptr;
+  addObstacleLayer(replayed, tf, node_, rlayer);
+
+  nav2_costmap_2d::CostmapRecordReader reader(path);
+  ASSERT_TRUE(reader.isOpen());
+  nav2_costmap_2d::CostmapReplay replay(replayed);
+  nav2_costmap_2d::ReplayStatistics statistics;
+  size_t cycle = 0;
+  ASSERT_TRUE(
+    replay.replay(
+      reader, statistics,
+      [&](const nav2_costmap_2d::RecordedCycle & recorded_cycle,
+      const nav2_costmap_2d::Costmap2D & recorded) {
+        ASSERT_LT(cycle, costmaps.size());
+        ASSERT_EQ(recorded_cycle.stamp_ns, static_cast<int64_t>(cycle) * 1000000000ll);
+        ASSERT_EQ(std::memcmp(recorded.getCharMap(), costmaps[cycle].data(), 100), 0);
+        ASSERT_EQ(
+          std::memcmp(replayed.getCostmap()->getCharMap(), costmaps[cycle].data(), 100), 0);
+        ++cycle;
+      }));
+  ASSERT_EQ(cycle, 10u);
+  ASSERT_EQ(statistics.cycles, 10u);
+  ASSERT_EQ(statistics.observations, 10u);
+  ASSERT_EQ(statistics.mismatched_cycles, 0u);
+  ASSERT_GE(statistics.update_time, statistics.max_update_time);
+}
+
+/**
+ * Test the update requests of event driven costmap updates
+ */
+TEST_F(TestNode, testUpdateRequests) {
+  nav2_costmap_2d::LayeredCostmap layers("frame", false, false);
+  auto soon = []() {return std::chrono::steady_clock::now() + std::chrono::milliseconds(10);};
+
+  ASSERT_FALSE(layers.waitForUpdateRequest(soon()));
+
+  // Requests are consumed by the wait they end
+  layers.requestUpdate();
+  layers.requestUpdate();
+  ASSERT_TRUE(layers.waitForUpdateRequest(soon()));
+  ASSERT_FALSE(layers.waitForUpdateRequest(soon()));
+
+  // A request from another thread ends an indefinite wait
+  std::thread requester([&layers]() {
+      std::this_thread::sleep_for(std::chrono::milliseconds(20));
+      layers.requestUpdate();
+    });
+  ASSERT_TRUE(layers.waitForUpdateRequest(std::chrono::steady_clock::time_point::max()));
+  requester.join();
+
+  // Footprint changes request an update
+  layers.setFootprint(nav2_costmap_2d::makeFootprintFromRadius(0.5));
+  ASSERT_TRUE(layers.waitForUpdateRequest(soon()));
+}
+
 /**
  * Test dynamic parameter setting of voxel layer
  */
@@ -444,7 +918,9 @@ TEST_F(TestNode, testDynParamsSetVoxel)
     rclcpp::Parameter("voxel_layer.max_obstacle_height", 4.0),
     rclcpp::Parameter("voxel_layer.footprint_clearing_enabled", false),
     rclcpp::Parameter("voxel_layer.enabled", false),
-    rclcpp::Parameter("voxel_layer.publish_voxel_map", true)
+    rclcpp::Parameter("voxel_layer.parallel_clearing", true),
+    rclcpp::Parameter("voxel_layer.publish_voxel_map", true),
+    rclcpp::Parameter("voxel_layer.publish_voxel_map_updates", true)
   });
 
   rclcpp::spin_until_future_complete(
@@ -460,7 +936,9 @@ TEST_F(TestNode, testDynParamsSetVoxel)
   EXPECT_EQ(costmap->get_parameter("voxel_layer.max_obstacle_height").as_double(), 4.0);
   EXPECT_EQ(costmap->get_parameter("voxel_layer.footprint_clearing_enabled").as_bool(), false);
   EXPECT_EQ(costmap->get_parameter("voxel_layer.enabled").as_bool(), false);
+  EXPECT_EQ(costmap->get_parameter("voxel_layer.parallel_clearing").as_bool(), true);
   EXPECT_EQ(costmap->get_parameter("voxel_layer.publish_voxel_map").as_bool(), true);
+  EXPECT_EQ(costmap->get_parameter("voxel_layer.publish_voxel_map_updates").as_bool(), true);
 
   costmap->on_deactivate(rclcpp_lifecycle::State());
   costmap->on_cleanup(rclcpp_lifecycle::State());
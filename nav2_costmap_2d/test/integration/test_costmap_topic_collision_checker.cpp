@@ -191,6 +191,65 @@ public:
     return collision_checker_->isCollisionFree(pose);
   }
 
+  int testTrajectory(const std::vector<geometry_msgs::msg::Pose2D> & poses, unsigned int levels)
+  {
+    rclcpp::Time stamp = now();
+    publishPose(poses.front().x, poses.front().y, poses.front().theta, stamp);
+
+    setPose(poses.front().x, poses.front().y, poses.front().theta, stamp);
+    publishFootprint();
+    publishCostmap();
+    costmap_sub_->setPyramidLevels(levels);
+    rclcpp::sleep_for(std::chrono::milliseconds(1000));
+    return collision_checker_->findFirstCollision(poses);
+  }
+
+  int testManeuver(const std::vector<geometry_msgs::msg::Pose2D> & poses)
+  {
+    testTrajectory(poses, 0);
+    nav2_costmap_2d::CostmapTopicCollisionChecker::Maneuver maneuver;
+    if (!collision_checker_->prepareManeuver(poses, maneuver)) {
+      return -2;
+    }
+    // Checking again without costmap changes reuses the rasterized cells
+    const int collision = collision_checker_->findFirstCollision(maneuver, 0, poses.size());
+    if (collision != collision_checker_->findFirstCollision(maneuver, 0, poses.size())) {
+      return -3;
+    }
+    return collision;
+  }
+
+  // Whether the check of each pose of a maneuver agrees with checking it alone
+  bool testManeuverPosesAlone(const std::vector<geometry_msgs::msg::Pose2D> & poses)
+  {
+    testTrajectory(poses, 0);
+    nav2_costmap_2d::CostmapTopicCollisionChecker::Maneuver maneuver;
+    if (!collision_checker_->prepareManeuver(poses, maneuver)) {
+      return false;
+    }
+    for (size_t i = 0; i < poses.size(); ++i) {
+      const int collision = collision_checker_->findFirstCollision(maneuver, i, i + 1);
+      if ((collision == -1) != collision_checker_->isCollisionFree(poses[i], false)) {
+        return false;
+      }
+    }
+    return true;
+  }
+
+  // Whether the batch check of each pose agrees with checking it alone
+  bool testTrajectoryPosesAlone(
+    const std::vector<geometry_msgs::msg::Pose2D> & poses, unsigned int levels)
+  {
+    testTrajectory(poses, levels);
+    for (const auto & pose : poses) {
+      const int collision = collision_checker_->findFirstCollision({pose}, false);
+      if ((collision == -1) != collision_checker_->isCollisionFree(pose, false)) {
+        return false;
+      }
+    }
+    return true;
+  }
+
   void setFootprint(double footprint_padding, double robot_radius)
   {
     std::vector<geometry_msgs::msg::Point> new_footprint;
@@ -346,3 +405,59 @@ TEST_F(TestNode, CollisionSpace)
   // Partially in obstacle
   ASSERT_EQ(collision_checker_->testPose(4.5, 4.5, 0), false);
 }
+
+static geometry_msgs::msg::Pose2D toPose2D(double x, double y, double theta)
+{
+  geometry_msgs::msg::Pose2D pose;
+  pose.x = x;
+  pose.y = y;
+  pose.theta = theta;
+  return pose;
+}
+
+TEST_F(TestNode, TrajectoryCollision)
+{
+  collision_checker_->setFootprint(0, 1);
+
+  const std::vector<geometry_msgs::msg::Pose2D> free_poses =
+  {toPose2D(2, 8.5, 0), toPose2D(2.5, 7, 0)};
+  std::vector<geometry_msgs::msg::Pose2D> poses = free_poses;
+  poses.push_back(toPose2D(8.5, 6.5, 0));
+  poses.push_back(toPose2D(4.5, 4.5, 0));
+
+  for (unsigned int levels : {0u, 3u}) {
+    ASSERT_EQ(collision_checker_->testTrajectory(free_poses, levels), -1);
+    ASSERT_EQ(collision_checker_->testTrajectory(poses, levels), 2);
+    ASSERT_EQ(collision_checker_->testTrajectory({toPose2D(5, 13, 0)}, levels), 0);
+  }
+
+  // Coarse levels never accept a pose in collision
+  std::vector<geometry_msgs::msg::Pose2D> grid_poses;
+  for (double x = 0.5; x < 10.0; x += 0.75) {
+    for (double y = 0.5; y < 10.0; y += 0.75) {
+      grid_poses.push_back(toPose2D(x, y, 0));
+    }
+  }
+  ASSERT_TRUE(collision_checker_->testTrajectoryPosesAlone(grid_poses, 3));
+}
+
+TEST_F(TestNode, ManeuverCollision)
+{
+  collision_checker_->setFootprint(0, 1);
+
+  std::vector<geometry_msgs::msg::Pose2D> poses = {toPose2D(2, 8.5, 0), toPose2D(2.5, 7, 0)};
+  ASSERT_EQ(collision_checker_->testManeuver(poses), -1);
+  poses.push_back(toPose2D(8.5, 6.5, 0));
+  poses.push_back(toPose2D(4.5, 4.5, 0));
+  ASSERT_EQ(collision_checker_->testManeuver(poses), 2);
+  ASSERT_EQ(collision_checker_->testManeuver({toPose2D(5, 13, 0)}), 0);
+
+  // The rasterized footprints agree with checking each pose alone
+  std::vector<geometry_msgs::msg::Pose2D> grid_poses;
+  for (double x = 0.5; x < 10.0; x += 0.75) {
+    for (double y = 0.5; y < 10.0; y += 0.75) {
+      grid_poses.push_back(toPose2D(x, y, 0.3));
+    }
+  }
+  ASSERT_TRUE(collision_checker_->testManeuverPosesAlone(grid_poses));
+}
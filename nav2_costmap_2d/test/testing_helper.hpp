@@ -53,7 +53,7 @@ void printMap(nav2_costmap_2d::Costmap2D & costmap)
 }
 
 unsigned int countValues(
-  nav2_costmap_2d::Costmap2D & costmap,
+  const nav2_costmap_2d::Costmap2D & costmap,
   unsigned char value, bool equal = true)
 {
   unsigned int count = 0;
@@ -0,0 +1,94 @@
+// Copyright (c) 2022 Samsung Research America
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <gtest/gtest.h>
+
+#include <random>
+
+#include "nav2_costmap_2d/cost_values.hpp"
+#include "nav2_costmap_2d/costmap_layer.hpp"
+
+class ClearableLayer : public nav2_costmap_2d::CostmapLayer
+{
+public:
+  ClearableLayer(unsigned int size_x, unsigned int size_y)
+  {
+    resizeMap(size_x, size_y, 0.05, 0.0, 0.0);
+  }
+
+  void fill()
+  {
+    for (unsigned int i = 0; i < getSizeInCellsX() * getSizeInCellsY(); ++i) {
+      getCharMap()[i] = static_cast<unsigned char>(i % 253);
+    }
+  }
+
+  void reset() override {}
+  bool isClearable() override {return true;}
+  void updateBounds(double, double, double, double *, double *, double *, double *) override {}
+  void updateCosts(nav2_costmap_2d::Costmap2D &, int, int, int, int) override {}
+};
+
+// Cells cleared, the area being exclusive of its bounds
+static bool isCleared(int x, int y, int start_x, int start_y, int end_x, int end_y, bool invert)
+{
+  const bool inside = x > start_x && x < end_x && y > start_y && y < end_y;
+  return inside != invert;
+}
+
+TEST(ClearArea, matchesArea)
+{
+  std::mt19937 generator(7);
+  std::uniform_int_distribution<int> coordinate(-5, 45);
+  ClearableLayer layer(37, 29);
+  for (int i = 0; i < 500; ++i) {
+    const int start_x = coordinate(generator), start_y = coordinate(generator);
+    const int end_x = coordinate(generator), end_y = coordinate(generator);
+    const bool invert = i % 2 == 1;
+    layer.fill();
+    layer.clearArea(start_x, start_y, end_x, end_y, invert);
+
+    unsigned int mismatches = 0;
+    for (int y = 0; y < 29; ++y) {
+      for (int x = 0; x < 37; ++x) {
+        const unsigned int index = layer.getIndex(x, y);
+        const unsigned char expected =
+          isCleared(x, y, start_x, start_y, end_x, end_y, invert) ?
+          nav2_costmap_2d::NO_INFORMATION : static_cast<unsigned char>(index % 253);
+        mismatches += layer.getCost(x, y) != expected;
+      }
+    }
+    EXPECT_EQ(mismatches, 0u) << start_x << " " << start_y << " " << end_x << " " << end_y <<
+      " " << invert;
+  }
+}
+
+TEST(ClearArea, clearsAroundAndExcept)
+{
+  ClearableLayer layer(20, 10);
+  layer.fill();
+  layer.clearArea(4, 2, 8, 6, false);
+  EXPECT_EQ(layer.getCost(5, 3), nav2_costmap_2d::NO_INFORMATION);
+  EXPECT_EQ(layer.getCost(7, 5), nav2_costmap_2d::NO_INFORMATION);
+  EXPECT_NE(layer.getCost(4, 3), nav2_costmap_2d::NO_INFORMATION);
+  EXPECT_NE(layer.getCost(8, 5), nav2_costmap_2d::NO_INFORMATION);
+
+  layer.fill();
+  layer.clearArea(4, 2, 8, 6, true);
+  EXPECT_NE(layer.getCost(5, 3), nav2_costmap_2d::NO_INFORMATION);
+  EXPECT_NE(layer.getCost(7, 5), nav2_costmap_2d::NO_INFORMATION);
+  EXPECT_EQ(layer.getCost(4, 3), nav2_costmap_2d::NO_INFORMATION);
+  EXPECT_EQ(layer.getCost(0, 0), nav2_costmap_2d::NO_INFORMATION);
+  EXPECT_EQ(layer.getCost(19, 9), nav2_costmap_2d::NO_INFORMATION);
+}
@@ -0,0 +1,108 @@
+// Copyright (c) 2022 Samsung Research America
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License. Reserved.
+
+#include <gtest/gtest.h>
+
+#include <algorithm>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "nav2_costmap_2d/combination_kernels.hpp"
+#include "nav2_costmap_2d/cost_values.hpp"
+
+using nav2_costmap_2d::NO_INFORMATION;
+using nav2_costmap_2d::INSCRIBED_INFLATED_OBSTACLE;
+
+// Costs biased towards unknown and high values, to cover every branch of the combinations
+std::vector<unsigned char> randomCosts(std::mt19937 & generator, unsigned int size)
+{
+  std::vector<unsigned char> costs(size);
+  for (auto & cost : costs) {
+    const unsigned int kind = generator() % 4;
+    if (kind == 0) {
+      cost = NO_INFORMATION;
+    } else if (kind == 1) {
+      cost = 200 + generator() % 56;
+    } else {
+      cost = generator() % 256;
+    }
+  }
+  return costs;
+}
+
+template<typename Kernel, typename Reference>
+void compareWithReference(Kernel kernel, Reference reference)
+{
+  std::mt19937 generator(42);
+  // Sizes around the vector widths, with offsets so that rows are not aligned
+  for (unsigned int size : {0u, 1u, 15u, 16u, 17u, 31u, 32u, 33u, 100u, 1001u}) {
+    for (unsigned int offset = 0; offset < 3; ++offset) {
+      std::vector<unsigned char> master = randomCosts(generator, size + offset);
+      std::vector<unsigned char> layer = randomCosts(generator, size + offset);
+      std::vector<unsigned char> expected = master;
+      for (unsigned int i = offset; i < size + offset; ++i) {
+        expected[i] = reference(master[i], layer[i]);
+      }
+
+      kernel(master.data() + offset, layer.data() + offset, size);
+      for (unsigned int i = 0; i < size + offset; ++i) {
+        ASSERT_EQ(master[i], expected[i]) << "size " << size << ", cell " << i;
+      }
+    }
+  }
+}
+
+TEST(CombinationKernels, max)
+{
+  compareWithReference(
+    nav2_costmap_2d::combineWithMax,
+    [](unsigned char master, unsigned char layer) -> unsigned char {
+      if (layer == NO_INFORMATION) {
+        return master;
+      }
+      return (master == NO_INFORMATION || master < layer) ? layer : master;
+    });
+}
+
+TEST(CombinationKernels, overwrite)
+{
+  compareWithReference(
+    nav2_costmap_2d::combineWithOverwrite,
+    [](unsigned char master, unsigned char layer) -> unsigned char {
+      return layer == NO_INFORMATION ? master : layer;
+    });
+}
+
+TEST(CombinationKernels, addition)
+{
+  compareWithReference(
+    nav2_costmap_2d::combineWithAddition,
+    [](unsigned char master, unsigned char layer) -> unsigned char {
+      if (layer == NO_INFORMATION) {
+        return master;
+      }
+      if (master == NO_INFORMATION) {
+        return layer;
+      }
+      const int sum = master + layer;
+      return sum >= INSCRIBED_INFLATED_OBSTACLE ? INSCRIBED_INFLATED_OBSTACLE - 1 : sum;
+    });
+}
+
+TEST(CombinationKernels, instructionSet)
+{
+  const std::string instruction_set = nav2_costmap_2d::getCombinationKernelsInstructionSet();
+  EXPECT_FALSE(instruction_set.empty());
+}
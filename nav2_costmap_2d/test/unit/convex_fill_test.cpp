@@ -0,0 +1,130 @@
+// Copyright (c) 2022 Samsung Research America
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <gtest/gtest.h>
+
+#include <cmath>
+#include <map>
+#include <set>
+#include <utility>
+#include <vector>
+
+#include "nav2_costmap_2d/cost_values.hpp"
+#include "nav2_costmap_2d/costmap_2d.hpp"
+
+using Cells = std::set<std::pair<unsigned int, unsigned int>>;
+
+// The cells between the ends of the outline on each column
+static Cells columnFill(
+  nav2_costmap_2d::Costmap2D & costmap, const std::vector<nav2_costmap_2d::MapLocation> & polygon)
+{
+  std::vector<nav2_costmap_2d::MapLocation> outline;
+  costmap.polygonOutlineCells(polygon, outline);
+  std::map<unsigned int, std::pair<unsigned int, unsigned int>> columns;
+  for (const auto & cell : outline) {
+    auto column = columns.emplace(cell.x, std::make_pair(cell.y, cell.y)).first;
+    column->second.first = std::min(column->second.first, cell.y);
+    column->second.second = std::max(column->second.second, cell.y);
+  }
+  Cells cells;
+  for (const auto & column : columns) {
+    for (unsigned int y = column.second.first; y <= column.second.second; ++y) {
+      cells.insert({column.first, y});
+    }
+  }
+  return cells;
+}
+
+static std::vector<nav2_costmap_2d::MapLocation> makePolygon(
+  double cx, double cy, double radius, const std::vector<double> & angles)
+{
+  std::vector<nav2_costmap_2d::MapLocation> polygon;
+  for (double angle : angles) {
+    polygon.push_back(
+      {static_cast<unsigned int>(cx + radius * std::cos(angle)),
+        static_cast<unsigned int>(cy + radius * std::sin(angle))});
+  }
+  return polygon;
+}
+
+TEST(ConvexFill, matchesOutlineColumns)
+{
+  nav2_costmap_2d::Costmap2D costmap(100, 100, 0.1, 0.0, 0.0);
+  const std::vector<std::vector<nav2_costmap_2d::MapLocation>> polygons = {
+    makePolygon(50.0, 50.0, 20.0, {0.3, 1.9, 3.5, 5.1}),
+    makePolygon(30.5, 60.5, 12.0, {0.0, 2.1, 4.2}),
+    makePolygon(70.0, 40.0, 25.0, {0.1, 0.9, 1.7, 2.6, 3.4, 4.3, 5.2}),
+    makePolygon(20.0, 20.0, 1.5, {0.0, 2.0, 4.0}),
+    // Degenerate, all on a line
+    {{10, 10}, {20, 15}, {30, 20}},
+  };
+
+  for (const auto & polygon : polygons) {
+    std::vector<nav2_costmap_2d::MapLocation> filled;
+    costmap.convexFillCells(polygon, filled);
+    Cells cells;
+    for (unsigned int i = 0; i < filled.size(); ++i) {
+      cells.insert({filled[i].x, filled[i].y});
+      // In row-major order
+      if (i > 0) {
+        EXPECT_TRUE(
+          filled[i - 1].y < filled[i].y ||
+          (filled[i - 1].y == filled[i].y && filled[i - 1].x < filled[i].x));
+      }
+    }
+    EXPECT_EQ(cells.size(), filled.size());
+    EXPECT_EQ(cells, columnFill(costmap, polygon));
+  }
+
+  // Fewer than three points fill nothing
+  std::vector<nav2_costmap_2d::MapLocation> filled;
+  costmap.convexFillCells({{10, 10}, {20, 20}}, filled);
+  EXPECT_TRUE(filled.empty());
+}
+
+TEST(ConvexFill, setsPolygonCost)
+{
+  nav2_costmap_2d::Costmap2D costmap(100, 100, 0.1, 0.0, 0.0);
+  std::vector<geometry_msgs::msg::Point> polygon;
+  for (double angle : {0.2, 1.4, 2.9, 4.4, 5.6}) {
+    geometry_msgs::msg::Point point;
+    point.x = 5.0 + 2.0 * std::cos(angle);
+    point.y = 5.0 + 2.0 * std::sin(angle);
+    polygon.push_back(point);
+  }
+  ASSERT_TRUE(costmap.setConvexPolygonCost(polygon, nav2_costmap_2d::LETHAL_OBSTACLE));
+
+  std::vector<nav2_costmap_2d::MapLocation> map_polygon;
+  for (const auto & point : polygon) {
+    nav2_costmap_2d::MapLocation location;
+    ASSERT_TRUE(costmap.worldToMap(point.x, point.y, location.x, location.y));
+    map_polygon.push_back(location);
+  }
+  const Cells cells = columnFill(costmap, map_polygon);
+  unsigned int mismatches = 0;
+  for (unsigned int x = 0; x < 100; ++x) {
+    for (unsigned int y = 0; y < 100; ++y) {
+      const bool inside = cells.count({x, y}) > 0;
+      mismatches += (costmap.getCost(x, y) == nav2_costmap_2d::LETHAL_OBSTACLE) != inside;
+    }
+  }
+  EXPECT_EQ(mismatches, 0u);
+  EXPECT_EQ(costmap.getCost(50, 50), nav2_costmap_2d::LETHAL_OBSTACLE);
+  EXPECT_EQ(costmap.getCost(90, 90), nav2_costmap_2d::FREE_SPACE);
+
+  // Polygons leaving the costmap are not filled
+  polygon[0].x = -1.0;
+  EXPECT_FALSE(costmap.setConvexPolygonCost(polygon, nav2_costmap_2d::FREE_SPACE));
+  EXPECT_EQ(costmap.getCost(50, 50), nav2_costmap_2d::LETHAL_OBSTACLE);
+}
@@ -0,0 +1,97 @@
+// Copyright (c) 2022 Samsung Research America
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License. Reserved.
+
+#include <gtest/gtest.h>
+
+#include <random>
+#include <vector>
+
+#include "nav2_costmap_2d/costmap_compression.hpp"
+#include "nav2_costmap_2d/cost_values.hpp"
+
+using nav2_costmap_2d::encodeRunLength;
+using nav2_costmap_2d::decodeRunLength;
+
+TEST(CostmapCompression, roundTrip)
+{
+  // Free and unknown areas with a few obstacles and random noise
+  std::mt19937 gen(42);
+  std::uniform_int_distribution<int> cost(0, 255);
+  std::vector<unsigned char> costs(300 * 200, nav2_costmap_2d::FREE_SPACE);
+  std::fill(costs.begin() + 20000, costs.begin() + 45000, nav2_costmap_2d::NO_INFORMATION);
+  for (unsigned int i = 0; i < costs.size(); i += 97) {
+    costs[i] = cost(gen);
+  }
+
+  std::vector<uint8_t> encoded;
+  encodeRunLength(costs.data(), 300, 200, 300, encoded);
+  EXPECT_LT(encoded.size(), costs.size() / 10);
+
+  std::vector<unsigned char> decoded(costs.size());
+  ASSERT_TRUE(decodeRunLength(encoded.data(), encoded.size(), decoded.data(), decoded.size()));
+  EXPECT_EQ(decoded, costs);
+}
+
+TEST(CostmapCompression, window)
+{
+  std::vector<unsigned char> costs(10 * 10);
+  for (unsigned int i = 0; i < costs.size(); i++) {
+    costs[i] = i;
+  }
+
+  // Window of 3x2 cells at (4, 5) of a 10 cells wide costmap
+  std::vector<uint8_t> encoded;
+  encodeRunLength(costs.data() + 5 * 10 + 4, 3, 2, 10, encoded);
+  std::vector<unsigned char> decoded(6);
+  ASSERT_TRUE(decodeRunLength(encoded.data(), encoded.size(), decoded.data(), decoded.size()));
+  EXPECT_EQ(decoded, std::vector<unsigned char>({54, 55, 56, 64, 65, 66}));
+}
+
+TEST(CostmapCompression, longRuns)
+{
+  // A uniform costmap is a single run, with a multi-byte length
+  std::vector<unsigned char> costs(4000 * 4000, nav2_costmap_2d::NO_INFORMATION);
+  std::vector<uint8_t> encoded;
+  encodeRunLength(costs.data(), 4000, 4000, 4000, encoded);
+  EXPECT_EQ(encoded.size(), 5u);
+
+  std::vector<unsigned char> decoded(costs.size(), 0);
+  ASSERT_TRUE(decodeRunLength(encoded.data(), encoded.size(), decoded.data(), decoded.size()));
+  EXPECT_EQ(decoded, costs);
+
+  encodeRunLength(costs.data(), 0, 10, 0, encoded);
+  EXPECT_TRUE(encoded.empty());
+  EXPECT_TRUE(decodeRunLength(encoded.data(), encoded.size(), decoded.data(), 0));
+}
+
+TEST(CostmapCompression, malformed)
+{
+  std::vector<unsigned char> decoded(10);
+
+  // Too few, too many, zero length and truncated runs
+  std::vector<uint8_t> encoded = {7, 9};
+  EXPECT_FALSE(decodeRunLength(encoded.data(), encoded.size(), decoded.data(), decoded.size()));
+  encoded = {7, 11};
+  EXPECT_FALSE(decodeRunLength(encoded.data(), encoded.size(), decoded.data(), decoded.size()));
+  encoded = {7, 0, 8, 10};
+  EXPECT_FALSE(decodeRunLength(encoded.data(), encoded.size(), decoded.data(), decoded.size()));
+  encoded = {7, 0x8a};
+  EXPECT_FALSE(decodeRunLength(encoded.data(), encoded.size(), decoded.data(), decoded.size()));
+  encoded = {7};
+  EXPECT_FALSE(decodeRunLength(encoded.data(), encoded.size(), decoded.data(), decoded.size()));
+
+  encoded = {7, 4, 8, 6};
+  EXPECT_TRUE(decodeRunLength(encoded.data(), encoded.size(), decoded.data(), decoded.size()));
+  EXPECT_EQ(decoded, std::vector<unsigned char>({7, 7, 7, 7, 8, 8, 8, 8, 8, 8}));
+}
@@ -0,0 +1,199 @@
+// Copyright (c) 2022 Samsung Research America
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License. Reserved.
+
+#include <gtest/gtest.h>
+
+#include <algorithm>
+#include <mutex>
+
+#include "nav2_costmap_2d/costmap_2d.hpp"
+#include "nav2_costmap_2d/costmap_pyramid.hpp"
+#include "nav2_costmap_2d/layered_costmap.hpp"
+
+// Check a level against the max of the costmap cells under each of its cells
+static void expectDownsampled(
+  const nav2_costmap_2d::Costmap2D & costmap,
+  const nav2_costmap_2d::Costmap2D & level, unsigned int factor)
+{
+  ASSERT_EQ(level.getSizeInCellsX(), (costmap.getSizeInCellsX() + factor - 1) / factor);
+  ASSERT_EQ(level.getSizeInCellsY(), (costmap.getSizeInCellsY() + factor - 1) / factor);
+  EXPECT_DOUBLE_EQ(level.getResolution(), costmap.getResolution() * factor);
+  EXPECT_DOUBLE_EQ(level.getOriginX(), costmap.getOriginX());
+  EXPECT_DOUBLE_EQ(level.getOriginY(), costmap.getOriginY());
+
+  for (unsigned int j = 0; j < level.getSizeInCellsY(); ++j) {
+    for (unsigned int i = 0; i < level.getSizeInCellsX(); ++i) {
+      unsigned char cost = 0;
+      for (unsigned int y = j * factor;
+        y < std::min((j + 1) * factor, costmap.getSizeInCellsY()); ++y)
+      {
+        for (unsigned int x = i * factor;
+          x < std::min((i + 1) * factor, costmap.getSizeInCellsX()); ++x)
+        {
+          cost = std::max(cost, costmap.getCost(x, y));
+        }
+      }
+      ASSERT_EQ(level.getCost(i, j), cost) << "factor " << factor << " cell " << i << ", " << j;
+    }
+  }
+}
+
+// Brute force maximum of a window of the costmap
+static unsigned char windowMaxCost(
+  const nav2_costmap_2d::Costmap2D & costmap,
+  unsigned int x0, unsigned int y0, unsigned int xn, unsigned int yn)
+{
+  unsigned char cost = 0;
+  for (unsigned int y = y0; y < std::min(yn, costmap.getSizeInCellsY()); ++y) {
+    for (unsigned int x = x0; x < std::min(xn, costmap.getSizeInCellsX()); ++x) {
+      cost = std::max(cost, costmap.getCost(x, y));
+    }
+  }
+  return cost;
+}
+
+TEST(CostmapPyramid, levels)
+{
+  nav2_costmap_2d::CostmapPyramid pyramid;
+  EXPECT_EQ(pyramid.getLevels(), 0u);
+  EXPECT_EQ(pyramid.getLevel(2), nullptr);
+
+  pyramid.setLevels(3);
+  EXPECT_EQ(pyramid.getLevels(), 3u);
+  EXPECT_NE(pyramid.getLevel(2), nullptr);
+  EXPECT_NE(pyramid.getLevel(4), nullptr);
+  EXPECT_NE(pyramid.getLevel(8), nullptr);
+  EXPECT_EQ(pyramid.getLevel(1), nullptr);
+  EXPECT_EQ(pyramid.getLevel(3), nullptr);
+  EXPECT_EQ(pyramid.getLevel(16), nullptr);
+}
+
+TEST(CostmapPyramid, windowUpdates)
+{
+  nav2_costmap_2d::Costmap2D costmap(37, 21, 0.05, -1.0, 3.0, 0);
+  costmap.setCost(0, 0, 100);
+  costmap.setCost(36, 20, 50);
+  costmap.setCost(17, 9, 254);
+
+  nav2_costmap_2d::CostmapPyramid pyramid;
+  pyramid.setLevels(3);
+
+  // The first update downsamples the whole costmap, whatever its window
+  pyramid.update(costmap, 0, 0, 0, 0);
+  for (unsigned int factor = 2; factor <= 8; factor *= 2) {
+    expectDownsampled(costmap, *pyramid.getLevel(factor), factor);
+  }
+
+  // Update an odd window, which both raises and lowers costs
+  costmap.setCost(17, 9, 0);
+  costmap.setCost(21, 12, 253);
+  costmap.setCost(15, 7, 1);
+  pyramid.update(costmap, 15, 7, 22, 13);
+  for (unsigned int factor = 2; factor <= 8; factor *= 2) {
+    expectDownsampled(costmap, *pyramid.getLevel(factor), factor);
+  }
+
+  // Changes outside of the window are not seen until they are updated
+  costmap.setCost(2, 2, 200);
+  pyramid.update(costmap, 30, 15, 31, 16);
+  EXPECT_EQ(pyramid.getLevel(2)->getCost(1, 1), 0);
+  pyramid.update(costmap, 2, 2, 3, 3);
+  for (unsigned int factor = 2; factor <= 8; factor *= 2) {
+    expectDownsampled(costmap, *pyramid.getLevel(factor), factor);
+  }
+}
+
+TEST(CostmapPyramid, geometryChanges)
+{
+  nav2_costmap_2d::Costmap2D costmap(16, 16, 0.1, 0.0, 0.0, 0);
+  costmap.setCost(3, 3, 100);
+
+  nav2_costmap_2d::CostmapPyramid pyramid;
+  pyramid.setLevels(2);
+  pyramid.update(costmap, 0, 0, 16, 16);
+  expectDownsampled(costmap, *pyramid.getLevel(4), 4);
+
+  // A moved origin recomputes all levels, even with an empty window
+  costmap.updateOrigin(0.5, 0.2);
+  costmap.setCost(0, 0, 40);
+  pyramid.update(costmap, 0, 0, 0, 0);
+  expectDownsampled(costmap, *pyramid.getLevel(2), 2);
+  expectDownsampled(costmap, *pyramid.getLevel(4), 4);
+
+  // So does a resize
+  costmap.resizeMap(9, 5, 0.2, 1.0, 1.0);
+  costmap.setCost(8, 4, 10);
+  pyramid.update(costmap, 8, 4, 9, 5);
+  expectDownsampled(costmap, *pyramid.getLevel(2), 2);
+  expectDownsampled(costmap, *pyramid.getLevel(4), 4);
+
+  // Added levels are computed on the next update
+  pyramid.setLevels(3);
+  pyramid.update(costmap, 0, 0, 1, 1);
+  expectDownsampled(costmap, *pyramid.getLevel(8), 8);
+}
+
+TEST(CostmapPyramid, maxCostQueries)
+{
+  nav2_costmap_2d::Costmap2D costmap(45, 27, 0.05, 0.0, 0.0, 0);
+  for (unsigned int i = 0; i < 12; ++i) {
+    costmap.setCost((i * 17) % 45, (i * 11) % 27, static_cast<unsigned char>(20 * i + 10));
+  }
+
+  // Without levels, and with levels not updated yet, the costmap is searched alone
+  nav2_costmap_2d::CostmapPyramid pyramid;
+  EXPECT_EQ(pyramid.getMaxCost(costmap, 0, 0, 45, 27), windowMaxCost(costmap, 0, 0, 45, 27));
+  pyramid.setLevels(3);
+  EXPECT_EQ(pyramid.getMaxCost(costmap, 3, 4, 30, 20), windowMaxCost(costmap, 3, 4, 30, 20));
+
+  pyramid.update(costmap, 0, 0, 45, 27);
+  for (unsigned int y0 = 0; y0 < 27; y0 += 5) {
+    for (unsigned int x0 = 0; x0 < 45; x0 += 3) {
+      for (unsigned int size = 1; size < 30; size += 7) {
+        ASSERT_EQ(
+          pyramid.getMaxCost(costmap, x0, y0, x0 + size, y0 + size),
+          windowMaxCost(costmap, x0, y0, x0 + size, y0 + size)) <<
+          "window " << x0 << ", " << y0 << " size " << size;
+      }
+    }
+  }
+
+  // Empty windows are free, and the search stops at the first cell of the stop cost
+  EXPECT_EQ(pyramid.getMaxCost(costmap, 10, 10, 10, 20), 0);
+  EXPECT_EQ(pyramid.getMaxCost(costmap, 50, 0, 60, 10), 0);
+  EXPECT_GE(pyramid.getMaxCost(costmap, 0, 0, 45, 27, 1), 1);
+  EXPECT_EQ(pyramid.getMaxCost(costmap, 24, 3, 34, 11, 1), 0);
+}
+
+TEST(CostmapPyramid, masterCostmapChanges)
+{
+  nav2_costmap_2d::LayeredCostmap layers("frame", false, false);
+  layers.setPyramidLevels(2);
+  layers.resizeMap(8, 8, 0.1, 0.0, 0.0);
+  layers.updateMap(0.4, 0.4, 0.0);
+  nav2_costmap_2d::Costmap2D * costmap = layers.getCostmap();
+  EXPECT_EQ(layers.getCostmapPyramid().getMaxCost(*costmap, 0, 0, 8, 8), 0);
+
+  // Changes of the whole costmap, as a reset, are downsampled again
+  {
+    std::unique_lock<nav2_costmap_2d::Costmap2D::mutex_t> lock(*(costmap->getMutex()));
+    costmap->setCost(5, 3, nav2_costmap_2d::LETHAL_OBSTACLE);
+    layers.markUpdated();
+  }
+  expectDownsampled(*costmap, *layers.getCostmapPyramid().getLevel(2), 2);
+  expectDownsampled(*costmap, *layers.getCostmapPyramid().getLevel(4), 4);
+  EXPECT_EQ(
+    layers.getCostmapPyramid().getMaxCost(*costmap, 4, 2, 8, 4),
+    nav2_costmap_2d::LETHAL_OBSTACLE);
+}
@@ -0,0 +1,225 @@
+// Copyright (c) 2022 Samsung Research America
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License. Reserved.
+
+#include <gtest/gtest.h>
+
+#include <algorithm>
+#include <cstring>
+#include <fstream>
+#include <iterator>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "rclcpp/rclcpp.hpp"
+#include "nav2_costmap_2d/cost_values.hpp"
+#include "nav2_costmap_2d/costmap_recorder.hpp"
+#include "nav2_costmap_2d/layer.hpp"
+#include "nav2_costmap_2d/layered_costmap.hpp"
+#include "sensor_msgs/point_cloud2_iterator.hpp"
+
+class RclCppFixture
+{
+public:
+  RclCppFixture() {rclcpp::init(0, nullptr);}
+  ~RclCppFixture() {rclcpp::shutdown();}
+};
+RclCppFixture g_rclcppfixture;
+
+// Layer marking a cell of the master costmap, set before each update
+class MarkingLayer : public nav2_costmap_2d::Layer
+{
+public:
+  void reset() {}
+  bool isClearable() {return false;}
+
+  void updateBounds(
+    double, double, double, double * min_x, double * min_y, double * max_x, double * max_y)
+  {
+    *min_x = std::min(*min_x, x_);
+    *min_y = std::min(*min_y, y_);
+    *max_x = std::max(*max_x, x_);
+    *max_y = std::max(*max_y, y_);
+  }
+
+  void updateCosts(nav2_costmap_2d::Costmap2D & master_grid, int, int, int, int)
+  {
+    unsigned int mx, my;
+    if (master_grid.worldToMap(x_, y_, mx, my)) {
+      master_grid.setCost(mx, my, nav2_costmap_2d::LETHAL_OBSTACLE);
+    }
+  }
+
+  double x_{0.0};
+  double y_{0.0};
+};
+
+class CostmapRecorderTest : public ::testing::Test
+{
+public:
+  CostmapRecorderTest()
+  : node_(std::make_shared<nav2_util::LifecycleNode>("test_node")),
+    tf_(node_->get_clock()),
+    layers_("frame", false, false),
+    layer_(std::make_shared<MarkingLayer>()),
+    path_(testing::TempDir() + "costmap_recorder_test.rec")
+  {
+    layers_.resizeMap(20, 20, 0.5, 0.0, 0.0);
+    layer_->initialize(&layers_, "marking", &tf_, node_, nullptr, nullptr);
+    layers_.addPlugin(layer_);
+  }
+
+  // Update at a cell marked, recording the cycle and a copy of the master costmap
+  void update(nav2_costmap_2d::CostmapRecorder & recorder, double x, double y)
+  {
+    layer_->x_ = x;
+    layer_->y_ = y;
+    layers_.updateMap(x, y, 0.0);
+    recorder.recordCycle(++stamp_ns_, x, y, 0.0, layers_);
+    nav2_costmap_2d::Costmap2D * costmap = layers_.getCostmap();
+    costmaps_.emplace_back(
+      costmap->getCharMap(),
+      costmap->getCharMap() + costmap->getSizeInCellsX() * costmap->getSizeInCellsY());
+  }
+
+  void expectCostmap(const nav2_costmap_2d::Costmap2D & costmap, size_t cycle)
+  {
+    ASSERT_EQ(
+      static_cast<size_t>(costmap.getSizeInCellsX()) * costmap.getSizeInCellsY(),
+      costmaps_[cycle].size());
+    EXPECT_EQ(
+      std::memcmp(costmap.getCharMap(), costmaps_[cycle].data(), costmaps_[cycle].size()), 0);
+  }
+
+protected:
+  nav2_util::LifecycleNode::SharedPtr node_;
+  tf2_ros::Buffer tf_;
+  nav2_costmap_2d::LayeredCostmap layers_;
+  std::shared_ptr<MarkingLayer> layer_;
+  std::string path_;
+  int64_t stamp_ns_{0};
+  std::vector<std::vector<unsigned char>> costmaps_;
+};
+
+TEST_F(CostmapRecorderTest, readsRecordedCycles)
+{
+  {
+    nav2_costmap_2d::CostmapRecorder recorder(path_, 3, rclcpp::get_logger("test"));
+    ASSERT_TRUE(recorder.isOpen());
+    for (unsigned int i = 0; i < 5; ++i) {
+      update(recorder, 1.25 + i, 2.25 + 2 * i);
+    }
+    // A change of the geometry is a keyframe
+    layers_.resizeMap(30, 10, 0.5, -1.0, 0.0);
+    update(recorder, 3.25, 4.25);
+  }
+
+  nav2_costmap_2d::CostmapRecordReader reader(path_);
+  ASSERT_TRUE(reader.isOpen());
+  nav2_costmap_2d::CostmapRecord record;
+  const std::vector<bool> keyframes = {true, false, false, true, false, true};
+  for (size_t i = 0; i < keyframes.size(); ++i) {
+    ASSERT_TRUE(reader.next(record));
+    ASSERT_EQ(record.type, nav2_costmap_2d::CostmapRecord::CYCLE);
+    EXPECT_EQ(record.cycle.stamp_ns, static_cast<int64_t>(i + 1));
+    EXPECT_EQ(record.cycle.keyframe, keyframes[i]);
+    expectCostmap(reader.getCostmap(), i);
+  }
+  EXPECT_DOUBLE_EQ(record.cycle.robot_x, 3.25);
+  EXPECT_DOUBLE_EQ(record.cycle.robot_y, 4.25);
+  EXPECT_DOUBLE_EQ(reader.getCostmap().getOriginX(), -1.0);
+  EXPECT_FALSE(reader.next(record));
+  EXPECT_FALSE(reader.failed());
+}
+
+TEST_F(CostmapRecorderTest, readsRecordedObservations)
+{
+  nav2_costmap_2d::Observation observation;
+  observation.origin_.x = 1.0;
+  observation.origin_.y = 2.0;
+  observation.origin_.z = 0.5;
+  observation.obstacle_max_range_ = 2.5;
+  observation.raytrace_max_range_ = 3.0;
+  sensor_msgs::msg::PointCloud2 & cloud = *(observation.cloud_);
+  cloud.header.stamp.sec = 12;
+  cloud.header.stamp.nanosec = 345;
+  sensor_msgs::PointCloud2Modifier modifier(cloud);
+  modifier.setPointCloud2FieldsByString(1, "xyz");
+  modifier.resize(3);
+  sensor_msgs::PointCloud2Iterator<float> iter_x(cloud, "x");
+  sensor_msgs::PointCloud2Iterator<float> iter_y(cloud, "y");
+  sensor_msgs::PointCloud2Iterator<float> iter_z(cloud, "z");
+  for (int i = 0; i < 3; ++i, ++iter_x, ++iter_y, ++iter_z) {
+    *iter_x = 1.5f * i;
+    *iter_y = -0.5f * i;
+    *iter_z = 0.25f;
+  }
+
+  {
+    nav2_costmap_2d::CostmapRecorder recorder(path_, 10, rclcpp::get_logger("test"));
+    const uint32_t source = recorder.addSource({"obstacles", "scan", 0.5, true, false});
+    recorder.recordObservation(source, observation);
+  }
+
+  nav2_costmap_2d::CostmapRecordReader reader(path_);
+  nav2_costmap_2d::CostmapRecord record;
+  ASSERT_TRUE(reader.next(record));
+  ASSERT_EQ(record.type, nav2_costmap_2d::CostmapRecord::SOURCE);
+  EXPECT_EQ(record.source.layer, "obstacles");
+  EXPECT_EQ(record.source.topic, "scan");
+  EXPECT_DOUBLE_EQ(record.source.keep_time, 0.5);
+  EXPECT_TRUE(record.source.marking);
+  EXPECT_FALSE(record.source.clearing);
+  const uint32_t source = record.source_id;
+  EXPECT_EQ(reader.getSources().count(source), 1u);
+
+  ASSERT_TRUE(reader.next(record));
+  ASSERT_EQ(record.type, nav2_costmap_2d::CostmapRecord::OBSERVATION);
+  EXPECT_EQ(record.source_id, source);
+  const nav2_costmap_2d::Observation & read = record.observation;
+  EXPECT_DOUBLE_EQ(read.origin_.y, 2.0);
+  EXPECT_DOUBLE_EQ(read.origin_.z, 0.5);
+  EXPECT_DOUBLE_EQ(read.obstacle_max_range_, 2.5);
+  EXPECT_DOUBLE_EQ(read.raytrace_max_range_, 3.0);
+  EXPECT_EQ(read.cloud_->header.stamp.sec, 12);
+  EXPECT_EQ(read.cloud_->header.stamp.nanosec, 345u);
+  ASSERT_EQ(read.cloud_->width * read.cloud_->height, 3u);
+  sensor_msgs::PointCloud2ConstIterator<float> read_x(*(read.cloud_), "x");
+  sensor_msgs::PointCloud2ConstIterator<float> read_y(*(read.cloud_), "y");
+  EXPECT_FLOAT_EQ(*(read_x + 2), 3.0f);
+  EXPECT_FLOAT_EQ(*(read_y + 2), -1.0f);
+  EXPECT_FALSE(reader.next(record));
+}
+
+TEST_F(CostmapRecorderTest, failsOnTruncatedRecordings)
+{
+  {
+    nav2_costmap_2d::CostmapRecorder recorder(path_, 10, rclcpp::get_logger("test"));
+    update(recorder, 1.25, 1.25);
+  }
+  std::ifstream in(path_, std::ios::binary);
+  std::string contents((std::istreambuf_iterator<char>(in)), std::istreambuf_iterator<char>());
+  in.close();
+  std::ofstream(path_, std::ios::binary | std::ios::trunc).write(
+    contents.data(), contents.size() - 1);
+
+  nav2_costmap_2d::CostmapRecordReader reader(path_);
+  ASSERT_TRUE(reader.isOpen());
+  nav2_costmap_2d::CostmapRecord record;
+  EXPECT_FALSE(reader.next(record));
+  EXPECT_TRUE(reader.failed());
+
+  std::ofstream(path_, std::ios::binary | std::ios::trunc) << "not a recording";
+  EXPECT_FALSE(nav2_costmap_2d::CostmapRecordReader(path_).isOpen());
+}
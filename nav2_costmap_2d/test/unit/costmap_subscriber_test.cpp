@@ -0,0 +1,309 @@
+// Copyright (c) 2022 Samsung Research America
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License. Reserved.
+
+#include <gtest/gtest.h>
+
+#include <algorithm>
+#include <chrono>
+#include <map>
+#include <memory>
+#include <thread>
+#include <utility>
+#include <vector>
+
+#include "rclcpp/rclcpp.hpp"
+#include "nav2_costmap_2d/costmap_subscriber.hpp"
+#include "nav2_costmap_2d/costmap_compression.hpp"
+#include "nav2_costmap_2d/costmap_registry.hpp"
+#include "nav2_costmap_2d/layer.hpp"
+#include "std_srvs/srv/empty.hpp"
+
+class RclCppFixture
+{
+public:
+  RclCppFixture() {rclcpp::init(0, nullptr);}
+  ~RclCppFixture() {rclcpp::shutdown();}
+};
+RclCppFixture g_rclcppfixture;
+
+nav2_msgs::msg::Costmap::SharedPtr makeCostmapMsg(
+  unsigned int size_x, unsigned int size_y, unsigned char cost, int32_t sec)
+{
+  auto msg = std::make_shared<nav2_msgs::msg::Costmap>();
+  msg->header.stamp.sec = sec;
+  msg->metadata.resolution = 0.05;
+  msg->metadata.size_x = size_x;
+  msg->metadata.size_y = size_y;
+  msg->data.assign(size_x * size_y, cost);
+  return msg;
+}
+
+nav2_msgs::msg::CostmapUpdate::SharedPtr makeUpdateMsg(
+  unsigned int x, unsigned int y, unsigned int size_x, unsigned int size_y,
+  unsigned char cost, int32_t sec)
+{
+  auto msg = std::make_shared<nav2_msgs::msg::CostmapUpdate>();
+  msg->header.stamp.sec = sec;
+  msg->x = x;
+  msg->y = y;
+  msg->size_x = size_x;
+  msg->size_y = size_y;
+  msg->data.assign(size_x * size_y, cost);
+  return msg;
+}
+
+TEST(CostmapSubscriber, appliesUpdates)
+{
+  auto node = std::make_shared<rclcpp::Node>("costmap_subscriber_test");
+  nav2_costmap_2d::CostmapSubscriber subscriber(node, "costmap_raw");
+
+  EXPECT_THROW(subscriber.getCostmap(), std::runtime_error);
+
+  // Updates before any full costmap are dropped
+  subscriber.costmapUpdateCallback(makeUpdateMsg(0, 0, 2, 2, 100, 1));
+  subscriber.costmapCallback(makeCostmapMsg(10, 8, 0, 2));
+  auto costmap = subscriber.getCostmap();
+  ASSERT_EQ(costmap->getSizeInCellsX(), 10u);
+  ASSERT_EQ(costmap->getSizeInCellsY(), 8u);
+  EXPECT_EQ(costmap->getCost(0, 0), 0);
+
+  subscriber.costmapUpdateCallback(makeUpdateMsg(3, 2, 4, 3, 254, 3));
+  costmap = subscriber.getCostmap();
+  for (unsigned int y = 0; y < 8; y++) {
+    for (unsigned int x = 0; x < 10; x++) {
+      const bool in_window = x >= 3 && x < 7 && y >= 2 && y < 5;
+      EXPECT_EQ(costmap->getCost(x, y), in_window ? 254 : 0);
+    }
+  }
+
+  // Updates older than the full costmap or outside of it are dropped
+  subscriber.costmapUpdateCallback(makeUpdateMsg(0, 0, 1, 1, 100, 1));
+  subscriber.costmapUpdateCallback(makeUpdateMsg(8, 0, 3, 1, 100, 4));
+  costmap = subscriber.getCostmap();
+  EXPECT_EQ(costmap->getCost(0, 0), 0);
+  EXPECT_EQ(costmap->getCost(9, 0), 0);
+
+  // More updates than are kept pending are still all applied
+  for (unsigned int i = 0; i < 40; i++) {
+    subscriber.costmapUpdateCallback(makeUpdateMsg(i % 10, i / 10, 1, 1, 50 + i, 5));
+  }
+  costmap = subscriber.getCostmap();
+  for (unsigned int i = 0; i < 40; i++) {
+    EXPECT_EQ(costmap->getCost(i % 10, i / 10), 50 + i);
+  }
+
+  // A new full costmap replaces the previous costs and size
+  subscriber.costmapCallback(makeCostmapMsg(5, 5, 10, 6));
+  costmap = subscriber.getCostmap();
+  ASSERT_EQ(costmap->getSizeInCellsX(), 5u);
+  EXPECT_EQ(costmap->getCost(4, 4), 10);
+}
+
+TEST(CostmapSubscriber, requestsFullCostmapPastLostUpdates)
+{
+  auto node = std::make_shared<rclcpp::Node>("costmap_subscriber_resync_test");
+  int requests = 0;
+  auto service = node->create_service<std_srvs::srv::Empty>(
+    "costmap_raw_resync",
+    [&requests](
+      const std::shared_ptr<rmw_request_id_t>,
+      const std::shared_ptr<std_srvs::srv::Empty::Request>,
+      std::shared_ptr<std_srvs::srv::Empty::Response>) {++requests;});
+  nav2_costmap_2d::CostmapSubscriber subscriber(node, "costmap_raw");
+  auto client = node->create_client<std_srvs::srv::Empty>("costmap_raw_resync");
+  ASSERT_TRUE(client->wait_for_service(std::chrono::seconds(5)));
+
+  auto numbered = [](
+    unsigned int x, unsigned char cost, int32_t sec, int32_t base_sec, uint64_t sequence) {
+      auto msg = makeUpdateMsg(x, 0, 1, 1, cost, sec);
+      msg->base_stamp.sec = base_sec;
+      msg->sequence = sequence;
+      return msg;
+    };
+  subscriber.costmapCallback(makeCostmapMsg(10, 8, 0, 2));
+  subscriber.costmapUpdateCallback(numbered(0, 100, 3, 2, 1));
+  // Updates of a full costmap not received yet are dropped
+  subscriber.costmapUpdateCallback(numbered(1, 100, 4, 3, 1));
+  auto costmap = subscriber.getCostmap();
+  EXPECT_EQ(costmap->getCost(0, 0), 100);
+  EXPECT_EQ(costmap->getCost(1, 0), 0);
+
+  // Past a lost update, the following ones are dropped and a full costmap is requested once
+  subscriber.costmapUpdateCallback(numbered(2, 100, 5, 2, 3));
+  subscriber.costmapUpdateCallback(numbered(3, 100, 6, 2, 4));
+  costmap = subscriber.getCostmap();
+  EXPECT_EQ(costmap->getCost(2, 0), 0);
+  EXPECT_EQ(costmap->getCost(3, 0), 0);
+  for (int i = 0; i < 50 && requests == 0; i++) {
+    rclcpp::spin_some(node);
+    std::this_thread::sleep_for(std::chrono::milliseconds(10));
+  }
+  EXPECT_EQ(requests, 1);
+
+  // Until the full costmap is received, the updates of which apply again
+  subscriber.costmapCallback(makeCostmapMsg(10, 8, 10, 7));
+  subscriber.costmapUpdateCallback(numbered(4, 100, 8, 7, 1));
+  costmap = subscriber.getCostmap();
+  EXPECT_EQ(costmap->getCost(3, 0), 10);
+  EXPECT_EQ(costmap->getCost(4, 0), 100);
+}
+
+nav2_msgs::msg::CompressedCostmap::SharedPtr compress(
+  const nav2_msgs::msg::Costmap & costmap, unsigned int x, unsigned int y,
+  unsigned int size_x, unsigned int size_y, int32_t sec)
+{
+  auto msg = std::make_shared<nav2_msgs::msg::CompressedCostmap>();
+  msg->header.stamp.sec = sec;
+  msg->metadata = costmap.metadata;
+  msg->x = x;
+  msg->y = y;
+  msg->size_x = size_x;
+  msg->size_y = size_y;
+  msg->format = "rle";
+  nav2_costmap_2d::encodeRunLength(
+    costmap.data.data() + y * costmap.metadata.size_x + x, size_x, size_y,
+    costmap.metadata.size_x, msg->data);
+  return msg;
+}
+
+TEST(CostmapSubscriber, decodesCompressedCostmaps)
+{
+  auto node = std::make_shared<rclcpp::Node>("compressed_costmap_subscriber_test");
+  nav2_costmap_2d::CostmapSubscriber subscriber(node, "costmap_raw", true);
+
+  auto costmap_msg = makeCostmapMsg(20, 10, 0, 1);
+  for (unsigned int i = 0; i < 20; i++) {
+    costmap_msg->data[5 * 20 + i] = 254;
+  }
+  subscriber.compressedCostmapCallback(compress(*costmap_msg, 0, 0, 20, 10, 1));
+  auto costmap = subscriber.getCostmap();
+  ASSERT_EQ(costmap->getSizeInCellsX(), 20u);
+  ASSERT_EQ(costmap->getSizeInCellsY(), 10u);
+  for (unsigned int y = 0; y < 10; y++) {
+    for (unsigned int x = 0; x < 20; x++) {
+      EXPECT_EQ(costmap->getCost(x, y), y == 5 ? 254 : 0);
+    }
+  }
+
+  // Compressed window of the changed costs
+  for (unsigned int i = 2; i < 8; i++) {
+    costmap_msg->data[i * 20 + 10] = 100;
+  }
+  subscriber.compressedCostmapUpdateCallback(compress(*costmap_msg, 10, 2, 1, 6, 2));
+  costmap = subscriber.getCostmap();
+  for (unsigned int y = 0; y < 10; y++) {
+    EXPECT_EQ(costmap->getCost(10, y), (y >= 2 && y < 8) ? 100 : 0);
+  }
+
+  // Malformed data is dropped
+  auto malformed = compress(*costmap_msg, 0, 0, 1, 1, 3);
+  malformed->data.push_back(1);
+  subscriber.compressedCostmapUpdateCallback(malformed);
+  costmap = subscriber.getCostmap();
+  EXPECT_EQ(costmap->getCost(0, 0), 0);
+}
+
+// Sets the costs of a few cells, updating only the window of the cells changed since
+class CellsLayer : public nav2_costmap_2d::Layer
+{
+public:
+  explicit CellsLayer(nav2_costmap_2d::LayeredCostmap * parent)
+  {
+    layered_costmap_ = parent;
+  }
+
+  void reset() override {}
+  bool isClearable() override {return false;}
+
+  void setCost(unsigned int x, unsigned int y, unsigned char cost)
+  {
+    costs_[{x, y}] = cost;
+    double wx, wy;
+    layered_costmap_->getCostmap()->mapToWorld(x, y, wx, wy);
+    changed_.push_back({wx, wy});
+  }
+
+  void updateBounds(
+    double, double, double, double * min_x, double * min_y, double * max_x,
+    double * max_y) override
+  {
+    for (const auto & point : changed_) {
+      *min_x = std::min(*min_x, point.first);
+      *min_y = std::min(*min_y, point.second);
+      *max_x = std::max(*max_x, point.first);
+      *max_y = std::max(*max_y, point.second);
+    }
+    changed_.clear();
+  }
+
+  void updateCosts(
+    nav2_costmap_2d::Costmap2D & master_grid, int min_i, int min_j, int max_i,
+    int max_j) override
+  {
+    for (const auto & cell : costs_) {
+      const int x = cell.first.first, y = cell.first.second;
+      if (x >= min_i && x < max_i && y >= min_j && y < max_j) {
+        master_grid.setCost(x, y, cell.second);
+      }
+    }
+  }
+
+protected:
+  std::map<std::pair<unsigned int, unsigned int>, unsigned char> costs_;
+  std::vector<std::pair<double, double>> changed_;
+};
+
+TEST(CostmapSubscriber, readsInProcessCostmap)
+{
+  auto node = std::make_shared<rclcpp::Node>("in_process_costmap_subscriber_test");
+  nav2_costmap_2d::CostmapSubscriber subscriber(node, "in_process/costmap_raw");
+  subscriber.setInProcess(true);
+
+  // Without a costmap in process nor messages, there is no costmap yet
+  EXPECT_THROW(subscriber.getCostmap(), std::runtime_error);
+
+  nav2_costmap_2d::LayeredCostmap layers("map", false, false);
+  layers.resizeMap(10, 8, 0.05, 0.0, 0.0);
+  auto layer = std::make_shared<CellsLayer>(&layers);
+  layers.addPlugin(layer);
+  layers.updateMap(0.0, 0.0, 0.0);
+  nav2_costmap_2d::CostmapRegistry::getInstance().add("/in_process/costmap_raw", &layers);
+
+  auto costmap = subscriber.getCostmap();
+  ASSERT_EQ(costmap->getSizeInCellsX(), 10u);
+  ASSERT_EQ(costmap->getSizeInCellsY(), 8u);
+  EXPECT_EQ(costmap->getCost(3, 2), 0);
+  const uint64_t revision = subscriber.getRevision();
+
+  // Only the window changed is copied, and reported as changed
+  layer->setCost(3, 2, 254);
+  layers.updateMap(0.0, 0.0, 0.0);
+  costmap = subscriber.getCostmap();
+  EXPECT_EQ(costmap->getCost(3, 2), 254);
+  std::vector<nav2_costmap_2d::CostmapSubscriber::ChangedWindow> windows;
+  ASSERT_TRUE(subscriber.getChangedWindows(revision, windows));
+  ASSERT_FALSE(windows.empty());
+  EXPECT_LE(windows.front().x0, 3u);
+  EXPECT_GT(windows.front().xn, 3u);
+
+  // A resize invalidates the windows, the whole costmap being copied again
+  layers.resizeMap(5, 5, 0.05, 0.0, 0.0);
+  costmap = subscriber.getCostmap();
+  EXPECT_EQ(costmap->getSizeInCellsX(), 5u);
+  EXPECT_FALSE(subscriber.getChangedWindows(revision, windows));
+
+  // Once unregistered, the costmap is only received from the topics again
+  nav2_costmap_2d::CostmapRegistry::getInstance().remove("/in_process/costmap_raw", &layers);
+  EXPECT_THROW(subscriber.getCostmap(), std::runtime_error);
+}
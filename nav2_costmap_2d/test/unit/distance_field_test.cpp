@@ -0,0 +1,188 @@
+// Copyright (c) 2022 Samsung Research America
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License. Reserved.
+
+#include <gtest/gtest.h>
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+#include "nav2_costmap_2d/cost_values.hpp"
+#include "nav2_costmap_2d/costmap_2d.hpp"
+#include "nav2_costmap_2d/distance_field.hpp"
+
+using nav2_costmap_2d::LETHAL_OBSTACLE;
+
+// Brute force signed distance of a cell, truncated to the maximum distance
+static float bruteForceDistance(
+  const nav2_costmap_2d::Costmap2D & costmap, unsigned int mx, unsigned int my,
+  double max_distance)
+{
+  const bool lethal = costmap.getCost(mx, my) == LETHAL_OBSTACLE;
+  double best = std::numeric_limits<double>::max();
+  for (unsigned int y = 0; y < costmap.getSizeInCellsY(); ++y) {
+    for (unsigned int x = 0; x < costmap.getSizeInCellsX(); ++x) {
+      if ((costmap.getCost(x, y) == LETHAL_OBSTACLE) != lethal) {
+        const double dx = static_cast<double>(x) - mx;
+        const double dy = static_cast<double>(y) - my;
+        best = std::min(best, std::hypot(dx, dy) * costmap.getResolution());
+      }
+    }
+  }
+  const double distance = std::min(best, max_distance);
+  return static_cast<float>(lethal ? -distance : distance);
+}
+
+static void expectDistances(
+  const nav2_costmap_2d::Costmap2D & costmap, const nav2_costmap_2d::DistanceField & field)
+{
+  ASSERT_EQ(field.getSizeInCellsX(), costmap.getSizeInCellsX());
+  ASSERT_EQ(field.getSizeInCellsY(), costmap.getSizeInCellsY());
+  for (unsigned int y = 0; y < costmap.getSizeInCellsY(); ++y) {
+    for (unsigned int x = 0; x < costmap.getSizeInCellsX(); ++x) {
+      ASSERT_NEAR(
+        field.getDistance(x, y),
+        bruteForceDistance(costmap, x, y, field.getMaxDistance()), 1e-5) <<
+        "cell " << x << ", " << y;
+    }
+  }
+}
+
+TEST(DistanceField, enabling)
+{
+  nav2_costmap_2d::Costmap2D costmap(10, 10, 0.1, 0.0, 0.0, 0);
+  nav2_costmap_2d::DistanceField field;
+  EXPECT_FALSE(field.isEnabled());
+
+  // A disabled field isn't computed
+  field.update(costmap, 0, 0, 10, 10);
+  EXPECT_EQ(field.getSizeInCellsX(), 0u);
+  float distance;
+  EXPECT_FALSE(field.getDistance(0.5, 0.5, distance));
+
+  field.setMaxDistance(0.5);
+  EXPECT_TRUE(field.isEnabled());
+  EXPECT_DOUBLE_EQ(field.getMaxDistance(), 0.5);
+  field.update(costmap, 0, 0, 0, 0);
+  expectDistances(costmap, field);
+
+  field.setMaxDistance(0.0);
+  EXPECT_FALSE(field.isEnabled());
+  EXPECT_EQ(field.getSizeInCellsX(), 0u);
+}
+
+TEST(DistanceField, windowUpdates)
+{
+  nav2_costmap_2d::Costmap2D costmap(41, 23, 0.05, -1.0, 3.0, 0);
+  costmap.setCost(0, 0, LETHAL_OBSTACLE);
+  costmap.setCost(40, 22, LETHAL_OBSTACLE);
+  for (unsigned int x = 10; x < 16; ++x) {
+    for (unsigned int y = 5; y < 9; ++y) {
+      costmap.setCost(x, y, LETHAL_OBSTACLE);
+    }
+  }
+  // Inflated and unknown cells are free space to the field
+  costmap.setCost(30, 10, nav2_costmap_2d::INSCRIBED_INFLATED_OBSTACLE);
+  costmap.setCost(31, 10, nav2_costmap_2d::NO_INFORMATION);
+
+  nav2_costmap_2d::DistanceField field;
+  field.setMaxDistance(0.3);
+
+  // The first update computes the whole field, whatever its window
+  field.update(costmap, 0, 0, 0, 0);
+  expectDistances(costmap, field);
+
+  // Update a window which both adds and removes lethal cells
+  costmap.setCost(12, 6, 0);
+  costmap.setCost(13, 7, 0);
+  costmap.setCost(25, 15, LETHAL_OBSTACLE);
+  field.update(costmap, 12, 6, 26, 16);
+  expectDistances(costmap, field);
+
+  // Changes outside of the window are not seen until they are updated, nor with an
+  // empty window
+  costmap.setCost(35, 3, LETHAL_OBSTACLE);
+  field.update(costmap, 2, 20, 3, 21);
+  field.update(costmap, 35, 3, 35, 3);
+  EXPECT_FLOAT_EQ(field.getDistance(35, 3), 0.3f);
+  field.update(costmap, 35, 3, 36, 4);
+  expectDistances(costmap, field);
+
+  // Unless the field was invalidated
+  costmap.setCost(3, 18, LETHAL_OBSTACLE);
+  field.invalidate();
+  field.update(costmap, 0, 0, 0, 0);
+  expectDistances(costmap, field);
+}
+
+TEST(DistanceField, geometryChanges)
+{
+  nav2_costmap_2d::Costmap2D costmap(16, 16, 0.1, 0.0, 0.0, 0);
+  costmap.setCost(3, 3, LETHAL_OBSTACLE);
+
+  nav2_costmap_2d::DistanceField field;
+  field.setMaxDistance(0.4);
+  field.update(costmap, 0, 0, 16, 16);
+  expectDistances(costmap, field);
+
+  // A moved origin recomputes the whole field, even with an empty window
+  costmap.updateOrigin(0.5, 0.2);
+  costmap.setCost(0, 0, LETHAL_OBSTACLE);
+  field.update(costmap, 0, 0, 0, 0);
+  expectDistances(costmap, field);
+
+  // So does a resize
+  costmap.resizeMap(9, 5, 0.2, 1.0, 1.0);
+  costmap.setCost(8, 4, LETHAL_OBSTACLE);
+  field.update(costmap, 8, 4, 9, 5);
+  expectDistances(costmap, field);
+}
+
+TEST(DistanceField, interpolation)
+{
+  // A wall along the column x = 0
+  nav2_costmap_2d::Costmap2D costmap(20, 10, 0.1, 0.0, 0.0, 0);
+  for (unsigned int y = 0; y < 10; ++y) {
+    costmap.setCost(0, y, LETHAL_OBSTACLE);
+  }
+
+  nav2_costmap_2d::DistanceField field;
+  field.setMaxDistance(1.0);
+  field.update(costmap, 0, 0, 20, 10);
+
+  // Distances are exact at cell centers and linear in between them
+  float distance, gradient_x, gradient_y;
+  ASSERT_TRUE(field.getDistanceAndGradient(0.55, 0.45, distance, gradient_x, gradient_y));
+  EXPECT_NEAR(distance, 0.5f, 1e-5);
+  EXPECT_NEAR(gradient_x, 1.0f, 1e-5);
+  EXPECT_NEAR(gradient_y, 0.0f, 1e-5);
+  ASSERT_TRUE(field.getDistance(0.6, 0.45, distance));
+  EXPECT_NEAR(distance, 0.55f, 1e-5);
+
+  // A lethal cell is at minus the distance to the nearest free cell
+  ASSERT_TRUE(field.getDistance(0.05, 0.45, distance));
+  EXPECT_NEAR(distance, -0.1f, 1e-5);
+
+  // The gradient vanishes where the distance is truncated
+  ASSERT_TRUE(field.getDistanceAndGradient(1.6, 0.55, distance, gradient_x, gradient_y));
+  EXPECT_FLOAT_EQ(distance, 1.0f);
+  EXPECT_FLOAT_EQ(gradient_x, 0.0f);
+  EXPECT_FLOAT_EQ(gradient_y, 0.0f);
+
+  // Points near the edges take the edge cells, and points outside of the map fail
+  ASSERT_TRUE(field.getDistance(1.99, 0.99, distance));
+  EXPECT_FLOAT_EQ(distance, 1.0f);
+  EXPECT_FALSE(field.getDistance(-0.01, 0.5, distance));
+  EXPECT_FALSE(field.getDistance(0.5, 1.0, distance));
+}
@@ -12,9 +12,11 @@
 // See the License for the specific language governing permissions and
 // limitations under the License.
 
+#include <algorithm>
 #include <string>
 #include <vector>
 #include <memory>
+#include <utility>
 
 #include "gtest/gtest.h"
 #include "nav2_costmap_2d/footprint_collision_checker.hpp"
@@ -250,3 +252,205 @@ TEST(collision_footprint, make_footprint_from_string_not_pairs) {
     "[[1, 2.2], [.3, -4e4], [-.3, -4e4], [-1, 2.2, 5.6]]", footprint);
   EXPECT_EQ(result, false);
 }
+
+TEST(collision_footprint, raster_matches_outline_cost) {
+  std::shared_ptr<nav2_costmap_2d::Costmap2D> costmap_ =
+    std::make_shared<nav2_costmap_2d::Costmap2D>(100, 100, 0.1, 0, 0, 0);
+  for (unsigned int i = 0; i < 100; ++i) {
+    for (unsigned int j = 0; j < 100; ++j) {
+      costmap_->setCost(i, j, (i * 31 + j * 17) % 97 == 0 ? 254 : (i * 13 + j * 7) % 200);
+    }
+  }
+
+  nav2_costmap_2d::Footprint footprint;
+  std::vector<std::pair<double, double>> vertices =
+  {{0.53, 0.27}, {-0.38, 0.31}, {-0.44, -0.29}, {0.47, -0.33}};
+  for (const auto & vertex : vertices) {
+    geometry_msgs::msg::Point pt;
+    pt.x = vertex.first;
+    pt.y = vertex.second;
+    footprint.push_back(pt);
+  }
+
+  nav2_costmap_2d::FootprintCollisionChecker<std::shared_ptr<nav2_costmap_2d::Costmap2D>>
+  collision_checker(costmap_);
+  collision_checker.setFootprintRaster(footprint, 16);
+
+  // At cell centers and on raster headings, the outline is the same as when traced
+  std::vector<geometry_msgs::msg::Pose2D> poses;
+  for (unsigned int heading = 0; heading < 16; ++heading) {
+    for (unsigned int i = 20; i < 80; i += 7) {
+      geometry_msgs::msg::Pose2D pose;
+      pose.x = (i + 0.5) * 0.1;
+      pose.y = (100 - i + 0.5) * 0.1 - 2.0;
+      pose.theta = heading * 2.0 * M_PI / 16 - M_PI;
+      poses.push_back(pose);
+    }
+  }
+
+  std::vector<double> costs;
+  collision_checker.footprintRasterCostsAtPoses(poses, costs);
+  ASSERT_EQ(costs.size(), poses.size());
+  for (unsigned int i = 0; i < poses.size(); ++i) {
+    EXPECT_EQ(
+      costs[i],
+      collision_checker.footprintCostAtPose(poses[i].x, poses[i].y, poses[i].theta, footprint));
+  }
+
+  // Headings round to the nearest raster
+  EXPECT_EQ(
+    collision_checker.footprintRasterCostAtPose(5.05, 5.05, 0.1),
+    collision_checker.footprintCostAtPose(5.05, 5.05, 0.0, footprint));
+  EXPECT_EQ(
+    collision_checker.footprintRasterCostAtPose(5.05, 5.05, 2.0 * M_PI + 0.1),
+    collision_checker.footprintCostAtPose(5.05, 5.05, 0.0, footprint));
+
+  // Leaving the costmap is a collision
+  EXPECT_EQ(collision_checker.footprintRasterCostAtPose(0.25, 5.0, 0.0), 254);
+  EXPECT_EQ(collision_checker.footprintRasterCostAtPose(-1.0, 5.0, 0.0), 254);
+}
+
+TEST(collision_footprint, raster_interior) {
+  std::shared_ptr<nav2_costmap_2d::Costmap2D> costmap_ =
+    std::make_shared<nav2_costmap_2d::Costmap2D>(100, 100, 0.1, 0, 0, 0);
+  costmap_->setCost(50, 50, 254);
+  costmap_->setCost(52, 49, 100);
+
+  nav2_costmap_2d::Footprint footprint = nav2_costmap_2d::makeFootprintFromRadius(0.43);
+
+  nav2_costmap_2d::FootprintCollisionChecker<std::shared_ptr<nav2_costmap_2d::Costmap2D>>
+  collision_checker(costmap_);
+
+  // No raster was set
+  EXPECT_EQ(collision_checker.footprintRasterCostAtPose(5.05, 5.05, 0.0), 254);
+  EXPECT_TRUE(collision_checker.getFootprintRaster(0.0).empty());
+
+  // The obstacles are inside of the footprint, but not on its outline
+  collision_checker.setFootprintRaster(footprint, 8);
+  EXPECT_EQ(collision_checker.footprintRasterCostAtPose(5.05, 5.05, 0.0), 0);
+  EXPECT_EQ(collision_checker.footprintCostAtPose(5.05, 5.05, 0.0, footprint), 0);
+
+  collision_checker.setFootprintRaster(footprint, 8, true);
+  EXPECT_EQ(collision_checker.footprintRasterCostAtPose(5.05, 5.05, 0.0), 254);
+  const auto & cells = collision_checker.getFootprintRaster(0.1);
+  EXPECT_NE(std::find(cells.begin(), cells.end(), std::make_pair(0, 0)), cells.end());
+  EXPECT_TRUE(std::is_sorted(
+      cells.begin(), cells.end(),
+      [](const std::pair<int, int> & a, const std::pair<int, int> & b) {
+        return a.second < b.second || (a.second == b.second && a.first < b.first);
+      }));
+  costmap_->setCost(50, 50, 0);
+  EXPECT_EQ(collision_checker.footprintRasterCostAtPose(5.05, 5.05, 0.0), 100);
+
+  // Rasters follow resolution changes of the costmap
+  costmap_->resizeMap(50, 50, 0.2, 0.0, 0.0);
+  costmap_->setCost(25, 25, 254);
+  EXPECT_EQ(collision_checker.footprintRasterCostAtPose(5.1, 5.1, 0.0), 254);
+  EXPECT_EQ(collision_checker.footprintRasterCostAtPose(4.1, 5.1, 0.0), 0);
+}
+
+TEST(collision_footprint, pyramid_matches_outline_cost) {
+  std::shared_ptr<nav2_costmap_2d::Costmap2D> costmap_ =
+    std::make_shared<nav2_costmap_2d::Costmap2D>(100, 100, 0.1, 0, 0, 0);
+  for (unsigned int i = 0; i < 20; ++i) {
+    costmap_->setCost(30 + 2 * i, 60, 254);
+    costmap_->setCost(70, 20 + i, 100);
+  }
+
+  nav2_costmap_2d::CostmapPyramid pyramid;
+  pyramid.setLevels(3);
+  pyramid.update(*costmap_, 0, 0, 100, 100);
+
+  nav2_costmap_2d::Footprint footprint = nav2_costmap_2d::makeFootprintFromRadius(0.43);
+  nav2_costmap_2d::FootprintCollisionChecker<std::shared_ptr<nav2_costmap_2d::Costmap2D>>
+  outline_checker(costmap_);
+  nav2_costmap_2d::FootprintCollisionChecker<std::shared_ptr<nav2_costmap_2d::Costmap2D>>
+  pyramid_checker(costmap_);
+  pyramid_checker.setCostmapPyramid(&pyramid);
+
+  for (double y = 0.2; y < 10.0; y += 0.37) {
+    for (double x = 0.2; x < 10.0; x += 0.37) {
+      EXPECT_EQ(
+        pyramid_checker.footprintCostAtPose(x, y, 0.3, footprint),
+        outline_checker.footprintCostAtPose(x, y, 0.3, footprint)) << x << ", " << y;
+    }
+  }
+
+  // Obstacles inside of the bounds but not under the outline are still traced
+  costmap_->setCost(15, 15, 254);
+  pyramid.update(*costmap_, 15, 15, 16, 16);
+  EXPECT_EQ(pyramid_checker.footprintCostAtPose(1.55, 1.55, 0.0, footprint), 0);
+}
+
+TEST(collision_footprint, sweep_matches_pose_by_pose_cost) {
+  std::shared_ptr<nav2_costmap_2d::Costmap2D> costmap_ =
+    std::make_shared<nav2_costmap_2d::Costmap2D>(100, 100, 0.1, 0, 0, 0);
+  for (unsigned int i = 0; i < 100; ++i) {
+    for (unsigned int j = 0; j < 100; ++j) {
+      costmap_->setCost(i, j, (i * 31 + j * 17) % 389 == 0 ? 254 : ((i + j) % 11 == 0) * 50);
+    }
+  }
+
+  nav2_costmap_2d::CostmapPyramid pyramid;
+  pyramid.setLevels(3);
+  pyramid.update(*costmap_, 0, 0, 100, 100);
+
+  nav2_costmap_2d::Footprint footprint;
+  std::vector<std::pair<double, double>> vertices =
+  {{0.33, 0.21}, {-0.28, 0.21}, {-0.28, -0.21}, {0.33, -0.21}};
+  for (const auto & vertex : vertices) {
+    geometry_msgs::msg::Point pt;
+    pt.x = vertex.first;
+    pt.y = vertex.second;
+    footprint.push_back(pt);
+  }
+
+  nav2_costmap_2d::FootprintCollisionChecker<std::shared_ptr<nav2_costmap_2d::Costmap2D>>
+  outline_checker(costmap_);
+  nav2_costmap_2d::FootprintCollisionChecker<std::shared_ptr<nav2_costmap_2d::Costmap2D>>
+  sweep_checker(costmap_);
+  sweep_checker.setCostmapPyramid(&pyramid);
+
+  // Arcs from many start poses, some of them leaving the costmap
+  for (unsigned int start = 0; start < 200; ++start) {
+    std::vector<geometry_msgs::msg::Pose2D> poses;
+    geometry_msgs::msg::Pose2D pose;
+    pose.x = 0.5 + (start * 37 % 90) * 0.1;
+    pose.y = 0.5 + (start * 53 % 90) * 0.1;
+    pose.theta = start * 0.7;
+    const double curvature = (static_cast<int>(start % 7) - 3) * 0.3;
+    for (unsigned int i = 0; i < 60; ++i) {
+      poses.push_back(pose);
+      pose.x += 0.05 * cos(pose.theta);
+      pose.y += 0.05 * sin(pose.theta);
+      pose.theta += 0.05 * curvature;
+    }
+
+    for (double cost : {1.0, 50.0, 254.0}) {
+      size_t expected = poses.size();
+      for (size_t i = 0; i < poses.size(); ++i) {
+        if (outline_checker.footprintCostAtPose(
+            poses[i].x, poses[i].y, poses[i].theta, footprint) >= cost)
+        {
+          expected = i;
+          break;
+        }
+      }
+      EXPECT_EQ(sweep_checker.findFootprintCostAtPoses(poses, footprint, cost), expected);
+      EXPECT_EQ(outline_checker.findFootprintCostAtPoses(poses, footprint, cost), expected);
+    }
+  }
+
+  // The search may start after poses already found, here with an obstacle under the
+  // front edge of the footprint at the first and last poses
+  std::vector<geometry_msgs::msg::Pose2D> poses(3);
+  poses[0].x = 3.05;
+  poses[0].y = 3.05;
+  poses[1].x = 5.05;
+  poses[1].y = 5.05;
+  poses[2] = poses[0];
+  costmap_->setCost(33, 30, 254);
+  pyramid.update(*costmap_, 33, 30, 34, 31);
+  EXPECT_EQ(sweep_checker.findFootprintCostAtPoses(poses, footprint, 254.0), 0u);
+  EXPECT_EQ(sweep_checker.findFootprintCostAtPoses(poses, footprint, 254.0, 1), 2u);
+}
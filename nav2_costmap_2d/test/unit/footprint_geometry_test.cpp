@@ -0,0 +1,78 @@
+// Copyright (c) 2022 Samsung Research America
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <gtest/gtest.h>
+
+#include <cmath>
+#include <memory>
+#include <vector>
+
+#include "nav2_costmap_2d/footprint.hpp"
+#include "nav2_costmap_2d/footprint_geometry.hpp"
+#include "nav2_costmap_2d/layered_costmap.hpp"
+
+static std::vector<geometry_msgs::msg::Point> rectangle(double length, double width)
+{
+  std::vector<geometry_msgs::msg::Point> footprint(4);
+  footprint[0].x = length / 2.0;
+  footprint[0].y = width / 2.0;
+  footprint[1].x = length / 2.0;
+  footprint[1].y = -width / 2.0;
+  footprint[2].x = -length / 2.0;
+  footprint[2].y = -width / 2.0;
+  footprint[3].x = -length / 2.0;
+  footprint[3].y = width / 2.0;
+  return footprint;
+}
+
+TEST(FootprintGeometry, computesRadiiAndOrientations)
+{
+  nav2_costmap_2d::FootprintGeometry geometry(rectangle(2.0, 1.0));
+  EXPECT_NEAR(geometry.getInscribedRadius(), 0.5, 1e-9);
+  EXPECT_NEAR(geometry.getCircumscribedRadius(), std::hypot(1.0, 0.5), 1e-9);
+
+  const auto & oriented = geometry.getOrientedFootprints(4);
+  ASSERT_EQ(oriented.size(), 4u);
+  // A quarter turn moves the front right corner to the front left
+  EXPECT_NEAR(oriented[0][0].x, 1.0, 1e-6);
+  EXPECT_NEAR(oriented[1][0].x, -0.5, 1e-6);
+  EXPECT_NEAR(oriented[1][0].y, 1.0, 1e-6);
+
+  // Computed once per number of headings
+  EXPECT_EQ(&geometry.getOrientedFootprints(4), &oriented);
+  EXPECT_EQ(geometry.getOrientedFootprints(8).size(), 8u);
+}
+
+TEST(FootprintGeometry, versionsAreUnique)
+{
+  nav2_costmap_2d::FootprintGeometry a(rectangle(2.0, 1.0));
+  nav2_costmap_2d::FootprintGeometry b(rectangle(2.0, 1.0));
+  EXPECT_NE(a.getVersion(), 0u);
+  EXPECT_NE(a.getVersion(), b.getVersion());
+}
+
+TEST(FootprintGeometry, layeredCostmapKeepsVersionOfSameFootprint)
+{
+  nav2_costmap_2d::LayeredCostmap layers("frame", false, false);
+  layers.setFootprint(rectangle(2.0, 1.0));
+  auto geometry = layers.getFootprintGeometry();
+  EXPECT_NEAR(layers.getInscribedRadius(), 0.5, 1e-9);
+
+  layers.setFootprint(rectangle(2.0, 1.0));
+  EXPECT_EQ(layers.getFootprintGeometry()->getVersion(), geometry->getVersion());
+
+  layers.setFootprint(rectangle(3.0, 1.0));
+  EXPECT_NE(layers.getFootprintGeometry()->getVersion(), geometry->getVersion());
+  EXPECT_NEAR(layers.getCircumscribedRadius(), std::hypot(1.5, 0.5), 1e-9);
+}
@@ -102,6 +102,7 @@ public:
 
 protected:
   void createMaps(unsigned char master_value, int8_t mask_value, const std::string & mask_frame);
+  void setMaskCell(unsigned int mx, unsigned int my, int8_t mask_value);
   void publishMaps();
   void rePublishInfo(double base, double multiplier);
   void rePublishMask();
@@ -174,6 +175,11 @@ void TestNode::createMaps(
   mask_->data.resize(width * height, mask_value);
 }
 
+void TestNode::setMaskCell(unsigned int mx, unsigned int my, int8_t mask_value)
+{
+  mask_->data[my * mask_->info.width + mx] = mask_value;
+}
+
 void TestNode::publishMaps()
 {
   info_publisher_ = std::make_shared<InfoPublisher>(0.0, 1.0);
@@ -467,6 +473,79 @@ TEST_F(TestNode, testDifferentFrames)
   reset();
 }
 
+TEST_F(TestNode, testMaskWithUnknownCells)
+{
+  // Initilize test system
+  createMaps(nav2_costmap_2d::FREE_SPACE, nav2_util::OCC_GRID_OCCUPIED, "map");
+  // Leave unknown holes in the mask: they should not change the master grid
+  setMaskCell(1, 1, nav2_util::OCC_GRID_UNKNOWN);
+  setMaskCell(0, 2, nav2_util::OCC_GRID_UNKNOWN);
+  publishMaps();
+  createKeepoutFilter("map");
+
+  // Test KeepoutFilter
+  geometry_msgs::msg::Pose2D pose;
+  keepout_filter_->process(*master_grid_, 0, 0, 10, 10, pose);
+  keepout_points_.push_back(Point{3, 3});
+  keepout_points_.push_back(Point{3, 4});
+  keepout_points_.push_back(Point{4, 3});
+  keepout_points_.push_back(Point{5, 3});
+  keepout_points_.push_back(Point{5, 4});
+  keepout_points_.push_back(Point{4, 5});
+  keepout_points_.push_back(Point{5, 5});
+  verifyMasterGrid(nav2_costmap_2d::FREE_SPACE, nav2_costmap_2d::LETHAL_OBSTACLE);
+
+  // Clean-up
+  keepout_filter_->resetFilter();
+  reset();
+}
+
+TEST_F(TestNode, testMisalignedRollingMaster)
+{
+  // Initilize test system
+  createMaps(nav2_costmap_2d::FREE_SPACE, nav2_util::OCC_GRID_OCCUPIED, "map");
+  publishMaps();
+  createKeepoutFilter("map");
+  // Master grid cells are shifted by a quarter of a cell from the mask cells
+  master_grid_ = std::make_shared<nav2_costmap_2d::Costmap2D>(
+    10, 10, 1.0, 0.25, 0.25, nav2_costmap_2d::FREE_SPACE);
+
+  // Test KeepoutFilter
+  geometry_msgs::msg::Pose2D pose;
+  keepout_filter_->process(*master_grid_, 0, 0, 10, 10, pose);
+  for (unsigned int y = 3; y < 6; y++) {
+    for (unsigned int x = 3; x < 6; x++) {
+      keepout_points_.push_back(Point{x, y});
+    }
+  }
+  verifyMasterGrid(nav2_costmap_2d::FREE_SPACE, nav2_costmap_2d::LETHAL_OBSTACLE);
+
+  // Roll the master grid by (2, 1) cells and start over from it free:
+  // the mask cells follow, including those projected from newly exposed cells
+  master_grid_->updateOrigin(2.25, 1.25);
+  master_grid_->resetMap(0, 0, 10, 10);
+  keepout_filter_->process(*master_grid_, 0, 0, 10, 10, pose);
+  for (Point & point : keepout_points_) {
+    point.x -= 2;
+    point.y -= 1;
+  }
+  verifyMasterGrid(nav2_costmap_2d::FREE_SPACE, nav2_costmap_2d::LETHAL_OBSTACLE);
+
+  // Roll the master grid back
+  master_grid_->updateOrigin(-0.75, -0.75);
+  master_grid_->resetMap(0, 0, 10, 10);
+  keepout_filter_->process(*master_grid_, 0, 0, 10, 10, pose);
+  for (Point & point : keepout_points_) {
+    point.x += 3;
+    point.y += 2;
+  }
+  verifyMasterGrid(nav2_costmap_2d::FREE_SPACE, nav2_costmap_2d::LETHAL_OBSTACLE);
+
+  // Clean-up
+  keepout_filter_->resetFilter();
+  reset();
+}
+
 int main(int argc, char ** argv)
 {
   // Initialize the system
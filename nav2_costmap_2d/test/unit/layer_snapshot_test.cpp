@@ -0,0 +1,152 @@
+// Copyright (c) 2022 Samsung Research America
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License. Reserved.
+
+#include <gtest/gtest.h>
+
+#include <cstdio>
+#include <fstream>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "nav2_costmap_2d/cost_values.hpp"
+#include "nav2_costmap_2d/layer_snapshot.hpp"
+#include "rclcpp/logger.hpp"
+
+using nav2_costmap_2d::LayerSnapshot;
+
+static LayerSnapshot makeSnapshot(bool voxels)
+{
+  LayerSnapshot snapshot;
+  snapshot.frame = "odom";
+  snapshot.stamp_ns = 1234567890123;
+  snapshot.origin_x = -2.5;
+  snapshot.origin_y = 1.25;
+  snapshot.robot_x = -1.0;
+  snapshot.robot_y = 2.0;
+  snapshot.resolution = 0.05;
+  snapshot.size_x = 60;
+  snapshot.size_y = 40;
+  snapshot.costs.assign(60 * 40, nav2_costmap_2d::NO_INFORMATION);
+  for (unsigned int i = 0; i < snapshot.costs.size(); i += 7) {
+    snapshot.costs[i] = i % 3 ? nav2_costmap_2d::FREE_SPACE : nav2_costmap_2d::LETHAL_OBSTACLE;
+  }
+  if (voxels) {
+    snapshot.size_z = 10;
+    snapshot.word_size = 4;
+    snapshot.origin_z = 0.1;
+    snapshot.z_resolution = 0.2;
+    snapshot.voxels.assign(snapshot.costs.size() * 4, 0);
+    for (unsigned int i = 0; i < snapshot.voxels.size(); i += 13) {
+      snapshot.voxels[i] = static_cast<uint8_t>(i);
+    }
+  }
+  return snapshot;
+}
+
+static void expectEqual(const LayerSnapshot & a, const LayerSnapshot & b)
+{
+  EXPECT_EQ(a.frame, b.frame);
+  EXPECT_EQ(a.stamp_ns, b.stamp_ns);
+  EXPECT_DOUBLE_EQ(a.origin_x, b.origin_x);
+  EXPECT_DOUBLE_EQ(a.origin_y, b.origin_y);
+  EXPECT_DOUBLE_EQ(a.robot_x, b.robot_x);
+  EXPECT_DOUBLE_EQ(a.robot_y, b.robot_y);
+  EXPECT_DOUBLE_EQ(a.resolution, b.resolution);
+  EXPECT_EQ(a.size_x, b.size_x);
+  EXPECT_EQ(a.size_y, b.size_y);
+  EXPECT_EQ(a.costs, b.costs);
+  EXPECT_EQ(a.size_z, b.size_z);
+  EXPECT_EQ(a.word_size, b.word_size);
+  EXPECT_EQ(a.voxels, b.voxels);
+}
+
+TEST(LayerSnapshot, saveAndLoad)
+{
+  const std::string path = testing::TempDir() + "layer_snapshot_test.snapshot";
+  for (bool voxels : {false, true}) {
+    const LayerSnapshot snapshot = makeSnapshot(voxels);
+    ASSERT_TRUE(nav2_costmap_2d::saveLayerSnapshot(path, snapshot));
+    LayerSnapshot loaded;
+    ASSERT_TRUE(nav2_costmap_2d::loadLayerSnapshot(path, loaded));
+    expectEqual(loaded, snapshot);
+    if (voxels) {
+      EXPECT_DOUBLE_EQ(loaded.origin_z, snapshot.origin_z);
+      EXPECT_DOUBLE_EQ(loaded.z_resolution, snapshot.z_resolution);
+    }
+  }
+
+  // Truncated, garbled and missing files are not loaded
+  {
+    std::ofstream file(path, std::ios::binary | std::ios::trunc);
+    file << "NAV2SNAP";
+  }
+  LayerSnapshot loaded;
+  EXPECT_FALSE(nav2_costmap_2d::loadLayerSnapshot(path, loaded));
+  {
+    std::ofstream file(path, std::ios::binary | std::ios::trunc);
+    file << "not a snapshot at all";
+  }
+  EXPECT_FALSE(nav2_costmap_2d::loadLayerSnapshot(path, loaded));
+  std::remove(path.c_str());
+  EXPECT_FALSE(nav2_costmap_2d::loadLayerSnapshot(path, loaded));
+}
+
+TEST(LayerSnapshot, copyOverlappingCells)
+{
+  // A 4x3 grid of cells numbered in order, into a 5x5 grid
+  std::vector<uint8_t> source(12);
+  for (unsigned int i = 0; i < source.size(); ++i) {
+    source[i] = static_cast<uint8_t>(i + 1);
+  }
+  std::vector<uint8_t> destination(25, 0);
+  EXPECT_EQ(
+    nav2_costmap_2d::copyOverlappingCells(
+      source.data(), 4, 3, destination.data(), 5, 5, 2, -1, 1), 6u);
+  const std::vector<uint8_t> expected = {
+    0, 0, 5, 6, 7,
+    0, 0, 9, 10, 11,
+    0, 0, 0, 0, 0,
+    0, 0, 0, 0, 0,
+    0, 0, 0, 0, 0};
+  EXPECT_EQ(destination, expected);
+
+  // Cells of several bytes, and grids not overlapping
+  std::vector<uint8_t> wide(8 * 2, 0);
+  EXPECT_EQ(
+    nav2_costmap_2d::copyOverlappingCells(source.data(), 2, 3, wide.data(), 2, 4, -1, 2, 2), 2u);
+  EXPECT_EQ(wide[2 * 4 + 0], 3);
+  EXPECT_EQ(wide[2 * 4 + 1], 4);
+  EXPECT_EQ(wide[3 * 4 + 0], 7);
+  EXPECT_EQ(
+    nav2_costmap_2d::copyOverlappingCells(source.data(), 4, 3, destination.data(), 5, 5, 5, 0, 1),
+    0u);
+}
+
+TEST(LayerSnapshot, writer)
+{
+  const std::string path = testing::TempDir() + "layer_snapshot_writer_test.snapshot";
+  std::remove(path.c_str());
+  {
+    nav2_costmap_2d::LayerSnapshotWriter writer(path, rclcpp::get_logger("test"));
+    writer.submit(std::make_unique<LayerSnapshot>(makeSnapshot(false)));
+    writer.submit(std::make_unique<LayerSnapshot>(makeSnapshot(true)));
+  }
+
+  // The last snapshot submitted is saved by the time the writer is destroyed
+  LayerSnapshot loaded;
+  ASSERT_TRUE(nav2_costmap_2d::loadLayerSnapshot(path, loaded));
+  expectEqual(loaded, makeSnapshot(true));
+  std::remove(path.c_str());
+}
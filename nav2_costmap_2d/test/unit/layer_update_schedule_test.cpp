@@ -0,0 +1,160 @@
+// Copyright (c) 2022 Samsung Research America
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License. Reserved.
+
+#include <gtest/gtest.h>
+
+#include <algorithm>
+#include <chrono>
+#include <memory>
+#include <string>
+#include <thread>
+
+#include "rclcpp/rclcpp.hpp"
+#include "nav2_costmap_2d/layer.hpp"
+#include "nav2_costmap_2d/layered_costmap.hpp"
+
+class RclCppFixture
+{
+public:
+  RclCppFixture() {rclcpp::init(0, nullptr);}
+  ~RclCppFixture() {rclcpp::shutdown();}
+};
+RclCppFixture g_rclcppfixture;
+
+// Layer counting its bounds updates, which cover a cell of its own
+class CountingLayer : public nav2_costmap_2d::Layer
+{
+public:
+  explicit CountingLayer(double x)
+  : x_(x) {}
+
+  void reset() {}
+  bool isClearable() {return false;}
+
+  void updateBounds(
+    double, double, double, double * min_x, double * min_y, double * max_x, double * max_y)
+  {
+    ++bounds_updates_;
+    *min_x = std::min(*min_x, x_);
+    *min_y = std::min(*min_y, 0.5);
+    *max_x = std::max(*max_x, x_);
+    *max_y = std::max(*max_y, 0.5);
+  }
+
+  void updateCosts(nav2_costmap_2d::Costmap2D &, int, int, int, int) {}
+
+  void request() {requestUpdate();}
+
+  int bounds_updates_{0};
+  double x_;
+};
+
+class LayerUpdateScheduleTest : public ::testing::Test
+{
+public:
+  LayerUpdateScheduleTest()
+  : node_(std::make_shared<nav2_util::LifecycleNode>("test_node")),
+    tf_(node_->get_clock())
+  {
+    node_->declare_parameter("slow.update_frequency", rclcpp::ParameterValue(1e-3));
+    node_->declare_parameter("timed.update_frequency", rclcpp::ParameterValue(20.0));
+  }
+
+  std::shared_ptr<CountingLayer> addLayer(
+    nav2_costmap_2d::LayeredCostmap & layers, const std::string & name, double x)
+  {
+    auto layer = std::make_shared<CountingLayer>(x);
+    layer->initialize(&layers, name, &tf_, node_, nullptr, nullptr);
+    layers.addPlugin(layer);
+    return layer;
+  }
+
+protected:
+  nav2_util::LifecycleNode::SharedPtr node_;
+  tf2_ros::Buffer tf_;
+};
+
+TEST_F(LayerUpdateScheduleTest, updatesAtLayerRates)
+{
+  nav2_costmap_2d::LayeredCostmap layers("frame", false, false);
+  layers.resizeMap(10, 10, 1.0, 0.0, 0.0);
+  auto fast = addLayer(layers, "fast", 1.5);
+  auto slow = addLayer(layers, "slow", 7.5);
+
+  // All layers update first, then only those due
+  layers.updateMap(0, 0, 0);
+  EXPECT_EQ(fast->bounds_updates_, 1);
+  EXPECT_EQ(slow->bounds_updates_, 1);
+  unsigned int x0, xn, y0, yn;
+  layers.getBounds(&x0, &xn, &y0, &yn);
+  EXPECT_EQ(x0, 1u);
+  EXPECT_EQ(xn, 8u);
+
+  layers.updateMap(0, 0, 0);
+  layers.updateMap(0, 0, 0);
+  EXPECT_EQ(fast->bounds_updates_, 3);
+  EXPECT_EQ(slow->bounds_updates_, 1);
+
+  // The window only covers the bounds of the layers due
+  layers.getBounds(&x0, &xn, &y0, &yn);
+  EXPECT_EQ(x0, 1u);
+  EXPECT_EQ(xn, 2u);
+
+  // A layer requesting an update is due at the next one
+  slow->request();
+  layers.updateMap(0, 0, 0);
+  layers.updateMap(0, 0, 0);
+  EXPECT_EQ(fast->bounds_updates_, 5);
+  EXPECT_EQ(slow->bounds_updates_, 2);
+
+  // As are all layers after a resize or a change of the whole costmap
+  layers.resizeMap(10, 10, 1.0, 0.0, 0.0);
+  layers.updateMap(0, 0, 0);
+  EXPECT_EQ(slow->bounds_updates_, 3);
+  layers.markUpdated();
+  layers.updateMap(0, 0, 0);
+  EXPECT_EQ(slow->bounds_updates_, 4);
+  layers.updateMap(0, 0, 0);
+  EXPECT_EQ(slow->bounds_updates_, 4);
+}
+
+TEST_F(LayerUpdateScheduleTest, updatesOncePeriodElapsed)
+{
+  nav2_costmap_2d::LayeredCostmap layers("frame", false, false);
+  layers.resizeMap(10, 10, 1.0, 0.0, 0.0);
+  auto timed = addLayer(layers, "timed", 2.5);
+
+  layers.updateMap(0, 0, 0);
+  layers.updateMap(0, 0, 0);
+  EXPECT_EQ(timed->bounds_updates_, 1);
+
+  std::this_thread::sleep_for(std::chrono::milliseconds(60));
+  layers.updateMap(0, 0, 0);
+  EXPECT_EQ(timed->bounds_updates_, 2);
+}
+
+TEST_F(LayerUpdateScheduleTest, updatesAllLayersWhenRolling)
+{
+  nav2_costmap_2d::LayeredCostmap layers("frame", true, false);
+  layers.resizeMap(10, 10, 1.0, 0.0, 0.0);
+  auto slow = addLayer(layers, "slow", 0.5);
+
+  layers.updateMap(5.0, 5.0, 0);
+  layers.updateMap(5.0, 5.0, 0);
+  EXPECT_EQ(slow->bounds_updates_, 1);
+
+  // Layers move their costmaps along with the master costmap in their bounds updates
+  layers.updateMap(6.0, 5.0, 0);
+  EXPECT_EQ(slow->bounds_updates_, 2);
+}
@@ -0,0 +1,178 @@
+// Copyright (c) 2022 Samsung Research America
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License. Reserved.
+
+#include <gtest/gtest.h>
+
+#include <cmath>
+#include <limits>
+#include <memory>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "rclcpp/rclcpp.hpp"
+#include "nav2_costmap_2d/observation_buffer.hpp"
+#include "sensor_msgs/point_cloud2_iterator.hpp"
+
+class RclCppFixture
+{
+public:
+  RclCppFixture() {rclcpp::init(0, nullptr);}
+  ~RclCppFixture() {rclcpp::shutdown();}
+};
+RclCppFixture g_rclcppfixture;
+
+sensor_msgs::msg::PointCloud2 makeCloud(const std::vector<float> & heights, float x)
+{
+  sensor_msgs::msg::PointCloud2 cloud;
+  cloud.header.frame_id = "map";
+  sensor_msgs::PointCloud2Modifier modifier(cloud);
+  modifier.setPointCloud2FieldsByString(1, "xyz");
+  modifier.resize(heights.size());
+  sensor_msgs::PointCloud2Iterator<float> iter_x(cloud, "x");
+  sensor_msgs::PointCloud2Iterator<float> iter_y(cloud, "y");
+  sensor_msgs::PointCloud2Iterator<float> iter_z(cloud, "z");
+  for (float height : heights) {
+    *iter_x = x;
+    *iter_y = 0.0;
+    *iter_z = height;
+    ++iter_x;
+    ++iter_y;
+    ++iter_z;
+  }
+  return cloud;
+}
+
+std::vector<float> getHeights(const nav2_costmap_2d::Observation & observation)
+{
+  std::vector<float> heights;
+  sensor_msgs::PointCloud2ConstIterator<float> iter_z(*(observation.cloud_), "z");
+  for (; iter_z != iter_z.end(); ++iter_z) {
+    heights.push_back(*iter_z);
+  }
+  return heights;
+}
+
+TEST(ObservationBuffer, reusesStaleObservations)
+{
+  auto node = std::make_shared<nav2_util::LifecycleNode>("observation_buffer_test");
+  tf2_ros::Buffer tf(node->get_clock());
+
+  // Only keeps the latest observation, with points between 0.0 and 2.0 m high
+  nav2_costmap_2d::ObservationBuffer buffer(
+    node, "cloud", 0.0, 0.0, 0.0, 2.0, 10.0, 0.0, 10.0, 0.0, tf, "map", "",
+    tf2::durationFromSec(0.0));
+
+  // Clouds buffered into recycled observations keep only their own points
+  buffer.bufferCloud(makeCloud({0.5, 1.0, 1.5, 3.0, 1.8}, 1.0));
+  buffer.bufferCloud(makeCloud({-1.0, 0.2}, 2.0));
+  buffer.bufferCloud(makeCloud({0.3, 0.6, 0.9, 1.2}, 3.0));
+
+  std::vector<nav2_costmap_2d::Observation> observations;
+  buffer.getObservations(observations);
+  ASSERT_EQ(observations.size(), 1u);
+  EXPECT_EQ(getHeights(observations[0]), std::vector<float>({0.3f, 0.6f, 0.9f, 1.2f}));
+  EXPECT_EQ(observations[0].obstacle_max_range_, 10.0);
+
+  buffer.bufferCloud(makeCloud({5.0, 0.1}, 4.0));
+  observations.clear();
+  buffer.getObservations(observations);
+  ASSERT_EQ(observations.size(), 1u);
+  EXPECT_EQ(getHeights(observations[0]), std::vector<float>({0.1f}));
+  sensor_msgs::PointCloud2ConstIterator<float> iter_x(*(observations[0].cloud_), "x");
+  EXPECT_EQ(*iter_x, 4.0f);
+
+  // Assigning observations copies their clouds
+  nav2_costmap_2d::Observation copy;
+  copy = observations[0];
+  EXPECT_EQ(getHeights(copy), std::vector<float>({0.1f}));
+  EXPECT_NE(copy.cloud_, observations[0].cloud_);
+}
+
+TEST(ObservationBuffer, voxelFilter)
+{
+  auto node = std::make_shared<nav2_util::LifecycleNode>("observation_buffer_test");
+  tf2_ros::Buffer tf(node->get_clock());
+
+  nav2_costmap_2d::ObservationBuffer buffer(
+    node, "cloud", 0.0, 0.0, 0.0, 2.0, 10.0, 0.0, 10.0, 0.0, tf, "map", "",
+    tf2::durationFromSec(0.0));
+
+  // Points of 2D cells collapse to the lowest one of each, after the height filter
+  buffer.setVoxelFilter(0.5, 0.0, 0.25, 0.0, 0.0);
+  buffer.bufferCloud(makeCloud({1.5, 0.6, -0.5, 1.2, 1.9, 3.0}, 1.0));
+  buffer.bufferCloud(makeCloud({1.5, 0.6, -0.5, 1.2, 1.9, 3.0}, 1.0));
+
+  std::vector<nav2_costmap_2d::Observation> observations;
+  buffer.getObservations(observations);
+  ASSERT_EQ(observations.size(), 1u);
+  EXPECT_EQ(getHeights(observations[0]), std::vector<float>({0.6f}));
+
+  // Voxels keep the lowest point of each of their heights
+  buffer.setVoxelFilter(0.5, 0.5, 0.25, 0.0, 0.0);
+  buffer.bufferCloud(makeCloud({1.5, 0.6, 0.1, 0.2, 1.2, 1.9, 0.7}, 1.0));
+  observations.clear();
+  buffer.getObservations(observations);
+  ASSERT_EQ(observations.size(), 1u);
+  EXPECT_EQ(getHeights(observations[0]), std::vector<float>({1.5f, 0.6f, 0.1f, 1.2f}));
+
+  // All points are kept once the filter is disabled
+  buffer.setVoxelFilter(0.0, 0.0, 0.0, 0.0, 0.0);
+  buffer.bufferCloud(makeCloud({1.5, 0.6, 0.1, 0.2}, 1.0));
+  observations.clear();
+  buffer.getObservations(observations);
+  ASSERT_EQ(observations.size(), 1u);
+  EXPECT_EQ(getHeights(observations[0]), std::vector<float>({1.5f, 0.6f, 0.1f, 0.2f}));
+}
+
+TEST(ObservationBuffer, bufferScan)
+{
+  auto node = std::make_shared<nav2_util::LifecycleNode>("observation_buffer_test");
+  tf2_ros::Buffer tf(node->get_clock());
+
+  nav2_costmap_2d::ObservationBuffer buffer(
+    node, "scan", 0.0, 0.0, -1.0, 2.0, 10.0, 0.0, 10.0, 0.0, tf, "map", "",
+    tf2::durationFromSec(0.0));
+
+  sensor_msgs::msg::LaserScan scan;
+  scan.header.frame_id = "map";
+  scan.angle_min = 0.0;
+  scan.angle_increment = M_PI / 2.0;
+  scan.range_min = 0.5;
+  scan.range_max = 5.0;
+  // Ranges out of [range_min, range_max) are dropped
+  scan.ranges = {1.0, 2.0, 0.1, 5.0, std::numeric_limits<float>::quiet_NaN()};
+
+  auto getPoints = [&buffer]() {
+      std::vector<nav2_costmap_2d::Observation> observations;
+      buffer.getObservations(observations);
+      std::vector<std::pair<float, float>> points;
+      sensor_msgs::PointCloud2ConstIterator<float> iter_x(*(observations.at(0).cloud_), "x");
+      sensor_msgs::PointCloud2ConstIterator<float> iter_y(*(observations.at(0).cloud_), "y");
+      for (; iter_x != iter_x.end(); ++iter_x, ++iter_y) {
+        points.emplace_back(std::round(*iter_x * 1e4) / 1e4, std::round(*iter_y * 1e4) / 1e4);
+      }
+      return points;
+    };
+
+  buffer.bufferScan(scan);
+  EXPECT_EQ(
+    getPoints(), (std::vector<std::pair<float, float>>({{1.0f, 0.0f}, {0.0f, 2.0f}})));
+
+  // The unit vectors follow the configuration of the scans
+  scan.angle_min = M_PI;
+  scan.ranges = {3.0};
+  buffer.bufferScan(scan);
+  EXPECT_EQ(getPoints(), (std::vector<std::pair<float, float>>({{-3.0f, 0.0f}})));
+}
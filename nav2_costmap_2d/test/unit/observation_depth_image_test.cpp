@@ -0,0 +1,105 @@
+// Copyright (c) 2022 Samsung Research America
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <gtest/gtest.h>
+
+#include <array>
+#include <cmath>
+#include <vector>
+
+#include "nav2_costmap_2d/observation_depth_image.hpp"
+#include "sensor_msgs/point_cloud2_iterator.hpp"
+
+typedef std::array<float, 3> Point;
+
+nav2_costmap_2d::Observation makeObservation(const std::vector<Point> & points)
+{
+  sensor_msgs::msg::PointCloud2 cloud;
+  sensor_msgs::PointCloud2Modifier modifier(cloud);
+  modifier.setPointCloud2FieldsByString(1, "xyz");
+  modifier.resize(points.size());
+  sensor_msgs::PointCloud2Iterator<float> iter_x(cloud, "x");
+  sensor_msgs::PointCloud2Iterator<float> iter_y(cloud, "y");
+  sensor_msgs::PointCloud2Iterator<float> iter_z(cloud, "z");
+  for (const Point & point : points) {
+    *iter_x = point[0];
+    *iter_y = point[1];
+    *iter_z = point[2];
+    ++iter_x;
+    ++iter_y;
+    ++iter_z;
+  }
+  geometry_msgs::msg::Point origin;
+  origin.x = 1.0;
+  origin.y = 1.0;
+  nav2_costmap_2d::Observation observation(origin, cloud, 5.0, 0.0, 4.0, 0.5);
+  observation.frustum_clearing_ = true;
+  return observation;
+}
+
+std::vector<Point> getPoints(const nav2_costmap_2d::Observation & observation)
+{
+  std::vector<Point> points;
+  sensor_msgs::PointCloud2ConstIterator<float> iter_x(*(observation.cloud_), "x");
+  sensor_msgs::PointCloud2ConstIterator<float> iter_y(*(observation.cloud_), "y");
+  sensor_msgs::PointCloud2ConstIterator<float> iter_z(*(observation.cloud_), "z");
+  for (; iter_x != iter_x.end(); ++iter_x, ++iter_y, ++iter_z) {
+    points.push_back({*iter_x, *iter_y, *iter_z});
+  }
+  return points;
+}
+
+TEST(ObservationDepthImage, keepsNearestPointOfEachDirection)
+{
+  // Points behind others in the same direction, and a point in another direction
+  auto observation = makeObservation(
+    {{3.0, 1.0, 0.0}, {2.0, 1.0, 0.0}, {4.0, 1.0, 1.0}, {1.0, 3.0, 0.0}, {1.0, 2.5, 0.0}});
+
+  nav2_costmap_2d::ObservationDepthImage depth_image;
+  nav2_costmap_2d::Observation reduced;
+  depth_image.reduce(observation, 0.1, false, reduced);
+  EXPECT_EQ(getPoints(reduced), std::vector<Point>({{2.0, 1.0, 0.0}, {1.0, 2.5, 0.0}}));
+  EXPECT_EQ(reduced.origin_.x, 1.0);
+  EXPECT_EQ(reduced.raytrace_max_range_, 4.0);
+  EXPECT_EQ(reduced.raytrace_min_range_, 0.5);
+  EXPECT_FALSE(reduced.frustum_clearing_);
+
+  // Split in elevation, the point above is kept too
+  depth_image.reduce(observation, 0.1, true, reduced);
+  EXPECT_EQ(
+    getPoints(reduced),
+    std::vector<Point>({{2.0, 1.0, 0.0}, {1.0, 2.5, 0.0}, {4.0, 1.0, 1.0}}));
+
+  // The image is reset for the next observation
+  depth_image.reduce(makeObservation({{0.0, 1.0, 0.0}}), 0.1, true, reduced);
+  EXPECT_EQ(getPoints(reduced), std::vector<Point>({{0.0, 1.0, 0.0}}));
+}
+
+TEST(ObservationDepthImage, keepsOnePointPerBin)
+{
+  // A dense arc of points reduced to the bins it spans
+  std::vector<Point> points;
+  for (int i = 0; i < 1000; ++i) {
+    const double angle = -0.5 + i * 0.001;
+    points.push_back(
+      {static_cast<float>(1.0 + 3.0 * std::cos(angle)),
+        static_cast<float>(1.0 + 3.0 * std::sin(angle)), 0.0f});
+  }
+  nav2_costmap_2d::ObservationDepthImage depth_image;
+  nav2_costmap_2d::Observation reduced;
+  depth_image.reduce(makeObservation(points), 0.05, false, reduced);
+  const size_t kept = getPoints(reduced).size();
+  EXPECT_GE(kept, 20u);
+  EXPECT_LE(kept, 21u);
+}
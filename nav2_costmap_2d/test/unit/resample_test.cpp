@@ -0,0 +1,123 @@
+// Copyright (c) 2022 Samsung Research America
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <gtest/gtest.h>
+
+#include <memory>
+
+#include "nav2_costmap_2d/cost_values.hpp"
+#include "nav2_costmap_2d/costmap_2d.hpp"
+#include "nav2_costmap_2d/costmap_layer.hpp"
+#include "nav2_costmap_2d/layered_costmap.hpp"
+
+// Keeps the costs set, only updating the master costmap in the bounds of the updates
+class KeptCostsLayer : public nav2_costmap_2d::CostmapLayer
+{
+public:
+  void reset() override {}
+  bool isClearable() override {return true;}
+  void updateBounds(double, double, double, double *, double *, double *, double *) override {}
+
+  void updateCosts(
+    nav2_costmap_2d::Costmap2D & master_grid, int min_i, int min_j, int max_i,
+    int max_j) override
+  {
+    updateWithMax(master_grid, min_i, min_j, max_i, max_j);
+  }
+
+  void setParent(nav2_costmap_2d::LayeredCostmap * parent)
+  {
+    layered_costmap_ = parent;
+    enabled_ = true;
+    setDefaultValue(nav2_costmap_2d::FREE_SPACE);
+  }
+};
+
+TEST(CopyResampled, coarserCellsKeepHighestKnownCost)
+{
+  nav2_costmap_2d::Costmap2D fine(8, 8, 0.05, 0.0, 0.0, nav2_costmap_2d::NO_INFORMATION);
+  fine.setCost(0, 0, 100);
+  fine.setCost(1, 1, nav2_costmap_2d::LETHAL_OBSTACLE);
+  fine.setCost(2, 0, nav2_costmap_2d::FREE_SPACE);
+
+  nav2_costmap_2d::Costmap2D coarse(4, 4, 0.1, 0.0, 0.0, nav2_costmap_2d::FREE_SPACE);
+  coarse.copyResampled(fine);
+  EXPECT_EQ(coarse.getCost(0, 0), nav2_costmap_2d::LETHAL_OBSTACLE);
+  EXPECT_EQ(coarse.getCost(1, 0), nav2_costmap_2d::FREE_SPACE);
+  EXPECT_EQ(coarse.getCost(2, 2), nav2_costmap_2d::NO_INFORMATION);
+}
+
+TEST(CopyResampled, finerCellsCopyTheirCell)
+{
+  nav2_costmap_2d::Costmap2D coarse(4, 4, 0.1, 0.0, 0.0, nav2_costmap_2d::FREE_SPACE);
+  coarse.setCost(1, 2, nav2_costmap_2d::LETHAL_OBSTACLE);
+
+  // Offset by half a fine cell, each fine cell still being within a coarse cell
+  nav2_costmap_2d::Costmap2D fine(10, 10, 0.05, 0.025, 0.025, nav2_costmap_2d::FREE_SPACE);
+  fine.copyResampled(coarse);
+  for (unsigned int y = 0; y < 10; ++y) {
+    for (unsigned int x = 0; x < 10; ++x) {
+      double wx, wy;
+      fine.mapToWorld(x, y, wx, wy);
+      unsigned int cx, cy;
+      const bool inside = coarse.worldToMap(wx, wy, cx, cy);
+      // Cells overlapping the edges of coarse cells take the highest of both
+      const bool lethal = inside && wx > 0.075 && wx < 0.225 && wy > 0.175 && wy < 0.325;
+      if ((x % 2 == 0) && (y % 2 == 0) && inside) {
+        EXPECT_EQ(fine.getCost(x, y), coarse.getCost(cx, cy)) << x << " " << y;
+      }
+      if (lethal) {
+        EXPECT_EQ(fine.getCost(x, y), nav2_costmap_2d::LETHAL_OBSTACLE) << x << " " << y;
+      }
+    }
+  }
+}
+
+TEST(CopyResampled, cellsOffTheSourceTakeTheDefault)
+{
+  nav2_costmap_2d::Costmap2D source(4, 4, 0.1, 0.0, 0.0, nav2_costmap_2d::FREE_SPACE);
+  source.setCost(3, 3, nav2_costmap_2d::LETHAL_OBSTACLE);
+
+  nav2_costmap_2d::Costmap2D moved(4, 4, 0.1, 0.2, 0.2, nav2_costmap_2d::NO_INFORMATION);
+  moved.copyResampled(source);
+  EXPECT_EQ(moved.getCost(1, 1), nav2_costmap_2d::LETHAL_OBSTACLE);
+  EXPECT_EQ(moved.getCost(0, 0), nav2_costmap_2d::FREE_SPACE);
+  EXPECT_EQ(moved.getCost(2, 2), nav2_costmap_2d::NO_INFORMATION);
+}
+
+TEST(ResizeMap, resamplesLayers)
+{
+  nav2_costmap_2d::LayeredCostmap layers("frame", true, false);
+  layers.resizeMap(40, 40, 0.05, 0.0, 0.0);
+  auto layer = std::make_shared<KeptCostsLayer>();
+  layer->setParent(&layers);
+  layer->matchSize();
+  layers.addPlugin(layer);
+  layer->setCost(10, 10, nav2_costmap_2d::LETHAL_OBSTACLE);
+
+  // Coarser cells around the same place
+  layers.resizeMap(20, 20, 0.1, 0.0, 0.0, false, true);
+  EXPECT_FALSE(layers.isResampling());
+  EXPECT_EQ(layer->getResolution(), 0.1);
+  EXPECT_EQ(layer->getCost(5, 5), nav2_costmap_2d::LETHAL_OBSTACLE);
+  EXPECT_EQ(layer->getCost(6, 5), nav2_costmap_2d::FREE_SPACE);
+
+  // The whole map is updated once, though the layer does not expand the bounds
+  layers.updateMap(1.0, 1.0, 0.0);
+  EXPECT_EQ(layers.getCostmap()->getCost(5, 5), nav2_costmap_2d::LETHAL_OBSTACLE);
+
+  // Without resampling, the layers are reset
+  layers.resizeMap(40, 40, 0.05, 0.0, 0.0);
+  EXPECT_EQ(layer->getCost(10, 10), nav2_costmap_2d::FREE_SPACE);
+}
@@ -0,0 +1,82 @@
+// Copyright (c) 2022 Samsung Research America
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License. Reserved.
+
+#include <gtest/gtest.h>
+
+#include <cstring>
+
+#include "nav2_costmap_2d/cost_values.hpp"
+#include "nav2_costmap_2d/costmap_2d.hpp"
+
+class ResettableCostmap : public nav2_costmap_2d::Costmap2D
+{
+public:
+  ResettableCostmap(unsigned int size_x, unsigned int size_y, unsigned char default_value)
+  : Costmap2D(size_x, size_y, 0.05, 0.0, 0.0, default_value)
+  {
+  }
+
+  void fill(unsigned char value)
+  {
+    memset(getCharMap(), value, getSizeInCellsX() * getSizeInCellsY());
+  }
+
+  using Costmap2D::resetMaps;
+};
+
+static void expectAllCells(const nav2_costmap_2d::Costmap2D & costmap, unsigned char value)
+{
+  const unsigned char * data = costmap.getCharMap();
+  const unsigned int size = costmap.getSizeInCellsX() * costmap.getSizeInCellsY();
+  unsigned int mismatches = 0;
+  for (unsigned int i = 0; i < size; ++i) {
+    mismatches += data[i] != value;
+  }
+  EXPECT_EQ(mismatches, 0u);
+}
+
+TEST(ResetMaps, smallCostmaps)
+{
+  for (unsigned char default_value :
+    {nav2_costmap_2d::FREE_SPACE, nav2_costmap_2d::NO_INFORMATION}) {
+    ResettableCostmap costmap(31, 17, default_value);
+    expectAllCells(costmap, default_value);
+    costmap.fill(100);
+    costmap.resetMaps();
+    expectAllCells(costmap, default_value);
+  }
+}
+
+TEST(ResetMaps, largeCostmaps)
+{
+  // Large enough for the pages of a free costmap to be released on reset,
+  // with a width that does not end rows on page boundaries
+  for (unsigned char default_value :
+    {nav2_costmap_2d::FREE_SPACE, nav2_costmap_2d::NO_INFORMATION}) {
+    ResettableCostmap costmap(2049, 1031, default_value);
+    expectAllCells(costmap, default_value);
+    costmap.fill(100);
+    costmap.resetMaps();
+    expectAllCells(costmap, default_value);
+
+    // The costmap is still writable after its pages were released
+    costmap.setCost(0, 0, 254);
+    costmap.setCost(2048, 1030, 254);
+    costmap.setCost(1000, 500, 254);
+    EXPECT_EQ(costmap.getCost(0, 0), 254);
+    EXPECT_EQ(costmap.getCost(2048, 1030), 254);
+    EXPECT_EQ(costmap.getCost(1000, 500), 254);
+    EXPECT_EQ(costmap.getCost(1001, 500), default_value);
+  }
+}
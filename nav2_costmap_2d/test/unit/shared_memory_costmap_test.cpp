@@ -0,0 +1,121 @@
+// Copyright (c) 2022 Samsung Research America
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <gtest/gtest.h>
+
+#include <chrono>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+
+#include "nav2_costmap_2d/layered_costmap.hpp"
+#include "nav2_costmap_2d/shared_memory_costmap.hpp"
+
+using nav2_costmap_2d::SharedMemoryCostmapReader;
+using nav2_costmap_2d::SharedMemoryCostmapWriter;
+
+void setCost(
+  nav2_costmap_2d::LayeredCostmap & layers, unsigned int x, unsigned int y, unsigned char cost)
+{
+  auto costmap = layers.getCostmap();
+  std::unique_lock<nav2_costmap_2d::Costmap2D::mutex_t> lock(*(costmap->getMutex()));
+  costmap->setCost(x, y, cost);
+  layers.markUpdated();
+}
+
+TEST(SharedMemoryCostmap, namesRegions)
+{
+  EXPECT_EQ(
+    nav2_costmap_2d::getSharedMemoryName("/local_costmap/costmap_raw"),
+    "/nav2_local_costmap_costmap_raw");
+  EXPECT_EQ(nav2_costmap_2d::getSharedMemoryName("costmap_raw"), "/nav2_costmap_raw");
+}
+
+TEST(SharedMemoryCostmap, readsWrittenCostmap)
+{
+  const std::string name = "/nav2_shared_memory_costmap_test";
+  nav2_costmap_2d::Costmap2D costmap;
+  bool changed;
+
+  SharedMemoryCostmapReader reader(name);
+  EXPECT_FALSE(reader.read(costmap, changed));
+
+  nav2_costmap_2d::LayeredCostmap layers("map", false, false);
+  layers.resizeMap(10, 8, 0.05, 1.0, 2.0);
+  setCost(layers, 3, 2, 254);
+
+  auto writer = std::make_unique<SharedMemoryCostmapWriter>(name);
+  ASSERT_TRUE(writer->update(layers));
+  ASSERT_TRUE(reader.read(costmap, changed));
+  EXPECT_TRUE(changed);
+  ASSERT_EQ(costmap.getSizeInCellsX(), 10u);
+  ASSERT_EQ(costmap.getSizeInCellsY(), 8u);
+  EXPECT_DOUBLE_EQ(costmap.getResolution(), 0.05);
+  EXPECT_DOUBLE_EQ(costmap.getOriginX(), 1.0);
+  EXPECT_DOUBLE_EQ(costmap.getOriginY(), 2.0);
+  EXPECT_EQ(costmap.getCost(3, 2), 254);
+  EXPECT_EQ(costmap.getCost(0, 0), 0);
+
+  // Nothing is copied until the costmap changes
+  ASSERT_TRUE(writer->update(layers));
+  ASSERT_TRUE(reader.read(costmap, changed));
+  EXPECT_FALSE(changed);
+
+  setCost(layers, 4, 5, 100);
+  ASSERT_TRUE(writer->update(layers));
+  ASSERT_TRUE(reader.read(costmap, changed));
+  EXPECT_TRUE(changed);
+  EXPECT_EQ(costmap.getCost(4, 5), 100);
+
+  // A larger costmap replaces the region, which the reader maps again
+  layers.resizeMap(40, 30, 0.05, 0.0, 0.0);
+  setCost(layers, 39, 29, 254);
+  ASSERT_TRUE(writer->update(layers));
+  ASSERT_TRUE(reader.read(costmap, changed));
+  EXPECT_TRUE(changed);
+  ASSERT_EQ(costmap.getSizeInCellsX(), 40u);
+  EXPECT_EQ(costmap.getCost(39, 29), 254);
+
+  // The region is removed with its writer
+  writer.reset();
+  EXPECT_FALSE(reader.read(costmap, changed));
+}
+
+TEST(SharedMemoryCostmap, skipsStaleRegions)
+{
+  const std::string name = "/nav2_shared_memory_costmap_stale_test";
+  nav2_costmap_2d::Costmap2D costmap;
+  bool changed;
+
+  nav2_costmap_2d::LayeredCostmap layers("map", false, false);
+  layers.resizeMap(10, 8, 0.05, 1.0, 2.0);
+  setCost(layers, 3, 2, 254);
+
+  SharedMemoryCostmapWriter writer(name);
+  SharedMemoryCostmapReader reader(name, 0.1);
+  ASSERT_TRUE(writer.update(layers));
+  ASSERT_TRUE(reader.read(costmap, changed));
+  EXPECT_TRUE(changed);
+
+  // A region its writer stopped updating, as when it died, is stale
+  std::this_thread::sleep_for(std::chrono::milliseconds(200));
+  EXPECT_FALSE(reader.read(costmap, changed));
+  EXPECT_FALSE(changed);
+
+  // Until its writer updates it again, even without changes
+  ASSERT_TRUE(writer.update(layers));
+  ASSERT_TRUE(reader.read(costmap, changed));
+  EXPECT_EQ(costmap.getCost(3, 2), 254);
+}
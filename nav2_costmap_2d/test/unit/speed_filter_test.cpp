@@ -224,6 +224,7 @@ protected:
     double tr_x, double tr_y);
   void testOutOfMask(uint8_t type, double base, double multiplier);
   void testIncorrectLimits(uint8_t type, double base, double multiplier);
+  void testSameZone(uint8_t type, double base, double multiplier);
 
   void reset();
 
@@ -617,6 +618,41 @@ void TestNode::testIncorrectLimits(uint8_t type, double base, double multiplier)
   }
 }
 
+void TestNode::testSameZone(uint8_t type, double base, double multiplier)
+{
+  const int min_i = 0;
+  const int min_j = 0;
+  const int max_i = width_ + 4;
+  const int max_j = height_ + 4;
+
+  geometry_msgs::msg::Pose2D pose;
+  nav2_msgs::msg::SpeedLimit::SharedPtr speed_limit;
+
+  // data = <some_middle_value>
+  pose.x = width_ / 2 - 1;
+  pose.y = height_ / 2 - 1;
+  speed_filter_->process(*master_grid_, min_i, min_j, max_i, max_j, pose);
+  speed_limit = waitSpeedLimit();
+  ASSERT_TRUE(speed_limit != nullptr);
+  verifySpeedLimit(type, base, multiplier, pose.x, pose.y, speed_limit);
+
+  // data = 0: entering no-limit zone
+  pose.x = 1.0;
+  pose.y = 0.0;
+  speed_filter_->process(*master_grid_, min_i, min_j, max_i, max_j, pose);
+  speed_limit = waitSpeedLimit();
+  ASSERT_TRUE(speed_limit != nullptr);
+  EXPECT_EQ(speed_limit->speed_limit, nav2_costmap_2d::NO_SPEED_LIMIT);
+
+  // Moving inside the same zone: no new speed limits expected
+  for (unsigned int x = 2; x < width_; x++) {
+    pose.x = x;
+    speed_filter_->process(*master_grid_, min_i, min_j, max_i, max_j, pose);
+  }
+  speed_limit = waitSpeedLimit();
+  ASSERT_TRUE(speed_limit == nullptr);
+}
+
 void TestNode::reset()
 {
   mask_.reset();
@@ -706,6 +742,21 @@ TEST_F(TestNode, testOutOfBounds)
   reset();
 }
 
+TEST_F(TestNode, testSameZone)
+{
+  // Initilize test system
+  createMaps("map");
+  publishMaps(nav2_costmap_2d::SPEED_FILTER_PERCENT, 0.0, 1.0);
+  EXPECT_TRUE(createSpeedFilter("map"));
+
+  // Test SpeedFilter
+  testSameZone(nav2_costmap_2d::SPEED_FILTER_PERCENT, 0.0, 1.0);
+
+  // Clean-up
+  speed_filter_->resetFilter();
+  reset();
+}
+
 TEST_F(TestNode, testInfoRePublish)
 {
   // Initilize test system
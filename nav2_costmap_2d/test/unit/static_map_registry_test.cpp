@@ -0,0 +1,89 @@
+// Copyright (c) 2022 Samsung Research America
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License. Reserved.
+
+#include <gtest/gtest.h>
+
+#include <array>
+#include <memory>
+
+#include "nav2_costmap_2d/static_map_registry.hpp"
+
+using nav2_costmap_2d::StaticMapRegistry;
+
+static nav_msgs::msg::OccupancyGrid makeMap()
+{
+  nav_msgs::msg::OccupancyGrid map;
+  map.header.frame_id = "map";
+  map.header.stamp.sec = 10;
+  map.info.width = 4;
+  map.info.height = 3;
+  map.info.resolution = 0.5;
+  map.info.origin.position.x = -1.0;
+  map.info.origin.position.y = 2.0;
+  map.data = {0, 100, -1, 50, 0, 0, 100, 100, -1, -1, 0, 50};
+  return map;
+}
+
+static std::array<unsigned char, 256> makeValueCosts(unsigned char unknown_cost)
+{
+  std::array<unsigned char, 256> value_costs;
+  for (unsigned int value = 0; value < 256; ++value) {
+    value_costs[value] = value >= 100 ? 254 : value / 2;
+  }
+  value_costs[255] = unknown_cost;
+  return value_costs;
+}
+
+TEST(StaticMapRegistry, buildsCostsOfMaps)
+{
+  const auto map = makeMap();
+  const auto value_costs = makeValueCosts(255);
+  auto costs = StaticMapRegistry::getInstance().getCosts("/map", map, value_costs);
+  ASSERT_NE(costs, nullptr);
+  EXPECT_EQ(costs->getSizeInCellsX(), 4u);
+  EXPECT_EQ(costs->getSizeInCellsY(), 3u);
+  EXPECT_DOUBLE_EQ(costs->getResolution(), 0.5);
+  EXPECT_DOUBLE_EQ(costs->getOriginX(), -1.0);
+  EXPECT_DOUBLE_EQ(costs->getOriginY(), 2.0);
+  for (unsigned int index = 0; index < map.data.size(); ++index) {
+    EXPECT_EQ(
+      costs->getCharMap()[index],
+      value_costs[static_cast<unsigned char>(map.data[index])]);
+  }
+}
+
+TEST(StaticMapRegistry, sharesCostsOfSameMaps)
+{
+  auto map = makeMap();
+  const auto value_costs = makeValueCosts(255);
+  auto & registry = StaticMapRegistry::getInstance();
+  auto costs = registry.getCosts("/map", map, value_costs);
+
+  // The same map, as received by another layer, gets the same costs
+  EXPECT_EQ(registry.getCosts("/map", makeMap(), value_costs), costs);
+
+  // But not on another topic, with other costs of its values, or once the map changed
+  EXPECT_NE(registry.getCosts("/other_map", map, value_costs), costs);
+  EXPECT_NE(registry.getCosts("/map", map, makeValueCosts(0)), costs);
+  map.header.stamp.sec = 11;
+  auto new_costs = registry.getCosts("/map", map, value_costs);
+  EXPECT_NE(new_costs, costs);
+  EXPECT_EQ(registry.getCosts("/map", map, value_costs), new_costs);
+
+  // Costs are released with the last layer holding them
+  std::weak_ptr<const nav2_costmap_2d::Costmap2D> released = new_costs;
+  new_costs.reset();
+  EXPECT_TRUE(released.expired());
+  EXPECT_EQ(registry.getCosts("/map", makeMap(), value_costs), costs);
+}
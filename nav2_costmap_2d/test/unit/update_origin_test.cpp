@@ -0,0 +1,65 @@
+// Copyright (c) 2022 Samsung Research America
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License. Reserved.
+
+#include <gtest/gtest.h>
+
+#include "nav2_costmap_2d/cost_values.hpp"
+#include "nav2_costmap_2d/costmap_2d.hpp"
+
+// Cost of a cell, from its position in the world grid
+static unsigned char patternCost(int world_x, int world_y)
+{
+  return static_cast<unsigned char>(1 + (((world_x * 7 + world_y * 13) % 250) + 250) % 250);
+}
+
+// Shift a costmap filled with the pattern, and check that each cell kept
+// the cost of its world cell, or became unknown if it was outside before
+static void testShift(int shift_x, int shift_y)
+{
+  const unsigned int size_x = 23, size_y = 17;
+  const double resolution = 0.5;
+  nav2_costmap_2d::Costmap2D costmap(
+    size_x, size_y, resolution, -3.0, 2.0, nav2_costmap_2d::NO_INFORMATION);
+  for (unsigned int j = 0; j < size_y; ++j) {
+    for (unsigned int i = 0; i < size_x; ++i) {
+      costmap.setCost(i, j, patternCost(i, j));
+    }
+  }
+
+  costmap.updateOrigin(-3.0 + shift_x * resolution, 2.0 + shift_y * resolution);
+  ASSERT_DOUBLE_EQ(costmap.getOriginX(), -3.0 + shift_x * resolution);
+  ASSERT_DOUBLE_EQ(costmap.getOriginY(), 2.0 + shift_y * resolution);
+
+  for (unsigned int j = 0; j < size_y; ++j) {
+    for (unsigned int i = 0; i < size_x; ++i) {
+      const int world_x = static_cast<int>(i) + shift_x;
+      const int world_y = static_cast<int>(j) + shift_y;
+      const bool was_inside = world_x >= 0 && world_x < static_cast<int>(size_x) &&
+        world_y >= 0 && world_y < static_cast<int>(size_y);
+      ASSERT_EQ(
+        costmap.getCost(i, j),
+        was_inside ? patternCost(world_x, world_y) : nav2_costmap_2d::NO_INFORMATION) <<
+        "shift " << shift_x << ", " << shift_y << " cell " << i << ", " << j;
+    }
+  }
+}
+
+TEST(UpdateOrigin, shifts)
+{
+  for (int shift_y : {-20, -17, -5, -1, 0, 1, 4, 16, 17}) {
+    for (int shift_x : {-30, -23, -22, -3, 0, 2, 22, 23}) {
+      testShift(shift_x, shift_y);
+    }
+  }
+}
@@ -0,0 +1,62 @@
+// Copyright (c) 2022 Samsung Research America
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License. Reserved.
+
+#include <gtest/gtest.h>
+
+#include "nav2_costmap_2d/visitation_map.hpp"
+
+TEST(VisitationMap, visitAndClear)
+{
+  nav2_costmap_2d::VisitationMap seen;
+  seen.resize(10);
+  ASSERT_EQ(seen.size(), 10u);
+  for (unsigned int i = 0; i < 10; ++i) {
+    ASSERT_FALSE(seen.isVisited(i));
+  }
+
+  seen.setVisited(3);
+  ASSERT_TRUE(seen.isVisited(3));
+  ASSERT_FALSE(seen.isVisited(4));
+
+  // Resizing to the same size keeps the current search
+  seen.resize(10);
+  ASSERT_TRUE(seen.isVisited(3));
+
+  seen.clear();
+  ASSERT_FALSE(seen.isVisited(3));
+
+  // Resizing starts over with all cells unvisited
+  seen.setVisited(5);
+  seen.resize(20);
+  ASSERT_FALSE(seen.isVisited(5));
+}
+
+TEST(VisitationMap, epochWrapAround)
+{
+  nav2_costmap_2d::VisitationMap seen;
+  seen.resize(4);
+  seen.setVisited(0);
+
+  // Cells visited in an old search must not appear visited once the epoch wraps around
+  for (unsigned int i = 0; i < 70000; ++i) {
+    seen.clear();
+    ASSERT_FALSE(seen.isVisited(0));
+    if (i % 2 == 0) {
+      seen.setVisited(1);
+    }
+  }
+  seen.setVisited(2);
+  ASSERT_TRUE(seen.isVisited(2));
+  ASSERT_FALSE(seen.isVisited(3));
+}
@@ -0,0 +1,153 @@
+/*
+ * Software License Agreement (BSD License)
+ *
+ *  Copyright (c) 2017, Locus Robotics
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer in the documentation and/or other materials provided
+ *     with the distribution.
+ *   * Neither the name of the copyright holder nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ *  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ *  COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ *  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef COSTMAP_QUEUE__BUCKET_QUEUE_HPP_
+#define COSTMAP_QUEUE__BUCKET_QUEUE_HPP_
+
+#include <stdexcept>
+#include <vector>
+
+namespace costmap_queue
+{
+/**
+ * @brief Templatized priority queue over a fixed number of integer priorities
+ *
+ * Items are stored in a vector of bins indexed by their priority, so that enqueueing is a
+ * push into its bin instead of a lookup in the map of MapBasedQueue. It suits priorities
+ * taken from a small set of values known in advance, such as the cached distances of the
+ * CostmapQueue, which are enqueued with the rank of their value in the sorted set.
+ * Items of the same priority are popped last in, first out, as with MapBasedQueue, so
+ * both queues give items in the same order. The bins keep their capacity across resets.
+ */
+template<class item_t>
+class BucketQueue
+{
+public:
+  /**
+   * @brief Default Constructor
+   */
+  BucketQueue()
+  : item_count_(0), current_bin_(0)
+  {
+  }
+
+  /**
+   * @brief Set the number of priorities, clearing the queue
+   * @param num_bins Number of priorities, from 0 to num_bins - 1
+   */
+  void setNumBins(unsigned int num_bins)
+  {
+    item_bins_.resize(num_bins);
+    reset();
+  }
+
+  /**
+   * @brief Clear the queue
+   */
+  void reset()
+  {
+    if (item_count_ > 0) {
+      for (auto & bin : item_bins_) {
+        bin.clear();
+      }
+      item_count_ = 0;
+    }
+    current_bin_ = item_bins_.size();
+  }
+
+  /**
+   * @brief Add a new item to the queue with a set priority
+   * @param bin Priority of the item, less than the number of bins
+   * @param item Payload item
+   */
+  void enqueue(const unsigned int bin, item_t item)
+  {
+    item_bins_[bin].push_back(item);
+    item_count_++;
+    if (bin < current_bin_) {
+      current_bin_ = bin;
+    }
+  }
+
+  /**
+   * @brief Check to see if there is anything in the queue
+   * @return True if there is nothing in the queue
+   *
+   * Must be called prior to front/pop.
+   */
+  bool isEmpty()
+  {
+    return item_count_ == 0;
+  }
+
+  /**
+   * @brief Return the item at the front of the queue
+   * @return The item at the front of the queue
+   */
+  item_t & front()
+  {
+    if (current_bin_ >= item_bins_.size()) {
+      throw std::out_of_range("front() called on empty costmap_queue::BucketQueue!");
+    }
+
+    return item_bins_[current_bin_].back();
+  }
+
+  /**
+   * @brief Remove (and destroy) the item at the front of the queue
+   */
+  void pop()
+  {
+    if (current_bin_ < item_bins_.size() && !item_bins_[current_bin_].empty()) {
+      item_bins_[current_bin_].pop_back();
+      item_count_--;
+    }
+
+    if (item_count_ == 0) {
+      current_bin_ = item_bins_.size();
+      return;
+    }
+    while (item_bins_[current_bin_].empty()) {
+      current_bin_++;
+    }
+  }
+
+protected:
+  std::vector<std::vector<item_t>> item_bins_;
+  unsigned int item_count_;
+  unsigned int current_bin_;
+};
+}  // namespace costmap_queue
+
+#endif  // COSTMAP_QUEUE__BUCKET_QUEUE_HPP_
@@ -40,6 +40,8 @@
 #include <limits>
 #include <memory>
 #include "nav2_costmap_2d/costmap_2d.hpp"
+#include "nav2_costmap_2d/visitation_map.hpp"
+#include "costmap_queue/bucket_queue.hpp"
 #include "costmap_queue/map_based_queue.hpp"
 
 namespace costmap_queue
@@ -104,6 +106,9 @@ public:
  * The validCellToQueue overridable-function allows for deriving classes to limit the queue traversal
  * to a subset of all costmap cells. LimitedCostmapQueue does this by ignoring distances above a limit.
  *
+ * Since all distances come from the cached distances, the cells can instead be stored in a
+ * BucketQueue, with a bin for each distinct cached distance, by passing bucket_queue=true to the
+ * constructor. Cells come out in the same order, without the map lookups of each enqueue.
  */
 class CostmapQueue : public MapBasedQueue<CellData>
 {
@@ -112,8 +117,11 @@ public:
    * @brief constructor
    * @param costmap Costmap which defines the size/number of cells
    * @param manhattan If true, sort cells by Manhattan distance, otherwise use Euclidean distance
+   * @param bucket_queue If true, store the cells in a BucketQueue instead of the MapBasedQueue
    */
-  explicit CostmapQueue(nav2_costmap_2d::Costmap2D & costmap, bool manhattan = false);
+  explicit CostmapQueue(
+    nav2_costmap_2d::Costmap2D & costmap, bool manhattan = false,
+    bool bucket_queue = false);
 
   /**
    * @brief Clear the queue
@@ -127,6 +135,17 @@ public:
    */
   void enqueueCell(unsigned int x, unsigned int y);
 
+  /**
+   * @brief Check to see if there are cells left in the queue
+   * @return True if there is nothing in the queue
+   *
+   * Checks the bucket queue instead of the MapBasedQueue if it stores the cells.
+   */
+  bool isEmpty()
+  {
+    return bucket_queue_ ? buckets_.isEmpty() : MapBasedQueue<CellData>::isEmpty();
+  }
+
   /**
    * @brief Get the next cell to examine, and enqueue its neighbors as needed
    * @return The next cell
@@ -160,9 +179,11 @@ protected:
   void computeCache();
 
   nav2_costmap_2d::Costmap2D & costmap_;
-  std::vector<bool> seen_;
+  nav2_costmap_2d::VisitationMap seen_;
   int max_distance_;
   bool manhattan_;
+  bool bucket_queue_;
+  BucketQueue<CellData> buckets_;
 
 protected:
   /**
@@ -182,6 +203,8 @@ protected:
     return cached_distances_[dx][dy];
   }
   std::vector<std::vector<double>> cached_distances_;
+  // Bin of each cached distance in the bucket queue, the rank of its value
+  std::vector<std::vector<unsigned int>> cached_bins_;
   int cached_max_distance_;
 };
 }  // namespace costmap_queue
@@ -49,8 +49,11 @@ class LimitedCostmapQueue : public CostmapQueue
 public:
   /**
    * @brief Constructor with limit as an integer number of cells.
+   * @param bucket_queue If true, store the cells in a BucketQueue instead of the MapBasedQueue
    */
-  LimitedCostmapQueue(nav2_costmap_2d::Costmap2D & costmap, const int cell_distance_limit);
+  LimitedCostmapQueue(
+    nav2_costmap_2d::Costmap2D & costmap, const int cell_distance_limit,
+    bool bucket_queue = false);
   bool validCellToQueue(const CellData & cell) override;
 };
 }  // namespace costmap_queue
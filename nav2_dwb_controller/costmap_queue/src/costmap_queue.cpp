@@ -41,22 +41,22 @@ using std::hypot;
 namespace costmap_queue
 {
 
-CostmapQueue::CostmapQueue(nav2_costmap_2d::Costmap2D & costmap, bool manhattan)
+CostmapQueue::CostmapQueue(
+  nav2_costmap_2d::Costmap2D & costmap, bool manhattan,
+  bool bucket_queue)
 : MapBasedQueue(), costmap_(costmap), max_distance_(-1), manhattan_(manhattan),
-  cached_max_distance_(-1)
+  bucket_queue_(bucket_queue), cached_max_distance_(-1)
 {
   reset();
 }
 
 void CostmapQueue::reset()
 {
-  unsigned int size_x = costmap_.getSizeInCellsX(), size_y = costmap_.getSizeInCellsY();
-  if (seen_.size() != size_x * size_y) {
-    seen_.resize(size_x * size_y);
-  }
-  std::fill(seen_.begin(), seen_.end(), false);
+  seen_.resize(costmap_.getSizeInCellsX() * costmap_.getSizeInCellsY());
+  seen_.clear();
   computeCache();
   MapBasedQueue::reset();
+  buckets_.reset();
 }
 
 void CostmapQueue::enqueueCell(unsigned int x, unsigned int y)
@@ -69,23 +69,35 @@ void CostmapQueue::enqueueCell(
   unsigned int index, unsigned int cur_x, unsigned int cur_y,
   unsigned int src_x, unsigned int src_y)
 {
-  if (seen_[index]) {return;}
+  if (seen_.isVisited(index)) {return;}
 
   // we compute our distance table one cell further than the inflation radius
   // dictates so we can make the check below
-  double distance = distanceLookup(cur_x, cur_y, src_x, src_y);
+  unsigned int dx = CellData::absolute_difference(cur_x, src_x);
+  unsigned int dy = CellData::absolute_difference(cur_y, src_y);
+  double distance = cached_distances_[dx][dy];
   CellData data(distance, index, cur_x, cur_y, src_x, src_y);
   if (validCellToQueue(data)) {
-    seen_[index] = true;
-    enqueue(distance, data);
+    seen_.setVisited(index);
+    if (bucket_queue_) {
+      buckets_.enqueue(cached_bins_[dx][dy], data);
+    } else {
+      enqueue(distance, data);
+    }
   }
 }
 
 CellData CostmapQueue::getNextCell()
 {
   // get the highest priority cell and pop it off the priority queue
-  CellData current_cell = front();
-  pop();
+  CellData current_cell;
+  if (bucket_queue_) {
+    current_cell = buckets_.front();
+    buckets_.pop();
+  } else {
+    current_cell = front();
+    pop();
+  }
 
   unsigned int index = current_cell.index_;
   unsigned int mx = current_cell.x_;
@@ -131,6 +143,27 @@ void CostmapQueue::computeCache()
       }
     }
   }
+
+  if (bucket_queue_) {
+    // Bins are the ranks of the distances among all distinct cached distances
+    std::vector<double> distances;
+    distances.reserve(cached_distances_.size() * cached_distances_.size());
+    for (const auto & row : cached_distances_) {
+      distances.insert(distances.end(), row.begin(), row.end());
+    }
+    std::sort(distances.begin(), distances.end());
+    distances.erase(std::unique(distances.begin(), distances.end()), distances.end());
+
+    cached_bins_.resize(cached_distances_.size());
+    for (unsigned int i = 0; i < cached_distances_.size(); ++i) {
+      cached_bins_[i].resize(cached_distances_[i].size());
+      for (unsigned int j = 0; j < cached_distances_[i].size(); ++j) {
+        cached_bins_[i][j] = std::lower_bound(
+          distances.begin(), distances.end(), cached_distances_[i][j]) - distances.begin();
+      }
+    }
+    buckets_.setNumBins(distances.size());
+  }
   cached_max_distance_ = max_distance_;
 }
 
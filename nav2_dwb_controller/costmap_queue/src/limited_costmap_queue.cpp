@@ -39,8 +39,8 @@ namespace costmap_queue
 
 LimitedCostmapQueue::LimitedCostmapQueue(
   nav2_costmap_2d::Costmap2D & costmap,
-  const int distance_limit)
-: CostmapQueue(costmap)
+  const int distance_limit, bool bucket_queue)
+: CostmapQueue(costmap, false, bucket_queue)
 {
   max_distance_ = distance_limit;
   reset();
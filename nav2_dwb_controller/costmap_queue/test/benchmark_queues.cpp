@@ -0,0 +1,94 @@
+/*
+ * Software License Agreement (BSD License)
+ *
+ *  Copyright (c) 2017, Locus Robotics
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer in the documentation and/or other materials provided
+ *     with the distribution.
+ *   * Neither the name of the copyright holder nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ *  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ *  COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ *  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ */
+
+// Compares the map based and bucket queues of CostmapQueue by the time taken to
+// expand the whole costmap from a path of source cells, as the DWB path critics do.
+// Usage: benchmark_queues [map size in cells] [number of trials]
+
+#include <chrono>
+#include <cstdlib>
+#include <iostream>
+#include <string>
+
+#include "costmap_queue/costmap_queue.hpp"
+#include "costmap_queue/limited_costmap_queue.hpp"
+
+using namespace std::chrono;  // NOLINT
+
+void runBenchmark(
+  const std::string & name, costmap_queue::CostmapQueue & queue,
+  const unsigned int size, const unsigned int trials)
+{
+  double total_time = 0.0;
+  unsigned int cells = 0;
+  for (unsigned int i = 0; i != trials; i++) {
+    steady_clock::time_point a = steady_clock::now();
+    queue.reset();
+    // A diagonal path through the costmap
+    for (unsigned int j = 0; j < size; j++) {
+      queue.enqueueCell(j, j);
+    }
+    cells = 0;
+    while (!queue.isEmpty()) {
+      queue.getNextCell();
+      cells++;
+    }
+    steady_clock::time_point b = steady_clock::now();
+    total_time += duration_cast<duration<double>>(b - a).count();
+  }
+
+  std::cout << name << ": " << cells << " cells, " <<
+    total_time * 1000.0 / trials << " ms" << std::endl;
+}
+
+int main(int argc, char ** argv)
+{
+  const unsigned int size = argc > 1 ? std::atoi(argv[1]) : 200;
+  const unsigned int trials = argc > 2 ? std::atoi(argv[2]) : 20;
+  nav2_costmap_2d::Costmap2D costmap(size, size, 0.05, 0.0, 0.0);
+
+  for (bool manhattan : {true, false}) {
+    const std::string metric = manhattan ? "manhattan" : "euclidean";
+    costmap_queue::CostmapQueue map_queue(costmap, manhattan);
+    costmap_queue::CostmapQueue bucket_queue(costmap, manhattan, true);
+    runBenchmark(metric + " map based queue", map_queue, size, trials);
+    runBenchmark(metric + " bucket queue   ", bucket_queue, size, trials);
+  }
+
+  costmap_queue::LimitedCostmapQueue limited_map_queue(costmap, 20);
+  costmap_queue::LimitedCostmapQueue limited_bucket_queue(costmap, 20, true);
+  runBenchmark("limited map based queue", limited_map_queue, size, trials);
+  runBenchmark("limited bucket queue   ", limited_bucket_queue, size, trials);
+  return 0;
+}
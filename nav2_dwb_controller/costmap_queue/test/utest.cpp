@@ -135,6 +135,53 @@ TEST(CostmapQueue, limitedQueue)
   EXPECT_EQ(count, 11);
 }
 
+TEST(CostmapQueue, bucketQueue)
+{
+  // The bucket queue gives the cells in the same order as the map based queue
+  nav2_costmap_2d::Costmap2D map(40, 30, 1.0, 0.0, 0.0);
+  for (bool manhattan : {false, true}) {
+    costmap_queue::CostmapQueue mq(map, manhattan);
+    costmap_queue::CostmapQueue bq(map, manhattan, true);
+    for (int repeat = 0; repeat < 2; repeat++) {
+      mq.reset();
+      bq.reset();
+      for (unsigned int i = 0; i < 5; i++) {
+        mq.enqueueCell(3 + 7 * i, 29 - 5 * i);
+        bq.enqueueCell(3 + 7 * i, 29 - 5 * i);
+      }
+      int count = 0;
+      while (!mq.isEmpty()) {
+        ASSERT_FALSE(bq.isEmpty());
+        costmap_queue::CellData m = mq.getNextCell();
+        costmap_queue::CellData b = bq.getNextCell();
+        EXPECT_EQ(m.index_, b.index_);
+        EXPECT_EQ(m.src_x_, b.src_x_);
+        EXPECT_EQ(m.src_y_, b.src_y_);
+        EXPECT_EQ(m.distance_, b.distance_);
+        count++;
+      }
+      EXPECT_TRUE(bq.isEmpty());
+      EXPECT_EQ(count, 40 * 30);
+    }
+  }
+}
+
+TEST(CostmapQueue, limitedBucketQueue)
+{
+  costmap_queue::LimitedCostmapQueue q(costmap, 3, true);
+  int count = 0;
+  double last_distance = 0.0;
+  q.enqueueCell(0, 0);
+  while (!q.isEmpty()) {
+    costmap_queue::CellData cell = q.getNextCell();
+    EXPECT_EQ(cell.distance_, hypot(cell.x_, cell.y_));
+    EXPECT_GE(cell.distance_, last_distance);
+    last_distance = cell.distance_;
+    count++;
+  }
+  EXPECT_EQ(count, 11);
+}
+
 int main(int argc, char ** argv)
 {
   testing::InitGoogleTest(&argc, argv);
@@ -44,6 +44,7 @@
 #include "dwb_core/publisher.hpp"
 #include "dwb_core/trajectory_critic.hpp"
 #include "dwb_core/trajectory_generator.hpp"
+#include "nav2_costmap_2d/tile_thread_pool.hpp"
 #include "nav_2d_msgs/msg/pose2_d_stamped.hpp"
 #include "nav_2d_msgs/msg/twist2_d_stamped.hpp"
 #include "rclcpp/rclcpp.hpp"
@@ -112,20 +113,71 @@ public:
     const geometry_msgs::msg::Twist & velocity,
     nav2_core::GoalChecker * /*goal_checker*/) override;
 
+  /**
+   * @brief Counters of the trajectories whose scoring was cut short
+   */
+  struct PruningStatistics
+  {
+    /// Number of trajectories scored
+    unsigned int trajectories{0};
+    /// Number of trajectories cut short, as they could not beat the best score
+    unsigned int pruned_trajectories{0};
+    /// Number of critic evaluations skipped by cutting trajectories short
+    unsigned int pruned_evaluations{0};
+  };
+
+  /**
+   * @brief Measured cost and contribution of a critic to the scores of an iteration
+   */
+  struct CriticStatistics
+  {
+    /// Number of trajectories scored by the critic
+    unsigned int evaluations{0};
+    /// Time spent scoring them
+    double seconds{0.0};
+    /// Sum of their scaled scores
+    double score_sum{0.0};
+    /// Lowest of their scaled scores, negative before the first evaluation
+    double min_score{-1.0};
+  };
+
+  /**
+   * @brief Statistics of scoring trajectories, gathered separately by each scoring chunk
+   */
+  struct ScoringStatistics
+  {
+    PruningStatistics pruning;
+    /// Statistics of each critic, in the order of critics_
+    std::vector<CriticStatistics> critics;
+    /// Scaled lower bound of each critic for the trajectory being scored
+    std::vector<double> bounds;
+  };
+
   /**
    * @brief Score a given command. Can be used for testing.
    *
    * Given a trajectory, calculate the score where lower scores are better.
    * If the given (positive) score exceeds the best_score, calculation may be cut short, as the
-   * score can only go up from there.
+   * score can only go up from there. With prune_with_lower_bounds, it is cut short as soon as
+   * the score plus the lower bounds of the critics left to evaluate exceed the best_score,
+   * and the total of the score then includes those bounds.
    *
    * @param traj Trajectory to check
    * @param best_score If positive, the threshold for early termination
+   * @param statistics If not null, counters and critic statistics are added to it
    * @return The full scoring of the input trajectory
    */
   virtual dwb_msgs::msg::TrajectoryScore scoreTrajectory(
     const dwb_msgs::msg::Trajectory2D & traj,
-    double best_score = -1);
+    double best_score = -1, ScoringStatistics * statistics = nullptr);
+
+  /**
+   * @brief Get the pruning counters of the last call to computeVelocityCommands
+   */
+  const PruningStatistics & getPruningStatistics() const
+  {
+    return pruning_statistics_;
+  }
 
   /**
    * @brief Compute the best command given the current pose and velocity, with possible debug information
@@ -170,14 +222,71 @@ protected:
     const nav_2d_msgs::msg::Pose2DStamped & pose, nav_2d_msgs::msg::Path2D & transformed_plan,
     nav_2d_msgs::msg::Pose2DStamped & goal_pose, bool publish_plan = true);
 
+  /**
+   * @brief Create the pool scoring trajectories in parallel, once the critics are loaded
+   *
+   * Trajectories are scored serially, with a warning, if any critic is not thread safe.
+   *
+   * @param scoring_threads Number of threads, 0 or less for one per hardware thread
+   */
+  void createScoringPool(int scoring_threads);
+
   /**
    * @brief Iterate through all the twists and find the best one
+   *
+   * With a scoring pool, the trajectories are split into as many chunks of consecutive
+   * twists as the pool has threads. Each chunk is short circuited by its own best score,
+   * and the chunks are merged in order, so that the best trajectory is the one found
+   * serially, and the results only depend on the number of threads. Generators sampling
+   * their twists in rounds get the scores of each round before generating the next one.
+   *
+   * With sort_critics, the critics are then sorted for the next iteration to evaluate first
+   * those adding the most score to the trajectories above the best one per second spent
+   * scoring, so that short circuiting skips the others as often as possible.
    */
   virtual dwb_msgs::msg::TrajectoryScore coreScoringAlgorithm(
     const geometry_msgs::msg::Pose2D & pose,
     const nav_2d_msgs::msg::Twist2D velocity,
     std::shared_ptr<dwb_msgs::msg::LocalPlanEvaluation> & results);
 
+  /**
+   * @brief Score a trajectory as scoreTrajectory() does, into a score whose critic scores
+   * are reused, and without copying the trajectory into it
+   */
+  void scoreTrajectoryInto(
+    const dwb_msgs::msg::Trajectory2D & traj,
+    double best_score, ScoringStatistics * statistics,
+    dwb_msgs::msg::TrajectoryScore & score);
+
+  /**
+   * @brief Sort the order in which critics score trajectories by their statistics
+   *
+   * Critics are ranked by the statistics of the last iteration they were evaluated in,
+   * and those never evaluated yet are moved first so that the next iteration measures them.
+   *
+   * @param statistics Statistics of the critics over an iteration
+   */
+  void sortCritics(const std::vector<CriticStatistics> & statistics);
+
+  /**
+   * @brief Score a range of trajectories as a batch, each critic scoring all of them at once
+   *
+   * Gives the same scores as scoreTrajectory() without short circuiting, as the totals of
+   * the trajectories are only known once all critics scored the batch.
+   *
+   * @param trajs Trajectories of the iteration
+   * @param begin First trajectory of the batch
+   * @param end Last trajectory of the batch (exclusive)
+   * @param scores Scores of the trajectories of the iteration, set over the batch without
+   * the trajectories
+   * @param failures Exceptions of the illegal trajectories of the iteration, set over the batch
+   */
+  void scoreTrajectoryBatch(
+    const std::vector<dwb_msgs::msg::Trajectory2D> & trajs,
+    unsigned int begin, unsigned int end,
+    std::vector<dwb_msgs::msg::TrajectoryScore> & scores,
+    std::vector<std::unique_ptr<IllegalTrajectoryException>> & failures);
+
   /**
    * @brief Transforms global plan into same frame as pose, clips far away poses and possibly prunes passed poses
    *
@@ -192,12 +301,19 @@ protected:
    * the way to the nav goal on to the critics or just a subset of the plan near the robot.
    * True means pass just a subset. This gives DWB less discretion to decide how it gets to the
    * nav goal. Instead it is encouraged to try to get on to the path generated by the global planner.
+   *
+   * Without pruning, the poses already passed are skipped by starting the search for the robot
+   * at the pose matched by the last call. If recover_plan_position_ is true and the robot is
+   * not near the plan there, the rest of the plan is searched for the closest pose to it.
    */
   virtual nav_2d_msgs::msg::Path2D transformGlobalPlan(
     const nav_2d_msgs::msg::Pose2DStamped & pose);
   nav_2d_msgs::msg::Path2D global_plan_;  ///< Saved Global Plan
   bool prune_plan_;
   double prune_distance_;
+  // Index of the pose of the global plan the search for the robot starts at
+  size_t plan_start_index_{0};
+  bool recover_plan_position_;
   bool debug_trajectory_details_;
   rclcpp::Duration transform_tolerance_{0, 0};
   bool shorten_transformed_plan_;
@@ -236,6 +352,27 @@ protected:
   std::string dwb_plugin_name_;
 
   bool short_circuit_trajectory_evaluation_;
+  bool batch_scoring_;
+  bool prune_with_lower_bounds_;
+  bool sort_critics_;
+
+  // Indices in critics_ in the order critics score trajectories
+  std::vector<size_t> critic_order_;
+  // Discrimination per second of each critic, by which critic_order_ is sorted
+  std::vector<double> critic_ranks_;
+  PruningStatistics pruning_statistics_;
+
+  // Trajectories generated by the last iteration, of which only the first few may be in use
+  std::vector<dwb_msgs::msg::Trajectory2D> trajectories_;
+  // Their scores, without the trajectories
+  std::vector<dwb_msgs::msg::TrajectoryScore> trajectory_scores_;
+
+  // Twists and scores of the last scoring round, reported to the generator
+  std::vector<nav_2d_msgs::msg::Twist2D> round_twists_;
+  std::vector<double> round_scores_;
+
+  // Pool scoring chunks of the trajectories in parallel, null to score them serially
+  std::unique_ptr<nav2_costmap_2d::TileThreadPool> scoring_pool_;
 };
 
 }  // namespace dwb_core
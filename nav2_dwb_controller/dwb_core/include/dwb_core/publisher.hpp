@@ -80,9 +80,10 @@ public:
 
   /**
    * @brief Does the publisher require that the LocalPlanEvaluation be saved
-   * @return True if the Evaluation is needed to publish either directly or as trajectories
+   * @return True if the Evaluation is needed to publish either directly or as trajectories,
+   * to at least one subscriber, as the planner otherwise only keeps the totals of the scores
    */
-  bool shouldRecordEvaluation() {return publish_evaluation_ || publish_trajectories_;}
+  bool shouldRecordEvaluation();
 
   /**
    * @brief If the pointer is not null, publish the evaluation and trajectories as needed
@@ -94,16 +95,16 @@ public:
   void publishCostGrid(
     const std::shared_ptr<nav2_costmap_2d::Costmap2DROS> costmap_ros,
     const std::vector<TrajectoryCritic::Ptr> critics);
-  void publishGlobalPlan(const nav_2d_msgs::msg::Path2D plan);
-  void publishTransformedPlan(const nav_2d_msgs::msg::Path2D plan);
-  void publishLocalPlan(const nav_2d_msgs::msg::Path2D plan);
+  void publishGlobalPlan(const nav_2d_msgs::msg::Path2D & plan);
+  void publishTransformedPlan(const nav_2d_msgs::msg::Path2D & plan);
+  void publishLocalPlan(const nav_2d_msgs::msg::Path2D & plan);
 
 protected:
   void publishTrajectories(const dwb_msgs::msg::LocalPlanEvaluation & results);
 
   // Helper function for publishing other plans
   void publishGenericPlan(
-    const nav_2d_msgs::msg::Path2D plan,
+    const nav_2d_msgs::msg::Path2D & plan,
     rclcpp::Publisher<nav_msgs::msg::Path> & pub, bool flag);
 
   // Flags for turning on/off publishing specific components
@@ -0,0 +1,85 @@
+/*
+ * Software License Agreement (BSD License)
+ *
+ *  Copyright (c) 2018, Locus Robotics
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer in the documentation and/or other materials provided
+ *     with the distribution.
+ *   * Neither the name of the copyright holder nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ *  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ *  COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ *  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef DWB_CORE__TRAJECTORY_BATCH_HPP_
+#define DWB_CORE__TRAJECTORY_BATCH_HPP_
+
+#include <vector>
+
+#include "dwb_msgs/msg/trajectory2_d.hpp"
+
+namespace dwb_core
+{
+
+/**
+ * @class TrajectoryBatch
+ * @brief Trajectories scored together, with their poses laid out as contiguous arrays
+ *
+ * Critics scoring a batch at once read the poses of trajectory i at indices offsets[i]
+ * to offsets[i + 1] (exclusive) of x, y and theta, rather than from the messages.
+ */
+class TrajectoryBatch
+{
+public:
+  /**
+   * @brief Lay out the poses of a range of trajectories
+   * @param trajectories First trajectory of the batch
+   * @param count Number of trajectories in the batch
+   */
+  TrajectoryBatch(const dwb_msgs::msg::Trajectory2D * trajectories, size_t count);
+
+  /**
+   * @brief Get the number of trajectories in the batch
+   */
+  size_t size() const {return count_;}
+
+  /**
+   * @brief Get a trajectory of the batch as a message
+   * @param i Index of the trajectory
+   */
+  const dwb_msgs::msg::Trajectory2D & trajectory(size_t i) const {return trajectories_[i];}
+
+  std::vector<double> x;
+  std::vector<double> y;
+  std::vector<double> theta;
+  std::vector<size_t> offsets;
+
+protected:
+  const dwb_msgs::msg::Trajectory2D * trajectories_;
+  size_t count_;
+};
+
+}  // namespace dwb_core
+
+#endif  // DWB_CORE__TRAJECTORY_BATCH_HPP_
@@ -46,6 +46,8 @@
 #include "nav_2d_msgs/msg/twist2_d.hpp"
 #include "nav_2d_msgs/msg/path2_d.hpp"
 #include "dwb_msgs/msg/trajectory2_d.hpp"
+#include "dwb_core/exceptions.hpp"
+#include "dwb_core/trajectory_batch.hpp"
 #include "sensor_msgs/msg/point_cloud.hpp"
 #include "nav2_util/lifecycle_node.hpp"
 
@@ -67,6 +69,8 @@ namespace dwb_core
  *       and there may be some shared work that can be done beforehand to optimize
  *       the scoring of each individual trajectory.
  *  3) scoreTrajectory is called once per trajectory and returns the score.
+ *       If the planner scores batches, scoreTrajectories is called instead with all
+ *       trajectories of a batch.
  *  4) debrief is called after each set of trajectories with the chosen trajectory.
  *       This can be used for stateful critics that monitor the trajectory through time.
  *
@@ -146,6 +150,52 @@ public:
    */
   virtual double scoreTrajectory(const dwb_msgs::msg::Trajectory2D & traj) = 0;
 
+  /**
+   * @brief Return a lower bound of the raw score of the given trajectory
+   *
+   * The planner may skip scoring trajectories which cannot beat the best one even with the
+   * lower bounds of the critics left to evaluate, so the bound should be much cheaper to
+   * compute than the score. It is never more than the score of a legal trajectory, and may
+   * be anything for an illegal one. The default suits critics whose scores are not negative.
+   */
+  virtual double getLowerBound(const dwb_msgs::msg::Trajectory2D &) {return 0.0;}
+
+  /**
+   * @brief Whether scoreTrajectory may be called concurrently for different trajectories
+   *
+   * The planner only scores trajectories in parallel if all of its critics are thread safe.
+   * Scoring then happens between prepare and debrief, with the costmap locked, so a critic
+   * is thread safe if scoreTrajectory only reads its state and the costmap.
+   */
+  virtual bool isThreadSafe() const {return false;}
+
+  /**
+   * @brief Write the raw scores of a batch of trajectories
+   *
+   * Trajectories with a failure, set by this or an earlier critic, are illegal and skipped.
+   * Subclasses may overwrite to score the poses of the whole batch at once, the default
+   * scores each trajectory with scoreTrajectory.
+   *
+   * @param batch Trajectories to score
+   * @param scores Raw score of each trajectory of the batch
+   * @param failures Exception of each illegal trajectory of the batch, null for legal ones
+   */
+  virtual void scoreTrajectories(
+    const TrajectoryBatch & batch, std::vector<double> & scores,
+    std::vector<std::unique_ptr<IllegalTrajectoryException>> & failures)
+  {
+    for (size_t i = 0; i < batch.size(); ++i) {
+      if (failures[i]) {
+        continue;
+      }
+      try {
+        scores[i] = scoreTrajectory(batch.trajectory(i));
+      } catch (const IllegalTrajectoryException & e) {
+        failures[i] = std::make_unique<IllegalTrajectoryException>(e);
+      }
+    }
+  }
+
   /**
    * @brief debrief informs the critic what the chosen cmd_vel was (if it cares)
    */
@@ -94,6 +94,21 @@ public:
    */
   virtual nav_2d_msgs::msg::Twist2D nextTwist() = 0;
 
+  /**
+   * @brief Get the scores of the twists returned since the last report
+   *
+   * Called by the planner once the twists returned until hasMoreTwists() is false are scored,
+   * after which hasMoreTwists() tells whether another round of twists follows, so that
+   * generators can sample again around the best twists.
+   *
+   * @param twists The twists of the round, in order
+   * @param scores Their scores, negative for illegal twists. Scores above the best one of
+   * the iteration may only be lower bounds of the full scores.
+   */
+  virtual void reportScores(
+    const std::vector<nav_2d_msgs::msg::Twist2D> & /*twists*/,
+    const std::vector<double> & /*scores*/) {}
+
   /**
    * @brief Get all the twists for an iteration.
    *
@@ -124,6 +139,26 @@ public:
     const nav_2d_msgs::msg::Twist2D & start_vel,
     const nav_2d_msgs::msg::Twist2D & cmd_vel) = 0;
 
+  /**
+   * @brief Generate a Trajectory2D into an existing message, such as one generated into before
+   *
+   * Generators may override this to reuse the capacity of the poses and time offsets of the
+   * message, so that generating every iteration into the same messages does not allocate.
+   *
+   * @param start_pose Current robot location
+   * @param start_vel Current robot velocity
+   * @param cmd_vel The desired command velocity
+   * @param traj Trajectory to overwrite
+   */
+  virtual void generateTrajectoryInto(
+    const geometry_msgs::msg::Pose2D & start_pose,
+    const nav_2d_msgs::msg::Twist2D & start_vel,
+    const nav_2d_msgs::msg::Twist2D & cmd_vel,
+    dwb_msgs::msg::Trajectory2D & traj)
+  {
+    traj = generateTrajectory(start_pose, start_vel, cmd_vel);
+  }
+
   /**
    * @brief Limits the maximum linear speed of the robot.
    * @param speed_limit expressed in absolute value (in m/s)
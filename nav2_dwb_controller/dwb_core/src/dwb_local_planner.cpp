@@ -33,8 +33,12 @@
  */
 
 #include <algorithm>
+#include <chrono>
+#include <limits>
 #include <memory>
+#include <numeric>
 #include <string>
+#include <thread>
 #include <utility>
 #include <vector>
 
@@ -105,8 +109,24 @@ void DWBLocalPlanner::configure(
   declare_parameter_if_not_declared(
     node, dwb_plugin_name_ + ".short_circuit_trajectory_evaluation",
     rclcpp::ParameterValue(true));
+  declare_parameter_if_not_declared(
+    node, dwb_plugin_name_ + ".scoring_threads",
+    rclcpp::ParameterValue(1));
+  declare_parameter_if_not_declared(
+    node, dwb_plugin_name_ + ".batch_scoring",
+    rclcpp::ParameterValue(false));
+  declare_parameter_if_not_declared(
+    node, dwb_plugin_name_ + ".recover_plan_position",
+    rclcpp::ParameterValue(false));
+  declare_parameter_if_not_declared(
+    node, dwb_plugin_name_ + ".prune_with_lower_bounds",
+    rclcpp::ParameterValue(false));
+  declare_parameter_if_not_declared(
+    node, dwb_plugin_name_ + ".sort_critics",
+    rclcpp::ParameterValue(false));
 
   std::string traj_generator_name;
+  int scoring_threads;
 
   double transform_tolerance;
   node->get_parameter(dwb_plugin_name_ + ".transform_tolerance", transform_tolerance);
@@ -115,12 +135,17 @@ void DWBLocalPlanner::configure(
 
   node->get_parameter(dwb_plugin_name_ + ".prune_plan", prune_plan_);
   node->get_parameter(dwb_plugin_name_ + ".prune_distance", prune_distance_);
+  node->get_parameter(dwb_plugin_name_ + ".recover_plan_position", recover_plan_position_);
   node->get_parameter(dwb_plugin_name_ + ".debug_trajectory_details", debug_trajectory_details_);
   node->get_parameter(dwb_plugin_name_ + ".trajectory_generator_name", traj_generator_name);
   node->get_parameter(
     dwb_plugin_name_ + ".short_circuit_trajectory_evaluation",
     short_circuit_trajectory_evaluation_);
   node->get_parameter(dwb_plugin_name_ + ".shorten_transformed_plan", shorten_transformed_plan_);
+  node->get_parameter(dwb_plugin_name_ + ".scoring_threads", scoring_threads);
+  node->get_parameter(dwb_plugin_name_ + ".batch_scoring", batch_scoring_);
+  node->get_parameter(dwb_plugin_name_ + ".prune_with_lower_bounds", prune_with_lower_bounds_);
+  node->get_parameter(dwb_plugin_name_ + ".sort_critics", sort_critics_);
 
   pub_ = std::make_unique<DWBPublisher>(node, dwb_plugin_name_);
   pub_->on_configure();
@@ -135,6 +160,29 @@ void DWBLocalPlanner::configure(
     RCLCPP_ERROR(logger_, "Couldn't load critics! Caught exception: %s", e.what());
     throw;
   }
+
+  createScoringPool(scoring_threads);
+}
+
+void
+DWBLocalPlanner::createScoringPool(int scoring_threads)
+{
+  if (scoring_threads <= 0) {
+    scoring_threads = std::max(1u, std::thread::hardware_concurrency());
+  }
+  scoring_pool_.reset();
+  if (scoring_threads > 1) {
+    auto unsafe_critic = std::find_if(
+      critics_.begin(), critics_.end(),
+      [](const TrajectoryCritic::Ptr & critic) {return !critic->isThreadSafe();});
+    if (unsafe_critic == critics_.end()) {
+      scoring_pool_ = std::make_unique<nav2_costmap_2d::TileThreadPool>(scoring_threads);
+    } else {
+      RCLCPP_WARN(
+        logger_, "Critic \"%s\" is not thread safe, trajectories will be scored serially",
+        (*unsafe_critic)->getName().c_str());
+    }
+  }
 }
 
 void
@@ -155,6 +203,8 @@ DWBLocalPlanner::cleanup()
   pub_->on_cleanup();
 
   traj_generator_.reset();
+  scoring_pool_.reset();
+  trajectories_.clear();
 }
 
 std::string
@@ -218,6 +268,10 @@ DWBLocalPlanner::loadCritics()
     }
     RCLCPP_INFO(logger_, "Critic plugin initialized");
   }
+
+  critic_order_.resize(critics_.size());
+  std::iota(critic_order_.begin(), critic_order_.end(), 0);
+  critic_ranks_.assign(critics_.size(), std::numeric_limits<double>::infinity());
 }
 
 void
@@ -232,6 +286,7 @@ DWBLocalPlanner::setPlan(const nav_msgs::msg::Path & path)
 
   pub_->publishGlobalPlan(path2d);
   global_plan_ = path2d;
+  plan_start_index_ = 0;
 }
 
 geometry_msgs::msg::TwistStamped
@@ -343,51 +398,153 @@ DWBLocalPlanner::coreScoringAlgorithm(
   const nav_2d_msgs::msg::Twist2D velocity,
   std::shared_ptr<dwb_msgs::msg::LocalPlanEvaluation> & results)
 {
-  nav_2d_msgs::msg::Twist2D twist;
-  dwb_msgs::msg::Trajectory2D traj;
-  dwb_msgs::msg::TrajectoryScore best, worst;
+  dwb_msgs::msg::TrajectoryScore best;
   best.total = -1;
-  worst.total = -1;
   IllegalTrajectoryTracker tracker;
 
+  // Trajectories are generated serially, as generators need not be thread safe. Those of
+  // the previous iteration are generated into, so that their poses need no allocations.
+  // A generator may sample its twists in rounds, each one generated once the scores of
+  // the previous ones are reported to it.
+  std::vector<dwb_msgs::msg::Trajectory2D> & trajs = trajectories_;
+  // The scores are kept without their trajectories, which are only copied into the best
+  // score and the records of the evaluation results
+  std::vector<dwb_msgs::msg::TrajectoryScore> & scores = trajectory_scores_;
+  std::vector<std::unique_ptr<IllegalTrajectoryException>> failures;
+  unsigned int num_trajs = 0;
+  const unsigned int max_chunks = scoring_pool_ ? scoring_pool_->getThreads() : 1;
+  std::vector<ScoringStatistics> chunk_statistics(max_chunks);
+  double round_best = -1;
   traj_generator_->startNewIteration(velocity);
   while (traj_generator_->hasMoreTwists()) {
-    twist = traj_generator_->nextTwist();
-    traj = traj_generator_->generateTrajectory(pose, velocity, twist);
-
-    try {
-      dwb_msgs::msg::TrajectoryScore score = scoreTrajectory(traj, best.total);
-      tracker.addLegalTrajectory();
-      if (results) {
-        results->twists.push_back(score);
+    const unsigned int round_begin = num_trajs;
+    while (traj_generator_->hasMoreTwists()) {
+      nav_2d_msgs::msg::Twist2D twist = traj_generator_->nextTwist();
+      if (num_trajs == trajs.size()) {
+        trajs.emplace_back();
       }
-      if (best.total < 0 || score.total < best.total) {
-        best = score;
-        if (results) {
-          results->best_index = results->twists.size() - 1;
+      traj_generator_->generateTrajectoryInto(pose, velocity, twist, trajs[num_trajs]);
+      ++num_trajs;
+    }
+    scores.resize(num_trajs);
+    failures.resize(num_trajs);
+
+    // The chunks of later rounds are short circuited by the best score of the earlier ones
+    const unsigned int round_size = num_trajs - round_begin;
+    const unsigned int num_chunks =
+      max_chunks > 1 && round_size > 1 ? std::min(max_chunks, round_size) : 1;
+    auto score_chunk = [&](unsigned int begin, unsigned int end, ScoringStatistics & statistics) {
+        if (batch_scoring_) {
+          scoreTrajectoryBatch(trajs, begin, end, scores, failures);
+          statistics.pruning.trajectories += end - begin;
+          return;
         }
-      }
-      if (worst.total < 0 || score.total > worst.total) {
-        worst = score;
-        if (results) {
-          results->worst_index = results->twists.size() - 1;
+        double chunk_best = round_best;
+        for (unsigned int i = begin; i < end; ++i) {
+          try {
+            scoreTrajectoryInto(trajs[i], chunk_best, &statistics, scores[i]);
+            if (chunk_best < 0 || scores[i].total < chunk_best) {
+              chunk_best = scores[i].total;
+            }
+          } catch (const dwb_core::IllegalTrajectoryException & e) {
+            failures[i] = std::make_unique<IllegalTrajectoryException>(e);
+          }
         }
+      };
+    if (num_chunks > 1) {
+      scoring_pool_->run(
+        num_chunks, [&](unsigned int chunk) {
+          score_chunk(
+            round_begin + chunk * round_size / num_chunks,
+            round_begin + (chunk + 1) * round_size / num_chunks,
+            chunk_statistics[chunk]);
+        });
+    } else {
+      score_chunk(round_begin, num_trajs, chunk_statistics[0]);
+    }
+
+    round_twists_.clear();
+    round_scores_.clear();
+    for (unsigned int i = round_begin; i < num_trajs; ++i) {
+      const double total = failures[i] ? -1.0 : scores[i].total;
+      round_twists_.push_back(trajs[i].velocity);
+      round_scores_.push_back(total);
+      if (total >= 0 && (round_best < 0 || total < round_best)) {
+        round_best = total;
+      }
+    }
+    traj_generator_->reportScores(round_twists_, round_scores_);
+  }
+
+  pruning_statistics_ = PruningStatistics();
+  std::vector<CriticStatistics> critic_statistics(critics_.size());
+  for (const ScoringStatistics & statistics : chunk_statistics) {
+    pruning_statistics_.trajectories += statistics.pruning.trajectories;
+    pruning_statistics_.pruned_trajectories += statistics.pruning.pruned_trajectories;
+    pruning_statistics_.pruned_evaluations += statistics.pruning.pruned_evaluations;
+    for (size_t i = 0; i < statistics.critics.size(); ++i) {
+      const CriticStatistics & chunk_critic = statistics.critics[i];
+      CriticStatistics & critic = critic_statistics[i];
+      if (chunk_critic.evaluations == 0) {
+        continue;
+      }
+      if (critic.evaluations == 0 || chunk_critic.min_score < critic.min_score) {
+        critic.min_score = chunk_critic.min_score;
       }
-    } catch (const dwb_core::IllegalTrajectoryException & e) {
+      critic.evaluations += chunk_critic.evaluations;
+      critic.seconds += chunk_critic.seconds;
+      critic.score_sum += chunk_critic.score_sum;
+    }
+  }
+  RCLCPP_DEBUG(
+    logger_, "Pruned %u of %u trajectories, skipping %u critic evaluations",
+    pruning_statistics_.pruned_trajectories, pruning_statistics_.trajectories,
+    pruning_statistics_.pruned_evaluations);
+  if (sort_critics_ && !batch_scoring_) {
+    sortCritics(critic_statistics);
+  }
+
+  // The best trajectory is only copied once found, and the worst is only needed by results
+  int best_index = -1;
+  double worst_total = -1;
+  for (unsigned int i = 0; i < num_trajs; ++i) {
+    if (failures[i]) {
       if (results) {
         dwb_msgs::msg::TrajectoryScore failed_score;
-        failed_score.traj = traj;
+        failed_score.traj = trajs[i];
 
         dwb_msgs::msg::CriticScore cs;
-        cs.name = e.getCriticName();
+        cs.name = failures[i]->getCriticName();
         cs.raw_score = -1.0;
         failed_score.scores.push_back(cs);
         failed_score.total = -1.0;
         results->twists.push_back(failed_score);
       }
-      tracker.addIllegalTrajectory(e);
+      tracker.addIllegalTrajectory(*failures[i]);
+      continue;
+    }
+
+    const dwb_msgs::msg::TrajectoryScore & score = scores[i];
+    tracker.addLegalTrajectory();
+    if (results) {
+      results->twists.push_back(score);
+      results->twists.back().traj = trajs[i];
+    }
+    if (best_index < 0 || score.total < scores[best_index].total) {
+      best_index = i;
+      if (results) {
+        results->best_index = results->twists.size() - 1;
+      }
+    }
+    if (results && (worst_total < 0 || score.total > worst_total)) {
+      worst_total = score.total;
+      results->worst_index = results->twists.size() - 1;
     }
   }
+  if (best_index >= 0) {
+    best = scores[best_index];
+    best.traj = trajs[best_index];
+  }
 
   if (best.total < 0) {
     if (debug_trajectory_details_) {
@@ -408,32 +565,149 @@ DWBLocalPlanner::coreScoringAlgorithm(
 dwb_msgs::msg::TrajectoryScore
 DWBLocalPlanner::scoreTrajectory(
   const dwb_msgs::msg::Trajectory2D & traj,
-  double best_score)
+  double best_score, ScoringStatistics * statistics)
 {
   dwb_msgs::msg::TrajectoryScore score;
+  scoreTrajectoryInto(traj, best_score, statistics, score);
   score.traj = traj;
+  return score;
+}
 
-  for (TrajectoryCritic::Ptr & critic : critics_) {
-    dwb_msgs::msg::CriticScore cs;
-    cs.name = critic->getName();
-    cs.scale = critic->getScale();
+void
+DWBLocalPlanner::scoreTrajectoryInto(
+  const dwb_msgs::msg::Trajectory2D & traj,
+  double best_score, ScoringStatistics * statistics,
+  dwb_msgs::msg::TrajectoryScore & score)
+{
+  ScoringStatistics local_statistics;
+  if (!statistics) {
+    statistics = &local_statistics;
+  }
+  statistics->critics.resize(critics_.size());
+  statistics->bounds.resize(critics_.size());
+  ++statistics->pruning.trajectories;
+
+  score.total = 0.0;
+  score.scores.resize(critics_.size());
+  for (size_t i = 0; i < critics_.size(); ++i) {
+    score.scores[i].name = critics_[i]->getName();
+    score.scores[i].raw_score = 0.0;
+    score.scores[i].scale = critics_[i]->getScale();
+  }
+
+  // The scaled lower bounds of the critics left to evaluate
+  const bool short_circuit = short_circuit_trajectory_evaluation_ && best_score > 0;
+  double remaining_bound = 0.0;
+  for (size_t i = 0; i < critics_.size(); ++i) {
+    double & bound = statistics->bounds[i];
+    bound = 0.0;
+    if (short_circuit && prune_with_lower_bounds_ && score.scores[i].scale != 0.0) {
+      bound = critics_[i]->getLowerBound(traj) * score.scores[i].scale;
+      remaining_bound += bound;
+    }
+  }
 
+  for (size_t n = 0; n < critic_order_.size(); ++n) {
+    const size_t i = critic_order_[n];
+    dwb_msgs::msg::CriticScore & cs = score.scores[i];
     if (cs.scale == 0.0) {
-      score.scores.push_back(cs);
       continue;
     }
 
-    double critic_score = critic->scoreTrajectory(traj);
+    // since we keep adding positives, once we are worse than the best, we will stay worse
+    if (short_circuit && score.total + remaining_bound > best_score) {
+      // The total includes the bounds, so that it is still no more than the full score
+      // while being worse than the best
+      score.total += remaining_bound;
+      ++statistics->pruning.pruned_trajectories;
+      for (; n < critic_order_.size(); ++n) {
+        if (score.scores[critic_order_[n]].scale != 0.0) {
+          ++statistics->pruning.pruned_evaluations;
+        }
+      }
+      break;
+    }
+    remaining_bound -= statistics->bounds[i];
+
+    const auto start_time = sort_critics_ ?
+      std::chrono::steady_clock::now() : std::chrono::steady_clock::time_point();
+    double critic_score = critics_[i]->scoreTrajectory(traj);
     cs.raw_score = critic_score;
-    score.scores.push_back(cs);
     score.total += critic_score * cs.scale;
-    if (short_circuit_trajectory_evaluation_ && best_score > 0 && score.total > best_score) {
-      // since we keep adding positives, once we are worse than the best, we will stay worse
-      break;
+
+    if (sort_critics_) {
+      CriticStatistics & critic = statistics->critics[i];
+      const double scaled_score = critic_score * cs.scale;
+      critic.seconds += std::chrono::duration<double>(
+        std::chrono::steady_clock::now() - start_time).count();
+      critic.score_sum += scaled_score;
+      if (critic.evaluations == 0 || scaled_score < critic.min_score) {
+        critic.min_score = scaled_score;
+      }
+      ++critic.evaluations;
     }
   }
+}
 
-  return score;
+void
+DWBLocalPlanner::sortCritics(const std::vector<CriticStatistics> & statistics)
+{
+  // A critic discriminates trajectories by as much as its mean score is above its lowest,
+  // which is roughly the score it adds to trajectories over that of the best one. Critics
+  // skipped for all trajectories keep their rank.
+  for (size_t i = 0; i < critics_.size(); ++i) {
+    const CriticStatistics & critic = statistics[i];
+    if (critic.evaluations > 0) {
+      const double discrimination = critic.score_sum / critic.evaluations - critic.min_score;
+      critic_ranks_[i] = discrimination / std::max(critic.seconds, 1e-9);
+    }
+  }
+  std::stable_sort(
+    critic_order_.begin(), critic_order_.end(),
+    [this](size_t a, size_t b) {return critic_ranks_[a] > critic_ranks_[b];});
+}
+
+void
+DWBLocalPlanner::scoreTrajectoryBatch(
+  const std::vector<dwb_msgs::msg::Trajectory2D> & trajs,
+  unsigned int begin, unsigned int end,
+  std::vector<dwb_msgs::msg::TrajectoryScore> & scores,
+  std::vector<std::unique_ptr<IllegalTrajectoryException>> & failures)
+{
+  TrajectoryBatch batch(trajs.data() + begin, end - begin);
+  std::vector<double> critic_scores(batch.size());
+  std::vector<std::unique_ptr<IllegalTrajectoryException>> batch_failures(batch.size());
+  for (unsigned int i = begin; i < end; ++i) {
+    scores[i].total = 0.0;
+    scores[i].scores.clear();
+  }
+
+  for (TrajectoryCritic::Ptr & critic : critics_) {
+    dwb_msgs::msg::CriticScore cs;
+    cs.name = critic->getName();
+    cs.scale = critic->getScale();
+
+    if (cs.scale != 0.0) {
+      critic->scoreTrajectories(batch, critic_scores, batch_failures);
+    }
+
+    // Illegal trajectories are no longer scored, as scoreTrajectory() stops at their failure
+    for (size_t i = 0; i < batch.size(); ++i) {
+      if (batch_failures[i]) {
+        continue;
+      }
+      dwb_msgs::msg::TrajectoryScore & score = scores[begin + i];
+      if (cs.scale != 0.0) {
+        cs.raw_score = critic_scores[i];
+        score.total += critic_scores[i] * cs.scale;
+      }
+      score.scores.push_back(cs);
+    }
+  }
+
+  for (size_t i = 0; i < batch.size(); ++i) {
+    failures[begin + i] = std::move(batch_failures[i]);
+  }
 }
 
 nav_2d_msgs::msg::Path2D
@@ -485,17 +759,41 @@ DWBLocalPlanner::transformGlobalPlan(
   }
 
   // Find the first pose in the global plan that's further than prune distance
-  // from the robot using integrated distance
+  // from the robot using integrated distance. The search starts at the pose matched by the
+  // last iteration, as the robot already passed the poses before it, so that it only covers
+  // a window of the plan when the plan is not pruned.
+  auto plan_start = begin(global_plan_.poses) +
+    std::min(plan_start_index_, global_plan_.poses.size() - 1);
   auto prune_point = nav2_util::geometry_utils::first_after_integrated_distance(
-    global_plan_.poses.begin(), global_plan_.poses.end(), prune_dist);
+    plan_start, global_plan_.poses.end(), prune_dist);
 
   // Find the first pose in the plan (upto prune_point) that's less than transform_start_threshold
   // from the robot.
-  auto transformation_begin = std::find_if(
-    begin(global_plan_.poses), prune_point,
-    [&](const auto & global_plan_pose) {
+  auto close_to_robot = [&](const auto & global_plan_pose) {
       return euclidean_distance(robot_pose.pose, global_plan_pose) < transform_start_threshold;
-    });
+    };
+  auto transformation_begin = std::find_if(plan_start, prune_point, close_to_robot);
+
+  // The robot is not near the plan where it was, such as after a jump of its localization, so
+  // it may be anywhere along the rest of the plan
+  if (transformation_begin == prune_point && recover_plan_position_ &&
+    prune_point != global_plan_.poses.end())
+  {
+    auto closest = nav2_util::geometry_utils::min_by(
+      prune_point, global_plan_.poses.end(),
+      [&](const auto & global_plan_pose) {
+        return euclidean_distance(robot_pose.pose, global_plan_pose);
+      });
+    if (close_to_robot(*closest)) {
+      RCLCPP_WARN(
+        logger_, "Robot is not near the plan where it was, found it %zu poses further",
+        static_cast<size_t>(closest - plan_start));
+      transformation_begin = closest;
+      while (transformation_begin != plan_start && close_to_robot(*(transformation_begin - 1))) {
+        --transformation_begin;
+      }
+    }
+  }
 
   // Find the first pose in the end of the plan that's further than transform_end_threshold
   // from the robot using integrated distance
@@ -522,16 +820,45 @@ DWBLocalPlanner::transformGlobalPlan(
       return transformed_pose.pose;
     };
 
-  std::transform(
-    transformation_begin, transformation_end,
-    std::back_inserter(transformed_plan.poses),
-    transformGlobalPoseToLocal);
+  // The poses are transformed with the latest transform, so it is looked up once for all of
+  // them rather than for each pose, unless it is not available
+  transformed_plan.poses.reserve(transformation_end - transformation_begin);
+  if (global_plan_.header.frame_id == transformed_plan.header.frame_id) {
+    transformed_plan.poses.assign(transformation_begin, transformation_end);
+  } else {
+    geometry_msgs::msg::TransformStamped plan_to_local;
+    bool have_transform = true;
+    try {
+      plan_to_local = tf_->lookupTransform(
+        transformed_plan.header.frame_id, global_plan_.header.frame_id, tf2::TimePointZero);
+    } catch (const tf2::TransformException &) {
+      have_transform = false;
+    }
+    if (have_transform) {
+      std::transform(
+        transformation_begin, transformation_end,
+        std::back_inserter(transformed_plan.poses),
+        [&](const auto & global_plan_pose) {
+          geometry_msgs::msg::Pose local_pose;
+          tf2::doTransform(nav_2d_utils::pose2DToPose(global_plan_pose), local_pose, plan_to_local);
+          return nav_2d_utils::poseToPose2D(local_pose);
+        });
+    } else {
+      std::transform(
+        transformation_begin, transformation_end,
+        std::back_inserter(transformed_plan.poses),
+        transformGlobalPoseToLocal);
+    }
+  }
 
   // Remove the portion of the global plan that we've already passed so we don't
-  // process it on the next iteration.
+  // process it on the next iteration. Without pruning, the next search starts there.
   if (prune_plan_) {
     global_plan_.poses.erase(begin(global_plan_.poses), transformation_begin);
+    plan_start_index_ = 0;
     pub_->publishGlobalPlan(global_plan_);
+  } else if (transformation_begin != prune_point) {
+    plan_start_index_ = transformation_begin - begin(global_plan_.poses);
   }
 
   if (transformed_plan.poses.empty()) {
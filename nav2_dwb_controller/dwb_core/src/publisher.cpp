@@ -154,13 +154,20 @@ DWBPublisher::on_cleanup()
   return nav2_util::CallbackReturn::SUCCESS;
 }
 
+bool
+DWBPublisher::shouldRecordEvaluation()
+{
+  return (publish_evaluation_ && eval_pub_->get_subscription_count() > 0) ||
+         (publish_trajectories_ && marker_pub_->get_subscription_count() > 0);
+}
+
 void
 DWBPublisher::publishEvaluation(std::shared_ptr<dwb_msgs::msg::LocalPlanEvaluation> results)
 {
   if (results) {
+    // Published by reference, so that the evaluation is not copied unless intra process
     if (publish_evaluation_ && eval_pub_->get_subscription_count() > 0) {
-      auto msg = std::make_unique<dwb_msgs::msg::LocalPlanEvaluation>(*results);
-      eval_pub_->publish(std::move(msg));
+      eval_pub_->publish(*results);
     }
     publishTrajectories(*results);
   }
@@ -338,26 +345,26 @@ DWBPublisher::publishCostGrid(
 }
 
 void
-DWBPublisher::publishGlobalPlan(const nav_2d_msgs::msg::Path2D plan)
+DWBPublisher::publishGlobalPlan(const nav_2d_msgs::msg::Path2D & plan)
 {
   publishGenericPlan(plan, *global_pub_, publish_global_plan_);
 }
 
 void
-DWBPublisher::publishTransformedPlan(const nav_2d_msgs::msg::Path2D plan)
+DWBPublisher::publishTransformedPlan(const nav_2d_msgs::msg::Path2D & plan)
 {
   publishGenericPlan(plan, *transformed_pub_, publish_transformed_);
 }
 
 void
-DWBPublisher::publishLocalPlan(const nav_2d_msgs::msg::Path2D plan)
+DWBPublisher::publishLocalPlan(const nav_2d_msgs::msg::Path2D & plan)
 {
   publishGenericPlan(plan, *local_pub_, publish_local_plan_);
 }
 
 void
 DWBPublisher::publishGenericPlan(
-  const nav_2d_msgs::msg::Path2D plan,
+  const nav_2d_msgs::msg::Path2D & plan,
   rclcpp::Publisher<nav_msgs::msg::Path> & pub, bool flag)
 {
   if (pub.get_subscription_count() < 1) {return;}
@@ -0,0 +1,457 @@
+/*
+ * Software License Agreement (BSD License)
+ *
+ *  Copyright (c) 2018, Locus Robotics
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer in the documentation and/or other materials provided
+ *     with the distribution.
+ *   * Neither the name of the copyright holder nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ *  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ *  COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ *  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include <algorithm>
+#include <cmath>
+#include <cstdarg>
+#include <cstdio>
+#include <limits>
+#include <memory>
+#include <numeric>
+#include <random>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "gtest/gtest.h"
+#include "rclcpp/rclcpp.hpp"
+#include "rcutils/logging.h"
+#include "dwb_core/dwb_local_planner.hpp"
+#include "dwb_core/exceptions.hpp"
+#include "nav_2d_utils/tf_help.hpp"
+#include "nav2_util/geometry_utils.hpp"
+#include "tf2_ros/buffer.h"
+
+// Generates a twist per trajectory index, in x, into a trajectory with that velocity
+class IndexGenerator : public dwb_core::TrajectoryGenerator
+{
+public:
+  explicit IndexGenerator(unsigned int num_twists)
+  : num_twists_(num_twists) {}
+
+  void initialize(const nav2_util::LifecycleNode::SharedPtr &, const std::string &) override {}
+  void startNewIteration(const nav_2d_msgs::msg::Twist2D &) override {next_ = 0;}
+  bool hasMoreTwists() override {return next_ < num_twists_;}
+
+  nav_2d_msgs::msg::Twist2D nextTwist() override
+  {
+    nav_2d_msgs::msg::Twist2D twist;
+    twist.x = next_++;
+    return twist;
+  }
+
+  dwb_msgs::msg::Trajectory2D generateTrajectory(
+    const geometry_msgs::msg::Pose2D &, const nav_2d_msgs::msg::Twist2D &,
+    const nav_2d_msgs::msg::Twist2D & cmd_vel) override
+  {
+    dwb_msgs::msg::Trajectory2D traj;
+    traj.velocity = cmd_vel;
+    return traj;
+  }
+
+  void setSpeedLimit(const double &, const bool &) override {}
+
+protected:
+  unsigned int num_twists_;
+  unsigned int next_{0};
+};
+
+// Scores each trajectory from a table, negative scores being illegal, with a lower bound a
+// fraction of the score
+class TableCritic : public dwb_core::TrajectoryCritic
+{
+public:
+  TableCritic(
+    const std::string & name, double scale, std::vector<double> scores,
+    double bound_ratio, bool thread_safe = true)
+  : scores_(std::move(scores)), bound_ratio_(bound_ratio), thread_safe_(thread_safe)
+  {
+    name_ = name;
+    scale_ = scale;
+  }
+
+  double scoreTrajectory(const dwb_msgs::msg::Trajectory2D & traj) override
+  {
+    const double score = scores_[static_cast<size_t>(traj.velocity.x)];
+    if (score < 0.0) {
+      throw dwb_core::IllegalTrajectoryException(name_, "Illegal in the table.");
+    }
+    return score;
+  }
+
+  double getLowerBound(const dwb_msgs::msg::Trajectory2D & traj) override
+  {
+    return std::max(0.0, scores_[static_cast<size_t>(traj.velocity.x)]) * bound_ratio_;
+  }
+
+  bool isThreadSafe() const override {return thread_safe_;}
+
+protected:
+  std::vector<double> scores_;
+  double bound_ratio_;
+  bool thread_safe_;
+};
+
+// Planner scoring the trajectories of an IndexGenerator with the given critics
+class ScoringPlanner : public dwb_core::DWBLocalPlanner
+{
+public:
+  ScoringPlanner(
+    const std::vector<dwb_core::TrajectoryCritic::Ptr> & critics, unsigned int num_twists,
+    bool prune_with_lower_bounds, bool sort_critics)
+  {
+    traj_generator_ = std::make_shared<IndexGenerator>(num_twists);
+    critics_ = critics;
+    short_circuit_trajectory_evaluation_ = true;
+    batch_scoring_ = false;
+    prune_with_lower_bounds_ = prune_with_lower_bounds;
+    sort_critics_ = sort_critics;
+    debug_trajectory_details_ = false;
+    critic_order_.resize(critics_.size());
+    std::iota(critic_order_.begin(), critic_order_.end(), 0);
+    critic_ranks_.assign(critics_.size(), std::numeric_limits<double>::infinity());
+  }
+
+  dwb_msgs::msg::TrajectoryScore score(
+    std::shared_ptr<dwb_msgs::msg::LocalPlanEvaluation> results = nullptr)
+  {
+    return coreScoringAlgorithm(geometry_msgs::msg::Pose2D(), nav_2d_msgs::msg::Twist2D(), results);
+  }
+
+  using DWBLocalPlanner::createScoringPool;
+
+  bool scoresInParallel() const {return scoring_pool_ != nullptr;}
+
+  void setShortCircuit(bool short_circuit) {short_circuit_trajectory_evaluation_ = short_circuit;}
+};
+
+// Critics with random scores and lower bounds from none to exact, some trajectories illegal,
+// and one critic ignored
+std::vector<dwb_core::TrajectoryCritic::Ptr> makeCritics(unsigned int num_twists)
+{
+  std::mt19937 generator(42);
+  std::uniform_real_distribution<double> distribution(0.0, 10.0);
+  auto table = [&](double illegal_ratio) {
+      std::vector<double> scores(num_twists);
+      for (double & score : scores) {
+        score = distribution(generator) < 10.0 * illegal_ratio ? -1.0 : distribution(generator);
+      }
+      return scores;
+    };
+  return {
+    std::make_shared<TableCritic>("Loose", 1.0, table(0.0), 0.0),
+    std::make_shared<TableCritic>("Exact", 2.0, table(0.1), 1.0),
+    std::make_shared<TableCritic>("Ignored", 0.0, table(0.0), 1.0),
+    std::make_shared<TableCritic>("Half", 0.5, table(0.0), 0.5),
+    std::make_shared<TableCritic>("Tight", 3.0, table(0.0), 0.9)};
+}
+
+TEST(DWBLocalPlanner, PruningChoosesSameTwist)
+{
+  const unsigned int num_twists = 200;
+  auto critics = makeCritics(num_twists);
+  ScoringPlanner plain(critics, num_twists, false, false);
+  ScoringPlanner pruning(critics, num_twists, true, true);
+
+  // The critics are sorted after each iteration, so the later ones score in another order
+  for (int iteration = 0; iteration < 4; ++iteration) {
+    const auto expected = plain.score();
+    const auto best = pruning.score();
+    EXPECT_EQ(best.traj.velocity.x, expected.traj.velocity.x);
+    EXPECT_NEAR(best.total, expected.total, 1e-4);
+    EXPECT_EQ(pruning.getPruningStatistics().trajectories, num_twists);
+    EXPECT_GT(pruning.getPruningStatistics().pruned_trajectories, 0u);
+  }
+}
+
+TEST(DWBLocalPlanner, PrunedTotalNeverPicked)
+{
+  const unsigned int num_twists = 200;
+  ScoringPlanner planner(makeCritics(num_twists), num_twists, true, true);
+
+  for (int iteration = 0; iteration < 2; ++iteration) {
+    auto results = std::make_shared<dwb_msgs::msg::LocalPlanEvaluation>();
+    const auto best = planner.score(results);
+    EXPECT_EQ(results->twists[results->best_index].traj.velocity.x, best.traj.velocity.x);
+
+    unsigned int pruned = 0;
+    for (const auto & twist : results->twists) {
+      if (twist.total < 0.0) {
+        continue;
+      }
+      // Scoring without a best score to beat gives the full score. A trajectory cut short may
+      // also be illegal, by a critic it skipped
+      double full_total = std::numeric_limits<double>::infinity();
+      try {
+        full_total = planner.scoreTrajectory(twist.traj).total;
+      } catch (const dwb_core::IllegalTrajectoryException &) {
+      }
+      EXPECT_LE(twist.total, full_total + 1e-4);
+      if (twist.total < full_total - 1e-4) {
+        ++pruned;
+        EXPECT_GT(twist.total, best.total);
+      }
+    }
+    EXPECT_GT(pruned, 0u);
+    EXPECT_NEAR(best.total, planner.scoreTrajectory(best.traj).total, 1e-4);
+  }
+}
+
+TEST(DWBLocalPlanner, ParallelScoringMatchesSerial)
+{
+  const unsigned int num_twists = 200;
+  auto critics = makeCritics(num_twists);
+
+  // Without short circuiting, every trajectory gets its full score, while with it, each chunk
+  // of a parallel iteration cuts trajectories short by its own best score
+  for (const bool short_circuit : {false, true}) {
+    ScoringPlanner serial(critics, num_twists, short_circuit, short_circuit);
+    ScoringPlanner parallel(critics, num_twists, short_circuit, short_circuit);
+    serial.setShortCircuit(short_circuit);
+    parallel.setShortCircuit(short_circuit);
+    serial.createScoringPool(1);
+    parallel.createScoringPool(4);
+    ASSERT_FALSE(serial.scoresInParallel());
+    ASSERT_TRUE(parallel.scoresInParallel());
+
+    for (int iteration = 0; iteration < 2; ++iteration) {
+      auto serial_results = std::make_shared<dwb_msgs::msg::LocalPlanEvaluation>();
+      auto parallel_results = std::make_shared<dwb_msgs::msg::LocalPlanEvaluation>();
+      const auto expected = serial.score(serial_results);
+      const auto best = parallel.score(parallel_results);
+      EXPECT_EQ(best.traj.velocity.x, expected.traj.velocity.x);
+      EXPECT_EQ(best.total, expected.total);
+
+      ASSERT_EQ(parallel_results->twists.size(), serial_results->twists.size());
+      EXPECT_EQ(parallel_results->best_index, serial_results->best_index);
+      if (short_circuit) {
+        continue;
+      }
+      EXPECT_EQ(parallel_results->worst_index, serial_results->worst_index);
+      for (size_t i = 0; i < serial_results->twists.size(); ++i) {
+        const auto & twist = parallel_results->twists[i];
+        const auto & expected_twist = serial_results->twists[i];
+        EXPECT_EQ(twist.traj.velocity.x, expected_twist.traj.velocity.x);
+        EXPECT_EQ(twist.total, expected_twist.total);
+        ASSERT_EQ(twist.scores.size(), expected_twist.scores.size());
+        for (size_t j = 0; j < twist.scores.size(); ++j) {
+          EXPECT_EQ(twist.scores[j].name, expected_twist.scores[j].name);
+          EXPECT_EQ(twist.scores[j].raw_score, expected_twist.scores[j].raw_score);
+        }
+      }
+    }
+  }
+}
+
+// Warnings logged while captured
+std::vector<std::string> warnings;
+
+void captureWarnings(
+  const rcutils_log_location_t *, int severity, const char *, rcutils_time_point_value_t,
+  const char * format, va_list * args)
+{
+  if (severity == RCUTILS_LOG_SEVERITY_WARN) {
+    char message[1024];
+    vsnprintf(message, sizeof(message), format, *args);
+    warnings.push_back(message);
+  }
+}
+
+TEST(DWBLocalPlanner, SerialScoringFallback)
+{
+  const unsigned int num_twists = 10;
+  const std::vector<double> scores(num_twists, 1.0);
+  auto safe_critic = std::make_shared<TableCritic>("Safe", 1.0, scores, 0.0);
+  auto unsafe_critic = std::make_shared<TableCritic>("Unsafe", 1.0, scores, 0.0, false);
+  ScoringPlanner parallel({safe_critic}, num_twists, false, false);
+  ScoringPlanner serial({safe_critic, unsafe_critic}, num_twists, false, false);
+
+  ASSERT_EQ(rcutils_logging_initialize(), RCUTILS_RET_OK);
+  const rcutils_logging_output_handler_t handler = rcutils_logging_get_output_handler();
+  rcutils_logging_set_output_handler(captureWarnings);
+  parallel.createScoringPool(4);
+  const size_t parallel_warnings = warnings.size();
+  serial.createScoringPool(4);
+  rcutils_logging_set_output_handler(handler);
+
+  EXPECT_TRUE(parallel.scoresInParallel());
+  EXPECT_EQ(parallel_warnings, 0u);
+  EXPECT_FALSE(serial.scoresInParallel());
+  ASSERT_EQ(warnings.size(), 1u);
+  EXPECT_NE(warnings[0].find("\"Unsafe\" is not thread safe"), std::string::npos);
+  EXPECT_EQ(serial.score().total, 2.0);
+}
+
+// Planner transforming its global plan into the map frame of a costmap
+class PlanTransformer : public dwb_core::DWBLocalPlanner
+{
+public:
+  PlanTransformer(
+    const nav2_util::LifecycleNode::SharedPtr & node, const std::shared_ptr<tf2_ros::Buffer> & tf,
+    const std::shared_ptr<nav2_costmap_2d::Costmap2DROS> & costmap_ros, bool prune_plan)
+  {
+    node_ = node;
+    tf_ = tf;
+    costmap_ros_ = costmap_ros;
+    pub_ = std::make_unique<dwb_core::DWBPublisher>(node, "transformer");
+    pub_->on_configure();
+    traj_generator_ = std::make_shared<IndexGenerator>(1);
+    prune_plan_ = prune_plan;
+    prune_distance_ = 2.0;
+    recover_plan_position_ = false;
+    shorten_transformed_plan_ = false;
+    transform_tolerance_ = rclcpp::Duration::from_seconds(0.1);
+  }
+
+  using DWBLocalPlanner::transformGlobalPlan;
+};
+
+// Set the transform of the odom frame in the map frame
+void setOdomTransform(tf2_ros::Buffer & tf, double x, double y, double yaw)
+{
+  geometry_msgs::msg::TransformStamped transform;
+  transform.header.frame_id = "map";
+  transform.child_frame_id = "odom";
+  transform.transform.translation.x = x;
+  transform.transform.translation.y = y;
+  transform.transform.rotation = nav2_util::geometry_utils::orientationAroundZAxis(yaw);
+  tf.setTransform(transform, "planner_test", true);
+}
+
+// A straight plan in the odom frame, a pose every 0.1 m
+nav_msgs::msg::Path makeOdomPlan(double start_x, double y)
+{
+  nav_msgs::msg::Path plan;
+  plan.header.frame_id = "odom";
+  for (int i = 0; i < 80; ++i) {
+    geometry_msgs::msg::PoseStamped pose;
+    pose.header.frame_id = "odom";
+    pose.pose.position.x = start_x + 0.1 * i;
+    pose.pose.position.y = y;
+    pose.pose.orientation.w = 1.0;
+    plan.poses.push_back(pose);
+  }
+  return plan;
+}
+
+nav_2d_msgs::msg::Pose2DStamped makeOdomPose(double x, double y)
+{
+  nav_2d_msgs::msg::Pose2DStamped pose;
+  pose.header.frame_id = "odom";
+  pose.pose.x = x;
+  pose.pose.y = y;
+  return pose;
+}
+
+// Expect the poses of the transformed plan to be consecutive poses of the plan, each
+// transformed by its own lookup
+void expectTransformedPoses(
+  const std::shared_ptr<tf2_ros::Buffer> & tf, const nav_msgs::msg::Path & plan,
+  const nav_2d_msgs::msg::Path2D & transformed_plan)
+{
+  rclcpp::Duration transform_tolerance = rclcpp::Duration::from_seconds(0.1);
+  std::vector<geometry_msgs::msg::Pose2D> expected_poses;
+  for (const auto & pose : plan.poses) {
+    nav_2d_msgs::msg::Pose2DStamped map_pose;
+    ASSERT_TRUE(
+      nav_2d_utils::transformPose(
+        tf, "map", nav_2d_utils::poseStampedToPose2D(pose), map_pose, transform_tolerance));
+    expected_poses.push_back(map_pose.pose);
+  }
+
+  ASSERT_FALSE(transformed_plan.poses.empty());
+  EXPECT_EQ(transformed_plan.header.frame_id, "map");
+  const auto & first_pose = transformed_plan.poses.front();
+  auto first = std::min_element(
+    expected_poses.begin(), expected_poses.end(),
+    [&](const auto & a, const auto & b) {
+      return std::hypot(a.x - first_pose.x, a.y - first_pose.y) <
+      std::hypot(b.x - first_pose.x, b.y - first_pose.y);
+    });
+  ASSERT_LE(
+    transformed_plan.poses.size(), static_cast<size_t>(expected_poses.end() - first));
+  for (size_t i = 0; i < transformed_plan.poses.size(); ++i) {
+    EXPECT_NEAR(transformed_plan.poses[i].x, first[i].x, 1e-9);
+    EXPECT_NEAR(transformed_plan.poses[i].y, first[i].y, 1e-9);
+    EXPECT_NEAR(transformed_plan.poses[i].theta, first[i].theta, 1e-9);
+  }
+}
+
+TEST(DWBLocalPlanner, TransformedPlanMatchesFreshOne)
+{
+  auto node = nav2_util::LifecycleNode::make_shared("plan_transformer_tester");
+  auto costmap_ros = std::make_shared<nav2_costmap_2d::Costmap2DROS>("test_global_costmap");
+  costmap_ros->configure();
+
+  for (const bool prune_plan : {false, true}) {
+    auto tf = std::make_shared<tf2_ros::Buffer>(node->get_clock());
+    setOdomTransform(*tf, 1.0, 0.5, 0.3);
+    PlanTransformer transformer(node, tf, costmap_ros, prune_plan);
+    auto plan = makeOdomPlan(0.0, 0.0);
+    transformer.setPlan(plan);
+
+    // The window follows the robot along the plan, its poses transformed with a single lookup
+    for (double x = 0.0; x < 5.0; x += 0.5) {
+      expectTransformedPoses(tf, plan, transformer.transformGlobalPlan(makeOdomPose(x, 0.1)));
+    }
+
+    // The odom frame drifted in the map frame
+    setOdomTransform(*tf, 1.2, 0.4, 0.35);
+    const auto robot_pose = makeOdomPose(5.0, 0.1);
+    expectTransformedPoses(tf, plan, transformer.transformGlobalPlan(robot_pose));
+
+    // A new plan, on which the robot is again near the start, gives the window of a planner
+    // which never had another plan
+    plan = makeOdomPlan(4.0, 0.5);
+    transformer.setPlan(plan);
+    PlanTransformer fresh_transformer(node, tf, costmap_ros, prune_plan);
+    fresh_transformer.setPlan(plan);
+    const auto transformed_plan = transformer.transformGlobalPlan(robot_pose);
+    const auto fresh_plan = fresh_transformer.transformGlobalPlan(robot_pose);
+    expectTransformedPoses(tf, plan, transformed_plan);
+    ASSERT_EQ(transformed_plan.poses.size(), fresh_plan.poses.size());
+    for (size_t i = 0; i < fresh_plan.poses.size(); ++i) {
+      EXPECT_EQ(transformed_plan.poses[i].x, fresh_plan.poses[i].x);
+      EXPECT_EQ(transformed_plan.poses[i].y, fresh_plan.poses[i].y);
+      EXPECT_EQ(transformed_plan.poses[i].theta, fresh_plan.poses[i].theta);
+    }
+  }
+}
+
+int main(int argc, char ** argv)
+{
+  rclcpp::init(argc, argv);
+  testing::InitGoogleTest(&argc, argv);
+  return RUN_ALL_TESTS();
+}
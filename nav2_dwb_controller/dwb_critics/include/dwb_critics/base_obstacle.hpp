@@ -59,6 +59,7 @@ class BaseObstacleCritic : public dwb_core::TrajectoryCritic
 public:
   void onInit() override;
   double scoreTrajectory(const dwb_msgs::msg::Trajectory2D & traj) override;
+  bool isThreadSafe() const override {return true;}
   void addCriticVisualization(
     std::vector<std::pair<std::string, std::vector<float>>> & cost_channels) override;
 
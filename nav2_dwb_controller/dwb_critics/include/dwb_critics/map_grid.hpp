@@ -64,6 +64,11 @@ public:
   // Standard TrajectoryCritic Interface
   void onInit() override;
   double scoreTrajectory(const dwb_msgs::msg::Trajectory2D & traj) override;
+  double getLowerBound(const dwb_msgs::msg::Trajectory2D & traj) override;
+  bool isThreadSafe() const override {return true;}
+  void scoreTrajectories(
+    const dwb_core::TrajectoryBatch & batch, std::vector<double> & scores,
+    std::vector<std::unique_ptr<dwb_core::IllegalTrajectoryException>> & failures) override;
   void addCriticVisualization(
     std::vector<std::pair<std::string, std::vector<float>>> & cost_channels) override;
   double getScale() const override {return costmap_->getResolution() * 0.5 * scale_;}
@@ -125,17 +130,43 @@ protected:
    */
   void reset() override;
 
+  /**
+   * @brief Aggregate the grid scores of the poses of a trajectory
+   * @param num_poses Number of poses in the trajectory
+   * @param score_pose Function returning the grid score of the pose at an index
+   * @return The score of the trajectory
+   */
+  template<typename ScorePose>
+  double aggregateScores(unsigned int num_poses, ScorePose score_pose);
+
   /**
    * @brief Go through the queue and set the cells to the Manhattan distance from their parents
    */
   void propogateManhattanDistances();
 
+  /**
+   * @brief Set the cells to the Manhattan distance from the closest source cell
+   *
+   * Gives the same distances as enqueueing the sources and propagating them through the
+   * queue, as the queue expands through all cells, but in two passes over the grid. The
+   * distances only depend on the sources and the size of the costmap, so they are kept
+   * as they are when neither changed since the last call.
+   *
+   * @param sources Indices of the source cells
+   */
+  void setManhattanDistances(const std::vector<unsigned int> & sources);
+
   std::shared_ptr<MapGridQueue> queue_;
   nav2_costmap_2d::Costmap2D * costmap_;
   std::vector<double> cell_values_;
   double obstacle_score_, unreachable_score_;  ///< Special cell_values
   bool stop_on_failure_;
   ScoreAggregationType aggregationType_;
+
+  // Sources and costmap size of the distances in cell_values_, if they are current
+  std::vector<unsigned int> sources_;
+  unsigned int sources_size_x_{0}, sources_size_y_{0};
+  bool sources_current_{false};
 };
 }  // namespace dwb_critics
 
@@ -35,6 +35,7 @@
 #ifndef DWB_CRITICS__OBSTACLE_FOOTPRINT_HPP_
 #define DWB_CRITICS__OBSTACLE_FOOTPRINT_HPP_
 
+#include <memory>
 #include <vector>
 #include "dwb_critics/base_obstacle.hpp"
 
@@ -72,6 +73,9 @@ public:
   virtual double scorePose(
     const geometry_msgs::msg::Pose2D & pose,
     const Footprint & oriented_footprint);
+  void scoreTrajectories(
+    const dwb_core::TrajectoryBatch & batch, std::vector<double> & scores,
+    std::vector<std::unique_ptr<dwb_core::IllegalTrajectoryException>> & failures) override;
   double getScale() const override {return costmap_->getResolution() * scale_;}
 
 protected:
@@ -34,6 +34,7 @@
 #ifndef DWB_CRITICS__PATH_ALIGN_HPP_
 #define DWB_CRITICS__PATH_ALIGN_HPP_
 
+#include <memory>
 #include <vector>
 #include <string>
 #include "dwb_critics/path_dist.hpp"
@@ -65,6 +66,17 @@ public:
   double getScale() const override;
   double scorePose(const geometry_msgs::msg::Pose2D & pose) override;
 
+  /**
+   * @brief Score each trajectory of a batch with scoreTrajectory, as the poses scored are
+   * projected forward by scorePose rather than those of the batch
+   */
+  void scoreTrajectories(
+    const dwb_core::TrajectoryBatch & batch, std::vector<double> & scores,
+    std::vector<std::unique_ptr<dwb_core::IllegalTrajectoryException>> & failures) override
+  {
+    dwb_core::TrajectoryCritic::scoreTrajectories(batch, scores, failures);
+  }
+
 protected:
   bool zero_scale_;
   double forward_point_distance_;
@@ -34,6 +34,8 @@
 #ifndef DWB_CRITICS__PATH_DIST_HPP_
 #define DWB_CRITICS__PATH_DIST_HPP_
 
+#include <vector>
+
 #include "dwb_critics/map_grid.hpp"
 
 namespace dwb_critics
@@ -48,6 +50,10 @@ public:
   bool prepare(
     const geometry_msgs::msg::Pose2D & pose, const nav_2d_msgs::msg::Twist2D & vel,
     const geometry_msgs::msg::Pose2D & goal, const nav_2d_msgs::msg::Path2D & global_plan) override;
+
+protected:
+  // Cells of the global plan on the costmap, kept to reuse their capacity
+  std::vector<unsigned int> path_cells_;
 };
 
 }  // namespace dwb_critics
@@ -53,6 +53,7 @@ class TwirlingCritic : public dwb_core::TrajectoryCritic
 public:
   void onInit() override;
   double scoreTrajectory(const dwb_msgs::msg::Trajectory2D & traj) override;
+  bool isThreadSafe() const override {return true;}
 };
 }  // namespace dwb_critics
 
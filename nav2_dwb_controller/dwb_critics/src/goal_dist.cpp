@@ -45,19 +45,14 @@ bool GoalDistCritic::prepare(
   const geometry_msgs::msg::Pose2D &,
   const nav_2d_msgs::msg::Path2D & global_plan)
 {
-  reset();
-
   unsigned int local_goal_x, local_goal_y;
   if (!getLastPoseOnCostmap(global_plan, local_goal_x, local_goal_y)) {
+    reset();
     return false;
   }
 
-  // Enqueue just the last pose
-  int index = costmap_->getIndex(local_goal_x, local_goal_y);
-  cell_values_[index] = 0.0;
-  queue_->enqueueCell(local_goal_x, local_goal_y);
-
-  propogateManhattanDistances();
+  // Just the last pose is a source
+  setManhattanDistances({costmap_->getIndex(local_goal_x, local_goal_y)});
 
   return true;
 }
@@ -94,10 +94,12 @@ void MapGridCritic::onInit()
 void MapGridCritic::setAsObstacle(unsigned int index)
 {
   cell_values_[index] = obstacle_score_;
+  sources_current_ = false;
 }
 
 void MapGridCritic::reset()
 {
+  sources_current_ = false;
   queue_->reset();
   cell_values_.resize(costmap_->getSizeInCellsX() * costmap_->getSizeInCellsY());
   obstacle_score_ = static_cast<double>(cell_values_.size());
@@ -114,19 +116,70 @@ void MapGridCritic::propogateManhattanDistances()
   }
 }
 
-double MapGridCritic::scoreTrajectory(const dwb_msgs::msg::Trajectory2D & traj)
+void MapGridCritic::setManhattanDistances(const std::vector<unsigned int> & sources)
+{
+  const unsigned int size_x = costmap_->getSizeInCellsX();
+  const unsigned int size_y = costmap_->getSizeInCellsY();
+  if (sources_current_ && size_x == sources_size_x_ && size_y == sources_size_y_ &&
+    sources == sources_)
+  {
+    return;
+  }
+
+  reset();
+  for (unsigned int index : sources) {
+    cell_values_[index] = 0.0;
+  }
+
+  // Without obstacles, the distance of each cell is the lowest of those of its neighbors
+  // plus one, which a forward and a backward pass find for the neighbors on either side
+  if (!sources.empty()) {
+    for (unsigned int y = 0; y < size_y; ++y) {
+      double * row = cell_values_.data() + y * size_x;
+      const double * above = y > 0 ? row - size_x : nullptr;
+      for (unsigned int x = 0; x < size_x; ++x) {
+        if (x > 0) {
+          row[x] = std::min(row[x], row[x - 1] + 1.0);
+        }
+        if (above) {
+          row[x] = std::min(row[x], above[x] + 1.0);
+        }
+      }
+    }
+    for (unsigned int y = size_y; y-- > 0; ) {
+      double * row = cell_values_.data() + y * size_x;
+      const double * below = y + 1 < size_y ? row + size_x : nullptr;
+      for (unsigned int x = size_x; x-- > 0; ) {
+        if (x + 1 < size_x) {
+          row[x] = std::min(row[x], row[x + 1] + 1.0);
+        }
+        if (below) {
+          row[x] = std::min(row[x], below[x] + 1.0);
+        }
+      }
+    }
+  }
+
+  sources_ = sources;
+  sources_size_x_ = size_x;
+  sources_size_y_ = size_y;
+  sources_current_ = true;
+}
+
+template<typename ScorePose>
+double MapGridCritic::aggregateScores(unsigned int num_poses, ScorePose score_pose)
 {
   double score = 0.0;
   unsigned int start_index = 0;
   if (aggregationType_ == ScoreAggregationType::Product) {
     score = 1.0;
   } else if (aggregationType_ == ScoreAggregationType::Last && !stop_on_failure_) {
-    start_index = traj.poses.size() - 1;
+    start_index = num_poses - 1;
   }
   double grid_dist;
 
-  for (unsigned int i = start_index; i < traj.poses.size(); ++i) {
-    grid_dist = scorePose(traj.poses[i]);
+  for (unsigned int i = start_index; i < num_poses; ++i) {
+    grid_dist = score_pose(i);
     if (stop_on_failure_) {
       if (grid_dist == obstacle_score_) {
         throw dwb_core::
@@ -155,6 +208,61 @@ double MapGridCritic::scoreTrajectory(const dwb_msgs::msg::Trajectory2D & traj)
   return score;
 }
 
+double MapGridCritic::scoreTrajectory(const dwb_msgs::msg::Trajectory2D & traj)
+{
+  return aggregateScores(
+    traj.poses.size(), [&](unsigned int i) {return scorePose(traj.poses[i]);});
+}
+
+double MapGridCritic::getLowerBound(const dwb_msgs::msg::Trajectory2D & traj)
+{
+  // Scores of poses are not negative, so the score of the last pose is the score of the
+  // trajectory with the last aggregation, and a lower bound of it with the sum
+  if (traj.poses.empty() || aggregationType_ == ScoreAggregationType::Product) {
+    return 0.0;
+  }
+  try {
+    return scorePose(traj.poses.back());
+  } catch (const dwb_core::IllegalTrajectoryException &) {
+    // The trajectory is illegal and scoring it will say so
+    return 0.0;
+  }
+}
+
+void MapGridCritic::scoreTrajectories(
+  const dwb_core::TrajectoryBatch & batch, std::vector<double> & scores,
+  std::vector<std::unique_ptr<dwb_core::IllegalTrajectoryException>> & failures)
+{
+  // The cells under all poses of the batch are found in a single pass over the pose arrays,
+  // those of poses off the grid being past the end of the grid
+  const unsigned int off_grid = cell_values_.size();
+  std::vector<unsigned int> cells(batch.x.size());
+  for (size_t k = 0; k < cells.size(); ++k) {
+    unsigned int cell_x, cell_y;
+    cells[k] = costmap_->worldToMap(batch.x[k], batch.y[k], cell_x, cell_y) ?
+      costmap_->getIndex(cell_x, cell_y) : off_grid;
+  }
+
+  for (size_t i = 0; i < batch.size(); ++i) {
+    if (failures[i]) {
+      continue;
+    }
+    const unsigned int * traj_cells = cells.data() + batch.offsets[i];
+    try {
+      scores[i] = aggregateScores(
+        batch.offsets[i + 1] - batch.offsets[i], [&](unsigned int k) {
+          if (traj_cells[k] == off_grid) {
+            throw dwb_core::
+                  IllegalTrajectoryException(name_, "Trajectory Goes Off Grid.");
+          }
+          return cell_values_[traj_cells[k]];
+        });
+    } catch (const dwb_core::IllegalTrajectoryException & e) {
+      failures[i] = std::make_unique<dwb_core::IllegalTrajectoryException>(e);
+    }
+  }
+}
+
 double MapGridCritic::scorePose(const geometry_msgs::msg::Pose2D & pose)
 {
   unsigned int cell_x, cell_y;
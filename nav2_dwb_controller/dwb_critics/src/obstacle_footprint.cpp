@@ -34,11 +34,13 @@
 
 #include "dwb_critics/obstacle_footprint.hpp"
 #include <algorithm>
+#include <limits>
+#include <memory>
 #include <vector>
-#include "dwb_critics/line_iterator.hpp"
 #include "dwb_core/exceptions.hpp"
 #include "pluginlib/class_list_macros.hpp"
 #include "nav2_costmap_2d/cost_values.hpp"
+#include "nav2_util/grid_traversal.hpp"
 
 PLUGINLIB_EXPORT_CLASS(dwb_critics::ObstacleFootprintCritic, dwb_core::TrajectoryCritic)
 
@@ -84,6 +86,51 @@ double ObstacleFootprintCritic::scorePose(const geometry_msgs::msg::Pose2D & pos
   return scorePose(pose, getOrientedFootprint(pose, footprint_spec_));
 }
 
+void ObstacleFootprintCritic::scoreTrajectories(
+  const dwb_core::TrajectoryBatch & batch, std::vector<double> & scores,
+  std::vector<std::unique_ptr<dwb_core::IllegalTrajectoryException>> & failures)
+{
+  // The headings of all poses of the batch are turned into rotations in a single pass
+  const size_t num_poses = batch.theta.size();
+  std::vector<double> cos_th(num_poses), sin_th(num_poses);
+  for (size_t k = 0; k < num_poses; ++k) {
+    cos_th[k] = cos(batch.theta[k]);
+    sin_th[k] = sin(batch.theta[k]);
+  }
+
+  // The oriented footprint of each pose is written over that of the pose before
+  Footprint footprint(footprint_spec_.size());
+  geometry_msgs::msg::Pose2D pose;
+  for (size_t i = 0; i < batch.size(); ++i) {
+    if (failures[i]) {
+      continue;
+    }
+    try {
+      double score = 0.0;
+      for (size_t k = batch.offsets[i]; k < batch.offsets[i + 1]; ++k) {
+        pose.x = batch.x[k];
+        pose.y = batch.y[k];
+        pose.theta = batch.theta[k];
+        unsigned int cell_x, cell_y;
+        if (!costmap_->worldToMap(pose.x, pose.y, cell_x, cell_y)) {
+          throw dwb_core::
+                IllegalTrajectoryException(name_, "Trajectory Goes Off Grid.");
+        }
+        for (unsigned int j = 0; j < footprint_spec_.size(); ++j) {
+          footprint[j].x = pose.x + footprint_spec_[j].x * cos_th[k] -
+            footprint_spec_[j].y * sin_th[k];
+          footprint[j].y = pose.y + footprint_spec_[j].x * sin_th[k] +
+            footprint_spec_[j].y * cos_th[k];
+        }
+        score = static_cast<double>(sum_scores_) * score + scorePose(pose, footprint);
+      }
+      scores[i] = score;
+    } catch (const dwb_core::IllegalTrajectoryException & e) {
+      failures[i] = std::make_unique<dwb_core::IllegalTrajectoryException>(e);
+    }
+  }
+}
+
 double ObstacleFootprintCritic::scorePose(
   const geometry_msgs::msg::Pose2D &,
   const Footprint & footprint)
@@ -93,6 +140,30 @@ double ObstacleFootprintCritic::scorePose(
   double line_cost = 0.0;
   double footprint_cost = 0.0;
 
+  // footprints with free bounds are free, which the pyramid finds from a few coarse cells
+  const nav2_costmap_2d::CostmapPyramid & pyramid =
+    costmap_ros_->getLayeredCostmap()->getCostmapPyramid();
+  if (pyramid.getLevels() > 0) {
+    unsigned int min_x = std::numeric_limits<unsigned int>::max(), max_x = 0;
+    unsigned int min_y = std::numeric_limits<unsigned int>::max(), max_y = 0;
+    for (const auto & point : footprint) {
+      if (!costmap_->worldToMap(point.x, point.y, x0, y0)) {
+        throw dwb_core::
+              IllegalTrajectoryException(name_, "Footprint Goes Off Grid.");
+      }
+      min_x = std::min(min_x, x0);
+      max_x = std::max(max_x, x0);
+      min_y = std::min(min_y, y0);
+      max_y = std::max(max_y, y0);
+    }
+    if (pyramid.getMaxCost(
+        *costmap_, min_x, min_y, max_x + 1, max_y + 1,
+        nav2_costmap_2d::FREE_SPACE + 1) == nav2_costmap_2d::FREE_SPACE)
+    {
+      return footprint_cost;
+    }
+  }
+
   // we need to rasterize each line in the footprint
   for (unsigned int i = 0; i < footprint.size() - 1; ++i) {
     // get the cell coord of the first point
@@ -134,16 +205,10 @@ double ObstacleFootprintCritic::scorePose(
 double ObstacleFootprintCritic::lineCost(int x0, int x1, int y0, int y1)
 {
   double line_cost = 0.0;
-  double point_cost = -1.0;
-
-  for (LineIterator line(x0, y0, x1, y1); line.isValid(); line.advance()) {
-    point_cost = pointCost(line.getX(), line.getY());   // Score the current point
-
-    if (line_cost < point_cost) {
-      line_cost = point_cost;
-    }
-  }
-
+  nav2_util::traverseLine(
+    x0, y0, x1, y1, [this, &line_cost](int x, int y) {
+      line_cost = std::max(line_cost, pointCost(x, y));
+    });
   return line_cost;
 }
 
@@ -45,7 +45,6 @@ bool PathDistCritic::prepare(
   const geometry_msgs::msg::Pose2D &,
   const nav_2d_msgs::msg::Path2D & global_plan)
 {
-  reset();
   bool started_path = false;
 
   nav_2d_msgs::msg::Path2D adjusted_global_plan =
@@ -60,6 +59,7 @@ bool PathDistCritic::prepare(
 
   unsigned int i;
   // put global path points into local map until we reach the border of the local map
+  path_cells_.clear();
   for (i = 0; i < adjusted_global_plan.poses.size(); ++i) {
     double g_x = adjusted_global_plan.poses[i].x;
     double g_y = adjusted_global_plan.poses[i].y;
@@ -68,15 +68,14 @@ bool PathDistCritic::prepare(
         g_x, g_y, map_x,
         map_y) && costmap_->getCost(map_x, map_y) != nav2_costmap_2d::NO_INFORMATION)
     {
-      int index = costmap_->getIndex(map_x, map_y);
-      cell_values_[index] = 0.0;
-      queue_->enqueueCell(map_x, map_y);
+      path_cells_.push_back(costmap_->getIndex(map_x, map_y));
       started_path = true;
     } else if (started_path) {
       break;
     }
   }
   if (!started_path) {
+    reset();
     RCLCPP_ERROR(
       rclcpp::get_logger("PathDistCritic"),
       "None of the %d first of %zu (%zu) points of the global plan were in "
@@ -85,7 +84,7 @@ bool PathDistCritic::prepare(
     return false;
   }
 
-  propogateManhattanDistances();
+  setManhattanDistances(path_cells_);
 
   return true;
 }
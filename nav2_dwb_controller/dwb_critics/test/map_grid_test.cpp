@@ -0,0 +1,176 @@
+/*
+ * Software License Agreement (BSD License)
+ *
+ *  Copyright (c) 2018, Wilco Bonestroo
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer in the documentation and/or other materials provided
+ *     with the distribution.
+ *   * Neither the name of the copyright holder nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ *  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ *  COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ *  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "gtest/gtest.h"
+#include "rclcpp/rclcpp.hpp"
+#include "dwb_critics/path_dist.hpp"
+#include "nav2_costmap_2d/cost_values.hpp"
+
+// A plan along y = 1 m, across the 5 m wide default costmap
+nav_2d_msgs::msg::Path2D makePlan(double y = 1.0)
+{
+  nav_2d_msgs::msg::Path2D plan;
+  for (double x = 0.05; x < 5.0; x += 0.1) {
+    geometry_msgs::msg::Pose2D pose;
+    pose.x = x;
+    pose.y = y;
+    plan.poses.push_back(pose);
+  }
+  return plan;
+}
+
+// Trajectories of a few poses each, moving away from or along the plan
+std::vector<dwb_msgs::msg::Trajectory2D> makeTrajectories()
+{
+  std::vector<dwb_msgs::msg::Trajectory2D> trajs;
+  for (int i = 0; i < 8; ++i) {
+    dwb_msgs::msg::Trajectory2D traj;
+    for (int k = 0; k < 5; ++k) {
+      geometry_msgs::msg::Pose2D pose;
+      pose.x = 0.5 + 0.4 * k + 0.1 * i;
+      pose.y = 0.3 + 0.5 * i * k / 4.0;
+      traj.poses.push_back(pose);
+    }
+    trajs.push_back(traj);
+  }
+  return trajs;
+}
+
+TEST(MapGrid, LowerBound)
+{
+  auto node = nav2_util::LifecycleNode::make_shared("map_grid_critic_tester");
+  auto costmap_ros = std::make_shared<nav2_costmap_2d::Costmap2DROS>("test_global_costmap");
+  costmap_ros->configure();
+
+  for (const std::string aggregation : {"last", "sum", "product"}) {
+    auto critic = std::make_shared<dwb_critics::PathDistCritic>();
+    const std::string name = "PathDist_" + aggregation;
+    node->declare_parameter("ns." + name + ".aggregation_type", aggregation);
+    critic->initialize(node, name, "ns", costmap_ros);
+    ASSERT_TRUE(
+      critic->prepare(
+        geometry_msgs::msg::Pose2D(), nav_2d_msgs::msg::Twist2D(),
+        geometry_msgs::msg::Pose2D(), makePlan()));
+
+    for (const auto & traj : makeTrajectories()) {
+      const double score = critic->scoreTrajectory(traj);
+      const double bound = critic->getLowerBound(traj);
+      if (aggregation == "product") {
+        // The product of the grid scores may be below the score of the last pose
+        EXPECT_EQ(bound, 0.0);
+      } else {
+        EXPECT_LE(bound, score);
+      }
+      if (aggregation == "last") {
+        EXPECT_EQ(bound, score);
+      }
+    }
+  }
+}
+
+TEST(MapGrid, ReusedGridMatchesFreshOne)
+{
+  auto node = nav2_util::LifecycleNode::make_shared("map_grid_critic_tester");
+  auto costmap_ros = std::make_shared<nav2_costmap_2d::Costmap2DROS>("test_global_costmap");
+  costmap_ros->configure();
+  nav2_costmap_2d::Costmap2D * costmap = costmap_ros->getCostmap();
+
+  auto prepare = [](dwb_critics::PathDistCritic & critic, const nav_2d_msgs::msg::Path2D & plan) {
+      return critic.prepare(
+        geometry_msgs::msg::Pose2D(), nav_2d_msgs::msg::Twist2D(),
+        geometry_msgs::msg::Pose2D(), plan);
+    };
+  // Compares the grid of the critic to that of a critic preparing the plan for the first time
+  auto expect_fresh_grid = [&](
+    dwb_critics::PathDistCritic & critic, const nav_2d_msgs::msg::Path2D & plan) {
+      dwb_critics::PathDistCritic fresh_critic;
+      fresh_critic.initialize(node, "PathDist", "ns", costmap_ros);
+      ASSERT_TRUE(prepare(fresh_critic, plan));
+      for (unsigned int y = 0; y < costmap->getSizeInCellsY(); ++y) {
+        for (unsigned int x = 0; x < costmap->getSizeInCellsX(); ++x) {
+          ASSERT_EQ(critic.getScore(x, y), fresh_critic.getScore(x, y)) << x << ", " << y;
+        }
+      }
+    };
+
+  dwb_critics::PathDistCritic critic;
+  critic.initialize(node, "PathDist", "ns", costmap_ros);
+  auto plan = makePlan(1.0);
+  ASSERT_TRUE(prepare(critic, plan));
+  expect_fresh_grid(critic, plan);
+
+  // The grid is reused for the same plan
+  ASSERT_TRUE(prepare(critic, plan));
+  expect_fresh_grid(critic, plan);
+
+  // The plan moved
+  plan = makePlan(2.5);
+  ASSERT_TRUE(prepare(critic, plan));
+  expect_fresh_grid(critic, plan);
+
+  // Costs changed, under the start of the plan, which is then unknown, and elsewhere
+  for (unsigned int x = 0; x < 20; ++x) {
+    costmap->setCost(x, 25, nav2_costmap_2d::NO_INFORMATION);
+  }
+  costmap->setCost(30, 10, nav2_costmap_2d::LETHAL_OBSTACLE);
+  ASSERT_TRUE(prepare(critic, plan));
+  expect_fresh_grid(critic, plan);
+  // The plan now starts from cell 20
+  EXPECT_EQ(critic.getScore(30, 25), 0.0);
+  EXPECT_EQ(critic.getScore(10, 25), 10.0);
+
+  // The costmap was resized
+  costmap->resizeMap(60, 40, 0.1, 0.0, 0.0);
+  ASSERT_TRUE(prepare(critic, plan));
+  expect_fresh_grid(critic, plan);
+}
+
+int main(int argc, char ** argv)
+{
+  ::testing::InitGoogleTest(&argc, argv);
+
+  // initialize ROS
+  rclcpp::init(argc, argv);
+
+  bool all_successful = RUN_ALL_TESTS();
+
+  // shutdown ROS
+  rclcpp::shutdown();
+
+  return all_successful;
+}
@@ -248,6 +248,66 @@ TEST(ObstacleFootprint, LineCost)
   ASSERT_EQ(critic->lineCost(0, 50, 3, 3), 100);  // pass 50 and 100
 }
 
+TEST(ObstacleFootprint, ScoreTrajectories)
+{
+  std::shared_ptr<dwb_critics::ObstacleFootprintCritic> critic =
+    std::make_shared<dwb_critics::ObstacleFootprintCritic>();
+
+  auto node = nav2_util::LifecycleNode::make_shared("costmap_tester");
+
+  auto costmap_ros = std::make_shared<nav2_costmap_2d::Costmap2DROS>("test_global_costmap");
+  costmap_ros->configure();
+
+  std::string name = "name";
+  std::string ns = "ns";
+  critic->initialize(node, name, ns, costmap_ros);
+
+  geometry_msgs::msg::Pose2D pose;
+  nav_2d_msgs::msg::Twist2D vel;
+  geometry_msgs::msg::Pose2D goal;
+  nav_2d_msgs::msg::Path2D global_plan;
+  costmap_ros->setRobotFootprint(getFootprint());
+  ASSERT_TRUE(critic->prepare(pose, vel, goal, global_plan));
+
+  for (unsigned int i = 0; i < costmap_ros->getCostmap()->getSizeInCellsX(); i++) {
+    costmap_ros->getCostmap()->setCost(i, 1, 100);
+  }
+
+  // Free, crossing the row of cost 100, and with the footprint rotated over the map edge
+  std::vector<dwb_msgs::msg::Trajectory2D> trajs(4);
+  for (unsigned int i = 0; i < 5; i++) {
+    pose.x = footprint_size_x_half + 0.05 + 0.05 * i;
+    pose.y = footprint_size_y_half + 0.25;
+    pose.theta = 0.0;
+    trajs[0].poses.push_back(pose);
+    pose.y = footprint_size_y_half + 0.05;
+    pose.theta = 0.002 * i;
+    trajs[1].poses.push_back(pose);
+    pose.theta = M_PI / 2;
+    trajs[2].poses.push_back(pose);
+  }
+  trajs[3] = trajs[0];
+
+  dwb_core::TrajectoryBatch batch(trajs.data(), trajs.size());
+  ASSERT_EQ(batch.size(), 4u);
+  ASSERT_EQ(batch.offsets.back(), 20u);
+  std::vector<double> scores(batch.size(), -1.0);
+  std::vector<std::unique_ptr<dwb_core::IllegalTrajectoryException>> failures(batch.size());
+  failures[3] = std::make_unique<dwb_core::IllegalTrajectoryException>(name, "Earlier critic.");
+  critic->scoreTrajectories(batch, scores, failures);
+
+  // The batch scores match those of each trajectory, illegal trajectories being skipped
+  EXPECT_EQ(scores[0], critic->scoreTrajectory(trajs[0]));
+  EXPECT_EQ(scores[1], critic->scoreTrajectory(trajs[1]));
+  EXPECT_EQ(scores[1], 100.0);
+  EXPECT_FALSE(failures[0]);
+  EXPECT_FALSE(failures[1]);
+  ASSERT_TRUE(failures[2]);
+  EXPECT_THROW(critic->scoreTrajectory(trajs[2]), dwb_core::IllegalTrajectoryException);
+  EXPECT_EQ(scores[3], -1.0);
+  EXPECT_STREQ(failures[3]->what(), "Earlier critic.");
+}
+
 int main(int argc, char ** argv)
 {
   ::testing::InitGoogleTest(&argc, argv);
@@ -0,0 +1,107 @@
+// Copyright (c) 2022 Samsung Research America
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef DWB_PLUGINS__ADAPTIVE_XY_THETA_ITERATOR_HPP_
+#define DWB_PLUGINS__ADAPTIVE_XY_THETA_ITERATOR_HPP_
+
+#include <algorithm>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "dwb_plugins/xy_theta_iterator.hpp"
+
+namespace dwb_plugins
+{
+
+/**
+ * @class AdaptiveXYThetaIterator
+ * @brief Samples the velocities of XYThetaIterator coarse to fine rather than all of them.
+ *
+ * The first round of an iteration samples a grid coarser than that of XYThetaIterator by
+ * coarse_sampling_factor, along with the best twist of the previous iteration. Each of the
+ * following rounds halves the spacing of the samples around the refinement_candidates best
+ * twists scored so far, down to that of the full grid. If no twist of the coarse grid is legal,
+ * the next round samples the full grid.
+ */
+class AdaptiveXYThetaIterator : public XYThetaIterator
+{
+public:
+  void initialize(
+    const nav2_util::LifecycleNode::SharedPtr & nh,
+    KinematicsHandler::Ptr kinematics,
+    const std::string & plugin_name) override;
+  void startNewIteration(const nav_2d_msgs::msg::Twist2D & current_velocity, double dt) override;
+  bool hasMoreTwists() override;
+  nav_2d_msgs::msg::Twist2D nextTwist() override;
+  void reportScores(
+    const std::vector<nav_2d_msgs::msg::Twist2D> & twists,
+    const std::vector<double> & scores) override;
+
+protected:
+  /**
+   * @struct Range
+   * @brief Velocities reachable along one dimension, and the spacing of the full grid
+   */
+  struct Range
+  {
+    double min, max, increment;
+
+    double clamp(double velocity) const
+    {
+      return std::min(std::max(velocity, min), max);
+    }
+  };
+
+  /**
+   * @brief Get the range of velocities reachable from the current one, as OneDVelocityIterator
+   */
+  static Range getRange(
+    double current, double min, double max, double acc_limit, double decel_limit,
+    double acc_time, int num_samples);
+
+  /**
+   * @brief Get the velocities of a range at a multiple of the spacing of the full grid
+   */
+  static std::vector<double> getSamples(const Range & range, int scale);
+
+  /**
+   * @brief Add the twists of a grid at a multiple of the spacing of the full one to the next round
+   */
+  void addGrid(int scale);
+
+  /**
+   * @brief Add a twist to the next round, if valid and not sampled yet in this iteration
+   */
+  void addTwist(double x, double y, double theta);
+
+  int coarse_sampling_factor_{4};
+  int refinement_candidates_{3};
+
+  Range x_range_, y_range_, theta_range_;
+  // Spacing of the samples of the current round, in that of the full grid
+  int scale_{1};
+  // Twists of the current round, and all twists sampled in this iteration
+  std::vector<nav_2d_msgs::msg::Twist2D> twists_;
+  size_t next_twist_{0};
+  std::vector<nav_2d_msgs::msg::Twist2D> sampled_;
+  // Scores of the legal twists of this iteration, and the best twist of the last one
+  std::vector<std::pair<double, nav_2d_msgs::msg::Twist2D>> scored_;
+  bool has_best_{false};
+  nav_2d_msgs::msg::Twist2D best_;
+};
+
+}  // namespace dwb_plugins
+
+#endif  // DWB_PLUGINS__ADAPTIVE_XY_THETA_ITERATOR_HPP_
@@ -62,11 +62,19 @@ public:
   void startNewIteration(const nav_2d_msgs::msg::Twist2D & current_velocity) override;
   bool hasMoreTwists() override;
   nav_2d_msgs::msg::Twist2D nextTwist() override;
+  void reportScores(
+    const std::vector<nav_2d_msgs::msg::Twist2D> & twists,
+    const std::vector<double> & scores) override;
 
   dwb_msgs::msg::Trajectory2D generateTrajectory(
     const geometry_msgs::msg::Pose2D & start_pose,
     const nav_2d_msgs::msg::Twist2D & start_vel,
     const nav_2d_msgs::msg::Twist2D & cmd_vel) override;
+  void generateTrajectoryInto(
+    const geometry_msgs::msg::Pose2D & start_pose,
+    const nav_2d_msgs::msg::Twist2D & start_vel,
+    const nav_2d_msgs::msg::Twist2D & cmd_vel,
+    dwb_msgs::msg::Trajectory2D & traj) override;
 
   /**
    * @brief Limits the maximum linear speed of the robot.
@@ -112,20 +120,34 @@ protected:
     const geometry_msgs::msg::Pose2D start_pose, const nav_2d_msgs::msg::Twist2D & vel,
     const double dt);
 
+  /**
+   * @brief Predict the pose of the robot after moving at a constant velocity, along the arc
+   * it follows rather than with the linear steps of computeNewPosition()
+   *
+   * @param start_pose Starting pose
+   * @param vel Constant robot velocity
+   * @param t amount of time in seconds
+   * @return New pose after t seconds
+   */
+  geometry_msgs::msg::Pose2D computeArcPosition(
+    const geometry_msgs::msg::Pose2D & start_pose, const nav_2d_msgs::msg::Twist2D & vel,
+    const double t);
 
   /**
    * @brief Compute an array of time deltas between the points in the generated trajectory.
    *
    * @param cmd_vel The desired command velocity
-   * @return vector of the difference between each time step in the generated trajectory
+   * @param steps Output vector of the difference between each time step in the generated
+   * trajectory, resized rather than reallocated when it is reused
    *
-   * If we are discretizing by time, the returned vector will be the same constant time_granularity
+   * If we are discretizing by time, the vector will be the same constant time_granularity
    * for all cmd_vels. Otherwise, you will get times based on the linear/angular granularity.
    *
    * Right now the vector contains a single value repeated many times, but this method could be overridden
    * to allow for dynamic spacing
    */
-  virtual std::vector<double> getTimeSteps(const nav_2d_msgs::msg::Twist2D & cmd_vel);
+  virtual void getTimeSteps(
+    const nav_2d_msgs::msg::Twist2D & cmd_vel, std::vector<double> & steps);
 
   KinematicsHandler::Ptr kinematics_handler_;
   std::shared_ptr<VelocityIterator> velocity_iterator_;
@@ -161,6 +183,15 @@ protected:
    * were not projected out as far as they intended.
    */
   bool include_last_point_;
+
+  /**
+   * @brief Whether the poses of each trajectory once its velocity is constant are computed
+   * along the arc of that velocity, rather than by linear steps
+   */
+  bool closed_form_rollout_;
+
+  /// @brief Time steps of the last trajectory generated, reused by the next
+  std::vector<double> time_steps_;
 };
 
 
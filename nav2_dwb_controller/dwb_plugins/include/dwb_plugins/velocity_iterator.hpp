@@ -37,6 +37,7 @@
 
 #include <memory>
 #include <string>
+#include <vector>
 
 #include "rclcpp/rclcpp.hpp"
 #include "nav_2d_msgs/msg/twist2_d.hpp"
@@ -56,6 +57,13 @@ public:
   virtual void startNewIteration(const nav_2d_msgs::msg::Twist2D & current_velocity, double dt) = 0;
   virtual bool hasMoreTwists() = 0;
   virtual nav_2d_msgs::msg::Twist2D nextTwist() = 0;
+  /**
+   * @brief Get the scores of the twists returned since the last report, see
+   * dwb_core::TrajectoryGenerator::reportScores(), for iterators sampling again around them
+   */
+  virtual void reportScores(
+    const std::vector<nav_2d_msgs::msg::Twist2D> & /*twists*/,
+    const std::vector<double> & /*scores*/) {}
 };
 }  // namespace dwb_plugins
 
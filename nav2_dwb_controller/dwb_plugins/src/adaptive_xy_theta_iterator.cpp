@@ -0,0 +1,204 @@
+// Copyright (c) 2022 Samsung Research America
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "dwb_plugins/adaptive_xy_theta_iterator.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "nav2_util/node_utils.hpp"
+
+namespace dwb_plugins
+{
+
+void AdaptiveXYThetaIterator::initialize(
+  const nav2_util::LifecycleNode::SharedPtr & nh,
+  KinematicsHandler::Ptr kinematics,
+  const std::string & plugin_name)
+{
+  XYThetaIterator::initialize(nh, kinematics, plugin_name);
+
+  nav2_util::declare_parameter_if_not_declared(
+    nh,
+    plugin_name + ".coarse_sampling_factor", rclcpp::ParameterValue(4));
+  nav2_util::declare_parameter_if_not_declared(
+    nh,
+    plugin_name + ".refinement_candidates", rclcpp::ParameterValue(3));
+
+  nh->get_parameter(plugin_name + ".coarse_sampling_factor", coarse_sampling_factor_);
+  nh->get_parameter(plugin_name + ".refinement_candidates", refinement_candidates_);
+  coarse_sampling_factor_ = std::max(coarse_sampling_factor_, 1);
+  refinement_candidates_ = std::max(refinement_candidates_, 1);
+}
+
+AdaptiveXYThetaIterator::Range AdaptiveXYThetaIterator::getRange(
+  double current, double min, double max, double acc_limit, double decel_limit,
+  double acc_time, int num_samples)
+{
+  current = std::min(std::max(current, min), max);
+  Range range;
+  range.max = projectVelocity(current, acc_limit, decel_limit, acc_time, max);
+  range.min = projectVelocity(current, acc_limit, decel_limit, acc_time, min);
+  range.increment = fabs(range.max - range.min) < EPSILON ?
+    0.0 : (range.max - range.min) / (std::max(2, num_samples) - 1);
+  return range;
+}
+
+std::vector<double> AdaptiveXYThetaIterator::getSamples(const Range & range, int scale)
+{
+  // Both ends of the range, and zero within it as OneDVelocityIterator samples it
+  std::vector<double> samples;
+  if (range.increment == 0.0) {
+    samples.push_back(range.min);
+    return samples;
+  }
+  const double step = range.increment * scale;
+  for (double velocity = range.min; velocity < range.max - EPSILON; velocity += step) {
+    samples.push_back(velocity);
+  }
+  samples.push_back(range.max);
+  if (range.min < 0.0 && range.max > 0.0) {
+    samples.push_back(0.0);
+  }
+  return samples;
+}
+
+void AdaptiveXYThetaIterator::startNewIteration(
+  const nav_2d_msgs::msg::Twist2D & current_velocity,
+  double dt)
+{
+  KinematicParameters kinematics = kinematics_handler_->getKinematics();
+  x_range_ = getRange(
+    current_velocity.x, kinematics.getMinX(), kinematics.getMaxX(),
+    kinematics.getAccX(), kinematics.getDecelX(), dt, vx_samples_);
+  y_range_ = getRange(
+    current_velocity.y, kinematics.getMinY(), kinematics.getMaxY(),
+    kinematics.getAccY(), kinematics.getDecelY(), dt, vy_samples_);
+  theta_range_ = getRange(
+    current_velocity.theta, kinematics.getMinTheta(), kinematics.getMaxTheta(),
+    kinematics.getAccTheta(), kinematics.getDecelTheta(), dt, vtheta_samples_);
+
+  twists_.clear();
+  next_twist_ = 0;
+  sampled_.clear();
+  scored_.clear();
+  scale_ = coarse_sampling_factor_;
+
+  // The previous best twist first, which the next one is likely close to
+  if (has_best_) {
+    addTwist(
+      x_range_.clamp(best_.x), y_range_.clamp(best_.y), theta_range_.clamp(best_.theta));
+    has_best_ = false;
+  }
+
+  addGrid(scale_);
+}
+
+bool AdaptiveXYThetaIterator::hasMoreTwists()
+{
+  return next_twist_ < twists_.size();
+}
+
+nav_2d_msgs::msg::Twist2D AdaptiveXYThetaIterator::nextTwist()
+{
+  return twists_[next_twist_++];
+}
+
+void AdaptiveXYThetaIterator::reportScores(
+  const std::vector<nav_2d_msgs::msg::Twist2D> & twists,
+  const std::vector<double> & scores)
+{
+  for (size_t i = 0; i < twists.size() && i < scores.size(); ++i) {
+    if (scores[i] >= 0.0) {
+      scored_.emplace_back(scores[i], twists[i]);
+    }
+  }
+
+  twists_.clear();
+  next_twist_ = 0;
+  if (scored_.empty()) {
+    // The legal twists may lie between the samples of the coarse grid, fall back to the full one
+    if (scale_ > 1) {
+      scale_ = 1;
+      addGrid(scale_);
+    }
+    return;
+  }
+
+  const size_t candidates = std::min(scored_.size(), static_cast<size_t>(refinement_candidates_));
+  std::partial_sort(
+    scored_.begin(), scored_.begin() + candidates, scored_.end(),
+    [](const auto & a, const auto & b) {return a.first < b.first;});
+  best_ = scored_.front().second;
+  has_best_ = true;
+  if (scale_ <= 1) {
+    return;
+  }
+
+  // Refine around the best twists so far at half the spacing of the last round
+  scale_ /= 2;
+  for (size_t i = 0; i < candidates; ++i) {
+    const nav_2d_msgs::msg::Twist2D center = scored_[i].second;
+    for (int dx = -1; dx <= 1; ++dx) {
+      for (int dy = -1; dy <= 1; ++dy) {
+        for (int dtheta = -1; dtheta <= 1; ++dtheta) {
+          addTwist(
+            x_range_.clamp(center.x + dx * scale_ * x_range_.increment),
+            y_range_.clamp(center.y + dy * scale_ * y_range_.increment),
+            theta_range_.clamp(center.theta + dtheta * scale_ * theta_range_.increment));
+        }
+      }
+    }
+  }
+}
+
+void AdaptiveXYThetaIterator::addGrid(int scale)
+{
+  const std::vector<double> xs = getSamples(x_range_, scale);
+  const std::vector<double> ys = getSamples(y_range_, scale);
+  const std::vector<double> thetas = getSamples(theta_range_, scale);
+  for (const double x : xs) {
+    for (const double y : ys) {
+      for (const double theta : thetas) {
+        addTwist(x, y, theta);
+      }
+    }
+  }
+}
+
+void AdaptiveXYThetaIterator::addTwist(double x, double y, double theta)
+{
+  if (!isValidSpeed(x, y, theta)) {
+    return;
+  }
+  for (const nav_2d_msgs::msg::Twist2D & twist : sampled_) {
+    if (fabs(twist.x - x) < EPSILON && fabs(twist.y - y) < EPSILON &&
+      fabs(twist.theta - theta) < EPSILON)
+    {
+      return;
+    }
+  }
+
+  nav_2d_msgs::msg::Twist2D twist;
+  twist.x = x;
+  twist.y = y;
+  twist.theta = theta;
+  sampled_.push_back(twist);
+  twists_.push_back(twist);
+}
+
+}  // namespace dwb_plugins
@@ -37,6 +37,7 @@
 #include <vector>
 #include <algorithm>
 #include <memory>
+#include "dwb_plugins/adaptive_xy_theta_iterator.hpp"
 #include "dwb_plugins/xy_theta_iterator.hpp"
 #include "nav_2d_utils/parameters.hpp"
 #include "pluginlib/class_list_macros.hpp"
@@ -74,6 +75,9 @@ void StandardTrajectoryGenerator::initialize(
   nav2_util::declare_parameter_if_not_declared(
     nh,
     plugin_name + ".include_last_point", rclcpp::ParameterValue(true));
+  nav2_util::declare_parameter_if_not_declared(
+    nh,
+    plugin_name + ".closed_form_rollout", rclcpp::ParameterValue(false));
 
   /*
    * If discretize_by_time, then sim_granularity represents the amount of time that should be between
@@ -89,12 +93,23 @@ void StandardTrajectoryGenerator::initialize(
   nh->get_parameter(plugin_name + ".linear_granularity", linear_granularity_);
   nh->get_parameter(plugin_name + ".angular_granularity", angular_granularity_);
   nh->get_parameter(plugin_name + ".include_last_point", include_last_point_);
+  nh->get_parameter(plugin_name + ".closed_form_rollout", closed_form_rollout_);
 }
 
 void StandardTrajectoryGenerator::initializeIterator(
   const nav2_util::LifecycleNode::SharedPtr & nh)
 {
-  velocity_iterator_ = std::make_shared<XYThetaIterator>();
+  nav2_util::declare_parameter_if_not_declared(
+    nh,
+    plugin_name_ + ".adaptive_sampling", rclcpp::ParameterValue(false));
+  bool adaptive_sampling;
+  nh->get_parameter(plugin_name_ + ".adaptive_sampling", adaptive_sampling);
+
+  if (adaptive_sampling) {
+    velocity_iterator_ = std::make_shared<AdaptiveXYThetaIterator>();
+  } else {
+    velocity_iterator_ = std::make_shared<XYThetaIterator>();
+  }
   velocity_iterator_->initialize(nh, kinematics_handler_, plugin_name_);
 }
 
@@ -114,10 +129,16 @@ nav_2d_msgs::msg::Twist2D StandardTrajectoryGenerator::nextTwist()
   return velocity_iterator_->nextTwist();
 }
 
-std::vector<double> StandardTrajectoryGenerator::getTimeSteps(
-  const nav_2d_msgs::msg::Twist2D & cmd_vel)
+void StandardTrajectoryGenerator::reportScores(
+  const std::vector<nav_2d_msgs::msg::Twist2D> & twists,
+  const std::vector<double> & scores)
+{
+  velocity_iterator_->reportScores(twists, scores);
+}
+
+void StandardTrajectoryGenerator::getTimeSteps(
+  const nav_2d_msgs::msg::Twist2D & cmd_vel, std::vector<double> & steps)
 {
-  std::vector<double> steps;
   if (discretize_by_time_) {
     steps.resize(ceil(sim_time_ / time_granularity_));
   } else {  // discretize by distance
@@ -140,7 +161,6 @@ std::vector<double> StandardTrajectoryGenerator::getTimeSteps(
     steps.resize(1);
   }
   std::fill(steps.begin(), steps.end(), sim_time_ / steps.size());
-  return steps;
 }
 
 dwb_msgs::msg::Trajectory2D StandardTrajectoryGenerator::generateTrajectory(
@@ -149,19 +169,46 @@ dwb_msgs::msg::Trajectory2D StandardTrajectoryGenerator::generateTrajectory(
   const nav_2d_msgs::msg::Twist2D & cmd_vel)
 {
   dwb_msgs::msg::Trajectory2D traj;
+  generateTrajectoryInto(start_pose, start_vel, cmd_vel, traj);
+  return traj;
+}
+
+void StandardTrajectoryGenerator::generateTrajectoryInto(
+  const geometry_msgs::msg::Pose2D & start_pose,
+  const nav_2d_msgs::msg::Twist2D & start_vel,
+  const nav_2d_msgs::msg::Twist2D & cmd_vel,
+  dwb_msgs::msg::Trajectory2D & traj)
+{
+  // Clearing keeps the capacity of the poses and time offsets of the trajectory
   traj.velocity = cmd_vel;
+  traj.poses.clear();
+  traj.time_offsets.clear();
   //  simulate the trajectory
   geometry_msgs::msg::Pose2D pose = start_pose;
   nav_2d_msgs::msg::Twist2D vel = start_vel;
   double running_time = 0.0;
-  std::vector<double> steps = getTimeSteps(cmd_vel);
+  getTimeSteps(cmd_vel, time_steps_);
   traj.poses.push_back(start_pose);
-  for (double dt : steps) {
+
+  // Once the velocity reaches the command it stays constant, and the robot follows an arc
+  bool constant_vel = false;
+  geometry_msgs::msg::Pose2D arc_start;
+  double arc_time = 0.0;
+  for (double dt : time_steps_) {
     //  calculate velocities
     vel = computeNewVelocity(cmd_vel, vel, dt);
 
     //  update the position of the robot using the velocities passed in
-    pose = computeNewPosition(pose, vel, dt);
+    if (closed_form_rollout_ && !constant_vel && vel == cmd_vel) {
+      constant_vel = true;
+      arc_start = pose;
+    }
+    if (constant_vel) {
+      arc_time += dt;
+      pose = computeArcPosition(arc_start, vel, arc_time);
+    } else {
+      pose = computeNewPosition(pose, vel, dt);
+    }
 
     traj.poses.push_back(pose);
     traj.time_offsets.push_back(rclcpp::Duration::from_seconds(running_time));
@@ -172,8 +219,6 @@ dwb_msgs::msg::Trajectory2D StandardTrajectoryGenerator::generateTrajectory(
     traj.poses.push_back(pose);
     traj.time_offsets.push_back(rclcpp::Duration::from_seconds(running_time));
   }
-
-  return traj;
 }
 
 /**
@@ -211,6 +256,32 @@ geometry_msgs::msg::Pose2D StandardTrajectoryGenerator::computeNewPosition(
   return new_pose;
 }
 
+geometry_msgs::msg::Pose2D StandardTrajectoryGenerator::computeArcPosition(
+  const geometry_msgs::msg::Pose2D & start_pose,
+  const nav_2d_msgs::msg::Twist2D & vel, const double t)
+{
+  // Displacement in the frame of the start pose, integrating the velocity as it rotates
+  const double dtheta = vel.theta * t;
+  double forward, left;
+  if (fabs(dtheta) < 1e-9) {
+    forward = vel.x * t;
+    left = vel.y * t;
+  } else {
+    const double sin_term = sin(dtheta) / vel.theta;
+    const double cos_term = (1.0 - cos(dtheta)) / vel.theta;
+    forward = vel.x * sin_term - vel.y * cos_term;
+    left = vel.x * cos_term + vel.y * sin_term;
+  }
+
+  geometry_msgs::msg::Pose2D new_pose;
+  const double cos_th = cos(start_pose.theta);
+  const double sin_th = sin(start_pose.theta);
+  new_pose.x = start_pose.x + forward * cos_th - left * sin_th;
+  new_pose.y = start_pose.y + forward * sin_th + left * cos_th;
+  new_pose.theta = start_pose.theta + dtheta;
+  return new_pose;
+}
+
 }  // namespace dwb_plugins
 
 PLUGINLIB_EXPORT_CLASS(
@@ -325,6 +325,113 @@ void matchTwist(
   EXPECT_DOUBLE_EQ(a.theta, theta);
 }
 
+// Convex score of a twist, lowest at a twist off the grid of the velocity iterator
+double adaptiveScore(const nav_2d_msgs::msg::Twist2D & twist)
+{
+  return hypot(twist.x - 0.31, (twist.y - 0.03) * 3.0) + fabs(twist.theta - 0.42) / 2.0;
+}
+
+// Score of the twists legal only in a rotational velocity band between the coarse samples
+double narrowBandScore(const nav_2d_msgs::msg::Twist2D & twist)
+{
+  return fabs(twist.theta - 0.4) < 0.05 ? adaptiveScore(twist) : -1.0;
+}
+
+// Score the twists of an iteration round by round, and return the best legal one
+nav_2d_msgs::msg::Twist2D scoreAdaptively(
+  StandardTrajectoryGenerator & gen, unsigned int & num_twists,
+  nav_2d_msgs::msg::Twist2D & first,
+  double (* score)(const nav_2d_msgs::msg::Twist2D &) = adaptiveScore)
+{
+  nav_2d_msgs::msg::Twist2D best;
+  double best_score = -1.0;
+  num_twists = 0;
+  gen.startNewIteration(zero);
+  while (gen.hasMoreTwists()) {
+    std::vector<nav_2d_msgs::msg::Twist2D> twists;
+    std::vector<double> scores;
+    while (gen.hasMoreTwists()) {
+      twists.push_back(gen.nextTwist());
+      scores.push_back(score(twists.back()));
+      if (scores.back() >= 0.0 && (best_score < 0.0 || scores.back() < best_score)) {
+        best_score = scores.back();
+        best = twists.back();
+      }
+    }
+    if (num_twists == 0) {
+      first = twists.front();
+    }
+    num_twists += twists.size();
+    gen.reportScores(twists, scores);
+  }
+  return best;
+}
+
+TEST(VelocityIterator, adaptive_sampling)
+{
+  auto nh = makeTestNode("adaptive", {rclcpp::Parameter("dwb.adaptive_sampling", true)});
+  StandardTrajectoryGenerator gen;
+  gen.initialize(nh, "dwb");
+
+  // The coarse round covers the same limits as the full grid
+  std::vector<nav_2d_msgs::msg::Twist2D> coarse = gen.getTwists(zero);
+  EXPECT_LT(coarse.size(), 1926u / 10);
+  checkLimits(coarse, 0.0, 0.55, -0.1, 0.1, -1.0, 1.0, 0.55, 0.1, 0.4);
+
+  auto full_nh = makeTestNode("adaptive_full");
+  StandardTrajectoryGenerator full_gen;
+  full_gen.initialize(full_nh, "dwb");
+  nav_2d_msgs::msg::Twist2D full_best;
+  double full_best_score = -1.0;
+  for (const nav_2d_msgs::msg::Twist2D & twist : full_gen.getTwists(zero)) {
+    if (full_best_score < 0.0 || adaptiveScore(twist) < full_best_score) {
+      full_best_score = adaptiveScore(twist);
+      full_best = twist;
+    }
+  }
+
+  // Refining around the best twists finds the best one of the full grid from far fewer
+  unsigned int num_twists;
+  nav_2d_msgs::msg::Twist2D first;
+  nav_2d_msgs::msg::Twist2D best = scoreAdaptively(gen, num_twists, first);
+  EXPECT_LT(num_twists, 1926u / 4);
+  matchTwist(best, full_best);
+
+  // And the next iteration starts from it
+  nav_2d_msgs::msg::Twist2D next_best = scoreAdaptively(gen, num_twists, first);
+  matchTwist(first, best);
+  matchTwist(next_best, full_best);
+}
+
+TEST(VelocityIterator, adaptive_sampling_narrow_band)
+{
+  auto nh = makeTestNode("adaptive_narrow", {rclcpp::Parameter("dwb.adaptive_sampling", true)});
+  StandardTrajectoryGenerator gen;
+  gen.initialize(nh, "dwb");
+  const size_t num_coarse = gen.getTwists(zero).size();
+
+  auto full_nh = makeTestNode("adaptive_narrow_full");
+  StandardTrajectoryGenerator full_gen;
+  full_gen.initialize(full_nh, "dwb");
+  nav_2d_msgs::msg::Twist2D full_best;
+  double full_best_score = -1.0;
+  for (const nav_2d_msgs::msg::Twist2D & twist : full_gen.getTwists(zero)) {
+    const double score = narrowBandScore(twist);
+    if (score >= 0.0 && (full_best_score < 0.0 || score < full_best_score)) {
+      full_best_score = score;
+      full_best = twist;
+    }
+  }
+  ASSERT_GE(full_best_score, 0.0);
+
+  // No twist of the coarse grid is legal, so the full grid is sampled next
+  unsigned int num_twists;
+  nav_2d_msgs::msg::Twist2D first;
+  nav_2d_msgs::msg::Twist2D best = scoreAdaptively(gen, num_twists, first, narrowBandScore);
+  EXPECT_GT(num_twists, num_coarse);
+  matchTwist(best, full_best);
+}
+
 const double DEFAULT_SIM_TIME = 1.7;
 
 TEST(TrajectoryGenerator, basic)
@@ -398,6 +505,39 @@ TEST(TrajectoryGenerator, holonomic)
   matchPose(res.poses[n - 1], cmd.x * DEFAULT_SIM_TIME, cmd.y * DEFAULT_SIM_TIME, 0);
 }
 
+TEST(TrajectoryGenerator, closed_form_rollout)
+{
+  auto nh = makeTestNode(
+    "closed_form_rollout", {
+    rclcpp::Parameter("dwb.linear_granularity", 0.5),
+    rclcpp::Parameter("dwb.angular_granularity", 0.025),
+    rclcpp::Parameter("dwb.closed_form_rollout", true)});
+  StandardTrajectoryGenerator gen;
+  gen.initialize(nh, "dwb");
+  nav_2d_msgs::msg::Twist2D cmd;
+  cmd.x = 0.3;
+  cmd.theta = 0.5;
+  dwb_msgs::msg::Trajectory2D res;
+  gen.generateTrajectoryInto(origin, cmd, cmd, res);
+  matchTwist(res.velocity, cmd);
+  EXPECT_NEAR(durationToSec(res.time_offsets.back()), DEFAULT_SIM_TIME, 1.0E-5);
+  ASSERT_GT(res.poses.size(), 2u);
+
+  // Every pose lies on the circle of radius x / theta the robot drives along
+  for (const auto & pose : res.poses) {
+    EXPECT_NEAR(hypot(pose.x, pose.y - 0.6), 0.6, 1.0E-9);
+  }
+  EXPECT_NEAR(res.poses.back().x, 0.6 * sin(0.5 * DEFAULT_SIM_TIME), 1.0E-9);
+  EXPECT_NEAR(res.poses.back().y, 0.6 * (1.0 - cos(0.5 * DEFAULT_SIM_TIME)), 1.0E-9);
+  EXPECT_NEAR(res.poses.back().theta, 0.5 * DEFAULT_SIM_TIME, 1.0E-9);
+
+  // Generating into the same trajectory again overwrites its poses
+  size_t n = res.poses.size();
+  gen.generateTrajectoryInto(origin, cmd, cmd, res);
+  EXPECT_EQ(res.poses.size(), n);
+  EXPECT_EQ(res.time_offsets.size(), n - 1);
+}
+
 TEST(TrajectoryGenerator, twisty)
 {
   auto nh = makeTestNode(
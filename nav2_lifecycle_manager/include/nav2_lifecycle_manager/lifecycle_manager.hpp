@@ -17,6 +17,7 @@
 
 #include <map>
 #include <memory>
+#include <mutex>
 #include <string>
 #include <thread>
 #include <unordered_map>
@@ -24,8 +25,10 @@
 
 #include "nav2_util/lifecycle_service_client.hpp"
 #include "nav2_util/node_thread.hpp"
+#include "nav2_util/shared_heartbeat.hpp"
 #include "rclcpp/rclcpp.hpp"
 #include "std_srvs/srv/empty.hpp"
+#include "nav2_msgs/msg/instrumentation_statistics.hpp"
 #include "nav2_msgs/srv/manage_lifecycle_nodes.hpp"
 #include "std_srvs/srv/trigger.hpp"
 #include "bondcpp/bond.hpp"
@@ -138,6 +141,12 @@ protected:
    */
   bool createBondConnection(const std::string & node_name);
 
+  /**
+   * @brief Request the shared heartbeat of a node before activating it, if enabled, which
+   * the node uses instead of a bond if it is on the same host
+   */
+  void requestSharedHeartbeat(const std::string & node_name);
+
   // Support function for killing bond connections
   /**
    * @brief Support function for killing bond connections
@@ -163,6 +172,30 @@ protected:
    */
   bool changeStateForAllNodes(std::uint8_t transition);
 
+  /**
+   * @brief Transition the nodes concurrently, each node when the nodes it depends on
+   * did for configure and activate, and when the nodes depending on it did otherwise
+   */
+  bool changeStateForAllNodesInParallel(std::uint8_t transition);
+
+  /**
+   * @brief Get the node dependencies from the parameters
+   * @return False if they are invalid, parallel transitions being disabled then
+   */
+  bool getNodeDependencies();
+
+  /**
+   * @brief Subscribe to the instrumentation of the nodes and report their memory
+   * periodically, if enabled
+   */
+  void createMemoryReport();
+
+  /**
+   * @brief Log the memory accounted by each node, its largest accounts and the resident
+   * memory of its process, warning when the accounted total is over the budget
+   */
+  void reportMemory();
+
   // Convenience function to highlight the output on the console
   /**
    * @brief Helper function to highlight the output on the console
@@ -176,6 +209,11 @@ protected:
 
   // A map of all nodes to check bond connection
   std::map<std::string, std::shared_ptr<bond::Bond>> bond_map_;
+  // A map of the nodes on this host beating into shared heartbeats instead of bonds
+  std::map<std::string, std::unique_ptr<nav2_util::SharedHeartbeat>> heartbeat_map_;
+  bool shared_heartbeats_{false};
+  // Guards the bond and heartbeat maps while transitioning in parallel
+  std::mutex bond_mutex_;
 
   // A map of all nodes to be controlled
   std::map<std::string, std::shared_ptr<nav2_util::LifecycleServiceClient>> node_map_;
@@ -191,6 +229,21 @@ protected:
   // Whether to automatically start up the system
   bool autostart_;
 
+  // Whether to transition the independent nodes concurrently
+  bool parallel_transitions_;
+
+  // The nodes each node depends on, to bring up before it and down after it
+  std::map<std::string, std::vector<std::string>> node_dependencies_;
+
+  // Latest instrumentation of each node, with the memory it reports
+  std::map<std::string, nav2_msgs::msg::InstrumentationStatistics::ConstSharedPtr>
+  instrumentation_map_;
+  std::vector<rclcpp::Subscription<nav2_msgs::msg::InstrumentationStatistics>::SharedPtr>
+  instrumentation_subs_;
+  rclcpp::TimerBase::SharedPtr memory_report_timer_;
+  // Accounted memory of all the nodes above which it is warned about, in bytes, 0 if none
+  uint64_t memory_budget_{0};
+
   bool system_active_{false};
 };
 
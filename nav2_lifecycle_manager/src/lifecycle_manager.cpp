@@ -14,9 +14,15 @@
 
 #include "nav2_lifecycle_manager/lifecycle_manager.hpp"
 
+#include <algorithm>
 #include <chrono>
+#include <future>
+#include <iomanip>
 #include <memory>
+#include <set>
+#include <sstream>
 #include <string>
+#include <utility>
 #include <vector>
 
 #include "rclcpp/rclcpp.hpp"
@@ -41,9 +47,20 @@ LifecycleManager::LifecycleManager(const rclcpp::NodeOptions & options)
   declare_parameter("node_names", rclcpp::PARAMETER_STRING_ARRAY);
   declare_parameter("autostart", rclcpp::ParameterValue(false));
   declare_parameter("bond_timeout", 4.0);
+  declare_parameter("shared_heartbeats", rclcpp::ParameterValue(false));
+  declare_parameter("parallel_transitions", rclcpp::ParameterValue(false));
+  declare_parameter("memory_report_period", 0.0);
+  declare_parameter("memory_budget", 0.0);
 
   node_names_ = get_parameter("node_names").as_string_array();
   get_parameter("autostart", autostart_);
+  get_parameter("shared_heartbeats", shared_heartbeats_);
+  get_parameter("parallel_transitions", parallel_transitions_);
+  if (parallel_transitions_ && !getNodeDependencies()) {
+    RCLCPP_ERROR(
+      get_logger(), "Invalid node dependencies, transitioning the nodes sequentially instead.");
+    parallel_transitions_ = false;
+  }
   double bond_timeout_s;
   get_parameter("bond_timeout", bond_timeout_s);
   bond_timeout_ = std::chrono::duration_cast<std::chrono::milliseconds>(
@@ -91,6 +108,8 @@ LifecycleManager::LifecycleManager(const rclcpp::NodeOptions & options)
           callback_group_);
       }
     });
+  createMemoryReport();
+
   auto executor = std::make_shared<rclcpp::executors::SingleThreadedExecutor>();
   executor->add_callback_group(callback_group_, get_node_base_interface());
   service_thread_ = std::make_unique<nav2_util::NodeThread>(executor);
@@ -136,6 +155,117 @@ LifecycleManager::isActiveCallback(
   response->success = system_active_;
 }
 
+bool
+LifecycleManager::getNodeDependencies()
+{
+  // The nodes a node depends on are in node_dependencies.<node name>, nodes without it
+  // depending on none
+  for (auto & node_name : node_names_) {
+    const std::string param_name = "node_dependencies." + node_name;
+    declare_parameter(param_name, rclcpp::ParameterValue(std::vector<std::string>()));
+    node_dependencies_[node_name] = get_parameter(param_name).as_string_array();
+    for (auto & dependency : node_dependencies_[node_name]) {
+      if (std::find(node_names_.begin(), node_names_.end(), dependency) == node_names_.end()) {
+        RCLCPP_ERROR(
+          get_logger(), "Node %s depends on %s, which is not a managed node.",
+          node_name.c_str(), dependency.c_str());
+        return false;
+      }
+    }
+  }
+
+  // Check the dependencies are acyclic by resolving them in turn
+  std::set<std::string> resolved;
+  bool progress = true;
+  while (progress && resolved.size() < node_names_.size()) {
+    progress = false;
+    for (auto & node_name : node_names_) {
+      const auto & dependencies = node_dependencies_[node_name];
+      if (!resolved.count(node_name) &&
+        std::all_of(
+          dependencies.begin(), dependencies.end(),
+          [&resolved](const std::string & dependency) {return resolved.count(dependency) > 0;}))
+      {
+        resolved.insert(node_name);
+        progress = true;
+      }
+    }
+  }
+  if (resolved.size() < node_names_.size()) {
+    RCLCPP_ERROR(get_logger(), "The node dependencies are cyclic.");
+    return false;
+  }
+  return true;
+}
+
+void
+LifecycleManager::createMemoryReport()
+{
+  double period, budget;
+  get_parameter("memory_report_period", period);
+  get_parameter("memory_budget", budget);
+  if (period <= 0.0) {
+    return;
+  }
+  memory_budget_ = budget > 0.0 ? static_cast<uint64_t>(budget * 1e6) : 0;
+
+  // The subscriptions and the timer share the default callback group, so they don't race
+  for (auto & node_name : node_names_) {
+    instrumentation_subs_.push_back(
+      create_subscription<nav2_msgs::msg::InstrumentationStatistics>(
+        node_name + "/instrumentation", 1,
+        [this, node_name](nav2_msgs::msg::InstrumentationStatistics::ConstSharedPtr msg) {
+          instrumentation_map_[node_name] = msg;
+        }));
+  }
+  memory_report_timer_ = create_wall_timer(
+    std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::duration<double>(period)),
+    std::bind(&LifecycleManager::reportMemory, this));
+}
+
+void
+LifecycleManager::reportMemory()
+{
+  constexpr size_t top_accounts = 3;
+  uint64_t total = 0;
+  for (auto & node_name : node_names_) {
+    auto it = instrumentation_map_.find(node_name);
+    if (it == instrumentation_map_.end()) {
+      continue;
+    }
+
+    std::vector<nav2_msgs::msg::MemoryStatistics> accounts = it->second->memory;
+    uint64_t accounted = 0;
+    for (auto & account : accounts) {
+      accounted += account.bytes;
+    }
+    total += accounted;
+
+    const size_t top = std::min(top_accounts, accounts.size());
+    std::partial_sort(
+      accounts.begin(), accounts.begin() + top, accounts.end(),
+      [](const nav2_msgs::msg::MemoryStatistics & a, const nav2_msgs::msg::MemoryStatistics & b) {
+        return a.bytes > b.bytes;
+      });
+    std::ostringstream largest;
+    largest << std::fixed << std::setprecision(1);
+    for (size_t i = 0; i != top; i++) {
+      largest << (i == 0 ? "" : ", ") << accounts[i].name << " " << accounts[i].bytes / 1e6 <<
+        " MB";
+    }
+    RCLCPP_INFO(
+      get_logger(), "%s: %.1f MB accounted, %.1f MB resident in its process, largest: %s",
+      node_name.c_str(), accounted / 1e6, it->second->resident_bytes / 1e6,
+      top == 0 ? "none" : largest.str().c_str());
+  }
+
+  if (memory_budget_ > 0 && total > memory_budget_) {
+    RCLCPP_WARN(
+      get_logger(), "The managed nodes account for %.1f MB, over the budget of %.1f MB",
+      total / 1e6, memory_budget_ / 1e6);
+  }
+}
+
 void
 LifecycleManager::createLifecycleServiceClients()
 {
@@ -162,53 +292,116 @@ LifecycleManager::createBondConnection(const std::string & node_name)
     std::chrono::duration_cast<std::chrono::nanoseconds>(bond_timeout_).count();
   const double timeout_s = timeout_ns / 1e9;
 
-  if (bond_map_.find(node_name) == bond_map_.end() && bond_timeout_.count() > 0.0) {
-    bond_map_[node_name] =
-      std::make_shared<bond::Bond>("bond", node_name, shared_from_this());
-    bond_map_[node_name]->setHeartbeatTimeout(timeout_s);
-    bond_map_[node_name]->setHeartbeatPeriod(0.10);
-    bond_map_[node_name]->start();
-    if (
-      !bond_map_[node_name]->waitUntilFormed(
-        rclcpp::Duration(rclcpp::Duration::from_nanoseconds(timeout_ns / 2))))
-    {
-      RCLCPP_ERROR(
-        get_logger(),
-        "Server %s was unable to be reached after %0.2fs by bond. "
-        "This server may be misconfigured.",
-        node_name.c_str(), timeout_s);
-      return false;
+  std::shared_ptr<bond::Bond> bond;
+  {
+    std::lock_guard<std::mutex> lock(bond_mutex_);
+    if (bond_map_.find(node_name) != bond_map_.end() || bond_timeout_.count() <= 0.0) {
+      return true;
+    }
+
+    // Nodes accepting the shared heartbeat beat during their activation, the others
+    // being on another host or not supporting it
+    auto heartbeat = heartbeat_map_.find(node_name);
+    if (heartbeat != heartbeat_map_.end()) {
+      if (heartbeat->second->hasBeaten()) {
+        RCLCPP_INFO(
+          get_logger(), "Server %s connected with shared heartbeat.", node_name.c_str());
+        return true;
+      }
+      heartbeat_map_.erase(heartbeat);
     }
-    RCLCPP_INFO(get_logger(), "Server %s connected with bond.", node_name.c_str());
+    bond = std::make_shared<bond::Bond>("bond", node_name, shared_from_this());
+    bond_map_[node_name] = bond;
+  }
+
+  bond->setHeartbeatTimeout(timeout_s);
+  bond->setHeartbeatPeriod(0.10);
+  bond->start();
+  if (
+    !bond->waitUntilFormed(
+      rclcpp::Duration(rclcpp::Duration::from_nanoseconds(timeout_ns / 2))))
+  {
+    RCLCPP_ERROR(
+      get_logger(),
+      "Server %s was unable to be reached after %0.2fs by bond. "
+      "This server may be misconfigured.",
+      node_name.c_str(), timeout_s);
+    return false;
   }
+  RCLCPP_INFO(get_logger(), "Server %s connected with bond.", node_name.c_str());
 
   return true;
 }
 
+void
+LifecycleManager::requestSharedHeartbeat(const std::string & node_name)
+{
+  if (!shared_heartbeats_ || bond_timeout_.count() <= 0) {
+    return;
+  }
+
+  // Node names are relative to the namespace of the manager, as its service clients
+  std::string fully_qualified_name = node_name;
+  if (node_name.empty() || node_name[0] != '/') {
+    const std::string ns = get_namespace();
+    fully_qualified_name = (ns == "/" ? "" : ns) + "/" + node_name;
+  }
+  auto heartbeat = nav2_util::SharedHeartbeat::request(fully_qualified_name);
+  if (!heartbeat) {
+    RCLCPP_WARN(
+      get_logger(), "Unable to request the shared heartbeat of %s, using a bond instead.",
+      node_name.c_str());
+    return;
+  }
+
+  std::lock_guard<std::mutex> lock(bond_mutex_);
+  if (bond_map_.find(node_name) == bond_map_.end()) {
+    heartbeat_map_[node_name] = std::move(heartbeat);
+  }
+}
+
 bool
 LifecycleManager::changeStateForNode(const std::string & node_name, std::uint8_t transition)
 {
-  message(transition_label_map_[transition] + node_name);
+  // Lookups only, as nodes may transition concurrently
+  message(transition_label_map_.at(transition) + node_name);
+  const auto start = std::chrono::steady_clock::now();
 
-  if (!node_map_[node_name]->change_state(transition) ||
-    !(node_map_[node_name]->get_state() == transition_state_map_[transition]))
+  auto & client = node_map_.at(node_name);
+  if (transition == Transition::TRANSITION_ACTIVATE) {
+    requestSharedHeartbeat(node_name);
+  }
+  if (!client->change_state(transition) ||
+    !(client->get_state() == transition_state_map_.at(transition)))
   {
     RCLCPP_ERROR(get_logger(), "Failed to change state for node: %s", node_name.c_str());
     return false;
   }
 
   if (transition == Transition::TRANSITION_ACTIVATE) {
-    return createBondConnection(node_name);
+    if (!createBondConnection(node_name)) {
+      return false;
+    }
   } else if (transition == Transition::TRANSITION_DEACTIVATE) {
+    std::lock_guard<std::mutex> lock(bond_mutex_);
     bond_map_.erase(node_name);
+    heartbeat_map_.erase(node_name);
   }
 
+  const std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+  RCLCPP_INFO(
+    get_logger(), "%s%s took %.3f s", transition_label_map_.at(transition).c_str(),
+    node_name.c_str(), elapsed.count());
   return true;
 }
 
 bool
 LifecycleManager::changeStateForAllNodes(std::uint8_t transition)
 {
+  if (parallel_transitions_) {
+    return changeStateForAllNodesInParallel(transition);
+  }
+
   if (transition == Transition::TRANSITION_CONFIGURE ||
     transition == Transition::TRANSITION_ACTIVATE)
   {
@@ -228,6 +421,70 @@ LifecycleManager::changeStateForAllNodes(std::uint8_t transition)
   return true;
 }
 
+bool
+LifecycleManager::changeStateForAllNodesInParallel(std::uint8_t transition)
+{
+  const auto start = std::chrono::steady_clock::now();
+
+  // Bringing up, nodes wait for the nodes they depend on, and bringing down for the nodes
+  // depending on them
+  const bool bringup = transition == Transition::TRANSITION_CONFIGURE ||
+    transition == Transition::TRANSITION_ACTIVATE;
+  std::map<std::string, std::vector<std::string>> awaited;
+  for (auto & node_name : node_names_) {
+    for (auto & dependency : node_dependencies_[node_name]) {
+      if (bringup) {
+        awaited[node_name].push_back(dependency);
+      } else {
+        awaited[dependency].push_back(node_name);
+      }
+    }
+  }
+
+  std::set<std::string> transitioned;
+  std::map<std::string, std::future<bool>> transitioning;
+  bool success = true;
+  while (true) {
+    // Start the nodes no longer waiting, unless a transition failed
+    for (auto & node_name : node_names_) {
+      const auto & nodes = awaited[node_name];
+      if (success && !transitioned.count(node_name) && !transitioning.count(node_name) &&
+        std::all_of(
+          nodes.begin(), nodes.end(),
+          [&transitioned](const std::string & node) {return transitioned.count(node) > 0;}))
+      {
+        transitioning[node_name] = std::async(
+          std::launch::async, &LifecycleManager::changeStateForNode, this, node_name, transition);
+      }
+    }
+
+    if (transitioning.empty()) {
+      break;
+    }
+
+    // Wait for a transition to finish, letting the others run meanwhile
+    bool finished = false;
+    while (!finished) {
+      for (auto it = transitioning.begin(); it != transitioning.end(); ) {
+        if (it->second.wait_for(10ms) == std::future_status::ready) {
+          success = it->second.get() && success;
+          transitioned.insert(it->first);
+          it = transitioning.erase(it);
+          finished = true;
+        } else {
+          ++it;
+        }
+      }
+    }
+  }
+
+  const std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+  RCLCPP_INFO(
+    get_logger(), "%s%zu nodes in parallel took %.3f s",
+    transition_label_map_.at(transition).c_str(), node_names_.size(), elapsed.count());
+  return success && transitioned.size() == node_names_.size();
+}
+
 void
 LifecycleManager::shutdownAllNodes()
 {
@@ -344,7 +601,7 @@ LifecycleManager::destroyBondTimer()
 void
 LifecycleManager::checkBondConnections()
 {
-  if (!system_active_ || !rclcpp::ok() || bond_map_.empty()) {
+  if (!system_active_ || !rclcpp::ok() || (bond_map_.empty() && heartbeat_map_.empty())) {
     return;
   }
 
@@ -353,7 +610,10 @@ LifecycleManager::checkBondConnections()
       return;
     }
 
-    if (bond_map_[node_name]->isBroken()) {
+    auto heartbeat = heartbeat_map_.find(node_name);
+    const bool broken = heartbeat != heartbeat_map_.end() ?
+      heartbeat->second->isBroken(bond_timeout_) : bond_map_[node_name]->isBroken();
+    if (broken) {
       message(
         std::string(
           "Have not received a heartbeat from " + node_name + "."));
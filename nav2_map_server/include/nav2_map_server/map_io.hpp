@@ -65,9 +65,31 @@ void loadMapFromFile(
   const LoadParameters & load_parameters,
   nav_msgs::msg::OccupancyGrid & map);
 
+/// Image format, and file extension, of binary map files
+/// holding the map metadata and OccupancyGrid data as is
+constexpr char BINARY_MAP_FORMAT[] = "nav2map";
+
+/**
+ * @brief Check if the given file is a binary map file
+ * @param file_name Name of the file
+ * @return true if it starts as a binary map file
+ */
+bool isBinaryMapFile(const std::string & file_name);
+
+/**
+ * @brief Load an OccupancyGrid from a binary map file, mapped in memory
+ * rather than decoded
+ * @param binary_file Name of the binary map file
+ * @param map Output loaded map
+ * @throw std::exception
+ */
+void loadMapFromBinaryFile(
+  const std::string & binary_file,
+  nav_msgs::msg::OccupancyGrid & map);
+
 /**
  * @brief Load the map YAML, image from map file and
- * generate an OccupancyGrid
+ * generate an OccupancyGrid. A binary map file can be given instead of the YAML file.
  * @param yaml_file Name of input YAML file
  * @param map Output loaded map
  * @return status of map loaded
@@ -76,6 +98,34 @@ LOAD_MAP_STATUS loadMapFromYaml(
   const std::string & yaml_file,
   nav_msgs::msg::OccupancyGrid & map);
 
+/* Map region part */
+
+/**
+ * @brief Halve the resolution of an OccupancyGrid map. Each output cell takes the
+ * highest known occupancy of the 2x2 input cells it covers, or unknown if all are unknown.
+ * @param map Input OccupancyGrid map
+ * @param downsampled Output OccupancyGrid map with twice the input resolution
+ */
+void downsampleMap(
+  const nav_msgs::msg::OccupancyGrid & map,
+  nav_msgs::msg::OccupancyGrid & downsampled);
+
+/**
+ * @brief Crop the cells of an OccupancyGrid map covering the given bounds.
+ * Bounds are clipped to the map; the yaw of the map origin is ignored.
+ * @param map Input OccupancyGrid map
+ * @param min_x Minimum x bound in the map frame
+ * @param min_y Minimum y bound in the map frame
+ * @param max_x Maximum x bound in the map frame
+ * @param max_y Maximum y bound in the map frame
+ * @param region Output OccupancyGrid map of the region
+ * @return true or false if the bounds do not overlap the map
+ */
+bool getMapRegion(
+  const nav_msgs::msg::OccupancyGrid & map,
+  double min_x, double min_y, double max_x, double max_y,
+  nav_msgs::msg::OccupancyGrid & region);
+
 
 /* Map output part */
 
@@ -89,7 +139,18 @@ struct SaveParameters
 };
 
 /**
- * @brief Write OccupancyGrid map to file
+ * @brief Write OccupancyGrid map to a binary map file
+ * @param map OccupancyGrid map data
+ * @param binary_file Name of the binary map file
+ * @throw std::exception
+ */
+void saveMapToBinaryFile(
+  const nav_msgs::msg::OccupancyGrid & map,
+  const std::string & binary_file);
+
+/**
+ * @brief Write OccupancyGrid map to file, as an image and its YAML file
+ * or as a binary map file if the image format is BINARY_MAP_FORMAT
  * @param map OccupancyGrid map data
  * @param save_parameters Map saving parameters.
  * @return true or false
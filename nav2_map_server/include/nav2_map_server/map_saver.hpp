@@ -16,8 +16,11 @@
 #ifndef NAV2_MAP_SERVER__MAP_SAVER_HPP_
 #define NAV2_MAP_SERVER__MAP_SAVER_HPP_
 
-#include <string>
+#include <future>
+#include <list>
 #include <memory>
+#include <mutex>
+#include <string>
 
 #include "rclcpp/rclcpp.hpp"
 #include "nav2_util/lifecycle_node.hpp"
@@ -89,15 +92,19 @@ protected:
   nav2_util::CallbackReturn on_shutdown(const rclcpp_lifecycle::State & state) override;
 
   /**
-   * @brief Map saving service callback
+   * @brief Map saving service callback. The map is saved asynchronously
+   * and the response is sent once saving completes.
    * @param request_header Service request header
    * @param request Service request
-   * @param response Service response
    */
   void saveMapCallback(
     const std::shared_ptr<rmw_request_id_t> request_header,
-    const std::shared_ptr<nav2_msgs::srv::SaveMap::Request> request,
-    std::shared_ptr<nav2_msgs::srv::SaveMap::Response> response);
+    const std::shared_ptr<nav2_msgs::srv::SaveMap::Request> request);
+
+  /**
+   * @brief Wait for the map saves in progress to complete
+   */
+  void waitForPendingSaves();
 
   // The timeout for saving the map in service
   std::shared_ptr<rclcpp::Duration> save_map_timeout_;
@@ -111,6 +118,9 @@ protected:
   const std::string save_map_service_name_{"save_map"};
   // A service to save the map to a file at run time (SaveMap)
   rclcpp::Service<nav2_msgs::srv::SaveMap>::SharedPtr save_map_service_;
+  // Map saves in progress, each responding to its service request on completion
+  std::list<std::future<void>> pending_saves_;
+  std::mutex pending_saves_mutex_;
 };
 
 }  // namespace nav2_map_server
@@ -18,12 +18,17 @@
 #include <string>
 #include <memory>
 #include <functional>
+#include <future>
+#include <vector>
 
 #include "rclcpp/rclcpp.hpp"
 #include "nav2_util/lifecycle_node.hpp"
 #include "nav_msgs/msg/occupancy_grid.hpp"
+#include "map_msgs/msg/occupancy_grid_update.hpp"
 #include "nav_msgs/srv/get_map.hpp"
 #include "nav2_msgs/srv/load_map.hpp"
+#include "nav2_msgs/srv/get_map_region.hpp"
+#include "nav2_msgs/srv/update_map.hpp"
 
 namespace nav2_map_server
 {
@@ -96,6 +101,11 @@ protected:
    */
   void updateMsgHeader();
 
+  /**
+   * @brief Rebuild the reduced resolution levels of msg_ served by the map region service
+   */
+  void updateMapPyramid();
+
   /**
    * @brief Map getting service callback
    * @param request_header Service request header
@@ -118,26 +128,118 @@ protected:
     const std::shared_ptr<nav2_msgs::srv::LoadMap::Request> request,
     std::shared_ptr<nav2_msgs::srv::LoadMap::Response> response);
 
+  /**
+   * @brief Map prefetching service callback. Starts loading and preprocessing the map in the
+   * background, so that a later load_map request of the same map swaps it in rather than
+   * loading it. The result only tells whether the prefetch started, that of the load is
+   * returned by the load_map request.
+   * @param request_header Service request header
+   * @param request Service request
+   * @param response Service response
+   */
+  void prefetchMapCallback(
+    const std::shared_ptr<rmw_request_id_t> request_header,
+    const std::shared_ptr<nav2_msgs::srv::LoadMap::Request> request,
+    std::shared_ptr<nav2_msgs::srv::LoadMap::Response> response);
+
+  /**
+   * @brief Swap the prefetched map in msg_, waiting for it if still loading
+   * @param response Output response with the prefetched OccupancyGrid map
+   * @return true or false
+   */
+  bool swapInPrefetchedMap(std::shared_ptr<nav2_msgs::srv::LoadMap::Response> response);
+
+  /**
+   * @brief Map region getting service callback
+   * @param request_header Service request header
+   * @param request Service request
+   * @param response Service response
+   */
+  void getMapRegionCallback(
+    const std::shared_ptr<rmw_request_id_t> request_header,
+    const std::shared_ptr<nav2_msgs::srv::GetMapRegion::Request> request,
+    std::shared_ptr<nav2_msgs::srv::GetMapRegion::Response> response);
+
+  /**
+   * @brief Map editing service callback. Overwrites a patch of the map
+   * and publishes it on the map updates topic.
+   * @param request_header Service request header
+   * @param request Service request
+   * @param response Service response
+   */
+  void updateMapCallback(
+    const std::shared_ptr<rmw_request_id_t> request_header,
+    const std::shared_ptr<nav2_msgs::srv::UpdateMap::Request> request,
+    std::shared_ptr<nav2_msgs::srv::UpdateMap::Response> response);
+
   // The name of the service for getting a map
   const std::string service_name_{"map"};
 
   // The name of the service for loading a map
   const std::string load_map_service_name_{"load_map"};
 
+  // The name of the service for prefetching a map
+  const std::string prefetch_map_service_name_{"prefetch_map"};
+
+  // The name of the service for getting a region of the map
+  const std::string map_region_service_name_{"map_region"};
+
+  // The name of the service for editing the map
+  const std::string update_map_service_name_{"update_map"};
+
   // A service to provide the occupancy grid (GetMap) and the message to return
   rclcpp::Service<nav_msgs::srv::GetMap>::SharedPtr occ_service_;
 
   // A service to load the occupancy grid from file at run time (LoadMap)
   rclcpp::Service<nav2_msgs::srv::LoadMap>::SharedPtr load_map_service_;
 
+  // A service to load the occupancy grid from file in the background (LoadMap)
+  rclcpp::Service<nav2_msgs::srv::LoadMap>::SharedPtr prefetch_map_service_;
+
+  // A service to provide regions of the occupancy grid at several resolutions (GetMapRegion)
+  rclcpp::Service<nav2_msgs::srv::GetMapRegion>::SharedPtr map_region_service_;
+
+  // A service to overwrite patches of the occupancy grid at run time (UpdateMap)
+  rclcpp::Service<nav2_msgs::srv::UpdateMap>::SharedPtr update_map_service_;
+
   // A topic on which the occupancy grid will be published
   rclcpp_lifecycle::LifecyclePublisher<nav_msgs::msg::OccupancyGrid>::SharedPtr occ_pub_;
 
+  // A topic on which the patches of the occupancy grid edits will be published
+  rclcpp_lifecycle::LifecyclePublisher<map_msgs::msg::OccupancyGridUpdate>::SharedPtr
+    occ_update_pub_;
+
+  // A topic on which the prefetched occupancy grids will be published once loaded,
+  // so that consumers may preprocess them ahead of their swap
+  rclcpp_lifecycle::LifecyclePublisher<nav_msgs::msg::OccupancyGrid>::SharedPtr
+    occ_prefetch_pub_;
+
   // The frame ID used in the returned OccupancyGrid message
   std::string frame_id_;
 
   // The message to publish on the occupancy grid topic
   nav_msgs::msg::OccupancyGrid msg_;
+
+  // The number of reduced resolution levels of the map and the levels themselves,
+  // each halving the resolution of the previous one
+  int map_pyramid_levels_;
+  std::vector<nav_msgs::msg::OccupancyGrid> map_pyramid_;
+
+  /**
+   * @struct PrefetchedMap
+   * @brief A map loaded in the background, along with its reduced resolution levels
+   */
+  struct PrefetchedMap
+  {
+    uint8_t result{nav2_msgs::srv::LoadMap::Response::RESULT_UNDEFINED_FAILURE};
+    nav_msgs::msg::OccupancyGrid map;
+    std::vector<nav_msgs::msg::OccupancyGrid> pyramid;
+  };
+
+  // The URL of the map being prefetched and its loading, declared last so that
+  // it is waited for before the publisher it uses is destroyed
+  std::string prefetch_url_;
+  std::future<std::unique_ptr<PrefetchedMap>> prefetch_;
 };
 
 }  // namespace nav2_map_server
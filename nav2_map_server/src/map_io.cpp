@@ -32,10 +32,24 @@
 #include "nav2_map_server/map_io.hpp"
 
 #ifndef _WIN32
+#include <fcntl.h>
 #include <libgen.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
 #endif
+#include <algorithm>
+#include <cctype>
+#include <cerrno>
+#include <cmath>
+#include <cstring>
+#include <functional>
 #include <iostream>
+#include <limits>
+#include <memory>
 #include <string>
+#include <thread>
+#include <utility>
 #include <vector>
 #include <fstream>
 #include <stdexcept>
@@ -169,6 +183,137 @@ LoadParameters loadMapYaml(const std::string & yaml_filename)
   return load_parameters;
 }
 
+/**
+ * @brief Threshold the color of a pixel into an OccupancyGrid cell value
+ * @param load_parameters Map loading parameters
+ * @param pixel Color of the pixel
+ * @param has_alpha Whether the image has an alpha channel
+ * @return OccupancyGrid cell value
+ * @throw std::runtime_error in case of an invalid map mode
+ */
+int8_t pixelToMapCell(
+  const LoadParameters & load_parameters,
+  const Magick::PixelPacket & pixel,
+  bool has_alpha)
+{
+  double sum = static_cast<double>(pixel.red) + pixel.green + pixel.blue;
+  unsigned int channels = 3;
+  if (load_parameters.mode == MapMode::Trinary && has_alpha) {
+    // To preserve existing behavior, average in alpha with color channels in Trinary mode.
+    // CAREFUL. alpha is inverted from what you might expect. High = transparent, low = opaque
+    sum += static_cast<Magick::Quantum>(MaxRGB - pixel.opacity);
+    channels++;
+  }
+  /// on a scale from 0.0 to 1.0 how bright is the pixel?
+  double shade = Magick::ColorGray::scaleQuantumToDouble(sum / channels);
+
+  // If negate is true, we consider blacker pixels free, and whiter
+  // pixels occupied. Otherwise, it's vice versa.
+  /// on a scale from 0.0 to 1.0, how occupied is the map cell (before thresholding)?
+  double occ = (load_parameters.negate ? shade : 1.0 - shade);
+
+  switch (load_parameters.mode) {
+    case MapMode::Trinary:
+      if (load_parameters.occupied_thresh < occ) {
+        return nav2_util::OCC_GRID_OCCUPIED;
+      } else if (occ < load_parameters.free_thresh) {
+        return nav2_util::OCC_GRID_FREE;
+      }
+      return nav2_util::OCC_GRID_UNKNOWN;
+    case MapMode::Scale:
+      if (pixel.opacity != OpaqueOpacity) {
+        return nav2_util::OCC_GRID_UNKNOWN;
+      } else if (load_parameters.occupied_thresh < occ) {
+        return nav2_util::OCC_GRID_OCCUPIED;
+      } else if (occ < load_parameters.free_thresh) {
+        return nav2_util::OCC_GRID_FREE;
+      }
+      return std::rint(
+        (occ - load_parameters.free_thresh) /
+        (load_parameters.occupied_thresh - load_parameters.free_thresh) * 100.0);
+    case MapMode::Raw: {
+        double occ_percent = std::round(shade * 255);
+        if (nav2_util::OCC_GRID_FREE <= occ_percent &&
+          occ_percent <= nav2_util::OCC_GRID_OCCUPIED)
+        {
+          return static_cast<int8_t>(occ_percent);
+        }
+        return nav2_util::OCC_GRID_UNKNOWN;
+      }
+    default:
+      throw std::runtime_error("Invalid map mode");
+  }
+}
+
+/**
+ * @brief Read the gray levels of a binary PGM file with 8-bit samples,
+ * the format maps are saved in, without decoding it through Magick
+ * @param file_name Name of the image file
+ * @param width Width of the image
+ * @param height Height of the image
+ * @param gray Gray levels of the image, row by row from its top
+ * @return true if the file is such a PGM, else the image should be decoded through Magick
+ */
+bool readBinaryPgm(
+  const std::string & file_name,
+  size_t & width, size_t & height,
+  std::vector<uint8_t> & gray)
+{
+  std::ifstream file(file_name, std::ios::binary);
+  char magic[2];
+  if (!file.read(magic, 2) || magic[0] != 'P' || magic[1] != '5') {
+    return false;
+  }
+
+  // Width, height and maximum gray level, separated by whitespaces and comments
+  unsigned int fields[3];
+  for (unsigned int & field : fields) {
+    while (std::isspace(file.peek()) || file.peek() == '#') {
+      if (file.get() == '#') {
+        file.ignore(std::numeric_limits<std::streamsize>::max(), '\n');
+      }
+    }
+    if (!(file >> field)) {
+      return false;
+    }
+  }
+
+  // A single whitespace separates the header from the samples
+  if (fields[0] == 0 || fields[1] == 0 || fields[2] != 255 || !std::isspace(file.get())) {
+    return false;
+  }
+
+  width = fields[0];
+  height = fields[1];
+  gray.resize(width * height);
+  return static_cast<bool>(file.read(reinterpret_cast<char *>(gray.data()), gray.size()));
+}
+
+/**
+ * @brief Process the rows of an image by ranges, on several threads for large images
+ * @param width Width of the image
+ * @param height Height of the image
+ * @param process_rows Function processing the rows from its first argument, up to the second
+ */
+void forEachRowRange(
+  size_t width, size_t height,
+  const std::function<void(size_t, size_t)> & process_rows)
+{
+  // Starting threads is only worth it from about a million pixels per thread
+  size_t threads = std::max(1u, std::thread::hardware_concurrency());
+  threads = std::min({threads, std::max<size_t>(1, width * height / (1 << 20)), height});
+  const size_t rows_per_thread = (height + threads - 1) / threads;
+
+  std::vector<std::thread> workers;
+  for (size_t first = rows_per_thread; first < height; first += rows_per_thread) {
+    workers.emplace_back(process_rows, first, std::min(height, first + rows_per_thread));
+  }
+  process_rows(0, std::min(height, rows_per_thread));
+  for (auto & worker : workers) {
+    worker.join();
+  }
+}
+
 void loadMapFromFile(
   const LoadParameters & load_parameters,
   nav_msgs::msg::OccupancyGrid & map)
@@ -178,11 +323,20 @@ void loadMapFromFile(
 
   std::cout << "[INFO] [map_io]: Loading image_file: " <<
     load_parameters.image_file_name << std::endl;
-  Magick::Image img(load_parameters.image_file_name);
+
+  // Binary 8-bit PGMs are read directly, other images through Magick
+  size_t width, height;
+  std::vector<uint8_t> gray;
+  std::unique_ptr<Magick::Image> img;
+  if (!readBinaryPgm(load_parameters.image_file_name, width, height, gray)) {
+    img = std::make_unique<Magick::Image>(load_parameters.image_file_name);
+    width = img->size().width();
+    height = img->size().height();
+  }
 
   // Copy the image data into the map structure
-  msg.info.width = img.size().width();
-  msg.info.height = img.size().height();
+  msg.info.width = width;
+  msg.info.height = height;
 
   msg.info.resolution = load_parameters.resolution;
   msg.info.origin.position.x = load_parameters.origin[0];
@@ -192,71 +346,45 @@ void loadMapFromFile(
 
   // Allocate space to hold the data
   msg.data.resize(msg.info.width * msg.info.height);
-
-  // Copy pixel data into the map structure
-  for (size_t y = 0; y < msg.info.height; y++) {
-    for (size_t x = 0; x < msg.info.width; x++) {
-      auto pixel = img.pixelColor(x, y);
-
-      std::vector<Magick::Quantum> channels = {pixel.redQuantum(), pixel.greenQuantum(),
-        pixel.blueQuantum()};
-      if (load_parameters.mode == MapMode::Trinary && img.matte()) {
-        // To preserve existing behavior, average in alpha with color channels in Trinary mode.
-        // CAREFUL. alpha is inverted from what you might expect. High = transparent, low = opaque
-        channels.push_back(MaxRGB - pixel.alphaQuantum());
-      }
-      double sum = 0;
-      for (auto c : channels) {
-        sum += c;
-      }
-      /// on a scale from 0.0 to 1.0 how bright is the pixel?
-      double shade = Magick::ColorGray::scaleQuantumToDouble(sum / channels.size());
-
-      // If negate is true, we consider blacker pixels free, and whiter
-      // pixels occupied. Otherwise, it's vice versa.
-      /// on a scale from 0.0 to 1.0, how occupied is the map cell (before thresholding)?
-      double occ = (load_parameters.negate ? shade : 1.0 - shade);
-
-      int8_t map_cell;
-      switch (load_parameters.mode) {
-        case MapMode::Trinary:
-          if (load_parameters.occupied_thresh < occ) {
-            map_cell = nav2_util::OCC_GRID_OCCUPIED;
-          } else if (occ < load_parameters.free_thresh) {
-            map_cell = nav2_util::OCC_GRID_FREE;
-          } else {
-            map_cell = nav2_util::OCC_GRID_UNKNOWN;
-          }
-          break;
-        case MapMode::Scale:
-          if (pixel.alphaQuantum() != OpaqueOpacity) {
-            map_cell = nav2_util::OCC_GRID_UNKNOWN;
-          } else if (load_parameters.occupied_thresh < occ) {
-            map_cell = nav2_util::OCC_GRID_OCCUPIED;
-          } else if (occ < load_parameters.free_thresh) {
-            map_cell = nav2_util::OCC_GRID_FREE;
-          } else {
-            map_cell = std::rint(
-              (occ - load_parameters.free_thresh) /
-              (load_parameters.occupied_thresh - load_parameters.free_thresh) * 100.0);
-          }
-          break;
-        case MapMode::Raw: {
-            double occ_percent = std::round(shade * 255);
-            if (nav2_util::OCC_GRID_FREE <= occ_percent &&
-              occ_percent <= nav2_util::OCC_GRID_OCCUPIED)
-            {
-              map_cell = static_cast<int8_t>(occ_percent);
-            } else {
-              map_cell = nav2_util::OCC_GRID_UNKNOWN;
-            }
-            break;
+  int8_t * data = msg.data.data();
+
+  if (img) {
+    // Threshold the pixels of the image in bulk rather than one Magick call each
+    const bool has_alpha = img->matte();
+    const Magick::PixelPacket * pixels = img->getConstPixels(0, 0, width, height);
+    if (!pixels) {
+      throw std::runtime_error("Failed to access the image pixels");
+    }
+    pixelToMapCell(load_parameters, pixels[0], has_alpha);  // throws on an invalid mode
+    forEachRowRange(
+      width, height, [&](size_t first, size_t last) {
+        for (size_t y = first; y < last; y++) {
+          const Magick::PixelPacket * row = pixels + width * y;
+          int8_t * cells = data + width * (height - y - 1);
+          for (size_t x = 0; x < width; x++) {
+            cells[x] = pixelToMapCell(load_parameters, row[x], has_alpha);
           }
-        default:
-          throw std::runtime_error("Invalid map mode");
-      }
-      msg.data[msg.info.width * (msg.info.height - y - 1) + x] = map_cell;
+        }
+      });
+  } else {
+    // Gray levels are thresholded through a table, as Magick would scale them to quanta
+    int8_t gray_to_cell[256];
+    Magick::PixelPacket pixel;
+    pixel.opacity = OpaqueOpacity;
+    for (unsigned int level = 0; level != 256; level++) {
+      pixel.red = pixel.green = pixel.blue = static_cast<Magick::Quantum>(level * (MaxRGB / 255));
+      gray_to_cell[level] = pixelToMapCell(load_parameters, pixel, false);
     }
+    forEachRowRange(
+      width, height, [&](size_t first, size_t last) {
+        for (size_t y = first; y < last; y++) {
+          const uint8_t * row = gray.data() + width * y;
+          int8_t * cells = data + width * (height - y - 1);
+          for (size_t x = 0; x < width; x++) {
+            cells[x] = gray_to_cell[row[x]];
+          }
+        }
+      });
   }
 
   // Since loadMapFromFile() does not belong to any node, publishing in a system time.
@@ -272,6 +400,132 @@ void loadMapFromFile(
   map = msg;
 }
 
+/**
+ * @brief Header of binary map files, followed by the OccupancyGrid data.
+ * Values are in the byte order of the machine writing the file.
+ */
+struct BinaryMapHeader
+{
+  char magic[8];
+  uint32_t version;
+  uint32_t width;
+  uint32_t height;
+  uint32_t reserved;
+  double resolution;
+  double origin_position[3];
+  double origin_orientation[4];
+};
+static_assert(sizeof(BinaryMapHeader) == 88, "Binary map header must not be padded");
+
+constexpr char BINARY_MAP_MAGIC[8] = {'N', 'A', 'V', '2', 'M', 'A', 'P', '\0'};
+constexpr uint32_t BINARY_MAP_VERSION = 1;
+
+bool isBinaryMapFile(const std::string & file_name)
+{
+  std::ifstream file(file_name, std::ios::binary);
+  char magic[sizeof(BINARY_MAP_MAGIC)];
+  return file.read(magic, sizeof(magic)) &&
+         std::memcmp(magic, BINARY_MAP_MAGIC, sizeof(magic)) == 0;
+}
+
+/**
+ * @brief Fill an OccupancyGrid from the content of a binary map file
+ * @param content Content of the file
+ * @param size Size of the content
+ * @param map Output loaded map
+ * @throw std::runtime_error if the content is not a valid binary map
+ */
+void readBinaryMap(const char * content, size_t size, nav_msgs::msg::OccupancyGrid & map)
+{
+  BinaryMapHeader header;
+  if (size < sizeof(header)) {
+    throw std::runtime_error("Binary map file is too short for its header");
+  }
+  std::memcpy(&header, content, sizeof(header));
+  if (std::memcmp(header.magic, BINARY_MAP_MAGIC, sizeof(header.magic)) != 0) {
+    throw std::runtime_error("Not a binary map file");
+  }
+  if (header.version != BINARY_MAP_VERSION) {
+    throw std::runtime_error(
+            "Unsupported binary map file version " + std::to_string(header.version));
+  }
+  const size_t cells = static_cast<size_t>(header.width) * header.height;
+  if (size != sizeof(header) + cells) {
+    throw std::runtime_error("Binary map file size does not match its map size");
+  }
+
+  map.info.width = header.width;
+  map.info.height = header.height;
+  map.info.resolution = header.resolution;
+  map.info.origin.position.x = header.origin_position[0];
+  map.info.origin.position.y = header.origin_position[1];
+  map.info.origin.position.z = header.origin_position[2];
+  map.info.origin.orientation.x = header.origin_orientation[0];
+  map.info.origin.orientation.y = header.origin_orientation[1];
+  map.info.origin.orientation.z = header.origin_orientation[2];
+  map.info.origin.orientation.w = header.origin_orientation[3];
+  const int8_t * data = reinterpret_cast<const int8_t *>(content + sizeof(header));
+  map.data.assign(data, data + cells);
+}
+
+void loadMapFromBinaryFile(
+  const std::string & binary_file,
+  nav_msgs::msg::OccupancyGrid & map)
+{
+  std::cout << "[INFO] [map_io]: Loading binary map file: " << binary_file << std::endl;
+  nav_msgs::msg::OccupancyGrid msg;
+
+#ifndef _WIN32
+  // The map data is copied once from the mapped file into the message
+  int fd = open(binary_file.c_str(), O_RDONLY);
+  if (fd < 0) {
+    throw std::runtime_error("Failed to open binary map file: " + std::string(strerror(errno)));
+  }
+  struct stat file_stat;
+  if (fstat(fd, &file_stat) != 0 || file_stat.st_size == 0) {
+    close(fd);
+    throw std::runtime_error("Failed to get the size of binary map file");
+  }
+  const size_t size = file_stat.st_size;
+  void * content = mmap(nullptr, size, PROT_READ, MAP_PRIVATE, fd, 0);
+  close(fd);
+  if (content == MAP_FAILED) {
+    throw std::runtime_error("Failed to map binary map file: " + std::string(strerror(errno)));
+  }
+  madvise(content, size, MADV_SEQUENTIAL);
+  try {
+    readBinaryMap(static_cast<const char *>(content), size, msg);
+  } catch (...) {
+    munmap(content, size);
+    throw;
+  }
+  munmap(content, size);
+#else
+  std::ifstream file(binary_file, std::ios::binary | std::ios::ate);
+  if (!file) {
+    throw std::runtime_error("Failed to open binary map file");
+  }
+  std::vector<char> content(static_cast<size_t>(file.tellg()));
+  file.seekg(0);
+  if (!file.read(content.data(), content.size())) {
+    throw std::runtime_error("Failed to read binary map file");
+  }
+  readBinaryMap(content.data(), content.size(), msg);
+#endif
+
+  // As for images, publishing in a system time
+  rclcpp::Clock clock(RCL_SYSTEM_TIME);
+  msg.info.map_load_time = clock.now();
+  msg.header.frame_id = "map";
+  msg.header.stamp = clock.now();
+
+  std::cout <<
+    "[DEBUG] [map_io]: Read map " << binary_file << ": " << msg.info.width <<
+    " X " << msg.info.height << " map @ " << msg.info.resolution << " m/cell" << std::endl;
+
+  map = std::move(msg);
+}
+
 LOAD_MAP_STATUS loadMapFromYaml(
   const std::string & yaml_file,
   nav_msgs::msg::OccupancyGrid & map)
@@ -280,6 +534,17 @@ LOAD_MAP_STATUS loadMapFromYaml(
     std::cerr << "[ERROR] [map_io]: YAML file name is empty, can't load!" << std::endl;
     return MAP_DOES_NOT_EXIST;
   }
+  if (isBinaryMapFile(yaml_file)) {
+    try {
+      loadMapFromBinaryFile(yaml_file, map);
+    } catch (std::exception & e) {
+      std::cerr <<
+        "[ERROR] [map_io]: Failed to load binary map file " << yaml_file <<
+        " for reason: " << e.what() << std::endl;
+      return INVALID_MAP_DATA;
+    }
+    return LOAD_MAP_SUCCESS;
+  }
   std::cout << "[INFO] [map_io]: Loading yaml file: " << yaml_file << std::endl;
   LoadParameters load_parameters;
   try {
@@ -308,6 +573,87 @@ LOAD_MAP_STATUS loadMapFromYaml(
   return LOAD_MAP_SUCCESS;
 }
 
+// === Map region part ===
+
+void downsampleMap(
+  const nav_msgs::msg::OccupancyGrid & map,
+  nav_msgs::msg::OccupancyGrid & downsampled)
+{
+  const size_t width = map.info.width;
+  const size_t height = map.info.height;
+  nav_msgs::msg::OccupancyGrid msg;
+  msg.header = map.header;
+  msg.info = map.info;
+  msg.info.resolution = map.info.resolution * 2.0;
+  msg.info.width = (width + 1) / 2;
+  msg.info.height = (height + 1) / 2;
+  msg.data.resize(msg.info.width * msg.info.height);
+
+  for (size_t y = 0; y < msg.info.height; y++) {
+    const size_t y_end = std::min(2 * y + 2, height);
+    for (size_t x = 0; x < msg.info.width; x++) {
+      const size_t x_end = std::min(2 * x + 2, width);
+      // Occupied cells must not vanish from the coarser levels
+      int8_t value = nav2_util::OCC_GRID_UNKNOWN;
+      for (size_t src_y = 2 * y; src_y < y_end; src_y++) {
+        for (size_t src_x = 2 * x; src_x < x_end; src_x++) {
+          value = std::max(value, map.data[src_y * width + src_x]);
+        }
+      }
+      msg.data[y * msg.info.width + x] = value;
+    }
+  }
+
+  downsampled = std::move(msg);
+}
+
+bool getMapRegion(
+  const nav_msgs::msg::OccupancyGrid & map,
+  double min_x, double min_y, double max_x, double max_y,
+  nav_msgs::msg::OccupancyGrid & region)
+{
+  const double resolution = map.info.resolution;
+  const int width = static_cast<int>(map.info.width);
+  const int height = static_cast<int>(map.info.height);
+  if (resolution <= 0.0 || min_x > max_x || min_y > max_y) {
+    return false;
+  }
+
+  auto toCell = [resolution](double coord, double origin) {
+      return std::floor((coord - origin) / resolution);
+    };
+  const double cell_min_x = toCell(min_x, map.info.origin.position.x);
+  const double cell_min_y = toCell(min_y, map.info.origin.position.y);
+  const double cell_max_x = toCell(max_x, map.info.origin.position.x);
+  const double cell_max_y = toCell(max_y, map.info.origin.position.y);
+  if (cell_max_x < 0.0 || cell_max_y < 0.0 || cell_min_x >= width || cell_min_y >= height) {
+    return false;
+  }
+
+  const int x0 = static_cast<int>(std::max(cell_min_x, 0.0));
+  const int y0 = static_cast<int>(std::max(cell_min_y, 0.0));
+  const int x1 = static_cast<int>(std::min(cell_max_x, width - 1.0));
+  const int y1 = static_cast<int>(std::min(cell_max_y, height - 1.0));
+
+  nav_msgs::msg::OccupancyGrid msg;
+  msg.header = map.header;
+  msg.info = map.info;
+  msg.info.width = x1 - x0 + 1;
+  msg.info.height = y1 - y0 + 1;
+  msg.info.origin.position.x = map.info.origin.position.x + x0 * resolution;
+  msg.info.origin.position.y = map.info.origin.position.y + y0 * resolution;
+  msg.data.resize(msg.info.width * msg.info.height);
+  for (int y = y0; y <= y1; y++) {
+    const auto row = map.data.begin() + static_cast<size_t>(y) * width;
+    std::copy(
+      row + x0, row + x1 + 1,
+      msg.data.begin() + static_cast<size_t>(y - y0) * msg.info.width);
+  }
+
+  region = std::move(msg);
+  return true;
+}
+
 // === Map output part ===
 
 /**
@@ -368,6 +714,11 @@ void checkSaveParameters(SaveParameters & save_parameters)
     save_parameters.image_format.begin(),
     [](unsigned char c) {return std::tolower(c);});
 
+  // Binary maps hold the map data as is, whatever the image mode
+  if (save_parameters.image_format == BINARY_MAP_FORMAT) {
+    return;
+  }
+
   const std::vector<std::string> BLESSED_FORMATS{"bmp", "pgm", "png"};
   if (
     std::find(BLESSED_FORMATS.begin(), BLESSED_FORMATS.end(), save_parameters.image_format) ==
@@ -417,6 +768,86 @@ void checkSaveParameters(SaveParameters & save_parameters)
   }
 }
 
+/**
+ * @brief Get the image pixel an OccupancyGrid cell is saved as
+ * @param save_parameters Map saving parameters
+ * @param map_cell Value of the OccupancyGrid cell
+ * @return Pixel color of the cell
+ * @throw std::exception in case of invalid map mode
+ */
+Magick::Color mapCellToPixel(const SaveParameters & save_parameters, int8_t map_cell)
+{
+  int free_thresh_int = std::rint(save_parameters.free_thresh * 100.0);
+  int occupied_thresh_int = std::rint(save_parameters.occupied_thresh * 100.0);
+
+  Magick::Color pixel;
+
+  switch (save_parameters.mode) {
+    case MapMode::Trinary:
+      if (map_cell < 0 || 100 < map_cell) {
+        pixel = Magick::ColorGray(205 / 255.0);
+      } else if (map_cell <= free_thresh_int) {
+        pixel = Magick::ColorGray(254 / 255.0);
+      } else if (occupied_thresh_int <= map_cell) {
+        pixel = Magick::ColorGray(0 / 255.0);
+      } else {
+        pixel = Magick::ColorGray(205 / 255.0);
+      }
+      break;
+    case MapMode::Scale:
+      if (map_cell < 0 || 100 < map_cell) {
+        pixel = Magick::ColorGray{0.5};
+        pixel.alphaQuantum(TransparentOpacity);
+      } else {
+        pixel = Magick::ColorGray{(100.0 - map_cell) / 100.0};
+      }
+      break;
+    case MapMode::Raw:
+      Magick::Quantum q;
+      if (map_cell < 0 || 100 < map_cell) {
+        q = MaxRGB;
+      } else {
+        q = map_cell / 255.0 * MaxRGB;
+      }
+      pixel = Magick::Color(q, q, q);
+      break;
+    default:
+      std::cerr << "[ERROR] [map_io]: Map mode should be Trinary, Scale or Raw" << std::endl;
+      throw std::runtime_error("Invalid map mode");
+  }
+  return pixel;
+}
+
+/**
+ * @brief Write an 8-bit gray map image directly as a binary PGM, row by row
+ * @param map Occupancy grid data
+ * @param cell_grays Gray level of each OccupancyGrid cell value, indexed by its unsigned byte
+ * @param file_name Name of the PGM file
+ * @throw std::exception in case of problem
+ */
+void writeBinaryPgm(
+  const nav_msgs::msg::OccupancyGrid & map,
+  const uint8_t cell_grays[256],
+  const std::string & file_name)
+{
+  const size_t width = map.info.width;
+  const size_t height = map.info.height;
+  std::ofstream file(file_name, std::ios::binary | std::ios::trunc);
+  file << "P5\n" << width << " " << height << "\n255\n";
+
+  std::vector<uint8_t> row(width);
+  for (size_t y = 0; y < height && file; y++) {
+    const int8_t * cells = map.data.data() + width * (height - y - 1);
+    for (size_t x = 0; x < width; x++) {
+      row[x] = cell_grays[static_cast<uint8_t>(cells[x])];
+    }
+    file.write(reinterpret_cast<const char *>(row.data()), width);
+  }
+  if (!file) {
+    throw std::runtime_error("Failed to write image file " + file_name);
+  }
+}
+
 /**
  * @brief Tries to write map data into a file
  * @param map Occupancy grid data
@@ -431,8 +862,28 @@ void tryWriteMapToFile(
     "[INFO] [map_io]: Received a " << map.info.width << " X " << map.info.height << " map @ " <<
     map.info.resolution << " m/pix" << std::endl;
 
+  const size_t width = map.info.width;
+  const size_t height = map.info.height;
+  if (map.data.size() != width * height) {
+    throw std::runtime_error("Map data size does not match its width and height");
+  }
+
+  // Each of the 256 possible cell values is converted to a pixel once
+  Magick::PixelPacket cell_pixels[256];
+  for (unsigned int value = 0; value != 256; ++value) {
+    cell_pixels[value] = mapCellToPixel(save_parameters, static_cast<int8_t>(value));
+  }
+
   std::string mapdatafile = save_parameters.map_file_name + "." + save_parameters.image_format;
-  {
+  if (save_parameters.image_format == "pgm" && save_parameters.mode != MapMode::Scale) {
+    // Gray maps without transparency are streamed to the file without an intermediate image
+    uint8_t cell_grays[256];
+    for (unsigned int value = 0; value != 256; ++value) {
+      cell_grays[value] = std::lround(cell_pixels[value].red * 255.0 / MaxRGB);
+    }
+    std::cout << "[INFO] [map_io]: Writing map occupancy data to " << mapdatafile << std::endl;
+    writeBinaryPgm(map, cell_grays, mapdatafile);
+  } else {
     // should never see this color, so the initialization value is just for debugging
     Magick::Image image({map.info.width, map.info.height}, "red");
 
@@ -446,51 +897,21 @@ void tryWriteMapToFile(
     // Since we only need to support 100 different pixel levels, 8 bits is fine
     image.depth(8);
 
-    int free_thresh_int = std::rint(save_parameters.free_thresh * 100.0);
-    int occupied_thresh_int = std::rint(save_parameters.occupied_thresh * 100.0);
-
-    for (size_t y = 0; y < map.info.height; y++) {
-      for (size_t x = 0; x < map.info.width; x++) {
-        int8_t map_cell = map.data[map.info.width * (map.info.height - y - 1) + x];
-
-        Magick::Color pixel;
-
-        switch (save_parameters.mode) {
-          case MapMode::Trinary:
-            if (map_cell < 0 || 100 < map_cell) {
-              pixel = Magick::ColorGray(205 / 255.0);
-            } else if (map_cell <= free_thresh_int) {
-              pixel = Magick::ColorGray(254 / 255.0);
-            } else if (occupied_thresh_int <= map_cell) {
-              pixel = Magick::ColorGray(0 / 255.0);
-            } else {
-              pixel = Magick::ColorGray(205 / 255.0);
-            }
-            break;
-          case MapMode::Scale:
-            if (map_cell < 0 || 100 < map_cell) {
-              pixel = Magick::ColorGray{0.5};
-              pixel.alphaQuantum(TransparentOpacity);
-            } else {
-              pixel = Magick::ColorGray{(100.0 - map_cell) / 100.0};
-            }
-            break;
-          case MapMode::Raw:
-            Magick::Quantum q;
-            if (map_cell < 0 || 100 < map_cell) {
-              q = MaxRGB;
-            } else {
-              q = map_cell / 255.0 * MaxRGB;
-            }
-            pixel = Magick::Color(q, q, q);
-            break;
-          default:
-            std::cerr << "[ERROR] [map_io]: Map mode should be Trinary, Scale or Raw" << std::endl;
-            throw std::runtime_error("Invalid map mode");
+    // Fill the whole pixel cache at once, rather than setting each pixel through Magick
+    image.modifyImage();
+    Magick::PixelPacket * pixels = image.getPixels(0, 0, width, height);
+    forEachRowRange(
+      width, height,
+      [&](size_t first_row, size_t last_row) {
+        for (size_t y = first_row; y < last_row; y++) {
+          const int8_t * cells = map.data.data() + width * (height - y - 1);
+          Magick::PixelPacket * row = pixels + width * y;
+          for (size_t x = 0; x < width; x++) {
+            row[x] = cell_pixels[static_cast<uint8_t>(cells[x])];
+          }
         }
-        image.pixelColor(x, y, pixel);
-      }
-    }
+      });
+    image.syncPixels();
 
     std::cout << "[INFO] [map_io]: Writing map occupancy data to " << mapdatafile << std::endl;
     image.write(mapdatafile);
@@ -529,6 +950,39 @@ void tryWriteMapToFile(
   std::cout << "[INFO] [map_io]: Map saved" << std::endl;
 }
 
+void saveMapToBinaryFile(
+  const nav_msgs::msg::OccupancyGrid & map,
+  const std::string & binary_file)
+{
+  const size_t cells = static_cast<size_t>(map.info.width) * map.info.height;
+  if (map.data.size() != cells) {
+    throw std::runtime_error("Map data size does not match its width and height");
+  }
+
+  BinaryMapHeader header;
+  std::memcpy(header.magic, BINARY_MAP_MAGIC, sizeof(header.magic));
+  header.version = BINARY_MAP_VERSION;
+  header.width = map.info.width;
+  header.height = map.info.height;
+  header.reserved = 0;
+  header.resolution = map.info.resolution;
+  header.origin_position[0] = map.info.origin.position.x;
+  header.origin_position[1] = map.info.origin.position.y;
+  header.origin_position[2] = map.info.origin.position.z;
+  header.origin_orientation[0] = map.info.origin.orientation.x;
+  header.origin_orientation[1] = map.info.origin.orientation.y;
+  header.origin_orientation[2] = map.info.origin.orientation.z;
+  header.origin_orientation[3] = map.info.origin.orientation.w;
+
+  std::cout << "[INFO] [map_io]: Writing binary map to " << binary_file << std::endl;
+  std::ofstream file(binary_file, std::ios::binary | std::ios::trunc);
+  file.write(reinterpret_cast<const char *>(&header), sizeof(header));
+  file.write(reinterpret_cast<const char *>(map.data.data()), cells);
+  if (!file) {
+    throw std::runtime_error("Failed to write binary map file " + binary_file);
+  }
+}
+
 bool saveMapToFile(
   const nav_msgs::msg::OccupancyGrid & map,
   const SaveParameters & save_parameters)
@@ -540,7 +994,12 @@ bool saveMapToFile(
     // Checking map parameters for consistency
     checkSaveParameters(save_parameters_loc);
 
-    tryWriteMapToFile(map, save_parameters_loc);
+    if (save_parameters_loc.image_format == BINARY_MAP_FORMAT) {
+      saveMapToBinaryFile(
+        map, save_parameters_loc.map_file_name + "." + save_parameters_loc.image_format);
+    } else {
+      tryWriteMapToFile(map, save_parameters_loc);
+    }
   } catch (std::exception & e) {
     std::cout << "[ERROR] [map_io]: Failed to write map for reason: " << e.what() << std::endl;
     return false;
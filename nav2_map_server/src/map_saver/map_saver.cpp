@@ -31,10 +31,12 @@
 
 #include "nav2_map_server/map_saver.hpp"
 
+#include <chrono>
 #include <string>
 #include <memory>
 #include <stdexcept>
 #include <functional>
+#include <future>
 #include <mutex>
 
 using namespace std::placeholders;
@@ -56,6 +58,7 @@ MapSaver::MapSaver(const rclcpp::NodeOptions & options)
 
 MapSaver::~MapSaver()
 {
+  waitForPendingSaves();
 }
 
 nav2_util::CallbackReturn
@@ -69,7 +72,7 @@ MapSaver::on_configure(const rclcpp_lifecycle::State & /*state*/)
   // Create a service that saves the occupancy grid from map topic to a file
   save_map_service_ = create_service<nav2_msgs::srv::SaveMap>(
     service_prefix + save_map_service_name_,
-    std::bind(&MapSaver::saveMapCallback, this, _1, _2, _3));
+    std::bind(&MapSaver::saveMapCallback, this, _1, _2));
 
   return nav2_util::CallbackReturn::SUCCESS;
 }
@@ -102,6 +105,7 @@ MapSaver::on_cleanup(const rclcpp_lifecycle::State & /*state*/)
   RCLCPP_INFO(get_logger(), "Cleaning up");
 
   save_map_service_.reset();
+  waitForPendingSaves();
 
   return nav2_util::CallbackReturn::SUCCESS;
 }
@@ -114,9 +118,8 @@ MapSaver::on_shutdown(const rclcpp_lifecycle::State & /*state*/)
 }
 
 void MapSaver::saveMapCallback(
-  const std::shared_ptr<rmw_request_id_t>/*request_header*/,
-  const std::shared_ptr<nav2_msgs::srv::SaveMap::Request> request,
-  std::shared_ptr<nav2_msgs::srv::SaveMap::Response> response)
+  const std::shared_ptr<rmw_request_id_t> request_header,
+  const std::shared_ptr<nav2_msgs::srv::SaveMap::Request> request)
 {
   // Set input arguments and call saveMapTopicToFile()
   SaveParameters save_parameters;
@@ -133,7 +136,29 @@ void MapSaver::saveMapCallback(
       request->map_mode.c_str());
   }
 
-  response->result = saveMapTopicToFile(request->map_topic, save_parameters);
+  // Save on a separate thread, so that large maps do not block other requests
+  std::lock_guard<std::mutex> lock(pending_saves_mutex_);
+  pending_saves_.remove_if(
+    [](const std::future<void> & save) {
+      return save.wait_for(std::chrono::seconds(0)) == std::future_status::ready;
+    });
+  pending_saves_.push_back(
+    std::async(
+      std::launch::async,
+      [this, service = save_map_service_, request_header, request, save_parameters]() {
+        nav2_msgs::srv::SaveMap::Response response;
+        response.result = saveMapTopicToFile(request->map_topic, save_parameters);
+        service->send_response(*request_header, response);
+      }));
+}
+
+void MapSaver::waitForPendingSaves()
+{
+  std::lock_guard<std::mutex> lock(pending_saves_mutex_);
+  for (auto & save : pending_saves_) {
+    save.wait();
+  }
+  pending_saves_.clear();
 }
 
 bool MapSaver::saveMapTopicToFile(
@@ -46,11 +46,14 @@
 
 #include "nav2_map_server/map_server.hpp"
 
+#include <algorithm>
 #include <string>
 #include <memory>
 #include <fstream>
+#include <future>
 #include <stdexcept>
 #include <utility>
+#include <vector>
 
 #include "yaml-cpp/yaml.h"
 #include "lifecycle_msgs/msg/state.hpp"
@@ -62,6 +65,49 @@ using namespace std::placeholders;
 namespace nav2_map_server
 {
 
+namespace
+{
+
+/**
+ * @brief Convert the status of a map loading to the result code of a LoadMap response
+ * @return True if the map was loaded
+ */
+bool toLoadMapResult(LOAD_MAP_STATUS status, uint8_t & result)
+{
+  switch (status) {
+    case MAP_DOES_NOT_EXIST:
+      result = nav2_msgs::srv::LoadMap::Response::RESULT_MAP_DOES_NOT_EXIST;
+      return false;
+    case INVALID_MAP_METADATA:
+      result = nav2_msgs::srv::LoadMap::Response::RESULT_INVALID_MAP_METADATA;
+      return false;
+    case INVALID_MAP_DATA:
+      result = nav2_msgs::srv::LoadMap::Response::RESULT_INVALID_MAP_DATA;
+      return false;
+    case LOAD_MAP_SUCCESS:
+      result = nav2_msgs::srv::LoadMap::Response::RESULT_SUCCESS;
+      return true;
+  }
+  result = nav2_msgs::srv::LoadMap::Response::RESULT_UNDEFINED_FAILURE;
+  return false;
+}
+
+/**
+ * @brief Build the reduced resolution levels of a map, each halving the resolution of the
+ * previous one
+ */
+void buildMapPyramid(
+  const nav_msgs::msg::OccupancyGrid & map, int levels,
+  std::vector<nav_msgs::msg::OccupancyGrid> & pyramid)
+{
+  pyramid.resize(levels);
+  for (size_t i = 0; i < pyramid.size(); i++) {
+    downsampleMap(i == 0 ? map : pyramid[i - 1], pyramid[i]);
+  }
+}
+
+}  // namespace
+
 MapServer::MapServer(const rclcpp::NodeOptions & options)
 : nav2_util::LifecycleNode("map_server", "", false, options)
 {
@@ -71,10 +117,14 @@ MapServer::MapServer(const rclcpp::NodeOptions & options)
   declare_parameter("yaml_filename", rclcpp::PARAMETER_STRING);
   declare_parameter("topic_name", "map");
   declare_parameter("frame_id", "map");
+  declare_parameter("map_pyramid_levels", 0);
 }
 
 MapServer::~MapServer()
 {
+  if (prefetch_.valid()) {
+    prefetch_.wait();
+  }
 }
 
 nav2_util::CallbackReturn
@@ -87,6 +137,8 @@ MapServer::on_configure(const rclcpp_lifecycle::State & /*state*/)
 
   std::string topic_name = get_parameter("topic_name").as_string();
   frame_id_ = get_parameter("frame_id").as_string();
+  map_pyramid_levels_ =
+    std::max(0, static_cast<int>(get_parameter("map_pyramid_levels").as_int()));
 
   // Shared pointer to LoadMap::Response is also should be initialized
   // in order to avoid null-pointer dereference
@@ -110,11 +162,35 @@ MapServer::on_configure(const rclcpp_lifecycle::State & /*state*/)
     topic_name,
     rclcpp::QoS(rclcpp::KeepLast(1)).transient_local().reliable());
 
+  // Create a publisher of the map edits, as expected by the costmap static layer
+  occ_update_pub_ = create_publisher<map_msgs::msg::OccupancyGridUpdate>(
+    topic_name + "_updates", rclcpp::SystemDefaultsQoS());
+
+  // Create a latched publisher of the prefetched maps
+  occ_prefetch_pub_ = create_publisher<nav_msgs::msg::OccupancyGrid>(
+    topic_name + "_prefetched",
+    rclcpp::QoS(rclcpp::KeepLast(1)).transient_local().reliable());
+
   // Create a service that loads the occupancy grid from a file
   load_map_service_ = create_service<nav2_msgs::srv::LoadMap>(
     service_prefix + std::string(load_map_service_name_),
     std::bind(&MapServer::loadMapCallback, this, _1, _2, _3));
 
+  // Create a service that loads the occupancy grid from a file in the background
+  prefetch_map_service_ = create_service<nav2_msgs::srv::LoadMap>(
+    service_prefix + std::string(prefetch_map_service_name_),
+    std::bind(&MapServer::prefetchMapCallback, this, _1, _2, _3));
+
+  // Create a service that provides regions of the occupancy grid
+  map_region_service_ = create_service<nav2_msgs::srv::GetMapRegion>(
+    service_prefix + std::string(map_region_service_name_),
+    std::bind(&MapServer::getMapRegionCallback, this, _1, _2, _3));
+
+  // Create a service that overwrites patches of the occupancy grid
+  update_map_service_ = create_service<nav2_msgs::srv::UpdateMap>(
+    service_prefix + std::string(update_map_service_name_),
+    std::bind(&MapServer::updateMapCallback, this, _1, _2, _3));
+
   return nav2_util::CallbackReturn::SUCCESS;
 }
 
@@ -125,6 +201,8 @@ MapServer::on_activate(const rclcpp_lifecycle::State & /*state*/)
 
   // Publish the map using the latched topic
   occ_pub_->on_activate();
+  occ_update_pub_->on_activate();
+  occ_prefetch_pub_->on_activate();
   auto occ_grid = std::make_unique<nav_msgs::msg::OccupancyGrid>(msg_);
   occ_pub_->publish(std::move(occ_grid));
 
@@ -140,6 +218,8 @@ MapServer::on_deactivate(const rclcpp_lifecycle::State & /*state*/)
   RCLCPP_INFO(get_logger(), "Deactivating");
 
   occ_pub_->on_deactivate();
+  occ_update_pub_->on_deactivate();
+  occ_prefetch_pub_->on_deactivate();
 
   // destroy bond connection
   destroyBond();
@@ -152,9 +232,22 @@ MapServer::on_cleanup(const rclcpp_lifecycle::State & /*state*/)
 {
   RCLCPP_INFO(get_logger(), "Cleaning up");
 
+  // The prefetched map is dropped once loaded, as it publishes on the prefetch topic
+  if (prefetch_.valid()) {
+    prefetch_.wait();
+    prefetch_ = std::future<std::unique_ptr<PrefetchedMap>>();
+  }
+  prefetch_url_.clear();
+
   occ_pub_.reset();
+  occ_update_pub_.reset();
+  occ_prefetch_pub_.reset();
   occ_service_.reset();
   load_map_service_.reset();
+  prefetch_map_service_.reset();
+  map_region_service_.reset();
+  update_map_service_.reset();
+  map_pyramid_.clear();
 
   return nav2_util::CallbackReturn::SUCCESS;
 }
@@ -195,35 +288,179 @@ void MapServer::loadMapCallback(
     return;
   }
   RCLCPP_INFO(get_logger(), "Handling LoadMap request");
-  // Load from file
-  if (loadMapResponseFromYaml(request->map_url, response)) {
+  // Swap in the map if prefetched, load it from file otherwise
+  bool loaded;
+  if (prefetch_.valid() && prefetch_url_ == request->map_url) {
+    loaded = swapInPrefetchedMap(response);
+  } else {
+    loaded = loadMapResponseFromYaml(request->map_url, response);
+  }
+  if (loaded) {
     auto occ_grid = std::make_unique<nav_msgs::msg::OccupancyGrid>(msg_);
     occ_pub_->publish(std::move(occ_grid));  // publish new map
   }
 }
 
+void MapServer::prefetchMapCallback(
+  const std::shared_ptr<rmw_request_id_t>/*request_header*/,
+  const std::shared_ptr<nav2_msgs::srv::LoadMap::Request> request,
+  std::shared_ptr<nav2_msgs::srv::LoadMap::Response> response)
+{
+  // if not in ACTIVE state, ignore request
+  if (get_current_state().id() != lifecycle_msgs::msg::State::PRIMARY_STATE_ACTIVE) {
+    RCLCPP_WARN(
+      get_logger(),
+      "Received PrefetchMap request but not in ACTIVE state, ignoring!");
+    response->result = nav2_msgs::srv::LoadMap::Response::RESULT_UNDEFINED_FAILURE;
+    return;
+  }
+  RCLCPP_INFO(get_logger(), "Handling PrefetchMap request of %s", request->map_url.c_str());
+
+  response->result = nav2_msgs::srv::LoadMap::Response::RESULT_SUCCESS;
+  if (prefetch_.valid()) {
+    if (prefetch_url_ == request->map_url) {
+      return;
+    }
+    // Replacing a prefetch still loading would block until it is loaded
+    if (prefetch_.wait_for(0s) != std::future_status::ready) {
+      RCLCPP_WARN(
+        get_logger(), "Still prefetching %s, ignoring PrefetchMap request!",
+        prefetch_url_.c_str());
+      response->result = nav2_msgs::srv::LoadMap::Response::RESULT_UNDEFINED_FAILURE;
+      return;
+    }
+  }
+
+  // The frame, pyramid levels and publisher are only changed once the prefetch is waited for
+  prefetch_url_ = request->map_url;
+  prefetch_ = std::async(
+    std::launch::async, [this, yaml_file = request->map_url]() {
+      auto prefetched = std::make_unique<PrefetchedMap>();
+      if (toLoadMapResult(loadMapFromYaml(yaml_file, prefetched->map), prefetched->result)) {
+        prefetched->map.header.frame_id = frame_id_;
+        prefetched->map.header.stamp = now();
+        buildMapPyramid(prefetched->map, map_pyramid_levels_, prefetched->pyramid);
+        occ_prefetch_pub_->publish(
+          std::make_unique<nav_msgs::msg::OccupancyGrid>(prefetched->map));
+        RCLCPP_INFO(get_logger(), "Prefetched map %s", yaml_file.c_str());
+      } else {
+        RCLCPP_WARN(get_logger(), "Failed to prefetch map %s", yaml_file.c_str());
+      }
+      return prefetched;
+    });
+}
+
+bool MapServer::swapInPrefetchedMap(
+  std::shared_ptr<nav2_msgs::srv::LoadMap::Response> response)
+{
+  std::unique_ptr<PrefetchedMap> prefetched = prefetch_.get();
+  prefetch_url_.clear();
+  response->result = prefetched->result;
+  if (prefetched->result != nav2_msgs::srv::LoadMap::Response::RESULT_SUCCESS) {
+    return false;
+  }
+
+  msg_ = std::move(prefetched->map);
+  map_pyramid_ = std::move(prefetched->pyramid);
+  updateMsgHeader();
+  response->map = msg_;
+  return true;
+}
+
+void MapServer::getMapRegionCallback(
+  const std::shared_ptr<rmw_request_id_t>/*request_header*/,
+  const std::shared_ptr<nav2_msgs::srv::GetMapRegion::Request> request,
+  std::shared_ptr<nav2_msgs::srv::GetMapRegion::Response> response)
+{
+  // if not in ACTIVE state, ignore request
+  if (get_current_state().id() != lifecycle_msgs::msg::State::PRIMARY_STATE_ACTIVE) {
+    RCLCPP_WARN(
+      get_logger(),
+      "Received GetMapRegion request but not in ACTIVE state, ignoring!");
+    response->success = false;
+    return;
+  }
+  RCLCPP_DEBUG(get_logger(), "Handling GetMapRegion request");
+  if (request->level > map_pyramid_.size()) {
+    RCLCPP_WARN(
+      get_logger(), "Requested map level %d exceeds the %zu levels served",
+      request->level, map_pyramid_.size());
+    response->success = false;
+    return;
+  }
+  const nav_msgs::msg::OccupancyGrid & level_map =
+    request->level == 0 ? msg_ : map_pyramid_[request->level - 1];
+  response->success = getMapRegion(
+    level_map, request->min_x, request->min_y, request->max_x, request->max_y,
+    response->map);
+}
+
+void MapServer::updateMapCallback(
+  const std::shared_ptr<rmw_request_id_t>/*request_header*/,
+  const std::shared_ptr<nav2_msgs::srv::UpdateMap::Request> request,
+  std::shared_ptr<nav2_msgs::srv::UpdateMap::Response> response)
+{
+  // if not in ACTIVE state, ignore request
+  if (get_current_state().id() != lifecycle_msgs::msg::State::PRIMARY_STATE_ACTIVE) {
+    RCLCPP_WARN(
+      get_logger(),
+      "Received UpdateMap request but not in ACTIVE state, ignoring!");
+    response->success = false;
+    return;
+  }
+  RCLCPP_INFO(
+    get_logger(), "Handling UpdateMap request of a %u X %u patch at (%d, %d)",
+    request->width, request->height, request->x, request->y);
+
+  const int64_t x = request->x;
+  const int64_t y = request->y;
+  if (x < 0 || y < 0 || x + request->width > msg_.info.width ||
+    y + request->height > msg_.info.height ||
+    request->data.size() != static_cast<size_t>(request->width) * request->height)
+  {
+    RCLCPP_WARN(
+      get_logger(), "Map patch exceeds the bounds of the %u X %u map or has %zu values, ignoring!",
+      msg_.info.width, msg_.info.height, request->data.size());
+    response->success = false;
+    return;
+  }
+
+  for (size_t row = 0; row < request->height; row++) {
+    std::copy_n(
+      request->data.begin() + row * request->width, request->width,
+      msg_.data.begin() + (y + row) * msg_.info.width + x);
+  }
+  msg_.header.stamp = now();
+  updateMapPyramid();
+
+  // The patch goes to the live subscribers, the latched map to the late joining ones
+  auto update = std::make_unique<map_msgs::msg::OccupancyGridUpdate>();
+  update->header = msg_.header;
+  update->x = request->x;
+  update->y = request->y;
+  update->width = request->width;
+  update->height = request->height;
+  update->data = request->data;
+  occ_update_pub_->publish(std::move(update));
+  auto occ_grid = std::make_unique<nav_msgs::msg::OccupancyGrid>(msg_);
+  occ_pub_->publish(std::move(occ_grid));
+  response->success = true;
+}
+
 bool MapServer::loadMapResponseFromYaml(
   const std::string & yaml_file,
   std::shared_ptr<nav2_msgs::srv::LoadMap::Response> response)
 {
-  switch (loadMapFromYaml(yaml_file, msg_)) {
-    case MAP_DOES_NOT_EXIST:
-      response->result = nav2_msgs::srv::LoadMap::Response::RESULT_MAP_DOES_NOT_EXIST;
-      return false;
-    case INVALID_MAP_METADATA:
-      response->result = nav2_msgs::srv::LoadMap::Response::RESULT_INVALID_MAP_METADATA;
-      return false;
-    case INVALID_MAP_DATA:
-      response->result = nav2_msgs::srv::LoadMap::Response::RESULT_INVALID_MAP_DATA;
-      return false;
-    case LOAD_MAP_SUCCESS:
-      // Correcting msg_ header when it belongs to spiecific node
-      updateMsgHeader();
-
-      response->map = msg_;
-      response->result = nav2_msgs::srv::LoadMap::Response::RESULT_SUCCESS;
+  if (!toLoadMapResult(loadMapFromYaml(yaml_file, msg_), response->result)) {
+    return false;
   }
 
+  // Correcting msg_ header when it belongs to spiecific node
+  updateMsgHeader();
+  updateMapPyramid();
+
+  response->map = msg_;
+
   return true;
 }
 
@@ -234,6 +471,11 @@ void MapServer::updateMsgHeader()
   msg_.header.stamp = now();
 }
 
+void MapServer::updateMapPyramid()
+{
+  buildMapPyramid(msg_, map_pyramid_levels_, map_pyramid_);
+}
+
 }  // namespace nav2_map_server
 
 #include "rclcpp_components/register_node_macro.hpp"
@@ -14,8 +14,10 @@
 
 #include <gtest/gtest.h>
 
+#include <chrono>
 #include <string>
 #include <memory>
+#include <thread>
 #include <experimental/filesystem>  // NOLINT
 
 #include <rclcpp/rclcpp.hpp>
@@ -24,6 +26,8 @@
 #include "nav2_map_server/map_server.hpp"
 #include "nav2_util/lifecycle_service_client.hpp"
 #include "nav2_msgs/srv/load_map.hpp"
+#include "nav2_msgs/srv/get_map_region.hpp"
+#include "nav2_msgs/srv/update_map.hpp"
 
 #define TEST_DIR TEST_DIRECTORY
 
@@ -120,6 +124,33 @@ TEST_F(MapServerTestFixture, GetMap)
   verifyMapMsg(resp->map);
 }
 
+// Send map region service requests and verify obtained OccupancyGrid
+TEST_F(MapServerTestFixture, GetMapRegion)
+{
+  RCLCPP_INFO(node_->get_logger(), "Testing GetMapRegion service");
+  auto req = std::make_shared<nav2_msgs::srv::GetMapRegion::Request>();
+  auto client = node_->create_client<nav2_msgs::srv::GetMapRegion>(
+    "/map_server/map_region");
+
+  RCLCPP_INFO(node_->get_logger(), "Waiting for map_region service");
+  ASSERT_TRUE(client->wait_for_service());
+
+  // Bounds covering the whole map give the whole map
+  req->min_x = -1000.0;
+  req->min_y = -1000.0;
+  req->max_x = 1000.0;
+  req->max_y = 1000.0;
+  req->level = 0;
+  auto resp = send_request<nav2_msgs::srv::GetMapRegion>(node_, client, req);
+  ASSERT_TRUE(resp->success);
+  verifyMapMsg(resp->map);
+
+  // No reduced resolution levels are served by default
+  req->level = 1;
+  resp = send_request<nav2_msgs::srv::GetMapRegion>(node_, client, req);
+  ASSERT_FALSE(resp->success);
+}
+
 // Send map loading service request and verify obtained OccupancyGrid
 TEST_F(MapServerTestFixture, LoadMap)
 {
@@ -191,3 +222,115 @@ TEST_F(MapServerTestFixture, LoadMapInvalidImage)
 
   ASSERT_EQ(resp->result, nav2_msgs::srv::LoadMap::Response::RESULT_INVALID_MAP_DATA);
 }
+
+// Prefetch maps and verify the OccupancyGrid swapped in by the map loading service
+TEST_F(MapServerTestFixture, PrefetchMap)
+{
+  RCLCPP_INFO(node_->get_logger(), "Testing PrefetchMap service");
+  auto req = std::make_shared<nav2_msgs::srv::LoadMap::Request>();
+  auto prefetch_client = node_->create_client<nav2_msgs::srv::LoadMap>(
+    "/map_server/prefetch_map");
+  auto load_client = node_->create_client<nav2_msgs::srv::LoadMap>(
+    "/map_server/load_map");
+
+  RCLCPP_INFO(node_->get_logger(), "Waiting for prefetch_map service");
+  ASSERT_TRUE(prefetch_client->wait_for_service());
+  ASSERT_TRUE(load_client->wait_for_service());
+
+  // 1. A prefetched map is returned by the next load of the same map
+  req->map_url = path(TEST_DIR) / path(g_valid_yaml_file);
+  auto resp = send_request<nav2_msgs::srv::LoadMap>(node_, prefetch_client, req);
+  ASSERT_EQ(resp->result, nav2_msgs::srv::LoadMap::Response::RESULT_SUCCESS);
+  resp = send_request<nav2_msgs::srv::LoadMap>(node_, load_client, req);
+  ASSERT_EQ(resp->result, nav2_msgs::srv::LoadMap::Response::RESULT_SUCCESS);
+  verifyMapMsg(resp->map);
+
+  // 2. The load of a map failing to prefetch returns the failure
+  req->map_url = path(TEST_DIR) / "invalid_image.yaml";
+  resp = send_request<nav2_msgs::srv::LoadMap>(node_, prefetch_client, req);
+  ASSERT_EQ(resp->result, nav2_msgs::srv::LoadMap::Response::RESULT_SUCCESS);
+  resp = send_request<nav2_msgs::srv::LoadMap>(node_, load_client, req);
+  ASSERT_EQ(resp->result, nav2_msgs::srv::LoadMap::Response::RESULT_INVALID_MAP_DATA);
+
+  // 3. Loads of other maps than the prefetched one load them from file
+  req->map_url = path(TEST_DIR) / path(g_valid_yaml_file);
+  resp = send_request<nav2_msgs::srv::LoadMap>(node_, prefetch_client, req);
+  ASSERT_EQ(resp->result, nav2_msgs::srv::LoadMap::Response::RESULT_SUCCESS);
+  req->map_url = "invalid_file.yaml";
+  resp = send_request<nav2_msgs::srv::LoadMap>(node_, load_client, req);
+  ASSERT_EQ(resp->result, nav2_msgs::srv::LoadMap::Response::RESULT_INVALID_MAP_METADATA);
+  req->map_url = path(TEST_DIR) / path(g_valid_yaml_file);
+  resp = send_request<nav2_msgs::srv::LoadMap>(node_, load_client, req);
+  ASSERT_EQ(resp->result, nav2_msgs::srv::LoadMap::Response::RESULT_SUCCESS);
+  verifyMapMsg(resp->map);
+}
+
+// Send map editing service requests and verify the map obtained from map service
+TEST_F(MapServerTestFixture, UpdateMap)
+{
+  RCLCPP_INFO(node_->get_logger(), "Testing UpdateMap service");
+  auto req = std::make_shared<nav2_msgs::srv::UpdateMap::Request>();
+  auto client = node_->create_client<nav2_msgs::srv::UpdateMap>(
+    "/map_server/update_map");
+
+  RCLCPP_INFO(node_->get_logger(), "Waiting for update_map service");
+  ASSERT_TRUE(client->wait_for_service());
+
+  // 1. Overwrite a 3 X 2 patch of the map
+  req->x = 4;
+  req->y = 5;
+  req->width = 3;
+  req->height = 2;
+  req->data = {100, 100, 100, 0, -1, 0};
+  auto resp = send_request<nav2_msgs::srv::UpdateMap>(node_, client, req);
+  ASSERT_TRUE(resp->success);
+
+  auto map_req = std::make_shared<nav_msgs::srv::GetMap::Request>();
+  auto map_client = node_->create_client<nav_msgs::srv::GetMap>(
+    "/map_server/map");
+  ASSERT_TRUE(map_client->wait_for_service());
+  auto map_resp = send_request<nav_msgs::srv::GetMap>(node_, map_client, map_req);
+  for (unsigned int y = 0; y < g_valid_image_height; y++) {
+    for (unsigned int x = 0; x < g_valid_image_width; x++) {
+      const unsigned int i = y * g_valid_image_width + x;
+      if (x >= 4 && x < 7 && y >= 5 && y < 7) {
+        ASSERT_EQ(map_resp->map.data[i], req->data[(y - 5) * 3 + x - 4]);
+      } else {
+        ASSERT_EQ(map_resp->map.data[i], g_valid_image_content[i]);
+      }
+    }
+  }
+
+  // 2. Late joining subscribers of the latched map topic receive the patched map
+  nav_msgs::msg::OccupancyGrid::SharedPtr latched_map;
+  auto map_sub = node_->create_subscription<nav_msgs::msg::OccupancyGrid>(
+    "map", rclcpp::QoS(rclcpp::KeepLast(1)).transient_local().reliable(),
+    [&latched_map](const nav_msgs::msg::OccupancyGrid::SharedPtr msg) {latched_map = msg;});
+  const auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(5);
+  while (!latched_map && std::chrono::steady_clock::now() < deadline) {
+    rclcpp::spin_some(node_);
+    std::this_thread::sleep_for(std::chrono::milliseconds(10));
+  }
+  ASSERT_TRUE(latched_map);
+  ASSERT_EQ(latched_map->data, map_resp->map.data);
+  map_sub.reset();
+
+  // 3. Patches exceeding the map or with a wrong number of values are rejected
+  req->x = 8;
+  resp = send_request<nav2_msgs::srv::UpdateMap>(node_, client, req);
+  ASSERT_FALSE(resp->success);
+  req->x = 4;
+  req->data.pop_back();
+  resp = send_request<nav2_msgs::srv::UpdateMap>(node_, client, req);
+  ASSERT_FALSE(resp->success);
+
+  // 4. Reload the map to restore it
+  auto load_req = std::make_shared<nav2_msgs::srv::LoadMap::Request>();
+  auto load_client = node_->create_client<nav2_msgs::srv::LoadMap>(
+    "/map_server/load_map");
+  ASSERT_TRUE(load_client->wait_for_service());
+  load_req->map_url = path(TEST_DIR) / path(g_valid_yaml_file);
+  auto load_resp = send_request<nav2_msgs::srv::LoadMap>(node_, load_client, load_req);
+  ASSERT_EQ(load_resp->result, nav2_msgs::srv::LoadMap::Response::RESULT_SUCCESS);
+  verifyMapMsg(load_resp->map);
+}
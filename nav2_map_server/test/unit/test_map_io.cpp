@@ -230,6 +230,148 @@ TEST_F(MapIOTester, loadSaveMapModes)
   ASSERT_EQ(status, LOAD_MAP_SUCCESS);
 
   verifyMapMsg(map_msg);
+
+  // 6. Save map in Raw mode as PGM, written without Magick
+  fillSaveParameters(path(g_tmp_dir) / path(g_valid_map_name), "pgm", saveParameters);
+  saveParameters.mode = MapMode::Raw;
+
+  ASSERT_TRUE(saveMapToFile(map_msg, saveParameters));
+
+  // 7. Load saved map and verify it
+  status = loadMapFromYaml(path(g_tmp_dir) / path(g_valid_yaml_file), map_msg);
+  ASSERT_EQ(status, LOAD_MAP_SUCCESS);
+
+  verifyMapMsg(map_msg);
+}
+
+// Load binary PGM files, read without Magick, and the same images as plain PGM files,
+// decoded through Magick, with all map modes.
+// Succeeds if both give the same OccupancyGrid messages.
+TEST_F(MapIOTester, loadBinaryPGMAsMagick)
+{
+  // 1. Write every gray level to a binary and a plain PGM file
+  const std::string binary_pgm = path(g_tmp_dir) / path("gray_levels_binary.pgm");
+  const std::string plain_pgm = path(g_tmp_dir) / path("gray_levels_plain.pgm");
+  {
+    std::ofstream binary_file(binary_pgm, std::ios::binary);
+    std::ofstream plain_file(plain_pgm);
+    binary_file << "P5\n# every gray level\n16 16\n255\n";
+    plain_file << "P2\n16 16\n255\n";
+    for (unsigned int level = 0; level != 256; level++) {
+      binary_file.put(static_cast<char>(level));
+      plain_file << level << " ";
+    }
+  }
+
+  // 2. Load both files and check that they match
+  for (MapMode mode : {MapMode::Trinary, MapMode::Scale, MapMode::Raw}) {
+    for (bool negate : {false, true}) {
+      LoadParameters loadParameters;
+      fillLoadParameters(binary_pgm, loadParameters);
+      loadParameters.mode = mode;
+      loadParameters.negate = negate;
+      nav_msgs::msg::OccupancyGrid binary_map_msg, plain_map_msg;
+      ASSERT_NO_THROW(loadMapFromFile(loadParameters, binary_map_msg));
+      loadParameters.image_file_name = plain_pgm;
+      ASSERT_NO_THROW(loadMapFromFile(loadParameters, plain_map_msg));
+
+      ASSERT_EQ(binary_map_msg.info.width, 16u);
+      ASSERT_EQ(binary_map_msg.info.height, 16u);
+      ASSERT_EQ(binary_map_msg.data, plain_map_msg.data);
+    }
+  }
+}
+
+// Load a valid reference PGM file, save it as a binary map file and load it back.
+// Check the loaded OccupancyGrid message for consistency, then that a truncated
+// binary map file fails to load.
+// Succeeds all steps were passed without a problem or expection.
+TEST_F(MapIOTester, loadSaveBinaryMap)
+{
+  // 1. Load reference map file
+  LoadParameters loadParameters;
+  fillLoadParameters(path(TEST_DIR) / path(g_valid_pgm_file), loadParameters);
+  nav_msgs::msg::OccupancyGrid map_msg;
+  ASSERT_NO_THROW(loadMapFromFile(loadParameters, map_msg));
+
+  // 2. Save OccupancyGrid into a tmp binary map file
+  SaveParameters saveParameters;
+  fillSaveParameters(path(g_tmp_dir) / path(g_valid_map_name), BINARY_MAP_FORMAT, saveParameters);
+  ASSERT_TRUE(saveMapToFile(map_msg, saveParameters));
+
+  // 3. Load saved map in place of its YAML file and verify it
+  const std::string binary_file =
+    std::string(path(g_tmp_dir) / path(g_valid_map_name)) + "." + BINARY_MAP_FORMAT;
+  ASSERT_TRUE(isBinaryMapFile(binary_file));
+  nav_msgs::msg::OccupancyGrid binary_map_msg;
+  ASSERT_EQ(loadMapFromYaml(binary_file, binary_map_msg), LOAD_MAP_SUCCESS);
+  verifyMapMsg(binary_map_msg);
+  ASSERT_DOUBLE_EQ(binary_map_msg.info.origin.position.x, map_msg.info.origin.position.x);
+  ASSERT_DOUBLE_EQ(binary_map_msg.info.origin.position.y, map_msg.info.origin.position.y);
+  ASSERT_DOUBLE_EQ(binary_map_msg.info.origin.orientation.z, map_msg.info.origin.orientation.z);
+  ASSERT_DOUBLE_EQ(binary_map_msg.info.origin.orientation.w, map_msg.info.origin.orientation.w);
+
+  // 4. Truncate the binary map file, failing to load it
+  {
+    std::ifstream binary_in(binary_file, std::ios::binary);
+    std::vector<char> content(100);
+    binary_in.read(content.data(), content.size());
+    std::ofstream(binary_file, std::ios::binary | std::ios::trunc).write(
+      content.data(), content.size());
+  }
+  ASSERT_EQ(loadMapFromYaml(binary_file, binary_map_msg), INVALID_MAP_DATA);
+  ASSERT_FALSE(isBinaryMapFile(path(TEST_DIR) / path(g_valid_pgm_file)));
+}
+
+// Downsample a small map and crop regions of it.
+// Succeeds if levels keep occupied cells and regions cover the clipped bounds.
+TEST_F(MapIOTester, downsampleAndCropMap)
+{
+  nav_msgs::msg::OccupancyGrid map_msg;
+  map_msg.info.resolution = 0.5;
+  map_msg.info.width = 5;
+  map_msg.info.height = 3;
+  map_msg.info.origin.position.x = -1.0;
+  map_msg.info.origin.position.y = 2.0;
+  map_msg.data = {
+    -1, -1, 0, 100, 0,
+    -1, -1, 0, 0, -1,
+    0, 50, -1, -1, -1};
+
+  // 1. Halve the map resolution, odd sizes are rounded up
+  nav_msgs::msg::OccupancyGrid level_msg;
+  downsampleMap(map_msg, level_msg);
+  ASSERT_DOUBLE_EQ(level_msg.info.resolution, 1.0);
+  ASSERT_EQ(level_msg.info.width, 3u);
+  ASSERT_EQ(level_msg.info.height, 2u);
+  ASSERT_DOUBLE_EQ(level_msg.info.origin.position.x, -1.0);
+  ASSERT_DOUBLE_EQ(level_msg.info.origin.position.y, 2.0);
+  const std::vector<int8_t> level_data = {-1, 100, 0, 50, -1, -1};
+  ASSERT_EQ(level_msg.data, level_data);
+
+  // 2. Crop a region inside the map
+  nav_msgs::msg::OccupancyGrid region_msg;
+  ASSERT_TRUE(getMapRegion(map_msg, 0.1, 2.6, 0.9, 3.4, region_msg));
+  ASSERT_EQ(region_msg.info.width, 2u);
+  ASSERT_EQ(region_msg.info.height, 2u);
+  ASSERT_DOUBLE_EQ(region_msg.info.origin.position.x, 0.0);
+  ASSERT_DOUBLE_EQ(region_msg.info.origin.position.y, 2.5);
+  const std::vector<int8_t> region_data = {0, 0, -1, -1};
+  ASSERT_EQ(region_msg.data, region_data);
+
+  // 3. Bounds are clipped to the map
+  ASSERT_TRUE(getMapRegion(map_msg, -10.0, -10.0, 10.0, 2.2, region_msg));
+  ASSERT_EQ(region_msg.info.width, 5u);
+  ASSERT_EQ(region_msg.info.height, 1u);
+  ASSERT_DOUBLE_EQ(region_msg.info.origin.position.x, -1.0);
+  ASSERT_DOUBLE_EQ(region_msg.info.origin.position.y, 2.0);
+  const std::vector<int8_t> row_data = {-1, -1, 0, 100, 0};
+  ASSERT_EQ(region_msg.data, row_data);
+
+  // 4. Bounds outside of the map give no region
+  ASSERT_FALSE(getMapRegion(map_msg, 2.0, 2.0, 3.0, 3.0, region_msg));
+  ASSERT_FALSE(getMapRegion(map_msg, 0.0, 0.0, 1.0, 1.9, region_msg));
+  ASSERT_FALSE(getMapRegion(map_msg, 1.0, 3.0, 0.0, 3.0, region_msg));
 }
 
 // Try to load an invalid file with different ways.
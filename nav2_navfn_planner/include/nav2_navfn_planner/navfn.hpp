@@ -44,6 +44,11 @@
 #include <string.h>
 #include <stdio.h>
 
+#include <memory>
+#include <vector>
+
+#include "nav2_costmap_2d/tile_thread_pool.hpp"
+
 namespace nav2_navfn_planner
 {
 
@@ -78,6 +83,9 @@ namespace nav2_navfn_planner
 // priority buffers
 #define PRIORITYBUFSIZE 10000
 
+// fast sweeping tiles, in cells along x and y
+#define SWEEPTILESIZE 64
+
 /**
   Navigation function call.
   \param costmap Cost map array, of type COSTTYPE; origin is upper left
@@ -113,12 +121,14 @@ public:
   ~NavFn();
 
   /**
-   * @brief  Sets or resets the size of the map
+   * @brief  Sets or resets the size of the map. The cell arrays are kept, with their
+   * contents, unless the map has more cells than they hold.
    * @param nx The x size of the map
    * @param ny The y size of the map
    */
   void setNavArr(int nx, int ny);
   int nx, ny, ns;  /**< size of grid, in pixels */
+  int nsbuf;  /**< size of the cell arrays */
 
   /**
    * @brief  Set up the cost array for the planner, usually from ROS
@@ -129,6 +139,20 @@ public:
    */
   void setCostmap(const COSTTYPE * cmap, bool isROS = true, bool allow_unknown = true);
 
+  /**
+   * @brief  Set up the cost array for the planner over a window of a ROS costmap only,
+   *   the costs of the other cells being kept from the previous calls
+   * @param cmap The costmap, of the size of the map
+   * @param x0 The first column of the window
+   * @param y0 The first row of the window
+   * @param xn The column past the window
+   * @param yn The row past the window
+   * @param allow_unknown Whether or not the planner should be allowed to plan through
+   *   unknown space
+   */
+  void setCostmapWindow(
+    const COSTTYPE * cmap, int x0, int y0, int xn, int yn, bool allow_unknown = true);
+
   /**
    * @brief  Calculates a plan using the A* heuristic, returns true if one is found
    * @return True if a plan is found, false otherwise
@@ -140,6 +164,19 @@ public:
    */
   bool calcNavFnDijkstra(bool atStart = false);
 
+  /**
+   * @brief  Calculates the full navigation function by fast sweeping over tiles of the map,
+   *   instead of the propagation through priority buffers
+   * @return True if the start point is reached
+   */
+  bool calcNavFnSweep();
+
+  /**
+   * @brief  Sets the number of threads sweeping tiles in calcNavFnSweep, including the caller
+   * @param threads The number of threads, 1 to sweep in the calling thread only
+   */
+  void setSweepThreads(unsigned int threads);
+
   /**
    * @brief  Accessor for the x-coordinates of a path
    * @return The x-coordinates of a path
@@ -164,6 +201,12 @@ public:
    */
   float getLastPathCost();
 
+  /**
+   * @brief  Gets the memory held by the cell arrays, priority buffers, tiles and paths
+   * @return The number of bytes allocated
+   */
+  size_t getMemoryUsage();
+
   /** cell arrays */
   COSTTYPE * costarr;  /**< cost array in 2D configuration space */
   float * potarr;  /**< potential array, navigation function potential */
@@ -242,8 +285,33 @@ public:
    */
   bool propNavFnAstar(int cycles);  /**< returns true if start point found */
 
-  /** gradient and paths */
-  float * gradx, * grady;  /**< gradient arrays, size of potential array */
+  /**
+   * @brief  Run propagation by fast sweeping until no potential decreases, with the update of
+   * updateCell. Tiles of SWEEPTILESIZE cells are swept until they converge, and the tiles next
+   * to a changed tile border are swept again. Tiles of one color of a checkerboard are swept
+   * in parallel, as none of them shares a border with another.
+   * @return true if the start point is reached
+   */
+  bool propNavFnSweep();
+
+  /**
+   * @brief  Sweep a tile down and up, each row left to right and back, until it converges
+   * @param tile The index of the tile
+   * @return The changed borders of the tile, as SweepBorder flags
+   */
+  int sweepTile(int tile);
+
+  /** flags of the changed borders of a sweep tile */
+  enum SweepBorder {SWEEP_LEFT = 1, SWEEP_RIGHT = 2, SWEEP_UP = 4, SWEEP_DOWN = 8};
+
+  /** fast sweeping */
+  std::unique_ptr<nav2_costmap_2d::TileThreadPool> sweep_pool_;  /**< sweep threads */
+  std::vector<bool> tile_active_;  /**< tiles left to sweep */
+  std::vector<int> tile_borders_;  /**< changed borders of the tiles of a sweep pass */
+  std::vector<int> sweep_tiles_;  /**< tiles of a sweep pass */
+  int tiles_x_, tiles_y_;  /**< number of tiles along x and y */
+
+  /** paths */
   float * pathx, * pathy;  /**< path points, as subpixel cell coordinates */
   int npath;  /**< number of path points */
   int npathbuf;  /**< size of pathx, pathy buffers */
@@ -258,11 +326,14 @@ public:
   int calcPath(int n, int * st = NULL);
 
   /**
-   * @brief  Calculate gradient at a cell
+   * @brief  Calculate gradient at a cell, from the potentials around it. It is only
+   *   computed for the cells along the path, rather than stored for the whole map.
    * @param n Cell number <n>
+   * @param gx Normalized gradient along x, 0 if none
+   * @param gy Normalized gradient along y, 0 if none
    * @return float norm
    */
-  float gradCell(int n);  /**< calculates gradient at cell <n>, returns norm */
+  float gradCell(int n, float & gx, float & gy);
 
   float pathStep;  /**< step size for following gradient */
 
@@ -18,6 +18,7 @@
 #define NAV2_NAVFN_PLANNER__NAVFN_PLANNER_HPP_
 
 #include <chrono>
+#include <cstdint>
 #include <string>
 #include <memory>
 #include <vector>
@@ -31,6 +32,7 @@
 #include "nav2_util/lifecycle_node.hpp"
 #include "nav2_costmap_2d/costmap_2d_ros.hpp"
 #include "nav2_util/geometry_utils.hpp"
+#include "nav2_util/instrumentation.hpp"
 
 namespace nav2_navfn_planner
 {
@@ -100,6 +102,33 @@ protected:
     const geometry_msgs::msg::Pose & goal, double tolerance,
     nav_msgs::msg::Path & plan);
 
+  /**
+   * @brief Compute a plan from the potential of the goal over the whole map, which is
+   * kept and reused by later requests to the same goal until the costmap is updated
+   * @param start Start pose
+   * @param goal Goal pose
+   * @param map_start Start cell
+   * @param map_goal Goal cell
+   * @param plan Path to be computed
+   * @return true if can find the path, false if the plan should be computed from the start
+   * instead, as the goal is in an obstacle or can't be reached from the start
+   */
+  bool makePlanFromGoalPotential(
+    const geometry_msgs::msg::Pose & start,
+    const geometry_msgs::msg::Pose & goal,
+    int * map_start, int * map_goal,
+    nav_msgs::msg::Path & plan);
+
+  /**
+   * @brief Set the orientation of the last pose of the plan to that of its final approach,
+   *        if use_final_approach_orientation is set
+   * @param start Start pose
+   * @param plan Computed path
+   */
+  void setFinalApproachOrientation(
+    const geometry_msgs::msg::Pose & start,
+    nav_msgs::msg::Path & plan);
+
   /**
    * @brief Compute the navigation function given a seed point in the world to start from
    * @param world_point Point in world coordinate frame
@@ -181,6 +210,14 @@ protected:
    */
   void clearRobotCell(unsigned int mx, unsigned int my);
 
+  /**
+   * @brief Update the cost array of planner_ to the costmap, translating only the
+   * windows changed since the last update when they are known. To be called with the
+   * costmap mutex held.
+   * @param map_start Start cell, cleared in the costmap by clearRobotCell()
+   */
+  void updateCostArray(const int * map_start);
+
   /**
    * @brief Determine if a new planner object should be made
    * @return true if planner object is out of date
@@ -190,6 +227,9 @@ protected:
   // Planner based on ROS1 NavFn algorithm
   std::unique_ptr<NavFn> planner_;
 
+  // Memory held by the planner, reported with the instrumentation of the server
+  std::unique_ptr<nav2_util::MemoryAccount> memory_;
+
   // TF buffer
   std::shared_ptr<tf2_ros::Buffer> tf_;
 
@@ -202,6 +242,9 @@ protected:
   // Global Costmap
   nav2_costmap_2d::Costmap2D * costmap_;
 
+  // Layered costmap of the global costmap, for its update count
+  nav2_costmap_2d::LayeredCostmap * layered_costmap_;
+
   // The global frame of the costmap
   std::string global_frame_, name_;
 
@@ -215,6 +258,27 @@ protected:
   // Whether to use the astar planner or default dijkstras
   bool use_astar_;
 
+  // Whether to compute the potential by fast sweeping instead, for either of them
+  bool use_fast_sweeping_;
+
+  // Whether to compute the potential from the goal over the whole map, and reuse it
+  // for later requests to the same goal while the costmap is not updated
+  bool reuse_goal_potential_;
+
+  // Goal cell, costmap update count and allow_unknown of the goal potential held
+  // by planner_, if goal_potential_valid_
+  bool goal_potential_valid_;
+  int potential_goal_[2];
+  uint64_t potential_update_count_;
+  bool potential_allow_unknown_;
+
+  // Costmap update count and allow_unknown of the cost array held by planner_, if
+  // cost_array_valid_, and the windows changed since
+  bool cost_array_valid_;
+  uint64_t cost_array_update_count_;
+  bool cost_array_allow_unknown_;
+  std::vector<nav2_costmap_2d::LayeredCostmap::ChangedWindow> changed_windows_;
+
   // parent node weak ptr
   rclcpp_lifecycle::LifecycleNode::WeakPtr node_;
 
@@ -114,7 +114,8 @@ NavFn::NavFn(int xs, int ys)
   costarr = NULL;
   potarr = NULL;
   pending = NULL;
-  gradx = grady = NULL;
+  nsbuf = 0;
+  tiles_x_ = tiles_y_ = 0;
   setNavArr(xs, ys);
 
   // priority buffers
@@ -152,12 +153,6 @@ NavFn::~NavFn()
   if (pending) {
     delete[] pending;
   }
-  if (gradx) {
-    delete[] gradx;
-  }
-  if (grady) {
-    delete[] grady;
-  }
   if (pathx) {
     delete[] pathx;
   }
@@ -211,6 +206,13 @@ NavFn::setNavArr(int xs, int ys)
   ny = ys;
   ns = nx * ny;
 
+  // the arrays are reset by setCostmap() and setupNavFn() before each use, so they are
+  // only reallocated to hold more cells
+  if (ns <= nsbuf) {
+    return;
+  }
+  nsbuf = ns;
+
   if (costarr) {
     delete[] costarr;
   }
@@ -221,20 +223,11 @@ NavFn::setNavArr(int xs, int ys)
     delete[] pending;
   }
 
-  if (gradx) {
-    delete[] gradx;
-  }
-  if (grady) {
-    delete[] grady;
-  }
-
   costarr = new COSTTYPE[ns];  // cost array, 2d config space
   memset(costarr, 0, ns * sizeof(COSTTYPE));
   potarr = new float[ns];  // navigation potential array
   pending = new bool[ns];
   memset(pending, 0, ns * sizeof(bool));
-  gradx = new float[ns];
-  grady = new float[ns];
 }
 
 
@@ -292,6 +285,34 @@ NavFn::setCostmap(const COSTTYPE * cmap, bool isROS, bool allow_unknown)
   }
 }
 
+void
+NavFn::setCostmapWindow(
+  const COSTTYPE * cmap, int x0, int y0, int xn, int yn, bool allow_unknown)
+{
+  x0 = std::max(x0, 0);
+  y0 = std::max(y0, 0);
+  xn = std::min(xn, nx);
+  yn = std::min(yn, ny);
+  for (int i = y0; i < yn; i++) {
+    const int k = i * nx;
+    for (int j = x0; j < xn; j++) {
+      // same translation as setCostmap() for ROS costs
+      COSTTYPE & cm = costarr[k + j];
+      cm = COST_OBS;
+      int v = cmap[k + j];
+      if (v < COST_OBS_ROS) {
+        v = COST_NEUTRAL + COST_FACTOR * v;
+        if (v >= COST_OBS) {
+          v = COST_OBS - 1;
+        }
+        cm = v;
+      } else if (v == COST_UNKNOWN_ROS && allow_unknown) {
+        cm = COST_OBS - 1;
+      }
+    }
+  }
+}
+
 bool
 NavFn::calcNavFnDijkstra(bool atStart)
 {
@@ -315,6 +336,31 @@ NavFn::calcNavFnAstar()
   return propNavFnAstar(std::max(nx * ny / 20, nx + ny));
 }
 
+//
+// calculate navigation function by fast sweeping, given a costmap, goal, and start
+//
+
+bool
+NavFn::calcNavFnSweep()
+{
+  setupNavFn(true);
+
+  // calculate the nav fn over the whole map
+  return propNavFnSweep();
+}
+
+void
+NavFn::setSweepThreads(unsigned int threads)
+{
+  if (threads > 1) {
+    if (!sweep_pool_ || sweep_pool_->getThreads() != threads) {
+      sweep_pool_ = std::make_unique<nav2_costmap_2d::TileThreadPool>(threads);
+    }
+  } else {
+    sweep_pool_.reset();
+  }
+}
+
 //
 // returning values
 //
@@ -323,6 +369,15 @@ float * NavFn::getPathX() {return pathx;}
 float * NavFn::getPathY() {return pathy;}
 int NavFn::getPathLen() {return npath;}
 
+size_t NavFn::getMemoryUsage()
+{
+  return static_cast<size_t>(nsbuf) * (sizeof(COSTTYPE) + sizeof(float) + sizeof(bool)) +
+         3 * PRIORITYBUFSIZE * sizeof(int) +
+         tile_active_.capacity() / 8 +
+         (tile_borders_.capacity() + sweep_tiles_.capacity()) * sizeof(int) +
+         2 * static_cast<size_t>(npathbuf) * sizeof(float);
+}
+
 // inserting onto the priority blocks
 #define push_cur(n)  {if (n >= 0 && n < ns && !pending[n] && \
       costarr[n] < COST_OBS && curPe < PRIORITYBUFSIZE) \
@@ -346,7 +401,6 @@ NavFn::setupNavFn(bool keepit)
     if (!keepit) {
       costarr[i] = COST_NEUTRAL;
     }
-    gradx[i] = grady[i] = 0.0;
   }
 
   // outer bounds of cost array
@@ -735,6 +789,184 @@ NavFn::propNavFnAstar(int cycles)
 }
 
 
+
+//
+// main propagation function
+// fast sweeping method over tiles
+// runs until no potential decreases any more,
+//   so the whole map is computed
+//
+
+// Potential of a cell from its lowest neighbors along each axis, as in updateCell()
+static inline float
+sweepPotential(float ta, float tc, float hf)
+{
+  float dc = tc - ta;  // relative cost between ta,tc
+  if (dc < 0) {  // tc is lowest
+    dc = -dc;
+    ta = tc;
+  }
+  if (dc >= hf) {  // if too large, use ta-only update
+    return ta + hf;
+  }
+  float d = dc / hf;
+  float v = -0.2301 * d * d + 0.5307 * d + 0.7040;
+  return ta + hf * v;
+}
+
+// Decreases below which a sweep is not repeated, in potential units
+#define SWEEP_TOLERANCE 0.1
+
+bool
+NavFn::propNavFnSweep()
+{
+  tiles_x_ = (nx + SWEEPTILESIZE - 1) / SWEEPTILESIZE;
+  tiles_y_ = (ny + SWEEPTILESIZE - 1) / SWEEPTILESIZE;
+  const int ntiles = tiles_x_ * tiles_y_;
+  tile_active_.assign(ntiles, false);
+  tile_borders_.assign(ntiles, 0);
+
+  // the goal cell is set, its tile starts the sweeps
+  tile_active_[goal[1] / SWEEPTILESIZE * tiles_x_ + goal[0] / SWEEPTILESIZE] = true;
+
+  int passes = 0;  // number of sweep passes
+  int nt = 0;  // number of tiles swept
+  bool active = true;
+  while (active) {
+    active = false;
+    for (int color = 0; color < 2; color++) {
+      // tiles of a color only share corners, and the update reads no diagonal neighbor
+      sweep_tiles_.clear();
+      for (int t = 0; t < ntiles; t++) {
+        if (tile_active_[t] && (t / tiles_x_ + t % tiles_x_) % 2 == color) {
+          sweep_tiles_.push_back(t);
+          tile_active_[t] = false;
+        }
+      }
+      if (sweep_tiles_.empty()) {
+        continue;
+      }
+      active = true;
+      passes++;
+      nt += sweep_tiles_.size();
+
+      if (sweep_pool_) {
+        sweep_pool_->run(
+          sweep_tiles_.size(), [this](unsigned int i) {
+            tile_borders_[sweep_tiles_[i]] = sweepTile(sweep_tiles_[i]);
+          });
+      } else {
+        for (int t : sweep_tiles_) {
+          tile_borders_[t] = sweepTile(t);
+        }
+      }
+
+      // sweep again the tiles next to a changed border
+      for (int t : sweep_tiles_) {
+        const int borders = tile_borders_[t];
+        const int tx = t % tiles_x_;
+        const int ty = t / tiles_x_;
+        if ((borders & SWEEP_LEFT) && tx > 0) {tile_active_[t - 1] = true;}
+        if ((borders & SWEEP_RIGHT) && tx < tiles_x_ - 1) {tile_active_[t + 1] = true;}
+        if ((borders & SWEEP_UP) && ty > 0) {tile_active_[t - tiles_x_] = true;}
+        if ((borders & SWEEP_DOWN) && ty < tiles_y_ - 1) {tile_active_[t + tiles_x_] = true;}
+      }
+    }
+  }
+
+  int startCell = start[1] * nx + start[0];
+  last_path_cost_ = potarr[startCell];
+
+  RCLCPP_DEBUG(
+    rclcpp::get_logger("rclcpp"),
+    "[NavFn] Used %d sweep passes, %d tiles swept\n", passes, nt);
+
+  return potarr[startCell] < POT_HIGH;
+}
+
+int
+NavFn::sweepTile(int tile)
+{
+  // the outer cells of the map are obstacles, and are not updated
+  const int tx = tile % tiles_x_;
+  const int ty = tile / tiles_x_;
+  const int x0 = tx * SWEEPTILESIZE;
+  const int y0 = ty * SWEEPTILESIZE;
+  const int x1 = std::min(x0 + SWEEPTILESIZE, nx);
+  const int y1 = std::min(y0 + SWEEPTILESIZE, ny);
+  const int xa = std::max(x0, 1);
+  const int xb = std::min(x1, nx - 1);
+  const int ya = std::max(y0, 1);
+  const int yb = std::min(y1, ny - 1);
+  if (xa >= xb || ya >= yb) {
+    return 0;
+  }
+
+  float ta[SWEEPTILESIZE];  // lowest vertical neighbor of each cell of a row
+  bool decreased[SWEEPTILESIZE];  // cells of a row whose potential has decreased
+  int borders = 0;
+
+  // rows changed by the last sweep, as bits from ya; after the first sweep, only the rows
+  // next to a changed row can change
+  uint64_t changed = ~static_cast<uint64_t>(0);
+  for (int dir = 0; changed != 0; dir = 1 - dir) {
+    const uint64_t near = changed | (changed << 1) | (changed >> 1);
+    changed = 0;
+    bool last_changed = false;  // if the row swept last has changed
+    for (int k = 0; k < yb - ya; k++) {
+      const int y = dir == 0 ? ya + k : yb - 1 - k;
+      if (!last_changed && !((near >> (y - ya)) & 1)) {
+        continue;
+      }
+      float * row = potarr + y * nx;
+      const float * up = row - nx;
+      const float * down = row + nx;
+      const COSTTYPE * costs = costarr + y * nx;
+
+      // the rows above and below don't change while sweeping this one
+      for (int x = xa; x < xb; x++) {
+        ta[x - xa] = std::min(up[x], down[x]);
+      }
+
+      // sweep left to right, then back over the cells whose right neighbor has changed since
+      // they were updated, as the others would get the same potential
+      bool row_changed = false;
+      for (int pass = 0; pass < 2; pass++) {
+        for (int j = pass; j < xb - xa; j++) {
+          const int x = pass == 0 ? xa + j : xb - 1 - j;
+          if (pass == 0) {
+            decreased[x - xa] = false;
+          } else if (!decreased[x + 1 - xa]) {
+            continue;
+          }
+          if (costs[x] >= COST_OBS) {  // don't propagate into obstacles
+            continue;
+          }
+          const float pot = sweepPotential(
+            ta[x - xa], std::min(row[x - 1], row[x + 1]), static_cast<float>(costs[x]));
+          if (pot < row[x]) {
+            if (row[x] - pot > SWEEP_TOLERANCE) {
+              row_changed = true;
+              if (x == x0) {borders |= SWEEP_LEFT;}
+              if (x == x1 - 1) {borders |= SWEEP_RIGHT;}
+            }
+            row[x] = pot;
+            decreased[x - xa] = true;
+          }
+        }
+      }
+
+      last_changed = row_changed;
+      if (row_changed) {
+        changed |= static_cast<uint64_t>(1) << (y - ya);
+        if (y == y0) {borders |= SWEEP_UP;}
+        if (y == y1 - 1) {borders |= SWEEP_DOWN;}
+      }
+    }
+  }
+  return borders;
+}
+
 float NavFn::getLastPathCost()
 {
   return last_path_cost_;
@@ -865,18 +1097,19 @@ NavFn::calcPath(int n, int * st)
       }
     } else {  // have a good gradient here
       // get grad at four positions near cell
-      gradCell(stc);
-      gradCell(stc + 1);
-      gradCell(stcnx);
-      gradCell(stcnx + 1);
+      float gx[4], gy[4];
+      gradCell(stc, gx[0], gy[0]);
+      gradCell(stc + 1, gx[1], gy[1]);
+      gradCell(stcnx, gx[2], gy[2]);
+      gradCell(stcnx + 1, gx[3], gy[3]);
 
 
       // get interpolated gradient
-      float x1 = (1.0 - dx) * gradx[stc] + dx * gradx[stc + 1];
-      float x2 = (1.0 - dx) * gradx[stcnx] + dx * gradx[stcnx + 1];
+      float x1 = (1.0 - dx) * gx[0] + dx * gx[1];
+      float x2 = (1.0 - dx) * gx[2] + dx * gx[3];
       float x = (1.0 - dy) * x1 + dy * x2;  // interpolated x
-      float y1 = (1.0 - dx) * grady[stc] + dx * grady[stc + 1];
-      float y2 = (1.0 - dx) * grady[stcnx] + dx * grady[stcnx + 1];
+      float y1 = (1.0 - dx) * gy[0] + dx * gy[1];
+      float y2 = (1.0 - dx) * gy[2] + dx * gy[3];
       float y = (1.0 - dy) * y1 + dy * y2;  // interpolated y
 
 #if 0
@@ -884,9 +1117,7 @@ NavFn::calcPath(int n, int * st)
       RCLCPP_DEBUG(
         rclcpp::get_logger("rclcpp"),
         "[Path] %0.2f,%0.2f  %0.2f,%0.2f  %0.2f,%0.2f  %0.2f,%0.2f; final x=%.3f, y=%.3f\n",
-        gradx[stc], grady[stc], gradx[stc + 1], grady[stc + 1],
-        gradx[stcnx], grady[stcnx], gradx[stcnx + 1], grady[stcnx + 1],
-        x, y);
+        gx[0], gy[0], gx[1], gy[1], gx[2], gy[2], gx[3], gy[3], x, y);
 #endif
 
       // check for zero gradient, failed
@@ -925,12 +1156,9 @@ NavFn::calcPath(int n, int * st)
 // calculate gradient at a cell
 // positive value are to the right and down
 float
-NavFn::gradCell(int n)
+NavFn::gradCell(int n, float & gx, float & gy)
 {
-  if (gradx[n] + grady[n] > 0.0) {  // check this cell
-    return 1.0;
-  }
-
+  gx = gy = 0.0;
   if (n < nx || n > ns - nx) {  // would be out of bounds
     return 0.0;
   }
@@ -973,8 +1201,8 @@ NavFn::gradCell(int n)
   float norm = hypot(dx, dy);
   if (norm > 0) {
     norm = 1.0 / norm;
-    gradx[n] = norm * dx;
-    grady[n] = norm * dy;
+    gx = norm * dx;
+    gy = norm * dy;
   }
   return norm;
 }
@@ -23,6 +23,7 @@
 
 #include "nav2_navfn_planner/navfn_planner.hpp"
 
+#include <algorithm>
 #include <chrono>
 #include <cmath>
 #include <iomanip>
@@ -48,7 +49,8 @@ namespace nav2_navfn_planner
 {
 
 NavfnPlanner::NavfnPlanner()
-: tf_(nullptr), costmap_(nullptr)
+: tf_(nullptr), costmap_(nullptr), layered_costmap_(nullptr), goal_potential_valid_(false),
+  cost_array_valid_(false)
 {
 }
 
@@ -68,6 +70,7 @@ NavfnPlanner::configure(
   tf_ = tf;
   name_ = name;
   costmap_ = costmap_ros->getCostmap();
+  layered_costmap_ = costmap_ros->getLayeredCostmap();
   global_frame_ = costmap_ros->getGlobalFrameID();
 
   node_ = parent;
@@ -90,11 +93,27 @@ NavfnPlanner::configure(
   declare_parameter_if_not_declared(
     node, name + ".use_final_approach_orientation", rclcpp::ParameterValue(false));
   node->get_parameter(name + ".use_final_approach_orientation", use_final_approach_orientation_);
+  declare_parameter_if_not_declared(
+    node, name + ".use_fast_sweeping", rclcpp::ParameterValue(false));
+  node->get_parameter(name + ".use_fast_sweeping", use_fast_sweeping_);
+  int fast_sweeping_threads;
+  declare_parameter_if_not_declared(
+    node, name + ".fast_sweeping_threads", rclcpp::ParameterValue(1));
+  node->get_parameter(name + ".fast_sweeping_threads", fast_sweeping_threads);
+  declare_parameter_if_not_declared(
+    node, name + ".reuse_goal_potential", rclcpp::ParameterValue(false));
+  node->get_parameter(name + ".reuse_goal_potential", reuse_goal_potential_);
 
   // Create a planner based on the new costmap size
   planner_ = std::make_unique<NavFn>(
     costmap_->getSizeInCellsX(),
     costmap_->getSizeInCellsY());
+  planner_->setSweepThreads(std::max(fast_sweeping_threads, 1));
+  memory_ = std::make_unique<nav2_util::MemoryAccount>(
+    std::string(node->get_name()) + "." + name_ + ".navfn");
+  memory_->set(planner_->getMemoryUsage());
+  goal_potential_valid_ = false;
+  cost_array_valid_ = false;
 }
 
 void
@@ -125,6 +144,7 @@ NavfnPlanner::cleanup()
     logger_, "Cleaning up plugin %s of type NavfnPlanner",
     name_.c_str());
   planner_.reset();
+  memory_.reset();
 }
 
 nav_msgs::msg::Path NavfnPlanner::createPlan(
@@ -176,6 +196,7 @@ nav_msgs::msg::Path NavfnPlanner::createPlan(
       logger_, "%s: failed to create plan with "
       "tolerance %.2f.", name_.c_str(), tolerance_);
   }
+  memory_->set(planner_->getMemoryUsage());
 
 
 #ifdef BENCHMARK_TESTING
@@ -187,6 +208,35 @@ nav_msgs::msg::Path NavfnPlanner::createPlan(
   return path;
 }
 
+void
+NavfnPlanner::updateCostArray(const int * map_start)
+{
+  const uint64_t update_count = layered_costmap_->getUpdateCount();
+  if (!cost_array_valid_ || isPlannerOutOfDate() ||
+    cost_array_allow_unknown_ != allow_unknown_ ||
+    !layered_costmap_->getChangedWindows(cost_array_update_count_, changed_windows_))
+  {
+    // make sure to resize the underlying array that Navfn uses
+    planner_->setNavArr(
+      costmap_->getSizeInCellsX(),
+      costmap_->getSizeInCellsY());
+    planner_->setCostmap(costmap_->getCharMap(), true, allow_unknown_);
+  } else {
+    for (const auto & window : changed_windows_) {
+      planner_->setCostmapWindow(
+        costmap_->getCharMap(), window.x0, window.y0, window.xn, window.yn, allow_unknown_);
+    }
+    // The start cell is cleared in the costmap without an update
+    planner_->setCostmapWindow(
+      costmap_->getCharMap(), map_start[0], map_start[1], map_start[0] + 1, map_start[1] + 1,
+      allow_unknown_);
+  }
+
+  cost_array_valid_ = true;
+  cost_array_update_count_ = update_count;
+  cost_array_allow_unknown_ = allow_unknown_;
+}
+
 bool
 NavfnPlanner::isPlannerOutOfDate()
 {
@@ -233,17 +283,6 @@ NavfnPlanner::makePlan(
   // clear the starting cell within the costmap because we know it can't be an obstacle
   clearRobotCell(mx, my);
 
-  std::unique_lock<nav2_costmap_2d::Costmap2D::mutex_t> lock(*(costmap_->getMutex()));
-
-  // make sure to resize the underlying array that Navfn uses
-  planner_->setNavArr(
-    costmap_->getSizeInCellsX(),
-    costmap_->getSizeInCellsY());
-
-  planner_->setCostmap(costmap_->getCharMap(), true, allow_unknown_);
-
-  lock.unlock();
-
   int map_start[2];
   map_start[0] = mx;
   map_start[1] = my;
@@ -263,12 +302,29 @@ NavfnPlanner::makePlan(
   map_goal[0] = mx;
   map_goal[1] = my;
 
+  if (reuse_goal_potential_ &&
+    makePlanFromGoalPotential(start, goal, map_start, map_goal, plan))
+  {
+    return true;
+  }
+
+  std::unique_lock<nav2_costmap_2d::Costmap2D::mutex_t> lock(*(costmap_->getMutex()));
+
+  updateCostArray(map_start);
+
+  lock.unlock();
+
+  // The potential computed from the start can't be reused
+  goal_potential_valid_ = false;
+
   // TODO(orduno): Explain why we are providing 'map_goal' to setStart().
   //               Same for setGoal, seems reversed. Computing backwards?
 
   planner_->setStart(map_goal);
   planner_->setGoal(map_start);
-  if (use_astar_) {
+  if (use_fast_sweeping_) {
+    planner_->calcNavFnSweep();
+  } else if (use_astar_) {
     planner_->calcNavFnAstar();
   } else {
     planner_->calcNavFnDijkstra(true);
@@ -311,32 +367,7 @@ NavfnPlanner::makePlan(
     // extract the plan
     if (getPlanFromPotential(best_pose, plan)) {
       smoothApproachToGoal(best_pose, plan);
-
-      // If use_final_approach_orientation=true, interpolate the last pose orientation from the
-      // previous pose to set the orientation to the 'final approach' orientation of the robot so
-      // it does not rotate.
-      // And deal with corner case of plan of length 1
-      if (use_final_approach_orientation_) {
-        size_t plan_size = plan.poses.size();
-        if (plan_size == 1) {
-          plan.poses.back().pose.orientation = start.orientation;
-        } else if (plan_size > 1) {
-          double dx, dy, theta;
-          auto last_pose = plan.poses.back().pose.position;
-          auto approach_pose = plan.poses[plan_size - 2].pose.position;
-          // Deal with the case of NavFn producing a path with two equal last poses
-          if (std::abs(last_pose.x - approach_pose.x) < 0.0001 &&
-            std::abs(last_pose.y - approach_pose.y) < 0.0001 && plan_size > 2)
-          {
-            approach_pose = plan.poses[plan_size - 3].pose.position;
-          }
-          dx = last_pose.x - approach_pose.x;
-          dy = last_pose.y - approach_pose.y;
-          theta = atan2(dy, dx);
-          plan.poses.back().pose.orientation =
-            nav2_util::geometry_utils::orientationAroundZAxis(theta);
-        }
-      }
+      setFinalApproachOrientation(start, plan);
     } else {
       RCLCPP_ERROR(
         logger_,
@@ -348,6 +379,125 @@ NavfnPlanner::makePlan(
   return !plan.poses.empty();
 }
 
+bool
+NavfnPlanner::makePlanFromGoalPotential(
+  const geometry_msgs::msg::Pose & start,
+  const geometry_msgs::msg::Pose & goal,
+  int * map_start, int * map_goal,
+  nav_msgs::msg::Path & plan)
+{
+  std::unique_lock<nav2_costmap_2d::Costmap2D::mutex_t> lock(*(costmap_->getMutex()));
+
+  // The update count is read with the costmap locked, so that it matches the costs
+  // copied below
+  const uint64_t update_count = layered_costmap_->getUpdateCount();
+  if (!goal_potential_valid_ || isPlannerOutOfDate() ||
+    potential_goal_[0] != map_goal[0] || potential_goal_[1] != map_goal[1] ||
+    potential_update_count_ != update_count || potential_allow_unknown_ != allow_unknown_)
+  {
+    updateCostArray(map_start);
+    lock.unlock();
+
+    // Unlike in makePlan(), the potential is propagated outward from the goal, and over
+    // the whole map rather than until the start is reached, so that it serves any start.
+    // A* would stop at the first start, so Dijkstra is used unless fast sweeping is set.
+    planner_->setGoal(map_goal);
+    planner_->setStart(map_start);
+    if (use_fast_sweeping_) {
+      planner_->calcNavFnSweep();
+    } else {
+      planner_->calcNavFnDijkstra(false);
+    }
+
+    goal_potential_valid_ = true;
+    potential_goal_[0] = map_goal[0];
+    potential_goal_[1] = map_goal[1];
+    potential_update_count_ = update_count;
+    potential_allow_unknown_ = allow_unknown_;
+  } else {
+    lock.unlock();
+  }
+
+  // A goal in an obstacle or out of reach of the start is left to makePlan(),
+  // which looks for the closest reachable pose within the tolerance
+  const int goal_index = map_goal[1] * planner_->nx + map_goal[0];
+  const int start_index = map_start[1] * planner_->nx + map_start[0];
+  if (planner_->costarr[goal_index] >= COST_OBS || planner_->potarr[start_index] >= POT_HIGH) {
+    return false;
+  }
+
+  planner_->setStart(map_start);
+
+  const int & max_cycles = (costmap_->getSizeInCellsX() >= costmap_->getSizeInCellsY()) ?
+    (costmap_->getSizeInCellsX() * 4) : (costmap_->getSizeInCellsY() * 4);
+
+  int path_len = planner_->calcPath(max_cycles);
+  if (path_len == 0) {
+    return false;
+  }
+
+  RCLCPP_DEBUG(
+    logger_,
+    "Path found from the goal potential, %d steps, %f cost\n", path_len,
+    planner_->potarr[start_index]);
+
+  // The path descends the potential from the start, so it is already in order
+  float * x = planner_->getPathX();
+  float * y = planner_->getPathY();
+  int len = planner_->getPathLen();
+
+  for (int i = 0; i < len; ++i) {
+    double world_x, world_y;
+    mapToWorld(x[i], y[i], world_x, world_y);
+
+    geometry_msgs::msg::PoseStamped pose;
+    pose.pose.position.x = world_x;
+    pose.pose.position.y = world_y;
+    pose.pose.position.z = 0.0;
+    pose.pose.orientation.x = 0.0;
+    pose.pose.orientation.y = 0.0;
+    pose.pose.orientation.z = 0.0;
+    pose.pose.orientation.w = 1.0;
+    plan.poses.push_back(pose);
+  }
+
+  smoothApproachToGoal(goal, plan);
+  setFinalApproachOrientation(start, plan);
+  return true;
+}
+
+void
+NavfnPlanner::setFinalApproachOrientation(
+  const geometry_msgs::msg::Pose & start,
+  nav_msgs::msg::Path & plan)
+{
+  // If use_final_approach_orientation=true, interpolate the last pose orientation from the
+  // previous pose to set the orientation to the 'final approach' orientation of the robot so
+  // it does not rotate.
+  // And deal with corner case of plan of length 1
+  if (use_final_approach_orientation_) {
+    size_t plan_size = plan.poses.size();
+    if (plan_size == 1) {
+      plan.poses.back().pose.orientation = start.orientation;
+    } else if (plan_size > 1) {
+      double dx, dy, theta;
+      auto last_pose = plan.poses.back().pose.position;
+      auto approach_pose = plan.poses[plan_size - 2].pose.position;
+      // Deal with the case of NavFn producing a path with two equal last poses
+      if (std::abs(last_pose.x - approach_pose.x) < 0.0001 &&
+        std::abs(last_pose.y - approach_pose.y) < 0.0001 && plan_size > 2)
+      {
+        approach_pose = plan.poses[plan_size - 3].pose.position;
+      }
+      dx = last_pose.x - approach_pose.x;
+      dy = last_pose.y - approach_pose.y;
+      theta = atan2(dy, dx);
+      plan.poses.back().pose.orientation =
+        nav2_util::geometry_utils::orientationAroundZAxis(theta);
+    }
+  }
+}
+
 void
 NavfnPlanner::smoothApproachToGoal(
   const geometry_msgs::msg::Pose & goal,
@@ -543,6 +693,10 @@ NavfnPlanner::dynamicParametersCallback(std::vector<rclcpp::Parameter> parameter
         allow_unknown_ = parameter.as_bool();
       } else if (name == name_ + ".use_final_approach_orientation") {
         use_final_approach_orientation_ = parameter.as_bool();
+      } else if (name == name_ + ".use_fast_sweeping") {
+        use_fast_sweeping_ = parameter.as_bool();
+      } else if (name == name_ + ".reuse_goal_potential") {
+        reuse_goal_potential_ = parameter.as_bool();
       }
     }
   }
@@ -51,7 +51,9 @@ TEST(NavfnTest, testDynamicParameter)
     {rclcpp::Parameter("test.tolerance", 1.0),
       rclcpp::Parameter("test.use_astar", true),
       rclcpp::Parameter("test.allow_unknown", true),
-      rclcpp::Parameter("test.use_final_approach_orientation", true)});
+      rclcpp::Parameter("test.use_final_approach_orientation", true),
+      rclcpp::Parameter("test.use_fast_sweeping", true),
+      rclcpp::Parameter("test.reuse_goal_potential", true)});
 
   rclcpp::spin_until_future_complete(
     node->get_node_base_interface(),
@@ -61,4 +63,6 @@ TEST(NavfnTest, testDynamicParameter)
   EXPECT_EQ(node->get_parameter("test.use_astar").as_bool(), true);
   EXPECT_EQ(node->get_parameter("test.allow_unknown").as_bool(), true);
   EXPECT_EQ(node->get_parameter("test.use_final_approach_orientation").as_bool(), true);
+  EXPECT_EQ(node->get_parameter("test.use_fast_sweeping").as_bool(), true);
+  EXPECT_EQ(node->get_parameter("test.reuse_goal_potential").as_bool(), true);
 }
@@ -0,0 +1,164 @@
+// Copyright (c) 2022, Samsung Research America
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License. Reserved.
+
+#include <algorithm>
+#include <vector>
+
+#include "gtest/gtest.h"
+#include "nav2_navfn_planner/navfn.hpp"
+
+using nav2_navfn_planner::NavFn;
+
+// A map larger than a sweep tile, with a wall to go around and an inflated obstacle
+static std::vector<COSTTYPE> makeCostmap(int nx, int ny)
+{
+  std::vector<COSTTYPE> costmap(nx * ny, 0);
+  for (int y = 0; y < ny - 30; y++) {
+    costmap[y * nx + nx / 2] = COST_OBS;
+  }
+  for (int y = 0; y < ny; y++) {
+    for (int x = 0; x < nx; x++) {
+      const int d2 = (x - 30) * (x - 30) + (y - 100) * (y - 100);
+      if (d2 < 100) {
+        costmap[y * nx + x] = COST_OBS;
+      } else if (d2 < 400) {
+        costmap[y * nx + x] = std::max<COSTTYPE>(costmap[y * nx + x], 150);
+      }
+    }
+  }
+  return costmap;
+}
+
+static void setupNavFn(NavFn & navfn, const std::vector<COSTTYPE> & costmap)
+{
+  int goal[2] = {10, 10};
+  int start[2] = {navfn.nx - 10, 10};
+  navfn.setCostmap(costmap.data(), true, true);
+  navfn.setGoal(goal);
+  navfn.setStart(start);
+}
+
+TEST(NavfnTest, testSweepMatchesDijkstra)
+{
+  const int nx = 150, ny = 130;
+  const std::vector<COSTTYPE> costmap = makeCostmap(nx, ny);
+
+  NavFn dijkstra(nx, ny);
+  setupNavFn(dijkstra, costmap);
+  EXPECT_TRUE(dijkstra.calcNavFnDijkstra(false));
+
+  for (unsigned int threads : {1u, 3u}) {
+    NavFn sweep(nx, ny);
+    sweep.setSweepThreads(threads);
+    setupNavFn(sweep, costmap);
+    EXPECT_TRUE(sweep.calcNavFnSweep());
+
+    // The same cells are reached, with about the same potentials
+    for (int i = 0; i < nx * ny; i++) {
+      ASSERT_EQ(dijkstra.potarr[i] < POT_HIGH, sweep.potarr[i] < POT_HIGH) << "cell " << i;
+      if (sweep.potarr[i] < POT_HIGH) {
+        EXPECT_NEAR(sweep.potarr[i], dijkstra.potarr[i], 0.05 * dijkstra.potarr[i] + 1.0);
+      }
+    }
+
+    // and the path goes around the wall to the goal
+    const int len = sweep.calcPath(nx * ny / 2);
+    ASSERT_GT(len, 0);
+    EXPECT_NEAR(sweep.getPathX()[len - 1], 10.0, 1.0);
+    EXPECT_NEAR(sweep.getPathY()[len - 1], 10.0, 1.0);
+    EXPECT_GT(*std::max_element(sweep.getPathY(), sweep.getPathY() + len), ny - 31);
+  }
+}
+
+TEST(NavfnTest, testSweepUnreachableStart)
+{
+  const int nx = 100, ny = 100;
+  std::vector<COSTTYPE> costmap(nx * ny, 0);
+  for (int y = 0; y < ny; y++) {
+    costmap[y * nx + nx / 2] = COST_OBS;
+  }
+
+  NavFn sweep(nx, ny);
+  setupNavFn(sweep, costmap);
+  EXPECT_FALSE(sweep.calcNavFnSweep());
+  EXPECT_GE(sweep.getLastPathCost(), POT_HIGH);
+}
+
+TEST(NavfnTest, testGoalPotentialServesManyStarts)
+{
+  const int nx = 150, ny = 130;
+  const std::vector<COSTTYPE> costmap = makeCostmap(nx, ny);
+
+  // The potential is propagated once from the goal over the whole map
+  NavFn navfn(nx, ny);
+  setupNavFn(navfn, costmap);
+  navfn.calcNavFnDijkstra(false);
+
+  // and any start reaching it descends to the goal, if need be around the wall
+  const int starts[][2] = {{nx - 10, 10}, {nx - 20, ny - 10}, {40, 60}, {30, 120}};
+  for (const auto & cell : starts) {
+    int start[2] = {cell[0], cell[1]};
+    EXPECT_LT(navfn.potarr[start[1] * nx + start[0]], POT_HIGH);
+    navfn.setStart(start);
+    const int len = navfn.calcPath(nx * ny / 2);
+    ASSERT_GT(len, 0);
+    EXPECT_NEAR(navfn.getPathX()[0], start[0], 1.0);
+    EXPECT_NEAR(navfn.getPathY()[0], start[1], 1.0);
+    EXPECT_NEAR(navfn.getPathX()[len - 1], 10.0, 1.0);
+    EXPECT_NEAR(navfn.getPathY()[len - 1], 10.0, 1.0);
+  }
+}
+
+TEST(NavfnTest, testCostWindowMatchesFullTranslation)
+{
+  const int nx = 150, ny = 130;
+  std::vector<COSTTYPE> costmap = makeCostmap(nx, ny);
+
+  NavFn navfn(nx, ny);
+  navfn.setCostmap(costmap.data(), true, true);
+
+  // Only the window changed is translated again, clipped to the map
+  for (int y = 40; y < 60; y++) {
+    for (int x = 120; x < nx; x++) {
+      costmap[y * nx + x] = y == 50 ? COST_UNKNOWN_ROS : 200;
+    }
+  }
+  navfn.setCostmapWindow(costmap.data(), 120, 40, nx + 10, 60, true);
+
+  NavFn full(nx, ny);
+  full.setCostmap(costmap.data(), true, true);
+  for (int i = 0; i < nx * ny; i++) {
+    ASSERT_EQ(navfn.costarr[i], full.costarr[i]) << "cell " << i;
+  }
+
+  // The arrays are kept for a smaller map, which plans as a new planner would
+  const int sx = 100, sy = 120;
+  const std::vector<COSTTYPE> smaller = makeCostmap(sx, sy);
+  navfn.setNavArr(sx, sy);
+  EXPECT_EQ(navfn.nsbuf, nx * ny);
+  setupNavFn(navfn, smaller);
+  NavFn fresh(sx, sy);
+  setupNavFn(fresh, smaller);
+  EXPECT_GT(navfn.getMemoryUsage(), fresh.getMemoryUsage());
+  EXPECT_TRUE(navfn.calcNavFnDijkstra(true));
+  EXPECT_TRUE(fresh.calcNavFnDijkstra(true));
+
+  const int len = navfn.calcPath(sx * sy / 2);
+  ASSERT_GT(len, 0);
+  ASSERT_EQ(len, fresh.calcPath(sx * sy / 2));
+  for (int i = 0; i < len; i++) {
+    EXPECT_FLOAT_EQ(navfn.getPathX()[i], fresh.getPathX()[i]);
+    EXPECT_FLOAT_EQ(navfn.getPathY()[i], fresh.getPathY()[i]);
+  }
+}
@@ -0,0 +1,81 @@
+// Copyright (c) 2022 Samsung Research America
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef NAV2_PLANNER__LAZY_PLANNER_HPP_
+#define NAV2_PLANNER__LAZY_PLANNER_HPP_
+
+#include <functional>
+#include <memory>
+#include <string>
+
+#include "nav2_core/global_planner.hpp"
+#include "nav2_util/lazy_plugin.hpp"
+
+namespace nav2_planner
+{
+
+/**
+ * @class nav2_planner::LazyPlanner
+ * @brief A planner plugin standing in for another one, which it only loads and configures
+ * on its first plan, and unloads once unused for a while if set to
+ */
+class LazyPlanner : public nav2_core::GlobalPlanner
+{
+public:
+  using Clock = nav2_util::LazyPlugin<nav2_core::GlobalPlanner>::Clock;
+
+  /**
+   * @brief A constructor for nav2_planner::LazyPlanner
+   * @param create Function creating an instance of the planner plugin
+   * @param unload_timeout Time without plans after which the planner is unloaded, never if zero
+   */
+  LazyPlanner(
+    std::function<nav2_core::GlobalPlanner::Ptr()> create,
+    Clock::duration unload_timeout);
+
+  void configure(
+    const rclcpp_lifecycle::LifecycleNode::WeakPtr & parent,
+    std::string name, std::shared_ptr<tf2_ros::Buffer> tf,
+    std::shared_ptr<nav2_costmap_2d::Costmap2DROS> costmap_ros) override;
+  void cleanup() override;
+  void activate() override;
+  void deactivate() override;
+  nav_msgs::msg::Path createPlan(
+    const geometry_msgs::msg::PoseStamped & start,
+    const geometry_msgs::msg::PoseStamped & goal) override;
+  nav_msgs::msg::Path createPlan(
+    const geometry_msgs::msg::PoseStamped & start,
+    const geometry_msgs::msg::PoseStamped & goal,
+    std::function<bool()> cancel_checker) override;
+
+  /**
+   * @brief Load the planner ahead of its first plan
+   */
+  void warm();
+
+  /**
+   * @brief Unload the planner if unused since the unload timeout
+   * @return True if the planner was unloaded
+   */
+  bool unloadIfIdle();
+
+protected:
+  std::function<nav2_core::GlobalPlanner::Ptr()> create_;
+  Clock::duration unload_timeout_;
+  std::unique_ptr<nav2_util::LazyPlugin<nav2_core::GlobalPlanner>> planner_;
+};
+
+}  // namespace nav2_planner
+
+#endif  // NAV2_PLANNER__LAZY_PLANNER_HPP_
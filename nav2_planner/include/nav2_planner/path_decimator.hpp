@@ -0,0 +1,61 @@
+// Copyright (c) 2022 Samsung Research America
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+
+#ifndef NAV2_PLANNER__PATH_DECIMATOR_HPP_
+#define NAV2_PLANNER__PATH_DECIMATOR_HPP_
+
+#include "nav_msgs/msg/path.hpp"
+
+namespace nav2_planner
+{
+
+/**
+ * @class nav2_planner::PathDecimator
+ * @brief Drops the poses of paths planned at costmap resolution that the segments between
+ * the poses kept pass within a tolerance of. Straight stretches keep a pose every
+ * max_spacing, while curves keep more of them the sharper they are, the deviation of a
+ * chord growing with its length squared times the curvature.
+ */
+class PathDecimator
+{
+public:
+  /**
+   * @brief A constructor for nav2_planner::PathDecimator
+   * @param tolerance Distance the poses dropped may be from the segments between those kept
+   * @param max_spacing Length of the segments between the poses kept above which they are
+   * not extended, 0 for no limit
+   */
+  PathDecimator(double tolerance, double max_spacing);
+
+  /**
+   * @brief Decimate a path, keeping its ends and the cusps where it reverses
+   * @param path Path to decimate in place
+   */
+  void decimate(nav_msgs::msg::Path & path) const;
+
+protected:
+  /**
+   * @brief Whether the poses between two poses of a path are all within the tolerance of the
+   * segment between them
+   */
+  bool isWithinTolerance(const nav_msgs::msg::Path & path, size_t first, size_t last) const;
+
+  double tolerance_;
+  double max_spacing_;
+};
+
+}  // namespace nav2_planner
+
+#endif  // NAV2_PLANNER__PATH_DECIMATOR_HPP_
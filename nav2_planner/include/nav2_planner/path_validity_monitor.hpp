@@ -0,0 +1,129 @@
+// Copyright (c) 2022 Samsung Research America
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef NAV2_PLANNER__PATH_VALIDITY_MONITOR_HPP_
+#define NAV2_PLANNER__PATH_VALIDITY_MONITOR_HPP_
+
+#include <cstdint>
+#include <deque>
+#include <vector>
+
+#include "geometry_msgs/msg/point.hpp"
+#include "nav_msgs/msg/path.hpp"
+#include "nav2_costmap_2d/layered_costmap.hpp"
+
+namespace nav2_planner
+{
+
+/**
+ * @class nav2_planner::PathValidityMonitor
+ * @brief Checks registered paths against the costmap. The cells swept by the footprint
+ * along a path are computed once, then only those in the windows changed by the costmap
+ * updates since the last check of the path are checked again. A pose is invalid when its
+ * center cell is lethal or inscribed, or a cell of its footprint is lethal, the footprint
+ * and center being swept up to the next pose for poses further apart than a cell.
+ */
+class PathValidityMonitor
+{
+public:
+  /**
+   * @brief A constructor for nav2_planner::PathValidityMonitor
+   * @param layered_costmap Costmap to check the paths against, outliving the monitor
+   * @param max_paths Number of paths kept registered, the oldest being dropped beyond it
+   */
+  PathValidityMonitor(nav2_costmap_2d::LayeredCostmap * layered_costmap, unsigned int max_paths);
+
+  /**
+   * @brief Register a path to check. Its cells are computed on its first check.
+   * @param path Path, in the frame of the costmap
+   * @return Identifier of the path, never 0
+   */
+  unsigned int registerPath(const nav_msgs::msg::Path & path);
+
+  /**
+   * @brief Get a registered path
+   * @param path_id Identifier of the path
+   * @return The path, or nullptr if it is not registered (anymore)
+   */
+  const nav_msgs::msg::Path * getPath(unsigned int path_id) const;
+
+  /**
+   * @brief Check a registered path, with the costmap mutex held while doing so
+   * @param path_id Identifier of the path
+   * @param footprint Footprint of the robot, the cells of the path being computed
+   * again if it changed since the last check
+   * @param start_index Index of the first pose to report, e.g. the closest to the robot
+   * @param invalid_pose_indices Set to the indices of the invalid poses from start_index on
+   * @return False if the path is not registered
+   */
+  bool checkPath(
+    unsigned int path_id,
+    const std::vector<geometry_msgs::msg::Point> & footprint,
+    unsigned int start_index,
+    std::vector<int> & invalid_pose_indices);
+
+  /**
+   * @brief Unregister all of the paths
+   */
+  void clear();
+
+protected:
+  struct PathCell
+  {
+    unsigned int index;
+    unsigned int pose;
+    bool center;
+    bool blocked;
+  };
+
+  struct MonitoredPath
+  {
+    unsigned int id;
+    nav_msgs::msg::Path path;
+    std::vector<geometry_msgs::msg::Point> footprint;
+    bool computed{false};
+    uint64_t update_count{0};
+    // Cells swept by the path, sorted by index
+    std::vector<PathCell> cells;
+    // Number of blocked cells of each pose
+    std::vector<unsigned int> blocked_cells;
+  };
+
+  /**
+   * @brief Rasterize the footprint along the path and check all of its cells
+   */
+  void computeCells(MonitoredPath & path);
+
+  /**
+   * @brief Check again the cells of the path in a window of the costmap
+   */
+  void checkWindow(
+    MonitoredPath & path, unsigned int x0, unsigned int y0,
+    unsigned int xn, unsigned int yn);
+
+  /**
+   * @brief Check a cell of the path, counting it in the blocked cells of its pose
+   */
+  void checkCell(MonitoredPath & path, PathCell & cell);
+
+  nav2_costmap_2d::LayeredCostmap * layered_costmap_;
+  unsigned int max_paths_;
+  unsigned int next_id_;
+  std::deque<MonitoredPath> paths_;
+  std::vector<nav2_costmap_2d::LayeredCostmap::ChangedWindow> windows_;
+};
+
+}  // namespace nav2_planner
+
+#endif  // NAV2_PLANNER__PATH_VALIDITY_MONITOR_HPP_
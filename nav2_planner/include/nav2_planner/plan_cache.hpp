@@ -0,0 +1,166 @@
+// Copyright (c) 2022 Samsung Research America
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef NAV2_PLANNER__PLAN_CACHE_HPP_
+#define NAV2_PLANNER__PLAN_CACHE_HPP_
+
+#include <cstdint>
+#include <list>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#include "geometry_msgs/msg/pose_stamped.hpp"
+#include "nav_msgs/msg/path.hpp"
+#include "nav2_costmap_2d/layered_costmap.hpp"
+
+namespace nav2_planner
+{
+
+/**
+ * @class nav2_planner::PlanCache
+ * @brief Keeps the most recently used plans, by planner and by the costmap cells and heading
+ * bins of their start and goal, so that repeated requests are answered without planning. A
+ * plan is dropped once a costmap update changed a cell within the circumscribed radius of
+ * the footprint of those it crosses, or the whole costmap may have changed, such as when it
+ * is resized or moved.
+ */
+class PlanCache
+{
+public:
+  /**
+   * @brief Hits and misses of the lookups, the misses counting the plans found invalid
+   */
+  struct Statistics
+  {
+    uint64_t hits{0};
+    uint64_t misses{0};
+    uint64_t invalidations{0};
+  };
+
+  /**
+   * @brief A constructor for nav2_planner::PlanCache
+   * @param layered_costmap Costmap the plans are planned on, outliving the cache
+   * @param max_plans Number of plans kept, the least recently used being dropped beyond it
+   * @param heading_bins Number of bins the headings of the starts and goals are split into
+   */
+  PlanCache(
+    nav2_costmap_2d::LayeredCostmap * layered_costmap, unsigned int max_plans,
+    unsigned int heading_bins);
+
+  /**
+   * @brief Get the update count of the costmap to insert a plan planned from now with
+   */
+  uint64_t getUpdateCount() const;
+
+  /**
+   * @brief Look up the plan of a planner between poses, checking it against the costmap
+   * @param planner_id Planner of the plan
+   * @param start Start pose, in the frame of the costmap
+   * @param goal Goal pose, in the frame of the costmap
+   * @param path Set to the plan, with its ends moved to the start and goal
+   * @return False if no valid plan is cached
+   */
+  bool lookup(
+    const std::string & planner_id,
+    const geometry_msgs::msg::PoseStamped & start,
+    const geometry_msgs::msg::PoseStamped & goal,
+    nav_msgs::msg::Path & path);
+
+  /**
+   * @brief Insert the plan of a planner between poses
+   * @param planner_id Planner of the plan
+   * @param start Start pose, in the frame of the costmap
+   * @param goal Goal pose, in the frame of the costmap
+   * @param path Plan, not cached if empty
+   * @param update_count Update count of the costmap from before the plan was planned
+   */
+  void insert(
+    const std::string & planner_id,
+    const geometry_msgs::msg::PoseStamped & start,
+    const geometry_msgs::msg::PoseStamped & goal,
+    const nav_msgs::msg::Path & path,
+    uint64_t update_count);
+
+  /**
+   * @brief Drop all of the plans
+   */
+  void clear();
+
+  /**
+   * @brief Get the hits and misses of the lookups so far
+   */
+  Statistics getStatistics() const;
+
+protected:
+  struct Key
+  {
+    std::string planner_id;
+    unsigned int start_index, start_bin, goal_index, goal_bin;
+
+    bool operator==(const Key & other) const
+    {
+      return start_index == other.start_index && goal_index == other.goal_index &&
+             start_bin == other.start_bin && goal_bin == other.goal_bin &&
+             planner_id == other.planner_id;
+    }
+  };
+
+  struct KeyHash
+  {
+    size_t operator()(const Key & key) const;
+  };
+
+  struct CachedPlan
+  {
+    Key key;
+    nav_msgs::msg::Path path;
+    uint64_t update_count;
+    // Indices of the cells crossed by the plan, sorted
+    std::vector<unsigned int> cells;
+  };
+
+  /**
+   * @brief Make the key of the poses, with the costmap mutex held
+   * @return False if a pose is off the costmap
+   */
+  bool makeKey(
+    const std::string & planner_id,
+    const geometry_msgs::msg::PoseStamped & start,
+    const geometry_msgs::msg::PoseStamped & goal,
+    Key & key) const;
+
+  /**
+   * @brief Check that the costmap updates since the plan was checked changed no cell within
+   * the circumscribed radius of its cells, with the costmap mutex held
+   */
+  bool isValid(CachedPlan & plan);
+
+  nav2_costmap_2d::LayeredCostmap * layered_costmap_;
+  unsigned int max_plans_;
+  unsigned int heading_bins_;
+
+  // Plans from the most to the least recently used, and their positions by key
+  std::list<CachedPlan> plans_;
+  std::unordered_map<Key, std::list<CachedPlan>::iterator, KeyHash> index_;
+  std::vector<nav2_costmap_2d::LayeredCostmap::ChangedWindow> windows_;
+  Statistics statistics_;
+  mutable std::mutex mutex_;
+};
+
+}  // namespace nav2_planner
+
+#endif  // NAV2_PLANNER__PLAN_CACHE_HPP_
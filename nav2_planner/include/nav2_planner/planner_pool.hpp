@@ -0,0 +1,182 @@
+// Copyright (c) 2022 Samsung Research America
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef NAV2_PLANNER__PLANNER_POOL_HPP_
+#define NAV2_PLANNER__PLANNER_POOL_HPP_
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+#include "geometry_msgs/msg/pose_stamped.hpp"
+#include "nav_msgs/msg/path.hpp"
+#include "nav2_core/global_planner.hpp"
+
+namespace nav2_planner
+{
+
+/**
+ * @class nav2_planner::PlannerPool
+ * @brief Worker threads planning queued requests concurrently, each with its own
+ * instances of the planner plugins, since plugins are stateful. The instances of a plugin
+ * sharing state between them, such as static members, must serialize it themselves
+ */
+class PlannerPool
+{
+public:
+  using PlannerMap = std::unordered_map<std::string, nav2_core::GlobalPlanner::Ptr>;
+  using CancelChecker = std::function<bool()>;
+  using PlanFunction = std::function<nav_msgs::msg::Path(
+        PlannerMap &, const geometry_msgs::msg::PoseStamped &,
+        const geometry_msgs::msg::PoseStamped &, const std::string &, CancelChecker)>;
+
+  /**
+   * @brief A constructor for nav2_planner::PlannerPool, starting a worker for each planner map
+   * @param planners The planner instances of each worker, only used by that worker
+   * @param plan Function planning a request with the planners of a worker, giving up once
+   * its cancel checker returns true if the planner can be interrupted
+   */
+  PlannerPool(std::vector<PlannerMap> planners, PlanFunction plan);
+
+  /**
+   * @brief A destructor for nav2_planner::PlannerPool, stopping the workers once the queued
+   * requests are planned
+   */
+  ~PlannerPool();
+
+  /**
+   * @brief Plan from each start to its goal on the workers, blocking until all are planned.
+   * Can be called from several threads at once, whose requests are queued in order.
+   * @param starts Start poses
+   * @param goals Goal poses, one for each start
+   * @param planner_id The planner to use
+   * @return Paths in the order of the goals, empty for the ones that failed
+   */
+  std::vector<nav_msgs::msg::Path> plan(
+    const std::vector<geometry_msgs::msg::PoseStamped> & starts,
+    const std::vector<geometry_msgs::msg::PoseStamped> & goals,
+    const std::string & planner_id);
+
+  /**
+   * @brief Result of a race between planners
+   */
+  struct RaceResult
+  {
+    nav_msgs::msg::Path path;
+    std::string planner_id;
+  };
+
+  /**
+   * @brief Plan from start to goal with each of the planners concurrently on the workers.
+   * Without deadline, returns the first valid path. With a deadline, returns the shortest
+   * path found by then, or else the first one found after it. The planners which did not
+   * start yet are dropped once the race is decided, the ones planning are cancelled, so that
+   * the workers are free for the next requests.
+   * @param start Start pose
+   * @param goal Goal pose
+   * @param planner_ids The planners to race
+   * @param deadline Time to wait for the shortest path, zero to take the first path
+   * @return The path found, empty if all of the planners failed, and its planner
+   */
+  RaceResult race(
+    const geometry_msgs::msg::PoseStamped & start,
+    const geometry_msgs::msg::PoseStamped & goal,
+    const std::vector<std::string> & planner_ids,
+    std::chrono::nanoseconds deadline);
+
+  /**
+   * @brief Get the planner instances of each worker, e.g. to activate them. They must not
+   * be used while plans are computed.
+   */
+  std::vector<PlannerMap> & getPlanners()
+  {
+    return planners_;
+  }
+
+  /**
+   * @brief Get the number of workers
+   */
+  size_t size() const
+  {
+    return workers_.size();
+  }
+
+protected:
+  // A batch of requests waited for together
+  struct Batch
+  {
+    size_t remaining;
+    std::condition_variable done;
+  };
+
+  // A race, which may be decided before all of its requests are planned
+  struct Race
+  {
+    geometry_msgs::msg::PoseStamped start;
+    geometry_msgs::msg::PoseStamped goal;
+    std::vector<std::string> planner_ids;
+    std::vector<nav_msgs::msg::Path> paths;
+    std::vector<bool> planned;
+    size_t remaining;
+    // Also read by the planners losing the race, without the mutex, to give up
+    std::atomic<bool> decided;
+    std::condition_variable done;
+  };
+
+  // A request of a batch, which is held until its path is computed, or of a race
+  struct Request
+  {
+    const geometry_msgs::msg::PoseStamped * start;
+    const geometry_msgs::msg::PoseStamped * goal;
+    const std::string * planner_id;
+    nav_msgs::msg::Path * path;
+    Batch * batch;
+    std::shared_ptr<Race> race;
+    size_t race_index;
+  };
+
+  /**
+   * @brief Get the shortest path planned in a race so far, with mutex_ locked
+   * @param race The race
+   * @return The shortest path and its planner, an empty path if none was found
+   */
+  static RaceResult shortestPath(const Race & race);
+
+  /**
+   * @brief Loop of a worker, planning requests from the queue until stopped
+   * @param worker Index of the worker and its planners
+   */
+  void work(size_t worker);
+
+  std::vector<PlannerMap> planners_;
+  PlanFunction plan_;
+  std::vector<std::thread> workers_;
+
+  std::mutex mutex_;
+  std::condition_variable request_cv_;
+  std::deque<Request> requests_;
+  bool stop_;
+};
+
+}  // namespace nav2_planner
+
+#endif  // NAV2_PLANNER__PLANNER_POOL_HPP_
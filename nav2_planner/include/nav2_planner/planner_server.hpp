@@ -16,15 +16,19 @@
 #define NAV2_PLANNER__PLANNER_SERVER_HPP_
 
 #include <chrono>
+#include <functional>
 #include <string>
 #include <memory>
 #include <vector>
 #include <unordered_map>
 #include <mutex>
+#include <thread>
 
+#include "builtin_interfaces/msg/duration.hpp"
 #include "geometry_msgs/msg/point.hpp"
 #include "geometry_msgs/msg/pose_stamped.hpp"
 #include "nav_msgs/msg/path.hpp"
+#include "nav2_util/instrumentation.hpp"
 #include "nav2_util/lifecycle_node.hpp"
 #include "nav2_msgs/action/compute_path_to_pose.hpp"
 #include "nav2_msgs/action/compute_path_through_poses.hpp"
@@ -39,6 +43,12 @@
 #include "pluginlib/class_list_macros.hpp"
 #include "nav2_core/global_planner.hpp"
 #include "nav2_msgs/srv/is_path_valid.hpp"
+#include "nav2_msgs/srv/compute_paths.hpp"
+#include "nav2_planner/lazy_planner.hpp"
+#include "nav2_planner/path_decimator.hpp"
+#include "nav2_planner/path_validity_monitor.hpp"
+#include "nav2_planner/plan_cache.hpp"
+#include "nav2_planner/planner_pool.hpp"
 
 namespace nav2_planner
 {
@@ -74,6 +84,36 @@ public:
     const std::string & planner_id);
 
 protected:
+  /**
+   * @brief Method to get plan from the desired plugin among the given planners
+   * @param planners Planners to choose from
+   * @param start starting pose
+   * @param goal goal request
+   * @param planner_id The planner to use
+   * @param cancel_checker Function returning true once the plan is no longer wanted, if any
+   * @return Path
+   */
+  nav_msgs::msg::Path getPlan(
+    PlannerMap & planners,
+    const geometry_msgs::msg::PoseStamped & start,
+    const geometry_msgs::msg::PoseStamped & goal,
+    const std::string & planner_id,
+    const std::function<bool()> & cancel_checker);
+
+  /**
+   * @brief Create a plan with a planner, decimating it if path_decimation_tolerance > 0
+   * @param planner The planner to use
+   * @param start starting pose
+   * @param goal goal request
+   * @param cancel_checker Function returning true once the plan is no longer wanted, if any
+   * @return Path
+   */
+  nav_msgs::msg::Path createPlan(
+    nav2_core::GlobalPlanner & planner,
+    const geometry_msgs::msg::PoseStamped & start,
+    const geometry_msgs::msg::PoseStamped & goal,
+    const std::function<bool()> & cancel_checker);
+
   /**
    * @brief Configure member variables and initializes planner
    * @param state Reference to LifeCycle node state
@@ -201,6 +241,23 @@ protected:
    */
   void computePlanThroughPoses();
 
+  /**
+   * @brief Plan with several planners concurrently on the planner pool, keeping the first
+   * path or the shortest one within the deadline. Without a pool, the planners are tried in
+   * turn until one finds a path.
+   * @param start starting pose
+   * @param goal goal pose
+   * @param planner_ids The planners to race
+   * @param deadline Time to wait for the shortest path, zero to take the first path
+   * @param result Result to set the path and the planner which computed it in
+   */
+  void racePlanners(
+    const geometry_msgs::msg::PoseStamped & start,
+    const geometry_msgs::msg::PoseStamped & goal,
+    const std::vector<std::string> & planner_ids,
+    const builtin_interfaces::msg::Duration & deadline,
+    ActionToPose::Result & result);
+
   /**
    * @brief The service callback to determine if the path is still valid
    * @param request to the service
@@ -210,6 +267,29 @@ protected:
     const std::shared_ptr<nav2_msgs::srv::IsPathValid::Request> request,
     std::shared_ptr<nav2_msgs::srv::IsPathValid::Response> response);
 
+  /**
+   * @brief The service callback to compute the paths of a batch of requests, with the
+   * planner pool if there is one
+   * @param request to the service
+   * @param response from the service
+   */
+  void computePaths(
+    const std::shared_ptr<nav2_msgs::srv::ComputePaths::Request> request,
+    std::shared_ptr<nav2_msgs::srv::ComputePaths::Response> response);
+
+  /**
+   * @brief Create an instance of a planner plugin, or its stand-in until its first plan if the
+   * planner is lazy
+   * @param index Index of the planner in planner_ids_
+   * @return The planner, not configured yet
+   */
+  nav2_core::GlobalPlanner::Ptr createPlanner(size_t index);
+
+  /**
+   * @brief Start loading the lazy planners set to warm up, and the timer unloading the idle ones
+   */
+  void startLazyPlanners();
+
   /**
    * @brief Publish a path for visualization purposes
    * @param path Reference to Global Path
@@ -237,6 +317,25 @@ protected:
   double max_planner_duration_;
   std::string planner_ids_concat_;
 
+  // Pool of planner instances for batch planning, if planner_pool_size > 0
+  std::unique_ptr<PlannerPool> planner_pool_;
+
+  // Whether to plan the segments of paths through poses concurrently with the planner pool
+  bool parallel_segment_planning_;
+
+  // Planners loaded on their first plan, whether to load them in the background once active,
+  // the thread doing so and the timer unloading the idle ones
+  struct Lazy
+  {
+    std::string id;
+    std::shared_ptr<LazyPlanner> planner;
+    bool warmup;
+  };
+  std::vector<Lazy> lazy_planners_;
+  std::mutex loader_mutex_;
+  std::thread warmup_thread_;
+  rclcpp::TimerBase::SharedPtr lazy_unload_timer_;
+
   // Clock
   rclcpp::Clock steady_clock_{RCL_STEADY_TIME};
 
@@ -248,11 +347,28 @@ protected:
   std::unique_ptr<nav2_util::NodeThread> costmap_thread_;
   nav2_costmap_2d::Costmap2D * costmap_;
 
+  // Paths registered by the is_path_valid service, checked incrementally
+  std::unique_ptr<PathValidityMonitor> path_validity_monitor_;
+
+  // Recent plans answering repeated requests, if plan_cache_size > 0
+  std::unique_ptr<PlanCache> plan_cache_;
+
+  // Decimates the plans, if path_decimation_tolerance > 0
+  std::unique_ptr<PathDecimator> path_decimator_;
+
   // Publishers for the path
   rclcpp_lifecycle::LifecyclePublisher<nav_msgs::msg::Path>::SharedPtr plan_publisher_;
 
+  // Publishes the measurements of the probes of the planning stages
+  std::unique_ptr<nav2_util::InstrumentationPublisher> instrumentation_publisher_;
+
   // Service to deterime if the path is valid
   rclcpp::Service<nav2_msgs::srv::IsPathValid>::SharedPtr is_path_valid_service_;
+
+  // Service to compute a batch of paths, in its own thread not to hold up the action servers
+  rclcpp::Service<nav2_msgs::srv::ComputePaths>::SharedPtr compute_paths_service_;
+  rclcpp::CallbackGroup::SharedPtr compute_paths_callback_group_;
+  std::unique_ptr<nav2_util::NodeThread> compute_paths_thread_;
 };
 
 }  // namespace nav2_planner
@@ -0,0 +1,91 @@
+// Copyright (c) 2022 Samsung Research America
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <memory>
+#include <string>
+#include <utility>
+
+#include "nav2_planner/lazy_planner.hpp"
+
+namespace nav2_planner
+{
+
+LazyPlanner::LazyPlanner(
+  std::function<nav2_core::GlobalPlanner::Ptr()> create,
+  Clock::duration unload_timeout)
+: create_(std::move(create)), unload_timeout_(unload_timeout)
+{
+}
+
+void LazyPlanner::configure(
+  const rclcpp_lifecycle::LifecycleNode::WeakPtr & parent,
+  std::string name, std::shared_ptr<tf2_ros::Buffer> tf,
+  std::shared_ptr<nav2_costmap_2d::Costmap2DROS> costmap_ros)
+{
+  // The configuration is kept for the planner to be configured with once loaded
+  planner_ = std::make_unique<nav2_util::LazyPlugin<nav2_core::GlobalPlanner>>(
+    [this, parent, name, tf, costmap_ros]() {
+      nav2_core::GlobalPlanner::Ptr planner = create_();
+      planner->configure(parent, name, tf, costmap_ros);
+      return planner;
+    }, unload_timeout_);
+}
+
+void LazyPlanner::cleanup()
+{
+  planner_->cleanup();
+}
+
+void LazyPlanner::activate()
+{
+  planner_->activate();
+}
+
+void LazyPlanner::deactivate()
+{
+  planner_->deactivate();
+}
+
+nav_msgs::msg::Path LazyPlanner::createPlan(
+  const geometry_msgs::msg::PoseStamped & start,
+  const geometry_msgs::msg::PoseStamped & goal)
+{
+  return planner_->use(
+    [&](nav2_core::GlobalPlanner & planner) {
+      return planner.createPlan(start, goal);
+    });
+}
+
+nav_msgs::msg::Path LazyPlanner::createPlan(
+  const geometry_msgs::msg::PoseStamped & start,
+  const geometry_msgs::msg::PoseStamped & goal,
+  std::function<bool()> cancel_checker)
+{
+  return planner_->use(
+    [&](nav2_core::GlobalPlanner & planner) {
+      return planner.createPlan(start, goal, cancel_checker);
+    });
+}
+
+void LazyPlanner::warm()
+{
+  planner_->warm();
+}
+
+bool LazyPlanner::unloadIfIdle()
+{
+  return planner_->unloadIfIdle();
+}
+
+}  // namespace nav2_planner
@@ -0,0 +1,89 @@
+// Copyright (c) 2022 Samsung Research America
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+
+#include "nav2_planner/path_decimator.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <utility>
+#include <vector>
+
+namespace nav2_planner
+{
+
+PathDecimator::PathDecimator(double tolerance, double max_spacing)
+: tolerance_(std::max(tolerance, 0.0)), max_spacing_(std::max(max_spacing, 0.0))
+{
+}
+
+bool PathDecimator::isWithinTolerance(
+  const nav_msgs::msg::Path & path, size_t first, size_t last) const
+{
+  const auto & a = path.poses[first].pose.position;
+  const auto & b = path.poses[last].pose.position;
+  const double dx = b.x - a.x, dy = b.y - a.y;
+  const double length_sq = dx * dx + dy * dy;
+  for (size_t i = first + 1; i < last; ++i) {
+    const auto & p = path.poses[i].pose.position;
+    const double px = p.x - a.x, py = p.y - a.y;
+
+    // Distance to the closest point of the segment
+    const double t = length_sq > 0.0 ?
+      std::clamp((px * dx + py * dy) / length_sq, 0.0, 1.0) : 0.0;
+    if (std::hypot(px - t * dx, py - t * dy) > tolerance_) {
+      return false;
+    }
+  }
+  return true;
+}
+
+void PathDecimator::decimate(nav_msgs::msg::Path & path) const
+{
+  const size_t size = path.poses.size();
+  if (size < 3) {
+    return;
+  }
+
+  // Each kept pose is extended to the furthest pose the segment to which is within the
+  // tolerance of the poses between them, with each pose checked against a growing segment
+  std::vector<size_t> kept{0};
+  size_t anchor = 0;
+  for (size_t i = 1; i + 1 < size; ++i) {
+    const auto & p = path.poses[i].pose.position;
+    const auto & prev = path.poses[i - 1].pose.position;
+    const auto & next = path.poses[i + 1].pose.position;
+
+    // Cusps are kept, as the controllers change direction on them
+    const bool cusp =
+      (p.x - prev.x) * (next.x - p.x) + (p.y - prev.y) * (next.y - p.y) < 0.0;
+    const auto & a = path.poses[anchor].pose.position;
+    const bool too_long = max_spacing_ > 0.0 &&
+      std::hypot(next.x - a.x, next.y - a.y) > max_spacing_;
+    if (cusp || too_long || !isWithinTolerance(path, anchor, i + 1)) {
+      kept.push_back(i);
+      anchor = i;
+    }
+  }
+  kept.push_back(size - 1);
+
+  for (size_t i = 0; i < kept.size(); ++i) {
+    if (i != kept[i]) {
+      path.poses[i] = std::move(path.poses[kept[i]]);
+    }
+  }
+  path.poses.resize(kept.size());
+}
+
+}  // namespace nav2_planner
@@ -0,0 +1,221 @@
+// Copyright (c) 2022 Samsung Research America
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "nav2_planner/path_validity_monitor.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <mutex>
+#include <random>
+#include <vector>
+
+#include "nav2_costmap_2d/cost_values.hpp"
+#include "nav2_costmap_2d/footprint.hpp"
+#include "tf2/utils.h"
+
+namespace nav2_planner
+{
+
+PathValidityMonitor::PathValidityMonitor(
+  nav2_costmap_2d::LayeredCostmap * layered_costmap, unsigned int max_paths)
+: layered_costmap_(layered_costmap),
+  max_paths_(std::max(max_paths, 1u)),
+  // Identifiers start anywhere, so clients of a previous monitor are unlikely to find
+  // their stale identifiers registered
+  next_id_(std::random_device()() | 1u)
+{
+}
+
+unsigned int PathValidityMonitor::registerPath(const nav_msgs::msg::Path & path)
+{
+  if (paths_.size() >= max_paths_) {
+    paths_.pop_front();
+  }
+
+  MonitoredPath monitored_path;
+  monitored_path.id = next_id_;
+  monitored_path.path = path;
+  paths_.push_back(std::move(monitored_path));
+
+  // 0 is never an identifier, as it stands for no path in requests
+  next_id_ = next_id_ == std::numeric_limits<unsigned int>::max() ? 1 : next_id_ + 1;
+  return paths_.back().id;
+}
+
+const nav_msgs::msg::Path * PathValidityMonitor::getPath(unsigned int path_id) const
+{
+  for (const auto & path : paths_) {
+    if (path.id == path_id) {
+      return &path.path;
+    }
+  }
+  return nullptr;
+}
+
+bool PathValidityMonitor::checkPath(
+  unsigned int path_id,
+  const std::vector<geometry_msgs::msg::Point> & footprint,
+  unsigned int start_index,
+  std::vector<int> & invalid_pose_indices)
+{
+  invalid_pose_indices.clear();
+  auto path = std::find_if(
+    paths_.begin(), paths_.end(),
+    [path_id](const MonitoredPath & monitored_path) {return monitored_path.id == path_id;});
+  if (path == paths_.end()) {
+    return false;
+  }
+
+  nav2_costmap_2d::Costmap2D * costmap = layered_costmap_->getCostmap();
+  std::unique_lock<nav2_costmap_2d::Costmap2D::mutex_t> lock(*(costmap->getMutex()));
+
+  // The cells swept are only valid as long as the costmap did not resize or move and the
+  // footprint is the same, in which case only the windows changed since need a check
+  if (!path->computed || path->footprint != footprint ||
+    !layered_costmap_->getChangedWindows(path->update_count, windows_))
+  {
+    path->footprint = footprint;
+    computeCells(*path);
+  } else {
+    for (const auto & window : windows_) {
+      checkWindow(*path, window.x0, window.y0, window.xn, window.yn);
+    }
+  }
+  path->update_count = layered_costmap_->getUpdateCount();
+
+  for (unsigned int i = start_index; i < path->blocked_cells.size(); ++i) {
+    if (path->blocked_cells[i] > 0) {
+      invalid_pose_indices.push_back(static_cast<int>(i));
+    }
+  }
+  return true;
+}
+
+void PathValidityMonitor::clear()
+{
+  paths_.clear();
+}
+
+void PathValidityMonitor::computeCells(MonitoredPath & path)
+{
+  nav2_costmap_2d::Costmap2D * costmap = layered_costmap_->getCostmap();
+  const auto & poses = path.path.poses;
+  path.cells.clear();
+  path.blocked_cells.assign(poses.size(), 0);
+
+  std::vector<geometry_msgs::msg::Point> oriented_footprint;
+  std::vector<nav2_costmap_2d::MapLocation> polygon, polygon_cells;
+  auto add_cells = [&](unsigned int i, double x, double y, double yaw) {
+      unsigned int mx, my;
+      if (costmap->worldToMap(x, y, mx, my)) {
+        path.cells.push_back({costmap->getIndex(mx, my), i, true, false});
+      }
+
+      if (path.footprint.size() < 3) {
+        return;
+      }
+      nav2_costmap_2d::transformFootprint(x, y, yaw, path.footprint, oriented_footprint);
+      // Vertices off the costmap are clamped to its edges, keeping the cells on it convex
+      polygon.clear();
+      for (const auto & point : oriented_footprint) {
+        int cell_x, cell_y;
+        costmap->worldToMapEnforceBounds(point.x, point.y, cell_x, cell_y);
+        polygon.push_back({static_cast<unsigned int>(cell_x), static_cast<unsigned int>(cell_y)});
+      }
+      polygon_cells.clear();
+      costmap->convexFillCells(polygon, polygon_cells);
+      for (const auto & cell : polygon_cells) {
+        path.cells.push_back({costmap->getIndex(cell.x, cell.y), i, false, false});
+      }
+    };
+
+  // The footprint moves by up to its farthest vertex from the center times the turn
+  double radius = 0.0;
+  for (const auto & point : path.footprint) {
+    radius = std::max(radius, std::hypot(point.x, point.y));
+  }
+
+  for (unsigned int i = 0; i != poses.size(); ++i) {
+    const auto & pose = poses[i].pose;
+    const double yaw = tf2::getYaw(pose.orientation);
+    add_cells(i, pose.position.x, pose.position.y, yaw);
+    if (i + 1 == poses.size()) {
+      break;
+    }
+
+    // Poses of decimated paths may be further apart than a cell, the footprint then being
+    // swept between them through poses interpolated a cell apart at most, which count as
+    // the pose before them
+    const auto & next = poses[i + 1].pose;
+    const double dx = next.position.x - pose.position.x;
+    const double dy = next.position.y - pose.position.y;
+    const double dyaw = std::remainder(tf2::getYaw(next.orientation) - yaw, 2.0 * M_PI);
+    const double travel = std::max(std::hypot(dx, dy), radius * std::fabs(dyaw));
+    // Allowing for the rounding of poses a cell apart, which need none
+    const unsigned int steps =
+      static_cast<unsigned int>(std::ceil(travel / costmap->getResolution() - 1e-6));
+    for (unsigned int k = 1; k < steps; ++k) {
+      const double t = static_cast<double>(k) / steps;
+      add_cells(i, pose.position.x + t * dx, pose.position.y + t * dy, yaw + t * dyaw);
+    }
+  }
+
+  std::sort(
+    path.cells.begin(), path.cells.end(),
+    [](const PathCell & a, const PathCell & b) {return a.index < b.index;});
+  for (auto & cell : path.cells) {
+    checkCell(path, cell);
+  }
+  path.computed = true;
+}
+
+void PathValidityMonitor::checkWindow(
+  MonitoredPath & path, unsigned int x0, unsigned int y0,
+  unsigned int xn, unsigned int yn)
+{
+  if (x0 >= xn || y0 >= yn) {
+    return;
+  }
+
+  nav2_costmap_2d::Costmap2D * costmap = layered_costmap_->getCostmap();
+  auto cell = path.cells.begin();
+  for (unsigned int y = y0; y != yn && cell != path.cells.end(); ++y) {
+    const unsigned int row_start = costmap->getIndex(x0, y);
+    const unsigned int row_end = row_start + (xn - x0);
+    cell = std::lower_bound(
+      cell, path.cells.end(), row_start,
+      [](const PathCell & a, unsigned int index) {return a.index < index;});
+    for (; cell != path.cells.end() && cell->index < row_end; ++cell) {
+      checkCell(path, *cell);
+    }
+  }
+}
+
+void PathValidityMonitor::checkCell(MonitoredPath & path, PathCell & cell)
+{
+  const unsigned char cost = layered_costmap_->getCostmap()->getCharMap()[cell.index];
+  const bool blocked = cost == nav2_costmap_2d::LETHAL_OBSTACLE ||
+    (cell.center && cost == nav2_costmap_2d::INSCRIBED_INFLATED_OBSTACLE);
+  if (blocked != cell.blocked) {
+    cell.blocked = blocked;
+    if (blocked) {
+      path.blocked_cells[cell.pose]++;
+    } else {
+      path.blocked_cells[cell.pose]--;
+    }
+  }
+}
+
+}  // namespace nav2_planner
@@ -0,0 +1,213 @@
+// Copyright (c) 2022 Samsung Research America
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "nav2_planner/plan_cache.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <functional>
+#include <mutex>
+#include <string>
+#include <vector>
+
+#include "nav2_util/grid_traversal.hpp"
+#include "tf2/utils.h"
+
+namespace nav2_planner
+{
+
+size_t PlanCache::KeyHash::operator()(const Key & key) const
+{
+  size_t hash = std::hash<std::string>()(key.planner_id);
+  for (const unsigned int value : {key.start_index, key.start_bin, key.goal_index, key.goal_bin}) {
+    hash ^= std::hash<unsigned int>()(value) + 0x9e3779b9 + (hash << 6) + (hash >> 2);
+  }
+  return hash;
+}
+
+PlanCache::PlanCache(
+  nav2_costmap_2d::LayeredCostmap * layered_costmap, unsigned int max_plans,
+  unsigned int heading_bins)
+: layered_costmap_(layered_costmap),
+  max_plans_(std::max(max_plans, 1u)),
+  heading_bins_(std::max(heading_bins, 1u))
+{
+}
+
+uint64_t PlanCache::getUpdateCount() const
+{
+  return layered_costmap_->getUpdateCount();
+}
+
+bool PlanCache::lookup(
+  const std::string & planner_id,
+  const geometry_msgs::msg::PoseStamped & start,
+  const geometry_msgs::msg::PoseStamped & goal,
+  nav_msgs::msg::Path & path)
+{
+  std::lock_guard<std::mutex> lock(mutex_);
+  nav2_costmap_2d::Costmap2D * costmap = layered_costmap_->getCostmap();
+  std::unique_lock<nav2_costmap_2d::Costmap2D::mutex_t> costmap_lock(*(costmap->getMutex()));
+
+  Key key;
+  auto entry = makeKey(planner_id, start, goal, key) ? index_.find(key) : index_.end();
+  if (entry == index_.end()) {
+    statistics_.misses++;
+    return false;
+  }
+  auto plan = entry->second;
+  if (!isValid(*plan)) {
+    index_.erase(entry);
+    plans_.erase(plan);
+    statistics_.misses++;
+    statistics_.invalidations++;
+    return false;
+  }
+
+  // The poses are in the same cells and heading bins as those the plan was planned between
+  plans_.splice(plans_.begin(), plans_, plan);
+  path = plan->path;
+  path.poses.front().pose = start.pose;
+  path.poses.back().pose = goal.pose;
+  statistics_.hits++;
+  return true;
+}
+
+void PlanCache::insert(
+  const std::string & planner_id,
+  const geometry_msgs::msg::PoseStamped & start,
+  const geometry_msgs::msg::PoseStamped & goal,
+  const nav_msgs::msg::Path & path,
+  uint64_t update_count)
+{
+  if (path.poses.empty()) {
+    return;
+  }
+
+  std::lock_guard<std::mutex> lock(mutex_);
+  nav2_costmap_2d::Costmap2D * costmap = layered_costmap_->getCostmap();
+  std::unique_lock<nav2_costmap_2d::Costmap2D::mutex_t> costmap_lock(*(costmap->getMutex()));
+
+  CachedPlan plan;
+  if (!makeKey(planner_id, start, goal, plan.key)) {
+    return;
+  }
+  plan.path = path;
+  plan.update_count = update_count;
+
+  // The cells between consecutive poses, poses off the costmap being clamped to its edges
+  int x0 = 0, y0 = 0;
+  for (size_t i = 0; i != path.poses.size(); ++i) {
+    int x1, y1;
+    costmap->worldToMapEnforceBounds(
+      path.poses[i].pose.position.x, path.poses[i].pose.position.y, x1, y1);
+    if (i == 0) {
+      x0 = x1;
+      y0 = y1;
+    }
+    nav2_util::traverseLine(
+      x0, y0, x1, y1, [&plan, costmap](int x, int y) {
+        plan.cells.push_back(costmap->getIndex(x, y));
+      });
+    x0 = x1;
+    y0 = y1;
+  }
+  std::sort(plan.cells.begin(), plan.cells.end());
+  plan.cells.erase(std::unique(plan.cells.begin(), plan.cells.end()), plan.cells.end());
+
+  // Changes made while planning may have been missed by the plan, in which case it is
+  // dropped on its first lookup
+  auto existing = index_.find(plan.key);
+  if (existing != index_.end()) {
+    plans_.erase(existing->second);
+    index_.erase(existing);
+  }
+  plans_.push_front(std::move(plan));
+  index_[plans_.front().key] = plans_.begin();
+  if (plans_.size() > max_plans_) {
+    index_.erase(plans_.back().key);
+    plans_.pop_back();
+  }
+}
+
+void PlanCache::clear()
+{
+  std::lock_guard<std::mutex> lock(mutex_);
+  index_.clear();
+  plans_.clear();
+}
+
+PlanCache::Statistics PlanCache::getStatistics() const
+{
+  std::lock_guard<std::mutex> lock(mutex_);
+  return statistics_;
+}
+
+bool PlanCache::makeKey(
+  const std::string & planner_id,
+  const geometry_msgs::msg::PoseStamped & start,
+  const geometry_msgs::msg::PoseStamped & goal,
+  Key & key) const
+{
+  nav2_costmap_2d::Costmap2D * costmap = layered_costmap_->getCostmap();
+  auto cell = [costmap](const geometry_msgs::msg::PoseStamped & pose, unsigned int & index) {
+      unsigned int mx, my;
+      if (!costmap->worldToMap(pose.pose.position.x, pose.pose.position.y, mx, my)) {
+        return false;
+      }
+      index = costmap->getIndex(mx, my);
+      return true;
+    };
+  auto bin = [this](const geometry_msgs::msg::PoseStamped & pose) {
+      const double turns = (tf2::getYaw(pose.pose.orientation) + M_PI) / (2.0 * M_PI);
+      return static_cast<unsigned int>(std::floor(turns * heading_bins_)) % heading_bins_;
+    };
+  key.planner_id = planner_id;
+  key.start_bin = bin(start);
+  key.goal_bin = bin(goal);
+  return cell(start, key.start_index) && cell(goal, key.goal_index);
+}
+
+bool PlanCache::isValid(CachedPlan & plan)
+{
+  if (!layered_costmap_->getChangedWindows(plan.update_count, windows_)) {
+    return false;
+  }
+
+  // The footprint along the plan reaches up to the circumscribed radius from its cells, so
+  // the windows are checked padded by it
+  nav2_costmap_2d::Costmap2D * costmap = layered_costmap_->getCostmap();
+  const unsigned int margin = static_cast<unsigned int>(
+    std::ceil(layered_costmap_->getCircumscribedRadius() / costmap->getResolution()));
+  for (const auto & window : windows_) {
+    const unsigned int x0 = window.x0 > margin ? window.x0 - margin : 0;
+    const unsigned int y0 = window.y0 > margin ? window.y0 - margin : 0;
+    const unsigned int xn = std::min(window.xn + margin, costmap->getSizeInCellsX());
+    const unsigned int yn = std::min(window.yn + margin, costmap->getSizeInCellsY());
+    auto cell = plan.cells.begin();
+    for (unsigned int y = y0; y < yn && cell != plan.cells.end(); ++y) {
+      const unsigned int row_start = costmap->getIndex(x0, y);
+      cell = std::lower_bound(cell, plan.cells.end(), row_start);
+      if (cell != plan.cells.end() && *cell < row_start + (xn - x0)) {
+        return false;
+      }
+    }
+  }
+
+  // Only the updates from now on need a check on the next lookup
+  plan.update_count = layered_costmap_->getUpdateCount();
+  return true;
+}
+
+}  // namespace nav2_planner
@@ -0,0 +1,190 @@
+// Copyright (c) 2022 Samsung Research America
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <exception>
+#include <limits>
+#include <memory>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "nav2_planner/planner_pool.hpp"
+#include "nav2_util/geometry_utils.hpp"
+
+namespace nav2_planner
+{
+
+PlannerPool::PlannerPool(std::vector<PlannerMap> planners, PlanFunction plan)
+: planners_(std::move(planners)),
+  plan_(std::move(plan)),
+  stop_(false)
+{
+  for (size_t i = 0; i != planners_.size(); i++) {
+    workers_.emplace_back(&PlannerPool::work, this, i);
+  }
+}
+
+PlannerPool::~PlannerPool()
+{
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    stop_ = true;
+  }
+  request_cv_.notify_all();
+  for (auto & worker : workers_) {
+    worker.join();
+  }
+}
+
+std::vector<nav_msgs::msg::Path>
+PlannerPool::plan(
+  const std::vector<geometry_msgs::msg::PoseStamped> & starts,
+  const std::vector<geometry_msgs::msg::PoseStamped> & goals,
+  const std::string & planner_id)
+{
+  std::vector<nav_msgs::msg::Path> paths(goals.size());
+  if (goals.empty()) {
+    return paths;
+  }
+
+  Batch batch;
+  batch.remaining = goals.size();
+
+  std::unique_lock<std::mutex> lock(mutex_);
+  for (size_t i = 0; i != goals.size(); i++) {
+    requests_.push_back({&starts[i], &goals[i], &planner_id, &paths[i], &batch, nullptr, 0});
+  }
+  request_cv_.notify_all();
+
+  // The requests point into this frame, so all of them must be done before returning
+  batch.done.wait(lock, [&batch]() {return batch.remaining == 0;});
+  return paths;
+}
+
+PlannerPool::RaceResult
+PlannerPool::race(
+  const geometry_msgs::msg::PoseStamped & start,
+  const geometry_msgs::msg::PoseStamped & goal,
+  const std::vector<std::string> & planner_ids,
+  std::chrono::nanoseconds deadline)
+{
+  if (planner_ids.empty()) {
+    return RaceResult();
+  }
+
+  // The race is shared with the workers, which may still plan for it once it is decided
+  auto race = std::make_shared<Race>();
+  race->start = start;
+  race->goal = goal;
+  race->planner_ids = planner_ids;
+  race->paths.resize(planner_ids.size());
+  race->planned.resize(planner_ids.size(), false);
+  race->remaining = planner_ids.size();
+  race->decided = false;
+
+  const auto deadline_time = std::chrono::steady_clock::now() + deadline;
+
+  std::unique_lock<std::mutex> lock(mutex_);
+  for (size_t i = 0; i != planner_ids.size(); i++) {
+    requests_.push_back(
+      {&race->start, &race->goal, &race->planner_ids[i], &race->paths[i], nullptr, race, i});
+  }
+  request_cv_.notify_all();
+
+  auto all_planned = [&race]() {return race->remaining == 0;};
+  auto path_found = [&race]() {
+      return race->remaining == 0 || !shortestPath(*race).path.poses.empty();
+    };
+
+  if (deadline > std::chrono::nanoseconds(0)) {
+    race->done.wait_until(lock, deadline_time, all_planned);
+  }
+  race->done.wait(lock, path_found);
+
+  race->decided = true;
+  return shortestPath(*race);
+}
+
+PlannerPool::RaceResult
+PlannerPool::shortestPath(const Race & race)
+{
+  RaceResult result;
+  double shortest_length = std::numeric_limits<double>::max();
+  for (size_t i = 0; i != race.paths.size(); i++) {
+    if (!race.planned[i] || race.paths[i].poses.empty()) {
+      continue;
+    }
+    double length = nav2_util::geometry_utils::calculate_path_length(race.paths[i]);
+    if (length < shortest_length) {
+      shortest_length = length;
+      result.path = race.paths[i];
+      result.planner_id = race.planner_ids[i];
+    }
+  }
+  return result;
+}
+
+void
+PlannerPool::work(size_t worker)
+{
+  PlannerMap & planners = planners_[worker];
+
+  std::unique_lock<std::mutex> lock(mutex_);
+  while (true) {
+    request_cv_.wait(lock, [this]() {return stop_ || !requests_.empty();});
+    if (requests_.empty()) {
+      return;
+    }
+
+    Request request = requests_.front();
+    requests_.pop_front();
+
+    // The losers of a decided race which did not start are dropped, the others cancelled
+    CancelChecker cancel_checker;
+    if (request.race) {
+      if (request.race->decided) {
+        continue;
+      }
+      std::shared_ptr<Race> race = request.race;
+      cancel_checker = [race]() {return race->decided.load();};
+    }
+    lock.unlock();
+
+    // A failed request gets an empty path, and must not take the worker down
+    nav_msgs::msg::Path path;
+    try {
+      path = plan_(planners, *request.start, *request.goal, *request.planner_id, cancel_checker);
+    } catch (std::exception &) {
+      path.poses.clear();
+    }
+
+    lock.lock();
+    if (request.race) {
+      // Planned into the race only under the mutex, as the caller reads it on every wake up
+      if (!request.race->decided) {
+        *request.path = std::move(path);
+        request.race->planned[request.race_index] = true;
+      }
+      request.race->remaining--;
+      request.race->done.notify_all();
+    } else {
+      *request.path = std::move(path);
+      if (--request.batch->remaining == 0) {
+        request.batch->done.notify_all();
+      }
+    }
+  }
+}
+
+}  // namespace nav2_planner
@@ -13,11 +13,13 @@
 // See the License for the specific language governing permissions and
 // limitations under the License.
 
+#include <algorithm>
 #include <chrono>
 #include <cmath>
 #include <iomanip>
 #include <iostream>
 #include <limits>
+#include <map>
 #include <iterator>
 #include <memory>
 #include <string>
@@ -29,12 +31,14 @@
 #include "nav2_util/node_utils.hpp"
 #include "nav2_util/geometry_utils.hpp"
 #include "nav2_costmap_2d/cost_values.hpp"
+#include "nav2_costmap_2d/tile_thread_pool.hpp"
 
 #include "nav2_planner/planner_server.hpp"
 
 using namespace std::chrono_literals;
 using rcl_interfaces::msg::ParameterType;
 using std::placeholders::_1;
+using std::placeholders::_2;
 
 namespace nav2_planner
 {
@@ -44,6 +48,7 @@ PlannerServer::PlannerServer(const rclcpp::NodeOptions & options)
   gp_loader_("nav2_core", "nav2_core::GlobalPlanner"),
   default_ids_{"GridBased"},
   default_types_{"nav2_navfn_planner/NavfnPlanner"},
+  parallel_segment_planning_(false),
   costmap_(nullptr)
 {
   RCLCPP_INFO(get_logger(), "Creating");
@@ -51,6 +56,13 @@ PlannerServer::PlannerServer(const rclcpp::NodeOptions & options)
   // Declare this node's parameters
   declare_parameter("planner_plugins", default_ids_);
   declare_parameter("expected_planner_frequency", 1.0);
+  declare_parameter("planner_pool_size", 0);
+  declare_parameter("parallel_segment_planning", false);
+  declare_parameter("parallel_plugin_configuration", false);
+  declare_parameter("plan_cache_size", 0);
+  declare_parameter("plan_cache_heading_bins", 16);
+  declare_parameter("path_decimation_tolerance", 0.0);
+  declare_parameter("path_decimation_max_spacing", 0.5);
 
   get_parameter("planner_plugins", planner_ids_);
   if (planner_ids_ == default_ids_) {
@@ -69,6 +81,9 @@ PlannerServer::PlannerServer(const rclcpp::NodeOptions & options)
 
 PlannerServer::~PlannerServer()
 {
+  if (warmup_thread_.joinable()) {
+    warmup_thread_.join();
+  }
   planners_.clear();
   costmap_thread_.reset();
 }
@@ -80,6 +95,24 @@ PlannerServer::on_configure(const rclcpp_lifecycle::State & state)
 
   costmap_ros_->on_configure(state);
   costmap_ = costmap_ros_->getCostmap();
+  path_validity_monitor_ = std::make_unique<PathValidityMonitor>(
+    costmap_ros_->getLayeredCostmap(), 16);
+
+  int plan_cache_size, plan_cache_heading_bins;
+  get_parameter("plan_cache_size", plan_cache_size);
+  get_parameter("plan_cache_heading_bins", plan_cache_heading_bins);
+  if (plan_cache_size > 0) {
+    plan_cache_ = std::make_unique<PlanCache>(
+      costmap_ros_->getLayeredCostmap(), plan_cache_size, std::max(plan_cache_heading_bins, 1));
+  }
+
+  double path_decimation_tolerance, path_decimation_max_spacing;
+  get_parameter("path_decimation_tolerance", path_decimation_tolerance);
+  get_parameter("path_decimation_max_spacing", path_decimation_max_spacing);
+  if (path_decimation_tolerance > 0.0) {
+    path_decimator_ = std::make_unique<PathDecimator>(
+      path_decimation_tolerance, path_decimation_max_spacing);
+  }
 
   RCLCPP_DEBUG(
     get_logger(), "Costmap size: %d,%d",
@@ -91,16 +124,29 @@ PlannerServer::on_configure(const rclcpp_lifecycle::State & state)
 
   auto node = shared_from_this();
 
+  // With parallel plugin configuration, the planners are created in turn, as class loaders
+  // aren't thread safe, and configured concurrently once all of them are. The planners of a
+  // type are configured one after another, by type, as their instances may share state
+  bool parallel_plugin_configuration;
+  get_parameter("parallel_plugin_configuration", parallel_plugin_configuration);
+  std::map<std::string, std::vector<std::pair<std::string, nav2_core::GlobalPlanner::Ptr>>>
+  unconfigured;
+  size_t unconfigured_count = 0;
+
   for (size_t i = 0; i != planner_ids_.size(); i++) {
     try {
       planner_types_[i] = nav2_util::get_plugin_type_param(
         node, planner_ids_[i]);
-      nav2_core::GlobalPlanner::Ptr planner =
-        gp_loader_.createUniqueInstance(planner_types_[i]);
+      nav2_core::GlobalPlanner::Ptr planner = createPlanner(i);
       RCLCPP_INFO(
         get_logger(), "Created global planner plugin %s of type %s",
         planner_ids_[i].c_str(), planner_types_[i].c_str());
-      planner->configure(node, planner_ids_[i], tf_, costmap_ros_);
+      if (parallel_plugin_configuration) {
+        unconfigured[planner_types_[i]].emplace_back(planner_ids_[i], planner);
+        unconfigured_count++;
+      } else {
+        planner->configure(node, planner_ids_[i], tf_, costmap_ros_);
+      }
       planners_.insert({planner_ids_[i], planner});
     } catch (const pluginlib::PluginlibException & ex) {
       RCLCPP_FATAL(
@@ -114,6 +160,85 @@ PlannerServer::on_configure(const rclcpp_lifecycle::State & state)
     planner_ids_concat_ += planner_ids_[i] + std::string(" ");
   }
 
+  // Each worker of the planner pool has its own instance of every planner,
+  // configured like the one of the action servers
+  int planner_pool_size;
+  get_parameter("planner_pool_size", planner_pool_size);
+  std::vector<PlannerMap> pool_planners(std::max(planner_pool_size, 0));
+  for (auto & planners : pool_planners) {
+    for (size_t i = 0; i != planner_ids_.size(); i++) {
+      try {
+        nav2_core::GlobalPlanner::Ptr planner = createPlanner(i);
+        if (parallel_plugin_configuration) {
+          unconfigured[planner_types_[i]].emplace_back(planner_ids_[i], planner);
+          unconfigured_count++;
+        } else {
+          planner->configure(node, planner_ids_[i], tf_, costmap_ros_);
+        }
+        planners.insert({planner_ids_[i], planner});
+      } catch (const std::exception & ex) {
+        RCLCPP_FATAL(
+          get_logger(), "Failed to create global planner %s for the planner pool. Exception: %s",
+          planner_ids_[i].c_str(), ex.what());
+        return nav2_util::CallbackReturn::FAILURE;
+      }
+    }
+  }
+
+  // The planners of each type are configured on their own thread, so that configuring the
+  // server takes as long as its slowest type of planners rather than all of them
+  if (!unconfigured.empty()) {
+    std::vector<std::vector<std::pair<std::string, nav2_core::GlobalPlanner::Ptr>> *> types;
+    for (auto & type : unconfigured) {
+      types.push_back(&type.second);
+    }
+    nav2_costmap_2d::TileThreadPool configuration_pool(types.size());
+    try {
+      configuration_pool.run(
+        types.size(), [&](unsigned int i) {
+          for (auto & planner : *types[i]) {
+            planner.second->configure(node, planner.first, tf_, costmap_ros_);
+          }
+        });
+    } catch (const std::exception & ex) {
+      RCLCPP_FATAL(
+        get_logger(), "Failed to configure global planners. Exception: %s", ex.what());
+      return nav2_util::CallbackReturn::FAILURE;
+    }
+    RCLCPP_INFO(
+      get_logger(), "Configured %zu global planners of %zu types concurrently.",
+      unconfigured_count, unconfigured.size());
+  }
+
+  if (planner_pool_size > 0) {
+    planner_pool_ = std::make_unique<PlannerPool>(
+      std::move(pool_planners),
+      [this](PlannerMap & planners, const geometry_msgs::msg::PoseStamped & start,
+      const geometry_msgs::msg::PoseStamped & goal, const std::string & planner_id,
+      PlannerPool::CancelChecker cancel_checker) {
+        try {
+          return getPlan(planners, start, goal, planner_id, cancel_checker);
+        } catch (std::exception & ex) {
+          RCLCPP_WARN(
+            get_logger(), "%s plugin failed to plan calculation to (%.2f, %.2f): \"%s\"",
+            planner_id.c_str(), goal.pose.position.x, goal.pose.position.y, ex.what());
+          return nav_msgs::msg::Path();
+        }
+      });
+
+    RCLCPP_INFO(
+      get_logger(),
+      "Planner pool has %d instances of each planner for batch planning.", planner_pool_size);
+  }
+
+  get_parameter("parallel_segment_planning", parallel_segment_planning_);
+  if (parallel_segment_planning_ && !planner_pool_) {
+    RCLCPP_WARN(
+      get_logger(),
+      "Parallel segment planning requires a planner pool, set planner_pool_size above 0."
+      " Segments will be planned in turn.");
+  }
+
   RCLCPP_INFO(
     get_logger(),
     "Planner Server has %s planners available.", planner_ids_concat_.c_str());
@@ -140,6 +265,8 @@ PlannerServer::on_configure(const rclcpp_lifecycle::State & state)
     std::bind(&PlannerServer::computePlan, this),
     nullptr,
     std::chrono::milliseconds(500),
+    true,
+    rcl_action_server_get_default_options(),
     true);
 
   action_server_poses_ = std::make_unique<ActionServerThroughPoses>(
@@ -148,8 +275,15 @@ PlannerServer::on_configure(const rclcpp_lifecycle::State & state)
     std::bind(&PlannerServer::computePlanThroughPoses, this),
     nullptr,
     std::chrono::milliseconds(500),
+    true,
+    rcl_action_server_get_default_options(),
     true);
 
+  // The memory of the costmap is reported with that of the planners
+  instrumentation_publisher_ = std::make_unique<nav2_util::InstrumentationPublisher>(
+    shared_from_this(), std::vector<std::string>{"planner_server."},
+    std::vector<std::string>{"planner_server.", std::string(costmap_ros_->get_name()) + "."});
+
   return nav2_util::CallbackReturn::SUCCESS;
 }
 
@@ -159,6 +293,7 @@ PlannerServer::on_activate(const rclcpp_lifecycle::State & state)
   RCLCPP_INFO(get_logger(), "Activating");
 
   plan_publisher_->on_activate();
+  instrumentation_publisher_->activate();
   action_server_pose_->activate();
   action_server_poses_->activate();
   costmap_ros_->on_activate(state);
@@ -167,6 +302,15 @@ PlannerServer::on_activate(const rclcpp_lifecycle::State & state)
   for (it = planners_.begin(); it != planners_.end(); ++it) {
     it->second->activate();
   }
+  if (planner_pool_) {
+    for (auto & planners : planner_pool_->getPlanners()) {
+      for (it = planners.begin(); it != planners.end(); ++it) {
+        it->second->activate();
+      }
+    }
+  }
+
+  startLazyPlanners();
 
   auto node = shared_from_this();
 
@@ -176,6 +320,17 @@ PlannerServer::on_activate(const rclcpp_lifecycle::State & state)
       &PlannerServer::isPathValid, this,
       std::placeholders::_1, std::placeholders::_2));
 
+  compute_paths_callback_group_ = create_callback_group(
+    rclcpp::CallbackGroupType::MutuallyExclusive, false);
+  compute_paths_service_ = create_service<nav2_msgs::srv::ComputePaths>(
+    "compute_paths",
+    std::bind(&PlannerServer::computePaths, this, _1, _2),
+    rmw_qos_profile_services_default,
+    compute_paths_callback_group_);
+  auto executor = std::make_shared<rclcpp::executors::SingleThreadedExecutor>();
+  executor->add_callback_group(compute_paths_callback_group_, get_node_base_interface());
+  compute_paths_thread_ = std::make_unique<nav2_util::NodeThread>(executor);
+
   // Add callback for dynamic parameters
   dyn_params_handler_ = node->add_on_set_parameters_callback(
     std::bind(&PlannerServer::dynamicParametersCallback, this, _1));
@@ -194,12 +349,29 @@ PlannerServer::on_deactivate(const rclcpp_lifecycle::State & state)
   action_server_pose_->deactivate();
   action_server_poses_->deactivate();
   plan_publisher_->on_deactivate();
+  instrumentation_publisher_->deactivate();
   costmap_ros_->on_deactivate(state);
 
+  // Stopping the service thread waits for a batch in progress
+  compute_paths_thread_.reset();
+  compute_paths_service_.reset();
+
+  lazy_unload_timer_.reset();
+  if (warmup_thread_.joinable()) {
+    warmup_thread_.join();
+  }
+
   PlannerMap::iterator it;
   for (it = planners_.begin(); it != planners_.end(); ++it) {
     it->second->deactivate();
   }
+  if (planner_pool_) {
+    for (auto & planners : planner_pool_->getPlanners()) {
+      for (it = planners.begin(); it != planners.end(); ++it) {
+        it->second->deactivate();
+      }
+    }
+  }
 
   dyn_params_handler_.reset();
 
@@ -217,6 +389,7 @@ PlannerServer::on_cleanup(const rclcpp_lifecycle::State & state)
   action_server_pose_.reset();
   action_server_poses_.reset();
   plan_publisher_.reset();
+  instrumentation_publisher_.reset();
   tf_.reset();
   costmap_ros_->on_cleanup(state);
 
@@ -225,6 +398,23 @@ PlannerServer::on_cleanup(const rclcpp_lifecycle::State & state)
     it->second->cleanup();
   }
   planners_.clear();
+  if (planner_pool_) {
+    for (auto & planners : planner_pool_->getPlanners()) {
+      for (it = planners.begin(); it != planners.end(); ++it) {
+        it->second->cleanup();
+      }
+    }
+    planner_pool_.reset();
+  }
+  lazy_planners_.clear();
+  path_validity_monitor_.reset();
+  if (plan_cache_) {
+    const auto statistics = plan_cache_->getStatistics();
+    RCLCPP_INFO(
+      get_logger(), "Plan cache had %lu hits and %lu misses, of which %lu invalidated plans.",
+      statistics.hits, statistics.misses, statistics.invalidations);
+    plan_cache_.reset();
+  }
   costmap_ = nullptr;
   return nav2_util::CallbackReturn::SUCCESS;
 }
@@ -250,6 +440,7 @@ bool PlannerServer::isServerInactive(
 
 void PlannerServer::waitForCostmap()
 {
+  NAV2_PROBE_SCOPE("planner_server.wait_for_costmap");
   // Don't compute a plan until costmap is valid (after clear costmap)
   rclcpp::Rate r(100);
   while (!costmap_ros_->isCurrent()) {
@@ -343,6 +534,7 @@ void
 PlannerServer::computePlanThroughPoses()
 {
   std::lock_guard<std::mutex> lock(dynamic_params_lock_);
+  NAV2_PROBE_SCOPE("planner_server.compute_plan_through_poses");
 
   auto start_time = steady_clock_.now();
 
@@ -373,28 +565,38 @@ PlannerServer::computePlanThroughPoses()
       return;
     }
 
-    // Get consecutive paths through these points
-    std::vector<geometry_msgs::msg::PoseStamped>::iterator goal_iter;
-    geometry_msgs::msg::PoseStamped curr_start, curr_goal;
+    // Get consecutive segments through these points
+    std::vector<geometry_msgs::msg::PoseStamped> curr_starts(goal->goals.size());
+    std::vector<geometry_msgs::msg::PoseStamped> curr_goals(goal->goals.size());
     for (unsigned int i = 0; i != goal->goals.size(); i++) {
       // Get starting point
       if (i == 0) {
-        curr_start = start;
+        curr_starts[i] = start;
       } else {
-        curr_start = goal->goals[i - 1];
+        curr_starts[i] = goal->goals[i - 1];
       }
-      curr_goal = goal->goals[i];
+      curr_goals[i] = goal->goals[i];
 
       // Transform them into the global frame
-      if (!transformPosesToGlobalFrame(action_server_poses_, curr_start, curr_goal)) {
+      if (!transformPosesToGlobalFrame(action_server_poses_, curr_starts[i], curr_goals[i])) {
         return;
       }
+    }
 
+    // The segments are independent given the waypoints, so they can be planned
+    // concurrently by the planner pool, else they are planned in turn below
+    std::vector<nav_msgs::msg::Path> segment_paths;
+    if (parallel_segment_planning_ && planner_pool_) {
+      segment_paths = planner_pool_->plan(curr_starts, curr_goals, goal->planner_id);
+    }
+
+    for (unsigned int i = 0; i != goal->goals.size(); i++) {
       // Get plan from start -> goal
-      nav_msgs::msg::Path curr_path = getPlan(curr_start, curr_goal, goal->planner_id);
+      nav_msgs::msg::Path curr_path = segment_paths.empty() ?
+        getPlan(curr_starts[i], curr_goals[i], goal->planner_id) : std::move(segment_paths[i]);
 
       // check path for validity
-      if (!validatePath(action_server_poses_, curr_goal, curr_path, goal->planner_id)) {
+      if (!validatePath(action_server_poses_, curr_goals[i], curr_path, goal->planner_id)) {
         return;
       }
 
@@ -433,6 +635,7 @@ void
 PlannerServer::computePlan()
 {
   std::lock_guard<std::mutex> lock(dynamic_params_lock_);
+  NAV2_PROBE_SCOPE("planner_server.compute_plan");
 
   auto start_time = steady_clock_.now();
 
@@ -461,9 +664,17 @@ PlannerServer::computePlan()
       return;
     }
 
-    result->path = getPlan(start, goal_pose, goal->planner_id);
+    if (goal->race_planner_ids.empty()) {
+      result->path = getPlan(start, goal_pose, goal->planner_id);
+      result->planner_id = goal->planner_id;
+    } else {
+      racePlanners(start, goal_pose, goal->race_planner_ids, goal->race_deadline, *result);
+    }
 
-    if (!validatePath(action_server_pose_, goal_pose, result->path, goal->planner_id)) {
+    if (!validatePath(
+        action_server_pose_, goal_pose, result->path,
+        goal->race_planner_ids.empty() ? goal->planner_id : std::string("race")))
+    {
       return;
     }
 
@@ -490,35 +701,245 @@ PlannerServer::computePlan()
   }
 }
 
+nav2_core::GlobalPlanner::Ptr
+PlannerServer::createPlanner(size_t index)
+{
+  const std::string & id = planner_ids_[index];
+  const std::string & type = planner_types_[index];
+  auto node = shared_from_this();
+  nav2_util::declare_parameter_if_not_declared(node, id + ".lazy", rclcpp::ParameterValue(false));
+  if (!get_parameter(id + ".lazy").as_bool()) {
+    return gp_loader_.createUniqueInstance(type);
+  }
+
+  // Without an instance yet, the type of the planner is checked for right away
+  if (!gp_loader_.isClassAvailable(type)) {
+    throw pluginlib::LibraryLoadException("Lazy planner type " + type + " is not available");
+  }
+  nav2_util::declare_parameter_if_not_declared(
+    node, id + ".lazy_warmup", rclcpp::ParameterValue(false));
+  nav2_util::declare_parameter_if_not_declared(
+    node, id + ".lazy_unload_timeout", rclcpp::ParameterValue(0.0));
+  const auto unload_timeout = std::chrono::duration_cast<LazyPlanner::Clock::duration>(
+    std::chrono::duration<double>(get_parameter(id + ".lazy_unload_timeout").as_double()));
+
+  // Instances are created once active, by the action servers, the planner pool and the warm up
+  auto planner = std::make_shared<LazyPlanner>(
+    [this, type]() {
+      std::lock_guard<std::mutex> lock(loader_mutex_);
+      return gp_loader_.createUniqueInstance(type);
+    }, unload_timeout);
+  lazy_planners_.push_back({id, planner, get_parameter(id + ".lazy_warmup").as_bool()});
+  return planner;
+}
+
+void
+PlannerServer::startLazyPlanners()
+{
+  if (lazy_planners_.empty()) {
+    return;
+  }
+
+  if (std::any_of(
+      lazy_planners_.begin(), lazy_planners_.end(), [](const Lazy & lazy) {return lazy.warmup;}))
+  {
+    warmup_thread_ = std::thread(
+      [this]() {
+        for (auto & lazy : lazy_planners_) {
+          if (!lazy.warmup) {
+            continue;
+          }
+          try {
+            lazy.planner->warm();
+            RCLCPP_INFO(get_logger(), "Warmed up lazy planner %s", lazy.id.c_str());
+          } catch (const std::exception & ex) {
+            RCLCPP_WARN(
+              get_logger(), "Failed to warm up lazy planner %s: %s", lazy.id.c_str(), ex.what());
+          }
+        }
+      });
+  }
+
+  lazy_unload_timer_ = create_wall_timer(
+    std::chrono::seconds(1), [this]() {
+      for (auto & lazy : lazy_planners_) {
+        if (lazy.planner->unloadIfIdle()) {
+          RCLCPP_INFO(get_logger(), "Unloaded idle lazy planner %s", lazy.id.c_str());
+        }
+      }
+    });
+}
+
 nav_msgs::msg::Path
 PlannerServer::getPlan(
   const geometry_msgs::msg::PoseStamped & start,
   const geometry_msgs::msg::PoseStamped & goal,
   const std::string & planner_id)
 {
+  return getPlan(planners_, start, goal, planner_id, std::function<bool()>());
+}
+
+nav_msgs::msg::Path
+PlannerServer::getPlan(
+  PlannerMap & planners,
+  const geometry_msgs::msg::PoseStamped & start,
+  const geometry_msgs::msg::PoseStamped & goal,
+  const std::string & planner_id,
+  const std::function<bool()> & cancel_checker)
+{
+  NAV2_PROBE_SCOPE("planner_server.create_plan");
   RCLCPP_DEBUG(
     get_logger(), "Attempting to a find path from (%.2f, %.2f) to "
     "(%.2f, %.2f).", start.pose.position.x, start.pose.position.y,
     goal.pose.position.x, goal.pose.position.y);
 
-  if (planners_.find(planner_id) != planners_.end()) {
-    return planners_[planner_id]->createPlan(start, goal);
-  } else {
-    if (planners_.size() == 1 && planner_id.empty()) {
+  auto planner = planners.find(planner_id);
+  if (planner == planners.end()) {
+    if (planners.size() == 1 && planner_id.empty()) {
       RCLCPP_WARN_ONCE(
         get_logger(), "No planners specified in action call. "
         "Server will use only plugin %s in server."
         " This warning will appear once.", planner_ids_concat_.c_str());
-      return planners_[planners_.begin()->first]->createPlan(start, goal);
+      planner = planners.begin();
     } else {
       RCLCPP_ERROR(
         get_logger(), "planner %s is not a valid planner. "
         "Planner names are: %s", planner_id.c_str(),
         planner_ids_concat_.c_str());
+      return nav_msgs::msg::Path();
+    }
+  }
+
+  if (!plan_cache_) {
+    return createPlan(*planner->second, start, goal, cancel_checker);
+  }
+
+  nav_msgs::msg::Path path;
+  if (plan_cache_->lookup(planner->first, start, goal, path)) {
+    NAV2_PROBE_COUNT("planner_server.plan_cache_hits", 1);
+    path.header.stamp = now();
+    return path;
+  }
+  NAV2_PROBE_COUNT("planner_server.plan_cache_misses", 1);
+  const uint64_t update_count = plan_cache_->getUpdateCount();
+  path = createPlan(*planner->second, start, goal, cancel_checker);
+  plan_cache_->insert(planner->first, start, goal, path, update_count);
+  return path;
+}
+
+nav_msgs::msg::Path
+PlannerServer::createPlan(
+  nav2_core::GlobalPlanner & planner,
+  const geometry_msgs::msg::PoseStamped & start,
+  const geometry_msgs::msg::PoseStamped & goal,
+  const std::function<bool()> & cancel_checker)
+{
+  nav_msgs::msg::Path path = planner.createPlan(start, goal, cancel_checker);
+
+  // Decimated before being cached or returned, so that all consumers get compact paths
+  if (path_decimator_) {
+    NAV2_PROBE_SCOPE("planner_server.decimate_path");
+    path_decimator_->decimate(path);
+  }
+  return path;
+}
+
+void
+PlannerServer::racePlanners(
+  const geometry_msgs::msg::PoseStamped & start,
+  const geometry_msgs::msg::PoseStamped & goal,
+  const std::vector<std::string> & planner_ids,
+  const builtin_interfaces::msg::Duration & deadline,
+  ActionToPose::Result & result)
+{
+  if (planner_pool_) {
+    auto race = planner_pool_->race(
+      start, goal, planner_ids,
+      rclcpp::Duration(deadline).to_chrono<std::chrono::nanoseconds>());
+    result.path = std::move(race.path);
+    result.planner_id = race.planner_id;
+    return;
+  }
+
+  // Without a pool, the planners are tried in turn until one finds a path
+  RCLCPP_WARN_ONCE(
+    get_logger(), "Racing planners requires a planner pool, set planner_pool_size above 0."
+    " The planners will be tried in turn. This warning will appear once.");
+  for (const auto & planner_id : planner_ids) {
+    try {
+      result.path = getPlan(start, goal, planner_id);
+    } catch (std::exception & ex) {
+      RCLCPP_WARN(
+        get_logger(), "%s plugin failed to plan calculation to (%.2f, %.2f): \"%s\"",
+        planner_id.c_str(), goal.pose.position.x, goal.pose.position.y, ex.what());
+      result.path.poses.clear();
+    }
+    if (!result.path.poses.empty()) {
+      result.planner_id = planner_id;
+      return;
+    }
+  }
+}
+
+void
+PlannerServer::computePaths(
+  const std::shared_ptr<nav2_msgs::srv::ComputePaths::Request> request,
+  std::shared_ptr<nav2_msgs::srv::ComputePaths::Response> response)
+{
+  auto start_time = steady_clock_.now();
+
+  if (!request->starts.empty() && request->starts.size() != request->goals.size()) {
+    RCLCPP_WARN(
+      get_logger(), "Compute paths requested %lu starts for %lu goals, there should be"
+      " one for each goal or none to plan from the robot pose.",
+      request->starts.size(), request->goals.size());
+    return;
+  }
+
+  waitForCostmap();
+
+  // Use start poses if provided otherwise use current robot pose
+  geometry_msgs::msg::PoseStamped robot_pose;
+  if (request->starts.empty() && !request->goals.empty() &&
+    !costmap_ros_->getRobotPose(robot_pose))
+  {
+    RCLCPP_WARN(get_logger(), "Could not get the robot pose to compute paths from");
+    return;
+  }
+
+  // Transform them into the global frame
+  std::vector<geometry_msgs::msg::PoseStamped> starts(request->goals.size());
+  std::vector<geometry_msgs::msg::PoseStamped> goals(request->goals.size());
+  for (size_t i = 0; i != request->goals.size(); i++) {
+    const auto & start = request->starts.empty() ? robot_pose : request->starts[i];
+    if (!costmap_ros_->transformPoseToGlobalFrame(start, starts[i]) ||
+      !costmap_ros_->transformPoseToGlobalFrame(request->goals[i], goals[i]))
+    {
+      RCLCPP_WARN(
+        get_logger(), "Could not transform the start or goal pose %lu in the costmap frame", i);
+      return;
     }
   }
 
-  return nav_msgs::msg::Path();
+  if (planner_pool_) {
+    response->paths = planner_pool_->plan(starts, goals, request->planner_id);
+  } else {
+    // Without a pool, the paths are computed in turn by the planners of the action servers
+    std::lock_guard<std::mutex> lock(dynamic_params_lock_);
+    response->paths.resize(goals.size());
+    for (size_t i = 0; i != goals.size(); i++) {
+      try {
+        response->paths[i] = getPlan(starts[i], goals[i], request->planner_id);
+      } catch (std::exception & ex) {
+        RCLCPP_WARN(
+          get_logger(), "%s plugin failed to plan calculation to (%.2f, %.2f): \"%s\"",
+          request->planner_id.c_str(), goals[i].pose.position.x, goals[i].pose.position.y,
+          ex.what());
+      }
+    }
+  }
+
+  response->planning_time = steady_clock_.now() - start_time;
 }
 
 void
@@ -536,7 +957,18 @@ void PlannerServer::isPathValid(
 {
   response->is_valid = true;
 
-  if (request->path.poses.empty()) {
+  // A path is registered by its first request, then checked by its identifier, an
+  // unknown identifier being answered with 0 for the client to send the path again
+  const nav_msgs::msg::Path * path = nullptr;
+  if (request->path_id != 0) {
+    path = path_validity_monitor_->getPath(request->path_id);
+    response->path_id = path ? request->path_id : 0;
+  } else if (!request->path.poses.empty()) {
+    response->path_id = path_validity_monitor_->registerPath(request->path);
+    path = path_validity_monitor_->getPath(response->path_id);
+  }
+
+  if (!path || path->poses.empty()) {
     response->is_valid = false;
     return;
   }
@@ -547,8 +979,8 @@ void PlannerServer::isPathValid(
     float current_distance = std::numeric_limits<float>::max();
     float closest_distance = current_distance;
     geometry_msgs::msg::Point current_point = current_pose.pose.position;
-    for (unsigned int i = 0; i < request->path.poses.size(); ++i) {
-      geometry_msgs::msg::Point path_point = request->path.poses[i].pose.position;
+    for (unsigned int i = 0; i < path->poses.size(); ++i) {
+      geometry_msgs::msg::Point path_point = path->poses[i].pose.position;
 
       current_distance = nav2_util::geometry_utils::euclidean_distance(
         current_point,
@@ -564,20 +996,10 @@ void PlannerServer::isPathValid(
      * The lethal check starts at the closest point to avoid points that have already been passed
      * and may have become occupied
      */
-    unsigned int mx = 0;
-    unsigned int my = 0;
-    for (unsigned int i = closest_point_index; i < request->path.poses.size(); ++i) {
-      costmap_->worldToMap(
-        request->path.poses[i].pose.position.x,
-        request->path.poses[i].pose.position.y, mx, my);
-      unsigned int cost = costmap_->getCost(mx, my);
-
-      if (cost == nav2_costmap_2d::LETHAL_OBSTACLE ||
-        cost == nav2_costmap_2d::INSCRIBED_INFLATED_OBSTACLE)
-      {
-        response->is_valid = false;
-      }
-    }
+    path_validity_monitor_->checkPath(
+      response->path_id, costmap_ros_->getRobotFootprint(), closest_point_index,
+      response->invalid_pose_indices);
+    response->is_valid = response->invalid_pose_indices.empty();
   }
 }
 
@@ -603,6 +1025,10 @@ PlannerServer::dynamicParametersCallback(std::vector<rclcpp::Parameter> paramete
           max_planner_duration_ = 0.0;
         }
       }
+    } else if (type == ParameterType::PARAMETER_BOOL) {
+      if (name == "parallel_segment_planning") {
+        parallel_segment_planning_ = parameter.as_bool();
+      }
     }
   }
 
@@ -87,4 +87,13 @@ TEST(WPTest, test_dynamic_parameters)
     results);
 
   EXPECT_EQ(planner->get_parameter("expected_planner_frequency").as_double(), -1.0);
+
+  results = rec_param->set_parameters_atomically(
+    {rclcpp::Parameter("parallel_segment_planning", true)});
+
+  rclcpp::spin_until_future_complete(
+    planner->get_node_base_interface(),
+    results);
+
+  EXPECT_EQ(planner->get_parameter("parallel_segment_planning").as_bool(), true);
 }
@@ -0,0 +1,127 @@
+// Copyright (c) 2022 Samsung Research America
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+
+#include <algorithm>
+#include <cmath>
+#include <utility>
+#include <vector>
+
+#include "gtest/gtest.h"
+#include "nav2_planner/path_decimator.hpp"
+
+static nav_msgs::msg::Path makePath(const std::vector<std::pair<double, double>> & points)
+{
+  nav_msgs::msg::Path path;
+  for (const auto & point : points) {
+    geometry_msgs::msg::PoseStamped pose;
+    pose.pose.position.x = point.first;
+    pose.pose.position.y = point.second;
+    path.poses.push_back(pose);
+  }
+  return path;
+}
+
+// Distance from a point to the closest segment of a path
+static double distanceToPath(const nav_msgs::msg::Path & path, double x, double y)
+{
+  double distance = std::hypot(
+    x - path.poses[0].pose.position.x, y - path.poses[0].pose.position.y);
+  for (size_t i = 1; i < path.poses.size(); ++i) {
+    const auto & a = path.poses[i - 1].pose.position;
+    const auto & b = path.poses[i].pose.position;
+    const double dx = b.x - a.x, dy = b.y - a.y;
+    const double length_sq = dx * dx + dy * dy;
+    const double t = length_sq > 0.0 ?
+      std::clamp(((x - a.x) * dx + (y - a.y) * dy) / length_sq, 0.0, 1.0) : 0.0;
+    distance = std::min(distance, std::hypot(x - a.x - t * dx, y - a.y - t * dy));
+  }
+  return distance;
+}
+
+TEST(PathDecimatorTest, testStraightPath)
+{
+  // 10 m at 5 cm, kept every 0.5 m
+  std::vector<std::pair<double, double>> points;
+  for (int i = 0; i <= 200; ++i) {
+    points.emplace_back(i * 0.05, 1.0);
+  }
+  auto path = makePath(points);
+  nav2_planner::PathDecimator(0.02, 0.5).decimate(path);
+  ASSERT_EQ(path.poses.size(), 21u);
+  EXPECT_DOUBLE_EQ(path.poses.front().pose.position.x, 0.0);
+  EXPECT_DOUBLE_EQ(path.poses[1].pose.position.x, 0.5);
+  EXPECT_DOUBLE_EQ(path.poses.back().pose.position.x, 10.0);
+
+  // Without a spacing limit, only the ends are kept
+  path = makePath(points);
+  nav2_planner::PathDecimator(0.02, 0.0).decimate(path);
+  EXPECT_EQ(path.poses.size(), 2u);
+}
+
+TEST(PathDecimatorTest, testCurvedPath)
+{
+  // Arcs of radius 1 m and 4 m at 5 cm
+  auto arc = [](double radius) {
+      std::vector<std::pair<double, double>> points;
+      const int steps = static_cast<int>(radius * M_PI / 0.05);
+      for (int i = 0; i <= steps; ++i) {
+        const double angle = i * M_PI / steps;
+        points.emplace_back(radius * std::cos(angle), radius * std::sin(angle));
+      }
+      return makePath(points);
+    };
+
+  const double tolerance = 0.01;
+  nav2_planner::PathDecimator decimator(tolerance, 0.0);
+  auto tight = arc(1.0), wide = arc(4.0);
+  const auto tight_original = tight, wide_original = wide;
+  decimator.decimate(tight);
+  decimator.decimate(wide);
+  EXPECT_LT(tight.poses.size(), tight_original.poses.size() / 3);
+  EXPECT_LT(wide.poses.size(), wide_original.poses.size() / 3);
+
+  // Sharper curves keep poses more densely
+  EXPECT_GT(tight.poses.size() / M_PI, wide.poses.size() / (4.0 * M_PI));
+
+  // All of the poses dropped are within the tolerance of the decimated path
+  for (const auto & pose : tight_original.poses) {
+    EXPECT_LE(distanceToPath(tight, pose.pose.position.x, pose.pose.position.y), tolerance);
+  }
+  for (const auto & pose : wide_original.poses) {
+    EXPECT_LE(distanceToPath(wide, pose.pose.position.x, pose.pose.position.y), tolerance);
+  }
+}
+
+TEST(PathDecimatorTest, testCusp)
+{
+  // Forward to 2 m then back to 1 m, on the same line
+  std::vector<std::pair<double, double>> points;
+  for (int i = 0; i <= 40; ++i) {
+    points.emplace_back(i * 0.05, 0.0);
+  }
+  for (int i = 39; i >= 20; --i) {
+    points.emplace_back(i * 0.05, 0.0);
+  }
+  auto path = makePath(points);
+  nav2_planner::PathDecimator(0.02, 0.0).decimate(path);
+  ASSERT_EQ(path.poses.size(), 3u);
+  EXPECT_DOUBLE_EQ(path.poses[1].pose.position.x, 2.0);
+  EXPECT_DOUBLE_EQ(path.poses[2].pose.position.x, 1.0);
+
+  // Paths too short to decimate are left as they are
+  path = makePath({{0.0, 0.0}, {0.04, 0.0}});
+  nav2_planner::PathDecimator(0.02, 0.0).decimate(path);
+  EXPECT_EQ(path.poses.size(), 2u);
+}
@@ -0,0 +1,224 @@
+// Copyright (c) 2022 Samsung Research America
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <cmath>
+#include <map>
+#include <memory>
+#include <utility>
+#include <vector>
+
+#include "gtest/gtest.h"
+#include "nav2_costmap_2d/cost_values.hpp"
+#include "nav2_costmap_2d/layer.hpp"
+#include "nav2_costmap_2d/layered_costmap.hpp"
+#include "nav2_planner/path_validity_monitor.hpp"
+
+// Sets the costs of a few cells, updating only the window around the cells changed since
+class CellsLayer : public nav2_costmap_2d::Layer
+{
+public:
+  void reset() override {}
+  bool isClearable() override {return false;}
+
+  void setCost(double x, double y, unsigned char cost)
+  {
+    unsigned int mx, my;
+    layered_costmap_->getCostmap()->worldToMap(x, y, mx, my);
+    costs_[{mx, my}] = cost;
+    changed_.push_back({x, y});
+  }
+
+  void updateBounds(
+    double, double, double, double * min_x, double * min_y, double * max_x,
+    double * max_y) override
+  {
+    for (const auto & point : changed_) {
+      *min_x = std::min(*min_x, point.first);
+      *min_y = std::min(*min_y, point.second);
+      *max_x = std::max(*max_x, point.first);
+      *max_y = std::max(*max_y, point.second);
+    }
+    changed_.clear();
+  }
+
+  void updateCosts(
+    nav2_costmap_2d::Costmap2D & master_grid, int min_i, int min_j, int max_i,
+    int max_j) override
+  {
+    for (const auto & cell : costs_) {
+      const int x = cell.first.first, y = cell.first.second;
+      if (x >= min_i && x < max_i && y >= min_j && y < max_j) {
+        master_grid.setCost(x, y, cell.second);
+      }
+    }
+  }
+
+  void setParent(nav2_costmap_2d::LayeredCostmap * parent)
+  {
+    layered_costmap_ = parent;
+  }
+
+protected:
+  std::map<std::pair<unsigned int, unsigned int>, unsigned char> costs_;
+  std::vector<std::pair<double, double>> changed_;
+};
+
+class PathValidityMonitorTest : public ::testing::Test
+{
+public:
+  PathValidityMonitorTest()
+  : layers_("map", false, false),
+    layer_(std::make_shared<CellsLayer>()),
+    monitor_(&layers_, 2)
+  {
+    layers_.resizeMap(100, 100, 0.1, 0.0, 0.0);
+    layer_->setParent(&layers_);
+    layers_.addPlugin(layer_);
+    layers_.updateMap(0.0, 0.0, 0.0);
+
+    // Along y = 5 m, from x = 1 m to 9 m
+    path_.header.frame_id = "map";
+    for (unsigned int i = 0; i <= 80; i++) {
+      geometry_msgs::msg::PoseStamped pose;
+      pose.pose.position.x = 1.0 + 0.1 * i;
+      pose.pose.position.y = 5.0;
+      path_.poses.push_back(pose);
+    }
+
+    for (const auto & corner : {std::make_pair(0.25, 0.25), std::make_pair(-0.25, 0.25),
+        std::make_pair(-0.25, -0.25), std::make_pair(0.25, -0.25)})
+    {
+      geometry_msgs::msg::Point point;
+      point.x = corner.first;
+      point.y = corner.second;
+      footprint_.push_back(point);
+    }
+  }
+
+  std::vector<int> check(unsigned int path_id, unsigned int start_index = 0)
+  {
+    std::vector<int> invalid_pose_indices;
+    EXPECT_TRUE(monitor_.checkPath(path_id, footprint_, start_index, invalid_pose_indices));
+    return invalid_pose_indices;
+  }
+
+  void setCost(double x, double y, unsigned char cost)
+  {
+    layer_->setCost(x, y, cost);
+    layers_.updateMap(0.0, 0.0, 0.0);
+  }
+
+protected:
+  nav2_costmap_2d::LayeredCostmap layers_;
+  std::shared_ptr<CellsLayer> layer_;
+  nav2_planner::PathValidityMonitor monitor_;
+  nav_msgs::msg::Path path_;
+  std::vector<geometry_msgs::msg::Point> footprint_;
+};
+
+TEST_F(PathValidityMonitorTest, testFootprintCollisions)
+{
+  const unsigned int path_id = monitor_.registerPath(path_);
+  ASSERT_NE(path_id, 0u);
+  ASSERT_NE(monitor_.getPath(path_id), nullptr);
+  EXPECT_EQ(monitor_.getPath(path_id)->poses.size(), path_.poses.size());
+  EXPECT_TRUE(check(path_id).empty());
+
+  // An obstacle off the path, under the footprint of the poses around it
+  setCost(5.05, 5.15, nav2_costmap_2d::LETHAL_OBSTACLE);
+  std::vector<int> invalid = check(path_id);
+  ASSERT_FALSE(invalid.empty());
+  for (int index : invalid) {
+    EXPECT_LE(std::fabs(path_.poses[index].pose.position.x - 5.05), 0.35);
+  }
+  EXPECT_TRUE(check(path_id, invalid.back() + 1).empty());
+
+  setCost(5.05, 5.15, nav2_costmap_2d::FREE_SPACE);
+  EXPECT_TRUE(check(path_id).empty());
+
+  // Inscribed costs only invalidate the poses on them
+  setCost(5.05, 5.15, nav2_costmap_2d::INSCRIBED_INFLATED_OBSTACLE);
+  EXPECT_TRUE(check(path_id).empty());
+  setCost(3.05, 5.05, nav2_costmap_2d::INSCRIBED_INFLATED_OBSTACLE);
+  invalid = check(path_id);
+  ASSERT_EQ(invalid.size(), 1u);
+  EXPECT_NEAR(path_.poses[invalid[0]].pose.position.x, 3.0, 0.11);
+
+  // Changes the monitor can't locate, such as resets, are found by a full check
+  {
+    auto costmap = layers_.getCostmap();
+    std::unique_lock<nav2_costmap_2d::Costmap2D::mutex_t> lock(*(costmap->getMutex()));
+    costmap->setCost(70, 50, nav2_costmap_2d::LETHAL_OBSTACLE);
+    layers_.markUpdated();
+  }
+  invalid = check(path_id);
+  ASSERT_GE(invalid.size(), 2u);
+  EXPECT_NEAR(path_.poses[invalid.back()].pose.position.x, 7.05, 0.35);
+
+  // A larger footprint sweeps more cells
+  std::vector<int> invalid_larger;
+  for (auto & point : footprint_) {
+    point.x *= 3.0;
+    point.y *= 3.0;
+  }
+  invalid_larger = check(path_id);
+  EXPECT_GT(invalid_larger.size(), invalid.size());
+}
+
+TEST_F(PathValidityMonitorTest, testSparsePoses)
+{
+  // A pose every meter, as along a decimated path
+  nav_msgs::msg::Path sparse_path;
+  sparse_path.header = path_.header;
+  for (unsigned int i = 0; i < path_.poses.size(); i += 10) {
+    sparse_path.poses.push_back(path_.poses[i]);
+  }
+  const unsigned int path_id = monitor_.registerPath(sparse_path);
+  EXPECT_TRUE(check(path_id).empty());
+
+  // An obstacle between the footprints of two poses is swept by the one before it
+  setCost(5.55, 5.15, nav2_costmap_2d::LETHAL_OBSTACLE);
+  std::vector<int> invalid = check(path_id);
+  ASSERT_EQ(invalid.size(), 1u);
+  EXPECT_NEAR(sparse_path.poses[invalid[0]].pose.position.x, 5.0, 1e-6);
+  setCost(5.55, 5.15, nav2_costmap_2d::FREE_SPACE);
+  EXPECT_TRUE(check(path_id).empty());
+
+  // As is an inscribed cost between them on the path
+  setCost(3.45, 5.05, nav2_costmap_2d::INSCRIBED_INFLATED_OBSTACLE);
+  invalid = check(path_id);
+  ASSERT_EQ(invalid.size(), 1u);
+  EXPECT_NEAR(sparse_path.poses[invalid[0]].pose.position.x, 3.0, 1e-6);
+}
+
+TEST_F(PathValidityMonitorTest, testRegistration)
+{
+  std::vector<int> invalid_pose_indices;
+  EXPECT_FALSE(monitor_.checkPath(0, footprint_, 0, invalid_pose_indices));
+
+  const unsigned int first = monitor_.registerPath(path_);
+  const unsigned int second = monitor_.registerPath(path_);
+  EXPECT_NE(first, second);
+  EXPECT_TRUE(monitor_.checkPath(first, footprint_, 0, invalid_pose_indices));
+
+  // Only the last two paths are kept
+  const unsigned int third = monitor_.registerPath(path_);
+  EXPECT_EQ(monitor_.getPath(first), nullptr);
+  EXPECT_FALSE(monitor_.checkPath(first, footprint_, 0, invalid_pose_indices));
+  EXPECT_TRUE(monitor_.checkPath(second, footprint_, 0, invalid_pose_indices));
+  EXPECT_TRUE(monitor_.checkPath(third, footprint_, 0, invalid_pose_indices));
+
+  monitor_.clear();
+  EXPECT_EQ(monitor_.getPath(third), nullptr);
+}
@@ -0,0 +1,242 @@
+// Copyright (c) 2022 Samsung Research America
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <cmath>
+#include <map>
+#include <memory>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "gtest/gtest.h"
+#include "nav2_costmap_2d/cost_values.hpp"
+#include "nav2_costmap_2d/layer.hpp"
+#include "nav2_costmap_2d/layered_costmap.hpp"
+#include "nav2_planner/plan_cache.hpp"
+#include "nav2_util/geometry_utils.hpp"
+
+// Sets the costs of a few cells, updating only the window around the cells changed since
+class CellsLayer : public nav2_costmap_2d::Layer
+{
+public:
+  void reset() override {}
+  bool isClearable() override {return false;}
+
+  void setCost(double x, double y, unsigned char cost)
+  {
+    unsigned int mx, my;
+    layered_costmap_->getCostmap()->worldToMap(x, y, mx, my);
+    costs_[{mx, my}] = cost;
+    changed_.push_back({x, y});
+  }
+
+  void updateBounds(
+    double, double, double, double * min_x, double * min_y, double * max_x,
+    double * max_y) override
+  {
+    for (const auto & point : changed_) {
+      *min_x = std::min(*min_x, point.first);
+      *min_y = std::min(*min_y, point.second);
+      *max_x = std::max(*max_x, point.first);
+      *max_y = std::max(*max_y, point.second);
+    }
+    changed_.clear();
+  }
+
+  void updateCosts(
+    nav2_costmap_2d::Costmap2D & master_grid, int min_i, int min_j, int max_i,
+    int max_j) override
+  {
+    for (const auto & cell : costs_) {
+      const int x = cell.first.first, y = cell.first.second;
+      if (x >= min_i && x < max_i && y >= min_j && y < max_j) {
+        master_grid.setCost(x, y, cell.second);
+      }
+    }
+  }
+
+  void setParent(nav2_costmap_2d::LayeredCostmap * parent)
+  {
+    layered_costmap_ = parent;
+  }
+
+protected:
+  std::map<std::pair<unsigned int, unsigned int>, unsigned char> costs_;
+  std::vector<std::pair<double, double>> changed_;
+};
+
+class PlanCacheTest : public ::testing::Test
+{
+public:
+  PlanCacheTest()
+  : layers_("map", false, false),
+    layer_(std::make_shared<CellsLayer>()),
+    cache_(&layers_, 2, 16)
+  {
+    layers_.resizeMap(100, 100, 0.1, 0.0, 0.0);
+    layer_->setParent(&layers_);
+    layers_.addPlugin(layer_);
+    layers_.updateMap(0.0, 0.0, 0.0);
+
+    // Along y = 5 m, from x = 1 m to 9 m
+    path_.header.frame_id = "map";
+    for (unsigned int i = 0; i <= 8; i++) {
+      path_.poses.push_back(pose(1.0 + i, 5.0, 0.0));
+    }
+  }
+
+  static geometry_msgs::msg::PoseStamped pose(double x, double y, double yaw)
+  {
+    geometry_msgs::msg::PoseStamped pose;
+    pose.header.frame_id = "map";
+    pose.pose.position.x = x;
+    pose.pose.position.y = y;
+    pose.pose.orientation = nav2_util::geometry_utils::orientationAroundZAxis(yaw);
+    return pose;
+  }
+
+  bool lookup(
+    const geometry_msgs::msg::PoseStamped & start, const geometry_msgs::msg::PoseStamped & goal,
+    const std::string & planner_id = "GridBased")
+  {
+    nav_msgs::msg::Path path;
+    return cache_.lookup(planner_id, start, goal, path);
+  }
+
+  void setCost(double x, double y, unsigned char cost)
+  {
+    layer_->setCost(x, y, cost);
+    layers_.updateMap(0.0, 0.0, 0.0);
+  }
+
+protected:
+  nav2_costmap_2d::LayeredCostmap layers_;
+  std::shared_ptr<CellsLayer> layer_;
+  nav2_planner::PlanCache cache_;
+  nav_msgs::msg::Path path_;
+};
+
+TEST_F(PlanCacheTest, testLookup)
+{
+  const auto start = pose(1.0, 5.0, 0.0), goal = pose(9.0, 5.0, 0.0);
+  EXPECT_FALSE(lookup(start, goal));
+  cache_.insert("GridBased", start, goal, path_, cache_.getUpdateCount());
+
+  // Poses in the same cells and heading bins get the plan, with its ends moved to them
+  nav_msgs::msg::Path path;
+  const auto near_start = pose(1.04, 5.04, 0.1), near_goal = pose(9.04, 5.04, 0.1);
+  ASSERT_TRUE(cache_.lookup("GridBased", near_start, near_goal, path));
+  ASSERT_EQ(path.poses.size(), path_.poses.size());
+  EXPECT_EQ(path.poses.front().pose, near_start.pose);
+  EXPECT_EQ(path.poses.back().pose, near_goal.pose);
+  EXPECT_EQ(path.poses[4].pose, path_.poses[4].pose);
+
+  // Other cells, headings or planners don't
+  EXPECT_FALSE(lookup(pose(1.2, 5.0, 0.0), goal));
+  EXPECT_FALSE(lookup(start, pose(9.0, 5.0, M_PI)));
+  EXPECT_FALSE(lookup(start, goal, "Other"));
+  EXPECT_FALSE(lookup(pose(-1.0, 5.0, 0.0), goal));
+
+  const auto statistics = cache_.getStatistics();
+  EXPECT_EQ(statistics.hits, 1u);
+  EXPECT_EQ(statistics.misses, 5u);
+  EXPECT_EQ(statistics.invalidations, 0u);
+
+  // Empty plans are not cached
+  cache_.insert("GridBased", goal, start, nav_msgs::msg::Path(), cache_.getUpdateCount());
+  EXPECT_FALSE(lookup(goal, start));
+}
+
+TEST_F(PlanCacheTest, testInvalidation)
+{
+  const auto start = pose(1.0, 5.0, 0.0), goal = pose(9.0, 5.0, 0.0);
+  cache_.insert("GridBased", start, goal, path_, cache_.getUpdateCount());
+
+  // Changes off the plan keep it, those of the cells between its poses drop it
+  setCost(5.0, 8.0, nav2_costmap_2d::LETHAL_OBSTACLE);
+  EXPECT_TRUE(lookup(start, goal));
+  setCost(5.0, 2.0, nav2_costmap_2d::LETHAL_OBSTACLE);
+  EXPECT_TRUE(lookup(start, goal));
+  setCost(4.55, 5.0, nav2_costmap_2d::LETHAL_OBSTACLE);
+  EXPECT_FALSE(lookup(start, goal));
+  EXPECT_EQ(cache_.getStatistics().invalidations, 1u);
+  setCost(4.55, 5.0, nav2_costmap_2d::FREE_SPACE);
+  EXPECT_FALSE(lookup(start, goal));
+  EXPECT_EQ(cache_.getStatistics().invalidations, 1u);
+
+  // Plans planned before a change they may have missed are dropped as well
+  const uint64_t update_count = cache_.getUpdateCount();
+  setCost(4.55, 5.0, nav2_costmap_2d::LETHAL_OBSTACLE);
+  cache_.insert("GridBased", start, goal, path_, update_count);
+  EXPECT_FALSE(lookup(start, goal));
+
+  // Changes that can't be located drop all of the plans
+  cache_.insert("GridBased", start, goal, path_, cache_.getUpdateCount());
+  EXPECT_TRUE(lookup(start, goal));
+  {
+    auto costmap = layers_.getCostmap();
+    std::unique_lock<nav2_costmap_2d::Costmap2D::mutex_t> lock(*(costmap->getMutex()));
+    costmap->setCost(20, 80, nav2_costmap_2d::LETHAL_OBSTACLE);
+    layers_.markUpdated();
+  }
+  EXPECT_FALSE(lookup(start, goal));
+}
+
+TEST_F(PlanCacheTest, testFootprintMargin)
+{
+  // A 0.5 m square footprint, reaching 0.36 m from the cells of the plan
+  std::vector<geometry_msgs::msg::Point> footprint;
+  for (const auto & corner : {std::make_pair(0.25, 0.25), std::make_pair(-0.25, 0.25),
+      std::make_pair(-0.25, -0.25), std::make_pair(0.25, -0.25)})
+  {
+    geometry_msgs::msg::Point point;
+    point.x = corner.first;
+    point.y = corner.second;
+    footprint.push_back(point);
+  }
+  layers_.setFootprint(footprint);
+
+  const auto start = pose(1.0, 5.0, 0.0), goal = pose(9.0, 5.0, 0.0);
+  cache_.insert("GridBased", start, goal, path_, cache_.getUpdateCount());
+
+  // Changes out of the reach of the footprint keep the plan, those under it drop it
+  setCost(4.55, 5.75, nav2_costmap_2d::LETHAL_OBSTACLE);
+  EXPECT_TRUE(lookup(start, goal));
+  setCost(4.55, 5.25, nav2_costmap_2d::LETHAL_OBSTACLE);
+  EXPECT_FALSE(lookup(start, goal));
+  EXPECT_EQ(cache_.getStatistics().invalidations, 1u);
+}
+
+TEST_F(PlanCacheTest, testEviction)
+{
+  const auto a = pose(1.0, 5.0, 0.0), b = pose(9.0, 5.0, 0.0), c = pose(5.0, 1.0, 0.0);
+  cache_.insert("GridBased", a, b, path_, cache_.getUpdateCount());
+  cache_.insert("GridBased", b, a, path_, cache_.getUpdateCount());
+
+  // Only the two most recently used plans are kept
+  EXPECT_TRUE(lookup(a, b));
+  cache_.insert("GridBased", a, c, path_, cache_.getUpdateCount());
+  EXPECT_TRUE(lookup(a, b));
+  EXPECT_TRUE(lookup(a, c));
+  EXPECT_FALSE(lookup(b, a));
+
+  // Inserting a plan again replaces it
+  cache_.insert("GridBased", a, c, path_, cache_.getUpdateCount());
+  EXPECT_TRUE(lookup(a, b));
+  EXPECT_TRUE(lookup(a, c));
+
+  cache_.clear();
+  EXPECT_FALSE(lookup(a, b));
+  EXPECT_FALSE(lookup(a, c));
+}
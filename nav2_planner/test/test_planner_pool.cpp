@@ -0,0 +1,376 @@
+// Copyright (c) 2022 Samsung Research America
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License. Reserved.
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <functional>
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "gtest/gtest.h"
+#include "nav2_costmap_2d/costmap_2d_ros.hpp"
+#include "nav2_planner/planner_pool.hpp"
+#include "nav2_smac_planner/smac_planner_2d.hpp"
+#include "nav2_smac_planner/smac_planner_hybrid.hpp"
+#include "rclcpp/rclcpp.hpp"
+
+class RclCppFixture
+{
+public:
+  RclCppFixture() {rclcpp::init(0, nullptr);}
+  ~RclCppFixture() {rclcpp::shutdown();}
+};
+RclCppFixture g_rclcppfixture;
+
+// Returns the goal as path after a while, failing if used by two threads at once
+class FakePlanner : public nav2_core::GlobalPlanner
+{
+public:
+  explicit FakePlanner(std::atomic<int> & planning)
+  : planning_(planning) {}
+
+  void configure(
+    const rclcpp_lifecycle::LifecycleNode::WeakPtr &, std::string,
+    std::shared_ptr<tf2_ros::Buffer>, std::shared_ptr<nav2_costmap_2d::Costmap2DROS>) override {}
+  void cleanup() override {}
+  void activate() override {}
+  void deactivate() override {}
+
+  nav_msgs::msg::Path createPlan(
+    const geometry_msgs::msg::PoseStamped & start,
+    const geometry_msgs::msg::PoseStamped & goal) override
+  {
+    EXPECT_FALSE(in_use_.exchange(true));
+    max_planning_ = std::max(max_planning_.load(), ++planning_);
+    std::this_thread::sleep_for(std::chrono::milliseconds(5));
+    --planning_;
+    in_use_ = false;
+
+    if (goal.pose.position.x < 0.0) {
+      throw std::runtime_error("Unreachable goal");
+    }
+    nav_msgs::msg::Path path;
+    path.poses.push_back(start);
+    path.poses.push_back(goal);
+    return path;
+  }
+
+  static std::atomic<int> max_planning_;
+
+protected:
+  std::atomic<int> & planning_;
+  std::atomic<bool> in_use_{false};
+};
+
+std::atomic<int> FakePlanner::max_planning_{0};
+
+TEST(PlannerPoolTest, testConcurrentPlans)
+{
+  std::atomic<int> planning{0};
+  std::vector<nav2_planner::PlannerPool::PlannerMap> planners(3);
+  for (auto & worker_planners : planners) {
+    worker_planners["GridBased"] = std::make_shared<FakePlanner>(planning);
+  }
+
+  nav2_planner::PlannerPool pool(
+    std::move(planners),
+    [](nav2_planner::PlannerPool::PlannerMap & planners,
+    const geometry_msgs::msg::PoseStamped & start,
+    const geometry_msgs::msg::PoseStamped & goal, const std::string & planner_id,
+    nav2_planner::PlannerPool::CancelChecker cancel_checker) {
+      return planners.at(planner_id)->createPlan(start, goal, cancel_checker);
+    });
+  EXPECT_EQ(pool.size(), 3u);
+
+  std::vector<geometry_msgs::msg::PoseStamped> starts(12), goals(12);
+  for (size_t i = 0; i != goals.size(); i++) {
+    starts[i].pose.position.y = i;
+    goals[i].pose.position.x = i == 5 ? -1.0 : i;
+  }
+
+  // Batches from several threads are planned concurrently, each worker with its own planners
+  std::vector<nav_msgs::msg::Path> other_paths;
+  std::thread other([&]() {other_paths = pool.plan(starts, goals, "GridBased");});
+  auto paths = pool.plan(starts, goals, "GridBased");
+  other.join();
+  EXPECT_GT(FakePlanner::max_planning_, 1);
+  EXPECT_LE(FakePlanner::max_planning_, 3);
+
+  // and the paths are in the order of the goals, empty for the failed or invalid ones
+  for (const auto & batch_paths : {paths, other_paths}) {
+    ASSERT_EQ(batch_paths.size(), goals.size());
+    for (size_t i = 0; i != goals.size(); i++) {
+      if (i == 5) {
+        EXPECT_TRUE(batch_paths[i].poses.empty());
+        continue;
+      }
+      ASSERT_EQ(batch_paths[i].poses.size(), 2u);
+      EXPECT_EQ(batch_paths[i].poses[0].pose.position.y, i);
+      EXPECT_EQ(batch_paths[i].poses[1].pose.position.x, i);
+    }
+  }
+
+  EXPECT_TRUE(pool.plan({}, {}, "GridBased").empty());
+  EXPECT_TRUE(pool.plan({starts[0]}, {goals[0]}, "Unknown")[0].poses.empty());
+}
+
+// Returns a straight path to the goal after a given time, or fails
+class TimedPlanner : public nav2_core::GlobalPlanner
+{
+public:
+  TimedPlanner(int duration_ms, int poses, std::atomic<int> & plans)
+  : duration_ms_(duration_ms), poses_(poses), plans_(plans) {}
+
+  void configure(
+    const rclcpp_lifecycle::LifecycleNode::WeakPtr &, std::string,
+    std::shared_ptr<tf2_ros::Buffer>, std::shared_ptr<nav2_costmap_2d::Costmap2DROS>) override {}
+  void cleanup() override {}
+  void activate() override {}
+  void deactivate() override {}
+
+  nav_msgs::msg::Path createPlan(
+    const geometry_msgs::msg::PoseStamped &,
+    const geometry_msgs::msg::PoseStamped & goal) override
+  {
+    ++plans_;
+    std::this_thread::sleep_for(std::chrono::milliseconds(duration_ms_));
+    nav_msgs::msg::Path path;
+    for (int i = 0; i < poses_; i++) {
+      path.poses.push_back(goal);
+      path.poses.back().pose.position.y = i;
+    }
+    return path;
+  }
+
+protected:
+  int duration_ms_;
+  int poses_;
+  std::atomic<int> & plans_;
+};
+
+TEST(PlannerPoolTest, testRace)
+{
+  // Fast planners give longer paths, Failing gives none
+  std::atomic<int> plans{0};
+  std::vector<nav2_planner::PlannerPool::PlannerMap> planners(3);
+  for (auto & worker_planners : planners) {
+    worker_planners["Fast"] = std::make_shared<TimedPlanner>(5, 4, plans);
+    worker_planners["Slow"] = std::make_shared<TimedPlanner>(100, 2, plans);
+    worker_planners["Failing"] = std::make_shared<TimedPlanner>(1, 0, plans);
+  }
+
+  nav2_planner::PlannerPool pool(
+    std::move(planners),
+    [](nav2_planner::PlannerPool::PlannerMap & planners,
+    const geometry_msgs::msg::PoseStamped & start,
+    const geometry_msgs::msg::PoseStamped & goal, const std::string & planner_id,
+    nav2_planner::PlannerPool::CancelChecker cancel_checker) {
+      return planners.at(planner_id)->createPlan(start, goal, cancel_checker);
+    });
+
+  geometry_msgs::msg::PoseStamped start, goal;
+
+  // Without deadline, the first valid path wins, without waiting for the slower planners
+  auto start_time = std::chrono::steady_clock::now();
+  auto result = pool.race(start, goal, {"Slow", "Failing", "Fast"}, std::chrono::nanoseconds(0));
+  EXPECT_LT(std::chrono::steady_clock::now() - start_time, std::chrono::milliseconds(90));
+  EXPECT_EQ(result.planner_id, "Fast");
+  EXPECT_EQ(result.path.poses.size(), 4u);
+
+  // With a deadline, the shortest path found by then wins
+  result = pool.race(start, goal, {"Fast", "Slow"}, std::chrono::milliseconds(500));
+  EXPECT_EQ(result.planner_id, "Slow");
+  EXPECT_EQ(result.path.poses.size(), 2u);
+
+  // or the first one found after it
+  result = pool.race(start, goal, {"Slow", "Failing"}, std::chrono::milliseconds(10));
+  EXPECT_EQ(result.planner_id, "Slow");
+
+  result = pool.race(start, goal, {"Failing", "Failing"}, std::chrono::nanoseconds(0));
+  EXPECT_TRUE(result.path.poses.empty());
+  EXPECT_TRUE(result.planner_id.empty());
+  EXPECT_TRUE(pool.race(start, goal, {}, std::chrono::nanoseconds(0)).path.poses.empty());
+
+  // The planners which did not start by the time the race is decided are dropped
+  std::this_thread::sleep_for(std::chrono::milliseconds(200));
+  plans = 0;
+  result = pool.race(
+    start, goal, {"Fast", "Slow", "Slow", "Slow", "Slow", "Slow"}, std::chrono::nanoseconds(0));
+  EXPECT_EQ(result.planner_id, "Fast");
+  std::this_thread::sleep_for(std::chrono::milliseconds(200));
+  EXPECT_LT(plans, 6);
+}
+
+// Plans until cancelled, or with others of a group planning at the same time
+class CancellablePlanner : public nav2_core::GlobalPlanner
+{
+public:
+  explicit CancellablePlanner(std::atomic<int> * group = nullptr)
+  : group_(group) {}
+
+  void configure(
+    const rclcpp_lifecycle::LifecycleNode::WeakPtr &, std::string,
+    std::shared_ptr<tf2_ros::Buffer>, std::shared_ptr<nav2_costmap_2d::Costmap2DROS>) override {}
+  void cleanup() override {}
+  void activate() override {}
+  void deactivate() override {}
+
+  nav_msgs::msg::Path createPlan(
+    const geometry_msgs::msg::PoseStamped & start,
+    const geometry_msgs::msg::PoseStamped & goal) override
+  {
+    return createPlan(start, goal, std::function<bool()>());
+  }
+
+  nav_msgs::msg::Path createPlan(
+    const geometry_msgs::msg::PoseStamped &,
+    const geometry_msgs::msg::PoseStamped & goal,
+    std::function<bool()> cancel_checker) override
+  {
+    nav_msgs::msg::Path path;
+    if (group_) {
+      ++*group_;
+    }
+    auto give_up_time = std::chrono::steady_clock::now() + std::chrono::seconds(2);
+    while (std::chrono::steady_clock::now() < give_up_time) {
+      if (cancel_checker && cancel_checker()) {
+        return path;
+      }
+      if (group_ && *group_ >= 2) {
+        path.poses.push_back(goal);
+        return path;
+      }
+      std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+    return path;
+  }
+
+protected:
+  std::atomic<int> * group_;
+};
+
+TEST(PlannerPoolTest, testRaceCancelsLosers)
+{
+  std::atomic<int> group{0}, planning{0};
+  std::vector<nav2_planner::PlannerPool::PlannerMap> planners(2);
+  for (auto & worker_planners : planners) {
+    worker_planners["Endless"] = std::make_shared<CancellablePlanner>();
+    worker_planners["Pair"] = std::make_shared<CancellablePlanner>(&group);
+    worker_planners["Fast"] = std::make_shared<FakePlanner>(planning);
+  }
+
+  nav2_planner::PlannerPool pool(
+    std::move(planners),
+    [](nav2_planner::PlannerPool::PlannerMap & planners,
+    const geometry_msgs::msg::PoseStamped & start,
+    const geometry_msgs::msg::PoseStamped & goal, const std::string & planner_id,
+    nav2_planner::PlannerPool::CancelChecker cancel_checker) {
+      return planners.at(planner_id)->createPlan(start, goal, cancel_checker);
+    });
+
+  geometry_msgs::msg::PoseStamped start, goal;
+  auto result = pool.race(start, goal, {"Endless", "Fast"}, std::chrono::nanoseconds(0));
+  EXPECT_EQ(result.planner_id, "Fast");
+
+  // The loser planning when the race is decided is cancelled rather than keeping its worker,
+  // so that a follow-up batch can be planned by both of the workers at once
+  auto start_time = std::chrono::steady_clock::now();
+  auto paths = pool.plan({start, start}, {goal, goal}, "Pair");
+  EXPECT_LT(std::chrono::steady_clock::now() - start_time, std::chrono::seconds(1));
+  ASSERT_EQ(paths.size(), 2u);
+  EXPECT_EQ(paths[0].poses.size(), 1u);
+  EXPECT_EQ(paths[1].poses.size(), 1u);
+}
+
+TEST(PlannerPoolTest, testConcurrentSmacPlanners)
+{
+  auto node = std::make_shared<rclcpp_lifecycle::LifecycleNode>("PlannerPoolSmacTest");
+  auto costmap_ros = std::make_shared<nav2_costmap_2d::Costmap2DROS>("global_costmap");
+  costmap_ros->on_configure(rclcpp_lifecycle::State());
+
+  // Two instances of each Smac planner, one per worker
+  std::vector<nav2_planner::PlannerPool::PlannerMap> planners(2);
+  for (auto & worker_planners : planners) {
+    worker_planners["GridBased"] = std::make_shared<nav2_smac_planner::SmacPlanner2D>();
+    worker_planners["Hybrid"] = std::make_shared<nav2_smac_planner::SmacPlannerHybrid>();
+    for (auto & planner : worker_planners) {
+      planner.second->configure(node, planner.first, nullptr, costmap_ros);
+      planner.second->activate();
+    }
+  }
+  auto planners_copy = planners;
+
+  std::vector<geometry_msgs::msg::PoseStamped> starts(6), goals(6);
+  for (size_t i = 0; i != goals.size(); i++) {
+    starts[i].pose.position.x = 0.5;
+    starts[i].pose.position.y = 0.5 + 0.5 * i;
+    starts[i].pose.orientation.w = 1.0;
+    goals[i].pose.position.x = 4.0;
+    goals[i].pose.position.y = 4.0 - 0.5 * i;
+    goals[i].pose.orientation.w = 1.0;
+  }
+
+  // The paths planned by one instance alone
+  std::vector<nav_msgs::msg::Path> expected_2d, expected_hybrid;
+  for (size_t i = 0; i != goals.size(); i++) {
+    expected_2d.push_back(planners_copy[0]["GridBased"]->createPlan(starts[i], goals[i]));
+    expected_hybrid.push_back(planners_copy[1]["Hybrid"]->createPlan(starts[i], goals[i]));
+  }
+
+  nav2_planner::PlannerPool pool(
+    std::move(planners),
+    [](nav2_planner::PlannerPool::PlannerMap & planners,
+    const geometry_msgs::msg::PoseStamped & start,
+    const geometry_msgs::msg::PoseStamped & goal, const std::string & planner_id,
+    nav2_planner::PlannerPool::CancelChecker cancel_checker) {
+      return planners.at(planner_id)->createPlan(start, goal, cancel_checker);
+    });
+
+  // are the same when both instances of a planner, and of the other type, plan concurrently,
+  // as each instance searches with state of its own
+  std::vector<nav_msgs::msg::Path> paths_hybrid;
+  std::thread other([&]() {paths_hybrid = pool.plan(starts, goals, "Hybrid");});
+  auto paths_2d = pool.plan(starts, goals, "GridBased");
+  other.join();
+
+  auto expect_same = [](
+    const std::vector<nav_msgs::msg::Path> & paths,
+    const std::vector<nav_msgs::msg::Path> & expected) {
+      ASSERT_EQ(paths.size(), expected.size());
+      for (size_t i = 0; i != paths.size(); i++) {
+        ASSERT_FALSE(expected[i].poses.empty());
+        ASSERT_EQ(paths[i].poses.size(), expected[i].poses.size());
+        for (size_t j = 0; j != paths[i].poses.size(); j++) {
+          EXPECT_NEAR(
+            paths[i].poses[j].pose.position.x, expected[i].poses[j].pose.position.x, 1e-6);
+          EXPECT_NEAR(
+            paths[i].poses[j].pose.position.y, expected[i].poses[j].pose.position.y, 1e-6);
+        }
+      }
+    };
+  expect_same(paths_2d, expected_2d);
+  expect_same(paths_hybrid, expected_hybrid);
+
+  for (auto & worker_planners : planners_copy) {
+    for (auto & planner : worker_planners) {
+      planner.second->deactivate();
+      planner.second->cleanup();
+    }
+  }
+  costmap_ros->on_cleanup(rclcpp_lifecycle::State());
+}
@@ -245,7 +245,7 @@ protected:
   geometry_msgs::msg::PoseStamped getLookAheadPoint(const double &, const nav_msgs::msg::Path &);
 
   /**
-   * @brief checks for the cusp position
+   * @brief checks for the cusp position, the first cusp of the plan not passed by the robot
    * @param pose Pose input to determine the cusp position
    * @return robot distance from the cusp
    */
@@ -299,12 +299,20 @@ protected:
   bool use_interpolation_;
 
   nav_msgs::msg::Path global_plan_;
+  // Index of the first pose of the plan not passed by the robot yet, with the path length up
+  // to each pose and the indices of the cusps, computed once per plan so that each cycle only
+  // covers the window of the plan around the robot
+  size_t plan_start_index_{0};
+  std::vector<double> plan_lengths_;
+  std::vector<size_t> plan_cusps_;
   std::shared_ptr<rclcpp_lifecycle::LifecyclePublisher<nav_msgs::msg::Path>> global_path_pub_;
   std::shared_ptr<rclcpp_lifecycle::LifecyclePublisher<geometry_msgs::msg::PointStamped>>
   carrot_pub_;
   std::shared_ptr<rclcpp_lifecycle::LifecyclePublisher<nav_msgs::msg::Path>> carrot_arc_pub_;
   std::unique_ptr<nav2_costmap_2d::FootprintCollisionChecker<nav2_costmap_2d::Costmap2D *>>
   collision_checker_;
+  // Poses of the arc projected by the collision lookahead
+  std::vector<geometry_msgs::msg::Pose2D> projected_poses_;
 
   // Dynamic parameters handler
   std::mutex mutex_;
@@ -188,6 +188,8 @@ void RegulatedPurePursuitController::configure(
   collision_checker_ = std::make_unique<nav2_costmap_2d::
       FootprintCollisionChecker<nav2_costmap_2d::Costmap2D *>>(costmap_);
   collision_checker_->setCostmap(costmap_);
+  collision_checker_->setCostmapPyramid(
+    &costmap_ros_->getLayeredCostmap()->getCostmapPyramid());
 }
 
 void RegulatedPurePursuitController::cleanup()
@@ -454,6 +456,9 @@ bool RegulatedPurePursuitController::isCollisionImminent(
   // Note(stevemacenski): This may be a bit unusual, but the robot_pose is in
   // odom frame and the carrot_pose is in robot base frame.
 
+  // the costmap pyramid of the collision checker is updated along with the costmap
+  std::unique_lock<nav2_costmap_2d::Costmap2D::mutex_t> lock(*(costmap_->getMutex()));
+
   // check current point is OK
   if (inCollision(
       robot_pose.pose.position.x, robot_pose.pose.position.y,
@@ -493,6 +498,7 @@ bool RegulatedPurePursuitController::isCollisionImminent(
   curr_pose.theta = tf2::getYaw(robot_pose.pose.orientation);
 
   // only forward simulate within time requested
+  projected_poses_.clear();
   int i = 1;
   while (i * projection_time < max_allowed_time_to_collision_up_to_carrot_) {
     i++;
@@ -507,22 +513,33 @@ bool RegulatedPurePursuitController::isCollisionImminent(
       break;
     }
 
-    // store it for visualization
-    pose_msg.pose.position.x = curr_pose.x;
-    pose_msg.pose.position.y = curr_pose.y;
-    pose_msg.pose.position.z = 0.01;
-    arc_pts_msg.poses.push_back(pose_msg);
+    projected_poses_.push_back(curr_pose);
+  }
 
-    // check for collision at the projected pose
-    if (inCollision(curr_pose.x, curr_pose.y, curr_pose.theta)) {
-      carrot_arc_pub_->publish(arc_pts_msg);
-      return true;
-    }
+  // The footprints of the whole arc are swept at once, so that only the poses with a
+  // lethal footprint cost are checked for collision one by one
+  const nav2_costmap_2d::Footprint footprint = costmap_ros_->getRobotFootprint();
+  size_t collision = collision_checker_->findFootprintCostAtPoses(
+    projected_poses_, footprint, static_cast<double>(LETHAL_OBSTACLE));
+  while (collision < projected_poses_.size() &&
+    !inCollision(
+      projected_poses_[collision].x, projected_poses_[collision].y,
+      projected_poses_[collision].theta))
+  {
+    collision = collision_checker_->findFootprintCostAtPoses(
+      projected_poses_, footprint, static_cast<double>(LETHAL_OBSTACLE), collision + 1);
   }
 
+  // store the arc up to the collision, if any, for visualization
+  for (size_t j = 0; j < projected_poses_.size() && j <= collision; ++j) {
+    pose_msg.pose.position.x = projected_poses_[j].x;
+    pose_msg.pose.position.y = projected_poses_[j].y;
+    pose_msg.pose.position.z = 0.01;
+    arc_pts_msg.poses.push_back(pose_msg);
+  }
   carrot_arc_pub_->publish(arc_pts_msg);
 
-  return false;
+  return collision < projected_poses_.size();
 }
 
 bool RegulatedPurePursuitController::inCollision(
@@ -631,6 +648,24 @@ void RegulatedPurePursuitController::applyConstraints(
 void RegulatedPurePursuitController::setPlan(const nav_msgs::msg::Path & path)
 {
   global_plan_ = path;
+  plan_start_index_ = 0;
+  plan_lengths_ = nav2_util::geometry_utils::calculate_cumulative_path_lengths(path);
+
+  // A cusp is a pose where the direction of the path reverses, with the dot product
+  // of the segments before and after it negative
+  plan_cusps_.clear();
+  for (size_t pose_id = 1; pose_id + 1 < path.poses.size(); ++pose_id) {
+    const auto & prev = path.poses[pose_id - 1].pose.position;
+    const auto & curr = path.poses[pose_id].pose.position;
+    const auto & next = path.poses[pose_id + 1].pose.position;
+    const double oa_x = curr.x - prev.x;
+    const double oa_y = curr.y - prev.y;
+    const double ab_x = next.x - curr.x;
+    const double ab_y = next.y - curr.y;
+    if ((oa_x * ab_x) + (oa_y * ab_y) < 0.0) {
+      plan_cusps_.push_back(pose_id);
+    }
+  }
 }
 
 void RegulatedPurePursuitController::setSpeedLimit(
@@ -667,16 +702,20 @@ nav_msgs::msg::Path RegulatedPurePursuitController::transformGlobalPlan(
   // We'll discard points on the plan that are outside the local costmap
   double max_costmap_extent = getCostmapMaxExtent();
 
-  auto closest_pose_upper_bound =
-    nav2_util::geometry_utils::first_after_integrated_distance(
-    global_plan_.poses.begin(), global_plan_.poses.end(), max_robot_pose_search_dist_);
+  // The poses already passed are skipped, and the search for the closest pose is bounded by
+  // the first pose further along the path than max_robot_pose_search_dist_
+  auto plan_start = global_plan_.poses.begin() + plan_start_index_;
+  auto closest_pose_upper_bound = global_plan_.poses.begin() +
+    (std::upper_bound(
+      plan_lengths_.begin() + plan_start_index_, plan_lengths_.end(),
+      plan_lengths_[plan_start_index_] + max_robot_pose_search_dist_) - plan_lengths_.begin());
 
   // First find the closest pose on the path to the robot
   // bounded by when the path turns around (if it does) so we don't get a pose from a later
   // portion of the path
   auto transformation_begin =
     nav2_util::geometry_utils::min_by(
-    global_plan_.poses.begin(), closest_pose_upper_bound,
+    plan_start, closest_pose_upper_bound,
     [&robot_pose](const geometry_msgs::msg::PoseStamped & ps) {
       return euclidean_distance(robot_pose, ps);
     });
@@ -699,17 +738,46 @@ nav_msgs::msg::Path RegulatedPurePursuitController::transformGlobalPlan(
     };
 
   // Transform the near part of the global plan into the robot's frame of reference.
+  // All of the poses are stamped with the time of the robot pose, so the transform is
+  // looked up once for all of them rather than for each pose, unless it is not available
   nav_msgs::msg::Path transformed_plan;
-  std::transform(
-    transformation_begin, transformation_end,
-    std::back_inserter(transformed_plan.poses),
-    transformGlobalPoseToLocal);
+  transformed_plan.poses.reserve(transformation_end - transformation_begin);
+  geometry_msgs::msg::TransformStamped plan_to_base;
+  bool have_transform = global_plan_.header.frame_id != costmap_ros_->getBaseFrameID();
+  if (have_transform) {
+    try {
+      plan_to_base = tf_->lookupTransform(
+        costmap_ros_->getBaseFrameID(), global_plan_.header.frame_id,
+        tf2_ros::fromMsg(robot_pose.header.stamp), transform_tolerance_);
+    } catch (tf2::TransformException &) {
+      have_transform = false;
+    }
+  }
+  if (have_transform) {
+    std::transform(
+      transformation_begin, transformation_end,
+      std::back_inserter(transformed_plan.poses),
+      [&](const auto & global_plan_pose) {
+        geometry_msgs::msg::PoseStamped stamped_pose, transformed_pose;
+        stamped_pose.header.frame_id = global_plan_.header.frame_id;
+        stamped_pose.header.stamp = robot_pose.header.stamp;
+        stamped_pose.pose = global_plan_pose.pose;
+        tf2::doTransform(stamped_pose, transformed_pose, plan_to_base);
+        transformed_pose.header.frame_id = costmap_ros_->getBaseFrameID();
+        return transformed_pose;
+      });
+  } else {
+    std::transform(
+      transformation_begin, transformation_end,
+      std::back_inserter(transformed_plan.poses),
+      transformGlobalPoseToLocal);
+  }
   transformed_plan.header.frame_id = costmap_ros_->getBaseFrameID();
   transformed_plan.header.stamp = robot_pose.header.stamp;
 
-  // Remove the portion of the global plan that we've already passed so we don't
+  // Skip the portion of the global plan that we've already passed so we don't
   // process it on the next iteration (this is called path pruning)
-  global_plan_.poses.erase(begin(global_plan_.poses), transformation_begin);
+  plan_start_index_ = transformation_begin - global_plan_.poses.begin();
   global_path_pub_->publish(transformed_plan);
 
   if (transformed_plan.poses.empty()) {
@@ -722,26 +790,14 @@ nav_msgs::msg::Path RegulatedPurePursuitController::transformGlobalPlan(
 double RegulatedPurePursuitController::findVelocitySignChange(
   const geometry_msgs::msg::PoseStamped & pose)
 {
-  // Iterating through the global path to determine the position of the cusp
-  for (unsigned int pose_id = 1; pose_id < global_plan_.poses.size() - 1; ++pose_id) {
-    // We have two vectors for the dot product OA and AB. Determining the vectors.
-    double oa_x = global_plan_.poses[pose_id].pose.position.x -
-      global_plan_.poses[pose_id - 1].pose.position.x;
-    double oa_y = global_plan_.poses[pose_id].pose.position.y -
-      global_plan_.poses[pose_id - 1].pose.position.y;
-    double ab_x = global_plan_.poses[pose_id + 1].pose.position.x -
-      global_plan_.poses[pose_id].pose.position.x;
-    double ab_y = global_plan_.poses[pose_id + 1].pose.position.y -
-      global_plan_.poses[pose_id].pose.position.y;
-
-    /* Checking for the existance of cusp, in the path, using the dot product
-    and determine it's distance from the robot. If there is no cusp in the path,
-    then just determine the distance to the goal location. */
-    if ( (oa_x * ab_x) + (oa_y * ab_y) < 0.0) {
-      auto x = global_plan_.poses[pose_id].pose.position.x - pose.pose.position.x;
-      auto y = global_plan_.poses[pose_id].pose.position.y - pose.pose.position.y;
-      return hypot(x, y);  // returning the distance if there is a cusp
-    }
+  /* Checking for the existance of cusp, in the path not passed yet, and determine it's
+  distance from the robot. If there is no cusp in the path, then just determine the
+  distance to the goal location. */
+  auto cusp = std::upper_bound(plan_cusps_.begin(), plan_cusps_.end(), plan_start_index_);
+  if (cusp != plan_cusps_.end()) {
+    auto x = global_plan_.poses[*cusp].pose.position.x - pose.pose.position.x;
+    auto y = global_plan_.poses[*cusp].pose.position.y - pose.pose.position.y;
+    return hypot(x, y);  // returning the distance if there is a cusp
   }
 
   return std::numeric_limits<double>::max();
@@ -961,3 +961,48 @@ TEST_F(TransformGlobalPlanTest, prune_after_leaving_costmap)
   EXPECT_NEAR(transformed_plan.poses[0].pose.position.x, 0.0, 0.5);
   EXPECT_NEAR(transformed_plan.poses[0].pose.position.y, 0.0, 0.5);
 }
+
+// The cusps passed by the robot are skipped once the plan is pruned
+TEST_F(TransformGlobalPlanTest, prune_passed_cusps)
+{
+  geometry_msgs::msg::PoseStamped robot_pose;
+  robot_pose.header.frame_id = COSTMAP_FRAME;
+  robot_pose.header.stamp = transform_time_;
+  robot_pose.pose.position.x = 1.5;
+  robot_pose.pose.position.y = 0.5;
+  robot_pose.pose.position.z = 0.0;
+
+  configure_costmap(100u, 0.1);
+  configure_controller(10.0);
+  setup_transforms(robot_pose.pose.position);
+
+  // Set up a path with cusps at (2, 0) and (0, 2)
+  nav_msgs::msg::Path global_plan;
+  global_plan.header.frame_id = PATH_FRAME;
+  global_plan.header.stamp = transform_time_;
+  auto add_pose = [&](double x, double y) {
+      geometry_msgs::msg::PoseStamped pose;
+      pose.header = global_plan.header;
+      pose.pose.position.x = x;
+      pose.pose.position.y = y;
+      global_plan.poses.push_back(pose);
+    };
+  for (int k = 0; k <= 20; ++k) {
+    add_pose(0.1 * k, 0.0);
+  }
+  for (int k = 1; k <= 20; ++k) {
+    add_pose(2.0 - 0.1 * k, 0.1 * k);
+  }
+  for (int k = 1; k <= 20; ++k) {
+    add_pose(0.1 * k, 2.0 + 0.02 * k);
+  }
+
+  ctrl_->setPlan(global_plan);
+  EXPECT_NEAR(ctrl_->findVelocitySignChangeWrapper(robot_pose), std::sqrt(0.5), 1e-6);
+
+  // The robot is past the first cusp, on the second segment
+  auto transformed_plan = ctrl_->transformGlobalPlanWrapper(robot_pose);
+  EXPECT_EQ(transformed_plan.poses.size(), global_plan.poses.size() - 25u);
+  EXPECT_NEAR(ctrl_->findVelocitySignChangeWrapper(robot_pose), std::sqrt(4.5), 1e-6);
+  EXPECT_EQ(ctrl_->getPlan().poses.size(), global_plan.poses.size());
+}
@@ -29,7 +29,7 @@
 #include "nav2_core/controller.hpp"
 #include "nav2_core/exceptions.hpp"
 #include "nav2_util/node_utils.hpp"
-#include "nav2_costmap_2d/footprint_collision_checker.hpp"
+#include "nav2_rotation_shim_controller/rotation_sweep.hpp"
 #include "angles/angles.h"
 
 namespace nav2_rotation_shim_controller
@@ -158,8 +158,7 @@ protected:
   rclcpp::Logger logger_ {rclcpp::get_logger("RotationShimController")};
   rclcpp::Clock::SharedPtr clock_;
   std::shared_ptr<nav2_costmap_2d::Costmap2DROS> costmap_ros_;
-  std::unique_ptr<nav2_costmap_2d::FootprintCollisionChecker<nav2_costmap_2d::Costmap2D *>>
-  collision_checker_;
+  std::unique_ptr<RotationSweep> rotation_sweep_;
 
   pluginlib::ClassLoader<nav2_core::Controller> lp_loader_;
   nav2_core::Controller::Ptr primary_controller_;
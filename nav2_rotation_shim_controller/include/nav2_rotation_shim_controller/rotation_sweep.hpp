@@ -0,0 +1,113 @@
+// Copyright (c) 2022 Samsung Research America
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef NAV2_ROTATION_SHIM_CONTROLLER__ROTATION_SWEEP_HPP_
+#define NAV2_ROTATION_SHIM_CONTROLLER__ROTATION_SWEEP_HPP_
+
+#include <cstdint>
+#include <vector>
+
+#include "nav2_costmap_2d/footprint_collision_checker.hpp"
+#include "nav2_costmap_2d/layered_costmap.hpp"
+
+namespace nav2_rotation_shim_controller
+{
+
+/**
+ * @class nav2_rotation_shim_controller::RotationSweep
+ * @brief Checks rotations in place against the costmap. The outlines of the footprint
+ * over the headings of a rotation are rasterized once into the cells they sweep, each
+ * with the range of headings covering it. The cost of the cells is cached, and only read
+ * again in the windows changed by the costmap updates, so a rotation checked on each
+ * control cycle seldom reads the costmap. The sweep is computed again when the robot
+ * leaves its cell, changes of direction or footprint, rotates past the sweep, or when
+ * the whole costmap may have changed.
+ */
+class RotationSweep
+{
+public:
+  /**
+   * @brief A constructor for nav2_rotation_shim_controller::RotationSweep
+   * @param layered_costmap Costmap to check the rotations against, outliving the sweep
+   */
+  explicit RotationSweep(nav2_costmap_2d::LayeredCostmap * layered_costmap);
+
+  /**
+   * @brief Find the cost of the footprint over a rotation in place, as the highest cost
+   * of its outlines at the headings of the rotation after the current one. Outlines
+   * leaving the costmap are lethal. The costmap mutex must be held.
+   * @param x Position of the robot
+   * @param y Position of the robot
+   * @param yaw Current heading of the robot
+   * @param angle Rotation to check, positive counterclockwise
+   * @param sweep_angle Rotation to compute the sweep over if computed again, at least
+   * angle, so that the following rotations of the maneuver reuse it
+   * @param footprint Footprint of the robot, unoriented
+   * @return Cost of the footprint
+   */
+  double rotationCost(
+    double x, double y, double yaw, double angle, double sweep_angle,
+    const nav2_costmap_2d::Footprint & footprint);
+
+  /**
+   * @brief Drop the sweep, e.g. on a new maneuver
+   */
+  void reset();
+
+protected:
+  struct SweepCell
+  {
+    int x, y;
+    // Range of rotation steps covering the cell
+    unsigned int first_step, last_step;
+    unsigned char cost;
+  };
+
+  /**
+   * @brief Get the number of raster headings in a rotation, at least one
+   */
+  unsigned int countSteps(double angle) const;
+
+  /**
+   * @brief Rasterize the outlines of the footprint over the steps of the sweep
+   */
+  void computeSweep(unsigned int steps);
+
+  /**
+   * @brief Read again the cost of the cells of the sweep in a window of the costmap
+   */
+  void updateCosts(int x0, int y0, int xn, int yn);
+
+  nav2_costmap_2d::LayeredCostmap * layered_costmap_;
+  nav2_costmap_2d::FootprintCollisionChecker<nav2_costmap_2d::Costmap2D *> collision_checker_;
+
+  nav2_costmap_2d::Footprint footprint_;
+  unsigned int num_headings_{0};
+  double resolution_{0.0};
+
+  bool computed_{false};
+  unsigned int cell_x_{0}, cell_y_{0};
+  unsigned int start_heading_{0};
+  int direction_{1};
+  unsigned int steps_{0};
+  uint64_t update_count_{0};
+  // Cells swept, sorted in row-major order, as offsets from the cell of the robot
+  std::vector<SweepCell> cells_;
+  int min_x_{0}, min_y_{0}, max_x_{0}, max_y_{0};
+  std::vector<nav2_costmap_2d::LayeredCostmap::ChangedWindow> windows_;
+};
+
+}  // namespace nav2_rotation_shim_controller
+
+#endif  // NAV2_ROTATION_SHIM_CONTROLLER__ROTATION_SWEEP_HPP_
@@ -88,9 +88,8 @@ void RotationShimController::configure(
 
   primary_controller_->configure(parent, name, tf, costmap_ros);
 
-  // initialize collision checker and set costmap
-  collision_checker_ = std::make_unique<nav2_costmap_2d::
-      FootprintCollisionChecker<nav2_costmap_2d::Costmap2D *>>(costmap_ros->getCostmap());
+  // initialize the rotation collision checking on the costmap
+  rotation_sweep_ = std::make_unique<RotationSweep>(costmap_ros->getLayeredCostmap());
 }
 
 void RotationShimController::activate()
@@ -133,6 +132,7 @@ void RotationShimController::cleanup()
 
   primary_controller_->cleanup();
   primary_controller_.reset();
+  rotation_sweep_.reset();
 }
 
 geometry_msgs::msg::TwistStamped RotationShimController::computeVelocityCommands(
@@ -234,37 +234,37 @@ void RotationShimController::isCollisionFree(
   const double & angular_distance_to_heading,
   const geometry_msgs::msg::PoseStamped & pose)
 {
-  // Simulate rotation ahead by time in control frequency increments
-  double simulated_time = 0.0;
-  double initial_yaw = tf2::getYaw(pose.pose.orientation);
-  double yaw = 0.0;
-  double footprint_cost = 0.0;
-  double remaining_rotation_before_thresh =
+  // Check the rotation ahead by the simulation time, stopping past the point it would be
+  // passed onto the primary controller. The sweep of the footprint covers the rest of
+  // the rotation to the heading, to be reused by the following cycles of the maneuver.
+  const double angular_vel = cmd_vel.twist.angular.z;
+  const double remaining_rotation_before_thresh =
     fabs(angular_distance_to_heading) - angular_dist_threshold_;
-
-  while (simulated_time < simulate_ahead_time_) {
-    simulated_time += control_duration_;
-    yaw = initial_yaw + cmd_vel.twist.angular.z * simulated_time;
-
-    // Stop simulating past the point it would be passed onto the primary controller
-    if (angles::shortest_angular_distance(yaw, initial_yaw) >= remaining_rotation_before_thresh) {
-      break;
-    }
-
-    using namespace nav2_costmap_2d;  // NOLINT
-    footprint_cost = collision_checker_->footprintCostAtPose(
-      pose.pose.position.x, pose.pose.position.y,
-      yaw, costmap_ros_->getRobotFootprint());
-
-    if (footprint_cost == static_cast<double>(NO_INFORMATION) &&
-      costmap_ros_->getLayeredCostmap()->isTrackingUnknown())
-    {
-      throw std::runtime_error("RotationShimController detected a potential collision ahead!");
+  double rotation = fabs(angular_vel) * simulate_ahead_time_;
+  double sweep_rotation = rotation;
+  if ((angular_vel >= 0.0) == (angular_distance_to_heading >= 0.0)) {
+    if (remaining_rotation_before_thresh <= 0.0) {
+      return;
     }
+    rotation = std::min(rotation, remaining_rotation_before_thresh);
+    sweep_rotation = remaining_rotation_before_thresh;
+  }
+  const double sign = angular_vel < 0.0 ? -1.0 : 1.0;
+
+  using namespace nav2_costmap_2d;  // NOLINT
+  std::unique_lock<Costmap2D::mutex_t> lock(*(costmap_ros_->getCostmap()->getMutex()));
+  const double footprint_cost = rotation_sweep_->rotationCost(
+    pose.pose.position.x, pose.pose.position.y, tf2::getYaw(pose.pose.orientation),
+    sign * rotation, sign * sweep_rotation, costmap_ros_->getRobotFootprint());
+
+  if (footprint_cost == static_cast<double>(NO_INFORMATION) &&
+    costmap_ros_->getLayeredCostmap()->isTrackingUnknown())
+  {
+    throw std::runtime_error("RotationShimController detected a potential collision ahead!");
+  }
 
-    if (footprint_cost >= static_cast<double>(LETHAL_OBSTACLE)) {
-      throw std::runtime_error("RotationShimController detected collision ahead!");
-    }
+  if (footprint_cost >= static_cast<double>(LETHAL_OBSTACLE)) {
+    throw std::runtime_error("RotationShimController detected collision ahead!");
   }
 }
 
@@ -272,6 +272,7 @@ void RotationShimController::setPlan(const nav_msgs::msg::Path & path)
 {
   path_updated_ = true;
   current_path_ = path;
+  rotation_sweep_->reset();
   primary_controller_->setPlan(path);
 }
 
@@ -0,0 +1,201 @@
+// Copyright (c) 2022 Samsung Research America
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "nav2_rotation_shim_controller/rotation_sweep.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <vector>
+
+#include "nav2_costmap_2d/cost_values.hpp"
+
+namespace nav2_rotation_shim_controller
+{
+
+RotationSweep::RotationSweep(nav2_costmap_2d::LayeredCostmap * layered_costmap)
+: layered_costmap_(layered_costmap),
+  collision_checker_(layered_costmap->getCostmap())
+{
+}
+
+double RotationSweep::rotationCost(
+  double x, double y, double yaw, double angle, double sweep_angle,
+  const nav2_costmap_2d::Footprint & footprint)
+{
+  nav2_costmap_2d::Costmap2D * costmap = layered_costmap_->getCostmap();
+  unsigned int mx, my;
+  if (footprint.empty() || !costmap->worldToMap(x, y, mx, my)) {
+    return static_cast<double>(nav2_costmap_2d::LETHAL_OBSTACLE);
+  }
+
+  // Headings of the rasters are close enough for the outline to move by about a cell
+  // from one to the next
+  if (footprint != footprint_ || resolution_ != costmap->getResolution()) {
+    double radius = 0.0;
+    for (const auto & point : footprint) {
+      radius = std::max(radius, std::hypot(point.x, point.y));
+    }
+    num_headings_ = static_cast<unsigned int>(
+      std::clamp(std::ceil(2.0 * M_PI * radius / costmap->getResolution()), 8.0, 1024.0));
+    collision_checker_.setFootprintRaster(footprint, num_headings_);
+    footprint_ = footprint;
+    resolution_ = costmap->getResolution();
+    computed_ = false;
+  }
+
+  const int N = static_cast<int>(num_headings_);
+  int heading = static_cast<int>(std::lround(yaw * N / (2.0 * M_PI)) % N);
+  if (heading < 0) {
+    heading += N;
+  }
+  const int direction = angle < 0.0 ? -1 : 1;
+  const unsigned int steps = countSteps(angle);
+
+  // Steps of the sweep already rotated through
+  unsigned int current_step = 0;
+  if (computed_) {
+    current_step = static_cast<unsigned int>(
+      (((heading - static_cast<int>(start_heading_)) * direction) % N + N) % N);
+  }
+
+  // The sweep is only kept while the costmap keeps its geometry, in which case only
+  // the windows changed since need to be read again
+  if (!computed_ || mx != cell_x_ || my != cell_y_ || direction != direction_ ||
+    current_step + steps > steps_ ||
+    !layered_costmap_->getChangedWindows(update_count_, windows_))
+  {
+    cell_x_ = mx;
+    cell_y_ = my;
+    start_heading_ = static_cast<unsigned int>(heading);
+    direction_ = direction;
+    current_step = 0;
+    computeSweep(std::max(steps, countSteps(sweep_angle)));
+    updateCosts(0, 0, costmap->getSizeInCellsX(), costmap->getSizeInCellsY());
+  } else {
+    for (const auto & window : windows_) {
+      updateCosts(window.x0, window.y0, window.xn, window.yn);
+    }
+  }
+  update_count_ = layered_costmap_->getUpdateCount();
+
+  // Cells covered by the outlines of the headings after the current one
+  const unsigned int first_step = current_step + 1;
+  const unsigned int last_step = current_step + steps;
+  unsigned char rotation_cost = 0;
+  for (const auto & cell : cells_) {
+    if (cell.first_step <= last_step && cell.last_step >= first_step) {
+      if (cell.cost == nav2_costmap_2d::LETHAL_OBSTACLE) {
+        return static_cast<double>(nav2_costmap_2d::LETHAL_OBSTACLE);
+      }
+      rotation_cost = std::max(rotation_cost, cell.cost);
+    }
+  }
+  return static_cast<double>(rotation_cost);
+}
+
+unsigned int RotationSweep::countSteps(double angle) const
+{
+  const double steps = std::round(std::fabs(angle) * num_headings_ / (2.0 * M_PI));
+  return static_cast<unsigned int>(std::clamp(steps, 1.0, static_cast<double>(num_headings_)));
+}
+
+void RotationSweep::reset()
+{
+  computed_ = false;
+  cells_.clear();
+}
+
+void RotationSweep::computeSweep(unsigned int steps)
+{
+  const double step_angle = 2.0 * M_PI / num_headings_;
+  cells_.clear();
+  for (unsigned int step = 1; step <= steps; ++step) {
+    const int heading = static_cast<int>(start_heading_) + direction_ * static_cast<int>(step);
+    for (const auto & cell : collision_checker_.getFootprintRaster(heading * step_angle)) {
+      cells_.push_back({cell.first, cell.second, step, step, 0});
+    }
+  }
+
+  // Merge the runs of steps covering each cell
+  std::sort(
+    cells_.begin(), cells_.end(),
+    [](const SweepCell & a, const SweepCell & b) {
+      return a.y < b.y || (a.y == b.y && a.x < b.x) ||
+      (a.y == b.y && a.x == b.x && a.first_step < b.first_step);
+    });
+  size_t merged = 0;
+  for (size_t i = 0; i < cells_.size(); ++i) {
+    if (merged > 0) {
+      SweepCell & last = cells_[merged - 1];
+      if (last.x == cells_[i].x && last.y == cells_[i].y &&
+        cells_[i].first_step <= last.last_step + 1)
+      {
+        last.last_step = std::max(last.last_step, cells_[i].last_step);
+        continue;
+      }
+    }
+    cells_[merged++] = cells_[i];
+  }
+  cells_.resize(merged);
+
+  // As with the vertices of the footprint, cells off the costmap are lethal
+  min_x_ = min_y_ = max_x_ = max_y_ = 0;
+  if (!cells_.empty()) {
+    min_y_ = cells_.front().y;
+    max_y_ = cells_.back().y;
+    min_x_ = max_x_ = cells_.front().x;
+  }
+  nav2_costmap_2d::Costmap2D * costmap = layered_costmap_->getCostmap();
+  const int size_x = static_cast<int>(costmap->getSizeInCellsX());
+  const int size_y = static_cast<int>(costmap->getSizeInCellsY());
+  for (auto & cell : cells_) {
+    min_x_ = std::min(min_x_, cell.x);
+    max_x_ = std::max(max_x_, cell.x);
+    const int x = static_cast<int>(cell_x_) + cell.x;
+    const int y = static_cast<int>(cell_y_) + cell.y;
+    if (x < 0 || y < 0 || x >= size_x || y >= size_y) {
+      cell.cost = nav2_costmap_2d::LETHAL_OBSTACLE;
+    }
+  }
+  steps_ = steps;
+  computed_ = true;
+}
+
+void RotationSweep::updateCosts(int x0, int y0, int xn, int yn)
+{
+  // Windows in offsets from the cell of the robot, clamped to the costmap
+  nav2_costmap_2d::Costmap2D * costmap = layered_costmap_->getCostmap();
+  const int cx = static_cast<int>(cell_x_);
+  const int cy = static_cast<int>(cell_y_);
+  x0 = std::max(x0, 0) - cx;
+  y0 = std::max(y0, 0) - cy;
+  xn = std::min(xn, static_cast<int>(costmap->getSizeInCellsX())) - cx;
+  yn = std::min(yn, static_cast<int>(costmap->getSizeInCellsY())) - cy;
+  if (x0 > max_x_ || xn <= min_x_ || y0 > max_y_ || yn <= min_y_) {
+    return;
+  }
+
+  const unsigned char * costs = costmap->getCharMap();
+  const int size_x = static_cast<int>(costmap->getSizeInCellsX());
+  auto cell = std::lower_bound(
+    cells_.begin(), cells_.end(), y0,
+    [](const SweepCell & a, int row) {return a.y < row;});
+  for (; cell != cells_.end() && cell->y < yn; ++cell) {
+    if (cell->x >= x0 && cell->x < xn) {
+      cell->cost = costs[(cy + cell->y) * size_x + cx + cell->x];
+    }
+  }
+}
+
+}  // namespace nav2_rotation_shim_controller
@@ -0,0 +1,152 @@
+// Copyright (c) 2022 Samsung Research America
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <algorithm>
+#include <cmath>
+#include <map>
+#include <memory>
+#include <utility>
+#include <vector>
+
+#include "gtest/gtest.h"
+#include "nav2_costmap_2d/cost_values.hpp"
+#include "nav2_costmap_2d/layer.hpp"
+#include "nav2_costmap_2d/layered_costmap.hpp"
+#include "nav2_rotation_shim_controller/rotation_sweep.hpp"
+
+// Sets the costs of a few cells, updating only the window around the cells changed since
+class CellsLayer : public nav2_costmap_2d::Layer
+{
+public:
+  void reset() override {}
+  bool isClearable() override {return false;}
+
+  void setCost(double x, double y, unsigned char cost)
+  {
+    unsigned int mx, my;
+    layered_costmap_->getCostmap()->worldToMap(x, y, mx, my);
+    costs_[{mx, my}] = cost;
+    changed_.push_back({x, y});
+  }
+
+  void updateBounds(
+    double, double, double, double * min_x, double * min_y, double * max_x,
+    double * max_y) override
+  {
+    for (const auto & point : changed_) {
+      *min_x = std::min(*min_x, point.first);
+      *min_y = std::min(*min_y, point.second);
+      *max_x = std::max(*max_x, point.first);
+      *max_y = std::max(*max_y, point.second);
+    }
+    changed_.clear();
+  }
+
+  void updateCosts(
+    nav2_costmap_2d::Costmap2D & master_grid, int min_i, int min_j, int max_i,
+    int max_j) override
+  {
+    for (const auto & cell : costs_) {
+      const int x = cell.first.first, y = cell.first.second;
+      if (x >= min_i && x < max_i && y >= min_j && y < max_j) {
+        master_grid.setCost(x, y, cell.second);
+      }
+    }
+  }
+
+  void setParent(nav2_costmap_2d::LayeredCostmap * parent)
+  {
+    layered_costmap_ = parent;
+  }
+
+protected:
+  std::map<std::pair<unsigned int, unsigned int>, unsigned char> costs_;
+  std::vector<std::pair<double, double>> changed_;
+};
+
+class RotationSweepTest : public ::testing::Test
+{
+public:
+  RotationSweepTest()
+  : layers_("map", false, false),
+    layer_(std::make_shared<CellsLayer>())
+  {
+    layers_.resizeMap(100, 100, 0.1, 0.0, 0.0);
+    layer_->setParent(&layers_);
+    layers_.addPlugin(layer_);
+    layers_.updateMap(0.0, 0.0, 0.0);
+    sweep_ = std::make_unique<nav2_rotation_shim_controller::RotationSweep>(&layers_);
+
+    // Long along x, so that only rotating sweeps its sides over the cells beside it
+    for (const auto & corner : {std::make_pair(0.5, 0.1), std::make_pair(-0.5, 0.1),
+        std::make_pair(-0.5, -0.1), std::make_pair(0.5, -0.1)})
+    {
+      geometry_msgs::msg::Point point;
+      point.x = corner.first;
+      point.y = corner.second;
+      footprint_.push_back(point);
+    }
+  }
+
+  double cost(double angle, double sweep_angle, double x = 5.05, double yaw = 0.0)
+  {
+    return sweep_->rotationCost(x, 5.05, yaw, angle, sweep_angle, footprint_);
+  }
+
+  void setCost(double x, double y, unsigned char cost)
+  {
+    layer_->setCost(x, y, cost);
+    layers_.updateMap(0.0, 0.0, 0.0);
+  }
+
+protected:
+  nav2_costmap_2d::LayeredCostmap layers_;
+  std::shared_ptr<CellsLayer> layer_;
+  std::unique_ptr<nav2_rotation_shim_controller::RotationSweep> sweep_;
+  nav2_costmap_2d::Footprint footprint_;
+};
+
+TEST_F(RotationSweepTest, testRotationCollisions)
+{
+  EXPECT_EQ(cost(1.6, 1.6), 0.0);
+
+  // An obstacle beside the robot, only reached by the sides past a quarter of a turn
+  setCost(5.05, 5.45, nav2_costmap_2d::LETHAL_OBSTACLE);
+  EXPECT_EQ(cost(1.6, 1.6), 254.0);
+  EXPECT_EQ(cost(0.6, 1.6), 0.0);
+  EXPECT_EQ(cost(-0.6, -1.6), 0.0);
+  EXPECT_EQ(cost(-1.6, -1.6), 254.0);
+
+  // Costs below lethal are reported as the highest
+  setCost(5.05, 5.45, 100);
+  EXPECT_EQ(cost(1.6, 1.6), 100.0);
+  setCost(5.05, 5.45, nav2_costmap_2d::FREE_SPACE);
+  EXPECT_EQ(cost(1.6, 1.6), 0.0);
+
+  // Resetting the costmap reads the whole sweep again
+  setCost(5.05, 5.45, nav2_costmap_2d::LETHAL_OBSTACLE);
+  layers_.markUpdated();
+  EXPECT_EQ(cost(1.6, 1.6), 254.0);
+  sweep_->reset();
+  EXPECT_EQ(cost(0.6, 0.6), 0.0);
+}
+
+TEST_F(RotationSweepTest, testRotationOffCostmap)
+{
+  // Close to the edge, the ends of the footprint leave the costmap when across it
+  EXPECT_EQ(cost(0.3, 0.3, 0.35, M_PI_2), 0.0);
+  EXPECT_EQ(cost(-0.3, -0.3, 0.35, M_PI_2), 0.0);
+  EXPECT_EQ(cost(1.5, 1.5, 0.35, M_PI_2), 254.0);
+  EXPECT_EQ(cost(0.3, 0.3, -1.0), 254.0);
+}
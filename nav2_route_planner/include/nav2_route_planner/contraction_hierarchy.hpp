@@ -0,0 +1,132 @@
+// Copyright (c) 2022 Samsung Research America
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef NAV2_ROUTE_PLANNER__CONTRACTION_HIERARCHY_HPP_
+#define NAV2_ROUTE_PLANNER__CONTRACTION_HIERARCHY_HPP_
+
+#include <cstdint>
+#include <limits>
+#include <vector>
+
+#include "nav2_route_planner/route_graph.hpp"
+
+namespace nav2_route_planner
+{
+
+/**
+ * @class nav2_route_planner::ContractionHierarchy
+ * @brief The contraction hierarchy of a RouteGraph, answering shortest route queries with
+ * two small Dijkstra searches rather than one over the whole graph.
+ *
+ * The nodes are contracted one at a time, least important first, each being removed from the
+ * graph along with shortcuts between its neighbors where it lies on their only shortest route.
+ * A query then searches from both ends along edges towards nodes contracted later only, the
+ * shortest route being that through the node where the searches meet at the lowest cost.
+ */
+class ContractionHierarchy
+{
+public:
+  /**
+   * @brief Contract a graph, replacing any previous hierarchy
+   */
+  void build(const RouteGraph & graph);
+
+  /**
+   * @brief Find the shortest route between two nodes of the graph
+   * @param route Output nodes of the route, from start to goal, along edges of the graph
+   * @param cost Output cost of the route
+   * @return False if the goal is unreachable
+   */
+  bool query(
+    unsigned int start, unsigned int goal, std::vector<unsigned int> & route, double & cost);
+
+  /**
+   * @brief Get the number of nodes of the hierarchy
+   */
+  size_t size() const {return upward_.size();}
+
+  /**
+   * @brief Get the number of shortcuts added by the contraction
+   */
+  size_t shortcuts() const {return shortcuts_;}
+
+protected:
+  static constexpr unsigned int NONE = std::numeric_limits<unsigned int>::max();
+
+  /**
+   * @struct Arc
+   * @brief An edge or shortcut, the latter replacing the edges to and from its middle node
+   */
+  struct Arc
+  {
+    unsigned int to;
+    double cost;
+    unsigned int middle;
+  };
+
+  /**
+   * @struct Search
+   * @brief The state of a Dijkstra search, reset in constant time by stamping the costs
+   */
+  struct Search
+  {
+    void reset(size_t size);
+    double cost(unsigned int node) const;
+    void set(unsigned int node, double cost, unsigned int parent, unsigned int middle);
+
+    std::vector<double> costs;
+    std::vector<unsigned int> parents, middles;
+    std::vector<uint32_t> stamps;
+    uint32_t stamp{0};
+  };
+
+  /**
+   * @brief Count the shortcuts needed to contract a node, contracting it if apply is set
+   */
+  int contract(unsigned int node, bool apply);
+
+  /**
+   * @brief Search the costs of the routes from a remaining node up to a cost avoiding another,
+   * in witness_ once reset, until the targets stamped in targets_ are settled or after
+   * settling a number of nodes. Routes found are witnesses that a shortcut is not needed,
+   * while routes missed only add needless shortcuts.
+   */
+  void searchWitnesses(
+    unsigned int from, unsigned int avoid, double max_cost, size_t targets, int max_settled);
+
+  /**
+   * @brief Append the nodes of the graph along an arc to a route, after its start
+   * @param middle Middle node of the arc if a shortcut, NONE otherwise
+   */
+  void unpack(
+    unsigned int from, unsigned int to, unsigned int middle,
+    std::vector<unsigned int> & route) const;
+
+  // Arcs of each node to those contracted after it
+  std::vector<std::vector<Arc>> upward_;
+  size_t shortcuts_{0};
+
+  // Arcs between the nodes not contracted yet, and their counts of contracted neighbors,
+  // during the build
+  std::vector<std::vector<Arc>> remaining_;
+  std::vector<int> contracted_neighbors_;
+  // Nodes stamped with the witness search they are the targets of
+  std::vector<uint32_t> targets_;
+
+  Search witness_, forward_, backward_;
+};
+
+}  // namespace nav2_route_planner
+
+#endif  // NAV2_ROUTE_PLANNER__CONTRACTION_HIERARCHY_HPP_
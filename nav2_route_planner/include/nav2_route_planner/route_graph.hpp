@@ -0,0 +1,113 @@
+// Copyright (c) 2022 Samsung Research America
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef NAV2_ROUTE_PLANNER__ROUTE_GRAPH_HPP_
+#define NAV2_ROUTE_PLANNER__ROUTE_GRAPH_HPP_
+
+#include <functional>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "nav2_costmap_2d/costmap_2d.hpp"
+
+namespace nav2_route_planner
+{
+
+/**
+ * @class nav2_route_planner::RouteGraph
+ * @brief A sparse roadmap of a site, of nodes in the costmap frame joined by undirected edges
+ * whose costs are at least their length
+ */
+class RouteGraph
+{
+public:
+  /**
+   * @struct Node
+   * @brief A node of the graph and its edges
+   */
+  struct Node
+  {
+    double x, y;
+    std::vector<std::pair<unsigned int, double>> edges;  ///< Other ends and costs
+  };
+
+  /**
+   * @brief Add a node to the graph
+   * @return The index of the node
+   */
+  unsigned int addNode(double x, double y);
+
+  /**
+   * @brief Add an undirected edge between two nodes, keeping the lowest cost of duplicates
+   * @param cost Cost of the edge, its length if negative
+   */
+  void addEdge(unsigned int a, unsigned int b, double cost = -1.0);
+
+  /**
+   * @brief Get the distance between two nodes
+   */
+  double distance(unsigned int a, unsigned int b) const;
+
+  /**
+   * @brief Get the nodes within a radius of a point, nearest first
+   */
+  std::vector<unsigned int> nodesNear(double x, double y, double radius) const;
+
+  const std::vector<Node> & nodes() const {return nodes_;}
+  size_t size() const {return nodes_.size();}
+  void clear() {nodes_.clear();}
+
+protected:
+  std::vector<Node> nodes_;
+};
+
+/**
+ * @brief Load a graph from a YAML file, of a list `nodes` of [x, y] positions and a
+ * list `edges` of [a, b] or [a, b, cost] node indices, throwing std::runtime_error if invalid
+ */
+void loadRouteGraph(const std::string & filename, RouteGraph & graph);
+
+/**
+ * @brief Whether the cells of the segment between two points all cost less than a maximum
+ */
+bool isSegmentFree(
+  const nav2_costmap_2d::Costmap2D & costmap, double x0, double y0, double x1, double y1,
+  unsigned char max_cost);
+
+/**
+ * @brief Generate a graph over the free space of a costmap, of nodes on a lattice and edges
+ * between the nodes within a radius of each other that are in line of sight
+ * @param node_spacing Spacing of the lattice, in meters
+ * @param connection_radius Longest edges, in meters
+ * @param max_cost Lowest cost of the cells blocking nodes and edges
+ */
+void generateRouteGraph(
+  const nav2_costmap_2d::Costmap2D & costmap, double node_spacing, double connection_radius,
+  unsigned char max_cost, RouteGraph & graph);
+
+/**
+ * @brief Find the shortest route between two nodes with A*, skipping blocked edges
+ * @param blocked Whether the edge between two nodes is blocked, all edges are open if unset
+ * @param route Output nodes of the route, from start to goal
+ * @return False if the goal is unreachable
+ */
+bool findRoute(
+  const RouteGraph & graph, unsigned int start, unsigned int goal,
+  const std::function<bool(unsigned int, unsigned int)> & blocked,
+  std::vector<unsigned int> & route);
+
+}  // namespace nav2_route_planner
+
+#endif  // NAV2_ROUTE_PLANNER__ROUTE_GRAPH_HPP_
@@ -0,0 +1,140 @@
+// Copyright (c) 2022 Samsung Research America
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef NAV2_ROUTE_PLANNER__ROUTE_PLANNER_HPP_
+#define NAV2_ROUTE_PLANNER__ROUTE_PLANNER_HPP_
+
+#include <future>
+#include <limits>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "rclcpp/rclcpp.hpp"
+#include "nav2_core/global_planner.hpp"
+#include "nav_msgs/msg/path.hpp"
+#include "nav2_costmap_2d/costmap_2d_ros.hpp"
+#include "nav2_util/lifecycle_node.hpp"
+#include "pluginlib/class_loader.hpp"
+#include "nav2_route_planner/contraction_hierarchy.hpp"
+#include "nav2_route_planner/route_graph.hpp"
+
+namespace nav2_route_planner
+{
+
+/**
+ * @class nav2_route_planner::RoutePlanner
+ * @brief A global planner routing along a sparse roadmap of the site, loaded from a file or
+ * generated over the costmap, whose shortest routes are found with a contraction hierarchy.
+ * The legs from the start to the roadmap and from the roadmap to the goal are planned by
+ * another global planner plugin, which also plans the whole path between nearby poses.
+ */
+class RoutePlanner : public nav2_core::GlobalPlanner
+{
+public:
+  /**
+   * @brief A constructor for nav2_route_planner::RoutePlanner
+   */
+  RoutePlanner();
+
+  /**
+   * @brief A destructor for nav2_route_planner::RoutePlanner
+   */
+  ~RoutePlanner();
+
+  void configure(
+    const rclcpp_lifecycle::LifecycleNode::WeakPtr & parent,
+    std::string name, std::shared_ptr<tf2_ros::Buffer> tf,
+    std::shared_ptr<nav2_costmap_2d::Costmap2DROS> costmap_ros) override;
+
+  void cleanup() override;
+
+  void activate() override;
+
+  void deactivate() override;
+
+  nav_msgs::msg::Path createPlan(
+    const geometry_msgs::msg::PoseStamped & start,
+    const geometry_msgs::msg::PoseStamped & goal) override;
+
+protected:
+  /**
+   * @brief Generate the roadmap again if the costmap was resized or moved since, starting to
+   * build its hierarchy in the background
+   * @return False if there is no roadmap
+   */
+  bool updateGraph();
+
+  /**
+   * @brief Start building the hierarchy of the roadmap in the background
+   */
+  void buildHierarchy();
+
+  /**
+   * @brief Find the roadmap node to join or leave it at, the nearest in line of sight or the
+   * nearest if the legs are planned by the local planner
+   * @return NONE if no node is near enough
+   */
+  unsigned int findEndNode(const geometry_msgs::msg::PoseStamped & pose);
+
+  /**
+   * @brief Find the shortest route along the roadmap that is free in the costmap, skipping
+   * the edges found blocked by the routes found before
+   * @return False if there is no free route
+   */
+  bool findFreeRoute(unsigned int start, unsigned int goal, std::vector<unsigned int> & route);
+
+  /**
+   * @brief Append the path between two poses to a path, planned by the local planner if set
+   * or along their segment otherwise
+   * @return False if no path was found
+   */
+  bool appendLeg(
+    const geometry_msgs::msg::PoseStamped & start,
+    const geometry_msgs::msg::PoseStamped & goal, nav_msgs::msg::Path & path);
+
+  /**
+   * @brief Append the poses along a segment to a path, every costmap cell, without its start
+   */
+  void appendSegment(double x0, double y0, double x1, double y1, nav_msgs::msg::Path & path);
+
+  static constexpr unsigned int NONE = std::numeric_limits<unsigned int>::max();
+
+  rclcpp::Clock::SharedPtr clock_;
+  rclcpp::Logger logger_{rclcpp::get_logger("RoutePlanner")};
+  std::string global_frame_, name_;
+  std::shared_ptr<nav2_costmap_2d::Costmap2DROS> costmap_ros_;
+  nav2_costmap_2d::Costmap2D * costmap_;
+
+  std::string graph_filename_;
+  double node_spacing_, connection_radius_, end_radius_, direct_planning_distance_;
+  unsigned char blocking_cost_;
+
+  // The planner of the legs to and from the roadmap, if any
+  pluginlib::ClassLoader<nav2_core::GlobalPlanner> planner_loader_;
+  nav2_core::GlobalPlanner::Ptr local_planner_;
+
+  // The roadmap and the costmap geometry it was generated for
+  std::shared_ptr<const RouteGraph> graph_;
+  unsigned int graph_size_x_{0}, graph_size_y_{0};
+  double graph_origin_x_{0.0}, graph_origin_y_{0.0}, graph_resolution_{0.0};
+
+  // The hierarchy of the roadmap once built, the roadmap being searched with A* until then
+  std::unique_ptr<ContractionHierarchy> hierarchy_;
+  std::future<std::unique_ptr<ContractionHierarchy>> hierarchy_build_;
+};
+
+}  // namespace nav2_route_planner
+
+#endif  // NAV2_ROUTE_PLANNER__ROUTE_PLANNER_HPP_
@@ -0,0 +1,308 @@
+// Copyright (c) 2022 Samsung Research America
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <algorithm>
+#include <functional>
+#include <limits>
+#include <queue>
+#include <utility>
+#include <vector>
+
+#include "nav2_route_planner/contraction_hierarchy.hpp"
+
+namespace nav2_route_planner
+{
+
+namespace
+{
+
+// Nodes settled by a witness search before giving up, when simulating the contraction of a
+// node to order it and when contracting it
+constexpr int MAX_SIMULATED_SETTLED = 20;
+constexpr int MAX_WITNESS_SETTLED = 500;
+
+using Entry = std::pair<double, unsigned int>;
+using Queue = std::priority_queue<Entry, std::vector<Entry>, std::greater<Entry>>;
+
+}  // namespace
+
+void ContractionHierarchy::Search::reset(size_t size)
+{
+  if (costs.size() != size) {
+    costs.resize(size);
+    parents.resize(size);
+    middles.resize(size);
+    stamps.assign(size, 0);
+    stamp = 0;
+  }
+  if (++stamp == 0) {
+    std::fill(stamps.begin(), stamps.end(), 0);
+    stamp = 1;
+  }
+}
+
+double ContractionHierarchy::Search::cost(unsigned int node) const
+{
+  return stamps[node] == stamp ? costs[node] : std::numeric_limits<double>::infinity();
+}
+
+void ContractionHierarchy::Search::set(
+  unsigned int node, double cost, unsigned int parent, unsigned int middle)
+{
+  stamps[node] = stamp;
+  costs[node] = cost;
+  parents[node] = parent;
+  middles[node] = middle;
+}
+
+void ContractionHierarchy::build(const RouteGraph & graph)
+{
+  const size_t size = graph.size();
+  upward_.assign(size, {});
+  remaining_.assign(size, {});
+  contracted_neighbors_.assign(size, 0);
+  targets_.assign(size, 0);
+  shortcuts_ = 0;
+  for (unsigned int node = 0; node < size; ++node) {
+    for (const auto & edge : graph.nodes()[node].edges) {
+      remaining_[node].push_back(Arc{edge.first, edge.second, NONE});
+    }
+  }
+
+  // Nodes adding fewer shortcuts than the arcs they remove are contracted first, spread out
+  // over the graph by the count of their contracted neighbors
+  auto priority = [this](unsigned int node) {
+      return contract(node, false) - static_cast<int>(remaining_[node].size()) +
+             contracted_neighbors_[node];
+    };
+  using Candidate = std::pair<int, unsigned int>;
+  std::priority_queue<Candidate, std::vector<Candidate>, std::greater<Candidate>> queue;
+  for (unsigned int node = 0; node < size; ++node) {
+    queue.emplace(priority(node), node);
+  }
+
+  // Priorities are only updated lazily, once the node of the top is found outdated
+  while (!queue.empty()) {
+    const unsigned int node = queue.top().second;
+    queue.pop();
+    const int current = priority(node);
+    if (!queue.empty() && current > queue.top().first) {
+      queue.emplace(current, node);
+      continue;
+    }
+    contract(node, true);
+  }
+
+  remaining_.clear();
+  contracted_neighbors_.clear();
+  targets_.clear();
+}
+
+int ContractionHierarchy::contract(unsigned int node, bool apply)
+{
+  const std::vector<Arc> arcs = remaining_[node];
+  std::vector<Arc> shortcuts_from;
+  std::vector<unsigned int> shortcuts_to;
+  int count = 0;
+  for (size_t i = 0; i + 1 < arcs.size(); ++i) {
+    double max_cost = 0.0;
+    for (size_t j = i + 1; j < arcs.size(); ++j) {
+      max_cost = std::max(max_cost, arcs[i].cost + arcs[j].cost);
+    }
+    witness_.reset(remaining_.size());
+    for (size_t j = i + 1; j < arcs.size(); ++j) {
+      targets_[arcs[j].to] = witness_.stamp;
+    }
+    searchWitnesses(
+      arcs[i].to, node, max_cost, arcs.size() - i - 1,
+      apply ? MAX_WITNESS_SETTLED : MAX_SIMULATED_SETTLED);
+    for (size_t j = i + 1; j < arcs.size(); ++j) {
+      const double cost = arcs[i].cost + arcs[j].cost;
+      if (witness_.cost(arcs[j].to) > cost) {
+        ++count;
+        if (apply) {
+          shortcuts_from.push_back(Arc{arcs[j].to, cost, node});
+          shortcuts_to.push_back(arcs[i].to);
+        }
+      }
+    }
+  }
+  if (!apply) {
+    return count;
+  }
+
+  // The node keeps its arcs to its remaining neighbors, from which they are removed
+  for (const auto & arc : arcs) {
+    upward_[node].push_back(arc);
+    auto & neighbor = remaining_[arc.to];
+    neighbor.erase(
+      std::find_if(
+        neighbor.begin(), neighbor.end(), [node](const Arc & a) {return a.to == node;}));
+    ++contracted_neighbors_[arc.to];
+  }
+  remaining_[node].clear();
+
+  auto add = [this](unsigned int from, const Arc & arc) {
+      auto & from_arcs = remaining_[from];
+      auto existing = std::find_if(
+        from_arcs.begin(), from_arcs.end(), [&arc](const Arc & a) {return a.to == arc.to;});
+      if (existing == from_arcs.end()) {
+        from_arcs.push_back(arc);
+      } else if (arc.cost < existing->cost) {
+        *existing = arc;
+      }
+    };
+  for (size_t i = 0; i < shortcuts_from.size(); ++i) {
+    const Arc & arc = shortcuts_from[i];
+    add(shortcuts_to[i], arc);
+    add(arc.to, Arc{shortcuts_to[i], arc.cost, arc.middle});
+  }
+  shortcuts_ += shortcuts_from.size();
+  return count;
+}
+
+void ContractionHierarchy::searchWitnesses(
+  unsigned int from, unsigned int avoid, double max_cost, size_t targets, int max_settled)
+{
+  witness_.set(from, 0.0, NONE, NONE);
+  Queue queue;
+  queue.emplace(0.0, from);
+  int settled = 0;
+  while (!queue.empty() && settled < max_settled) {
+    const auto [cost, node] = queue.top();
+    queue.pop();
+    if (cost > max_cost) {
+      return;
+    }
+    if (cost > witness_.cost(node)) {
+      continue;
+    }
+    if (targets_[node] == witness_.stamp && --targets == 0) {
+      return;
+    }
+    ++settled;
+    for (const auto & arc : remaining_[node]) {
+      const double next = cost + arc.cost;
+      if (arc.to != avoid && next < witness_.cost(arc.to)) {
+        witness_.set(arc.to, next, node, NONE);
+        queue.emplace(next, arc.to);
+      }
+    }
+  }
+}
+
+bool ContractionHierarchy::query(
+  unsigned int start, unsigned int goal, std::vector<unsigned int> & route, double & cost)
+{
+  route.clear();
+  const size_t size = upward_.size();
+  if (start >= size || goal >= size) {
+    return false;
+  }
+  forward_.reset(size);
+  backward_.reset(size);
+  forward_.set(start, 0.0, NONE, NONE);
+  backward_.set(goal, 0.0, NONE, NONE);
+  Queue forward_queue, backward_queue;
+  forward_queue.emplace(0.0, start);
+  backward_queue.emplace(0.0, goal);
+
+  // Each search stops once its lowest cost exceeds that of the best route found
+  double best = std::numeric_limits<double>::infinity();
+  unsigned int meeting = NONE;
+  const double inf = std::numeric_limits<double>::infinity();
+  while (!forward_queue.empty() || !backward_queue.empty()) {
+    const double forward_top = forward_queue.empty() ? inf : forward_queue.top().first;
+    const double backward_top = backward_queue.empty() ? inf : backward_queue.top().first;
+    if (std::min(forward_top, backward_top) >= best) {
+      break;
+    }
+    const bool forward = forward_top <= backward_top;
+    Queue & queue = forward ? forward_queue : backward_queue;
+    Search & search = forward ? forward_ : backward_;
+    const Search & other = forward ? backward_ : forward_;
+
+    const auto [node_cost, node] = queue.top();
+    queue.pop();
+    if (node_cost > search.cost(node)) {
+      continue;
+    }
+    const double through = node_cost + other.cost(node);
+    if (through < best) {
+      best = through;
+      meeting = node;
+    }
+
+    // Nodes reached at a lower cost through a node contracted after them are not expanded,
+    // as the routes through them are not the shortest
+    const auto & arcs = upward_[node];
+    if (std::any_of(
+        arcs.begin(), arcs.end(), [&search, node_cost](const Arc & arc) {
+          return search.cost(arc.to) + arc.cost < node_cost;
+        }))
+    {
+      continue;
+    }
+    for (const auto & arc : arcs) {
+      const double next = node_cost + arc.cost;
+      if (next < search.cost(arc.to)) {
+        search.set(arc.to, next, node, arc.middle);
+        queue.emplace(next, arc.to);
+      }
+    }
+  }
+  if (meeting == NONE) {
+    return false;
+  }
+
+  // The arcs from the start up to the meeting node, then down to the goal
+  std::vector<std::pair<unsigned int, unsigned int>> hops;
+  for (unsigned int node = meeting; node != start; node = forward_.parents[node]) {
+    hops.emplace_back(node, forward_.middles[node]);
+  }
+  std::reverse(hops.begin(), hops.end());
+  for (unsigned int node = meeting; node != goal; node = backward_.parents[node]) {
+    hops.emplace_back(backward_.parents[node], backward_.middles[node]);
+  }
+
+  route.push_back(start);
+  for (const auto & hop : hops) {
+    unpack(route.back(), hop.first, hop.second, route);
+  }
+  cost = best;
+  return true;
+}
+
+void ContractionHierarchy::unpack(
+  unsigned int from, unsigned int to, unsigned int middle,
+  std::vector<unsigned int> & route) const
+{
+  if (middle == NONE) {
+    route.push_back(to);
+    return;
+  }
+  // The middle node was contracted before both ends, keeping its arcs to them
+  auto middleOf = [this, middle](unsigned int end) {
+      for (const auto & arc : upward_[middle]) {
+        if (arc.to == end) {
+          return arc.middle;
+        }
+      }
+      return NONE;
+    };
+  unpack(from, middle, middleOf(from), route);
+  unpack(middle, to, middleOf(to), route);
+}
+
+}  // namespace nav2_route_planner
@@ -0,0 +1,237 @@
+// Copyright (c) 2022 Samsung Research America
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <algorithm>
+#include <cmath>
+#include <functional>
+#include <limits>
+#include <numeric>
+#include <queue>
+#include <stdexcept>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "yaml-cpp/yaml.h"
+#include "nav2_route_planner/route_graph.hpp"
+#include "nav2_util/grid_traversal.hpp"
+
+namespace nav2_route_planner
+{
+
+unsigned int RouteGraph::addNode(double x, double y)
+{
+  nodes_.push_back(Node{x, y, {}});
+  return static_cast<unsigned int>(nodes_.size() - 1);
+}
+
+void RouteGraph::addEdge(unsigned int a, unsigned int b, double cost)
+{
+  if (a == b) {
+    return;
+  }
+  if (cost < 0.0) {
+    cost = distance(a, b);
+  }
+  auto add = [this, cost](unsigned int from, unsigned int to) {
+      auto & edges = nodes_[from].edges;
+      auto edge = std::find_if(
+        edges.begin(), edges.end(), [to](const auto & e) {return e.first == to;});
+      if (edge == edges.end()) {
+        edges.emplace_back(to, cost);
+      } else {
+        edge->second = std::min(edge->second, cost);
+      }
+    };
+  add(a, b);
+  add(b, a);
+}
+
+double RouteGraph::distance(unsigned int a, unsigned int b) const
+{
+  return std::hypot(nodes_[a].x - nodes_[b].x, nodes_[a].y - nodes_[b].y);
+}
+
+std::vector<unsigned int> RouteGraph::nodesNear(double x, double y, double radius) const
+{
+  std::vector<std::pair<double, unsigned int>> near;
+  for (unsigned int i = 0; i < nodes_.size(); ++i) {
+    const double d = std::hypot(nodes_[i].x - x, nodes_[i].y - y);
+    if (d <= radius) {
+      near.emplace_back(d, i);
+    }
+  }
+  std::sort(near.begin(), near.end());
+  std::vector<unsigned int> indices;
+  indices.reserve(near.size());
+  for (const auto & n : near) {
+    indices.push_back(n.second);
+  }
+  return indices;
+}
+
+void loadRouteGraph(const std::string & filename, RouteGraph & graph)
+{
+  graph.clear();
+  try {
+    YAML::Node doc = YAML::LoadFile(filename);
+    for (const auto & node : doc["nodes"]) {
+      if (node.size() != 2) {
+        throw std::runtime_error("nodes must be [x, y] positions");
+      }
+      graph.addNode(node[0].as<double>(), node[1].as<double>());
+    }
+    for (const auto & edge : doc["edges"]) {
+      if (edge.size() != 2 && edge.size() != 3) {
+        throw std::runtime_error("edges must be [a, b] or [a, b, cost] node indices");
+      }
+      const auto a = edge[0].as<unsigned int>();
+      const auto b = edge[1].as<unsigned int>();
+      if (a >= graph.size() || b >= graph.size()) {
+        throw std::runtime_error("edge of a node index out of range");
+      }
+      const double length = graph.distance(a, b);
+      const double cost = edge.size() == 3 ? edge[2].as<double>() : length;
+      if (cost < length) {
+        throw std::runtime_error("edge costs must be at least their length");
+      }
+      graph.addEdge(a, b, cost);
+    }
+  } catch (const std::exception & e) {
+    graph.clear();
+    throw std::runtime_error("Failed to load route graph " + filename + ": " + e.what());
+  }
+}
+
+bool isSegmentFree(
+  const nav2_costmap_2d::Costmap2D & costmap, double x0, double y0, double x1, double y1,
+  unsigned char max_cost)
+{
+  unsigned int mx0, my0, mx1, my1;
+  if (!costmap.worldToMap(x0, y0, mx0, my0) || !costmap.worldToMap(x1, y1, mx1, my1)) {
+    return false;
+  }
+  return nav2_util::traverseLine(
+    mx0, my0, mx1, my1, [&costmap, max_cost](int x, int y) {
+      return costmap.getCost(x, y) < max_cost;
+    });
+}
+
+void generateRouteGraph(
+  const nav2_costmap_2d::Costmap2D & costmap, double node_spacing, double connection_radius,
+  unsigned char max_cost, RouteGraph & graph)
+{
+  graph.clear();
+  const unsigned int size_x = costmap.getSizeInCellsX();
+  const unsigned int size_y = costmap.getSizeInCellsY();
+  const int step =
+    std::max(1, static_cast<int>(std::round(node_spacing / costmap.getResolution())));
+  const int lattice_x = (size_x + step - 1) / step;
+  const int lattice_y = (size_y + step - 1) / step;
+
+  // Nodes at the centers of the lattice cells that are free
+  std::vector<int> lattice(lattice_x * lattice_y, -1);
+  for (int j = 0; j < lattice_y; ++j) {
+    for (int i = 0; i < lattice_x; ++i) {
+      const unsigned int mx = std::min<unsigned int>(i * step + step / 2, size_x - 1);
+      const unsigned int my = std::min<unsigned int>(j * step + step / 2, size_y - 1);
+      if (costmap.getCost(mx, my) < max_cost) {
+        double wx, wy;
+        costmap.mapToWorld(mx, my, wx, wy);
+        lattice[j * lattice_x + i] = static_cast<int>(graph.addNode(wx, wy));
+      }
+    }
+  }
+
+  // Edges along the lattice directions within the radius, one per direction and half plane,
+  // as those of a direction through nodes between them are covered by the shorter ones
+  const int radius = static_cast<int>(connection_radius / (step * costmap.getResolution()));
+  std::vector<std::pair<int, int>> directions;
+  for (int dj = -radius; dj <= radius; ++dj) {
+    for (int di = 0; di <= radius; ++di) {
+      if ((di == 0 && dj <= 0) || di * di + dj * dj > radius * radius ||
+        std::gcd(di, std::abs(dj)) != 1)
+      {
+        continue;
+      }
+      directions.emplace_back(di, dj);
+    }
+  }
+  for (int j = 0; j < lattice_y; ++j) {
+    for (int i = 0; i < lattice_x; ++i) {
+      const int a = lattice[j * lattice_x + i];
+      if (a < 0) {
+        continue;
+      }
+      for (const auto & d : directions) {
+        const int ni = i + d.first, nj = j + d.second;
+        if (ni >= lattice_x || nj < 0 || nj >= lattice_y) {
+          continue;
+        }
+        const int b = lattice[nj * lattice_x + ni];
+        if (b < 0) {
+          continue;
+        }
+        const auto & na = graph.nodes()[a];
+        const auto & nb = graph.nodes()[b];
+        if (isSegmentFree(costmap, na.x, na.y, nb.x, nb.y, max_cost)) {
+          graph.addEdge(a, b);
+        }
+      }
+    }
+  }
+}
+
+bool findRoute(
+  const RouteGraph & graph, unsigned int start, unsigned int goal,
+  const std::function<bool(unsigned int, unsigned int)> & blocked,
+  std::vector<unsigned int> & route)
+{
+  route.clear();
+  const auto & nodes = graph.nodes();
+  const unsigned int none = std::numeric_limits<unsigned int>::max();
+  std::vector<double> costs(nodes.size(), std::numeric_limits<double>::infinity());
+  std::vector<unsigned int> parents(nodes.size(), none);
+  using Entry = std::pair<double, unsigned int>;
+  std::priority_queue<Entry, std::vector<Entry>, std::greater<Entry>> queue;
+
+  // As edges cost at least their length, the distance to the goal is admissible
+  costs[start] = 0.0;
+  queue.emplace(graph.distance(start, goal), start);
+  while (!queue.empty()) {
+    const auto [f, node] = queue.top();
+    queue.pop();
+    if (node == goal) {
+      for (unsigned int n = goal; n != none; n = parents[n]) {
+        route.push_back(n);
+      }
+      std::reverse(route.begin(), route.end());
+      return true;
+    }
+    if (f > costs[node] + graph.distance(node, goal)) {
+      continue;
+    }
+    for (const auto & edge : nodes[node].edges) {
+      const double cost = costs[node] + edge.second;
+      if (cost < costs[edge.first] && !(blocked && blocked(node, edge.first))) {
+        costs[edge.first] = cost;
+        parents[edge.first] = node;
+        queue.emplace(cost + graph.distance(edge.first, goal), edge.first);
+      }
+    }
+  }
+  return false;
+}
+
+}  // namespace nav2_route_planner
@@ -0,0 +1,387 @@
+// Copyright (c) 2022 Samsung Research America
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <memory>
+#include <set>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "nav2_route_planner/route_planner.hpp"
+#include "nav2_costmap_2d/cost_values.hpp"
+#include "nav2_util/geometry_utils.hpp"
+#include "nav2_util/node_utils.hpp"
+
+using namespace std::chrono_literals;
+
+namespace nav2_route_planner
+{
+
+RoutePlanner::RoutePlanner()
+: costmap_(nullptr),
+  planner_loader_("nav2_core", "nav2_core::GlobalPlanner")
+{
+}
+
+RoutePlanner::~RoutePlanner()
+{
+  if (hierarchy_build_.valid()) {
+    hierarchy_build_.wait();
+  }
+}
+
+void RoutePlanner::configure(
+  const rclcpp_lifecycle::LifecycleNode::WeakPtr & parent,
+  std::string name, std::shared_ptr<tf2_ros::Buffer> tf,
+  std::shared_ptr<nav2_costmap_2d::Costmap2DROS> costmap_ros)
+{
+  auto node = parent.lock();
+  clock_ = node->get_clock();
+  logger_ = node->get_logger();
+  name_ = name;
+  costmap_ros_ = costmap_ros;
+  costmap_ = costmap_ros->getCostmap();
+  global_frame_ = costmap_ros->getGlobalFrameID();
+
+  nav2_util::declare_parameter_if_not_declared(
+    node, name_ + ".graph_filename", rclcpp::ParameterValue(std::string("")));
+  nav2_util::declare_parameter_if_not_declared(
+    node, name_ + ".node_spacing", rclcpp::ParameterValue(2.0));
+  nav2_util::declare_parameter_if_not_declared(
+    node, name_ + ".connection_radius", rclcpp::ParameterValue(3.0));
+  nav2_util::declare_parameter_if_not_declared(
+    node, name_ + ".blocking_cost",
+    rclcpp::ParameterValue(static_cast<int>(nav2_costmap_2d::INSCRIBED_INFLATED_OBSTACLE)));
+  nav2_util::declare_parameter_if_not_declared(
+    node, name_ + ".end_radius", rclcpp::ParameterValue(5.0));
+  nav2_util::declare_parameter_if_not_declared(
+    node, name_ + ".direct_planning_distance", rclcpp::ParameterValue(10.0));
+  nav2_util::declare_parameter_if_not_declared(
+    node, name_ + ".local_planner", rclcpp::ParameterValue(std::string("")));
+
+  node->get_parameter(name_ + ".graph_filename", graph_filename_);
+  node->get_parameter(name_ + ".node_spacing", node_spacing_);
+  node->get_parameter(name_ + ".connection_radius", connection_radius_);
+  int blocking_cost;
+  node->get_parameter(name_ + ".blocking_cost", blocking_cost);
+  blocking_cost_ = static_cast<unsigned char>(std::clamp(blocking_cost, 1, 255));
+  node->get_parameter(name_ + ".end_radius", end_radius_);
+  node->get_parameter(name_ + ".direct_planning_distance", direct_planning_distance_);
+  const std::string local_planner = node->get_parameter(name_ + ".local_planner").as_string();
+
+  // The local planner shares the name, and so the parameters, of this planner
+  if (!local_planner.empty()) {
+    try {
+      local_planner_ = planner_loader_.createUniqueInstance(local_planner);
+      RCLCPP_INFO(
+        logger_, "Created local planner for routing: %s of type %s",
+        name_.c_str(), local_planner.c_str());
+    } catch (const pluginlib::PluginlibException & ex) {
+      RCLCPP_FATAL(
+        logger_, "Failed to create local planner for routing. Exception: %s", ex.what());
+      throw;
+    }
+    local_planner_->configure(parent, name, tf, costmap_ros);
+  }
+
+  // Roadmaps of a file are built right away, those generated once the costmap is received
+  if (!graph_filename_.empty()) {
+    auto graph = std::make_shared<RouteGraph>();
+    loadRouteGraph(graph_filename_, *graph);
+    RCLCPP_INFO(
+      logger_, "Loaded a roadmap of %zu nodes from %s", graph->size(), graph_filename_.c_str());
+    graph_ = graph;
+    buildHierarchy();
+  }
+}
+
+void RoutePlanner::cleanup()
+{
+  RCLCPP_INFO(logger_, "CleaningUp plugin %s of type nav2_route_planner", name_.c_str());
+  if (hierarchy_build_.valid()) {
+    hierarchy_build_.wait();
+    hierarchy_build_ = std::future<std::unique_ptr<ContractionHierarchy>>();
+  }
+  hierarchy_.reset();
+  graph_.reset();
+  if (local_planner_) {
+    local_planner_->cleanup();
+    local_planner_.reset();
+  }
+}
+
+void RoutePlanner::activate()
+{
+  RCLCPP_INFO(logger_, "Activating plugin %s of type nav2_route_planner", name_.c_str());
+  if (local_planner_) {
+    local_planner_->activate();
+  }
+}
+
+void RoutePlanner::deactivate()
+{
+  RCLCPP_INFO(logger_, "Deactivating plugin %s of type nav2_route_planner", name_.c_str());
+  if (local_planner_) {
+    local_planner_->deactivate();
+  }
+}
+
+nav_msgs::msg::Path RoutePlanner::createPlan(
+  const geometry_msgs::msg::PoseStamped & start,
+  const geometry_msgs::msg::PoseStamped & goal)
+{
+  nav_msgs::msg::Path path;
+  path.header.stamp = clock_->now();
+  path.header.frame_id = global_frame_;
+
+  // Nearby poses are planned directly
+  if (std::hypot(
+      goal.pose.position.x - start.pose.position.x,
+      goal.pose.position.y - start.pose.position.y) <= direct_planning_distance_)
+  {
+    path.poses.push_back(start);
+    if (!appendLeg(start, goal, path)) {
+      RCLCPP_WARN(logger_, "Failed to plan a path between nearby poses");
+      path.poses.clear();
+    }
+    return path;
+  }
+
+  if (!updateGraph()) {
+    RCLCPP_WARN(logger_, "No roadmap to route along");
+    return path;
+  }
+  const unsigned int entry = findEndNode(start);
+  const unsigned int exit = findEndNode(goal);
+  if (entry == NONE || exit == NONE) {
+    RCLCPP_WARN(
+      logger_, "No roadmap node within %.2f meters of the %s", end_radius_,
+      entry == NONE ? "start" : "goal");
+    return path;
+  }
+  std::vector<unsigned int> route;
+  if (!findFreeRoute(entry, exit, route)) {
+    RCLCPP_WARN(logger_, "No free route along the roadmap between the start and the goal");
+    return path;
+  }
+
+  // The roadmap is joined and left headed along the route
+  const auto & nodes = graph_->nodes();
+  auto routePose = [&](size_t i) {
+      geometry_msgs::msg::PoseStamped pose;
+      pose.header = path.header;
+      pose.pose.position.x = nodes[route[i]].x;
+      pose.pose.position.y = nodes[route[i]].y;
+      if (route.size() == 1) {
+        pose.pose.orientation = goal.pose.orientation;
+        return pose;
+      }
+      const auto & a = nodes[route[i + 1 < route.size() ? i : i - 1]];
+      const auto & b = nodes[route[i + 1 < route.size() ? i + 1 : i]];
+      pose.pose.orientation =
+        nav2_util::geometry_utils::orientationAroundZAxis(std::atan2(b.y - a.y, b.x - a.x));
+      return pose;
+    };
+
+  path.poses.push_back(start);
+  const geometry_msgs::msg::PoseStamped entry_pose = routePose(0);
+  if (!appendLeg(start, entry_pose, path)) {
+    RCLCPP_WARN(logger_, "Failed to plan a path from the start to the roadmap");
+    path.poses.clear();
+    return path;
+  }
+  for (size_t i = 1; i < route.size(); ++i) {
+    appendSegment(
+      nodes[route[i - 1]].x, nodes[route[i - 1]].y, nodes[route[i]].x, nodes[route[i]].y, path);
+  }
+  if (!appendLeg(routePose(route.size() - 1), goal, path)) {
+    RCLCPP_WARN(logger_, "Failed to plan a path from the roadmap to the goal");
+    path.poses.clear();
+    return path;
+  }
+  path.poses.back().pose.orientation = goal.pose.orientation;
+  return path;
+}
+
+bool RoutePlanner::updateGraph()
+{
+  if (!graph_filename_.empty()) {
+    return graph_ && graph_->size() > 0;
+  }
+
+  std::unique_lock<nav2_costmap_2d::Costmap2D::mutex_t> lock(*(costmap_->getMutex()));
+  if (graph_ && graph_size_x_ == costmap_->getSizeInCellsX() &&
+    graph_size_y_ == costmap_->getSizeInCellsY() &&
+    graph_origin_x_ == costmap_->getOriginX() && graph_origin_y_ == costmap_->getOriginY() &&
+    graph_resolution_ == costmap_->getResolution())
+  {
+    return graph_->size() > 0;
+  }
+
+  // A build of the previous roadmap is waited for, as roadmaps are only generated again
+  // when the map changes
+  if (hierarchy_build_.valid()) {
+    hierarchy_build_.wait();
+    hierarchy_build_ = std::future<std::unique_ptr<ContractionHierarchy>>();
+  }
+  hierarchy_.reset();
+
+  auto graph = std::make_shared<RouteGraph>();
+  generateRouteGraph(*costmap_, node_spacing_, connection_radius_, blocking_cost_, *graph);
+  graph_size_x_ = costmap_->getSizeInCellsX();
+  graph_size_y_ = costmap_->getSizeInCellsY();
+  graph_origin_x_ = costmap_->getOriginX();
+  graph_origin_y_ = costmap_->getOriginY();
+  graph_resolution_ = costmap_->getResolution();
+  lock.unlock();
+
+  RCLCPP_INFO(logger_, "Generated a roadmap of %zu nodes", graph->size());
+  graph_ = graph;
+  buildHierarchy();
+  return graph_->size() > 0;
+}
+
+void RoutePlanner::buildHierarchy()
+{
+  hierarchy_build_ = std::async(
+    std::launch::async, [graph = graph_, logger = logger_]() {
+      const auto start = std::chrono::steady_clock::now();
+      auto hierarchy = std::make_unique<ContractionHierarchy>();
+      hierarchy->build(*graph);
+      RCLCPP_INFO(
+        logger, "Built the roadmap hierarchy with %zu shortcuts in %.2f seconds",
+        hierarchy->shortcuts(),
+        std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count());
+      return hierarchy;
+    });
+}
+
+unsigned int RoutePlanner::findEndNode(const geometry_msgs::msg::PoseStamped & pose)
+{
+  const double x = pose.pose.position.x, y = pose.pose.position.y;
+  const std::vector<unsigned int> near = graph_->nodesNear(x, y, end_radius_);
+  if (near.empty()) {
+    return NONE;
+  }
+
+  std::unique_lock<nav2_costmap_2d::Costmap2D::mutex_t> lock(*(costmap_->getMutex()));
+  for (const unsigned int node : near) {
+    const auto & n = graph_->nodes()[node];
+    if (isSegmentFree(*costmap_, x, y, n.x, n.y, blocking_cost_)) {
+      return node;
+    }
+  }
+  return local_planner_ ? near.front() : NONE;
+}
+
+bool RoutePlanner::findFreeRoute(
+  unsigned int start, unsigned int goal, std::vector<unsigned int> & route)
+{
+  if (hierarchy_build_.valid() && hierarchy_build_.wait_for(0s) == std::future_status::ready) {
+    hierarchy_ = hierarchy_build_.get();
+  }
+  double cost;
+  bool found = hierarchy_ ? hierarchy_->query(start, goal, route, cost) :
+    findRoute(*graph_, start, goal, nullptr, route);
+
+  // The edges of the route are checked against the costmap, and the route found again with
+  // A* around those blocked, which only costs more than the route of the hierarchy
+  std::set<std::pair<unsigned int, unsigned int>> blocked;
+  auto isBlocked = [&blocked](unsigned int a, unsigned int b) {
+      return blocked.count(std::minmax(a, b)) > 0;
+    };
+  const auto & nodes = graph_->nodes();
+  while (found) {
+    bool free = true;
+    {
+      std::unique_lock<nav2_costmap_2d::Costmap2D::mutex_t> lock(*(costmap_->getMutex()));
+      for (size_t i = 1; i < route.size(); ++i) {
+        const auto & a = nodes[route[i - 1]];
+        const auto & b = nodes[route[i]];
+        if (!isSegmentFree(*costmap_, a.x, a.y, b.x, b.y, blocking_cost_)) {
+          blocked.insert(std::minmax(route[i - 1], route[i]));
+          free = false;
+        }
+      }
+    }
+    if (free) {
+      return true;
+    }
+    RCLCPP_DEBUG(logger_, "Routing around %zu blocked roadmap edges", blocked.size());
+    found = findRoute(*graph_, start, goal, isBlocked, route);
+  }
+  return false;
+}
+
+bool RoutePlanner::appendLeg(
+  const geometry_msgs::msg::PoseStamped & start,
+  const geometry_msgs::msg::PoseStamped & goal, nav_msgs::msg::Path & path)
+{
+  if (local_planner_) {
+    const nav_msgs::msg::Path leg = local_planner_->createPlan(start, goal);
+    if (leg.poses.empty()) {
+      return false;
+    }
+    // The leg starts at the last pose of the path
+    for (size_t i = 1; i < leg.poses.size(); ++i) {
+      path.poses.push_back(leg.poses[i]);
+      path.poses.back().header = path.header;
+    }
+    if (leg.poses.size() == 1) {
+      path.poses.push_back(goal);
+      path.poses.back().header = path.header;
+    }
+    return true;
+  }
+
+  {
+    std::unique_lock<nav2_costmap_2d::Costmap2D::mutex_t> lock(*(costmap_->getMutex()));
+    if (!isSegmentFree(
+        *costmap_, start.pose.position.x, start.pose.position.y,
+        goal.pose.position.x, goal.pose.position.y, blocking_cost_))
+    {
+      return false;
+    }
+  }
+  appendSegment(
+    start.pose.position.x, start.pose.position.y, goal.pose.position.x, goal.pose.position.y,
+    path);
+  path.poses.back().pose.orientation = goal.pose.orientation;
+  return true;
+}
+
+void RoutePlanner::appendSegment(
+  double x0, double y0, double x1, double y1, nav_msgs::msg::Path & path)
+{
+  const double length = std::hypot(x1 - x0, y1 - y0);
+  const int steps =
+    std::max(1, static_cast<int>(std::ceil(length / costmap_->getResolution())));
+  geometry_msgs::msg::PoseStamped pose;
+  pose.header = path.header;
+  pose.pose.orientation =
+    nav2_util::geometry_utils::orientationAroundZAxis(std::atan2(y1 - y0, x1 - x0));
+  for (int k = 1; k <= steps; ++k) {
+    pose.pose.position.x = x0 + (x1 - x0) * k / steps;
+    pose.pose.position.y = y0 + (y1 - y0) * k / steps;
+    path.poses.push_back(pose);
+  }
+}
+
+}  // namespace nav2_route_planner
+
+#include "pluginlib/class_list_macros.hpp"
+PLUGINLIB_EXPORT_CLASS(nav2_route_planner::RoutePlanner, nav2_core::GlobalPlanner)
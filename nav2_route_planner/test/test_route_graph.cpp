@@ -0,0 +1,194 @@
+// Copyright (c) 2022 Samsung Research America
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <gtest/gtest.h>
+
+#include <cmath>
+#include <cstdio>
+#include <fstream>
+#include <random>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include "nav2_costmap_2d/cost_values.hpp"
+#include "nav2_route_planner/contraction_hierarchy.hpp"
+#include "nav2_route_planner/route_graph.hpp"
+
+using nav2_route_planner::ContractionHierarchy;
+using nav2_route_planner::RouteGraph;
+
+static double routeCost(const RouteGraph & graph, const std::vector<unsigned int> & route)
+{
+  double cost = 0.0;
+  for (size_t i = 1; i < route.size(); ++i) {
+    bool found = false;
+    for (const auto & edge : graph.nodes()[route[i - 1]].edges) {
+      if (edge.first == route[i]) {
+        cost += edge.second;
+        found = true;
+      }
+    }
+    EXPECT_TRUE(found) << "no edge between " << route[i - 1] << " and " << route[i];
+  }
+  return cost;
+}
+
+TEST(RouteGraph, hierarchy_matches_search)
+{
+  // Random nodes joined to their nearest neighbors, with some edges costing more than their
+  // length, and a node left unconnected
+  std::mt19937 generator(11);
+  std::uniform_real_distribution<double> position(0.0, 100.0);
+  std::uniform_real_distribution<double> penalty(1.0, 3.0);
+  RouteGraph graph;
+  for (int i = 0; i < 400; ++i) {
+    graph.addNode(position(generator), position(generator));
+  }
+  for (unsigned int a = 0; a + 1 < graph.size(); ++a) {
+    const auto near = graph.nodesNear(graph.nodes()[a].x, graph.nodes()[a].y, 9.0);
+    for (size_t k = 1; k < near.size() && k < 5; ++k) {
+      const double weight = k % 2 ? 1.0 : penalty(generator);
+      graph.addEdge(a, near[k], graph.distance(a, near[k]) * weight);
+    }
+  }
+  const unsigned int isolated = graph.addNode(500.0, 500.0);
+
+  ContractionHierarchy hierarchy;
+  hierarchy.build(graph);
+  EXPECT_EQ(hierarchy.size(), graph.size());
+
+  std::uniform_int_distribution<unsigned int> node(0, isolated - 1);
+  for (int i = 0; i < 300; ++i) {
+    const unsigned int start = node(generator), goal = node(generator);
+    std::vector<unsigned int> expected, route;
+    double cost;
+    const bool found = nav2_route_planner::findRoute(graph, start, goal, nullptr, expected);
+    ASSERT_EQ(hierarchy.query(start, goal, route, cost), found);
+    if (!found) {
+      continue;
+    }
+    ASSERT_FALSE(route.empty());
+    EXPECT_EQ(route.front(), start);
+    EXPECT_EQ(route.back(), goal);
+    EXPECT_NEAR(routeCost(graph, route), routeCost(graph, expected), 1e-6);
+    EXPECT_NEAR(cost, routeCost(graph, route), 1e-6);
+  }
+
+  std::vector<unsigned int> route;
+  double cost;
+  EXPECT_FALSE(hierarchy.query(0, isolated, route, cost));
+  EXPECT_TRUE(hierarchy.query(5, 5, route, cost));
+  EXPECT_EQ(route, std::vector<unsigned int>{5});
+}
+
+TEST(RouteGraph, blocked_edges)
+{
+  // A square with a diagonal, whose shortest route is blocked
+  RouteGraph graph;
+  graph.addNode(0.0, 0.0);
+  graph.addNode(1.0, 0.0);
+  graph.addNode(1.0, 1.0);
+  graph.addNode(0.0, 1.0);
+  graph.addEdge(0, 1);
+  graph.addEdge(1, 2);
+  graph.addEdge(2, 3);
+  graph.addEdge(3, 0);
+  graph.addEdge(0, 2);
+
+  std::vector<unsigned int> route;
+  EXPECT_TRUE(nav2_route_planner::findRoute(graph, 0, 2, nullptr, route));
+  EXPECT_EQ(route, (std::vector<unsigned int>{0, 2}));
+
+  auto blocked = [](unsigned int a, unsigned int b) {
+      return (a == 0 && b == 2) || (a == 2 && b == 0) || (a == 1 && b == 2);
+    };
+  EXPECT_TRUE(nav2_route_planner::findRoute(graph, 0, 2, blocked, route));
+  EXPECT_EQ(route, (std::vector<unsigned int>{0, 3, 2}));
+  EXPECT_FALSE(
+    nav2_route_planner::findRoute(
+      graph, 0, 2, [](unsigned int a, unsigned int) {return a == 0;}, route));
+}
+
+TEST(RouteGraph, generation)
+{
+  // A 20 x 10 m map split by a wall with a gap at its top
+  nav2_costmap_2d::Costmap2D costmap(200, 100, 0.1, 0.0, 0.0, nav2_costmap_2d::FREE_SPACE);
+  for (unsigned int y = 0; y < 70; ++y) {
+    for (unsigned int x = 98; x < 102; ++x) {
+      costmap.setCost(x, y, nav2_costmap_2d::LETHAL_OBSTACLE);
+    }
+  }
+
+  RouteGraph graph;
+  nav2_route_planner::generateRouteGraph(
+    costmap, 1.0, 1.5, nav2_costmap_2d::INSCRIBED_INFLATED_OBSTACLE, graph);
+  EXPECT_GT(graph.size(), 150u);
+
+  // No edge crosses the wall
+  for (unsigned int a = 0; a < graph.size(); ++a) {
+    for (const auto & edge : graph.nodes()[a].edges) {
+      const auto & na = graph.nodes()[a];
+      const auto & nb = graph.nodes()[edge.first];
+      EXPECT_LE(graph.distance(a, edge.first), 1.5 + 1e-9);
+      EXPECT_TRUE(
+        nav2_route_planner::isSegmentFree(
+          costmap, na.x, na.y, nb.x, nb.y, nav2_costmap_2d::INSCRIBED_INFLATED_OBSTACLE));
+    }
+  }
+
+  // The route across the wall goes through its gap
+  const unsigned int start = graph.nodesNear(1.0, 1.0, 1.0).front();
+  const unsigned int goal = graph.nodesNear(19.0, 1.0, 1.0).front();
+  ContractionHierarchy hierarchy;
+  hierarchy.build(graph);
+  std::vector<unsigned int> route;
+  double cost;
+  ASSERT_TRUE(hierarchy.query(start, goal, route, cost));
+  double highest = 0.0;
+  for (const auto node : route) {
+    highest = std::max(highest, graph.nodes()[node].y);
+  }
+  EXPECT_GT(highest, 7.0);
+  EXPECT_GT(cost, 18.5);
+}
+
+TEST(RouteGraph, loading)
+{
+  const std::string filename = "/tmp/test_route_graph.yaml";
+  {
+    std::ofstream file(filename);
+    file << "nodes: [[0.0, 0.0], [3.0, 4.0], [6.0, 0.0]]\n";
+    file << "edges: [[0, 1], [1, 2, 7.5]]\n";
+  }
+  RouteGraph graph;
+  nav2_route_planner::loadRouteGraph(filename, graph);
+  ASSERT_EQ(graph.size(), 3u);
+  EXPECT_EQ(routeCost(graph, {0, 1, 2}), 12.5);
+
+  {
+    std::ofstream file(filename);
+    file << "nodes: [[0.0, 0.0], [3.0, 4.0]]\n";
+    file << "edges: [[0, 2]]\n";
+  }
+  EXPECT_THROW(nav2_route_planner::loadRouteGraph(filename, graph), std::runtime_error);
+  {
+    std::ofstream file(filename);
+    file << "nodes: [[0.0, 0.0], [3.0, 4.0]]\n";
+    file << "edges: [[0, 1, 2.0]]\n";
+  }
+  EXPECT_THROW(nav2_route_planner::loadRouteGraph(filename, graph), std::runtime_error);
+  EXPECT_EQ(graph.size(), 0u);
+  std::remove(filename.c_str());
+}
@@ -120,6 +120,8 @@ private:
   void initializeProperties();
   bool validateFloats(const nav2_msgs::msg::ParticleCloud & msg);
   bool setTransform(std_msgs::msg::Header const & header);
+  /// Merge the particles closer on screen than the merge pixels, at the distance of the cloud
+  void mergeParticles();
   void updateDisplay();
   void updateArrows2d();
   void updateArrows3d();
@@ -144,6 +146,7 @@ private:
 
   rviz_common::properties::FloatProperty * arrow_min_length_property_;
   rviz_common::properties::FloatProperty * arrow_max_length_property_;
+  rviz_common::properties::FloatProperty * merge_pixels_property_;
 
   float min_length_;
   float max_length_;
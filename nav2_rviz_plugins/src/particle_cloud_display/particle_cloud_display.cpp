@@ -45,12 +45,19 @@
 
 #include "nav2_rviz_plugins/particle_cloud_display/particle_cloud_display.hpp"
 
+#include <cmath>
+#include <cstdint>
 #include <memory>
 #include <string>
+#include <unordered_map>
+#include <utility>
+#include <vector>
 
+#include <OgreCamera.h>
 #include <OgreManualObject.h>
 #include <OgreMaterialManager.h>
 #include <OgreTechnique.h>
+#include <OgreViewport.h>
 
 #include "rviz_common/logging.hpp"
 #include "rviz_common/msg_conversions.hpp"
@@ -58,6 +65,8 @@
 #include "rviz_common/properties/color_property.hpp"
 #include "rviz_common/properties/float_property.hpp"
 #include "rviz_common/validate_floats.hpp"
+#include "rviz_common/view_controller.hpp"
+#include "rviz_common/view_manager.hpp"
 
 #include "rviz_rendering/objects/arrow.hpp"
 #include "rviz_rendering/objects/axes.hpp"
@@ -131,6 +140,12 @@ void ParticleCloudDisplay::initializeProperties()
   arrow_max_length_property_ = new rviz_common::properties::FloatProperty(
     "Max Arrow Length", max_length_, "Maximum length of the arrows.", this, SLOT(updateGeometry()));
 
+  merge_pixels_property_ = new rviz_common::properties::FloatProperty(
+    "Merge Pixels", 0.0f,
+    "Particles closer than this on screen are merged into one of their summed weight, "
+    "0 to disable.", this);
+  merge_pixels_property_->setMin(0);
+
   // Scales are set based on initial values
   length_scale_ = max_length_ - min_length_;
   shaft_radius_scale_ = 0.0435;
@@ -175,6 +190,7 @@ void ParticleCloudDisplay::processMessage(const nav2_msgs::msg::ParticleCloud::C
     poses_[i].orientation = rviz_common::quaternionMsgToOgre(msg->particles[i].pose.orientation);
     poses_[i].weight = static_cast<float>(msg->particles[i].weight);
   }
+  mergeParticles();
 
   updateDisplay();
 
@@ -208,6 +224,66 @@ bool ParticleCloudDisplay::setTransform(std_msgs::msg::Header const & header)
   return true;
 }
 
+void ParticleCloudDisplay::mergeParticles()
+{
+  const float merge_pixels = merge_pixels_property_->getFloat();
+  rviz_common::ViewController * view =
+    context_->getViewManager() ? context_->getViewManager()->getCurrent() : nullptr;
+  Ogre::Camera * camera = view ? view->getCamera() : nullptr;
+  if (merge_pixels <= 0.0f || poses_.size() < 2 || !camera || !camera->getViewport() ||
+    camera->getViewport()->getActualHeight() <= 0)
+  {
+    return;
+  }
+
+  // Size of a pixel at the distance of the cloud from the camera
+  const float height = static_cast<float>(camera->getViewport()->getActualHeight());
+  float pixel_size;
+  if (camera->getProjectionType() == Ogre::PT_ORTHOGRAPHIC) {
+    pixel_size = camera->getOrthoWindowHeight() / height;
+  } else {
+    Ogre::Vector3 center = Ogre::Vector3::ZERO;
+    for (const auto & pose : poses_) {
+      center += pose.position;
+    }
+    center /= static_cast<float>(poses_.size());
+    const float distance =
+      camera->getDerivedPosition().distance(scene_node_->convertLocalToWorldPosition(center));
+    pixel_size = 2.0f * distance * std::tan(camera->getFOVy().valueRadians() / 2.0f) / height;
+  }
+  const float cell_size = merge_pixels * pixel_size;
+  if (!(cell_size > 0.0f)) {
+    return;
+  }
+
+  // The particles of a cell are merged at their mean position, with the heading of the
+  // heaviest of them, so that dense areas show as long arrows
+  std::unordered_map<uint64_t, size_t> cells;
+  std::vector<OgrePoseWithWeight> merged;
+  std::vector<std::pair<unsigned int, float>> counts_and_max_weights;
+  for (const auto & pose : poses_) {
+    const int64_t x = static_cast<int64_t>(std::floor(pose.position.x / cell_size));
+    const int64_t y = static_cast<int64_t>(std::floor(pose.position.y / cell_size));
+    const uint64_t key = (static_cast<uint64_t>(x) << 32) ^ static_cast<uint32_t>(y);
+    auto cell = cells.emplace(key, merged.size());
+    if (cell.second) {
+      merged.push_back(pose);
+      counts_and_max_weights.emplace_back(1, pose.weight);
+      continue;
+    }
+    OgrePoseWithWeight & merged_pose = merged[cell.first->second];
+    auto & count_and_max_weight = counts_and_max_weights[cell.first->second];
+    count_and_max_weight.first++;
+    merged_pose.position += (pose.position - merged_pose.position) / count_and_max_weight.first;
+    if (pose.weight > count_and_max_weight.second) {
+      count_and_max_weight.second = pose.weight;
+      merged_pose.orientation = pose.orientation;
+    }
+    merged_pose.weight += pose.weight;
+  }
+  poses_ = std::move(merged);
+}
+
 void ParticleCloudDisplay::updateDisplay()
 {
   int shape = shape_property_->getOptionInt();
@@ -17,6 +17,7 @@
 #define NAV2_SMAC_PLANNER__A_STAR_HPP_
 
 #include <vector>
+#include <functional>
 #include <iostream>
 #include <unordered_map>
 #include <memory>
@@ -27,6 +28,9 @@
 #include "nav2_costmap_2d/costmap_2d.hpp"
 
 #include "nav2_smac_planner/analytic_expansion.hpp"
+#include "nav2_smac_planner/bidirectional_frontier.hpp"
+#include "nav2_smac_planner/dense_graph.hpp"
+#include "nav2_smac_planner/indexed_heap.hpp"
 #include "nav2_smac_planner/node_2d.hpp"
 #include "nav2_smac_planner/node_hybrid.hpp"
 #include "nav2_smac_planner/node_lattice.hpp"
@@ -37,6 +41,60 @@
 namespace nav2_smac_planner
 {
 
+/**
+ * @struct nav2_smac_planner::SearchState
+ * @brief State the nodes share across a search, such as their motion tables, heuristic
+ * lookup tables and obstacle heuristic. Each search owns its own, so that instances
+ * planning concurrently, e.g. on a planner pool, do not share any.
+ */
+struct SearchState
+{
+  Node2DSearchState node_2d;
+  NodeHybridSearchState node_hybrid;
+  NodeLatticeSearchState node_lattice;
+};
+
+/**
+ * @class nav2_smac_planner::SearchStateGuard
+ * @brief Binds a search state to the nodes for the calling thread while in scope,
+ * restoring the state bound before on destruction
+ */
+class SearchStateGuard
+{
+public:
+  /**
+   * @brief A constructor for nav2_smac_planner::SearchStateGuard
+   * @param state Search state to bind
+   */
+  explicit SearchStateGuard(SearchState & state)
+  : _node_2d(Node2D::search_state),
+    _node_hybrid(NodeHybrid::search_state),
+    _node_lattice(NodeLattice::search_state)
+  {
+    Node2D::search_state = &state.node_2d;
+    NodeHybrid::search_state = &state.node_hybrid;
+    NodeLattice::search_state = &state.node_lattice;
+  }
+
+  /**
+   * @brief A destructor for nav2_smac_planner::SearchStateGuard
+   */
+  ~SearchStateGuard()
+  {
+    Node2D::search_state = _node_2d;
+    NodeHybrid::search_state = _node_hybrid;
+    NodeLattice::search_state = _node_lattice;
+  }
+
+  SearchStateGuard(const SearchStateGuard &) = delete;
+  SearchStateGuard & operator=(const SearchStateGuard &) = delete;
+
+private:
+  Node2DSearchState * _node_2d;
+  NodeHybridSearchState * _node_hybrid;
+  NodeLatticeSearchState * _node_lattice;
+};
+
 /**
  * @class nav2_smac_planner::AStarAlgorithm
  * @brief An A* implementation for planning in a costmap. Templated based on the Node type.
@@ -47,6 +105,7 @@ class AStarAlgorithm
 public:
   typedef NodeT * NodePtr;
   typedef std::unordered_map<unsigned int, NodeT> Graph;
+  typedef DenseGraph<NodeT> DenseNodeGraph;
   typedef std::vector<NodePtr> NodeVector;
   typedef std::pair<float, NodeBasic<NodeT>> NodeElement;
   typedef typename NodeT::Coordinates Coordinates;
@@ -67,6 +126,7 @@ public:
   };
 
   typedef std::priority_queue<NodeElement, std::vector<NodeElement>, NodeComparator> NodeQueue;
+  typedef IndexedHeap<NodeBasic<NodeT>> IndexedNodeQueue;
 
   /**
    * @brief A constructor for nav2_smac_planner::PlannerServer
@@ -112,6 +172,22 @@ public:
    */
   void setCollisionChecker(GridCollisionChecker * collision_checker);
 
+  /**
+   * @brief Restrict the expansions of the search to a corridor of the costmap. Analytic
+   * expansions are still checked against the costmap only, and the bidirectional search
+   * is not restricted.
+   * @param corridor Whether each cell of the costmap, indexed by x + y * size x, is in the
+   * corridor, expected to outlive its use, or nullptr to expand all of the cells
+   */
+  void setCorridor(const std::vector<unsigned char> * corridor);
+
+  /**
+   * @brief Set the function checked along with the planning time to give up the search once
+   * its path is no longer wanted, e.g. by a planner losing a race
+   * @param cancel_checker Function returning true once cancelled, or empty not to check
+   */
+  void setCancelChecker(std::function<bool()> cancel_checker);
+
   /**
    * @brief Set the goal for planning, as a node index
    * @param mx The node X index of the goal
@@ -123,6 +199,14 @@ public:
     const unsigned int & my,
     const unsigned int & dim_3);
 
+  /**
+   * @brief Set several goals for planning, such as the poses of a goal region, as node
+   * coordinates. The search returns the path to the cheapest of them it reaches, the
+   * heuristic being the lowest to any of them.
+   * @param goals The node coordinates of the goals, the first being returned by getGoal()
+   */
+  void setGoals(const CoordinateVector & goals);
+
   /**
    * @brief Set the starting pose for planning, as a node index
    * @param mx The node X index of the goal
@@ -182,6 +266,33 @@ public:
    */
   unsigned int & getSizeDim3();
 
+  /**
+   * @brief Get the largest size the open set reached during the last search
+   * @return Peak number of queued elements
+   */
+  unsigned int & getPeakQueueSize();
+
+  /**
+   * @brief Get the memory held by the graph of nodes, and an estimate of that of the
+   * open set from its peak size during the last search
+   * @return Number of bytes allocated
+   */
+  size_t getGraphMemoryUsage() const;
+
+  /**
+   * @brief Get the heuristic weight the last returned path was found with. With the
+   * anytime search, this bounds the cost of that path relative to the optimal path for
+   * an admissible heuristic. Otherwise, it is 1.0.
+   * @return Suboptimality bound of the last path
+   */
+  float & getSuboptimalityBound();
+
+  /**
+   * @brief Get the state the nodes of the search share, e.g. its motion table
+   * @return Reference to the search state
+   */
+  SearchState & getSearchState();
+
 protected:
   /**
    * @brief Get pointer to next goal in open set
@@ -210,6 +321,13 @@ protected:
    */
   inline bool isGoal(NodePtr & node);
 
+  /**
+   * @brief Get the goal closest to a node, to attempt analytic expansions to
+   * @param node Node pointer to find the closest goal of
+   * @return Node pointer reference to the closest goal
+   */
+  inline NodePtr & getClosestGoal(const NodePtr & node);
+
   /**
    * @brief Get cost of heuristic of node
    * @param node Node index current
@@ -218,6 +336,65 @@ protected:
    */
   inline float getHeuristicCost(const NodePtr & node);
 
+  /**
+   * @brief Store the path to a solution of the anytime search, then reopen the search
+   * with a lower heuristic weight to improve upon it, reusing the expanded graph
+   * @param node Node pointer to the solution node
+   * @param path Reference to the best path so far, replaced by the path to the node
+   * @return If the search should continue to improve the path, which it stops once
+   * unweighted or within the target bound
+   */
+  inline bool improvePath(NodePtr & node, CoordinateVector & path);
+
+  /**
+   * @brief With lazy collision checking, finish the collision check of a node popped
+   * from the queue, which was queued with the cost of its center cell, and requeue it
+   * if its cost to come is higher than it was queued with
+   * @param node Node pointer to the popped node
+   * @return If the node is valid to expand now
+   */
+  inline bool isLazyNodeExpandable(NodePtr & node);
+
+  /**
+   * @brief Get the number of nodes popped from the queue to expand as a batch.
+   * Only NodeHybrid expands batches, with the collision checks of their neighbors in
+   * parallel, and not with lazy collision checking.
+   * @return Number of nodes of a batch, 1 to expand each node once popped
+   */
+  unsigned int getExpansionBatchSize();
+
+  /**
+   * @brief Collision check the neighbors of the nodes of the expansion batch, before
+   * they are expanded in turn
+   */
+  void checkBatchNeighbors();
+
+  /**
+   * @brief Retrieve the valid neighbors of a node of the expansion batch
+   * @param batch_index Index of the node in the expansion batch
+   * @param neighbor_getter Functor to get the node of an index
+   * @param neighbors Vector of neighbors to be filled
+   */
+  void getBatchNeighbors(
+    const unsigned int & batch_index, NodeGetter & neighbor_getter, NodeVector & neighbors);
+
+  /**
+   * @brief Expand the nodes of the expansion batch in the order they were popped,
+   * queueing their neighbors of lower cost
+   * @param neighbor_getter Functor to get the node of an index
+   */
+  void expandBatch(NodeGetter & neighbor_getter);
+
+  /**
+   * @brief Search from both the start and the goal until the frontiers meet and no
+   * cheaper connection can remain, optionally expanding each frontier on its own thread.
+   * Only supported by Node2D.
+   * @param path Reference to a vector of indicies of generated path
+   * @param iterations Reference to number of iterations to create plan
+   * @return if plan was successful
+   */
+  bool createBidirectionalPath(CoordinateVector & path, int & iterations);
+
   /**
    * @brief Check if inputs to planner are valid
    * @return Are valid
@@ -229,11 +406,29 @@ protected:
    */
   inline void clearQueue();
 
+  /**
+   * @brief Check if there are no more nodes in the open set
+   * @return If the queue is empty
+   */
+  inline bool isQueueEmpty();
+
   /**
    * @brief Clear graph of nodes searched
    */
   inline void clearGraph();
 
+  /**
+   * @brief Check if the graph has been initialized with a costmap
+   * @return If the graph is empty
+   */
+  inline bool isGraphEmpty();
+
+  /**
+   * @brief Check if the search was cancelled
+   * @return If the cancel checker returns true
+   */
+  inline bool isCancelled();
+
   int _timing_interval = 5000;
 
   bool _traverse_unknown;
@@ -249,16 +444,36 @@ protected:
   Coordinates _goal_coordinates;
   NodePtr _start;
   NodePtr _goal;
+  CoordinateVector _goals_coordinates;
+  NodeVector _goals;
 
   Graph _graph;
+  DenseNodeGraph _dense_graph;
+  bool _use_dense_graph;
   NodeQueue _queue;
+  IndexedNodeQueue _indexed_queue;
+  bool _use_indexed_heap;
+  unsigned int _peak_queue_size;
+  float _heuristic_weight;
+  float _suboptimality_bound;
+  NodeVector _closed_nodes;
+  NodeVector _expansion_batch;
+  // Copies of the collision checker for the threads checking the batch neighbors
+  std::vector<GridCollisionChecker> _batch_collision_checkers;
+  NodeHybrid::ProjectionChecks _batch_checks;
+  NodeVector _batch_neighbors;
+  std::unique_ptr<BidirectionalFrontier> _forward_frontier;
+  std::unique_ptr<BidirectionalFrontier> _backward_frontier;
 
   MotionModel _motion_model;
   NodeHeuristicPair _best_heuristic_node;
 
   GridCollisionChecker * _collision_checker;
   nav2_costmap_2d::Costmap2D * _costmap;
+  const std::vector<unsigned char> * _corridor;
+  std::function<bool()> _cancel_checker;
   std::unique_ptr<AnalyticExpansion<NodeT>> _expander;
+  SearchState _search_state;
 };
 
 }  // namespace nav2_smac_planner
@@ -0,0 +1,639 @@
+// Copyright (c) 2022, Samsung Research America
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License. Reserved.
+
+#ifndef NAV2_SMAC_PLANNER__ANALYTIC_CURVE_HPP_
+#define NAV2_SMAC_PLANNER__ANALYTIC_CURVE_HPP_
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <cstdint>
+#include <limits>
+#include <vector>
+
+namespace nav2_smac_planner
+{
+
+/**
+ * @brief A segment of a Dubins or Reeds-Shepp curve
+ */
+enum class CurveSegment : uint8_t
+{
+  NOP = 0,
+  LEFT = 1,
+  STRAIGHT = 2,
+  RIGHT = 3
+};
+
+/**
+ * @struct nav2_smac_planner::CurvePath
+ * @brief The shortest Dubins or Reeds-Shepp curve between two poses. The lengths of
+ * its segments are in units of the turning radius, negative when driving in reverse.
+ */
+struct CurvePath
+{
+  /**
+   * @brief Total length of the curve, in units of the turning radius, infinite if none
+   * was found
+   */
+  inline double length() const
+  {
+    if (!word) {
+      return std::numeric_limits<double>::max();
+    }
+    return std::fabs(lengths[0]) + std::fabs(lengths[1]) + std::fabs(lengths[2]) +
+           std::fabs(lengths[3]) + std::fabs(lengths[4]);
+  }
+
+  /**
+   * @brief Whether a curve was found
+   */
+  inline bool valid() const
+  {
+    return word != nullptr;
+  }
+
+  const CurveSegment * word{nullptr};
+  std::array<double, 5> lengths{{0.0, 0.0, 0.0, 0.0, 0.0}};
+};
+
+/**
+ * @brief The closed form solutions of the curves, from the Dubins and Reeds-Shepp papers
+ * as implemented in OMPL's DubinsStateSpace and ReedsSheppStateSpace
+ */
+namespace curves
+{
+
+constexpr CurveSegment L = CurveSegment::LEFT;
+constexpr CurveSegment S = CurveSegment::STRAIGHT;
+constexpr CurveSegment R = CurveSegment::RIGHT;
+constexpr CurveSegment N = CurveSegment::NOP;
+
+constexpr CurveSegment DUBINS_WORDS[6][5] = {
+  {L, S, L, N, N},
+  {R, S, R, N, N},
+  {R, S, L, N, N},
+  {L, S, R, N, N},
+  {R, L, R, N, N},
+  {L, R, L, N, N}
+};
+
+constexpr CurveSegment REEDS_SHEPP_WORDS[18][5] = {
+  {L, R, L, N, N},
+  {R, L, R, N, N},
+  {L, R, L, R, N},
+  {R, L, R, L, N},
+  {L, R, S, L, N},
+  {R, L, S, R, N},
+  {L, S, R, L, N},
+  {R, S, L, R, N},
+  {L, R, S, R, N},
+  {R, L, S, L, N},
+  {R, S, R, L, N},
+  {L, S, L, R, N},
+  {L, S, R, N, N},
+  {R, S, L, N, N},
+  {L, S, L, N, N},
+  {R, S, R, N, N},
+  {L, R, S, L, R},
+  {R, L, S, R, L}
+};
+
+constexpr double TWO_PI = 2.0 * M_PI;
+constexpr double HALF_PI = 0.5 * M_PI;
+constexpr double DUBINS_EPS = 1e-6;
+constexpr double DUBINS_ZERO = -1e-7;
+constexpr double RS_ZERO = 10.0 * std::numeric_limits<double>::epsilon();
+
+// Angle in [0, 2PI)
+inline double mod2piPositive(double x)
+{
+  if (x < 0.0 && x > DUBINS_ZERO) {
+    return 0.0;
+  }
+  double xm = x - TWO_PI * std::floor(x / TWO_PI);
+  if (TWO_PI - xm < 0.5 * DUBINS_EPS) {
+    xm = 0.0;
+  }
+  return xm;
+}
+
+// Angle in [-PI, PI]
+inline double mod2pi(double x)
+{
+  double v = std::fmod(x, TWO_PI);
+  if (v < -M_PI) {
+    v += TWO_PI;
+  } else if (v > M_PI) {
+    v -= TWO_PI;
+  }
+  return v;
+}
+
+inline void polar(double x, double y, double & r, double & theta)
+{
+  r = std::sqrt(x * x + y * y);
+  theta = std::atan2(y, x);
+}
+
+// Keep a candidate curve if it is shorter than the best one so far
+inline void keep(
+  CurvePath & path, double & min_length, const CurveSegment * word,
+  double t, double u, double v, double w = 0.0, double x = 0.0)
+{
+  const double length = std::fabs(t) + std::fabs(u) + std::fabs(v) + std::fabs(w) +
+    std::fabs(x);
+  if (length < min_length) {
+    min_length = length;
+    path.word = word;
+    path.lengths = {{t, u, v, w, x}};
+  }
+}
+
+/**
+ * @brief Shortest Dubins curve, for a goal at distance d in units of the turning radius,
+ * with the start and goal headings alpha and beta relative to the line joining them
+ */
+inline CurvePath dubins(double d, double alpha, double beta)
+{
+  CurvePath path;
+  if (d < DUBINS_EPS && std::fabs(alpha - beta) < DUBINS_EPS) {
+    path.word = DUBINS_WORDS[0];
+    path.lengths = {{0.0, d, 0.0, 0.0, 0.0}};
+    return path;
+  }
+
+  const double ca = std::cos(alpha), sa = std::sin(alpha);
+  const double cb = std::cos(beta), sb = std::sin(beta);
+  double min_length = std::numeric_limits<double>::max();
+  double tmp, theta, p;
+
+  // LSL
+  tmp = 2.0 + d * d - 2.0 * (ca * cb + sa * sb - d * (sa - sb));
+  if (tmp >= DUBINS_ZERO) {
+    theta = std::atan2(cb - ca, d + sa - sb);
+    keep(
+      path, min_length, DUBINS_WORDS[0], mod2piPositive(-alpha + theta),
+      std::sqrt(std::max(tmp, 0.0)), mod2piPositive(beta - theta));
+  }
+
+  // RSR
+  tmp = 2.0 + d * d - 2.0 * (ca * cb + sa * sb - d * (sb - sa));
+  if (tmp >= DUBINS_ZERO) {
+    theta = std::atan2(ca - cb, d - sa + sb);
+    keep(
+      path, min_length, DUBINS_WORDS[1], mod2piPositive(alpha - theta),
+      std::sqrt(std::max(tmp, 0.0)), mod2piPositive(-beta + theta));
+  }
+
+  // RSL
+  tmp = d * d - 2.0 + 2.0 * (ca * cb + sa * sb - d * (sa + sb));
+  if (tmp >= DUBINS_ZERO) {
+    p = std::sqrt(std::max(tmp, 0.0));
+    theta = std::atan2(ca + cb, d - sa - sb) - std::atan2(2.0, p);
+    keep(
+      path, min_length, DUBINS_WORDS[2], mod2piPositive(alpha - theta), p,
+      mod2piPositive(beta - theta));
+  }
+
+  // LSR
+  tmp = -2.0 + d * d + 2.0 * (ca * cb + sa * sb + d * (sa + sb));
+  if (tmp >= DUBINS_ZERO) {
+    p = std::sqrt(std::max(tmp, 0.0));
+    theta = std::atan2(-ca - cb, d + sa + sb) - std::atan2(-2.0, p);
+    keep(
+      path, min_length, DUBINS_WORDS[3], mod2piPositive(-alpha + theta), p,
+      mod2piPositive(-beta + theta));
+  }
+
+  // RLR
+  tmp = 0.125 * (6.0 - d * d + 2.0 * (ca * cb + sa * sb + d * (sa - sb)));
+  if (std::fabs(tmp) < 1.0) {
+    p = TWO_PI - std::acos(tmp);
+    theta = std::atan2(ca - cb, d - sa + sb);
+    const double t = mod2piPositive(alpha - theta + 0.5 * p);
+    keep(path, min_length, DUBINS_WORDS[4], t, p, mod2piPositive(alpha - beta - t + p));
+  }
+
+  // LRL
+  tmp = 0.125 * (6.0 - d * d + 2.0 * (ca * cb + sa * sb - d * (sa - sb)));
+  if (std::fabs(tmp) < 1.0) {
+    p = TWO_PI - std::acos(tmp);
+    theta = std::atan2(-ca + cb, d + sa - sb);
+    const double t = mod2piPositive(-alpha + theta + 0.5 * p);
+    keep(path, min_length, DUBINS_WORDS[5], t, p, mod2piPositive(beta - alpha - t + p));
+  }
+
+  return path;
+}
+
+inline void tauOmega(
+  double u, double v, double xi, double eta, double phi, double & tau, double & omega)
+{
+  const double delta = mod2pi(u - v);
+  const double a = std::sin(u) - std::sin(delta);
+  const double b = std::cos(u) - std::cos(delta) - 1.0;
+  const double t1 = std::atan2(eta * a - xi * b, xi * a + eta * b);
+  const double t2 = 2.0 * (std::cos(delta) - std::cos(v) - std::cos(u)) + 3.0;
+  tau = (t2 < 0.0) ? mod2pi(t1 + M_PI) : mod2pi(t1);
+  omega = mod2pi(tau - u + v - phi);
+}
+
+// Formula 8.1 of the Reeds-Shepp paper
+inline bool LpSpLp(double x, double y, double phi, double & t, double & u, double & v)
+{
+  polar(x - std::sin(phi), y - 1.0 + std::cos(phi), u, t);
+  if (t >= -RS_ZERO) {
+    v = mod2pi(phi - t);
+    return v >= -RS_ZERO;
+  }
+  return false;
+}
+
+// Formula 8.2
+inline bool LpSpRp(double x, double y, double phi, double & t, double & u, double & v)
+{
+  double t1, u1;
+  polar(x + std::sin(phi), y - 1.0 - std::cos(phi), u1, t1);
+  u1 = u1 * u1;
+  if (u1 >= 4.0) {
+    u = std::sqrt(u1 - 4.0);
+    t = mod2pi(t1 + std::atan2(2.0, u));
+    v = mod2pi(t - phi);
+    return t >= -RS_ZERO && v >= -RS_ZERO;
+  }
+  return false;
+}
+
+// Formula 8.3 / 8.4, with the typo of the paper fixed
+inline bool LpRmL(double x, double y, double phi, double & t, double & u, double & v)
+{
+  double u1, theta;
+  polar(x - std::sin(phi), y - 1.0 + std::cos(phi), u1, theta);
+  if (u1 <= 4.0) {
+    u = -2.0 * std::asin(0.25 * u1);
+    t = mod2pi(theta + 0.5 * u + M_PI);
+    v = mod2pi(phi - t + u);
+    return t >= -RS_ZERO && u <= RS_ZERO;
+  }
+  return false;
+}
+
+// Formula 8.7
+inline bool LpRupLumRm(double x, double y, double phi, double & t, double & u, double & v)
+{
+  const double xi = x + std::sin(phi), eta = y - 1.0 - std::cos(phi);
+  const double rho = 0.25 * (2.0 + std::sqrt(xi * xi + eta * eta));
+  if (rho <= 1.0) {
+    u = std::acos(rho);
+    tauOmega(u, -u, xi, eta, phi, t, v);
+    return t >= -RS_ZERO && v <= RS_ZERO;
+  }
+  return false;
+}
+
+// Formula 8.8
+inline bool LpRumLumRp(double x, double y, double phi, double & t, double & u, double & v)
+{
+  const double xi = x + std::sin(phi), eta = y - 1.0 - std::cos(phi);
+  const double rho = (20.0 - xi * xi - eta * eta) / 16.0;
+  if (rho >= 0.0 && rho <= 1.0) {
+    u = -std::acos(rho);
+    if (u >= -HALF_PI) {
+      tauOmega(u, u, xi, eta, phi, t, v);
+      return t >= -RS_ZERO && v >= -RS_ZERO;
+    }
+  }
+  return false;
+}
+
+// Formula 8.9
+inline bool LpRmSmLm(double x, double y, double phi, double & t, double & u, double & v)
+{
+  double rho, theta;
+  polar(x - std::sin(phi), y - 1.0 + std::cos(phi), rho, theta);
+  if (rho >= 2.0) {
+    const double r = std::sqrt(rho * rho - 4.0);
+    u = 2.0 - r;
+    t = mod2pi(theta + std::atan2(r, -2.0));
+    v = mod2pi(phi - HALF_PI - t);
+    return t >= -RS_ZERO && u <= RS_ZERO && v <= RS_ZERO;
+  }
+  return false;
+}
+
+// Formula 8.10
+inline bool LpRmSmRm(double x, double y, double phi, double & t, double & u, double & v)
+{
+  const double xi = x + std::sin(phi), eta = y - 1.0 - std::cos(phi);
+  double rho, theta;
+  polar(-eta, xi, rho, theta);
+  if (rho >= 2.0) {
+    t = theta;
+    u = 2.0 - rho;
+    v = mod2pi(t + HALF_PI - phi);
+    return t >= -RS_ZERO && u <= RS_ZERO && v <= RS_ZERO;
+  }
+  return false;
+}
+
+// Formula 8.11, with the typo of the paper fixed
+inline bool LpRmSLmRp(double x, double y, double phi, double & t, double & u, double & v)
+{
+  const double xi = x + std::sin(phi), eta = y - 1.0 - std::cos(phi);
+  double rho, theta;
+  polar(xi, eta, rho, theta);
+  if (rho >= 2.0) {
+    u = 4.0 - std::sqrt(rho * rho - 4.0);
+    if (u <= RS_ZERO) {
+      t = mod2pi(std::atan2((4.0 - u) * xi - 2.0 * eta, -2.0 * xi + (u - 4.0) * eta));
+      v = mod2pi(t - phi);
+      return t >= -RS_ZERO && v >= -RS_ZERO;
+    }
+  }
+  return false;
+}
+
+/**
+ * @brief Shortest Reeds-Shepp curve to a goal at (x, y, phi) relative to the start,
+ * in units of the turning radius. The candidate words are searched together with their
+ * time flipped, reflected and backwards versions.
+ */
+inline CurvePath reedsShepp(double x, double y, double phi)
+{
+  CurvePath path;
+  double min_length = std::numeric_limits<double>::max();
+  double t, u, v;
+  const auto * W = REEDS_SHEPP_WORDS;
+  const double xb = x * std::cos(phi) + y * std::sin(phi);
+  const double yb = x * std::sin(phi) - y * std::cos(phi);
+
+  // CSC
+  if (LpSpLp(x, y, phi, t, u, v)) {keep(path, min_length, W[14], t, u, v);}
+  if (LpSpLp(-x, y, -phi, t, u, v)) {keep(path, min_length, W[14], -t, -u, -v);}
+  if (LpSpLp(x, -y, -phi, t, u, v)) {keep(path, min_length, W[15], t, u, v);}
+  if (LpSpLp(-x, -y, phi, t, u, v)) {keep(path, min_length, W[15], -t, -u, -v);}
+  if (LpSpRp(x, y, phi, t, u, v)) {keep(path, min_length, W[12], t, u, v);}
+  if (LpSpRp(-x, y, -phi, t, u, v)) {keep(path, min_length, W[12], -t, -u, -v);}
+  if (LpSpRp(x, -y, -phi, t, u, v)) {keep(path, min_length, W[13], t, u, v);}
+  if (LpSpRp(-x, -y, phi, t, u, v)) {keep(path, min_length, W[13], -t, -u, -v);}
+
+  // CCC
+  if (LpRmL(x, y, phi, t, u, v)) {keep(path, min_length, W[0], t, u, v);}
+  if (LpRmL(-x, y, -phi, t, u, v)) {keep(path, min_length, W[0], -t, -u, -v);}
+  if (LpRmL(x, -y, -phi, t, u, v)) {keep(path, min_length, W[1], t, u, v);}
+  if (LpRmL(-x, -y, phi, t, u, v)) {keep(path, min_length, W[1], -t, -u, -v);}
+  if (LpRmL(xb, yb, phi, t, u, v)) {keep(path, min_length, W[0], v, u, t);}
+  if (LpRmL(-xb, yb, -phi, t, u, v)) {keep(path, min_length, W[0], -v, -u, -t);}
+  if (LpRmL(xb, -yb, -phi, t, u, v)) {keep(path, min_length, W[1], v, u, t);}
+  if (LpRmL(-xb, -yb, phi, t, u, v)) {keep(path, min_length, W[1], -v, -u, -t);}
+
+  // CCCC
+  if (LpRupLumRm(x, y, phi, t, u, v)) {keep(path, min_length, W[2], t, u, -u, v);}
+  if (LpRupLumRm(-x, y, -phi, t, u, v)) {keep(path, min_length, W[2], -t, -u, u, -v);}
+  if (LpRupLumRm(x, -y, -phi, t, u, v)) {keep(path, min_length, W[3], t, u, -u, v);}
+  if (LpRupLumRm(-x, -y, phi, t, u, v)) {keep(path, min_length, W[3], -t, -u, u, -v);}
+  if (LpRumLumRp(x, y, phi, t, u, v)) {keep(path, min_length, W[2], t, u, u, v);}
+  if (LpRumLumRp(-x, y, -phi, t, u, v)) {keep(path, min_length, W[2], -t, -u, -u, -v);}
+  if (LpRumLumRp(x, -y, -phi, t, u, v)) {keep(path, min_length, W[3], t, u, u, v);}
+  if (LpRumLumRp(-x, -y, phi, t, u, v)) {keep(path, min_length, W[3], -t, -u, -u, -v);}
+
+  // CCSC
+  if (LpRmSmLm(x, y, phi, t, u, v)) {keep(path, min_length, W[4], t, -HALF_PI, u, v);}
+  if (LpRmSmLm(-x, y, -phi, t, u, v)) {keep(path, min_length, W[4], -t, HALF_PI, -u, -v);}
+  if (LpRmSmLm(x, -y, -phi, t, u, v)) {keep(path, min_length, W[5], t, -HALF_PI, u, v);}
+  if (LpRmSmLm(-x, -y, phi, t, u, v)) {keep(path, min_length, W[5], -t, HALF_PI, -u, -v);}
+  if (LpRmSmRm(x, y, phi, t, u, v)) {keep(path, min_length, W[8], t, -HALF_PI, u, v);}
+  if (LpRmSmRm(-x, y, -phi, t, u, v)) {keep(path, min_length, W[8], -t, HALF_PI, -u, -v);}
+  if (LpRmSmRm(x, -y, -phi, t, u, v)) {keep(path, min_length, W[9], t, -HALF_PI, u, v);}
+  if (LpRmSmRm(-x, -y, phi, t, u, v)) {keep(path, min_length, W[9], -t, HALF_PI, -u, -v);}
+  if (LpRmSmLm(xb, yb, phi, t, u, v)) {keep(path, min_length, W[6], v, u, -HALF_PI, t);}
+  if (LpRmSmLm(-xb, yb, -phi, t, u, v)) {keep(path, min_length, W[6], -v, -u, HALF_PI, -t);}
+  if (LpRmSmLm(xb, -yb, -phi, t, u, v)) {keep(path, min_length, W[7], v, u, -HALF_PI, t);}
+  if (LpRmSmLm(-xb, -yb, phi, t, u, v)) {keep(path, min_length, W[7], -v, -u, HALF_PI, -t);}
+  if (LpRmSmRm(xb, yb, phi, t, u, v)) {keep(path, min_length, W[10], v, u, -HALF_PI, t);}
+  if (LpRmSmRm(-xb, yb, -phi, t, u, v)) {keep(path, min_length, W[10], -v, -u, HALF_PI, -t);}
+  if (LpRmSmRm(xb, -yb, -phi, t, u, v)) {keep(path, min_length, W[11], v, u, -HALF_PI, t);}
+  if (LpRmSmRm(-xb, -yb, phi, t, u, v)) {keep(path, min_length, W[11], -v, -u, HALF_PI, -t);}
+
+  // CCSCC
+  if (LpRmSLmRp(x, y, phi, t, u, v)) {
+    keep(path, min_length, W[16], t, -HALF_PI, u, -HALF_PI, v);
+  }
+  if (LpRmSLmRp(-x, y, -phi, t, u, v)) {
+    keep(path, min_length, W[16], -t, HALF_PI, -u, HALF_PI, -v);
+  }
+  if (LpRmSLmRp(x, -y, -phi, t, u, v)) {
+    keep(path, min_length, W[17], t, -HALF_PI, u, -HALF_PI, v);
+  }
+  if (LpRmSLmRp(-x, -y, phi, t, u, v)) {
+    keep(path, min_length, W[17], -t, HALF_PI, -u, HALF_PI, -v);
+  }
+
+  return path;
+}
+
+/**
+ * @brief Move along a segment, by a length in units of the turning radius
+ */
+inline void advance(
+  const CurveSegment & segment, const double & length, double & x, double & y, double & theta)
+{
+  switch (segment) {
+    case CurveSegment::LEFT:
+      x += std::sin(theta + length) - std::sin(theta);
+      y += -std::cos(theta + length) + std::cos(theta);
+      theta += length;
+      break;
+    case CurveSegment::RIGHT:
+      x += -std::sin(theta - length) + std::sin(theta);
+      y += std::cos(theta - length) - std::cos(theta);
+      theta -= length;
+      break;
+    case CurveSegment::STRAIGHT:
+      x += length * std::cos(theta);
+      y += length * std::sin(theta);
+      break;
+    case CurveSegment::NOP:
+      break;
+  }
+}
+
+}  // namespace curves
+
+/**
+ * @class nav2_smac_planner::AnalyticCurve
+ * @brief Shortest Dubins or Reeds-Shepp curves for a turning radius, computed in closed
+ * form without allocations. Replaces OMPL's state spaces for the distance heuristics
+ * and the analytic expansions, which allocate states and go through virtual calls.
+ */
+class AnalyticCurve
+{
+public:
+  /**
+   * @brief A constructor for nav2_smac_planner::AnalyticCurve
+   */
+  AnalyticCurve() = default;
+
+  /**
+   * @brief A constructor for nav2_smac_planner::AnalyticCurve
+   * @param reverse Whether to use Reeds-Shepp curves, driving in reverse, or Dubins curves
+   * @param turning_radius Minimum turning radius, in the units of the poses
+   */
+  AnalyticCurve(const bool & reverse, const double & turning_radius)
+  : reverse_(reverse), turning_radius_(turning_radius)
+  {}
+
+  /**
+   * @brief Whether the curve was constructed with a turning radius
+   */
+  inline bool valid() const
+  {
+    return turning_radius_ > 0.0;
+  }
+
+  /**
+   * @brief Get the shortest curve between two poses
+   * @return The curve, with segment lengths in units of the turning radius
+   */
+  inline CurvePath getPath(
+    const double & x0, const double & y0, const double & theta0,
+    const double & x1, const double & y1, const double & theta1) const
+  {
+    const double dx = x1 - x0, dy = y1 - y0;
+    if (reverse_) {
+      const double c = std::cos(theta0), s = std::sin(theta0);
+      return curves::reedsShepp(
+        (c * dx + s * dy) / turning_radius_, (-s * dx + c * dy) / turning_radius_,
+        theta1 - theta0);
+    }
+    const double th = std::atan2(dy, dx);
+    return curves::dubins(
+      std::sqrt(dx * dx + dy * dy) / turning_radius_,
+      curves::mod2piPositive(theta0 - th), curves::mod2piPositive(theta1 - th));
+  }
+
+  /**
+   * @brief Get the length of the shortest curve between two poses
+   * @return The length, in the units of the poses
+   */
+  inline double distance(
+    const double & x0, const double & y0, const double & theta0,
+    const double & x1, const double & y1, const double & theta1) const
+  {
+    return length(getPath(x0, y0, theta0, x1, y1, theta1));
+  }
+
+  /**
+   * @brief Get the length of a curve
+   * @param path The curve, from getPath()
+   * @return The length, in the units of the poses
+   */
+  inline double length(const CurvePath & path) const
+  {
+    return turning_radius_ * path.length();
+  }
+
+  /**
+   * @brief Get the pose at a fraction of a curve
+   * @param path The curve, from getPath()
+   * @param x0 X of the start of the curve
+   * @param y0 Y of the start of the curve
+   * @param theta0 Heading of the start of the curve
+   * @param t Fraction of the length of the curve, in [0, 1]
+   * @param x X of the pose
+   * @param y Y of the pose
+   * @param theta Heading of the pose, in [0, 2PI)
+   */
+  inline void interpolate(
+    const CurvePath & path,
+    const double & x0, const double & y0, const double & theta0, const double & t,
+    double & x, double & y, double & theta) const
+  {
+    double remaining = t * path.length();
+    x = 0.0;
+    y = 0.0;
+    theta = theta0;
+    for (unsigned int i = 0; i < 5 && remaining > 0.0; ++i) {
+      double v;
+      if (path.lengths[i] < 0.0) {
+        v = std::max(-remaining, path.lengths[i]);
+        remaining += v;
+      } else {
+        v = std::min(remaining, path.lengths[i]);
+        remaining -= v;
+      }
+      curves::advance(path.word[i], v, x, y, theta);
+    }
+    x = x * turning_radius_ + x0;
+    y = y * turning_radius_ + y0;
+    theta = normalize(theta);
+  }
+
+  /**
+   * @brief Get the poses at regular intervals along a curve, excluding its start and end,
+   * without walking the curve from its start for each of them
+   * @param path The curve, from getPath()
+   * @param x0 X of the start of the curve
+   * @param y0 Y of the start of the curve
+   * @param theta0 Heading of the start of the curve
+   * @param num_intervals Number of intervals, num_intervals - 1 poses are interpolated
+   * @param poses Poses at fractions i / num_intervals of the curve, with headings in
+   * [0, 2PI), appended
+   */
+  template<typename CoordinatesT>
+  inline void interpolate(
+    const CurvePath & path,
+    const double & x0, const double & y0, const double & theta0,
+    const unsigned int & num_intervals, std::vector<CoordinatesT> & poses) const
+  {
+    const double length = path.length();
+    // Start of the current segment, and length of the curve before it
+    double seg_x = 0.0, seg_y = 0.0, seg_theta = theta0, seg_start = 0.0;
+    unsigned int seg = 0;
+    for (unsigned int i = 1; i < num_intervals; ++i) {
+      const double s = length * i / num_intervals;
+      while (seg < 4 && seg_start + std::fabs(path.lengths[seg]) < s) {
+        curves::advance(path.word[seg], path.lengths[seg], seg_x, seg_y, seg_theta);
+        seg_start += std::fabs(path.lengths[seg]);
+        ++seg;
+      }
+      double x = seg_x, y = seg_y, theta = seg_theta;
+      const double offset = std::min(s - seg_start, std::fabs(path.lengths[seg]));
+      curves::advance(
+        path.word[seg], path.lengths[seg] < 0.0 ? -offset : offset, x, y, theta);
+      poses.emplace_back(
+        static_cast<float>(x * turning_radius_ + x0), static_cast<float>(y * turning_radius_ + y0),
+        static_cast<float>(normalize(theta)));
+    }
+  }
+
+protected:
+  // Heading in [0, 2PI)
+  static inline double normalize(double theta)
+  {
+    theta = std::fmod(theta, curves::TWO_PI);
+    if (theta < 0.0) {
+      theta += curves::TWO_PI;
+    }
+    return theta >= curves::TWO_PI ? 0.0 : theta;
+  }
+
+  bool reverse_{false};
+  double turning_radius_{0.0};
+};
+
+}  // namespace nav2_smac_planner
+
+#endif  // NAV2_SMAC_PLANNER__ANALYTIC_CURVE_HPP_
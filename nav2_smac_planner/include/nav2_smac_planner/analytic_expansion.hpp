@@ -126,6 +126,7 @@ protected:
   unsigned int _dim_3_size;
   GridCollisionChecker * _collision_checker;
   std::list<std::unique_ptr<NodeT>> _detached_nodes;
+  std::vector<Coordinates> _interpolated_poses;
 };
 
 }  // namespace nav2_smac_planner
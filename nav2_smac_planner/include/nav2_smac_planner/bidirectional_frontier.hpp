@@ -0,0 +1,198 @@
+// Copyright (c) 2022, Samsung Research America
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License. Reserved.
+
+#ifndef NAV2_SMAC_PLANNER__BIDIRECTIONAL_FRONTIER_HPP_
+#define NAV2_SMAC_PLANNER__BIDIRECTIONAL_FRONTIER_HPP_
+
+#include <atomic>
+#include <cstdint>
+#include <cstring>
+#include <functional>
+#include <limits>
+#include <memory>
+#include <mutex>
+#include <queue>
+#include <utility>
+#include <vector>
+
+#include "nav2_smac_planner/collision_checker.hpp"
+#include "nav2_smac_planner/dense_graph.hpp"
+#include "nav2_smac_planner/node_2d.hpp"
+
+namespace nav2_smac_planner
+{
+
+/**
+ * @struct nav2_smac_planner::BidirectionalMeeting
+ * @brief The cheapest connection found so far between the two frontiers of a
+ * bidirectional search, shared between the threads expanding them
+ */
+struct BidirectionalMeeting
+{
+  /**
+   * @brief Record a connection through a node if it is cheaper than the best so far
+   * @param cost_in Total cost of the path through the node
+   * @param index_in Index of the node both frontiers reached
+   */
+  void update(const float & cost_in, const unsigned int & index_in)
+  {
+    std::lock_guard<std::mutex> lock(mutex);
+    if (cost_in < cost.load(std::memory_order_relaxed)) {
+      index = index_in;
+      cost.store(cost_in, std::memory_order_relaxed);
+    }
+  }
+
+  std::mutex mutex;
+  std::atomic<float> cost{std::numeric_limits<float>::max()};
+  unsigned int index{0};
+  std::atomic<bool> done{false};
+};
+
+/**
+ * @class nav2_smac_planner::BidirectionalFrontier
+ * @brief One direction of a bidirectional Node2D search, with its own graph and
+ * open set. The accumulated cost of each node is also published in a lock-free
+ * array so that the opposite frontier can detect meetings from another thread.
+ */
+class BidirectionalFrontier
+{
+public:
+  typedef Node2D * NodePtr;
+  typedef std::pair<float, NodePtr> NodeElement;
+  typedef std::function<bool (const unsigned int &, NodePtr &)> NodeGetter;
+
+  /**
+   * @struct nav2_smac_planner::BidirectionalFrontier::NodeComparator
+   * @brief Node comparison for priority queue sorting
+   */
+  struct NodeComparator
+  {
+    bool operator()(const NodeElement & a, const NodeElement & b) const
+    {
+      return a.first > b.first;
+    }
+  };
+
+  typedef std::priority_queue<NodeElement, std::vector<NodeElement>, NodeComparator> NodeQueue;
+
+  /**
+   * @brief A constructor for nav2_smac_planner::BidirectionalFrontier
+   * @param backward Whether this frontier searches from the goal to the start, so that
+   * traversal costs are taken along edges in the reverse direction of expansion
+   */
+  explicit BidirectionalFrontier(const bool & backward);
+
+  /**
+   * @brief Size the frontier to the planning space, only reallocates if the size changed
+   * @param size Total number of nodes in the planning space
+   * @param collision_checker Collision checker to validate nodes with, must not be
+   * shared with a frontier expanded on another thread
+   * @param traverse_unknown Whether to search through unknown space
+   */
+  void initialize(
+    const unsigned int & size,
+    GridCollisionChecker * collision_checker,
+    const bool & traverse_unknown);
+
+  /**
+   * @brief Start a new search from a node towards a target
+   * @param root_index Index the frontier is expanded from
+   * @param target_index Index the frontier is expanded towards, for the heuristic
+   */
+  void reset(const unsigned int & root_index, const unsigned int & target_index);
+
+  /**
+   * @brief Get the lowest estimated total cost in the open set, which bounds
+   * the cost of any path through a node not yet expanded by this frontier
+   * @return Lowest queued cost, or the float maximum if the open set is empty
+   */
+  float getMinimumCost();
+
+  /**
+   * @brief Get the number of entries in the open set
+   * @return Size of the open set
+   */
+  inline unsigned int getQueueSize() const
+  {
+    return _queue.size();
+  }
+
+  /**
+   * @brief Expand the next node of the open set, recording any meeting with the other frontier
+   * @param other The frontier searching in the opposite direction
+   * @param meeting Best meeting of the frontiers to update
+   * @return If a node was expanded, false if the open set is exhausted
+   */
+  bool expand(const BidirectionalFrontier & other, BidirectionalMeeting & meeting);
+
+  /**
+   * @brief Get the accumulated cost from the root to a node, safe to call from
+   * another thread while this frontier is being expanded
+   * @param index Index of the node
+   * @return Accumulated cost, or the float maximum if not yet reached in this search
+   */
+  inline float getAccumulatedCost(const unsigned int & index) const
+  {
+    const uint64_t entry = _costs[index].load(std::memory_order_relaxed);
+    if (static_cast<uint32_t>(entry >> 32) != _epoch) {
+      return std::numeric_limits<float>::max();
+    }
+
+    const uint32_t cost_bits = static_cast<uint32_t>(entry);
+    float cost;
+    std::memcpy(&cost, &cost_bits, sizeof(float));
+    return cost;
+  }
+
+  /**
+   * @brief Get a node of the frontier's graph, to trace the path back to the root
+   * @param index Index of the node
+   * @return Node pointer of the node
+   */
+  inline NodePtr getNode(const unsigned int & index)
+  {
+    return _graph.get(index);
+  }
+
+protected:
+  /**
+   * @brief Publish the accumulated cost of a node to the other frontier
+   * @param index Index of the node
+   * @param cost Accumulated cost of the node
+   */
+  inline void setAccumulatedCost(const unsigned int & index, const float & cost)
+  {
+    uint32_t cost_bits;
+    std::memcpy(&cost_bits, &cost, sizeof(float));
+    _costs[index].store(
+      (static_cast<uint64_t>(_epoch) << 32) | cost_bits, std::memory_order_relaxed);
+  }
+
+  bool _backward;
+  bool _traverse_unknown;
+  GridCollisionChecker * _collision_checker;
+  DenseGraph<Node2D> _graph;
+  NodeQueue _queue;
+  Node2D::Coordinates _target_coordinates;
+  NodeGetter _neighbor_getter;
+  Node2D::NodeVector _neighbors;
+  std::unique_ptr<std::atomic<uint64_t>[]> _costs;
+  unsigned int _size;
+  uint32_t _epoch;
+};
+
+}  // namespace nav2_smac_planner
+
+#endif  // NAV2_SMAC_PLANNER__BIDIRECTIONAL_FRONTIER_HPP_
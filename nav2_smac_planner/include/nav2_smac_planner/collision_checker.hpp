@@ -11,9 +11,13 @@
 // WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
 // See the License for the specific language governing permissions and
 // limitations under the License. Reserved.
+#include <memory>
+#include <utility>
 #include <vector>
 #include "nav2_costmap_2d/footprint_collision_checker.hpp"
+#include "nav2_costmap_2d/footprint_geometry.hpp"
 #include "nav2_smac_planner/constants.hpp"
+#include "nav2_smac_planner/types.hpp"
 
 #ifndef NAV2_SMAC_PLANNER__COLLISION_CHECKER_HPP_
 #define NAV2_SMAC_PLANNER__COLLISION_CHECKER_HPP_
@@ -35,10 +39,14 @@ public:
    * @param costmap The costmap to collision check against
    * @param num_quantizations The number of quantizations to precompute footprint
    * orientations for to speed up collision checking
+   * @param rasterize_footprint Whether to precompute the footprint cells of each orientation
+   * and check them as row spans of the costmap, rather than ray-tracing each edge. Poses are
+   * snapped to their cell, which may differ by up to a cell for fractional coordinates.
    */
   GridCollisionChecker(
     nav2_costmap_2d::Costmap2D * costmap,
-    unsigned int num_quantizations);
+    unsigned int num_quantizations,
+    const bool & rasterize_footprint = false);
 
   /**
    * @brief A constructor for nav2_smac_planner::GridCollisionChecker
@@ -61,6 +69,17 @@ public:
     const bool & radius,
     const double & possible_inscribed_cost);
 
+  /**
+   * @brief Set the footprint to use with collision checker from its shared geometry,
+   * only computing the orientation bins again when its version changes
+   * @param footprint_geometry The footprint to collision check against, with its geometry
+   * @param radius Whether or not the footprint is a circle and use radius collision checking
+   */
+  void setFootprint(
+    const std::shared_ptr<const nav2_costmap_2d::FootprintGeometry> & footprint_geometry,
+    const bool & radius,
+    const double & possible_inscribed_cost);
+
   /**
    * @brief Check if in collision with costmap and footprint at pose
    * @param x X coordinate of pose to check against
@@ -85,6 +104,19 @@ public:
     const unsigned int & i,
     const bool & traverse_unknown);
 
+  /**
+   * @brief Check if in collision with costmap at the cell of a pose center only. The poses
+   * in collision are a subset of those in collision with the footprint at any orientation.
+   * @param x X coordinate of pose to check against
+   * @param y Y coordinate of pose to check against
+   * @param traverse_unknown Whether or not to traverse in unknown space
+   * @return boolean if in collision or not.
+   */
+  bool inCollisionAtCenter(
+    const float & x,
+    const float & y,
+    const bool & traverse_unknown);
+
   /**
    * @brief Get cost at footprint pose in costmap
    * @return the cost at the pose in costmap
@@ -100,7 +132,130 @@ public:
     return angles_;
   }
 
+  /**
+   * @struct nav2_smac_planner::GridCollisionChecker::FootprintSpan
+   * @brief A contiguous run of footprint cells in a costmap row, relative to the pose cell
+   */
+  struct FootprintSpan
+  {
+    int dy;
+    int dx_start;
+    int dx_end;
+  };
+
+  /**
+   * @struct nav2_smac_planner::GridCollisionChecker::RasterizedFootprint
+   * @brief The footprint cells of an orientation bin and their bounds, relative to the pose cell
+   */
+  struct RasterizedFootprint
+  {
+    std::vector<FootprintSpan> spans;
+    int min_dx{0};
+    int max_dx{0};
+    int min_dy{0};
+    int max_dy{0};
+  };
+
+  /**
+   * @struct nav2_smac_planner::GridCollisionChecker::SweptFootprint
+   * @brief The cells swept by the centers and the footprint of a set of poses,
+   * relative to the origin cell of the poses
+   */
+  struct SweptFootprint
+  {
+    RasterizedFootprint centers;
+    RasterizedFootprint footprint;
+  };
+
+  /**
+   * @brief Rasterize the cells swept over a set of poses for span collision checking
+   * @param poses Poses to sweep in cells relative to the origin cell, with angle bins as theta
+   * @param swept_footprint The swept cells, relative to the origin cell
+   */
+  void sweepFootprint(const MotionPoses & poses, SweptFootprint & swept_footprint);
+
+  /**
+   * @brief Check if in collision with costmap anywhere over a swept set of poses. This
+   * matches checking each pose individually, except that the footprint cells of all poses
+   * are checked (and give the cost) once any pose center is potentially in an inscribed
+   * collision.
+   * @param swept_footprint The swept cells, from sweepFootprint()
+   * @param x X cell of the origin of the swept poses
+   * @param y Y cell of the origin of the swept poses
+   * @param traverse_unknown Whether or not to traverse in unknown space
+   * @return boolean if in collision or not, counting any cell off of the map as a collision
+   */
+  bool inCollision(
+    const SweptFootprint & swept_footprint,
+    const int & x,
+    const int & y,
+    const bool & traverse_unknown);
+
+  /**
+   * @brief Get whether the footprint is rasterized for span collision checking
+   * @return If the footprint is rasterized
+   */
+  bool isFootprintRasterized()
+  {
+    return rasterize_footprint_;
+  }
+
+  /**
+   * @brief Get an identifier of the current footprint, unique across collision checkers,
+   * which changes whenever the footprint does so that swept cells may be cached
+   * @return The footprint identifier
+   */
+  unsigned int getFootprintId()
+  {
+    return footprint_id_;
+  }
+
 private:
+  /**
+   * @brief Rasterize the oriented footprints into row spans of cells
+   */
+  void rasterizeFootprints();
+
+  /**
+   * @brief Add the cells of the oriented footprint's edges at an offset from a pose cell
+   * @param angle_bin Angle bin of the footprint
+   * @param x Offset of the footprint center from the pose cell in X, in cells
+   * @param y Offset of the footprint center from the pose cell in Y, in cells
+   * @param cells The (row, column) cells to add to
+   */
+  void traceFootprint(
+    const unsigned int & angle_bin, const double & x, const double & y,
+    std::vector<std::pair<int, int>> & cells);
+
+  /**
+   * @brief Merge a set of (row, column) cells into contiguous row spans
+   * @param cells The cells to merge, which are sorted and deduplicated in place
+   * @param rasterized_footprint The spans of the cells and their bounds
+   */
+  static void toSpans(
+    std::vector<std::pair<int, int>> & cells, RasterizedFootprint & rasterized_footprint);
+
+  /**
+   * @brief Get the maximum cost of a set of rasterized cells at a pose
+   * @param footprint The rasterized cells, relative to the pose cell
+   * @param x X cell of the pose
+   * @param y Y cell of the pose
+   * @param lethal_cost The lowest known cost considered a collision
+   * @return The occupied cost if any cell is lethal or off the map, else the maximum cost
+   */
+  double spanCost(
+    const RasterizedFootprint & footprint, const int & x, const int & y,
+    const unsigned char & lethal_cost);
+
+  /**
+   * @brief Get the maximum cost of the rasterized footprint cells at a pose
+   * @param x X cell of the pose
+   * @param y Y cell of the pose
+   * @param angle_bin Angle bin of the pose
+   * @return The lethal cost if any footprint cell is lethal or off the map, else the maximum cost
+   */
+  double rasterizedFootprintCost(const int & x, const int & y, const unsigned int & angle_bin);
+
   /**
    * @brief Check if value outside the range
    * @param min Minimum value of the range
@@ -111,12 +266,16 @@ private:
   bool outsideRange(const unsigned int & max, const float & value);
 
 protected:
-  std::vector<nav2_costmap_2d::Footprint> oriented_footprints_;
-  nav2_costmap_2d::Footprint unoriented_footprint_;
+  std::shared_ptr<const nav2_costmap_2d::FootprintGeometry> footprint_geometry_;
+  // Footprints at the angle bins, kept by the geometry
+  const std::vector<nav2_costmap_2d::Footprint> * oriented_footprints_{nullptr};
   double footprint_cost_;
-  bool footprint_is_radius_;
+  bool footprint_is_radius_{false};
   std::vector<float> angles_;
   double possible_inscribed_cost_{-1};
+  bool rasterize_footprint_;
+  std::vector<RasterizedFootprint> rasterized_footprints_;
+  unsigned int footprint_id_;
 };
 
 }  // namespace nav2_smac_planner
@@ -18,8 +18,11 @@
 #include <algorithm>
 #include <string>
 #include <memory>
+#include <vector>
 
 #include "nav2_costmap_2d/costmap_2d_ros.hpp"
+#include "nav2_costmap_2d/costmap_pyramid.hpp"
+#include "nav2_costmap_2d/layered_costmap.hpp"
 #include "nav2_smac_planner/constants.hpp"
 
 namespace nav2_smac_planner
@@ -74,6 +77,23 @@ public:
    */
   void on_cleanup();
 
+  /**
+   * @brief Set coarse levels kept up to date with the costmap, to copy the downsampled
+   * costmap from when one has the downsampling factor rather than downsampling each cell.
+   * Only used with the max function, as levels hold the max cost of their cells.
+   * @param pyramid Levels of the costmap, or nullptr to always downsample
+   */
+  void setCostmapPyramid(const nav2_costmap_2d::CostmapPyramid * pyramid);
+
+  /**
+   * @brief Set the layered costmap whose master costmap is downsampled, to only downsample
+   * again the cells changed by its updates since the previous downsampling. Its changed
+   * windows are read in downsample(), with the costmap mutex held.
+   * @param layered_costmap Layered costmap of the costmap, or nullptr to always downsample
+   * every cell
+   */
+  void setLayeredCostmap(const nav2_costmap_2d::LayeredCostmap * layered_costmap);
+
   /**
    * @brief Downsample the given costmap by the downsampling factor, and publish the downsampled costmap
    * @param downsampling_factor Multiplier for the costmap resolution
@@ -93,13 +113,17 @@ protected:
   void updateCostmapSize();
 
   /**
-   * @brief Explore all subcells of the original costmap and assign the max cost to the new (downsampled) cell
-   * @param new_mx The X-coordinate of the cell in the new costmap
-   * @param new_my The Y-coordinate of the cell in the new costmap
+   * @brief Explore all subcells of the original costmap and assign the max (or min) cost to
+   * the new (downsampled) cells of a window. The subcells are reduced a row of the original
+   * costmap at a time, over contiguous costs, before reducing each block of the row.
+   * @param x0 Window start x, in cells of the new costmap
+   * @param y0 Window start y, in cells of the new costmap
+   * @param xn Window end x (exclusive), in cells of the new costmap
+   * @param yn Window end y (exclusive), in cells of the new costmap
    */
-  void setCostOfCell(
-    const unsigned int & new_mx,
-    const unsigned int & new_my);
+  void downsampleWindow(
+    const unsigned int & x0, const unsigned int & y0,
+    const unsigned int & xn, const unsigned int & yn);
 
   unsigned int _size_x;
   unsigned int _size_y;
@@ -109,6 +133,13 @@ protected:
   bool _use_min_cost_neighbor;
   float _downsampled_resolution;
   nav2_costmap_2d::Costmap2D * _costmap;
+  const nav2_costmap_2d::CostmapPyramid * _costmap_pyramid;
+  const nav2_costmap_2d::LayeredCostmap * _layered_costmap;
+  // Whether the downsampled costmap is up to date with the costmap as of _update_count
+  bool _downsampled;
+  uint64_t _update_count;
+  std::vector<nav2_costmap_2d::LayeredCostmap::ChangedWindow> _changed_windows;
+  std::vector<unsigned char> _row_costs;
   std::unique_ptr<nav2_costmap_2d::Costmap2D> _downsampled_costmap;
   std::unique_ptr<nav2_costmap_2d::Costmap2DPublisher> _downsampled_costmap_pub;
 };
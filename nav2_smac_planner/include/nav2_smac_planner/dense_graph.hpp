@@ -0,0 +1,163 @@
+// Copyright (c) 2022, Samsung Research America
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License. Reserved.
+
+#ifndef NAV2_SMAC_PLANNER__DENSE_GRAPH_HPP_
+#define NAV2_SMAC_PLANNER__DENSE_GRAPH_HPP_
+
+#include <cstddef>
+#include <vector>
+
+namespace nav2_smac_planner
+{
+
+/**
+ * @class nav2_smac_planner::DenseGraph
+ * @brief An index-addressed graph of nodes sized to the planning space.
+ * Only the nodes touched by a search are stored, contiguously in the order they were
+ * first requested, so that the planning space costs a single slot index per state
+ * instead of a node. A slot is valid if it is within the nodes of the current search
+ * and holds the node of its index, so that a new search starts in constant time by
+ * reusing the stored nodes from the first one, without resetting the slots.
+ */
+template<typename NodeT>
+class DenseGraph
+{
+public:
+  typedef NodeT * NodePtr;
+
+  /**
+   * @brief A constructor for nav2_smac_planner::DenseGraph
+   */
+  DenseGraph()
+  : _used(0)
+  {
+  }
+
+  /**
+   * @brief Size the graph to a number of nodes, only reallocates if the size changed
+   * @param size Total number of nodes in the planning space
+   */
+  void resize(const unsigned int & size)
+  {
+    if (_slots.size() == size) {
+      return;
+    }
+
+    _slots.assign(size, 0u);
+    _blocks.clear();
+    _used = 0;
+  }
+
+  /**
+   * @brief Invalidate all nodes for a new search in constant time
+   */
+  void clear()
+  {
+    _used = 0;
+  }
+
+  /**
+   * @brief Get a node by index, creating it if it was not requested yet in this search
+   * @param index Index of the node, must be less than size()
+   * @return Node pointer to the node at index
+   */
+  inline NodePtr get(const unsigned int & index)
+  {
+    unsigned int & slot = _slots[index];
+    if (slot < _used) {
+      NodeT & node = getSlot(slot);
+      if (node.getIndex() == index) {
+        return &node;
+      }
+    }
+
+    // Blocks are reserved to their full size so that nodes never move once created
+    slot = _used++;
+    const unsigned int block = slot >> block_bits;
+    if (block == _blocks.size()) {
+      _blocks.emplace_back();
+      _blocks.back().reserve(block_size);
+    }
+    std::vector<NodeT> & nodes = _blocks[block];
+    const unsigned int offset = slot & (block_size - 1);
+    if (offset == nodes.size()) {
+      nodes.emplace_back(index);
+    } else {
+      nodes[offset] = NodeT(index);
+    }
+    return &nodes[offset];
+  }
+
+  /**
+   * @brief Whether the graph has been sized yet
+   * @return If the graph contains no nodes
+   */
+  inline bool empty() const
+  {
+    return _slots.empty();
+  }
+
+  /**
+   * @brief Get the number of nodes in the graph
+   * @return Number of nodes
+   */
+  inline unsigned int size() const
+  {
+    return _slots.size();
+  }
+
+  /**
+   * @brief Get the number of nodes stored, the most requested by a search since sized
+   * @return Number of nodes stored
+   */
+  inline unsigned int getStoredSize() const
+  {
+    unsigned int stored = 0;
+    for (const auto & nodes : _blocks) {
+      stored += nodes.size();
+    }
+    return stored;
+  }
+
+  /**
+   * @brief Get the memory held by the slots and the stored nodes
+   * @return Number of bytes allocated
+   */
+  inline size_t getMemoryUsage() const
+  {
+    size_t bytes = _slots.capacity() * sizeof(unsigned int);
+    for (const auto & nodes : _blocks) {
+      bytes += nodes.capacity() * sizeof(NodeT);
+    }
+    return bytes;
+  }
+
+protected:
+  inline NodeT & getSlot(const unsigned int & slot)
+  {
+    return _blocks[slot >> block_bits][slot & (block_size - 1)];
+  }
+
+  static constexpr unsigned int block_bits = 12;
+  static constexpr unsigned int block_size = 1u << block_bits;
+
+  // Slot of the node of each index, valid only if it holds the node of that index
+  std::vector<unsigned int> _slots;
+  std::vector<std::vector<NodeT>> _blocks;
+  unsigned int _used;
+};
+
+}  // namespace nav2_smac_planner
+
+#endif  // NAV2_SMAC_PLANNER__DENSE_GRAPH_HPP_
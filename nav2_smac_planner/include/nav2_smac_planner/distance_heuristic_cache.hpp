@@ -0,0 +1,113 @@
+// Copyright (c) 2022, Samsung Research America
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License. Reserved.
+
+#ifndef NAV2_SMAC_PLANNER__DISTANCE_HEURISTIC_CACHE_HPP_
+#define NAV2_SMAC_PLANNER__DISTANCE_HEURISTIC_CACHE_HPP_
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "nav2_smac_planner/constants.hpp"
+
+namespace nav2_smac_planner
+{
+
+/**
+ * The distance heuristic cache file is laid out in little endian byte order as:
+ *   DistanceHeuristicCacheHeader
+ *   float heading_angles[number_of_headings]
+ *   float lookup_table[lookup_table_length]
+ * where the header and heading angles are the key the table was computed for.
+ * The version is bumped whenever the table computed for the same key changes,
+ * such as by the closed-form Dubins and Reeds-Shepp distances of version 2.
+ */
+const char DISTANCE_HEURISTIC_CACHE_MAGIC[8] = {'N', 'A', 'V', '2', 'D', 'H', 'L', 'T'};
+const uint32_t DISTANCE_HEURISTIC_CACHE_VERSION = 2;
+
+/**
+ * @struct nav2_smac_planner::DistanceHeuristicCacheHeader
+ * @brief The header of a distance heuristic cache file
+ */
+struct DistanceHeuristicCacheHeader
+{
+  char magic[8];
+  uint32_t version;
+  uint32_t motion_model;
+  float turning_radius;
+  float lookup_table_dim;
+  uint32_t number_of_headings;
+  uint32_t lookup_table_length;
+};
+
+static_assert(
+  sizeof(DistanceHeuristicCacheHeader) == 32, "Unexpected distance heuristic cache padding");
+
+/**
+ * @class nav2_smac_planner::DistanceHeuristicCache
+ * @brief A persistent, versioned cache of a distance heuristic lookup table
+ * on disk, keyed by the parameters the table is computed from
+ */
+class DistanceHeuristicCache
+{
+public:
+  /**
+   * @brief A constructor for nav2_smac_planner::DistanceHeuristicCache
+   * @param directory Directory to store cached lookup tables in
+   * @param motion_model Motion model whose shortest distances are in the table
+   * @param turning_radius Minimum turning radius, in grid coordinates
+   * @param lookup_table_dim Size of the lookup table window, in cells
+   * @param heading_angles Angles of each heading bin in the table, in radians
+   */
+  DistanceHeuristicCache(
+    const std::string & directory,
+    const MotionModel & motion_model,
+    const float & turning_radius,
+    const float & lookup_table_dim,
+    const std::vector<float> & heading_angles);
+
+  /**
+   * @brief Load the cached lookup table by memory mapping its file
+   * @param lookup_table Lookup table to populate
+   * @return If a valid table was cached for this key
+   */
+  bool load(std::vector<float> & lookup_table) const;
+
+  /**
+   * @brief Save a lookup table to the cache, replacing any existing table atomically
+   * so that concurrently starting planners never read a partial file
+   * @param lookup_table Lookup table computed for this key
+   * @return If the table was saved
+   */
+  bool save(const std::vector<float> & lookup_table) const;
+
+  /**
+   * @brief Get the filepath of the cached lookup table for this key
+   * @return Filepath of the cache file
+   */
+  const std::string & getFilepath() const
+  {
+    return _filepath;
+  }
+
+protected:
+  std::string _directory;
+  std::string _filepath;
+  DistanceHeuristicCacheHeader _header;
+  std::vector<float> _heading_angles;
+};
+
+}  // namespace nav2_smac_planner
+
+#endif  // NAV2_SMAC_PLANNER__DISTANCE_HEURISTIC_CACHE_HPP_
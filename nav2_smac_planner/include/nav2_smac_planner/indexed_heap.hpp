@@ -0,0 +1,239 @@
+// Copyright (c) 2022, Samsung Research America
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License. Reserved.
+
+#ifndef NAV2_SMAC_PLANNER__INDEXED_HEAP_HPP_
+#define NAV2_SMAC_PLANNER__INDEXED_HEAP_HPP_
+
+#include <algorithm>
+#include <vector>
+#include <limits>
+#include <unordered_map>
+#include <utility>
+
+namespace nav2_smac_planner
+{
+
+/**
+ * @class nav2_smac_planner::IndexedHeap
+ * @brief A d-ary min-heap keyed by node index supporting decrease-key, such that
+ * every node is in the open set at most once. Element positions are tracked either
+ * in a dense array (when the index space is reserved ahead of time) or in a hash map.
+ */
+template<typename PayloadT, unsigned int D = 4>
+class IndexedHeap
+{
+public:
+  /**
+   * @struct nav2_smac_planner::IndexedHeap::Element
+   * @brief An element of the heap
+   */
+  struct Element
+  {
+    Element(const float & cost_in, const unsigned int & index_in, const PayloadT & payload_in)
+    : cost(cost_in), index(index_in), payload(payload_in)
+    {}
+
+    float cost;
+    unsigned int index;
+    PayloadT payload;
+  };
+
+  static constexpr unsigned int NOT_QUEUED = std::numeric_limits<unsigned int>::max();
+
+  /**
+   * @brief A constructor for nav2_smac_planner::IndexedHeap
+   */
+  IndexedHeap() {}
+
+  /**
+   * @brief Use a dense position array for keys in [0, size), otherwise a hash map is used
+   * @param size Number of unique keys that may be inserted, 0 to use a hash map
+   */
+  void reserveIndices(const unsigned int & size)
+  {
+    clear();
+    _dense_positions.assign(size, NOT_QUEUED);
+    _positions.clear();
+  }
+
+  /**
+   * @brief Insert a new element, or update the cost and payload of an existing one
+   * @param cost Priority of the element, lowest first
+   * @param index Unique key of the element
+   * @param payload Data to store with the element
+   */
+  void push(const float & cost, const unsigned int & index, const PayloadT & payload)
+  {
+    unsigned int & position = getPosition(index);
+    if (position == NOT_QUEUED) {
+      position = static_cast<unsigned int>(_heap.size());
+      _heap.emplace_back(cost, index, payload);
+      siftUp(position);
+      return;
+    }
+
+    Element & element = _heap[position];
+    const bool decreased = cost < element.cost;
+    element.cost = cost;
+    element.payload = payload;
+    if (decreased) {
+      siftUp(position);
+    } else {
+      siftDown(position);
+    }
+  }
+
+  /**
+   * @brief Get the lowest cost element
+   * @return Reference to the top element
+   */
+  inline const Element & top() const
+  {
+    return _heap.front();
+  }
+
+  /**
+   * @brief Remove the lowest cost element
+   */
+  void pop()
+  {
+    erasePosition(_heap.front().index);
+    if (_heap.size() == 1) {
+      _heap.pop_back();
+      return;
+    }
+
+    _heap.front() = std::move(_heap.back());
+    _heap.pop_back();
+    getPosition(_heap.front().index) = 0;
+    siftDown(0);
+  }
+
+  /**
+   * @brief Whether an index is currently in the heap
+   * @param index Key to check
+   * @return If queued
+   */
+  inline bool contains(const unsigned int & index)
+  {
+    if (!_dense_positions.empty()) {
+      return _dense_positions[index] != NOT_QUEUED;
+    }
+    return _positions.find(index) != _positions.end();
+  }
+
+  /**
+   * @brief Whether the heap is empty
+   * @return If empty
+   */
+  inline bool empty() const
+  {
+    return _heap.empty();
+  }
+
+  /**
+   * @brief Number of elements in the heap
+   * @return Size
+   */
+  inline unsigned int size() const
+  {
+    return static_cast<unsigned int>(_heap.size());
+  }
+
+  /**
+   * @brief Remove all elements, scales with the number of queued elements only
+   */
+  void clear()
+  {
+    if (!_dense_positions.empty()) {
+      for (const Element & element : _heap) {
+        _dense_positions[element.index] = NOT_QUEUED;
+      }
+    }
+    _positions.clear();
+    _heap.clear();
+  }
+
+protected:
+  inline unsigned int & getPosition(const unsigned int & index)
+  {
+    if (!_dense_positions.empty()) {
+      return _dense_positions[index];
+    }
+    return _positions.emplace(index, NOT_QUEUED).first->second;
+  }
+
+  inline void erasePosition(const unsigned int & index)
+  {
+    if (!_dense_positions.empty()) {
+      _dense_positions[index] = NOT_QUEUED;
+    } else {
+      _positions.erase(index);
+    }
+  }
+
+  void siftUp(unsigned int position)
+  {
+    Element element = std::move(_heap[position]);
+    while (position > 0) {
+      const unsigned int parent = (position - 1) / D;
+      if (!(element.cost < _heap[parent].cost)) {
+        break;
+      }
+      _heap[position] = std::move(_heap[parent]);
+      getPosition(_heap[position].index) = position;
+      position = parent;
+    }
+    getPosition(element.index) = position;
+    _heap[position] = std::move(element);
+  }
+
+  void siftDown(unsigned int position)
+  {
+    const unsigned int size = static_cast<unsigned int>(_heap.size());
+    Element element = std::move(_heap[position]);
+    while (true) {
+      const unsigned int first_child = D * position + 1;
+      if (first_child >= size) {
+        break;
+      }
+
+      // Find the lowest cost child
+      const unsigned int last_child = std::min(first_child + D, size);
+      unsigned int best_child = first_child;
+      for (unsigned int child = first_child + 1; child < last_child; child++) {
+        if (_heap[child].cost < _heap[best_child].cost) {
+          best_child = child;
+        }
+      }
+
+      if (!(_heap[best_child].cost < element.cost)) {
+        break;
+      }
+      _heap[position] = std::move(_heap[best_child]);
+      getPosition(_heap[position].index) = position;
+      position = best_child;
+    }
+    getPosition(element.index) = position;
+    _heap[position] = std::move(element);
+  }
+
+  std::vector<Element> _heap;
+  std::vector<unsigned int> _dense_positions;
+  std::unordered_map<unsigned int, unsigned int> _positions;
+};
+
+}  // namespace nav2_smac_planner
+
+#endif  // NAV2_SMAC_PLANNER__INDEXED_HEAP_HPP_
@@ -0,0 +1,139 @@
+// Copyright (c) 2022, Samsung Research America
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License. Reserved.
+
+#ifndef NAV2_SMAC_PLANNER__JUMP_POINT_TABLE_HPP_
+#define NAV2_SMAC_PLANNER__JUMP_POINT_TABLE_HPP_
+
+#include <array>
+#include <cstdint>
+#include <utility>
+#include <vector>
+
+#include "nav2_costmap_2d/costmap_2d.hpp"
+#include "nav2_smac_planner/constants.hpp"
+
+namespace nav2_smac_planner
+{
+
+/**
+ * @class nav2_smac_planner::JumpPointTable
+ * @brief Jump distances of a Jump Point Search over the 8-connected grid of a costmap.
+ * The cells of equal cost form uniform regions where the search jumps in straight lines,
+ * only stopping at the jump points of the blocked cells, as on a uniform grid, and at the
+ * cells next to a cell of another cost, which are expanded in every direction. The
+ * straight jump distances are tabled, and only the lines around the cells which changed
+ * since the last update are recomputed.
+ */
+class JumpPointTable
+{
+public:
+  typedef std::pair<int, int> Direction;
+  typedef std::vector<Direction> DirectionVector;
+
+  /**
+   * @brief Update the table to the current costs of a costmap
+   * @param costmap Costmap to search
+   * @param traverse_unknown If unknown costs are valid to traverse
+   */
+  void update(const nav2_costmap_2d::Costmap2D * costmap, const bool & traverse_unknown);
+
+  /**
+   * @brief Set the goals the jumps stop at
+   * @param goals Indices of the goal cells
+   */
+  void setGoals(const std::vector<unsigned int> & goals);
+
+  /**
+   * @brief Get the directions to jump in from a cell, pruned by the direction it was
+   * reached from as on a uniform grid, or all of them if not in a uniform region
+   * @param index Index of the cell
+   * @param parent_index Index of the cell jumped from, or -1 for the start
+   * @param directions Vector of the directions to fill
+   */
+  void getDirections(
+    const unsigned int & index, const int & parent_index, DirectionVector & directions) const;
+
+  /**
+   * @brief Jump from a cell in a direction to the next jump point
+   * @param index Index of the cell jumped from
+   * @param direction Direction of the jump, as a step in x and y
+   * @param successor Index of the jump point reached
+   * @return Whether a jump point was reached before a blocked cell or the costmap bounds
+   */
+  bool jump(
+    const unsigned int & index, const Direction & direction, unsigned int & successor) const;
+
+private:
+  /**
+   * @brief Whether a cell is blocked, out of the costmap bounds included
+   */
+  inline bool isBlocked(const int & x, const int & y) const
+  {
+    if (x < 0 || y < 0 || x >= _size_x || y >= _size_y) {
+      return true;
+    }
+    return _flags[y * _size_x + x] & BLOCKED;
+  }
+
+  /**
+   * @brief Whether a cost is valid to traverse
+   */
+  inline bool isTraversable(const unsigned char & cost) const
+  {
+    return cost < INSCRIBED || (cost == UNKNOWN && _traverse_unknown);
+  }
+
+  /**
+   * @brief Whether a straight jump reaching a cell stops at it, either next to another
+   * cost or with a forced neighbor from a blocked cell
+   */
+  bool isJumpPoint(const int & x, const int & y, const int & dx, const int & dy) const;
+
+  /**
+   * @brief Distance of a straight jump from a cell, given the distance from the next
+   * cell of the jump. Positive to a jump point, else minus the cells crossed before a
+   * blocked cell.
+   */
+  int16_t getDistance(
+    const int & x, const int & y, const int & dx, const int & dy,
+    const int16_t & next_distance) const;
+
+  /**
+   * @brief Distance to the closest goal on a straight jump from a cell, within a range
+   * @return The distance, or 0 without a goal in range
+   */
+  int getGoalDistance(
+    const int & x, const int & y, const int & dx, const int & dy, const int & range) const;
+
+  void updateFlags(const int & x, const int & y);
+  void updateRow(const int & y);
+  void updateColumn(const int & x);
+
+  static constexpr uint8_t BLOCKED = 1;
+  static constexpr uint8_t BOUNDARY = 2;
+
+  int _size_x{0};
+  int _size_y{0};
+  bool _traverse_unknown{false};
+  // Costs of the last update, to find the cells changed since
+  std::vector<unsigned char> _costs;
+  std::vector<uint8_t> _flags;
+  // Straight jump distances towards +x, -x, +y and -y
+  std::array<std::vector<int16_t>, 4> _distances;
+  std::vector<std::pair<int, int>> _goals;
+};
+
+}  // namespace nav2_smac_planner
+
+#endif  // NAV2_SMAC_PLANNER__JUMP_POINT_TABLE_HPP_
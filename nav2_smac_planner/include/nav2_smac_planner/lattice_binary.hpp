@@ -0,0 +1,127 @@
+// Copyright (c) 2022, Samsung Research America
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License. Reserved.
+
+#ifndef NAV2_SMAC_PLANNER__LATTICE_BINARY_HPP_
+#define NAV2_SMAC_PLANNER__LATTICE_BINARY_HPP_
+
+#include <cstdint>
+#include <string>
+
+#include "nav2_smac_planner/types.hpp"
+#include "nav2_smac_planner/mapped_file.hpp"
+
+namespace nav2_smac_planner
+{
+
+/**
+ * The binary lattice file is laid out in little endian byte order as:
+ *   LatticeBinaryHeader
+ *   float heading_angles[number_of_headings]
+ *   LatticeBinaryPrimitive primitives[number_of_trajectories]
+ *   float poses[number_of_poses][3] (x, y, yaw of each primitive's poses, in order)
+ * matching the fields of the JSON lattice file written by generate_motion_primitives.py.
+ */
+const char LATTICE_BINARY_MAGIC[8] = {'N', 'A', 'V', '2', 'L', 'A', 'T', 'B'};
+const uint32_t LATTICE_BINARY_VERSION = 1;
+
+/**
+ * @struct nav2_smac_planner::LatticeBinaryHeader
+ * @brief The header of a binary lattice file
+ */
+struct LatticeBinaryHeader
+{
+  char magic[8];
+  uint32_t version;
+  float turning_radius;
+  float grid_resolution;
+  uint32_t number_of_headings;
+  uint32_t number_of_trajectories;
+  uint32_t number_of_poses;
+  char motion_model[16];
+};
+
+/**
+ * @struct nav2_smac_planner::LatticeBinaryPrimitive
+ * @brief A motion primitive record of a binary lattice file
+ */
+struct LatticeBinaryPrimitive
+{
+  uint32_t trajectory_id;
+  uint32_t start_angle_index;
+  uint32_t end_angle_index;
+  float trajectory_radius;
+  float trajectory_length;
+  float arc_length;
+  float straight_length;
+  uint32_t left_turn;
+  uint32_t pose_offset;
+  uint32_t number_of_poses;
+};
+
+static_assert(sizeof(LatticeBinaryHeader) == 48, "Unexpected binary lattice header padding");
+static_assert(sizeof(LatticeBinaryPrimitive) == 40, "Unexpected binary lattice record padding");
+
+/**
+ * @class nav2_smac_planner::LatticeBinaryFile
+ * @brief A read-only, memory mapped binary lattice file, which can be
+ * loaded without parsing. Its contents are copied out by the getters, so the
+ * file may be unmapped once loaded
+ */
+class LatticeBinaryFile
+{
+public:
+  /**
+   * @brief A constructor for nav2_smac_planner::LatticeBinaryFile
+   * @param filepath Filepath to the binary lattice file, throwing if it is not valid
+   */
+  explicit LatticeBinaryFile(const std::string & filepath);
+
+  /**
+   * @brief Check whether a file is a binary lattice file, rather than JSON
+   * @param filepath Filepath to the lattice file
+   * @return If the file starts with the binary lattice magic
+   */
+  static bool isLatticeBinaryFile(const std::string & filepath);
+
+  /**
+   * @brief Write a binary lattice file
+   * @param filepath Filepath to write the binary lattice file to
+   * @param metadata Metadata of the lattice
+   * @param primitives All motion primitives of the lattice, in order
+   */
+  static void write(
+    const std::string & filepath,
+    const LatticeMetadata & metadata,
+    const MotionPrimitives & primitives);
+
+  /**
+   * @brief Get the metadata of the lattice
+   * @return The lattice metadata
+   */
+  LatticeMetadata getMetadata() const;
+
+  /**
+   * @brief Get all motion primitives of the lattice, in order
+   * @param primitives The motion primitives to populate
+   */
+  void getMotionPrimitives(MotionPrimitives & primitives) const;
+
+protected:
+  MappedFile _file;
+  LatticeBinaryHeader _header;
+};
+
+}  // namespace nav2_smac_planner
+
+#endif  // NAV2_SMAC_PLANNER__LATTICE_BINARY_HPP_
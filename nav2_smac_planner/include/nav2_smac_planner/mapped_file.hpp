@@ -0,0 +1,70 @@
+// Copyright (c) 2022, Samsung Research America
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License. Reserved.
+
+#ifndef NAV2_SMAC_PLANNER__MAPPED_FILE_HPP_
+#define NAV2_SMAC_PLANNER__MAPPED_FILE_HPP_
+
+#include <cstddef>
+#include <string>
+
+namespace nav2_smac_planner
+{
+
+/**
+ * @class nav2_smac_planner::MappedFile
+ * @brief A read-only memory mapping of a file
+ */
+class MappedFile
+{
+public:
+  /**
+   * @brief A constructor for nav2_smac_planner::MappedFile
+   * @param filepath Filepath of the file to map, throwing if it cannot be mapped
+   */
+  explicit MappedFile(const std::string & filepath);
+
+  /**
+   * @brief A destructor for nav2_smac_planner::MappedFile
+   */
+  ~MappedFile();
+
+  MappedFile(const MappedFile &) = delete;
+  MappedFile & operator=(const MappedFile &) = delete;
+
+  /**
+   * @brief Get the mapped contents of the file
+   * @return Pointer to the first byte of the file
+   */
+  inline const unsigned char * data() const
+  {
+    return _data;
+  }
+
+  /**
+   * @brief Get the size of the mapped file
+   * @return Size of the file in bytes
+   */
+  inline std::size_t size() const
+  {
+    return _size;
+  }
+
+protected:
+  const unsigned char * _data;
+  std::size_t _size;
+};
+
+}  // namespace nav2_smac_planner
+
+#endif  // NAV2_SMAC_PLANNER__MAPPED_FILE_HPP_
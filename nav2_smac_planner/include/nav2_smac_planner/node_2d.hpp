@@ -27,11 +27,25 @@
 #include "nav2_smac_planner/types.hpp"
 #include "nav2_smac_planner/constants.hpp"
 #include "nav2_smac_planner/collision_checker.hpp"
+#include "nav2_smac_planner/jump_point_table.hpp"
 #include "nav2_smac_planner/node_hybrid.hpp"
 
 namespace nav2_smac_planner
 {
 
+/**
+ * @struct nav2_smac_planner::Node2DSearchState
+ * @brief Motion model and jump point table of a search, required across all of its
+ * nodes but allocated only once
+ */
+struct Node2DSearchState
+{
+  float cost_travel_multiplier{2.0};
+  std::vector<int> _neighbors_grid_offsets;
+  bool use_jump_point_search{false};
+  JumpPointTable jump_point_table;
+};
+
 /**
  * @class nav2_smac_planner::Node2D
  * @brief Node2D implementation for graph
@@ -137,6 +151,25 @@ public:
     _is_queued = false;
   }
 
+  /**
+   * @brief Gets if the cell was fully collision checked, always the case of a cell
+   * checked by its cost alone
+   * @return If the cell was fully collision checked
+   */
+  inline bool wasCollisionChecked()
+  {
+    return true;
+  }
+
+  /**
+   * @brief Clears the visited state of the cell so it can be expanded again,
+   * used to reopen nodes when an anytime search lowers its heuristic weight
+   */
+  inline void resetVisited()
+  {
+    _was_visited = false;
+  }
+
   /**
    * @brief Gets if cell is currently queued in search
    * @param If cell was queued
@@ -173,7 +206,8 @@ public:
 
   /**
    * @brief get traversal cost from this node to child node
-   * @param child Node pointer to this node's child
+   * @param child Node pointer to this node's child, or a jump point in a straight or
+   * diagonal line through cells of the child's cost
    * @return traversal cost
    */
   float getTraversalCost(const NodePtr & child);
@@ -215,7 +249,7 @@ public:
    */
   static inline Coordinates getCoords(const unsigned int & index)
   {
-    const unsigned int & size_x = _neighbors_grid_offsets[3];
+    const unsigned int & size_x = search_state->_neighbors_grid_offsets[3];
     return Coordinates(index % size_x, index / size_x);
   }
 
@@ -238,7 +272,7 @@ public:
    * @param x_size_uint The total x size to find neighbors
    * @param y_size The total y size to find neighbors
    * @param num_angle_quantization Number of quantizations, must be 0
-   * @param search_info Search parameters, unused by 2D node
+   * @param search_info Search parameters, the cost penalty and jump point search of 2D node
    */
   static void initMotionModel(
     const MotionModel & motion_model,
@@ -248,7 +282,8 @@ public:
     SearchInfo & search_info);
 
   /**
-   * @brief Retrieve all valid neighbors of a node.
+   * @brief Retrieve all valid neighbors of a node, or the jump points reached from it
+   * with the jump point search.
    * @param validity_checker Functor for state validity checking
    * @param collision_checker Collision checker to use
    * @param traverse_unknown If unknown costs are valid to traverse
@@ -262,14 +297,17 @@ public:
 
   /**
    * @brief Set the starting pose for planning, as a node index
-   * @param path Reference to a vector of indicies of generated path
+   * @param path Reference to a vector of indicies of generated path, with the cells
+   * between jump points filled in
    * @return whether the path was able to be backtraced
    */
   bool backtracePath(CoordinateVector & path);
 
   Node2D * parent;
-  static float cost_travel_multiplier;
-  static std::vector<int> _neighbors_grid_offsets;
+  // State of the search the calling thread plans with, shared by all of its nodes
+  static thread_local Node2DSearchState * search_state;
+  // Used by threads with no search bound, e.g. when using the nodes directly
+  static Node2DSearchState default_search_state;
 
 private:
   float _cell_cost;
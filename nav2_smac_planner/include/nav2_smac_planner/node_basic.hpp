@@ -25,8 +25,6 @@
 #include <utility>
 #include <limits>
 
-#include "ompl/base/StateSpace.h"
-
 #include "nav2_smac_planner/constants.hpp"
 #include "nav2_smac_planner/node_hybrid.hpp"
 #include "nav2_smac_planner/node_lattice.hpp"
@@ -76,6 +74,7 @@ public:
   MotionPrimitive * prim_ptr;  // Used by NodeLattice
   unsigned int index, motion_index;
   bool backward;
+  bool collision_checked;  // Used by NodeHybrid and NodeLattice
 };
 
 }  // namespace nav2_smac_planner
@@ -16,6 +16,7 @@
 #define NAV2_SMAC_PLANNER__NODE_HYBRID_HPP_
 
 #include <math.h>
+#include <array>
 #include <vector>
 #include <cmath>
 #include <iostream>
@@ -25,9 +26,9 @@
 #include <utility>
 #include <limits>
 
-#include "ompl/base/StateSpace.h"
-
+#include "nav2_smac_planner/analytic_curve.hpp"
 #include "nav2_smac_planner/constants.hpp"
+#include "nav2_smac_planner/distance_heuristic_cache.hpp"
 #include "nav2_smac_planner/types.hpp"
 #include "nav2_smac_planner/collision_checker.hpp"
 #include "nav2_smac_planner/costmap_downsampler.hpp"
@@ -48,6 +49,8 @@ struct ObstacleHeuristicComparator
 };
 
 typedef std::vector<ObstacleHeuristicElement> ObstacleHeuristicQueue;
+// Cells of the goals of a search, in costmap coordinates
+typedef std::vector<std::pair<unsigned int, unsigned int>> GoalCells;
 
 // Must forward declare
 class NodeHybrid;
@@ -96,6 +99,21 @@ struct HybridMotionTable
    */
   MotionPoses getProjections(const NodeHybrid * node);
 
+  /**
+   * @brief Get projections of motion models, for a number of primitives known at
+   * compile time so that the projections are neither allocated nor looped over at runtime
+   * @param node Ptr to NodeHybrid
+   * @param projection_list Array of the motion poses to fill
+   */
+  template<unsigned int NumPrimitives>
+  void getProjections(
+    const NodeHybrid * node, std::array<MotionPose, NumPrimitives> & projection_list);
+
+  /**
+   * @brief Compute the penalties of the travel cost of each primitive following another
+   */
+  void initTravelCostPenalties();
+
   /**
    * @brief Get the angular bin to use from a raw orientation
    * @param theta Angle in radians
@@ -122,10 +140,44 @@ struct HybridMotionTable
   float cost_penalty;
   float reverse_penalty;
   float travel_distance_reward;
-  ompl::base::StateSpacePtr state_space;
+  bool lazy_collision_checking{false};
+  AnalyticCurve analytic_curve;
   std::vector<std::vector<double>> delta_xs;
   std::vector<std::vector<double>> delta_ys;
   std::vector<TrigValues> trig_values;
+
+  static constexpr unsigned int max_primitives = 6;
+  // Travel cost factors of turning, by previous and new primitive, and of reversing
+  std::array<std::array<float, max_primitives>, max_primitives> turn_penalties;
+  std::array<float, max_primitives> reverse_penalties;
+};
+
+/**
+ * @struct nav2_smac_planner::NodeHybridSearchState
+ * @brief Motion table and heuristics of a search, required across all of its nodes
+ * but allocated only once
+ */
+struct NodeHybridSearchState
+{
+  double travel_distance_cost{std::sqrt(2.0)};
+  HybridMotionTable motion_table;
+  // Wavefront lookup and queue for continuing to expand as needed
+  LookupTable obstacle_heuristic_lookup_table;
+  ObstacleHeuristicQueue obstacle_heuristic_queue;
+  // Downsampled costs, goal and penalty the wavefront was computed with, for reuse. The
+  // costs are bordered by occupied cells and the lookup table is indexed the same way.
+  std::vector<unsigned char> obstacle_heuristic_costmap;
+  unsigned int obstacle_heuristic_size_x{0};
+  std::vector<unsigned int> obstacle_heuristic_goal_indices;
+  double obstacle_heuristic_cost_penalty{-1.0};
+  int obstacle_heuristic_threads{1};
+  int obstacle_heuristic_neighborhood{8};
+
+  nav2_costmap_2d::Costmap2D * sampled_costmap{nullptr};
+  CostmapDownsampler downsampler;
+  // Dubin / Reeds-Shepp lookup and size for dereferencing
+  LookupTable dist_heuristic_lookup_table;
+  float size_lookup{25};
 };
 
 /**
@@ -139,6 +191,19 @@ public:
   typedef std::unique_ptr<std::vector<NodeHybrid>> Graph;
   typedef std::vector<NodePtr> NodeVector;
 
+  /**
+   * @struct nav2_smac_planner::NodeHybrid::ProjectionCheck
+   * @brief Collision check of the projection of a node by a motion primitive
+   */
+  struct ProjectionCheck
+  {
+    MotionPose pose;
+    float cost;
+    bool valid;
+  };
+
+  typedef std::vector<ProjectionCheck> ProjectionChecks;
+
   /**
    * @class nav2_smac_planner::NodeHybrid::Coordinates
    * @brief NodeHybrid implementation of coordinate structure
@@ -272,6 +337,34 @@ public:
     _was_visited = true;
   }
 
+  /**
+   * @brief Clears the visited state of the cell so it can be expanded again,
+   * used to reopen nodes when an anytime search lowers its heuristic weight
+   */
+  inline void resetVisited()
+  {
+    _was_visited = false;
+  }
+
+  /**
+   * @brief Gets if the pose of the cell was fully collision checked, else it was
+   * only checked at its center for a lazy collision checking search
+   * @return If the pose was fully collision checked
+   */
+  inline bool & wasCollisionChecked()
+  {
+    return _was_collision_checked;
+  }
+
+  /**
+   * @brief Sets if the pose of the cell was fully collision checked
+   * @param checked If the pose was fully collision checked
+   */
+  inline void setCollisionChecked(const bool & checked)
+  {
+    _was_collision_checked = checked;
+  }
+
   /**
    * @brief Gets cell index
    * @return Reference to cell index
@@ -288,6 +381,23 @@ public:
    */
   bool isNodeValid(const bool & traverse_unknown, GridCollisionChecker * collision_checker);
 
+  /**
+   * @brief Check if this node is possibly valid from its center cell only, setting its
+   * cost to the center cost until fully checked by isDeferredNodeValid()
+   * @param traverse_unknown If we can explore unknown nodes on the graph
+   * @return whether this node is possibly valid
+   */
+  bool isNodeCenterValid(
+    const bool & traverse_unknown, GridCollisionChecker * collision_checker);
+
+  /**
+   * @brief Finish the collision check of a node only checked at its center
+   * @param traverse_unknown If we can explore unknown nodes on the graph
+   * @return whether this node is valid and collision free
+   */
+  bool isDeferredNodeValid(
+    const bool & traverse_unknown, GridCollisionChecker * collision_checker);
+
   /**
    * @brief Get traversal cost of parent node to child node
    * @param child Node pointer to child
@@ -322,8 +432,8 @@ public:
     const unsigned int & x, const unsigned int & y, const unsigned int & angle)
   {
     return getIndex(
-      x, y, angle, motion_table.size_x,
-      motion_table.num_angle_quantization);
+      x, y, angle, search_state->motion_table.size_x,
+      search_state->motion_table.num_angle_quantization);
   }
 
   /**
@@ -384,6 +494,18 @@ public:
     const unsigned int & dim_3_size,
     const SearchInfo & search_info);
 
+  /**
+   * @brief Get the memory held by the obstacle heuristic: its field, queue, costs and goals
+   * @return Number of bytes allocated
+   */
+  static size_t getObstacleHeuristicMemoryUsage();
+
+  /**
+   * @brief Get the memory held by the obstacle and distance heuristic lookup tables
+   * @return Number of bytes allocated
+   */
+  static size_t getLookupTablesMemoryUsage();
+
   /**
    * @brief Compute the Obstacle heuristic
    * @param node_coords Coordinates to get heuristic at
@@ -412,11 +534,79 @@ public:
    * @brief reset the obstacle heuristic state
    * @param costmap Costmap to use
    * @param goal_coords Coordinates to start heuristic expansion at
+   * @param cache Whether to keep the prior field when planning to the same goal. It is
+   * kept as-is if the downsampled costmap is unchanged, else incrementally repaired.
+   * @param threads Number of threads to expand the field with. If more than 1, the
+   * full field is expanded in parallel on the first request rather than on demand.
+   * @param neighborhood Number of the neighbors of a cell the field is expanded to, 4, 8,
+   * or 16 to add knight moves which follow straight lines more closely
+   */
+  static void resetObstacleHeuristic(
+    nav2_costmap_2d::Costmap2D * costmap,
+    const unsigned int & start_x, const unsigned int & start_y,
+    const unsigned int & goal_x, const unsigned int & goal_y,
+    const bool & cache = false,
+    const int & threads = 1,
+    const int & neighborhood = 8);
+
+  /**
+   * @brief reset the obstacle heuristic state to the cost to the closest of several goals,
+   * expanded from all of them at once
+   * @param costmap Costmap to use
+   * @param start_x Start X coordinate, to prioritize the expansion towards
+   * @param start_y Start Y coordinate, to prioritize the expansion towards
+   * @param goals Cells of the goals to start heuristic expansion at
+   * @param cache Whether to keep the prior field when planning to the same goals
+   * @param threads Number of threads to expand the field with
+   * @param neighborhood Number of the neighbors of a cell the field is expanded to
    */
   static void resetObstacleHeuristic(
     nav2_costmap_2d::Costmap2D * costmap,
     const unsigned int & start_x, const unsigned int & start_y,
-    const unsigned int & goal_x, const unsigned int & goal_y);
+    const GoalCells & goals,
+    const bool & cache = false,
+    const int & threads = 1,
+    const int & neighborhood = 8);
+
+  /**
+   * @brief Expand the full obstacle heuristic field from the goal in parallel using
+   * delta-stepping. Since every step costs at least 1, cells within a cost bucket of
+   * width 1 cannot improve one another and each bucket is settled concurrently.
+   * @param cost_penalty Penalty to apply to higher cost cells
+   */
+  static void expandObstacleHeuristicParallel(const double & cost_penalty);
+
+  /**
+   * @brief Expand the full obstacle heuristic field in parallel over a neighborhood
+   * @param cost_penalty Penalty to apply to higher cost cells
+   */
+  template<unsigned int Connectivity>
+  static void expandObstacleHeuristicParallel(const double & cost_penalty);
+
+  /**
+   * @brief Expand the obstacle heuristic field over a neighborhood until a cell is closed
+   * @param start_x X coordinate of the cell, in the obstacle heuristic costmap
+   * @param start_y Y coordinate of the cell, in the obstacle heuristic costmap
+   * @param cost_penalty Penalty to apply to higher cost cells
+   */
+  template<unsigned int Connectivity>
+  static void expandObstacleHeuristic(
+    const unsigned int & start_x, const unsigned int & start_y, const double & cost_penalty);
+
+  /**
+   * @brief Incrementally repair the obstacle heuristic where costs changed since it was
+   * computed. Values depending on cells with increased costs are invalidated (raise),
+   * then the affected cells are re-seeded and improvements propagated (lower).
+   * @param costs Downsampled costs the field should be repaired for
+   */
+  static void repairObstacleHeuristic(const unsigned char * costs);
+
+  /**
+   * @brief Incrementally repair the obstacle heuristic over a neighborhood of adjacent cells
+   * @param costs Downsampled costs the field should be repaired for
+   */
+  template<unsigned int Connectivity>
+  static void repairObstacleHeuristic(const unsigned char * costs);
 
   /**
    * @brief Retrieve all valid neighbors of a node.
@@ -431,6 +621,33 @@ public:
     const bool & traverse_unknown,
     NodeVector & neighbors);
 
+  /**
+   * @brief Collision check the projections of a batch of nodes by all motion primitives
+   * at once, in parallel with a collision checker per thread. The checks are independent
+   * and stored in order, so the results do not depend on the threads.
+   * @param nodes Nodes to project
+   * @param collision_checkers Collision checkers to use, one per thread
+   * @param traverse_unknown If unknown costs are valid to traverse
+   * @param checks Checks to fill, by node then by motion primitive
+   */
+  static void checkProjections(
+    const NodeVector & nodes,
+    std::vector<GridCollisionChecker> & collision_checkers,
+    const bool & traverse_unknown,
+    ProjectionChecks & checks);
+
+  /**
+   * @brief Retrieve all valid neighbors of a node from the checks of its projections,
+   * as getNeighbors() would find them
+   * @param validity_checker Functor for state validity checking
+   * @param checks Checks of the projections of this node by each motion primitive
+   * @param neighbors Vector of neighbors to be filled
+   */
+  void getCheckedNeighbors(
+    std::function<bool(const unsigned int &, nav2_smac_planner::NodeHybrid * &)> & validity_checker,
+    const ProjectionCheck * checks,
+    NodeVector & neighbors);
+
   /**
    * @brief Set the starting pose for planning, as a node index
    * @param path Reference to a vector of indicies of generated path
@@ -441,24 +658,28 @@ public:
   NodeHybrid * parent;
   Coordinates pose;
 
-  // Constants required across all nodes but don't want to allocate more than once
-  static double travel_distance_cost;
-  static HybridMotionTable motion_table;
-  // Wavefront lookup and queue for continuing to expand as needed
-  static LookupTable obstacle_heuristic_lookup_table;
-  static ObstacleHeuristicQueue obstacle_heuristic_queue;
-
-  static nav2_costmap_2d::Costmap2D * sampled_costmap;
-  static CostmapDownsampler downsampler;
-  // Dubin / Reeds-Shepp lookup and size for dereferencing
-  static LookupTable dist_heuristic_lookup_table;
-  static float size_lookup;
+  // State of the search the calling thread plans with, shared by all of its nodes
+  static thread_local NodeHybridSearchState * search_state;
+  // Used by threads with no search bound, e.g. when using the nodes directly
+  static NodeHybridSearchState default_search_state;
 
 private:
+  /**
+   * @brief Retrieve all valid neighbors of a node, for the number of primitives
+   * of the motion model
+   */
+  template<unsigned int NumPrimitives>
+  void getPrimitiveNeighbors(
+    std::function<bool(const unsigned int &, nav2_smac_planner::NodeHybrid * &)> & validity_checker,
+    GridCollisionChecker * collision_checker,
+    const bool & traverse_unknown,
+    NodeVector & neighbors);
+
   float _cell_cost;
   float _accumulated_cost;
   unsigned int _index;
   bool _was_visited;
+  bool _was_collision_checked;
   unsigned int _motion_primitive_index;
 };
 
@@ -28,12 +28,13 @@
 #include <string>
 
 #include "nlohmann/json.hpp"
-#include "ompl/base/StateSpace.h"
 #include "angles/angles.h"
 
+#include "nav2_smac_planner/analytic_curve.hpp"
 #include "nav2_smac_planner/constants.hpp"
 #include "nav2_smac_planner/types.hpp"
 #include "nav2_smac_planner/collision_checker.hpp"
+#include "nav2_smac_planner/lattice_binary.hpp"
 #include "nav2_smac_planner/node_hybrid.hpp"
 #include "nav2_smac_planner/utils.hpp"
 
@@ -96,6 +97,21 @@ struct LatticeMotionTable
    */
   float & getAngleFromBin(const unsigned int & bin_idx);
 
+  /**
+   * @brief Get the cells swept by the footprint over a motion primitive, relative to the
+   * primitive's end cell, rasterizing them on first use for the checker's footprint
+   * @param collision_checker Collision checker with the footprint to sweep
+   * @param motion_primitive Motion primitive to sweep
+   * @param is_backwards Whether the primitive is driven in reverse
+   * @param end_angle_bin Angle bin of the primitive's end pose in the collision checker
+   * @return The swept cells of the primitive
+   */
+  GridCollisionChecker::SweptFootprint & getSweptFootprint(
+    GridCollisionChecker * collision_checker,
+    MotionPrimitive * motion_primitive,
+    const bool & is_backwards,
+    const float & end_angle_bin);
+
   unsigned int size_x;
   unsigned int num_angle_quantization;
   float change_penalty;
@@ -105,11 +121,27 @@ struct LatticeMotionTable
   float travel_distance_reward;
   float rotation_penalty;
   bool allow_reverse_expansion;
+  bool lazy_collision_checking{false};
   std::vector<std::vector<MotionPrimitive>> motion_primitives;
-  ompl::base::StateSpacePtr state_space;
+  AnalyticCurve analytic_curve;
   std::vector<TrigValues> trig_values;
   std::string current_lattice_filepath;
   LatticeMetadata lattice_metadata;
+  std::vector<std::unique_ptr<GridCollisionChecker::SweptFootprint>> swept_footprints;
+  unsigned int swept_footprint_id{std::numeric_limits<unsigned int>::max()};
+};
+
+/**
+ * @struct nav2_smac_planner::NodeLatticeSearchState
+ * @brief Motion table and distance heuristic of a search, required across all of its
+ * nodes but allocated only once
+ */
+struct NodeLatticeSearchState
+{
+  LatticeMotionTable motion_table;
+  // Dubin / Reeds-Shepp lookup and size for dereferencing
+  LookupTable dist_heuristic_lookup_table;
+  float size_lookup{25};
 };
 
 /**
@@ -222,6 +254,34 @@ public:
     _was_visited = true;
   }
 
+  /**
+   * @brief Clears the visited state of the cell so it can be expanded again,
+   * used to reopen nodes when an anytime search lowers its heuristic weight
+   */
+  inline void resetVisited()
+  {
+    _was_visited = false;
+  }
+
+  /**
+   * @brief Gets if the pose of the cell was fully collision checked, else it was
+   * only checked at its center for a lazy collision checking search
+   * @return If the pose was fully collision checked
+   */
+  inline bool & wasCollisionChecked()
+  {
+    return _was_collision_checked;
+  }
+
+  /**
+   * @brief Sets if the pose of the cell was fully collision checked
+   * @param checked If the pose was fully collision checked
+   */
+  inline void setCollisionChecked(const bool & checked)
+  {
+    _was_collision_checked = checked;
+  }
+
   /**
    * @brief Gets cell index
    * @return Reference to cell index
@@ -264,6 +324,26 @@ public:
     MotionPrimitive * primitive = nullptr,
     bool is_backwards = false);
 
+  /**
+   * @brief Check if this node is possibly valid from the center cell of its pose only,
+   * setting its cost to the center cost until fully checked by isDeferredNodeValid()
+   * @param traverse_unknown If we can explore unknown nodes on the graph
+   * @param collision_checker Collision checker object to aid in validity checking
+   * @return whether this node is possibly valid
+   */
+  bool isNodeCenterValid(
+    const bool & traverse_unknown, GridCollisionChecker * collision_checker);
+
+  /**
+   * @brief Finish the collision check of a node only checked at its center, over the
+   * motion primitive and direction it was reached with
+   * @param traverse_unknown If we can explore unknown nodes on the graph
+   * @param collision_checker Collision checker object to aid in validity checking
+   * @return whether this node is valid and collision free
+   */
+  bool isDeferredNodeValid(
+    const bool & traverse_unknown, GridCollisionChecker * collision_checker);
+
   /**
    * @brief Get traversal cost of parent node to child node
    * @param child Node pointer to child
@@ -283,8 +363,8 @@ public:
   {
     // Hybrid-A* and State Lattice share a coordinate system
     return NodeHybrid::getIndex(
-      x, y, angle, motion_table.size_x,
-      motion_table.num_angle_quantization);
+      x, y, angle, search_state->motion_table.size_x,
+      search_state->motion_table.num_angle_quantization);
   }
 
   /**
@@ -346,18 +426,53 @@ public:
     const unsigned int & dim_3_size,
     const SearchInfo & search_info);
 
+  /**
+   * @brief Get the memory held by the distance heuristic lookup table and the
+   * obstacle heuristic shared with NodeHybrid
+   * @return Number of bytes allocated
+   */
+  static size_t getLookupTablesMemoryUsage();
+
   /**
    * @brief Compute the wavefront heuristic
    * @param costmap Costmap to use
    * @param goal_coords Coordinates to start heuristic expansion at
+   * @param cache Whether to keep, or repair, the prior field when planning to the same goal
+   * @param threads Number of threads to expand the field with
+   * @param neighborhood Number of the neighbors of a cell the field is expanded to, 4, 8,
+   * or 16 to add knight moves which better fit the smooth primitives of a lattice
    */
   static void resetObstacleHeuristic(
     nav2_costmap_2d::Costmap2D * costmap,
     const unsigned int & start_x, const unsigned int & start_y,
-    const unsigned int & goal_x, const unsigned int & goal_y)
+    const unsigned int & goal_x, const unsigned int & goal_y,
+    const bool & cache = false,
+    const int & threads = 1,
+    const int & neighborhood = 8)
   {
     // State Lattice and Hybrid-A* share this heuristics
-    NodeHybrid::resetObstacleHeuristic(costmap, start_x, start_y, goal_x, goal_y);
+    NodeHybrid::resetObstacleHeuristic(
+      costmap, start_x, start_y, goal_x, goal_y, cache, threads, neighborhood);
+  }
+
+  /**
+   * @brief Compute the wavefront heuristic to the closest of several goals
+   * @param costmap Costmap to use
+   * @param goals Cells of the goals to start heuristic expansion at
+   * @param cache Whether to keep, or repair, the prior field when planning to the same goals
+   * @param threads Number of threads to expand the field with
+   * @param neighborhood Number of the neighbors of a cell the field is expanded to
+   */
+  static void resetObstacleHeuristic(
+    nav2_costmap_2d::Costmap2D * costmap,
+    const unsigned int & start_x, const unsigned int & start_y,
+    const GoalCells & goals,
+    const bool & cache = false,
+    const int & threads = 1,
+    const int & neighborhood = 8)
+  {
+    NodeHybrid::resetObstacleHeuristic(
+      costmap, start_x, start_y, goals, cache, threads, neighborhood);
   }
 
   /**
@@ -410,18 +525,20 @@ public:
 
   NodeLattice * parent;
   Coordinates pose;
-  static LatticeMotionTable motion_table;
-  // Dubin / Reeds-Shepp lookup and size for dereferencing
-  static LookupTable dist_heuristic_lookup_table;
-  static float size_lookup;
+  // State of the search the calling thread plans with, shared by all of its nodes
+  static thread_local NodeLatticeSearchState * search_state;
+  // Used by threads with no search bound, e.g. when using the nodes directly
+  static NodeLatticeSearchState default_search_state;
 
 private:
   float _cell_cost;
   float _accumulated_cost;
   unsigned int _index;
   bool _was_visited;
-  MotionPrimitive * _motion_primitive;
+  // Packed beside the other flags rather than after the pointer, to save its padding
   bool _backwards;
+  bool _was_collision_checked;
+  MotionPrimitive * _motion_primitive;
 };
 
 }  // namespace nav2_smac_planner
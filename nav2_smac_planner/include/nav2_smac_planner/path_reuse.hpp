@@ -0,0 +1,86 @@
+// Copyright (c) 2021, Samsung Research America
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License. Reserved.
+
+#ifndef NAV2_SMAC_PLANNER__PATH_REUSE_HPP_
+#define NAV2_SMAC_PLANNER__PATH_REUSE_HPP_
+
+#include <functional>
+
+#include "geometry_msgs/msg/pose.hpp"
+#include "geometry_msgs/msg/pose_stamped.hpp"
+#include "nav_msgs/msg/path.hpp"
+
+namespace nav2_smac_planner
+{
+
+/**
+ * @class nav2_smac_planner::PathReuse
+ * @brief Keeps the last plan to a goal, to reuse it when replanning to the same goal while it
+ * is still collision-free, or to only replan the part of it which is not
+ */
+class PathReuse
+{
+public:
+  typedef std::function<bool (const geometry_msgs::msg::Pose &)> CollisionChecker;
+
+  /**
+   * @brief A constructor for nav2_smac_planner::PathReuse
+   * @param max_deviation Maximum distance of the start from the last plan to reuse it, in
+   * meters. Its heading must also be within a quarter turn of the plan's.
+   * @param repair_margin Length of the last plan kept clear of its poses in collision when
+   * replanning them, in meters
+   */
+  PathReuse(const double & max_deviation, const double & repair_margin);
+
+  /**
+   * @brief Set the last plan, to reuse for the next ones to its goal
+   * @param plan Last plan
+   * @param goal Goal of the last plan
+   */
+  void setPlan(const nav_msgs::msg::Path & plan, const geometry_msgs::msg::PoseStamped & goal);
+
+  /**
+   * @brief Forget the last plan
+   */
+  void clear();
+
+  /**
+   * @brief Find the part of the last plan which can be reused for a plan between poses
+   * @param start Start pose
+   * @param goal Goal pose, the last plan is only reused for the same goal
+   * @param in_collision Whether a pose of the last plan is now in collision
+   * @param plan Poses of the last plan from its pose closest to the start
+   * @param repair_start Index in plan of the pose to replan from. Equal to repair_end when
+   * none of the poses of the plan are in collision
+   * @param repair_end Index in plan of the pose to replan to
+   * @return If the last plan can be reused, in which case the plan is set
+   */
+  bool findReusablePath(
+    const geometry_msgs::msg::PoseStamped & start,
+    const geometry_msgs::msg::PoseStamped & goal,
+    const CollisionChecker & in_collision,
+    nav_msgs::msg::Path & plan,
+    unsigned int & repair_start,
+    unsigned int & repair_end);
+
+protected:
+  double max_deviation_;
+  double repair_margin_;
+  nav_msgs::msg::Path plan_;
+  geometry_msgs::msg::PoseStamped goal_;
+};
+
+}  // namespace nav2_smac_planner
+
+#endif  // NAV2_SMAC_PLANNER__PATH_REUSE_HPP_
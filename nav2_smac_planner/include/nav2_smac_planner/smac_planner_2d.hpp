@@ -15,6 +15,7 @@
 #ifndef NAV2_SMAC_PLANNER__SMAC_PLANNER_2D_HPP_
 #define NAV2_SMAC_PLANNER__SMAC_PLANNER_2D_HPP_
 
+#include <functional>
 #include <memory>
 #include <vector>
 #include <string>
@@ -32,6 +33,7 @@
 #include "geometry_msgs/msg/pose_stamped.hpp"
 #include "nav2_util/lifecycle_node.hpp"
 #include "nav2_util/node_utils.hpp"
+#include "nav2_util/instrumentation.hpp"
 #include "tf2/utils.h"
 #include "rcl_interfaces/msg/set_parameters_result.hpp"
 
@@ -88,6 +90,18 @@ public:
     const geometry_msgs::msg::PoseStamped & start,
     const geometry_msgs::msg::PoseStamped & goal) override;
 
+  /**
+   * @brief Creating a plan from start and goal poses, given up once cancelled
+   * @param start Start pose
+   * @param goal Goal pose
+   * @param cancel_checker Function returning true once the plan is no longer wanted
+   * @return nav2_msgs::Path of the generated path
+   */
+  nav_msgs::msg::Path createPlan(
+    const geometry_msgs::msg::PoseStamped & start,
+    const geometry_msgs::msg::PoseStamped & goal,
+    std::function<bool()> cancel_checker) override;
+
 protected:
   /**
    * @brief Callback executed when a parameter change is detected
@@ -96,10 +110,18 @@ protected:
   rcl_interfaces::msg::SetParametersResult
   dynamicParametersCallback(std::vector<rclcpp::Parameter> parameters);
 
+  /**
+   * @brief Set the memory accounts to the memory held by the search
+   */
+  void updateMemoryAccounts();
+
   std::unique_ptr<AStarAlgorithm<Node2D>> _a_star;
   GridCollisionChecker _collision_checker;
   std::unique_ptr<Smoother> _smoother;
   nav2_costmap_2d::Costmap2D * _costmap;
+  const nav2_costmap_2d::CostmapPyramid * _costmap_pyramid;
+  const nav2_costmap_2d::LayeredCostmap * _layered_costmap;
+  std::shared_ptr<nav2_costmap_2d::Costmap2DROS> _costmap_ros;
   std::unique_ptr<CostmapDownsampler> _costmap_downsampler;
   rclcpp::Clock::SharedPtr _clock;
   rclcpp::Logger _logger{rclcpp::get_logger("SmacPlanner2D")};
@@ -117,6 +139,7 @@ protected:
   std::string _motion_model_for_search;
   MotionModel _motion_model;
   std::mutex _mutex;
+  std::unique_ptr<nav2_util::MemoryAccount> _graph_memory;
   rclcpp_lifecycle::LifecycleNode::WeakPtr _node;
 
   // Dynamic parameters handler
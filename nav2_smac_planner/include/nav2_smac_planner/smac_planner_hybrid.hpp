@@ -15,12 +15,16 @@
 #ifndef NAV2_SMAC_PLANNER__SMAC_PLANNER_HYBRID_HPP_
 #define NAV2_SMAC_PLANNER__SMAC_PLANNER_HYBRID_HPP_
 
+#include <chrono>
+#include <cstdint>
+#include <functional>
 #include <memory>
 #include <vector>
 #include <string>
 
 #include "nav2_smac_planner/a_star.hpp"
 #include "nav2_smac_planner/smoother.hpp"
+#include "nav2_smac_planner/path_reuse.hpp"
 #include "nav2_smac_planner/utils.hpp"
 #include "nav2_smac_planner/costmap_downsampler.hpp"
 #include "nav_msgs/msg/occupancy_grid.hpp"
@@ -31,6 +35,7 @@
 #include "geometry_msgs/msg/pose_stamped.hpp"
 #include "nav2_util/lifecycle_node.hpp"
 #include "nav2_util/node_utils.hpp"
+#include "nav2_util/instrumentation.hpp"
 #include "tf2/utils.h"
 
 namespace nav2_smac_planner
@@ -86,6 +91,18 @@ public:
     const geometry_msgs::msg::PoseStamped & start,
     const geometry_msgs::msg::PoseStamped & goal) override;
 
+  /**
+   * @brief Creating a plan from start and goal poses, given up once cancelled
+   * @param start Start pose
+   * @param goal Goal pose
+   * @param cancel_checker Function returning true once the plan is no longer wanted
+   * @return nav2_msgs::Path of the generated path
+   */
+  nav_msgs::msg::Path createPlan(
+    const geometry_msgs::msg::PoseStamped & start,
+    const geometry_msgs::msg::PoseStamped & goal,
+    std::function<bool()> cancel_checker) override;
+
 protected:
   /**
    * @brief Callback executed when a paramter change is detected
@@ -94,14 +111,71 @@ protected:
   rcl_interfaces::msg::SetParametersResult
   dynamicParametersCallback(std::vector<rclcpp::Parameter> parameters);
 
+  /**
+   * @brief Search a plan between poses and smooth it
+   * @param costmap Costmap to plan on, set in the collision checker
+   * @param start Start pose
+   * @param goal Goal pose
+   * @param start_time Time the planning started at, for the time left to smooth
+   * @param cancel_checker Function returning true once the plan is no longer wanted, if any
+   * @param plan Plan to set the poses of, with the header of its poses
+   * @param error Reason of the failure, if no plan is found
+   * @return If a plan was found
+   */
+  bool searchPlan(
+    nav2_costmap_2d::Costmap2D * costmap,
+    const geometry_msgs::msg::PoseStamped & start,
+    const geometry_msgs::msg::PoseStamped & goal,
+    const std::chrono::steady_clock::time_point & start_time,
+    const std::function<bool()> & cancel_checker,
+    nav_msgs::msg::Path & plan,
+    std::string & error);
+
+  /**
+   * @brief Initialize the coarse 2D search of the corridors, or disable it when corridor
+   * search is not enabled
+   */
+  void initializeCorridorSearch();
+
+  /**
+   * @brief Set the memory accounts to the memory held by the search
+   */
+  void updateMemoryAccounts();
+
+  /**
+   * @brief Find a corridor around a 2D path between the start and goal on a coarse version
+   * of the costmap, that of the corridor collision checker, to restrict the expansions of
+   * the Hybrid-A* search to
+   * @param costmap Costmap the Hybrid-A* search plans on
+   * @param start Start pose
+   * @param goal Goal pose
+   * @return If a coarse path was found, in which case the corridor is set in _corridor
+   */
+  bool findCorridor(
+    nav2_costmap_2d::Costmap2D * costmap,
+    const geometry_msgs::msg::PoseStamped & start,
+    const geometry_msgs::msg::PoseStamped & goal);
+
   std::unique_ptr<AStarAlgorithm<NodeHybrid>> _a_star;
   GridCollisionChecker _collision_checker;
   std::unique_ptr<Smoother> _smoother;
+  std::unique_ptr<PathReuse> _path_reuse;
   rclcpp::Clock::SharedPtr _clock;
   rclcpp::Logger _logger{rclcpp::get_logger("SmacPlannerHybrid")};
   nav2_costmap_2d::Costmap2D * _costmap;
   std::shared_ptr<nav2_costmap_2d::Costmap2DROS> _costmap_ros;
+  uint64_t _footprint_version{0};
   std::unique_ptr<CostmapDownsampler> _costmap_downsampler;
+  std::unique_ptr<AStarAlgorithm<Node2D>> _corridor_a_star;
+  GridCollisionChecker _corridor_collision_checker;
+  std::unique_ptr<CostmapDownsampler> _corridor_downsampler;
+  std::vector<unsigned char> _corridor;
+  bool _corridor_search;
+  int _corridor_downsampling_factor;
+  double _corridor_radius;
+  bool _reuse_path;
+  double _reuse_path_max_deviation;
+  double _reuse_path_repair_margin;
   std::string _global_frame, _name;
   float _lookup_table_dim;
   float _tolerance;
@@ -110,6 +184,7 @@ protected:
   double _angle_bin_size;
   unsigned int _angle_quantizations;
   bool _allow_unknown;
+  bool _rasterize_footprint;
   int _max_iterations;
   SearchInfo _search_info;
   double _max_planning_time;
@@ -119,6 +194,8 @@ protected:
   MotionModel _motion_model;
   rclcpp_lifecycle::LifecyclePublisher<nav_msgs::msg::Path>::SharedPtr _raw_plan_publisher;
   std::mutex _mutex;
+  std::unique_ptr<nav2_util::MemoryAccount> _graph_memory;
+  std::unique_ptr<nav2_util::MemoryAccount> _lookup_table_memory;
   rclcpp_lifecycle::LifecycleNode::WeakPtr _node;
 
   // Dynamic parameters handler
@@ -15,12 +15,16 @@
 #ifndef NAV2_SMAC_PLANNER__SMAC_PLANNER_LATTICE_HPP_
 #define NAV2_SMAC_PLANNER__SMAC_PLANNER_LATTICE_HPP_
 
+#include <chrono>
+#include <cstdint>
+#include <functional>
 #include <memory>
 #include <vector>
 #include <string>
 
 #include "nav2_smac_planner/a_star.hpp"
 #include "nav2_smac_planner/smoother.hpp"
+#include "nav2_smac_planner/path_reuse.hpp"
 #include "nav2_smac_planner/utils.hpp"
 #include "nav_msgs/msg/occupancy_grid.hpp"
 #include "nav2_core/global_planner.hpp"
@@ -30,6 +34,7 @@
 #include "geometry_msgs/msg/pose_stamped.hpp"
 #include "nav2_util/lifecycle_node.hpp"
 #include "nav2_util/node_utils.hpp"
+#include "nav2_util/instrumentation.hpp"
 #include "tf2/utils.h"
 
 namespace nav2_smac_planner
@@ -85,6 +90,18 @@ public:
     const geometry_msgs::msg::PoseStamped & start,
     const geometry_msgs::msg::PoseStamped & goal) override;
 
+  /**
+   * @brief Creating a plan from start and goal poses, given up once cancelled
+   * @param start Start pose
+   * @param goal Goal pose
+   * @param cancel_checker Function returning true once the plan is no longer wanted
+   * @return nav2_msgs::Path of the generated path
+   */
+  nav_msgs::msg::Path createPlan(
+    const geometry_msgs::msg::PoseStamped & start,
+    const geometry_msgs::msg::PoseStamped & goal,
+    std::function<bool()> cancel_checker) override;
+
 protected:
   /**
    * @brief Callback executed when a paramter change is detected
@@ -93,24 +110,55 @@ protected:
   rcl_interfaces::msg::SetParametersResult
   dynamicParametersCallback(std::vector<rclcpp::Parameter> parameters);
 
+  /**
+   * @brief Search a plan between poses and smooth it
+   * @param start Start pose
+   * @param goal Goal pose
+   * @param start_time Time the planning started at, for the time left to smooth
+   * @param cancel_checker Function returning true once the plan is no longer wanted, if any
+   * @param plan Plan to set the poses of, with the header of its poses
+   * @param error Reason of the failure, if no plan is found
+   * @return If a plan was found
+   */
+  bool searchPlan(
+    const geometry_msgs::msg::PoseStamped & start,
+    const geometry_msgs::msg::PoseStamped & goal,
+    const std::chrono::steady_clock::time_point & start_time,
+    const std::function<bool()> & cancel_checker,
+    nav_msgs::msg::Path & plan,
+    std::string & error);
+
+  /**
+   * @brief Set the memory accounts to the memory held by the search
+   */
+  void updateMemoryAccounts();
+
   std::unique_ptr<AStarAlgorithm<NodeLattice>> _a_star;
   GridCollisionChecker _collision_checker;
   std::unique_ptr<Smoother> _smoother;
+  std::unique_ptr<PathReuse> _path_reuse;
   rclcpp::Clock::SharedPtr _clock;
   rclcpp::Logger _logger{rclcpp::get_logger("SmacPlannerLattice")};
   nav2_costmap_2d::Costmap2D * _costmap;
   std::shared_ptr<nav2_costmap_2d::Costmap2DROS> _costmap_ros;
+  uint64_t _footprint_version{0};
   MotionModel _motion_model;
   LatticeMetadata _metadata;
   std::string _global_frame, _name;
   SearchInfo _search_info;
   bool _allow_unknown;
+  bool _rasterize_footprint;
   int _max_iterations;
   float _tolerance;
   rclcpp_lifecycle::LifecyclePublisher<nav_msgs::msg::Path>::SharedPtr _raw_plan_publisher;
   double _max_planning_time;
   double _lookup_table_size;
+  bool _reuse_path;
+  double _reuse_path_max_deviation;
+  double _reuse_path_repair_margin;
   std::mutex _mutex;
+  std::unique_ptr<nav2_util::MemoryAccount> _graph_memory;
+  std::unique_ptr<nav2_util::MemoryAccount> _lookup_table_memory;
   rclcpp_lifecycle::LifecycleNode::WeakPtr _node;
 
   // Dynamic parameters handler
@@ -23,14 +23,13 @@
 #include <utility>
 
 #include "nav2_costmap_2d/costmap_2d.hpp"
+#include "nav2_smac_planner/analytic_curve.hpp"
 #include "nav2_smac_planner/types.hpp"
 #include "nav2_smac_planner/constants.hpp"
 #include "nav2_util/geometry_utils.hpp"
 #include "nav_msgs/msg/path.hpp"
 #include "angles/angles.h"
 #include "tf2/utils.h"
-#include "ompl/base/StateSpace.h"
-#include "ompl/base/spaces/DubinsStateSpace.h"
 
 namespace nav2_smac_planner
 {
@@ -77,6 +76,17 @@ struct BoundaryExpansion
 };
 
 typedef std::vector<BoundaryExpansion> BoundaryExpansions;
+
+/**
+ * @struct nav2_smac_planner::SmootherBuffers
+ * @brief Positions of a path segment being smoothed, contiguous per dimension
+ */
+struct SmootherBuffers
+{
+  std::vector<double> original_x, original_y;
+  std::vector<double> x, y;
+  std::vector<double> last_x, last_y;
+};
 typedef std::vector<geometry_msgs::msg::PoseStamped>::iterator PathIterator;
 typedef std::vector<geometry_msgs::msg::PoseStamped>::reverse_iterator ReversePathIterator;
 
@@ -124,33 +134,46 @@ protected:
    * @param reversing_segment Return if this is a reversing segment
    * @param costmap Pointer to minimal costmap
    * @param max_time Maximum time to compute, stop early if over limit
+   * @param refinement_ctr Number of refinements done so far
    * @return If smoothing was successful
    */
   bool smoothImpl(
     nav_msgs::msg::Path & path,
     bool & reversing_segment,
     const nav2_costmap_2d::Costmap2D * costmap,
-    const double & max_time);
+    const double & max_time,
+    int & refinement_ctr);
 
   /**
-   * @brief Get the field value for a given dimension
-   * @param msg Current pose to sample
-   * @param dim Dimension ID of interest
-   * @return dim value
+   * @brief Smooth a segment of a path and enforce its boundary conditions
+   * @param path Path the segment is in
+   * @param segment Segment of the path to smooth
+   * @param segment_path Path to populate with the smoothed segment
+   * @param costmap Pointer to minimal costmap
+   * @param max_time Maximum time to compute, stop early if over limit
+   * @param refinement_ctr Number of refinements done so far
+   * @return If smoothing was successful
    */
-  inline double getFieldByDim(
-    const geometry_msgs::msg::PoseStamped & msg,
-    const unsigned int & dim);
+  bool smoothSegment(
+    const nav_msgs::msg::Path & path,
+    const PathSegment & segment,
+    nav_msgs::msg::Path & segment_path,
+    const nav2_costmap_2d::Costmap2D * costmap,
+    const double & max_time,
+    int & refinement_ctr);
 
   /**
-   * @brief Set the field value for a given dimension
-   * @param msg Current pose to sample
-   * @param dim Dimension ID of interest
-   * @param value to set the dimention to for the pose
+   * @brief Smooth positions by gradient descent, towards their neighbors and their original
+   * positions, until they converge
+   * @param buffers Positions to smooth, in place, and their original positions
+   * @param costmap Pointer to minimal costmap
+   * @param max_time Maximum time to compute, stop early if over limit
+   * @return If smoothing converged, else the positions are the last ones without collision
    */
-  inline void setFieldByDim(
-    geometry_msgs::msg::PoseStamped & msg, const unsigned int dim,
-    const double & value);
+  bool smoothPositions(
+    SmootherBuffers & buffers,
+    const nav2_costmap_2d::Costmap2D * costmap,
+    const double & max_time);
 
   /**
    * @brief Finds the starting and end indices of path segments where
@@ -232,10 +255,10 @@ protected:
     bool & reversing_segment);
 
   double min_turning_rad_, tolerance_, data_w_, smooth_w_;
-  int max_its_, refinement_ctr_;
+  int max_its_, segment_smoothing_threads_;
   bool is_holonomic_, do_refinement_;
   MotionModel motion_model_;
-  ompl::base::StateSpacePtr state_space_;
+  AnalyticCurve analytic_curve_;
 };
 
 }  // namespace nav2_smac_planner
@@ -46,6 +46,21 @@ struct SearchInfo
   std::string lattice_filepath;
   bool cache_obstacle_heuristic;
   bool allow_reverse_expansion;
+  bool use_dense_graph{false};
+  bool use_indexed_heap{false};
+  int obstacle_heuristic_threads{1};
+  int obstacle_heuristic_neighborhood{8};
+  std::string distance_heuristic_cache_directory{""};
+  bool use_anytime_search{false};
+  float anytime_initial_weight{3.0};
+  float anytime_weight_decrement{0.5};
+  float anytime_target_bound{1.0};
+  bool use_bidirectional_search{false};
+  bool parallel_bidirectional_search{false};
+  bool use_jump_point_search{false};
+  bool use_lazy_collision_checking{false};
+  int expansion_batch_size{1};
+  int expansion_threads{1};
 };
 
 /**
@@ -58,7 +73,7 @@ struct SmootherParams
    * @brief A constructor for nav2_smac_planner::SmootherParams
    */
   SmootherParams()
-  : holonomic_(false)
+  : holonomic_(false), segment_smoothing_threads_(1)
   {
   }
 
@@ -87,6 +102,9 @@ struct SmootherParams
     nav2_util::declare_parameter_if_not_declared(
       node, local_name + "do_refinement", rclcpp::ParameterValue(true));
     node->get_parameter(local_name + "do_refinement", do_refinement_);
+    nav2_util::declare_parameter_if_not_declared(
+      node, local_name + "segment_smoothing_threads", rclcpp::ParameterValue(1));
+    node->get_parameter(local_name + "segment_smoothing_threads", segment_smoothing_threads_);
   }
 
   double tolerance_;
@@ -95,6 +113,7 @@ struct SmootherParams
   double w_smooth_;
   bool holonomic_;
   bool do_refinement_;
+  int segment_smoothing_threads_;
 };
 
 /**
@@ -13,3 +13,8 @@
 # limitations under the License. Reserved.
 
 VERSION = 1.0
+
+# Binary output file format, matching nav2_smac_planner::LatticeBinaryFile
+BINARY_MAGIC = b'NAV2LATB'
+BINARY_VERSION = 1
+BINARY_MOTION_MODEL_SIZE = 16
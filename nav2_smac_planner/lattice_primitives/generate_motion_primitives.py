@@ -17,6 +17,7 @@ from datetime import datetime
 import json
 import logging
 from pathlib import Path
+import struct
 import time
 
 import constants
@@ -53,6 +54,11 @@ def handle_arg_parsing():
                         default='./output.json',
                         help='The output file containing the '
                         'trajectory data')
+    parser.add_argument('--format',
+                        choices=['json', 'binary'],
+                        default='json',
+                        help='The format of the output file. Binary files are '
+                        'memory mapped by the planner rather than parsed')
     parser.add_argument('--visualizations',
                         type=Path,
                         default='./visualizations',
@@ -137,19 +143,22 @@ def create_header(config: dict, minimal_set_trajectories: dict) -> dict:
     return header_dict
 
 
-def write_to_json(output_path: Path, minimal_set_trajectories: dict, config: dict) -> None:
+def create_output(minimal_set_trajectories: dict, config: dict) -> dict:
     """
-    Write the minimal spanning set to an output file.
+    Create a dict containing the header and primitives of the minimal spanning set.
 
     Args:
     ----
-    output_path: Path
-        The output file for the json data
     minimal_set_trajectories: dict
         The minimal spanning set
     config: dict
         The dict containing user specified parameters
 
+    Returns
+    -------
+    dict
+        A dictionary containing the fields of the output file
+
     """
     output_dict = create_header(config, minimal_set_trajectories)
 
@@ -194,10 +203,84 @@ def write_to_json(output_path: Path, minimal_set_trajectories: dict, config: dic
 
     output_dict['lattice_metadata']['number_of_trajectories'] = idx
 
+    return output_dict
+
+
+def write_to_json(output_path: Path, output_dict: dict) -> None:
+    """
+    Write the minimal spanning set to a json output file.
+
+    Args:
+    ----
+    output_path: Path
+        The output file for the json data
+    output_dict: dict
+        The header and primitives of the minimal spanning set
+
+    """
     with open(output_path, 'w') as output_file:
         json.dump(output_dict, output_file, indent='\t')
 
 
+def write_to_binary(output_path: Path, output_dict: dict) -> None:
+    """
+    Write the minimal spanning set to a binary output file.
+
+    The layout matches nav2_smac_planner::LatticeBinaryFile, in little endian
+    byte order: a header, the heading angles, a record per primitive and then
+    the poses of every primitive.
+
+    Args:
+    ----
+    output_path: Path
+        The output file for the binary data
+    output_dict: dict
+        The header and primitives of the minimal spanning set
+
+    """
+    metadata = output_dict['lattice_metadata']
+    primitives = output_dict['primitives']
+    motion_model = metadata['motion_model'].encode('ascii')
+    if len(motion_model) >= constants.BINARY_MOTION_MODEL_SIZE:
+        raise ValueError(f'Motion model {metadata["motion_model"]} is too long')
+
+    number_of_poses = sum(len(primitive['poses']) for primitive in primitives)
+
+    with open(output_path, 'wb') as output_file:
+        output_file.write(struct.pack(
+            '<8sIffIII16s',
+            constants.BINARY_MAGIC,
+            constants.BINARY_VERSION,
+            metadata['turning_radius'],
+            metadata['grid_resolution'],
+            len(metadata['heading_angles']),
+            len(primitives),
+            number_of_poses,
+            motion_model))
+        output_file.write(struct.pack(
+            f'<{len(metadata["heading_angles"])}f', *metadata['heading_angles']))
+
+        pose_offset = 0
+        for primitive in primitives:
+            output_file.write(struct.pack(
+                '<IIIffffIII',
+                primitive['trajectory_id'],
+                primitive['start_angle_index'],
+                primitive['end_angle_index'],
+                primitive['trajectory_radius'],
+                primitive['trajectory_length'],
+                primitive['arc_length'],
+                primitive['straight_length'],
+                int(primitive['left_turn']),
+                pose_offset,
+                len(primitive['poses'])))
+            pose_offset += len(primitive['poses'])
+
+        for primitive in primitives:
+            for pose in primitive['poses']:
+                output_file.write(struct.pack('<3f', *pose))
+
+
 def save_visualizations(visualizations_folder: Path, minimal_set_trajectories: dict) -> None:
     """
     Draw the visualizations for every trajectory and save it as an image.
@@ -256,5 +339,9 @@ if __name__ == '__main__':
     minimal_set_trajectories = lattice_gen.run()
     print(f'Finished Generating. Took {time.time() - start} seconds')
 
-    write_to_json(args.output, minimal_set_trajectories, config)
+    output_dict = create_output(minimal_set_trajectories, config)
+    if args.format == 'binary':
+        write_to_binary(args.output, output_dict)
+    else:
+        write_to_json(args.output, output_dict)
     save_visualizations(args.visualizations, minimal_set_trajectories)
@@ -18,6 +18,7 @@
 #include <stdexcept>
 #include <memory>
 #include <algorithm>
+#include <atomic>
 #include <limits>
 #include <type_traits>
 #include <chrono>
@@ -44,9 +45,17 @@ AStarAlgorithm<NodeT>::AStarAlgorithm(
   _goal_coordinates(Coordinates()),
   _start(nullptr),
   _goal(nullptr),
-  _motion_model(motion_model)
+  _use_dense_graph(search_info.use_dense_graph),
+  _use_indexed_heap(search_info.use_indexed_heap),
+  _peak_queue_size(0),
+  _heuristic_weight(1.0),
+  _suboptimality_bound(1.0),
+  _motion_model(motion_model),
+  _corridor(nullptr)
 {
-  _graph.reserve(100000);
+  if (!_use_dense_graph) {
+    _graph.reserve(100000);
+  }
 }
 
 template<typename NodeT>
@@ -63,6 +72,7 @@ void AStarAlgorithm<NodeT>::initialize(
   const float & lookup_table_size,
   const unsigned int & dim_3_size)
 {
+  SearchStateGuard bind_state(_search_state);
   _traverse_unknown = allow_unknown;
   _max_iterations = max_iterations;
   _max_on_approach_iterations = max_on_approach_iterations;
@@ -82,6 +92,7 @@ void AStarAlgorithm<Node2D>::initialize(
   const float & /*lookup_table_size*/,
   const unsigned int & dim_3_size)
 {
+  SearchStateGuard bind_state(_search_state);
   _traverse_unknown = allow_unknown;
   _max_iterations = max_iterations;
   _max_on_approach_iterations = max_on_approach_iterations;
@@ -98,6 +109,7 @@ void AStarAlgorithm<Node2D>::initialize(
 template<typename NodeT>
 void AStarAlgorithm<NodeT>::setCollisionChecker(GridCollisionChecker * collision_checker)
 {
+  SearchStateGuard bind_state(_search_state);
   _collision_checker = collision_checker;
   _costmap = collision_checker->getCostmap();
   unsigned int x_size = _costmap->getSizeInCellsX();
@@ -110,6 +122,20 @@ void AStarAlgorithm<NodeT>::setCollisionChecker(GridCollisionChecker * collision
     _y_size = y_size;
     NodeT::initMotionModel(_motion_model, _x_size, _y_size, _dim3_size, _search_info);
   }
+
+  // Only reallocates when the size of the planning space changed
+  if (_use_dense_graph) {
+    const unsigned int graph_size = getSizeX() * getSizeY() * getSizeDim3();
+    if (_dense_graph.size() != graph_size) {
+      _dense_graph.resize(graph_size);
+
+      // With the full index space allocated, the heap can track positions densely too
+      if (_use_indexed_heap) {
+        _indexed_queue.reserveIndices(graph_size);
+      }
+    }
+  }
+
   _expander->setCollisionChecker(collision_checker);
 }
 
@@ -117,6 +143,10 @@ template<typename NodeT>
 typename AStarAlgorithm<NodeT>::NodePtr AStarAlgorithm<NodeT>::addToGraph(
   const unsigned int & index)
 {
+  if (_use_dense_graph) {
+    return _dense_graph.get(index);
+  }
+
   // Emplace will only create a new object if it doesn't already exist.
   // If an element exists, it will return the existing object, not create a new one.
   return &(_graph.emplace(index, NodeT(index)).first->second);
@@ -131,6 +161,7 @@ void AStarAlgorithm<Node2D>::setStart(
   if (dim_3 != 0) {
     throw std::runtime_error("Node type Node2D cannot be given non-zero starting dim 3.");
   }
+  SearchStateGuard bind_state(_search_state);
   _start = addToGraph(Node2D::getIndex(mx, my, getSizeX()));
 }
 
@@ -140,6 +171,7 @@ void AStarAlgorithm<NodeT>::setStart(
   const unsigned int & my,
   const unsigned int & dim_3)
 {
+  SearchStateGuard bind_state(_search_state);
   _start = addToGraph(NodeT::getIndex(mx, my, dim_3));
   _start->setPose(
     Coordinates(
@@ -148,6 +180,36 @@ void AStarAlgorithm<NodeT>::setStart(
       static_cast<float>(dim_3)));
 }
 
+template<>
+void AStarAlgorithm<Node2D>::setGoals(const CoordinateVector & goals)
+{
+  if (goals.empty()) {
+    throw std::runtime_error("At least one goal must be given.");
+  }
+
+  SearchStateGuard bind_state(_search_state);
+  _goals.clear();
+  for (const auto & goal : goals) {
+    _goals.push_back(
+      addToGraph(
+        Node2D::getIndex(
+          static_cast<unsigned int>(goal.x), static_cast<unsigned int>(goal.y), getSizeX())));
+  }
+  _goals_coordinates = goals;
+  _goal = _goals.front();
+  _goal_coordinates = goals.front();
+
+  // The jumps stop at the goals, over the costs current as of planning to them
+  if (Node2D::search_state->use_jump_point_search) {
+    std::vector<unsigned int> goal_indices;
+    for (const auto & goal : _goals) {
+      goal_indices.push_back(goal->getIndex());
+    }
+    Node2D::search_state->jump_point_table.update(_costmap, _traverse_unknown);
+    Node2D::search_state->jump_point_table.setGoals(goal_indices);
+  }
+}
+
 template<>
 void AStarAlgorithm<Node2D>::setGoal(
   const unsigned int & mx,
@@ -158,8 +220,19 @@ void AStarAlgorithm<Node2D>::setGoal(
     throw std::runtime_error("Node type Node2D cannot be given non-zero goal dim 3.");
   }
 
-  _goal = addToGraph(Node2D::getIndex(mx, my, getSizeX()));
-  _goal_coordinates = Node2D::Coordinates(mx, my);
+  setGoals({Node2D::Coordinates(mx, my)});
+}
+
+template<typename NodeT>
+void AStarAlgorithm<NodeT>::setCorridor(const std::vector<unsigned char> * corridor)
+{
+  _corridor = corridor;
+}
+
+template<typename NodeT>
+void AStarAlgorithm<NodeT>::setCancelChecker(std::function<bool()> cancel_checker)
+{
+  _cancel_checker = std::move(cancel_checker);
 }
 
 template<typename NodeT>
@@ -168,30 +241,55 @@ void AStarAlgorithm<NodeT>::setGoal(
   const unsigned int & my,
   const unsigned int & dim_3)
 {
-  _goal = addToGraph(NodeT::getIndex(mx, my, dim_3));
+  setGoals(
+  {
+    Coordinates(
+      static_cast<float>(mx),
+      static_cast<float>(my),
+      static_cast<float>(dim_3))
+  });
+}
 
-  typename NodeT::Coordinates goal_coords(
-    static_cast<float>(mx),
-    static_cast<float>(my),
-    static_cast<float>(dim_3));
+template<typename NodeT>
+void AStarAlgorithm<NodeT>::setGoals(const CoordinateVector & goals)
+{
+  if (goals.empty()) {
+    throw std::runtime_error("At least one goal must be given.");
+  }
 
-  if (!_search_info.cache_obstacle_heuristic || goal_coords != _goal_coordinates) {
-    if (!_start) {
-      throw std::runtime_error("Start must be set before goal.");
-    }
+  if (!_start) {
+    throw std::runtime_error("Start must be set before goal.");
+  }
 
-    NodeT::resetObstacleHeuristic(_costmap, _start->pose.x, _start->pose.y, mx, my);
+  SearchStateGuard bind_state(_search_state);
+  _goals.clear();
+  GoalCells goal_cells;
+  for (const auto & goal : goals) {
+    NodePtr goal_node = addToGraph(
+      NodeT::getIndex(
+        static_cast<unsigned int>(goal.x), static_cast<unsigned int>(goal.y),
+        static_cast<unsigned int>(goal.theta)));
+    goal_node->setPose(goal);
+    _goals.push_back(goal_node);
+    goal_cells.emplace_back(static_cast<unsigned int>(goal.x), static_cast<unsigned int>(goal.y));
   }
 
-  _goal_coordinates = goal_coords;
-  _goal->setPose(_goal_coordinates);
+  // The field is expanded from all of the goals at once, so it is the cost to the closest.
+  // If caching, the prior field is kept or repaired when the goal cells are unchanged.
+  NodeT::resetObstacleHeuristic(
+    _costmap, _start->pose.x, _start->pose.y, goal_cells, _search_info.cache_obstacle_heuristic,
+    _search_info.obstacle_heuristic_threads, _search_info.obstacle_heuristic_neighborhood);
+
+  _goals_coordinates = goals;
+  _goal = _goals.front();
+  _goal_coordinates = goals.front();
 }
 
 template<typename NodeT>
 bool AStarAlgorithm<NodeT>::areInputsValid()
 {
   // Check if graph was filled in
-  if (_graph.empty()) {
+  if (isGraphEmpty()) {
     throw std::runtime_error("Failed to compute path, no costmap given.");
   }
 
@@ -200,9 +298,12 @@ bool AStarAlgorithm<NodeT>::areInputsValid()
     throw std::runtime_error("Failed to compute path, no valid start or goal given.");
   }
 
-  // Check if ending point is valid
+  // Check if ending point is valid, with several goals any of them may be reached
   if (getToleranceHeuristic() < 0.001 &&
-    !_goal->isNodeValid(_traverse_unknown, _collision_checker))
+    std::none_of(
+      _goals.begin(), _goals.end(), [this](NodePtr & goal) {
+        return goal->isNodeValid(_traverse_unknown, _collision_checker);
+      }))
   {
     throw std::runtime_error("Failed to compute path, goal is occupied with no tolerance.");
   }
@@ -215,33 +316,190 @@ bool AStarAlgorithm<NodeT>::areInputsValid()
   return true;
 }
 
+template<>
+bool AStarAlgorithm<Node2D>::isLazyNodeExpandable(NodePtr &)
+{
+  // A 2D node is fully checked by its cell cost, so it is never deferred
+  return true;
+}
+
+template<typename NodeT>
+bool AStarAlgorithm<NodeT>::isLazyNodeExpandable(NodePtr & node)
+{
+  if (node->wasCollisionChecked()) {
+    return true;
+  }
+
+  // Orphaned by another pose of the node found in collision, and requeued if reached again
+  if (!node->parent) {
+    return false;
+  }
+
+  if (!node->isDeferredNodeValid(_traverse_unknown, _collision_checker)) {
+    // Reset so that the other poses reaching the node may queue it again
+    node->setAccumulatedCost(std::numeric_limits<float>::max());
+    node->parent = nullptr;
+    return false;
+  }
+
+  // With its footprint cost known, requeue the node if it was queued too early. Now
+  // checked, the node may also be the closest to the goal to end a path at.
+  const float g_cost =
+    node->parent->getAccumulatedCost() + node->parent->getTraversalCost(node);
+  const float heuristic = getHeuristicCost(node);
+  if (g_cost > node->getAccumulatedCost()) {
+    node->setAccumulatedCost(g_cost);
+    addNode(g_cost + _heuristic_weight * heuristic, node);
+    return false;
+  }
+
+  node->setAccumulatedCost(g_cost);
+  return true;
+}
+
+template<typename NodeT>
+unsigned int AStarAlgorithm<NodeT>::getExpansionBatchSize()
+{
+  return 1;
+}
+
+template<>
+unsigned int AStarAlgorithm<NodeHybrid>::getExpansionBatchSize()
+{
+  // Lazily checked neighbors are only checked once popped, so there is no batch to check
+  if (_search_info.use_lazy_collision_checking) {
+    return 1;
+  }
+  return static_cast<unsigned int>(std::max(1, _search_info.expansion_batch_size));
+}
+
+template<typename NodeT>
+void AStarAlgorithm<NodeT>::checkBatchNeighbors()
+{
+}
+
+template<>
+void AStarAlgorithm<NodeHybrid>::checkBatchNeighbors()
+{
+  if (getExpansionBatchSize() == 1) {
+    return;
+  }
+
+  // The collision checkers store the last cost checked, so each thread uses its own
+  const unsigned int threads = std::max(1, _search_info.expansion_threads);
+  if (_batch_collision_checkers.size() != threads) {
+    _batch_collision_checkers.assign(threads, *_collision_checker);
+  }
+  NodeHybrid::checkProjections(
+    _expansion_batch, _batch_collision_checkers, _traverse_unknown, _batch_checks);
+}
+
+template<typename NodeT>
+void AStarAlgorithm<NodeT>::getBatchNeighbors(
+  const unsigned int & batch_index, NodeGetter & neighbor_getter, NodeVector & neighbors)
+{
+  _expansion_batch[batch_index]->getNeighbors(
+    neighbor_getter, _collision_checker, _traverse_unknown, neighbors);
+}
+
+template<>
+void AStarAlgorithm<NodeHybrid>::getBatchNeighbors(
+  const unsigned int & batch_index, NodeGetter & neighbor_getter, NodeVector & neighbors)
+{
+  if (getExpansionBatchSize() == 1) {
+    _expansion_batch[batch_index]->getNeighbors(
+      neighbor_getter, _collision_checker, _traverse_unknown, neighbors);
+    return;
+  }
+
+  const unsigned int num_primitives = _batch_checks.size() / _expansion_batch.size();
+  _expansion_batch[batch_index]->getCheckedNeighbors(
+    neighbor_getter, &_batch_checks[batch_index * num_primitives], neighbors);
+}
+
+template<typename NodeT>
+void AStarAlgorithm<NodeT>::expandBatch(NodeGetter & neighbor_getter)
+{
+  checkBatchNeighbors();
+
+  NodePtr neighbor = nullptr;
+  float g_cost = 0.0;
+  for (unsigned int i = 0; i != _expansion_batch.size(); i++) {
+    NodePtr & current_node = _expansion_batch[i];
+    _batch_neighbors.clear();
+    getBatchNeighbors(i, neighbor_getter, _batch_neighbors);
+
+    for (NeighborIterator neighbor_iterator = _batch_neighbors.begin();
+      neighbor_iterator != _batch_neighbors.end(); ++neighbor_iterator)
+    {
+      neighbor = *neighbor_iterator;
+
+      // Skip the neighbors outside of the corridor, if restricted to one
+      if (_corridor && !(*_corridor)[neighbor->getIndex() / getSizeDim3()]) {
+        continue;
+      }
+
+      // 4.1) Compute the cost to go to this node
+      g_cost = current_node->getAccumulatedCost() + current_node->getTraversalCost(neighbor);
+
+      // 4.2) If this is a lower cost than prior, we set this as the new cost and new approach
+      if (g_cost < neighbor->getAccumulatedCost()) {
+        neighbor->setAccumulatedCost(g_cost);
+        neighbor->parent = current_node;
+
+        // 4.3) Add to queue with heuristic cost
+        addNode(g_cost + _heuristic_weight * getHeuristicCost(neighbor), neighbor);
+      }
+    }
+  }
+
+  _expansion_batch.clear();
+}
+
 template<typename NodeT>
 bool AStarAlgorithm<NodeT>::createPath(
   CoordinateVector & path, int & iterations,
   const float & tolerance)
 {
+  SearchStateGuard bind_state(_search_state);
   steady_clock::time_point start_time = steady_clock::now();
   _tolerance = tolerance;
   _best_heuristic_node = {std::numeric_limits<float>::max(), 0};
   clearQueue();
+  _closed_nodes.clear();
+  _expansion_batch.clear();
+  // Copied again once needed, as the costmap checked may have changed
+  _batch_collision_checkers.clear();
+
+  // The anytime search starts with an inflated heuristic to find a first path quickly
+  _heuristic_weight = _search_info.use_anytime_search ?
+    std::max(1.0f, _search_info.anytime_initial_weight) : 1.0f;
+  _suboptimality_bound = _heuristic_weight;
+  bool path_found = false;
 
   if (!areInputsValid()) {
     return false;
   }
 
+  // The backward search is rooted at the goal, so the goal tolerance or several goals
+  // require a forward search, as do the jumps which stop at the goals
+  if (_search_info.use_bidirectional_search && !_search_info.use_jump_point_search &&
+    _goals.size() == 1 &&
+    _goal->isNodeValid(_traverse_unknown, _collision_checker))
+  {
+    return createBidirectionalPath(path, iterations);
+  }
+
   // 0) Add starting point to the open set
   addNode(0.0, getStart());
   getStart()->setAccumulatedCost(0.0);
 
   // Optimization: preallocate all variables
   NodePtr current_node = nullptr;
-  NodePtr neighbor = nullptr;
   NodePtr expansion_result = nullptr;
-  float g_cost = 0.0;
-  NodeVector neighbors;
   int approach_iterations = 0;
-  NeighborIterator neighbor_iterator;
   int analytic_iterations = 0;
+  const unsigned int batch_size = getExpansionBatchSize();
   int closest_distance = std::numeric_limits<int>::max();
 
   // Given an index, return a node ptr reference if its collision-free and valid
@@ -257,16 +515,22 @@ bool AStarAlgorithm<NodeT>::createPath(
       return true;
     };
 
-  while (iterations < getMaxIterations() && !_queue.empty()) {
-    // Check for planning timeout only on every Nth iteration
+  while (iterations < getMaxIterations() && (!isQueueEmpty() || !_expansion_batch.empty())) {
+    // Check for planning timeout or cancellation only on every Nth iteration
     if (iterations % _timing_interval == 0) {
       std::chrono::duration<double> planning_duration =
         std::chrono::duration_cast<std::chrono::duration<double>>(steady_clock::now() - start_time);
-      if (static_cast<double>(planning_duration.count()) >= _max_planning_time) {
-        return false;
+      if (static_cast<double>(planning_duration.count()) >= _max_planning_time || isCancelled()) {
+        return path_found;
       }
     }
 
+    // 0.1) Expand the nodes popped so far if no other node is left to batch with them
+    if (isQueueEmpty()) {
+      expandBatch(neighborGetter);
+      continue;
+    }
+
     // 1) Pick Nbest from O s.t. min(f(Nbest)), remove from queue
     current_node = getNextNode();
 
@@ -276,60 +540,299 @@ bool AStarAlgorithm<NodeT>::createPath(
       continue;
     }
 
+    // 1.1) With lazy collision checking, the node is only fully checked once popped
+    if (_search_info.use_lazy_collision_checking && !isLazyNodeExpandable(current_node)) {
+      continue;
+    }
+
     iterations++;
 
     // 2) Mark Nbest as visited
     current_node->visited();
+    if (_search_info.use_anytime_search) {
+      _closed_nodes.push_back(current_node);
+    }
 
-    // 2.1) Use an analytic expansion (if available) to generate a path
+    // 2.1) Use an analytic expansion (if available) to generate a path, to the closest goal
     expansion_result = nullptr;
     expansion_result = _expander->tryAnalyticExpansion(
-      current_node, getGoal(), neighborGetter, analytic_iterations, closest_distance);
+      current_node, getClosestGoal(current_node), neighborGetter, analytic_iterations,
+      closest_distance);
     if (expansion_result != nullptr) {
       current_node = expansion_result;
     }
 
     // 3) Check if we're at the goal, backtrace if required
     if (isGoal(current_node)) {
-      return current_node->backtracePath(path);
+      if (!_search_info.use_anytime_search) {
+        return current_node->backtracePath(path);
+      }
+
+      // 3.1) With the anytime search, keep improving the path while time remains
+      path_found = true;
+      if (!improvePath(current_node, path)) {
+        return true;
+      }
+      // The nodes of the batch were reopened and requeued
+      _expansion_batch.clear();
+      approach_iterations = 0;
+      continue;
     } else if (_best_heuristic_node.first < getToleranceHeuristic()) {
       // Optimization: Let us find when in tolerance and refine within reason
       approach_iterations++;
       if (approach_iterations >= getOnApproachMaxIterations()) {
-        return _graph.at(_best_heuristic_node.second).backtracePath(path);
+        if (!_search_info.use_anytime_search) {
+          return addToGraph(_best_heuristic_node.second)->backtracePath(path);
+        }
+
+        path_found = true;
+        NodePtr best_node = addToGraph(_best_heuristic_node.second);
+        if (!improvePath(best_node, path)) {
+          return true;
+        }
+        _expansion_batch.clear();
+        approach_iterations = 0;
+        continue;
       }
     }
 
-    // 4) Expand neighbors of Nbest not visited
-    neighbors.clear();
-    current_node->getNeighbors(neighborGetter, _collision_checker, _traverse_unknown, neighbors);
+    // 4) Expand neighbors of Nbest not visited, once a batch of nodes is popped
+    _expansion_batch.push_back(current_node);
+    if (_expansion_batch.size() >= batch_size || isQueueEmpty()) {
+      expandBatch(neighborGetter);
+    }
+  }
+
+  return path_found;
+}
+
+template<typename NodeT>
+bool AStarAlgorithm<NodeT>::createBidirectionalPath(CoordinateVector &, int &)
+{
+  throw std::runtime_error("Bidirectional search is only supported by Node2D.");
+}
+
+template<>
+bool AStarAlgorithm<Node2D>::createBidirectionalPath(
+  CoordinateVector & path, int & iterations)
+{
+  steady_clock::time_point start_time = steady_clock::now();
+  const bool parallel = _search_info.parallel_bidirectional_search;
+  const unsigned int graph_size = getSizeX() * getSizeY();
 
-    for (neighbor_iterator = neighbors.begin();
-      neighbor_iterator != neighbors.end(); ++neighbor_iterator)
+  if (!_forward_frontier) {
+    _forward_frontier = std::make_unique<BidirectionalFrontier>(false);
+    _backward_frontier = std::make_unique<BidirectionalFrontier>(true);
+  }
+
+  // The collision checker stores the last cost checked, so each thread needs its own
+  GridCollisionChecker backward_collision_checker(*_collision_checker);
+  _forward_frontier->initialize(graph_size, _collision_checker, _traverse_unknown);
+  _backward_frontier->initialize(
+    graph_size, parallel ? &backward_collision_checker : _collision_checker, _traverse_unknown);
+  _forward_frontier->reset(_start->getIndex(), _goal->getIndex());
+  _backward_frontier->reset(_goal->getIndex(), _start->getIndex());
+
+  BidirectionalMeeting meeting;
+  std::atomic<int> total_iterations{0};
+  std::atomic<bool> completed{false};
+
+  // Expands a frontier until no path through its open set could be cheaper than the
+  // best meeting, in which case it is optimal, or until the search limits are reached
+  auto search =
+    [&, this](BidirectionalFrontier & frontier, BidirectionalFrontier & other) -> void
     {
-      neighbor = *neighbor_iterator;
+      int frontier_iterations = 0;
+      while (!meeting.done.load()) {
+        if (frontier_iterations++ % _timing_interval == 0) {
+          std::chrono::duration<double> planning_duration =
+            std::chrono::duration_cast<std::chrono::duration<double>>(
+            steady_clock::now() - start_time);
+          if (static_cast<double>(planning_duration.count()) >= _max_planning_time ||
+            isCancelled())
+          {
+            meeting.done = true;
+            return;
+          }
+        }
 
-      // 4.1) Compute the cost to go to this node
-      g_cost = current_node->getAccumulatedCost() + current_node->getTraversalCost(neighbor);
+        if (total_iterations.load() >= getMaxIterations()) {
+          meeting.done = true;
+          return;
+        }
 
-      // 4.2) If this is a lower cost than prior, we set this as the new cost and new approach
-      if (g_cost < neighbor->getAccumulatedCost()) {
-        neighbor->setAccumulatedCost(g_cost);
-        neighbor->parent = current_node;
+        if (frontier.getMinimumCost() >= meeting.cost.load()) {
+          completed = true;
+          meeting.done = true;
+          return;
+        }
 
-        // 4.3) Add to queue with heuristic cost
-        addNode(g_cost + getHeuristicCost(neighbor), neighbor);
+        frontier.expand(other, meeting);
+        total_iterations++;
       }
+    };
+
+  if (parallel) {
+    std::thread backward_thread(
+      [&, this]() {
+        // The thread expands the nodes of this search too
+        SearchStateGuard bind_state(_search_state);
+        search(*_backward_frontier, *_forward_frontier);
+      });
+    search(*_forward_frontier, *_backward_frontier);
+    backward_thread.join();
+  } else {
+    while (true) {
+      if (total_iterations.load() % _timing_interval == 0) {
+        std::chrono::duration<double> planning_duration =
+          std::chrono::duration_cast<std::chrono::duration<double>>(
+          steady_clock::now() - start_time);
+        if (static_cast<double>(planning_duration.count()) >= _max_planning_time ||
+          isCancelled())
+        {
+          break;
+        }
+      }
+
+      if (total_iterations.load() >= getMaxIterations()) {
+        break;
+      }
+
+      // Either exhausted open set also bounds every remaining path
+      if (_forward_frontier->getMinimumCost() >= meeting.cost.load() ||
+        _backward_frontier->getMinimumCost() >= meeting.cost.load())
+      {
+        completed = true;
+        break;
+      }
+
+      // Alternate by expanding the smaller open set, which balances the frontiers
+      if (_forward_frontier->getQueueSize() <= _backward_frontier->getQueueSize()) {
+        _forward_frontier->expand(*_backward_frontier, meeting);
+      } else {
+        _backward_frontier->expand(*_forward_frontier, meeting);
+      }
+      total_iterations++;
     }
   }
 
-  return false;
+  iterations = total_iterations.load();
+  if (!completed || meeting.cost.load() == std::numeric_limits<float>::max()) {
+    return false;
+  }
+
+  // Trace from the goal to the meeting node, then from the meeting node to the start
+  CoordinateVector meeting_path;
+  for (NodePtr node = _backward_frontier->getNode(meeting.index); node; node = node->parent) {
+    meeting_path.push_back(Node2D::getCoords(node->getIndex()));
+  }
+  path.insert(path.end(), meeting_path.rbegin(), meeting_path.rend());
+
+  // The start itself is not part of the path, as with a backtrace
+  for (NodePtr node = _forward_frontier->getNode(meeting.index)->parent;
+    node && node->parent; node = node->parent)
+  {
+    path.push_back(Node2D::getCoords(node->getIndex()));
+  }
+
+  if (meeting.index == _start->getIndex() && !path.empty()) {
+    path.pop_back();
+  }
+
+  return path.size() > 0;
+}
+
+template<typename NodeT>
+bool AStarAlgorithm<NodeT>::improvePath(NodePtr & node, CoordinateVector & path)
+{
+  CoordinateVector new_path;
+  if (node->backtracePath(new_path)) {
+    path.swap(new_path);
+    _suboptimality_bound = _heuristic_weight;
+  }
+
+  // Unweighted search cannot improve further, nor need it once within the target bound
+  if (_heuristic_weight <= 1.0f || _search_info.anytime_weight_decrement <= 0.0f ||
+    _suboptimality_bound <= _search_info.anytime_target_bound)
+  {
+    return false;
+  }
+  _heuristic_weight = std::max(1.0f, _heuristic_weight - _search_info.anytime_weight_decrement);
+
+  // Collect the open set, taking the first (lowest cost) queue entry of each node and
+  // marking it visited so that stale entries do not override its pose
+  NodeVector reopened_nodes;
+  reopened_nodes.swap(_closed_nodes);
+  while (!isQueueEmpty()) {
+    NodeBasic<NodeT> queued_node = _use_indexed_heap ?
+      _indexed_queue.top().payload : _queue.top().second;
+    if (_use_indexed_heap) {
+      _indexed_queue.pop();
+    } else {
+      _queue.pop();
+    }
+
+    if (!queued_node.graph_node_ptr->wasVisited()) {
+      queued_node.processSearchNode();
+      queued_node.graph_node_ptr->visited();
+      reopened_nodes.push_back(queued_node.graph_node_ptr);
+    }
+  }
+
+  // Nodes set along an analytic expansion were marked visited without being expanded
+  for (NodePtr path_node = node; path_node; path_node = path_node->parent) {
+    reopened_nodes.push_back(path_node);
+  }
+
+  // Requeue the open and closed sets with the new weight, keeping their costs, as
+  // closed nodes cannot be improved once visited within a search iteration.
+  // All collected nodes are now visited, so clearing it also skips duplicates.
+  _best_heuristic_node = {std::numeric_limits<float>::max(), 0};
+  for (NodePtr & reopened_node : reopened_nodes) {
+    if (!reopened_node->wasVisited()) {
+      continue;
+    }
+    reopened_node->resetVisited();
+    const float g_cost = reopened_node->getAccumulatedCost();
+    if (g_cost < std::numeric_limits<float>::max()) {
+      addNode(g_cost + _heuristic_weight * getHeuristicCost(reopened_node), reopened_node);
+    }
+  }
+
+  return true;
 }
 
 template<typename NodeT>
 bool AStarAlgorithm<NodeT>::isGoal(NodePtr & node)
 {
-  return node == getGoal();
+  if (_goals.size() == 1) {
+    return node == getGoal();
+  }
+
+  return std::find(_goals.begin(), _goals.end(), node) != _goals.end();
+}
+
+template<typename NodeT>
+typename AStarAlgorithm<NodeT>::NodePtr & AStarAlgorithm<NodeT>::getClosestGoal(
+  const NodePtr & node)
+{
+  if (_goals.size() == 1) {
+    return getGoal();
+  }
+
+  const Coordinates node_coords =
+    NodeT::getCoords(node->getIndex(), getSizeX(), getSizeDim3());
+  unsigned int closest = 0;
+  float closest_distance = std::numeric_limits<float>::max();
+  for (unsigned int i = 0; i != _goals_coordinates.size(); i++) {
+    const float distance = std::hypot(
+      _goals_coordinates[i].x - node_coords.x, _goals_coordinates[i].y - node_coords.y);
+    if (distance < closest_distance) {
+      closest_distance = distance;
+      closest = i;
+    }
+  }
+  return _goals[closest];
 }
 
 template<typename NodeT>
@@ -347,6 +850,13 @@ typename AStarAlgorithm<NodeT>::NodePtr & AStarAlgorithm<NodeT>::getGoal()
 template<typename NodeT>
 typename AStarAlgorithm<NodeT>::NodePtr AStarAlgorithm<NodeT>::getNextNode()
 {
+  if (_use_indexed_heap) {
+    NodeBasic<NodeT> node = _indexed_queue.top().payload;
+    _indexed_queue.pop();
+    node.processSearchNode();
+    return node.graph_node_ptr;
+  }
+
   NodeBasic<NodeT> node = _queue.top().second;
   _queue.pop();
   node.processSearchNode();
@@ -358,7 +868,16 @@ void AStarAlgorithm<NodeT>::addNode(const float & cost, NodePtr & node)
 {
   NodeBasic<NodeT> queued_node(node->getIndex());
   queued_node.populateSearchNode(node);
+
+  if (_use_indexed_heap) {
+    // If already queued, the cost and cached search state are updated in place
+    _indexed_queue.push(cost, queued_node.index, queued_node);
+    _peak_queue_size = std::max(_peak_queue_size, _indexed_queue.size());
+    return;
+  }
+
   _queue.emplace(cost, queued_node);
+  _peak_queue_size = std::max(_peak_queue_size, static_cast<unsigned int>(_queue.size()));
 }
 
 template<typename NodeT>
@@ -368,8 +887,13 @@ float AStarAlgorithm<NodeT>::getHeuristicCost(const NodePtr & node)
     NodeT::getCoords(node->getIndex(), getSizeX(), getSizeDim3());
   float heuristic = NodeT::getHeuristicCost(
     node_coords, _goal_coordinates, _costmap);
+  for (unsigned int i = 1; i < _goals_coordinates.size(); i++) {
+    heuristic = std::min(
+      heuristic, NodeT::getHeuristicCost(node_coords, _goals_coordinates[i], _costmap));
+  }
 
-  if (heuristic < _best_heuristic_node.first) {
+  // Only the fully collision checked nodes are valid to end a path at
+  if (heuristic < _best_heuristic_node.first && node->wasCollisionChecked()) {
     _best_heuristic_node = {heuristic, node->getIndex()};
   }
 
@@ -379,18 +903,56 @@ float AStarAlgorithm<NodeT>::getHeuristicCost(const NodePtr & node)
 template<typename NodeT>
 void AStarAlgorithm<NodeT>::clearQueue()
 {
+  _peak_queue_size = 0;
+
+  if (_use_indexed_heap) {
+    _indexed_queue.clear();
+    return;
+  }
+
   NodeQueue q;
   std::swap(_queue, q);
 }
 
+template<typename NodeT>
+bool AStarAlgorithm<NodeT>::isQueueEmpty()
+{
+  if (_use_indexed_heap) {
+    return _indexed_queue.empty();
+  }
+
+  return _queue.empty();
+}
+
 template<typename NodeT>
 void AStarAlgorithm<NodeT>::clearGraph()
 {
+  if (_use_dense_graph) {
+    _dense_graph.clear();
+    return;
+  }
+
   Graph g;
   std::swap(_graph, g);
   _graph.reserve(100000);
 }
 
+template<typename NodeT>
+bool AStarAlgorithm<NodeT>::isCancelled()
+{
+  return _cancel_checker && _cancel_checker();
+}
+
+template<typename NodeT>
+bool AStarAlgorithm<NodeT>::isGraphEmpty()
+{
+  if (_use_dense_graph) {
+    return _dense_graph.empty();
+  }
+
+  return _graph.empty();
+}
+
 template<typename NodeT>
 int & AStarAlgorithm<NodeT>::getMaxIterations()
 {
@@ -427,6 +989,37 @@ unsigned int & AStarAlgorithm<NodeT>::getSizeDim3()
   return _dim3_size;
 }
 
+template<typename NodeT>
+unsigned int & AStarAlgorithm<NodeT>::getPeakQueueSize()
+{
+  return _peak_queue_size;
+}
+
+template<typename NodeT>
+size_t AStarAlgorithm<NodeT>::getGraphMemoryUsage() const
+{
+  size_t bytes = static_cast<size_t>(_peak_queue_size) * sizeof(NodeElement);
+  if (_use_dense_graph) {
+    return bytes + _dense_graph.getMemoryUsage();
+  }
+
+  // Each node of the map is allocated with its key and the link to the next one
+  return bytes + _graph.bucket_count() * sizeof(void *) +
+         _graph.size() * (sizeof(typename Graph::value_type) + sizeof(void *));
+}
+
+template<typename NodeT>
+float & AStarAlgorithm<NodeT>::getSuboptimalityBound()
+{
+  return _suboptimality_bound;
+}
+
+template<typename NodeT>
+SearchState & AStarAlgorithm<NodeT>::getSearchState()
+{
+  return _search_state;
+}
+
 // Instantiate algorithm for the supported template types
 template class AStarAlgorithm<Node2D>;
 template class AStarAlgorithm<NodeHybrid>;
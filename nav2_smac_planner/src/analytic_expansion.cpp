@@ -12,10 +12,6 @@
 // See the License for the specific language governing permissions and
 // limitations under the License. Reserved.
 
-#include <ompl/base/ScopedState.h>
-#include <ompl/base/spaces/DubinsStateSpace.h>
-#include <ompl/base/spaces/ReedsSheppStateSpace.h>
-
 #include <algorithm>
 #include <vector>
 #include <memory>
@@ -122,16 +118,15 @@ typename AnalyticExpansion<NodeT>::AnalyticExpansionNodes AnalyticExpansion<Node
   const NodePtr & goal,
   const NodeGetter & node_getter)
 {
-  static ompl::base::ScopedState<> from(node->motion_table.state_space), to(
-    node->motion_table.state_space), s(node->motion_table.state_space);
-  from[0] = node->pose.x;
-  from[1] = node->pose.y;
-  from[2] = node->motion_table.getAngleFromBin(node->pose.theta);
-  to[0] = goal->pose.x;
-  to[1] = goal->pose.y;
-  to[2] = node->motion_table.getAngleFromBin(goal->pose.theta);
+  const AnalyticCurve & curve = NodeT::search_state->motion_table.analytic_curve;
+  const double x0 = node->pose.x;
+  const double y0 = node->pose.y;
+  const double theta0 = NodeT::search_state->motion_table.getAngleFromBin(node->pose.theta);
+  const CurvePath path = curve.getPath(
+    x0, y0, theta0, goal->pose.x, goal->pose.y,
+    NodeT::search_state->motion_table.getAngleFromBin(goal->pose.theta));
 
-  float d = node->motion_table.state_space->distance(from(), to());
+  float d = curve.length(path);
 
   // If the length is too far, exit. This prevents unsafe shortcutting of paths
   // into higher cost areas far out from the goal itself, let search to the work of getting
@@ -149,8 +144,10 @@ typename AnalyticExpansion<NodeT>::AnalyticExpansionNodes AnalyticExpansion<Node
   // When "from" and "to" are zero or one cell away,
   // num_intervals == 0
   possible_nodes.reserve(num_intervals);  // We won't store this node or the goal
-  std::vector<double> reals;
-  double theta;
+
+  // Intermediary poses (non-goal, non-start), with headings in range [0, 2PI)
+  _interpolated_poses.clear();
+  curve.interpolate(path, x0, y0, theta0, num_intervals, _interpolated_poses);
 
   // Pre-allocate
   NodePtr prev(node);
@@ -160,24 +157,19 @@ typename AnalyticExpansion<NodeT>::AnalyticExpansionNodes AnalyticExpansion<Node
   Coordinates proposed_coordinates;
   bool failure = false;
 
-  // Check intermediary poses (non-goal, non-start)
-  for (float i = 1; i < num_intervals; i++) {
-    node->motion_table.state_space->interpolate(from(), to(), i / num_intervals, s());
-    reals = s.reals();
-    // Make sure in range [0, 2PI)
-    theta = (reals[2] < 0.0) ? (reals[2] + 2.0 * M_PI) : reals[2];
-    theta = (theta > 2.0 * M_PI) ? (theta - 2.0 * M_PI) : theta;
-    angle = node->motion_table.getClosestAngularBin(theta);
+  // Check intermediary poses
+  for (const Coordinates & pose : _interpolated_poses) {
+    angle = NodeT::search_state->motion_table.getClosestAngularBin(pose.theta);
 
     // Turn the pose into a node, and check if it is valid
     index = NodeT::getIndex(
-      static_cast<unsigned int>(reals[0]),
-      static_cast<unsigned int>(reals[1]),
+      static_cast<unsigned int>(pose.x),
+      static_cast<unsigned int>(pose.y),
       static_cast<unsigned int>(angle));
     // Get the node from the graph
     if (node_getter(index, next)) {
       Coordinates initial_node_coords = next->pose;
-      proposed_coordinates = {static_cast<float>(reals[0]), static_cast<float>(reals[1]), angle};
+      proposed_coordinates = {pose.x, pose.y, angle};
       next->setPose(proposed_coordinates);
       if (next->isNodeValid(_traverse_unknown, _collision_checker) && next != prev) {
         // Save the node, and its previous coordinates in case we need to abort
@@ -0,0 +1,155 @@
+// Copyright (c) 2022, Samsung Research America
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License. Reserved.
+
+#include <algorithm>
+#include <limits>
+
+#include "nav2_smac_planner/bidirectional_frontier.hpp"
+
+namespace nav2_smac_planner
+{
+
+BidirectionalFrontier::BidirectionalFrontier(const bool & backward)
+: _backward(backward),
+  _traverse_unknown(true),
+  _collision_checker(nullptr),
+  _size(0),
+  _epoch(0)
+{
+  _neighbor_getter =
+    [this](const unsigned int & index, NodePtr & neighbor_rtn) -> bool
+    {
+      if (index >= _size) {
+        return false;
+      }
+
+      neighbor_rtn = _graph.get(index);
+      return true;
+    };
+}
+
+void BidirectionalFrontier::initialize(
+  const unsigned int & size,
+  GridCollisionChecker * collision_checker,
+  const bool & traverse_unknown)
+{
+  _collision_checker = collision_checker;
+  _traverse_unknown = traverse_unknown;
+
+  if (_size == size) {
+    return;
+  }
+
+  _graph.resize(size);
+  _costs = std::make_unique<std::atomic<uint64_t>[]>(size);
+  for (unsigned int i = 0; i != size; i++) {
+    _costs[i].store(0u, std::memory_order_relaxed);
+  }
+  _size = size;
+  _epoch = 0;
+}
+
+void BidirectionalFrontier::reset(
+  const unsigned int & root_index,
+  const unsigned int & target_index)
+{
+  _graph.clear();
+  _queue = NodeQueue();
+  _target_coordinates = Node2D::getCoords(target_index);
+
+  // Costs are stamped with the search they were set in, so no stale cost is read
+  _epoch++;
+  if (_epoch == 0) {
+    for (unsigned int i = 0; i != _size; i++) {
+      _costs[i].store(0u, std::memory_order_relaxed);
+    }
+    _epoch = 1;
+  }
+
+  // Validate the root so that its cell cost is set for backward traversal costs
+  NodePtr root = _graph.get(root_index);
+  root->isNodeValid(_traverse_unknown, _collision_checker);
+  root->setAccumulatedCost(0.0);
+  setAccumulatedCost(root_index, 0.0);
+  _queue.emplace(
+    Node2D::getHeuristicCost(Node2D::getCoords(root_index), _target_coordinates, nullptr), root);
+}
+
+float BidirectionalFrontier::getMinimumCost()
+{
+  // Skip entries of nodes since expanded by a cheaper queued entry
+  while (!_queue.empty() && _queue.top().second->wasVisited()) {
+    _queue.pop();
+  }
+
+  if (_queue.empty()) {
+    return std::numeric_limits<float>::max();
+  }
+
+  return _queue.top().first;
+}
+
+bool BidirectionalFrontier::expand(
+  const BidirectionalFrontier & other,
+  BidirectionalMeeting & meeting)
+{
+  while (!_queue.empty() && _queue.top().second->wasVisited()) {
+    _queue.pop();
+  }
+
+  if (_queue.empty()) {
+    return false;
+  }
+
+  NodePtr current_node = _queue.top().second;
+  _queue.pop();
+  current_node->visited();
+
+  // The other frontier may have reached this node before it was queued here
+  const float other_cost = other.getAccumulatedCost(current_node->getIndex());
+  if (other_cost < std::numeric_limits<float>::max()) {
+    meeting.update(current_node->getAccumulatedCost() + other_cost, current_node->getIndex());
+  }
+
+  _neighbors.clear();
+  current_node->getNeighbors(
+    _neighbor_getter, _collision_checker, _traverse_unknown, _neighbors);
+
+  for (NodePtr & neighbor : _neighbors) {
+    // Traversal cost is that of entering a cell, so the backward search
+    // pays the cost of the edge from the neighbor to the current node
+    const float g_cost = current_node->getAccumulatedCost() +
+      (_backward ? neighbor->getTraversalCost(current_node) :
+      current_node->getTraversalCost(neighbor));
+
+    if (g_cost < neighbor->getAccumulatedCost()) {
+      const unsigned int & index = neighbor->getIndex();
+      neighbor->setAccumulatedCost(g_cost);
+      neighbor->parent = current_node;
+      setAccumulatedCost(index, g_cost);
+      _queue.emplace(
+        g_cost + Node2D::getHeuristicCost(Node2D::getCoords(index), _target_coordinates, nullptr),
+        neighbor);
+
+      const float neighbor_other_cost = other.getAccumulatedCost(index);
+      if (neighbor_other_cost < std::numeric_limits<float>::max()) {
+        meeting.update(g_cost + neighbor_other_cost, index);
+      }
+    }
+  }
+
+  return true;
+}
+
+}  // namespace nav2_smac_planner
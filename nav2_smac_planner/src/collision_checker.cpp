@@ -12,15 +12,29 @@
 // See the License for the specific language governing permissions and
 // limitations under the License. Reserved.
 
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <memory>
+#include <utility>
+#include <vector>
+
+#include "nav2_util/grid_traversal.hpp"
 #include "nav2_smac_planner/collision_checker.hpp"
 
 namespace nav2_smac_planner
 {
 
+// Shared across instances so that footprint identifiers are never reused
+static std::atomic<unsigned int> next_footprint_id{0};
+
 GridCollisionChecker::GridCollisionChecker(
   nav2_costmap_2d::Costmap2D * costmap,
-  unsigned int num_quantizations)
-: FootprintCollisionChecker(costmap)
+  unsigned int num_quantizations,
+  const bool & rasterize_footprint)
+: FootprintCollisionChecker(costmap),
+  rasterize_footprint_(rasterize_footprint),
+  footprint_id_(next_footprint_id++)
 {
   // Convert number of regular bins into angles
   float bin_size = 2 * M_PI / static_cast<float>(num_quantizations);
@@ -43,6 +57,29 @@ void GridCollisionChecker::setFootprint(
   const bool & radius,
   const double & possible_inscribed_cost)
 {
+  // Footprints set again keep their geometry
+  if (footprint_geometry_ && footprint == footprint_geometry_->getFootprint()) {
+    setFootprint(footprint_geometry_, radius, possible_inscribed_cost);
+    return;
+  }
+  setFootprint(
+    std::make_shared<const nav2_costmap_2d::FootprintGeometry>(footprint),
+    radius, possible_inscribed_cost);
+}
+
+void GridCollisionChecker::setFootprint(
+  const std::shared_ptr<const nav2_costmap_2d::FootprintGeometry> & footprint_geometry,
+  const bool & radius,
+  const double & possible_inscribed_cost)
+{
+  const bool changed = !footprint_geometry_ ||
+    footprint_geometry->getVersion() != footprint_geometry_->getVersion();
+
+  // Swept cells cached by callers depend on both the footprint and its checking mode
+  if (radius != footprint_is_radius_ || (!radius && changed)) {
+    footprint_id_ = next_footprint_id++;
+  }
+
   possible_inscribed_cost_ = possible_inscribed_cost;
   footprint_is_radius_ = radius;
 
@@ -52,32 +89,184 @@ void GridCollisionChecker::setFootprint(
   }
 
   // No change, no updates required
-  if (footprint == unoriented_footprint_) {
+  if (!changed) {
     return;
   }
 
-  oriented_footprints_.reserve(angles_.size());
-  double sin_th, cos_th;
-  geometry_msgs::msg::Point new_pt;
-  const unsigned int footprint_size = footprint.size();
+  // The orientation bins for checking to use are computed once per footprint, and shared
+  // with the other checkers using as many bins
+  footprint_geometry_ = footprint_geometry;
+  oriented_footprints_ = &footprint_geometry_->getOrientedFootprints(angles_.size());
+
+  if (rasterize_footprint_) {
+    rasterizeFootprints();
+  }
+}
+
+void GridCollisionChecker::rasterizeFootprints()
+{
+  rasterized_footprints_.clear();
+  rasterized_footprints_.reserve(oriented_footprints_->size());
+  std::vector<std::pair<int, int>> cells;
+  for (unsigned int i = 0; i != oriented_footprints_->size(); i++) {
+    RasterizedFootprint rasterized_footprint;
+    cells.clear();
+    traceFootprint(i, 0.0, 0.0, cells);
+    toSpans(cells, rasterized_footprint);
+    rasterized_footprints_.push_back(rasterized_footprint);
+  }
+}
+
+void GridCollisionChecker::traceFootprint(
+  const unsigned int & angle_bin, const double & x, const double & y,
+  std::vector<std::pair<int, int>> & cells)
+{
+  // Footprint points are offset from the center of the pose cell, as mapToWorld places them
+  const double resolution = costmap_->getResolution();
+  auto toCellOffset = [&](const double & offset, const double & coord) {
+      return static_cast<int>(std::floor(offset + 0.5 + coord / resolution));
+    };
+
+  if (!oriented_footprints_ || angle_bin >= oriented_footprints_->size()) {
+    return;
+  }
+
+  // Trace each edge of the closed polygon, as footprintCost() would
+  const nav2_costmap_2d::Footprint & oriented_footprint = (*oriented_footprints_)[angle_bin];
+  const unsigned int footprint_size = oriented_footprint.size();
+  for (unsigned int i = 0; i != footprint_size; i++) {
+    const geometry_msgs::msg::Point & p0 = oriented_footprint[i];
+    const geometry_msgs::msg::Point & p1 = oriented_footprint[(i + 1) % footprint_size];
+    nav2_util::traverseLine(
+      toCellOffset(x, p0.x), toCellOffset(y, p0.y),
+      toCellOffset(x, p1.x), toCellOffset(y, p1.y),
+      [&cells](int cx, int cy) {cells.emplace_back(cy, cx);});
+  }
+}
+
+void GridCollisionChecker::toSpans(
+  std::vector<std::pair<int, int>> & cells, RasterizedFootprint & rasterized_footprint)
+{
+  if (cells.empty()) {
+    return;
+  }
+
+  // Merge the unique cells of each row into contiguous spans
+  std::sort(cells.begin(), cells.end());
+  cells.erase(std::unique(cells.begin(), cells.end()), cells.end());
+  rasterized_footprint.min_dy = cells.front().first;
+  rasterized_footprint.max_dy = cells.back().first;
+  rasterized_footprint.min_dx = cells.front().second;
+  rasterized_footprint.max_dx = cells.front().second;
+  for (const std::pair<int, int> & cell : cells) {
+    rasterized_footprint.min_dx = std::min(rasterized_footprint.min_dx, cell.second);
+    rasterized_footprint.max_dx = std::max(rasterized_footprint.max_dx, cell.second);
+    std::vector<FootprintSpan> & spans = rasterized_footprint.spans;
+    if (!spans.empty() && spans.back().dy == cell.first &&
+      spans.back().dx_end + 1 == cell.second)
+    {
+      spans.back().dx_end = cell.second;
+    } else {
+      spans.push_back(FootprintSpan{cell.first, cell.second, cell.second});
+    }
+  }
+}
+
+void GridCollisionChecker::sweepFootprint(
+  const MotionPoses & poses, SweptFootprint & swept_footprint)
+{
+  swept_footprint = SweptFootprint();
+  std::vector<std::pair<int, int>> center_cells, footprint_cells;
+  center_cells.reserve(poses.size());
+  for (const MotionPose & pose : poses) {
+    // Pose cells are truncated as the single pose check does for non-negative coordinates
+    center_cells.emplace_back(
+      static_cast<int>(std::floor(pose._y)), static_cast<int>(std::floor(pose._x)));
+    if (!footprint_is_radius_) {
+      traceFootprint(static_cast<unsigned int>(pose._theta), pose._x, pose._y, footprint_cells);
+    }
+  }
+
+  toSpans(center_cells, swept_footprint.centers);
+  toSpans(footprint_cells, swept_footprint.footprint);
+}
+
+double GridCollisionChecker::spanCost(
+  const RasterizedFootprint & footprint, const int & x, const int & y,
+  const unsigned char & lethal_cost)
+{
+  const int size_x = static_cast<int>(costmap_->getSizeInCellsX());
+  const int size_y = static_cast<int>(costmap_->getSizeInCellsY());
 
-  // Precompute the orientation bins for checking to use
-  for (unsigned int i = 0; i != angles_.size(); i++) {
-    sin_th = sin(angles_[i]);
-    cos_th = cos(angles_[i]);
-    nav2_costmap_2d::Footprint oriented_footprint;
-    oriented_footprint.reserve(footprint_size);
+  // Any part of the footprint off of the map is considered in collision
+  if (x + footprint.min_dx < 0 || x + footprint.max_dx >= size_x ||
+    y + footprint.min_dy < 0 || y + footprint.max_dy >= size_y)
+  {
+    return static_cast<double>(OCCUPIED);
+  }
 
-    for (unsigned int j = 0; j < footprint_size; j++) {
-      new_pt.x = footprint[j].x * cos_th - footprint[j].y * sin_th;
-      new_pt.y = footprint[j].x * sin_th + footprint[j].y * cos_th;
-      oriented_footprint.push_back(new_pt);
+  // Branchless maximum over each span so that the contiguous row is vectorized. Lethal
+  // is tracked separately since it takes precedence over the (higher) unknown cost.
+  const unsigned char * char_map = costmap_->getCharMap();
+  const unsigned char unknown = static_cast<unsigned char>(UNKNOWN);
+  unsigned char max_cost = 0;
+  for (const FootprintSpan & span : footprint.spans) {
+    const unsigned char * row = char_map + (y + span.dy) * size_x + x;
+    unsigned char span_cost = 0;
+    unsigned char span_lethal = 0;
+    for (int dx = span.dx_start; dx <= span.dx_end; dx++) {
+      span_cost = std::max(span_cost, row[dx]);
+      span_lethal |= static_cast<unsigned char>((row[dx] >= lethal_cost) & (row[dx] != unknown));
     }
 
-    oriented_footprints_.push_back(oriented_footprint);
+    if (span_lethal) {
+      return static_cast<double>(OCCUPIED);
+    }
+    max_cost = std::max(max_cost, span_cost);
   }
 
-  unoriented_footprint_ = footprint;
+  return static_cast<double>(max_cost);
+}
+
+double GridCollisionChecker::rasterizedFootprintCost(
+  const int & x, const int & y, const unsigned int & angle_bin)
+{
+  return spanCost(
+    rasterized_footprints_[angle_bin], x, y, static_cast<unsigned char>(OCCUPIED));
+}
+
+bool GridCollisionChecker::inCollision(
+  const SweptFootprint & swept_footprint,
+  const int & x,
+  const int & y,
+  const bool & traverse_unknown)
+{
+  // Pose centers are in collision if inscribed, as for a single pose
+  footprint_cost_ = spanCost(
+    swept_footprint.centers, x, y, static_cast<unsigned char>(INSCRIBED));
+  if (footprint_cost_ == OCCUPIED) {
+    return true;
+  }
+
+  // If using a radius or no pose is potentially in an inscribed collision,
+  // no need to check the footprint cells
+  if (footprint_is_radius_ || footprint_cost_ < possible_inscribed_cost_) {
+    return footprint_cost_ == UNKNOWN && !traverse_unknown;
+  }
+
+  if (footprint_cost_ == UNKNOWN && !traverse_unknown) {
+    return true;
+  }
+
+  footprint_cost_ = spanCost(
+    swept_footprint.footprint, x, y, static_cast<unsigned char>(OCCUPIED));
+
+  if (footprint_cost_ == UNKNOWN && traverse_unknown) {
+    return false;
+  }
+
+  // if occupied or unknown and not to traverse unknown space
+  return footprint_cost_ >= OCCUPIED;
 }
 
 bool GridCollisionChecker::inCollision(
@@ -118,10 +307,22 @@ bool GridCollisionChecker::inCollision(
     }
 
     // if possible inscribed, need to check actual footprint pose.
+    if (rasterize_footprint_) {
+      // Use precomputed footprint cells, offset by the pose cell to collision check
+      footprint_cost_ = rasterizedFootprintCost(
+        static_cast<int>(x), static_cast<int>(y), static_cast<unsigned int>(angle_bin));
+
+      if (footprint_cost_ == UNKNOWN && traverse_unknown) {
+        return false;
+      }
+
+      return footprint_cost_ >= OCCUPIED;
+    }
+
     // Use precomputed oriented footprints are done on initialization,
     // offset by translation value to collision check
     geometry_msgs::msg::Point new_pt;
-    const nav2_costmap_2d::Footprint & oriented_footprint = oriented_footprints_[angle_bin];
+    const nav2_costmap_2d::Footprint & oriented_footprint = (*oriented_footprints_)[angle_bin];
     nav2_costmap_2d::Footprint current_footprint;
     current_footprint.reserve(oriented_footprint.size());
     for (unsigned int i = 0; i < oriented_footprint.size(); ++i) {
@@ -165,6 +366,30 @@ bool GridCollisionChecker::inCollision(
   return footprint_cost_ >= INSCRIBED;
 }
 
+bool GridCollisionChecker::inCollisionAtCenter(
+  const float & x,
+  const float & y,
+  const bool & traverse_unknown)
+{
+  // Poses off the map are left to the full check, as in inCollision()
+  const unsigned int mx = static_cast<unsigned int>(x);
+  const unsigned int my = static_cast<unsigned int>(y);
+  if (x < 0.0f || y < 0.0f ||
+    mx >= costmap_->getSizeInCellsX() || my >= costmap_->getSizeInCellsY())
+  {
+    footprint_cost_ = 0.0;
+    return false;
+  }
+
+  footprint_cost_ = costmap_->getCost(mx, my);
+  if (footprint_cost_ == UNKNOWN && traverse_unknown) {
+    return false;
+  }
+
+  // Inscribed in the middle is a collision at any orientation of any footprint
+  return footprint_cost_ >= INSCRIBED;
+}
+
 float GridCollisionChecker::getCost()
 {
   // Assumes inCollision called prior
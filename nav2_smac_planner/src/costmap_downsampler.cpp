@@ -18,12 +18,48 @@
 #include <string>
 #include <memory>
 #include <algorithm>
+#include <vector>
 
 namespace nav2_smac_planner
 {
 
+namespace
+{
+
+// Reduce rows of costs into a row, then each block of the row into a cost. Both loops run
+// over contiguous costs, without branches, so that they can be vectorized.
+template<typename ReduceT>
+void reduceBlocks(
+  const unsigned char * rows, const unsigned int & num_rows, const unsigned int & stride,
+  const unsigned int & width, const unsigned int & block_size, const unsigned char & init,
+  unsigned char * row, unsigned char * blocks, ReduceT reduce)
+{
+  std::copy(rows, rows + width, row);
+  for (unsigned int j = 1; j < num_rows; ++j) {
+    const unsigned char * next_row = rows + j * stride;
+    for (unsigned int i = 0; i < width; ++i) {
+      row[i] = reduce(row[i], next_row[i]);
+    }
+  }
+
+  for (unsigned int start = 0, b = 0; start < width; start += block_size, ++b) {
+    const unsigned int end = std::min(start + block_size, width);
+    unsigned char cost = init;
+    for (unsigned int i = start; i < end; ++i) {
+      cost = reduce(cost, row[i]);
+    }
+    blocks[b] = cost;
+  }
+}
+
+}  // namespace
+
 CostmapDownsampler::CostmapDownsampler()
 : _costmap(nullptr),
+  _costmap_pyramid(nullptr),
+  _layered_costmap(nullptr),
+  _downsampled(false),
+  _update_count(0),
   _downsampled_costmap(nullptr),
   _downsampled_costmap_pub(nullptr)
 {
@@ -44,6 +80,7 @@ void CostmapDownsampler::on_configure(
   _costmap = costmap;
   _downsampling_factor = downsampling_factor;
   _use_min_cost_neighbor = use_min_cost_neighbor;
+  _downsampled = false;
   updateCostmapSize();
 
   _downsampled_costmap = std::make_unique<nav2_costmap_2d::Costmap2D>(
@@ -73,29 +110,89 @@ void CostmapDownsampler::on_deactivate()
 void CostmapDownsampler::on_cleanup()
 {
   _costmap = nullptr;
+  _costmap_pyramid = nullptr;
+  _layered_costmap = nullptr;
+  _downsampled = false;
   _downsampled_costmap.reset();
   _downsampled_costmap_pub.reset();
 }
 
+void CostmapDownsampler::setCostmapPyramid(const nav2_costmap_2d::CostmapPyramid * pyramid)
+{
+  _costmap_pyramid = pyramid;
+}
+
+void CostmapDownsampler::setLayeredCostmap(
+  const nav2_costmap_2d::LayeredCostmap * layered_costmap)
+{
+  _layered_costmap = layered_costmap;
+  _downsampled = false;
+}
+
 nav2_costmap_2d::Costmap2D * CostmapDownsampler::downsample(
   const unsigned int & downsampling_factor)
 {
+  if (downsampling_factor != _downsampling_factor) {
+    _downsampled = false;
+  }
   _downsampling_factor = downsampling_factor;
   updateCostmapSize();
 
   // Adjust costmap size if needed
   if (_downsampled_costmap->getSizeInCellsX() != _downsampled_size_x ||
     _downsampled_costmap->getSizeInCellsY() != _downsampled_size_y ||
-    _downsampled_costmap->getResolution() != _downsampled_resolution)
+    _downsampled_costmap->getResolution() != _downsampled_resolution ||
+    _downsampled_costmap->getOriginX() != _costmap->getOriginX() ||
+    _downsampled_costmap->getOriginY() != _costmap->getOriginY())
   {
     resizeCostmap();
+    _downsampled = false;
   }
 
-  // Assign costs
-  for (unsigned int i = 0; i < _downsampled_size_x; ++i) {
-    for (unsigned int j = 0; j < _downsampled_size_y; ++j) {
-      setCostOfCell(i, j);
+  // Only the cells changed by the updates of the costmap since the last downsampling
+  // need to be downsampled again, as long as the updates since are all known
+  if (_downsampled && _layered_costmap &&
+    _layered_costmap->getChangedWindows(_update_count, _changed_windows))
+  {
+    for (const auto & window : _changed_windows) {
+      if (window.x0 >= window.xn || window.y0 >= window.yn) {
+        continue;
+      }
+      const unsigned int x0 = window.x0 / _downsampling_factor;
+      const unsigned int y0 = window.y0 / _downsampling_factor;
+      const unsigned int xn = std::min(
+        (window.xn + _downsampling_factor - 1) / _downsampling_factor, _downsampled_size_x);
+      const unsigned int yn = std::min(
+        (window.yn + _downsampling_factor - 1) / _downsampling_factor, _downsampled_size_y);
+      downsampleWindow(x0, y0, xn, yn);
+      if (_downsampled_costmap_pub) {
+        _downsampled_costmap_pub->updateBounds(x0, xn, y0, yn);
+      }
     }
+  } else {
+    // A level of the pyramid with this factor was already downsampled by the
+    // costmap updates, over only the windows that changed
+    const nav2_costmap_2d::Costmap2D * level =
+      _costmap_pyramid && !_use_min_cost_neighbor ?
+      _costmap_pyramid->getLevel(_downsampling_factor) : nullptr;
+
+    if (level && level->getSizeInCellsX() == _downsampled_size_x &&
+      level->getSizeInCellsY() == _downsampled_size_y)
+    {
+      *_downsampled_costmap = *level;
+    } else {
+      downsampleWindow(0, 0, _downsampled_size_x, _downsampled_size_y);
+    }
+
+    if (_downsampled_costmap_pub) {
+      // Every cell was assigned, so the whole costmap is sent as an update
+      _downsampled_costmap_pub->updateBounds(0, _downsampled_size_x, 0, _downsampled_size_y);
+    }
+  }
+
+  if (_layered_costmap) {
+    _update_count = _layered_costmap->getUpdateCount();
+    _downsampled = true;
   }
 
   if (_downsampled_costmap_pub) {
@@ -123,32 +220,31 @@ void CostmapDownsampler::resizeCostmap()
     _costmap->getOriginY());
 }
 
-void CostmapDownsampler::setCostOfCell(
-  const unsigned int & new_mx,
-  const unsigned int & new_my)
+void CostmapDownsampler::downsampleWindow(
+  const unsigned int & x0, const unsigned int & y0,
+  const unsigned int & xn, const unsigned int & yn)
 {
-  unsigned int mx, my;
-  unsigned char cost = _use_min_cost_neighbor ? 255 : 0;
-  unsigned int x_offset = new_mx * _downsampling_factor;
-  unsigned int y_offset = new_my * _downsampling_factor;
-
-  for (unsigned int i = 0; i < _downsampling_factor; ++i) {
-    mx = x_offset + i;
-    if (mx >= _size_x) {
-      continue;
-    }
-    for (unsigned int j = 0; j < _downsampling_factor; ++j) {
-      my = y_offset + j;
-      if (my >= _size_y) {
-        continue;
-      }
-      cost = _use_min_cost_neighbor ?
-        std::min(cost, _costmap->getCost(mx, my)) :
-        std::max(cost, _costmap->getCost(mx, my));
+  const unsigned char * costs = _costmap->getCharMap();
+  unsigned char * downsampled_costs = _downsampled_costmap->getCharMap();
+  const unsigned int mx0 = x0 * _downsampling_factor;
+  const unsigned int width = std::min(xn * _downsampling_factor, _size_x) - mx0;
+  _row_costs.resize(width);
+
+  for (unsigned int new_my = y0; new_my < yn; ++new_my) {
+    const unsigned int my0 = new_my * _downsampling_factor;
+    const unsigned int num_rows = std::min(my0 + _downsampling_factor, _size_y) - my0;
+    const unsigned char * rows = costs + my0 * _size_x + mx0;
+    unsigned char * blocks = downsampled_costs + new_my * _downsampled_size_x + x0;
+    if (_use_min_cost_neighbor) {
+      reduceBlocks(
+        rows, num_rows, _size_x, width, _downsampling_factor, 255, _row_costs.data(), blocks,
+        [](unsigned char a, unsigned char b) {return std::min(a, b);});
+    } else {
+      reduceBlocks(
+        rows, num_rows, _size_x, width, _downsampling_factor, 0, _row_costs.data(), blocks,
+        [](unsigned char a, unsigned char b) {return std::max(a, b);});
     }
   }
-
-  _downsampled_costmap->setCost(new_mx, new_my, cost);
 }
 
 }  // namespace nav2_smac_planner
@@ -0,0 +1,145 @@
+// Copyright (c) 2022, Samsung Research America
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License. Reserved.
+
+#include <unistd.h>
+
+#include <cstdio>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <iomanip>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include "nav2_smac_planner/distance_heuristic_cache.hpp"
+#include "nav2_smac_planner/mapped_file.hpp"
+
+namespace nav2_smac_planner
+{
+
+DistanceHeuristicCache::DistanceHeuristicCache(
+  const std::string & directory,
+  const MotionModel & motion_model,
+  const float & turning_radius,
+  const float & lookup_table_dim,
+  const std::vector<float> & heading_angles)
+: _directory(directory),
+  _heading_angles(heading_angles)
+{
+  std::memset(&_header, 0, sizeof(_header));
+  std::memcpy(
+    _header.magic, DISTANCE_HEURISTIC_CACHE_MAGIC, sizeof(DISTANCE_HEURISTIC_CACHE_MAGIC));
+  _header.version = DISTANCE_HEURISTIC_CACHE_VERSION;
+  _header.motion_model = static_cast<uint32_t>(motion_model);
+  _header.turning_radius = turning_radius;
+  _header.lookup_table_dim = lookup_table_dim;
+  _header.number_of_headings = heading_angles.size();
+
+  // Name the file by a FNV-1a hash of the key, which the file contents are verified against
+  uint64_t hash = 14695981039346656037ull;
+  auto hashBytes = [&](const void * data, const std::size_t & size) {
+      const unsigned char * bytes = static_cast<const unsigned char *>(data);
+      for (std::size_t i = 0; i != size; i++) {
+        hash = (hash ^ bytes[i]) * 1099511628211ull;
+      }
+    };
+  hashBytes(&_header, sizeof(_header));
+  hashBytes(_heading_angles.data(), sizeof(float) * _heading_angles.size());
+
+  std::stringstream filename;
+  filename << "distance_heuristic_" << std::hex << std::setw(16) << std::setfill('0') << hash << ".bin";
+  _filepath = (std::filesystem::path(_directory) / filename.str()).string();
+}
+
+bool DistanceHeuristicCache::load(std::vector<float> & lookup_table) const
+{
+  std::error_code error;
+  if (!std::filesystem::exists(_filepath, error)) {
+    return false;
+  }
+
+  try {
+    MappedFile file(_filepath);
+    if (file.size() < sizeof(DistanceHeuristicCacheHeader)) {
+      return false;
+    }
+
+    // Only use the table if it was computed for exactly this key, ignoring its length
+    DistanceHeuristicCacheHeader header;
+    std::memcpy(&header, file.data(), sizeof(header));
+    const uint32_t lookup_table_length = header.lookup_table_length;
+    header.lookup_table_length = 0;
+    if (std::memcmp(&header, &_header, sizeof(header)) != 0) {
+      return false;
+    }
+
+    const std::size_t angles_size = sizeof(float) * _heading_angles.size();
+    const unsigned char * angles = file.data() + sizeof(header);
+    if (file.size() != sizeof(header) + angles_size + sizeof(float) * lookup_table_length ||
+      std::memcmp(angles, _heading_angles.data(), angles_size) != 0)
+    {
+      return false;
+    }
+
+    lookup_table.resize(lookup_table_length);
+    std::memcpy(lookup_table.data(), angles + angles_size, sizeof(float) * lookup_table_length);
+  } catch (const std::runtime_error &) {
+    return false;
+  }
+
+  return true;
+}
+
+bool DistanceHeuristicCache::save(const std::vector<float> & lookup_table) const
+{
+  std::error_code error;
+  std::filesystem::create_directories(_directory, error);
+  if (error) {
+    return false;
+  }
+
+  DistanceHeuristicCacheHeader header = _header;
+  header.lookup_table_length = lookup_table.size();
+
+  // Write to a unique temporary file, then move it into place
+  const std::string temp_filepath = _filepath + "." + std::to_string(getpid()) + ".tmp";
+  {
+    std::ofstream file(temp_filepath, std::ios::binary | std::ios::trunc);
+    if (!file.is_open()) {
+      return false;
+    }
+    file.write(reinterpret_cast<const char *>(&header), sizeof(header));
+    file.write(
+      reinterpret_cast<const char *>(_heading_angles.data()),
+      sizeof(float) * _heading_angles.size());
+    file.write(
+      reinterpret_cast<const char *>(lookup_table.data()), sizeof(float) * lookup_table.size());
+    if (!file) {
+      file.close();
+      std::remove(temp_filepath.c_str());
+      return false;
+    }
+  }
+
+  if (std::rename(temp_filepath.c_str(), _filepath.c_str()) != 0) {
+    std::remove(temp_filepath.c_str());
+    return false;
+  }
+
+  return true;
+}
+
+}  // namespace nav2_smac_planner
@@ -0,0 +1,368 @@
+// Copyright (c) 2022, Samsung Research America
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License. Reserved.
+
+#include "nav2_smac_planner/jump_point_table.hpp"
+
+#include <algorithm>
+#include <cstdlib>
+#include <cstring>
+#include <limits>
+#include <vector>
+
+namespace nav2_smac_planner
+{
+
+namespace
+{
+
+// Longer jumps are split at an intermediate jump point, which the search expands as usual
+constexpr int16_t max_jump_distance = std::numeric_limits<int16_t>::max();
+
+inline unsigned int getTable(const int & dx, const int & dy)
+{
+  if (dy == 0) {
+    return dx > 0 ? 0 : 1;
+  }
+  return dy > 0 ? 2 : 3;
+}
+
+}  // namespace
+
+void JumpPointTable::update(
+  const nav2_costmap_2d::Costmap2D * costmap, const bool & traverse_unknown)
+{
+  const int size_x = static_cast<int>(costmap->getSizeInCellsX());
+  const int size_y = static_cast<int>(costmap->getSizeInCellsY());
+  const unsigned int cells = size_x * size_y;
+  const unsigned char * costs = costmap->getCharMap();
+
+  if (size_x != _size_x || size_y != _size_y || traverse_unknown != _traverse_unknown ||
+    _costs.size() != cells)
+  {
+    _size_x = size_x;
+    _size_y = size_y;
+    _traverse_unknown = traverse_unknown;
+    _costs.assign(costs, costs + cells);
+    _flags.assign(cells, 0);
+    for (auto & distances : _distances) {
+      distances.assign(cells, 0);
+    }
+
+    for (int y = 0; y != _size_y; y++) {
+      for (int x = 0; x != _size_x; x++) {
+        updateFlags(x, y);
+      }
+    }
+    for (int y = 0; y != _size_y; y++) {
+      updateRow(y);
+    }
+    for (int x = 0; x != _size_x; x++) {
+      updateColumn(x);
+    }
+    return;
+  }
+
+  // Find the span of the cells changed in each row, keeping their new costs
+  std::vector<std::array<int, 3>> changed_spans;
+  for (int y = 0; y != _size_y; y++) {
+    const unsigned char * row = costs + y * _size_x;
+    unsigned char * last_row = &_costs[y * _size_x];
+    if (std::memcmp(row, last_row, _size_x) == 0) {
+      continue;
+    }
+
+    int min_x = 0;
+    while (row[min_x] == last_row[min_x]) {
+      min_x++;
+    }
+    int max_x = _size_x - 1;
+    while (row[max_x] == last_row[max_x]) {
+      max_x--;
+    }
+    std::copy(row + min_x, row + max_x + 1, last_row + min_x);
+    changed_spans.push_back({y, min_x, max_x});
+  }
+
+  if (changed_spans.empty()) {
+    return;
+  }
+
+  // Flags depend on the 8-connected neighbors, and the jumps of a line on the flags of the
+  // line and on the blocked cells beside it, so only the lines next to a change are updated
+  std::vector<bool> rows(_size_y, false);
+  std::vector<bool> columns(_size_x, false);
+  for (const auto & span : changed_spans) {
+    const int min_y = std::max(span[0] - 1, 0);
+    const int max_y = std::min(span[0] + 1, _size_y - 1);
+    const int min_x = std::max(span[1] - 1, 0);
+    const int max_x = std::min(span[2] + 1, _size_x - 1);
+    for (int y = min_y; y <= max_y; y++) {
+      rows[y] = true;
+      for (int x = min_x; x <= max_x; x++) {
+        updateFlags(x, y);
+        columns[x] = true;
+      }
+    }
+  }
+
+  for (int y = 0; y != _size_y; y++) {
+    if (rows[y]) {
+      updateRow(y);
+    }
+  }
+  for (int x = 0; x != _size_x; x++) {
+    if (columns[x]) {
+      updateColumn(x);
+    }
+  }
+}
+
+void JumpPointTable::setGoals(const std::vector<unsigned int> & goals)
+{
+  _goals.clear();
+  for (const unsigned int & goal : goals) {
+    _goals.emplace_back(goal % _size_x, goal / _size_x);
+  }
+}
+
+void JumpPointTable::getDirections(
+  const unsigned int & index, const int & parent_index, DirectionVector & directions) const
+{
+  directions.clear();
+
+  // Entering a region, every neighbor may start a cheaper path. The order matches the
+  // neighbors of Node2D, ending with the cardinal directions for consistent ties.
+  const unsigned char & cost = _costs[index];
+  if (parent_index < 0 || _costs[parent_index] != cost) {
+    directions = {{-1, 0}, {1, 0}, {0, -1}, {0, 1}, {-1, -1}, {1, -1}, {-1, 1}, {1, 1}};
+    return;
+  }
+
+  const int x = index % _size_x;
+  const int y = index / _size_x;
+  const int parent_x = parent_index % _size_x;
+  const int parent_y = parent_index / _size_x;
+  const int dx = (x > parent_x) - (x < parent_x);
+  const int dy = (y > parent_y) - (y < parent_y);
+
+  // Within a region, the cells of other costs are obstacles to its paths
+  auto isObstacle = [&](const int & nx, const int & ny) -> bool
+    {
+      return isBlocked(nx, ny) || _costs[ny * _size_x + nx] != cost;
+    };
+
+  // Natural neighbors, then the neighbors forced by an obstacle beside the move
+  if (dx == 0 || dy == 0) {
+    directions.emplace_back(dx, dy);
+    if (dy == 0) {
+      if (isObstacle(x, y - 1)) {
+        directions.emplace_back(dx, -1);
+      }
+      if (isObstacle(x, y + 1)) {
+        directions.emplace_back(dx, 1);
+      }
+    } else {
+      if (isObstacle(x - 1, y)) {
+        directions.emplace_back(-1, dy);
+      }
+      if (isObstacle(x + 1, y)) {
+        directions.emplace_back(1, dy);
+      }
+    }
+  } else {
+    directions.emplace_back(dx, 0);
+    directions.emplace_back(0, dy);
+    directions.emplace_back(dx, dy);
+    if (isObstacle(x - dx, y)) {
+      directions.emplace_back(-dx, dy);
+    }
+    if (isObstacle(x, y - dy)) {
+      directions.emplace_back(dx, -dy);
+    }
+  }
+
+  // At the boundary of a region, the paths may also leave it for any neighbor region
+  if (_flags[index] & BOUNDARY) {
+    for (int ny = y - 1; ny <= y + 1; ny++) {
+      for (int nx = x - 1; nx <= x + 1; nx++) {
+        const Direction direction(nx - x, ny - y);
+        if (!isBlocked(nx, ny) && _costs[ny * _size_x + nx] != cost &&
+          std::find(directions.begin(), directions.end(), direction) == directions.end())
+        {
+          directions.push_back(direction);
+        }
+      }
+    }
+  }
+}
+
+bool JumpPointTable::jump(
+  const unsigned int & index, const Direction & direction, unsigned int & successor) const
+{
+  const int & dx = direction.first;
+  const int & dy = direction.second;
+  int x = index % _size_x;
+  int y = index / _size_x;
+
+  // Straight jumps are tabled, stopping short at a goal on the way
+  if (dx == 0 || dy == 0) {
+    const int distance = _distances[getTable(dx, dy)][index];
+    int steps = getGoalDistance(x, y, dx, dy, std::abs(distance));
+    if (steps == 0) {
+      if (distance <= 0) {
+        return false;
+      }
+      steps = distance;
+    }
+    successor = (y + steps * dy) * _size_x + x + steps * dx;
+    return true;
+  }
+
+  // Diagonal jumps stop where either straight jump from the cell reached would stop
+  const unsigned char & cost = _costs[index];
+  while (true) {
+    x += dx;
+    y += dy;
+    if (isBlocked(x, y)) {
+      return false;
+    }
+
+    successor = y * _size_x + x;
+    if (_costs[successor] != cost || (_flags[successor] & BOUNDARY)) {
+      return true;
+    }
+
+    if ((isBlocked(x - dx, y) && !isBlocked(x - dx, y + dy)) ||
+      (isBlocked(x, y - dy) && !isBlocked(x + dx, y - dy)))
+    {
+      return true;
+    }
+
+    const int distance_x = _distances[getTable(dx, 0)][successor];
+    const int distance_y = _distances[getTable(0, dy)][successor];
+    if (distance_x > 0 || distance_y > 0 ||
+      std::find(_goals.begin(), _goals.end(), std::make_pair(x, y)) != _goals.end() ||
+      getGoalDistance(x, y, dx, 0, -distance_x) > 0 ||
+      getGoalDistance(x, y, 0, dy, -distance_y) > 0)
+    {
+      return true;
+    }
+  }
+}
+
+bool JumpPointTable::isJumpPoint(
+  const int & x, const int & y, const int & dx, const int & dy) const
+{
+  if (_flags[y * _size_x + x] & BOUNDARY) {
+    return true;
+  }
+
+  if (dy == 0) {
+    return (isBlocked(x, y - 1) && !isBlocked(x + dx, y - 1)) ||
+           (isBlocked(x, y + 1) && !isBlocked(x + dx, y + 1));
+  }
+
+  return (isBlocked(x - 1, y) && !isBlocked(x - 1, y + dy)) ||
+         (isBlocked(x + 1, y) && !isBlocked(x + 1, y + dy));
+}
+
+int16_t JumpPointTable::getDistance(
+  const int & x, const int & y, const int & dx, const int & dy,
+  const int16_t & next_distance) const
+{
+  const int next_x = x + dx;
+  const int next_y = y + dy;
+  if (isBlocked(next_x, next_y)) {
+    return 0;
+  }
+
+  if (_costs[next_y * _size_x + next_x] != _costs[y * _size_x + x] ||
+    isJumpPoint(next_x, next_y, dx, dy) ||
+    next_distance == max_jump_distance || next_distance == -max_jump_distance)
+  {
+    return 1;
+  }
+
+  return next_distance > 0 ? next_distance + 1 : next_distance - 1;
+}
+
+int JumpPointTable::getGoalDistance(
+  const int & x, const int & y, const int & dx, const int & dy, const int & range) const
+{
+  int closest = 0;
+  for (const auto & goal : _goals) {
+    int steps = 0;
+    if (dy == 0 && goal.second == y) {
+      steps = (goal.first - x) * dx;
+    } else if (dx == 0 && goal.first == x) {
+      steps = (goal.second - y) * dy;
+    }
+
+    if (steps > 0 && steps <= range && (closest == 0 || steps < closest)) {
+      closest = steps;
+    }
+  }
+  return closest;
+}
+
+void JumpPointTable::updateFlags(const int & x, const int & y)
+{
+  const unsigned int index = y * _size_x + x;
+  const unsigned char & cost = _costs[index];
+  if (!isTraversable(cost)) {
+    _flags[index] = BLOCKED;
+    return;
+  }
+
+  // Cells next to a traversable cell of another cost are boundaries of their region
+  _flags[index] = 0;
+  for (int ny = std::max(y - 1, 0); ny <= std::min(y + 1, _size_y - 1); ny++) {
+    for (int nx = std::max(x - 1, 0); nx <= std::min(x + 1, _size_x - 1); nx++) {
+      const unsigned char & neighbor_cost = _costs[ny * _size_x + nx];
+      if (neighbor_cost != cost && isTraversable(neighbor_cost)) {
+        _flags[index] = BOUNDARY;
+        return;
+      }
+    }
+  }
+}
+
+void JumpPointTable::updateRow(const int & y)
+{
+  std::vector<int16_t> & forward = _distances[0];
+  std::vector<int16_t> & backward = _distances[1];
+  const int start = y * _size_x;
+  for (int x = _size_x - 1; x >= 0; x--) {
+    forward[start + x] = getDistance(x, y, 1, 0, x + 1 < _size_x ? forward[start + x + 1] : 0);
+  }
+  for (int x = 0; x != _size_x; x++) {
+    backward[start + x] = getDistance(x, y, -1, 0, x > 0 ? backward[start + x - 1] : 0);
+  }
+}
+
+void JumpPointTable::updateColumn(const int & x)
+{
+  std::vector<int16_t> & forward = _distances[2];
+  std::vector<int16_t> & backward = _distances[3];
+  for (int y = _size_y - 1; y >= 0; y--) {
+    const int index = y * _size_x + x;
+    forward[index] = getDistance(x, y, 0, 1, y + 1 < _size_y ? forward[index + _size_x] : 0);
+  }
+  for (int y = 0; y != _size_y; y++) {
+    const int index = y * _size_x + x;
+    backward[index] = getDistance(x, y, 0, -1, y > 0 ? backward[index - _size_x] : 0);
+  }
+}
+
+}  // namespace nav2_smac_planner
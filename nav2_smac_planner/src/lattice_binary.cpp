@@ -0,0 +1,184 @@
+// Copyright (c) 2022, Samsung Research America
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License. Reserved.
+
+#include <cstring>
+#include <fstream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include "nav2_smac_planner/lattice_binary.hpp"
+
+namespace nav2_smac_planner
+{
+
+LatticeBinaryFile::LatticeBinaryFile(const std::string & filepath)
+: _file(filepath)
+{
+  if (_file.size() < sizeof(LatticeBinaryHeader)) {
+    throw std::runtime_error("Binary lattice file is too small to be valid!");
+  }
+
+  std::memcpy(&_header, _file.data(), sizeof(LatticeBinaryHeader));
+  if (std::memcmp(_header.magic, LATTICE_BINARY_MAGIC, sizeof(LATTICE_BINARY_MAGIC)) != 0) {
+    throw std::runtime_error("File is not a binary lattice file!");
+  }
+
+  if (_header.version != LATTICE_BINARY_VERSION) {
+    throw std::runtime_error(
+            "Binary lattice file version " + std::to_string(_header.version) +
+            " is not supported, expected version " + std::to_string(LATTICE_BINARY_VERSION));
+  }
+
+  const std::size_t expected_size = sizeof(LatticeBinaryHeader) +
+    sizeof(float) * _header.number_of_headings +
+    sizeof(LatticeBinaryPrimitive) * _header.number_of_trajectories +
+    3 * sizeof(float) * _header.number_of_poses;
+  if (_file.size() != expected_size) {
+    throw std::runtime_error("Binary lattice file size does not match its header!");
+  }
+}
+
+bool LatticeBinaryFile::isLatticeBinaryFile(const std::string & filepath)
+{
+  std::ifstream lattice_file(filepath, std::ios::binary);
+  char magic[sizeof(LATTICE_BINARY_MAGIC)];
+  if (!lattice_file.read(magic, sizeof(magic))) {
+    return false;
+  }
+  return std::memcmp(magic, LATTICE_BINARY_MAGIC, sizeof(LATTICE_BINARY_MAGIC)) == 0;
+}
+
+LatticeMetadata LatticeBinaryFile::getMetadata() const
+{
+  LatticeMetadata metadata;
+  metadata.min_turning_radius = _header.turning_radius;
+  metadata.grid_resolution = _header.grid_resolution;
+  metadata.number_of_headings = _header.number_of_headings;
+  metadata.number_of_trajectories = _header.number_of_trajectories;
+  metadata.motion_model = std::string(
+    _header.motion_model,
+    strnlen(_header.motion_model, sizeof(_header.motion_model)));
+
+  metadata.heading_angles.resize(_header.number_of_headings);
+  std::memcpy(
+    metadata.heading_angles.data(), _file.data() + sizeof(LatticeBinaryHeader),
+    sizeof(float) * _header.number_of_headings);
+  return metadata;
+}
+
+void LatticeBinaryFile::getMotionPrimitives(MotionPrimitives & primitives) const
+{
+  const unsigned char * records = _file.data() + sizeof(LatticeBinaryHeader) +
+    sizeof(float) * _header.number_of_headings;
+  const unsigned char * poses = records +
+    sizeof(LatticeBinaryPrimitive) * _header.number_of_trajectories;
+
+  primitives.clear();
+  primitives.reserve(_header.number_of_trajectories);
+  LatticeBinaryPrimitive record;
+  for (unsigned int i = 0; i != _header.number_of_trajectories; i++) {
+    std::memcpy(&record, records + i * sizeof(LatticeBinaryPrimitive), sizeof(record));
+    if (static_cast<uint64_t>(record.pose_offset) + record.number_of_poses >
+      _header.number_of_poses)
+    {
+      throw std::runtime_error("Binary lattice file primitive poses are out of bounds!");
+    }
+
+    MotionPrimitive primitive;
+    primitive.trajectory_id = record.trajectory_id;
+    primitive.start_angle = record.start_angle_index;
+    primitive.end_angle = record.end_angle_index;
+    primitive.turning_radius = record.trajectory_radius;
+    primitive.trajectory_length = record.trajectory_length;
+    primitive.arc_length = record.arc_length;
+    primitive.straight_length = record.straight_length;
+    primitive.left_turn = record.left_turn != 0;
+
+    // Poses are stored contiguously as (x, y, yaw) floats, matching MotionPose
+    primitive.poses.resize(record.number_of_poses);
+    for (unsigned int j = 0; j != record.number_of_poses; j++) {
+      float pose[3];
+      std::memcpy(
+        pose, poses + 3 * sizeof(float) * (record.pose_offset + j), sizeof(pose));
+      primitive.poses[j] = MotionPose(pose[0], pose[1], pose[2]);
+    }
+    primitives.push_back(primitive);
+  }
+}
+
+void LatticeBinaryFile::write(
+  const std::string & filepath,
+  const LatticeMetadata & metadata,
+  const MotionPrimitives & primitives)
+{
+  std::ofstream lattice_file(filepath, std::ios::binary | std::ios::trunc);
+  if (!lattice_file.is_open()) {
+    throw std::runtime_error("Could not open binary lattice file for writing!");
+  }
+
+  if (metadata.motion_model.size() >= sizeof(LatticeBinaryHeader::motion_model)) {
+    throw std::runtime_error("Lattice motion model name is too long for binary lattice file!");
+  }
+
+  uint32_t number_of_poses = 0;
+  for (const MotionPrimitive & primitive : primitives) {
+    number_of_poses += primitive.poses.size();
+  }
+
+  LatticeBinaryHeader header;
+  std::memset(&header, 0, sizeof(header));
+  std::memcpy(header.magic, LATTICE_BINARY_MAGIC, sizeof(LATTICE_BINARY_MAGIC));
+  header.version = LATTICE_BINARY_VERSION;
+  header.turning_radius = metadata.min_turning_radius;
+  header.grid_resolution = metadata.grid_resolution;
+  header.number_of_headings = metadata.heading_angles.size();
+  header.number_of_trajectories = primitives.size();
+  header.number_of_poses = number_of_poses;
+  std::memcpy(header.motion_model, metadata.motion_model.data(), metadata.motion_model.size());
+  lattice_file.write(reinterpret_cast<const char *>(&header), sizeof(header));
+  lattice_file.write(
+    reinterpret_cast<const char *>(metadata.heading_angles.data()),
+    sizeof(float) * metadata.heading_angles.size());
+
+  uint32_t pose_offset = 0;
+  for (const MotionPrimitive & primitive : primitives) {
+    LatticeBinaryPrimitive record;
+    record.trajectory_id = primitive.trajectory_id;
+    record.start_angle_index = static_cast<uint32_t>(primitive.start_angle);
+    record.end_angle_index = static_cast<uint32_t>(primitive.end_angle);
+    record.trajectory_radius = primitive.turning_radius;
+    record.trajectory_length = primitive.trajectory_length;
+    record.arc_length = primitive.arc_length;
+    record.straight_length = primitive.straight_length;
+    record.left_turn = primitive.left_turn ? 1u : 0u;
+    record.pose_offset = pose_offset;
+    record.number_of_poses = primitive.poses.size();
+    lattice_file.write(reinterpret_cast<const char *>(&record), sizeof(record));
+    pose_offset += record.number_of_poses;
+  }
+
+  for (const MotionPrimitive & primitive : primitives) {
+    for (const MotionPose & pose : primitive.poses) {
+      const float values[3] = {pose._x, pose._y, pose._theta};
+      lattice_file.write(reinterpret_cast<const char *>(values), sizeof(values));
+    }
+  }
+
+  if (!lattice_file) {
+    throw std::runtime_error("Could not write binary lattice file!");
+  }
+}
+
+}  // namespace nav2_smac_planner
@@ -0,0 +1,58 @@
+// Copyright (c) 2022, Samsung Research America
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License. Reserved.
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <stdexcept>
+#include <string>
+
+#include "nav2_smac_planner/mapped_file.hpp"
+
+namespace nav2_smac_planner
+{
+
+MappedFile::MappedFile(const std::string & filepath)
+: _data(nullptr),
+  _size(0)
+{
+  int fd = open(filepath.c_str(), O_RDONLY);
+  if (fd < 0) {
+    throw std::runtime_error("Could not open file " + filepath);
+  }
+
+  struct stat file_stat;
+  if (fstat(fd, &file_stat) != 0 || file_stat.st_size <= 0) {
+    close(fd);
+    throw std::runtime_error("Could not get a valid size of file " + filepath);
+  }
+  _size = static_cast<std::size_t>(file_stat.st_size);
+
+  // The mapping remains valid once the descriptor is closed
+  void * data = mmap(nullptr, _size, PROT_READ, MAP_SHARED, fd, 0);
+  close(fd);
+  if (data == MAP_FAILED) {
+    throw std::runtime_error("Could not memory map file " + filepath);
+  }
+  _data = static_cast<const unsigned char *>(data);
+}
+
+MappedFile::~MappedFile()
+{
+  munmap(const_cast<unsigned char *>(_data), _size);
+}
+
+}  // namespace nav2_smac_planner
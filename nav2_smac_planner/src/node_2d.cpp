@@ -15,6 +15,7 @@
 
 #include "nav2_smac_planner/node_2d.hpp"
 
+#include <algorithm>
 #include <vector>
 #include <limits>
 
@@ -22,8 +23,8 @@ namespace nav2_smac_planner
 {
 
 // defining static member for all instance to share
-std::vector<int> Node2D::_neighbors_grid_offsets;
-float Node2D::cost_travel_multiplier = 2.0;
+Node2DSearchState Node2D::default_search_state;
+thread_local Node2DSearchState * Node2D::search_state = &Node2D::default_search_state;
 
 Node2D::Node2D(const unsigned int index)
 : parent(nullptr),
@@ -70,12 +71,16 @@ float Node2D::getTraversalCost(const NodePtr & child)
   const float & dy = A.y - B.y;
   static float sqrt_2 = sqrt(2);
 
+  // A jump crosses cells of the same cost as the jump point reached, each move costing
+  // the same as a move to a neighbor
+  const float moves = std::max(1.0f, std::max(fabs(dx), fabs(dy)));
+
   // If a diagonal move, travel cost is sqrt(2) not 1.0.
-  if ((dx * dx + dy * dy) > 1.05) {
-    return sqrt_2 + cost_travel_multiplier * normalized_cost;
+  if (dx != 0.0f && dy != 0.0f) {
+    return moves * (sqrt_2 + search_state->cost_travel_multiplier * normalized_cost);
   }
 
-  return 1.0 + cost_travel_multiplier * normalized_cost;
+  return moves * (1.0 + search_state->cost_travel_multiplier * normalized_cost);
 }
 
 float Node2D::getHeuristicCost(
@@ -97,15 +102,18 @@ void Node2D::initMotionModel(
   SearchInfo & search_info)
 {
   int x_size = static_cast<int>(x_size_uint);
-  cost_travel_multiplier = search_info.cost_penalty;
+  search_state->cost_travel_multiplier = search_info.cost_penalty;
+  // Jumps are only defined over the 8-connected grid
+  search_state->use_jump_point_search =
+    search_info.use_jump_point_search && neighborhood == MotionModel::MOORE;
   switch (neighborhood) {
     case MotionModel::UNKNOWN:
       throw std::runtime_error("Unknown neighborhood type selected.");
     case MotionModel::VON_NEUMANN:
-      _neighbors_grid_offsets = {-1, +1, -x_size, +x_size};
+      search_state->_neighbors_grid_offsets = {-1, +1, -x_size, +x_size};
       break;
     case MotionModel::MOORE:
-      _neighbors_grid_offsets = {-1, +1, -x_size, +x_size, -x_size - 1,
+      search_state->_neighbors_grid_offsets = {-1, +1, -x_size, +x_size, -x_size - 1,
         -x_size + 1, +x_size - 1, +x_size + 1};
       break;
     default:
@@ -135,11 +143,29 @@ void Node2D::getNeighbors(
   int index;
   NodePtr neighbor;
   int node_i = this->getIndex();
+
+  if (search_state->use_jump_point_search) {
+    static thread_local JumpPointTable::DirectionVector directions;
+    unsigned int successor;
+    search_state->jump_point_table.getDirections(
+      this->getIndex(), this->parent ? static_cast<int>(this->parent->getIndex()) : -1,
+      directions);
+    for (const auto & direction : directions) {
+      if (search_state->jump_point_table.jump(this->getIndex(), direction, successor) &&
+        NeighborGetter(successor, neighbor) &&
+        neighbor->isNodeValid(traverse_unknown, collision_checker) && !neighbor->wasVisited())
+      {
+        neighbors.push_back(neighbor);
+      }
+    }
+    return;
+  }
+
   const Coordinates parent = getCoords(this->getIndex());
   Coordinates child;
 
-  for (unsigned int i = 0; i != _neighbors_grid_offsets.size(); ++i) {
-    index = node_i + _neighbors_grid_offsets[i];
+  for (unsigned int i = 0; i != search_state->_neighbors_grid_offsets.size(); ++i) {
+    index = node_i + search_state->_neighbors_grid_offsets[i];
 
     // Check for wrap around conditions
     child = getCoords(index);
@@ -164,8 +190,16 @@ bool Node2D::backtracePath(CoordinateVector & path)
   NodePtr current_node = this;
 
   while (current_node->parent) {
-    path.push_back(
-      Node2D::getCoords(current_node->getIndex()));
+    // Fill in the cells crossed by a jump, in a straight or diagonal line
+    Coordinates coords = Node2D::getCoords(current_node->getIndex());
+    const Coordinates parent_coords = Node2D::getCoords(current_node->parent->getIndex());
+    const float dx = (parent_coords.x > coords.x) - (parent_coords.x < coords.x);
+    const float dy = (parent_coords.y > coords.y) - (parent_coords.y < coords.y);
+    while (coords.x != parent_coords.x || coords.y != parent_coords.y) {
+      path.push_back(coords);
+      coords.x += dx;
+      coords.y += dy;
+    }
     current_node = current_node->parent;
   }
 
@@ -31,6 +31,7 @@ void NodeBasic<NodeHybrid>::processSearchNode()
   if (!this->graph_node_ptr->wasVisited()) {
     this->graph_node_ptr->pose = this->pose;
     this->graph_node_ptr->setMotionPrimitiveIndex(this->motion_index);
+    this->graph_node_ptr->setCollisionChecked(this->collision_checked);
   }
 }
 
@@ -44,6 +45,7 @@ void NodeBasic<NodeLattice>::processSearchNode()
     this->graph_node_ptr->pose = this->pose;
     this->graph_node_ptr->setMotionPrimitive(this->prim_ptr);
     this->graph_node_ptr->backwards(this->backward);
+    this->graph_node_ptr->setCollisionChecked(this->collision_checked);
   }
 }
 
@@ -59,6 +61,7 @@ void NodeBasic<NodeHybrid>::populateSearchNode(NodeHybrid * & node)
   this->pose = node->pose;
   this->graph_node_ptr = node;
   this->motion_index = node->getMotionPrimitiveIndex();
+  this->collision_checked = node->wasCollisionChecked();
 }
 
 template<>
@@ -68,6 +71,7 @@ void NodeBasic<NodeLattice>::populateSearchNode(NodeLattice * & node)
   this->graph_node_ptr = node;
   this->prim_ptr = node->getMotionPrimitive();
   this->backward = node->isBackward();
+  this->collision_checked = node->wasCollisionChecked();
 }
 
 template class NodeBasic<Node2D>;
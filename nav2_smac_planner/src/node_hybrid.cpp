@@ -14,6 +14,9 @@
 // limitations under the License. Reserved.
 
 #include <math.h>
+#include <omp.h>
+#include <array>
+#include <atomic>
 #include <chrono>
 #include <vector>
 #include <memory>
@@ -22,10 +25,6 @@
 #include <limits>
 #include <utility>
 
-#include "ompl/base/ScopedState.h"
-#include "ompl/base/spaces/DubinsStateSpace.h"
-#include "ompl/base/spaces/ReedsSheppStateSpace.h"
-
 #include "nav2_smac_planner/node_hybrid.hpp"
 
 using namespace std::chrono;  // NOLINT
@@ -34,14 +33,8 @@ namespace nav2_smac_planner
 {
 
 // defining static member for all instance to share
-LookupTable NodeHybrid::obstacle_heuristic_lookup_table;
-double NodeHybrid::travel_distance_cost = sqrt(2);
-HybridMotionTable NodeHybrid::motion_table;
-float NodeHybrid::size_lookup = 25;
-LookupTable NodeHybrid::dist_heuristic_lookup_table;
-nav2_costmap_2d::Costmap2D * NodeHybrid::sampled_costmap = nullptr;
-CostmapDownsampler NodeHybrid::downsampler;
-ObstacleHeuristicQueue NodeHybrid::obstacle_heuristic_queue;
+NodeHybridSearchState NodeHybrid::default_search_state;
+thread_local NodeHybridSearchState * NodeHybrid::search_state = &NodeHybrid::default_search_state;
 
 // Each of these tables are the projected motion models through
 // time and space applied to the search on the current node in
@@ -64,6 +57,7 @@ void HybridMotionTable::initDubin(
   cost_penalty = search_info.cost_penalty;
   reverse_penalty = search_info.reverse_penalty;
   travel_distance_reward = 1.0f - search_info.retrospective_penalty;
+  initTravelCostPenalties();
 
   // if nothing changed, no need to re-compute primitives
   if (num_angle_quantization_in == num_angle_quantization &&
@@ -117,8 +111,8 @@ void HybridMotionTable::initDubin(
   projections.emplace_back(delta_x, delta_y, increments);  // Left
   projections.emplace_back(delta_x, -delta_y, -increments);  // Right
 
-  // Create the correct OMPL state space
-  state_space = std::make_unique<ompl::base::DubinsStateSpace>(min_turning_radius);
+  // Create the correct analytic curve
+  analytic_curve = AnalyticCurve(false, min_turning_radius);
 
   // Precompute projection deltas
   delta_xs.resize(projections.size());
@@ -157,6 +151,7 @@ void HybridMotionTable::initReedsShepp(
   cost_penalty = search_info.cost_penalty;
   reverse_penalty = search_info.reverse_penalty;
   travel_distance_reward = 1.0f - search_info.retrospective_penalty;
+  initTravelCostPenalties();
 
   // if nothing changed, no need to re-compute primitives
   if (num_angle_quantization_in == num_angle_quantization &&
@@ -194,8 +189,8 @@ void HybridMotionTable::initReedsShepp(
   projections.emplace_back(-delta_x, delta_y, -increments);  // Backward + Left
   projections.emplace_back(-delta_x, -delta_y, increments);  // Backward + Right
 
-  // Create the correct OMPL state space
-  state_space = std::make_unique<ompl::base::ReedsSheppStateSpace>(min_turning_radius);
+  // Create the correct analytic curve
+  analytic_curve = AnalyticCurve(true, min_turning_radius);
 
   // Precompute projection deltas
   delta_xs.resize(projections.size());
@@ -248,6 +243,50 @@ MotionPoses HybridMotionTable::getProjections(const NodeHybrid * node)
   return projection_list;
 }
 
+template<unsigned int NumPrimitives>
+void HybridMotionTable::getProjections(
+  const NodeHybrid * node, std::array<MotionPose, NumPrimitives> & projection_list)
+{
+  const float & node_heading = node->pose.theta;
+  const unsigned int heading_bin = static_cast<unsigned int>(node_heading);
+  for (unsigned int i = 0; i != NumPrimitives; i++) {
+    float new_heading = node_heading + projections[i]._theta;
+
+    if (new_heading < 0.0) {
+      new_heading += num_angle_quantization_float;
+    }
+
+    if (new_heading >= num_angle_quantization_float) {
+      new_heading -= num_angle_quantization_float;
+    }
+
+    projection_list[i] = MotionPose(
+      delta_xs[i][heading_bin] + node->pose.x,
+      delta_ys[i][heading_bin] + node->pose.y,
+      new_heading);
+  }
+}
+
+void HybridMotionTable::initTravelCostPenalties()
+{
+  // Straight motions are primitives 0 and 3, reversing motions those above 2
+  for (unsigned int i = 0; i != max_primitives; i++) {
+    for (unsigned int j = 0; j != max_primitives; j++) {
+      if (j == 0 || j == 3) {
+        // New motion is a straight motion, no additional costs to be applied
+        turn_penalties[i][j] = 1.0f;
+      } else if (i == j) {
+        // Turning motion but keeps in same direction: encourages to commit to turning
+        turn_penalties[i][j] = non_straight_penalty;
+      } else {
+        // Turning motion and changing direction: penalizes wiggling
+        turn_penalties[i][j] = non_straight_penalty + change_penalty;
+      }
+    }
+    reverse_penalties[i] = i > 2 ? reverse_penalty : 1.0f;
+  }
+}
+
 unsigned int HybridMotionTable::getClosestAngularBin(const double & theta)
 {
   return static_cast<unsigned int>(floor(theta / bin_size));
@@ -265,6 +304,7 @@ NodeHybrid::NodeHybrid(const unsigned int index)
   _accumulated_cost(std::numeric_limits<float>::max()),
   _index(index),
   _was_visited(false),
+  _was_collision_checked(false),
   _motion_primitive_index(std::numeric_limits<unsigned int>::max())
 {
 }
@@ -280,6 +320,7 @@ void NodeHybrid::reset()
   _cell_cost = std::numeric_limits<float>::quiet_NaN();
   _accumulated_cost = std::numeric_limits<float>::max();
   _was_visited = false;
+  _was_collision_checked = false;
   _motion_primitive_index = std::numeric_limits<unsigned int>::max();
   pose.x = 0.0f;
   pose.y = 0.0f;
@@ -297,9 +338,30 @@ bool NodeHybrid::isNodeValid(
   }
 
   _cell_cost = collision_checker->getCost();
+  _was_collision_checked = true;
   return true;
 }
 
+bool NodeHybrid::isNodeCenterValid(
+  const bool & traverse_unknown,
+  GridCollisionChecker * collision_checker)
+{
+  if (collision_checker->inCollisionAtCenter(this->pose.x, this->pose.y, traverse_unknown)) {
+    return false;
+  }
+
+  _cell_cost = collision_checker->getCost();
+  _was_collision_checked = false;
+  return true;
+}
+
+bool NodeHybrid::isDeferredNodeValid(
+  const bool & traverse_unknown,
+  GridCollisionChecker * collision_checker)
+{
+  return isNodeValid(traverse_unknown, collision_checker);
+}
+
 float NodeHybrid::getTraversalCost(const NodePtr & child)
 {
   const float normalized_cost = child->getCost() / 252.0;
@@ -311,34 +373,18 @@ float NodeHybrid::getTraversalCost(const NodePtr & child)
 
   // this is the first node
   if (getMotionPrimitiveIndex() == std::numeric_limits<unsigned int>::max()) {
-    return NodeHybrid::travel_distance_cost;
+    return NodeHybrid::search_state->travel_distance_cost;
   }
 
-  float travel_cost = 0.0;
+  const HybridMotionTable & motion_table = search_state->motion_table;
   float travel_cost_raw =
-    NodeHybrid::travel_distance_cost *
+    NodeHybrid::search_state->travel_distance_cost *
     (motion_table.travel_distance_reward + motion_table.cost_penalty * normalized_cost);
 
-  if (child->getMotionPrimitiveIndex() == 0 || child->getMotionPrimitiveIndex() == 3) {
-    // New motion is a straight motion, no additional costs to be applied
-    travel_cost = travel_cost_raw;
-  } else {
-    if (getMotionPrimitiveIndex() == child->getMotionPrimitiveIndex()) {
-      // Turning motion but keeps in same direction: encourages to commit to turning if starting it
-      travel_cost = travel_cost_raw * motion_table.non_straight_penalty;
-    } else {
-      // Turning motion and changing direction: penalizes wiggling
-      travel_cost = travel_cost_raw *
-        (motion_table.non_straight_penalty + motion_table.change_penalty);
-    }
-  }
-
-  if (child->getMotionPrimitiveIndex() > 2) {
-    // reverse direction
-    travel_cost *= motion_table.reverse_penalty;
-  }
-
-  return travel_cost;
+  // The turning and reversing penalties are tabled by primitive, without branching
+  const unsigned int & child_primitive = child->getMotionPrimitiveIndex();
+  return travel_cost_raw * motion_table.turn_penalties[getMotionPrimitiveIndex()][child_primitive] *
+         motion_table.reverse_penalties[child_primitive];
 }
 
 float NodeHybrid::getHeuristicCost(
@@ -347,7 +393,7 @@ float NodeHybrid::getHeuristicCost(
   const nav2_costmap_2d::Costmap2D * /*costmap*/)
 {
   const float obstacle_heuristic =
-    getObstacleHeuristic(node_coords, goal_coords, motion_table.cost_penalty);
+    getObstacleHeuristic(node_coords, goal_coords, search_state->motion_table.cost_penalty);
   const float dist_heuristic = getDistanceHeuristic(node_coords, goal_coords, obstacle_heuristic);
   return std::max(obstacle_heuristic, dist_heuristic);
 }
@@ -362,10 +408,11 @@ void NodeHybrid::initMotionModel(
   // find the motion model selected
   switch (motion_model) {
     case MotionModel::DUBIN:
-      motion_table.initDubin(size_x, size_y, num_angle_quantization, search_info);
+      search_state->motion_table.initDubin(size_x, size_y, num_angle_quantization, search_info);
       break;
     case MotionModel::REEDS_SHEPP:
-      motion_table.initReedsShepp(size_x, size_y, num_angle_quantization, search_info);
+      search_state->motion_table.initReedsShepp(
+        size_x, size_y, num_angle_quantization, search_info);
       break;
     default:
       throw std::runtime_error(
@@ -374,7 +421,8 @@ void NodeHybrid::initMotionModel(
               " Reeds-Shepp (Ackermann forward and back).");
   }
 
-  travel_distance_cost = motion_table.projections[0]._x;
+  search_state->travel_distance_cost = search_state->motion_table.projections[0]._x;
+  search_state->motion_table.lazy_collision_checking = search_info.use_lazy_collision_checking;
 }
 
 inline float distanceHeuristic2D(
@@ -386,48 +434,460 @@ inline float distanceHeuristic2D(
     static_cast<int>(idx / size_x) - static_cast<int>(target_y));
 }
 
+// The obstacle heuristic is computed on a copy of the downsampled costmap bordered by
+// occupied cells, wide enough for the longest moves so that they never need bounds checks
+constexpr unsigned int obstacle_heuristic_padding = 2;
+
+/**
+ * @struct nav2_smac_planner::ObstacleHeuristicNeighborhood
+ * @brief Moves of the obstacle heuristic wavefront, as cell offsets, by connectivity
+ */
+template<unsigned int Connectivity>
+struct ObstacleHeuristicNeighborhood;
+
+template<>
+struct ObstacleHeuristicNeighborhood<4>
+{
+  static constexpr std::array<std::array<int, 2>, 4> moves{{
+    {{1, 0}}, {{-1, 0}},  // left right
+    {{0, 1}}, {{0, -1}}}};  // up down
+};
+
+template<>
+struct ObstacleHeuristicNeighborhood<8>
+{
+  static constexpr std::array<std::array<int, 2>, 8> moves{{
+    {{1, 0}}, {{-1, 0}},  // left right
+    {{0, 1}}, {{0, -1}},  // up down
+    {{1, 1}}, {{-1, 1}},  // upper diagonals
+    {{1, -1}}, {{-1, -1}}}};  // lower diagonals
+};
+
+template<>
+struct ObstacleHeuristicNeighborhood<16>
+{
+  // The knight moves approximate straight lines within 3% rather than 8% of their length
+  static constexpr std::array<std::array<int, 2>, 16> moves{{
+    {{1, 0}}, {{-1, 0}},  // left right
+    {{0, 1}}, {{0, -1}},  // up down
+    {{1, 1}}, {{-1, 1}},  // upper diagonals
+    {{1, -1}}, {{-1, -1}},  // lower diagonals
+    {{2, 1}}, {{1, 2}}, {{-1, 2}}, {{-2, 1}},  // upper knight moves
+    {{-2, -1}}, {{-1, -2}}, {{1, -2}}, {{2, -1}}}};  // lower knight moves
+};
+
+/**
+ * @struct nav2_smac_planner::ObstacleHeuristicMoves
+ * @brief Index offsets and lengths of the moves of a neighborhood in the padded costmap
+ */
+template<unsigned int Connectivity>
+struct ObstacleHeuristicMoves
+{
+  explicit ObstacleHeuristicMoves(const unsigned int & padded_size_x)
+  {
+    const int stride = static_cast<int>(padded_size_x);
+    for (unsigned int i = 0; i != Connectivity; i++) {
+      const int dx = ObstacleHeuristicNeighborhood<Connectivity>::moves[i][0];
+      const int dy = ObstacleHeuristicNeighborhood<Connectivity>::moves[i][1];
+      offsets[i] = dy * stride + dx;
+      distances[i] = static_cast<float>(sqrt(dx * dx + dy * dy));
+      max_distance = std::max(max_distance, distances[i]);
+      // Knight moves cross the two cells between their ends
+      if (std::abs(dx) == 2) {
+        crossed[i] = {{dx / 2, dy * stride + dx / 2}};
+      } else if (std::abs(dy) == 2) {
+        crossed[i] = {{(dy / 2) * stride, (dy / 2) * stride + dx}};
+      } else {
+        crossed[i] = {{offsets[i], offsets[i]}};
+      }
+    }
+  }
+
+  /**
+   * @brief Whether the cells crossed by a move from a cell are free, its end aside
+   */
+  inline bool isCrossable(
+    const unsigned char * costs, const unsigned int & idx, const unsigned int & i) const
+  {
+    return Connectivity != 16 || i < 8 ||
+           (costs[static_cast<int>(idx) + crossed[i][0]] < INSCRIBED &&
+           costs[static_cast<int>(idx) + crossed[i][1]] < INSCRIBED);
+  }
+
+  std::array<int, Connectivity> offsets;
+  std::array<float, Connectivity> distances;
+  std::array<std::array<int, 2>, Connectivity> crossed;
+  float max_distance{0.0f};
+};
+
+void NodeHybrid::resetObstacleHeuristic(
+  nav2_costmap_2d::Costmap2D * costmap,
+  const unsigned int & start_x, const unsigned int & start_y,
+  const unsigned int & goal_x, const unsigned int & goal_y,
+  const bool & cache,
+  const int & threads,
+  const int & neighborhood)
+{
+  resetObstacleHeuristic(
+    costmap, start_x, start_y, {{goal_x, goal_y}}, cache, threads, neighborhood);
+}
+
 void NodeHybrid::resetObstacleHeuristic(
   nav2_costmap_2d::Costmap2D * costmap,
   const unsigned int & start_x, const unsigned int & start_y,
-  const unsigned int & goal_x, const unsigned int & goal_y)
+  const GoalCells & goals,
+  const bool & cache,
+  const int & threads,
+  const int & neighborhood)
 {
+  search_state->obstacle_heuristic_threads = threads;
+
   // Downsample costmap 2x to compute a sparse obstacle heuristic. This speeds up
   // the planner considerably to search through 75% less cells with no detectable
   // erosion of path quality after even modest smoothing. The error would be no more
   // than 0.05 * normalized cost. Since this is just a search prior, there's no loss in generality
   std::weak_ptr<nav2_util::LifecycleNode> ptr;
-  downsampler.on_configure(ptr, "fake_frame", "fake_topic", costmap, 2.0, true);
-  downsampler.on_activate();
-  sampled_costmap = downsampler.downsample(2.0);
+  search_state->downsampler.on_configure(ptr, "fake_frame", "fake_topic", costmap, 2.0, true);
+  search_state->downsampler.on_activate();
+  search_state->sampled_costmap = search_state->downsampler.downsample(2.0);
+
+  // Copy the downsampled costs within a border of occupied cells
+  const unsigned int sampled_size_x = search_state->sampled_costmap->getSizeInCellsX();
+  const unsigned int sampled_size_y = search_state->sampled_costmap->getSizeInCellsY();
+  const unsigned int size_x = sampled_size_x + 2 * obstacle_heuristic_padding;
+  unsigned int size = size_x * (sampled_size_y + 2 * obstacle_heuristic_padding);
+  std::vector<unsigned char> costs(size, static_cast<unsigned char>(OCCUPIED));
+  const unsigned char * sampled_costs = search_state->sampled_costmap->getCharMap();
+  for (unsigned int y = 0; y != sampled_size_y; y++) {
+    std::copy_n(
+      sampled_costs + y * sampled_size_x, sampled_size_x,
+      costs.begin() + (y + obstacle_heuristic_padding) * size_x + obstacle_heuristic_padding);
+  }
+
+  // Divided by 2 due to downsampled costmap. Sorted to look up and compare goal sets.
+  std::vector<unsigned int> goal_indices;
+  goal_indices.reserve(goals.size());
+  for (const auto & goal : goals) {
+    goal_indices.push_back(
+      (floor(goal.second / 2.0) + obstacle_heuristic_padding) * size_x +
+      floor(goal.first / 2.0) + obstacle_heuristic_padding);
+  }
+  std::sort(goal_indices.begin(), goal_indices.end());
+  goal_indices.erase(std::unique(goal_indices.begin(), goal_indices.end()), goal_indices.end());
+  const int connectivity = (neighborhood == 4 || neighborhood == 16) ? neighborhood : 8;
+
+  // When replanning to the same goals, the cost-to-go field is still valid where the
+  // costmap has not changed. Keep it outright if nothing changed, else only repair the
+  // cells affected by the cost changes rather than expanding from the goals again.
+  if (cache && goal_indices == search_state->obstacle_heuristic_goal_indices &&
+    size_x == search_state->obstacle_heuristic_size_x &&
+    size == search_state->obstacle_heuristic_costmap.size() &&
+    size == search_state->obstacle_heuristic_lookup_table.size() &&
+    connectivity == search_state->obstacle_heuristic_neighborhood)
+  {
+    if (costs == search_state->obstacle_heuristic_costmap) {
+      return;
+    }
+    // The repair does not follow the cells crossed by knight moves, so a 16-connected
+    // field is expanded again instead
+    if (connectivity != 16) {
+      repairObstacleHeuristic(costs.data());
+      search_state->obstacle_heuristic_costmap.swap(costs);
+      return;
+    }
+  }
 
   // Clear lookup table
-  unsigned int size = sampled_costmap->getSizeInCellsX() * sampled_costmap->getSizeInCellsY();
-  if (obstacle_heuristic_lookup_table.size() == size) {
+  if (search_state->obstacle_heuristic_lookup_table.size() == size) {
     // must reset all values
     std::fill(
-      obstacle_heuristic_lookup_table.begin(),
-      obstacle_heuristic_lookup_table.end(), 0.0);
+      search_state->obstacle_heuristic_lookup_table.begin(),
+      search_state->obstacle_heuristic_lookup_table.end(), 0.0);
   } else {
-    unsigned int obstacle_size = obstacle_heuristic_lookup_table.size();
-    obstacle_heuristic_lookup_table.resize(size, 0.0);
+    unsigned int obstacle_size = search_state->obstacle_heuristic_lookup_table.size();
+    search_state->obstacle_heuristic_lookup_table.resize(size, 0.0);
     // must reset values for non-constructed indices
     std::fill_n(
-      obstacle_heuristic_lookup_table.begin(), obstacle_size, 0.0);
+      search_state->obstacle_heuristic_lookup_table.begin(), obstacle_size, 0.0);
+  }
+
+  search_state->obstacle_heuristic_queue.clear();
+  search_state->obstacle_heuristic_queue.reserve(size);
+
+  // Set initial goal points to queue from
+  for (const unsigned int & goal_index : goal_indices) {
+    search_state->obstacle_heuristic_queue.emplace_back(
+      distanceHeuristic2D(goal_index, size_x, start_x, start_y), goal_index);
+
+    // initialize goal cell with a very small value to differentiate it from 0.0
+    // (~uninitialized), the negative value means the cell is in the open set
+    search_state->obstacle_heuristic_lookup_table[goal_index] = -0.00001f;
+  }
+
+  // Record what the field is computed for, the cost penalty is set on first expansion
+  search_state->obstacle_heuristic_costmap.swap(costs);
+  search_state->obstacle_heuristic_size_x = size_x;
+  search_state->obstacle_heuristic_goal_indices = goal_indices;
+  search_state->obstacle_heuristic_cost_penalty = -1.0;
+  search_state->obstacle_heuristic_neighborhood = connectivity;
+}
+
+void NodeHybrid::repairObstacleHeuristic(const unsigned char * costs)
+{
+  if (search_state->obstacle_heuristic_neighborhood == 4) {
+    repairObstacleHeuristic<4>(costs);
+  } else {
+    repairObstacleHeuristic<8>(costs);
+  }
+}
+
+template<unsigned int Connectivity>
+void NodeHybrid::repairObstacleHeuristic(const unsigned char * costs)
+{
+  // Nothing has been expanded yet, so there is nothing to repair
+  if (search_state->obstacle_heuristic_cost_penalty < 0.0) {
+    return;
+  }
+
+  const unsigned int size = search_state->obstacle_heuristic_costmap.size();
+  const std::vector<unsigned int> & goal_indices = search_state->obstacle_heuristic_goal_indices;
+  const unsigned char * old_costs = search_state->obstacle_heuristic_costmap.data();
+  const double cost_penalty = search_state->obstacle_heuristic_cost_penalty;
+  const ObstacleHeuristicMoves<Connectivity> moves(search_state->obstacle_heuristic_size_x);
+  LookupTable & table = search_state->obstacle_heuristic_lookup_table;
+
+  // Border cells are occupied in both costmaps, so they are never neighbors to update
+  auto getNeighbor = [&](const unsigned int & idx, const unsigned int & i)
+    {
+      return static_cast<unsigned int>(static_cast<int>(idx) + moves.offsets[i]);
+    };
+
+  auto isGoal = [&](const unsigned int & idx)
+    {
+      return std::binary_search(goal_indices.begin(), goal_indices.end(), idx);
+    };
+
+  auto getTravelCost = [&](const unsigned int & i, const unsigned char & cost)
+    {
+      return static_cast<float>(
+        moves.distances[i] * (1.0f + (cost_penalty * cost / 252.0f)));
+    };
+
+  // Raise: cells whose cost increased, and all cells whose value was derived through
+  // them, are no longer supported and are invalidated back to unknown
+  ObstacleHeuristicQueue raised, repair_queue;
+  std::vector<unsigned int> invalidated, decreased;
+  float max_closed_cost = 0.0f;
+  for (unsigned int idx = 0; idx != size; idx++) {
+    max_closed_cost = std::max(max_closed_cost, table[idx]);
+    if (costs[idx] == old_costs[idx] || isGoal(idx)) {
+      continue;
+    }
+    if (costs[idx] > old_costs[idx]) {
+      if (table[idx] != 0.0f) {
+        raised.emplace_back(std::fabs(table[idx]), idx);
+        invalidated.push_back(idx);
+        table[idx] = 0.0f;
+      }
+    } else if (costs[idx] < INSCRIBED) {
+      decreased.push_back(idx);
+    }
+  }
+
+  float value;
+  unsigned int idx, new_idx;
+  while (!raised.empty()) {
+    value = raised.back().first;
+    idx = raised.back().second;
+    raised.pop_back();
+    for (unsigned int i = 0; i != Connectivity; i++) {
+      new_idx = getNeighbor(idx, i);
+      if (table[new_idx] == 0.0f || isGoal(new_idx)) {
+        continue;
+      }
+      // Value may have been reached through the invalidated cell, with its cost at that
+      // time, or through a value it has since improved upon
+      const float neighbor_value = std::fabs(table[new_idx]);
+      const float supported_value = value + getTravelCost(i, old_costs[new_idx]);
+      if (neighbor_value >= supported_value * (1.0f - 1e-4f)) {
+        raised.emplace_back(neighbor_value, new_idx);
+        invalidated.push_back(new_idx);
+        table[new_idx] = 0.0f;
+      }
+    }
+  }
+
+  // Lower: re-seed the invalidated cells and the cells whose cost decreased from their
+  // neighbors, then propagate the improvements in order of cost within the extent of the
+  // previously closed field. Open and unknown cells reached are queued for expansion.
+  auto lowerCell = [&](const unsigned int & cell, const float & new_value)
+    {
+      float & existing_value = table[cell];
+      if (existing_value > 0.0f) {
+        if (new_value >= existing_value * (1.0f - 1e-5f)) {
+          return;
+        }
+        existing_value = new_value;
+      } else {
+        if (existing_value < 0.0f && new_value >= -existing_value) {
+          return;
+        }
+        // the negative value means the cell is in the open set
+        existing_value = -new_value;
+        search_state->obstacle_heuristic_queue.emplace_back(new_value, cell);
+      }
+
+      if (new_value < max_closed_cost) {
+        repair_queue.emplace_back(new_value, cell);
+        std::push_heap(repair_queue.begin(), repair_queue.end(), ObstacleHeuristicComparator{});
+      }
+    };
+
+  invalidated.insert(invalidated.end(), decreased.begin(), decreased.end());
+  for (const unsigned int & cell : invalidated) {
+    if (costs[cell] >= INSCRIBED) {
+      continue;
+    }
+    value = std::numeric_limits<float>::max();
+    for (unsigned int i = 0; i != Connectivity; i++) {
+      new_idx = getNeighbor(cell, i);
+      if (table[new_idx] != 0.0f) {
+        value = std::min(value, std::fabs(table[new_idx]) + getTravelCost(i, costs[cell]));
+      }
+    }
+    if (value != std::numeric_limits<float>::max()) {
+      lowerCell(cell, value);
+    }
   }
 
-  obstacle_heuristic_queue.clear();
-  obstacle_heuristic_queue.reserve(
-    sampled_costmap->getSizeInCellsX() * sampled_costmap->getSizeInCellsY());
+  while (!repair_queue.empty()) {
+    std::pop_heap(repair_queue.begin(), repair_queue.end(), ObstacleHeuristicComparator{});
+    value = repair_queue.back().first;
+    idx = repair_queue.back().second;
+    repair_queue.pop_back();
+    if (std::fabs(table[idx]) != value) {
+      // cell has since been improved further
+      continue;
+    }
+    for (unsigned int i = 0; i != Connectivity; i++) {
+      new_idx = getNeighbor(idx, i);
+      if (costs[new_idx] < INSCRIBED && !isGoal(new_idx)) {
+        lowerCell(new_idx, value + getTravelCost(i, costs[new_idx]));
+      }
+    }
+  }
 
-  // Set initial goal point to queue from. Divided by 2 due to downsampled costmap.
-  const unsigned int size_x = sampled_costmap->getSizeInCellsX();
-  const unsigned int goal_index = floor(goal_y / 2.0) * size_x + floor(goal_x / 2.0);
-  obstacle_heuristic_queue.emplace_back(
-    distanceHeuristic2D(goal_index, size_x, start_x, start_y), goal_index);
+  // Drop queued entries for cells that are no longer open
+  search_state->obstacle_heuristic_queue.erase(
+    std::remove_if(
+      search_state->obstacle_heuristic_queue.begin(), search_state->obstacle_heuristic_queue.end(),
+      [&](const ObstacleHeuristicElement & e) {
+        return table[e.second] >= 0.0f;
+      }), search_state->obstacle_heuristic_queue.end());
+}
 
-  // initialize goal cell with a very small value to differentiate it from 0.0 (~uninitialized)
-  // the negative value means the cell is in the open set
-  obstacle_heuristic_lookup_table[goal_index] = -0.00001f;
+inline bool atomicMin(std::atomic<float> & value, const float & candidate)
+{
+  float current = value.load(std::memory_order_relaxed);
+  while (candidate < current) {
+    if (value.compare_exchange_weak(current, candidate, std::memory_order_relaxed)) {
+      return true;
+    }
+  }
+  return false;
+}
+
+void NodeHybrid::expandObstacleHeuristicParallel(const double & cost_penalty)
+{
+  if (search_state->obstacle_heuristic_neighborhood == 4) {
+    expandObstacleHeuristicParallel<4>(cost_penalty);
+  } else if (search_state->obstacle_heuristic_neighborhood == 16) {
+    expandObstacleHeuristicParallel<16>(cost_penalty);
+  } else {
+    expandObstacleHeuristicParallel<8>(cost_penalty);
+  }
+}
+
+template<unsigned int Connectivity>
+void NodeHybrid::expandObstacleHeuristicParallel(const double & cost_penalty)
+{
+  const int size = static_cast<int>(search_state->obstacle_heuristic_costmap.size());
+  const unsigned char * costs = search_state->obstacle_heuristic_costmap.data();
+  const int threads = search_state->obstacle_heuristic_threads;
+  const ObstacleHeuristicMoves<Connectivity> moves(search_state->obstacle_heuristic_size_x);
+
+  std::vector<std::atomic<float>> dist(size);
+  #pragma omp parallel for num_threads(threads) schedule(static)
+  for (int i = 0; i < size; i++) {
+    dist[i].store(std::numeric_limits<float>::max(), std::memory_order_relaxed);
+  }
+  for (const unsigned int & goal_index : search_state->obstacle_heuristic_goal_indices) {
+    dist[goal_index].store(0.00001f, std::memory_order_relaxed);
+  }
+
+  // Cells are bucketed by the integer part of their cost. Steps cost at most
+  // max_distance * (1 + cost_penalty) so only the next few buckets are ever pending,
+  // which are kept in a ring of per-thread buckets to be merged without locking.
+  const unsigned int ring_size =
+    static_cast<unsigned int>(std::ceil(moves.max_distance * (1.0 + cost_penalty))) + 2u;
+  std::vector<std::vector<std::vector<unsigned int>>> buckets(
+    threads, std::vector<std::vector<unsigned int>>(ring_size));
+  std::vector<unsigned int> frontier = search_state->obstacle_heuristic_goal_indices;
+  unsigned int bucket = 0;
+
+  while (true) {
+    #pragma omp parallel for num_threads(threads) schedule(dynamic, 64)
+    for (int j = 0; j < static_cast<int>(frontier.size()); j++) {
+      const unsigned int idx = frontier[j];
+      const float c_cost = dist[idx].load(std::memory_order_relaxed);
+      if (static_cast<unsigned int>(c_cost) != bucket) {
+        // cell was since improved into an earlier bucket and already expanded
+        continue;
+      }
+
+      std::vector<std::vector<unsigned int>> & thread_buckets = buckets[omp_get_thread_num()];
+      unsigned int new_idx;
+      float cost, new_cost;
+      for (unsigned int i = 0; i != Connectivity; i++) {
+        new_idx = static_cast<unsigned int>(static_cast<int>(idx) + moves.offsets[i]);
+        cost = static_cast<float>(costs[new_idx]);
+        if (cost >= INSCRIBED || !moves.isCrossable(costs, idx, i)) {
+          continue;
+        }
+
+        new_cost = c_cost + static_cast<float>(
+          moves.distances[i] * (1.0f + (cost_penalty * cost / 252.0f)));
+        if (atomicMin(dist[new_idx], new_cost)) {
+          thread_buckets[static_cast<unsigned int>(new_cost) % ring_size].push_back(new_idx);
+        }
+      }
+    }
+
+    // Find the next non-empty bucket and merge it across threads
+    frontier.clear();
+    unsigned int next = bucket + 1;
+    for (; next != bucket + ring_size && frontier.empty(); next++) {
+      for (auto & thread_buckets : buckets) {
+        std::vector<unsigned int> & pending = thread_buckets[next % ring_size];
+        frontier.insert(frontier.end(), pending.begin(), pending.end());
+        pending.clear();
+      }
+    }
+    if (frontier.empty()) {
+      break;
+    }
+    bucket = next - 1;
+  }
+
+  // Every reachable cell is now closed, while unreachable cells remain unknown. The
+  // table is referenced outside of the loop, as its threads have no search state bound.
+  LookupTable & lookup_table = search_state->obstacle_heuristic_lookup_table;
+  #pragma omp parallel for num_threads(threads) schedule(static)
+  for (int i = 0; i < size; i++) {
+    const float value = dist[i].load(std::memory_order_relaxed);
+    lookup_table[i] = value == std::numeric_limits<float>::max() ? 0.0f : value;
+  }
+  search_state->obstacle_heuristic_queue.clear();
 }
 
 float NodeHybrid::getObstacleHeuristic(
@@ -436,12 +896,32 @@ float NodeHybrid::getObstacleHeuristic(
   const double & cost_penalty)
 {
   // If already expanded, return the cost
-  const unsigned int size_x = sampled_costmap->getSizeInCellsX();
+  const unsigned int size_x = search_state->obstacle_heuristic_size_x;
   // Divided by 2 due to downsampled costmap.
-  const unsigned int start_y = floor(node_coords.y / 2.0);
-  const unsigned int start_x = floor(node_coords.x / 2.0);
+  const unsigned int start_y = floor(node_coords.y / 2.0) + obstacle_heuristic_padding;
+  const unsigned int start_x = floor(node_coords.x / 2.0) + obstacle_heuristic_padding;
   const unsigned int start_index = start_y * size_x + start_x;
-  const float & requested_node_cost = obstacle_heuristic_lookup_table[start_index];
+  // A field expanded with a different cost penalty must be expanded again
+  if (cost_penalty != search_state->obstacle_heuristic_cost_penalty) {
+    if (search_state->obstacle_heuristic_cost_penalty >= 0.0) {
+      std::fill(
+        search_state->obstacle_heuristic_lookup_table.begin(),
+        search_state->obstacle_heuristic_lookup_table.end(), 0.0);
+      search_state->obstacle_heuristic_queue.clear();
+      for (const unsigned int & goal_index : search_state->obstacle_heuristic_goal_indices) {
+        search_state->obstacle_heuristic_queue.emplace_back(0.0f, goal_index);
+        search_state->obstacle_heuristic_lookup_table[goal_index] = -0.00001f;
+      }
+    }
+    search_state->obstacle_heuristic_cost_penalty = cost_penalty;
+
+    // With multiple threads, expand the entire field at once rather than on demand
+    if (search_state->obstacle_heuristic_threads > 1) {
+      expandObstacleHeuristicParallel(cost_penalty);
+    }
+  }
+
+  const float & requested_node_cost = search_state->obstacle_heuristic_lookup_table[start_index];
   if (requested_node_cost > 0.0f) {
     // costs are doubled due to downsampling
     return 2.0 * requested_node_cost;
@@ -455,79 +935,74 @@ float NodeHybrid::getObstacleHeuristic(
 
   // start_x and start_y have changed since last call
   // we need to recompute 2D distance heuristic and reprioritize queue
-  for (auto & n : obstacle_heuristic_queue) {
-    n.first = -obstacle_heuristic_lookup_table[n.second] +
+  for (auto & n : search_state->obstacle_heuristic_queue) {
+    n.first = -search_state->obstacle_heuristic_lookup_table[n.second] +
       distanceHeuristic2D(n.second, size_x, start_x, start_y);
   }
   std::make_heap(
-    obstacle_heuristic_queue.begin(), obstacle_heuristic_queue.end(),
-    ObstacleHeuristicComparator{});
+    search_state->obstacle_heuristic_queue.begin(),
+    search_state->obstacle_heuristic_queue.end(), ObstacleHeuristicComparator{});
+
+  if (search_state->obstacle_heuristic_neighborhood == 4) {
+    expandObstacleHeuristic<4>(start_x, start_y, cost_penalty);
+  } else if (search_state->obstacle_heuristic_neighborhood == 16) {
+    expandObstacleHeuristic<16>(start_x, start_y, cost_penalty);
+  } else {
+    expandObstacleHeuristic<8>(start_x, start_y, cost_penalty);
+  }
+
+  // return requested_node_cost which has been updated by the search
+  // costs are doubled due to downsampling
+  return 2.0 * requested_node_cost;
+}
 
-  const int size_x_int = static_cast<int>(size_x);
-  const unsigned int size_y = sampled_costmap->getSizeInCellsY();
-  const float sqrt_2 = sqrt(2);
+template<unsigned int Connectivity>
+void NodeHybrid::expandObstacleHeuristic(
+  const unsigned int & start_x, const unsigned int & start_y, const double & cost_penalty)
+{
+  const unsigned int size_x = search_state->obstacle_heuristic_size_x;
+  const unsigned int start_index = start_y * size_x + start_x;
+  const unsigned char * costs = search_state->obstacle_heuristic_costmap.data();
+  LookupTable & lookup_table = search_state->obstacle_heuristic_lookup_table;
+  ObstacleHeuristicQueue & queue = search_state->obstacle_heuristic_queue;
+  const ObstacleHeuristicMoves<Connectivity> moves(size_x);
   float c_cost, cost, travel_cost, new_cost, existing_cost;
-  unsigned int idx, mx, my, mx_idx, my_idx;
+  unsigned int idx;
   unsigned int new_idx = 0;
 
-  const std::vector<int> neighborhood = {1, -1,  // left right
-    size_x_int, -size_x_int,  // up down
-    size_x_int + 1, size_x_int - 1,  // upper diagonals
-    -size_x_int + 1, -size_x_int - 1};  // lower diagonals
-
-  while (!obstacle_heuristic_queue.empty()) {
-    idx = obstacle_heuristic_queue.front().second;
-    std::pop_heap(
-      obstacle_heuristic_queue.begin(), obstacle_heuristic_queue.end(),
-      ObstacleHeuristicComparator{});
-    obstacle_heuristic_queue.pop_back();
-    c_cost = obstacle_heuristic_lookup_table[idx];
+  while (!queue.empty()) {
+    idx = queue.front().second;
+    std::pop_heap(queue.begin(), queue.end(), ObstacleHeuristicComparator{});
+    queue.pop_back();
+    c_cost = lookup_table[idx];
     if (c_cost > 0.0f) {
       // cell has been processed and closed, no further cost improvements
       // are mathematically possible thanks to euclidean distance heuristic consistency
       continue;
     }
     c_cost = -c_cost;
-    obstacle_heuristic_lookup_table[idx] = c_cost;  // set a positive value to close the cell
+    lookup_table[idx] = c_cost;  // set a positive value to close the cell
 
-    my_idx = idx / size_x;
-    mx_idx = idx - (my_idx * size_x);
-
-    // find neighbors
-    for (unsigned int i = 0; i != neighborhood.size(); i++) {
-      new_idx = static_cast<unsigned int>(static_cast<int>(idx) + neighborhood[i]);
+    // find neighbors, within the occupied border of the costmap
+    for (unsigned int i = 0; i != Connectivity; i++) {
+      new_idx = static_cast<unsigned int>(static_cast<int>(idx) + moves.offsets[i]);
 
       // if neighbor path is better and non-lethal, set new cost and add to queue
-      if (new_idx < size_x * size_y) {
-        cost = static_cast<float>(sampled_costmap->getCost(new_idx));
-        if (cost >= INSCRIBED) {
-          continue;
-        }
-
-        my = new_idx / size_x;
-        mx = new_idx - (my * size_x);
-
-        if (mx == 0 && mx_idx >= size_x - 1 || mx >= size_x - 1 && mx_idx == 0) {
-          continue;
-        }
-        if (my == 0 && my_idx >= size_y - 1 || my >= size_y - 1 && my_idx == 0) {
-          continue;
-        }
+      cost = static_cast<float>(costs[new_idx]);
+      if (cost >= INSCRIBED || !moves.isCrossable(costs, idx, i)) {
+        continue;
+      }
 
-        existing_cost = obstacle_heuristic_lookup_table[new_idx];
-        if (existing_cost <= 0.0f) {
-          travel_cost =
-            ((i <= 3) ? 1.0f : sqrt_2) * (1.0f + (cost_penalty * cost / 252.0f));
-          new_cost = c_cost + travel_cost;
-          if (existing_cost == 0.0f || -existing_cost > new_cost) {
-            // the negative value means the cell is in the open set
-            obstacle_heuristic_lookup_table[new_idx] = -new_cost;
-            obstacle_heuristic_queue.emplace_back(
-              new_cost + distanceHeuristic2D(new_idx, size_x, start_x, start_y), new_idx);
-            std::push_heap(
-              obstacle_heuristic_queue.begin(), obstacle_heuristic_queue.end(),
-              ObstacleHeuristicComparator{});
-          }
+      existing_cost = lookup_table[new_idx];
+      if (existing_cost <= 0.0f) {
+        travel_cost = moves.distances[i] * (1.0f + (cost_penalty * cost / 252.0f));
+        new_cost = c_cost + travel_cost;
+        if (existing_cost == 0.0f || -existing_cost > new_cost) {
+          // the negative value means the cell is in the open set
+          lookup_table[new_idx] = -new_cost;
+          queue.emplace_back(
+            new_cost + distanceHeuristic2D(new_idx, size_x, start_x, start_y), new_idx);
+          std::push_heap(queue.begin(), queue.end(), ObstacleHeuristicComparator{});
         }
       }
     }
@@ -536,10 +1011,6 @@ float NodeHybrid::getObstacleHeuristic(
       break;
     }
   }
-
-  // return requested_node_cost which has been updated by the search
-  // costs are doubled due to downsampling
-  return 2.0 * requested_node_cost;
 }
 
 float NodeHybrid::getDistanceHeuristic(
@@ -547,6 +1018,7 @@ float NodeHybrid::getDistanceHeuristic(
   const Coordinates & goal_coords,
   const float & obstacle_heuristic)
 {
+  const HybridMotionTable & motion_table = search_state->motion_table;
   // rotate and translate node_coords such that goal_coords relative is (0,0,0)
   // Due to the rounding involved in exact cell increments for caching,
   // this is not an exact replica of a live heuristic, but has bounded error.
@@ -577,8 +1049,8 @@ float NodeHybrid::getDistanceHeuristic(
   // to apply the distance heuristic. Since the lookup table is contains only the positive
   // X axis, we mirror the Y and theta values across the X axis to find the heuristic values.
   float motion_heuristic = 0.0;
-  const int floored_size = floor(size_lookup / 2.0);
-  const int ceiling_size = ceil(size_lookup / 2.0);
+  const int floored_size = floor(search_state->size_lookup / 2.0);
+  const int ceiling_size = ceil(search_state->size_lookup / 2.0);
   const float mirrored_relative_y = abs(node_coords_relative.y);
   if (abs(node_coords_relative.x) < floored_size && mirrored_relative_y < floored_size) {
     // Need to mirror angle if Y coordinate was mirrored
@@ -594,23 +1066,32 @@ float NodeHybrid::getDistanceHeuristic(
       x_pos * ceiling_size * motion_table.num_angle_quantization +
       y_pos * motion_table.num_angle_quantization +
       theta_pos;
-    motion_heuristic = dist_heuristic_lookup_table[index];
+    motion_heuristic = search_state->dist_heuristic_lookup_table[index];
   } else if (obstacle_heuristic == 0.0) {
     // If no obstacle heuristic value, must have some H to use
     // In nominal situations, this should never be called.
-    static ompl::base::ScopedState<> from(motion_table.state_space), to(motion_table.state_space);
-    to[0] = goal_coords.x;
-    to[1] = goal_coords.y;
-    to[2] = goal_coords.theta * motion_table.num_angle_quantization;
-    from[0] = node_coords.x;
-    from[1] = node_coords.y;
-    from[2] = node_coords.theta * motion_table.num_angle_quantization;
-    motion_heuristic = motion_table.state_space->distance(from(), to());
+    motion_heuristic = motion_table.analytic_curve.distance(
+      node_coords.x, node_coords.y, node_coords.theta * motion_table.num_angle_quantization,
+      goal_coords.x, goal_coords.y, goal_coords.theta * motion_table.num_angle_quantization);
   }
 
   return motion_heuristic;
 }
 
+size_t NodeHybrid::getObstacleHeuristicMemoryUsage()
+{
+  return search_state->obstacle_heuristic_lookup_table.capacity() * sizeof(float) +
+         search_state->obstacle_heuristic_queue.capacity() * sizeof(ObstacleHeuristicElement) +
+         search_state->obstacle_heuristic_costmap.capacity() * sizeof(unsigned char) +
+         search_state->obstacle_heuristic_goal_indices.capacity() * sizeof(unsigned int);
+}
+
+size_t NodeHybrid::getLookupTablesMemoryUsage()
+{
+  return getObstacleHeuristicMemoryUsage() +
+         search_state->dist_heuristic_lookup_table.capacity() * sizeof(float);
+}
+
 void NodeHybrid::precomputeDistanceHeuristic(
   const float & lookup_table_dim,
   const MotionModel & motion_model,
@@ -619,45 +1100,61 @@ void NodeHybrid::precomputeDistanceHeuristic(
 {
   // Dubin or Reeds-Shepp shortest distances
   if (motion_model == MotionModel::DUBIN) {
-    motion_table.state_space = std::make_unique<ompl::base::DubinsStateSpace>(
-      search_info.minimum_turning_radius);
+    search_state->motion_table.analytic_curve =
+      AnalyticCurve(false, search_info.minimum_turning_radius);
   } else if (motion_model == MotionModel::REEDS_SHEPP) {
-    motion_table.state_space = std::make_unique<ompl::base::ReedsSheppStateSpace>(
-      search_info.minimum_turning_radius);
+    search_state->motion_table.analytic_curve =
+      AnalyticCurve(true, search_info.minimum_turning_radius);
   } else {
     throw std::runtime_error(
             "Node attempted to precompute distance heuristics "
             "with invalid motion model!");
   }
 
-  ompl::base::ScopedState<> from(motion_table.state_space), to(motion_table.state_space);
-  to[0] = 0.0;
-  to[1] = 0.0;
-  to[2] = 0.0;
-  size_lookup = lookup_table_dim;
+  search_state->size_lookup = lookup_table_dim;
   float motion_heuristic = 0.0;
   unsigned int index = 0;
   int dim_3_size_int = static_cast<int>(dim_3_size);
   float angular_bin_size = 2 * M_PI / static_cast<float>(dim_3_size);
 
+  // Reuse a table cached on disk by a previous run with the same parameters
+  std::unique_ptr<DistanceHeuristicCache> cache;
+  if (!search_info.distance_heuristic_cache_directory.empty()) {
+    std::vector<float> heading_angles;
+    for (int heading = 0; heading != dim_3_size_int; heading++) {
+      heading_angles.push_back(heading * angular_bin_size);
+    }
+    cache = std::make_unique<DistanceHeuristicCache>(
+      search_info.distance_heuristic_cache_directory, motion_model,
+      search_info.minimum_turning_radius, search_state->size_lookup, heading_angles);
+    if (cache->load(search_state->dist_heuristic_lookup_table)) {
+      return;
+    }
+  }
+
   // Create a lookup table of Dubin/Reeds-Shepp distances in a window around the goal
   // to help drive the search towards admissible approaches. Deu to symmetries in the
   // Heuristic space, we need to only store 2 of the 4 quadrants and simply mirror
   // around the X axis any relative node lookup. This reduces memory overhead and increases
   // the size of a window a platform can store in memory.
-  dist_heuristic_lookup_table.resize(size_lookup * ceil(size_lookup / 2.0) * dim_3_size_int);
+  const float & size_lookup = search_state->size_lookup;
+  LookupTable & lookup_table = search_state->dist_heuristic_lookup_table;
+  lookup_table.resize(size_lookup * ceil(size_lookup / 2.0) * dim_3_size_int);
   for (float x = ceil(-size_lookup / 2.0); x <= floor(size_lookup / 2.0); x += 1.0) {
     for (float y = 0.0; y <= floor(size_lookup / 2.0); y += 1.0) {
       for (int heading = 0; heading != dim_3_size_int; heading++) {
-        from[0] = x;
-        from[1] = y;
-        from[2] = heading * angular_bin_size;
-        motion_heuristic = motion_table.state_space->distance(from(), to());
-        dist_heuristic_lookup_table[index] = motion_heuristic;
+        motion_heuristic = search_state->motion_table.analytic_curve.distance(
+          x, y, heading * angular_bin_size, 0.0, 0.0, 0.0);
+        lookup_table[index] = motion_heuristic;
         index++;
       }
     }
   }
+
+  // Failing to write the cache only costs recomputing the table on the next start
+  if (cache) {
+    cache->save(lookup_table);
+  }
 }
 
 void NodeHybrid::getNeighbors(
@@ -665,18 +1162,34 @@ void NodeHybrid::getNeighbors(
   GridCollisionChecker * collision_checker,
   const bool & traverse_unknown,
   NodeVector & neighbors)
+{
+  // Dubin and Reeds-Shepp models have 3 and 6 primitives
+  if (search_state->motion_table.projections.size() == 3) {
+    getPrimitiveNeighbors<3>(NeighborGetter, collision_checker, traverse_unknown, neighbors);
+  } else if (search_state->motion_table.projections.size() == 6) {
+    getPrimitiveNeighbors<6>(NeighborGetter, collision_checker, traverse_unknown, neighbors);
+  }
+}
+
+template<unsigned int NumPrimitives>
+void NodeHybrid::getPrimitiveNeighbors(
+  std::function<bool(const unsigned int &, nav2_smac_planner::NodeHybrid * &)> & NeighborGetter,
+  GridCollisionChecker * collision_checker,
+  const bool & traverse_unknown,
+  NodeVector & neighbors)
 {
   unsigned int index = 0;
   NodePtr neighbor = nullptr;
   Coordinates initial_node_coords;
-  const MotionPoses motion_projections = motion_table.getProjections(this);
+  std::array<MotionPose, NumPrimitives> motion_projections;
+  search_state->motion_table.getProjections<NumPrimitives>(this, motion_projections);
 
-  for (unsigned int i = 0; i != motion_projections.size(); i++) {
+  for (unsigned int i = 0; i != NumPrimitives; i++) {
     index = NodeHybrid::getIndex(
       static_cast<unsigned int>(motion_projections[i]._x),
       static_cast<unsigned int>(motion_projections[i]._y),
       static_cast<unsigned int>(motion_projections[i]._theta),
-      motion_table.size_x, motion_table.num_angle_quantization);
+      search_state->motion_table.size_x, search_state->motion_table.num_angle_quantization);
 
     if (NeighborGetter(index, neighbor) && !neighbor->wasVisited()) {
       // Cache the initial pose in case it was visited but valid
@@ -687,7 +1200,11 @@ void NodeHybrid::getNeighbors(
           motion_projections[i]._x,
           motion_projections[i]._y,
           motion_projections[i]._theta));
-      if (neighbor->isNodeValid(traverse_unknown, collision_checker)) {
+      // With lazy collision checking, the footprint is only checked once expanded
+      const bool is_valid = search_state->motion_table.lazy_collision_checking ?
+        neighbor->isNodeCenterValid(traverse_unknown, collision_checker) :
+        neighbor->isNodeValid(traverse_unknown, collision_checker);
+      if (is_valid) {
         neighbor->setMotionPrimitiveIndex(i);
         neighbors.push_back(neighbor);
       } else {
@@ -697,6 +1214,73 @@ void NodeHybrid::getNeighbors(
   }
 }
 
+void NodeHybrid::checkProjections(
+  const NodeVector & nodes,
+  std::vector<GridCollisionChecker> & collision_checkers,
+  const bool & traverse_unknown,
+  ProjectionChecks & checks)
+{
+  const unsigned int num_primitives = search_state->motion_table.projections.size();
+  checks.resize(nodes.size() * num_primitives);
+  for (unsigned int i = 0; i != nodes.size(); i++) {
+    const MotionPoses projections = search_state->motion_table.getProjections(nodes[i]);
+    for (unsigned int j = 0; j != num_primitives; j++) {
+      checks[i * num_primitives + j].pose = projections[j];
+    }
+  }
+
+  // Each thread writes the checks it was given only, with its own collision checker,
+  // as it stores the last cost checked. Projections off the costmap have no cost to
+  // store, so they are left out.
+  const int threads = std::max(1, static_cast<int>(collision_checkers.size()));
+  const float size_x = static_cast<float>(search_state->motion_table.size_x);
+  const float size_y = static_cast<float>(collision_checkers[0].getCostmap()->getSizeInCellsY());
+  #pragma omp parallel for num_threads(threads) schedule(dynamic, 4)
+  for (int k = 0; k < static_cast<int>(checks.size()); k++) {
+    GridCollisionChecker & collision_checker = collision_checkers[omp_get_thread_num()];
+    ProjectionCheck & check = checks[k];
+    if (check.pose._x < 0.0f || check.pose._x >= size_x ||
+      check.pose._y < 0.0f || check.pose._y >= size_y)
+    {
+      check.valid = false;
+      check.cost = 0.0f;
+      continue;
+    }
+    check.valid = !collision_checker.inCollision(
+      check.pose._x, check.pose._y, check.pose._theta, traverse_unknown);
+    check.cost = check.valid ? collision_checker.getCost() : 0.0f;
+  }
+}
+
+void NodeHybrid::getCheckedNeighbors(
+  std::function<bool(const unsigned int &, nav2_smac_planner::NodeHybrid * &)> & NeighborGetter,
+  const ProjectionCheck * checks,
+  NodeVector & neighbors)
+{
+  unsigned int index = 0;
+  NodePtr neighbor = nullptr;
+  for (unsigned int i = 0; i != search_state->motion_table.projections.size(); i++) {
+    const ProjectionCheck & check = checks[i];
+    if (!check.valid) {
+      continue;
+    }
+
+    index = NodeHybrid::getIndex(
+      static_cast<unsigned int>(check.pose._x),
+      static_cast<unsigned int>(check.pose._y),
+      static_cast<unsigned int>(check.pose._theta),
+      search_state->motion_table.size_x, search_state->motion_table.num_angle_quantization);
+
+    if (NeighborGetter(index, neighbor) && !neighbor->wasVisited()) {
+      neighbor->setPose(Coordinates(check.pose._x, check.pose._y, check.pose._theta));
+      neighbor->_cell_cost = check.cost;
+      neighbor->_was_collision_checked = true;
+      neighbor->setMotionPrimitiveIndex(i);
+      neighbors.push_back(neighbor);
+    }
+  }
+}
+
 bool NodeHybrid::backtracePath(CoordinateVector & path)
 {
   if (!this->parent) {
@@ -708,7 +1292,7 @@ bool NodeHybrid::backtracePath(CoordinateVector & path)
   while (current_node->parent) {
     path.push_back(current_node->pose);
     // Convert angle to radians
-    path.back().theta = NodeHybrid::motion_table.getAngleFromBin(path.back().theta);
+    path.back().theta = NodeHybrid::search_state->motion_table.getAngleFromBin(path.back().theta);
     current_node = current_node->parent;
   }
 
@@ -23,10 +23,6 @@
 #include <fstream>
 #include <cmath>
 
-#include "ompl/base/ScopedState.h"
-#include "ompl/base/spaces/DubinsStateSpace.h"
-#include "ompl/base/spaces/ReedsSheppStateSpace.h"
-
 #include "nav2_smac_planner/node_lattice.hpp"
 
 using namespace std::chrono;  // NOLINT
@@ -35,9 +31,9 @@ namespace nav2_smac_planner
 {
 
 // defining static member for all instance to share
-LatticeMotionTable NodeLattice::motion_table;
-float NodeLattice::size_lookup = 25;
-LookupTable NodeLattice::dist_heuristic_lookup_table;
+NodeLatticeSearchState NodeLattice::default_search_state;
+thread_local NodeLatticeSearchState * NodeLattice::search_state =
+  &NodeLattice::default_search_state;
 
 // Each of these tables are the projected motion models through
 // time and space applied to the search on the current node in
@@ -67,42 +63,47 @@ void LatticeMotionTable::initMotionModel(
 
   // Get the metadata about this minimum control set
   lattice_metadata = getLatticeMetadata(current_lattice_filepath);
-  std::ifstream latticeFile(current_lattice_filepath);
-  if (!latticeFile.is_open()) {
-    throw std::runtime_error("Could not open lattice file");
-  }
-  nlohmann::json json;
-  latticeFile >> json;
   num_angle_quantization = lattice_metadata.number_of_headings;
 
-  if (!state_space) {
-    if (!allow_reverse_expansion) {
-      state_space = std::make_unique<ompl::base::DubinsStateSpace>(
-        lattice_metadata.min_turning_radius);
-    } else {
-      state_space = std::make_unique<ompl::base::ReedsSheppStateSpace>(
-        lattice_metadata.min_turning_radius);
+  if (!analytic_curve.valid()) {
+    analytic_curve = AnalyticCurve(allow_reverse_expansion, lattice_metadata.min_turning_radius);
+  }
+
+  // Populate the motion primitives at each heading angle, copied from a memory
+  // mapped binary lattice file if given, else parsing the JSON lattice file
+  std::vector<MotionPrimitive> all_primitives;
+  if (LatticeBinaryFile::isLatticeBinaryFile(current_lattice_filepath)) {
+    LatticeBinaryFile(current_lattice_filepath).getMotionPrimitives(all_primitives);
+  } else {
+    std::ifstream latticeFile(current_lattice_filepath);
+    if (!latticeFile.is_open()) {
+      throw std::runtime_error("Could not open lattice file");
+    }
+    nlohmann::json json;
+    latticeFile >> json;
+    nlohmann::json json_primitives = json["primitives"];
+    all_primitives.resize(json_primitives.size());
+    for (unsigned int i = 0; i < json_primitives.size(); ++i) {
+      fromJsonToMotionPrimitive(json_primitives[i], all_primitives[i]);
     }
   }
 
-  // Populate the motion primitives at each heading angle
   float prev_start_angle = 0.0;
   std::vector<MotionPrimitive> primitives;
-  nlohmann::json json_primitives = json["primitives"];
-  for (unsigned int i = 0; i < json_primitives.size(); ++i) {
-    MotionPrimitive new_primitive;
-    fromJsonToMotionPrimitive(json_primitives[i], new_primitive);
-
-    if (prev_start_angle != new_primitive.start_angle) {
+  motion_primitives.clear();
+  for (unsigned int i = 0; i < all_primitives.size(); ++i) {
+    if (prev_start_angle != all_primitives[i].start_angle) {
       motion_primitives.push_back(primitives);
       primitives.clear();
-      prev_start_angle = new_primitive.start_angle;
+      prev_start_angle = all_primitives[i].start_angle;
     }
-    primitives.push_back(new_primitive);
+    primitives.push_back(all_primitives[i]);
   }
   motion_primitives.push_back(primitives);
+  swept_footprints.clear();
 
   // Populate useful precomputed values to be leveraged
+  trig_values.clear();
   trig_values.reserve(lattice_metadata.number_of_headings);
   for (unsigned int i = 0; i < lattice_metadata.heading_angles.size(); ++i) {
     trig_values.emplace_back(
@@ -140,6 +141,10 @@ MotionPrimitivePtrs LatticeMotionTable::getMotionPrimitives(const NodeLattice *
 
 LatticeMetadata LatticeMotionTable::getLatticeMetadata(const std::string & lattice_filepath)
 {
+  if (LatticeBinaryFile::isLatticeBinaryFile(lattice_filepath)) {
+    return LatticeBinaryFile(lattice_filepath).getMetadata();
+  }
+
   std::ifstream lattice_file(lattice_filepath);
   if (!lattice_file.is_open()) {
     throw std::runtime_error("Could not open lattice file!");
@@ -172,6 +177,55 @@ float & LatticeMotionTable::getAngleFromBin(const unsigned int & bin_idx)
   return lattice_metadata.heading_angles[bin_idx];
 }
 
+GridCollisionChecker::SweptFootprint & LatticeMotionTable::getSweptFootprint(
+  GridCollisionChecker * collision_checker,
+  MotionPrimitive * motion_primitive,
+  const bool & is_backwards,
+  const float & end_angle_bin)
+{
+  // Swept cells are only valid for the footprint they were rasterized with
+  if (swept_footprint_id != collision_checker->getFootprintId()) {
+    swept_footprints.clear();
+    swept_footprint_id = collision_checker->getFootprintId();
+  }
+
+  const unsigned int swept_idx = 2 * motion_primitive->trajectory_id + (is_backwards ? 1 : 0);
+  if (swept_idx >= swept_footprints.size()) {
+    swept_footprints.resize(swept_idx + 1);
+  }
+
+  std::unique_ptr<GridCollisionChecker::SweptFootprint> & swept_footprint =
+    swept_footprints[swept_idx];
+  if (swept_footprint) {
+    return *swept_footprint;
+  }
+
+  // Sample the same poses as NodeLattice::isNodeValid, relative to the end cell
+  static const double bin_size = 2.0 * M_PI / collision_checker->getPrecomputedAngles().size();
+  const float pi_2 = 2.0 * M_PI;
+  const float & grid_resolution = lattice_metadata.grid_resolution;
+  const float & resolution_diag_sq = 2.0 * grid_resolution * grid_resolution;
+  const MotionPose & end_pose = motion_primitive->poses.back();
+  MotionPose last_pose(1e9, 1e9, 1e9), pose_dist(0.0, 0.0, 0.0);
+  MotionPoses poses;
+  poses.emplace_back(0.0, 0.0, end_angle_bin);
+  for (auto it = motion_primitive->poses.begin(); it != motion_primitive->poses.end(); ++it) {
+    pose_dist = *it - last_pose;
+    if (pose_dist._x * pose_dist._x + pose_dist._y * pose_dist._y > resolution_diag_sq) {
+      last_pose = *it;
+      const float theta = is_backwards ? std::fmod(it->_theta + M_PI, pi_2) : it->_theta;
+      poses.emplace_back(
+        (it->_x - end_pose._x) / grid_resolution,
+        (it->_y - end_pose._y) / grid_resolution,
+        theta / bin_size);
+    }
+  }
+
+  swept_footprint = std::make_unique<GridCollisionChecker::SweptFootprint>();
+  collision_checker->sweepFootprint(poses, *swept_footprint);
+  return *swept_footprint;
+}
+
 NodeLattice::NodeLattice(const unsigned int index)
 : parent(nullptr),
   pose(0.0f, 0.0f, 0.0f),
@@ -179,8 +233,9 @@ NodeLattice::NodeLattice(const unsigned int index)
   _accumulated_cost(std::numeric_limits<float>::max()),
   _index(index),
   _was_visited(false),
-  _motion_primitive(nullptr),
-  _backwards(false)
+  _backwards(false),
+  _was_collision_checked(false),
+  _motion_primitive(nullptr)
 {
 }
 
@@ -200,6 +255,7 @@ void NodeLattice::reset()
   pose.theta = 0.0f;
   _motion_primitive = nullptr;
   _backwards = false;
+  _was_collision_checked = false;
 }
 
 bool NodeLattice::isNodeValid(
@@ -211,7 +267,27 @@ bool NodeLattice::isNodeValid(
   // Check primitive end pose
   // Convert grid quantization of primitives to radians, then collision checker quantization
   static const double bin_size = 2.0 * M_PI / collision_checker->getPrecomputedAngles().size();
-  const double & angle = motion_table.getAngleFromBin(this->pose.theta) / bin_size;
+  const double & angle = search_state->motion_table.getAngleFromBin(this->pose.theta) / bin_size;
+
+  // With a rasterized footprint, check the cells swept over the whole primitive at once
+  if (motion_primitive && collision_checker->isFootprintRasterized()) {
+    const GridCollisionChecker::SweptFootprint & swept_footprint =
+      search_state->motion_table.getSweptFootprint(
+      collision_checker, motion_primitive, is_backwards, angle);
+    if (collision_checker->inCollision(
+        swept_footprint,
+        static_cast<int>(this->pose.x),
+        static_cast<int>(this->pose.y),
+        traverse_unknown))
+    {
+      return false;
+    }
+
+    _cell_cost = collision_checker->getCost();
+    _was_collision_checked = true;
+    return true;
+  }
+
   if (collision_checker->inCollision(
       this->pose.x, this->pose.y, angle /*bin in collision checker*/, traverse_unknown))
   {
@@ -224,7 +300,7 @@ bool NodeLattice::isNodeValid(
   // If valid motion primitives are set, check intermediary poses > 1 cell apart
   if (motion_primitive) {
     const float pi_2 = 2.0 * M_PI;
-    const float & grid_resolution = motion_table.lattice_metadata.grid_resolution;
+    const float & grid_resolution = search_state->motion_table.lattice_metadata.grid_resolution;
     const float & resolution_diag_sq = 2.0 * grid_resolution * grid_resolution;
     MotionPose last_pose(1e9, 1e9, 1e9), pose_dist(0.0, 0.0, 0.0);
 
@@ -232,7 +308,7 @@ bool NodeLattice::isNodeValid(
     MotionPose initial_pose, prim_pose;
     initial_pose._x = this->pose.x - (motion_primitive->poses.back()._x / grid_resolution);
     initial_pose._y = this->pose.y - (motion_primitive->poses.back()._y / grid_resolution);
-    initial_pose._theta = motion_table.getAngleFromBin(motion_primitive->start_angle);
+    initial_pose._theta = search_state->motion_table.getAngleFromBin(motion_primitive->start_angle);
 
     for (auto it = motion_primitive->poses.begin(); it != motion_primitive->poses.end(); ++it) {
       // poses are in metric coordinates from (0, 0), not grid space yet
@@ -264,11 +340,33 @@ bool NodeLattice::isNodeValid(
   }
 
   _cell_cost = max_cell_cost;
+  _was_collision_checked = true;
+  return true;
+}
+
+bool NodeLattice::isNodeCenterValid(
+  const bool & traverse_unknown,
+  GridCollisionChecker * collision_checker)
+{
+  if (collision_checker->inCollisionAtCenter(this->pose.x, this->pose.y, traverse_unknown)) {
+    return false;
+  }
+
+  _cell_cost = collision_checker->getCost();
+  _was_collision_checked = false;
   return true;
 }
 
+bool NodeLattice::isDeferredNodeValid(
+  const bool & traverse_unknown,
+  GridCollisionChecker * collision_checker)
+{
+  return isNodeValid(traverse_unknown, collision_checker, _motion_primitive, _backwards);
+}
+
 float NodeLattice::getTraversalCost(const NodePtr & child)
 {
+  LatticeMotionTable & motion_table = search_state->motion_table;
   const float normalized_cost = child->getCost() / 252.0;
   if (std::isnan(normalized_cost)) {
     throw std::runtime_error(
@@ -324,7 +422,7 @@ float NodeLattice::getHeuristicCost(
 {
   // get obstacle heuristic value
   const float obstacle_heuristic = getObstacleHeuristic(
-    node_coords, goal_coords, motion_table.cost_penalty);
+    node_coords, goal_coords, search_state->motion_table.cost_penalty);
   const float distance_heuristic =
     getDistanceHeuristic(node_coords, goal_coords, obstacle_heuristic);
   return std::max(obstacle_heuristic, distance_heuristic);
@@ -343,7 +441,8 @@ void NodeLattice::initMotionModel(
             " STATE_LATTICE and provide a valid lattice file.");
   }
 
-  motion_table.initMotionModel(size_x, search_info);
+  search_state->motion_table.initMotionModel(size_x, search_info);
+  search_state->motion_table.lazy_collision_checking = search_info.use_lazy_collision_checking;
 }
 
 float NodeLattice::getDistanceHeuristic(
@@ -351,6 +450,7 @@ float NodeLattice::getDistanceHeuristic(
   const Coordinates & goal_coords,
   const float & obstacle_heuristic)
 {
+  LatticeMotionTable & motion_table = search_state->motion_table;
   // rotate and translate node_coords such that goal_coords relative is (0,0,0)
   // Due to the rounding involved in exact cell increments for caching,
   // this is not an exact replica of a live heuristic, but has bounded error.
@@ -381,8 +481,8 @@ float NodeLattice::getDistanceHeuristic(
   // to apply the distance heuristic. Since the lookup table is contains only the positive
   // X axis, we mirror the Y and theta values across the X axis to find the heuristic values.
   float motion_heuristic = 0.0;
-  const int floored_size = floor(size_lookup / 2.0);
-  const int ceiling_size = ceil(size_lookup / 2.0);
+  const int floored_size = floor(search_state->size_lookup / 2.0);
+  const int ceiling_size = ceil(search_state->size_lookup / 2.0);
   const float mirrored_relative_y = abs(node_coords_relative.y);
   if (abs(node_coords_relative.x) < floored_size && mirrored_relative_y < floored_size) {
     // Need to mirror angle if Y coordinate was mirrored
@@ -398,21 +498,22 @@ float NodeLattice::getDistanceHeuristic(
       x_pos * ceiling_size * motion_table.num_angle_quantization +
       y_pos * motion_table.num_angle_quantization +
       theta_pos;
-    motion_heuristic = dist_heuristic_lookup_table[index];
+    motion_heuristic = search_state->dist_heuristic_lookup_table[index];
   } else if (obstacle_heuristic == 0.0) {
-    static ompl::base::ScopedState<> from(motion_table.state_space), to(motion_table.state_space);
-    to[0] = goal_coords.x;
-    to[1] = goal_coords.y;
-    to[2] = motion_table.getAngleFromBin(goal_coords.theta);
-    from[0] = node_coords.x;
-    from[1] = node_coords.y;
-    from[2] = motion_table.getAngleFromBin(node_coords.theta);
-    motion_heuristic = motion_table.state_space->distance(from(), to());
+    motion_heuristic = motion_table.analytic_curve.distance(
+      node_coords.x, node_coords.y, motion_table.getAngleFromBin(node_coords.theta),
+      goal_coords.x, goal_coords.y, motion_table.getAngleFromBin(goal_coords.theta));
   }
 
   return motion_heuristic;
 }
 
+size_t NodeLattice::getLookupTablesMemoryUsage()
+{
+  return NodeHybrid::getObstacleHeuristicMemoryUsage() +
+         search_state->dist_heuristic_lookup_table.capacity() * sizeof(float);
+}
+
 void NodeLattice::precomputeDistanceHeuristic(
   const float & lookup_table_dim,
   const MotionModel & motion_model,
@@ -420,43 +521,55 @@ void NodeLattice::precomputeDistanceHeuristic(
   const SearchInfo & search_info)
 {
   // Dubin or Reeds-Shepp shortest distances
-  if (!search_info.allow_reverse_expansion) {
-    motion_table.state_space = std::make_unique<ompl::base::DubinsStateSpace>(
-      search_info.minimum_turning_radius);
-  } else {
-    motion_table.state_space = std::make_unique<ompl::base::ReedsSheppStateSpace>(
-      search_info.minimum_turning_radius);
-  }
-  motion_table.lattice_metadata =
+  search_state->motion_table.analytic_curve = AnalyticCurve(
+    search_info.allow_reverse_expansion, search_info.minimum_turning_radius);
+  search_state->motion_table.lattice_metadata =
     LatticeMotionTable::getLatticeMetadata(search_info.lattice_filepath);
 
-  ompl::base::ScopedState<> from(motion_table.state_space), to(motion_table.state_space);
-  to[0] = 0.0;
-  to[1] = 0.0;
-  to[2] = 0.0;
-  size_lookup = lookup_table_dim;
+  search_state->size_lookup = lookup_table_dim;
   float motion_heuristic = 0.0;
   unsigned int index = 0;
   int dim_3_size_int = static_cast<int>(dim_3_size);
 
+  // Reuse a table cached on disk by a previous run with the same parameters
+  std::unique_ptr<DistanceHeuristicCache> cache;
+  if (!search_info.distance_heuristic_cache_directory.empty()) {
+    std::vector<float> heading_angles;
+    for (int heading = 0; heading != dim_3_size_int; heading++) {
+      heading_angles.push_back(search_state->motion_table.getAngleFromBin(heading));
+    }
+    cache = std::make_unique<DistanceHeuristicCache>(
+      search_info.distance_heuristic_cache_directory,
+      search_info.allow_reverse_expansion ? MotionModel::REEDS_SHEPP : MotionModel::DUBIN,
+      search_info.minimum_turning_radius, search_state->size_lookup, heading_angles);
+    if (cache->load(search_state->dist_heuristic_lookup_table)) {
+      return;
+    }
+  }
+
   // Create a lookup table of Dubin/Reeds-Shepp distances in a window around the goal
   // to help drive the search towards admissible approaches. Deu to symmetries in the
   // Heuristic space, we need to only store 2 of the 4 quadrants and simply mirror
   // around the X axis any relative node lookup. This reduces memory overhead and increases
   // the size of a window a platform can store in memory.
-  dist_heuristic_lookup_table.resize(size_lookup * ceil(size_lookup / 2.0) * dim_3_size_int);
+  const float & size_lookup = search_state->size_lookup;
+  LookupTable & lookup_table = search_state->dist_heuristic_lookup_table;
+  lookup_table.resize(size_lookup * ceil(size_lookup / 2.0) * dim_3_size_int);
   for (float x = ceil(-size_lookup / 2.0); x <= floor(size_lookup / 2.0); x += 1.0) {
     for (float y = 0.0; y <= floor(size_lookup / 2.0); y += 1.0) {
       for (int heading = 0; heading != dim_3_size_int; heading++) {
-        from[0] = x;
-        from[1] = y;
-        from[2] = motion_table.getAngleFromBin(heading);
-        motion_heuristic = motion_table.state_space->distance(from(), to());
-        dist_heuristic_lookup_table[index] = motion_heuristic;
+        motion_heuristic = search_state->motion_table.analytic_curve.distance(
+          x, y, search_state->motion_table.getAngleFromBin(heading), 0.0, 0.0, 0.0);
+        lookup_table[index] = motion_heuristic;
         index++;
       }
     }
   }
+
+  // Failing to write the cache only costs recomputing the table on the next start
+  if (cache) {
+    cache->save(lookup_table);
+  }
 }
 
 void NodeLattice::getNeighbors(
@@ -470,8 +583,8 @@ void NodeLattice::getNeighbors(
   bool backwards = false;
   NodePtr neighbor = nullptr;
   Coordinates initial_node_coords, motion_projection;
-  MotionPrimitivePtrs motion_primitives = motion_table.getMotionPrimitives(this);
-  const float & grid_resolution = motion_table.lattice_metadata.grid_resolution;
+  MotionPrimitivePtrs motion_primitives = search_state->motion_table.getMotionPrimitives(this);
+  const float & grid_resolution = search_state->motion_table.lattice_metadata.grid_resolution;
 
   unsigned int direction_change_idx = 1e9;
   for (unsigned int i = 0; i != motion_primitives.size(); i++) {
@@ -504,12 +617,12 @@ void NodeLattice::getNeighbors(
       angle = motion_projection.theta;
       if (i >= direction_change_idx) {
         backwards = true;
-        angle = motion_projection.theta - (motion_table.num_angle_quantization / 2);
+        angle = motion_projection.theta - (search_state->motion_table.num_angle_quantization / 2);
         if (angle < 0) {
-          angle += motion_table.num_angle_quantization;
+          angle += search_state->motion_table.num_angle_quantization;
         }
-        if (angle > motion_table.num_angle_quantization) {
-          angle -= motion_table.num_angle_quantization;
+        if (angle > search_state->motion_table.num_angle_quantization) {
+          angle -= search_state->motion_table.num_angle_quantization;
         }
       }
 
@@ -520,10 +633,12 @@ void NodeLattice::getNeighbors(
           angle));
 
       // Using a special isNodeValid API here, giving the motion primitive to use to
-      // validity check the transition of the current node to the new node over
-      if (neighbor->isNodeValid(
-          traverse_unknown, collision_checker, motion_primitives[i], backwards))
-      {
+      // validity check the transition of the current node to the new node over.
+      // With lazy collision checking, the transition is only checked once expanded.
+      const bool is_valid = search_state->motion_table.lazy_collision_checking ?
+        neighbor->isNodeCenterValid(traverse_unknown, collision_checker) :
+        neighbor->isNodeValid(traverse_unknown, collision_checker, motion_primitives[i], backwards);
+      if (is_valid) {
         neighbor->setMotionPrimitive(motion_primitives[i]);
         // Marking if this search was obtained in the reverse direction
         neighbor->backwards(backwards);
@@ -544,7 +659,8 @@ bool NodeLattice::backtracePath(CoordinateVector & path)
   Coordinates initial_pose, prim_pose;
   NodePtr current_node = this;
   MotionPrimitive * prim = nullptr;
-  const float & grid_resolution = NodeLattice::motion_table.lattice_metadata.grid_resolution;
+  LatticeMotionTable & motion_table = search_state->motion_table;
+  const float & grid_resolution = motion_table.lattice_metadata.grid_resolution;
   const float pi_2 = 2.0 * M_PI;
 
   while (current_node->parent) {
@@ -554,7 +670,7 @@ bool NodeLattice::backtracePath(CoordinateVector & path)
     if (prim) {
       initial_pose.x = current_node->pose.x - (prim->poses.back()._x / grid_resolution);
       initial_pose.y = current_node->pose.y - (prim->poses.back()._y / grid_resolution);
-      initial_pose.theta = NodeLattice::motion_table.getAngleFromBin(prim->start_angle);
+      initial_pose.theta = motion_table.getAngleFromBin(prim->start_angle);
 
       for (auto it = prim->poses.crbegin(); it != prim->poses.crend(); ++it) {
         // Convert primitive pose into grid space if it should be checked
@@ -572,7 +688,7 @@ bool NodeLattice::backtracePath(CoordinateVector & path)
     } else {
       // For analytic expansion nodes where there is no valid motion primitive
       path.push_back(current_node->pose);
-      path.back().theta = NodeLattice::motion_table.getAngleFromBin(path.back().theta);
+      path.back().theta = motion_table.getAngleFromBin(path.back().theta);
     }
 
     current_node = current_node->parent;
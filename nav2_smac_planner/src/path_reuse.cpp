@@ -0,0 +1,129 @@
+// Copyright (c) 2021, Samsung Research America
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License. Reserved.
+
+#include <cmath>
+#include <limits>
+
+#include "nav2_smac_planner/path_reuse.hpp"
+#include "angles/angles.h"
+#include "tf2/utils.h"
+
+namespace nav2_smac_planner
+{
+
+PathReuse::PathReuse(const double & max_deviation, const double & repair_margin)
+: max_deviation_(max_deviation),
+  repair_margin_(repair_margin)
+{
+}
+
+void PathReuse::setPlan(
+  const nav_msgs::msg::Path & plan,
+  const geometry_msgs::msg::PoseStamped & goal)
+{
+  plan_ = plan;
+  goal_ = goal;
+}
+
+void PathReuse::clear()
+{
+  plan_.poses.clear();
+}
+
+bool PathReuse::findReusablePath(
+  const geometry_msgs::msg::PoseStamped & start,
+  const geometry_msgs::msg::PoseStamped & goal,
+  const CollisionChecker & in_collision,
+  nav_msgs::msg::Path & plan,
+  unsigned int & repair_start,
+  unsigned int & repair_end)
+{
+  if (plan_.poses.empty() || goal.header.frame_id != goal_.header.frame_id ||
+    std::hypot(
+      goal.pose.position.x - goal_.pose.position.x,
+      goal.pose.position.y - goal_.pose.position.y) > 1e-3 ||
+    std::fabs(
+      angles::shortest_angular_distance(
+        tf2::getYaw(goal.pose.orientation), tf2::getYaw(goal_.pose.orientation))) > 1e-3)
+  {
+    return false;
+  }
+
+  // Pose of the last plan closest to the start, which must still be close to it
+  unsigned int closest = 0;
+  double closest_distance = std::numeric_limits<double>::max();
+  for (unsigned int i = 0; i != plan_.poses.size(); i++) {
+    const double distance = std::hypot(
+      plan_.poses[i].pose.position.x - start.pose.position.x,
+      plan_.poses[i].pose.position.y - start.pose.position.y);
+    if (distance < closest_distance) {
+      closest_distance = distance;
+      closest = i;
+    }
+  }
+  if (closest_distance > max_deviation_ ||
+    std::fabs(
+      angles::shortest_angular_distance(
+        tf2::getYaw(start.pose.orientation),
+        tf2::getYaw(plan_.poses[closest].pose.orientation))) > M_PI_4)
+  {
+    return false;
+  }
+
+  // Find the poses now in collision, the ends of the plan must not be to repair the rest
+  const unsigned int size = plan_.poses.size() - closest;
+  unsigned int first_collision = size;
+  unsigned int last_collision = size;
+  for (unsigned int i = 0; i != size; i++) {
+    if (in_collision(plan_.poses[closest + i].pose)) {
+      if (first_collision == size) {
+        first_collision = i;
+      }
+      last_collision = i;
+    }
+  }
+  if (first_collision == 0 || last_collision == size - 1) {
+    return false;
+  }
+
+  plan.header = plan_.header;
+  plan.poses.assign(plan_.poses.begin() + closest, plan_.poses.end());
+  if (first_collision == size) {
+    repair_start = 0;
+    repair_end = 0;
+    return true;
+  }
+
+  // Replan the poses in collision and the margin around them
+  auto distance = [&plan](const unsigned int & i, const unsigned int & j) {
+      return std::hypot(
+        plan.poses[i].pose.position.x - plan.poses[j].pose.position.x,
+        plan.poses[i].pose.position.y - plan.poses[j].pose.position.y);
+    };
+  double margin = 0.0;
+  repair_start = first_collision - 1;
+  while (repair_start > 0 && margin < repair_margin_) {
+    margin += distance(repair_start, repair_start - 1);
+    repair_start--;
+  }
+  margin = 0.0;
+  repair_end = last_collision + 1;
+  while (repair_end < size - 1 && margin < repair_margin_) {
+    margin += distance(repair_end, repair_end + 1);
+    repair_end++;
+  }
+  return true;
+}
+
+}  // namespace nav2_smac_planner
@@ -34,6 +34,8 @@ SmacPlanner2D::SmacPlanner2D()
   _collision_checker(nullptr, 1),
   _smoother(nullptr),
   _costmap(nullptr),
+  _costmap_pyramid(nullptr),
+  _layered_costmap(nullptr),
   _costmap_downsampler(nullptr)
 {
 }
@@ -55,6 +57,9 @@ void SmacPlanner2D::configure(
   _logger = node->get_logger();
   _clock = node->get_clock();
   _costmap = costmap_ros->getCostmap();
+  _costmap_pyramid = &costmap_ros->getLayeredCostmap()->getCostmapPyramid();
+  _layered_costmap = costmap_ros->getLayeredCostmap();
+  _costmap_ros = costmap_ros;
   _name = name;
   _global_frame = costmap_ros->getGlobalFrameID();
 
@@ -86,6 +91,34 @@ void SmacPlanner2D::configure(
   nav2_util::declare_parameter_if_not_declared(
     node, name + ".use_final_approach_orientation", rclcpp::ParameterValue(false));
   node->get_parameter(name + ".use_final_approach_orientation", _use_final_approach_orientation);
+  nav2_util::declare_parameter_if_not_declared(
+    node, name + ".use_dense_graph", rclcpp::ParameterValue(false));
+  node->get_parameter(name + ".use_dense_graph", _search_info.use_dense_graph);
+  nav2_util::declare_parameter_if_not_declared(
+    node, name + ".use_indexed_heap", rclcpp::ParameterValue(false));
+  node->get_parameter(name + ".use_indexed_heap", _search_info.use_indexed_heap);
+  nav2_util::declare_parameter_if_not_declared(
+    node, name + ".use_anytime_search", rclcpp::ParameterValue(false));
+  node->get_parameter(name + ".use_anytime_search", _search_info.use_anytime_search);
+  nav2_util::declare_parameter_if_not_declared(
+    node, name + ".anytime_initial_weight", rclcpp::ParameterValue(3.0));
+  node->get_parameter(name + ".anytime_initial_weight", _search_info.anytime_initial_weight);
+  nav2_util::declare_parameter_if_not_declared(
+    node, name + ".anytime_weight_decrement", rclcpp::ParameterValue(0.5));
+  node->get_parameter(name + ".anytime_weight_decrement", _search_info.anytime_weight_decrement);
+  nav2_util::declare_parameter_if_not_declared(
+    node, name + ".anytime_target_bound", rclcpp::ParameterValue(1.0));
+  node->get_parameter(name + ".anytime_target_bound", _search_info.anytime_target_bound);
+  nav2_util::declare_parameter_if_not_declared(
+    node, name + ".use_bidirectional_search", rclcpp::ParameterValue(false));
+  node->get_parameter(name + ".use_bidirectional_search", _search_info.use_bidirectional_search);
+  nav2_util::declare_parameter_if_not_declared(
+    node, name + ".parallel_bidirectional_search", rclcpp::ParameterValue(false));
+  node->get_parameter(
+    name + ".parallel_bidirectional_search", _search_info.parallel_bidirectional_search);
+  nav2_util::declare_parameter_if_not_declared(
+    node, name + ".use_jump_point_search", rclcpp::ParameterValue(false));
+  node->get_parameter(name + ".use_jump_point_search", _search_info.use_jump_point_search);
 
   nav2_util::declare_parameter_if_not_declared(
     node, name + ".max_planning_time", rclcpp::ParameterValue(2.0));
@@ -103,6 +136,12 @@ void SmacPlanner2D::configure(
       _motion_model_for_search.c_str());
   }
 
+  if (_search_info.use_jump_point_search && _motion_model != MotionModel::MOORE) {
+    RCLCPP_WARN(
+      _logger, "Jump point search requires the MOORE motion model, disabling it.");
+    _search_info.use_jump_point_search = false;
+  }
+
   if (_max_on_approach_iterations <= 0) {
     RCLCPP_INFO(
       _logger, "On approach iteration selected as <= 0, "
@@ -147,10 +186,16 @@ void SmacPlanner2D::configure(
     _costmap_downsampler = std::make_unique<CostmapDownsampler>();
     _costmap_downsampler->on_configure(
       node, _global_frame, topic_name, _costmap, _downsampling_factor);
+    _costmap_downsampler->setCostmapPyramid(_costmap_pyramid);
+    _costmap_downsampler->setLayeredCostmap(_layered_costmap);
   }
 
   _raw_plan_publisher = node->create_publisher<nav_msgs::msg::Path>("unsmoothed_plan", 1);
 
+  // Account the memory of the search, reported with the instrumentation of the server
+  _graph_memory = std::make_unique<nav2_util::MemoryAccount>(
+    std::string(node->get_name()) + "." + _name + ".graph");
+
   RCLCPP_INFO(
     _logger, "Configured plugin %s of type SmacPlanner2D with "
     "tolerance %.2f, maximum iterations %i, "
@@ -199,26 +244,44 @@ void SmacPlanner2D::cleanup()
     _costmap_downsampler.reset();
   }
   _raw_plan_publisher.reset();
+  _graph_memory.reset();
 }
 
 nav_msgs::msg::Path SmacPlanner2D::createPlan(
   const geometry_msgs::msg::PoseStamped & start,
   const geometry_msgs::msg::PoseStamped & goal)
+{
+  return createPlan(start, goal, std::function<bool()>());
+}
+
+nav_msgs::msg::Path SmacPlanner2D::createPlan(
+  const geometry_msgs::msg::PoseStamped & start,
+  const geometry_msgs::msg::PoseStamped & goal,
+  std::function<bool()> cancel_checker)
 {
   std::lock_guard<std::mutex> lock_reinit(_mutex);
   steady_clock::time_point a = steady_clock::now();
 
   std::unique_lock<nav2_costmap_2d::Costmap2D::mutex_t> lock(*(_costmap->getMutex()));
 
-  // Downsample costmap, if required
-  nav2_costmap_2d::Costmap2D * costmap = _costmap;
+  // Plan on the downsampled costmap, which only this planner writes, or else on a snapshot
+  // of the master costmap, so that the costmap is only locked while they are taken rather
+  // than holding off its updates for the whole search
+  std::shared_ptr<const nav2_costmap_2d::Costmap2D> snapshot;
+  nav2_costmap_2d::Costmap2D * costmap;
   if (_costmap_downsampler) {
     costmap = _costmap_downsampler->downsample(_downsampling_factor);
-    _collision_checker.setCostmap(costmap);
+  } else {
+    snapshot = _costmap_ros->getCostmapSnapshot();
+    // The snapshot is only read by the search, which takes mutable costmaps
+    costmap = const_cast<nav2_costmap_2d::Costmap2D *>(snapshot.get());
   }
+  _collision_checker.setCostmap(costmap);
+  lock.unlock();
 
   // Set collision checker and costmap information
   _a_star->setCollisionChecker(&_collision_checker);
+  _a_star->setCancelChecker(cancel_checker);
 
   // Set starting point
   unsigned int mx_start, my_start, mx_goal, my_goal;
@@ -266,7 +329,9 @@ nav_msgs::msg::Path SmacPlanner2D::createPlan(
     if (!_a_star->createPath(
         path, num_iterations, _tolerance / static_cast<float>(costmap->getResolution())))
     {
-      if (num_iterations < _a_star->getMaxIterations()) {
+      if (cancel_checker && cancel_checker()) {
+        error = std::string("cancelled");
+      } else if (num_iterations < _a_star->getMaxIterations()) {
         error = std::string("no valid path found");
       } else {
         error = std::string("exceeded maximum iterations");
@@ -276,6 +341,7 @@ nav_msgs::msg::Path SmacPlanner2D::createPlan(
     error = "invalid use: ";
     error += e.what();
   }
+  updateMemoryAccounts();
 
   if (!error.empty()) {
     RCLCPP_WARN(
@@ -336,6 +402,11 @@ nav_msgs::msg::Path SmacPlanner2D::createPlan(
   return plan;
 }
 
+void SmacPlanner2D::updateMemoryAccounts()
+{
+  _graph_memory->set(_a_star->getGraphMemoryUsage());
+}
+
 rcl_interfaces::msg::SetParametersResult
 SmacPlanner2D::dynamicParametersCallback(std::vector<rclcpp::Parameter> parameters)
 {
@@ -358,6 +429,15 @@ SmacPlanner2D::dynamicParametersCallback(std::vector<rclcpp::Parameter> paramete
       } else if (name == _name + ".max_planning_time") {
         reinit_a_star = true;
         _max_planning_time = parameter.as_double();
+      } else if (name == _name + ".anytime_initial_weight") {
+        reinit_a_star = true;
+        _search_info.anytime_initial_weight = static_cast<float>(parameter.as_double());
+      } else if (name == _name + ".anytime_weight_decrement") {
+        reinit_a_star = true;
+        _search_info.anytime_weight_decrement = static_cast<float>(parameter.as_double());
+      } else if (name == _name + ".anytime_target_bound") {
+        reinit_a_star = true;
+        _search_info.anytime_target_bound = static_cast<float>(parameter.as_double());
       }
     } else if (type == ParameterType::PARAMETER_BOOL) {
       if (name == _name + ".downsample_costmap") {
@@ -368,6 +448,24 @@ SmacPlanner2D::dynamicParametersCallback(std::vector<rclcpp::Parameter> paramete
         _allow_unknown = parameter.as_bool();
       } else if (name == _name + ".use_final_approach_orientation") {
         _use_final_approach_orientation = parameter.as_bool();
+      } else if (name == _name + ".use_dense_graph") {
+        reinit_a_star = true;
+        _search_info.use_dense_graph = parameter.as_bool();
+      } else if (name == _name + ".use_indexed_heap") {
+        reinit_a_star = true;
+        _search_info.use_indexed_heap = parameter.as_bool();
+      } else if (name == _name + ".use_anytime_search") {
+        reinit_a_star = true;
+        _search_info.use_anytime_search = parameter.as_bool();
+      } else if (name == _name + ".use_bidirectional_search") {
+        reinit_a_star = true;
+        _search_info.use_bidirectional_search = parameter.as_bool();
+      } else if (name == _name + ".parallel_bidirectional_search") {
+        reinit_a_star = true;
+        _search_info.parallel_bidirectional_search = parameter.as_bool();
+      } else if (name == _name + ".use_jump_point_search") {
+        reinit_a_star = true;
+        _search_info.use_jump_point_search = parameter.as_bool();
       }
     } else if (type == ParameterType::PARAMETER_INTEGER) {
       if (name == _name + ".downsampling_factor") {
@@ -429,6 +527,8 @@ SmacPlanner2D::dynamicParametersCallback(std::vector<rclcpp::Parameter> paramete
         _costmap_downsampler = std::make_unique<CostmapDownsampler>();
         _costmap_downsampler->on_configure(
           node, _global_frame, topic_name, _costmap, _downsampling_factor);
+        _costmap_downsampler->setCostmapPyramid(_costmap_pyramid);
+        _costmap_downsampler->setLayeredCostmap(_layered_costmap);
       }
     }
   }
@@ -17,6 +17,7 @@
 #include <vector>
 #include <algorithm>
 #include <limits>
+#include <cmath>
 
 #include "Eigen/Core"
 #include "nav2_smac_planner/smac_planner_hybrid.hpp"
@@ -34,8 +35,12 @@ SmacPlannerHybrid::SmacPlannerHybrid()
 : _a_star(nullptr),
   _collision_checker(nullptr, 1),
   _smoother(nullptr),
+  _path_reuse(nullptr),
   _costmap(nullptr),
-  _costmap_downsampler(nullptr)
+  _costmap_downsampler(nullptr),
+  _corridor_a_star(nullptr),
+  _corridor_collision_checker(nullptr, 1),
+  _corridor_downsampler(nullptr)
 {
 }
 
@@ -73,6 +78,15 @@ void SmacPlannerHybrid::configure(
   nav2_util::declare_parameter_if_not_declared(
     node, name + ".downsampling_factor", rclcpp::ParameterValue(1));
   node->get_parameter(name + ".downsampling_factor", _downsampling_factor);
+  nav2_util::declare_parameter_if_not_declared(
+    node, name + ".corridor_search", rclcpp::ParameterValue(false));
+  node->get_parameter(name + ".corridor_search", _corridor_search);
+  nav2_util::declare_parameter_if_not_declared(
+    node, name + ".corridor_downsampling_factor", rclcpp::ParameterValue(4));
+  node->get_parameter(name + ".corridor_downsampling_factor", _corridor_downsampling_factor);
+  nav2_util::declare_parameter_if_not_declared(
+    node, name + ".corridor_radius", rclcpp::ParameterValue(2.0));
+  node->get_parameter(name + ".corridor_radius", _corridor_radius);
 
   nav2_util::declare_parameter_if_not_declared(
     node, name + ".angle_quantization_bins", rclcpp::ParameterValue(72));
@@ -83,12 +97,24 @@ void SmacPlannerHybrid::configure(
   nav2_util::declare_parameter_if_not_declared(
     node, name + ".allow_unknown", rclcpp::ParameterValue(true));
   node->get_parameter(name + ".allow_unknown", _allow_unknown);
+  nav2_util::declare_parameter_if_not_declared(
+    node, name + ".rasterize_footprint", rclcpp::ParameterValue(false));
+  node->get_parameter(name + ".rasterize_footprint", _rasterize_footprint);
   nav2_util::declare_parameter_if_not_declared(
     node, name + ".max_iterations", rclcpp::ParameterValue(1000000));
   node->get_parameter(name + ".max_iterations", _max_iterations);
   nav2_util::declare_parameter_if_not_declared(
     node, name + ".smooth_path", rclcpp::ParameterValue(true));
   node->get_parameter(name + ".smooth_path", smooth_path);
+  nav2_util::declare_parameter_if_not_declared(
+    node, name + ".reuse_path", rclcpp::ParameterValue(false));
+  node->get_parameter(name + ".reuse_path", _reuse_path);
+  nav2_util::declare_parameter_if_not_declared(
+    node, name + ".reuse_path_max_deviation", rclcpp::ParameterValue(0.5));
+  node->get_parameter(name + ".reuse_path_max_deviation", _reuse_path_max_deviation);
+  nav2_util::declare_parameter_if_not_declared(
+    node, name + ".reuse_path_repair_margin", rclcpp::ParameterValue(1.0));
+  node->get_parameter(name + ".reuse_path_repair_margin", _reuse_path_repair_margin);
 
   nav2_util::declare_parameter_if_not_declared(
     node, name + ".minimum_turning_radius", rclcpp::ParameterValue(0.4));
@@ -96,6 +122,49 @@ void SmacPlannerHybrid::configure(
   nav2_util::declare_parameter_if_not_declared(
     node, name + ".cache_obstacle_heuristic", rclcpp::ParameterValue(false));
   node->get_parameter(name + ".cache_obstacle_heuristic", _search_info.cache_obstacle_heuristic);
+  nav2_util::declare_parameter_if_not_declared(
+    node, name + ".use_indexed_heap", rclcpp::ParameterValue(false));
+  node->get_parameter(name + ".use_indexed_heap", _search_info.use_indexed_heap);
+  nav2_util::declare_parameter_if_not_declared(
+    node, name + ".obstacle_heuristic_threads", rclcpp::ParameterValue(1));
+  node->get_parameter(
+    name + ".obstacle_heuristic_threads", _search_info.obstacle_heuristic_threads);
+  nav2_util::declare_parameter_if_not_declared(
+    node, name + ".obstacle_heuristic_neighborhood", rclcpp::ParameterValue(8));
+  node->get_parameter(
+    name + ".obstacle_heuristic_neighborhood", _search_info.obstacle_heuristic_neighborhood);
+  if (_search_info.obstacle_heuristic_neighborhood != 4 &&
+    _search_info.obstacle_heuristic_neighborhood != 8 &&
+    _search_info.obstacle_heuristic_neighborhood != 16)
+  {
+    RCLCPP_WARN(
+      _logger,
+      "Unsupported obstacle heuristic neighborhood %d, valid options are 4, 8 and 16. "
+      "Using 8.", _search_info.obstacle_heuristic_neighborhood);
+    _search_info.obstacle_heuristic_neighborhood = 8;
+  }
+  nav2_util::declare_parameter_if_not_declared(
+    node, name + ".use_anytime_search", rclcpp::ParameterValue(false));
+  node->get_parameter(name + ".use_anytime_search", _search_info.use_anytime_search);
+  nav2_util::declare_parameter_if_not_declared(
+    node, name + ".use_lazy_collision_checking", rclcpp::ParameterValue(false));
+  node->get_parameter(
+    name + ".use_lazy_collision_checking", _search_info.use_lazy_collision_checking);
+  nav2_util::declare_parameter_if_not_declared(
+    node, name + ".expansion_batch_size", rclcpp::ParameterValue(1));
+  node->get_parameter(name + ".expansion_batch_size", _search_info.expansion_batch_size);
+  nav2_util::declare_parameter_if_not_declared(
+    node, name + ".expansion_threads", rclcpp::ParameterValue(1));
+  node->get_parameter(name + ".expansion_threads", _search_info.expansion_threads);
+  nav2_util::declare_parameter_if_not_declared(
+    node, name + ".anytime_initial_weight", rclcpp::ParameterValue(3.0));
+  node->get_parameter(name + ".anytime_initial_weight", _search_info.anytime_initial_weight);
+  nav2_util::declare_parameter_if_not_declared(
+    node, name + ".anytime_weight_decrement", rclcpp::ParameterValue(0.5));
+  node->get_parameter(name + ".anytime_weight_decrement", _search_info.anytime_weight_decrement);
+  nav2_util::declare_parameter_if_not_declared(
+    node, name + ".anytime_target_bound", rclcpp::ParameterValue(1.0));
+  node->get_parameter(name + ".anytime_target_bound", _search_info.anytime_target_bound);
   nav2_util::declare_parameter_if_not_declared(
     node, name + ".reverse_penalty", rclcpp::ParameterValue(2.0));
   node->get_parameter(name + ".reverse_penalty", _search_info.reverse_penalty);
@@ -126,6 +195,10 @@ void SmacPlannerHybrid::configure(
   nav2_util::declare_parameter_if_not_declared(
     node, name + ".lookup_table_size", rclcpp::ParameterValue(20.0));
   node->get_parameter(name + ".lookup_table_size", _lookup_table_size);
+  nav2_util::declare_parameter_if_not_declared(
+    node, name + ".distance_heuristic_cache_directory", rclcpp::ParameterValue(std::string("")));
+  node->get_parameter(
+    name + ".distance_heuristic_cache_directory", _search_info.distance_heuristic_cache_directory);
 
   nav2_util::declare_parameter_if_not_declared(
     node, name + ".motion_model_for_search", rclcpp::ParameterValue(std::string("DUBIN")));
@@ -169,11 +242,13 @@ void SmacPlannerHybrid::configure(
   }
 
   // Initialize collision checker
-  _collision_checker = GridCollisionChecker(_costmap, _angle_quantizations);
+  _collision_checker = GridCollisionChecker(
+    _costmap, _angle_quantizations, _rasterize_footprint);
   _collision_checker.setFootprint(
-    _costmap_ros->getRobotFootprint(),
+    _costmap_ros->getFootprintGeometry(),
     _costmap_ros->getUseRadius(),
     findCircumscribedCost(_costmap_ros));
+  _footprint_version = _costmap_ros->getFootprintGeometry()->getVersion();
 
   // Initialize A* template
   _a_star = std::make_unique<AStarAlgorithm<NodeHybrid>>(_motion_model, _search_info);
@@ -193,16 +268,34 @@ void SmacPlannerHybrid::configure(
     _smoother->initialize(_minimum_turning_radius_global_coords);
   }
 
+  // Initialize reuse of the last plan
+  if (_reuse_path) {
+    _path_reuse = std::make_unique<PathReuse>(
+      _reuse_path_max_deviation, _reuse_path_repair_margin);
+  }
+
   // Initialize costmap downsampler
   if (_downsample_costmap && _downsampling_factor > 1) {
     _costmap_downsampler = std::make_unique<CostmapDownsampler>();
     std::string topic_name = "downsampled_costmap";
     _costmap_downsampler->on_configure(
       node, _global_frame, topic_name, _costmap, _downsampling_factor);
+    _costmap_downsampler->setCostmapPyramid(
+      &_costmap_ros->getLayeredCostmap()->getCostmapPyramid());
+    _costmap_downsampler->setLayeredCostmap(_costmap_ros->getLayeredCostmap());
   }
 
+  // Initialize coarse search of corridors
+  initializeCorridorSearch();
+
   _raw_plan_publisher = node->create_publisher<nav_msgs::msg::Path>("unsmoothed_plan", 1);
 
+  // Account the memory of the search, reported with the instrumentation of the server
+  _graph_memory = std::make_unique<nav2_util::MemoryAccount>(
+    std::string(node->get_name()) + "." + _name + ".graph");
+  _lookup_table_memory = std::make_unique<nav2_util::MemoryAccount>(
+    std::string(node->get_name()) + "." + _name + ".lookup_tables");
+
   RCLCPP_INFO(
     _logger, "Configured plugin %s of type SmacPlannerHybrid with "
     "maximum iterations %i, and %s. Using motion model: %s.",
@@ -220,6 +313,9 @@ void SmacPlannerHybrid::activate()
   if (_costmap_downsampler) {
     _costmap_downsampler->on_activate();
   }
+  if (_corridor_downsampler) {
+    _corridor_downsampler->on_activate();
+  }
   auto node = _node.lock();
   // Add callback for dynamic parameters
   _dyn_params_handler = node->add_on_set_parameters_callback(
@@ -235,6 +331,9 @@ void SmacPlannerHybrid::deactivate()
   if (_costmap_downsampler) {
     _costmap_downsampler->on_deactivate();
   }
+  if (_corridor_downsampler) {
+    _corridor_downsampler->on_deactivate();
+  }
   _dyn_params_handler.reset();
 }
 
@@ -245,35 +344,275 @@ void SmacPlannerHybrid::cleanup()
     _name.c_str());
   _a_star.reset();
   _smoother.reset();
+  _path_reuse.reset();
   if (_costmap_downsampler) {
     _costmap_downsampler->on_cleanup();
     _costmap_downsampler.reset();
   }
+  _corridor_a_star.reset();
+  if (_corridor_downsampler) {
+    _corridor_downsampler->on_cleanup();
+    _corridor_downsampler.reset();
+  }
   _raw_plan_publisher.reset();
+  _graph_memory.reset();
+  _lookup_table_memory.reset();
+}
+
+void SmacPlannerHybrid::initializeCorridorSearch()
+{
+  _corridor_a_star.reset();
+  if (_corridor_downsampler) {
+    _corridor_downsampler->on_cleanup();
+    _corridor_downsampler.reset();
+  }
+  if (!_corridor_search) {
+    return;
+  }
+  if (_corridor_downsampling_factor < 2) {
+    RCLCPP_WARN(
+      _logger, "Corridor downsampling factor of %i does not make the costmap coarser, "
+      "disabling corridor search.", _corridor_downsampling_factor);
+    return;
+  }
+
+  // The coarse costmap keeps the least cost of its cells, not to close narrow passages
+  auto node = _node.lock();
+  std::string topic_name = "corridor_costmap";
+  _corridor_downsampler = std::make_unique<CostmapDownsampler>();
+  _corridor_downsampler->on_configure(
+    node, _global_frame, topic_name, _costmap,
+    _downsampling_factor * _corridor_downsampling_factor, true);
+  _corridor_downsampler->setLayeredCostmap(_costmap_ros->getLayeredCostmap());
+
+  _corridor_collision_checker = GridCollisionChecker(_costmap, 1 /*for 2D, most be 1*/);
+  _corridor_collision_checker.setFootprint(
+    _costmap_ros->getRobotFootprint(),
+    true /*for 2D, most use radius*/,
+    0.0 /*for 2D cost at inscribed isn't relevent*/);
+
+  SearchInfo search_info = _search_info;
+  search_info.use_anytime_search = false;
+  search_info.use_bidirectional_search = false;
+  _corridor_a_star = std::make_unique<AStarAlgorithm<Node2D>>(MotionModel::MOORE, search_info);
+  _corridor_a_star->initialize(
+    _allow_unknown,
+    _max_iterations,
+    std::numeric_limits<int>::max(),
+    _max_planning_time,
+    0.0 /*unused for 2D*/,
+    1 /*for 2D, most be 1*/);
+}
+
+bool SmacPlannerHybrid::findCorridor(
+  nav2_costmap_2d::Costmap2D * costmap,
+  const geometry_msgs::msg::PoseStamped & start,
+  const geometry_msgs::msg::PoseStamped & goal)
+{
+  nav2_costmap_2d::Costmap2D * coarse_costmap = _corridor_collision_checker.getCostmap();
+  // Initializes the Node2D motion model, shared with the other 2D searches like SmacPlanner2D's,
+  // for the coarse costmap. They initialize it again for theirs when next setting their costmap
+  _corridor_a_star->setCollisionChecker(&_corridor_collision_checker);
+  unsigned int coarse_size_x = coarse_costmap->getSizeInCellsX();
+  unsigned int coarse_size_y = coarse_costmap->getSizeInCellsY();
+
+  unsigned int mx_start, my_start, mx_goal, my_goal;
+  if (!coarse_costmap->worldToMap(
+      start.pose.position.x, start.pose.position.y, mx_start, my_start) ||
+    !coarse_costmap->worldToMap(goal.pose.position.x, goal.pose.position.y, mx_goal, my_goal))
+  {
+    return false;
+  }
+  _corridor_a_star->setStart(mx_start, my_start, 0);
+  _corridor_a_star->setGoal(mx_goal, my_goal, 0);
+
+  Node2D::CoordinateVector coarse_path;
+  int num_iterations = 0;
+  try {
+    if (!_corridor_a_star->createPath(coarse_path, num_iterations, 0.0)) {
+      return false;
+    }
+  } catch (const std::runtime_error &) {
+    return false;
+  }
+
+  // Cells of the coarse costmap within the corridor radius of the coarse path
+  const int radius = static_cast<int>(
+    std::ceil(_corridor_radius / coarse_costmap->getResolution()));
+  const int size_x = static_cast<int>(coarse_size_x);
+  const int size_y = static_cast<int>(coarse_size_y);
+  std::vector<unsigned char> coarse_corridor(coarse_size_x * coarse_size_y, 0);
+  for (const auto & coordinates : coarse_path) {
+    const int x = static_cast<int>(coordinates.x);
+    const int y = static_cast<int>(coordinates.y);
+    for (int j = std::max(y - radius, 0); j <= std::min(y + radius, size_y - 1); ++j) {
+      for (int i = std::max(x - radius, 0); i <= std::min(x + radius, size_x - 1); ++i) {
+        if ((i - x) * (i - x) + (j - y) * (j - y) <= radius * radius) {
+          coarse_corridor[i + j * size_x] = 1;
+        }
+      }
+    }
+  }
+
+  // Cells of the costmap planned on within the coarse cells of the corridor
+  const unsigned int factor = static_cast<unsigned int>(_corridor_downsampling_factor);
+  const unsigned int fine_size_x = costmap->getSizeInCellsX();
+  const unsigned int fine_size_y = costmap->getSizeInCellsY();
+  _corridor.assign(fine_size_x * fine_size_y, 0);
+  for (unsigned int j = 0; j < fine_size_y; ++j) {
+    const unsigned char * coarse_row = &coarse_corridor[(j / factor) * coarse_size_x];
+    unsigned char * row = &_corridor[j * fine_size_x];
+    for (unsigned int i = 0; i < fine_size_x; ++i) {
+      row[i] = coarse_row[i / factor];
+    }
+  }
+  return true;
 }
 
 nav_msgs::msg::Path SmacPlannerHybrid::createPlan(
   const geometry_msgs::msg::PoseStamped & start,
   const geometry_msgs::msg::PoseStamped & goal)
+{
+  return createPlan(start, goal, std::function<bool()>());
+}
+
+nav_msgs::msg::Path SmacPlannerHybrid::createPlan(
+  const geometry_msgs::msg::PoseStamped & start,
+  const geometry_msgs::msg::PoseStamped & goal,
+  std::function<bool()> cancel_checker)
 {
   std::lock_guard<std::mutex> lock_reinit(_mutex);
   steady_clock::time_point a = steady_clock::now();
 
   std::unique_lock<nav2_costmap_2d::Costmap2D::mutex_t> lock(*(_costmap->getMutex()));
 
-  // Downsample costmap, if required
-  nav2_costmap_2d::Costmap2D * costmap = _costmap;
+  // Follow the footprint changed since, the orientation bins being shared in its geometry
+  auto footprint_geometry = _costmap_ros->getFootprintGeometry();
+  if (footprint_geometry->getVersion() != _footprint_version) {
+    _collision_checker.setFootprint(
+      footprint_geometry, _costmap_ros->getUseRadius(), findCircumscribedCost(_costmap_ros));
+    _footprint_version = footprint_geometry->getVersion();
+  }
+
+  // Plan on the downsampled costmap, which only this planner writes, or else on a snapshot
+  // of the master costmap, so that the costmap is only locked while they are taken rather
+  // than holding off its updates for the whole search
+  std::shared_ptr<const nav2_costmap_2d::Costmap2D> snapshot;
+  nav2_costmap_2d::Costmap2D * costmap;
   if (_costmap_downsampler) {
     costmap = _costmap_downsampler->downsample(_downsampling_factor);
-    _collision_checker.setCostmap(costmap);
+  } else {
+    snapshot = _costmap_ros->getCostmapSnapshot();
+    // The snapshot is only read by the search, which takes mutable costmaps
+    costmap = const_cast<nav2_costmap_2d::Costmap2D *>(snapshot.get());
   }
+  _collision_checker.setCostmap(costmap);
+  if (_corridor_a_star) {
+    _corridor_collision_checker.setCostmap(
+      _corridor_downsampler->downsample(_downsampling_factor * _corridor_downsampling_factor));
+  }
+  lock.unlock();
+
+  _a_star->setCancelChecker(cancel_checker);
+  if (_corridor_a_star) {
+    _corridor_a_star->setCancelChecker(cancel_checker);
+  }
+
+  // Setup message
+  nav_msgs::msg::Path plan;
+  plan.header.stamp = _clock->now();
+  plan.header.frame_id = _global_frame;
+
+  // Reuse the last plan to the goal while it is collision-free, only replanning its poses
+  // now in collision
+  std::string error;
+  if (_path_reuse) {
+    auto in_collision = [&, this](const geometry_msgs::msg::Pose & pose) -> bool
+      {
+        unsigned int mx, my;
+        if (!costmap->worldToMap(pose.position.x, pose.position.y, mx, my)) {
+          return true;
+        }
+        double orientation_bin = tf2::getYaw(pose.orientation) / _angle_bin_size;
+        while (orientation_bin < 0.0) {
+          orientation_bin += static_cast<float>(_angle_quantizations);
+        }
+        if (orientation_bin >= static_cast<float>(_angle_quantizations)) {
+          orientation_bin -= static_cast<float>(_angle_quantizations);
+        }
+        return _collision_checker.inCollision(
+          static_cast<float>(mx), static_cast<float>(my),
+          static_cast<float>(floor(orientation_bin)), _allow_unknown);
+      };
+
+    nav_msgs::msg::Path reused_plan;
+    unsigned int repair_start, repair_end;
+    if (_path_reuse->findReusablePath(
+        start, goal, in_collision, reused_plan, repair_start, repair_end))
+    {
+      nav_msgs::msg::Path repair;
+      repair.header = plan.header;
+      if (repair_start == repair_end) {
+        plan.poses = reused_plan.poses;
+      } else if (searchPlan(
+          costmap, reused_plan.poses[repair_start], reused_plan.poses[repair_end], a,
+          cancel_checker, repair, error))
+      {
+        plan.poses.assign(reused_plan.poses.begin(), reused_plan.poses.begin() + repair_start);
+        plan.poses.insert(plan.poses.end(), repair.poses.begin(), repair.poses.end());
+        plan.poses.insert(
+          plan.poses.end(), reused_plan.poses.begin() + repair_end + 1, reused_plan.poses.end());
+      }
+
+      if (!plan.poses.empty()) {
+        for (auto & pose : plan.poses) {
+          pose.header = plan.header;
+        }
+        _path_reuse->setPlan(plan, goal);
+        return plan;
+      }
 
+      RCLCPP_DEBUG(
+        _logger, "%s: failed to repair the last plan, %s, replanning.",
+        _name.c_str(), error.c_str());
+      error.clear();
+    }
+  }
+
+  const bool found = searchPlan(costmap, start, goal, a, cancel_checker, plan, error);
+  updateMemoryAccounts();
+  if (!found) {
+    RCLCPP_WARN(
+      _logger,
+      "%s: failed to create plan, %s.",
+      _name.c_str(), error.c_str());
+    if (_path_reuse) {
+      _path_reuse->clear();
+    }
+    return plan;
+  }
+
+  if (_path_reuse) {
+    _path_reuse->setPlan(plan, goal);
+  }
+  return plan;
+}
+
+bool SmacPlannerHybrid::searchPlan(
+  nav2_costmap_2d::Costmap2D * costmap,
+  const geometry_msgs::msg::PoseStamped & start,
+  const geometry_msgs::msg::PoseStamped & goal,
+  const steady_clock::time_point & start_time,
+  const std::function<bool()> & cancel_checker,
+  nav_msgs::msg::Path & plan,
+  std::string & error)
+{
   // Set collision checker and costmap information
   _a_star->setCollisionChecker(&_collision_checker);
 
   // Set starting point, in A* bin search coordinates
-  unsigned int mx, my;
-  costmap->worldToMap(start.pose.position.x, start.pose.position.y, mx, my);
+  unsigned int mx_start, my_start;
+  costmap->worldToMap(start.pose.position.x, start.pose.position.y, mx_start, my_start);
   double orientation_bin = tf2::getYaw(start.pose.orientation) / _angle_bin_size;
   while (orientation_bin < 0.0) {
     orientation_bin += static_cast<float>(_angle_quantizations);
@@ -282,11 +621,12 @@ nav_msgs::msg::Path SmacPlannerHybrid::createPlan(
   if (orientation_bin >= static_cast<float>(_angle_quantizations)) {
     orientation_bin -= static_cast<float>(_angle_quantizations);
   }
-  unsigned int orientation_bin_id = static_cast<unsigned int>(floor(orientation_bin));
-  _a_star->setStart(mx, my, orientation_bin_id);
+  unsigned int start_bin = static_cast<unsigned int>(floor(orientation_bin));
+  _a_star->setStart(mx_start, my_start, start_bin);
 
   // Set goal point, in A* bin search coordinates
-  costmap->worldToMap(goal.pose.position.x, goal.pose.position.y, mx, my);
+  unsigned int mx_goal, my_goal;
+  costmap->worldToMap(goal.pose.position.x, goal.pose.position.y, mx_goal, my_goal);
   orientation_bin = tf2::getYaw(goal.pose.orientation) / _angle_bin_size;
   while (orientation_bin < 0.0) {
     orientation_bin += static_cast<float>(_angle_quantizations);
@@ -295,13 +635,14 @@ nav_msgs::msg::Path SmacPlannerHybrid::createPlan(
   if (orientation_bin >= static_cast<float>(_angle_quantizations)) {
     orientation_bin -= static_cast<float>(_angle_quantizations);
   }
-  orientation_bin_id = static_cast<unsigned int>(floor(orientation_bin));
-  _a_star->setGoal(mx, my, orientation_bin_id);
+  unsigned int goal_bin = static_cast<unsigned int>(floor(orientation_bin));
+  _a_star->setGoal(mx_goal, my_goal, goal_bin);
+
+  // Restrict the search to a corridor around a coarse 2D path, if enabled
+  bool corridor = _corridor_a_star && findCorridor(costmap, start, goal);
+  _a_star->setCorridor(corridor ? &_corridor : nullptr);
 
   // Setup message
-  nav_msgs::msg::Path plan;
-  plan.header.stamp = _clock->now();
-  plan.header.frame_id = _global_frame;
   geometry_msgs::msg::PoseStamped pose;
   pose.header = plan.header;
   pose.pose.position.z = 0.0;
@@ -313,10 +654,29 @@ nav_msgs::msg::Path SmacPlannerHybrid::createPlan(
   // Compute plan
   NodeHybrid::CoordinateVector path;
   int num_iterations = 0;
-  std::string error;
   try {
-    if (!_a_star->createPath(path, num_iterations, 0.0)) {
-      if (num_iterations < _a_star->getMaxIterations()) {
+    bool path_found = _a_star->createPath(path, num_iterations, 0.0);
+
+    // The coarse costmap may let the corridor through passages too narrow for the robot,
+    // so without a path in the corridor, the search is done again on the whole costmap
+    const bool cancelled = !path_found && cancel_checker && cancel_checker();
+    if (!path_found && corridor && !cancelled) {
+      RCLCPP_DEBUG(
+        _logger, "%s: no path found in the corridor, searching the whole costmap.",
+        _name.c_str());
+      _a_star->setCorridor(nullptr);
+      _a_star->setCollisionChecker(&_collision_checker);
+      _a_star->setStart(mx_start, my_start, start_bin);
+      _a_star->setGoal(mx_goal, my_goal, goal_bin);
+      path.clear();
+      num_iterations = 0;
+      path_found = _a_star->createPath(path, num_iterations, 0.0);
+    }
+
+    if (!path_found) {
+      if (cancelled) {
+        error = std::string("cancelled");
+      } else if (num_iterations < _a_star->getMaxIterations()) {
         error = std::string("no valid path found");
       } else {
         error = std::string("exceeded maximum iterations");
@@ -328,11 +688,7 @@ nav_msgs::msg::Path SmacPlannerHybrid::createPlan(
   }
 
   if (!error.empty()) {
-    RCLCPP_WARN(
-      _logger,
-      "%s: failed to create plan, %s.",
-      _name.c_str(), error.c_str());
-    return plan;
+    return false;
   }
 
   // Convert to world coordinates
@@ -350,7 +706,7 @@ nav_msgs::msg::Path SmacPlannerHybrid::createPlan(
 
   // Find how much time we have left to do smoothing
   steady_clock::time_point b = steady_clock::now();
-  duration<double> time_span = duration_cast<duration<double>>(b - a);
+  duration<double> time_span = duration_cast<duration<double>>(b - start_time);
   double time_remaining = _max_planning_time - static_cast<double>(time_span.count());
 
 #ifdef BENCHMARK_TESTING
@@ -370,7 +726,19 @@ nav_msgs::msg::Path SmacPlannerHybrid::createPlan(
     " milliseconds to smooth path." << std::endl;
 #endif
 
-  return plan;
+  return true;
+}
+
+void SmacPlannerHybrid::updateMemoryAccounts()
+{
+  size_t graph_bytes = _a_star->getGraphMemoryUsage();
+  if (_corridor_a_star) {
+    graph_bytes += _corridor_a_star->getGraphMemoryUsage() + _corridor.capacity();
+  }
+  _graph_memory->set(graph_bytes);
+  // The lookup tables are those of the search of this planner
+  SearchStateGuard bind_state(_a_star->getSearchState());
+  _lookup_table_memory->set(NodeHybrid::getLookupTablesMemoryUsage());
 }
 
 rcl_interfaces::msg::SetParametersResult
@@ -383,6 +751,8 @@ SmacPlannerHybrid::dynamicParametersCallback(std::vector<rclcpp::Parameter> para
   bool reinit_a_star = false;
   bool reinit_downsampler = false;
   bool reinit_smoother = false;
+  bool reinit_corridor = false;
+  bool reinit_path_reuse = false;
 
   for (auto parameter : parameters) {
     const auto & type = parameter.get_type();
@@ -420,17 +790,52 @@ SmacPlannerHybrid::dynamicParametersCallback(std::vector<rclcpp::Parameter> para
         reinit_a_star = true;
         _search_info.analytic_expansion_max_length =
           static_cast<float>(parameter.as_double()) / _costmap->getResolution();
+      } else if (name == _name + ".anytime_initial_weight") {
+        reinit_a_star = true;
+        _search_info.anytime_initial_weight = static_cast<float>(parameter.as_double());
+      } else if (name == _name + ".anytime_weight_decrement") {
+        reinit_a_star = true;
+        _search_info.anytime_weight_decrement = static_cast<float>(parameter.as_double());
+      } else if (name == _name + ".anytime_target_bound") {
+        reinit_a_star = true;
+        _search_info.anytime_target_bound = static_cast<float>(parameter.as_double());
+      } else if (name == _name + ".corridor_radius") {
+        _corridor_radius = parameter.as_double();
+      } else if (name == _name + ".reuse_path_max_deviation") {
+        reinit_path_reuse = true;
+        _reuse_path_max_deviation = parameter.as_double();
+      } else if (name == _name + ".reuse_path_repair_margin") {
+        reinit_path_reuse = true;
+        _reuse_path_repair_margin = parameter.as_double();
       }
     } else if (type == ParameterType::PARAMETER_BOOL) {
       if (name == _name + ".downsample_costmap") {
         reinit_downsampler = true;
         _downsample_costmap = parameter.as_bool();
+      } else if (name == _name + ".rasterize_footprint") {
+        reinit_collision_checker = true;
+        _rasterize_footprint = parameter.as_bool();
       } else if (name == _name + ".allow_unknown") {
         reinit_a_star = true;
         _allow_unknown = parameter.as_bool();
       } else if (name == _name + ".cache_obstacle_heuristic") {
         reinit_a_star = true;
         _search_info.cache_obstacle_heuristic = parameter.as_bool();
+      } else if (name == _name + ".use_indexed_heap") {
+        reinit_a_star = true;
+        _search_info.use_indexed_heap = parameter.as_bool();
+      } else if (name == _name + ".use_anytime_search") {
+        reinit_a_star = true;
+        _search_info.use_anytime_search = parameter.as_bool();
+      } else if (name == _name + ".use_lazy_collision_checking") {
+        reinit_a_star = true;
+        _search_info.use_lazy_collision_checking = parameter.as_bool();
+      } else if (name == _name + ".corridor_search") {
+        reinit_corridor = true;
+        _corridor_search = parameter.as_bool();
+      } else if (name == _name + ".reuse_path") {
+        reinit_path_reuse = true;
+        _reuse_path = parameter.as_bool();
       } else if (name == _name + ".smooth_path") {
         if (parameter.as_bool()) {
           reinit_smoother = true;
@@ -458,9 +863,27 @@ SmacPlannerHybrid::dynamicParametersCallback(std::vector<rclcpp::Parameter> para
         int angle_quantizations = parameter.as_int();
         _angle_bin_size = 2.0 * M_PI / angle_quantizations;
         _angle_quantizations = static_cast<unsigned int>(angle_quantizations);
+      } else if (name == _name + ".obstacle_heuristic_threads") {
+        reinit_a_star = true;
+        _search_info.obstacle_heuristic_threads = parameter.as_int();
+      } else if (name == _name + ".obstacle_heuristic_neighborhood") {
+        reinit_a_star = true;
+        _search_info.obstacle_heuristic_neighborhood = parameter.as_int();
+      } else if (name == _name + ".expansion_batch_size") {
+        reinit_a_star = true;
+        _search_info.expansion_batch_size = parameter.as_int();
+      } else if (name == _name + ".expansion_threads") {
+        reinit_a_star = true;
+        _search_info.expansion_threads = parameter.as_int();
+      } else if (name == _name + ".corridor_downsampling_factor") {
+        reinit_corridor = true;
+        _corridor_downsampling_factor = parameter.as_int();
       }
     } else if (type == ParameterType::PARAMETER_STRING) {
-      if (name == _name + ".motion_model_for_search") {
+      if (name == _name + ".distance_heuristic_cache_directory") {
+        reinit_a_star = true;
+        _search_info.distance_heuristic_cache_directory = parameter.as_string();
+      } else if (name == _name + ".motion_model_for_search") {
         reinit_a_star = true;
         _motion_model = fromString(parameter.as_string());
         if (_motion_model == MotionModel::UNKNOWN) {
@@ -474,8 +897,19 @@ SmacPlannerHybrid::dynamicParametersCallback(std::vector<rclcpp::Parameter> para
     }
   }
 
+  // Re-Initialize reuse of the last plan
+  if (reinit_path_reuse) {
+    _path_reuse.reset();
+    if (_reuse_path) {
+      _path_reuse = std::make_unique<PathReuse>(
+        _reuse_path_max_deviation, _reuse_path_repair_margin);
+    }
+  }
+
   // Re-init if needed with mutex lock (to avoid re-init while creating a plan)
-  if (reinit_a_star || reinit_downsampler || reinit_collision_checker || reinit_smoother) {
+  if (reinit_a_star || reinit_downsampler || reinit_collision_checker || reinit_smoother ||
+    reinit_corridor)
+  {
     // convert to grid coordinates
     if (!_downsample_costmap) {
       _downsampling_factor = 1;
@@ -518,16 +952,26 @@ SmacPlannerHybrid::dynamicParametersCallback(std::vector<rclcpp::Parameter> para
         _costmap_downsampler = std::make_unique<CostmapDownsampler>();
         _costmap_downsampler->on_configure(
           node, _global_frame, topic_name, _costmap, _downsampling_factor);
+        _costmap_downsampler->setCostmapPyramid(
+          &_costmap_ros->getLayeredCostmap()->getCostmapPyramid());
+        _costmap_downsampler->setLayeredCostmap(_costmap_ros->getLayeredCostmap());
       }
     }
 
+    // Re-Initialize coarse search of corridors, which follows the A* and downsampling settings
+    if (reinit_a_star || reinit_downsampler || reinit_corridor) {
+      initializeCorridorSearch();
+    }
+
     // Re-Initialize collision checker
     if (reinit_collision_checker) {
-      _collision_checker = GridCollisionChecker(_costmap, _angle_quantizations);
+      _collision_checker = GridCollisionChecker(
+        _costmap, _angle_quantizations, _rasterize_footprint);
       _collision_checker.setFootprint(
-        _costmap_ros->getRobotFootprint(),
+        _costmap_ros->getFootprintGeometry(),
         _costmap_ros->getUseRadius(),
         findCircumscribedCost(_costmap_ros));
+      _footprint_version = _costmap_ros->getFootprintGeometry()->getVersion();
     }
 
     // Re-Initialize smoother
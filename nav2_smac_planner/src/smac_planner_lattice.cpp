@@ -33,6 +33,7 @@ SmacPlannerLattice::SmacPlannerLattice()
 : _a_star(nullptr),
   _collision_checker(nullptr, 1),
   _smoother(nullptr),
+  _path_reuse(nullptr),
   _costmap(nullptr)
 {
 }
@@ -58,6 +59,10 @@ void SmacPlannerLattice::configure(
   _name = name;
   _global_frame = costmap_ros->getGlobalFrameID();
   _raw_plan_publisher = node->create_publisher<nav_msgs::msg::Path>("unsmoothed_plan", 1);
+  _graph_memory = std::make_unique<nav2_util::MemoryAccount>(
+    std::string(node->get_name()) + "." + _name + ".graph");
+  _lookup_table_memory = std::make_unique<nav2_util::MemoryAccount>(
+    std::string(node->get_name()) + "." + _name + ".lookup_tables");
 
   RCLCPP_INFO(_logger, "Configuring %s of type SmacPlannerLattice", name.c_str());
 
@@ -68,12 +73,24 @@ void SmacPlannerLattice::configure(
   nav2_util::declare_parameter_if_not_declared(
     node, name + ".allow_unknown", rclcpp::ParameterValue(true));
   node->get_parameter(name + ".allow_unknown", _allow_unknown);
+  nav2_util::declare_parameter_if_not_declared(
+    node, name + ".rasterize_footprint", rclcpp::ParameterValue(false));
+  node->get_parameter(name + ".rasterize_footprint", _rasterize_footprint);
   nav2_util::declare_parameter_if_not_declared(
     node, name + ".max_iterations", rclcpp::ParameterValue(1000000));
   node->get_parameter(name + ".max_iterations", _max_iterations);
   nav2_util::declare_parameter_if_not_declared(
     node, name + ".smooth_path", rclcpp::ParameterValue(true));
   node->get_parameter(name + ".smooth_path", smooth_path);
+  nav2_util::declare_parameter_if_not_declared(
+    node, name + ".reuse_path", rclcpp::ParameterValue(false));
+  node->get_parameter(name + ".reuse_path", _reuse_path);
+  nav2_util::declare_parameter_if_not_declared(
+    node, name + ".reuse_path_max_deviation", rclcpp::ParameterValue(0.5));
+  node->get_parameter(name + ".reuse_path_max_deviation", _reuse_path_max_deviation);
+  nav2_util::declare_parameter_if_not_declared(
+    node, name + ".reuse_path_repair_margin", rclcpp::ParameterValue(1.0));
+  node->get_parameter(name + ".reuse_path_repair_margin", _reuse_path_repair_margin);
 
   // Default to a well rounded model: 16 bin, 0.4m turning radius, ackermann model
   nav2_util::declare_parameter_if_not_declared(
@@ -84,6 +101,43 @@ void SmacPlannerLattice::configure(
   nav2_util::declare_parameter_if_not_declared(
     node, name + ".cache_obstacle_heuristic", rclcpp::ParameterValue(false));
   node->get_parameter(name + ".cache_obstacle_heuristic", _search_info.cache_obstacle_heuristic);
+  nav2_util::declare_parameter_if_not_declared(
+    node, name + ".use_indexed_heap", rclcpp::ParameterValue(false));
+  node->get_parameter(name + ".use_indexed_heap", _search_info.use_indexed_heap);
+  nav2_util::declare_parameter_if_not_declared(
+    node, name + ".obstacle_heuristic_threads", rclcpp::ParameterValue(1));
+  node->get_parameter(
+    name + ".obstacle_heuristic_threads", _search_info.obstacle_heuristic_threads);
+  nav2_util::declare_parameter_if_not_declared(
+    node, name + ".obstacle_heuristic_neighborhood", rclcpp::ParameterValue(8));
+  node->get_parameter(
+    name + ".obstacle_heuristic_neighborhood", _search_info.obstacle_heuristic_neighborhood);
+  if (_search_info.obstacle_heuristic_neighborhood != 4 &&
+    _search_info.obstacle_heuristic_neighborhood != 8 &&
+    _search_info.obstacle_heuristic_neighborhood != 16)
+  {
+    RCLCPP_WARN(
+      _logger,
+      "Unsupported obstacle heuristic neighborhood %d, valid options are 4, 8 and 16. "
+      "Using 8.", _search_info.obstacle_heuristic_neighborhood);
+    _search_info.obstacle_heuristic_neighborhood = 8;
+  }
+  nav2_util::declare_parameter_if_not_declared(
+    node, name + ".use_anytime_search", rclcpp::ParameterValue(false));
+  node->get_parameter(name + ".use_anytime_search", _search_info.use_anytime_search);
+  nav2_util::declare_parameter_if_not_declared(
+    node, name + ".use_lazy_collision_checking", rclcpp::ParameterValue(false));
+  node->get_parameter(
+    name + ".use_lazy_collision_checking", _search_info.use_lazy_collision_checking);
+  nav2_util::declare_parameter_if_not_declared(
+    node, name + ".anytime_initial_weight", rclcpp::ParameterValue(3.0));
+  node->get_parameter(name + ".anytime_initial_weight", _search_info.anytime_initial_weight);
+  nav2_util::declare_parameter_if_not_declared(
+    node, name + ".anytime_weight_decrement", rclcpp::ParameterValue(0.5));
+  node->get_parameter(name + ".anytime_weight_decrement", _search_info.anytime_weight_decrement);
+  nav2_util::declare_parameter_if_not_declared(
+    node, name + ".anytime_target_bound", rclcpp::ParameterValue(1.0));
+  node->get_parameter(name + ".anytime_target_bound", _search_info.anytime_target_bound);
   nav2_util::declare_parameter_if_not_declared(
     node, name + ".reverse_penalty", rclcpp::ParameterValue(2.0));
   node->get_parameter(name + ".reverse_penalty", _search_info.reverse_penalty);
@@ -117,6 +171,10 @@ void SmacPlannerLattice::configure(
   nav2_util::declare_parameter_if_not_declared(
     node, name + ".lookup_table_size", rclcpp::ParameterValue(20.0));
   node->get_parameter(name + ".lookup_table_size", _lookup_table_size);
+  nav2_util::declare_parameter_if_not_declared(
+    node, name + ".distance_heuristic_cache_directory", rclcpp::ParameterValue(std::string("")));
+  node->get_parameter(
+    name + ".distance_heuristic_cache_directory", _search_info.distance_heuristic_cache_directory);
   nav2_util::declare_parameter_if_not_declared(
     node, name + ".allow_reverse_expansion", rclcpp::ParameterValue(false));
   node->get_parameter(name + ".allow_reverse_expansion", _search_info.allow_reverse_expansion);
@@ -156,11 +214,12 @@ void SmacPlannerLattice::configure(
   // increments causing "wobbly" checks that could cause larger robots to virtually show collisions
   // in valid configurations. This approximation helps to bound orientation error for all checks
   // in exchange for slight inaccuracies in the collision headings in terminal search states.
-  _collision_checker = GridCollisionChecker(_costmap, 72u);
+  _collision_checker = GridCollisionChecker(_costmap, 72u, _rasterize_footprint);
   _collision_checker.setFootprint(
-    costmap_ros->getRobotFootprint(),
+    costmap_ros->getFootprintGeometry(),
     costmap_ros->getUseRadius(),
     findCircumscribedCost(costmap_ros));
+  _footprint_version = costmap_ros->getFootprintGeometry()->getVersion();
 
   // Initialize A* template
   _a_star = std::make_unique<AStarAlgorithm<NodeLattice>>(_motion_model, _search_info);
@@ -180,6 +239,12 @@ void SmacPlannerLattice::configure(
     _smoother->initialize(_metadata.min_turning_radius);
   }
 
+  // Initialize reuse of the last plan
+  if (_reuse_path) {
+    _path_reuse = std::make_unique<PathReuse>(
+      _reuse_path_max_deviation, _reuse_path_repair_margin);
+  }
+
   RCLCPP_INFO(
     _logger, "Configured plugin %s of type SmacPlannerLattice with "
     "maximum iterations %i, "
@@ -217,38 +282,147 @@ void SmacPlannerLattice::cleanup()
     _name.c_str());
   _a_star.reset();
   _smoother.reset();
+  _path_reuse.reset();
   _raw_plan_publisher.reset();
+  _graph_memory.reset();
+  _lookup_table_memory.reset();
 }
 
 nav_msgs::msg::Path SmacPlannerLattice::createPlan(
   const geometry_msgs::msg::PoseStamped & start,
   const geometry_msgs::msg::PoseStamped & goal)
+{
+  return createPlan(start, goal, std::function<bool()>());
+}
+
+nav_msgs::msg::Path SmacPlannerLattice::createPlan(
+  const geometry_msgs::msg::PoseStamped & start,
+  const geometry_msgs::msg::PoseStamped & goal,
+  std::function<bool()> cancel_checker)
 {
   std::lock_guard<std::mutex> lock_reinit(_mutex);
   steady_clock::time_point a = steady_clock::now();
 
   std::unique_lock<nav2_costmap_2d::Costmap2D::mutex_t> lock(*(_costmap->getMutex()));
 
+  // Follow the footprint changed since, the orientation bins being shared in its geometry
+  auto footprint_geometry = _costmap_ros->getFootprintGeometry();
+  if (footprint_geometry->getVersion() != _footprint_version) {
+    _collision_checker.setFootprint(
+      footprint_geometry, _costmap_ros->getUseRadius(), findCircumscribedCost(_costmap_ros));
+    _footprint_version = footprint_geometry->getVersion();
+  }
+
+  // Plan on a snapshot of the costmap, so that the costmap is only locked while it is
+  // taken rather than holding off its updates for the whole search
+  std::shared_ptr<const nav2_costmap_2d::Costmap2D> snapshot = _costmap_ros->getCostmapSnapshot();
+  // The snapshot is only read by the search, which takes mutable costmaps
+  nav2_costmap_2d::Costmap2D * costmap = const_cast<nav2_costmap_2d::Costmap2D *>(snapshot.get());
+  _collision_checker.setCostmap(costmap);
+  lock.unlock();
+
+  _a_star->setCancelChecker(cancel_checker);
+
+  // Setup message
+  nav_msgs::msg::Path plan;
+  plan.header.stamp = _clock->now();
+  plan.header.frame_id = _global_frame;
+
+  // Reuse the last plan to the goal while it is collision-free, only replanning its poses
+  // now in collision
+  std::string error;
+  if (_path_reuse) {
+    auto in_collision = [this, costmap](const geometry_msgs::msg::Pose & pose) -> bool
+      {
+        unsigned int mx, my;
+        if (!costmap->worldToMap(pose.position.x, pose.position.y, mx, my)) {
+          return true;
+        }
+        LatticeMotionTable & motion_table = _a_star->getSearchState().node_lattice.motion_table;
+        return _collision_checker.inCollision(
+          static_cast<float>(mx), static_cast<float>(my),
+          static_cast<float>(motion_table.getClosestAngularBin(tf2::getYaw(pose.orientation))),
+          _allow_unknown);
+      };
+
+    nav_msgs::msg::Path reused_plan;
+    unsigned int repair_start, repair_end;
+    if (_path_reuse->findReusablePath(
+        start, goal, in_collision, reused_plan, repair_start, repair_end))
+    {
+      nav_msgs::msg::Path repair;
+      repair.header = plan.header;
+      if (repair_start == repair_end) {
+        plan.poses = reused_plan.poses;
+      } else if (searchPlan(
+          reused_plan.poses[repair_start], reused_plan.poses[repair_end], a, cancel_checker,
+          repair, error))
+      {
+        plan.poses.assign(reused_plan.poses.begin(), reused_plan.poses.begin() + repair_start);
+        plan.poses.insert(plan.poses.end(), repair.poses.begin(), repair.poses.end());
+        plan.poses.insert(
+          plan.poses.end(), reused_plan.poses.begin() + repair_end + 1, reused_plan.poses.end());
+      }
+
+      if (!plan.poses.empty()) {
+        for (auto & pose : plan.poses) {
+          pose.header = plan.header;
+        }
+        _path_reuse->setPlan(plan, goal);
+        return plan;
+      }
+
+      RCLCPP_DEBUG(
+        _logger, "%s: failed to repair the last plan, %s, replanning.",
+        _name.c_str(), error.c_str());
+      error.clear();
+    }
+  }
+
+  const bool found = searchPlan(start, goal, a, cancel_checker, plan, error);
+  updateMemoryAccounts();
+  if (!found) {
+    RCLCPP_WARN(
+      _logger,
+      "%s: failed to create plan, %s.",
+      _name.c_str(), error.c_str());
+    if (_path_reuse) {
+      _path_reuse->clear();
+    }
+    return plan;
+  }
+
+  if (_path_reuse) {
+    _path_reuse->setPlan(plan, goal);
+  }
+  return plan;
+}
+
+bool SmacPlannerLattice::searchPlan(
+  const geometry_msgs::msg::PoseStamped & start,
+  const geometry_msgs::msg::PoseStamped & goal,
+  const steady_clock::time_point & start_time,
+  const std::function<bool()> & cancel_checker,
+  nav_msgs::msg::Path & plan,
+  std::string & error)
+{
   // Set collision checker and costmap information
   _a_star->setCollisionChecker(&_collision_checker);
+  nav2_costmap_2d::Costmap2D * costmap = _collision_checker.getCostmap();
 
   // Set starting point, in A* bin search coordinates
+  LatticeMotionTable & motion_table = _a_star->getSearchState().node_lattice.motion_table;
   unsigned int mx, my;
-  _costmap->worldToMap(start.pose.position.x, start.pose.position.y, mx, my);
+  costmap->worldToMap(start.pose.position.x, start.pose.position.y, mx, my);
   _a_star->setStart(
-    mx, my,
-    NodeLattice::motion_table.getClosestAngularBin(tf2::getYaw(start.pose.orientation)));
+    mx, my, motion_table.getClosestAngularBin(tf2::getYaw(start.pose.orientation)));
 
   // Set goal point, in A* bin search coordinates
-  _costmap->worldToMap(goal.pose.position.x, goal.pose.position.y, mx, my);
+  costmap->worldToMap(goal.pose.position.x, goal.pose.position.y, mx, my);
   _a_star->setGoal(
-    mx, my,
-    NodeLattice::motion_table.getClosestAngularBin(tf2::getYaw(goal.pose.orientation)));
+    mx, my, motion_table.getClosestAngularBin(tf2::getYaw(goal.pose.orientation)));
 
   // Setup message
-  nav_msgs::msg::Path plan;
-  plan.header.stamp = _clock->now();
-  plan.header.frame_id = _global_frame;
   geometry_msgs::msg::PoseStamped pose;
   pose.header = plan.header;
   pose.pose.position.z = 0.0;
@@ -260,10 +434,11 @@ nav_msgs::msg::Path SmacPlannerLattice::createPlan(
   // Compute plan
   NodeLattice::CoordinateVector path;
   int num_iterations = 0;
-  std::string error;
   try {
     if (!_a_star->createPath(path, num_iterations, 0 /*no tolerance*/)) {
-      if (num_iterations < _a_star->getMaxIterations()) {
+      if (cancel_checker && cancel_checker()) {
+        error = std::string("cancelled");
+      } else if (num_iterations < _a_star->getMaxIterations()) {
         error = std::string("no valid path found");
       } else {
         error = std::string("exceeded maximum iterations");
@@ -275,18 +450,14 @@ nav_msgs::msg::Path SmacPlannerLattice::createPlan(
   }
 
   if (!error.empty()) {
-    RCLCPP_WARN(
-      _logger,
-      "%s: failed to create plan, %s.",
-      _name.c_str(), error.c_str());
-    return plan;
+    return false;
   }
 
   // Convert to world coordinates
   plan.poses.reserve(path.size());
   geometry_msgs::msg::PoseStamped last_pose = pose;
   for (int i = path.size() - 1; i >= 0; --i) {
-    pose.pose = getWorldCoords(path[i].x, path[i].y, _costmap);
+    pose.pose = getWorldCoords(path[i].x, path[i].y, costmap);
     pose.pose.orientation = getWorldOrientation(path[i].theta);
     if (fabs(pose.pose.position.x - last_pose.pose.position.x) < 1e-4 &&
       fabs(pose.pose.position.y - last_pose.pose.position.y) < 1e-4 &&
@@ -309,7 +480,7 @@ nav_msgs::msg::Path SmacPlannerLattice::createPlan(
 
   // Find how much time we have left to do smoothing
   steady_clock::time_point b = steady_clock::now();
-  duration<double> time_span = duration_cast<duration<double>>(b - a);
+  duration<double> time_span = duration_cast<duration<double>>(b - start_time);
   double time_remaining = _max_planning_time - static_cast<double>(time_span.count());
 
 #ifdef BENCHMARK_TESTING
@@ -319,7 +490,7 @@ nav_msgs::msg::Path SmacPlannerLattice::createPlan(
 
   // Smooth plan
   if (_smoother && num_iterations > 1) {
-    _smoother->smooth(plan, _costmap, time_remaining);
+    _smoother->smooth(plan, costmap, time_remaining);
   }
 
 #ifdef BENCHMARK_TESTING
@@ -329,7 +500,15 @@ nav_msgs::msg::Path SmacPlannerLattice::createPlan(
     " milliseconds to smooth path." << std::endl;
 #endif
 
-  return plan;
+  return true;
+}
+
+void SmacPlannerLattice::updateMemoryAccounts()
+{
+  _graph_memory->set(_a_star->getGraphMemoryUsage());
+  // The lookup tables are those of the search of this planner
+  SearchStateGuard bind_state(_a_star->getSearchState());
+  _lookup_table_memory->set(NodeLattice::getLookupTablesMemoryUsage());
 }
 
 rcl_interfaces::msg::SetParametersResult
@@ -340,6 +519,7 @@ SmacPlannerLattice::dynamicParametersCallback(std::vector<rclcpp::Parameter> par
 
   bool reinit_a_star = false;
   bool reinit_smoother = false;
+  bool reinit_path_reuse = false;
 
   for (auto parameter : parameters) {
     const auto & type = parameter.get_type();
@@ -374,6 +554,21 @@ SmacPlannerLattice::dynamicParametersCallback(std::vector<rclcpp::Parameter> par
         reinit_a_star = true;
         _search_info.analytic_expansion_max_length =
           static_cast<float>(parameter.as_double()) / _costmap->getResolution();
+      } else if (name == _name + ".anytime_initial_weight") {
+        reinit_a_star = true;
+        _search_info.anytime_initial_weight = static_cast<float>(parameter.as_double());
+      } else if (name == _name + ".anytime_weight_decrement") {
+        reinit_a_star = true;
+        _search_info.anytime_weight_decrement = static_cast<float>(parameter.as_double());
+      } else if (name == _name + ".anytime_target_bound") {
+        reinit_a_star = true;
+        _search_info.anytime_target_bound = static_cast<float>(parameter.as_double());
+      } else if (name == _name + ".reuse_path_max_deviation") {
+        reinit_path_reuse = true;
+        _reuse_path_max_deviation = parameter.as_double();
+      } else if (name == _name + ".reuse_path_repair_margin") {
+        reinit_path_reuse = true;
+        _reuse_path_repair_margin = parameter.as_double();
       }
     } else if (type == ParameterType::PARAMETER_BOOL) {
       if (name == _name + ".allow_unknown") {
@@ -382,9 +577,21 @@ SmacPlannerLattice::dynamicParametersCallback(std::vector<rclcpp::Parameter> par
       } else if (name == _name + ".cache_obstacle_heuristic") {
         reinit_a_star = true;
         _search_info.cache_obstacle_heuristic = parameter.as_bool();
+      } else if (name == _name + ".use_indexed_heap") {
+        reinit_a_star = true;
+        _search_info.use_indexed_heap = parameter.as_bool();
+      } else if (name == _name + ".use_anytime_search") {
+        reinit_a_star = true;
+        _search_info.use_anytime_search = parameter.as_bool();
+      } else if (name == _name + ".use_lazy_collision_checking") {
+        reinit_a_star = true;
+        _search_info.use_lazy_collision_checking = parameter.as_bool();
       } else if (name == _name + ".allow_reverse_expansion") {
         reinit_a_star = true;
         _search_info.allow_reverse_expansion = parameter.as_bool();
+      } else if (name == _name + ".reuse_path") {
+        reinit_path_reuse = true;
+        _reuse_path = parameter.as_bool();
       } else if (name == _name + ".smooth_path") {
         if (parameter.as_bool()) {
           reinit_smoother = true;
@@ -402,9 +609,18 @@ SmacPlannerLattice::dynamicParametersCallback(std::vector<rclcpp::Parameter> par
             "disabling maximum iterations.");
           _max_iterations = std::numeric_limits<int>::max();
         }
+      } else if (name == _name + ".obstacle_heuristic_threads") {
+        reinit_a_star = true;
+        _search_info.obstacle_heuristic_threads = parameter.as_int();
+      } else if (name == _name + ".obstacle_heuristic_neighborhood") {
+        reinit_a_star = true;
+        _search_info.obstacle_heuristic_neighborhood = parameter.as_int();
       }
     } else if (type == ParameterType::PARAMETER_STRING) {
-      if (name == _name + ".lattice_filepath") {
+      if (name == _name + ".distance_heuristic_cache_directory") {
+        reinit_a_star = true;
+        _search_info.distance_heuristic_cache_directory = parameter.as_string();
+      } else if (name == _name + ".lattice_filepath") {
         reinit_a_star = true;
         if (_smoother) {
           reinit_smoother = true;
@@ -417,6 +633,15 @@ SmacPlannerLattice::dynamicParametersCallback(std::vector<rclcpp::Parameter> par
     }
   }
 
+  // Re-Initialize reuse of the last plan
+  if (reinit_path_reuse) {
+    _path_reuse.reset();
+    if (_reuse_path) {
+      _path_reuse = std::make_unique<PathReuse>(
+        _reuse_path_max_deviation, _reuse_path_repair_margin);
+    }
+  }
+
   // Re-init if needed with mutex lock (to avoid re-init while creating a plan)
   if (reinit_a_star || reinit_smoother) {
     // convert to grid coordinates
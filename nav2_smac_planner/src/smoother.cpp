@@ -12,8 +12,7 @@
 // See the License for the specific language governing permissions and
 // limitations under the License. Reserved.
 
-#include <ompl/base/ScopedState.h>
-#include <ompl/base/spaces/DubinsStateSpace.h>
+#include <algorithm>
 #include <vector>
 #include <memory>
 #include "nav2_smac_planner/smoother.hpp"
@@ -31,12 +30,13 @@ Smoother::Smoother(const SmootherParams & params)
   smooth_w_ = params.w_smooth_;
   is_holonomic_ = params.holonomic_;
   do_refinement_ = params.do_refinement_;
+  segment_smoothing_threads_ = params.segment_smoothing_threads_;
 }
 
 void Smoother::initialize(const double & min_turning_radius)
 {
   min_turning_rad_ = min_turning_radius;
-  state_space_ = std::make_unique<ompl::base::DubinsStateSpace>(min_turning_rad_);
+  analytic_curve_ = AnalyticCurve(false, min_turning_rad_);
 }
 
 bool Smoother::smooth(
@@ -44,39 +44,58 @@ bool Smoother::smooth(
   const nav2_costmap_2d::Costmap2D * costmap,
   const double & max_time)
 {
-  refinement_ctr_ = 0;
   steady_clock::time_point start = steady_clock::now();
   double time_remaining = max_time;
-  bool success = true, reversing_segment;
+  bool success = true;
   nav_msgs::msg::Path curr_path_segment;
   curr_path_segment.header = path.header;
   std::vector<PathSegment> path_segments = findDirectionalPathSegments(path);
 
-  for (unsigned int i = 0; i != path_segments.size(); i++) {
-    if (path_segments[i].end - path_segments[i].start > 10) {
-      // Populate path segment
-      curr_path_segment.poses.clear();
+  if (segment_smoothing_threads_ > 1 && path_segments.size() > 1) {
+    // Segments only share their fixed end points, so they are smoothed independently
+    // with their own refinements, all within the time allowed to the whole path
+    std::vector<PathSegment> smoothed_segments;
+    for (const auto & segment : path_segments) {
+      if (segment.end - segment.start > 10) {
+        smoothed_segments.push_back(segment);
+      }
+    }
+    time_remaining -= duration_cast<duration<double>>(steady_clock::now() - start).count();
+
+    const int count = static_cast<int>(smoothed_segments.size());
+    std::vector<nav_msgs::msg::Path> segment_paths(count);
+    std::vector<char> segment_success(count, false);
+    #pragma omp parallel for num_threads(segment_smoothing_threads_) schedule(dynamic)
+    for (int i = 0; i < count; i++) {
+      int refinement_ctr = 0;
+      segment_paths[i].header = path.header;
+      segment_success[i] = smoothSegment(
+        path, smoothed_segments[i], segment_paths[i], costmap, time_remaining, refinement_ctr);
+    }
+
+    // Assemble the path changes to the main path in order, as the shared end point
+    // takes the orientation of the segment it starts
+    for (int i = 0; i < count; i++) {
       std::copy(
-        path.poses.begin() + path_segments[i].start,
-        path.poses.begin() + path_segments[i].end + 1,
-        std::back_inserter(curr_path_segment.poses));
+        segment_paths[i].poses.begin(),
+        segment_paths[i].poses.end(),
+        path.poses.begin() + smoothed_segments[i].start);
+      success = success && segment_success[i];
+    }
+    return success;
+  }
 
+  // Serially, the refinements are shared by all the segments
+  int refinement_ctr = 0;
+  for (unsigned int i = 0; i != path_segments.size(); i++) {
+    if (path_segments[i].end - path_segments[i].start > 10) {
       // Make sure we're still able to smooth with time remaining
       steady_clock::time_point now = steady_clock::now();
       time_remaining = max_time - duration_cast<duration<double>>(now - start).count();
 
-      // Smooth path segment naively
-      const geometry_msgs::msg::Pose start_pose = curr_path_segment.poses.front().pose;
-      const geometry_msgs::msg::Pose goal_pose = curr_path_segment.poses.back().pose;
-      bool local_success =
-        smoothImpl(curr_path_segment, reversing_segment, costmap, time_remaining);
-      success = success && local_success;
-
-      // Enforce boundary conditions
-      if (!is_holonomic_ && local_success) {
-        enforceStartBoundaryConditions(start_pose, curr_path_segment, costmap, reversing_segment);
-        enforceEndBoundaryConditions(goal_pose, curr_path_segment, costmap, reversing_segment);
-      }
+      success = smoothSegment(
+        path, path_segments[i], curr_path_segment, costmap, time_remaining,
+        refinement_ctr) && success;
 
       // Assemble the path changes to the main path
       std::copy(
@@ -89,10 +108,81 @@ bool Smoother::smooth(
   return success;
 }
 
+bool Smoother::smoothSegment(
+  const nav_msgs::msg::Path & path,
+  const PathSegment & segment,
+  nav_msgs::msg::Path & segment_path,
+  const nav2_costmap_2d::Costmap2D * costmap,
+  const double & max_time,
+  int & refinement_ctr)
+{
+  // Populate path segment
+  segment_path.poses.assign(
+    path.poses.begin() + segment.start,
+    path.poses.begin() + segment.end + 1);
+
+  // Smooth path segment naively
+  bool reversing_segment;
+  const geometry_msgs::msg::Pose start_pose = segment_path.poses.front().pose;
+  const geometry_msgs::msg::Pose goal_pose = segment_path.poses.back().pose;
+  bool local_success =
+    smoothImpl(segment_path, reversing_segment, costmap, max_time, refinement_ctr);
+
+  // Enforce boundary conditions
+  if (!is_holonomic_ && local_success) {
+    enforceStartBoundaryConditions(start_pose, segment_path, costmap, reversing_segment);
+    enforceEndBoundaryConditions(goal_pose, segment_path, costmap, reversing_segment);
+  }
+
+  return local_success;
+}
+
 bool Smoother::smoothImpl(
   nav_msgs::msg::Path & path,
   bool & reversing_segment,
   const nav2_costmap_2d::Costmap2D * costmap,
+  const double & max_time,
+  int & refinement_ctr)
+{
+  // Reused across calls, one per thread as segments may be smoothed concurrently
+  thread_local SmootherBuffers buffers;
+  const unsigned int path_size = path.poses.size();
+  buffers.x.resize(path_size);
+  buffers.y.resize(path_size);
+  for (unsigned int i = 0; i != path_size; i++) {
+    buffers.x[i] = path.poses[i].pose.position.x;
+    buffers.y[i] = path.poses[i].pose.position.y;
+  }
+  buffers.original_x = buffers.x;
+  buffers.original_y = buffers.y;
+
+  const bool success = smoothPositions(buffers, costmap, max_time);
+
+  // Lets do additional refinement, it shouldn't take more than a couple milliseconds
+  // but really puts the path quality over the top. Each refinement smooths towards the
+  // last smoothed positions, and a failed one keeps the positions it reached.
+  if (success) {
+    while (do_refinement_ && refinement_ctr < 4) {
+      refinement_ctr++;
+      buffers.original_x = buffers.x;
+      buffers.original_y = buffers.y;
+      if (!smoothPositions(buffers, costmap, max_time)) {
+        break;
+      }
+    }
+  }
+
+  for (unsigned int i = 0; i != path_size; i++) {
+    path.poses[i].pose.position.x = buffers.x[i];
+    path.poses[i].pose.position.y = buffers.y[i];
+  }
+  updateApproximatePathOrientations(path, reversing_segment);
+  return success;
+}
+
+bool Smoother::smoothPositions(
+  SmootherBuffers & buffers,
+  const nav2_costmap_2d::Costmap2D * costmap,
   const double & max_time)
 {
   steady_clock::time_point a = steady_clock::now();
@@ -100,24 +190,27 @@ bool Smoother::smoothImpl(
 
   int its = 0;
   double change = tolerance_;
-  const unsigned int & path_size = path.poses.size();
-  double x_i, y_i, y_m1, y_ip1, y_i_org;
+  const unsigned int path_size = buffers.x.size();
+  const double * org_x = buffers.original_x.data();
+  const double * org_y = buffers.original_y.data();
+  double * x = buffers.x.data();
+  double * y = buffers.y.data();
+  double x_i, y_i;
   unsigned int mx, my;
 
-  nav_msgs::msg::Path new_path = path;
-  nav_msgs::msg::Path last_path = path;
+  buffers.last_x = buffers.x;
+  buffers.last_y = buffers.y;
 
   while (change >= tolerance_) {
     its += 1;
     change = 0.0;
 
-    // Make sure the smoothing function will converge
+    // Make sure the smoothing function will converge, the positions are
+    // those of the last iteration
     if (its >= max_its_) {
       RCLCPP_DEBUG(
         rclcpp::get_logger("SmacPlannerSmoother"),
         "Number of iterations has exceeded limit of %i.", max_its_);
-      path = last_path;
-      updateApproximatePathOrientations(path, reversing_segment);
       return false;
     }
 
@@ -128,32 +221,23 @@ bool Smoother::smoothImpl(
       RCLCPP_DEBUG(
         rclcpp::get_logger("SmacPlannerSmoother"),
         "Smoothing time exceeded allowed duration of %0.2f.", max_time);
-      path = last_path;
-      updateApproximatePathOrientations(path, reversing_segment);
       return false;
     }
 
     for (unsigned int i = 1; i != path_size - 1; i++) {
-      for (unsigned int j = 0; j != 2; j++) {
-        x_i = getFieldByDim(path.poses[i], j);
-        y_i = getFieldByDim(new_path.poses[i], j);
-        y_m1 = getFieldByDim(new_path.poses[i - 1], j);
-        y_ip1 = getFieldByDim(new_path.poses[i + 1], j);
-        y_i_org = y_i;
-
-        // Smooth based on local 3 point neighborhood and original data locations
-        y_i += data_w_ * (x_i - y_i) + smooth_w_ * (y_ip1 + y_m1 - (2.0 * y_i));
-        setFieldByDim(new_path.poses[i], j, y_i);
-        change += abs(y_i - y_i_org);
-      }
+      // Smooth based on local 3 point neighborhood and original data locations,
+      // both dimensions at once
+      x_i = x[i];
+      y_i = y[i];
+      x[i] += data_w_ * (org_x[i] - x_i) + smooth_w_ * (x[i + 1] + x[i - 1] - (2.0 * x_i));
+      y[i] += data_w_ * (org_y[i] - y_i) + smooth_w_ * (y[i + 1] + y[i - 1] - (2.0 * y_i));
+      change += abs(x[i] - x_i);
+      change += abs(y[i] - y_i);
 
       // validate update is admissible, only checks cost if a valid costmap pointer is provided
       float cost = 0.0;
       if (costmap) {
-        costmap->worldToMap(
-          getFieldByDim(new_path.poses[i], 0),
-          getFieldByDim(new_path.poses[i], 1),
-          mx, my);
+        costmap->worldToMap(x[i], y[i], mx, my);
         cost = static_cast<float>(costmap->getCost(mx, my));
       }
 
@@ -162,52 +246,19 @@ bool Smoother::smoothImpl(
           rclcpp::get_logger("SmacPlannerSmoother"),
           "Smoothing process resulted in an infeasible collision. "
           "Returning the last path before the infeasibility was introduced.");
-        path = last_path;
-        updateApproximatePathOrientations(path, reversing_segment);
+        std::copy(buffers.last_x.begin(), buffers.last_x.begin() + i + 1, buffers.x.begin());
+        std::copy(buffers.last_y.begin(), buffers.last_y.begin() + i + 1, buffers.y.begin());
         return false;
       }
     }
 
-    last_path = new_path;
-  }
-
-  // Lets do additional refinement, it shouldn't take more than a couple milliseconds
-  // but really puts the path quality over the top.
-  if (do_refinement_ && refinement_ctr_ < 4) {
-    refinement_ctr_++;
-    smoothImpl(new_path, reversing_segment, costmap, max_time);
+    std::copy(buffers.x.begin(), buffers.x.end(), buffers.last_x.begin());
+    std::copy(buffers.y.begin(), buffers.y.end(), buffers.last_y.begin());
   }
 
-  updateApproximatePathOrientations(new_path, reversing_segment);
-  path = new_path;
   return true;
 }
 
-double Smoother::getFieldByDim(
-  const geometry_msgs::msg::PoseStamped & msg, const unsigned int & dim)
-{
-  if (dim == 0) {
-    return msg.pose.position.x;
-  } else if (dim == 1) {
-    return msg.pose.position.y;
-  } else {
-    return msg.pose.position.z;
-  }
-}
-
-void Smoother::setFieldByDim(
-  geometry_msgs::msg::PoseStamped & msg, const unsigned int dim,
-  const double & value)
-{
-  if (dim == 0) {
-    msg.pose.position.x = value;
-  } else if (dim == 1) {
-    msg.pose.position.y = value;
-  } else {
-    msg.pose.position.z = value;
-  }
-}
-
 std::vector<PathSegment> Smoother::findDirectionalPathSegments(const nav_msgs::msg::Path & path)
 {
   std::vector<PathSegment> segments;
@@ -322,16 +373,12 @@ void Smoother::findBoundaryExpansion(
   BoundaryExpansion & expansion,
   const nav2_costmap_2d::Costmap2D * costmap)
 {
-  static ompl::base::ScopedState<> from(state_space_), to(state_space_), s(state_space_);
-
-  from[0] = start.position.x;
-  from[1] = start.position.y;
-  from[2] = tf2::getYaw(start.orientation);
-  to[0] = end.position.x;
-  to[1] = end.position.y;
-  to[2] = tf2::getYaw(end.orientation);
+  const double start_yaw = tf2::getYaw(start.orientation);
+  const CurvePath path = analytic_curve_.getPath(
+    start.position.x, start.position.y, start_yaw,
+    end.position.x, end.position.y, tf2::getYaw(end.orientation));
 
-  double d = state_space_->distance(from(), to());
+  double d = analytic_curve_.length(path);
   // If this path is too long compared to the original, then this is probably
   // a loop-de-loop, treat as invalid as to not deviate too far from the original path.
   // 2.0 selected from prinicipled choice of boundary test points
@@ -343,20 +390,16 @@ void Smoother::findBoundaryExpansion(
     return;
   }
 
-  std::vector<double> reals;
   double theta(0.0), x(0.0), y(0.0);
   double x_m = start.position.x;
   double y_m = start.position.y;
 
   // Get intermediary poses
   for (double i = 0; i <= expansion.path_end_idx; i++) {
-    state_space_->interpolate(from(), to(), i / expansion.path_end_idx, s());
-    reals = s.reals();
-    // Make sure in range [0, 2PI)
-    theta = (reals[2] < 0.0) ? (reals[2] + 2.0 * M_PI) : reals[2];
-    theta = (theta > 2.0 * M_PI) ? (theta - 2.0 * M_PI) : theta;
-    x = reals[0];
-    y = reals[1];
+    // In range [0, 2PI)
+    analytic_curve_.interpolate(
+      path, start.position.x, start.position.y, start_yaw, i / expansion.path_end_idx,
+      x, y, theta);
 
     // Check for collision
     unsigned int mx, my;
@@ -0,0 +1,133 @@
+// Copyright (c) 2022, Samsung Research America
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License. Reserved.
+
+// Compares the open set implementations of AStarAlgorithm for each node type by
+// peak queue size and expansions per second in a large, mostly open map.
+// Usage: benchmark_a_star_queues [map size in cells] [number of trials]
+
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <cstdlib>
+#include <iostream>
+#include <limits>
+#include <memory>
+#include <string>
+
+#include "rclcpp/rclcpp.hpp"
+#include "nav2_costmap_2d/costmap_2d.hpp"
+#include "nav2_smac_planner/a_star.hpp"
+#include "nav2_smac_planner/collision_checker.hpp"
+#include "ament_index_cpp/get_package_share_directory.hpp"
+
+using namespace std::chrono;  // NOLINT
+
+template<typename NodeT>
+void runBenchmark(
+  const std::string & name,
+  const nav2_smac_planner::MotionModel & motion_model,
+  nav2_smac_planner::SearchInfo info,
+  nav2_costmap_2d::Costmap2D * costmap,
+  const unsigned int & dim_3_size,
+  const unsigned int & trials)
+{
+  const unsigned int size_x = costmap->getSizeInCellsX();
+  const unsigned int size_y = costmap->getSizeInCellsY();
+  nav2_smac_planner::GridCollisionChecker checker(costmap, dim_3_size);
+  checker.setFootprint(nav2_costmap_2d::Footprint(), true, 0.0);
+
+  for (unsigned int use_heap = 0; use_heap != 2; use_heap++) {
+    info.use_indexed_heap = use_heap == 1;
+    nav2_smac_planner::AStarAlgorithm<NodeT> a_star(motion_model, info);
+    int max_iterations = std::numeric_limits<int>::max();
+    a_star.initialize(
+      false, max_iterations, std::numeric_limits<int>::max(), 1000.0, 401, dim_3_size);
+
+    double total_time = 0.0;
+    uint64_t total_iterations = 0;
+    unsigned int peak_queue_size = 0;
+    for (unsigned int i = 0; i != trials; i++) {
+      typename NodeT::CoordinateVector path;
+      int num_it = 0;
+      a_star.setCollisionChecker(&checker);
+      a_star.setStart(5u, 5u, 0u);
+      a_star.setGoal(size_x - 5u, size_y - 5u, 0u);
+      steady_clock::time_point a = steady_clock::now();
+      a_star.createPath(path, num_it, 0.0);
+      steady_clock::time_point b = steady_clock::now();
+      total_time += duration_cast<duration<double>>(b - a).count();
+      total_iterations += num_it;
+      peak_queue_size = std::max(peak_queue_size, a_star.getPeakQueueSize());
+    }
+
+    std::cout << name << (use_heap ? " indexed heap:   " : " priority queue: ") <<
+      "peak queue size " << peak_queue_size <<
+      ", expansions " << total_iterations / trials <<
+      ", " << total_time * 1000.0 / trials << " ms" <<
+      ", " << static_cast<double>(total_iterations) / total_time << " expansions/sec" <<
+      std::endl;
+  }
+}
+
+int main(int argc, char ** argv)
+{
+  rclcpp::init(0, nullptr);
+  const unsigned int size = argc > 1 ? std::atoi(argv[1]) : 1000;
+  const unsigned int trials = argc > 2 ? std::atoi(argv[2]) : 5;
+
+  // Open map with a sparse field of pillars and a gentle cost gradient
+  nav2_costmap_2d::Costmap2D costmap(size, size, 0.05, 0.0, 0.0, 0);
+  for (unsigned int j = 0; j != size; j++) {
+    for (unsigned int i = 0; i != size; i++) {
+      costmap.setCost(i, j, static_cast<unsigned char>((i * j) % 50));
+    }
+  }
+  for (unsigned int j = 50; j < size - 50; j += 50) {
+    for (unsigned int i = 50; i < size - 50; i += 50) {
+      for (unsigned int dj = 0; dj != 10; dj++) {
+        for (unsigned int di = 0; di != 10; di++) {
+          costmap.setCost(i + di, j + dj, nav2_costmap_2d::LETHAL_OBSTACLE);
+        }
+      }
+    }
+  }
+
+  nav2_smac_planner::SearchInfo info;
+  info.change_penalty = 0.0;
+  info.non_straight_penalty = 1.2;
+  info.reverse_penalty = 2.0;
+  info.minimum_turning_radius = 8;  // in grid coordinates
+  info.retrospective_penalty = 0.015;
+  info.analytic_expansion_max_length = 60.0;  // in grid coordinates
+  info.analytic_expansion_ratio = 3.5;
+  info.cost_penalty = 2.0;
+  info.rotation_penalty = 5.0;
+  info.cache_obstacle_heuristic = false;
+  info.allow_reverse_expansion = false;
+
+  runBenchmark<nav2_smac_planner::Node2D>(
+    "2D", nav2_smac_planner::MotionModel::MOORE, info, &costmap, 1, trials);
+  runBenchmark<nav2_smac_planner::NodeHybrid>(
+    "Hybrid", nav2_smac_planner::MotionModel::DUBIN, info, &costmap, 72, trials);
+
+  info.lattice_filepath =
+    ament_index_cpp::get_package_share_directory("nav2_smac_planner") +
+    "/sample_primitives/5cm_resolution/0.5m_turning_radius/ackermann" +
+    "/output.json";
+  runBenchmark<nav2_smac_planner::NodeLattice>(
+    "Lattice", nav2_smac_planner::MotionModel::STATE_LATTICE, info, &costmap, 16, trials);
+
+  rclcpp::shutdown();
+  return 0;
+}
@@ -120,6 +120,341 @@ TEST(AStarTest, test_a_star_2d)
   delete costmapA;
 }
 
+TEST(AStarTest, test_a_star_2d_dense_graph)
+{
+  nav2_smac_planner::SearchInfo info;
+  info.use_dense_graph = true;
+  nav2_smac_planner::AStarAlgorithm<nav2_smac_planner::Node2D> a_star(
+    nav2_smac_planner::MotionModel::MOORE, info);
+  int max_iterations = 10000;
+  float tolerance = 0.0;
+  int it_on_approach = 10;
+  double max_planning_time = 120.0;
+  int num_it = 0;
+
+  a_star.initialize(false, max_iterations, it_on_approach, max_planning_time, 0.0, 1);
+
+  // no costmap given yet, graph is not sized
+  nav2_smac_planner::Node2D::CoordinateVector path;
+  EXPECT_THROW(a_star.createPath(path, num_it, tolerance), std::runtime_error);
+
+  nav2_costmap_2d::Costmap2D * costmapA =
+    new nav2_costmap_2d::Costmap2D(100, 100, 0.1, 0.0, 0.0, 0);
+  // island in the middle of lethal cost to cross
+  for (unsigned int i = 40; i <= 60; ++i) {
+    for (unsigned int j = 40; j <= 60; ++j) {
+      costmapA->setCost(i, j, 254);
+    }
+  }
+
+  std::unique_ptr<nav2_smac_planner::GridCollisionChecker> checker =
+    std::make_unique<nav2_smac_planner::GridCollisionChecker>(costmapA, 1);
+  checker->setFootprint(nav2_costmap_2d::Footprint(), true, 0.0);
+
+  // Results must match the hashed graph and be repeatable as storage is reused between plans
+  for (unsigned int i = 0; i != 3; i++) {
+    path.clear();
+    num_it = 0;
+    a_star.setCollisionChecker(checker.get());
+    a_star.setStart(20u, 20u, 0);
+    a_star.setGoal(80u, 80u, 0);
+    EXPECT_TRUE(a_star.createPath(path, num_it, tolerance));
+    EXPECT_EQ(num_it, 102);
+    EXPECT_EQ(path.size(), 81u);
+    for (unsigned int j = 0; j != path.size(); j++) {
+      EXPECT_EQ(costmapA->getCost(path[j].x, path[j].y), 0);
+    }
+  }
+
+  // A new costmap size reallocates the graph
+  nav2_costmap_2d::Costmap2D * costmapB =
+    new nav2_costmap_2d::Costmap2D(50, 50, 0.1, 0.0, 0.0, 0);
+  std::unique_ptr<nav2_smac_planner::GridCollisionChecker> checker_b =
+    std::make_unique<nav2_smac_planner::GridCollisionChecker>(costmapB, 1);
+  checker_b->setFootprint(nav2_costmap_2d::Footprint(), true, 0.0);
+  path.clear();
+  num_it = 0;
+  a_star.setCollisionChecker(checker_b.get());
+  a_star.setStart(5u, 5u, 0);
+  a_star.setGoal(45u, 45u, 0);
+  EXPECT_TRUE(a_star.createPath(path, num_it, tolerance));
+  EXPECT_EQ(a_star.getSizeX(), 50u);
+  EXPECT_EQ(a_star.getSizeY(), 50u);
+
+  info.use_dense_graph = false;
+  nav2_smac_planner::AStarAlgorithm<nav2_smac_planner::Node2D> a_star_hashed(
+    nav2_smac_planner::MotionModel::MOORE, info);
+  a_star_hashed.initialize(false, max_iterations, it_on_approach, max_planning_time, 0.0, 1);
+  nav2_smac_planner::Node2D::CoordinateVector path_hashed;
+  int num_it_hashed = 0;
+  a_star_hashed.setCollisionChecker(checker_b.get());
+  a_star_hashed.setStart(5u, 5u, 0);
+  a_star_hashed.setGoal(45u, 45u, 0);
+  EXPECT_TRUE(a_star_hashed.createPath(path_hashed, num_it_hashed, tolerance));
+  EXPECT_EQ(num_it, num_it_hashed);
+  EXPECT_EQ(path.size(), path_hashed.size());
+  EXPECT_GT(a_star.getGraphMemoryUsage(), 2500u * sizeof(unsigned int));
+  EXPECT_GT(a_star_hashed.getGraphMemoryUsage(), 0u);
+
+  delete costmapA;
+  delete costmapB;
+}
+
+TEST(AStarTest, test_dense_graph_storage)
+{
+  nav2_smac_planner::DenseGraph<nav2_smac_planner::Node2D> graph;
+  EXPECT_TRUE(graph.empty());
+  graph.resize(100000);
+  EXPECT_EQ(graph.size(), 100000u);
+  EXPECT_EQ(graph.getStoredSize(), 0u);
+  EXPECT_EQ(graph.getMemoryUsage(), 100000u * sizeof(unsigned int));
+
+  // Nodes are only stored once requested, and keep their address as more are added
+  nav2_smac_planner::Node2D * first = graph.get(500u);
+  first->setAccumulatedCost(1.0);
+  for (unsigned int i = 0; i != 10000; i++) {
+    EXPECT_EQ(graph.get(i * 10u)->getIndex(), i * 10u);
+  }
+  EXPECT_EQ(graph.get(500u), first);
+  EXPECT_EQ(first->getAccumulatedCost(), 1.0);
+  EXPECT_EQ(graph.getStoredSize(), 10000u);
+  // Nodes are stored in blocks of 4096, reserved whole
+  EXPECT_EQ(
+    graph.getMemoryUsage(),
+    100000u * sizeof(unsigned int) + 3u * 4096u * sizeof(nav2_smac_planner::Node2D));
+
+  // A new search resets the nodes requested again and reuses the storage
+  graph.clear();
+  nav2_smac_planner::Node2D * node = graph.get(7u);
+  EXPECT_EQ(node->getIndex(), 7u);
+  EXPECT_EQ(node->getAccumulatedCost(), std::numeric_limits<float>::max());
+  EXPECT_EQ(graph.get(500u)->getAccumulatedCost(), std::numeric_limits<float>::max());
+  EXPECT_EQ(graph.get(7u), node);
+  EXPECT_EQ(graph.getStoredSize(), 10000u);
+}
+
+TEST(AStarTest, test_a_star_corridor)
+{
+  nav2_smac_planner::SearchInfo info;
+  nav2_smac_planner::AStarAlgorithm<nav2_smac_planner::Node2D> a_star(
+    nav2_smac_planner::MotionModel::MOORE, info);
+  int max_iterations = 10000;
+  float tolerance = 0.0;
+  int it_on_approach = 10;
+  double max_planning_time = 120.0;
+  int num_it = 0;
+
+  a_star.initialize(false, max_iterations, it_on_approach, max_planning_time, 0.0, 1);
+
+  nav2_costmap_2d::Costmap2D * costmapA =
+    new nav2_costmap_2d::Costmap2D(100, 100, 0.1, 0.0, 0.0, 0);
+  std::unique_ptr<nav2_smac_planner::GridCollisionChecker> checker =
+    std::make_unique<nav2_smac_planner::GridCollisionChecker>(costmapA, 1);
+  checker->setFootprint(nav2_costmap_2d::Footprint(), true, 0.0);
+
+  // corridor going up then right, around the straight path
+  std::vector<unsigned char> corridor(100 * 100, 0);
+  for (unsigned int j = 18; j <= 82; ++j) {
+    for (unsigned int i = 18; i <= 22; ++i) {
+      corridor[i + j * 100] = 1;
+      corridor[j + (i + 60) * 100] = 1;
+    }
+  }
+
+  a_star.setCollisionChecker(checker.get());
+  a_star.setCorridor(&corridor);
+  a_star.setStart(20u, 20u, 0);
+  a_star.setGoal(80u, 80u, 0);
+  nav2_smac_planner::Node2D::CoordinateVector path;
+  EXPECT_TRUE(a_star.createPath(path, num_it, tolerance));
+  for (unsigned int i = 0; i != path.size(); i++) {
+    EXPECT_TRUE(corridor[path[i].x + path[i].y * 100]);
+  }
+  EXPECT_GT(path.size(), 81u);
+
+  // no path within a corridor cut in two
+  for (unsigned int i = 18; i <= 22; ++i) {
+    corridor[i + 50 * 100] = 0;
+  }
+  a_star.setCollisionChecker(checker.get());
+  a_star.setStart(20u, 20u, 0);
+  a_star.setGoal(80u, 80u, 0);
+  path.clear();
+  num_it = 0;
+  EXPECT_FALSE(a_star.createPath(path, num_it, tolerance));
+
+  // the whole costmap is searched without a corridor
+  a_star.setCorridor(nullptr);
+  a_star.setCollisionChecker(checker.get());
+  a_star.setStart(20u, 20u, 0);
+  a_star.setGoal(80u, 80u, 0);
+  path.clear();
+  num_it = 0;
+  EXPECT_TRUE(a_star.createPath(path, num_it, tolerance));
+  // the diagonal cells after the start, which the backtrace stops short of
+  EXPECT_EQ(path.size(), 60u);
+
+  delete costmapA;
+}
+
+TEST(AStarTest, test_a_star_own_motion_model)
+{
+  nav2_smac_planner::SearchInfo info;
+  nav2_smac_planner::AStarAlgorithm<nav2_smac_planner::Node2D> a_star(
+    nav2_smac_planner::MotionModel::MOORE, info);
+  nav2_smac_planner::AStarAlgorithm<nav2_smac_planner::Node2D> coarse_a_star(
+    nav2_smac_planner::MotionModel::MOORE, info);
+  int max_iterations = 10000;
+  float tolerance = 0.0;
+  int it_on_approach = 10;
+  double max_planning_time = 120.0;
+  int num_it = 0;
+
+  a_star.initialize(false, max_iterations, it_on_approach, max_planning_time, 0.0, 1);
+  coarse_a_star.initialize(false, max_iterations, it_on_approach, max_planning_time, 0.0, 1);
+
+  nav2_costmap_2d::Costmap2D * costmapA =
+    new nav2_costmap_2d::Costmap2D(100, 100, 0.1, 0.0, 0.0, 0);
+  nav2_costmap_2d::Costmap2D * coarse_costmap =
+    new nav2_costmap_2d::Costmap2D(50, 50, 0.2, 0.0, 0.0, 0);
+  std::unique_ptr<nav2_smac_planner::GridCollisionChecker> checker =
+    std::make_unique<nav2_smac_planner::GridCollisionChecker>(costmapA, 1);
+  checker->setFootprint(nav2_costmap_2d::Footprint(), true, 0.0);
+  std::unique_ptr<nav2_smac_planner::GridCollisionChecker> coarse_checker =
+    std::make_unique<nav2_smac_planner::GridCollisionChecker>(coarse_costmap, 1);
+  coarse_checker->setFootprint(nav2_costmap_2d::Footprint(), true, 0.0);
+
+  nav2_smac_planner::Node2D::CoordinateVector path;
+  const std::vector<int> & offsets = a_star.getSearchState().node_2d._neighbors_grid_offsets;
+  const std::vector<int> & coarse_offsets =
+    coarse_a_star.getSearchState().node_2d._neighbors_grid_offsets;
+  a_star.setCollisionChecker(checker.get());
+  EXPECT_EQ(offsets[3], 100);
+
+  // another search on a coarser costmap initializes a motion model of its own
+  coarse_a_star.setCollisionChecker(coarse_checker.get());
+  EXPECT_EQ(coarse_offsets[3], 50);
+  EXPECT_EQ(offsets[3], 100);
+  coarse_a_star.setStart(10u, 10u, 0);
+  coarse_a_star.setGoal(40u, 40u, 0);
+  EXPECT_TRUE(coarse_a_star.createPath(path, num_it, tolerance));
+
+  // leaving the motion model of the first search as it was
+  a_star.setCollisionChecker(checker.get());
+  EXPECT_EQ(offsets[3], 100);
+  EXPECT_EQ(coarse_offsets[3], 50);
+  a_star.setStart(20u, 20u, 0);
+  a_star.setGoal(80u, 80u, 0);
+  path.clear();
+  num_it = 0;
+  EXPECT_TRUE(a_star.createPath(path, num_it, tolerance));
+  for (unsigned int i = 1; i < path.size(); i++) {
+    EXPECT_LE(std::abs(static_cast<int>(path[i].x) - static_cast<int>(path[i - 1].x)), 1);
+    EXPECT_LE(std::abs(static_cast<int>(path[i].y) - static_cast<int>(path[i - 1].y)), 1);
+  }
+
+  delete costmapA;
+  delete coarse_costmap;
+}
+
+TEST(AStarTest, test_a_star_multi_goal)
+{
+  nav2_smac_planner::SearchInfo info;
+  nav2_smac_planner::AStarAlgorithm<nav2_smac_planner::Node2D> a_star(
+    nav2_smac_planner::MotionModel::MOORE, info);
+  int max_iterations = 10000;
+  float tolerance = 0.0;
+  int it_on_approach = 10;
+  double max_planning_time = 120.0;
+  int num_it = 0;
+
+  a_star.initialize(false, max_iterations, it_on_approach, max_planning_time, 0.0, 1);
+
+  nav2_costmap_2d::Costmap2D * costmapA =
+    new nav2_costmap_2d::Costmap2D(100, 100, 0.1, 0.0, 0.0, 0);
+  std::unique_ptr<nav2_smac_planner::GridCollisionChecker> checker =
+    std::make_unique<nav2_smac_planner::GridCollisionChecker>(costmapA, 1);
+  checker->setFootprint(nav2_costmap_2d::Footprint(), true, 0.0);
+
+  // the path ends at the closest of the goals
+  nav2_smac_planner::Node2D::CoordinateVector goals = {
+    nav2_smac_planner::Node2D::Coordinates(80u, 80u),
+    nav2_smac_planner::Node2D::Coordinates(20u, 50u)};
+  a_star.setCollisionChecker(checker.get());
+  a_star.setStart(20u, 20u, 0);
+  a_star.setGoals(goals);
+  nav2_smac_planner::Node2D::CoordinateVector path;
+  EXPECT_TRUE(a_star.createPath(path, num_it, tolerance));
+  EXPECT_EQ(path.front().x, 20.0f);
+  EXPECT_EQ(path.front().y, 50.0f);
+
+  // or at the next closest when it is occupied
+  costmapA->setCost(20u, 50u, 254);
+  a_star.setCollisionChecker(checker.get());
+  a_star.setStart(20u, 20u, 0);
+  a_star.setGoals(goals);
+  path.clear();
+  num_it = 0;
+  EXPECT_TRUE(a_star.createPath(path, num_it, tolerance));
+  EXPECT_EQ(path.front().x, 80.0f);
+  EXPECT_EQ(path.front().y, 80.0f);
+
+  // no path when all of them are occupied
+  costmapA->setCost(80u, 80u, 254);
+  a_star.setCollisionChecker(checker.get());
+  a_star.setStart(20u, 20u, 0);
+  a_star.setGoals(goals);
+  path.clear();
+  num_it = 0;
+  EXPECT_THROW(a_star.createPath(path, num_it, tolerance), std::runtime_error);
+  EXPECT_THROW(a_star.setGoals({}), std::runtime_error);
+
+  delete costmapA;
+}
+
+TEST(AStarTest, test_a_star_cancel)
+{
+  int max_iterations = 10000;
+  int it_on_approach = 10;
+  double max_planning_time = 120.0;
+
+  nav2_costmap_2d::Costmap2D * costmapA =
+    new nav2_costmap_2d::Costmap2D(100, 100, 0.1, 0.0, 0.0, 0);
+  std::unique_ptr<nav2_smac_planner::GridCollisionChecker> checker =
+    std::make_unique<nav2_smac_planner::GridCollisionChecker>(costmapA, 1);
+  checker->setFootprint(nav2_costmap_2d::Footprint(), true, 0.0);
+
+  // A cancelled search gives up, with or without the bidirectional search
+  for (unsigned int bidirectional = 0; bidirectional != 2; bidirectional++) {
+    nav2_smac_planner::SearchInfo info;
+    info.use_bidirectional_search = bidirectional == 1;
+    nav2_smac_planner::AStarAlgorithm<nav2_smac_planner::Node2D> a_star(
+      nav2_smac_planner::MotionModel::MOORE, info);
+    a_star.initialize(false, max_iterations, it_on_approach, max_planning_time, 0.0, 1);
+
+    bool cancelled = true;
+    a_star.setCancelChecker([&cancelled]() {return cancelled;});
+    a_star.setCollisionChecker(checker.get());
+    a_star.setStart(20u, 20u, 0);
+    a_star.setGoal(80u, 80u, 0);
+    nav2_smac_planner::Node2D::CoordinateVector path;
+    int num_it = 0;
+    EXPECT_FALSE(a_star.createPath(path, num_it, 0.0));
+    EXPECT_EQ(num_it, 0);
+
+    // and plans again once no longer cancelled
+    cancelled = false;
+    a_star.setCollisionChecker(checker.get());
+    a_star.setStart(20u, 20u, 0);
+    a_star.setGoal(80u, 80u, 0);
+    path.clear();
+    EXPECT_TRUE(a_star.createPath(path, num_it, 0.0));
+    EXPECT_GT(num_it, 0);
+  }
+
+  delete costmapA;
+}
+
 TEST(AStarTest, test_a_star_se2)
 {
   nav2_smac_planner::SearchInfo info;
@@ -176,6 +511,148 @@ TEST(AStarTest, test_a_star_se2)
   delete costmapA;
 }
 
+TEST(AStarTest, test_a_star_se2_lazy_collision_checking)
+{
+  nav2_smac_planner::SearchInfo info;
+  info.change_penalty = 0.1;
+  info.non_straight_penalty = 1.1;
+  info.reverse_penalty = 2.0;
+  info.minimum_turning_radius = 8;  // in grid coordinates
+  info.retrospective_penalty = 0.015;
+  info.analytic_expansion_max_length = 20.0;  // in grid coordinates
+  info.analytic_expansion_ratio = 3.5;
+  info.cost_penalty = 1.7;
+  unsigned int size_theta = 72;
+  int max_iterations = 10000;
+  float tolerance = 10.0;
+  int it_on_approach = 10;
+  double max_planning_time = 120.0;
+
+  nav2_costmap_2d::Costmap2D * costmapA =
+    new nav2_costmap_2d::Costmap2D(100, 100, 0.1, 0.0, 0.0, 0);
+  // island in the middle of lethal cost to cross, with a high cost ring around it
+  for (unsigned int i = 35; i <= 65; ++i) {
+    for (unsigned int j = 35; j <= 65; ++j) {
+      costmapA->setCost(i, j, (i < 40 || i > 60 || j < 40 || j > 60) ? 200 : 254);
+    }
+  }
+
+  // A footprint checked in full near the island
+  nav2_costmap_2d::Footprint footprint;
+  geometry_msgs::msg::Point p;
+  p.x = -0.3;
+  p.y = -0.2;
+  footprint.push_back(p);
+  p.x = 0.3;
+  footprint.push_back(p);
+  p.y = 0.2;
+  footprint.push_back(p);
+  p.x = -0.3;
+  footprint.push_back(p);
+  std::unique_ptr<nav2_smac_planner::GridCollisionChecker> checker =
+    std::make_unique<nav2_smac_planner::GridCollisionChecker>(costmapA, size_theta);
+  checker->setFootprint(footprint, false, 100.0);
+
+  // The lazy search must find a path as the full one does, whose poses are never in collision
+  for (const bool & lazy : {false, true}) {
+    info.use_lazy_collision_checking = lazy;
+    nav2_smac_planner::AStarAlgorithm<nav2_smac_planner::NodeHybrid> a_star(
+      nav2_smac_planner::MotionModel::DUBIN, info);
+    a_star.initialize(false, max_iterations, it_on_approach, max_planning_time, 401, size_theta);
+    a_star.setCollisionChecker(checker.get());
+    a_star.setStart(10u, 10u, 0u);
+    a_star.setGoal(80u, 80u, 40u);
+    nav2_smac_planner::NodeHybrid::CoordinateVector path;
+    int num_it = 0;
+    EXPECT_TRUE(a_star.createPath(path, num_it, tolerance));
+    EXPECT_GT(path.size(), 0u);
+    const double bin_size = 2.0 * M_PI / size_theta;
+    for (unsigned int i = 0; i != path.size(); i++) {
+      EXPECT_FALSE(checker->inCollision(path[i].x, path[i].y, path[i].theta / bin_size, false));
+    }
+  }
+
+  delete costmapA;
+}
+
+TEST(AStarTest, test_a_star_se2_batch_expansion)
+{
+  nav2_smac_planner::SearchInfo info;
+  info.change_penalty = 0.1;
+  info.non_straight_penalty = 1.1;
+  info.reverse_penalty = 2.0;
+  info.minimum_turning_radius = 8;  // in grid coordinates
+  info.retrospective_penalty = 0.015;
+  info.analytic_expansion_max_length = 20.0;  // in grid coordinates
+  info.analytic_expansion_ratio = 3.5;
+  info.cost_penalty = 1.7;
+  unsigned int size_theta = 72;
+  int max_iterations = 10000;
+  float tolerance = 10.0;
+  int it_on_approach = 10;
+  double max_planning_time = 120.0;
+
+  nav2_costmap_2d::Costmap2D * costmapA =
+    new nav2_costmap_2d::Costmap2D(100, 100, 0.1, 0.0, 0.0, 0);
+  // island in the middle of lethal cost to cross, with a high cost ring around it
+  for (unsigned int i = 35; i <= 65; ++i) {
+    for (unsigned int j = 35; j <= 65; ++j) {
+      costmapA->setCost(i, j, (i < 40 || i > 60 || j < 40 || j > 60) ? 200 : 254);
+    }
+  }
+
+  nav2_costmap_2d::Footprint footprint;
+  geometry_msgs::msg::Point p;
+  p.x = -0.3;
+  p.y = -0.2;
+  footprint.push_back(p);
+  p.x = 0.3;
+  footprint.push_back(p);
+  p.y = 0.2;
+  footprint.push_back(p);
+  p.x = -0.3;
+  footprint.push_back(p);
+  std::unique_ptr<nav2_smac_planner::GridCollisionChecker> checker =
+    std::make_unique<nav2_smac_planner::GridCollisionChecker>(costmapA, size_theta);
+  checker->setFootprint(footprint, false, 100.0);
+
+  auto plan = [&](const int & batch_size, const int & threads) {
+      info.expansion_batch_size = batch_size;
+      info.expansion_threads = threads;
+      nav2_smac_planner::AStarAlgorithm<nav2_smac_planner::NodeHybrid> a_star(
+        nav2_smac_planner::MotionModel::DUBIN, info);
+      a_star.initialize(false, max_iterations, it_on_approach, max_planning_time, 401, size_theta);
+      a_star.setCollisionChecker(checker.get());
+      a_star.setStart(10u, 10u, 0u);
+      a_star.setGoal(80u, 80u, 40u);
+      nav2_smac_planner::NodeHybrid::CoordinateVector path;
+      int num_it = 0;
+      EXPECT_TRUE(a_star.createPath(path, num_it, tolerance));
+      return path;
+    };
+
+  // Batches find a path whose poses are never in collision, whatever the number of threads
+  const nav2_smac_planner::NodeHybrid::CoordinateVector path = plan(8, 1);
+  EXPECT_GT(path.size(), 0u);
+  const double bin_size = 2.0 * M_PI / size_theta;
+  for (unsigned int i = 0; i != path.size(); i++) {
+    EXPECT_FALSE(checker->inCollision(path[i].x, path[i].y, path[i].theta / bin_size, false));
+  }
+
+  const nav2_smac_planner::NodeHybrid::CoordinateVector threaded_path = plan(8, 4);
+  ASSERT_EQ(threaded_path.size(), path.size());
+  for (unsigned int i = 0; i != path.size(); i++) {
+    EXPECT_EQ(threaded_path[i].x, path[i].x);
+    EXPECT_EQ(threaded_path[i].y, path[i].y);
+    EXPECT_EQ(threaded_path[i].theta, path[i].theta);
+  }
+
+  // Single node batches expand as without batching
+  EXPECT_GT(plan(1, 4).size(), 0u);
+
+  delete costmapA;
+}
+
 TEST(AStarTest, test_a_star_lattice)
 {
   nav2_smac_planner::SearchInfo info;
@@ -225,7 +702,7 @@ TEST(AStarTest, test_a_star_lattice)
 
   // check path is the right size and collision free
   EXPECT_EQ(num_it, 21);
-  EXPECT_EQ(path.size(), 47u);
+  EXPECT_EQ(path.size(), 48u);
   for (unsigned int i = 0; i != path.size(); i++) {
     EXPECT_EQ(costmapA->getCost(path[i].x, path[i].y), 0);
   }
@@ -237,6 +714,341 @@ TEST(AStarTest, test_a_star_lattice)
   delete costmapA;
 }
 
+TEST(AStarTest, test_a_star_indexed_heap)
+{
+  nav2_smac_planner::SearchInfo info;
+  info.change_penalty = 0.1;
+  info.non_straight_penalty = 1.1;
+  info.reverse_penalty = 2.0;
+  info.minimum_turning_radius = 8;  // in grid coordinates
+  info.retrospective_penalty = 0.015;
+  info.analytic_expansion_max_length = 20.0;  // in grid coordinates
+  info.analytic_expansion_ratio = 3.5;
+  info.cost_penalty = 1.7;
+  info.cache_obstacle_heuristic = false;
+  int max_iterations = 10000;
+  float tolerance = 10.0;
+  int it_on_approach = 10;
+  double max_planning_time = 120.0;
+  unsigned int size_theta = 72;
+
+  nav2_costmap_2d::Costmap2D * costmapA =
+    new nav2_costmap_2d::Costmap2D(100, 100, 0.1, 0.0, 0.0, 0);
+  // island in the middle of lethal cost to cross
+  for (unsigned int i = 40; i <= 60; ++i) {
+    for (unsigned int j = 40; j <= 60; ++j) {
+      costmapA->setCost(i, j, 254);
+    }
+  }
+
+  // 2D search, with both hashed and dense graph storage
+  std::unique_ptr<nav2_smac_planner::GridCollisionChecker> checker_2d =
+    std::make_unique<nav2_smac_planner::GridCollisionChecker>(costmapA, 1);
+  checker_2d->setFootprint(nav2_costmap_2d::Footprint(), true, 0.0);
+  unsigned int peak_queue_sizes[2];
+  unsigned int path_sizes[2];
+  for (unsigned int use_heap = 0; use_heap != 2; use_heap++) {
+    info.use_indexed_heap = use_heap == 1;
+    nav2_smac_planner::AStarAlgorithm<nav2_smac_planner::Node2D> a_star(
+      nav2_smac_planner::MotionModel::MOORE, info);
+    a_star.initialize(false, max_iterations, it_on_approach, max_planning_time, 0.0, 1);
+    a_star.setCollisionChecker(checker_2d.get());
+    a_star.setStart(20u, 20u, 0);
+    a_star.setGoal(80u, 80u, 0);
+    nav2_smac_planner::Node2D::CoordinateVector path;
+    int num_it = 0;
+    EXPECT_TRUE(a_star.createPath(path, num_it, 0.0));
+    EXPECT_GT(path.size(), 0u);
+    for (unsigned int i = 0; i != path.size(); i++) {
+      EXPECT_EQ(costmapA->getCost(path[i].x, path[i].y), 0);
+    }
+    peak_queue_sizes[use_heap] = a_star.getPeakQueueSize();
+    path_sizes[use_heap] = path.size();
+  }
+
+  // No duplicate entries should ever make the open set larger
+  EXPECT_LE(peak_queue_sizes[1], peak_queue_sizes[0]);
+
+  info.use_dense_graph = true;
+  nav2_smac_planner::AStarAlgorithm<nav2_smac_planner::Node2D> a_star_dense(
+    nav2_smac_planner::MotionModel::MOORE, info);
+  a_star_dense.initialize(false, max_iterations, it_on_approach, max_planning_time, 0.0, 1);
+  for (unsigned int i = 0; i != 2; i++) {
+    a_star_dense.setCollisionChecker(checker_2d.get());
+    a_star_dense.setStart(20u, 20u, 0);
+    a_star_dense.setGoal(80u, 80u, 0);
+    nav2_smac_planner::Node2D::CoordinateVector path;
+    int num_it = 0;
+    EXPECT_TRUE(a_star_dense.createPath(path, num_it, 0.0));
+    EXPECT_EQ(path.size(), path_sizes[1]);
+    EXPECT_EQ(a_star_dense.getPeakQueueSize(), peak_queue_sizes[1]);
+  }
+  info.use_dense_graph = false;
+
+  // Hybrid-A* search
+  info.use_indexed_heap = true;
+  nav2_smac_planner::AStarAlgorithm<nav2_smac_planner::NodeHybrid> a_star_se2(
+    nav2_smac_planner::MotionModel::DUBIN, info);
+  a_star_se2.initialize(false, max_iterations, it_on_approach, max_planning_time, 401, size_theta);
+  std::unique_ptr<nav2_smac_planner::GridCollisionChecker> checker_se2 =
+    std::make_unique<nav2_smac_planner::GridCollisionChecker>(costmapA, size_theta);
+  checker_se2->setFootprint(nav2_costmap_2d::Footprint(), true, 0.0);
+  a_star_se2.setCollisionChecker(checker_se2.get());
+  a_star_se2.setStart(10u, 10u, 0u);
+  a_star_se2.setGoal(80u, 80u, 40u);
+  nav2_smac_planner::NodeHybrid::CoordinateVector path_se2;
+  int num_it = 0;
+  EXPECT_TRUE(a_star_se2.createPath(path_se2, num_it, tolerance));
+  EXPECT_GT(path_se2.size(), 0u);
+  for (unsigned int i = 0; i != path_se2.size(); i++) {
+    EXPECT_EQ(costmapA->getCost(path_se2[i].x, path_se2[i].y), 0);
+  }
+  for (unsigned int i = 1; i != path_se2.size(); i++) {
+    EXPECT_LT(hypotf(path_se2[i].x - path_se2[i - 1].x, path_se2[i].y - path_se2[i - 1].y), 2.1f);
+  }
+
+  delete costmapA;
+}
+
+TEST(AStarTest, test_a_star_anytime)
+{
+  nav2_smac_planner::SearchInfo info;
+  info.change_penalty = 0.1;
+  info.non_straight_penalty = 1.1;
+  info.reverse_penalty = 2.0;
+  info.minimum_turning_radius = 8;  // in grid coordinates
+  info.retrospective_penalty = 0.015;
+  info.analytic_expansion_max_length = 20.0;  // in grid coordinates
+  info.analytic_expansion_ratio = 3.5;
+  info.cost_penalty = 1.7;
+  info.cache_obstacle_heuristic = false;
+  info.use_anytime_search = true;
+  info.anytime_initial_weight = 3.0;
+  info.anytime_weight_decrement = 1.0;
+  int max_iterations = 100000;
+  float tolerance = 10.0;
+  int it_on_approach = 10;
+  double max_planning_time = 120.0;
+  unsigned int size_theta = 72;
+
+  nav2_costmap_2d::Costmap2D * costmapA =
+    new nav2_costmap_2d::Costmap2D(100, 100, 0.1, 0.0, 0.0, 0);
+  // island in the middle of lethal cost to cross
+  for (unsigned int i = 40; i <= 60; ++i) {
+    for (unsigned int j = 40; j <= 60; ++j) {
+      costmapA->setCost(i, j, 254);
+    }
+  }
+
+  // 2D search, which should improve down to an unweighted search with ample time
+  std::unique_ptr<nav2_smac_planner::GridCollisionChecker> checker_2d =
+    std::make_unique<nav2_smac_planner::GridCollisionChecker>(costmapA, 1);
+  checker_2d->setFootprint(nav2_costmap_2d::Footprint(), true, 0.0);
+  for (unsigned int use_heap = 0; use_heap != 2; use_heap++) {
+    info.use_indexed_heap = use_heap == 1;
+    nav2_smac_planner::AStarAlgorithm<nav2_smac_planner::Node2D> a_star(
+      nav2_smac_planner::MotionModel::MOORE, info);
+    a_star.initialize(false, max_iterations, it_on_approach, max_planning_time, 0.0, 1);
+    a_star.setCollisionChecker(checker_2d.get());
+    a_star.setStart(20u, 20u, 0);
+    a_star.setGoal(80u, 80u, 0);
+    nav2_smac_planner::Node2D::CoordinateVector path;
+    int num_it = 0;
+    EXPECT_TRUE(a_star.createPath(path, num_it, 0.0));
+    EXPECT_GT(path.size(), 0u);
+    EXPECT_EQ(path.front().x, 80.0f);
+    // The backtrace stops short of the start cell
+    EXPECT_LE(std::max(fabs(path.back().x - 20.0f), fabs(path.back().y - 20.0f)), 1.0f);
+    for (unsigned int i = 0; i != path.size(); i++) {
+      EXPECT_EQ(costmapA->getCost(path[i].x, path[i].y), 0);
+    }
+    EXPECT_EQ(a_star.getSuboptimalityBound(), 1.0f);
+  }
+
+  // 2D search stopping once within the target bound
+  info.use_indexed_heap = false;
+  info.anytime_weight_decrement = 0.5;
+  info.anytime_target_bound = 2.0;
+  nav2_smac_planner::AStarAlgorithm<nav2_smac_planner::Node2D> a_star_bounded(
+    nav2_smac_planner::MotionModel::MOORE, info);
+  a_star_bounded.initialize(false, max_iterations, it_on_approach, max_planning_time, 0.0, 1);
+  a_star_bounded.setCollisionChecker(checker_2d.get());
+  a_star_bounded.setStart(20u, 20u, 0);
+  a_star_bounded.setGoal(80u, 80u, 0);
+  nav2_smac_planner::Node2D::CoordinateVector path_bounded;
+  int num_it_bounded = 0;
+  EXPECT_TRUE(a_star_bounded.createPath(path_bounded, num_it_bounded, 0.0));
+  EXPECT_GT(path_bounded.size(), 0u);
+  EXPECT_EQ(a_star_bounded.getSuboptimalityBound(), 2.0f);
+  info.anytime_weight_decrement = 1.0;
+  info.anytime_target_bound = 1.0;
+
+  // Hybrid-A* search, bounded by the weight of the last path found
+  info.use_indexed_heap = false;
+  std::unique_ptr<nav2_smac_planner::GridCollisionChecker> checker_se2 =
+    std::make_unique<nav2_smac_planner::GridCollisionChecker>(costmapA, size_theta);
+  checker_se2->setFootprint(nav2_costmap_2d::Footprint(), true, 0.0);
+  nav2_smac_planner::AStarAlgorithm<nav2_smac_planner::NodeHybrid> a_star_se2(
+    nav2_smac_planner::MotionModel::DUBIN, info);
+  a_star_se2.initialize(false, max_iterations, it_on_approach, max_planning_time, 401, size_theta);
+  a_star_se2.setCollisionChecker(checker_se2.get());
+  a_star_se2.setStart(10u, 10u, 0u);
+  a_star_se2.setGoal(80u, 80u, 40u);
+  nav2_smac_planner::NodeHybrid::CoordinateVector path_se2;
+  int num_it = 0;
+  EXPECT_TRUE(a_star_se2.createPath(path_se2, num_it, tolerance));
+  EXPECT_GT(path_se2.size(), 0u);
+  for (unsigned int i = 0; i != path_se2.size(); i++) {
+    EXPECT_EQ(costmapA->getCost(path_se2[i].x, path_se2[i].y), 0);
+  }
+  EXPECT_GE(a_star_se2.getSuboptimalityBound(), 1.0f);
+  EXPECT_LE(a_star_se2.getSuboptimalityBound(), 3.0f);
+
+  delete costmapA;
+}
+
+TEST(AStarTest, test_a_star_bidirectional)
+{
+  nav2_smac_planner::SearchInfo info;
+  info.cost_penalty = 1.7;
+  info.use_bidirectional_search = true;
+  int max_iterations = 10000;
+  int it_on_approach = 10;
+  double max_planning_time = 120.0;
+
+  nav2_costmap_2d::Costmap2D * costmapA =
+    new nav2_costmap_2d::Costmap2D(100, 100, 0.1, 0.0, 0.0, 0);
+  // wall across the map with a single doorway to pass through
+  for (unsigned int j = 0; j != 100; ++j) {
+    if (j < 70 || j > 72) {
+      costmapA->setCost(50, j, 254);
+    }
+  }
+
+  std::unique_ptr<nav2_smac_planner::GridCollisionChecker> checker =
+    std::make_unique<nav2_smac_planner::GridCollisionChecker>(costmapA, 1);
+  checker->setFootprint(nav2_costmap_2d::Footprint(), true, 0.0);
+
+  // Searching sequentially and in parallel should both find a shortest path
+  for (unsigned int parallel = 0; parallel != 2; parallel++) {
+    info.parallel_bidirectional_search = parallel == 1;
+    nav2_smac_planner::AStarAlgorithm<nav2_smac_planner::Node2D> a_star(
+      nav2_smac_planner::MotionModel::VON_NEUMANN, info);
+    a_star.initialize(false, max_iterations, it_on_approach, max_planning_time, 0.0, 1);
+
+    // Run twice to check the frontiers are reset between plans
+    for (unsigned int i = 0; i != 2; i++) {
+      a_star.setCollisionChecker(checker.get());
+      a_star.setStart(20u, 20u, 0);
+      a_star.setGoal(80u, 20u, 0);
+      nav2_smac_planner::Node2D::CoordinateVector path;
+      int num_it = 0;
+      EXPECT_TRUE(a_star.createPath(path, num_it, 0.0));
+      EXPECT_GT(num_it, 0);
+
+      // Up to the doorway and back down, excluding the start
+      EXPECT_EQ(path.size(), 60u + 2u * 50u);
+      EXPECT_EQ(path.front().x, 80.0f);
+      EXPECT_EQ(path.front().y, 20.0f);
+      EXPECT_EQ(fabs(path.back().x - 20.0f) + fabs(path.back().y - 20.0f), 1.0f);
+      for (unsigned int j = 0; j != path.size(); j++) {
+        EXPECT_EQ(costmapA->getCost(path[j].x, path[j].y), 0);
+      }
+      for (unsigned int j = 1; j != path.size(); j++) {
+        EXPECT_EQ(fabs(path[j].x - path[j - 1].x) + fabs(path[j].y - path[j - 1].y), 1.0f);
+      }
+    }
+  }
+
+  // Closing the doorway leaves no path
+  for (unsigned int j = 70; j <= 72; ++j) {
+    costmapA->setCost(50, j, 254);
+  }
+  nav2_smac_planner::AStarAlgorithm<nav2_smac_planner::Node2D> a_star(
+    nav2_smac_planner::MotionModel::VON_NEUMANN, info);
+  a_star.initialize(false, max_iterations, it_on_approach, max_planning_time, 0.0, 1);
+  a_star.setCollisionChecker(checker.get());
+  a_star.setStart(20u, 20u, 0);
+  a_star.setGoal(80u, 20u, 0);
+  nav2_smac_planner::Node2D::CoordinateVector path;
+  int num_it = 0;
+  EXPECT_FALSE(a_star.createPath(path, num_it, 0.0));
+
+  // Other node types do not support it
+  nav2_smac_planner::AStarAlgorithm<nav2_smac_planner::NodeHybrid> a_star_se2(
+    nav2_smac_planner::MotionModel::DUBIN, info);
+  a_star_se2.initialize(false, max_iterations, it_on_approach, max_planning_time, 401, 72);
+  std::unique_ptr<nav2_smac_planner::GridCollisionChecker> checker_se2 =
+    std::make_unique<nav2_smac_planner::GridCollisionChecker>(costmapA, 72);
+  checker_se2->setFootprint(nav2_costmap_2d::Footprint(), true, 0.0);
+  a_star_se2.setCollisionChecker(checker_se2.get());
+  a_star_se2.setStart(10u, 10u, 0u);
+  a_star_se2.setGoal(30u, 10u, 0u);
+  nav2_smac_planner::NodeHybrid::CoordinateVector path_se2;
+  EXPECT_THROW(a_star_se2.createPath(path_se2, num_it, 0.0), std::runtime_error);
+
+  delete costmapA;
+}
+
+TEST(AStarTest, test_a_star_jump_point_search)
+{
+  nav2_smac_planner::SearchInfo info;
+  info.use_jump_point_search = true;
+  nav2_smac_planner::AStarAlgorithm<nav2_smac_planner::Node2D> a_star(
+    nav2_smac_planner::MotionModel::MOORE, info);
+  int max_iterations = 10000;
+  int it_on_approach = 10;
+  double max_planning_time = 120.0;
+  a_star.initialize(false, max_iterations, it_on_approach, max_planning_time, 0.0, 1);
+
+  nav2_costmap_2d::Costmap2D * costmapA =
+    new nav2_costmap_2d::Costmap2D(100, 100, 0.1, 0.0, 0.0, 0);
+  // island in the middle of lethal cost to cross, and a line of low cost
+  for (unsigned int i = 40; i <= 60; ++i) {
+    for (unsigned int j = 40; j <= 60; ++j) {
+      costmapA->setCost(i, j, 254);
+    }
+  }
+  for (unsigned int j = 0; j != 100; ++j) {
+    costmapA->setCost(30, j, 10);
+  }
+
+  std::unique_ptr<nav2_smac_planner::GridCollisionChecker> checker =
+    std::make_unique<nav2_smac_planner::GridCollisionChecker>(costmapA, 1);
+  checker->setFootprint(nav2_costmap_2d::Footprint(), true, 0.0);
+
+  // The second plan blocks the first path with a wall, updating the jumps around it
+  for (unsigned int plan = 0; plan != 2; plan++) {
+    a_star.setCollisionChecker(checker.get());
+    a_star.setStart(20u, 20u, 0);
+    a_star.setGoal(80u, 80u, 0);
+    nav2_smac_planner::Node2D::CoordinateVector path;
+    int num_it = 0;
+    EXPECT_TRUE(a_star.createPath(path, num_it, 0.0));
+
+    // Far fewer expansions than the 102 of a search expanding every neighbor, and a
+    // path of neighboring cells as long as its path
+    EXPECT_LT(num_it, 30);
+    EXPECT_EQ(path.size(), 81u);
+    EXPECT_EQ(path.front().x, 80.0f);
+    EXPECT_EQ(path.front().y, 80.0f);
+    EXPECT_LE(std::max(fabs(path.back().x - 20.0f), fabs(path.back().y - 20.0f)), 1.0f);
+    for (unsigned int j = 0; j != path.size(); j++) {
+      EXPECT_LT(costmapA->getCost(path[j].x, path[j].y), 253);
+    }
+    for (unsigned int j = 1; j != path.size(); j++) {
+      EXPECT_EQ(
+        std::max(fabs(path[j].x - path[j - 1].x), fabs(path[j].y - path[j - 1].y)), 1.0f);
+    }
+
+    for (unsigned int i = 60; i <= 80; ++i) {
+      costmapA->setCost(i, 70, 254);
+    }
+  }
+
+  delete costmapA;
+}
+
 TEST(AStarTest, test_se2_single_pose_path)
 {
   nav2_smac_planner::SearchInfo info;
@@ -0,0 +1,108 @@
+// Copyright (c) 2022, Samsung Research America
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License. Reserved.
+
+#include <math.h>
+#include <random>
+#include <vector>
+
+#include "gtest/gtest.h"
+#include "angles/angles.h"
+#include "nav2_smac_planner/analytic_curve.hpp"
+#include "nav2_smac_planner/node_hybrid.hpp"
+
+using nav2_smac_planner::AnalyticCurve;
+using nav2_smac_planner::CurvePath;
+
+TEST(AnalyticCurveTest, test_known_distances)
+{
+  AnalyticCurve dubins(false, 2.0);
+  AnalyticCurve reeds_shepp(true, 2.0);
+  EXPECT_TRUE(dubins.valid());
+  EXPECT_FALSE(AnalyticCurve().valid());
+
+  // Straight ahead
+  EXPECT_NEAR(dubins.distance(1.0, 1.0, 0.0, 6.0, 1.0, 0.0), 5.0, 1e-9);
+  EXPECT_NEAR(reeds_shepp.distance(1.0, 1.0, 0.0, 6.0, 1.0, 0.0), 5.0, 1e-9);
+
+  // A quarter turn to the left
+  EXPECT_NEAR(dubins.distance(0.0, 0.0, 0.0, 2.0, 2.0, M_PI_2), M_PI, 1e-9);
+  EXPECT_NEAR(reeds_shepp.distance(0.0, 0.0, 0.0, 2.0, 2.0, M_PI_2), M_PI, 1e-9);
+
+  // Straight behind, only Reeds-Shepp curves may reverse
+  EXPECT_NEAR(reeds_shepp.distance(0.0, 0.0, 0.0, -3.0, 0.0, 0.0), 3.0, 1e-9);
+  EXPECT_GT(dubins.distance(0.0, 0.0, 0.0, -3.0, 0.0, 0.0), 3.0 + 2.0 * M_PI);
+}
+
+TEST(AnalyticCurveTest, test_interpolation)
+{
+  std::mt19937 gen(42);
+  std::uniform_real_distribution<double> position(-10.0, 10.0);
+  std::uniform_real_distribution<double> heading(-M_PI, M_PI);
+
+  for (bool reverse : {false, true}) {
+    AnalyticCurve curve(reverse, 1.5);
+    for (int i = 0; i != 200; i++) {
+      const double x0 = position(gen), y0 = position(gen), theta0 = heading(gen);
+      const double x1 = position(gen), y1 = position(gen), theta1 = heading(gen);
+      const CurvePath path = curve.getPath(x0, y0, theta0, x1, y1, theta1);
+      ASSERT_TRUE(path.valid());
+      EXPECT_NEAR(curve.length(path), curve.distance(x0, y0, theta0, x1, y1, theta1), 1e-9);
+      EXPECT_GE(curve.length(path), hypot(x1 - x0, y1 - y0) - 1e-9);
+
+      // The ends of the curve are the poses given
+      double x, y, theta;
+      curve.interpolate(path, x0, y0, theta0, 0.0, x, y, theta);
+      EXPECT_NEAR(x, x0, 1e-9);
+      EXPECT_NEAR(y, y0, 1e-9);
+      EXPECT_NEAR(angles::shortest_angular_distance(theta, theta0), 0.0, 1e-9);
+      curve.interpolate(path, x0, y0, theta0, 1.0, x, y, theta);
+      EXPECT_NEAR(x, x1, 1e-6);
+      EXPECT_NEAR(y, y1, 1e-6);
+      EXPECT_NEAR(angles::shortest_angular_distance(theta, theta1), 0.0, 1e-6);
+
+      // The batch interpolation gives the same poses as interpolating each of them
+      const unsigned int num_intervals = 17;
+      std::vector<nav2_smac_planner::NodeHybrid::Coordinates> poses;
+      curve.interpolate(path, x0, y0, theta0, num_intervals, poses);
+      ASSERT_EQ(poses.size(), num_intervals - 1);
+      for (unsigned int j = 1; j != num_intervals; j++) {
+        curve.interpolate(
+          path, x0, y0, theta0, static_cast<double>(j) / num_intervals, x, y, theta);
+        EXPECT_NEAR(poses[j - 1].x, x, 1e-4);
+        EXPECT_NEAR(poses[j - 1].y, y, 1e-4);
+        EXPECT_GE(poses[j - 1].theta, 0.0);
+        EXPECT_LT(poses[j - 1].theta, 2.0 * M_PI);
+        EXPECT_NEAR(angles::shortest_angular_distance(poses[j - 1].theta, theta), 0.0, 1e-4);
+      }
+    }
+  }
+}
+
+TEST(AnalyticCurveTest, test_reeds_shepp_shorter)
+{
+  std::mt19937 gen(7);
+  std::uniform_real_distribution<double> position(-10.0, 10.0);
+  std::uniform_real_distribution<double> heading(-M_PI, M_PI);
+  AnalyticCurve dubins(false, 1.0);
+  AnalyticCurve reeds_shepp(true, 1.0);
+
+  // A Dubins curve, driven forward or backward, is a Reeds-Shepp candidate
+  for (int i = 0; i != 500; i++) {
+    const double x0 = position(gen), y0 = position(gen), theta0 = heading(gen);
+    const double x1 = position(gen), y1 = position(gen), theta1 = heading(gen);
+    const double rs = reeds_shepp.distance(x0, y0, theta0, x1, y1, theta1);
+    EXPECT_LE(rs, dubins.distance(x0, y0, theta0, x1, y1, theta1) + 1e-9);
+    EXPECT_LE(rs, dubins.distance(x1, y1, theta1, x0, y0, theta0) + 1e-9);
+  }
+}
@@ -169,3 +169,96 @@ TEST(collision_footprint, test_point_and_line_cost)
   EXPECT_NEAR(right_value, 254.0, 0.001);
   delete costmap_;
 }
+
+TEST(collision_footprint, test_rasterized_footprint)
+{
+  nav2_costmap_2d::Costmap2D * costmap_ = new nav2_costmap_2d::Costmap2D(
+    100, 100, 0.1, 0, 0, 0);
+  for (unsigned int i = 0; i != 100; ++i) {
+    for (unsigned int j = 0; j != 100; ++j) {
+      costmap_->setCost(i, j, static_cast<unsigned char>((i * 7 + j * 13) % 200));
+    }
+  }
+  costmap_->setCost(30, 30, 254);
+  costmap_->setCost(70, 40, 254);
+  costmap_->setCost(50, 70, 255);
+
+  geometry_msgs::msg::Point p1;
+  p1.x = -0.62;
+  p1.y = 0.33;
+  geometry_msgs::msg::Point p2;
+  p2.x = 0.78;
+  p2.y = 0.33;
+  geometry_msgs::msg::Point p3;
+  p3.x = 0.78;
+  p3.y = -0.33;
+  geometry_msgs::msg::Point p4;
+  p4.x = -0.62;
+  p4.y = -0.33;
+  nav2_costmap_2d::Footprint footprint = {p1, p2, p3, p4};
+
+  nav2_smac_planner::GridCollisionChecker collision_checker(costmap_, 72);
+  collision_checker.setFootprint(footprint, false /*use footprint*/, 0.0);
+  nav2_smac_planner::GridCollisionChecker rasterized_checker(costmap_, 72, true);
+  rasterized_checker.setFootprint(footprint, false /*use footprint*/, 0.0);
+
+  // Cell centered poses rasterize to the same cells as tracing the footprint edges
+  for (unsigned int bin = 0; bin != 72; bin += 18) {
+    for (unsigned int x = 0; x != 100; x += 3) {
+      for (unsigned int y = 0; y != 100; y += 3) {
+        for (bool traverse_unknown : {true, false}) {
+          EXPECT_EQ(
+            collision_checker.inCollision(x, y, bin, traverse_unknown),
+            rasterized_checker.inCollision(x, y, bin, traverse_unknown));
+          EXPECT_EQ(collision_checker.getCost(), rasterized_checker.getCost());
+        }
+      }
+    }
+  }
+
+  // Footprint off of the map is in collision
+  EXPECT_TRUE(rasterized_checker.inCollision(2.0, 50.0, 0.0, true));
+  EXPECT_FALSE(rasterized_checker.inCollision(50.0, 50.0, 0.0, true));
+  delete costmap_;
+}
+
+TEST(collision_footprint, test_shared_footprint_geometry)
+{
+  nav2_costmap_2d::Costmap2D * costmap_ = new nav2_costmap_2d::Costmap2D(
+    100, 100, 0.1, 0, 0, 0);
+  costmap_->setCost(50, 55, 254);
+
+  geometry_msgs::msg::Point p1;
+  p1.x = -0.62;
+  p1.y = 0.33;
+  geometry_msgs::msg::Point p2;
+  p2.x = 0.78;
+  p2.y = 0.33;
+  geometry_msgs::msg::Point p3;
+  p3.x = 0.78;
+  p3.y = -0.33;
+  geometry_msgs::msg::Point p4;
+  p4.x = -0.62;
+  p4.y = -0.33;
+  nav2_costmap_2d::Footprint footprint = {p1, p2, p3, p4};
+  auto geometry = std::make_shared<const nav2_costmap_2d::FootprintGeometry>(footprint);
+
+  nav2_smac_planner::GridCollisionChecker collision_checker(costmap_, 72);
+  collision_checker.setFootprint(footprint, false /*use footprint*/, 0.0);
+  nav2_smac_planner::GridCollisionChecker shared_checker(costmap_, 72);
+  shared_checker.setFootprint(geometry, false /*use footprint*/, 0.0);
+  for (unsigned int bin = 0; bin != 72; bin += 9) {
+    EXPECT_EQ(
+      collision_checker.inCollision(50, 50, bin, false),
+      shared_checker.inCollision(50, 50, bin, false));
+  }
+
+  // The same geometry keeps the swept cells, a new version changes them
+  const unsigned int footprint_id = shared_checker.getFootprintId();
+  shared_checker.setFootprint(geometry, false /*use footprint*/, 0.0);
+  EXPECT_EQ(shared_checker.getFootprintId(), footprint_id);
+  shared_checker.setFootprint(
+    std::make_shared<const nav2_costmap_2d::FootprintGeometry>(footprint), false, 0.0);
+  EXPECT_NE(shared_checker.getFootprintId(), footprint_id);
+  delete costmap_;
+}
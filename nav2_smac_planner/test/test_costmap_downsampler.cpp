@@ -12,12 +12,14 @@
 // See the License for the specific language governing permissions and
 // limitations under the License. Reserved.
 
+#include <algorithm>
 #include <memory>
 #include <vector>
 
 #include "gtest/gtest.h"
 #include "rclcpp/rclcpp.hpp"
 #include "nav2_costmap_2d/costmap_2d.hpp"
+#include "nav2_costmap_2d/layered_costmap.hpp"
 #include "nav2_util/lifecycle_node.hpp"
 #include "nav2_smac_planner/costmap_downsampler.hpp"
 
@@ -29,6 +31,47 @@ public:
 };
 RclCppFixture g_rclcppfixture;
 
+// Sets a cost over a window of cells of the master costmap, at each update
+class WindowLayer : public nav2_costmap_2d::Layer
+{
+public:
+  void setWindow(int x0, int y0, int xn, int yn, unsigned char cost)
+  {
+    x0_ = x0;
+    y0_ = y0;
+    xn_ = xn;
+    yn_ = yn;
+    cost_ = cost;
+  }
+
+  void reset() override {}
+
+  bool isClearable() override {return false;}
+
+  void updateBounds(
+    double, double, double, double * min_x, double * min_y, double * max_x,
+    double * max_y) override
+  {
+    *min_x = std::min(*min_x, x0_ + 0.5);
+    *min_y = std::min(*min_y, y0_ + 0.5);
+    *max_x = std::max(*max_x, xn_ - 0.5);
+    *max_y = std::max(*max_y, yn_ - 0.5);
+  }
+
+  void updateCosts(nav2_costmap_2d::Costmap2D & master_grid, int, int, int, int) override
+  {
+    for (int y = y0_; y < yn_; ++y) {
+      for (int x = x0_; x < xn_; ++x) {
+        master_grid.setCost(x, y, cost_);
+      }
+    }
+  }
+
+protected:
+  int x0_{0}, y0_{0}, xn_{0}, yn_{0};
+  unsigned char cost_{0};
+};
+
 TEST(CostmapDownsampler, costmap_downsample_test)
 {
   nav2_util::LifecycleNode::SharedPtr node = std::make_shared<nav2_util::LifecycleNode>(
@@ -65,3 +108,86 @@ TEST(CostmapDownsampler, costmap_downsample_test)
 
   downsampler.resizeCostmap();
 }
+
+TEST(CostmapDownsampler, costmap_pyramid_test)
+{
+  nav2_util::LifecycleNode::SharedPtr node = std::make_shared<nav2_util::LifecycleNode>(
+    "CostmapDownsamplerTest");
+  nav2_smac_planner::CostmapDownsampler downsampler;
+
+  nav2_costmap_2d::Costmap2D costmap(11, 9, 0.05, 1.0, 2.0, 0);
+  costmap.setCost(0, 0, 100);
+  costmap.setCost(10, 8, 50);
+  costmap.setCost(5, 3, 253);
+
+  nav2_costmap_2d::CostmapPyramid pyramid;
+  pyramid.setLevels(2);
+  pyramid.update(costmap, 0, 0, 11, 9);
+
+  // levels match the costmap downsampled cell by cell
+  downsampler.on_configure(node, "map", "unused_topic", &costmap, 4);
+  nav2_costmap_2d::Costmap2D expected = *downsampler.downsample(4);
+
+  downsampler.setCostmapPyramid(&pyramid);
+  nav2_costmap_2d::Costmap2D * downsampled = downsampler.downsample(4);
+  ASSERT_EQ(downsampled->getSizeInCellsX(), expected.getSizeInCellsX());
+  ASSERT_EQ(downsampled->getSizeInCellsY(), expected.getSizeInCellsY());
+  EXPECT_DOUBLE_EQ(downsampled->getResolution(), 0.2);
+  EXPECT_DOUBLE_EQ(downsampled->getOriginX(), 1.0);
+  EXPECT_DOUBLE_EQ(downsampled->getOriginY(), 2.0);
+  for (unsigned int j = 0; j < expected.getSizeInCellsY(); ++j) {
+    for (unsigned int i = 0; i < expected.getSizeInCellsX(); ++i) {
+      EXPECT_EQ(downsampled->getCost(i, j), expected.getCost(i, j));
+    }
+  }
+
+  // factors without a level are still downsampled
+  downsampled = downsampler.downsample(3);
+  EXPECT_EQ(downsampled->getSizeInCellsX(), 4u);
+  EXPECT_EQ(downsampled->getCost(3, 2), 50);
+}
+
+TEST(CostmapDownsampler, costmap_changed_windows_test)
+{
+  nav2_util::LifecycleNode::SharedPtr node = std::make_shared<nav2_util::LifecycleNode>(
+    "CostmapDownsamplerTest");
+
+  nav2_costmap_2d::LayeredCostmap layers("map", false, false);
+  layers.resizeMap(11, 9, 1.0, 0.0, 0.0);
+  auto layer = std::make_shared<WindowLayer>();
+  layers.addPlugin(layer);
+  layer->setWindow(2, 2, 4, 4, 100);
+  layers.updateMap(0.0, 0.0, 0.0);
+  nav2_costmap_2d::Costmap2D * costmap = layers.getCostmap();
+
+  nav2_smac_planner::CostmapDownsampler downsampler;
+  downsampler.on_configure(node, "map", "unused_topic", costmap, 2);
+  downsampler.setLayeredCostmap(&layers);
+  EXPECT_EQ(downsampler.downsample(2)->getCost(1, 1), 100);
+
+  // A cell changed outside of the updates is not downsampled again
+  costmap->setCost(0, 8, 50);
+  layer->setWindow(7, 5, 11, 6, 253);
+  layers.updateMap(0.0, 0.0, 0.0);
+  nav2_costmap_2d::Costmap2D * downsampled = downsampler.downsample(2);
+  EXPECT_EQ(downsampled->getCost(1, 1), 100);
+  EXPECT_EQ(downsampled->getCost(3, 2), 253);
+  EXPECT_EQ(downsampled->getCost(5, 2), 253);
+  EXPECT_EQ(downsampled->getCost(0, 4), 0);
+
+  // Every other cell matches the costmap downsampled cell by cell
+  nav2_smac_planner::CostmapDownsampler full_downsampler;
+  full_downsampler.on_configure(node, "map", "unused_topic", costmap, 2);
+  nav2_costmap_2d::Costmap2D * expected = full_downsampler.downsample(2);
+  for (unsigned int j = 0; j < expected->getSizeInCellsY(); ++j) {
+    for (unsigned int i = 0; i < expected->getSizeInCellsX(); ++i) {
+      if (i != 0 || j != 4) {
+        EXPECT_EQ(downsampled->getCost(i, j), expected->getCost(i, j));
+      }
+    }
+  }
+
+  // Once the change is known, the whole costmap is downsampled again
+  layers.markUpdated();
+  EXPECT_EQ(downsampler.downsample(2)->getCost(0, 4), 50);
+}
@@ -109,25 +109,25 @@ TEST(Node2DTest, test_node_2d_neighbors)
   nav2_smac_planner::Node2D::initMotionModel(
     nav2_smac_planner::MotionModel::VON_NEUMANN, size_x,
     size_y, quant, info);
-  EXPECT_EQ(nav2_smac_planner::Node2D::_neighbors_grid_offsets.size(), 4u);
-  EXPECT_EQ(nav2_smac_planner::Node2D::_neighbors_grid_offsets[0], -1);
-  EXPECT_EQ(nav2_smac_planner::Node2D::_neighbors_grid_offsets[1], 1);
-  EXPECT_EQ(nav2_smac_planner::Node2D::_neighbors_grid_offsets[2], -10);
-  EXPECT_EQ(nav2_smac_planner::Node2D::_neighbors_grid_offsets[3], 10);
+  EXPECT_EQ(nav2_smac_planner::Node2D::search_state->_neighbors_grid_offsets.size(), 4u);
+  EXPECT_EQ(nav2_smac_planner::Node2D::search_state->_neighbors_grid_offsets[0], -1);
+  EXPECT_EQ(nav2_smac_planner::Node2D::search_state->_neighbors_grid_offsets[1], 1);
+  EXPECT_EQ(nav2_smac_planner::Node2D::search_state->_neighbors_grid_offsets[2], -10);
+  EXPECT_EQ(nav2_smac_planner::Node2D::search_state->_neighbors_grid_offsets[3], 10);
 
   size_x = 100u;
   nav2_smac_planner::Node2D::initMotionModel(
     nav2_smac_planner::MotionModel::MOORE, size_x, size_y,
     quant, info);
-  EXPECT_EQ(nav2_smac_planner::Node2D::_neighbors_grid_offsets.size(), 8u);
-  EXPECT_EQ(nav2_smac_planner::Node2D::_neighbors_grid_offsets[0], -1);
-  EXPECT_EQ(nav2_smac_planner::Node2D::_neighbors_grid_offsets[1], 1);
-  EXPECT_EQ(nav2_smac_planner::Node2D::_neighbors_grid_offsets[2], -100);
-  EXPECT_EQ(nav2_smac_planner::Node2D::_neighbors_grid_offsets[3], 100);
-  EXPECT_EQ(nav2_smac_planner::Node2D::_neighbors_grid_offsets[4], -101);
-  EXPECT_EQ(nav2_smac_planner::Node2D::_neighbors_grid_offsets[5], -99);
-  EXPECT_EQ(nav2_smac_planner::Node2D::_neighbors_grid_offsets[6], 99);
-  EXPECT_EQ(nav2_smac_planner::Node2D::_neighbors_grid_offsets[7], 101);
+  EXPECT_EQ(nav2_smac_planner::Node2D::search_state->_neighbors_grid_offsets.size(), 8u);
+  EXPECT_EQ(nav2_smac_planner::Node2D::search_state->_neighbors_grid_offsets[0], -1);
+  EXPECT_EQ(nav2_smac_planner::Node2D::search_state->_neighbors_grid_offsets[1], 1);
+  EXPECT_EQ(nav2_smac_planner::Node2D::search_state->_neighbors_grid_offsets[2], -100);
+  EXPECT_EQ(nav2_smac_planner::Node2D::search_state->_neighbors_grid_offsets[3], 100);
+  EXPECT_EQ(nav2_smac_planner::Node2D::search_state->_neighbors_grid_offsets[4], -101);
+  EXPECT_EQ(nav2_smac_planner::Node2D::search_state->_neighbors_grid_offsets[5], -99);
+  EXPECT_EQ(nav2_smac_planner::Node2D::search_state->_neighbors_grid_offsets[6], 99);
+  EXPECT_EQ(nav2_smac_planner::Node2D::search_state->_neighbors_grid_offsets[7], 101);
 
   nav2_costmap_2d::Costmap2D costmapA(10, 10, 0.05, 0.0, 0.0, 0);
   std::unique_ptr<nav2_smac_planner::GridCollisionChecker> checker =
@@ -148,3 +148,65 @@ TEST(Node2DTest, test_node_2d_neighbors)
   // should be empty since totally invalid
   EXPECT_EQ(neighbors.size(), 0u);
 }
+
+TEST(Node2DTest, test_node_2d_jump_point_table)
+{
+  nav2_costmap_2d::Costmap2D costmapA(30, 30, 0.05, 0.0, 0.0, 0);
+  for (unsigned int i = 10; i <= 14; ++i) {
+    for (unsigned int j = 10; j <= 14; ++j) {
+      costmapA.setCost(i, j, 254);
+    }
+  }
+  for (unsigned int j = 0; j != 30; ++j) {
+    costmapA.setCost(20, j, 100);
+  }
+
+  nav2_smac_planner::JumpPointTable table;
+  table.update(&costmapA, false);
+  table.setGoals({25u + 5u * 30u});
+  unsigned int successor = 0;
+
+  // Straight jumps stop next to another cost, at a goal, or past an obstacle's corner
+  EXPECT_TRUE(table.jump(0u, {1, 0}, successor));
+  EXPECT_EQ(successor, 19u);
+  EXPECT_TRUE(table.jump(25u, {0, 1}, successor));
+  EXPECT_EQ(successor, 25u + 5u * 30u);
+  EXPECT_TRUE(table.jump(9u * 30u, {1, 0}, successor));
+  EXPECT_EQ(successor, 14u + 9u * 30u);
+  // Or fail running into an obstacle, and step into another cost
+  EXPECT_FALSE(table.jump(12u * 30u, {1, 0}, successor));
+  EXPECT_TRUE(table.jump(19u, {1, 1}, successor));
+  EXPECT_EQ(successor, 20u + 30u);
+
+  // Reached in a straight line in a uniform region, only the natural neighbor is expanded
+  nav2_smac_planner::JumpPointTable::DirectionVector directions;
+  table.getDirections(5u + 5u * 30u, 5u, directions);
+  EXPECT_EQ(directions.size(), 1u);
+  table.getDirections(5u + 5u * 30u, -1, directions);
+  EXPECT_EQ(directions.size(), 8u);
+
+  // Updating the changed cells only matches a table computed anew
+  costmapA.setCost(5, 0, 254);
+  costmapA.setCost(12, 12, 0);
+  costmapA.setCost(20, 7, 0);
+  costmapA.setCost(29, 29, 255);
+  table.update(&costmapA, false);
+  nav2_smac_planner::JumpPointTable new_table;
+  new_table.update(&costmapA, false);
+  new_table.setGoals({25u + 5u * 30u});
+  for (unsigned int index = 0; index != 30u * 30u; ++index) {
+    for (int dx = -1; dx <= 1; ++dx) {
+      for (int dy = -1; dy <= 1; ++dy) {
+        if (dx == 0 && dy == 0) {
+          continue;
+        }
+        unsigned int new_successor = 0;
+        const bool jumped = table.jump(index, {dx, dy}, successor);
+        EXPECT_EQ(jumped, new_table.jump(index, {dx, dy}, new_successor));
+        if (jumped) {
+          EXPECT_EQ(successor, new_successor);
+        }
+      }
+    }
+  }
+}
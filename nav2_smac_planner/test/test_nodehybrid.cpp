@@ -13,6 +13,7 @@
 // limitations under the License. Reserved.
 
 #include <math.h>
+#include <filesystem>
 #include <memory>
 #include <string>
 #include <vector>
@@ -48,7 +49,7 @@ TEST(NodeHybridTest, test_node_hybrid)
 
   // Check defaulted constants
   nav2_smac_planner::NodeHybrid testA(49);
-  EXPECT_EQ(testA.travel_distance_cost, sqrt(2));
+  EXPECT_EQ(testA.search_state->travel_distance_cost, sqrt(2));
 
   nav2_smac_planner::NodeHybrid::initMotionModel(
     nav2_smac_planner::MotionModel::DUBIN, size_x, size_y, size_theta, info);
@@ -76,7 +77,7 @@ TEST(NodeHybridTest, test_node_hybrid)
   EXPECT_TRUE(std::isnan(testA.getCost()));
 
   // Check motion-specific constants
-  EXPECT_NEAR(testA.travel_distance_cost, 2.08842, 0.1);
+  EXPECT_NEAR(testA.search_state->travel_distance_cost, 2.08842, 0.1);
 
   // check collision checking
   EXPECT_EQ(testA.isNodeValid(false, checker.get()), true);
@@ -214,6 +215,244 @@ TEST(NodeHybridTest, test_obstacle_heuristic)
   delete costmapA;
 }
 
+TEST(NodeHybridTest, test_obstacle_heuristic_repair)
+{
+  nav2_smac_planner::SearchInfo info;
+  info.cost_penalty = 1.7;
+  info.minimum_turning_radius = 8;
+  unsigned int size_x = 100;
+  unsigned int size_y = 100;
+  unsigned int size_theta = 72;
+  nav2_smac_planner::NodeHybrid::initMotionModel(
+    nav2_smac_planner::MotionModel::DUBIN, size_x, size_y, size_theta, info);
+
+  nav2_costmap_2d::Costmap2D * costmapA = new nav2_costmap_2d::Costmap2D(
+    100, 100, 0.1, 0.0, 0.0, 0);
+  // wall two cells thick not to be cleared by the downsampled costmap
+  for (unsigned int i = 0; i <= 70; ++i) {
+    costmapA->setCost(i, 50, 254);
+    costmapA->setCost(i, 51, 254);
+  }
+  for (unsigned int i = 20; i <= 40; ++i) {
+    for (unsigned int j = 60; j <= 80; ++j) {
+      costmapA->setCost(i, j, 150);
+    }
+  }
+
+  nav2_smac_planner::NodeHybrid::Coordinates goal(90, 90, 0);
+  std::vector<nav2_smac_planner::NodeHybrid::Coordinates> queries = {
+    {10, 10, 0}, {60, 20, 0}, {10, 90, 0}, {30, 70, 0}};
+
+  auto getCosts = [&](const bool & cache) {
+      nav2_smac_planner::NodeHybrid::resetObstacleHeuristic(
+        costmapA, queries[0].x, queries[0].y, goal.x, goal.y, cache);
+      std::vector<float> costs;
+      for (auto & query : queries) {
+        costs.push_back(
+          nav2_smac_planner::NodeHybrid::getObstacleHeuristic(query, goal, info.cost_penalty));
+      }
+      return costs;
+    };
+
+  // unchanged costmap keeps the cached field
+  std::vector<float> initial = getCosts(false);
+  EXPECT_EQ(getCosts(true), initial);
+
+  // move the wall gap, raising costs along the cached paths
+  for (unsigned int i = 71; i < 100; ++i) {
+    costmapA->setCost(i, 50, 254);
+    costmapA->setCost(i, 51, 254);
+  }
+  costmapA->setCost(10, 50, 0);
+  costmapA->setCost(10, 51, 0);
+  std::vector<float> repaired = getCosts(true);
+  std::vector<float> expected = getCosts(false);
+  for (unsigned int i = 0; i != queries.size(); i++) {
+    EXPECT_NEAR(repaired[i], expected[i], 1e-3);
+  }
+  EXPECT_GT(repaired[1], initial[1]);
+
+  // then clear the high cost area, lowering costs along the cached paths
+  getCosts(true);
+  for (unsigned int i = 20; i <= 40; ++i) {
+    for (unsigned int j = 60; j <= 80; ++j) {
+      costmapA->setCost(i, j, 0);
+    }
+  }
+  repaired = getCosts(true);
+  expected = getCosts(false);
+  for (unsigned int i = 0; i != queries.size(); i++) {
+    EXPECT_NEAR(repaired[i], expected[i], 1e-3);
+  }
+
+  delete costmapA;
+}
+
+TEST(NodeHybridTest, test_obstacle_heuristic_parallel)
+{
+  nav2_costmap_2d::Costmap2D * costmapA = new nav2_costmap_2d::Costmap2D(
+    200, 200, 0.05, 0.0, 0.0, 0);
+  for (unsigned int i = 0; i != 200; ++i) {
+    for (unsigned int j = 0; j != 200; ++j) {
+      costmapA->setCost(i, j, static_cast<unsigned char>((i * j) % 200));
+    }
+  }
+  for (unsigned int i = 20; i <= 180; ++i) {
+    costmapA->setCost(i, 100, 254);
+    costmapA->setCost(100, i, 254);
+  }
+
+  const double cost_penalty = 2.0;
+  nav2_smac_planner::NodeHybrid::Coordinates goal(30, 30, 0);
+  std::vector<nav2_smac_planner::NodeHybrid::Coordinates> queries = {
+    {170, 170, 0}, {170, 30, 0}, {30, 170, 0}, {60, 60, 0}, {100, 100, 0}};
+
+  // the parallel expansion should be the same as expanding only on demand
+  nav2_smac_planner::NodeHybrid::resetObstacleHeuristic(
+    costmapA, queries[0].x, queries[0].y, goal.x, goal.y, false, 1);
+  std::vector<float> expected;
+  for (auto & query : queries) {
+    expected.push_back(
+      nav2_smac_planner::NodeHybrid::getObstacleHeuristic(query, goal, cost_penalty));
+  }
+
+  nav2_smac_planner::NodeHybrid::resetObstacleHeuristic(
+    costmapA, queries[0].x, queries[0].y, goal.x, goal.y, false, 4);
+  for (unsigned int i = 0; i != queries.size(); i++) {
+    EXPECT_NEAR(
+      nav2_smac_planner::NodeHybrid::getObstacleHeuristic(queries[i], goal, cost_penalty),
+      expected[i], 1e-3);
+  }
+  EXPECT_TRUE(nav2_smac_planner::NodeHybrid::search_state->obstacle_heuristic_queue.empty());
+
+  delete costmapA;
+}
+
+TEST(NodeHybridTest, test_obstacle_heuristic_neighborhood)
+{
+  nav2_costmap_2d::Costmap2D * costmapA = new nav2_costmap_2d::Costmap2D(
+    200, 200, 0.05, 0.0, 0.0, 0);
+  // a wall one cell wide once downsampled, not to be jumped over by knight moves
+  for (unsigned int j = 0; j <= 181; ++j) {
+    costmapA->setCost(100, j, 254);
+    costmapA->setCost(101, j, 254);
+  }
+
+  const double cost_penalty = 2.0;
+  nav2_smac_planner::NodeHybrid::Coordinates goal(20, 20, 0);
+  std::vector<nav2_smac_planner::NodeHybrid::Coordinates> queries = {
+    {90, 60, 0}, {60, 180, 0}, {150, 20, 0}};
+
+  auto getCosts = [&](const int & neighborhood, const bool & cache, const int & threads) {
+      nav2_smac_planner::NodeHybrid::resetObstacleHeuristic(
+        costmapA, queries[0].x, queries[0].y, goal.x, goal.y, cache, threads, neighborhood);
+      std::vector<float> costs;
+      for (auto & query : queries) {
+        costs.push_back(
+          nav2_smac_planner::NodeHybrid::getObstacleHeuristic(query, goal, cost_penalty));
+      }
+      return costs;
+    };
+
+  // more moves can only shorten the paths, knight moves following straight lines closer
+  std::vector<float> costs_4 = getCosts(4, false, 1);
+  std::vector<float> costs_8 = getCosts(8, false, 1);
+  std::vector<float> costs_16 = getCosts(16, false, 1);
+  for (unsigned int i = 0; i != queries.size(); i++) {
+    EXPECT_GT(costs_4[i], costs_8[i]);
+    EXPECT_LE(costs_16[i], costs_8[i]);
+    EXPECT_GE(costs_16[i], std::hypot(queries[i].x - goal.x, queries[i].y - goal.y) - 3.0f);
+  }
+  EXPECT_LT(costs_16[0], costs_8[0]);
+  // going around the wall rather than through it
+  EXPECT_GT(costs_16[2], 300.0f);
+
+  // the parallel expansion and the cache give the same costs for each neighborhood
+  for (const int neighborhood : {4, 16}) {
+    std::vector<float> expected = getCosts(neighborhood, false, 1);
+    std::vector<float> parallel = getCosts(neighborhood, false, 4);
+    std::vector<float> cached = getCosts(neighborhood, true, 1);
+    costmapA->setCost(60, 60, 254);
+    std::vector<float> changed = getCosts(neighborhood, true, 1);
+    costmapA->setCost(60, 60, 0);
+    std::vector<float> restored = getCosts(neighborhood, true, 1);
+    for (unsigned int i = 0; i != queries.size(); i++) {
+      EXPECT_NEAR(parallel[i], expected[i], 1e-3);
+      EXPECT_NEAR(cached[i], expected[i], 1e-3);
+      EXPECT_GE(changed[i], expected[i] - 1e-3);
+      EXPECT_NEAR(restored[i], expected[i], 1e-3);
+    }
+  }
+
+  delete costmapA;
+}
+
+TEST(NodeHybridTest, test_distance_heuristic_cache)
+{
+  nav2_smac_planner::SearchInfo info;
+  info.change_penalty = 0.1;
+  info.non_straight_penalty = 1.1;
+  info.reverse_penalty = 2.0;
+  info.minimum_turning_radius = 8;  // 0.4m/5cm resolution costmap
+  info.cost_penalty = 1.7;
+  info.retrospective_penalty = 0.1;
+  const float lookup_table_dim = 21.0;
+  const unsigned int size_theta = 72;
+
+  // Uncached table to compare against
+  nav2_smac_planner::NodeHybrid::precomputeDistanceHeuristic(
+    lookup_table_dim, nav2_smac_planner::MotionModel::DUBIN, size_theta, info);
+  nav2_smac_planner::LookupTable expected_table =
+    nav2_smac_planner::NodeHybrid::search_state->dist_heuristic_lookup_table;
+  nav2_smac_planner::LookupTable & lookup_table =
+    nav2_smac_planner::NodeHybrid::search_state->dist_heuristic_lookup_table;
+
+  std::string cache_directory = "/tmp/nav2_smac_planner_test_distance_heuristic_cache";
+  std::filesystem::remove_all(cache_directory);
+  info.distance_heuristic_cache_directory = cache_directory;
+  // the angles of the headings as computed by the node, which key the file
+  const float angular_bin_size = 2 * M_PI / static_cast<float>(size_theta);
+  std::vector<float> heading_angles;
+  for (unsigned int i = 0; i != size_theta; i++) {
+    heading_angles.push_back(i * angular_bin_size);
+  }
+  nav2_smac_planner::DistanceHeuristicCache cache(
+    cache_directory, nav2_smac_planner::MotionModel::DUBIN,
+    info.minimum_turning_radius, lookup_table_dim, heading_angles);
+
+  // First run computes and writes the table
+  nav2_smac_planner::NodeHybrid::precomputeDistanceHeuristic(
+    lookup_table_dim, nav2_smac_planner::MotionModel::DUBIN, size_theta, info);
+  EXPECT_TRUE(std::filesystem::exists(cache.getFilepath()));
+  EXPECT_EQ(lookup_table, expected_table);
+
+  // Later runs load the cached table
+  nav2_smac_planner::LookupTable cached_table;
+  EXPECT_TRUE(cache.load(cached_table));
+  EXPECT_EQ(cached_table, expected_table);
+  lookup_table.clear();
+  nav2_smac_planner::NodeHybrid::precomputeDistanceHeuristic(
+    lookup_table_dim, nav2_smac_planner::MotionModel::DUBIN, size_theta, info);
+  EXPECT_EQ(lookup_table, expected_table);
+
+  // Other parameters are keyed separately
+  nav2_smac_planner::DistanceHeuristicCache other_cache(
+    cache_directory, nav2_smac_planner::MotionModel::REEDS_SHEPP,
+    info.minimum_turning_radius, lookup_table_dim, heading_angles);
+  EXPECT_NE(other_cache.getFilepath(), cache.getFilepath());
+  EXPECT_FALSE(other_cache.load(cached_table));
+
+  // A truncated cache file is ignored and rewritten
+  std::filesystem::resize_file(cache.getFilepath(), 100);
+  EXPECT_FALSE(cache.load(cached_table));
+  nav2_smac_planner::NodeHybrid::precomputeDistanceHeuristic(
+    lookup_table_dim, nav2_smac_planner::MotionModel::DUBIN, size_theta, info);
+  EXPECT_EQ(lookup_table, expected_table);
+  EXPECT_TRUE(cache.load(cached_table));
+
+  std::filesystem::remove_all(cache_directory);
+}
+
 TEST(NodeHybridTest, test_node_debin_neighbors)
 {
   nav2_smac_planner::SearchInfo info;
@@ -227,20 +466,51 @@ TEST(NodeHybridTest, test_node_debin_neighbors)
   unsigned int size_theta = 72;
   nav2_smac_planner::NodeHybrid::initMotionModel(
     nav2_smac_planner::MotionModel::DUBIN, size_x, size_y, size_theta, info);
+  const auto & primitives = nav2_smac_planner::NodeHybrid::search_state->motion_table.projections;
 
   // test neighborhood computation
-  EXPECT_EQ(nav2_smac_planner::NodeHybrid::motion_table.projections.size(), 3u);
-  EXPECT_NEAR(nav2_smac_planner::NodeHybrid::motion_table.projections[0]._x, 1.731517, 0.01);
-  EXPECT_NEAR(nav2_smac_planner::NodeHybrid::motion_table.projections[0]._y, 0, 0.01);
-  EXPECT_NEAR(nav2_smac_planner::NodeHybrid::motion_table.projections[0]._theta, 0, 0.01);
-
-  EXPECT_NEAR(nav2_smac_planner::NodeHybrid::motion_table.projections[1]._x, 1.69047, 0.01);
-  EXPECT_NEAR(nav2_smac_planner::NodeHybrid::motion_table.projections[1]._y, 0.3747, 0.01);
-  EXPECT_NEAR(nav2_smac_planner::NodeHybrid::motion_table.projections[1]._theta, 5, 0.01);
-
-  EXPECT_NEAR(nav2_smac_planner::NodeHybrid::motion_table.projections[2]._x, 1.69047, 0.01);
-  EXPECT_NEAR(nav2_smac_planner::NodeHybrid::motion_table.projections[2]._y, -0.3747, 0.01);
-  EXPECT_NEAR(nav2_smac_planner::NodeHybrid::motion_table.projections[2]._theta, -5, 0.01);
+  EXPECT_EQ(primitives.size(), 3u);
+  EXPECT_NEAR(primitives[0]._x, 1.731517, 0.01);
+  EXPECT_NEAR(primitives[0]._y, 0, 0.01);
+  EXPECT_NEAR(primitives[0]._theta, 0, 0.01);
+
+  EXPECT_NEAR(primitives[1]._x, 1.69047, 0.01);
+  EXPECT_NEAR(primitives[1]._y, 0.3747, 0.01);
+  EXPECT_NEAR(primitives[1]._theta, 5, 0.01);
+
+  EXPECT_NEAR(primitives[2]._x, 1.69047, 0.01);
+  EXPECT_NEAR(primitives[2]._y, -0.3747, 0.01);
+  EXPECT_NEAR(primitives[2]._theta, -5, 0.01);
+
+  // the neighbors expanded are the projections of the node
+  nav2_costmap_2d::Costmap2D costmapA(100, 100, 0.05, 0.0, 0.0, 0);
+  std::unique_ptr<nav2_smac_planner::GridCollisionChecker> checker =
+    std::make_unique<nav2_smac_planner::GridCollisionChecker>(&costmapA, 72);
+  checker->setFootprint(nav2_costmap_2d::Footprint(), true, 0.0);
+  std::vector<nav2_smac_planner::NodeHybrid> graph;
+  for (unsigned int index = 0; index != size_x * size_y * size_theta; ++index) {
+    graph.emplace_back(index);
+  }
+  std::function<bool(const unsigned int &, nav2_smac_planner::NodeHybrid * &)> neighborGetter =
+    [&](const unsigned int & index, nav2_smac_planner::NodeHybrid * & neighbor_rtn) -> bool
+    {
+      neighbor_rtn = &graph[index];
+      return true;
+    };
+
+  nav2_smac_planner::NodeHybrid node(0);
+  node.pose = nav2_smac_planner::NodeHybrid::Coordinates(50.0, 50.0, 10.0);
+  nav2_smac_planner::MotionPoses projections =
+    nav2_smac_planner::NodeHybrid::search_state->motion_table.getProjections(&node);
+  nav2_smac_planner::NodeHybrid::NodeVector neighbors;
+  node.getNeighbors(neighborGetter, checker.get(), false, neighbors);
+  ASSERT_EQ(neighbors.size(), 3u);
+  for (unsigned int i = 0; i != neighbors.size(); ++i) {
+    EXPECT_EQ(neighbors[i]->getMotionPrimitiveIndex(), i);
+    EXPECT_EQ(neighbors[i]->pose.x, projections[i]._x);
+    EXPECT_EQ(neighbors[i]->pose.y, projections[i]._y);
+    EXPECT_EQ(neighbors[i]->pose.theta, projections[i]._theta);
+  }
 }
 
 TEST(NodeHybridTest, test_node_reeds_neighbors)
@@ -256,31 +526,41 @@ TEST(NodeHybridTest, test_node_reeds_neighbors)
   unsigned int size_theta = 72;
   nav2_smac_planner::NodeHybrid::initMotionModel(
     nav2_smac_planner::MotionModel::REEDS_SHEPP, size_x, size_y, size_theta, info);
-
-  EXPECT_EQ(nav2_smac_planner::NodeHybrid::motion_table.projections.size(), 6u);
-  EXPECT_NEAR(nav2_smac_planner::NodeHybrid::motion_table.projections[0]._x, 2.088, 0.01);
-  EXPECT_NEAR(nav2_smac_planner::NodeHybrid::motion_table.projections[0]._y, 0, 0.01);
-  EXPECT_NEAR(nav2_smac_planner::NodeHybrid::motion_table.projections[0]._theta, 0, 0.01);
-
-  EXPECT_NEAR(nav2_smac_planner::NodeHybrid::motion_table.projections[1]._x, 2.070, 0.01);
-  EXPECT_NEAR(nav2_smac_planner::NodeHybrid::motion_table.projections[1]._y, 0.272, 0.01);
-  EXPECT_NEAR(nav2_smac_planner::NodeHybrid::motion_table.projections[1]._theta, 3, 0.01);
-
-  EXPECT_NEAR(nav2_smac_planner::NodeHybrid::motion_table.projections[2]._x, 2.070, 0.01);
-  EXPECT_NEAR(nav2_smac_planner::NodeHybrid::motion_table.projections[2]._y, -0.272, 0.01);
-  EXPECT_NEAR(nav2_smac_planner::NodeHybrid::motion_table.projections[2]._theta, -3, 0.01);
-
-  EXPECT_NEAR(nav2_smac_planner::NodeHybrid::motion_table.projections[3]._x, -2.088, 0.01);
-  EXPECT_NEAR(nav2_smac_planner::NodeHybrid::motion_table.projections[3]._y, 0, 0.01);
-  EXPECT_NEAR(nav2_smac_planner::NodeHybrid::motion_table.projections[3]._theta, 0, 0.01);
-
-  EXPECT_NEAR(nav2_smac_planner::NodeHybrid::motion_table.projections[4]._x, -2.07, 0.01);
-  EXPECT_NEAR(nav2_smac_planner::NodeHybrid::motion_table.projections[4]._y, 0.272, 0.01);
-  EXPECT_NEAR(nav2_smac_planner::NodeHybrid::motion_table.projections[4]._theta, -3, 0.01);
-
-  EXPECT_NEAR(nav2_smac_planner::NodeHybrid::motion_table.projections[5]._x, -2.07, 0.01);
-  EXPECT_NEAR(nav2_smac_planner::NodeHybrid::motion_table.projections[5]._y, -0.272, 0.01);
-  EXPECT_NEAR(nav2_smac_planner::NodeHybrid::motion_table.projections[5]._theta, 3, 0.01);
+  const auto & primitives = nav2_smac_planner::NodeHybrid::search_state->motion_table.projections;
+
+  EXPECT_EQ(primitives.size(), 6u);
+  EXPECT_NEAR(primitives[0]._x, 2.088, 0.01);
+  EXPECT_NEAR(primitives[0]._y, 0, 0.01);
+  EXPECT_NEAR(primitives[0]._theta, 0, 0.01);
+
+  EXPECT_NEAR(primitives[1]._x, 2.070, 0.01);
+  EXPECT_NEAR(primitives[1]._y, 0.272, 0.01);
+  EXPECT_NEAR(primitives[1]._theta, 3, 0.01);
+
+  EXPECT_NEAR(primitives[2]._x, 2.070, 0.01);
+  EXPECT_NEAR(primitives[2]._y, -0.272, 0.01);
+  EXPECT_NEAR(primitives[2]._theta, -3, 0.01);
+
+  EXPECT_NEAR(primitives[3]._x, -2.088, 0.01);
+  EXPECT_NEAR(primitives[3]._y, 0, 0.01);
+  EXPECT_NEAR(primitives[3]._theta, 0, 0.01);
+
+  EXPECT_NEAR(primitives[4]._x, -2.07, 0.01);
+  EXPECT_NEAR(primitives[4]._y, 0.272, 0.01);
+  EXPECT_NEAR(primitives[4]._theta, -3, 0.01);
+
+  EXPECT_NEAR(primitives[5]._x, -2.07, 0.01);
+  EXPECT_NEAR(primitives[5]._y, -0.272, 0.01);
+  EXPECT_NEAR(primitives[5]._theta, 3, 0.01);
+
+  // turning and reversing penalties are tabled by primitive
+  const auto & motion_table = nav2_smac_planner::NodeHybrid::search_state->motion_table;
+  EXPECT_EQ(motion_table.turn_penalties[1][0], 1.0f);
+  EXPECT_EQ(motion_table.turn_penalties[4][3], 1.0f);
+  EXPECT_EQ(motion_table.turn_penalties[1][1], 1.4f);
+  EXPECT_EQ(motion_table.turn_penalties[1][2], 1.4f + 1.2f);
+  EXPECT_EQ(motion_table.reverse_penalties[2], 1.0f);
+  EXPECT_EQ(motion_table.reverse_penalties[3], 2.1f);
 
   nav2_costmap_2d::Costmap2D costmapA(100, 100, 0.05, 0.0, 0.0, 0);
   std::unique_ptr<nav2_smac_planner::GridCollisionChecker> checker =
@@ -83,6 +83,86 @@ TEST(NodeLatticeTest, parser_test)
   EXPECT_NEAR(myPrimitives[0].poses[1]._theta, 6.09345, 0.015);
 }
 
+TEST(NodeLatticeTest, binary_parser_test)
+{
+  std::string pkg_share_dir = ament_index_cpp::get_package_share_directory("nav2_smac_planner");
+  std::string filePath =
+    pkg_share_dir +
+    "/sample_primitives/5cm_resolution/0.5m_turning_radius/ackermann" +
+    "/output.json";
+  std::ifstream myJsonFile(filePath);
+
+  ASSERT_TRUE(myJsonFile.is_open());
+
+  json j;
+  myJsonFile >> j;
+
+  nav2_smac_planner::LatticeMetadata metaData;
+  nav2_smac_planner::fromJsonToMetaData(j["lattice_metadata"], metaData);
+  std::vector<nav2_smac_planner::MotionPrimitive> myPrimitives;
+  for (unsigned int i = 0; i < j["primitives"].size(); ++i) {
+    nav2_smac_planner::MotionPrimitive newPrimative;
+    nav2_smac_planner::fromJsonToMotionPrimitive(j["primitives"][i], newPrimative);
+    myPrimitives.push_back(newPrimative);
+  }
+
+  // Round trip the lattice through the binary format
+  std::string binaryFilePath = "/tmp/nav2_smac_planner_test_lattice.bin";
+  nav2_smac_planner::LatticeBinaryFile::write(binaryFilePath, metaData, myPrimitives);
+  EXPECT_TRUE(nav2_smac_planner::LatticeBinaryFile::isLatticeBinaryFile(binaryFilePath));
+  EXPECT_FALSE(nav2_smac_planner::LatticeBinaryFile::isLatticeBinaryFile(filePath));
+
+  nav2_smac_planner::LatticeMetadata binaryMetaData =
+    nav2_smac_planner::LatticeMotionTable::getLatticeMetadata(binaryFilePath);
+  EXPECT_EQ(binaryMetaData.min_turning_radius, metaData.min_turning_radius);
+  EXPECT_EQ(binaryMetaData.grid_resolution, metaData.grid_resolution);
+  EXPECT_EQ(binaryMetaData.number_of_headings, metaData.number_of_headings);
+  EXPECT_EQ(binaryMetaData.heading_angles, metaData.heading_angles);
+  EXPECT_EQ(binaryMetaData.number_of_trajectories, metaData.number_of_trajectories);
+  EXPECT_EQ(binaryMetaData.motion_model, metaData.motion_model);
+
+  std::vector<nav2_smac_planner::MotionPrimitive> binaryPrimitives;
+  nav2_smac_planner::LatticeBinaryFile(binaryFilePath).getMotionPrimitives(binaryPrimitives);
+  ASSERT_EQ(binaryPrimitives.size(), myPrimitives.size());
+  for (unsigned int i = 0; i != myPrimitives.size(); i++) {
+    EXPECT_EQ(binaryPrimitives[i].trajectory_id, myPrimitives[i].trajectory_id);
+    EXPECT_EQ(binaryPrimitives[i].start_angle, myPrimitives[i].start_angle);
+    EXPECT_EQ(binaryPrimitives[i].end_angle, myPrimitives[i].end_angle);
+    EXPECT_EQ(binaryPrimitives[i].turning_radius, myPrimitives[i].turning_radius);
+    EXPECT_EQ(binaryPrimitives[i].trajectory_length, myPrimitives[i].trajectory_length);
+    EXPECT_EQ(binaryPrimitives[i].arc_length, myPrimitives[i].arc_length);
+    EXPECT_EQ(binaryPrimitives[i].straight_length, myPrimitives[i].straight_length);
+    EXPECT_EQ(binaryPrimitives[i].left_turn, myPrimitives[i].left_turn);
+    ASSERT_EQ(binaryPrimitives[i].poses.size(), myPrimitives[i].poses.size());
+    for (unsigned int k = 0; k != myPrimitives[i].poses.size(); k++) {
+      EXPECT_EQ(binaryPrimitives[i].poses[k]._x, myPrimitives[i].poses[k]._x);
+      EXPECT_EQ(binaryPrimitives[i].poses[k]._y, myPrimitives[i].poses[k]._y);
+      EXPECT_EQ(binaryPrimitives[i].poses[k]._theta, myPrimitives[i].poses[k]._theta);
+    }
+  }
+
+  // The motion table loads binary lattice files the same as JSON
+  nav2_smac_planner::SearchInfo info;
+  info.lattice_filepath = binaryFilePath;
+  unsigned int x = 100;
+  unsigned int y = 100;
+  unsigned int angle_quantization = 16;
+  nav2_smac_planner::NodeLattice::initMotionModel(
+    nav2_smac_planner::MotionModel::STATE_LATTICE, x, y, angle_quantization, info);
+  std::vector<std::vector<nav2_smac_planner::MotionPrimitive>> & tablePrimitives =
+    nav2_smac_planner::NodeLattice::search_state->motion_table.motion_primitives;
+  EXPECT_EQ(tablePrimitives.size(), 16u);
+  EXPECT_EQ(tablePrimitives[0][0].trajectory_id, myPrimitives[0].trajectory_id);
+  EXPECT_EQ(tablePrimitives[15].back().trajectory_id, myPrimitives.back().trajectory_id);
+
+  // Corrupt files are rejected rather than read out of bounds
+  std::ofstream truncated(binaryFilePath, std::ios::binary | std::ios::trunc);
+  truncated.write(nav2_smac_planner::LATTICE_BINARY_MAGIC, 8);
+  truncated.close();
+  EXPECT_THROW(
+    nav2_smac_planner::LatticeBinaryFile binaryFile(binaryFilePath), std::runtime_error);
+}
+
 TEST(NodeLatticeTest, test_node_lattice_neighbors_and_parsing)
 {
   std::string pkg_share_dir = ament_index_cpp::get_package_share_directory("nav2_smac_planner");
@@ -113,14 +193,14 @@ TEST(NodeLatticeTest, test_node_lattice_neighbors_and_parsing)
   nav2_smac_planner::NodeLattice aNode(0);
   aNode.setPose(nav2_smac_planner::NodeHybrid::Coordinates(0, 0, 0));
   nav2_smac_planner::MotionPrimitivePtrs projections =
-    nav2_smac_planner::NodeLattice::motion_table.getMotionPrimitives(&aNode);
+    nav2_smac_planner::NodeLattice::search_state->motion_table.getMotionPrimitives(&aNode);
 
   EXPECT_NEAR(projections[0]->poses.back()._x, 0.5, 0.01);
   EXPECT_NEAR(projections[0]->poses.back()._y, -0.35, 0.01);
   EXPECT_NEAR(projections[0]->poses.back()._theta, 5.176, 0.01);
 
   EXPECT_NEAR(
-    nav2_smac_planner::NodeLattice::motion_table.getLatticeMetadata(
+    nav2_smac_planner::NodeLattice::search_state->motion_table.getLatticeMetadata(
       filePath).grid_resolution, 0.05, 0.005);
 }
 
@@ -153,13 +233,13 @@ TEST(NodeLatticeTest, test_node_lattice_conversions)
   nav2_smac_planner::NodeLattice aNode(0);
   aNode.setPose(nav2_smac_planner::NodeHybrid::Coordinates(0, 0, 0));
 
-  EXPECT_NEAR(aNode.motion_table.getAngleFromBin(0u), 0.0, 0.005);
-  EXPECT_NEAR(aNode.motion_table.getAngleFromBin(1u), 0.46364, 0.005);
-  EXPECT_NEAR(aNode.motion_table.getAngleFromBin(2u), 0.78539, 0.005);
+  EXPECT_NEAR(aNode.search_state->motion_table.getAngleFromBin(0u), 0.0, 0.005);
+  EXPECT_NEAR(aNode.search_state->motion_table.getAngleFromBin(1u), 0.46364, 0.005);
+  EXPECT_NEAR(aNode.search_state->motion_table.getAngleFromBin(2u), 0.78539, 0.005);
 
-  EXPECT_EQ(aNode.motion_table.getClosestAngularBin(0.0), 0u);
-  EXPECT_EQ(aNode.motion_table.getClosestAngularBin(0.5), 1u);
-  EXPECT_EQ(aNode.motion_table.getClosestAngularBin(1.5), 4u);
+  EXPECT_EQ(aNode.search_state->motion_table.getClosestAngularBin(0.0), 0u);
+  EXPECT_EQ(aNode.search_state->motion_table.getClosestAngularBin(0.5), 1u);
+  EXPECT_EQ(aNode.search_state->motion_table.getClosestAngularBin(1.5), 4u);
 }
 
 TEST(NodeLatticeTest, test_node_lattice)
@@ -238,6 +318,100 @@ TEST(NodeLatticeTest, test_node_lattice)
   delete costmapA;
 }
 
+TEST(NodeLatticeTest, test_node_lattice_swept_footprint)
+{
+  std::string pkg_share_dir = ament_index_cpp::get_package_share_directory("nav2_smac_planner");
+  std::string filePath =
+    pkg_share_dir +
+    "/sample_primitives/5cm_resolution/0.5m_turning_radius/ackermann" +
+    "/output.json";
+
+  nav2_smac_planner::SearchInfo info;
+  info.minimum_turning_radius = 1.1;
+  info.non_straight_penalty = 1;
+  info.change_penalty = 1;
+  info.reverse_penalty = 1;
+  info.cost_penalty = 1;
+  info.retrospective_penalty = 0.1;
+  info.analytic_expansion_ratio = 1;
+  info.lattice_filepath = filePath;
+  info.cache_obstacle_heuristic = true;
+  info.allow_reverse_expansion = true;
+
+  unsigned int x = 100;
+  unsigned int y = 100;
+  unsigned int angle_quantization = 16;
+
+  nav2_smac_planner::NodeLattice::initMotionModel(
+    nav2_smac_planner::MotionModel::STATE_LATTICE, x, y, angle_quantization, info);
+
+  nav2_costmap_2d::Costmap2D * costmapA = new nav2_costmap_2d::Costmap2D(
+    100, 100, 0.05, 0.0, 0.0, 50);
+
+  geometry_msgs::msg::Point p1;
+  p1.x = -0.12;
+  p1.y = 0.08;
+  geometry_msgs::msg::Point p2;
+  p2.x = 0.12;
+  p2.y = 0.08;
+  geometry_msgs::msg::Point p3;
+  p3.x = 0.12;
+  p3.y = -0.08;
+  geometry_msgs::msg::Point p4;
+  p4.x = -0.12;
+  p4.y = -0.08;
+  nav2_costmap_2d::Footprint footprint = {p1, p2, p3, p4};
+
+  nav2_smac_planner::GridCollisionChecker checker(costmapA, 72);
+  checker.setFootprint(footprint, false, 0.0);
+  nav2_smac_planner::GridCollisionChecker rasterized_checker(costmapA, 72, true);
+  rasterized_checker.setFootprint(footprint, false, 0.0);
+
+  // Primitives from the center of the map, with the node at the end of the primitive
+  nav2_smac_planner::NodeLattice node(0);
+  std::vector<nav2_smac_planner::MotionPrimitive> & primitives =
+    nav2_smac_planner::NodeLattice::search_state->motion_table.motion_primitives[0];
+  const float & resolution =
+    nav2_smac_planner::NodeLattice::search_state->motion_table.lattice_metadata.grid_resolution;
+  auto checkPrimitives = [&](const bool & expected_valid) {
+      for (unsigned int i = 0; i != primitives.size(); i++) {
+        node.pose.x = 50 + primitives[i].poses.back()._x / resolution;
+        node.pose.y = 50 + primitives[i].poses.back()._y / resolution;
+        node.pose.theta = primitives[i].end_angle;
+        const bool valid = node.isNodeValid(false, &checker, &primitives[i]);
+        const float cost = node.getCost();
+        EXPECT_EQ(node.isNodeValid(false, &rasterized_checker, &primitives[i]), valid);
+        EXPECT_EQ(valid, expected_valid);
+        if (valid) {
+          EXPECT_EQ(node.getCost(), cost);
+        }
+      }
+    };
+
+  // Free space is valid and the swept cost is a footprint cost
+  checkPrimitives(true);
+
+  // A wall along the start of the primitives collides with the swept footprint
+  for (unsigned int i = 50; i != 60; i++) {
+    costmapA->setCost(i, 50, nav2_costmap_2d::LETHAL_OBSTACLE);
+  }
+  checkPrimitives(false);
+
+  // Changing the footprint resweeps the primitives, checking only their centers
+  checker.setFootprint(nav2_costmap_2d::Footprint(), true, 0.0);
+  rasterized_checker.setFootprint(nav2_costmap_2d::Footprint(), true, 0.0);
+  for (unsigned int i = 0; i != primitives.size(); i++) {
+    node.pose.x = 50 + primitives[i].poses.back()._x / resolution;
+    node.pose.y = 50 + primitives[i].poses.back()._y / resolution;
+    node.pose.theta = primitives[i].end_angle;
+    EXPECT_EQ(
+      node.isNodeValid(false, &checker, &primitives[i]),
+      node.isNodeValid(false, &rasterized_checker, &primitives[i]));
+  }
+
+  delete costmapA;
+}
+
 
 TEST(NodeLatticeTest, test_get_neighbors)
 {
@@ -0,0 +1,110 @@
+// Copyright (c) 2021, Samsung Research America
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License. Reserved.
+
+#include <math.h>
+#include <memory>
+#include <string>
+
+#include "gtest/gtest.h"
+#include "nav2_smac_planner/path_reuse.hpp"
+
+geometry_msgs::msg::PoseStamped makePose(const double & x, const double & y, const double & yaw)
+{
+  geometry_msgs::msg::PoseStamped pose;
+  pose.header.frame_id = "map";
+  pose.pose.position.x = x;
+  pose.pose.position.y = y;
+  pose.pose.orientation.z = sin(yaw / 2.0);
+  pose.pose.orientation.w = cos(yaw / 2.0);
+  return pose;
+}
+
+TEST(PathReuseTest, test_path_reuse)
+{
+  nav2_smac_planner::PathReuse path_reuse(0.5, 1.0);
+  auto no_collision = [](const geometry_msgs::msg::Pose &) {return false;};
+  nav_msgs::msg::Path plan;
+  unsigned int repair_start, repair_end;
+
+  // straight plan from (0, 0) to (5, 0) every 5 cm
+  nav_msgs::msg::Path last_plan;
+  last_plan.header.frame_id = "map";
+  for (unsigned int i = 0; i <= 100; i++) {
+    last_plan.poses.push_back(makePose(i * 0.05, 0.0, 0.0));
+  }
+  auto goal = makePose(5.0, 0.0, 0.0);
+
+  // no last plan
+  EXPECT_FALSE(
+    path_reuse.findReusablePath(
+      makePose(1.0, 0.1, 0.0), goal, no_collision, plan, repair_start, repair_end));
+  path_reuse.setPlan(last_plan, goal);
+
+  // collision-free, reused from the pose closest to the start
+  EXPECT_TRUE(
+    path_reuse.findReusablePath(
+      makePose(1.0, 0.1, 0.0), goal, no_collision, plan, repair_start, repair_end));
+  EXPECT_EQ(plan.poses.size(), 81u);
+  EXPECT_NEAR(plan.poses.front().pose.position.x, 1.0, 1e-6);
+  EXPECT_EQ(repair_start, repair_end);
+
+  // another goal, or the start away from the plan
+  EXPECT_FALSE(
+    path_reuse.findReusablePath(
+      makePose(1.0, 0.1, 0.0), makePose(5.0, 1.0, 0.0), no_collision, plan,
+      repair_start, repair_end));
+  EXPECT_FALSE(
+    path_reuse.findReusablePath(
+      makePose(1.0, 0.1, M_PI), goal, no_collision, plan, repair_start, repair_end));
+  EXPECT_FALSE(
+    path_reuse.findReusablePath(
+      makePose(1.0, 1.0, 0.0), goal, no_collision, plan, repair_start, repair_end));
+
+  // an obstacle on the plan, replanned with the margin around it
+  auto obstacle = [](const geometry_msgs::msg::Pose & pose) {
+      return pose.position.x > 2.52 && pose.position.x < 2.68;
+    };
+  EXPECT_TRUE(
+    path_reuse.findReusablePath(
+      makePose(1.0, 0.1, 0.0), goal, obstacle, plan, repair_start, repair_end));
+  EXPECT_LT(repair_start, repair_end);
+  EXPECT_NEAR(plan.poses[repair_start].pose.position.x, 1.5, 0.06);
+  EXPECT_NEAR(plan.poses[repair_end].pose.position.x, 3.7, 0.06);
+
+  // the margin is cut at the ends of the plan
+  EXPECT_TRUE(
+    path_reuse.findReusablePath(
+      makePose(2.0, 0.0, 0.0), goal, obstacle, plan, repair_start, repair_end));
+  EXPECT_EQ(repair_start, 0u);
+
+  // not reused with the start or goal in collision
+  auto start_obstacle = [](const geometry_msgs::msg::Pose & pose) {
+      return pose.position.x < 1.1;
+    };
+  EXPECT_FALSE(
+    path_reuse.findReusablePath(
+      makePose(1.0, 0.1, 0.0), goal, start_obstacle, plan, repair_start, repair_end));
+  auto goal_obstacle = [](const geometry_msgs::msg::Pose & pose) {
+      return pose.position.x > 4.9;
+    };
+  EXPECT_FALSE(
+    path_reuse.findReusablePath(
+      makePose(1.0, 0.1, 0.0), goal, goal_obstacle, plan, repair_start, repair_end));
+
+  // forgotten once cleared
+  path_reuse.clear();
+  EXPECT_FALSE(
+    path_reuse.findReusablePath(
+      makePose(1.0, 0.1, 0.0), goal, no_collision, plan, repair_start, repair_end));
+}
@@ -109,7 +109,9 @@ TEST(SmacTest, test_smac_2d_reconfigure) {
       rclcpp::Parameter("test.max_iterations", -1),
       rclcpp::Parameter("test.max_on_approach_iterations", -1),
       rclcpp::Parameter("test.motion_model_for_search", "UNKNOWN"),
-      rclcpp::Parameter("test.use_final_approach_orientation", false)});
+      rclcpp::Parameter("test.use_final_approach_orientation", false),
+      rclcpp::Parameter("test.use_dense_graph", true),
+      rclcpp::Parameter("test.use_jump_point_search", true)});
 
   rclcpp::spin_until_future_complete(
     node2D->get_node_base_interface(),
@@ -125,6 +127,8 @@ TEST(SmacTest, test_smac_2d_reconfigure) {
   EXPECT_EQ(node2D->get_parameter("test.downsampling_factor").as_int(), 2);
   EXPECT_EQ(node2D->get_parameter("test.max_iterations").as_int(), -1);
   EXPECT_EQ(node2D->get_parameter("test.use_final_approach_orientation").as_bool(), false);
+  EXPECT_EQ(node2D->get_parameter("test.use_dense_graph").as_bool(), true);
+  EXPECT_EQ(node2D->get_parameter("test.use_jump_point_search").as_bool(), true);
   EXPECT_EQ(
     node2D->get_parameter("test.max_on_approach_iterations").as_int(),
     -1);
@@ -54,6 +54,8 @@ TEST(SmacTest, test_smac_se2)
   nodeSE2->set_parameter(rclcpp::Parameter("test.downsample_costmap", true));
   nodeSE2->declare_parameter("test.downsampling_factor", 2);
   nodeSE2->set_parameter(rclcpp::Parameter("test.downsampling_factor", 2));
+  nodeSE2->declare_parameter("test.corridor_search", true);
+  nodeSE2->set_parameter(rclcpp::Parameter("test.corridor_search", true));
 
   geometry_msgs::msg::PoseStamped start, goal;
   start.pose.position.x = 0.0;
@@ -106,6 +108,8 @@ TEST(SmacTest, test_smac_se2_reconfigure)
       rclcpp::Parameter("test.max_iterations", -1),
       rclcpp::Parameter("test.minimum_turning_radius", 1.0),
       rclcpp::Parameter("test.cache_obstacle_heuristic", true),
+      rclcpp::Parameter("test.obstacle_heuristic_threads", 2),
+      rclcpp::Parameter("test.obstacle_heuristic_neighborhood", 16),
       rclcpp::Parameter("test.reverse_penalty", 5.0),
       rclcpp::Parameter("test.change_penalty", 1.0),
       rclcpp::Parameter("test.non_straight_penalty", 2.0),
@@ -116,6 +120,11 @@ TEST(SmacTest, test_smac_se2_reconfigure)
       rclcpp::Parameter("test.lookup_table_size", 30.0),
       rclcpp::Parameter("test.smooth_path", false),
       rclcpp::Parameter("test.analytic_expansion_max_length", 42.0),
+      rclcpp::Parameter("test.corridor_search", true),
+      rclcpp::Parameter("test.corridor_downsampling_factor", 3),
+      rclcpp::Parameter("test.corridor_radius", 1.5),
+      rclcpp::Parameter("test.reuse_path", true),
+      rclcpp::Parameter("test.reuse_path_max_deviation", 0.3),
       rclcpp::Parameter("test.motion_model_for_search", std::string("REEDS_SHEPP"))});
 
   rclcpp::spin_until_future_complete(
@@ -129,6 +138,8 @@ TEST(SmacTest, test_smac_se2_reconfigure)
   EXPECT_EQ(nodeSE2->get_parameter("test.max_iterations").as_int(), -1);
   EXPECT_EQ(nodeSE2->get_parameter("test.minimum_turning_radius").as_double(), 1.0);
   EXPECT_EQ(nodeSE2->get_parameter("test.cache_obstacle_heuristic").as_bool(), true);
+  EXPECT_EQ(nodeSE2->get_parameter("test.obstacle_heuristic_threads").as_int(), 2);
+  EXPECT_EQ(nodeSE2->get_parameter("test.obstacle_heuristic_neighborhood").as_int(), 16);
   EXPECT_EQ(nodeSE2->get_parameter("test.reverse_penalty").as_double(), 5.0);
   EXPECT_EQ(nodeSE2->get_parameter("test.change_penalty").as_double(), 1.0);
   EXPECT_EQ(nodeSE2->get_parameter("test.non_straight_penalty").as_double(), 2.0);
@@ -136,6 +147,11 @@ TEST(SmacTest, test_smac_se2_reconfigure)
   EXPECT_EQ(nodeSE2->get_parameter("test.retrospective_penalty").as_double(), 0.2);
   EXPECT_EQ(nodeSE2->get_parameter("test.analytic_expansion_ratio").as_double(), 4.0);
   EXPECT_EQ(nodeSE2->get_parameter("test.smooth_path").as_bool(), false);
+  EXPECT_EQ(nodeSE2->get_parameter("test.corridor_search").as_bool(), true);
+  EXPECT_EQ(nodeSE2->get_parameter("test.corridor_downsampling_factor").as_int(), 3);
+  EXPECT_EQ(nodeSE2->get_parameter("test.corridor_radius").as_double(), 1.5);
+  EXPECT_EQ(nodeSE2->get_parameter("test.reuse_path").as_bool(), true);
+  EXPECT_EQ(nodeSE2->get_parameter("test.reuse_path_max_deviation").as_double(), 0.3);
   EXPECT_EQ(nodeSE2->get_parameter("test.max_planning_time").as_double(), 10.0);
   EXPECT_EQ(nodeSE2->get_parameter("test.lookup_table_size").as_double(), 30.0);
   EXPECT_EQ(nodeSE2->get_parameter("test.analytic_expansion_max_length").as_double(), 42.0);
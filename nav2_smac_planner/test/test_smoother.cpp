@@ -133,6 +133,7 @@ TEST(SmootherTest, test_full_smoother)
 
   // Test smoother, should succeed with same number of points
   // and shorter overall length, while still being collision free.
+  nav_msgs::msg::Path serial_plan = plan, parallel_plan = plan, repeated_plan = plan;
   auto path_size_in = plan.poses.size();
   EXPECT_TRUE(smoother->smooth(plan, costmap, maxtime));
   EXPECT_EQ(plan.poses.size(), path_size_in);  // Should have same number of poses
@@ -148,6 +149,34 @@ TEST(SmootherTest, test_full_smoother)
   }
   EXPECT_LT(length, initial_length);  // Should be shorter
 
+  // Smoothing the segments in parallel gives the same path without refinements,
+  // whose budget is shared by the segments only when serial
+  params.do_refinement_ = false;
+  auto serial_smoother = std::make_unique<SmootherWrapper>(params);
+  serial_smoother->initialize(0.4 /*turning radius*/);
+  params.segment_smoothing_threads_ = 2;
+  auto parallel_smoother = std::make_unique<SmootherWrapper>(params);
+  parallel_smoother->initialize(0.4 /*turning radius*/);
+  EXPECT_TRUE(serial_smoother->smooth(serial_plan, costmap, maxtime));
+  EXPECT_TRUE(parallel_smoother->smooth(parallel_plan, costmap, maxtime));
+  for (unsigned int i = 0; i != serial_plan.poses.size(); i++) {
+    const auto & serial_pose = serial_plan.poses[i].pose;
+    const auto & parallel_pose = parallel_plan.poses[i].pose;
+    EXPECT_DOUBLE_EQ(serial_pose.position.x, parallel_pose.position.x);
+    EXPECT_DOUBLE_EQ(serial_pose.position.y, parallel_pose.position.y);
+    EXPECT_DOUBLE_EQ(serial_pose.orientation.z, parallel_pose.orientation.z);
+    EXPECT_DOUBLE_EQ(serial_pose.orientation.w, parallel_pose.orientation.w);
+  }
+
+  // Smoothing again, from the buffers left by the previous segments, gives the same path
+  EXPECT_TRUE(serial_smoother->smooth(repeated_plan, costmap, maxtime));
+  for (unsigned int i = 0; i != serial_plan.poses.size(); i++) {
+    EXPECT_EQ(serial_plan.poses[i].pose.position.x, repeated_plan.poses[i].pose.position.x);
+    EXPECT_EQ(serial_plan.poses[i].pose.position.y, repeated_plan.poses[i].pose.position.y);
+  }
+  params.do_refinement_ = true;
+  params.segment_smoothing_threads_ = 1;
+
   // Try again but with failure modes
 
   // Failure mode: not enough iterations to complete
@@ -28,6 +28,7 @@
 #include "nav2_costmap_2d/costmap_topic_collision_checker.hpp"
 #include "nav2_costmap_2d/footprint_subscriber.hpp"
 #include "nav2_msgs/action/smooth_path.hpp"
+#include "nav2_smoother/path_segments.hpp"
 #include "nav2_util/lifecycle_node.hpp"
 #include "nav2_util/robot_utils.hpp"
 #include "nav2_util/simple_action_server.hpp"
@@ -135,6 +136,28 @@ protected:
    */
   bool findSmootherId(const std::string & c_name, std::string & name);
 
+  /**
+   * @brief Smooths the directional segments of a path one after the other,
+   * publishing the path smoothed so far as feedback after each of them but the last
+   * @param goal Goal of the action, with the path to smooth
+   * @param segments Directional segments of the path
+   * @param start_time Time the smoothing started at, which the time limit counts from
+   * @param result Result of the action, to set the smoothed path and its completion in
+   * @return bool False if a smoothed segment is in collision, when checked for
+   */
+  bool smoothSegments(
+    const Action::Goal & goal,
+    const std::vector<PathSegment> & segments,
+    const rclcpp::Time & start_time,
+    Action::Result & result);
+
+  /**
+   * @brief Checks a smoothed path for collisions, logging the first one
+   * @param path Path to check
+   * @return bool True if the path is collision free
+   */
+  bool isCollisionFree(const nav_msgs::msg::Path & path);
+
   // Our action server implements the SmoothPath action
   std::unique_ptr<ActionServer> action_server_;
 
@@ -153,6 +176,7 @@ protected:
   std::vector<std::string> smoother_ids_;
   std::vector<std::string> smoother_types_;
   std::string smoother_ids_concat_, current_smoother_;
+  bool stream_segments_;
 
   // Utilities
   std::shared_ptr<nav2_costmap_2d::CostmapSubscriber> costmap_sub_;
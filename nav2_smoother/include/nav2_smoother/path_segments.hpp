@@ -0,0 +1,90 @@
+// Copyright (c) 2022 Samsung Research America
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+
+#ifndef NAV2_SMOOTHER__PATH_SEGMENTS_HPP_
+#define NAV2_SMOOTHER__PATH_SEGMENTS_HPP_
+
+#include <cmath>
+#include <vector>
+
+#include "nav_msgs/msg/path.hpp"
+#include "angles/angles.h"
+#include "tf2/utils.h"
+
+namespace nav2_smoother
+{
+
+/**
+ * @class nav2_smoother::PathSegment
+ * @brief A segment of a path in start/end indices
+ */
+struct PathSegment
+{
+  unsigned int start;
+  unsigned int end;
+};
+
+/**
+ * @brief Finds the starting and end indices of path segments where
+ * the robot is traveling in the same direction (e.g. forward vs reverse).
+ * Consecutive segments share the cusp pose, which ends one and starts the next
+ * @param path Path in which to look for cusps, of at least 2 poses
+ * @return Set of index pairs for each segment of the path in a given direction
+ */
+inline std::vector<PathSegment> findDirectionalPathSegments(const nav_msgs::msg::Path & path)
+{
+  std::vector<PathSegment> segments;
+  PathSegment curr_segment;
+  curr_segment.start = 0;
+
+  // Iterating through the path to determine the position of the cusp
+  for (unsigned int idx = 1; idx < path.poses.size() - 1; ++idx) {
+    // We have two vectors for the dot product OA and AB. Determining the vectors.
+    double oa_x = path.poses[idx].pose.position.x -
+      path.poses[idx - 1].pose.position.x;
+    double oa_y = path.poses[idx].pose.position.y -
+      path.poses[idx - 1].pose.position.y;
+    double ab_x = path.poses[idx + 1].pose.position.x -
+      path.poses[idx].pose.position.x;
+    double ab_y = path.poses[idx + 1].pose.position.y -
+      path.poses[idx].pose.position.y;
+
+    // Checking for the existance of cusp, in the path, using the dot product.
+    double dot_product = (oa_x * ab_x) + (oa_y * ab_y);
+    if (dot_product < 0.0) {
+      curr_segment.end = idx;
+      segments.push_back(curr_segment);
+      curr_segment.start = idx;
+    }
+
+    // Checking for the existance of a differential rotation in place.
+    double cur_theta = tf2::getYaw(path.poses[idx].pose.orientation);
+    double next_theta = tf2::getYaw(path.poses[idx + 1].pose.orientation);
+    double dtheta = angles::shortest_angular_distance(cur_theta, next_theta);
+    if (std::fabs(ab_x) < 1e-4 && std::fabs(ab_y) < 1e-4 && std::fabs(dtheta) > 1e-4) {
+      curr_segment.end = idx;
+      segments.push_back(curr_segment);
+      curr_segment.start = idx;
+    }
+  }
+
+  curr_segment.end = path.poses.size() - 1;
+  segments.push_back(curr_segment);
+  return segments;
+}
+
+}  // namespace nav2_smoother
+
+#endif  // NAV2_SMOOTHER__PATH_SEGMENTS_HPP_
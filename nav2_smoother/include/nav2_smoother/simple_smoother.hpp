@@ -26,6 +26,8 @@
 #include "nav2_core/smoother.hpp"
 #include "nav2_costmap_2d/costmap_2d.hpp"
 #include "nav2_costmap_2d/cost_values.hpp"
+#include "nav2_costmap_2d/tile_thread_pool.hpp"
+#include "nav2_smoother/path_segments.hpp"
 #include "nav2_util/geometry_utils.hpp"
 #include "nav2_util/node_utils.hpp"
 #include "nav_msgs/msg/path.hpp"
@@ -36,13 +38,15 @@ namespace nav2_smoother
 {
 
 /**
- * @class nav2_smoother::PathSegment
- * @brief A segment of a path in start/end indices
+ * @struct nav2_smoother::SegmentBuffers
+ * @brief Working state of a path segment being smoothed, kept to reuse its memory
  */
-struct PathSegment
+struct SegmentBuffers
 {
-  unsigned int start;
-  unsigned int end;
+  // Positions as data term, current and next iteration, and last checked to be collision free
+  std::vector<double> data_x, data_y, smooth_x, smooth_y, next_x, next_y;
+  std::vector<double> valid_x, valid_y;
+  int refinement_ctr{0};
 };
 
 typedef std::vector<geometry_msgs::msg::PoseStamped>::iterator PathIterator;
@@ -74,7 +78,11 @@ public:
   /**
    * @brief Method to cleanup resources.
    */
-  void cleanup() override {costmap_sub_.reset();}
+  void cleanup() override
+  {
+    costmap_sub_.reset();
+    segment_pool_.reset();
+  }
 
   /**
    * @brief Method to activate smoother and any threads involved in execution.
@@ -104,33 +112,64 @@ protected:
    * @param reversing_segment Return if this is a reversing segment
    * @param costmap Pointer to minimal costmap
    * @param max_time Maximum time to compute, stop early if over limit
+   * @param buffers Working state of the segment, its refinement counter included
    * @return If smoothing was successful
    */
   bool smoothImpl(
     nav_msgs::msg::Path & path,
     bool & reversing_segment,
     const nav2_costmap_2d::Costmap2D * costmap,
+    const double & max_time,
+    SegmentBuffers & buffers);
+
+  /**
+   * @brief Smooth all the segments long enough on the segment pool, each with its
+   * own buffers and refinements, then assemble them back in order
+   * @param path Reference to path
+   * @param path_segments Segments of the path to smooth
+   * @param costmap Pointer to minimal costmap
+   * @param max_time Maximum time to compute, stop early if over limit
+   * @return If smoothing was successful for all the segments
+   */
+  bool smoothSegmentsInParallel(
+    nav_msgs::msg::Path & path,
+    const std::vector<PathSegment> & path_segments,
+    const nav2_costmap_2d::Costmap2D * costmap,
     const double & max_time);
 
   /**
-   * @brief Get the field value for a given dimension
-   * @param msg Current pose to sample
-   * @param dim Dimension ID of interest
-   * @return dim value
+   * @brief Iterate the smoothing of the positions in smooth_x and smooth_y towards
+   * data_x and data_y until converged, checking for collisions every
+   * collision_check_interval_ iterations and once converged
+   * @param costmap Pointer to minimal costmap
+   * @param max_time Maximum time to compute, stop early if over limit
+   * @param buffers Working state of the segment
+   * @return If smoothing converged, else smooth_x and smooth_y hold the last valid path
+   */
+  bool smoothIterations(
+    const nav2_costmap_2d::Costmap2D * costmap,
+    const double & max_time,
+    SegmentBuffers & buffers);
+
+  /**
+   * @brief Check that the positions in smooth_x and smooth_y are out of obstacles
+   * @param costmap Pointer to minimal costmap, or nullptr not to check
+   * @param buffers Working state of the segment
+   * @return If the path is collision free
    */
-  inline double getFieldByDim(
-    const geometry_msgs::msg::PoseStamped & msg,
-    const unsigned int & dim);
+  bool isPathCollisionFree(
+    const nav2_costmap_2d::Costmap2D * costmap,
+    const SegmentBuffers & buffers);
 
   /**
-   * @brief Set the field value for a given dimension
-   * @param msg Current pose to sample
-   * @param dim Dimension ID of interest
-   * @param value to set the dimention to for the pose
+   * @brief Keep the positions in smooth_x and smooth_y if collision free,
+   * else go back to the ones last checked
+   * @param costmap Pointer to minimal costmap
+   * @param buffers Working state of the segment
    */
-  inline void setFieldByDim(
-    geometry_msgs::msg::PoseStamped & msg, const unsigned int dim,
-    const double & value);
+  void restoreLastValidPath(
+    const nav2_costmap_2d::Costmap2D * costmap,
+    SegmentBuffers & buffers);
 
   /**
    * @brief Finds the starting and end indices of path segments where
@@ -150,8 +189,12 @@ protected:
     bool & reversing_segment);
 
   double tolerance_, data_w_, smooth_w_;
-  int max_its_, refinement_ctr_;
+  int max_its_, collision_check_interval_;
   bool do_refinement_;
+
+  // Buffers of each segment smoothed in parallel, the first one being used serially
+  std::vector<SegmentBuffers> segment_buffers_;
+  std::unique_ptr<nav2_costmap_2d::TileThreadPool> segment_pool_;
   std::shared_ptr<nav2_costmap_2d::CostmapSubscriber> costmap_sub_;
   rclcpp::Logger logger_{rclcpp::get_logger("SimpleSmoother")};
 };
@@ -53,7 +53,11 @@ SmootherServer::SmootherServer(const rclcpp::NodeOptions & options)
     "robot_base_frame",
     rclcpp::ParameterValue(std::string("base_link")));
   declare_parameter("transform_tolerance", rclcpp::ParameterValue(0.1));
+  declare_parameter("in_process_costmap", rclcpp::ParameterValue(false));
+  declare_parameter("shared_memory_costmap", rclcpp::ParameterValue(false));
+  declare_parameter("shared_memory_timeout", rclcpp::ParameterValue(2.0));
   declare_parameter("smoother_plugins", default_ids_);
+  declare_parameter("stream_segments", rclcpp::ParameterValue(false));
 }
 
 SmootherServer::~SmootherServer()
@@ -84,13 +88,20 @@ SmootherServer::on_configure(const rclcpp_lifecycle::State &)
   transform_listener_ = std::make_shared<tf2_ros::TransformListener>(*tf_);
 
   std::string costmap_topic, footprint_topic, robot_base_frame;
-  double transform_tolerance;
+  double transform_tolerance, shared_memory_timeout;
+  bool in_process_costmap, shared_memory_costmap;
   this->get_parameter("costmap_topic", costmap_topic);
   this->get_parameter("footprint_topic", footprint_topic);
   this->get_parameter("transform_tolerance", transform_tolerance);
   this->get_parameter("robot_base_frame", robot_base_frame);
+  this->get_parameter("in_process_costmap", in_process_costmap);
+  this->get_parameter("shared_memory_costmap", shared_memory_costmap);
+  this->get_parameter("shared_memory_timeout", shared_memory_timeout);
+  this->get_parameter("stream_segments", stream_segments_);
   costmap_sub_ = std::make_shared<nav2_costmap_2d::CostmapSubscriber>(
     shared_from_this(), costmap_topic);
+  costmap_sub_->setInProcess(in_process_costmap);
+  costmap_sub_->setSharedMemory(shared_memory_costmap, shared_memory_timeout);
   footprint_sub_ = std::make_shared<nav2_costmap_2d::FootprintSubscriber>(
     shared_from_this(), footprint_topic, *tf_, robot_base_frame, transform_tolerance);
 
@@ -270,9 +281,19 @@ void SmootherServer::smoothPlan()
 
     // Perform smoothing
     auto goal = action_server_->get_current_goal();
-    result->path = goal->path;
-    result->was_completed = smoothers_[current_smoother_]->smooth(
-      result->path, goal->max_smoothing_duration);
+    std::vector<PathSegment> segments;
+    if (stream_segments_ && goal->path.poses.size() > 2) {
+      segments = findDirectionalPathSegments(goal->path);
+    }
+
+    bool collision_free = true;
+    if (segments.size() > 1) {
+      collision_free = smoothSegments(*goal, segments, start_time, *result);
+    } else {
+      result->path = goal->path;
+      result->was_completed = smoothers_[current_smoother_]->smooth(
+        result->path, goal->max_smoothing_duration);
+    }
     result->smoothing_duration = steady_clock_.now() - start_time;
 
     if (!result->was_completed) {
@@ -286,25 +307,13 @@ void SmootherServer::smoothPlan()
     }
     plan_publisher_->publish(result->path);
 
-    // Check for collisions
-    if (goal->check_for_collisions) {
-      geometry_msgs::msg::Pose2D pose2d;
-      bool fetch_data = true;
-      for (const auto & pose : result->path.poses) {
-        pose2d.x = pose.pose.position.x;
-        pose2d.y = pose.pose.position.y;
-        pose2d.theta = tf2::getYaw(pose.pose.orientation);
-
-        if (!collision_checker_->isCollisionFree(pose2d, fetch_data)) {
-          RCLCPP_ERROR(
-            get_logger(),
-            "Smoothed path leads to a collision at x: %lf, y: %lf, theta: %lf",
-            pose2d.x, pose2d.y, pose2d.theta);
-          action_server_->terminate_current(result);
-          return;
-        }
-        fetch_data = false;
-      }
+    // Check for collisions, the segments streamed having been checked already
+    if (segments.size() <= 1 && goal->check_for_collisions) {
+      collision_free = isCollisionFree(result->path);
+    }
+    if (!collision_free) {
+      action_server_->terminate_current(result);
+      return;
     }
 
     RCLCPP_DEBUG(
@@ -319,6 +328,74 @@ void SmootherServer::smoothPlan()
   }
 }
 
+bool SmootherServer::smoothSegments(
+  const Action::Goal & goal,
+  const std::vector<PathSegment> & segments,
+  const rclcpp::Time & start_time,
+  Action::Result & result)
+{
+  const rclcpp::Duration max_duration(goal.max_smoothing_duration);
+  result.path.header = goal.path.header;
+  result.path.poses.clear();
+  result.was_completed = true;
+
+  nav_msgs::msg::Path segment;
+  segment.header = goal.path.header;
+  for (unsigned int i = 0; i != segments.size(); i++) {
+    segment.poses.assign(
+      goal.path.poses.begin() + segments[i].start,
+      goal.path.poses.begin() + segments[i].end + 1);
+
+    // Segments left once the time is up are passed on as they are
+    const rclcpp::Duration remaining = max_duration - (steady_clock_.now() - start_time);
+    if (remaining > rclcpp::Duration(0, 0)) {
+      result.was_completed &= smoothers_[current_smoother_]->smooth(segment, remaining);
+    } else {
+      result.was_completed = false;
+    }
+
+    if (goal.check_for_collisions && !isCollisionFree(segment)) {
+      return false;
+    }
+
+    // The cusp starting a segment ends the previous one, whose smoothed pose is kept
+    result.path.poses.insert(
+      result.path.poses.end(),
+      result.path.poses.empty() ? segment.poses.begin() : segment.poses.begin() + 1,
+      segment.poses.end());
+
+    if (i + 1 != segments.size()) {
+      auto feedback = std::make_shared<Action::Feedback>();
+      feedback->path = result.path;
+      action_server_->publish_feedback(feedback);
+    }
+  }
+
+  return true;
+}
+
+bool SmootherServer::isCollisionFree(const nav_msgs::msg::Path & path)
+{
+  std::vector<geometry_msgs::msg::Pose2D> poses(path.poses.size());
+  for (unsigned int i = 0; i < poses.size(); ++i) {
+    const auto & pose = path.poses[i];
+    poses[i].x = pose.pose.position.x;
+    poses[i].y = pose.pose.position.y;
+    poses[i].theta = tf2::getYaw(pose.pose.orientation);
+  }
+
+  const int collision = collision_checker_->findFirstCollision(poses);
+  if (collision != -1) {
+    const geometry_msgs::msg::Pose2D & pose2d = poses[collision];
+    RCLCPP_ERROR(
+      get_logger(),
+      "Smoothed path leads to a collision at x: %lf, y: %lf, theta: %lf",
+      pose2d.x, pose2d.y, pose2d.theta);
+    return false;
+  }
+  return true;
+}
+
 }  // namespace nav2_smoother
 
 #include "rclcpp_components/register_node_macro.hpp"
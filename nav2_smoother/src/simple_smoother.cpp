@@ -12,6 +12,8 @@
 // See the License for the specific language governing permissions and
 // limitations under the License. Reserved.
 
+#include <algorithm>
+#include <thread>
 #include <vector>
 #include <memory>
 #include "nav2_smoother/simple_smoother.hpp"
@@ -43,12 +45,30 @@ void SimpleSmoother::configure(
     node, name + ".w_smooth", rclcpp::ParameterValue(0.3));
   declare_parameter_if_not_declared(
     node, name + ".do_refinement", rclcpp::ParameterValue(true));
+  declare_parameter_if_not_declared(
+    node, name + ".collision_check_interval", rclcpp::ParameterValue(10));
+  declare_parameter_if_not_declared(
+    node, name + ".segment_smoothing_threads", rclcpp::ParameterValue(1));
 
   node->get_parameter(name + ".tolerance", tolerance_);
   node->get_parameter(name + ".max_its", max_its_);
   node->get_parameter(name + ".w_data", data_w_);
   node->get_parameter(name + ".w_smooth", smooth_w_);
   node->get_parameter(name + ".do_refinement", do_refinement_);
+  node->get_parameter(name + ".collision_check_interval", collision_check_interval_);
+  collision_check_interval_ = std::max(collision_check_interval_, 1);
+
+  int segment_smoothing_threads;
+  node->get_parameter(name + ".segment_smoothing_threads", segment_smoothing_threads);
+  if (segment_smoothing_threads <= 0) {
+    segment_smoothing_threads = std::max(1u, std::thread::hardware_concurrency());
+  }
+  segment_pool_.reset();
+  segment_buffers_.resize(1);
+  if (segment_smoothing_threads > 1) {
+    segment_pool_ = std::make_unique<nav2_costmap_2d::TileThreadPool>(
+      segment_smoothing_threads);
+  }
 }
 
 bool SimpleSmoother::smooth(
@@ -57,7 +77,6 @@ bool SimpleSmoother::smooth(
 {
   auto costmap = costmap_sub_->getCostmap();
 
-  refinement_ctr_ = 0;
   steady_clock::time_point start = steady_clock::now();
   double time_remaining = max_time.seconds();
 
@@ -67,6 +86,15 @@ bool SimpleSmoother::smooth(
 
   std::vector<PathSegment> path_segments = findDirectionalPathSegments(path);
 
+  if (segment_pool_ && path_segments.size() > 1) {
+    time_remaining -= duration_cast<duration<double>>(steady_clock::now() - start).count();
+    return smoothSegmentsInParallel(path, path_segments, costmap.get(), time_remaining);
+  }
+
+  // Serially, the refinements are shared by all the segments
+  SegmentBuffers & buffers = segment_buffers_.front();
+  buffers.refinement_ctr = 0;
+
   for (unsigned int i = 0; i != path_segments.size(); i++) {
     if (path_segments[i].end - path_segments[i].start > 9) {
       // Populate path segment
@@ -82,7 +110,7 @@ bool SimpleSmoother::smooth(
 
       // Smooth path segment naively
       success = success && smoothImpl(
-        curr_path_segment, reversing_segment, costmap.get(), time_remaining);
+        curr_path_segment, reversing_segment, costmap.get(), time_remaining, buffers);
 
       // Assemble the path changes to the main path
       std::copy(
@@ -95,35 +123,123 @@ bool SimpleSmoother::smooth(
   return success;
 }
 
+bool SimpleSmoother::smoothSegmentsInParallel(
+  nav_msgs::msg::Path & path,
+  const std::vector<PathSegment> & path_segments,
+  const nav2_costmap_2d::Costmap2D * costmap,
+  const double & max_time)
+{
+  std::vector<PathSegment> smoothed_segments;
+  for (const auto & segment : path_segments) {
+    if (segment.end - segment.start > 9) {
+      smoothed_segments.push_back(segment);
+    }
+  }
+
+  // Segments only share their fixed end points, so they are smoothed independently,
+  // all within the time allowed to the whole path
+  const unsigned int count = smoothed_segments.size();
+  if (segment_buffers_.size() < count) {
+    segment_buffers_.resize(count);
+  }
+  std::vector<nav_msgs::msg::Path> segment_paths(count);
+  std::vector<char> segment_success(count, false);
+  segment_pool_->run(
+    count, [&](unsigned int i) {
+      const PathSegment & segment = smoothed_segments[i];
+      nav_msgs::msg::Path & segment_path = segment_paths[i];
+      segment_path.header = path.header;
+      segment_path.poses.assign(
+        path.poses.begin() + segment.start, path.poses.begin() + segment.end + 1);
+      bool reversing_segment;
+      segment_buffers_[i].refinement_ctr = 0;
+      segment_success[i] = smoothImpl(
+        segment_path, reversing_segment, costmap, max_time, segment_buffers_[i]);
+    });
+
+  // Assemble the path changes to the main path in order, as the shared end point
+  // takes the orientation of the segment it starts
+  bool success = true;
+  for (unsigned int i = 0; i != count; i++) {
+    std::copy(
+      segment_paths[i].poses.begin(),
+      segment_paths[i].poses.end(),
+      path.poses.begin() + smoothed_segments[i].start);
+    success = success && segment_success[i];
+  }
+
+  return success;
+}
+
 bool SimpleSmoother::smoothImpl(
   nav_msgs::msg::Path & path,
   bool & reversing_segment,
   const nav2_costmap_2d::Costmap2D * costmap,
-  const double & max_time)
+  const double & max_time,
+  SegmentBuffers & buffers)
+{
+  // Extract the positions once, the data term being the original path
+  const unsigned int path_size = path.poses.size();
+  buffers.data_x.resize(path_size);
+  buffers.data_y.resize(path_size);
+  for (unsigned int i = 0; i != path_size; i++) {
+    buffers.data_x[i] = path.poses[i].pose.position.x;
+    buffers.data_y[i] = path.poses[i].pose.position.y;
+  }
+  buffers.smooth_x = buffers.data_x;
+  buffers.smooth_y = buffers.data_y;
+
+  bool success = smoothIterations(costmap, max_time, buffers);
+
+  // Lets do additional refinement, it shouldn't take more than a couple milliseconds
+  // but really puts the path quality over the top. Each refinement smooths the last
+  // result further, and one that fails keeps its last valid path.
+  if (success) {
+    while (do_refinement_ && buffers.refinement_ctr < 4) {
+      buffers.refinement_ctr++;
+      buffers.data_x = buffers.smooth_x;
+      buffers.data_y = buffers.smooth_y;
+      if (!smoothIterations(costmap, max_time, buffers)) {
+        break;
+      }
+    }
+  }
+
+  for (unsigned int i = 0; i != path_size; i++) {
+    path.poses[i].pose.position.x = buffers.smooth_x[i];
+    path.poses[i].pose.position.y = buffers.smooth_y[i];
+  }
+  updateApproximatePathOrientations(path, reversing_segment);
+  return success;
+}
+
+bool SimpleSmoother::smoothIterations(
+  const nav2_costmap_2d::Costmap2D * costmap,
+  const double & max_time,
+  SegmentBuffers & buffers)
 {
   steady_clock::time_point a = steady_clock::now();
   rclcpp::Duration max_dur = rclcpp::Duration::from_seconds(max_time);
 
   int its = 0;
   double change = tolerance_;
-  const unsigned int & path_size = path.poses.size();
-  double x_i, y_i, y_m1, y_ip1, y_i_org;
-  unsigned int mx, my;
+  const unsigned int path_size = buffers.smooth_x.size();
 
-  nav_msgs::msg::Path new_path = path;
-  nav_msgs::msg::Path last_path = path;
+  // The end points are fixed, and the path before the first iteration is valid
+  buffers.next_x = buffers.smooth_x;
+  buffers.next_y = buffers.smooth_y;
+  buffers.valid_x = buffers.smooth_x;
+  buffers.valid_y = buffers.smooth_y;
 
   while (change >= tolerance_) {
     its += 1;
-    change = 0.0;
 
     // Make sure the smoothing function will converge
     if (its >= max_its_) {
       RCLCPP_WARN(
         logger_,
         "Number of iterations has exceeded limit of %i.", max_its_);
-      path = last_path;
-      updateApproximatePathOrientations(path, reversing_segment);
+      restoreLastValidPath(costmap, buffers);
       return false;
     }
 
@@ -134,127 +250,87 @@ bool SimpleSmoother::smoothImpl(
       RCLCPP_WARN(
         logger_,
         "Smoothing time exceeded allowed duration of %0.2f.", max_time);
-      path = last_path;
-      updateApproximatePathOrientations(path, reversing_segment);
+      restoreLastValidPath(costmap, buffers);
       return false;
     }
 
-    for (unsigned int i = 1; i != path_size - 1; i++) {
-      for (unsigned int j = 0; j != 2; j++) {
-        x_i = getFieldByDim(path.poses[i], j);
-        y_i = getFieldByDim(new_path.poses[i], j);
-        y_m1 = getFieldByDim(new_path.poses[i - 1], j);
-        y_ip1 = getFieldByDim(new_path.poses[i + 1], j);
-        y_i_org = y_i;
-
-        // Smooth based on local 3 point neighborhood and original data locations
-        y_i += data_w_ * (x_i - y_i) + smooth_w_ * (y_ip1 + y_m1 - (2.0 * y_i));
-        setFieldByDim(new_path.poses[i], j, y_i);
-        change += abs(y_i - y_i_org);
-      }
-
-      // validate update is admissible, only checks cost if a valid costmap pointer is provided
-      float cost = 0.0;
-      if (costmap) {
-        costmap->worldToMap(
-          getFieldByDim(new_path.poses[i], 0),
-          getFieldByDim(new_path.poses[i], 1),
-          mx, my);
-        cost = static_cast<float>(costmap->getCost(mx, my));
-      }
+    // Smooth based on local 3 point neighborhood and original data locations. All points
+    // are updated from the previous iteration, in a single pass over contiguous arrays.
+    const double * data_x = buffers.data_x.data();
+    const double * data_y = buffers.data_y.data();
+    const double * y_x = buffers.smooth_x.data();
+    const double * y_y = buffers.smooth_y.data();
+    double * next_x = buffers.next_x.data();
+    double * next_y = buffers.next_y.data();
+    change = 0.0;
+    for (unsigned int i = 1; i < path_size - 1; i++) {
+      const double dx = data_w_ * (data_x[i] - y_x[i]) +
+        smooth_w_ * (y_x[i + 1] + y_x[i - 1] - 2.0 * y_x[i]);
+      const double dy = data_w_ * (data_y[i] - y_y[i]) +
+        smooth_w_ * (y_y[i + 1] + y_y[i - 1] - 2.0 * y_y[i]);
+      next_x[i] = y_x[i] + dx;
+      next_y[i] = y_y[i] + dy;
+      change += std::abs(dx) + std::abs(dy);
+    }
+    buffers.smooth_x.swap(buffers.next_x);
+    buffers.smooth_y.swap(buffers.next_y);
 
-      if (cost > nav2_costmap_2d::MAX_NON_OBSTACLE && cost != nav2_costmap_2d::NO_INFORMATION) {
+    // Validate the updates are admissible every few iterations and once converged,
+    // returning the last path checked if not
+    if (its % collision_check_interval_ == 0 || change < tolerance_) {
+      if (!isPathCollisionFree(costmap, buffers)) {
         RCLCPP_DEBUG(
           rclcpp::get_logger("SmacPlannerSmoother"),
           "Smoothing process resulted in an infeasible collision. "
           "Returning the last path before the infeasibility was introduced.");
-        path = last_path;
-        updateApproximatePathOrientations(path, reversing_segment);
+        buffers.smooth_x = buffers.valid_x;
+        buffers.smooth_y = buffers.valid_y;
         return false;
       }
+      buffers.valid_x = buffers.smooth_x;
+      buffers.valid_y = buffers.smooth_y;
     }
-
-    last_path = new_path;
-  }
-
-  // Lets do additional refinement, it shouldn't take more than a couple milliseconds
-  // but really puts the path quality over the top.
-  if (do_refinement_ && refinement_ctr_ < 4) {
-    refinement_ctr_++;
-    smoothImpl(new_path, reversing_segment, costmap, max_time);
   }
 
-  updateApproximatePathOrientations(new_path, reversing_segment);
-  path = new_path;
   return true;
 }
 
-double SimpleSmoother::getFieldByDim(
-  const geometry_msgs::msg::PoseStamped & msg, const unsigned int & dim)
+bool SimpleSmoother::isPathCollisionFree(
+  const nav2_costmap_2d::Costmap2D * costmap,
+  const SegmentBuffers & buffers)
 {
-  if (dim == 0) {
-    return msg.pose.position.x;
-  } else if (dim == 1) {
-    return msg.pose.position.y;
-  } else {
-    return msg.pose.position.z;
+  // Only checks cost if a valid costmap pointer is provided
+  if (!costmap) {
+    return true;
+  }
+
+  unsigned int mx, my;
+  for (unsigned int i = 1; i < buffers.smooth_x.size() - 1; i++) {
+    if (!costmap->worldToMap(buffers.smooth_x[i], buffers.smooth_y[i], mx, my)) {
+      continue;
+    }
+    unsigned char cost = costmap->getCost(mx, my);
+    if (cost > nav2_costmap_2d::MAX_NON_OBSTACLE && cost != nav2_costmap_2d::NO_INFORMATION) {
+      return false;
+    }
   }
+  return true;
 }
 
-void SimpleSmoother::setFieldByDim(
-  geometry_msgs::msg::PoseStamped & msg, const unsigned int dim,
-  const double & value)
+void SimpleSmoother::restoreLastValidPath(
+  const nav2_costmap_2d::Costmap2D * costmap,
+  SegmentBuffers & buffers)
 {
-  if (dim == 0) {
-    msg.pose.position.x = value;
-  } else if (dim == 1) {
-    msg.pose.position.y = value;
-  } else {
-    msg.pose.position.z = value;
+  if (!isPathCollisionFree(costmap, buffers)) {
+    buffers.smooth_x = buffers.valid_x;
+    buffers.smooth_y = buffers.valid_y;
   }
 }
 
 std::vector<PathSegment> SimpleSmoother::findDirectionalPathSegments(
   const nav_msgs::msg::Path & path)
 {
-  std::vector<PathSegment> segments;
-  PathSegment curr_segment;
-  curr_segment.start = 0;
-
-  // Iterating through the path to determine the position of the cusp
-  for (unsigned int idx = 1; idx < path.poses.size() - 1; ++idx) {
-    // We have two vectors for the dot product OA and AB. Determining the vectors.
-    double oa_x = path.poses[idx].pose.position.x -
-      path.poses[idx - 1].pose.position.x;
-    double oa_y = path.poses[idx].pose.position.y -
-      path.poses[idx - 1].pose.position.y;
-    double ab_x = path.poses[idx + 1].pose.position.x -
-      path.poses[idx].pose.position.x;
-    double ab_y = path.poses[idx + 1].pose.position.y -
-      path.poses[idx].pose.position.y;
-
-    // Checking for the existance of cusp, in the path, using the dot product.
-    double dot_product = (oa_x * ab_x) + (oa_y * ab_y);
-    if (dot_product < 0.0) {
-      curr_segment.end = idx;
-      segments.push_back(curr_segment);
-      curr_segment.start = idx;
-    }
-
-    // Checking for the existance of a differential rotation in place.
-    double cur_theta = tf2::getYaw(path.poses[idx].pose.orientation);
-    double next_theta = tf2::getYaw(path.poses[idx + 1].pose.orientation);
-    double dtheta = angles::shortest_angular_distance(cur_theta, next_theta);
-    if (fabs(ab_x) < 1e-4 && fabs(ab_y) < 1e-4 && fabs(dtheta) > 1e-4) {
-      curr_segment.end = idx;
-      segments.push_back(curr_segment);
-      curr_segment.start = idx;
-    }
-  }
-
-  curr_segment.end = path.poses.size() - 1;
-  segments.push_back(curr_segment);
-  return segments;
+  return nav2_smoother::findDirectionalPathSegments(path);
 }
 
 void SimpleSmoother::updateApproximatePathOrientations(
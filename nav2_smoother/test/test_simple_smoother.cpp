@@ -277,3 +277,118 @@ TEST(SmootherTest, test_simple_smoother)
   max_its_path.poses[10].pose.position.y = 1.0;
   EXPECT_FALSE(smoother->smooth(max_its_path, max_time));
 }
+
+TEST(SmootherTest, test_simple_smoother_long_path)
+{
+  rclcpp_lifecycle::LifecycleNode::SharedPtr node =
+    std::make_shared<rclcpp_lifecycle::LifecycleNode>("SmacSmootherLongPathTest");
+
+  std::shared_ptr<nav2_msgs::msg::Costmap> costmap_msg =
+    std::make_shared<nav2_msgs::msg::Costmap>();
+  costmap_msg->header.stamp = node->now();
+  costmap_msg->header.frame_id = "map";
+  costmap_msg->data.resize(400 * 400);
+  costmap_msg->metadata.resolution = 0.05;
+  costmap_msg->metadata.size_x = 400;
+  costmap_msg->metadata.size_y = 400;
+
+  std::weak_ptr<rclcpp_lifecycle::LifecycleNode> parent = node;
+  std::shared_ptr<nav2_costmap_2d::CostmapSubscriber> dummy_costmap;
+  dummy_costmap = std::make_shared<nav2_costmap_2d::CostmapSubscriber>(parent, "dummy_topic");
+  dummy_costmap->costmapCallback(costmap_msg);
+
+  // Collisions checked every iteration, or every 10 iterations by default
+  std::shared_ptr<tf2_ros::Buffer> dummy_tf;
+  std::shared_ptr<nav2_costmap_2d::FootprintSubscriber> dummy_footprint;
+  node->declare_parameter("every_its.collision_check_interval", rclcpp::ParameterValue(1));
+  auto smoother = std::make_unique<SmootherWrapper>();
+  smoother->configure(parent, "test", dummy_tf, dummy_costmap, dummy_footprint);
+  auto every_its_smoother = std::make_unique<SmootherWrapper>();
+  every_its_smoother->configure(parent, "every_its", dummy_tf, dummy_costmap, dummy_footprint);
+
+  // A long staircase of grid steps, going diagonally
+  nav_msgs::msg::Path staircase_path;
+  staircase_path.header.frame_id = "map";
+  for (unsigned int i = 0; i != 600; i++) {
+    geometry_msgs::msg::PoseStamped pose;
+    pose.pose.position.x = 0.5 + 0.05 * ((i + 1) / 2);
+    pose.pose.position.y = 0.5 + 0.05 * (i / 2);
+    staircase_path.poses.push_back(pose);
+  }
+  nav_msgs::msg::Path every_its_path = staircase_path;
+
+  rclcpp::Duration max_time = rclcpp::Duration::from_seconds(1);  // 1 second
+  EXPECT_TRUE(smoother->smooth(staircase_path, max_time));
+  EXPECT_TRUE(every_its_smoother->smooth(every_its_path, max_time));
+
+  // Away from its ends, the path is now close to the diagonal, whatever the checks
+  for (unsigned int i = 50; i != 550; i++) {
+    const auto & position = staircase_path.poses[i].pose.position;
+    EXPECT_NEAR(position.x - position.y, 0.025, 0.005);
+    EXPECT_NEAR(position.x, every_its_path.poses[i].pose.position.x, 1e-6);
+    EXPECT_NEAR(position.y, every_its_path.poses[i].pose.position.y, 1e-6);
+  }
+}
+
+TEST(SmootherTest, test_simple_smoother_parallel_segments)
+{
+  rclcpp_lifecycle::LifecycleNode::SharedPtr node =
+    std::make_shared<rclcpp_lifecycle::LifecycleNode>("SmacSmootherParallelTest");
+
+  std::shared_ptr<nav2_msgs::msg::Costmap> costmap_msg =
+    std::make_shared<nav2_msgs::msg::Costmap>();
+  costmap_msg->header.stamp = node->now();
+  costmap_msg->header.frame_id = "map";
+  costmap_msg->data.resize(400 * 400);
+  costmap_msg->metadata.resolution = 0.05;
+  costmap_msg->metadata.size_x = 400;
+  costmap_msg->metadata.size_y = 400;
+
+  std::weak_ptr<rclcpp_lifecycle::LifecycleNode> parent = node;
+  std::shared_ptr<nav2_costmap_2d::CostmapSubscriber> dummy_costmap;
+  dummy_costmap = std::make_shared<nav2_costmap_2d::CostmapSubscriber>(parent, "dummy_topic");
+  dummy_costmap->costmapCallback(costmap_msg);
+
+  // Without refinements, whose budget is shared by the segments only when serial,
+  // smoothing the segments in parallel gives the same path
+  std::shared_ptr<tf2_ros::Buffer> dummy_tf;
+  std::shared_ptr<nav2_costmap_2d::FootprintSubscriber> dummy_footprint;
+  node->declare_parameter("serial.do_refinement", rclcpp::ParameterValue(false));
+  node->declare_parameter("parallel.do_refinement", rclcpp::ParameterValue(false));
+  node->declare_parameter("parallel.segment_smoothing_threads", rclcpp::ParameterValue(3));
+  auto smoother = std::make_unique<SmootherWrapper>();
+  smoother->configure(parent, "serial", dummy_tf, dummy_costmap, dummy_footprint);
+  auto parallel_smoother = std::make_unique<SmootherWrapper>();
+  parallel_smoother->configure(parent, "parallel", dummy_tf, dummy_costmap, dummy_footprint);
+
+  // Noisy path going back and forth, reversing at each of its 7 cusps
+  nav_msgs::msg::Path reversing_path;
+  reversing_path.header.frame_id = "map";
+  double x = 5.0, y = 1.0;
+  for (unsigned int segment = 0; segment != 8; segment++) {
+    const double direction = segment % 2 ? -1.0 : 1.0;
+    for (unsigned int i = segment ? 1 : 0; i <= 50; i++) {
+      geometry_msgs::msg::PoseStamped pose;
+      pose.pose.position.x = x + direction * 0.05 * i;
+      pose.pose.position.y = y + 0.01 * i + (i % 2 ? 0.02 : 0.0);
+      reversing_path.poses.push_back(pose);
+    }
+    x = reversing_path.poses.back().pose.position.x;
+    y = reversing_path.poses.back().pose.position.y;
+  }
+  EXPECT_EQ(smoother->findDirectionalPathSegmentsWrapper(reversing_path).size(), 8u);
+  nav_msgs::msg::Path parallel_path = reversing_path;
+
+  rclcpp::Duration max_time = rclcpp::Duration::from_seconds(1);  // 1 second
+  EXPECT_TRUE(smoother->smooth(reversing_path, max_time));
+  EXPECT_TRUE(parallel_smoother->smooth(parallel_path, max_time));
+
+  for (unsigned int i = 0; i != reversing_path.poses.size(); i++) {
+    const auto & pose = reversing_path.poses[i].pose;
+    const auto & parallel_pose = parallel_path.poses[i].pose;
+    EXPECT_DOUBLE_EQ(pose.position.x, parallel_pose.position.x);
+    EXPECT_DOUBLE_EQ(pose.position.y, parallel_pose.position.y);
+    EXPECT_DOUBLE_EQ(pose.orientation.z, parallel_pose.orientation.z);
+    EXPECT_DOUBLE_EQ(pose.orientation.w, parallel_pose.orientation.w);
+  }
+}
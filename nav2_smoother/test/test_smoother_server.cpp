@@ -390,6 +390,58 @@ TEST_F(SmootherTest, testingCollisionCheckDisabled)
   SUCCEED();
 }
 
+TEST_F(SmootherTest, testingStreamedSegments)
+{
+  smoother_server_->deactivate();
+  smoother_server_->cleanup();
+  smoother_server_->set_parameter(rclcpp::Parameter("stream_segments", true));
+  smoother_server_->configure();
+  smoother_server_->activate();
+  ASSERT_TRUE(client_->wait_for_action_server(4s));
+
+  // A path reversing at its second pose, in two segments of 2 poses
+  auto goal = SmoothAction::Goal();
+  goal.smoother_id = "DummySmoothPath";
+  goal.check_for_collisions = true;
+  goal.max_smoothing_duration = rclcpp::Duration(500ms);
+  geometry_msgs::msg::PoseStamped pose;
+  pose.pose.orientation.w = 1.0;
+  for (double x : {0.0, 1.0, 0.5}) {
+    pose.pose.position.x = x;
+    goal.path.poses.push_back(pose);
+  }
+
+  std::vector<nav_msgs::msg::Path> feedback_paths;
+  auto send_goal_options = rclcpp_action::Client<SmoothAction>::SendGoalOptions();
+  send_goal_options.feedback_callback =
+    [&feedback_paths](
+    ClientGoalHandle::SharedPtr, const std::shared_ptr<const SmoothAction::Feedback> feedback) {
+      feedback_paths.push_back(feedback->path);
+    };
+  auto future_goal = client_->async_send_goal(goal, send_goal_options);
+  ASSERT_EQ(
+    rclcpp::spin_until_future_complete(node_lifecycle_, future_goal),
+    rclcpp::FutureReturnCode::SUCCESS);
+  goal_handle_ = future_goal.get();
+  ASSERT_TRUE(goal_handle_);
+  auto result = getResult();
+
+  // Each segment gets the middle pose of the dummy smoother appended, the first
+  // one being given out on its own before the second one is smoothed
+  EXPECT_EQ(result.code, rclcpp_action::ResultCode::SUCCEEDED);
+  EXPECT_TRUE(result.result->was_completed);
+  ASSERT_EQ(result.result->path.poses.size(), 5u);
+  EXPECT_DOUBLE_EQ(result.result->path.poses[2].pose.position.x, 0.5);
+  EXPECT_DOUBLE_EQ(result.result->path.poses[3].pose.position.x, 0.5);
+  EXPECT_DOUBLE_EQ(result.result->path.poses[4].pose.position.x, 0.75);
+  ASSERT_EQ(feedback_paths.size(), 1u);
+  ASSERT_EQ(feedback_paths[0].poses.size(), 3u);
+  EXPECT_TRUE(
+    std::equal(
+      feedback_paths[0].poses.begin(), feedback_paths[0].poses.end(),
+      result.result->path.poses.begin()));
+}
+
 TEST_F(SmootherConfigTest, testingConfigureSuccessWithValidSmootherPlugin)
 {
   auto smoother_server = std::make_shared<DummySmootherServer>();
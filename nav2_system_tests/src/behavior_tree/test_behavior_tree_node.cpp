@@ -54,6 +54,7 @@ public:
     const std::vector<std::string> plugin_libs = {
       "nav2_compute_path_to_pose_action_bt_node",
       "nav2_compute_path_through_poses_action_bt_node",
+      "nav2_compute_path_race_action_bt_node",
       "nav2_smooth_path_action_bt_node",
       "nav2_follow_path_action_bt_node",
       "nav2_back_up_action_bt_node",
@@ -0,0 +1,338 @@
+// Copyright (c) 2022 Samsung Research America
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License. Reserved.
+
+// Benchmarks the global planner plugins against costmaps made from map files, such as the
+// ones of tools/planner_benchmarking, cropped to several sizes. Each planner is given the
+// same random start and goal pairs, and one CSV row is written per planner and map size.
+// Usage: benchmark_planners <output.csv> <map.pgm> [<map.pgm> ...] [--ros-args ...]
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <fstream>
+#include <iostream>
+#include <limits>
+#include <memory>
+#include <random>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "rclcpp/rclcpp.hpp"
+#include "rclcpp_lifecycle/lifecycle_node.hpp"
+#include "pluginlib/class_loader.hpp"
+#include "nav2_core/global_planner.hpp"
+#include "nav2_costmap_2d/cost_values.hpp"
+#include "nav2_costmap_2d/costmap_2d_ros.hpp"
+#include "nav2_map_server/map_io.hpp"
+#include "nav2_util/geometry_utils.hpp"
+#include "nav2_util/node_utils.hpp"
+#include "tf2_ros/buffer.h"
+
+using namespace std::chrono;  // NOLINT
+using nav2_util::declare_parameter_if_not_declared;
+
+struct Query
+{
+  geometry_msgs::msg::PoseStamped start;
+  geometry_msgs::msg::PoseStamped goal;
+};
+
+// Sets the costmap to a crop of the map, inflated with the default inflation layer profile
+void setCostmap(
+  const nav_msgs::msg::OccupancyGrid & map, const unsigned int & size,
+  nav2_costmap_2d::Costmap2D * costmap)
+{
+  const unsigned int size_x = std::min(size, map.info.width);
+  const unsigned int size_y = std::min(size, map.info.height);
+  const double resolution = map.info.resolution;
+  costmap->resizeMap(size_x, size_y, resolution, 0.0, 0.0);
+
+  // Chamfer distance to the closest obstacle, in cells
+  std::vector<float> distance(size_x * size_y, std::numeric_limits<float>::max());
+  for (unsigned int j = 0; j != size_y; j++) {
+    for (unsigned int i = 0; i != size_x; i++) {
+      if (map.data[i + j * map.info.width] == 100) {
+        distance[i + j * size_x] = 0.0f;
+      }
+    }
+  }
+  auto relax = [&](const unsigned int & i, const unsigned int & j, const int & di, const int & dj) {
+      const int ni = static_cast<int>(i) + di;
+      const int nj = static_cast<int>(j) + dj;
+      if (ni < 0 || nj < 0 || ni >= static_cast<int>(size_x) || nj >= static_cast<int>(size_y)) {
+        return;
+      }
+      const float step = di != 0 && dj != 0 ? M_SQRT2 : 1.0f;
+      distance[i + j * size_x] =
+        std::min(distance[i + j * size_x], distance[ni + nj * size_x] + step);
+    };
+  for (unsigned int j = 0; j != size_y; j++) {
+    for (unsigned int i = 0; i != size_x; i++) {
+      relax(i, j, -1, 0);
+      relax(i, j, -1, -1);
+      relax(i, j, 0, -1);
+      relax(i, j, 1, -1);
+    }
+  }
+  for (unsigned int j = size_y; j-- > 0; ) {
+    for (unsigned int i = size_x; i-- > 0; ) {
+      relax(i, j, 1, 0);
+      relax(i, j, 1, 1);
+      relax(i, j, 0, 1);
+      relax(i, j, -1, 1);
+    }
+  }
+
+  const double inscribed_radius = 0.22;
+  const double inflation_radius = 0.55;
+  const double cost_scaling_factor = 3.0;
+  for (unsigned int j = 0; j != size_y; j++) {
+    for (unsigned int i = 0; i != size_x; i++) {
+      const double d = distance[i + j * size_x] * resolution;
+      unsigned char cost = nav2_costmap_2d::FREE_SPACE;
+      if (d == 0.0) {
+        cost = nav2_costmap_2d::LETHAL_OBSTACLE;
+      } else if (map.data[i + j * map.info.width] == -1) {
+        cost = nav2_costmap_2d::NO_INFORMATION;
+      } else if (d <= inscribed_radius) {
+        cost = nav2_costmap_2d::INSCRIBED_INFLATED_OBSTACLE;
+      } else if (d <= inflation_radius) {
+        cost = static_cast<unsigned char>(
+          (nav2_costmap_2d::INSCRIBED_INFLATED_OBSTACLE - 1) *
+          std::exp(-cost_scaling_factor * (d - inscribed_radius)));
+      }
+      costmap->setCost(i, j, cost);
+    }
+  }
+}
+
+// Random start and goal pairs in free space, a quarter of the map width apart at least
+std::vector<Query> getQueries(
+  nav2_costmap_2d::Costmap2D * costmap, const unsigned int & number, const int & seed)
+{
+  std::mt19937 generator(seed);
+  const unsigned int size_x = costmap->getSizeInCellsX();
+  const unsigned int size_y = costmap->getSizeInCellsY();
+  const unsigned int buffer = size_x / 20;
+  std::uniform_int_distribution<unsigned int> x_distribution(buffer, size_x - buffer - 1);
+  std::uniform_int_distribution<unsigned int> y_distribution(buffer, size_y - buffer - 1);
+  std::uniform_real_distribution<double> yaw_distribution(-M_PI, M_PI);
+
+  auto getRandomPose = [&](geometry_msgs::msg::PoseStamped & pose) {
+      for (unsigned int k = 0; k != 10000; k++) {
+        const unsigned int mx = x_distribution(generator);
+        const unsigned int my = y_distribution(generator);
+        if (costmap->getCost(mx, my) < 128) {
+          pose.header.frame_id = "map";
+          costmap->mapToWorld(mx, my, pose.pose.position.x, pose.pose.position.y);
+          pose.pose.orientation =
+            nav2_util::geometry_utils::orientationAroundZAxis(yaw_distribution(generator));
+          return true;
+        }
+      }
+      return false;
+    };
+
+  std::vector<Query> queries;
+  const double min_distance = costmap->getSizeInMetersX() / 4.0;
+  while (queries.size() != number) {
+    Query query;
+    if (!getRandomPose(query.start) || !getRandomPose(query.goal)) {
+      break;
+    }
+    if (nav2_util::geometry_utils::euclidean_distance(query.start, query.goal) >=
+      min_distance)
+    {
+      queries.push_back(query);
+    }
+  }
+  return queries;
+}
+
+// Reset the peak resident set size of the process, Linux only
+void resetPeakMemory()
+{
+  std::ofstream clear_refs("/proc/self/clear_refs");
+  clear_refs << "5";
+}
+
+// Peak resident set size of the process since its last reset, in kB
+long getPeakMemory()  // NOLINT
+{
+  std::ifstream status("/proc/self/status");
+  std::string line;
+  while (std::getline(status, line)) {
+    if (line.rfind("VmHWM:", 0) == 0) {
+      return std::stol(line.substr(6));
+    }
+  }
+  return -1;
+}
+
+double getPercentile(std::vector<double> values, const double & percentile)
+{
+  if (values.empty()) {
+    return 0.0;
+  }
+  std::sort(values.begin(), values.end());
+  const unsigned int rank = static_cast<unsigned int>(std::ceil(percentile * values.size()));
+  return values[std::max(rank, 1u) - 1];
+}
+
+int main(int argc, char ** argv)
+{
+  std::vector<std::string> args = rclcpp::init_and_remove_ros_arguments(argc, argv);
+  if (args.size() < 3) {
+    std::cerr << "Usage: benchmark_planners <output.csv> <map.pgm> [<map.pgm> ...]" <<
+      std::endl;
+    rclcpp::shutdown();
+    return 1;
+  }
+
+  auto node = std::make_shared<rclcpp_lifecycle::LifecycleNode>("planner_benchmark");
+  declare_parameter_if_not_declared(node, "queries", rclcpp::ParameterValue(20));
+  declare_parameter_if_not_declared(node, "seed", rclcpp::ParameterValue(33));
+  declare_parameter_if_not_declared(node, "resolution", rclcpp::ParameterValue(0.05));
+  declare_parameter_if_not_declared(
+    node, "map_sizes", rclcpp::ParameterValue(std::vector<int64_t>{250, 500, 1000, 2000}));
+  declare_parameter_if_not_declared(
+    node, "planner_plugins", rclcpp::ParameterValue(
+      std::vector<std::string>{"NavFn", "ThetaStar", "Smac2D", "SmacHybrid", "SmacLattice"}));
+  const std::vector<std::pair<std::string, std::string>> default_types = {
+    {"NavFn", "nav2_navfn_planner/NavfnPlanner"},
+    {"ThetaStar", "nav2_theta_star_planner/ThetaStarPlanner"},
+    {"Smac2D", "nav2_smac_planner/SmacPlanner2D"},
+    {"SmacHybrid", "nav2_smac_planner/SmacPlannerHybrid"},
+    {"SmacLattice", "nav2_smac_planner/SmacPlannerLattice"}};
+  for (const auto & default_type : default_types) {
+    declare_parameter_if_not_declared(
+      node, default_type.first + ".plugin", rclcpp::ParameterValue(default_type.second));
+  }
+
+  const int queries_number = node->get_parameter("queries").as_int();
+  const int seed = node->get_parameter("seed").as_int();
+  const double resolution = node->get_parameter("resolution").as_double();
+  const std::vector<int64_t> map_sizes = node->get_parameter("map_sizes").as_integer_array();
+  const std::vector<std::string> planner_ids =
+    node->get_parameter("planner_plugins").as_string_array();
+
+  auto costmap_ros = std::make_shared<nav2_costmap_2d::Costmap2DROS>("global_costmap");
+  costmap_ros->on_configure(rclcpp_lifecycle::State());
+  auto tf = std::make_shared<tf2_ros::Buffer>(node->get_clock());
+  pluginlib::ClassLoader<nav2_core::GlobalPlanner> loader(
+    "nav2_core", "nav2_core::GlobalPlanner");
+
+  std::ofstream output(args[1]);
+  output << "planner,map,size_cells,queries,successes," <<
+    "latency_mean_ms,latency_p50_ms,latency_p90_ms,latency_p99_ms,latency_max_ms," <<
+    "path_length_m,path_mean_cost,path_turning_rad,peak_memory_kb" << std::endl;
+
+  for (unsigned int m = 2; m != args.size(); m++) {
+    nav_msgs::msg::OccupancyGrid map;
+    nav2_map_server::LoadParameters load_parameters;
+    load_parameters.image_file_name = args[m];
+    load_parameters.resolution = resolution;
+    load_parameters.free_thresh = 0.196;
+    load_parameters.occupied_thresh = 0.65;
+    load_parameters.mode = nav2_map_server::MapMode::Trinary;
+    load_parameters.negate = false;
+    nav2_map_server::loadMapFromFile(load_parameters, map);
+
+    for (const int64_t & size : map_sizes) {
+      if (size > static_cast<int64_t>(std::max(map.info.width, map.info.height))) {
+        continue;
+      }
+      nav2_costmap_2d::Costmap2D * costmap = costmap_ros->getCostmap();
+      setCostmap(map, size, costmap);
+      const std::vector<Query> queries = getQueries(costmap, queries_number, seed);
+
+      for (const std::string & planner_id : planner_ids) {
+        nav2_core::GlobalPlanner::Ptr planner;
+        try {
+          declare_parameter_if_not_declared(
+            node, planner_id + ".plugin", rclcpp::ParameterValue(std::string("")));
+          planner = loader.createUniqueInstance(
+            node->get_parameter(planner_id + ".plugin").as_string());
+        } catch (const pluginlib::PluginlibException & ex) {
+          std::cerr << "Failed to create planner " << planner_id << ": " << ex.what() <<
+            std::endl;
+          continue;
+        }
+        planner->configure(node, planner_id, tf, costmap_ros);
+        planner->activate();
+
+        resetPeakMemory();
+        std::vector<double> latencies;
+        unsigned int successes = 0;
+        double length = 0.0, mean_cost = 0.0, turning = 0.0;
+        for (const Query & query : queries) {
+          nav_msgs::msg::Path path;
+          steady_clock::time_point a = steady_clock::now();
+          try {
+            path = planner->createPlan(query.start, query.goal);
+          } catch (...) {
+          }
+          steady_clock::time_point b = steady_clock::now();
+          latencies.push_back(duration_cast<duration<double>>(b - a).count() * 1000.0);
+          if (path.poses.empty()) {
+            continue;
+          }
+
+          successes++;
+          length += nav2_util::geometry_utils::calculate_path_length(path);
+          double cost = 0.0;
+          unsigned int mx, my;
+          for (unsigned int i = 0; i != path.poses.size(); i++) {
+            if (costmap->worldToMap(
+                path.poses[i].pose.position.x, path.poses[i].pose.position.y, mx, my))
+            {
+              cost += costmap->getCost(mx, my);
+            }
+            if (i > 1) {
+              const auto & p0 = path.poses[i - 2].pose.position;
+              const auto & p1 = path.poses[i - 1].pose.position;
+              const auto & p2 = path.poses[i].pose.position;
+              const double heading_change =
+                std::atan2(p2.y - p1.y, p2.x - p1.x) - std::atan2(p1.y - p0.y, p1.x - p0.x);
+              turning += std::fabs(std::atan2(std::sin(heading_change), std::cos(heading_change)));
+            }
+          }
+          mean_cost += cost / path.poses.size();
+        }
+        const long peak_memory = getPeakMemory();  // NOLINT
+
+        planner->deactivate();
+        planner->cleanup();
+        planner.reset();
+
+        double latency_mean = 0.0;
+        for (const double & latency : latencies) {
+          latency_mean += latency / latencies.size();
+        }
+        const double successes_divisor = std::max(successes, 1u);
+        output << planner_id << "," << args[m] << "," << size << "," << queries.size() << "," <<
+          successes << "," << latency_mean << "," << getPercentile(latencies, 0.5) << "," <<
+          getPercentile(latencies, 0.9) << "," << getPercentile(latencies, 0.99) << "," <<
+          getPercentile(latencies, 1.0) << "," << length / successes_divisor << "," <<
+          mean_cost / successes_divisor << "," << turning / successes_divisor << "," <<
+          peak_memory << std::endl;
+      }
+    }
+  }
+
+  costmap_ros->on_cleanup(rclcpp_lifecycle::State());
+  rclcpp::shutdown();
+  return 0;
+}
@@ -20,8 +20,10 @@
 #include <vector>
 #include <queue>
 #include <algorithm>
+#include <cstdint>
 #include "rclcpp/rclcpp.hpp"
 #include "nav2_costmap_2d/costmap_2d_ros.hpp"
+#include "nav2_costmap_2d/visitation_map.hpp"
 
 const double INF_COST = DBL_MAX;
 const int LETHAL_COST = 252;
@@ -56,6 +58,107 @@ struct comp
 
 namespace theta_star
 {
+/**
+ * @brief an open list of two levels, the nodes are placed in buckets of f costs of a given width
+ *            and only the current bucket, that of the lowest costs, is kept as a binary heap; so the
+ *            nodes come out in the order of their f costs as with a priority queue over all of them,
+ *            with the heap operations on the nodes of a single bucket
+ *            the entries hold the f cost of the node when pushed, a node whose cost decreased is pushed
+ *            again and its older entries are dropped when reaching them
+ */
+class bucket_queue
+{
+public:
+  /**
+   * @brief clears the queue, the buckets keep their capacity
+   * @param width is the range of f costs of a bucket
+   */
+  void reset(const double & width)
+  {
+    for (size_t i = current_; i < used_; i++) {
+      buckets_[i].clear();
+    }
+    heap_.clear();
+    width_ = width;
+    current_ = 0;
+    used_ = 0;
+    size_ = 0;
+  }
+
+  void push(tree_node * node)
+  {
+    const size_t bucket = static_cast<size_t>(std::max(node->f, 0.0) / width_);
+    if (bucket <= current_) {
+      heap_.push_back({node->f, node});
+      std::push_heap(heap_.begin(), heap_.end(), heap_comp());
+    } else {
+      if (bucket >= buckets_.size()) {
+        buckets_.resize(bucket + 1);
+      }
+      buckets_[bucket].push_back({node->f, node});
+      used_ = std::max(used_, bucket + 1);
+    }
+    size_++;
+  }
+
+  bool empty()
+  {
+    settle();
+    return size_ == 0;
+  }
+
+  /// must be called only if the queue is not empty
+  tree_node * top() const
+  {
+    return heap_.front().node;
+  }
+
+  void pop()
+  {
+    std::pop_heap(heap_.begin(), heap_.end(), heap_comp());
+    heap_.pop_back();
+    size_--;
+  }
+
+protected:
+  struct entry
+  {
+    double f;
+    tree_node * node;
+  };
+
+  struct heap_comp
+  {
+    bool operator()(const entry & e1, const entry & e2) const
+    {
+      return e1.f > e2.f;
+    }
+  };
+
+  /// moves to the heap the next bucket if the current one is empty and drops the outdated entries,
+  /// until the top of the heap is a node in the queue with its f cost
+  void settle()
+  {
+    while (size_ > 0) {
+      if (heap_.empty()) {
+        while (buckets_[++current_].empty()) {}
+        std::swap(heap_, buckets_[current_]);
+        std::make_heap(heap_.begin(), heap_.end(), heap_comp());
+      }
+      const entry & front = heap_.front();
+      if (front.node->is_in_queue && front.f == front.node->f) {
+        return;
+      }
+      pop();
+    }
+  }
+
+  std::vector<std::vector<entry>> buckets_;
+  std::vector<entry> heap_;
+  double width_ = 1.0;
+  size_t current_ = 0, used_ = 0, size_ = 0;
+};
+
 class ThetaStar
 {
 public:
@@ -72,6 +175,13 @@ public:
   int how_many_corners_;
   /// the x-directional and y-directional lengths of the map respectively
   int size_x_, size_y_;
+  /// whether the open list is a bucket_queue instead of a priority queue
+  bool use_bucket_queue_;
+  /// whether the line of sight checks skip the free cells counted by a summed-area table
+  bool use_los_integral_;
+  /// whether a node reached is given the parent of the node expanded without a line of sight
+  /// check, which is only done once the node is expanded (Lazy Theta*)
+  bool use_lazy_los_;
 
   ThetaStar();
 
@@ -111,6 +221,7 @@ public:
   }
 
   int nodes_opened = 0;
+  int los_checks = 0;
 
 protected:
   /// for the coordinates (x,y), it stores at node_position_[size_x_ * y + x],
@@ -119,6 +230,10 @@ protected:
   /// and its number of elements increases to account for a change in map size
   std::vector<tree_node *> node_position_;
 
+  /// the cells whose pointer in node_position_ was stored during the current execution of
+  /// generatePath, those of the other cells are outdated; it avoids resetting node_position_
+  nav2_costmap_2d::VisitationMap node_stamps_;
+
   /// the vector nodes_data_ stores the coordinates, costs and index of the parent node,
   /// and whether or not the node is present in queue_, for all the nodes searched
   /// it is initialised with no elements
@@ -128,11 +243,33 @@ protected:
   /// this is the priority queue (open_list) to select the next node to be expanded
   std::priority_queue<tree_node *, std::vector<tree_node *>, comp> queue_;
 
+  /// the open list used instead of queue_ if use_bucket_queue_ is set
+  bucket_queue bucket_queue_;
+
   /// it is a counter like variable used to generate consecutive indices
   /// such that the data for all the nodes (in open and closed lists) could be stored
   /// consecutively in nodes_data_
   int index_generated_;
 
+  /// a Bresenham line of the line of sight check, walked along its major axis in steps k,
+  /// the cells of a step lying at a level l of steps along the minor axis
+  struct los_line
+  {
+    int m0, n0;            // start coordinates along the major and minor axis
+    int d_major, d_minor;  // absolute lengths along the major and minor axis
+    int s_major, s_minor;  // step directions along the major and minor axis
+    bool x_major;          // whether the major axis is x
+    int gcd;               // greatest common divisor of d_major and d_minor
+  };
+
+  /// summed-area table of the cells with a cost over FREE_SPACE,
+  /// cost_integral_[(size_x_ + 1) * y + x] counts them in the cells [0, x) x [0, y)
+  /// it is empty unless use_los_integral_ is set
+  std::vector<uint32_t> cost_integral_;
+
+  /// the costs the summed-area table was computed from, to find the cells updated since
+  std::vector<unsigned char> integral_costs_;
+
   const coordsM moves[8] = {{0, 1},
     {0, -1},
     {1, 0},
@@ -152,6 +289,14 @@ protected:
    */
   void resetParent(tree_node * curr_data);
 
+  /**
+   * @brief with use_lazy_los_, it performs the line of sight check between the current node and
+   *            the parent it was given when reached; if there is none, the parent becomes the
+   *            expanded neighbor through which the current node costs the least
+   * @param data of the current node
+   */
+  void setVertex(tree_node * curr_data);
+
   /**
    * @brief this function expands the current node
    * @param curr_data used to send the data of the current node
@@ -170,6 +315,46 @@ protected:
     const int & x0, const int & y0, const int & x1, const int & y1,
     double & sl_cost) const;
 
+  /**
+   * @brief adds the traversal costs of the steps [ka, kb) of a line to sl_cost; the steps
+   *            whose cells are all free according to the summed-area table are counted without
+   *            being visited, and the others are bisected until walking them is cheaper
+   * @return false if a cell of the steps is not safe
+   */
+  bool losCheckSteps(const los_line & line, int ka, int kb, double & sl_cost) const;
+
+  /**
+   * @brief walks the steps [ka, kb) of a line cell by cell, adding their traversal costs to sl_cost
+   * @return false if a cell of the steps is not safe
+   */
+  bool losWalkSteps(const los_line & line, int ka, int kb, double & sl_cost) const;
+
+  /**
+   * @brief checks the cell of the step k of a line at the coordinate n along the minor axis
+   */
+  inline bool isSafeOnLine(const los_line & line, int k, int n, double & cost) const
+  {
+    const int m = line.m0 + line.s_major * k + (line.s_major - 1) / 2;
+    return line.x_major ? isSafe(m, n, cost) : isSafe(n, m, cost);
+  }
+
+  /**
+   * @brief recomputes the summed-area table from the first row and column whose costs changed
+   *            since it was last computed, or in full if the size of the map changed
+   */
+  void updateCostIntegral();
+
+  /**
+   * @brief counts the cells with a cost over FREE_SPACE in the inclusive window [xa, xb] x [ya, yb]
+   */
+  inline uint32_t countCostlyCells(
+    const int & xa, const int & ya, const int & xb, const int & yb) const
+  {
+    const int stride = size_x_ + 1;
+    return cost_integral_[stride * (yb + 1) + xb + 1] - cost_integral_[stride * (yb + 1) + xa] -
+           cost_integral_[stride * ya + xb + 1] + cost_integral_[stride * ya + xa];
+  }
+
   /**
    * @brief it returns the path by backtracking from the goal to the start, by using their parent nodes
    * @param raw_points used to return the path  thus found
@@ -252,7 +437,7 @@ protected:
   }
 
   /**
-   * @brief initialises the node_position_ vector by storing -1 as index for all points(x, y) within the limits of the map
+   * @brief initialises the node_position_ vector by marking all the stored pointers as outdated in node_stamps_
    * @param size_inc is used to increase the number of elements in node_position_ in case the size of the map increases
    */
   void initializePosn(int size_inc = 0);
@@ -264,15 +449,17 @@ protected:
   inline void addIndex(const int & cx, const int & cy, tree_node * node_this)
   {
     node_position_[size_x_ * cy + cx] = node_this;
+    node_stamps_.setVisited(size_x_ * cy + cx);
   }
 
   /**
    * @brief retrieves the pointer of the location at which the data of the point(cx, cy) is stored in nodes_data
-   * @return id_this is the pointer to that location
+   * @return id_this is the pointer to that location, or nullptr if it was not stored in the current execution
    */
   inline tree_node * getIndex(const int & cx, const int & cy)
   {
-    return node_position_[size_x_ * cy + cx];
+    const int index = size_x_ * cy + cx;
+    return node_stamps_.isVisited(index) ? node_position_[index] : nullptr;
   }
 
   /**
@@ -299,6 +486,45 @@ protected:
   void clearQueue()
   {
     queue_ = std::priority_queue<tree_node *, std::vector<tree_node *>, comp>();
+    // buckets of a tenth of the euclidean cost of a cell keep the current heap small
+    bucket_queue_.reset(w_euc_cost_ > 0.0 ? 0.1 * w_euc_cost_ : 0.1);
+  }
+
+  /**
+   * @brief adds a node to the open list in use
+   */
+  inline void pushToQueue(tree_node * node)
+  {
+    if (use_bucket_queue_) {
+      bucket_queue_.push(node);
+    } else {
+      queue_.push(node);
+    }
+  }
+
+  /**
+   * @brief checks whether the open list in use is empty
+   */
+  inline bool isQueueEmpty()
+  {
+    return use_bucket_queue_ ? bucket_queue_.empty() : queue_.empty();
+  }
+
+  /**
+   * @brief removes the node of lowest f cost from the open list in use, which must not be empty
+   * @return the node thus removed
+   */
+  inline tree_node * popFromQueue()
+  {
+    tree_node * node;
+    if (use_bucket_queue_) {
+      node = bucket_queue_.top();
+      bucket_queue_.pop();
+    } else {
+      node = queue_.top();
+      queue_.pop();
+    }
+    return node;
   }
 };
 }   //  namespace theta_star
@@ -12,6 +12,8 @@
 //  See the License for the specific language governing permissions and
 //  limitations under the License.
 
+#include <algorithm>
+#include <numeric>
 #include <vector>
 #include "nav2_theta_star_planner/theta_star.hpp"
 
@@ -25,6 +27,9 @@ ThetaStar::ThetaStar()
   how_many_corners_(8),
   size_x_(0),
   size_y_(0),
+  use_bucket_queue_(false),
+  use_los_integral_(false),
+  use_lazy_los_(false),
   index_generated_(0)
 {
   exp_node = new tree_node;
@@ -45,32 +50,46 @@ void ThetaStar::setStartAndGoal(
 bool ThetaStar::generatePath(std::vector<coordsW> & raw_path)
 {
   resetContainers();
+  clearQueue();
+  if (use_los_integral_) {
+    updateCostIntegral();
+  } else {
+    cost_integral_.clear();
+    integral_costs_.clear();
+  }
   addToNodesData(index_generated_);
   double src_g_cost = getTraversalCost(src_.x, src_.y), src_h_cost = getHCost(src_.x, src_.y);
   nodes_data_[index_generated_] =
   {src_.x, src_.y, src_g_cost, src_h_cost, &nodes_data_[index_generated_], true,
     src_g_cost + src_h_cost};
-  queue_.push({&nodes_data_[index_generated_]});
+  pushToQueue(&nodes_data_[index_generated_]);
   addIndex(src_.x, src_.y, &nodes_data_[index_generated_]);
   tree_node * curr_data = &nodes_data_[index_generated_];
   index_generated_++;
   nodes_opened = 0;
+  los_checks = 0;
 
-  while (!queue_.empty()) {
+  while (!isQueueEmpty()) {
     nodes_opened++;
 
+    if (use_lazy_los_) {
+      // the parent is checked before the goal is accepted as well
+      setVertex(curr_data);
+    }
+
     if (isGoal(*curr_data)) {
       break;
     }
 
-    resetParent(curr_data);
+    if (!use_lazy_los_) {
+      resetParent(curr_data);
+    }
     setNeighbors(curr_data);
 
-    curr_data = queue_.top();
-    queue_.pop();
+    curr_data = popFromQueue();
   }
 
-  if (queue_.empty()) {
+  if (isQueueEmpty()) {
     raw_path.clear();
     return false;
   }
@@ -88,6 +107,7 @@ void ThetaStar::resetParent(tree_node * curr_data)
   const tree_node * curr_par = curr_data->parent_id;
   const tree_node * maybe_par = curr_par->parent_id;
 
+  los_checks++;
   if (losCheck(curr_data->x, curr_data->y, maybe_par->x, maybe_par->y, los_cost)) {
     g_cost = maybe_par->g +
       getEuclideanCost(curr_data->x, curr_data->y, maybe_par->x, maybe_par->y) + los_cost;
@@ -100,12 +120,57 @@ void ThetaStar::resetParent(tree_node * curr_data)
   }
 }
 
+void ThetaStar::setVertex(tree_node * curr_data)
+{
+  double los_cost = 0;
+  curr_data->is_in_queue = false;
+  const tree_node * curr_par = curr_data->parent_id;
+  if (curr_par == curr_data) {
+    return;
+  }
+
+  los_checks++;
+  if (losCheck(curr_data->x, curr_data->y, curr_par->x, curr_par->y, los_cost)) {
+    curr_data->g = curr_par->g +
+      getEuclideanCost(curr_data->x, curr_data->y, curr_par->x, curr_par->y) + los_cost;
+  } else {
+    // the node was reached from an expanded neighbor, which is adjacent so always in sight
+    curr_data->g = INF_COST;
+    for (int i = 0; i < how_many_corners_; i++) {
+      const int mx = curr_data->x + moves[i].x;
+      const int my = curr_data->y + moves[i].y;
+      if (!withinLimits(mx, my)) {
+        continue;
+      }
+
+      const tree_node * m_id = getIndex(mx, my);
+      if (m_id == nullptr || m_id->is_in_queue) {
+        continue;
+      }
+
+      const double g_cost = m_id->g + getEuclideanCost(mx, my, curr_data->x, curr_data->y) +
+        getTraversalCost(curr_data->x, curr_data->y);
+      if (g_cost < curr_data->g) {
+        curr_data->parent_id = m_id;
+        curr_data->g = g_cost;
+      }
+    }
+  }
+  curr_data->f = curr_data->g + curr_data->h;
+}
+
 void ThetaStar::setNeighbors(const tree_node * curr_data)
 {
   int mx, my;
   tree_node * m_id = nullptr;
   double g_cost, h_cost, cal_cost;
 
+  // with use_lazy_los_, the neighbors are given the parent of the current node, assuming a line
+  // of sight to it, at the cost through the current node without the distance saved
+  const tree_node * par = use_lazy_los_ ? curr_data->parent_id : curr_data;
+  const double par_g = curr_data->g -
+    getEuclideanCost(par->x, par->y, curr_data->x, curr_data->y);
+
   for (int i = 0; i < how_many_corners_; i++) {
     mx = curr_data->x + moves[i].x;
     my = curr_data->y + moves[i].y;
@@ -118,11 +183,15 @@ void ThetaStar::setNeighbors(const tree_node * curr_data)
       continue;
     }
 
-    g_cost = curr_data->g + getEuclideanCost(curr_data->x, curr_data->y, mx, my) +
-      getTraversalCost(mx, my);
+    g_cost = par_g + getEuclideanCost(par->x, par->y, mx, my) + getTraversalCost(mx, my);
 
     m_id = getIndex(mx, my);
 
+    // the expanded nodes are closed, as the shortcut costs would reopen them over and over
+    if (use_lazy_los_ && m_id != nullptr && !m_id->is_in_queue) {
+      continue;
+    }
+
     if (m_id == nullptr) {
       addToNodesData(index_generated_);
       m_id = &nodes_data_[index_generated_];
@@ -138,12 +207,15 @@ void ThetaStar::setNeighbors(const tree_node * curr_data)
       exp_node->g = g_cost;
       exp_node->h = h_cost;
       exp_node->f = cal_cost;
-      exp_node->parent_id = curr_data;
+      exp_node->parent_id = par;
       if (!exp_node->is_in_queue) {
         exp_node->x = mx;
         exp_node->y = my;
         exp_node->is_in_queue = true;
-        queue_.push({m_id});
+        pushToQueue(m_id);
+      } else if (use_bucket_queue_) {
+        // the entries of the bucket queue keep the f cost they were pushed with
+        pushToQueue(m_id);
       }
     }
   }
@@ -175,88 +247,165 @@ bool ThetaStar::losCheck(
 {
   sl_cost = 0;
 
-  int cx, cy;
-  int dy = abs(y1 - y0), dx = abs(x1 - x0), f = 0;
-  int sx, sy;
-  sx = x1 > x0 ? 1 : -1;
-  sy = y1 > y0 ? 1 : -1;
-
-  int u_x = (sx - 1) / 2;
-  int u_y = (sy - 1) / 2;
-  cx = x0;
-  cy = y0;
-
-  if (dx >= dy) {
-    while (cx != x1) {
-      f += dy;
-      if (f >= dx) {
-        if (!isSafe(cx + u_x, cy + u_y, sl_cost)) {
-          return false;
-        }
-        cy += sy;
-        f -= dx;
-      }
-      if (f != 0 && !isSafe(cx + u_x, cy + u_y, sl_cost)) {
-        return false;
-      }
-      if (dy == 0 && !isSafe(cx + u_x, cy, sl_cost) && !isSafe(cx + u_x, cy - 1, sl_cost)) {
+  const int dx = abs(x1 - x0), dy = abs(y1 - y0);
+  const int sx = x1 > x0 ? 1 : -1, sy = y1 > y0 ? 1 : -1;
+  const los_line line = dx >= dy ?
+    los_line{x0, y0, dx, dy, sx, sy, true, std::gcd(dx, dy)} :
+    los_line{y0, x0, dy, dx, sy, sx, false, std::gcd(dx, dy)};
+  if (line.d_major == 0) {
+    return true;
+  }
+
+  if (cost_integral_.size() == static_cast<size_t>((size_x_ + 1) * (size_y_ + 1))) {
+    return losCheckSteps(line, 0, line.d_major, sl_cost);
+  }
+  return losWalkSteps(line, 0, line.d_major, sl_cost);
+}
+
+bool ThetaStar::losCheckSteps(const los_line & line, int ka, int kb, double & sl_cost) const
+{
+  // The step k lies at the level(k * d_minor / d_major) before its minor step, and the cells
+  // of the steps [ka, kb) at the levels up to the last one visited before the step kb
+  const int64_t d_minor = line.d_minor;
+  int ma, mb, na, nb;
+  if (line.s_major > 0) {
+    ma = line.m0 + ka;
+    mb = line.m0 + kb - 1;
+  } else {
+    ma = line.m0 - kb;
+    mb = line.m0 - ka - 1;
+  }
+  if (line.d_minor == 0) {
+    // Only the cells of the first check are visited when they are safe
+    na = nb = line.n0;
+  } else {
+    const int la = static_cast<int>(ka * d_minor / line.d_major);
+    const int lb = static_cast<int>((kb * d_minor - 1) / line.d_major);
+    if (line.s_minor > 0) {
+      na = line.n0 + la;
+      nb = line.n0 + lb;
+    } else {
+      na = line.n0 - lb - 1;
+      nb = line.n0 - la - 1;
+    }
+  }
+
+  const uint32_t costly = line.x_major ?
+    countCostlyCells(ma, na, mb, nb) : countCostlyCells(na, ma, nb, mb);
+  if (costly == 0) {
+    // Every step visits a cell per minor step and one more unless it ends on a level,
+    // which happens every d_major / gcd steps, all of cost FREE_SPACE
+    int64_t cells = kb - ka;
+    if (line.d_minor != 0) {
+      cells += (kb * d_minor / line.d_major - ka * d_minor / line.d_major) -
+        (static_cast<int64_t>(kb) * line.gcd / line.d_major -
+        static_cast<int64_t>(ka) * line.gcd / line.d_major);
+    }
+    const double free_cost = 26.0;  // getCost() of a cell of cost FREE_SPACE
+    sl_cost += cells * w_traversal_cost_ * free_cost * free_cost / LETHAL_COST / LETHAL_COST;
+    return true;
+  }
+
+  // Windows mostly made of costly cells are walked instead of being bisected further
+  const int64_t area = static_cast<int64_t>(mb - ma + 1) * (nb - na + 1);
+  if (kb - ka <= 8 || 2 * static_cast<int64_t>(costly) >= area) {
+    return losWalkSteps(line, ka, kb, sl_cost);
+  }
+  const int km = ka + (kb - ka) / 2;
+  return losCheckSteps(line, ka, km, sl_cost) && losCheckSteps(line, km, kb, sl_cost);
+}
+
+bool ThetaStar::losWalkSteps(const los_line & line, int ka, int kb, double & sl_cost) const
+{
+  const int64_t d_minor = line.d_minor;
+  int64_t f = ka * d_minor % line.d_major;
+  int level = static_cast<int>(ka * d_minor / line.d_major);
+  const int u_minor = (line.s_minor - 1) / 2;
+  int n = line.n0 + line.s_minor * level + u_minor;
+
+  for (int k = ka; k < kb; k++) {
+    f += line.d_minor;
+    if (f >= line.d_major) {
+      if (!isSafeOnLine(line, k, n, sl_cost)) {
         return false;
       }
-      cx += sx;
+      n += line.s_minor;
+      f -= line.d_major;
     }
+    if (f != 0 && !isSafeOnLine(line, k, n, sl_cost)) {
+      return false;
+    }
+    if (line.d_minor == 0 && !isSafeOnLine(line, k, line.n0, sl_cost) &&
+      !isSafeOnLine(line, k, line.n0 - 1, sl_cost))
+    {
+      return false;
+    }
+  }
+  return true;
+}
+
+void ThetaStar::updateCostIntegral()
+{
+  const unsigned char * costs = costmap_->getCharMap();
+  const size_t cells = static_cast<size_t>(size_x_) * size_y_;
+  const int stride = size_x_ + 1;
+  int x0 = 0, y0 = 0;
+
+  if (cost_integral_.size() != static_cast<size_t>(stride) * (size_y_ + 1)) {
+    cost_integral_.assign(static_cast<size_t>(stride) * (size_y_ + 1), 0);
   } else {
-    while (cy != y1) {
-      f = f + dx;
-      if (f >= dy) {
-        if (!isSafe(cx + u_x, cy + u_y, sl_cost)) {
-          return false;
+    // Only the sums of the cells after the first changed row and column are affected
+    x0 = size_x_;
+    y0 = size_y_;
+    for (int y = 0; y < size_y_; y++) {
+      const unsigned char * row = costs + static_cast<size_t>(size_x_) * y;
+      const unsigned char * last_row = integral_costs_.data() + static_cast<size_t>(size_x_) * y;
+      for (int x = 0; x < x0; x++) {
+        if (row[x] != last_row[x]) {
+          x0 = x;
+          y0 = std::min(y0, y);
+          break;
         }
-        cx += sx;
-        f -= dy;
       }
-      if (f != 0 && !isSafe(cx + u_x, cy + u_y, sl_cost)) {
-        return false;
-      }
-      if (dx == 0 && !isSafe(cx, cy + u_y, sl_cost) && !isSafe(cx - 1, cy + u_y, sl_cost)) {
-        return false;
-      }
-      cy += sy;
+    }
+    if (y0 == size_y_) {
+      return;
+    }
+  }
+  integral_costs_.assign(costs, costs + cells);
+
+  for (int y = y0; y < size_y_; y++) {
+    const unsigned char * row = costs + static_cast<size_t>(size_x_) * y;
+    uint32_t * above = &cost_integral_[static_cast<size_t>(stride) * y];
+    uint32_t * sums = above + stride;
+    // Costly cells of the row before x0, carried over from the sums left unchanged
+    uint32_t row_count = sums[x0] - above[x0];
+    for (int x = x0; x < size_x_; x++) {
+      row_count += row[x] > nav2_costmap_2d::FREE_SPACE;
+      sums[x + 1] = above[x + 1] + row_count;
     }
   }
-  return true;
 }
 
 void ThetaStar::resetContainers()
 {
   index_generated_ = 0;
-  int last_size_x = size_x_;
-  int last_size_y = size_y_;
   int curr_size_x = static_cast<int>(costmap_->getSizeInCellsX());
   int curr_size_y = static_cast<int>(costmap_->getSizeInCellsY());
-  if (((last_size_x != curr_size_x) || (last_size_y != curr_size_y)) &&
-    static_cast<int>(node_position_.size()) < (curr_size_x * curr_size_y))
-  {
-    initializePosn(curr_size_y * curr_size_x - last_size_y * last_size_x);
+  int size_inc = curr_size_x * curr_size_y - static_cast<int>(node_position_.size());
+  if (size_inc > 0) {
+    // nodes_data_ must not reallocate during a search, as node_position_ points into it
     nodes_data_.reserve(curr_size_x * curr_size_y);
-  } else {
-    initializePosn();
   }
   size_x_ = curr_size_x;
   size_y_ = curr_size_y;
+  initializePosn(std::max(size_inc, 0));
 }
 
 void ThetaStar::initializePosn(int size_inc)
 {
-  int i = 0;
-
-  if (!node_position_.empty()) {
-    for (; i < size_x_ * size_y_; i++) {
-      node_position_[i] = nullptr;
-    }
-  }
-
-  for (; i < size_inc; i++) {
-    node_position_.push_back(nullptr);
-  }
+  node_position_.resize(node_position_.size() + size_inc, nullptr);
+  node_stamps_.resize(node_position_.size());
+  node_stamps_.clear();
 }
 }  //  namespace theta_star
@@ -55,6 +55,18 @@ void ThetaStarPlanner::configure(
 
   planner_->w_heuristic_cost_ = planner_->w_euc_cost_ < 1.0 ? planner_->w_euc_cost_ : 1.0;
 
+  nav2_util::declare_parameter_if_not_declared(
+    node, name_ + ".use_bucket_queue", rclcpp::ParameterValue(false));
+  node->get_parameter(name_ + ".use_bucket_queue", planner_->use_bucket_queue_);
+
+  nav2_util::declare_parameter_if_not_declared(
+    node, name_ + ".use_los_integral", rclcpp::ParameterValue(false));
+  node->get_parameter(name_ + ".use_los_integral", planner_->use_los_integral_);
+
+  nav2_util::declare_parameter_if_not_declared(
+    node, name_ + ".use_lazy_los", rclcpp::ParameterValue(false));
+  node->get_parameter(name_ + ".use_lazy_los", planner_->use_lazy_los_);
+
   nav2_util::declare_parameter_if_not_declared(
     node, name + ".use_final_approach_orientation", rclcpp::ParameterValue(false));
   node->get_parameter(name + ".use_final_approach_orientation", use_final_approach_orientation_);
@@ -215,6 +227,12 @@ ThetaStarPlanner::dynamicParametersCallback(std::vector<rclcpp::Parameter> param
     } else if (type == ParameterType::PARAMETER_BOOL) {
       if (name == name_ + ".use_final_approach_orientation") {
         use_final_approach_orientation_ = parameter.as_bool();
+      } else if (name == name_ + ".use_bucket_queue") {
+        planner_->use_bucket_queue_ = parameter.as_bool();
+      } else if (name == name_ + ".use_los_integral") {
+        planner_->use_los_integral_ = parameter.as_bool();
+      } else if (name == name_ + ".use_lazy_los") {
+        planner_->use_lazy_los_ = parameter.as_bool();
       }
     }
   }
@@ -41,6 +41,10 @@ public:
     return losCheck(x0, y0, x1, y1, sl_cost);
   }
 
+  void uupdateCostIntegral() {updateCostIntegral();}
+
+  void uclearCostIntegral() {cost_integral_.clear();}
+
   bool uwithinLimits(const int & cx, const int & cy) {return withinLimits(cx, cy);}
 
   bool uisGoal(const tree_node & this_node) {return isGoal(this_node);}
@@ -121,7 +125,7 @@ TEST(ThetaStarTest, test_theta_star) {
   EXPECT_FALSE(planner_->isSafe(10, 10));      // cost at this point is 253 (>LETHAL_COST)
 
   /// Check if the functions addIndex & getIndex work properly
-  coordsM c = {20, 30};
+  coordsM c = {10, 15};
   planner_->uaddToNodesData(0);
   planner_->uaddIndex(c.x, c.y);
   tree_node * c_node = planner_->ugetIndex(c.x, c.y);
@@ -143,6 +147,120 @@ TEST(ThetaStarTest, test_theta_star) {
   planner_->src_ = {10, 10};
   EXPECT_FALSE(planner_->runAlgo(path));
   EXPECT_EQ(static_cast<int>(path.size()), 0);
+
+  /// Check if the bucket queue finds a path as well, with the nodes of the previous plans outdated
+  planner_->use_bucket_queue_ = true;
+  planner_->src_ = {s.x, s.y};
+  EXPECT_TRUE(planner_->runAlgo(path));
+  EXPECT_GT(static_cast<int>(path.size()), 0);
+  path.clear();
+  planner_->src_ = {10, 10};
+  EXPECT_FALSE(planner_->runAlgo(path));
+  EXPECT_EQ(static_cast<int>(path.size()), 0);
+}
+
+// The bucket queue should give the nodes in the order of their f costs
+TEST(ThetaStarTest, test_bucket_queue) {
+  theta_star::bucket_queue queue;
+  queue.reset(0.5);
+  EXPECT_TRUE(queue.empty());
+
+  std::vector<tree_node> nodes(6);
+  const std::vector<double> costs = {3.2, 0.1, 7.9, 3.3, 0.4, 12.0};
+  for (size_t i = 0; i < nodes.size(); i++) {
+    nodes[i].f = costs[i];
+    nodes[i].is_in_queue = true;
+    queue.push(&nodes[i]);
+  }
+
+  /// a node whose cost decreased is pushed again and comes out only once
+  nodes[2].f = 1.0;
+  queue.push(&nodes[2]);
+
+  const std::vector<int> order = {1, 4, 2, 0, 3, 5};
+  for (const int & i : order) {
+    ASSERT_FALSE(queue.empty());
+    EXPECT_EQ(queue.top(), &nodes[i]);
+    queue.top()->is_in_queue = false;
+    queue.pop();
+  }
+  EXPECT_TRUE(queue.empty());
+}
+
+// The line of sight checks should find the same lines and costs with the summed-area table
+TEST(ThetaStarTest, test_los_integral) {
+  auto planner_ = std::make_unique<test_theta_star>();
+  planner_->costmap_ = new nav2_costmap_2d::Costmap2D(60, 40, 1.0, 0.0, 0.0, 0);
+  for (int i = 20; i <= 25; i++) {
+    for (int j = 10; j <= 30; j++) {
+      planner_->costmap_->setCost(i, j, j < 20 ? 100 : 254);
+    }
+  }
+  planner_->size_x_ = 60;
+  planner_->size_y_ = 40;
+  planner_->uupdateCostIntegral();
+
+  const std::vector<std::vector<int>> lines = {
+    {1, 1, 58, 38}, {1, 5, 58, 5}, {30, 1, 30, 38}, {58, 15, 2, 12}, {10, 35, 50, 2},
+    {40, 30, 3, 25}, {5, 15, 50, 16}};
+  for (const auto & l : lines) {
+    double walked_cost = 0.0, counted_cost = 0.0;
+    planner_->uclearCostIntegral();
+    bool walked = planner_->ulosCheck(l[0], l[1], l[2], l[3], walked_cost);
+    planner_->uupdateCostIntegral();
+    bool counted = planner_->ulosCheck(l[0], l[1], l[2], l[3], counted_cost);
+    EXPECT_EQ(walked, counted);
+    if (walked) {
+      EXPECT_NEAR(walked_cost, counted_cost, 1e-9);
+    }
+  }
+
+  /// the table should follow the updates of the costmap
+  double sl_cost = 0.0;
+  EXPECT_TRUE(planner_->ulosCheck(1, 35, 58, 35, sl_cost));
+  /// horizontal lines pass between two rows, so both have to be blocked
+  planner_->costmap_->setCost(40, 35, 254);
+  planner_->costmap_->setCost(40, 34, 254);
+  planner_->uupdateCostIntegral();
+  EXPECT_FALSE(planner_->ulosCheck(1, 35, 58, 35, sl_cost));
+  planner_->costmap_->setCost(40, 35, 0);
+  planner_->costmap_->setCost(40, 34, 0);
+  planner_->uupdateCostIntegral();
+  EXPECT_TRUE(planner_->ulosCheck(1, 35, 58, 35, sl_cost));
+}
+
+// Lazy Theta* should find paths in line of sight, checking each expanded node at most once
+TEST(ThetaStarTest, test_lazy_los) {
+  auto planner_ = std::make_unique<test_theta_star>();
+  planner_->costmap_ = new nav2_costmap_2d::Costmap2D(60, 40, 1.0, 0.0, 0.0, 0);
+  for (int i = 20; i <= 25; i++) {
+    for (int j = 5; j <= 35; j++) {
+      planner_->costmap_->setCost(i, j, j < 15 ? 100 : 254);
+    }
+  }
+  planner_->use_lazy_los_ = true;
+  planner_->src_ = {5, 30};
+  planner_->dst_ = {55, 30};
+
+  std::vector<coordsW> path;
+  EXPECT_TRUE(planner_->runAlgo(path));
+  ASSERT_GT(static_cast<int>(path.size()), 2);
+  EXPECT_LE(planner_->los_checks, planner_->nodes_opened);
+  for (size_t i = 1; i < path.size(); i++) {
+    unsigned int x0, y0, x1, y1;
+    planner_->costmap_->worldToMap(path[i - 1].x, path[i - 1].y, x0, y0);
+    planner_->costmap_->worldToMap(path[i].x, path[i].y, x1, y1);
+    double sl_cost = 0.0;
+    EXPECT_TRUE(planner_->ulosCheck(x1, y1, x0, y0, sl_cost));
+  }
+
+  /// and no path through a wall across the map
+  for (int j = 0; j < 40; j++) {
+    planner_->costmap_->setCost(22, j, 254);
+  }
+  path.clear();
+  EXPECT_FALSE(planner_->runAlgo(path));
+  EXPECT_EQ(static_cast<int>(path.size()), 0);
 }
 
 // Smoke tests meant to detect issues arising from the plugin part rather than the algorithm
@@ -16,6 +16,7 @@
 #define NAV2_UTIL__GEOMETRY_UTILS_HPP_
 
 #include <cmath>
+#include <vector>
 
 #include "geometry_msgs/msg/pose.hpp"
 #include "geometry_msgs/msg/pose_stamped.hpp"
@@ -179,6 +180,22 @@ inline double calculate_path_length(const nav_msgs::msg::Path & path, size_t sta
   return path_length;
 }
 
+/**
+ * @brief Calculate the length of the path from its first pose to each of its poses,
+ * so that the length between two poses is the difference of their entries
+ * @param path Path containing the poses that are planned
+ * @return std::vector<double> Path length up to each pose, 0 for the first one
+ */
+inline std::vector<double> calculate_cumulative_path_lengths(const nav_msgs::msg::Path & path)
+{
+  std::vector<double> lengths(path.poses.size(), 0.0);
+  for (size_t idx = 1; idx < path.poses.size(); ++idx) {
+    lengths[idx] =
+      lengths[idx - 1] + euclidean_distance(path.poses[idx - 1].pose, path.poses[idx].pose);
+  }
+  return lengths;
+}
+
 }  // namespace geometry_utils
 }  // namespace nav2_util
 
@@ -0,0 +1,331 @@
+// Copyright (c) 2022 Samsung Research America
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef NAV2_UTIL__GRID_TRAVERSAL_HPP_
+#define NAV2_UTIL__GRID_TRAVERSAL_HPP_
+
+#include <stdlib.h>
+
+#include <algorithm>
+#include <cstdint>
+#include <type_traits>
+#include <utility>
+
+namespace nav2_util
+{
+
+namespace detail
+{
+
+/**
+ * @brief Call a visitor of a traversal, visitors returning void never stopping it
+ * @return False if the traversal is to stop
+ */
+template<class Visitor, class ... Args>
+inline bool visitCell(Visitor & visitor, Args && ... args)
+{
+  if constexpr (std::is_void_v<std::invoke_result_t<Visitor &, Args...>>) {
+    visitor(std::forward<Args>(args)...);
+    return true;
+  } else {
+    return static_cast<bool>(visitor(std::forward<Args>(args)...));
+  }
+}
+
+inline int64_t floorDiv(int64_t a, int64_t b)
+{
+  return a / b - (a % b != 0 && (a < 0) != (b < 0));
+}
+
+inline int64_t ceilDiv(int64_t a, int64_t b)
+{
+  return -floorDiv(-a, b);
+}
+
+}  // namespace detail
+
+/**
+ * @class nav2_util::GridLine
+ * @brief The Bresenham line between two cells, of the same cells as LineIterator and
+ * Costmap2D::raytraceLine, in steps k along its major axis. The cell of the step k is k cells
+ * along the major axis from the start and (d_major / 2 + k * d_minor) / d_major cells along
+ * the minor one, so that any step is found without walking those before it.
+ */
+struct GridLine
+{
+  /**
+   * @brief A constructor for GridLine
+   * @param x0 Starting x
+   * @param y0 Starting y
+   * @param x1 Ending x
+   * @param y1 Ending y
+   */
+  GridLine(int x0, int y0, int x1, int y1)
+  : x0(x0), y0(y0),
+    s_x(x1 >= x0 ? 1 : -1), s_y(y1 >= y0 ? 1 : -1),
+    x_major(abs(x1 - x0) >= abs(y1 - y0))
+  {
+    d_major = x_major ? abs(x1 - x0) : abs(y1 - y0);
+    d_minor = x_major ? abs(y1 - y0) : abs(x1 - x0);
+  }
+
+  /**
+   * @brief Get the number of cells of the line, both ends included
+   */
+  int size() const
+  {
+    return d_major + 1;
+  }
+
+  /**
+   * @brief Get the number of cells along the minor axis from the start to the step k
+   */
+  int level(int k) const
+  {
+    return d_major == 0 ? 0 : static_cast<int>(
+      (d_major / 2 + static_cast<int64_t>(k) * d_minor) / d_major);
+  }
+
+  /**
+   * @brief Get the error of the minor axis at the step k, in [0, d_major)
+   */
+  int error(int k) const
+  {
+    return d_major == 0 ? 0 : static_cast<int>(
+      (d_major / 2 + static_cast<int64_t>(k) * d_minor) % d_major);
+  }
+
+  /**
+   * @brief Get the cell of the step k
+   */
+  void cell(int k, int & x, int & y) const
+  {
+    const int l = level(k);
+    x = x0 + s_x * (x_major ? k : l);
+    y = y0 + s_y * (x_major ? l : k);
+  }
+
+  int x0, y0;        ///< Starting cell
+  int s_x, s_y;      ///< Step directions along x and y
+  bool x_major;      ///< Whether the major axis is x
+  int d_major;       ///< Length along the major axis, in cells
+  int d_minor;       ///< Length along the minor axis, in cells
+};
+
+/**
+ * @brief Visit the cells of the steps [k_begin, k_end) of a line, in order
+ * @param visitor Called with the x and y of each cell, stopping the traversal if it returns false
+ * @return False if the visitor stopped the traversal
+ */
+template<class Visitor>
+inline bool traverseLine(const GridLine & line, int k_begin, int k_end, Visitor && visitor)
+{
+  if (k_begin >= k_end) {
+    return true;
+  }
+  int x, y;
+  line.cell(k_begin, x, y);
+  int error = line.error(k_begin);
+  const int major_x = line.x_major ? line.s_x : 0;
+  const int major_y = line.x_major ? 0 : line.s_y;
+  const int minor_x = line.x_major ? 0 : line.s_x;
+  const int minor_y = line.x_major ? line.s_y : 0;
+  for (int k = k_begin; ; ) {
+    if (!detail::visitCell(visitor, x, y)) {
+      return false;
+    }
+    if (++k == k_end) {
+      return true;
+    }
+    x += major_x;
+    y += major_y;
+    error += line.d_minor;
+    if (error >= line.d_major) {
+      error -= line.d_major;
+      x += minor_x;
+      y += minor_y;
+    }
+  }
+}
+
+/**
+ * @brief Visit the cells of the line between two cells, in order, as LineIterator does
+ * @return False if the visitor stopped the traversal
+ */
+template<class Visitor>
+inline bool traverseLine(int x0, int y0, int x1, int y1, Visitor && visitor)
+{
+  const GridLine line(x0, y0, x1, y1);
+  return traverseLine(line, 0, line.size(), visitor);
+}
+
+/**
+ * @brief Get the steps of a line whose cells are within bounds. As the line is monotonic
+ * along both axes, they are a single range, found without walking the line.
+ * @param min_x Lowest x within bounds
+ * @param min_y Lowest y within bounds
+ * @param max_x Highest x within bounds (exclusive)
+ * @param max_y Highest y within bounds (exclusive)
+ * @param k_begin First step within bounds
+ * @param k_end Last step within bounds (exclusive)
+ * @return False if no cell of the line is within bounds
+ */
+inline bool clipLine(
+  const GridLine & line, int min_x, int min_y, int max_x, int max_y,
+  int & k_begin, int & k_end)
+{
+  // The offsets t from c0 in the direction s of the coordinates within [lo, hi)
+  auto offsets = [](int c0, int s, int lo, int hi, int64_t & a, int64_t & b) {
+      a = s > 0 ? static_cast<int64_t>(lo) - c0 : static_cast<int64_t>(c0) - (hi - 1);
+      b = s > 0 ? static_cast<int64_t>(hi) - 1 - c0 : static_cast<int64_t>(c0) - lo;
+    };
+
+  int64_t first = 0, last = line.d_major, a, b;
+  if (line.x_major) {
+    offsets(line.x0, line.s_x, min_x, max_x, a, b);
+  } else {
+    offsets(line.y0, line.s_y, min_y, max_y, a, b);
+  }
+  first = std::max(first, a);
+  last = std::min(last, b);
+
+  // The levels within bounds along the minor axis, and the steps at those levels
+  if (line.x_major) {
+    offsets(line.y0, line.s_y, min_y, max_y, a, b);
+  } else {
+    offsets(line.x0, line.s_x, min_x, max_x, a, b);
+  }
+  if (line.d_minor == 0) {
+    if (a > 0 || b < 0) {
+      return false;
+    }
+  } else {
+    const int64_t half = line.d_major / 2;
+    first = std::max(first, detail::ceilDiv(a * line.d_major - half, line.d_minor));
+    last = std::min(last, detail::floorDiv((b + 1) * line.d_major - half - 1, line.d_minor));
+  }
+
+  if (first > last) {
+    return false;
+  }
+  k_begin = static_cast<int>(first);
+  k_end = static_cast<int>(last) + 1;
+  return true;
+}
+
+/**
+ * @brief Visit the cells of the line between two cells within bounds, in order. The cells
+ * are those of traverseLine() within bounds, whose ends need not be.
+ * @return False if the visitor stopped the traversal
+ */
+template<class Visitor>
+inline bool traverseLineClipped(
+  int x0, int y0, int x1, int y1, int min_x, int min_y, int max_x, int max_y,
+  Visitor && visitor)
+{
+  const GridLine line(x0, y0, x1, y1);
+  int k_begin, k_end;
+  if (!clipLine(line, min_x, min_y, max_x, max_y, k_begin, k_end)) {
+    return true;
+  }
+  return traverseLine(line, k_begin, k_end, visitor);
+}
+
+/**
+ * @brief Visit the cells of the steps [k_begin, k_end) of a line as runs along rows, in
+ * order, so that visitors read each run from contiguous memory in a loop that vectorizes,
+ * rather than cell by cell. Lines along y have runs of a single cell.
+ * @param visitor Called with the y, the lowest x and the highest x of each run, stopping the
+ * traversal if it returns false
+ * @return False if the visitor stopped the traversal
+ */
+template<class Visitor>
+inline bool traverseLineSpans(const GridLine & line, int k_begin, int k_end, Visitor && visitor)
+{
+  if (!line.x_major) {
+    return traverseLine(
+      line, k_begin, k_end, [&visitor](int x, int y) {
+        return detail::visitCell(visitor, y, x, x);
+      });
+  }
+  if (k_begin >= k_end) {
+    return true;
+  }
+
+  int x, y;
+  line.cell(k_begin, x, y);
+  int error = line.error(k_begin);
+  int first = x;
+  for (int k = k_begin + 1; k < k_end; ++k) {
+    x += line.s_x;
+    error += line.d_minor;
+    if (error >= line.d_major) {
+      error -= line.d_major;
+      const int last = x - line.s_x;
+      if (!detail::visitCell(visitor, y, std::min(first, last), std::max(first, last))) {
+        return false;
+      }
+      y += line.s_y;
+      first = x;
+    }
+  }
+  return detail::visitCell(visitor, y, std::min(first, x), std::max(first, x));
+}
+
+/**
+ * @brief Visit the cells of the line between two cells as runs along rows, in order
+ * @return False if the visitor stopped the traversal
+ */
+template<class Visitor>
+inline bool traverseLineSpans(int x0, int y0, int x1, int y1, Visitor && visitor)
+{
+  const GridLine line(x0, y0, x1, y1);
+  return traverseLineSpans(line, 0, line.size(), visitor);
+}
+
+/**
+ * @brief Visit the indices of the cells of a line in a row-major grid, given the steps of
+ * the indices along its major and minor axes, as Costmap2D::raytraceLine does
+ * @param offset Index of the first cell
+ * @param d_major Length of the line along its major axis
+ * @param d_minor Length of the line along its minor axis
+ * @param error Initial error of the minor axis, in [0, d_major)
+ * @param offset_major Step of the index along the major axis
+ * @param offset_minor Step of the index along the minor axis
+ * @param steps Number of steps along the major axis, the visited cells being one more
+ * @param visitor Called with the index of each cell, stopping the traversal if it returns false
+ * @return False if the visitor stopped the traversal
+ */
+template<class Visitor>
+inline bool traverseLineOffsets(
+  unsigned int offset, unsigned int d_major, unsigned int d_minor, int error,
+  int offset_major, int offset_minor, unsigned int steps, Visitor && visitor)
+{
+  for (unsigned int i = 0; i < steps; ++i) {
+    if (!detail::visitCell(visitor, offset)) {
+      return false;
+    }
+    offset += offset_major;
+    error += d_minor;
+    if (static_cast<unsigned int>(error) >= d_major) {
+      offset += offset_minor;
+      error -= d_major;
+    }
+  }
+  return detail::visitCell(visitor, offset);
+}
+
+}  // namespace nav2_util
+
+#endif  // NAV2_UTIL__GRID_TRAVERSAL_HPP_
@@ -0,0 +1,315 @@
+// Copyright (c) 2022 Samsung Research America
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef NAV2_UTIL__INSTRUMENTATION_HPP_
+#define NAV2_UTIL__INSTRUMENTATION_HPP_
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "nav2_msgs/msg/instrumentation_statistics.hpp"
+#include "nav2_msgs/msg/memory_statistics.hpp"
+#include "rclcpp/rclcpp.hpp"
+#include "rclcpp_lifecycle/lifecycle_node.hpp"
+
+namespace nav2_util
+{
+
+/**
+ * @brief Number of heap allocations made by the calling thread, counted by the
+ * nav2_util_allocation_counter library when it is linked or preloaded into the process
+ */
+uint64_t & threadAllocations();
+
+/**
+ * @class nav2_util::Probe
+ * @brief A named measurement point of the hot paths, accumulating the number, duration
+ * and heap allocations of the scopes it measures, or the increments of a counter. The
+ * measurements are spread over a few cache line aligned slots, each thread always using
+ * the same one, so threads seldom contend on them. Probes register themselves while
+ * they exist, to be reported by getProbeStatistics().
+ */
+class Probe
+{
+public:
+  /**
+   * @brief A constructor for nav2_util::Probe
+   * @param name Name of the probe, by convention as <server or node>.<stage>
+   */
+  explicit Probe(const std::string & name);
+
+  /**
+   * @brief A destructor for nav2_util::Probe
+   */
+  ~Probe();
+
+  Probe(const Probe &) = delete;
+  Probe & operator=(const Probe &) = delete;
+
+  /**
+   * @brief Add a measured scope
+   * @param nanoseconds Duration of the scope
+   * @param allocations Heap allocations in the scope
+   */
+  void record(uint64_t nanoseconds, uint64_t allocations)
+  {
+    Slot & slot = getSlot();
+    slot.calls.fetch_add(1, std::memory_order_relaxed);
+    slot.time.fetch_add(nanoseconds, std::memory_order_relaxed);
+    slot.allocations.fetch_add(allocations, std::memory_order_relaxed);
+    uint64_t max = slot.max_time.load(std::memory_order_relaxed);
+    while (nanoseconds > max &&
+      !slot.max_time.compare_exchange_weak(max, nanoseconds, std::memory_order_relaxed))
+    {
+    }
+  }
+
+  /**
+   * @brief Increment the probe as a counter
+   * @param count Increment
+   */
+  void add(uint64_t count)
+  {
+    getSlot().calls.fetch_add(count, std::memory_order_relaxed);
+  }
+
+  /**
+   * @brief Get the name of the probe
+   */
+  const std::string & getName() const
+  {
+    return name_;
+  }
+
+  /**
+   * @brief Get the measurements of the probe, summed over its slots
+   */
+  nav2_msgs::msg::ProbeStatistics getStatistics() const;
+
+protected:
+  static constexpr unsigned int SLOTS = 8;
+
+  struct alignas(64) Slot
+  {
+    std::atomic<uint64_t> calls{0};
+    std::atomic<uint64_t> time{0};
+    std::atomic<uint64_t> max_time{0};
+    std::atomic<uint64_t> allocations{0};
+  };
+
+  Slot & getSlot()
+  {
+    return slots_[getThreadSlot()];
+  }
+
+  static unsigned int getThreadSlot();
+
+  std::string name_;
+  std::array<Slot, SLOTS> slots_;
+};
+
+/**
+ * @class nav2_util::ScopedProbe
+ * @brief Measures the duration and heap allocations of its scope into a probe
+ */
+class ScopedProbe
+{
+public:
+  using Clock = std::chrono::steady_clock;
+
+  explicit ScopedProbe(Probe & probe)
+  : probe_(probe), allocations_(threadAllocations()), start_(Clock::now())
+  {
+  }
+
+  ~ScopedProbe()
+  {
+    const auto elapsed = std::chrono::duration_cast<std::chrono::nanoseconds>(
+      Clock::now() - start_);
+    probe_.record(elapsed.count(), threadAllocations() - allocations_);
+  }
+
+  ScopedProbe(const ScopedProbe &) = delete;
+  ScopedProbe & operator=(const ScopedProbe &) = delete;
+
+protected:
+  Probe & probe_;
+  uint64_t allocations_;
+  Clock::time_point start_;
+};
+
+/**
+ * @brief Get the measurements of the existing probes
+ * @param prefix Only report the probes whose name starts with it
+ * @return Measurements of the probes, sorted by name
+ */
+std::vector<nav2_msgs::msg::ProbeStatistics> getProbeStatistics(const std::string & prefix = "");
+
+/**
+ * @class nav2_util::MemoryAccount
+ * @brief A named account of the memory owned by an allocator, such as a costmap grid or the
+ * graph of a planner, set by the allocator as its allocations change. Accounts register
+ * themselves while they exist, to be reported by getMemoryStatistics().
+ */
+class MemoryAccount
+{
+public:
+  /**
+   * @brief A constructor for nav2_util::MemoryAccount
+   * @param name Name of the account, by convention as <node>.<plugin or allocator>
+   */
+  explicit MemoryAccount(const std::string & name);
+
+  /**
+   * @brief A destructor for nav2_util::MemoryAccount
+   */
+  ~MemoryAccount();
+
+  MemoryAccount(const MemoryAccount &) = delete;
+  MemoryAccount & operator=(const MemoryAccount &) = delete;
+
+  /**
+   * @brief Set the memory owned
+   * @param bytes Bytes owned by the allocator
+   */
+  void set(uint64_t bytes)
+  {
+    bytes_.store(bytes, std::memory_order_relaxed);
+    uint64_t peak = peak_bytes_.load(std::memory_order_relaxed);
+    while (bytes > peak &&
+      !peak_bytes_.compare_exchange_weak(peak, bytes, std::memory_order_relaxed))
+    {
+    }
+  }
+
+  /**
+   * @brief Get the memory owned, in bytes
+   */
+  uint64_t get() const
+  {
+    return bytes_.load(std::memory_order_relaxed);
+  }
+
+  /**
+   * @brief Get the name of the account
+   */
+  const std::string & getName() const
+  {
+    return name_;
+  }
+
+  /**
+   * @brief Get the memory owned and the most owned since the account was created
+   */
+  nav2_msgs::msg::MemoryStatistics getStatistics() const;
+
+protected:
+  std::string name_;
+  std::atomic<uint64_t> bytes_{0};
+  std::atomic<uint64_t> peak_bytes_{0};
+};
+
+/**
+ * @brief Get the memory of the existing accounts
+ * @param prefix Only report the accounts whose name starts with it
+ * @return Memory of the accounts, sorted by name
+ */
+std::vector<nav2_msgs::msg::MemoryStatistics> getMemoryStatistics(
+  const std::string & prefix = "");
+
+/**
+ * @brief Get the resident memory of the process, in bytes, 0 if unknown
+ */
+uint64_t getResidentMemory();
+
+/**
+ * @class nav2_util::InstrumentationPublisher
+ * @brief Periodically publishes the measurements of probes and the memory accounts on
+ * <node>/instrumentation, every instrumentation_period seconds, 0.0 or less disabling it
+ */
+class InstrumentationPublisher
+{
+public:
+  /**
+   * @brief A constructor for nav2_util::InstrumentationPublisher, to call on configure
+   * @param parent Node declaring the period parameter and publishing the measurements
+   * @param prefixes Only publish the probes whose name starts with one of them
+   * @param memory_prefixes Only publish the memory accounts whose name starts with one of
+   *        them, the probe prefixes if empty, e.g. to include those of the costmap of a server
+   */
+  InstrumentationPublisher(
+    const rclcpp_lifecycle::LifecycleNode::WeakPtr & parent,
+    const std::vector<std::string> & prefixes,
+    const std::vector<std::string> & memory_prefixes = {});
+
+  /**
+   * @brief Start publishing
+   */
+  void activate();
+
+  /**
+   * @brief Stop publishing
+   */
+  void deactivate();
+
+protected:
+  void publish();
+
+  rclcpp_lifecycle::LifecycleNode::WeakPtr node_;
+  std::vector<std::string> prefixes_;
+  std::vector<std::string> memory_prefixes_;
+  double period_;
+  rclcpp_lifecycle::LifecyclePublisher<nav2_msgs::msg::InstrumentationStatistics>::SharedPtr
+    publisher_;
+  rclcpp::TimerBase::SharedPtr timer_;
+};
+
+}  // namespace nav2_util
+
+#define NAV2_PROBE_CONCAT_(a, b) a ## b
+#define NAV2_PROBE_CONCAT(a, b) NAV2_PROBE_CONCAT_(a, b)
+
+#ifndef NAV2_INSTRUMENTATION_DISABLED
+
+/// @brief Measure the rest of the enclosing scope into a static probe of the given name
+#define NAV2_PROBE_SCOPE(name) \
+  static nav2_util::Probe NAV2_PROBE_CONCAT(nav2_probe_, __LINE__)(name); \
+  nav2_util::ScopedProbe NAV2_PROBE_CONCAT(nav2_scoped_probe_, __LINE__)( \
+    NAV2_PROBE_CONCAT(nav2_probe_, __LINE__))
+
+/// @brief Measure the rest of the enclosing scope into an existing probe, such as a member
+#define NAV2_PROBE_SCOPE_ON(probe) \
+  nav2_util::ScopedProbe NAV2_PROBE_CONCAT(nav2_scoped_probe_, __LINE__)(probe)
+
+/// @brief Increment a static counter probe of the given name
+#define NAV2_PROBE_COUNT(name, count) \
+  do { \
+    static nav2_util::Probe nav2_counter_probe(name); \
+    nav2_counter_probe.add(count); \
+  } while (0)
+
+#else
+
+#define NAV2_PROBE_SCOPE(name) static_cast<void>(0)
+#define NAV2_PROBE_SCOPE_ON(probe) static_cast<void>(0)
+#define NAV2_PROBE_COUNT(name, count) static_cast<void>(0)
+
+#endif  // NAV2_INSTRUMENTATION_DISABLED
+
+#endif  // NAV2_UTIL__INSTRUMENTATION_HPP_
@@ -0,0 +1,195 @@
+// Copyright (c) 2022 Samsung Research America
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef NAV2_UTIL__LAZY_PLUGIN_HPP_
+#define NAV2_UTIL__LAZY_PLUGIN_HPP_
+
+#include <chrono>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <utility>
+
+namespace nav2_util
+{
+
+/**
+ * @class nav2_util::LazyPlugin
+ * @brief A lifecycle plugin of a server, loaded and configured on its first use rather than
+ * along with the server, and optionally unloaded again once unused for a while. It follows
+ * the activation of the server, activating the plugin whenever it is loaded while active.
+ * Uses of the plugin are serialized, so that it is never unloaded while in use.
+ */
+template<class PluginT>
+class LazyPlugin
+{
+public:
+  using Clock = std::chrono::steady_clock;
+  using Ptr = std::shared_ptr<PluginT>;
+
+  /**
+   * @brief A constructor for nav2_util::LazyPlugin
+   * @param load Function creating and configuring the plugin
+   * @param unload_timeout Time without use after which the plugin is unloaded, never if zero
+   * @param restore Function called with the plugin once loaded and activated, if set, to
+   * restore the state given to previous instances
+   */
+  explicit LazyPlugin(
+    std::function<Ptr()> load,
+    Clock::duration unload_timeout = Clock::duration::zero(),
+    std::function<void(PluginT &)> restore = nullptr)
+  : load_(std::move(load)), restore_(std::move(restore)), unload_timeout_(unload_timeout)
+  {
+  }
+
+  /**
+   * @brief Call a function with the plugin, loading it first if needed
+   * @return The result of the function
+   */
+  template<class Function>
+  auto use(Function && function)
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    PluginT & plugin = get();
+    last_use_ = Clock::now();
+    return function(plugin);
+  }
+
+  /**
+   * @brief Call a function with the plugin if loaded, or with null otherwise, without loading
+   * it or counting as a use
+   */
+  template<class Function>
+  void useIfLoaded(Function && function)
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    function(plugin_.get());
+  }
+
+  /**
+   * @brief Load the plugin ahead of its first use, e.g. in the background after activation
+   */
+  void warm()
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    get();
+  }
+
+  /**
+   * @brief Activate the plugin if loaded, and those loaded later on
+   */
+  void activate()
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    active_ = true;
+    if (plugin_) {
+      plugin_->activate();
+    }
+  }
+
+  /**
+   * @brief Deactivate the plugin if loaded
+   */
+  void deactivate()
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    active_ = false;
+    if (plugin_) {
+      plugin_->deactivate();
+    }
+  }
+
+  /**
+   * @brief Clean up and unload the plugin if loaded
+   */
+  void cleanup()
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    unload();
+  }
+
+  /**
+   * @brief Unload the plugin if it wasn't used since the unload timeout. A plugin in use is
+   * left loaded rather than waited for.
+   * @param now Current time
+   * @return True if the plugin was unloaded
+   */
+  bool unloadIfIdle(Clock::time_point now = Clock::now())
+  {
+    std::unique_lock<std::mutex> lock(mutex_, std::try_to_lock);
+    if (!lock.owns_lock() || !plugin_ || unload_timeout_ <= Clock::duration::zero() ||
+      now - last_use_ < unload_timeout_)
+    {
+      return false;
+    }
+    unload();
+    return true;
+  }
+
+  /**
+   * @brief Whether the plugin is loaded
+   */
+  bool isLoaded()
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return static_cast<bool>(plugin_);
+  }
+
+protected:
+  /**
+   * @brief Get the plugin, loading it if needed, with the mutex held
+   */
+  PluginT & get()
+  {
+    if (!plugin_) {
+      Ptr plugin = load_();
+      if (active_) {
+        plugin->activate();
+      }
+      if (restore_) {
+        restore_(*plugin);
+      }
+      plugin_ = std::move(plugin);
+      last_use_ = Clock::now();
+    }
+    return *plugin_;
+  }
+
+  /**
+   * @brief Unload the plugin if loaded, with the mutex held
+   */
+  void unload()
+  {
+    if (plugin_) {
+      if (active_) {
+        plugin_->deactivate();
+      }
+      plugin_->cleanup();
+      plugin_.reset();
+    }
+  }
+
+  std::function<Ptr()> load_;
+  std::function<void(PluginT &)> restore_;
+  Clock::duration unload_timeout_;
+
+  std::mutex mutex_;
+  Ptr plugin_;
+  bool active_{false};
+  Clock::time_point last_use_;
+};
+
+}  // namespace nav2_util
+
+#endif  // NAV2_UTIL__LAZY_PLUGIN_HPP_
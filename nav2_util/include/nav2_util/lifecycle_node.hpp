@@ -20,6 +20,7 @@
 #include <thread>
 
 #include "nav2_util/node_thread.hpp"
+#include "nav2_util/shared_heartbeat.hpp"
 #include "rclcpp_lifecycle/lifecycle_node.hpp"
 #include "rclcpp/rclcpp.hpp"
 #include "bondcpp/bond.hpp"
@@ -176,7 +177,8 @@ public:
   }
 
   /**
-   * @brief Create bond connection to lifecycle manager
+   * @brief Create bond connection to lifecycle manager, or beat into the shared heartbeat
+   * it requested if it is on the same host
    */
   void createBond();
 
@@ -203,6 +205,10 @@ protected:
 
   // Connection to tell that server is still up
   std::unique_ptr<bond::Bond> bond_{nullptr};
+
+  // Shared memory heartbeat used instead of the bond, and the timer beating into it
+  std::unique_ptr<nav2_util::SharedHeartbeat> heartbeat_;
+  rclcpp::TimerBase::SharedPtr heartbeat_timer_;
 };
 
 }  // namespace nav2_util
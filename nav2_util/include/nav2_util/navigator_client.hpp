@@ -0,0 +1,263 @@
+// Copyright (c) 2022 Samsung Research America
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef NAV2_UTIL__NAVIGATOR_CLIENT_HPP_
+#define NAV2_UTIL__NAVIGATOR_CLIENT_HPP_
+
+#include <chrono>
+#include <functional>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+#include "geometry_msgs/msg/pose_stamped.hpp"
+#include "nav_msgs/msg/path.hpp"
+#include "nav2_msgs/action/compute_path_through_poses.hpp"
+#include "nav2_msgs/action/compute_path_to_pose.hpp"
+#include "nav2_msgs/action/follow_path.hpp"
+#include "nav2_msgs/action/follow_waypoints.hpp"
+#include "nav2_msgs/action/navigate_through_poses.hpp"
+#include "nav2_msgs/action/navigate_to_pose.hpp"
+#include "nav2_msgs/srv/compute_paths.hpp"
+#include "nav2_util/node_thread.hpp"
+#include "rclcpp/rclcpp.hpp"
+#include "rclcpp_action/rclcpp_action.hpp"
+
+namespace nav2_util
+{
+
+/**
+ * @class nav2_util::NavigatorClient
+ * @brief A C++ counterpart of the BasicNavigator of nav2_simple_commander, sending the
+ * tasks of navigation asynchronously. Each task returns a future of its result, and its
+ * feedback is passed to a callback as it comes, both from the callbacks of the node, so
+ * that many tasks may be in flight without spinning for each of them.
+ */
+class NavigatorClient
+{
+public:
+  template<class ActionT>
+  using Result = typename rclcpp_action::ClientGoalHandle<ActionT>::WrappedResult;
+  template<class ActionT>
+  using ResultFuture = std::shared_future<Result<ActionT>>;
+  template<class ActionT>
+  using FeedbackCallback =
+    std::function<void (const std::shared_ptr<const typename ActionT::Feedback>)>;
+
+  using NavigateToPose = nav2_msgs::action::NavigateToPose;
+  using NavigateThroughPoses = nav2_msgs::action::NavigateThroughPoses;
+  using FollowWaypoints = nav2_msgs::action::FollowWaypoints;
+  using FollowPath = nav2_msgs::action::FollowPath;
+  using ComputePathToPose = nav2_msgs::action::ComputePathToPose;
+  using ComputePathThroughPoses = nav2_msgs::action::ComputePathThroughPoses;
+  using ComputePaths = nav2_msgs::srv::ComputePaths;
+  using PathsFuture = std::shared_future<ComputePaths::Response::SharedPtr>;
+
+  /**
+   * @brief A constructor for nav2_util::NavigatorClient
+   * @param node Node to create the action and service clients off of
+   * @param spin_thread Whether to spin the node in a thread of the client, false if
+   * the node is spun by an executor of the caller. The results and feedback are only
+   * received while the node is spun.
+   */
+  explicit NavigatorClient(const rclcpp::Node::SharedPtr & node, bool spin_thread = true);
+
+  /**
+   * @brief Block until the servers of all the tasks are available or timeout. Goals sent
+   * to a server not available are never answered.
+   * @param timeout Maximum timeout to wait for each server
+   * @return bool true if all the servers are available
+   */
+  bool waitForServers(std::chrono::nanoseconds timeout = std::chrono::nanoseconds(-1));
+
+  /**
+   * @brief Navigate to a pose
+   * @param pose Goal pose
+   * @param behavior_tree Behavior tree to navigate with, empty for the default one
+   * @param feedback_callback Callback receiving the feedback of the task, if any
+   * @return Future of the result, aborted with no result if the goal is rejected
+   */
+  ResultFuture<NavigateToPose> goToPose(
+    const geometry_msgs::msg::PoseStamped & pose,
+    const std::string & behavior_tree = "",
+    FeedbackCallback<NavigateToPose> feedback_callback = nullptr);
+
+  /**
+   * @brief Navigate through poses
+   * @param poses Poses to go through, the last being the goal
+   * @param behavior_tree Behavior tree to navigate with, empty for the default one
+   * @param feedback_callback Callback receiving the feedback of the task, if any
+   * @return Future of the result, aborted with no result if the goal is rejected
+   */
+  ResultFuture<NavigateThroughPoses> goThroughPoses(
+    const std::vector<geometry_msgs::msg::PoseStamped> & poses,
+    const std::string & behavior_tree = "",
+    FeedbackCallback<NavigateThroughPoses> feedback_callback = nullptr);
+
+  /**
+   * @brief Navigate to each of the waypoints in turn
+   * @param poses Waypoints to go to
+   * @param feedback_callback Callback receiving the feedback of the task, if any
+   * @return Future of the result, aborted with no result if the goal is rejected
+   */
+  ResultFuture<FollowWaypoints> followWaypoints(
+    const std::vector<geometry_msgs::msg::PoseStamped> & poses,
+    FeedbackCallback<FollowWaypoints> feedback_callback = nullptr);
+
+  /**
+   * @brief Follow a path with the controller server
+   * @param path Path to follow
+   * @param controller_id Controller to follow the path with, empty for the only one
+   * @param goal_checker_id Goal checker to use, empty for the only one
+   * @param feedback_callback Callback receiving the feedback of the task, if any
+   * @return Future of the result, aborted with no result if the goal is rejected
+   */
+  ResultFuture<FollowPath> followPath(
+    const nav_msgs::msg::Path & path,
+    const std::string & controller_id = "",
+    const std::string & goal_checker_id = "",
+    FeedbackCallback<FollowPath> feedback_callback = nullptr);
+
+  /**
+   * @brief Compute a path to a pose with the planner server
+   * @param start Start of the path, if use_start
+   * @param goal Goal of the path
+   * @param planner_id Planner to compute the path with, empty for the only one
+   * @param use_start Whether to start from start rather than from the robot pose
+   * @return Future of the result, aborted with no result if the goal is rejected
+   */
+  ResultFuture<ComputePathToPose> getPath(
+    const geometry_msgs::msg::PoseStamped & start,
+    const geometry_msgs::msg::PoseStamped & goal,
+    const std::string & planner_id = "",
+    bool use_start = false);
+
+  /**
+   * @brief Compute a path through poses with the planner server
+   * @param start Start of the path, if use_start
+   * @param goals Poses to go through, the last being the goal
+   * @param planner_id Planner to compute the path with, empty for the only one
+   * @param use_start Whether to start from start rather than from the robot pose
+   * @return Future of the result, aborted with no result if the goal is rejected
+   */
+  ResultFuture<ComputePathThroughPoses> getPathThroughPoses(
+    const geometry_msgs::msg::PoseStamped & start,
+    const std::vector<geometry_msgs::msg::PoseStamped> & goals,
+    const std::string & planner_id = "",
+    bool use_start = false);
+
+  /**
+   * @brief Compute a batch of paths with the compute_paths service of the planner server,
+   * in parallel on its planner pool if it has one, without preempting its actions
+   * @param goals Goals of the paths
+   * @param starts Starts of the paths, one for each goal, or none to plan from the robot pose
+   * @param planner_id Planner to compute the paths with, empty for the only one
+   * @return Future of the response, with the paths in the order of the goals, empty for
+   * those that could not be planned, or nullptr if the batch is canceled
+   */
+  PathsFuture getPaths(
+    const std::vector<geometry_msgs::msg::PoseStamped> & goals,
+    const std::vector<geometry_msgs::msg::PoseStamped> & starts = {},
+    const std::string & planner_id = "");
+
+  /**
+   * @brief Cancel all the tasks sent by the client. The batches of paths can't be canceled
+   * on the planner server, so only their responses are dropped.
+   */
+  void cancelAll();
+
+protected:
+  struct PathsRequest;
+
+  /**
+   * @brief Send a goal
+   * @return Future of the result
+   */
+  template<class ActionT>
+  static ResultFuture<ActionT> sendGoal(
+    const typename rclcpp_action::Client<ActionT>::SharedPtr & client,
+    const typename ActionT::Goal & goal,
+    FeedbackCallback<ActionT> feedback_callback)
+  {
+    auto promise = std::make_shared<std::promise<Result<ActionT>>>();
+    ResultFuture<ActionT> future = promise->get_future().share();
+    dispatchGoal<ActionT>(client, goal, feedback_callback, promise);
+    return future;
+  }
+
+  /**
+   * @brief Send a goal, fulfilling a promise of its result when done
+   * @param on_done Called after the promise is fulfilled, if any
+   */
+  template<class ActionT>
+  static void dispatchGoal(
+    const typename rclcpp_action::Client<ActionT>::SharedPtr & client,
+    const typename ActionT::Goal & goal,
+    FeedbackCallback<ActionT> feedback_callback,
+    const std::shared_ptr<std::promise<Result<ActionT>>> & promise,
+    std::function<void()> on_done = nullptr)
+  {
+    auto send_goal_options = typename rclcpp_action::Client<ActionT>::SendGoalOptions();
+    send_goal_options.goal_response_callback =
+      [promise, on_done](
+      const typename rclcpp_action::ClientGoalHandle<ActionT>::SharedPtr & goal_handle) {
+        if (!goal_handle) {
+          Result<ActionT> result;
+          result.code = rclcpp_action::ResultCode::ABORTED;
+          promise->set_value(result);
+          if (on_done) {
+            on_done();
+          }
+        }
+      };
+    send_goal_options.result_callback =
+      [promise, on_done](const Result<ActionT> & result) {
+        promise->set_value(result);
+        if (on_done) {
+          on_done();
+        }
+      };
+    if (feedback_callback) {
+      send_goal_options.feedback_callback =
+        [feedback_callback](
+        typename rclcpp_action::ClientGoalHandle<ActionT>::SharedPtr,
+        const std::shared_ptr<const typename ActionT::Feedback> feedback) {
+          feedback_callback(feedback);
+        };
+    }
+    client->async_send_goal(goal, send_goal_options);
+  }
+
+  rclcpp::Node::SharedPtr node_;
+
+  rclcpp_action::Client<NavigateToPose>::SharedPtr nav_to_pose_client_;
+  rclcpp_action::Client<NavigateThroughPoses>::SharedPtr nav_through_poses_client_;
+  rclcpp_action::Client<FollowWaypoints>::SharedPtr follow_waypoints_client_;
+  rclcpp_action::Client<FollowPath>::SharedPtr follow_path_client_;
+  rclcpp_action::Client<ComputePathToPose>::SharedPtr compute_path_to_pose_client_;
+  rclcpp_action::Client<ComputePathThroughPoses>::SharedPtr compute_path_through_poses_client_;
+  rclcpp::Client<ComputePaths>::SharedPtr compute_paths_client_;
+
+  std::mutex paths_requests_mutex_;
+  std::vector<std::weak_ptr<PathsRequest>> paths_requests_;
+
+  // Stops spinning before the clients are destroyed
+  std::unique_ptr<nav2_util::NodeThread> node_thread_;
+};
+
+}  // namespace nav2_util
+
+#endif  // NAV2_UTIL__NAVIGATOR_CLIENT_HPP_
@@ -82,7 +82,8 @@ get_node_options_default(bool allow_undeclared = true, bool declare_initial_para
 
 /// Declares static ROS2 parameter and sets it to a given value if it was not already declared
 /* Declares static ROS2 parameter and sets it to a given value
- * if it was not already declared.
+ * if it was not already declared. Safe to call from several threads at once,
+ * as plugins configured concurrently do.
  *
  * \param[in] node A node in which given parameter to be declared
  * \param[in] param_name The name of parameter
@@ -98,12 +99,17 @@ void declare_parameter_if_not_declared(
   rcl_interfaces::msg::ParameterDescriptor())
 {
   if (!node->has_parameter(param_name)) {
-    node->declare_parameter(param_name, default_value, parameter_descriptor);
+    try {
+      node->declare_parameter(param_name, default_value, parameter_descriptor);
+    } catch (const rclcpp::exceptions::ParameterAlreadyDeclaredException &) {
+      // Declared by another thread since it was checked for
+    }
   }
 }
 
 /// Declares static ROS2 parameter with given type if it was not already declared
 /* Declares static ROS2 parameter with given type if it was not already declared.
+ * Safe to call from several threads at once.
  *
  * \param[in] node A node in which given parameter to be declared
  * \param[in] param_type The type of parameter
@@ -119,7 +125,11 @@ void declare_parameter_if_not_declared(
   rcl_interfaces::msg::ParameterDescriptor())
 {
   if (!node->has_parameter(param_name)) {
-    node->declare_parameter(param_name, param_type, parameter_descriptor);
+    try {
+      node->declare_parameter(param_name, param_type, parameter_descriptor);
+    } catch (const rclcpp::exceptions::ParameterAlreadyDeclaredException &) {
+      // Declared by another thread since it was checked for
+    }
   }
 }
 
@@ -16,12 +16,15 @@
 #ifndef NAV2_UTIL__ODOMETRY_UTILS_HPP_
 #define NAV2_UTIL__ODOMETRY_UTILS_HPP_
 
+#include <array>
+#include <atomic>
 #include <cmath>
 #include <chrono>
+#include <cstdint>
 #include <memory>
 #include <mutex>
 #include <string>
-#include <deque>
+#include <vector>
 
 #include "geometry_msgs/msg/twist.hpp"
 #include "geometry_msgs/msg/twist_stamped.hpp"
@@ -36,7 +39,9 @@ namespace nav2_util
 /**
  * @class OdomSmoother
  * Wrapper for getting smooth odometry readings using a simple moving avergae.
- * Subscribes to the topic with a mutex.
+ * The velocities of the history are kept in a ring buffer with their running sum,
+ * updated in constant time per message, and the average is published to the readers
+ * through a sequence lock, so they never wait for the subscription callback.
  */
 class OdomSmoother
 {
@@ -68,13 +73,13 @@ public:
    * @brief Get twist msg from smoother
    * @return twist Twist msg
    */
-  inline geometry_msgs::msg::Twist getTwist() {return vel_smooth_.twist;}
+  geometry_msgs::msg::Twist getTwist() const;
 
   /**
    * @brief Get twist stamped msg from smoother
    * @return twist TwistStamped msg
    */
-  inline geometry_msgs::msg::TwistStamped getTwistStamped() {return vel_smooth_;}
+  geometry_msgs::msg::TwistStamped getTwistStamped() const;
 
 protected:
   /**
@@ -88,13 +93,39 @@ protected:
    */
   void updateState();
 
+  /**
+   * @brief Read the twist published by updateState()
+   * @param twist Set to the smoothed twist
+   * @param stamp Set to the stamp of the last message, if not null
+   */
+  void readState(geometry_msgs::msg::Twist & twist, builtin_interfaces::msg::Time * stamp) const;
+
+  // Linear then angular velocities, in x, y and z
+  using Velocities = std::array<double, 6>;
+
+  struct Sample
+  {
+    int64_t stamp;
+    Velocities velocities;
+  };
+
   rclcpp::Subscription<nav_msgs::msg::Odometry>::SharedPtr odom_sub_;
-  nav_msgs::msg::Odometry odom_cumulate_;
-  geometry_msgs::msg::TwistStamped vel_smooth_;
   std::mutex odom_mutex_;
-
   rclcpp::Duration odom_history_duration_;
-  std::deque<nav_msgs::msg::Odometry> odom_history_;
+
+  // Ring buffer of the history, only growing when full
+  std::vector<Sample> odom_history_;
+  size_t history_front_{0};
+  size_t history_size_{0};
+  Velocities odom_cumulate_{};
+
+  // Smoothed twist, written under the sequence lock, odd while being written
+  std::atomic<uint64_t> sequence_{0};
+  std::array<std::atomic<double>, 6> vel_smooth_{};
+  std::atomic<int32_t> stamp_sec_{0};
+  std::atomic<uint32_t> stamp_nanosec_{0};
+  // Only replaced when the frame of the messages changes
+  std::shared_ptr<const std::string> frame_id_;
 };
 
 }  // namespace nav2_util
@@ -24,6 +24,7 @@
 #include <thread>
 
 #include "geometry_msgs/msg/pose_stamped.hpp"
+#include "nav2_util/transform_cache.hpp"
 #include "tf2_ros/buffer.h"
 #include "tf2_geometry_msgs/tf2_geometry_msgs.hpp"
 #include "rclcpp/rclcpp.hpp"
@@ -60,6 +61,36 @@ bool transformPoseInTargetFrame(
   tf2_ros::Buffer & tf_buffer, const std::string target_frame,
   const double transform_timeout = 0.1);
 
+/**
+* @brief get the current pose of the robot, through a transform cache
+* @param global_pose Pose to transform
+* @param tf_cache Transform cache to use for the transformation
+* @param global_frame Frame to transform into
+* @param robot_frame Frame to transform from
+* @param transform_timeout TF Timeout to use for transformation
+* @return bool Whether it could be transformed successfully
+*/
+bool getCurrentPose(
+  geometry_msgs::msg::PoseStamped & global_pose,
+  TransformCache & tf_cache, const std::string global_frame = "map",
+  const std::string robot_frame = "base_link", const double transform_timeout = 0.1,
+  const rclcpp::Time stamp = rclcpp::Time());
+
+/**
+* @brief get an arbitrary pose in a target frame, through a transform cache
+* @param input_pose Pose to transform
+* @param transformed_pose Output transformation
+* @param tf_cache Transform cache to use for the transformation
+* @param target_frame Frame to transform into
+* @param transform_timeout TF Timeout to use for transformation
+* @return bool Whether it could be transformed successfully
+*/
+bool transformPoseInTargetFrame(
+  const geometry_msgs::msg::PoseStamped & input_pose,
+  geometry_msgs::msg::PoseStamped & transformed_pose,
+  TransformCache & tf_cache, const std::string target_frame,
+  const double transform_timeout = 0.1);
+
 }  // end namespace nav2_util
 
 #endif  // NAV2_UTIL__ROBOT_UTILS_HPP_
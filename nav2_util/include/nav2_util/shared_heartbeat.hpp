@@ -0,0 +1,111 @@
+// Copyright (c) 2022 Samsung Research America
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+
+#ifndef NAV2_UTIL__SHARED_HEARTBEAT_HPP_
+#define NAV2_UTIL__SHARED_HEARTBEAT_HPP_
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <memory>
+#include <string>
+
+namespace nav2_util
+{
+
+/**
+ * @class nav2_util::SharedHeartbeat
+ * @brief Heartbeat of a node to the lifecycle manager through shared memory, for nodes on
+ * the same host as the manager, in place of a bond publishing heartbeats over DDS topics.
+ * The manager requests it by creating the shared memory segment of the node before
+ * activating it, and the node accepts it by opening the segment and beating into it. Nodes
+ * on other hosts don't find the segment, and fall back to a bond.
+ */
+class SharedHeartbeat
+{
+public:
+  /**
+   * @brief Request the heartbeat of a node, creating its segment anew
+   * @param node_name Fully qualified name of the node
+   * @return The heartbeat, or nullptr if the segment could not be created
+   */
+  static std::unique_ptr<SharedHeartbeat> request(const std::string & node_name);
+
+  /**
+   * @brief Accept the heartbeat requested for a node, opening its segment
+   * @param node_name Fully qualified name of the node
+   * @return The heartbeat, or nullptr if it was not requested on this host
+   */
+  static std::unique_ptr<SharedHeartbeat> accept(const std::string & node_name);
+
+  /**
+   * @brief Get the name of the shared memory segment of a node, unique to the node and to
+   * the ROS domain
+   * @param node_name Fully qualified name of the node
+   */
+  static std::string getSegmentName(const std::string & node_name);
+
+  /**
+   * @brief A destructor, unmapping the segment and removing it if it was requested
+   */
+  ~SharedHeartbeat();
+
+  SharedHeartbeat(const SharedHeartbeat &) = delete;
+  SharedHeartbeat & operator=(const SharedHeartbeat &) = delete;
+
+  /**
+   * @brief Beat, stamping the segment with the current steady time
+   */
+  void beat();
+
+  /**
+   * @brief Whether the node beat since the heartbeat was requested
+   */
+  bool hasBeaten() const;
+
+  /**
+   * @brief Whether the node didn't beat for longer than a timeout, as a broken bond
+   * @param timeout Duration without beats after which the heartbeat is broken
+   */
+  bool isBroken(const std::chrono::nanoseconds & timeout) const;
+
+protected:
+  /**
+   * @brief Contents of the segment, steady clocks being the same for all processes of a host
+   */
+  struct Segment
+  {
+    std::atomic<int64_t> last_beat_ns;
+  };
+
+  /**
+   * @brief A constructor, from a mapped segment
+   */
+  SharedHeartbeat(const std::string & segment_name, Segment * segment, bool owner);
+
+  /**
+   * @brief Map the segment of a node, creating it anew if requested
+   * @return The heartbeat, or nullptr on failure
+   */
+  static std::unique_ptr<SharedHeartbeat> map(const std::string & node_name, bool create);
+
+  std::string segment_name_;
+  Segment * segment_;
+  bool owner_;
+};
+
+}  // namespace nav2_util
+
+#endif  // NAV2_UTIL__SHARED_HEARTBEAT_HPP_
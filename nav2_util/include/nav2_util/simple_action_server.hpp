@@ -15,12 +15,14 @@
 #ifndef NAV2_UTIL__SIMPLE_ACTION_SERVER_HPP_
 #define NAV2_UTIL__SIMPLE_ACTION_SERVER_HPP_
 
+#include <atomic>
 #include <memory>
 #include <mutex>
 #include <string>
 #include <thread>
 #include <future>
 #include <chrono>
+#include <condition_variable>
 
 #include "rclcpp/rclcpp.hpp"
 #include "rclcpp_action/rclcpp_action.hpp"
@@ -57,6 +59,8 @@ public:
    * @param server_timeout Timeout to to react to stop or preemption requests
    * @param spin_thread Whether to spin with a dedicated thread internally
    * @param options Options to pass to the underlying rcl_action_server_t
+   * @param persistent_worker Whether to execute the goals on a thread kept for the lifetime
+   * of the server, woken up on new goals, rather than on a new thread for each goal
    */
   template<typename NodeT>
   explicit SimpleActionServer(
@@ -66,13 +70,15 @@ public:
     CompletionCallback completion_callback = nullptr,
     std::chrono::milliseconds server_timeout = std::chrono::milliseconds(500),
     bool spin_thread = false,
-    const rcl_action_server_options_t & options = rcl_action_server_get_default_options())
+    const rcl_action_server_options_t & options = rcl_action_server_get_default_options(),
+    bool persistent_worker = false)
   : SimpleActionServer(
       node->get_node_base_interface(),
       node->get_node_clock_interface(),
       node->get_node_logging_interface(),
       node->get_node_waitables_interface(),
-      action_name, execute_callback, completion_callback, server_timeout, spin_thread, options)
+      action_name, execute_callback, completion_callback, server_timeout, spin_thread, options,
+      persistent_worker)
   {}
 
   /**
@@ -83,6 +89,8 @@ public:
    * @param server_timeout Timeout to to react to stop or preemption requests
    * @param spin_thread Whether to spin with a dedicated thread internally
    * @param options Options to pass to the underlying rcl_action_server_t
+   * @param persistent_worker Whether to execute the goals on a thread kept for the lifetime
+   * of the server, woken up on new goals, rather than on a new thread for each goal
    */
   explicit SimpleActionServer(
     rclcpp::node_interfaces::NodeBaseInterface::SharedPtr node_base_interface,
@@ -94,7 +102,8 @@ public:
     CompletionCallback completion_callback = nullptr,
     std::chrono::milliseconds server_timeout = std::chrono::milliseconds(500),
     bool spin_thread = false,
-    const rcl_action_server_options_t & options = rcl_action_server_get_default_options())
+    const rcl_action_server_options_t & options = rcl_action_server_get_default_options(),
+    bool persistent_worker = false)
   : node_base_interface_(node_base_interface),
     node_clock_interface_(node_clock_interface),
     node_logging_interface_(node_logging_interface),
@@ -103,6 +112,7 @@ public:
     execute_callback_(execute_callback),
     completion_callback_(completion_callback),
     server_timeout_(server_timeout),
+    persistent_worker_(persistent_worker),
     spin_thread_(spin_thread)
   {
     using namespace std::placeholders;  // NOLINT
@@ -126,6 +136,24 @@ public:
       executor_->add_callback_group(callback_group_, node_base_interface_);
       executor_thread_ = std::make_unique<nav2_util::NodeThread>(executor_);
     }
+    if (persistent_worker_) {
+      worker_thread_ = std::thread([this]() {workerLoop();});
+    }
+  }
+
+  /**
+   * @brief A destructor for SimpleActionServer, waiting for the goal being executed if any
+   */
+  ~SimpleActionServer()
+  {
+    if (worker_thread_.joinable()) {
+      {
+        std::lock_guard<std::mutex> lock(worker_mutex_);
+        worker_shutdown_ = true;
+      }
+      worker_cv_.notify_all();
+      worker_thread_.join();
+    }
   }
 
   /**
@@ -200,9 +228,19 @@ public:
 
       current_handle_ = handle;
 
-      // Return quickly to avoid blocking the executor, so spin up a new thread
+      // Return quickly to avoid blocking the executor, so wake up the worker thread
+      // or spin up a new thread
       debug_msg("Executing goal asynchronously.");
-      execution_future_ = std::async(std::launch::async, [this]() {work();});
+      if (persistent_worker_) {
+        worker_busy_ = true;
+        {
+          std::lock_guard<std::mutex> lock(worker_mutex_);
+          work_requested_ = true;
+        }
+        worker_cv_.notify_all();
+      } else {
+        execution_future_ = std::async(std::launch::async, [this]() {work();});
+      }
     }
   }
 
@@ -251,6 +289,38 @@ public:
     debug_msg("Worker thread done.");
   }
 
+  /**
+   * @brief Loop of the persistent worker thread, executing the goals once woken up for them
+   */
+  void workerLoop()
+  {
+    std::unique_lock<std::mutex> lock(worker_mutex_);
+    while (true) {
+      worker_cv_.wait(lock, [this]() {return work_requested_ || worker_shutdown_;});
+      if (worker_shutdown_) {
+        return;
+      }
+      work_requested_ = false;
+      lock.unlock();
+
+      // Goals received since work() returned were made pending, as the worker was still busy
+      bool pending = true;
+      while (pending) {
+        work();
+        std::lock_guard<std::recursive_mutex> update_lock(update_mutex_);
+        pending = !stop_execution_ && is_active(pending_handle_);
+        if (pending) {
+          accept_pending_goal();
+        } else {
+          worker_busy_ = false;
+        }
+      }
+
+      lock.lock();
+      worker_cv_.notify_all();
+    }
+  }
+
   /**
    * @brief Active action server
    */
@@ -274,6 +344,23 @@ public:
       stop_execution_ = true;
     }
 
+    if (persistent_worker_) {
+      if (is_running()) {
+        warn_msg(
+          "Requested to deactivate server but goal is still executing."
+          " Should check if action server is running before deactivating.");
+      }
+      std::unique_lock<std::mutex> lock(worker_mutex_);
+      if (!worker_cv_.wait_for(lock, server_timeout_, [this]() {return !worker_busy_;})) {
+        lock.unlock();
+        terminate_all();
+        completion_callback_();
+        throw std::runtime_error("Action callback is still running and missed deadline to stop");
+      }
+      debug_msg("Deactivation completed.");
+      return;
+    }
+
     if (!execution_future_.valid()) {
       return;
     }
@@ -304,6 +391,9 @@ public:
    */
   bool is_running()
   {
+    if (persistent_worker_) {
+      return worker_busy_;
+    }
     return execution_future_.valid() &&
            (execution_future_.wait_for(std::chrono::milliseconds(0)) ==
            std::future_status::timeout);
@@ -503,6 +593,16 @@ protected:
   bool preempt_requested_{false};
   std::chrono::milliseconds server_timeout_;
 
+  // The persistent worker thread, if any, woken up once a goal is to be executed or the
+  // server destroyed, and whether it is executing goals
+  bool persistent_worker_;
+  std::thread worker_thread_;
+  std::mutex worker_mutex_;
+  std::condition_variable worker_cv_;
+  bool work_requested_{false};
+  bool worker_shutdown_{false};
+  std::atomic<bool> worker_busy_{false};
+
   std::shared_ptr<rclcpp_action::ServerGoalHandle<ActionT>> current_handle_;
   std::shared_ptr<rclcpp_action::ServerGoalHandle<ActionT>> pending_handle_;
 
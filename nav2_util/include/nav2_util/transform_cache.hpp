@@ -0,0 +1,110 @@
+// Copyright (c) 2022 Samsung Research America
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef NAV2_UTIL__TRANSFORM_CACHE_HPP_
+#define NAV2_UTIL__TRANSFORM_CACHE_HPP_
+
+#include <chrono>
+#include <mutex>
+#include <string>
+#include <vector>
+
+#include "geometry_msgs/msg/pose_stamped.hpp"
+#include "geometry_msgs/msg/transform_stamped.hpp"
+#include "tf2/time.h"
+#include "tf2_ros/buffer.h"
+
+namespace nav2_util
+{
+
+/**
+ * @class nav2_util::TransformCache
+ * @brief Serves repeated lookups of the same frames at the same time, such as the robot
+ * pose queried many times in a control cycle, from the transforms looked up in the TF
+ * buffer during the last lifetime, instead of walking the TF tree again. Lookups of the
+ * latest transform, at time zero, are cached too, so the transforms served may be up to
+ * a lifetime older than the buffer's. It can be shared between threads.
+ */
+class TransformCache
+{
+public:
+  /**
+   * @brief A constructor for nav2_util::TransformCache
+   * @param tf_buffer TF buffer to look the transforms up in, outliving the cache
+   * @param lifetime Duration the transforms looked up are served for, 0 disabling the cache
+   * @param capacity Number of transforms kept, the oldest being dropped beyond it
+   */
+  TransformCache(
+    tf2_ros::Buffer & tf_buffer, const std::chrono::nanoseconds & lifetime,
+    size_t capacity = 16);
+
+  /**
+   * @brief Get the transform between two frames at a time, as tf2_ros::Buffer does
+   * @param target_frame Frame to transform into
+   * @param source_frame Frame to transform from
+   * @param time Time of the transform, tf2::TimePointZero for the latest
+   * @param timeout Duration to wait for the transform when not cached
+   * @return The transform
+   * @throw tf2::TransformException if the transform is not available
+   */
+  geometry_msgs::msg::TransformStamped lookupTransform(
+    const std::string & target_frame, const std::string & source_frame,
+    const tf2::TimePoint & time, const tf2::Duration & timeout);
+
+  /**
+   * @brief Transform a pose into a frame, as tf2_ros::Buffer does
+   * @param input_pose Pose to transform, at the time of its stamp
+   * @param target_frame Frame to transform into
+   * @param timeout Duration to wait for the transform when not cached
+   * @return The transformed pose
+   * @throw tf2::TransformException if the transform is not available
+   */
+  geometry_msgs::msg::PoseStamped transform(
+    const geometry_msgs::msg::PoseStamped & input_pose, const std::string & target_frame,
+    const tf2::Duration & timeout);
+
+  /**
+   * @brief Drop the cached transforms, e.g. at the start of a cycle
+   */
+  void clear();
+
+  /**
+   * @brief Get the TF buffer the transforms are looked up in
+   */
+  tf2_ros::Buffer & getBuffer()
+  {
+    return tf_buffer_;
+  }
+
+protected:
+  struct Entry
+  {
+    std::string target_frame;
+    std::string source_frame;
+    tf2::TimePoint time;
+    std::chrono::steady_clock::time_point lookup_time;
+    geometry_msgs::msg::TransformStamped transform;
+  };
+
+  tf2_ros::Buffer & tf_buffer_;
+  std::chrono::nanoseconds lifetime_;
+  size_t capacity_;
+  std::mutex mutex_;
+  // In order of lookup, the oldest first
+  std::vector<Entry> entries_;
+};
+
+}  // namespace nav2_util
+
+#endif  // NAV2_UTIL__TRANSFORM_CACHE_HPP_
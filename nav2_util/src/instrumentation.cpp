@@ -0,0 +1,233 @@
+// Copyright (c) 2022 Samsung Research America
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "nav2_util/instrumentation.hpp"
+
+#include <unistd.h>
+
+#include <algorithm>
+#include <fstream>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+#include "nav2_util/node_utils.hpp"
+
+using namespace std::chrono_literals;  // NOLINT
+
+namespace nav2_util
+{
+
+namespace
+{
+
+struct ProbeRegistry
+{
+  std::mutex mutex;
+  std::vector<Probe *> probes;
+  std::vector<MemoryAccount *> accounts;
+};
+
+// Never destroyed, as static probes and accounts may outlive any other static object
+ProbeRegistry & getRegistry()
+{
+  static ProbeRegistry * registry = new ProbeRegistry();
+  return *registry;
+}
+
+}  // namespace
+
+uint64_t & threadAllocations()
+{
+  static thread_local uint64_t allocations = 0;
+  return allocations;
+}
+
+Probe::Probe(const std::string & name)
+: name_(name)
+{
+  ProbeRegistry & registry = getRegistry();
+  std::lock_guard<std::mutex> lock(registry.mutex);
+  registry.probes.push_back(this);
+}
+
+Probe::~Probe()
+{
+  ProbeRegistry & registry = getRegistry();
+  std::lock_guard<std::mutex> lock(registry.mutex);
+  registry.probes.erase(
+    std::remove(registry.probes.begin(), registry.probes.end(), this), registry.probes.end());
+}
+
+unsigned int Probe::getThreadSlot()
+{
+  static std::atomic<unsigned int> threads{0};
+  static thread_local unsigned int slot =
+    threads.fetch_add(1, std::memory_order_relaxed) % SLOTS;
+  return slot;
+}
+
+nav2_msgs::msg::ProbeStatistics Probe::getStatistics() const
+{
+  nav2_msgs::msg::ProbeStatistics statistics;
+  statistics.name = name_;
+  uint64_t time = 0, max_time = 0;
+  for (const Slot & slot : slots_) {
+    statistics.calls += slot.calls.load(std::memory_order_relaxed);
+    statistics.allocations += slot.allocations.load(std::memory_order_relaxed);
+    time += slot.time.load(std::memory_order_relaxed);
+    max_time = std::max(max_time, slot.max_time.load(std::memory_order_relaxed));
+  }
+  statistics.total_time = time * 1e-9;
+  statistics.max_time = max_time * 1e-9;
+  return statistics;
+}
+
+std::vector<nav2_msgs::msg::ProbeStatistics> getProbeStatistics(const std::string & prefix)
+{
+  std::vector<nav2_msgs::msg::ProbeStatistics> statistics;
+  {
+    ProbeRegistry & registry = getRegistry();
+    std::lock_guard<std::mutex> lock(registry.mutex);
+    for (const Probe * probe : registry.probes) {
+      if (probe->getName().compare(0, prefix.size(), prefix) == 0) {
+        statistics.push_back(probe->getStatistics());
+      }
+    }
+  }
+  std::sort(
+    statistics.begin(), statistics.end(),
+    [](const nav2_msgs::msg::ProbeStatistics & a, const nav2_msgs::msg::ProbeStatistics & b) {
+      return a.name < b.name;
+    });
+  return statistics;
+}
+
+MemoryAccount::MemoryAccount(const std::string & name)
+: name_(name)
+{
+  ProbeRegistry & registry = getRegistry();
+  std::lock_guard<std::mutex> lock(registry.mutex);
+  registry.accounts.push_back(this);
+}
+
+MemoryAccount::~MemoryAccount()
+{
+  ProbeRegistry & registry = getRegistry();
+  std::lock_guard<std::mutex> lock(registry.mutex);
+  registry.accounts.erase(
+    std::remove(registry.accounts.begin(), registry.accounts.end(), this),
+    registry.accounts.end());
+}
+
+nav2_msgs::msg::MemoryStatistics MemoryAccount::getStatistics() const
+{
+  nav2_msgs::msg::MemoryStatistics statistics;
+  statistics.name = name_;
+  statistics.bytes = bytes_.load(std::memory_order_relaxed);
+  statistics.peak_bytes = peak_bytes_.load(std::memory_order_relaxed);
+  return statistics;
+}
+
+std::vector<nav2_msgs::msg::MemoryStatistics> getMemoryStatistics(const std::string & prefix)
+{
+  std::vector<nav2_msgs::msg::MemoryStatistics> statistics;
+  {
+    ProbeRegistry & registry = getRegistry();
+    std::lock_guard<std::mutex> lock(registry.mutex);
+    for (const MemoryAccount * account : registry.accounts) {
+      if (account->getName().compare(0, prefix.size(), prefix) == 0) {
+        statistics.push_back(account->getStatistics());
+      }
+    }
+  }
+  std::sort(
+    statistics.begin(), statistics.end(),
+    [](const nav2_msgs::msg::MemoryStatistics & a, const nav2_msgs::msg::MemoryStatistics & b) {
+      return a.name < b.name;
+    });
+  return statistics;
+}
+
+uint64_t getResidentMemory()
+{
+  // The second field of statm is the number of resident pages
+  std::ifstream statm("/proc/self/statm");
+  uint64_t size, resident;
+  if (!(statm >> size >> resident)) {
+    return 0;
+  }
+  return resident * static_cast<uint64_t>(sysconf(_SC_PAGESIZE));
+}
+
+InstrumentationPublisher::InstrumentationPublisher(
+  const rclcpp_lifecycle::LifecycleNode::WeakPtr & parent,
+  const std::vector<std::string> & prefixes,
+  const std::vector<std::string> & memory_prefixes)
+: node_(parent), prefixes_(prefixes),
+  memory_prefixes_(memory_prefixes.empty() ? prefixes : memory_prefixes)
+{
+  auto node = node_.lock();
+  declare_parameter_if_not_declared(
+    node, "instrumentation_period", rclcpp::ParameterValue(0.0));
+  node->get_parameter("instrumentation_period", period_);
+  if (period_ > 0.0) {
+    publisher_ = node->create_publisher<nav2_msgs::msg::InstrumentationStatistics>(
+      "~/instrumentation", 1);
+  }
+}
+
+void InstrumentationPublisher::activate()
+{
+  if (!publisher_) {
+    return;
+  }
+  auto node = node_.lock();
+  publisher_->on_activate();
+  timer_ = node->create_wall_timer(
+    std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::duration<double>(period_)),
+    std::bind(&InstrumentationPublisher::publish, this));
+}
+
+void InstrumentationPublisher::deactivate()
+{
+  if (!publisher_) {
+    return;
+  }
+  timer_.reset();
+  publisher_->on_deactivate();
+}
+
+void InstrumentationPublisher::publish()
+{
+  auto node = node_.lock();
+  if (!node) {
+    return;
+  }
+  auto msg = std::make_unique<nav2_msgs::msg::InstrumentationStatistics>();
+  msg->header.stamp = node->now();
+  for (const std::string & prefix : prefixes_) {
+    std::vector<nav2_msgs::msg::ProbeStatistics> probes = getProbeStatistics(prefix);
+    msg->probes.insert(msg->probes.end(), probes.begin(), probes.end());
+  }
+  for (const std::string & prefix : memory_prefixes_) {
+    std::vector<nav2_msgs::msg::MemoryStatistics> memory = getMemoryStatistics(prefix);
+    msg->memory.insert(msg->memory.end(), memory.begin(), memory.end());
+  }
+  msg->resident_bytes = getResidentMemory();
+  publisher_->publish(std::move(msg));
+}
+
+}  // namespace nav2_util
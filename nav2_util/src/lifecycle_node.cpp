@@ -14,6 +14,7 @@
 
 #include "nav2_util/lifecycle_node.hpp"
 
+#include <chrono>
 #include <memory>
 #include <string>
 #include <vector>
@@ -81,6 +82,17 @@ LifecycleNode::~LifecycleNode()
 
 void LifecycleNode::createBond()
 {
+  // The manager requested a shared heartbeat if it is on this host
+  heartbeat_ = SharedHeartbeat::accept(this->get_fully_qualified_name());
+  if (heartbeat_) {
+    RCLCPP_INFO(
+      get_logger(), "Creating shared heartbeat (%s) to lifecycle manager.", this->get_name());
+    heartbeat_->beat();
+    heartbeat_timer_ = this->create_wall_timer(
+      std::chrono::milliseconds(100), [this]() {heartbeat_->beat();});
+    return;
+  }
+
   RCLCPP_INFO(get_logger(), "Creating bond (%s) to lifecycle manager.", this->get_name());
 
   bond_ = std::make_unique<bond::Bond>(
@@ -100,6 +112,11 @@ void LifecycleNode::destroyBond()
   if (bond_) {
     bond_.reset();
   }
+  if (heartbeat_timer_) {
+    heartbeat_timer_->cancel();
+    heartbeat_timer_.reset();
+  }
+  heartbeat_.reset();
 }
 
 void LifecycleNode::print_lifecycle_node_notification()
@@ -0,0 +1,205 @@
+// Copyright (c) 2022 Samsung Research America
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "nav2_util/navigator_client.hpp"
+
+#include <algorithm>
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace nav2_util
+{
+
+struct NavigatorClient::PathsRequest
+{
+  std::promise<ComputePaths::Response::SharedPtr> promise;
+  std::mutex mutex;
+  bool done{false};
+};
+
+NavigatorClient::NavigatorClient(const rclcpp::Node::SharedPtr & node, bool spin_thread)
+: node_(node)
+{
+  nav_to_pose_client_ = rclcpp_action::create_client<NavigateToPose>(node_, "navigate_to_pose");
+  nav_through_poses_client_ =
+    rclcpp_action::create_client<NavigateThroughPoses>(node_, "navigate_through_poses");
+  follow_waypoints_client_ =
+    rclcpp_action::create_client<FollowWaypoints>(node_, "follow_waypoints");
+  follow_path_client_ = rclcpp_action::create_client<FollowPath>(node_, "follow_path");
+  compute_path_to_pose_client_ =
+    rclcpp_action::create_client<ComputePathToPose>(node_, "compute_path_to_pose");
+  compute_path_through_poses_client_ =
+    rclcpp_action::create_client<ComputePathThroughPoses>(node_, "compute_path_through_poses");
+  compute_paths_client_ = node_->create_client<ComputePaths>("compute_paths");
+
+  if (spin_thread) {
+    node_thread_ = std::make_unique<nav2_util::NodeThread>(node_);
+  }
+}
+
+bool NavigatorClient::waitForServers(std::chrono::nanoseconds timeout)
+{
+  const std::vector<rclcpp_action::ClientBase *> clients = {
+    nav_to_pose_client_.get(), nav_through_poses_client_.get(),
+    follow_waypoints_client_.get(), follow_path_client_.get(),
+    compute_path_to_pose_client_.get(), compute_path_through_poses_client_.get()};
+  for (auto client : clients) {
+    if (!client->wait_for_action_server(timeout)) {
+      RCLCPP_WARN(node_->get_logger(), "Navigator client: action server not available");
+      return false;
+    }
+  }
+  if (!compute_paths_client_->wait_for_service(timeout)) {
+    RCLCPP_WARN(node_->get_logger(), "Navigator client: compute_paths service not available");
+    return false;
+  }
+  return true;
+}
+
+NavigatorClient::ResultFuture<NavigatorClient::NavigateToPose> NavigatorClient::goToPose(
+  const geometry_msgs::msg::PoseStamped & pose,
+  const std::string & behavior_tree,
+  FeedbackCallback<NavigateToPose> feedback_callback)
+{
+  NavigateToPose::Goal goal;
+  goal.pose = pose;
+  goal.behavior_tree = behavior_tree;
+  return sendGoal<NavigateToPose>(nav_to_pose_client_, goal, feedback_callback);
+}
+
+NavigatorClient::ResultFuture<NavigatorClient::NavigateThroughPoses>
+NavigatorClient::goThroughPoses(
+  const std::vector<geometry_msgs::msg::PoseStamped> & poses,
+  const std::string & behavior_tree,
+  FeedbackCallback<NavigateThroughPoses> feedback_callback)
+{
+  NavigateThroughPoses::Goal goal;
+  goal.poses = poses;
+  goal.behavior_tree = behavior_tree;
+  return sendGoal<NavigateThroughPoses>(nav_through_poses_client_, goal, feedback_callback);
+}
+
+NavigatorClient::ResultFuture<NavigatorClient::FollowWaypoints> NavigatorClient::followWaypoints(
+  const std::vector<geometry_msgs::msg::PoseStamped> & poses,
+  FeedbackCallback<FollowWaypoints> feedback_callback)
+{
+  FollowWaypoints::Goal goal;
+  goal.poses = poses;
+  return sendGoal<FollowWaypoints>(follow_waypoints_client_, goal, feedback_callback);
+}
+
+NavigatorClient::ResultFuture<NavigatorClient::FollowPath> NavigatorClient::followPath(
+  const nav_msgs::msg::Path & path,
+  const std::string & controller_id,
+  const std::string & goal_checker_id,
+  FeedbackCallback<FollowPath> feedback_callback)
+{
+  FollowPath::Goal goal;
+  goal.path = path;
+  goal.controller_id = controller_id;
+  goal.goal_checker_id = goal_checker_id;
+  return sendGoal<FollowPath>(follow_path_client_, goal, feedback_callback);
+}
+
+NavigatorClient::ResultFuture<NavigatorClient::ComputePathToPose> NavigatorClient::getPath(
+  const geometry_msgs::msg::PoseStamped & start,
+  const geometry_msgs::msg::PoseStamped & goal,
+  const std::string & planner_id,
+  bool use_start)
+{
+  ComputePathToPose::Goal path_goal;
+  path_goal.start = start;
+  path_goal.goal = goal;
+  path_goal.planner_id = planner_id;
+  path_goal.use_start = use_start;
+  return sendGoal<ComputePathToPose>(compute_path_to_pose_client_, path_goal, nullptr);
+}
+
+NavigatorClient::ResultFuture<NavigatorClient::ComputePathThroughPoses>
+NavigatorClient::getPathThroughPoses(
+  const geometry_msgs::msg::PoseStamped & start,
+  const std::vector<geometry_msgs::msg::PoseStamped> & goals,
+  const std::string & planner_id,
+  bool use_start)
+{
+  ComputePathThroughPoses::Goal path_goal;
+  path_goal.start = start;
+  path_goal.goals = goals;
+  path_goal.planner_id = planner_id;
+  path_goal.use_start = use_start;
+  return sendGoal<ComputePathThroughPoses>(
+    compute_path_through_poses_client_, path_goal, nullptr);
+}
+
+NavigatorClient::PathsFuture NavigatorClient::getPaths(
+  const std::vector<geometry_msgs::msg::PoseStamped> & goals,
+  const std::vector<geometry_msgs::msg::PoseStamped> & starts,
+  const std::string & planner_id)
+{
+  auto request = std::make_shared<ComputePaths::Request>();
+  request->goals = goals;
+  request->starts = starts;
+  request->planner_id = planner_id;
+
+  auto paths_request = std::make_shared<PathsRequest>();
+  PathsFuture future = paths_request->promise.get_future().share();
+  {
+    std::lock_guard<std::mutex> lock(paths_requests_mutex_);
+    paths_requests_.erase(
+      std::remove_if(
+        paths_requests_.begin(), paths_requests_.end(),
+        [](const std::weak_ptr<PathsRequest> & pending) {return pending.expired();}),
+      paths_requests_.end());
+    paths_requests_.push_back(paths_request);
+  }
+
+  // The request is kept by the callback of its response, unless canceled first
+  compute_paths_client_->async_send_request(
+    request, [paths_request](rclcpp::Client<ComputePaths>::SharedFuture response) {
+      std::lock_guard<std::mutex> lock(paths_request->mutex);
+      if (!paths_request->done) {
+        paths_request->done = true;
+        paths_request->promise.set_value(response.get());
+      }
+    });
+  return future;
+}
+
+void NavigatorClient::cancelAll()
+{
+  {
+    std::lock_guard<std::mutex> lock(paths_requests_mutex_);
+    for (const auto & pending : paths_requests_) {
+      if (auto paths_request = pending.lock()) {
+        std::lock_guard<std::mutex> request_lock(paths_request->mutex);
+        if (!paths_request->done) {
+          paths_request->done = true;
+          paths_request->promise.set_value(nullptr);
+        }
+      }
+    }
+    paths_requests_.clear();
+  }
+  compute_paths_client_->prune_pending_requests();
+
+  nav_to_pose_client_->async_cancel_all_goals();
+  nav_through_poses_client_->async_cancel_all_goals();
+  follow_waypoints_client_->async_cancel_all_goals();
+  follow_path_client_->async_cancel_all_goals();
+  compute_path_to_pose_client_->async_cancel_all_goals();
+  compute_path_through_poses_client_->async_cancel_all_goals();
+}
+
+}  // namespace nav2_util
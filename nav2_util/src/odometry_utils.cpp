@@ -13,7 +13,10 @@
 // See the License for the specific language governing permissions and
 // limitations under the License.
 
+#include <algorithm>
+#include <memory>
 #include <string>
+#include <vector>
 
 #include "nav2_util/odometry_utils.hpp"
 
@@ -23,99 +26,145 @@ using namespace std::chrono_literals;  // NOLINT
 namespace nav2_util
 {
 
+namespace
+{
+
+// Enough for 0.3 s of odometry at 100 Hz without growing
+constexpr size_t INITIAL_HISTORY_CAPACITY = 64;
+
+}  // namespace
+
 OdomSmoother::OdomSmoother(
   const rclcpp::Node::WeakPtr & parent,
   double filter_duration,
   const std::string & odom_topic)
-: odom_history_duration_(rclcpp::Duration::from_seconds(filter_duration))
+: odom_history_duration_(rclcpp::Duration::from_seconds(filter_duration)),
+  odom_history_(INITIAL_HISTORY_CAPACITY),
+  frame_id_(std::make_shared<const std::string>())
 {
   auto node = parent.lock();
   odom_sub_ = node->create_subscription<nav_msgs::msg::Odometry>(
     odom_topic,
     rclcpp::SystemDefaultsQoS(),
     std::bind(&OdomSmoother::odomCallback, this, std::placeholders::_1));
-
-  odom_cumulate_.twist.twist.linear.x = 0;
-  odom_cumulate_.twist.twist.linear.y = 0;
-  odom_cumulate_.twist.twist.linear.z = 0;
-  odom_cumulate_.twist.twist.angular.x = 0;
-  odom_cumulate_.twist.twist.angular.y = 0;
-  odom_cumulate_.twist.twist.angular.z = 0;
 }
 
 OdomSmoother::OdomSmoother(
   const nav2_util::LifecycleNode::WeakPtr & parent,
   double filter_duration,
   const std::string & odom_topic)
-: odom_history_duration_(rclcpp::Duration::from_seconds(filter_duration))
+: odom_history_duration_(rclcpp::Duration::from_seconds(filter_duration)),
+  odom_history_(INITIAL_HISTORY_CAPACITY),
+  frame_id_(std::make_shared<const std::string>())
 {
   auto node = parent.lock();
   odom_sub_ = node->create_subscription<nav_msgs::msg::Odometry>(
     odom_topic,
     rclcpp::SystemDefaultsQoS(),
     std::bind(&OdomSmoother::odomCallback, this, std::placeholders::_1));
+}
 
-  odom_cumulate_.twist.twist.linear.x = 0;
-  odom_cumulate_.twist.twist.linear.y = 0;
-  odom_cumulate_.twist.twist.linear.z = 0;
-  odom_cumulate_.twist.twist.angular.x = 0;
-  odom_cumulate_.twist.twist.angular.y = 0;
-  odom_cumulate_.twist.twist.angular.z = 0;
+geometry_msgs::msg::Twist OdomSmoother::getTwist() const
+{
+  geometry_msgs::msg::Twist twist;
+  readState(twist, nullptr);
+  return twist;
+}
+
+geometry_msgs::msg::TwistStamped OdomSmoother::getTwistStamped() const
+{
+  geometry_msgs::msg::TwistStamped twist;
+  readState(twist.twist, &twist.header.stamp);
+  twist.header.frame_id = *std::atomic_load(&frame_id_);
+  return twist;
 }
 
 void OdomSmoother::odomCallback(const nav_msgs::msg::Odometry::SharedPtr msg)
 {
   std::lock_guard<std::mutex> lock(odom_mutex_);
 
-  // update cumulated odom only if history is not empty
-  if (!odom_history_.empty()) {
-    // to store current time
-    auto current_time = rclcpp::Time(msg->header.stamp);
-
-    // to store time of the first odom in history
-    auto front_time = rclcpp::Time(odom_history_.front().header.stamp);
-
-    // update cumulated odom when duration has exceeded and pop earliest msg
-    while (current_time - front_time > odom_history_duration_) {
-      const auto & odom = odom_history_.front();
-      odom_cumulate_.twist.twist.linear.x -= odom.twist.twist.linear.x;
-      odom_cumulate_.twist.twist.linear.y -= odom.twist.twist.linear.y;
-      odom_cumulate_.twist.twist.linear.z -= odom.twist.twist.linear.z;
-      odom_cumulate_.twist.twist.angular.x -= odom.twist.twist.angular.x;
-      odom_cumulate_.twist.twist.angular.y -= odom.twist.twist.angular.y;
-      odom_cumulate_.twist.twist.angular.z -= odom.twist.twist.angular.z;
-      odom_history_.pop_front();
-
-      if (odom_history_.empty()) {
-        break;
-      }
-
-      // update with the timestamp of earliest odom message in history
-      front_time = rclcpp::Time(odom_history_.front().header.stamp);
+  // to store current time
+  const int64_t current_time = rclcpp::Time(msg->header.stamp).nanoseconds();
+
+  // update cumulated odom when duration has exceeded and pop earliest msg
+  while (history_size_ > 0 &&
+    current_time - odom_history_[history_front_].stamp > odom_history_duration_.nanoseconds())
+  {
+    const Velocities & velocities = odom_history_[history_front_].velocities;
+    for (size_t i = 0; i != odom_cumulate_.size(); ++i) {
+      odom_cumulate_[i] -= velocities[i];
     }
+    history_front_ = (history_front_ + 1) % odom_history_.size();
+    history_size_--;
   }
 
-  odom_history_.push_back(*msg);
+  if (history_size_ == odom_history_.size()) {
+    // Unroll the ring buffer into a larger one, which is then kept
+    std::rotate(
+      odom_history_.begin(), odom_history_.begin() + history_front_, odom_history_.end());
+    odom_history_.resize(2 * odom_history_.size());
+    history_front_ = 0;
+  }
+
+  Sample & sample = odom_history_[(history_front_ + history_size_) % odom_history_.size()];
+  sample.stamp = current_time;
+  sample.velocities = {
+    msg->twist.twist.linear.x, msg->twist.twist.linear.y, msg->twist.twist.linear.z,
+    msg->twist.twist.angular.x, msg->twist.twist.angular.y, msg->twist.twist.angular.z};
+  history_size_++;
+
+  if (*std::atomic_load(&frame_id_) != msg->header.frame_id) {
+    std::atomic_store(&frame_id_, std::make_shared<const std::string>(msg->header.frame_id));
+  }
   updateState();
 }
 
 void OdomSmoother::updateState()
 {
-  const auto & odom = odom_history_.back();
-  odom_cumulate_.twist.twist.linear.x += odom.twist.twist.linear.x;
-  odom_cumulate_.twist.twist.linear.y += odom.twist.twist.linear.y;
-  odom_cumulate_.twist.twist.linear.z += odom.twist.twist.linear.z;
-  odom_cumulate_.twist.twist.angular.x += odom.twist.twist.angular.x;
-  odom_cumulate_.twist.twist.angular.y += odom.twist.twist.angular.y;
-  odom_cumulate_.twist.twist.angular.z += odom.twist.twist.angular.z;
-
-  vel_smooth_.header = odom.header;
-  vel_smooth_.twist.linear.x = odom_cumulate_.twist.twist.linear.x / odom_history_.size();
-  vel_smooth_.twist.linear.y = odom_cumulate_.twist.twist.linear.y / odom_history_.size();
-  vel_smooth_.twist.linear.z = odom_cumulate_.twist.twist.linear.z / odom_history_.size();
-  vel_smooth_.twist.angular.x = odom_cumulate_.twist.twist.angular.x / odom_history_.size();
-  vel_smooth_.twist.angular.y = odom_cumulate_.twist.twist.angular.y / odom_history_.size();
-  vel_smooth_.twist.angular.z = odom_cumulate_.twist.twist.angular.z / odom_history_.size();
+  const Sample & sample =
+    odom_history_[(history_front_ + history_size_ - 1) % odom_history_.size()];
+  for (size_t i = 0; i != odom_cumulate_.size(); ++i) {
+    odom_cumulate_[i] += sample.velocities[i];
+  }
+
+  const uint64_t sequence = sequence_.load(std::memory_order_relaxed);
+  sequence_.store(sequence + 1, std::memory_order_relaxed);
+  std::atomic_thread_fence(std::memory_order_release);
+  for (size_t i = 0; i != odom_cumulate_.size(); ++i) {
+    vel_smooth_[i].store(odom_cumulate_[i] / history_size_, std::memory_order_relaxed);
+  }
+  const rclcpp::Time stamp(sample.stamp);
+  const builtin_interfaces::msg::Time stamp_msg = stamp;
+  stamp_sec_.store(stamp_msg.sec, std::memory_order_relaxed);
+  stamp_nanosec_.store(stamp_msg.nanosec, std::memory_order_relaxed);
+  sequence_.store(sequence + 2, std::memory_order_release);
+}
+
+void OdomSmoother::readState(
+  geometry_msgs::msg::Twist & twist, builtin_interfaces::msg::Time * stamp) const
+{
+  Velocities velocities;
+  builtin_interfaces::msg::Time stamp_msg;
+  uint64_t sequence;
+  do {
+    sequence = sequence_.load(std::memory_order_acquire);
+    for (size_t i = 0; i != velocities.size(); ++i) {
+      velocities[i] = vel_smooth_[i].load(std::memory_order_relaxed);
+    }
+    stamp_msg.sec = stamp_sec_.load(std::memory_order_relaxed);
+    stamp_msg.nanosec = stamp_nanosec_.load(std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_acquire);
+  } while ((sequence & 1) || sequence != sequence_.load(std::memory_order_relaxed));
+
+  twist.linear.x = velocities[0];
+  twist.linear.y = velocities[1];
+  twist.linear.z = velocities[2];
+  twist.angular.x = velocities[3];
+  twist.angular.y = velocities[4];
+  twist.angular.z = velocities[5];
+  if (stamp) {
+    *stamp = stamp_msg;
+  }
 }
 
 }  // namespace nav2_util
@@ -23,30 +23,35 @@
 namespace nav2_util
 {
 
-bool getCurrentPose(
+namespace
+{
+
+template<typename TransformerT>
+bool getCurrentPoseWith(
   geometry_msgs::msg::PoseStamped & global_pose,
-  tf2_ros::Buffer & tf_buffer, const std::string global_frame,
-  const std::string robot_frame, const double transform_timeout,
-  const rclcpp::Time stamp)
+  TransformerT & transformer, const std::string & global_frame,
+  const std::string & robot_frame, const double transform_timeout,
+  const rclcpp::Time & stamp)
 {
   tf2::toMsg(tf2::Transform::getIdentity(), global_pose.pose);
   global_pose.header.frame_id = robot_frame;
   global_pose.header.stamp = stamp;
 
   return transformPoseInTargetFrame(
-    global_pose, global_pose, tf_buffer, global_frame, transform_timeout);
+    global_pose, global_pose, transformer, global_frame, transform_timeout);
 }
 
-bool transformPoseInTargetFrame(
+template<typename TransformerT>
+bool transformPoseInTargetFrameWith(
   const geometry_msgs::msg::PoseStamped & input_pose,
   geometry_msgs::msg::PoseStamped & transformed_pose,
-  tf2_ros::Buffer & tf_buffer, const std::string target_frame,
+  TransformerT & transformer, const std::string & target_frame,
   const double transform_timeout)
 {
   static rclcpp::Logger logger = rclcpp::get_logger("transformPoseInTargetFrame");
 
   try {
-    transformed_pose = tf_buffer.transform(
+    transformed_pose = transformer.transform(
       input_pose, target_frame,
       tf2::durationFromSec(transform_timeout));
     return true;
@@ -75,4 +80,46 @@ bool transformPoseInTargetFrame(
   return false;
 }
 
+}  // namespace
+
+bool getCurrentPose(
+  geometry_msgs::msg::PoseStamped & global_pose,
+  tf2_ros::Buffer & tf_buffer, const std::string global_frame,
+  const std::string robot_frame, const double transform_timeout,
+  const rclcpp::Time stamp)
+{
+  return getCurrentPoseWith(
+    global_pose, tf_buffer, global_frame, robot_frame, transform_timeout, stamp);
+}
+
+bool getCurrentPose(
+  geometry_msgs::msg::PoseStamped & global_pose,
+  TransformCache & tf_cache, const std::string global_frame,
+  const std::string robot_frame, const double transform_timeout,
+  const rclcpp::Time stamp)
+{
+  return getCurrentPoseWith(
+    global_pose, tf_cache, global_frame, robot_frame, transform_timeout, stamp);
+}
+
+bool transformPoseInTargetFrame(
+  const geometry_msgs::msg::PoseStamped & input_pose,
+  geometry_msgs::msg::PoseStamped & transformed_pose,
+  tf2_ros::Buffer & tf_buffer, const std::string target_frame,
+  const double transform_timeout)
+{
+  return transformPoseInTargetFrameWith(
+    input_pose, transformed_pose, tf_buffer, target_frame, transform_timeout);
+}
+
+bool transformPoseInTargetFrame(
+  const geometry_msgs::msg::PoseStamped & input_pose,
+  geometry_msgs::msg::PoseStamped & transformed_pose,
+  TransformCache & tf_cache, const std::string target_frame,
+  const double transform_timeout)
+{
+  return transformPoseInTargetFrameWith(
+    input_pose, transformed_pose, tf_cache, target_frame, transform_timeout);
+}
+
 }  // end namespace nav2_util
@@ -0,0 +1,119 @@
+// Copyright (c) 2022 Samsung Research America
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+
+#include "nav2_util/shared_heartbeat.hpp"
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <cstdlib>
+#include <memory>
+#include <string>
+
+namespace nav2_util
+{
+
+static int64_t steadyNow()
+{
+  return std::chrono::duration_cast<std::chrono::nanoseconds>(
+    std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+std::unique_ptr<SharedHeartbeat> SharedHeartbeat::request(const std::string & node_name)
+{
+  return map(node_name, true);
+}
+
+std::unique_ptr<SharedHeartbeat> SharedHeartbeat::accept(const std::string & node_name)
+{
+  return map(node_name, false);
+}
+
+std::string SharedHeartbeat::getSegmentName(const std::string & node_name)
+{
+  // Segment names have a single slash, and ROS names don't have dots
+  const char * domain_id = std::getenv("ROS_DOMAIN_ID");
+  std::string name = node_name;
+  std::replace(name.begin(), name.end(), '/', '.');
+  return "/nav2_heartbeat." + std::string(domain_id ? domain_id : "0") + name;
+}
+
+std::unique_ptr<SharedHeartbeat> SharedHeartbeat::map(const std::string & node_name, bool create)
+{
+  const std::string segment_name = getSegmentName(node_name);
+  int fd;
+  if (create) {
+    // Created anew, so that beats of a previous activation aren't taken for the node's
+    shm_unlink(segment_name.c_str());
+    fd = shm_open(segment_name.c_str(), O_RDWR | O_CREAT | O_EXCL, 0600);
+    if (fd >= 0 && ftruncate(fd, sizeof(Segment)) != 0) {
+      close(fd);
+      shm_unlink(segment_name.c_str());
+      return nullptr;
+    }
+  } else {
+    fd = shm_open(segment_name.c_str(), O_RDWR, 0600);
+  }
+  if (fd < 0) {
+    return nullptr;
+  }
+
+  void * address = mmap(nullptr, sizeof(Segment), PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+  close(fd);
+  if (address == MAP_FAILED) {
+    if (create) {
+      shm_unlink(segment_name.c_str());
+    }
+    return nullptr;
+  }
+
+  // Segments are created zero filled, which is a heartbeat that never beat
+  auto segment = static_cast<Segment *>(address);
+  return std::unique_ptr<SharedHeartbeat>(new SharedHeartbeat(segment_name, segment, create));
+}
+
+SharedHeartbeat::SharedHeartbeat(
+  const std::string & segment_name, Segment * segment, bool owner)
+: segment_name_(segment_name), segment_(segment), owner_(owner)
+{
+}
+
+SharedHeartbeat::~SharedHeartbeat()
+{
+  munmap(segment_, sizeof(Segment));
+  if (owner_) {
+    shm_unlink(segment_name_.c_str());
+  }
+}
+
+void SharedHeartbeat::beat()
+{
+  segment_->last_beat_ns.store(steadyNow(), std::memory_order_relaxed);
+}
+
+bool SharedHeartbeat::hasBeaten() const
+{
+  return segment_->last_beat_ns.load(std::memory_order_relaxed) != 0;
+}
+
+bool SharedHeartbeat::isBroken(const std::chrono::nanoseconds & timeout) const
+{
+  const int64_t last_beat_ns = segment_->last_beat_ns.load(std::memory_order_relaxed);
+  return last_beat_ns == 0 || steadyNow() - last_beat_ns > timeout.count();
+}
+
+}  // namespace nav2_util
@@ -0,0 +1,94 @@
+// Copyright (c) 2022 Samsung Research America
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "nav2_util/transform_cache.hpp"
+
+#include <algorithm>
+#include <string>
+#include <vector>
+
+#include "tf2_geometry_msgs/tf2_geometry_msgs.hpp"
+
+namespace nav2_util
+{
+
+TransformCache::TransformCache(
+  tf2_ros::Buffer & tf_buffer, const std::chrono::nanoseconds & lifetime,
+  size_t capacity)
+: tf_buffer_(tf_buffer), lifetime_(lifetime), capacity_(std::max<size_t>(capacity, 1))
+{
+  entries_.reserve(capacity_);
+}
+
+geometry_msgs::msg::TransformStamped TransformCache::lookupTransform(
+  const std::string & target_frame, const std::string & source_frame,
+  const tf2::TimePoint & time, const tf2::Duration & timeout)
+{
+  if (lifetime_.count() <= 0) {
+    return tf_buffer_.lookupTransform(target_frame, source_frame, time, timeout);
+  }
+
+  const auto now = std::chrono::steady_clock::now();
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    // Expired entries are mostly the oldest ones
+    auto expired = std::find_if(
+      entries_.begin(), entries_.end(),
+      [&](const Entry & entry) {return now - entry.lookup_time < lifetime_;});
+    entries_.erase(entries_.begin(), expired);
+
+    for (const auto & entry : entries_) {
+      if (entry.time == time && now - entry.lookup_time < lifetime_ &&
+        entry.source_frame == source_frame && entry.target_frame == target_frame)
+      {
+        return entry.transform;
+      }
+    }
+  }
+
+  // Looked up without the lock held, as it may wait for the transform
+  Entry entry;
+  entry.transform = tf_buffer_.lookupTransform(target_frame, source_frame, time, timeout);
+  entry.target_frame = target_frame;
+  entry.source_frame = source_frame;
+  entry.time = time;
+  entry.lookup_time = now;
+
+  std::lock_guard<std::mutex> lock(mutex_);
+  if (entries_.size() >= capacity_) {
+    entries_.erase(entries_.begin());
+  }
+  entries_.push_back(entry);
+  return entry.transform;
+}
+
+geometry_msgs::msg::PoseStamped TransformCache::transform(
+  const geometry_msgs::msg::PoseStamped & input_pose, const std::string & target_frame,
+  const tf2::Duration & timeout)
+{
+  geometry_msgs::msg::PoseStamped transformed_pose;
+  tf2::doTransform(
+    input_pose, transformed_pose,
+    lookupTransform(
+      target_frame, tf2::getFrameId(input_pose), tf2::getTimestamp(input_pose), timeout));
+  return transformed_pose;
+}
+
+void TransformCache::clear()
+{
+  std::lock_guard<std::mutex> lock(mutex_);
+  entries_.clear();
+}
+
+}  // namespace nav2_util
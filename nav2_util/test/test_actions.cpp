@@ -22,6 +22,11 @@
 #include "test_msgs/action/fibonacci.hpp"
 #include "std_msgs/msg/empty.hpp"
 
+// Built again as test_actions_persistent_worker, executing the goals on a persistent thread
+#ifndef PERSISTENT_WORKER
+#define PERSISTENT_WORKER false
+#endif
+
 using Fibonacci = test_msgs::action::Fibonacci;
 using GoalHandle = rclcpp_action::ServerGoalHandle<Fibonacci>;
 
@@ -45,7 +50,12 @@ public:
     action_server_ = std::make_shared<nav2_util::SimpleActionServer<Fibonacci>>(
       shared_from_this(),
       "fibonacci",
-      std::bind(&FibonacciServerNode::execute, this));
+      std::bind(&FibonacciServerNode::execute, this),
+      nullptr,
+      std::chrono::milliseconds(500),
+      false,
+      rcl_action_server_get_default_options(),
+      PERSISTENT_WORKER);
 
     deactivate_subs_ = create_subscription<std_msgs::msg::Empty>(
       "deactivate_server",
@@ -21,6 +21,7 @@
 
 using nav2_util::geometry_utils::euclidean_distance;
 using nav2_util::geometry_utils::calculate_path_length;
+using nav2_util::geometry_utils::calculate_cumulative_path_lengths;
 
 TEST(GeometryUtils, euclidean_distance_point_3d)
 {
@@ -128,3 +129,23 @@ TEST(GeometryUtils, calculate_path_length)
     calculate_path_length(circle_path),
     2 * pi * polar_distance, 1e-1);
 }
+
+TEST(GeometryUtils, calculate_cumulative_path_lengths)
+{
+  EXPECT_TRUE(calculate_cumulative_path_lengths(nav_msgs::msg::Path()).empty());
+
+  nav_msgs::msg::Path path;
+  for (size_t i = 0; i < 20; ++i) {
+    geometry_msgs::msg::PoseStamped pose_stamped_msg;
+    pose_stamped_msg.pose.position.x = 0.1 * i * i;
+    pose_stamped_msg.pose.position.y = std::sin(0.3 * i);
+    path.poses.push_back(pose_stamped_msg);
+  }
+
+  auto lengths = calculate_cumulative_path_lengths(path);
+  ASSERT_EQ(lengths.size(), path.poses.size());
+  EXPECT_DOUBLE_EQ(lengths.front(), 0.0);
+  for (size_t i = 0; i < path.poses.size(); ++i) {
+    EXPECT_NEAR(lengths.back() - lengths[i], calculate_path_length(path, i), 1e-9);
+  }
+}
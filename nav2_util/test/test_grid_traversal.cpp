@@ -0,0 +1,156 @@
+// Copyright (c) 2022 Samsung Research America
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <random>
+#include <utility>
+#include <vector>
+
+#include "nav2_util/grid_traversal.hpp"
+#include "nav2_util/line_iterator.hpp"
+#include "gtest/gtest.h"
+
+using Cells = std::vector<std::pair<int, int>>;
+
+static Cells iteratorCells(int x0, int y0, int x1, int y1)
+{
+  Cells cells;
+  for (nav2_util::LineIterator line(x0, y0, x1, y1); line.isValid(); line.advance()) {
+    cells.emplace_back(line.getX(), line.getY());
+  }
+  return cells;
+}
+
+TEST(GridTraversal, matches_line_iterator)
+{
+  std::mt19937 generator(42);
+  std::uniform_int_distribution<int> coordinate(-20, 20);
+  for (int i = 0; i < 2000; ++i) {
+    const int x0 = coordinate(generator), y0 = coordinate(generator);
+    const int x1 = coordinate(generator), y1 = coordinate(generator);
+    const Cells expected = iteratorCells(x0, y0, x1, y1);
+
+    Cells cells;
+    EXPECT_TRUE(
+      nav2_util::traverseLine(
+        x0, y0, x1, y1, [&](int x, int y) {cells.emplace_back(x, y);}));
+    ASSERT_EQ(cells, expected);
+
+    // Steps are found directly, as well as walked to
+    const nav2_util::GridLine line(x0, y0, x1, y1);
+    ASSERT_EQ(line.size(), static_cast<int>(expected.size()));
+    for (int k = 0; k < line.size(); ++k) {
+      int x, y;
+      line.cell(k, x, y);
+      EXPECT_EQ(std::make_pair(x, y), expected[k]);
+    }
+  }
+}
+
+TEST(GridTraversal, early_exit)
+{
+  int visited = 0;
+  EXPECT_FALSE(
+    nav2_util::traverseLine(
+      0, 0, 10, 3, [&](int x, int) {
+        ++visited;
+        return x < 4;
+      }));
+  EXPECT_EQ(visited, 5);
+}
+
+TEST(GridTraversal, clipping)
+{
+  std::mt19937 generator(7);
+  std::uniform_int_distribution<int> coordinate(-30, 30);
+  for (int i = 0; i < 2000; ++i) {
+    const int x0 = coordinate(generator), y0 = coordinate(generator);
+    const int x1 = coordinate(generator), y1 = coordinate(generator);
+    const int min_x = -10, min_y = -5, max_x = 12, max_y = 9;
+    Cells expected;
+    for (const auto & cell : iteratorCells(x0, y0, x1, y1)) {
+      if (cell.first >= min_x && cell.first < max_x && cell.second >= min_y &&
+        cell.second < max_y)
+      {
+        expected.push_back(cell);
+      }
+    }
+
+    Cells cells;
+    nav2_util::traverseLineClipped(
+      x0, y0, x1, y1, min_x, min_y, max_x, max_y,
+      [&](int x, int y) {cells.emplace_back(x, y);});
+    ASSERT_EQ(cells, expected) << x0 << ", " << y0 << " to " << x1 << ", " << y1;
+  }
+}
+
+TEST(GridTraversal, spans)
+{
+  std::mt19937 generator(3);
+  std::uniform_int_distribution<int> coordinate(-20, 20);
+  for (int i = 0; i < 2000; ++i) {
+    const int x0 = coordinate(generator), y0 = coordinate(generator);
+    const int x1 = coordinate(generator), y1 = coordinate(generator);
+    const Cells expected = iteratorCells(x0, y0, x1, y1);
+
+    // The runs cover the cells in order, along rows
+    Cells cells;
+    nav2_util::traverseLineSpans(
+      x0, y0, x1, y1, [&](int y, int x_first, int x_last) {
+        ASSERT_LE(x_first, x_last);
+        if (x1 >= x0) {
+          for (int x = x_first; x <= x_last; ++x) {
+            cells.emplace_back(x, y);
+          }
+        } else {
+          for (int x = x_last; x >= x_first; --x) {
+            cells.emplace_back(x, y);
+          }
+        }
+      });
+    ASSERT_EQ(cells, expected);
+  }
+
+  // With a run per row of a line along x
+  int runs = 0;
+  EXPECT_FALSE(
+    nav2_util::traverseLineSpans(
+      0, 0, 7, 1, [&](int, int x_first, int x_last) {
+        ++runs;
+        EXPECT_EQ(x_last - x_first, 3);
+        return runs < 2;
+      }));
+  EXPECT_EQ(runs, 2);
+}
+
+TEST(GridTraversal, offsets)
+{
+  // The line from (5, 2) to (11, 5) of a 100 cells wide grid
+  std::vector<unsigned int> offsets;
+  nav2_util::traverseLineOffsets(
+    205, 6, 3, 3, 1, 100, 6, [&](unsigned int offset) {offsets.push_back(offset);});
+  std::vector<unsigned int> expected;
+  for (const auto & cell : iteratorCells(5, 2, 11, 5)) {
+    expected.push_back(cell.second * 100 + cell.first);
+  }
+  EXPECT_EQ(offsets, expected);
+
+  offsets.clear();
+  EXPECT_FALSE(
+    nav2_util::traverseLineOffsets(
+      205, 6, 3, 3, 1, 100, 4, [&](unsigned int offset) {
+        offsets.push_back(offset);
+        return offsets.size() < 3;
+      }));
+  EXPECT_EQ(offsets.size(), 3u);
+}
@@ -0,0 +1,132 @@
+// Copyright (c) 2022 Samsung Research America
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <chrono>
+#include <memory>
+#include <thread>
+#include <vector>
+
+#include "nav2_util/instrumentation.hpp"
+#include "gtest/gtest.h"
+
+using namespace std::chrono_literals;  // NOLINT
+
+TEST(Instrumentation, ScopedProbe)
+{
+  nav2_util::Probe probe("test_scoped.stage");
+  for (unsigned int i = 0; i != 3; i++) {
+    nav2_util::ScopedProbe scope(probe);
+    std::this_thread::sleep_for(1ms);
+  }
+
+  auto statistics = probe.getStatistics();
+  EXPECT_EQ(statistics.name, "test_scoped.stage");
+  EXPECT_EQ(statistics.calls, 3u);
+  EXPECT_GE(statistics.total_time, 3e-3);
+  EXPECT_GE(statistics.max_time, 1e-3);
+  EXPECT_LE(statistics.max_time, statistics.total_time);
+}
+
+TEST(Instrumentation, AllocationsOfScope)
+{
+  nav2_util::Probe probe("test_allocations.stage");
+  {
+    nav2_util::ScopedProbe scope(probe);
+    // Without the allocation counter library, the allocations are counted by hand
+    nav2_util::threadAllocations() += 2;
+  }
+  EXPECT_EQ(probe.getStatistics().allocations, 2u);
+}
+
+TEST(Instrumentation, CountersOverThreads)
+{
+  nav2_util::Probe probe("test_threads.counter");
+  std::vector<std::thread> threads;
+  for (unsigned int i = 0; i != 16; i++) {
+    threads.emplace_back(
+      [&probe]() {
+        for (unsigned int j = 0; j != 1000; j++) {
+          probe.add(1);
+        }
+      });
+  }
+  for (auto & thread : threads) {
+    thread.join();
+  }
+  EXPECT_EQ(probe.getStatistics().calls, 16000u);
+}
+
+TEST(Instrumentation, Registry)
+{
+  auto probe_b = std::make_unique<nav2_util::Probe>("test_registry.b");
+  nav2_util::Probe probe_a("test_registry.a");
+  nav2_util::Probe other("test_other.a");
+  probe_a.add(4);
+
+  auto statistics = nav2_util::getProbeStatistics("test_registry.");
+  ASSERT_EQ(statistics.size(), 2u);
+  EXPECT_EQ(statistics[0].name, "test_registry.a");
+  EXPECT_EQ(statistics[0].calls, 4u);
+  EXPECT_EQ(statistics[1].name, "test_registry.b");
+
+  probe_b.reset();
+  statistics = nav2_util::getProbeStatistics("test_registry.");
+  ASSERT_EQ(statistics.size(), 1u);
+  EXPECT_EQ(statistics[0].name, "test_registry.a");
+}
+
+TEST(Instrumentation, Macros)
+{
+  for (unsigned int i = 0; i != 2; i++) {
+    NAV2_PROBE_SCOPE("test_macros.scope");
+    NAV2_PROBE_COUNT("test_macros.counter", 3);
+  }
+
+  auto statistics = nav2_util::getProbeStatistics("test_macros.");
+#ifndef NAV2_INSTRUMENTATION_DISABLED
+  ASSERT_EQ(statistics.size(), 2u);
+  EXPECT_EQ(statistics[0].name, "test_macros.counter");
+  EXPECT_EQ(statistics[0].calls, 6u);
+  EXPECT_EQ(statistics[1].name, "test_macros.scope");
+  EXPECT_EQ(statistics[1].calls, 2u);
+#else
+  EXPECT_TRUE(statistics.empty());
+#endif
+}
+
+TEST(Instrumentation, MemoryAccounts)
+{
+  auto account_b = std::make_unique<nav2_util::MemoryAccount>("test_memory.b");
+  nav2_util::MemoryAccount account_a("test_memory.a");
+  nav2_util::MemoryAccount other("test_other.a");
+  account_a.set(4096);
+  account_a.set(1024);
+  account_b->set(10);
+
+  auto statistics = nav2_util::getMemoryStatistics("test_memory.");
+  ASSERT_EQ(statistics.size(), 2u);
+  EXPECT_EQ(statistics[0].name, "test_memory.a");
+  EXPECT_EQ(statistics[0].bytes, 1024u);
+  EXPECT_EQ(statistics[0].peak_bytes, 4096u);
+  EXPECT_EQ(statistics[1].name, "test_memory.b");
+  EXPECT_EQ(statistics[1].bytes, 10u);
+
+  account_b.reset();
+  statistics = nav2_util::getMemoryStatistics("test_memory.");
+  ASSERT_EQ(statistics.size(), 1u);
+  EXPECT_EQ(account_a.get(), 1024u);
+
+  // A process always has some memory resident
+  EXPECT_GT(nav2_util::getResidentMemory(), 0u);
+}
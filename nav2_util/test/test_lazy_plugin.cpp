@@ -0,0 +1,119 @@
+// Copyright (c) 2022 Samsung Research America
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <chrono>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "nav2_util/lazy_plugin.hpp"
+#include "gtest/gtest.h"
+
+using namespace std::chrono_literals;
+
+// Plugin recording the calls of its lifecycle
+class RecordingPlugin
+{
+public:
+  explicit RecordingPlugin(std::vector<std::string> & calls)
+  : calls_(calls)
+  {
+    calls_.push_back("configure");
+  }
+
+  void activate() {calls_.push_back("activate");}
+  void deactivate() {calls_.push_back("deactivate");}
+  void cleanup() {calls_.push_back("cleanup");}
+  int run(int value) {return value * 2;}
+
+  std::vector<std::string> & calls_;
+};
+
+using LazyRecordingPlugin = nav2_util::LazyPlugin<RecordingPlugin>;
+
+TEST(LazyPlugin, loadsOnFirstUse)
+{
+  std::vector<std::string> calls;
+  LazyRecordingPlugin plugin([&]() {return std::make_shared<RecordingPlugin>(calls);});
+  plugin.activate();
+  EXPECT_FALSE(plugin.isLoaded());
+  plugin.useIfLoaded([](RecordingPlugin * p) {EXPECT_EQ(p, nullptr);});
+  EXPECT_TRUE(calls.empty());
+
+  // Loaded while active, the plugin is activated before its use
+  EXPECT_EQ(plugin.use([](RecordingPlugin & p) {return p.run(3);}), 6);
+  EXPECT_TRUE(plugin.isLoaded());
+  EXPECT_EQ(plugin.use([](RecordingPlugin & p) {return p.run(4);}), 8);
+  plugin.useIfLoaded([](RecordingPlugin * p) {EXPECT_NE(p, nullptr);});
+  EXPECT_EQ(calls, (std::vector<std::string>{"configure", "activate"}));
+
+  plugin.deactivate();
+  plugin.cleanup();
+  EXPECT_FALSE(plugin.isLoaded());
+  EXPECT_EQ(
+    calls, (std::vector<std::string>{"configure", "activate", "deactivate", "cleanup"}));
+}
+
+TEST(LazyPlugin, warmsAndFollowsActivation)
+{
+  std::vector<std::string> calls;
+  LazyRecordingPlugin plugin([&]() {return std::make_shared<RecordingPlugin>(calls);});
+
+  // Loaded while inactive, the plugin is activated along with the server
+  plugin.warm();
+  EXPECT_TRUE(plugin.isLoaded());
+  plugin.activate();
+  plugin.deactivate();
+  EXPECT_EQ(
+    calls, (std::vector<std::string>{"configure", "activate", "deactivate"}));
+
+  // Unused plugins are only cleaned up
+  calls.clear();
+  LazyRecordingPlugin unused([&]() {return std::make_shared<RecordingPlugin>(calls);});
+  unused.activate();
+  unused.deactivate();
+  unused.cleanup();
+  EXPECT_TRUE(calls.empty());
+}
+
+TEST(LazyPlugin, unloadsWhenIdle)
+{
+  std::vector<std::string> calls;
+  int restored = 0;
+  LazyRecordingPlugin plugin(
+    [&]() {return std::make_shared<RecordingPlugin>(calls);}, 10s,
+    [&](RecordingPlugin &) {++restored;});
+  plugin.activate();
+  plugin.use([](RecordingPlugin &) {});
+  EXPECT_EQ(restored, 1);
+
+  const auto now = LazyRecordingPlugin::Clock::now();
+  EXPECT_FALSE(plugin.unloadIfIdle(now + 1s));
+  EXPECT_TRUE(plugin.unloadIfIdle(now + 11s));
+  EXPECT_FALSE(plugin.isLoaded());
+  EXPECT_FALSE(plugin.unloadIfIdle(now + 20s));
+  EXPECT_EQ(
+    calls, (std::vector<std::string>{"configure", "activate", "deactivate", "cleanup"}));
+
+  // The next use loads the plugin again, restoring its state
+  plugin.use([](RecordingPlugin &) {});
+  EXPECT_TRUE(plugin.isLoaded());
+  EXPECT_EQ(restored, 2);
+
+  // Plugins without a timeout stay loaded
+  LazyRecordingPlugin kept([&]() {return std::make_shared<RecordingPlugin>(calls);});
+  kept.use([](RecordingPlugin &) {});
+  EXPECT_FALSE(kept.unloadIfIdle(now + 1000s));
+  EXPECT_TRUE(kept.isLoaded());
+}
@@ -0,0 +1,184 @@
+// Copyright (c) 2022 Samsung Research America
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <atomic>
+#include <chrono>
+#include <memory>
+#include <thread>
+#include <vector>
+
+#include "gtest/gtest.h"
+#include "nav2_util/navigator_client.hpp"
+#include "nav2_util/node_thread.hpp"
+#include "nav2_util/node_utils.hpp"
+#include "nav2_util/simple_action_server.hpp"
+
+using namespace std::chrono_literals;
+using ComputePathToPose = nav2_msgs::action::ComputePathToPose;
+using NavigateToPose = nav2_msgs::action::NavigateToPose;
+using ComputePaths = nav2_msgs::srv::ComputePaths;
+
+class RclCppFixture
+{
+public:
+  RclCppFixture() {rclcpp::init(0, nullptr);}
+  ~RclCppFixture() {rclcpp::shutdown();}
+};
+RclCppFixture g_rclcppfixture;
+
+// Planner answering with paths to the goals, and a navigator giving feedback
+class FakeServers
+{
+public:
+  explicit FakeServers(std::chrono::milliseconds paths_delay = 5ms)
+  : paths_delay_(paths_delay)
+  {
+    node_ = std::make_shared<rclcpp::Node>("fake_navigation_servers");
+    planner_server_ = std::make_shared<nav2_util::SimpleActionServer<ComputePathToPose>>(
+      node_, "compute_path_to_pose", [this]() {computePath();});
+    paths_service_ = node_->create_service<ComputePaths>(
+      "compute_paths",
+      [this](const std::shared_ptr<ComputePaths::Request> request,
+      std::shared_ptr<ComputePaths::Response> response) {
+        computePaths(request, response);
+      });
+    navigator_server_ = std::make_shared<nav2_util::SimpleActionServer<NavigateToPose>>(
+      node_, "navigate_to_pose", [this]() {navigate();});
+    planner_server_->activate();
+    navigator_server_->activate();
+    node_thread_ = std::make_unique<nav2_util::NodeThread>(node_);
+  }
+
+  ~FakeServers()
+  {
+    node_thread_.reset();
+    planner_server_->deactivate();
+    navigator_server_->deactivate();
+  }
+
+  void computePath()
+  {
+    auto goal = planner_server_->get_current_goal();
+    std::this_thread::sleep_for(5ms);
+    auto result = std::make_shared<ComputePathToPose::Result>();
+    result->path.poses.push_back(goal->goal);
+    planner_server_->succeeded_current(result);
+  }
+
+  void computePaths(
+    const std::shared_ptr<ComputePaths::Request> request,
+    std::shared_ptr<ComputePaths::Response> response)
+  {
+    std::this_thread::sleep_for(paths_delay_);
+    for (const auto & goal : request->goals) {
+      nav_msgs::msg::Path path;
+      path.poses.push_back(goal);
+      response->paths.push_back(path);
+    }
+  }
+
+  void navigate()
+  {
+    for (int i = 0; i < 3; ++i) {
+      auto feedback = std::make_shared<NavigateToPose::Feedback>();
+      feedback->number_of_recoveries = i;
+      navigator_server_->publish_feedback(feedback);
+      std::this_thread::sleep_for(20ms);
+    }
+    navigator_server_->succeeded_current();
+  }
+
+  rclcpp::Node::SharedPtr node_;
+  std::shared_ptr<nav2_util::SimpleActionServer<ComputePathToPose>> planner_server_;
+  std::shared_ptr<nav2_util::SimpleActionServer<NavigateToPose>> navigator_server_;
+  rclcpp::Service<ComputePaths>::SharedPtr paths_service_;
+  std::chrono::milliseconds paths_delay_;
+  std::unique_ptr<nav2_util::NodeThread> node_thread_;
+};
+
+// Waits for the servers faked only
+class NavigatorClientWrapper : public nav2_util::NavigatorClient
+{
+public:
+  explicit NavigatorClientWrapper(const rclcpp::Node::SharedPtr & node)
+  : nav2_util::NavigatorClient(node)
+  {
+  }
+
+  bool waitForFakeServers()
+  {
+    return compute_path_to_pose_client_->wait_for_action_server(5s) &&
+           nav_to_pose_client_->wait_for_action_server(5s) &&
+           compute_paths_client_->wait_for_service(5s);
+  }
+};
+
+TEST(NavigatorClient, computesPathBatches)
+{
+  FakeServers servers;
+  auto node = std::make_shared<rclcpp::Node>(
+    nav2_util::generate_internal_node_name("navigator_client"));
+  NavigatorClientWrapper client(node);
+  ASSERT_TRUE(client.waitForFakeServers());
+
+  std::vector<geometry_msgs::msg::PoseStamped> goals(20);
+  for (size_t i = 0; i != goals.size(); ++i) {
+    goals[i].pose.position.x = static_cast<double>(i);
+  }
+
+  // All of the paths are computed by a single request, in the order of the goals
+  auto future = client.getPaths(goals);
+  ASSERT_EQ(future.wait_for(10s), std::future_status::ready);
+  const auto response = future.get();
+  ASSERT_TRUE(response);
+  ASSERT_EQ(response->paths.size(), goals.size());
+  for (size_t i = 0; i != goals.size(); ++i) {
+    ASSERT_EQ(response->paths[i].poses.size(), 1u);
+    EXPECT_EQ(response->paths[i].poses[0].pose.position.x, static_cast<double>(i));
+  }
+}
+
+TEST(NavigatorClient, streamsFeedback)
+{
+  FakeServers servers;
+  auto node = std::make_shared<rclcpp::Node>(
+    nav2_util::generate_internal_node_name("navigator_client"));
+  NavigatorClientWrapper client(node);
+  ASSERT_TRUE(client.waitForFakeServers());
+
+  std::atomic<int> feedback_received{0};
+  auto future = client.goToPose(
+    geometry_msgs::msg::PoseStamped(), "",
+    [&feedback_received](const std::shared_ptr<const NavigateToPose::Feedback>) {
+      feedback_received++;
+    });
+  ASSERT_EQ(future.wait_for(10s), std::future_status::ready);
+  EXPECT_EQ(future.get().code, rclcpp_action::ResultCode::SUCCEEDED);
+  EXPECT_GT(feedback_received.load(), 0);
+}
+
+TEST(NavigatorClient, cancelsBatches)
+{
+  FakeServers servers(500ms);
+  auto node = std::make_shared<rclcpp::Node>(
+    nav2_util::generate_internal_node_name("navigator_client"));
+  NavigatorClientWrapper client(node);
+  ASSERT_TRUE(client.waitForFakeServers());
+
+  // The response is dropped rather than waited for
+  auto future = client.getPaths(std::vector<geometry_msgs::msg::PoseStamped>(200));
+  client.cancelAll();
+  ASSERT_EQ(future.wait_for(100ms), std::future_status::ready);
+  EXPECT_FALSE(future.get());
+}
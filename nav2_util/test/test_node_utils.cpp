@@ -14,6 +14,8 @@
 
 #include <memory>
 #include <string>
+#include <thread>
+#include <vector>
 
 #include "nav2_util/node_utils.hpp"
 #include "gtest/gtest.h"
@@ -86,6 +88,30 @@ TEST(DeclareParameterIfNotDeclared, DeclareParameterIfNotDeclared)
   ASSERT_EQ(param, "fred");
 }
 
+TEST(DeclareParameterIfNotDeclared, DeclareParameterConcurrently)
+{
+  auto node = std::make_shared<rclcpp::Node>("test_node");
+
+  // Threads declaring the same parameters all succeed, whichever declares them first
+  std::vector<std::thread> threads;
+  for (int t = 0; t < 4; ++t) {
+    threads.emplace_back(
+      [node]() {
+        for (int i = 0; i < 100; ++i) {
+          declare_parameter_if_not_declared(
+            node, "param" + std::to_string(i), rclcpp::ParameterValue{i});
+        }
+      });
+  }
+  for (auto & thread : threads) {
+    thread.join();
+  }
+
+  int param;
+  node->get_parameter("param99", param);
+  ASSERT_EQ(param, 99);
+}
+
 TEST(GetPluginTypeParam, GetPluginTypeParam)
 {
   ::testing::FLAGS_gtest_death_test_style = "threadsafe";
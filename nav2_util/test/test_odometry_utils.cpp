@@ -32,6 +32,13 @@ public:
 };
 RclCppFixture g_rclcppfixture;
 
+class OdomSmootherWrapper : public nav2_util::OdomSmoother
+{
+public:
+  using nav2_util::OdomSmoother::OdomSmoother;
+  using nav2_util::OdomSmoother::odomCallback;
+};
+
 TEST(OdometryUtils, test_smoothed_velocity)
 {
   auto node = std::make_shared<rclcpp::Node>("test_node");
@@ -113,3 +120,41 @@ TEST(OdometryUtils, test_smoothed_velocity)
   EXPECT_EQ(twist_msg.linear.y, 5.0);
   EXPECT_EQ(twist_msg.angular.z, 5.0);
 }
+
+TEST(OdometryUtils, test_smoothed_velocity_history_growth)
+{
+  auto node = std::make_shared<rclcpp::Node>("test_node");
+  OdomSmootherWrapper odom_smoother(node, 0.3, "odom_growth");
+
+  auto time = node->now();
+  auto msg = std::make_shared<nav_msgs::msg::Odometry>();
+  msg->header.frame_id = "odom";
+
+  // More messages in the history than its initial capacity
+  for (int i = 0; i != 300; ++i) {
+    msg->header.stamp = time + rclcpp::Duration::from_seconds(i * 0.001);
+    msg->twist.twist.linear.x = i % 2 ? 1.0 : 3.0;
+    msg->twist.twist.angular.z = -1.0;
+    odom_smoother.odomCallback(msg);
+  }
+
+  auto twist_msg = odom_smoother.getTwistStamped();
+  EXPECT_NEAR(twist_msg.twist.linear.x, 2.0, 1e-9);
+  EXPECT_NEAR(twist_msg.twist.angular.z, -1.0, 1e-9);
+  EXPECT_EQ(twist_msg.header.frame_id, "odom");
+  EXPECT_EQ(
+    rclcpp::Time(twist_msg.header.stamp).nanoseconds(),
+    (time + rclcpp::Duration::from_seconds(0.299)).nanoseconds());
+
+  // The whole history expires
+  msg->header.stamp = time + rclcpp::Duration::from_seconds(1.0);
+  msg->header.frame_id = "odom_2";
+  msg->twist.twist.linear.x = 0.5;
+  msg->twist.twist.angular.z = 0.0;
+  odom_smoother.odomCallback(msg);
+
+  twist_msg = odom_smoother.getTwistStamped();
+  EXPECT_EQ(twist_msg.twist.linear.x, 0.5);
+  EXPECT_EQ(twist_msg.twist.angular.z, 0.0);
+  EXPECT_EQ(twist_msg.header.frame_id, "odom_2");
+}
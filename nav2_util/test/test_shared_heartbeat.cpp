@@ -0,0 +1,71 @@
+// Copyright (c) 2022 Samsung Research America
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+
+#include <chrono>
+#include <memory>
+#include <string>
+#include <thread>
+
+#include "nav2_util/shared_heartbeat.hpp"
+#include "gtest/gtest.h"
+
+using nav2_util::SharedHeartbeat;
+
+TEST(SharedHeartbeat, SegmentNames)
+{
+  // Nodes of the same name in different namespaces get different segments
+  EXPECT_NE(
+    SharedHeartbeat::getSegmentName("/robot1/controller_server"),
+    SharedHeartbeat::getSegmentName("/robot2/controller_server"));
+  EXPECT_NE(
+    SharedHeartbeat::getSegmentName("/a/b_c"), SharedHeartbeat::getSegmentName("/a_b/c"));
+  const std::string name = SharedHeartbeat::getSegmentName("/robot1/controller_server");
+  EXPECT_EQ(name.find('/', 1), std::string::npos);
+}
+
+TEST(SharedHeartbeat, RequestAndAccept)
+{
+  const std::string node_name = "/test_shared_heartbeat/node";
+
+  // Not requested, the node uses a bond
+  EXPECT_EQ(SharedHeartbeat::accept(node_name), nullptr);
+
+  auto manager = SharedHeartbeat::request(node_name);
+  ASSERT_NE(manager, nullptr);
+  EXPECT_FALSE(manager->hasBeaten());
+  EXPECT_TRUE(manager->isBroken(std::chrono::seconds(4)));
+
+  auto node = SharedHeartbeat::accept(node_name);
+  ASSERT_NE(node, nullptr);
+  node->beat();
+  EXPECT_TRUE(manager->hasBeaten());
+  EXPECT_FALSE(manager->isBroken(std::chrono::seconds(4)));
+
+  // Without beats for longer than the timeout, it is broken
+  std::this_thread::sleep_for(std::chrono::milliseconds(50));
+  EXPECT_TRUE(manager->isBroken(std::chrono::milliseconds(20)));
+  node->beat();
+  EXPECT_FALSE(manager->isBroken(std::chrono::milliseconds(20)));
+
+  // Requesting it again starts over, without the beats of the previous activation
+  node.reset();
+  manager = SharedHeartbeat::request(node_name);
+  ASSERT_NE(manager, nullptr);
+  EXPECT_FALSE(manager->hasBeaten());
+
+  // Removed with the manager's heartbeat
+  manager.reset();
+  EXPECT_EQ(SharedHeartbeat::accept(node_name), nullptr);
+}
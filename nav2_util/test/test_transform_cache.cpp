@@ -0,0 +1,100 @@
+// Copyright (c) 2022 Samsung Research America
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <chrono>
+#include <memory>
+#include <string>
+
+#include "gtest/gtest.h"
+#include "rclcpp/rclcpp.hpp"
+#include "nav2_util/robot_utils.hpp"
+#include "nav2_util/transform_cache.hpp"
+
+using namespace std::chrono_literals;  // NOLINT
+
+class RclCppFixture
+{
+public:
+  RclCppFixture() {rclcpp::init(0, nullptr);}
+  ~RclCppFixture() {rclcpp::shutdown();}
+};
+RclCppFixture g_rclcppfixture;
+
+void setTransform(tf2_ros::Buffer & tf, double x, int32_t sec)
+{
+  geometry_msgs::msg::TransformStamped transform;
+  transform.header.frame_id = "map";
+  transform.header.stamp.sec = sec;
+  transform.child_frame_id = "base_link";
+  transform.transform.translation.x = x;
+  transform.transform.rotation.w = 1.0;
+  tf.setTransform(transform, "test");
+}
+
+TEST(TransformCache, servesRepeatedLookups)
+{
+  auto node = std::make_shared<rclcpp::Node>("transform_cache_test");
+  tf2_ros::Buffer tf(node->get_clock());
+  nav2_util::TransformCache cache(tf, 1h);
+
+  EXPECT_THROW(
+    cache.lookupTransform("map", "base_link", tf2::TimePointZero, tf2::durationFromSec(0.0)),
+    tf2::TransformException);
+
+  setTransform(tf, 1.0, 10);
+  geometry_msgs::msg::PoseStamped pose;
+  ASSERT_TRUE(nav2_util::getCurrentPose(pose, cache, "map", "base_link", 0.0));
+  EXPECT_DOUBLE_EQ(pose.pose.position.x, 1.0);
+
+  // The latest transform is served from the cache until cleared
+  setTransform(tf, 2.0, 11);
+  ASSERT_TRUE(nav2_util::getCurrentPose(pose, cache, "map", "base_link", 0.0));
+  EXPECT_DOUBLE_EQ(pose.pose.position.x, 1.0);
+  cache.clear();
+  ASSERT_TRUE(nav2_util::getCurrentPose(pose, cache, "map", "base_link", 0.0));
+  EXPECT_DOUBLE_EQ(pose.pose.position.x, 2.0);
+
+  // Other times and frames are looked up on their own
+  ASSERT_TRUE(
+    nav2_util::getCurrentPose(
+      pose, cache, "map", "base_link", 0.0, rclcpp::Time(10, 500000000)));
+  EXPECT_DOUBLE_EQ(pose.pose.position.x, 1.5);
+  geometry_msgs::msg::PoseStamped map_pose;
+  map_pose.header.frame_id = "map";
+  map_pose.pose.orientation.w = 1.0;
+  ASSERT_TRUE(nav2_util::transformPoseInTargetFrame(map_pose, pose, cache, "base_link", 0.0));
+  EXPECT_DOUBLE_EQ(pose.pose.position.x, -2.0);
+}
+
+TEST(TransformCache, expiresTransforms)
+{
+  auto node = std::make_shared<rclcpp::Node>("transform_cache_expiry_test");
+  tf2_ros::Buffer tf(node->get_clock());
+  geometry_msgs::msg::PoseStamped pose;
+
+  // Without a lifetime, every lookup goes to the buffer
+  nav2_util::TransformCache disabled_cache(tf, 0ns);
+  setTransform(tf, 1.0, 10);
+  ASSERT_TRUE(nav2_util::getCurrentPose(pose, disabled_cache, "map", "base_link", 0.0));
+  setTransform(tf, 2.0, 11);
+  ASSERT_TRUE(nav2_util::getCurrentPose(pose, disabled_cache, "map", "base_link", 0.0));
+  EXPECT_DOUBLE_EQ(pose.pose.position.x, 2.0);
+
+  nav2_util::TransformCache cache(tf, 10ms);
+  ASSERT_TRUE(nav2_util::getCurrentPose(pose, cache, "map", "base_link", 0.0));
+  setTransform(tf, 3.0, 12);
+  rclcpp::sleep_for(20ms);
+  ASSERT_TRUE(nav2_util::getCurrentPose(pose, cache, "map", "base_link", 0.0));
+  EXPECT_DOUBLE_EQ(pose.pose.position.x, 3.0);
+}
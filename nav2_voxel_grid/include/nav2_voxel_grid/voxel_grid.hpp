@@ -44,14 +44,9 @@
 #include <math.h>
 #include <limits.h>
 #include <algorithm>
+#include <vector>
 #include "rclcpp/rclcpp.hpp"
 
-/**
- * @class VoxelGrid
- * @brief A 3D grid structure that stores points as an integer array.
- *        X and Y index the array and Z selects which bit of the integer
- *        is used giving a limit of 16 vertical cells.
- */
 namespace nav2_voxel_grid
 {
 
@@ -62,29 +57,126 @@ enum VoxelStatus
   MARKED = 2,
 };
 
-class VoxelGrid
+/**
+ * @brief  Count the set bits of a column word
+ */
+inline unsigned int popcount(uint32_t n)
+{
+  return __builtin_popcount(n);
+}
+
+inline unsigned int popcount(uint64_t n)
+{
+  return __builtin_popcountll(n);
+}
+
+#ifdef __SIZEOF_INT128__
+inline unsigned int popcount(unsigned __int128 n)
+{
+  return __builtin_popcountll(static_cast<uint64_t>(n)) +
+         __builtin_popcountll(static_cast<uint64_t>(n >> 64));
+}
+#endif
+
+/**
+ * @brief  Get a voxel of a grid packed in 32 bit words, like in VoxelGrid messages.
+ *         Columns wider than a word span consecutive words, least significant first.
+ * @param words_per_column Number of words of each column
+ */
+inline VoxelStatus getPackedVoxel(
+  unsigned int x, unsigned int y, unsigned int z,
+  unsigned int size_x, unsigned int size_y, unsigned int size_z,
+  const uint32_t * data, unsigned int words_per_column)
+{
+  if (x >= size_x || y >= size_y || z >= size_z) {
+    return UNKNOWN;
+  }
+  const uint32_t * col = &data[(y * size_x + x) * words_per_column];
+  const unsigned int marked_bit = z + words_per_column * 16;
+  unsigned int bits = ((col[z / 32] >> (z % 32)) & 1) +
+    ((col[marked_bit / 32] >> (marked_bit % 32)) & 1);
+
+  // known marked: 11 = 2 bits, unknown: 01 = 1 bit, known free: 00 = 0 bits
+  if (bits < 2) {
+    if (bits < 1) {
+      return FREE;
+    }
+    return UNKNOWN;
+  }
+  return MARKED;
+}
+
+/**
+ * @class BasicVoxelGrid
+ * @brief A 3D grid structure that stores points as an integer array.
+ *        X and Y index the array and Z selects which bit of the integer
+ *        is used. The upper half of the bits of a column word mark voxels and
+ *        the lower half tracks unknown voxels, giving a limit of 16 vertical
+ *        cells with 32 bit words, 32 with 64 bit words and 64 with 128 bit words.
+ */
+template<class Word>
+class BasicVoxelGrid
 {
 public:
+  typedef Word WordType;
+
+  /// @brief Maximum number of z levels of the columns
+  static constexpr unsigned int max_size_z = sizeof(Word) * 4;
+  /// @brief Number of 32 bit words each column is packed in by packData()
+  static constexpr unsigned int packed_words = sizeof(Word) / sizeof(uint32_t);
+  /// @brief Column of only unknown voxels
+  static constexpr Word unknown_column = ~Word(0) >> max_size_z;
+
+  /**
+   * @brief  Get the mask of both bits of a voxel in its column
+   */
+  static constexpr Word voxelMask(unsigned int z)
+  {
+    return (Word(1) << z << max_size_z) | (Word(1) << z);
+  }
+
+  /**
+   * @brief  Get the bits of the marked voxels of a column
+   */
+  static constexpr Word markedBits(Word col)
+  {
+    return col >> max_size_z;
+  }
+
+  /**
+   * @brief  Get the bits of the unknown voxels of a column
+   */
+  static constexpr Word unknownBits(Word col)
+  {
+    return (col >> max_size_z) ^ (col & unknown_column);
+  }
+
   /**
    * @brief  Constructor for a voxel grid
    * @param size_x The x size of the grid
    * @param size_y The y size of the grid
-   * @param size_z The z size of the grid, only sizes <= 16 are supported
+   * @param size_z The z size of the grid, only sizes <= max_size_z are supported
    */
-  VoxelGrid(unsigned int size_x, unsigned int size_y, unsigned int size_z);
+  BasicVoxelGrid(unsigned int size_x, unsigned int size_y, unsigned int size_z);
 
-  ~VoxelGrid();
+  ~BasicVoxelGrid();
 
   /**
    * @brief  Resizes a voxel grid to the desired size
    * @param size_x The x size of the grid
    * @param size_y The y size of the grid
-   * @param size_z The z size of the grid, only sizes <= 16 are supported
+   * @param size_z The z size of the grid, only sizes <= max_size_z are supported
    */
   void resize(unsigned int size_x, unsigned int size_y, unsigned int size_z);
 
   void reset();
-  uint32_t * getData() {return data_;}
+  Word * getData() {return data_;}
+
+  /**
+   * @brief  Pack the columns in 32 bit words, least significant first, as read by getPackedVoxel()
+   * @param packed Array of packed_words words for each column of the grid
+   */
+  void packData(uint32_t * packed) const;
 
   inline void markVoxel(unsigned int x, unsigned int y, unsigned int z)
   {
@@ -92,8 +184,7 @@ public:
       RCLCPP_DEBUG(logger, "Error, voxel out of bounds.\n");
       return;
     }
-    uint32_t full_mask = ((uint32_t)1 << z << 16) | (1 << z);
-    data_[y * size_x_ + x] |= full_mask;  // clear unknown and mark cell
+    data_[y * size_x_ + x] |= voxelMask(z);  // clear unknown and mark cell
   }
 
   inline bool markVoxelInMap(
@@ -106,24 +197,55 @@ public:
     }
 
     int index = y * size_x_ + x;
-    uint32_t * col = &data_[index];
-    uint32_t full_mask = ((uint32_t)1 << z << 16) | (1 << z);
-    *col |= full_mask;  // clear unknown and mark cell
-
-    unsigned int marked_bits = *col >> 16;
+    Word * col = &data_[index];
+    *col |= voxelMask(z);  // clear unknown and mark cell
 
     // make sure the number of bits in each is below our thesholds
-    return !bitsBelowThreshold(marked_bits, marked_threshold);
+    return !bitsBelowThreshold(markedBits(*col), marked_threshold);
   }
 
+  /**
+   * @brief  Add a voxel to the masks of the voxels to mark of each column without
+   *         modifying the grid, so that all of the voxels of a column are then marked
+   *         with a single update of it by markColumns()
+   * @param mark_masks Masks of the voxels to mark of each column, zero initialized
+   * and sized like the grid
+   * @param columns Appended with the index of each column first added to the masks
+   */
+  inline void accumulateMarkVoxel(
+    unsigned int x, unsigned int y, unsigned int z,
+    Word * mark_masks, std::vector<unsigned int> & columns)
+  {
+    if (x >= size_x_ || y >= size_y_ || z >= size_z_) {
+      RCLCPP_DEBUG(logger, "Error, voxel out of bounds.\n");
+      return;
+    }
+    const unsigned int index = y * size_x_ + x;
+    if (mark_masks[index] == 0) {
+      columns.push_back(index);
+    }
+    mark_masks[index] |= voxelMask(z);
+  }
+
+  /**
+   * @brief  Mark the voxels accumulated for columns, which has the same result as calling
+   *         markVoxelInMap() for each voxel accumulated. The masks of the columns are
+   *         reset to zero.
+   * @param mark_masks Masks of the voxels to mark of each column
+   * @param columns Index of each column with voxels to mark, left with only those with
+   * more than marked_threshold marked voxels, to be marked in the map, in the same order
+   */
+  void markColumns(
+    Word * mark_masks, std::vector<unsigned int> & columns,
+    unsigned int marked_threshold);
+
   inline void clearVoxel(unsigned int x, unsigned int y, unsigned int z)
   {
     if (x >= size_x_ || y >= size_y_ || z >= size_z_) {
       RCLCPP_DEBUG(logger, "Error, voxel out of bounds.\n");
       return;
     }
-    uint32_t full_mask = ((uint32_t)1 << z << 16) | (1 << z);
-    data_[y * size_x_ + x] &= ~(full_mask);  // clear unknown and clear cell
+    data_[y * size_x_ + x] &= ~voxelMask(z);  // clear unknown and clear cell
   }
 
   inline void clearVoxelColumn(unsigned int index)
@@ -139,50 +261,33 @@ public:
       return;
     }
     int index = y * size_x_ + x;
-    uint32_t * col = &data_[index];
-    uint32_t full_mask = ((uint32_t)1 << z << 16) | (1 << z);
-    *col &= ~(full_mask);  // clear unknown and clear cell
-
-    unsigned int unknown_bits = uint16_t(*col >> 16) ^ uint16_t(*col);
-    unsigned int marked_bits = *col >> 16;
+    Word * col = &data_[index];
+    *col &= ~voxelMask(z);  // clear unknown and clear cell
 
     // make sure the number of bits in each is below our thesholds
-    if (bitsBelowThreshold(unknown_bits, 1) && bitsBelowThreshold(marked_bits, 1)) {
+    if (bitsBelowThreshold(unknownBits(*col), 1) && bitsBelowThreshold(markedBits(*col), 1)) {
       costmap[index] = 0;
     }
   }
 
-  inline bool bitsBelowThreshold(unsigned int n, unsigned int bit_threshold)
+  static inline bool bitsBelowThreshold(Word n, unsigned int bit_threshold)
   {
-    unsigned int bit_count;
-    for (bit_count = 0; n; ) {
-      ++bit_count;
-      if (bit_count > bit_threshold) {
-        return false;
-      }
-      n &= n - 1;  // clear the least significant bit set
-    }
-    return true;
+    return numBits(n) <= bit_threshold;
   }
 
-  static inline unsigned int numBits(unsigned int n)
+  static inline unsigned int numBits(Word n)
   {
-    unsigned int bit_count;
-    for (bit_count = 0; n; ++bit_count) {
-      n &= n - 1;  // clear the least significant bit set
-    }
-    return bit_count;
+    return popcount(n);
   }
 
   static VoxelStatus getVoxel(
     unsigned int x, unsigned int y, unsigned int z,
-    unsigned int size_x, unsigned int size_y, unsigned int size_z, const uint32_t * data)
+    unsigned int size_x, unsigned int size_y, unsigned int size_z, const Word * data)
   {
     if (x >= size_x || y >= size_y || z >= size_z) {
       return UNKNOWN;
     }
-    uint32_t full_mask = ((uint32_t)1 << z << 16) | (1 << z);
-    uint32_t result = data[y * size_x + x] & full_mask;
+    Word result = data[y * size_x + x] & voxelMask(z);
     unsigned int bits = numBits(result);
 
     // known marked: 11 = 2 bits, unknown: 01 = 1 bit, known free: 00 = 0 bits
@@ -207,6 +312,31 @@ public:
     unsigned char free_cost = 0, unsigned char unknown_cost = 255,
     unsigned int max_length = UINT_MAX, unsigned int min_length = 0);
 
+  /**
+   * @brief  Raytrace a clearing line without modifying the grid, accumulating the
+   *         voxels to clear in a mask per column instead. Lines may be accumulated
+   *         concurrently into separate masks, then cleared with clearColumnsInMap().
+   * @param clear_masks Masks of the voxels to clear of each column, zero initialized
+   * and sized like the grid
+   * @param columns Appended with the index of each column first added to the masks
+   */
+  void accumulateClearVoxelLine(
+    double x0, double y0, double z0, double x1, double y1, double z1,
+    Word * clear_masks, std::vector<unsigned int> & columns,
+    unsigned int max_length = UINT_MAX, unsigned int min_length = 0);
+
+  /**
+   * @brief  Clear the voxels accumulated for columns and update their cost in the map,
+   *         which has the same result as calling clearVoxelLineInMap() for each line
+   *         accumulated. The masks of the columns are reset to zero.
+   * @param clear_masks Masks of the voxels to clear of each column
+   * @param columns Index of each column with voxels to clear
+   */
+  void clearColumnsInMap(
+    Word * clear_masks, const std::vector<unsigned int> & columns, unsigned char * map_2d,
+    unsigned int unknown_threshold, unsigned int mark_threshold,
+    unsigned char free_cost = 0, unsigned char unknown_cost = 255);
+
   VoxelStatus getVoxel(unsigned int x, unsigned int y, unsigned int z);
 
   // Are there any obstacles at that (x, y) location in the grid?
@@ -261,7 +391,7 @@ public:
     int offset_dy = sign(dy) * size_x_;
     int offset_dz = sign(dz);
 
-    unsigned int z_mask = ((1 << 16) | 1) << (unsigned int)min_z0;
+    Word z_mask = voxelMask((unsigned int)min_z0);
     unsigned int offset = (unsigned int)min_y0 * size_x_ + (unsigned int)min_x0;
 
     GridOffset grid_off(offset);
@@ -305,7 +435,7 @@ private:
     ActionType at, OffA off_a, OffB off_b, OffC off_c,
     unsigned int abs_da, unsigned int abs_db, unsigned int abs_dc,
     int error_b, int error_c, int offset_a, int offset_b, int offset_c, unsigned int & offset,
-    unsigned int & z_mask, unsigned int max_length = UINT_MAX)
+    Word & z_mask, unsigned int max_length = UINT_MAX)
   {
     unsigned int end = std::min(max_length, abs_da);
     for (unsigned int i = 0; i < end; ++i) {
@@ -336,7 +466,7 @@ private:
   }
 
   unsigned int size_x_, size_y_, size_z_;
-  uint32_t * data_;
+  Word * data_;
   unsigned char * costmap;
   rclcpp::Logger logger;
 
@@ -345,36 +475,36 @@ private:
   class MarkVoxel
   {
 public:
-    explicit MarkVoxel(uint32_t * data)
+    explicit MarkVoxel(Word * data)
     : data_(data) {}
-    inline void operator()(unsigned int offset, unsigned int z_mask)
+    inline void operator()(unsigned int offset, Word z_mask)
     {
       data_[offset] |= z_mask;  // clear unknown and mark cell
     }
 
 private:
-    uint32_t * data_;
+    Word * data_;
   };
 
   class ClearVoxel
   {
 public:
-    explicit ClearVoxel(uint32_t * data)
+    explicit ClearVoxel(Word * data)
     : data_(data) {}
-    inline void operator()(unsigned int offset, unsigned int z_mask)
+    inline void operator()(unsigned int offset, Word z_mask)
     {
       data_[offset] &= ~(z_mask);  // clear unknown and clear cell
     }
 
 private:
-    uint32_t * data_;
+    Word * data_;
   };
 
   class ClearVoxelInMap
   {
 public:
     ClearVoxelInMap(
-      uint32_t * data, unsigned char * costmap,
+      Word * data, unsigned char * costmap,
       unsigned int unknown_clear_threshold, unsigned int marked_clear_threshold,
       unsigned char free_cost = 0, unsigned char unknown_cost = 255)
     : data_(data), costmap_(costmap),
@@ -384,17 +514,14 @@ public:
     {
     }
 
-    inline void operator()(unsigned int offset, unsigned int z_mask)
+    inline void operator()(unsigned int offset, Word z_mask)
     {
-      uint32_t * col = &data_[offset];
+      Word * col = &data_[offset];
       *col &= ~(z_mask);  // clear unknown and clear cell
 
-      unsigned int unknown_bits = uint16_t(*col >> 16) ^ uint16_t(*col);
-      unsigned int marked_bits = *col >> 16;
-
       // make sure the number of bits in each is below our thesholds
-      if (bitsBelowThreshold(marked_bits, marked_clear_threshold_)) {
-        if (bitsBelowThreshold(unknown_bits, unknown_clear_threshold_)) {
+      if (bitsBelowThreshold(markedBits(*col), marked_clear_threshold_)) {
+        if (bitsBelowThreshold(unknownBits(*col), unknown_clear_threshold_)) {
           costmap_[offset] = free_cost_;
         } else {
           costmap_[offset] = unknown_cost_;
@@ -403,23 +530,28 @@ public:
     }
 
 private:
-    inline bool bitsBelowThreshold(unsigned int n, unsigned int bit_threshold)
+    Word * data_;
+    unsigned char * costmap_;
+    unsigned int unknown_clear_threshold_, marked_clear_threshold_;
+    unsigned char free_cost_, unknown_cost_;
+  };
+
+  class AccumulateClearMask
+  {
+public:
+    AccumulateClearMask(Word * clear_masks, std::vector<unsigned int> & columns)
+    : clear_masks_(clear_masks), columns_(columns) {}
+    inline void operator()(unsigned int offset, Word z_mask)
     {
-      unsigned int bit_count;
-      for (bit_count = 0; n; ) {
-        ++bit_count;
-        if (bit_count > bit_threshold) {
-          return false;
-        }
-        n &= n - 1;  // clear the least significant bit set
+      if (clear_masks_[offset] == 0) {
+        columns_.push_back(offset);
       }
-      return true;
+      clear_masks_[offset] |= z_mask;
     }
 
-    uint32_t * data_;
-    unsigned char * costmap_;
-    unsigned int unknown_clear_threshold_, marked_clear_threshold_;
-    unsigned char free_cost_, unknown_cost_;
+private:
+    Word * clear_masks_;
+    std::vector<unsigned int> & columns_;
   };
 
   class GridOffset
@@ -439,7 +571,7 @@ private:
   class ZOffset
   {
 public:
-    explicit ZOffset(unsigned int & z_mask)
+    explicit ZOffset(Word & z_mask)
     : z_mask_(z_mask) {}
     inline void operator()(int offset_val)
     {
@@ -447,10 +579,19 @@ public:
     }
 
 private:
-    unsigned int & z_mask_;
+    Word & z_mask_;
   };
 };
 
+/// @brief Voxel grid of up to 16 z levels
+typedef BasicVoxelGrid<uint32_t> VoxelGrid;
+/// @brief Voxel grid of up to 32 z levels
+typedef BasicVoxelGrid<uint64_t> VoxelGrid64;
+#ifdef __SIZEOF_INT128__
+/// @brief Voxel grid of up to 64 z levels
+typedef BasicVoxelGrid<unsigned __int128> VoxelGrid128;
+#endif
+
 }  // namespace nav2_voxel_grid
 
 #endif  // NAV2_VOXEL_GRID__VOXEL_GRID_HPP_
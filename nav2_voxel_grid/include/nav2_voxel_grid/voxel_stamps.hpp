@@ -0,0 +1,143 @@
+// Copyright (c) 2022 Samsung Research America
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef NAV2_VOXEL_GRID__VOXEL_STAMPS_HPP_
+#define NAV2_VOXEL_GRID__VOXEL_STAMPS_HPP_
+
+#include <stddef.h>
+#include <stdint.h>
+#include <deque>
+#include <vector>
+
+namespace nav2_voxel_grid
+{
+
+/**
+ * @class VoxelStamps
+ * @brief Time each voxel of a grid was last marked, to clear the voxels not marked again
+ *        within a decay time. The voxels stamped are queued in the order they are first
+ *        stamped, so that sweeping the expired ones only visits the voxels expired or
+ *        refreshed since, which is amortized O(1) per voxel stamped.
+ */
+class VoxelStamps
+{
+public:
+  /**
+   * @brief  Resize to the size of a grid, resetting all the stamps
+   */
+  void resize(unsigned int size_x, unsigned int size_y, unsigned int size_z);
+
+  /**
+   * @brief  Reset all the stamps, no voxel being tracked anymore
+   */
+  void reset();
+
+  /**
+   * @brief  Whether the stamps are sized to a grid
+   */
+  bool empty() const {return stamps_.empty();}
+
+  /**
+   * @brief  Stamp a voxel marked
+   * @param index Index of the column of the voxel
+   * @param z Z of the voxel
+   * @param time Time the voxel is marked, in ticks never decreasing and greater than zero
+   */
+  inline void stamp(unsigned int index, unsigned int z, uint32_t time)
+  {
+    uint32_t & voxel_stamp = stamps_[z * cells_ + index];
+    if (voxel_stamp == 0) {
+      queue_.push_back(
+        {static_cast<int>(index % size_x_) + offset_x_,
+          static_cast<int>(index / size_x_) + offset_y_, z, time});
+    }
+    voxel_stamp = time;
+  }
+
+  /**
+   * @brief  Get the stamps of the columns at a z, zero for the voxels not tracked,
+   *         to shift them with the grid
+   */
+  uint32_t * getStamps(unsigned int z) {return &stamps_[z * cells_];}
+
+  /**
+   * @brief  Follow the grid shifted as Costmap2D::shiftMapRegion does, once the stamps
+   *         of each z are shifted with the fill value zero
+   */
+  void shiftOrigin(int cell_ox, int cell_oy)
+  {
+    offset_x_ += cell_ox;
+    offset_y_ += cell_oy;
+  }
+
+  /**
+   * @brief  Sweep the voxels last stamped at least decay ticks before now, which are not
+   *         tracked anymore. A voxel shifted out and back in while queued may be passed
+   *         twice, once expired.
+   * @param expired Called with the index of the column and the z of each voxel expired
+   */
+  template<class ExpiredT>
+  void sweep(uint32_t now, uint32_t decay, ExpiredT expired)
+  {
+    while (!queue_.empty() && now - queue_.front().time >= decay) {
+      Entry entry = queue_.front();
+      queue_.pop_front();
+      const int x = entry.x - offset_x_;
+      const int y = entry.y - offset_y_;
+      if (x < 0 || y < 0 || x >= static_cast<int>(size_x_) || y >= static_cast<int>(size_y_)) {
+        continue;
+      }
+      const unsigned int index = y * size_x_ + x;
+      uint32_t & voxel_stamp = stamps_[entry.z * cells_ + index];
+      if (voxel_stamp == 0) {
+        continue;
+      }
+      if (now - voxel_stamp >= decay) {
+        voxel_stamp = 0;
+        expired(index, entry.z);
+      } else {
+        // Stamped again since queued, queued again as of its last stamp
+        entry.time = voxel_stamp;
+        queue_.push_back(entry);
+      }
+    }
+  }
+
+  /**
+   * @brief  Number of the voxels queued to be swept
+   */
+  size_t queued() const {return queue_.size();}
+
+private:
+  /**
+   * @struct Entry
+   * @brief Voxel queued, in cells of the grid as of no shift so that shifts keep it
+   */
+  struct Entry
+  {
+    int x, y;
+    unsigned int z;
+    uint32_t time;
+  };
+
+  unsigned int size_x_{0}, size_y_{0}, cells_{0};
+  int offset_x_{0}, offset_y_{0};
+  // Stamps of the voxels, z by z, zero for the voxels not tracked
+  std::vector<uint32_t> stamps_;
+  std::deque<Entry> queue_;
+};
+
+}  // namespace nav2_voxel_grid
+
+#endif  // NAV2_VOXEL_GRID__VOXEL_STAMPS_HPP_
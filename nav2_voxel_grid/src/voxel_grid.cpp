@@ -38,30 +38,33 @@
 
 namespace nav2_voxel_grid
 {
-VoxelGrid::VoxelGrid(unsigned int size_x, unsigned int size_y, unsigned int size_z)
+template<class Word>
+BasicVoxelGrid<Word>::BasicVoxelGrid(
+  unsigned int size_x, unsigned int size_y,
+  unsigned int size_z)
 : logger(rclcpp::get_logger("voxel_grid"))
 {
   size_x_ = size_x;
   size_y_ = size_y;
   size_z_ = size_z;
 
-  if (size_z_ > 16) {
+  if (size_z_ > max_size_z) {
     RCLCPP_INFO(
-      logger, "Error, this implementation can only support up to 16 z values (%d)",
-      size_z_);
-    size_z_ = 16;
+      logger, "Error, this implementation can only support up to %u z values (%d)",
+      max_size_z, size_z_);
+    size_z_ = max_size_z;
   }
 
-  data_ = new uint32_t[size_x_ * size_y_];
-  uint32_t unknown_col = ~((uint32_t)0) >> 16;
-  uint32_t * col = data_;
+  data_ = new Word[size_x_ * size_y_];
+  Word * col = data_;
   for (unsigned int i = 0; i < size_x_ * size_y_; ++i) {
-    *col = unknown_col;
+    *col = unknown_column;
     ++col;
   }
 }
 
-void VoxelGrid::resize(unsigned int size_x, unsigned int size_y, unsigned int size_z)
+template<class Word>
+void BasicVoxelGrid<Word>::resize(unsigned int size_x, unsigned int size_y, unsigned int size_z)
 {
   // if we're not actually changing the size, we can just reset things
   if (size_x == size_x_ && size_y == size_y_ && size_z == size_z_) {
@@ -74,38 +77,54 @@ void VoxelGrid::resize(unsigned int size_x, unsigned int size_y, unsigned int si
   size_y_ = size_y;
   size_z_ = size_z;
 
-  if (size_z_ > 16) {
+  if (size_z_ > max_size_z) {
     RCLCPP_INFO(
-      logger, "Error, this implementation can only support up to 16 z values (%d)",
-      size_z);
-    size_z_ = 16;
+      logger, "Error, this implementation can only support up to %u z values (%d)",
+      max_size_z, size_z);
+    size_z_ = max_size_z;
   }
 
-  data_ = new uint32_t[size_x_ * size_y_];
-  uint32_t unknown_col = ~((uint32_t)0) >> 16;
-  uint32_t * col = data_;
+  data_ = new Word[size_x_ * size_y_];
+  Word * col = data_;
   for (unsigned int i = 0; i < size_x_ * size_y_; ++i) {
-    *col = unknown_col;
+    *col = unknown_column;
     ++col;
   }
 }
 
-VoxelGrid::~VoxelGrid()
+template<class Word>
+BasicVoxelGrid<Word>::~BasicVoxelGrid()
 {
   delete[] data_;
 }
 
-void VoxelGrid::reset()
+template<class Word>
+void BasicVoxelGrid<Word>::reset()
 {
-  uint32_t unknown_col = ~((uint32_t)0) >> 16;
-  uint32_t * col = data_;
+  Word * col = data_;
   for (unsigned int i = 0; i < size_x_ * size_y_; ++i) {
-    *col = unknown_col;
+    *col = unknown_column;
     ++col;
   }
 }
 
-void VoxelGrid::markVoxelLine(
+template<class Word>
+void BasicVoxelGrid<Word>::packData(uint32_t * packed) const
+{
+  if (packed_words == 1) {
+    memcpy(packed, data_, size_x_ * size_y_ * sizeof(Word));
+    return;
+  }
+
+  for (unsigned int i = 0; i < size_x_ * size_y_; ++i) {
+    for (unsigned int w = 0; w < packed_words; ++w) {
+      *packed++ = static_cast<uint32_t>(data_[i] >> (32 * w));
+    }
+  }
+}
+
+template<class Word>
+void BasicVoxelGrid<Word>::markVoxelLine(
   double x0, double y0, double z0, double x1, double y1, double z1,
   unsigned int max_length)
 {
@@ -124,7 +143,8 @@ void VoxelGrid::markVoxelLine(
   raytraceLine(mv, x0, y0, z0, x1, y1, z1, max_length);
 }
 
-void VoxelGrid::clearVoxelLine(
+template<class Word>
+void BasicVoxelGrid<Word>::clearVoxelLine(
   double x0, double y0, double z0, double x1, double y1, double z1,
   unsigned int max_length, unsigned int min_length)
 {
@@ -143,7 +163,8 @@ void VoxelGrid::clearVoxelLine(
   raytraceLine(cv, x0, y0, z0, x1, y1, z1, max_length, min_length);
 }
 
-void VoxelGrid::clearVoxelLineInMap(
+template<class Word>
+void BasicVoxelGrid<Word>::clearVoxelLineInMap(
   double x0, double y0, double z0, double x1, double y1, double z1, unsigned char * map_2d,
   unsigned int unknown_threshold, unsigned int mark_threshold, unsigned char free_cost,
   unsigned char unknown_cost, unsigned int max_length, unsigned int min_length)
@@ -169,14 +190,68 @@ void VoxelGrid::clearVoxelLineInMap(
   raytraceLine(cvm, x0, y0, z0, x1, y1, z1, max_length, min_length);
 }
 
-VoxelStatus VoxelGrid::getVoxel(unsigned int x, unsigned int y, unsigned int z)
+template<class Word>
+void BasicVoxelGrid<Word>::accumulateClearVoxelLine(
+  double x0, double y0, double z0, double x1, double y1, double z1,
+  Word * clear_masks, std::vector<unsigned int> & columns,
+  unsigned int max_length, unsigned int min_length)
+{
+  if (x0 >= size_x_ || y0 >= size_y_ || z0 >= size_z_ || x1 >= size_x_ || y1 >= size_y_ ||
+    z1 >= size_z_)
+  {
+    RCLCPP_DEBUG(
+      logger,
+      "Error, line endpoint out of bounds. "
+      "(%.2f, %.2f, %.2f) to (%.2f, %.2f, %.2f),  size: (%d, %d, %d)",
+      x0, y0, z0, x1, y1, z1, size_x_, size_y_, size_z_);
+    return;
+  }
+
+  AccumulateClearMask acm(clear_masks, columns);
+  raytraceLine(acm, x0, y0, z0, x1, y1, z1, max_length, min_length);
+}
+
+template<class Word>
+void BasicVoxelGrid<Word>::clearColumnsInMap(
+  Word * clear_masks, const std::vector<unsigned int> & columns, unsigned char * map_2d,
+  unsigned int unknown_threshold, unsigned int mark_threshold, unsigned char free_cost,
+  unsigned char unknown_cost)
+{
+  // Clearing only ever removes bits of a column, so the cost set when a column is last
+  // raytraced only depends on the voxels cleared by all lines, whatever their order
+  ClearVoxelInMap cvm(data_, map_2d, unknown_threshold, mark_threshold, free_cost, unknown_cost);
+  for (const unsigned int & column : columns) {
+    cvm(column, clear_masks[column]);
+    clear_masks[column] = 0;
+  }
+}
+
+template<class Word>
+void BasicVoxelGrid<Word>::markColumns(
+  Word * mark_masks, std::vector<unsigned int> & columns, unsigned int marked_threshold)
+{
+  // Marking only ever adds bits to a column, so it is above the threshold after all of
+  // its voxels are marked if it was after marking any of them one by one
+  size_t marked = 0;
+  for (const unsigned int & column : columns) {
+    Word & col = data_[column];
+    col |= mark_masks[column];
+    mark_masks[column] = 0;
+    if (!bitsBelowThreshold(markedBits(col), marked_threshold)) {
+      columns[marked++] = column;
+    }
+  }
+  columns.resize(marked);
+}
+
+template<class Word>
+VoxelStatus BasicVoxelGrid<Word>::getVoxel(unsigned int x, unsigned int y, unsigned int z)
 {
   if (x >= size_x_ || y >= size_y_ || z >= size_z_) {
     RCLCPP_DEBUG(logger, "Error, voxel out of bounds. (%d, %d, %d)\n", x, y, z);
     return UNKNOWN;
   }
-  uint32_t full_mask = ((uint32_t)1 << z << 16) | (1 << z);
-  uint32_t result = data_[y * size_x_ + x] & full_mask;
+  Word result = data_[y * size_x_ + x] & voxelMask(z);
   unsigned int bits = numBits(result);
 
   // known marked: 11 = 2 bits, unknown: 01 = 1 bit, known free: 00 = 0 bits
@@ -191,7 +266,8 @@ VoxelStatus VoxelGrid::getVoxel(unsigned int x, unsigned int y, unsigned int z)
   return MARKED;
 }
 
-VoxelStatus VoxelGrid::getVoxelColumn(
+template<class Word>
+VoxelStatus BasicVoxelGrid<Word>::getVoxelColumn(
   unsigned int x, unsigned int y,
   unsigned int unknown_threshold, unsigned int marked_threshold)
 {
@@ -200,40 +276,41 @@ VoxelStatus VoxelGrid::getVoxelColumn(
     return UNKNOWN;
   }
 
-  uint32_t * col = &data_[y * size_x_ + x];
-
-  unsigned int unknown_bits = uint16_t(*col >> 16) ^ uint16_t(*col);
-  unsigned int marked_bits = *col >> 16;
+  Word * col = &data_[y * size_x_ + x];
 
   // check if the number of marked bits qualifies the col as marked
-  if (!bitsBelowThreshold(marked_bits, marked_threshold)) {
+  if (!bitsBelowThreshold(markedBits(*col), marked_threshold)) {
     return MARKED;
   }
 
   // check if the number of unkown bits qualifies the col as unknown
-  if (!bitsBelowThreshold(unknown_bits, unknown_threshold)) {
+  if (!bitsBelowThreshold(unknownBits(*col), unknown_threshold)) {
     return UNKNOWN;
   }
 
   return FREE;
 }
 
-unsigned int VoxelGrid::sizeX()
+template<class Word>
+unsigned int BasicVoxelGrid<Word>::sizeX()
 {
   return size_x_;
 }
 
-unsigned int VoxelGrid::sizeY()
+template<class Word>
+unsigned int BasicVoxelGrid<Word>::sizeY()
 {
   return size_y_;
 }
 
-unsigned int VoxelGrid::sizeZ()
+template<class Word>
+unsigned int BasicVoxelGrid<Word>::sizeZ()
 {
   return size_z_;
 }
 
-void VoxelGrid::printVoxelGrid()
+template<class Word>
+void BasicVoxelGrid<Word>::printVoxelGrid()
 {
   for (unsigned int z = 0; z < size_z_; z++) {
     printf("Layer z = %u:\n", z);
@@ -246,14 +323,22 @@ void VoxelGrid::printVoxelGrid()
   }
 }
 
-void VoxelGrid::printColumnGrid()
+template<class Word>
+void BasicVoxelGrid<Word>::printColumnGrid()
 {
   printf("Column view:\n");
   for (unsigned int y = 0; y < size_y_; y++) {
     for (unsigned int x = 0; x < size_x_; x++) {
-      printf((getVoxelColumn(x, y, 16, 0) == nav2_voxel_grid::MARKED) ? "#" : " ");
+      printf((getVoxelColumn(x, y, max_size_z, 0) == nav2_voxel_grid::MARKED) ? "#" : " ");
     }
     printf("|\n");
   }
 }
+
+template class BasicVoxelGrid<uint32_t>;
+template class BasicVoxelGrid<uint64_t>;
+#ifdef __SIZEOF_INT128__
+template class BasicVoxelGrid<unsigned __int128>;
+#endif
+
 }  // namespace nav2_voxel_grid
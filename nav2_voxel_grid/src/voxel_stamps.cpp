@@ -0,0 +1,40 @@
+// Copyright (c) 2022 Samsung Research America
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "nav2_voxel_grid/voxel_stamps.hpp"
+
+#include <algorithm>
+
+namespace nav2_voxel_grid
+{
+
+void VoxelStamps::resize(unsigned int size_x, unsigned int size_y, unsigned int size_z)
+{
+  size_x_ = size_x;
+  size_y_ = size_y;
+  cells_ = size_x * size_y;
+  stamps_.assign(cells_ * size_z, 0);
+  stamps_.shrink_to_fit();
+  queue_.clear();
+  offset_x_ = offset_y_ = 0;
+}
+
+void VoxelStamps::reset()
+{
+  std::fill(stamps_.begin(), stamps_.end(), 0);
+  queue_.clear();
+  offset_x_ = offset_y_ = 0;
+}
+
+}  // namespace nav2_voxel_grid
@@ -34,6 +34,9 @@
 *
 * Author: Eitan Marder-Eppstein
 *********************************************************************/
+#include <algorithm>
+#include <vector>
+
 #include <nav2_voxel_grid/voxel_grid.hpp>
 #include <gtest/gtest.h>
 
@@ -185,6 +188,176 @@ TEST(voxel_grid, clearVoxelLineInMap) {
   delete[] map_2d;
 }
 
+TEST(voxel_grid, accumulatedClearing) {
+  int size_x = 20, size_y = 20, size_z = 16;
+  nav2_voxel_grid::VoxelGrid serial(size_x, size_y, size_z);
+  nav2_voxel_grid::VoxelGrid accumulated(size_x, size_y, size_z);
+
+  // Mark a wall and a table, some of which the rays below clear
+  for (int i = 0; i < size_x; ++i) {
+    for (int k = 0; k < size_z; k += 3) {
+      serial.markVoxelInMap(i, 15, k, 0);
+      accumulated.markVoxelInMap(i, 15, k, 0);
+    }
+    serial.markVoxelInMap(i, 8, 4, 0);
+    accumulated.markVoxelInMap(i, 8, 4, 0);
+  }
+
+  unsigned char * serial_map = new unsigned char[size_x * size_y];
+  unsigned char * accumulated_map = new unsigned char[size_x * size_y];
+  std::fill(serial_map, serial_map + size_x * size_y, 254);
+  std::fill(accumulated_map, accumulated_map + size_x * size_y, 254);
+
+  // Accumulate the rays in two sets of masks, as two clearing threads would
+  std::vector<uint32_t> masks_a(size_x * size_y, 0), masks_b(size_x * size_y, 0);
+  std::vector<unsigned int> columns_a, columns_b;
+  for (int i = 0; i < size_x; ++i) {
+    double x1 = i + 0.5, y1 = 19.5, z1 = (i % 16) + 0.5;
+    serial.clearVoxelLineInMap(10.5, 0.5, 8.5, x1, y1, z1, serial_map, 16, 0, 0, 255, 30, 2);
+    if (i % 2) {
+      accumulated.accumulateClearVoxelLine(
+        10.5, 0.5, 8.5, x1, y1, z1, masks_a.data(), columns_a, 30, 2);
+    } else {
+      accumulated.accumulateClearVoxelLine(
+        10.5, 0.5, 8.5, x1, y1, z1, masks_b.data(), columns_b, 30, 2);
+    }
+  }
+
+  // Nothing is cleared until the masks are
+  EXPECT_EQ(accumulated.getVoxel(10, 8, 4), nav2_voxel_grid::MARKED);
+  EXPECT_FALSE(columns_a.empty());
+
+  for (const unsigned int & column : columns_b) {
+    if (masks_a[column] == 0) {
+      columns_a.push_back(column);
+    }
+    masks_a[column] |= masks_b[column];
+    masks_b[column] = 0;
+  }
+  accumulated.clearColumnsInMap(masks_a.data(), columns_a, accumulated_map, 16, 0, 0, 255);
+
+  for (int i = 0; i < size_x * size_y; ++i) {
+    EXPECT_EQ(masks_a[i], 0u);
+    EXPECT_EQ(serial_map[i], accumulated_map[i]);
+  }
+  for (int i = 0; i < size_x; ++i) {
+    for (int j = 0; j < size_y; ++j) {
+      for (int k = 0; k < size_z; ++k) {
+        EXPECT_EQ(serial.getVoxel(i, j, k), accumulated.getVoxel(i, j, k));
+      }
+    }
+  }
+
+  delete[] serial_map;
+  delete[] accumulated_map;
+}
+
+TEST(voxel_grid, accumulatedMarking) {
+  int size_x = 20, size_y = 20, size_z = 16;
+  nav2_voxel_grid::VoxelGrid serial(size_x, size_y, size_z);
+  nav2_voxel_grid::VoxelGrid accumulated(size_x, size_y, size_z);
+  serial.markVoxelInMap(2, 2, 0, 0);
+  accumulated.markVoxelInMap(2, 2, 0, 0);
+
+  // Points of a wall, several per column, a single point already marked and one out of bounds
+  std::vector<uint32_t> masks(size_x * size_y, 0);
+  std::vector<unsigned int> columns;
+  std::vector<unsigned int> serial_marked;
+  auto mark = [&](unsigned int x, unsigned int y, unsigned int z) {
+      if (serial.markVoxelInMap(x, y, z, 2)) {
+        serial_marked.push_back(y * size_x + x);
+      }
+      accumulated.accumulateMarkVoxel(x, y, z, masks.data(), columns);
+    };
+  for (int i = 0; i < size_x; ++i) {
+    for (int k = 0; k < i % 6; ++k) {
+      mark(i, 10, k);
+      mark(i, 10, k);
+    }
+  }
+  mark(2, 2, 0);
+  mark(2, 2, size_z);
+
+  // Nothing is marked until the masks are
+  EXPECT_EQ(accumulated.getVoxel(5, 10, 0), nav2_voxel_grid::UNKNOWN);
+  EXPECT_EQ(columns.size(), 17u);
+
+  accumulated.markColumns(masks.data(), columns, 2);
+  std::sort(serial_marked.begin(), serial_marked.end());
+  serial_marked.erase(
+    std::unique(serial_marked.begin(), serial_marked.end()), serial_marked.end());
+  std::sort(columns.begin(), columns.end());
+  EXPECT_EQ(columns, serial_marked);
+
+  for (int i = 0; i < size_x * size_y; ++i) {
+    EXPECT_EQ(masks[i], 0u);
+  }
+  for (int i = 0; i < size_x; ++i) {
+    for (int j = 0; j < size_y; ++j) {
+      for (int k = 0; k < size_z; ++k) {
+        EXPECT_EQ(serial.getVoxel(i, j, k), accumulated.getVoxel(i, j, k));
+      }
+    }
+  }
+}
+
+template<class VoxelGridT>
+void testTallColumns()
+{
+  const unsigned int size_z = VoxelGridT::max_size_z;
+  VoxelGridT vg(10, 10, size_z + 1);
+  ASSERT_EQ(vg.sizeZ(), size_z);
+  EXPECT_EQ(vg.getVoxelColumn(3, 3, size_z - 1, 0), nav2_voxel_grid::UNKNOWN);
+
+  // Mark every level of a column, including those above 16
+  for (unsigned int z = 0; z < size_z; ++z) {
+    EXPECT_TRUE(vg.markVoxelInMap(3, 3, z, z));
+    EXPECT_EQ(vg.getVoxel(3, 3, z), nav2_voxel_grid::MARKED);
+  }
+  EXPECT_EQ(vg.getVoxel(3, 4, size_z - 1), nav2_voxel_grid::UNKNOWN);
+  EXPECT_EQ(vg.getVoxelColumn(3, 3, 0, size_z - 1), nav2_voxel_grid::MARKED);
+  EXPECT_EQ(vg.getVoxelColumn(3, 3, 0, size_z), nav2_voxel_grid::FREE);
+
+  // Clear the upper half of it, building the cost of the column in a map
+  unsigned char map_2d[100];
+  map_2d[33] = 254;
+  vg.clearVoxelLineInMap(3.5, 3.5, size_z / 2 + 0.5, 3.5, 3.5, size_z - 0.5, map_2d, 0, size_z);
+  for (unsigned int z = 0; z < size_z; ++z) {
+    EXPECT_EQ(
+      vg.getVoxel(3, 3, z), z < size_z / 2 ? nav2_voxel_grid::MARKED : nav2_voxel_grid::FREE);
+  }
+  EXPECT_EQ(map_2d[33], 0);
+  EXPECT_EQ(vg.getVoxelColumn(3, 3, 0, size_z / 2 - 1), nav2_voxel_grid::MARKED);
+  EXPECT_EQ(vg.getVoxelColumn(3, 3, 0, size_z / 2), nav2_voxel_grid::FREE);
+
+  // The static accessor decodes the columns of published grids
+  EXPECT_EQ(
+    VoxelGridT::getVoxel(3, 3, size_z - 1, 10, 10, size_z, vg.getData()),
+    nav2_voxel_grid::FREE);
+  EXPECT_EQ(
+    VoxelGridT::getVoxel(3, 3, 0, 10, 10, size_z, vg.getData()), nav2_voxel_grid::MARKED);
+
+  // And packed grids decode to the same voxels
+  std::vector<uint32_t> packed(100 * VoxelGridT::packed_words);
+  vg.packData(packed.data());
+  for (unsigned int x = 0; x < 10; ++x) {
+    for (unsigned int z = 0; z < size_z; ++z) {
+      EXPECT_EQ(
+        nav2_voxel_grid::getPackedVoxel(
+          x, 3, z, 10, 10, size_z, packed.data(), VoxelGridT::packed_words),
+        vg.getVoxel(x, 3, z));
+    }
+  }
+}
+
+TEST(voxel_grid, tallColumns) {
+  testTallColumns<nav2_voxel_grid::VoxelGrid>();
+  testTallColumns<nav2_voxel_grid::VoxelGrid64>();
+#ifdef __SIZEOF_INT128__
+  testTallColumns<nav2_voxel_grid::VoxelGrid128>();
+#endif
+}
+
 TEST(voxel_grid, GetVoxelData) {
   uint32_t * data = new uint32_t[9];
   data[4] = 255;
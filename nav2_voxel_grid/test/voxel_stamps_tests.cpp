@@ -0,0 +1,80 @@
+// Copyright (c) 2022 Samsung Research America
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <gtest/gtest.h>
+
+#include <algorithm>
+#include <utility>
+#include <vector>
+
+#include "nav2_voxel_grid/voxel_stamps.hpp"
+
+typedef std::vector<std::pair<unsigned int, unsigned int>> Voxels;
+
+static Voxels sweep(nav2_voxel_grid::VoxelStamps & stamps, uint32_t now, uint32_t decay)
+{
+  Voxels expired;
+  stamps.sweep(
+    now, decay, [&expired](unsigned int index, unsigned int z) {
+      expired.emplace_back(index, z);
+    });
+  return expired;
+}
+
+TEST(VoxelStamps, expiresVoxelsNotStampedAgain)
+{
+  nav2_voxel_grid::VoxelStamps stamps;
+  stamps.resize(10, 10, 4);
+  stamps.stamp(5, 0, 1);
+  stamps.stamp(6, 3, 1);
+  stamps.stamp(7, 1, 5);
+  EXPECT_TRUE(sweep(stamps, 10, 10).empty());
+
+  // Refreshed voxels are queued again, only once
+  stamps.stamp(6, 3, 8);
+  stamps.stamp(6, 3, 9);
+  EXPECT_EQ(sweep(stamps, 11, 10), Voxels({{5, 0}}));
+  EXPECT_EQ(stamps.queued(), 2u);
+  EXPECT_EQ(sweep(stamps, 15, 10), Voxels({{7, 1}}));
+  EXPECT_EQ(sweep(stamps, 19, 10), Voxels({{6, 3}}));
+  EXPECT_EQ(stamps.queued(), 0u);
+
+  // Voxels expired are tracked again once stamped
+  stamps.stamp(5, 0, 20);
+  EXPECT_EQ(sweep(stamps, 30, 10), Voxels({{5, 0}}));
+}
+
+TEST(VoxelStamps, followsShiftsAndResets)
+{
+  nav2_voxel_grid::VoxelStamps stamps;
+  stamps.resize(4, 4, 1);
+  stamps.stamp(0, 0, 1);
+  stamps.stamp(3 * 4 + 3, 0, 1);
+
+  // Shifted by one cell in x and y, the first voxel is shifted out
+  uint32_t * plane = stamps.getStamps(0);
+  std::vector<uint32_t> shifted(16, 0);
+  for (unsigned int y = 0; y + 1 < 4; ++y) {
+    for (unsigned int x = 0; x + 1 < 4; ++x) {
+      shifted[y * 4 + x] = plane[(y + 1) * 4 + x + 1];
+    }
+  }
+  std::copy(shifted.begin(), shifted.end(), plane);
+  stamps.shiftOrigin(1, 1);
+  EXPECT_EQ(sweep(stamps, 11, 10), Voxels({{2 * 4 + 2, 0}}));
+
+  stamps.stamp(0, 0, 12);
+  stamps.reset();
+  EXPECT_TRUE(sweep(stamps, 30, 10).empty());
+}
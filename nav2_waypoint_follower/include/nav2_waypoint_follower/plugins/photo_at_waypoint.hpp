@@ -23,8 +23,11 @@
 
 
 #include <experimental/filesystem>
+#include <condition_variable>
+#include <deque>
 #include <mutex>
 #include <string>
+#include <thread>
 #include <exception>
 
 #include "rclcpp/rclcpp.hpp"
@@ -94,6 +97,29 @@ public:
   static void deepCopyMsg2Mat(const sensor_msgs::msg::Image::SharedPtr & msg, cv::Mat & mat);
 
 protected:
+  /**
+   * @brief Convert and write an image to a file
+   *
+   * @param msg image to write
+   * @param path file to write it to
+   */
+  static void writeImage(
+    const sensor_msgs::msg::Image::SharedPtr & msg,
+    const std::experimental::filesystem::path & path);
+
+  /**
+   * @brief Loop of the writer thread, writing the queued images until stopped
+   */
+  void writeImages();
+
+  // An image taken at a waypoint, waiting to be written
+  struct PendingImage
+  {
+    sensor_msgs::msg::Image::SharedPtr msg;
+    std::experimental::filesystem::path path;
+    int waypoint_index;
+  };
+
   // to ensure safety when accessing global var curr_frame_
   std::mutex global_mutex_;
   // the taken photos will be saved under this directory
@@ -110,6 +136,15 @@ protected:
   rclcpp::Logger logger_{rclcpp::get_logger("nav2_waypoint_follower")};
   // ros susbcriber to get camera image
   rclcpp::Subscription<sensor_msgs::msg::Image>::SharedPtr camera_image_subscriber_;
+  // whether images are converted and written by a writer thread, off the waypoint following
+  bool write_in_background_;
+  // images waiting for the writer thread, written right away when it is full
+  unsigned int max_pending_images_;
+  std::deque<PendingImage> pending_images_;
+  std::mutex pending_images_mutex_;
+  std::condition_variable pending_images_cv_;
+  bool stop_writer_{false};
+  std::thread writer_thread_;
 };
 }  // namespace nav2_waypoint_follower
 
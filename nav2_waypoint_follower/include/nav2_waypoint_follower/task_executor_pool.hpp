@@ -0,0 +1,106 @@
+// Copyright (c) 2022 Samsung Research America
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef NAV2_WAYPOINT_FOLLOWER__TASK_EXECUTOR_POOL_HPP_
+#define NAV2_WAYPOINT_FOLLOWER__TASK_EXECUTOR_POOL_HPP_
+
+#include <condition_variable>
+#include <deque>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include "geometry_msgs/msg/pose_stamped.hpp"
+#include "nav2_core/waypoint_task_executor.hpp"
+
+namespace nav2_waypoint_follower
+{
+
+/**
+ * @class nav2_waypoint_follower::TaskExecutorPool
+ * @brief Worker threads running the task executor at the waypoints reached, from a bounded
+ * queue, while the robot goes on to the next waypoints. With several workers, the task
+ * executor must support concurrent calls to processAtWaypoint().
+ */
+class TaskExecutorPool
+{
+public:
+  /**
+   * @brief A constructor for nav2_waypoint_follower::TaskExecutorPool, starting the workers
+   * @param task_executor Task executor to run, expected to outlive the pool
+   * @param num_threads Number of workers
+   * @param queue_size Number of tasks which can wait for a worker
+   */
+  TaskExecutorPool(
+    nav2_core::WaypointTaskExecutor & task_executor,
+    unsigned int num_threads,
+    unsigned int queue_size);
+
+  /**
+   * @brief A destructor for nav2_waypoint_follower::TaskExecutorPool, stopping the workers
+   * once the tasks running are done. The tasks still queued are dropped.
+   */
+  ~TaskExecutorPool();
+
+  /**
+   * @brief Queue the task at a waypoint
+   * @param pose Pose of the waypoint
+   * @param waypoint_index Index of the waypoint
+   * @return False if the queue is full, in which case the task is not queued
+   */
+  bool push(const geometry_msgs::msg::PoseStamped & pose, int waypoint_index);
+
+  /**
+   * @brief Get the indices of the waypoints whose task failed since the last call
+   * @return Indices of the waypoints, in the order their tasks finished
+   */
+  std::vector<int> takeFailures();
+
+  /**
+   * @brief Drop the tasks still queued, the ones running are finished
+   */
+  void clear();
+
+  /**
+   * @brief Whether all of the tasks queued are done
+   */
+  bool idle();
+
+protected:
+  // A task at a waypoint
+  struct Task
+  {
+    geometry_msgs::msg::PoseStamped pose;
+    int waypoint_index;
+  };
+
+  /**
+   * @brief Loop of a worker, running tasks from the queue until stopped
+   */
+  void work();
+
+  nav2_core::WaypointTaskExecutor & task_executor_;
+  unsigned int queue_size_;
+  std::vector<std::thread> workers_;
+  std::deque<Task> queue_;
+  std::vector<int> failures_;
+  unsigned int running_;
+  bool stop_;
+  std::mutex mutex_;
+  std::condition_variable queued_;
+};
+
+}  // namespace nav2_waypoint_follower
+
+#endif  // NAV2_WAYPOINT_FOLLOWER__TASK_EXECUTOR_POOL_HPP_
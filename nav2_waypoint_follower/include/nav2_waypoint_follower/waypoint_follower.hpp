@@ -29,6 +29,7 @@
 
 #include "nav2_util/node_utils.hpp"
 #include "nav2_core/waypoint_task_executor.hpp"
+#include "nav2_waypoint_follower/task_executor_pool.hpp"
 #include "pluginlib/class_loader.hpp"
 #include "pluginlib/class_list_macros.hpp"
 
@@ -105,12 +106,33 @@ protected:
    */
   void followWaypoints();
 
+  /**
+   * @brief Handle the tasks at waypoints which failed on the task executor pool
+   * @param result Result of the action, set if it is terminated
+   * @return False if the action was terminated, because of stop on failure
+   */
+  bool handleTaskFailures(std::shared_ptr<ActionT::Result> result);
+
+  /**
+   * @brief Wait for the tasks queued on the task executor pool, handling their failures
+   * @param result Result of the action, set if it is terminated
+   * @return False if the action was terminated or canceled meanwhile
+   */
+  bool waitForTasks(std::shared_ptr<ActionT::Result> result);
+
   /**
    * @brief Action client result callback
    * @param result Result of action server updated asynchronously
    */
   void resultCallback(const rclcpp_action::ClientGoalHandle<ClientT>::WrappedResult & result);
 
+  /**
+   * @brief Action client feedback callback, readying the handoff of a pass-through waypoint
+   * once the robot is within the handoff radius of it
+   * @param feedback Feedback of the navigation to the current waypoint
+   */
+  void feedbackCallback(const std::shared_ptr<const ClientT::Feedback> & feedback);
+
   /**
    * @brief Action client goal response callback
    * @param goal Response of action server updated asynchronously
@@ -138,6 +160,15 @@ protected:
   int loop_rate_;
   std::vector<int> failed_ids_;
 
+  // Whether the waypoints before the last are passed through, without their task, the
+  // navigation being handed over to the next once within the handoff radius of them
+  bool pass_through_waypoints_;
+  double handoff_radius_;
+  bool handoff_ready_;
+  geometry_msgs::msg::PoseStamped current_waypoint_;
+  // Incremented on each goal sent, the callbacks of the goals handed over being ignored
+  unsigned int goal_generation_;
+
   // Task Execution At Waypoint Plugin
   pluginlib::ClassLoader<nav2_core::WaypointTaskExecutor>
   waypoint_task_executor_loader_;
@@ -145,6 +176,8 @@ protected:
   waypoint_task_executor_;
   std::string waypoint_task_executor_id_;
   std::string waypoint_task_executor_type_;
+  // Runs the task executor while the robot goes on, when it has workers
+  std::unique_ptr<TaskExecutorPool> task_executor_pool_;
 };
 
 }  // namespace nav2_waypoint_follower
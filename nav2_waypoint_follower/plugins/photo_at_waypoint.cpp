@@ -14,8 +14,11 @@
 
 #include "nav2_waypoint_follower/plugins/photo_at_waypoint.hpp"
 
+#include <algorithm>
 #include <string>
 #include <memory>
+#include <stdexcept>
+#include <utility>
 
 #include "pluginlib/class_list_macros.hpp"
 
@@ -29,6 +32,15 @@ PhotoAtWaypoint::PhotoAtWaypoint()
 
 PhotoAtWaypoint::~PhotoAtWaypoint()
 {
+  // The images already taken are still written
+  {
+    std::lock_guard<std::mutex> lock(pending_images_mutex_);
+    stop_writer_ = true;
+  }
+  pending_images_cv_.notify_all();
+  if (writer_thread_.joinable()) {
+    writer_thread_.join();
+  }
 }
 
 void PhotoAtWaypoint::initialize(
@@ -51,12 +63,22 @@ void PhotoAtWaypoint::initialize(
   nav2_util::declare_parameter_if_not_declared(
     node, plugin_name + ".image_format",
     rclcpp::ParameterValue("png"));
+  nav2_util::declare_parameter_if_not_declared(
+    node, plugin_name + ".write_in_background",
+    rclcpp::ParameterValue(false));
+  nav2_util::declare_parameter_if_not_declared(
+    node, plugin_name + ".max_pending_images",
+    rclcpp::ParameterValue(4));
 
   std::string save_dir_as_string;
+  int max_pending_images;
   node->get_parameter(plugin_name + ".enabled", is_enabled_);
   node->get_parameter(plugin_name + ".image_topic", image_topic_);
   node->get_parameter(plugin_name + ".save_dir", save_dir_as_string);
   node->get_parameter(plugin_name + ".image_format", image_format_);
+  node->get_parameter(plugin_name + ".write_in_background", write_in_background_);
+  node->get_parameter(plugin_name + ".max_pending_images", max_pending_images);
+  max_pending_images_ = static_cast<unsigned int>(std::max(max_pending_images, 1));
 
   // get inputted save directory and make sure it exists, if not log and create  it
   save_dir_ = save_dir_as_string;
@@ -95,6 +117,9 @@ void PhotoAtWaypoint::initialize(
     camera_image_subscriber_ = node->create_subscription<sensor_msgs::msg::Image>(
       image_topic_, rclcpp::SystemDefaultsQoS(),
       std::bind(&PhotoAtWaypoint::imageCallback, this, std::placeholders::_1));
+    if (write_in_background_ && !writer_thread_.joinable()) {
+      writer_thread_ = std::thread(&PhotoAtWaypoint::writeImages, this);
+    }
   }
 }
 
@@ -115,11 +140,33 @@ bool PhotoAtWaypoint::processAtWaypoint(
       std::to_string(curr_pose.header.stamp.sec) + "." + image_format_;
     std::experimental::filesystem::path full_path_image_path = save_dir_ / file_name;
 
+    // take the current frame, the messages received are not modified afterwards
+    sensor_msgs::msg::Image::SharedPtr frame_msg;
+    {
+      std::lock_guard<std::mutex> guard(global_mutex_);
+      frame_msg = curr_frame_msg_;
+    }
+    if (frame_msg->data.empty()) {
+      throw std::runtime_error("No image received");
+    }
+
+    // queue it for the writer thread, so that the robot does not wait for its encoding
+    if (write_in_background_) {
+      std::unique_lock<std::mutex> lock(pending_images_mutex_);
+      if (pending_images_.size() < max_pending_images_) {
+        pending_images_.push_back({frame_msg, full_path_image_path, curr_waypoint_index});
+        lock.unlock();
+        pending_images_cv_.notify_one();
+        RCLCPP_INFO(
+          logger_,
+          "Photo has been taken sucessfully at waypoint %i, writing it in background",
+          curr_waypoint_index);
+        return true;
+      }
+    }
+
     // save the taken photo at this waypoint to given directory
-    std::lock_guard<std::mutex> guard(global_mutex_);
-    cv::Mat curr_frame_mat;
-    deepCopyMsg2Mat(curr_frame_msg_, curr_frame_mat);
-    cv::imwrite(full_path_image_path.c_str(), curr_frame_mat);
+    writeImage(frame_msg, full_path_image_path);
     RCLCPP_INFO(
       logger_,
       "Photo has been taken sucessfully at waypoint %i", curr_waypoint_index);
@@ -135,6 +182,40 @@ bool PhotoAtWaypoint::processAtWaypoint(
   return true;
 }
 
+void PhotoAtWaypoint::writeImage(
+  const sensor_msgs::msg::Image::SharedPtr & msg,
+  const std::experimental::filesystem::path & path)
+{
+  cv::Mat frame_mat;
+  deepCopyMsg2Mat(msg, frame_mat);
+  if (!cv::imwrite(path.c_str(), frame_mat)) {
+    throw std::runtime_error("Failed to write " + path.string());
+  }
+}
+
+void PhotoAtWaypoint::writeImages()
+{
+  std::unique_lock<std::mutex> lock(pending_images_mutex_);
+  while (true) {
+    pending_images_cv_.wait(lock, [this]() {return stop_writer_ || !pending_images_.empty();});
+    if (pending_images_.empty()) {
+      return;
+    }
+
+    PendingImage image = std::move(pending_images_.front());
+    pending_images_.pop_front();
+    lock.unlock();
+    try {
+      writeImage(image.msg, image.path);
+    } catch (const std::exception & e) {
+      RCLCPP_ERROR(
+        logger_, "Couldn't write photo taken at waypoint %i! Caught exception: %s",
+        image.waypoint_index, e.what());
+    }
+    lock.lock();
+  }
+}
+
 void PhotoAtWaypoint::imageCallback(const sensor_msgs::msg::Image::SharedPtr msg)
 {
   std::lock_guard<std::mutex> guard(global_mutex_);
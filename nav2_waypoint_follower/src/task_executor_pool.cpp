@@ -0,0 +1,107 @@
+// Copyright (c) 2022 Samsung Research America
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "nav2_waypoint_follower/task_executor_pool.hpp"
+
+#include <utility>
+#include <vector>
+
+namespace nav2_waypoint_follower
+{
+
+TaskExecutorPool::TaskExecutorPool(
+  nav2_core::WaypointTaskExecutor & task_executor,
+  unsigned int num_threads,
+  unsigned int queue_size)
+: task_executor_(task_executor),
+  queue_size_(queue_size),
+  running_(0),
+  stop_(false)
+{
+  for (unsigned int i = 0; i < num_threads; ++i) {
+    workers_.emplace_back(&TaskExecutorPool::work, this);
+  }
+}
+
+TaskExecutorPool::~TaskExecutorPool()
+{
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    stop_ = true;
+    queue_.clear();
+  }
+  queued_.notify_all();
+  for (auto & worker : workers_) {
+    worker.join();
+  }
+}
+
+bool TaskExecutorPool::push(const geometry_msgs::msg::PoseStamped & pose, int waypoint_index)
+{
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (queue_.size() >= queue_size_) {
+      return false;
+    }
+    queue_.push_back({pose, waypoint_index});
+  }
+  queued_.notify_one();
+  return true;
+}
+
+std::vector<int> TaskExecutorPool::takeFailures()
+{
+  std::lock_guard<std::mutex> lock(mutex_);
+  std::vector<int> failures;
+  failures.swap(failures_);
+  return failures;
+}
+
+void TaskExecutorPool::clear()
+{
+  std::lock_guard<std::mutex> lock(mutex_);
+  queue_.clear();
+}
+
+bool TaskExecutorPool::idle()
+{
+  std::lock_guard<std::mutex> lock(mutex_);
+  return queue_.empty() && running_ == 0;
+}
+
+void TaskExecutorPool::work()
+{
+  std::unique_lock<std::mutex> lock(mutex_);
+  while (true) {
+    queued_.wait(lock, [this]() {return stop_ || !queue_.empty();});
+    if (stop_) {
+      return;
+    }
+
+    Task task = std::move(queue_.front());
+    queue_.pop_front();
+    running_++;
+    lock.unlock();
+
+    const bool succeeded = task_executor_.processAtWaypoint(task.pose, task.waypoint_index);
+
+    lock.lock();
+    running_--;
+    if (!succeeded) {
+      failures_.push_back(task.waypoint_index);
+    }
+  }
+}
+
+}  // namespace nav2_waypoint_follower
@@ -14,6 +14,8 @@
 
 #include "nav2_waypoint_follower/waypoint_follower.hpp"
 
+#include <algorithm>
+#include <cmath>
 #include <fstream>
 #include <memory>
 #include <streambuf>
@@ -29,6 +31,8 @@ using std::placeholders::_1;
 
 WaypointFollower::WaypointFollower(const rclcpp::NodeOptions & options)
 : nav2_util::LifecycleNode("waypoint_follower", "", false, options),
+  handoff_ready_(false),
+  goal_generation_(0),
   waypoint_task_executor_loader_("nav2_waypoint_follower",
     "nav2_core::WaypointTaskExecutor")
 {
@@ -36,6 +40,10 @@ WaypointFollower::WaypointFollower(const rclcpp::NodeOptions & options)
 
   declare_parameter("stop_on_failure", true);
   declare_parameter("loop_rate", 20);
+  declare_parameter("task_executor_threads", 0);
+  declare_parameter("task_queue_size", 4);
+  declare_parameter("pass_through_waypoints", false);
+  declare_parameter("handoff_radius", 1.0);
   nav2_util::declare_parameter_if_not_declared(
     this, std::string("waypoint_task_executor_plugin"),
     rclcpp::ParameterValue(std::string("wait_at_waypoint")));
@@ -57,6 +65,8 @@ WaypointFollower::on_configure(const rclcpp_lifecycle::State & /*state*/)
 
   stop_on_failure_ = get_parameter("stop_on_failure").as_bool();
   loop_rate_ = get_parameter("loop_rate").as_int();
+  pass_through_waypoints_ = get_parameter("pass_through_waypoints").as_bool();
+  handoff_radius_ = get_parameter("handoff_radius").as_double();
   waypoint_task_executor_id_ = get_parameter("waypoint_task_executor_plugin").as_string();
 
   callback_group_ = create_callback_group(
@@ -88,6 +98,16 @@ WaypointFollower::on_configure(const rclcpp_lifecycle::State & /*state*/)
       get_logger(), "Created waypoint_task_executor : %s of type %s",
       waypoint_task_executor_id_.c_str(), waypoint_task_executor_type_.c_str());
     waypoint_task_executor_->initialize(node, waypoint_task_executor_id_);
+
+    const int task_executor_threads = get_parameter("task_executor_threads").as_int();
+    if (task_executor_threads > 0) {
+      const int task_queue_size = get_parameter("task_queue_size").as_int();
+      task_executor_pool_ = std::make_unique<TaskExecutorPool>(
+        *waypoint_task_executor_, task_executor_threads, std::max(task_queue_size, 1));
+      RCLCPP_INFO(
+        get_logger(), "Running the tasks at waypoints on %i threads, without stopping.",
+        task_executor_threads);
+    }
   } catch (const pluginlib::PluginlibException & ex) {
     RCLCPP_FATAL(
       get_logger(),
@@ -136,6 +156,7 @@ WaypointFollower::on_cleanup(const rclcpp_lifecycle::State & /*state*/)
 
   action_server_.reset();
   nav_to_pose_client_.reset();
+  task_executor_pool_.reset();
 
   return nav2_util::CallbackReturn::SUCCESS;
 }
@@ -180,6 +201,9 @@ WaypointFollower::followWaypoints()
       callback_group_executor_.spin_until_future_complete(cancel_future);
       // for result callback processing
       callback_group_executor_.spin_some();
+      if (task_executor_pool_) {
+        task_executor_pool_->clear();
+      }
       action_server_->terminate_all();
       return;
     }
@@ -190,19 +214,48 @@ WaypointFollower::followWaypoints()
       goal = action_server_->accept_pending_goal();
       goal_index = 0;
       new_goal = true;
+      // The tasks of the previous goal are still done, but their failures are not reported
+      if (task_executor_pool_) {
+        task_executor_pool_->takeFailures();
+      }
     }
 
-    // Check if we need to send a new goal
+    if (!handleTaskFailures(result)) {
+      return;
+    }
+
+    // Check if we need to send a new goal, which preempts the navigation to a waypoint
+    // passed through rather than starting a new one
     if (new_goal) {
       new_goal = false;
       ClientT::Goal client_goal;
       client_goal.pose = goal->poses[goal_index];
+      current_waypoint_ = client_goal.pose;
+      handoff_ready_ = false;
 
+      const unsigned int generation = ++goal_generation_;
       auto send_goal_options = rclcpp_action::Client<ClientT>::SendGoalOptions();
       send_goal_options.result_callback =
-        std::bind(&WaypointFollower::resultCallback, this, std::placeholders::_1);
+        [this, generation](
+        const rclcpp_action::ClientGoalHandle<ClientT>::WrappedResult & wrapped) {
+          if (generation == goal_generation_) {
+            resultCallback(wrapped);
+          }
+        };
+      send_goal_options.feedback_callback =
+        [this, generation](
+        rclcpp_action::ClientGoalHandle<ClientT>::SharedPtr,
+        const std::shared_ptr<const ClientT::Feedback> navigation_feedback) {
+          if (generation == goal_generation_) {
+            feedbackCallback(navigation_feedback);
+          }
+        };
       send_goal_options.goal_response_callback =
-        std::bind(&WaypointFollower::goalResponseCallback, this, std::placeholders::_1);
+        [this, generation](const rclcpp_action::ClientGoalHandle<ClientT>::SharedPtr & handle) {
+          if (generation == goal_generation_) {
+            goalResponseCallback(handle);
+          }
+        };
       future_goal_handle_ =
         nav_to_pose_client_->async_send_goal(client_goal, send_goal_options);
       current_goal_status_ = ActionStatus::PROCESSING;
@@ -211,6 +264,11 @@ WaypointFollower::followWaypoints()
     feedback->current_waypoint = goal_index;
     action_server_->publish_feedback(feedback);
 
+    const bool pass_through = pass_through_waypoints_ && goal_index + 1 < goal->poses.size();
+    if (pass_through && current_goal_status_ == ActionStatus::PROCESSING && handoff_ready_) {
+      current_goal_status_ = ActionStatus::SUCCEEDED;
+    }
+
     if (current_goal_status_ == ActionStatus::FAILED) {
       failed_ids_.push_back(goal_index);
 
@@ -228,6 +286,20 @@ WaypointFollower::followWaypoints()
           get_logger(), "Failed to process waypoint %i,"
           " moving to next.", goal_index);
       }
+    } else if (current_goal_status_ == ActionStatus::SUCCEEDED && pass_through) {
+      RCLCPP_INFO(get_logger(), "Passed through waypoint %i, moving to next.", goal_index);
+    } else if (current_goal_status_ == ActionStatus::SUCCEEDED && task_executor_pool_) {
+      // The robot goes on while the task is done, unless too many tasks are waiting
+      if (!task_executor_pool_->push(goal->poses[goal_index], goal_index)) {
+        RCLCPP_INFO_THROTTLE(
+          get_logger(), *get_clock(), 1000,
+          "Task queue is full at waypoint %i, waiting for a task to finish.", goal_index);
+        callback_group_executor_.spin_some();
+        r.sleep();
+        continue;
+      }
+      RCLCPP_INFO(
+        get_logger(), "Queued task execution at waypoint %i, moving to next.", goal_index);
     } else if (current_goal_status_ == ActionStatus::SUCCEEDED) {
       RCLCPP_INFO(
         get_logger(), "Succeeded processing waypoint %i, processing waypoint task execution",
@@ -262,6 +334,9 @@ WaypointFollower::followWaypoints()
       goal_index++;
       new_goal = true;
       if (goal_index >= goal->poses.size()) {
+        if (!waitForTasks(result)) {
+          return;
+        }
         RCLCPP_INFO(
           get_logger(), "Completed all %lu waypoints requested.",
           goal->poses.size());
@@ -282,6 +357,58 @@ WaypointFollower::followWaypoints()
   }
 }
 
+bool
+WaypointFollower::handleTaskFailures(std::shared_ptr<ActionT::Result> result)
+{
+  if (!task_executor_pool_) {
+    return true;
+  }
+
+  for (const int waypoint_index : task_executor_pool_->takeFailures()) {
+    failed_ids_.push_back(waypoint_index);
+    RCLCPP_INFO(get_logger(), "Task execution at waypoint %i failed!", waypoint_index);
+    if (stop_on_failure_) {
+      RCLCPP_WARN(
+        get_logger(), "Failed to execute task at waypoint %i "
+        " stop on failure is enabled."
+        " Terminating action.", waypoint_index);
+      // The robot may be on its way to the next waypoint already
+      auto cancel_future = nav_to_pose_client_->async_cancel_all_goals();
+      callback_group_executor_.spin_until_future_complete(cancel_future);
+      callback_group_executor_.spin_some();
+      task_executor_pool_->clear();
+      result->missed_waypoints = failed_ids_;
+      action_server_->terminate_current(result);
+      failed_ids_.clear();
+      return false;
+    }
+  }
+  return true;
+}
+
+bool
+WaypointFollower::waitForTasks(std::shared_ptr<ActionT::Result> result)
+{
+  if (!task_executor_pool_) {
+    return true;
+  }
+
+  rclcpp::WallRate r(loop_rate_);
+  while (rclcpp::ok() && !task_executor_pool_->idle()) {
+    if (action_server_->is_cancel_requested()) {
+      task_executor_pool_->clear();
+      action_server_->terminate_all();
+      failed_ids_.clear();
+      return false;
+    }
+    if (!handleTaskFailures(result)) {
+      return false;
+    }
+    r.sleep();
+  }
+  return handleTaskFailures(result);
+}
+
 void
 WaypointFollower::resultCallback(
   const rclcpp_action::ClientGoalHandle<ClientT>::WrappedResult & result)
@@ -302,6 +429,23 @@ WaypointFollower::resultCallback(
   }
 }
 
+void
+WaypointFollower::feedbackCallback(const std::shared_ptr<const ClientT::Feedback> & feedback)
+{
+  // Poses in different frames are not compared, the waypoint being reached then
+  if (feedback->current_pose.header.frame_id != current_waypoint_.header.frame_id) {
+    RCLCPP_WARN_ONCE(
+      get_logger(), "Waypoints in the %s frame can't be passed through, as the robot pose is"
+      " in the %s frame. This warning will appear once.",
+      current_waypoint_.header.frame_id.c_str(), feedback->current_pose.header.frame_id.c_str());
+    return;
+  }
+  handoff_ready_ = std::hypot(
+    feedback->current_pose.pose.position.x - current_waypoint_.pose.position.x,
+    feedback->current_pose.pose.position.y - current_waypoint_.pose.position.y) <=
+    handoff_radius_;
+}
+
 void
 WaypointFollower::goalResponseCallback(
   const rclcpp_action::ClientGoalHandle<ClientT>::SharedPtr & goal)
@@ -331,6 +475,12 @@ WaypointFollower::dynamicParametersCallback(std::vector<rclcpp::Parameter> param
     } else if (type == ParameterType::PARAMETER_BOOL) {
       if (name == "stop_on_failure") {
         stop_on_failure_ = parameter.as_bool();
+      } else if (name == "pass_through_waypoints") {
+        pass_through_waypoints_ = parameter.as_bool();
+      }
+    } else if (type == ParameterType::PARAMETER_DOUBLE) {
+      if (name == "handoff_radius") {
+        handoff_radius_ = parameter.as_double();
       }
     }
   }
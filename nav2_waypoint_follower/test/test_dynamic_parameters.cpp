@@ -65,7 +65,9 @@ TEST(WPTest, test_dynamic_parameters)
 
   auto results = rec_param->set_parameters_atomically(
     {rclcpp::Parameter("loop_rate", 100),
-      rclcpp::Parameter("stop_on_failure", false)});
+      rclcpp::Parameter("stop_on_failure", false),
+      rclcpp::Parameter("pass_through_waypoints", true),
+      rclcpp::Parameter("handoff_radius", 2.5)});
 
   rclcpp::spin_until_future_complete(
     follower->get_node_base_interface(),
@@ -73,4 +75,6 @@ TEST(WPTest, test_dynamic_parameters)
 
   EXPECT_EQ(follower->get_parameter("loop_rate").as_int(), 100);
   EXPECT_EQ(follower->get_parameter("stop_on_failure").as_bool(), false);
+  EXPECT_EQ(follower->get_parameter("pass_through_waypoints").as_bool(), true);
+  EXPECT_EQ(follower->get_parameter("handoff_radius").as_double(), 2.5);
 }
@@ -13,6 +13,7 @@
 // limitations under the License. Reserved.
 
 #include <math.h>
+#include <chrono>
 #include <condition_variable>
 #include <memory>
 #include <string>
@@ -26,6 +27,7 @@
 #include "nav2_waypoint_follower/plugins/photo_at_waypoint.hpp"
 #include "nav2_waypoint_follower/plugins/wait_at_waypoint.hpp"
 #include "nav2_waypoint_follower/plugins/input_at_waypoint.hpp"
+#include "nav2_waypoint_follower/task_executor_pool.hpp"
 
 
 class RclCppFixture
@@ -162,3 +164,115 @@ TEST(WaypointFollowerTest, PhotoAtWaypoint)
   // plugin is not enabled, should exit
   EXPECT_TRUE(paw->processAtWaypoint(pose, 0));
 }
+
+TEST(WaypointFollowerTest, PhotoAtWaypointInBackground)
+{
+  auto node = std::make_shared<rclcpp_lifecycle::LifecycleNode>("testWaypointNode");
+  node->declare_parameter("PAW.write_in_background", true);
+  node->declare_parameter("PAW.save_dir", "/tmp/waypoint_images_background");
+
+  std::unique_ptr<nav2_waypoint_follower::PhotoAtWaypoint> paw(
+    new nav2_waypoint_follower::PhotoAtWaypoint
+  );
+  paw->initialize(node, std::string("PAW"));
+
+  // no images, still fails right away
+  geometry_msgs::msg::PoseStamped pose;
+  EXPECT_FALSE(paw->processAtWaypoint(pose, 0));
+
+  auto msg = std::make_shared<sensor_msgs::msg::Image>();
+  msg->encoding = "rgb8";
+  msg->height = 240;
+  msg->width = 320;
+  msg->step = 960;
+  msg->data.assign(msg->height * msg->step, 100);
+  paw->imageCallback(msg);
+
+  // more photos than are kept pending, the others are written right away
+  for (int i = 0; i < 8; i++) {
+    pose.header.stamp.sec = 1000 + i;
+    EXPECT_TRUE(paw->processAtWaypoint(pose, i));
+  }
+
+  // the pending photos are written before the plugin is destroyed
+  paw.reset();
+  for (int i = 0; i < 8; i++) {
+    const std::string file_name = "/tmp/waypoint_images_background/" + std::to_string(i) +
+      "_" + std::to_string(1000 + i) + ".png";
+    EXPECT_TRUE(std::experimental::filesystem::exists(file_name)) << file_name;
+    std::experimental::filesystem::remove(file_name);
+  }
+}
+
+// Records the waypoints of its tasks, failing at odd ones, until it is released
+class BlockingTaskExecutor : public nav2_core::WaypointTaskExecutor
+{
+public:
+  void initialize(
+    const rclcpp_lifecycle::LifecycleNode::WeakPtr & /*parent*/,
+    const std::string & /*plugin_name*/) override
+  {
+  }
+
+  bool processAtWaypoint(
+    const geometry_msgs::msg::PoseStamped & /*curr_pose*/,
+    const int & curr_waypoint_index) override
+  {
+    std::unique_lock<std::mutex> lock(mutex);
+    started = true;
+    cv.notify_all();
+    cv.wait(lock, [this]() {return released;});
+    waypoints.push_back(curr_waypoint_index);
+    return curr_waypoint_index % 2 == 0;
+  }
+
+  void release()
+  {
+    std::lock_guard<std::mutex> lock(mutex);
+    released = true;
+    cv.notify_all();
+  }
+
+  void waitStarted()
+  {
+    std::unique_lock<std::mutex> lock(mutex);
+    cv.wait(lock, [this]() {return started;});
+  }
+
+  std::vector<int> waypoints;
+  bool started{false};
+  bool released{false};
+  std::mutex mutex;
+  std::condition_variable cv;
+};
+
+TEST(WaypointFollowerTest, TaskExecutorPool)
+{
+  BlockingTaskExecutor task_executor;
+  geometry_msgs::msg::PoseStamped pose;
+  {
+    nav2_waypoint_follower::TaskExecutorPool pool(task_executor, 1, 2);
+
+    // one task running on the worker, two queued, the next ones do not fit
+    EXPECT_TRUE(pool.push(pose, 0));
+    task_executor.waitStarted();
+    EXPECT_TRUE(pool.push(pose, 1));
+    EXPECT_TRUE(pool.push(pose, 2));
+    EXPECT_FALSE(pool.push(pose, 3));
+    EXPECT_FALSE(pool.idle());
+
+    task_executor.release();
+    while (!pool.idle()) {
+      std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+    EXPECT_EQ(pool.takeFailures(), std::vector<int>({1}));
+    EXPECT_TRUE(pool.takeFailures().empty());
+
+    EXPECT_TRUE(pool.push(pose, 3));
+    while (!pool.idle()) {
+      std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+    EXPECT_EQ(pool.takeFailures(), std::vector<int>({3}));
+  }
+  EXPECT_EQ(task_executor.waypoints, std::vector<int>({0, 1, 2, 3}));
+}